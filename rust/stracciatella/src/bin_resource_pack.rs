@@ -37,6 +37,11 @@ fn main() {
                 .help("Adds the file size to the resource properties")
                 .long("file-size"),
         )
+        .arg(
+            Arg::with_name("progress")
+                .help("Reports the number of processed files to stderr")
+                .long("progress"),
+        )
         .arg(
             Arg::with_name("pretty")
                 .help("Outputs with the pretty formatter")
@@ -112,6 +117,10 @@ fn subcommand_create(matches: &ArgMatches) {
         builder.with_file_size();
     }
 
+    if matches.is_present("progress") {
+        builder.with_progress();
+    }
+
     if let Some(values) = matches.values_of("hash") {
         for hash in values {
             builder.with_hash(hash);
@@ -79,6 +79,49 @@ impl Cli {
         opts.optflag("", "nosound", "Turn the sound and music off");
         opts.optflag("", "window", "Start the game in a window");
         opts.optflag("", "debug", "Enable Debug Mode");
+        opts.optflag(
+            "",
+            "gpucompositing",
+            "Draw the mouse cursor as a separate layer on the GPU instead of blitting it into the screen",
+        );
+        opts.optflag(
+            "",
+            "hardwarecursor",
+            "Let the operating system draw the mouse cursor, so it moves independently of the game frame",
+        );
+        opts.optflag(
+            "",
+            "framepacing",
+            "Present the frames in step with the display's refresh (vsync), apart from the fixed game cycles",
+        );
+        opts.optopt(
+            "",
+            "tilecache",
+            "Memory in megabytes used to keep loaded tile surfaces for later tilesets. 0 turns the cache off. Default value is 64",
+            "MEGABYTES",
+        );
+        opts.optopt(
+            "",
+            "record",
+            "Record the input and the random seed into FILE, running the game on a fixed timestep, so it can be replayed with -replay",
+            "FILE",
+        );
+        opts.optopt(
+            "",
+            "replay",
+            "Replay the input recorded in FILE as fast as possible, then print the time taken and exit",
+            "FILE",
+        );
+        opts.optflag(
+            "",
+            "replaynorender",
+            "Do not show the frames while replaying, to time the game without the presentation",
+        );
+        opts.optflag(
+            "",
+            "benchmark",
+            "Run all benchmarks from the main menu, compare the results with the stored baseline, then exit, failing if any result regressed",
+        );
         opts.optflag("", "help", "print this help menu");
 
         Cli {
@@ -177,6 +220,47 @@ impl Cli {
                     engine_options.start_in_debug_mode = true;
                 }
 
+                if m.opt_present("gpucompositing") {
+                    engine_options.gpu_compositing = true;
+                }
+
+                if m.opt_present("hardwarecursor") {
+                    engine_options.hardware_cursor = true;
+                }
+
+                if m.opt_present("framepacing") {
+                    engine_options.frame_pacing = true;
+                }
+
+                if let Some(s) = m.opt_str("tilecache") {
+                    match s.parse::<u32>() {
+                        Ok(val) => {
+                            engine_options.tile_cache_size = val;
+                        }
+                        Err(_e) => return Err(String::from("Incorrect tile cache size.")),
+                    }
+                }
+
+                if let Some(s) = m.opt_str("record") {
+                    engine_options.record_input = PathBuf::from(s);
+                }
+
+                if let Some(s) = m.opt_str("replay") {
+                    engine_options.replay_input = PathBuf::from(s);
+                }
+
+                if m.opt_present("replaynorender") {
+                    engine_options.replay_without_rendering = true;
+                }
+
+                if m.opt_present("benchmark") {
+                    engine_options.run_benchmarks = true;
+                }
+
+                if m.opt_present("record") && m.opt_present("replay") {
+                    return Err(String::from("Cannot record and replay at the same time."));
+                }
+
                 Ok(())
             }
             Err(f) => Err(f.to_string()),
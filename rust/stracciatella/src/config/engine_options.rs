@@ -34,6 +34,22 @@ pub struct EngineOptions {
     pub start_in_debug_mode: bool,
     /// Whether to enable sound
     pub start_without_sound: bool,
+    /// Whether to compose the screen and the mouse cursor on the GPU
+    pub gpu_compositing: bool,
+    /// Whether to let the operating system draw the mouse cursor
+    pub hardware_cursor: bool,
+    /// Whether to present the frames in step with the display's refresh
+    pub frame_pacing: bool,
+    /// Memory budget in megabytes for tile surfaces kept for later tilesets
+    pub tile_cache_size: u32,
+    /// File to record the input and the random seed into, empty if not recording
+    pub record_input: PathBuf,
+    /// File with recorded input to replay as a benchmark, empty if not replaying
+    pub replay_input: PathBuf,
+    /// Whether to skip presenting the frames to the window while replaying
+    pub replay_without_rendering: bool,
+    /// Whether to run the benchmark suite on startup and exit
+    pub run_benchmarks: bool,
 }
 
 impl Default for EngineOptions {
@@ -53,6 +69,14 @@ impl Default for EngineOptions {
             scaling_quality: ScalingQuality::default(),
             start_in_debug_mode: false,
             start_without_sound: false,
+            gpu_compositing: false,
+            hardware_cursor: false,
+            frame_pacing: false,
+            tile_cache_size: 64,
+            record_input: PathBuf::from(""),
+            replay_input: PathBuf::from(""),
+            replay_without_rendering: false,
+            run_benchmarks: false,
         }
     }
 }
@@ -1,6 +1,6 @@
 //! This module contains code to guess Vanillaversion with resource packs.
 
-use std::collections::HashSet;
+use std::collections::{BTreeMap, HashSet};
 use std::convert::From;
 use std::error::Error;
 use std::ffi::OsString;
@@ -9,28 +9,136 @@ use std::fs::File;
 use std::io;
 use std::path::{Path, PathBuf};
 use std::str::FromStr;
+use std::time::UNIX_EPOCH;
 
+use digest::Digest;
+use hex;
 use log::{error, info};
+use md5::Md5;
 use rayon::prelude::*;
+use serde::{Deserialize, Serialize};
 use serde_json;
 
-use crate::config::VanillaVersion;
+use crate::config::{find_stracciatella_home, VanillaVersion};
 use crate::fs::resolve_existing_components;
 use crate::res::{
     Resource, ResourceError, ResourcePack, ResourcePackBuilder, ResourcePropertiesExt,
 };
 use crate::unicode::Nfc;
 
+/// File in the stracciatella home that remembers the guesses per game dir.
+const GUESS_CACHE_FILE: &str = "guess_cache.json";
+
+/// Directory of the resource packs the data dir is compared to.
+const RESOURCE_PACKS_DIR: &str = "externalized/resource_packs";
+
 /// Guess the vanilla version of the resources in the game dir.
+///
+/// The guess is remembered with a fingerprint of the names, sizes and modification times of the
+/// files in the data dir and of the resource packs, so it is only repeated when one of them changed.
 pub fn guess_vanilla_version(gamedir: &str) -> Guess {
     let path = Path::new(gamedir);
     let mut logged = Guess::default();
+    let cache_path = find_stracciatella_home()
+        .ok()
+        .map(|home| home.join(GUESS_CACHE_FILE));
+    let fingerprint = logged
+        .get_datadir(&path)
+        .ok()
+        .map(|datadir| fingerprint_files(&[datadir.as_path(), Path::new(RESOURCE_PACKS_DIR)]));
+    let mut cache = cache_path
+        .as_ref()
+        .map(|p| read_guess_cache(p))
+        .unwrap_or_default();
+
+    if let (Some(fingerprint), Some(cached)) = (fingerprint.as_ref(), cache.get(gamedir)) {
+        if &cached.fingerprint == fingerprint {
+            info!("Using the remembered vanilla_version {:?}", cached.vanilla_version);
+            logged.vanilla_version = Some(cached.vanilla_version);
+            return logged;
+        }
+    }
+
     if let Err(err) = logged.guess_vanilla_version(&path) {
         error!("Error: {}", err.desc);
     }
+
+    if let (Some(cache_path), Some(fingerprint), Some(vanilla_version)) =
+        (cache_path, fingerprint, logged.vanilla_version)
+    {
+        cache.insert(
+            gamedir.to_owned(),
+            CachedGuess {
+                fingerprint,
+                vanilla_version,
+            },
+        );
+        if let Err(err) = write_guess_cache(&cache_path, &cache) {
+            error!("Failed to write {:?}: {}", cache_path, err.desc);
+        }
+    }
     logged
 }
 
+/// A guess remembered for a game dir.
+#[derive(Debug, Deserialize, Serialize)]
+struct CachedGuess {
+    /// Fingerprint of the files the guess was made from.
+    fingerprint: String,
+    /// The guessed version.
+    vanilla_version: VanillaVersion,
+}
+
+/// Reads the remembered guesses, an unreadable cache is treated as empty.
+fn read_guess_cache(path: &Path) -> BTreeMap<String, CachedGuess> {
+    File::open(path)
+        .ok()
+        .and_then(|f| serde_json::from_reader(f).ok())
+        .unwrap_or_default()
+}
+
+/// Writes the remembered guesses.
+fn write_guess_cache(path: &Path, cache: &BTreeMap<String, CachedGuess>) -> GuessResult<()> {
+    let f = File::create(path)?;
+    serde_json::to_writer_pretty(f, cache)?;
+    Ok(())
+}
+
+/// Hashes the paths, sizes and modification times of all the files in the dirs.
+///
+/// Only metadata is read, none of the file data.
+fn fingerprint_files(dirs: &[&Path]) -> String {
+    let mut hasher = Md5::new();
+    for dir in dirs {
+        let mut pending = vec![dir.to_path_buf()];
+        while let Some(path) = pending.pop() {
+            let metadata = match path.metadata() {
+                Ok(metadata) => metadata,
+                Err(_) => continue,
+            };
+            if metadata.is_dir() {
+                if let Ok(iter) = path.read_dir() {
+                    let mut entries: Vec<_> =
+                        iter.filter_map(|e| e.ok().map(|e| e.path())).collect();
+                    entries.sort();
+                    entries.reverse(); // popped in order
+                    pending.append(&mut entries);
+                }
+            } else {
+                let modified = metadata
+                    .modified()
+                    .ok()
+                    .and_then(|t| t.duration_since(UNIX_EPOCH).ok())
+                    .map(|d| (d.as_secs(), d.subsec_nanos()))
+                    .unwrap_or_default();
+                hasher.input(path.to_string_lossy().as_bytes());
+                hasher.input(format!(":{}:{}.{}\n", metadata.len(), modified.0, modified.1));
+            }
+        }
+    }
+    hex::encode(hasher.result())
+}
+
 /// A difference that was detected in resource packs
 #[derive(Debug)]
 enum Difference {
@@ -272,7 +380,7 @@ impl Guess {
 
     /// Find all resource packs in externalized directory
     fn get_pack_paths(&self) -> GuessResult<Vec<PathBuf>> {
-        let dir = Path::new("externalized/resource_packs");
+        let dir = Path::new(RESOURCE_PACKS_DIR);
         info!("Searching for resource packs in {:?}", &dir);
         let paths: Vec<PathBuf> = dir
             .read_dir()?
@@ -482,6 +590,20 @@ mod tests {
         tmp_dir
     }
 
+    #[test]
+    fn test_fingerprint_files_changes_with_file_size() {
+        let data_dir = build_data_dir_with_resources(vec![(
+            PathBuf::from("other/data.txt"),
+            Vec::from("data"),
+        )]);
+        let dir = data_dir.path().join("data");
+        let before = fingerprint_files(&[dir.as_path()]);
+        assert_eq!(fingerprint_files(&[dir.as_path()]), before);
+
+        fs::write(dir.join("other/data.txt"), "more data").unwrap();
+        assert_ne!(fingerprint_files(&[dir.as_path()]), before);
+    }
+
     #[test]
     fn test_language_specific_resources_not_present() {
         let data_dir = build_data_dir_with_resources(vec![(
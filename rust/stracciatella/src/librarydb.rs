@@ -16,6 +16,9 @@
 //!  * it is thread safe
 //!  * shadowing respects library order and uses the full file path,
 //!    the original shadowed libraries based on the longest base path
+//!  * paths are resolved with a hash index of all the entries of all the libraries
+//!  * where the platform supports it, libraries are memory mapped once and
+//!    reads are copies from the mapping, without locks or system calls
 //!
 //!
 //! # FFI
@@ -25,18 +28,22 @@
 //! [`stracciatella_c_api::c::librarydb`]: ../../stracciatella_c_api/c/librarydb/index.html
 
 use std::cmp;
-use std::collections::HashSet;
+use std::collections::{HashMap, HashSet};
 use std::fmt;
 use std::fs::File;
 use std::io;
 use std::io::{Seek, SeekFrom};
 use std::ops;
 use std::path::{Component, Path, PathBuf};
+use std::sync::atomic::{AtomicU64, Ordering};
 use std::sync::{Arc, Mutex, MutexGuard, RwLock};
 
 use crate::file_formats::slf::{SlfEntryState, SlfHeader};
 use crate::unicode::Nfc;
 
+/// Length of the longest ASCII path that is looked up without allocating.
+const ASCII_PATH_BUFFER_LENGTH: usize = 256;
+
 /// Thread safe library database.
 #[derive(Debug)]
 pub struct LibraryDB {
@@ -48,6 +55,13 @@ pub struct LibraryDB {
 pub struct LibraryDBInner {
     /// Thread safe libraries.
     arc_libraries: Vec<Arc<RwLock<Library>>>,
+    /// Caseless full path of every visible entry to the library and entry index.
+    /// Entries shadowed by an earlier library are not in the index.
+    index: HashMap<String, (usize, usize)>,
+    /// Number of files opened from each library.
+    lookup_hits: Vec<AtomicU64>,
+    /// Number of paths not found in any library.
+    lookup_misses: AtomicU64,
 }
 
 /// Library.
@@ -59,6 +73,8 @@ pub struct Library {
     library_path: PathBuf,
     /// Library file open for reading.
     library_file: File,
+    /// Read-only mapping of the library file, if it could be mapped.
+    mapping: Option<Arc<Mapping>>,
     /// Caseless base path of the entries in the library.
     base_path: Nfc,
     /// List of ok entries in the library.
@@ -81,14 +97,29 @@ pub struct LibraryEntry {
 /// Provides access to the data of a library entry through Read and Seek.
 #[derive(Debug)]
 pub struct LibraryFile {
-    /// The index of the entry of this file.
-    index: usize,
     /// The thread safe library of this file.
     arc_library: Arc<RwLock<Library>>,
+    /// Mapping of the library file, reads copy from it if present.
+    mapping: Option<Arc<Mapping>>,
+    /// Start of the file data in the library file.
+    data_start: u64,
+    /// End of the file data in the library file.
+    data_end: u64,
     /// Current position in the library file.
     position: u64,
 }
 
+/// Read-only memory mapping of a whole library file.
+#[derive(Debug)]
+struct Mapping {
+    ptr: *const u8,
+    len: usize,
+}
+
+/// The mapping is read-only and lives as long as the struct.
+unsafe impl Send for Mapping {}
+unsafe impl Sync for Mapping {}
+
 impl LibraryDB {
     /// Constructor.
     pub fn new() -> Self {
@@ -113,6 +144,22 @@ impl LibraryDB {
     pub fn open_file(&self, path: &str) -> io::Result<LibraryFile> {
         self.locked().open_file(path)
     }
+
+    /// Returns true if a library contains the file.
+    /// Does not count as a lookup.
+    pub fn contains_file(&self, path: &str) -> bool {
+        self.locked().contains_file(path)
+    }
+
+    /// Returns the number of files opened from each library, in library order.
+    pub fn lookup_hits(&self) -> Vec<u64> {
+        self.locked().lookup_hits()
+    }
+
+    /// Returns the number of paths that were not found in any library.
+    pub fn lookup_misses(&self) -> u64 {
+        self.locked().lookup_misses()
+    }
 }
 
 impl LibraryDBInner {
@@ -120,32 +167,78 @@ impl LibraryDBInner {
     fn new() -> Self {
         Self {
             arc_libraries: Vec::new(),
+            index: HashMap::new(),
+            lookup_hits: Vec::new(),
+            lookup_misses: AtomicU64::new(0),
         }
     }
 
     /// Opens and adds a library at the end of library database.
+    /// Adds the entries that are not shadowed by an earlier library to the index.
     pub fn add_library(&mut self, data_dir: &Path, library: &Path) -> io::Result<()> {
         let library = Library::open(&data_dir, &library)?;
+        let library_index = self.arc_libraries.len();
+        self.index.reserve(library.entries.len());
+        for (entry_index, entry) in library.entries.iter().enumerate() {
+            let path = format!("{}{}", library.base_path, entry.file_path);
+            self.index
+                .entry(path)
+                .or_insert((library_index, entry_index));
+        }
         self.arc_libraries.push(Arc::new(RwLock::new(library)));
+        self.lookup_hits.push(AtomicU64::new(0));
         Ok(())
     }
 
     /// Opens a library file for reading.
     /// The file must be dropped before the library database is dropped.
     pub fn open_file(&self, path: &str) -> io::Result<LibraryFile> {
-        let path = Nfc::caseless_path(&path);
-        for arc_library in &self.arc_libraries {
+        if let Some((library_index, entry_index)) = self.find_entry(path) {
+            let arc_library = &self.arc_libraries[library_index];
             let library = arc_library.read().unwrap();
-            if let Some(index) = library.find(&path) {
-                return Ok(LibraryFile {
-                    index,
-                    arc_library: arc_library.to_owned(),
-                    position: library.entries[index].data_start,
-                });
-            }
+            let entry = &library.entries[entry_index];
+            self.lookup_hits[library_index].fetch_add(1, Ordering::Relaxed);
+            return Ok(LibraryFile {
+                arc_library: arc_library.to_owned(),
+                mapping: library.mapping.to_owned(),
+                data_start: entry.data_start,
+                data_end: entry.data_end,
+                position: entry.data_start,
+            });
         }
+        self.lookup_misses.fetch_add(1, Ordering::Relaxed);
         Err(io::ErrorKind::NotFound.into())
     }
+
+    /// Returns true if a library contains the file.
+    /// Does not count as a lookup.
+    pub fn contains_file(&self, path: &str) -> bool {
+        self.find_entry(path).is_some()
+    }
+
+    /// Finds the library and entry index of a path.
+    /// Most paths are ASCII and short, their caseless form is made on the stack.
+    fn find_entry(&self, path: &str) -> Option<(usize, usize)> {
+        let mut buffer = [0u8; ASCII_PATH_BUFFER_LENGTH];
+        let found = match ascii_caseless_path(path, &mut buffer) {
+            Some(caseless) => self.index.get(caseless),
+            None => self.index.get(Nfc::caseless_path(path).as_str()),
+        };
+        found.cloned()
+    }
+
+    /// Returns the number of files opened from each library, in library order.
+    pub fn lookup_hits(&self) -> Vec<u64> {
+        self.lookup_hits
+            .iter()
+            .map(|x| x.load(Ordering::Relaxed))
+            .collect()
+    }
+
+    /// Returns the number of paths that were not found in any library.
+    pub fn lookup_misses(&self) -> u64 {
+        self.lookup_misses.load(Ordering::Relaxed)
+    }
 }
 
 impl Library {
@@ -181,43 +274,85 @@ impl Library {
                 ));
             }
         }
+        // Reads fall back to the file if the library cannot be mapped
+        let mapping = Mapping::new(&library_file).ok().map(Arc::new);
         Ok(Library {
             library_path,
             library_file,
+            mapping,
             base_path,
             entries,
         })
     }
-
-    /// Finds the file entry identified by path.
-    /// Returns the entry index or None.
-    /// Expects path to be a caseless path.
-    /// Expects the entries to be sorted.
-    fn find(&self, path: &Nfc) -> Option<usize> {
-        if path.starts_with(&self.base_path.as_str()) {
-            let file_path = path.split_at(self.base_path.len()).1;
-            return self
-                .entries
-                .binary_search_by(|x| x.file_path.as_str().cmp(file_path))
-                .ok();
-        }
-        None
-    }
 }
 
 impl LibraryFile {
     /// Returns the current seek position.
     pub fn current_position(&self) -> u64 {
-        let library = self.arc_library.read().unwrap();
-        let entry = &library.entries[self.index];
-        self.position - entry.data_start
+        self.position - self.data_start
     }
 
     /// Returns the file size.
     pub fn file_size(&self) -> u64 {
-        let library = self.arc_library.read().unwrap();
-        let entry = &library.entries[self.index];
-        entry.data_end - entry.data_start
+        self.data_end - self.data_start
+    }
+
+    /// Returns the data of the file if the library is memory mapped.
+    pub fn mapped_data(&self) -> Option<&[u8]> {
+        let mapping = self.mapping.as_ref()?.as_slice();
+        let end = cmp::min(self.data_end, mapping.len() as u64) as usize;
+        let start = cmp::min(self.data_start as usize, end);
+        Some(&mapping[start..end])
+    }
+}
+
+impl Mapping {
+    /// Maps the whole file for reading.
+    #[cfg(unix)]
+    fn new(file: &File) -> io::Result<Self> {
+        use std::os::unix::io::AsRawFd;
+
+        let len = file.metadata()?.len();
+        if len == 0 || len > usize::max_value() as u64 {
+            return Err(io::ErrorKind::InvalidInput.into());
+        }
+        let len = len as usize;
+        let ptr = unsafe {
+            libc::mmap(
+                std::ptr::null_mut(),
+                len,
+                libc::PROT_READ,
+                libc::MAP_PRIVATE,
+                file.as_raw_fd(),
+                0,
+            )
+        };
+        if ptr == libc::MAP_FAILED {
+            return Err(io::Error::last_os_error());
+        }
+        Ok(Mapping {
+            ptr: ptr as *const u8,
+            len,
+        })
+    }
+
+    /// Memory mapping is not implemented, the file is read instead.
+    #[cfg(not(unix))]
+    fn new(_file: &File) -> io::Result<Self> {
+        Err(io::ErrorKind::Other.into())
+    }
+
+    fn as_slice(&self) -> &[u8] {
+        unsafe { std::slice::from_raw_parts(self.ptr, self.len) }
+    }
+}
+
+impl ops::Drop for Mapping {
+    fn drop(&mut self) {
+        #[cfg(unix)]
+        unsafe {
+            libc::munmap(self.ptr as *mut libc::c_void, self.len);
+        }
     }
 }
 
@@ -271,17 +406,15 @@ impl cmp::Eq for LibraryEntry {}
 /// LibraryFile seeks the data of a library entry.
 impl io::Seek for LibraryFile {
     fn seek(&mut self, pos: SeekFrom) -> io::Result<u64> {
-        let library = self.arc_library.write().unwrap();
-        let entry = &library.entries[self.index];
         let checked_position = match pos {
-            SeekFrom::Start(n) => entry.data_start.checked_add(n),
+            SeekFrom::Start(n) => self.data_start.checked_add(n),
             SeekFrom::Current(n) => checked_add_u64_i64(self.position, n),
-            SeekFrom::End(n) => checked_add_u64_i64(entry.data_end, n),
+            SeekFrom::End(n) => checked_add_u64_i64(self.data_end, n),
         };
         if let Some(position) = checked_position {
-            if position >= entry.data_start {
+            if position >= self.data_start {
                 self.position = position;
-                return Ok(position - entry.data_start);
+                return Ok(position - self.data_start);
             }
         }
         // must never become negative or overflow
@@ -292,8 +425,20 @@ impl io::Seek for LibraryFile {
 /// LibraryFile reads the data of a library entry.
 impl io::Read for LibraryFile {
     fn read(&mut self, buf: &mut [u8]) -> io::Result<usize> {
+        if let Some(data) = self.mapped_data() {
+            let offset = self.position - self.data_start;
+            if offset >= data.len() as u64 {
+                return Ok(0);
+            }
+            let data = &data[offset as usize..];
+            let bytes = cmp::min(data.len(), buf.len());
+            buf[..bytes].copy_from_slice(&data[..bytes]);
+            self.position += bytes as u64;
+            return Ok(bytes);
+        }
+
         let mut library = self.arc_library.write().unwrap();
-        let end = library.entries[self.index].data_end;
+        let end = self.data_end;
         if self.position >= end {
             return Ok(0);
         }
@@ -324,6 +469,23 @@ fn checked_add_u64_i64(a: u64, b: i64) -> Option<u64> {
     }
 }
 
+/// Writes the caseless path of an ASCII path into the buffer, as `Nfc::caseless_path` would make it.
+/// Returns None if the path is not ASCII or does not fit.
+fn ascii_caseless_path<'a>(path: &str, buffer: &'a mut [u8]) -> Option<&'a str> {
+    if !path.is_ascii() || path.len() > buffer.len() {
+        return None;
+    }
+    let buffer = &mut buffer[..path.len()];
+    for (to, &from) in buffer.iter_mut().zip(path.as_bytes()) {
+        *to = if from == b'\\' {
+            b'/'
+        } else {
+            from.to_ascii_lowercase()
+        };
+    }
+    std::str::from_utf8(buffer).ok()
+}
+
 /// Finds a filesystem file.
 /// dir_path is an absolute path or a path relative to the current directory.
 /// file_name is a path relative to dir_path, the normal components are searched case-insensitive (perfect match takes precedence).
@@ -503,6 +665,27 @@ pub mod tests {
         tmp.close().unwrap();
     }
 
+    #[test]
+    fn read_in_parts() {
+        let (tmp, dir) = data_dir();
+
+        let mut ldb = LibraryDB::new();
+        ldb.add_library(&dir, Path::new("foo.slf")).unwrap();
+        let mut file = ldb.open_file("foo/bar.txt").unwrap();
+
+        let mut buf = [0u8; 5];
+        assert_eq!(file.read(&mut buf).unwrap(), 5);
+        assert_eq!(&buf, b"foo.s");
+        assert_eq!(file.read(&mut buf).unwrap(), 2);
+        assert_eq!(&buf[..2], b"lf");
+        assert_eq!(file.read(&mut buf).unwrap(), 0);
+        assert_eq!(file.seek(SeekFrom::End(4)).unwrap(), 11);
+        assert_eq!(file.read(&mut buf).unwrap(), 0);
+        assert_eq!(file.current_position(), 11);
+
+        tmp.close().unwrap();
+    }
+
     #[test]
     fn library_order_matters() {
         let (tmp, dir) = data_dir();
@@ -522,6 +705,41 @@ pub mod tests {
         tmp.close().unwrap();
     }
 
+    #[test]
+    fn lookup_counters() {
+        let (tmp, dir) = data_dir();
+
+        let mut ldb = LibraryDB::new();
+        ldb.add_library(&dir, Path::new("foo.slf")).unwrap();
+        ldb.add_library(&dir, Path::new("data.slf")).unwrap();
+        library_file_data(&ldb, "foo/bar.txt");
+        library_file_data(&ldb, "FOO/BAR/baz.txt");
+        library_file_data(&ldb, "foo.txt");
+        assert!(ldb.open_file("missing.txt").is_err());
+        assert_eq!(ldb.lookup_hits(), vec![2, 1]);
+        assert_eq!(ldb.lookup_misses(), 1);
+        assert!(ldb.contains_file("FOO/bar.txt"));
+        assert!(!ldb.contains_file("missing.txt"));
+        assert_eq!(ldb.lookup_hits(), vec![2, 1]);
+        assert_eq!(ldb.lookup_misses(), 1);
+
+        tmp.close().unwrap();
+    }
+
+    #[test]
+    fn ascii_caseless_path_matches_nfc() {
+        let mut buffer = [0u8; ASCII_PATH_BUFFER_LENGTH];
+        for path in &["foo\\BAR/Baz.TXT", "tilecache/SKYSCRAPER.sti", ""] {
+            assert_eq!(
+                ascii_caseless_path(path, &mut buffer),
+                Some(Nfc::caseless_path(path).as_str())
+            );
+        }
+        assert_eq!(ascii_caseless_path("Straße.txt", &mut buffer), None);
+        let long = "a".repeat(ASCII_PATH_BUFFER_LENGTH + 1);
+        assert_eq!(ascii_caseless_path(&long, &mut buffer), None);
+    }
+
     #[test]
     fn case_insensitive_file_paths() {
         let (tmp, dir) = data_dir();
@@ -56,8 +56,12 @@ use std::collections::{HashSet, VecDeque};
 use std::convert::From;
 use std::error::Error;
 use std::fmt;
+use std::fs::File;
 use std::io;
+use std::io::Read;
 use std::path::{Path, PathBuf};
+use std::sync::atomic::{AtomicUsize, Ordering};
+use std::sync::Arc;
 
 use digest::Digest;
 use hex;
@@ -69,6 +73,12 @@ use serde_json::{json, Map, Value};
 use crate::file_formats::slf::{SlfEntryState, SlfHeader};
 use crate::unicode::Nfc;
 
+/// Size of the chunks file data is hashed in.
+const HASH_CHUNK_SIZE: usize = 64 * 1024;
+
+/// Number of files between two progress reports.
+const PROGRESS_INTERVAL: usize = 1000;
+
 /// A pack of game resources.
 #[derive(Clone, Debug, Default, Deserialize, Serialize)]
 pub struct ResourcePack {
@@ -108,6 +118,12 @@ pub struct ResourcePackBuilder {
     /// Add paths to the pack (base, path).
     with_paths: VecDeque<(PathBuf, PathBuf)>,
 
+    /// Report the number of processed files to stderr.
+    with_progress: bool,
+
+    /// Number of files processed so far, shared by the worker threads.
+    num_processed: Arc<AtomicUsize>,
+
     /// Resource being built.
     pack: ResourcePack,
 }
@@ -194,6 +210,13 @@ impl ResourcePackBuilder {
         self
     }
 
+    /// Reports progress to stderr.
+    #[allow(dead_code)]
+    pub fn with_progress(&mut self) -> &mut Self {
+        self.with_progress = true;
+        self
+    }
+
     /// Adds a directory or an archive.
     #[allow(dead_code)]
     pub fn with_path(&mut self, base: &Path, path: &Path) -> &mut Self {
@@ -237,6 +260,7 @@ impl ResourcePackBuilder {
             self.pack.set_property(&prop, true);
         }
 
+        self.num_processed.store(0, Ordering::Relaxed);
         let resources: Result<Vec<Vec<Resource>>, ResourceError> = self
             .with_paths
             .par_iter()
@@ -254,6 +278,13 @@ impl ResourcePackBuilder {
             .collect();
         let mut resources: Vec<_> = resources?.into_iter().flat_map(|r| r).collect();
         self.pack.resources.append(&mut resources);
+        if self.with_progress {
+            eprintln!(
+                "{} files processed, {} resources",
+                self.num_processed.load(Ordering::Relaxed),
+                self.pack.resources.len()
+            );
+        }
 
         let pack = self.pack.to_owned();
         self.pack = ResourcePack::default();
@@ -294,7 +325,7 @@ impl ResourcePackBuilder {
         let extension = lowercase_extension(path);
         let wants_archive = self.with_archives.binary_search(&extension).is_ok();
         let wants_hashes = !self.with_hashes.is_empty();
-        if wants_archive || wants_hashes {
+        if wants_archive {
             let data = std::fs::read(path)?;
             if wants_archive {
                 match extension.as_str() {
@@ -308,11 +339,23 @@ impl ResourcePackBuilder {
             if wants_hashes {
                 self.add_hashes(&mut resource, &data)?;
             }
+        } else if wants_hashes {
+            // no need to hold the whole file
+            self.add_hashes_from_input(&mut resource, &mut File::open(path)?)?;
         }
         resources.push(resource);
+        self.report_progress();
         Ok(resources)
     }
 
+    /// Counts a processed file and reports every PROGRESS_INTERVAL files.
+    fn report_progress(&self) {
+        let n = self.num_processed.fetch_add(1, Ordering::Relaxed) + 1;
+        if self.with_progress && n % PROGRESS_INTERVAL == 0 {
+            eprintln!("{} files processed", n);
+        }
+    }
+
     // Adds the contents of a SLF archive.
     fn get_resources_for_slf(
         &self,
@@ -351,13 +394,38 @@ impl ResourcePackBuilder {
 
     /// Adds hashes of the resource data.
     fn add_hashes(&self, resource: &mut Resource, data: &[u8]) -> Result<(), ResourceError> {
-        for algorithm in &self.with_hashes {
-            let hash = match algorithm.as_str() {
-                "md5" => hex::encode(Md5::digest(&data)),
+        self.add_hashes_from_input(resource, &mut io::Cursor::new(data))
+    }
+
+    /// Adds hashes of the resource data, read from the input a chunk at a time.
+    fn add_hashes_from_input<R: Read>(
+        &self,
+        resource: &mut Resource,
+        input: &mut R,
+    ) -> Result<(), ResourceError> {
+        let mut hashers: Vec<_> = self
+            .with_hashes
+            .iter()
+            .map(|algorithm| match algorithm.as_str() {
+                "md5" => Md5::new(),
                 _ => panic!(), // execute() must be fixed
+            })
+            .collect();
+        let mut buf = vec![0u8; HASH_CHUNK_SIZE];
+        loop {
+            let n = match input.read(&mut buf) {
+                Ok(0) => break,
+                Ok(n) => n,
+                Err(ref err) if err.kind() == io::ErrorKind::Interrupted => continue,
+                Err(err) => return Err(err.into()),
             };
+            for hasher in &mut hashers {
+                hasher.input(&buf[..n]);
+            }
+        }
+        for (algorithm, hasher) in self.with_hashes.iter().zip(hashers) {
             let prop = "hash_".to_owned() + algorithm;
-            resource.set_property(&prop, hash);
+            resource.set_property(&prop, hex::encode(hasher.result()));
         }
         Ok(())
     }
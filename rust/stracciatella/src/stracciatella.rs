@@ -194,6 +194,57 @@ mod tests {
         assert_eq!(engine_options.resolution.1, 960);
     }
 
+    #[test]
+    fn parse_args_should_return_the_correct_tile_cache_size() {
+        let mut engine_options = EngineOptions::default();
+        let input = vec![
+            String::from("ja2"),
+            String::from("--tilecache"),
+            String::from("128"),
+        ];
+        assert_eq!(parse_args(&mut engine_options, &input), None);
+        assert_eq!(engine_options.tile_cache_size, 128);
+    }
+
+    #[test]
+    fn parse_args_should_return_the_replay_options() {
+        let mut engine_options = EngineOptions::default();
+        let input = vec![
+            String::from("ja2"),
+            String::from("--replay"),
+            String::from("bench.rec"),
+            String::from("--replaynorender"),
+        ];
+        assert_eq!(parse_args(&mut engine_options, &input), None);
+        assert_eq!(engine_options.replay_input, PathBuf::from("bench.rec"));
+        assert!(engine_options.replay_without_rendering);
+        assert_eq!(engine_options.record_input, PathBuf::from(""));
+    }
+
+    #[test]
+    fn parse_args_should_return_the_benchmark_option() {
+        let mut engine_options = EngineOptions::default();
+        let input = vec![String::from("ja2"), String::from("--benchmark")];
+        assert_eq!(parse_args(&mut engine_options, &input), None);
+        assert!(engine_options.run_benchmarks);
+    }
+
+    #[test]
+    fn parse_args_should_fail_to_record_and_replay_at_once() {
+        let mut engine_options = EngineOptions::default();
+        let input = vec![
+            String::from("ja2"),
+            String::from("--record"),
+            String::from("a.rec"),
+            String::from("--replay"),
+            String::from("b.rec"),
+        ];
+        assert_eq!(
+            parse_args(&mut engine_options, &input),
+            Some(String::from("Cannot record and replay at the same time."))
+        );
+    }
+
     #[test]
     #[cfg(target_os = "macos")]
     fn parse_args_should_return_the_correct_canonical_game_dir_on_mac() {
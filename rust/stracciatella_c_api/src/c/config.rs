@@ -250,6 +250,66 @@ pub extern "C" fn EngineOptions_setStartWithoutSound(ptr: *mut EngineOptions, va
     engine_options.start_without_sound = val
 }
 
+/// Gets `EngineOptions.gpu_compositing`.
+#[no_mangle]
+pub extern "C" fn EngineOptions_shouldUseGPUCompositing(ptr: *const EngineOptions) -> bool {
+    let engine_options = unsafe_ref(ptr);
+    engine_options.gpu_compositing
+}
+
+/// Gets `EngineOptions.hardware_cursor`.
+#[no_mangle]
+pub extern "C" fn EngineOptions_shouldUseHardwareCursor(ptr: *const EngineOptions) -> bool {
+    let engine_options = unsafe_ref(ptr);
+    engine_options.hardware_cursor
+}
+
+/// Gets `EngineOptions.frame_pacing`.
+#[no_mangle]
+pub extern "C" fn EngineOptions_shouldPaceFrames(ptr: *const EngineOptions) -> bool {
+    let engine_options = unsafe_ref(ptr);
+    engine_options.frame_pacing
+}
+
+/// Gets `EngineOptions.tile_cache_size`.
+#[no_mangle]
+pub extern "C" fn EngineOptions_getTileCacheSize(ptr: *const EngineOptions) -> u32 {
+    let engine_options = unsafe_ref(ptr);
+    engine_options.tile_cache_size
+}
+
+/// Gets the `EngineOptions.record_input` path, empty if the input is not recorded.
+/// The caller is responsible for the returned memory.
+#[no_mangle]
+pub extern "C" fn EngineOptions_getRecordInput(ptr: *const EngineOptions) -> *mut c_char {
+    let engine_options = unsafe_ref(ptr);
+    let record_input = c_string_from_path_or_panic(&engine_options.record_input);
+    record_input.into_raw()
+}
+
+/// Gets the `EngineOptions.replay_input` path, empty if no input is replayed.
+/// The caller is responsible for the returned memory.
+#[no_mangle]
+pub extern "C" fn EngineOptions_getReplayInput(ptr: *const EngineOptions) -> *mut c_char {
+    let engine_options = unsafe_ref(ptr);
+    let replay_input = c_string_from_path_or_panic(&engine_options.replay_input);
+    replay_input.into_raw()
+}
+
+/// Gets `EngineOptions.replay_without_rendering`.
+#[no_mangle]
+pub extern "C" fn EngineOptions_shouldReplayWithoutRendering(ptr: *const EngineOptions) -> bool {
+    let engine_options = unsafe_ref(ptr);
+    engine_options.replay_without_rendering
+}
+
+/// Gets `EngineOptions.run_benchmarks`.
+#[no_mangle]
+pub extern "C" fn EngineOptions_shouldRunBenchmarks(ptr: *const EngineOptions) -> bool {
+    let engine_options = unsafe_ref(ptr);
+    engine_options.run_benchmarks
+}
+
 /// Gets the string representation of the `ScalingQuality` value.
 /// The caller is responsible for the returned memory.
 #[no_mangle]
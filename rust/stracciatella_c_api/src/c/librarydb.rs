@@ -37,7 +37,7 @@ pub extern "C" fn LibraryDB_push(
     let library = path_from_c_str_or_panic(unsafe_c_str(library));
     match ldb.add_library(data_dir, library) {
         Err(err) => {
-            remember_rust_error(format!("{:?}", err));
+            remember_rust_error_fmt(format_args!("{:?}", err));
             false
         }
         Ok(_) => {
@@ -47,6 +47,37 @@ pub extern "C" fn LibraryDB_push(
     }
 }
 
+/// Gets the number of libraries in the library database.
+#[no_mangle]
+pub extern "C" fn LibraryDB_getNumberOfLibraries(ldb: *const LibraryDB) -> size_t {
+    let ldb = unsafe_ref(ldb);
+    ldb.lookup_hits().len()
+}
+
+/// Gets the number of files opened from the library at `index`.
+/// Returns 0 if there is no such library.
+#[no_mangle]
+pub extern "C" fn LibraryDB_getLookupHits(ldb: *const LibraryDB, index: size_t) -> u64 {
+    let ldb = unsafe_ref(ldb);
+    ldb.lookup_hits().get(index).cloned().unwrap_or(0)
+}
+
+/// Gets the number of paths that were not found in any library.
+#[no_mangle]
+pub extern "C" fn LibraryDB_getLookupMisses(ldb: *const LibraryDB) -> u64 {
+    let ldb = unsafe_ref(ldb);
+    ldb.lookup_misses()
+}
+
+/// Returns true if a library in the library database contains the file.
+/// Does not allocate for most paths, nor set the rust error.
+#[no_mangle]
+pub extern "C" fn LibraryDB_containsFile(ldb: *const LibraryDB, path: *const c_char) -> bool {
+    let ldb = unsafe_ref(ldb);
+    let path = str_from_c_str_or_panic(unsafe_c_str(path));
+    ldb.contains_file(&path)
+}
+
 /// Opens a library database file for reading.
 /// Returns the file on success and null on error.
 /// The caller is responsible for the library file memory.
@@ -57,7 +88,7 @@ pub extern "C" fn LibraryFile_open(ldb: *mut LibraryDB, path: *const c_char) ->
     let path = str_from_c_str_or_panic(unsafe_c_str(path));
     match ldb.open_file(&path) {
         Err(err) => {
-            remember_rust_error(format!("{:?}", err));
+            remember_rust_error_fmt(format_args!("{:?}", err));
             std::ptr::null_mut()
         }
         Ok(file) => {
@@ -88,7 +119,7 @@ pub extern "C" fn LibraryFile_seek(file: *mut LibraryFile, distance: i64, from:
     };
     match seek_result {
         Err(err) => {
-            remember_rust_error(format!("{:?}", err));
+            remember_rust_error_fmt(format_args!("{:?}", err));
             false
         }
         Ok(_) => {
@@ -110,7 +141,7 @@ pub extern "C" fn LibraryFile_read(
     let buffer = unsafe_slice_mut(buffer, buffer_length);
     match file.read_exact(buffer) {
         Err(err) => {
-            remember_rust_error(format!("{:?}", err));
+            remember_rust_error_fmt(format_args!("{:?}", err));
             false
         }
         Ok(_) => {
@@ -133,3 +164,25 @@ pub extern "C" fn LibraryFile_getSize(file: *mut LibraryFile) -> u64 {
     let file = unsafe_mut(file);
     file.file_size()
 }
+
+/// Gets the data of a library database file if its library is memory mapped.
+/// Returns null if it is not mapped.
+/// The data stays valid until the file is closed.
+#[no_mangle]
+pub extern "C" fn LibraryFile_getMappedData(
+    file: *const LibraryFile,
+    length: *mut size_t,
+) -> *const u8 {
+    let file = unsafe_ref(file);
+    let length = unsafe_mut(length);
+    match file.mapped_data() {
+        Some(data) => {
+            *length = data.len();
+            data.as_ptr()
+        }
+        None => {
+            *length = 0;
+            std::ptr::null()
+        }
+    }
+}
@@ -44,6 +44,9 @@ pub(crate) mod common {
 
     use std::cell::RefCell;
     use std::ffi::{CStr, CString};
+    use std::fmt;
+    use std::io::Write;
+    use std::mem;
     use std::path::Path;
     use std::slice;
 
@@ -51,23 +54,47 @@ pub(crate) mod common {
 
     thread_local!(
         /// A thread local error for C.
-        pub static RUST_ERROR: RefCell<Option<CString>> = RefCell::new(None)
+        pub static RUST_ERROR: RefCell<Option<CString>> = RefCell::new(None);
+        /// The memory of the last forgotten error, reused by the next error.
+        static RUST_ERROR_BUFFER: RefCell<Vec<u8>> = RefCell::new(Vec::new())
     );
 
     /// Sets the thread local error string for C.
     pub fn remember_rust_error<T: AsRef<str>>(msg: T) {
+        remember_rust_error_fmt(format_args!("{}", msg.as_ref()));
+    }
+
+    /// Sets the thread local error string for C from format arguments.
+    /// Discards characters starting with the first nul character.
+    /// The memory of the previous error is reused, so an error that happens over and over does not allocate.
+    pub fn remember_rust_error_fmt(args: fmt::Arguments) {
+        let mut bytes = RUST_ERROR
+            .with(|x| x.borrow_mut().take())
+            .map(CString::into_bytes)
+            .unwrap_or_else(|| {
+                RUST_ERROR_BUFFER.with(|x| mem::replace(&mut *x.borrow_mut(), Vec::new()))
+            });
+        bytes.clear();
+        let _ = bytes.write_fmt(args); // writing to a Vec does not fail
+        if let Some(pos) = bytes.iter().position(|x| *x == 0) {
+            bytes.truncate(pos);
+        }
+        let error = unsafe { CString::from_vec_unchecked(bytes) };
         RUST_ERROR.with(|x| {
-            let mut error = x.borrow_mut();
-            *error = Some(c_string_from_str(msg.as_ref()));
+            let mut rust_error = x.borrow_mut();
+            *rust_error = Some(error);
         });
     }
 
     /// Unsets the thread local error string for C.
+    /// Keeps its memory for the next error.
     pub fn forget_rust_error() {
-        RUST_ERROR.with(|x| {
-            let mut error = x.borrow_mut();
-            *error = None;
-        });
+        if let Some(error) = RUST_ERROR.with(|x| x.borrow_mut().take()) {
+            RUST_ERROR_BUFFER.with(|x| {
+                let mut buffer = x.borrow_mut();
+                *buffer = error.into_bytes();
+            });
+        }
     }
 
     /// Moves a value into a wrapped raw pointer. The caller is responsible for the memory.
@@ -284,5 +311,11 @@ mod tests {
         assert_eq!(error(), Some(CString::new("rust error").unwrap()));
         forget_rust_error(); // unset
         assert_eq!(error(), None);
+        remember_rust_error_fmt(format_args!("{:?} {}", "rust", 42)); // set again, reusing the memory
+        assert_eq!(error(), Some(CString::new("\"rust\" 42").unwrap()));
+        remember_rust_error("short\0nope"); // replace
+        assert_eq!(error(), Some(CString::new("short").unwrap()));
+        forget_rust_error();
+        assert_eq!(error(), None);
     }
 }
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <memory>
 #include <stdint.h>
 #include <string>
 #include <string_theory/string>
@@ -62,6 +63,14 @@ public:
 	virtual bool doesGameResExists(char const* filename) const = 0;
 	virtual bool doesGameResExists(const std::string &filename) const = 0;
 
+	/** Start or stop remembering the names of the game resources which are
+	 * opened, e.g. to read them ahead at the next start. Only for use by the
+	 * main thread. */
+	virtual void recordGameResOpens(bool record) = 0;
+
+	/** Get the remembered names, in the order they were first opened. */
+	virtual const std::vector<std::string>& getRecordedGameRes() const = 0;
+
 	/** Get folder for screenshots. */
 	virtual std::string getScreenshotFolder() const = 0;
 
@@ -76,14 +85,26 @@ public:
 
 	virtual void loadEncryptedString(SGPFile* const File, wchar_t* DestString, uint32_t const seek_chars, uint32_t const read_chars) const = 0;
 
-	/** Load dialogue quote from file. */
-	virtual ST::string* loadDialogQuoteFromFile(const char* filename, int quote_number) = 0;
+	/** Get a dialogue quote from file. All quotes of the file are loaded the
+	 * first time one of them is needed and kept until the content manager is
+	 * destroyed. Throws if there is no such quote. */
+	virtual const ST::string& loadDialogQuoteFromFile(const char* filename, int quote_number) = 0;
+
+	/** Read a dialogue file in the background, if its quotes are not loaded yet. */
+	virtual void preloadDialogQuotes(const char* filename) = 0;
 
 	/** Get weapons with the give index. */
 	virtual const WeaponModel* getWeapon(uint16_t index) = 0;
 	virtual const WeaponModel* getWeaponByName(const std::string &internalName) = 0;
 
+	/** Get the standard replacement of a weapon in the big gun list. The
+	 * replacements are looked up when the data is loaded. */
+	virtual const WeaponModel* getWeaponReplacement(const WeaponModel* weapon) const = 0;
+
 	virtual const MagazineModel* getMagazineByName(const std::string &internalName) = 0;
+
+	/** Get the standard replacement of a magazine in the big gun list. */
+	virtual const MagazineModel* getMagazineReplacement(const MagazineModel* mag) const = 0;
 	virtual const MagazineModel* getMagazineByItemIndex(uint16_t itemIndex) = 0;
 	virtual const std::vector<const MagazineModel*>& getMagazines() const = 0;
 
@@ -118,6 +139,15 @@ public:
 	/** Open temporary file for appending. */
 	virtual SGPFile* openTempFileForAppend(const char* filename) const = 0;
 
+	/** Create temporary file from a slice of a buffer, which is kept until the file is opened. */
+	virtual void addTempFileReference(const char* filename, std::shared_ptr<std::vector<uint8_t> const> const& buffer, size_t offset, size_t size) const = 0;
+
 	/** Delete temporary file. */
 	virtual void deleteTempFile(const char* filename) const = 0;
+
+	/** Check if temporary file exists. */
+	virtual bool doesTempFileExist(const char* filename) const = 0;
+
+	/** Delete all temporary files. */
+	virtual void deleteAllTempFiles() const = 0;
 };
@@ -16,13 +16,18 @@
 #include "game/GameState.h"
 
 #include "sgp/FileMan.h"
+#include "sgp/LoadSaveData.h"
 #include "sgp/MemMan.h"
+#include "sgp/Prefetch.h"
 #include "sgp/StrUtils.h"
+#include "sgp/TempFileStore.h"
+#include "sgp/WorkerPool.h"
 
 #include "AmmoTypeModel.h"
 #include "CalibreModel.h"
 #include "ContentMusic.h"
 #include "DealerInventory.h"
+#include "JsonCache.h"
 #include "JsonObject.h"
 #include "JsonUtility.h"
 #include "MagazineModel.h"
@@ -33,6 +38,8 @@
 
 #include "Logger.h"
 
+#include <SDL.h>
+
 #define BASEDATADIR    "data"
 
 #define MAPSDIR        "maps"
@@ -48,93 +55,148 @@
 // Boost probably provides this functionality
 #define NEW_TEMP_DIR "temp"
 
-static void LoadEncryptedData(STRING_ENC_TYPE encType, SGPFile* const File, wchar_t* DestString, UINT32 const seek_chars, UINT32 const read_chars)
+// Memory for temporary files, the rest is moved to NEW_TEMP_DIR
+#define TEMP_FILE_MEMORY_BUDGET (32 * 1024 * 1024)
+
+// The parsed data files of the last start
+#define JSON_CACHE_FILE "DataFiles.cache"
+
+/* Parses the JSON file straight from a view of its data, without copying it
+ * into a string first. */
+static rapidjson::Document& ParseJsonFile(rapidjson::Document& document, SGPFile* const f)
 {
-	FileSeek(File, seek_chars * 2, FILE_SEEK_FROM_START);
+	FileView const view(f);
+	return document.Parse<rapidjson::kParseCommentsFlag>(reinterpret_cast<char const*>(view.data()), view.size());
+}
 
-	UINT16 *Str = MALLOCN(UINT16, read_chars);
-	FileRead(File, Str, sizeof(UINT16) * read_chars);
 
-	Str[read_chars - 1] = '\0';
-	for (const UINT16* i = Str; *i != '\0'; ++i)
-	{
-		/* "Decrypt" the ROT-1 "encrypted" data */
-		wchar_t c = (*i > 33 ? *i - 1 : *i);
+#define DECODING_TABLE_SIZE 0x0480 // beyond, no character is corrected, only "decrypted"
+#define NUM_STRING_ENC_TYPES (SE_NORMAL + 1)
 
-		if(encType == SE_RUSSIAN)
-		{
-			/* The Russian data files are incorrectly encoded. The original texts seem to
-			 * be encoded in CP1251, but then they were converted from CP1252 (!) to
-			 * UTF-16 to store them in the data files. Undo this damage here. */
-			if (0xC0 <= c && c <= 0xFF) c += 0x0350;
-		}
-		else
+
+/* Decodes one character of the encrypted text of the data files. */
+static wchar_t DecodeEncryptedChar(STRING_ENC_TYPE const encType, UINT16 const raw)
+{
+	/* "Decrypt" the ROT-1 "encrypted" data */
+	wchar_t c = (raw > 33 ? raw - 1 : raw);
+
+	if(encType == SE_RUSSIAN)
+	{
+		/* The Russian data files are incorrectly encoded. The original texts seem to
+		 * be encoded in CP1251, but then they were converted from CP1252 (!) to
+		 * UTF-16 to store them in the data files. Undo this damage here. */
+		if (0xC0 <= c && c <= 0xFF) c += 0x0350;
+	}
+	else
+	{
+		if(encType == SE_ENGLISH)
 		{
-			if(encType == SE_ENGLISH)
+			/* The English data files are incorrectly encoded. The original texts seem
+			 * to be encoded in CP437, but then they were converted from CP1252 (!) to
+			 * UTF-16 to store them in the data files. Undo this damage here. This
+			 * problem only occurs for a few lines by Malice. */
+			switch (c)
 			{
-				/* The English data files are incorrectly encoded. The original texts seem
-				 * to be encoded in CP437, but then they were converted from CP1252 (!) to
-				 * UTF-16 to store them in the data files. Undo this damage here. This
-				 * problem only occurs for a few lines by Malice. */
-				switch (c)
-				{
-					case 128: c = 0x00C7; break; // Ç
-					case 130: c = 0x00E9; break; // é
-					case 135: c = 0x00E7; break; // ç
-				}
+				case 128: c = 0x00C7; break; // Ç
+				case 130: c = 0x00E9; break; // é
+				case 135: c = 0x00E7; break; // ç
 			}
-			else if(encType == SE_POLISH)
+		}
+		else if(encType == SE_POLISH)
+		{
+			/* The Polish data files are incorrectly encoded. The original texts seem to
+			 * be encoded in CP1250, but then they were converted from CP1252 (!) to
+			 * UTF-16 to store them in the data files. Undo this damage here.
+			 * Also the format code for centering texts differs. */
+			switch (c)
 			{
-				/* The Polish data files are incorrectly encoded. The original texts seem to
-				 * be encoded in CP1250, but then they were converted from CP1252 (!) to
-				 * UTF-16 to store them in the data files. Undo this damage here.
-				 * Also the format code for centering texts differs. */
-				switch (c)
-				{
-					case 143: c = 0x0179; break;
-					case 163: c = 0x0141; break;
-					case 165: c = 0x0104; break;
-					case 175: c = 0x017B; break;
-					case 179: c = 0x0142; break;
-					case 182: c = 179;    break; // not a char, but a format code (centering)
-					case 185: c = 0x0105; break;
-					case 191: c = 0x017C; break;
-					case 198: c = 0x0106; break;
-					case 202: c = 0x0118; break;
-					case 209: c = 0x0143; break;
-					case 230: c = 0x0107; break;
-					case 234: c = 0x0119; break;
-					case 241: c = 0x0144; break;
-					case 338: c = 0x015A; break;
-					case 339: c = 0x015B; break;
-					case 376: c = 0x017A; break;
-				}
+				case 143: c = 0x0179; break;
+				case 163: c = 0x0141; break;
+				case 165: c = 0x0104; break;
+				case 175: c = 0x017B; break;
+				case 179: c = 0x0142; break;
+				case 182: c = 179;    break; // not a char, but a format code (centering)
+				case 185: c = 0x0105; break;
+				case 191: c = 0x017C; break;
+				case 198: c = 0x0106; break;
+				case 202: c = 0x0118; break;
+				case 209: c = 0x0143; break;
+				case 230: c = 0x0107; break;
+				case 234: c = 0x0119; break;
+				case 241: c = 0x0144; break;
+				case 338: c = 0x015A; break;
+				case 339: c = 0x015B; break;
+				case 376: c = 0x017A; break;
 			}
+		}
 
-			/* Cyrillic texts (by Ivan Dolvich) in the non-Russian versions are encoded
-			 * in some wild manner. Undo this damage here. */
-			if (0x044D <= c && c <= 0x0452) // cyrillic A to IE
-			{
-				c += -0x044D + 0x0410;
-			}
-			else if (c == 0x0453) // cyrillic IO
-			{
-				c = 0x0401;
-			}
-			else if (0x0454 <= c && c <= 0x0467) // cyrillic ZHE to SHCHA
-			{
-				c += -0x0454 + 0x0416;
-			}
-			else if (0x0468 <= c && c <= 0x046C) // cyrillic YERU to YA
+		/* Cyrillic texts (by Ivan Dolvich) in the non-Russian versions are encoded
+		 * in some wild manner. Undo this damage here. */
+		if (0x044D <= c && c <= 0x0452) // cyrillic A to IE
+		{
+			c += -0x044D + 0x0410;
+		}
+		else if (c == 0x0453) // cyrillic IO
+		{
+			c = 0x0401;
+		}
+		else if (0x0454 <= c && c <= 0x0467) // cyrillic ZHE to SHCHA
+		{
+			c += -0x0454 + 0x0416;
+		}
+		else if (0x0468 <= c && c <= 0x046C) // cyrillic YERU to YA
+		{
+			c += -0x0468 + 0x042B;
+		}
+	}
+
+	return c;
+}
+
+
+/* Every character the corrections touch, decoded for each encoding. Built once,
+ * so decoding text is a lookup per character. */
+struct DecodingTables
+{
+	UINT16 table[NUM_STRING_ENC_TYPES][DECODING_TABLE_SIZE];
+
+	DecodingTables()
+	{
+		for (int e = 0; e != NUM_STRING_ENC_TYPES; ++e)
+		{
+			for (UINT16 raw = 0; raw != DECODING_TABLE_SIZE; ++raw)
 			{
-				c += -0x0468 + 0x042B;
+				table[e][raw] = static_cast<UINT16>(DecodeEncryptedChar(static_cast<STRING_ENC_TYPE>(e), raw));
 			}
 		}
+	}
+};
+
 
-		*DestString++ = c;
+/* Decodes the encrypted text up to its first 0, at most n - 1 characters, and
+ * terminates it. */
+template<typename T> static void DecodeEncryptedText(STRING_ENC_TYPE const encType, BYTE const* const src, size_t const n, T* dst)
+{
+	static DecodingTables const tables;
+	UINT16 const* const table = tables.table[encType];
+	for (size_t i = 0; i + 1 < n; ++i)
+	{
+		UINT16 raw;
+		memcpy(&raw, src + 2 * i, sizeof(raw));
+		if (raw == 0) break;
+		*dst++ = raw < DECODING_TABLE_SIZE ? table[raw] : DecodeEncryptedChar(encType, raw);
 	}
-	*DestString = L'\0';
-	MemFree(Str);
+	*dst = 0;
+}
+
+
+static void LoadEncryptedData(STRING_ENC_TYPE encType, SGPFile* const File, wchar_t* DestString, UINT32 const seek_chars, UINT32 const read_chars)
+{
+	FileSeek(File, seek_chars * 2, FILE_SEEK_FROM_START);
+
+	SGP::Buffer<UINT16> Str(read_chars);
+	FileRead(File, Str, sizeof(UINT16) * read_chars);
+	DecodeEncryptedText(encType, reinterpret_cast<BYTE const*>(static_cast<UINT16*>(Str)), read_chars, DestString);
 }
 
 DefaultContentManager::DefaultContentManager(GameVersion gameVersion,
@@ -143,10 +205,12 @@ DefaultContentManager::DefaultContentManager(GameVersion gameVersion,
 						const std::string &externalizedDataPath
 	)
 	:m_gameVersion(gameVersion),
+	m_recordGameRes(false),
 	mNormalGunChoice(ARMY_GUN_LEVELS),
 	mExtendedGunChoice(ARMY_GUN_LEVELS),
 	m_dealersInventory(NUM_ARMS_DEALERS),
-	m_libraryDB(LibraryDB_create())
+	m_libraryDB(LibraryDB_create()),
+	m_tempFiles(new TempFileStore(NEW_TEMP_DIR, TEMP_FILE_MEMORY_BUDGET))
 {
 	/*
 	 * Searching actual paths to directories 'Data' and 'Data/Tilecache', 'Data/Maps'
@@ -218,6 +282,12 @@ void DefaultContentManager::addExtraResources(const std::string &baseDir, const
 
 DefaultContentManager::~DefaultContentManager()
 {
+	size_t const n_libraries = LibraryDB_getNumberOfLibraries(m_libraryDB.get());
+	for (size_t i = 0; i != n_libraries; ++i)
+	{
+		SLOGD("Library %u: %llu files opened", (unsigned)i, (unsigned long long)LibraryDB_getLookupHits(m_libraryDB.get(), i));
+	}
+	SLOGD("Library files not found: %llu", (unsigned long long)LibraryDB_getLookupMisses(m_libraryDB.get()));
 	m_libraryDB.reset(nullptr);
 
 	for (const ItemModel* item : m_items)
@@ -229,6 +299,7 @@ DefaultContentManager::~DefaultContentManager()
 	m_magazines.clear();
 	m_weaponMap.clear();
 	m_itemMap.clear();
+	m_replacements.clear();
 
 	for (const CalibreModel* calibre : m_calibres)
 	{
@@ -253,19 +324,6 @@ DefaultContentManager::~DefaultContentManager()
 	delete m_bobbyRayUsedInventory;
 	delete m_impPolicy;
 	delete m_gamePolicy;
-
-	for (const ST::string *str : m_newStrings)
-	{
-		delete str;
-	}
-	for (const ST::string *str : m_calibreNames)
-	{
-		delete str;
-	}
-	for (const ST::string *str : m_calibreNamesBobbyRay)
-	{
-		delete str;
-	}
 }
 
 const DealerInventory* DefaultContentManager::getBobbyRayNewInventory() const
@@ -359,34 +417,43 @@ std::vector<std::string> DefaultContentManager::getAllTilecache() const
 /** Open temporary file for writing. */
 SGPFile* DefaultContentManager::openTempFileForWriting(const char* filename, bool truncate) const
 {
-	std::string path = FileMan::joinPaths(NEW_TEMP_DIR, filename);
-	return FileMan::openForWriting(path.c_str(), truncate);
+	return m_tempFiles->openForWriting(filename, truncate);
 }
 
 /** Open temporary file for appending. */
 SGPFile* DefaultContentManager::openTempFileForAppend(const char* filename) const
 {
-	std::string path = FileMan::joinPaths(NEW_TEMP_DIR, filename);
-	return FileMan::openForAppend(path.c_str());
+	return m_tempFiles->openForAppend(filename);
 }
 
 /* Open temporary file for reading. */
 SGPFile* DefaultContentManager::openTempFileForReading(const char* filename) const
 {
-	std::string path = FileMan::joinPaths(NEW_TEMP_DIR, filename);
-
-	int         mode;
-	const char* fmode = GetFileOpenModeForReading(&mode);
+	return m_tempFiles->openForReading(filename);
+}
 
-	int d = FileMan::openFileForReading(path.c_str(), mode);
-	return FileMan::getSGPFileFromFD(d, path.c_str(), fmode);
+/** Create temporary file from a slice of a buffer. */
+void DefaultContentManager::addTempFileReference(const char* filename, std::shared_ptr<std::vector<uint8_t> const> const& buffer, size_t offset, size_t size) const
+{
+	m_tempFiles->addReference(filename, buffer, offset, size);
 }
 
 /** Delete temporary file. */
 void DefaultContentManager::deleteTempFile(const char* filename) const
 {
-	std::string path = FileMan::joinPaths(NEW_TEMP_DIR, filename);
-	FileDelete(path);
+	m_tempFiles->deleteFile(filename);
+}
+
+/** Check if temporary file exists. */
+bool DefaultContentManager::doesTempFileExist(const char* filename) const
+{
+	return m_tempFiles->exists(filename);
+}
+
+/** Delete all temporary files. */
+void DefaultContentManager::deleteAllTempFiles() const
+{
+	m_tempFiles->deleteAll();
 }
 
 /* Open a game resource file for reading.
@@ -398,6 +465,8 @@ void DefaultContentManager::deleteTempFile(const char* filename) const
  * If file is not found, try to find the file in libraries located in 'Data' directory; */
 SGPFile* DefaultContentManager::openGameResForReading(const char* filename) const
 {
+	recordGameRes(filename);
+
 	int         mode;
 	const char* fmode = GetFileOpenModeForReading(&mode);
 
@@ -458,6 +527,27 @@ SGPFile* DefaultContentManager::openGameResForReading(const std::string& filenam
 	return openGameResForReading(filename.c_str());
 }
 
+/* Starts or stops recording the game resources which are opened. */
+void DefaultContentManager::recordGameResOpens(bool const record)
+{
+	m_recordGameRes = record;
+}
+
+/* Gets the recorded game resources, in the order they were first opened. */
+const std::vector<std::string>& DefaultContentManager::getRecordedGameRes() const
+{
+	return m_recordedGameRes;
+}
+
+/* Remembers an opened game resource, if they are recorded. */
+void DefaultContentManager::recordGameRes(const char* const filename) const
+{
+	if (m_recordGameRes && m_recordedGameResSet.insert(filename).second)
+	{
+		m_recordedGameRes.push_back(filename);
+	}
+}
+
 /* Checks if a game resource exists. */
 bool DefaultContentManager::doesGameResExists(char const* filename) const
 {
@@ -475,8 +565,7 @@ bool DefaultContentManager::doesGameResExists(char const* filename) const
 			file = fopen(path, "rb");
 			if (!file)
 			{
-				RustPointer<LibraryFile> libFile(LibraryFile_open(m_libraryDB.get(), filename));
-				return static_cast<bool>(libFile);
+				return LibraryDB_containsFile(m_libraryDB.get(), filename);
 			}
 		}
 
@@ -518,28 +607,41 @@ void DefaultContentManager::loadEncryptedString(SGPFile* const File, wchar_t* De
 	LoadEncryptedData(getStringEncType(), File, DestString, seek_chars, read_chars);
 }
 
-/** Load dialogue quote from file. */
-ST::string* DefaultContentManager::loadDialogQuoteFromFile(const char* fileName, int quote_number)
+/** Get a dialogue quote from file. */
+const ST::string& DefaultContentManager::loadDialogQuoteFromFile(const char* fileName, int quote_number)
 {
-	AutoSGPFile File(openGameResForReading(fileName));
+	std::map<std::string, std::vector<ST::string> >::iterator it = m_dialogQuotes.find(fileName);
+	if (it == m_dialogQuotes.end())
+	{
+		std::vector<ST::string> quotes;
+		loadAllDialogQuotes(getStringEncType(), fileName, quotes);
+		it = m_dialogQuotes.insert(std::make_pair(std::string(fileName), std::move(quotes))).first;
+	}
+	return it->second.at(quote_number);
+}
 
-	wchar_t quote[DIALOGUESIZE];
-	LoadEncryptedData(getStringEncType(), File, quote, quote_number * DIALOGUESIZE, DIALOGUESIZE);
-	return new ST::string(quote);
+/** Read a dialogue file in the background, if its quotes are not loaded yet. */
+void DefaultContentManager::preloadDialogQuotes(const char* fileName)
+{
+	if (m_dialogQuotes.find(fileName) != m_dialogQuotes.end()) return;
+	if (!doesGameResExists(fileName)) return;
+	PrefetchFile(openGameResForReading(fileName));
 }
 
 /** Load all dialogue quotes for a character. */
-void DefaultContentManager::loadAllDialogQuotes(STRING_ENC_TYPE encType, const char* fileName, std::vector<ST::string*> &quotes) const
+void DefaultContentManager::loadAllDialogQuotes(STRING_ENC_TYPE encType, const char* fileName, std::vector<ST::string> &quotes) const
 {
+	// Decode the quotes straight from the file data into UTF-16, and make the strings once
 	AutoSGPFile File(openGameResForReading(fileName));
-	uint32_t fileSize = FileGetSize(File);
-	uint32_t numQuotes = fileSize / DIALOGUESIZE / 2;
+	FileView const view(File);
+	size_t const numQuotes = view.size() / DIALOGUESIZE / 2;
 	// SLOGI("%d quotes in dialog %s", numQuotes, fileName);
-	for(int i = 0; i < numQuotes; i++)
+	quotes.reserve(quotes.size() + numQuotes);
+	for (size_t i = 0; i != numQuotes; ++i)
 	{
-		wchar_t quote[DIALOGUESIZE];
-		LoadEncryptedData(encType, File, quote, i * DIALOGUESIZE, DIALOGUESIZE);
-		quotes.push_back(new ST::string(quote));
+		char16_t quote[DIALOGUESIZE];
+		DecodeEncryptedText(encType, view.data() + i * DIALOGUESIZE * 2, DIALOGUESIZE, quote);
+		quotes.push_back(utf16_to_string(quote, DIALOGUESIZE));
 	}
 }
 
@@ -551,23 +653,46 @@ const WeaponModel* DefaultContentManager::getWeapon(uint16_t itemIndex)
 
 const WeaponModel* DefaultContentManager::getWeaponByName(const std::string &internalName)
 {
-	std::map<std::string, const WeaponModel*>::const_iterator it = m_weaponMap.find(internalName);
-	if(it == m_weaponMap.end())
+	const WeaponModel* const weapon = m_weaponMap.find(internalName);
+	if(!weapon)
 	{
 		SLOGE("weapon '%s' is not found", internalName.c_str());
 		throw std::runtime_error(FormattedString("weapon '%s' is not found", internalName.c_str()));
 	}
-	return it->second;//m_weaponMap[internalName];
+	return weapon;
+}
+
+const WeaponModel* DefaultContentManager::getWeaponReplacement(const WeaponModel* weapon) const
+{
+	const ItemModel* const replacement = m_replacements[weapon->getItemIndex()];
+	if(!replacement)
+	{
+		SLOGE("weapon '%s' is not found", weapon->getStandardReplacement().c_str());
+		throw std::runtime_error(FormattedString("weapon '%s' is not found", weapon->getStandardReplacement().c_str()));
+	}
+	return replacement->asWeapon();
 }
 
 const MagazineModel* DefaultContentManager::getMagazineByName(const std::string &internalName)
 {
-	if(m_magazineMap.find(internalName) == m_magazineMap.end())
+	const MagazineModel* const mag = m_magazineMap.find(internalName);
+	if(!mag)
 	{
 		SLOGE("magazine '%s' is not found", internalName.c_str());
 		throw std::runtime_error(FormattedString("magazine '%s' is not found", internalName.c_str()));
 	}
-	return m_magazineMap[internalName];
+	return mag;
+}
+
+const MagazineModel* DefaultContentManager::getMagazineReplacement(const MagazineModel* mag) const
+{
+	const ItemModel* const replacement = m_replacements[mag->getItemIndex()];
+	if(!replacement)
+	{
+		SLOGE("magazine '%s' is not found", mag->getStandardReplacement().c_str());
+		throw std::runtime_error(FormattedString("magazine '%s' is not found", mag->getStandardReplacement().c_str()));
+	}
+	return replacement->asAmmo();
 }
 
 const MagazineModel* DefaultContentManager::getMagazineByItemIndex(uint16_t itemIndex)
@@ -587,12 +712,12 @@ const CalibreModel* DefaultContentManager::getCalibre(uint8_t index)
 
 const ST::string* DefaultContentManager::getCalibreName(uint8_t index) const
 {
-	return m_calibreNames[index];
+	return m_calibreNames.get(index);
 }
 
 const ST::string* DefaultContentManager::getCalibreNameForBobbyRay(uint8_t index) const
 {
-	return m_calibreNamesBobbyRay[index];
+	return m_calibreNamesBobbyRay.get(index);
 }
 
 const AmmoTypeModel* DefaultContentManager::getAmmoType(uint8_t index)
@@ -602,19 +727,16 @@ const AmmoTypeModel* DefaultContentManager::getAmmoType(uint8_t index)
 
 bool DefaultContentManager::loadWeapons()
 {
-	AutoSGPFile f(openGameResForReading("weapons.json"));
-	std::string jsonData = FileMan::fileReadText(f);
-
-	rapidjson::Document document;
-	if (document.Parse<rapidjson::kParseCommentsFlag>(jsonData.c_str()).HasParseError())
+	std::unique_ptr<rapidjson::Document> document(takeJsonDataFile("weapons.json"));
+	if (document->HasParseError())
 	{
 		SLOGE("Failed to parse weapons.json");
 		return false;
 	}
 	else
 	{
-		if(document.IsArray()) {
-			const rapidjson::Value& a = document;
+		if(document->IsArray()) {
+			const rapidjson::Value& a = *document;
 			for (rapidjson::SizeType i = 0; i < a.Size(); i++)
 			{
 				JsonObjectReader obj(a[i]);
@@ -628,7 +750,7 @@ bool DefaultContentManager::loadWeapons()
 				}
 
 				m_items[w->getItemIndex()] = w;
-				m_weaponMap.insert(std::make_pair(w->getInternalName(), w));
+				m_weaponMap.insert(w);
 			}
 		}
 	}
@@ -638,19 +760,16 @@ bool DefaultContentManager::loadWeapons()
 
 bool DefaultContentManager::loadMagazines()
 {
-	AutoSGPFile f(openGameResForReading("magazines.json"));
-	std::string jsonData = FileMan::fileReadText(f);
-
-	rapidjson::Document document;
-	if (document.Parse<rapidjson::kParseCommentsFlag>(jsonData.c_str()).HasParseError())
+	std::unique_ptr<rapidjson::Document> document(takeJsonDataFile("magazines.json"));
+	if (document->HasParseError())
 	{
 		SLOGE("Failed to parse magazines.json");
 		return false;
 	}
 	else
 	{
-		if(document.IsArray()) {
-			const rapidjson::Value& a = document;
+		if(document->IsArray()) {
+			const rapidjson::Value& a = *document;
 			for (rapidjson::SizeType i = 0; i < a.Size(); i++)
 			{
 				JsonObjectReader obj(a[i]);
@@ -665,7 +784,7 @@ bool DefaultContentManager::loadMagazines()
 
 				m_magazines.push_back(mag);
 				m_items[mag->getItemIndex()] = mag;
-				m_magazineMap.insert(std::make_pair(mag->getInternalName(), mag));
+				m_magazineMap.insert(mag);
 			}
 		}
 	}
@@ -675,19 +794,16 @@ bool DefaultContentManager::loadMagazines()
 
 bool DefaultContentManager::loadCalibres()
 {
-	AutoSGPFile f(openGameResForReading("calibres.json"));
-	std::string jsonData = FileMan::fileReadText(f);
-
-	rapidjson::Document document;
-	if (document.Parse<rapidjson::kParseCommentsFlag>(jsonData.c_str()).HasParseError())
+	std::unique_ptr<rapidjson::Document> document(takeJsonDataFile("calibres.json"));
+	if (document->HasParseError())
 	{
 		SLOGE("Failed to parse calibres.json");
 		return false;
 	}
 	else
 	{
-		if(document.IsArray()) {
-			const rapidjson::Value& a = document;
+		if(document->IsArray()) {
+			const rapidjson::Value& a = *document;
 			for (rapidjson::SizeType i = 0; i < a.Size(); i++)
 			{
 				JsonObjectReader obj(a[i]);
@@ -714,19 +830,16 @@ bool DefaultContentManager::loadCalibres()
 
 bool DefaultContentManager::loadAmmoTypes()
 {
-	AutoSGPFile f(openGameResForReading("ammo_types.json"));
-	std::string jsonData = FileMan::fileReadText(f);
-
-	rapidjson::Document document;
-	if (document.Parse<rapidjson::kParseCommentsFlag>(jsonData.c_str()).HasParseError())
+	std::unique_ptr<rapidjson::Document> document(takeJsonDataFile("ammo_types.json"));
+	if (document->HasParseError())
 	{
 		SLOGE("Failed to parse ammo_types.json");
 		return false;
 	}
 	else
 	{
-		if(document.IsArray()) {
-			const rapidjson::Value& a = document;
+		if(document->IsArray()) {
+			const rapidjson::Value& a = *document;
 			for (rapidjson::SizeType i = 0; i < a.Size(); i++)
 			{
 				JsonObjectReader obj(a[i]);
@@ -770,11 +883,9 @@ bool DefaultContentManager::loadMusicModeList(const MusicMode mode, rapidjson::V
 
 bool DefaultContentManager::loadMusic()
 {
-	AutoSGPFile f(openGameResForReading("music.json"));
-	std::string jsonData = FileMan::fileReadText(f);
-
-	rapidjson::Document document;
-	if (document.Parse<rapidjson::kParseCommentsFlag>(jsonData.c_str()).HasParseError()) {
+	std::unique_ptr<rapidjson::Document> json(takeJsonDataFile("music.json"));
+	rapidjson::Document& document = *json;
+	if (document.HasParseError()) {
 		SLOGE("Failed to parse music.json");
 		return false;
 	}
@@ -811,19 +922,16 @@ bool DefaultContentManager::readWeaponTable(
 	const char *fileName,
 	std::vector<std::vector<const WeaponModel*> > & weaponTable)
 {
-	AutoSGPFile f(openGameResForReading(fileName));
-	std::string jsonData = FileMan::fileReadText(f);
-
-	rapidjson::Document document;
-	if (document.Parse<rapidjson::kParseCommentsFlag>(jsonData.c_str()).HasParseError())
+	std::unique_ptr<rapidjson::Document> document(takeJsonDataFile(fileName));
+	if (document->HasParseError())
 	{
 		SLOGE("Failed to parse %s", fileName);
 		return false;
 	}
 
-	if(document.IsArray())
+	if(document->IsArray())
 	{
-		const rapidjson::Value& a = document;
+		const rapidjson::Value& a = *document;
 		for (rapidjson::SizeType i = 0; i < a.Size(); i++)
 		{
 			std::vector<std::string> weaponNames;
@@ -856,7 +964,13 @@ bool DefaultContentManager::loadArmyGunChoice()
 		&& readWeaponTable("army-gun-choice-extended.json", mExtendedGunChoice);
 }
 
-void DefaultContentManager::loadStringRes(const char *name, std::vector<const ST::string*> &strings) const
+void DefaultContentManager::loadStringRes(const char *name, StringTable &strings) const
+{
+	std::shared_ptr<rapidjson::Document> json(readJsonDataFile(getStringResFileName(name).c_str()));
+	strings.load(*json);
+}
+
+std::string DefaultContentManager::getStringResFileName(const char *name) const
 {
 	std::string fullName(name);
 
@@ -877,18 +991,51 @@ void DefaultContentManager::loadStringRes(const char *name, std::vector<const ST
 	}
 
 	fullName += ".json";
-	std::shared_ptr<rapidjson::Document> json(readJsonDataFile(fullName.c_str()));
-	std::vector<std::string> utf8_encoded;
-	JsonUtility::parseListStrings(*json, utf8_encoded);
-	for (const std::string &str : utf8_encoded)
-	{
-		strings.push_back(new ST::string(str));
-	}
+	return fullName;
 }
 
 /** Load the game data. */
 bool DefaultContentManager::loadGameData()
 {
+	const char* const dataFiles[] =
+	{
+		"calibres.json",
+		"ammo_types.json",
+		"magazines.json",
+		"weapons.json",
+		"army-gun-choice-normal.json",
+		"army-gun-choice-extended.json",
+		"music.json",
+		"game.json",
+		"imp.json",
+		"dealer-inventory-tony.json",
+		"dealer-inventory-frank.json",
+		"dealer-inventory-micky.json",
+		"dealer-inventory-arnie.json",
+		"dealer-inventory-perko.json",
+		"dealer-inventory-keith.json",
+		"dealer-inventory-herve-santos.json",
+		"dealer-inventory-peter-santos.json",
+		"dealer-inventory-alberto-santos.json",
+		"dealer-inventory-carlo-santos.json",
+		"dealer-inventory-jake.json",
+		"dealer-inventory-franz.json",
+		"dealer-inventory-howard.json",
+		"dealer-inventory-sam.json",
+		"dealer-inventory-fredo.json",
+		"dealer-inventory-gabby.json",
+		"dealer-inventory-devin.json",
+		"dealer-inventory-elgin.json",
+		"dealer-inventory-manny.json",
+		"bobby-ray-inventory-new.json",
+		"bobby-ray-inventory-used.json"
+	};
+	std::vector<std::string> fileNames(std::begin(dataFiles), std::end(dataFiles));
+	fileNames.push_back(getStringResFileName("strings/ammo-calibre"));
+	fileNames.push_back(getStringResFileName("strings/ammo-calibre-bobbyray"));
+	fileNames.push_back(getStringResFileName("strings/new-strings"));
+	parseJsonDataFiles(fileNames);
+
 	createAllHardcodedItemModels(m_items);
 
 	bool result = loadCalibres()
@@ -900,8 +1047,9 @@ bool DefaultContentManager::loadGameData()
 
 	for (const ItemModel *item : m_items)
 	{
-		m_itemMap.insert(std::make_pair(item->getInternalName(), item));
+		m_itemMap.insert(item);
 	}
+	resolveReplacements();
 
 	loadAllDealersInventory();
 
@@ -916,16 +1064,139 @@ bool DefaultContentManager::loadGameData()
 
 	loadStringRes("strings/new-strings", m_newStrings);
 
+	// Whatever was not loaded because of an error
+	m_parsedJson.clear();
+
+	SLOGI("Name indexes: %u items (%u slots, %u lookups, %u probes), %u weapons (%u slots, %u lookups, %u probes), %u magazines (%u slots, %u lookups, %u probes)",
+		static_cast<UINT>(m_itemMap.size()), static_cast<UINT>(m_itemMap.capacity()), static_cast<UINT>(m_itemMap.lookups()), static_cast<UINT>(m_itemMap.probes()),
+		static_cast<UINT>(m_weaponMap.size()), static_cast<UINT>(m_weaponMap.capacity()), static_cast<UINT>(m_weaponMap.lookups()), static_cast<UINT>(m_weaponMap.probes()),
+		static_cast<UINT>(m_magazineMap.size()), static_cast<UINT>(m_magazineMap.capacity()), static_cast<UINT>(m_magazineMap.lookups()), static_cast<UINT>(m_magazineMap.probes()));
+
 	return result;
 }
 
-rapidjson::Document* DefaultContentManager::readJsonDataFile(const char *fileName) const
+namespace
+{
+	/* A data file parsed by parseJsonDataFiles(). It is read on the main thread,
+	 * because the content manager opens files, and parsed on the worker pool. */
+	struct JsonDataFile
+	{
+		std::string                          name;
+		AutoSGPFile                          file;
+		std::unique_ptr<FileView>            view;
+		std::unique_ptr<rapidjson::Document> document;
+		uint64_t                             read_ticks;
+		uint64_t                             parse_ticks;
+	};
+}
+
+static void ParseJsonDataFile(UINT const i, void* const ctx)
+{
+	JsonDataFile& f = *static_cast<std::unique_ptr<JsonDataFile>*>(ctx)[i];
+	uint64_t const start = SDL_GetPerformanceCounter();
+	f.document.reset(new rapidjson::Document());
+	f.document->Parse<rapidjson::kParseCommentsFlag>(reinterpret_cast<char const*>(f.view->data()), f.view->size());
+	f.parse_ticks = SDL_GetPerformanceCounter() - start;
+}
+
+void DefaultContentManager::parseJsonDataFiles(const std::vector<std::string> &fileNames)
+{
+	uint64_t const start = SDL_GetPerformanceCounter();
+
+	std::vector<std::unique_ptr<JsonDataFile> > files;
+	for (const std::string &name : fileNames)
+	{
+		uint64_t const read_start = SDL_GetPerformanceCounter();
+		std::unique_ptr<JsonDataFile> f(new JsonDataFile());
+		f->name = name;
+		try
+		{
+			f->file = openGameResForReading(name);
+			f->view.reset(new FileView(f->file));
+		}
+		catch (const std::exception &)
+		{
+			// The loader of the file runs into this again and reports it
+			continue;
+		}
+		f->read_ticks = SDL_GetPerformanceCounter() - read_start;
+		files.push_back(std::move(f));
+	}
+
+	// The cache is only good for the very same data files, mods included
+	uint64_t key = JSON_CACHE_KEY_SEED;
+	for (const std::unique_ptr<JsonDataFile> &f : files)
+	{
+		key = HashJsonCacheSource(key, f->name, f->view->data(), f->view->size());
+	}
+
+	double const ms_per_tick = 1000.0 / SDL_GetPerformanceFrequency();
+	try
+	{
+		AutoSGPFile    f(openUserPrivateFileForReading(JSON_CACHE_FILE));
+		FileView const view(f);
+		JsonDocuments  cached;
+		if (DecodeJsonCache(view, key, cached) && cached.size() == files.size())
+		{
+			m_parsedJson.swap(cached);
+			SLOGI("Loaded %u data files from the cache in %.2f ms", static_cast<UINT>(files.size()), (SDL_GetPerformanceCounter() - start) * ms_per_tick);
+			return;
+		}
+		SLOGI("Ignoring the data file cache, the data files have changed");
+	}
+	catch (const std::exception &e)
+	{
+		// A missing or truncated cache just means parsing the files
+		SLOGD("No data file cache loaded: %s", e.what());
+	}
+
+	RunParallel(static_cast<UINT>(files.size()), ParseJsonDataFile, files.data());
+
+	bool parsed = true;
+	for (std::unique_ptr<JsonDataFile> &f : files)
+	{
+		SLOGD("Parsed %s in %.2f ms (read %.2f ms, %u bytes)", f->name.c_str(),
+			f->parse_ticks * ms_per_tick, f->read_ticks * ms_per_tick, static_cast<UINT>(f->view->size()));
+		if (f->document->HasParseError()) parsed = false;
+		m_parsedJson[f->name] = std::move(f->document);
+	}
+	SLOGI("Parsed %u data files in %.2f ms", static_cast<UINT>(files.size()), (SDL_GetPerformanceCounter() - start) * ms_per_tick);
+
+	// Broken files are reported by their loaders, so they are not cached
+	if (!parsed) return;
+	try
+	{
+		std::vector<BYTE> const data = EncodeJsonCache(key, m_parsedJson);
+		AutoSGPFile f(FileMan::openForWriting(JSON_CACHE_FILE));
+		FileWrite(f, data.data(), data.size());
+	}
+	catch (const std::exception &e)
+	{
+		SLOGW("Failed to write the data file cache: %s", e.what());
+	}
+}
+
+rapidjson::Document* DefaultContentManager::takeJsonDataFile(const char *fileName) const
 {
+	JsonDocuments::iterator const it = m_parsedJson.find(fileName);
+	if (it != m_parsedJson.end())
+	{
+		rapidjson::Document* const document = it->second.release();
+		m_parsedJson.erase(it);
+		return document;
+	}
+
 	AutoSGPFile f(openGameResForReading(fileName));
-	std::string jsonData = FileMan::fileReadText(f);
 
 	rapidjson::Document *document = new rapidjson::Document();
-	if (document->Parse<rapidjson::kParseCommentsFlag>(jsonData.c_str()).HasParseError())
+	ParseJsonFile(*document, f);
+	return document;
+}
+
+rapidjson::Document* DefaultContentManager::readJsonDataFile(const char *fileName) const
+{
+	rapidjson::Document *document = takeJsonDataFile(fileName);
+	if (document->HasParseError())
 	{
 		SLOGE("Failed to parse '%s'", fileName);
 		delete document;
@@ -978,13 +1249,34 @@ const ItemModel* DefaultContentManager::getItem(uint16_t itemIndex) const
 
 const ItemModel* DefaultContentManager::getItemByName(const std::string &internalName) const
 {
-	std::map<std::string, const ItemModel*>::const_iterator it = m_itemMap.find(internalName);
-	if(it == m_itemMap.end())
+	const ItemModel* const item = m_itemMap.find(internalName);
+	if(!item)
 	{
 		SLOGE("item '%s' is not found", internalName.c_str());
 		throw std::runtime_error(FormattedString("item '%s' is not found", internalName.c_str()));
 	}
-	return it->second;
+	return item;
+}
+
+void DefaultContentManager::resolveReplacements()
+{
+	m_replacements.assign(m_items.size(), NULL);
+	for (const ItemModel *item : m_items)
+	{
+		if (!item->isInBigGunList()) continue;
+
+		const ItemModel* replacement = NULL;
+		if (const WeaponModel* const weapon = item->asWeapon())
+		{
+			replacement = m_weaponMap.find(weapon->getStandardReplacement());
+		}
+		else if (const MagazineModel* const mag = item->asAmmo())
+		{
+			replacement = m_magazineMap.find(mag->getStandardReplacement());
+		}
+		// A missing replacement is reported when it is needed
+		m_replacements[item->getItemIndex()] = replacement;
+	}
 }
 
 const DealerInventory* DefaultContentManager::getDealerInventory(int dealerId) const
@@ -1012,13 +1304,11 @@ const GamePolicy* DefaultContentManager::getGamePolicy() const
 
 const ST::string* DefaultContentManager::getNewString(int stringId) const
 {
-	if(stringId >= m_newStrings.size())
+	const ST::string* const str = stringId < 0 ? NULL : m_newStrings.get(stringId);
+	if(!str)
 	{
 		SLOGE("new string %d is not found", stringId);
 		throw std::runtime_error(FormattedString("new string %d is not found", stringId));
 	}
-	else
-	{
-		return m_newStrings[stringId];
-	}
+	return str;
 }
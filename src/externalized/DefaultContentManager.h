@@ -1,6 +1,8 @@
 #pragma once
 
 #include <map>
+#include <memory>
+#include <set>
 #include <stdexcept>
 #include <string>
 #include <vector>
@@ -10,11 +12,15 @@
 #include "ContentManager.h"
 #include "ContentMusic.h"
 #include "IGameDataLoader.h"
+#include "JsonCache.h"
+#include "NameIndex.h"
+#include "StringTable.h"
 #include "StringEncodingTypes.h"
 
 #include "rapidjson/document.h"
 
 struct LibraryDB;
+class TempFileStore;
 
 class DefaultContentManager : public ContentManager, public IGameDataLoader
 {
@@ -76,9 +82,18 @@ public:
 	/** Open temporary file for appending. */
 	virtual SGPFile* openTempFileForAppend(const char* filename) const;
 
+	/** Create temporary file from a slice of a buffer, which is kept until the file is opened. */
+	virtual void addTempFileReference(const char* filename, std::shared_ptr<std::vector<uint8_t> const> const& buffer, size_t offset, size_t size) const;
+
 	/** Delete temporary file. */
 	virtual void deleteTempFile(const char* filename) const;
 
+	/** Check if temporary file exists. */
+	virtual bool doesTempFileExist(const char* filename) const;
+
+	/** Delete all temporary files. */
+	virtual void deleteAllTempFiles() const;
+
 	/** Open user's private file (e.g. saved game, settings) for reading. */
 	virtual SGPFile* openUserPrivateFileForReading(const std::string& filename) const;
 
@@ -86,6 +101,9 @@ public:
 	virtual bool doesGameResExists(char const* filename) const;
 	virtual bool doesGameResExists(const std::string &filename) const;
 
+	virtual void recordGameResOpens(bool record);
+	virtual const std::vector<std::string>& getRecordedGameRes() const;
+
 	/** Get folder for screenshots. */
 	virtual std::string getScreenshotFolder() const;
 
@@ -105,17 +123,22 @@ public:
 
 	virtual void loadEncryptedString(SGPFile* const File, wchar_t* DestString, uint32_t const seek_chars, uint32_t const read_chars) const;
 
-	/** Load dialogue quote from file. */
-	virtual ST::string* loadDialogQuoteFromFile(const char* filename, int quote_number);
+	/** Get a dialogue quote from file. */
+	virtual const ST::string& loadDialogQuoteFromFile(const char* filename, int quote_number);
+
+	/** Read a dialogue file in the background, if its quotes are not loaded yet. */
+	virtual void preloadDialogQuotes(const char* filename);
 
 	/** Load all dialogue quotes for a character. */
-	void loadAllDialogQuotes(STRING_ENC_TYPE encType, const char* filename, std::vector<ST::string*> &quotes) const;
+	void loadAllDialogQuotes(STRING_ENC_TYPE encType, const char* filename, std::vector<ST::string> &quotes) const;
 
 	/** Get weapons with the give index. */
 	virtual const WeaponModel* getWeapon(uint16_t index);
 	virtual const WeaponModel* getWeaponByName(const std::string &internalName);
+	virtual const WeaponModel* getWeaponReplacement(const WeaponModel* weapon) const;
 
 	virtual const MagazineModel* getMagazineByName(const std::string &internalName);
+	virtual const MagazineModel* getMagazineReplacement(const MagazineModel* mag) const;
 	virtual const MagazineModel* getMagazineByItemIndex(uint16_t itemIndex);
 	virtual const std::vector<const MagazineModel*>& getMagazines() const;
 
@@ -151,24 +174,35 @@ protected:
 
 	const GameVersion m_gameVersion;
 
-	std::vector<const ST::string*> m_newStrings;
+	bool m_recordGameRes;
+	mutable std::vector<std::string> m_recordedGameRes;
+	mutable std::set<std::string> m_recordedGameResSet;
+
+	/** Remember an opened game resource, if they are recorded. */
+	void recordGameRes(const char* filename) const;
+
+	StringTable m_newStrings;
 
 	std::vector<const ItemModel*> m_items;
 	std::vector<const MagazineModel*> m_magazines;
 
 	std::vector<const CalibreModel*> m_calibres;
-	std::vector<const ST::string*> m_calibreNames;
-	std::vector<const ST::string*> m_calibreNamesBobbyRay;
+	StringTable m_calibreNames;
+	StringTable m_calibreNamesBobbyRay;
 
 	std::vector<AmmoTypeModel*> m_ammoTypes;
 
 	/** Mapping of calibre names to objects. */
 	std::map<std::string, const AmmoTypeModel*> m_ammoTypeMap;
 	std::map<std::string, const CalibreModel*> m_calibreMap;
-	std::map<std::string, const MagazineModel*> m_magazineMap;
-	std::map<std::string, const WeaponModel*> m_weaponMap;
-	std::map<std::string, const ItemModel*> m_itemMap;
+	NameIndex<MagazineModel> m_magazineMap;
+	NameIndex<WeaponModel> m_weaponMap;
+	NameIndex<ItemModel> m_itemMap;
+
+	/** Standard replacements of the big gun list items by item index. */
+	std::vector<const ItemModel*> m_replacements;
 	std::map<MusicMode, const std::vector<const ST::string*>*> m_musicMap;
+	std::map<std::string, std::vector<ST::string> > m_dialogQuotes;
 
 	std::vector<std::vector<const WeaponModel*> > mNormalGunChoice;
 	std::vector<std::vector<const WeaponModel*> > mExtendedGunChoice;
@@ -181,6 +215,9 @@ protected:
 
 	RustPointer<LibraryDB> m_libraryDB;
 
+	/** Temporary files are kept in memory as long as they fit the budget. */
+	std::unique_ptr<TempFileStore> m_tempFiles;
+
 	bool loadWeapons();
 	bool loadMagazines();
 	bool loadCalibres();
@@ -191,13 +228,30 @@ protected:
 
 	const DealerInventory * loadDealerInventory(const char *fileName);
 	bool loadAllDealersInventory();
-	void loadStringRes(const char *name, std::vector<const ST::string*> &strings) const;
+	void loadStringRes(const char *name, StringTable &strings) const;
+	std::string getStringResFileName(const char *name) const;
+
+	/** Look up the standard replacements of the big gun list items. */
+	void resolveReplacements();
 
 	bool readWeaponTable(
 		const char *fileName,
 		std::vector<std::vector<const WeaponModel*> > & weaponTable);
 
+	/** Parse data files ahead of their loading, spread over the worker pool.
+	 * The documents are cached in binary form for the next start with the same
+	 * files. */
+	void parseJsonDataFiles(const std::vector<std::string> &fileNames);
+
+	/** Get a parsed data file, which may have a parse error. Files parsed ahead
+	 * are handed out once. */
+	rapidjson::Document* takeJsonDataFile(const char *fileName) const;
+
+	/** Like takeJsonDataFile(), but throws on a parse error. */
 	rapidjson::Document* readJsonDataFile(const char *fileName) const;
+
+	/** Data files parsed by parseJsonDataFiles() and not taken yet. */
+	mutable JsonDocuments m_parsedJson;
 };
 
 class LibraryFileNotFoundException : public std::runtime_error
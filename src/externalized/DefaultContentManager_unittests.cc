@@ -22,9 +22,10 @@ TEST(TempFiles, createFile)
 		AutoSGPFile file(cm->openTempFileForWriting("foo.txt", true));
 	}
 
+	// Small temp files are kept in memory
+	ASSERT_EQ(cm->doesTempFileExist("foo.txt"), true);
 	std::vector<std::string> results = FindFilesInDir(TMPDIR, ".txt", false, false);
-	ASSERT_EQ(results.size(), 1u);
-	EXPECT_STREQ(results[0].c_str(), TMPDIR PS "foo.txt");
+	ASSERT_EQ(results.size(), 0u);
 
 	boost::filesystem::remove_all(TMPDIR);
 	delete cm;
@@ -117,13 +118,12 @@ TEST(TempFiles, deleteFile)
 		AutoSGPFile file(cm->openTempFileForWriting("foo.txt", true));
 	}
 
-	std::vector<std::string> results = FindFilesInDir(TMPDIR, ".txt", false, false);
-	ASSERT_EQ(results.size(), 1u);
+	ASSERT_EQ(cm->doesTempFileExist("foo.txt"), true);
 
 	cm->deleteTempFile("foo.txt");
 
-	results = FindFilesInDir(TMPDIR, ".txt", false, false);
-	ASSERT_EQ(results.size(), 0u);
+	ASSERT_EQ(cm->doesTempFileExist("foo.txt"), false);
+	EXPECT_THROW(cm->openTempFileForReading("foo.txt"), std::runtime_error);
 
 	boost::filesystem::remove_all(TMPDIR);
 	delete cm;
@@ -0,0 +1,210 @@
+#include "JsonCache.h"
+
+#include "sgp/FileMan.h"
+
+#include <stdexcept>
+#include <string.h>
+
+
+#define JSON_CACHE_VERSION 1
+
+enum JsonCacheTag
+{
+	TAG_NULL,
+	TAG_FALSE,
+	TAG_TRUE,
+	TAG_INT,
+	TAG_UINT,
+	TAG_INT64,
+	TAG_UINT64,
+	TAG_DOUBLE,
+	TAG_STRING,
+	TAG_ARRAY,
+	TAG_OBJECT
+};
+
+/* The cache starts with this header, followed by the documents as their name
+ * and root value. A value is its tag and payload, strings are a length and the
+ * characters, arrays and objects a count and the members. */
+struct JsonCacheHeader
+{
+	char     id[4];
+	UINT32   version;
+	uint64_t key;
+	UINT32   n_documents;
+	UINT32   padding;
+};
+
+
+uint64_t HashJsonCacheSource(uint64_t key, const std::string &name, BYTE const* const data, size_t const size)
+{
+	// FNV-1a over the name, the size and the contents
+	const uint64_t prime = 1099511628211ULL;
+	for (const char c : name) key = (key ^ static_cast<BYTE>(c)) * prime;
+	for (size_t i = 0; i != sizeof(uint64_t); ++i) key = (key ^ ((static_cast<uint64_t>(size) >> (i * 8)) & 0xFF)) * prime;
+	for (size_t i = 0; i != size; ++i) key = (key ^ data[i]) * prime;
+	return key;
+}
+
+
+template<typename T> static void Put(std::vector<BYTE> &out, const T &v)
+{
+	BYTE const* const p = reinterpret_cast<BYTE const*>(&v);
+	out.insert(out.end(), p, p + sizeof(v));
+}
+
+
+static void PutString(std::vector<BYTE> &out, const char* const s, UINT32 const length)
+{
+	Put(out, length);
+	out.insert(out.end(), s, s + length);
+}
+
+
+static void PutValue(std::vector<BYTE> &out, const rapidjson::Value &v)
+{
+	switch (v.GetType())
+	{
+		case rapidjson::kNullType:  out.push_back(TAG_NULL);  break;
+		case rapidjson::kFalseType: out.push_back(TAG_FALSE); break;
+		case rapidjson::kTrueType:  out.push_back(TAG_TRUE);  break;
+
+		case rapidjson::kNumberType:
+			if      (v.IsInt())    { out.push_back(TAG_INT);    Put(out, v.GetInt());    }
+			else if (v.IsUint())   { out.push_back(TAG_UINT);   Put(out, v.GetUint());   }
+			else if (v.IsInt64())  { out.push_back(TAG_INT64);  Put(out, v.GetInt64());  }
+			else if (v.IsUint64()) { out.push_back(TAG_UINT64); Put(out, v.GetUint64()); }
+			else                   { out.push_back(TAG_DOUBLE); Put(out, v.GetDouble()); }
+			break;
+
+		case rapidjson::kStringType:
+			out.push_back(TAG_STRING);
+			PutString(out, v.GetString(), v.GetStringLength());
+			break;
+
+		case rapidjson::kArrayType:
+			out.push_back(TAG_ARRAY);
+			Put(out, static_cast<UINT32>(v.Size()));
+			for (const rapidjson::Value &e : v.GetArray()) PutValue(out, e);
+			break;
+
+		case rapidjson::kObjectType:
+			out.push_back(TAG_OBJECT);
+			Put(out, static_cast<UINT32>(v.MemberCount()));
+			for (rapidjson::Value::ConstMemberIterator i = v.MemberBegin(); i != v.MemberEnd(); ++i)
+			{
+				PutString(out, i->name.GetString(), i->name.GetStringLength());
+				PutValue(out, i->value);
+			}
+			break;
+	}
+}
+
+
+std::vector<BYTE> EncodeJsonCache(uint64_t const key, const JsonDocuments &documents)
+{
+	std::vector<BYTE> out;
+	JsonCacheHeader const header =
+	{
+		{ 'J', 'S', 'N', 'C' },
+		JSON_CACHE_VERSION,
+		key,
+		static_cast<UINT32>(documents.size()),
+		0
+	};
+	Put(out, header);
+	for (const JsonDocuments::value_type &d : documents)
+	{
+		PutString(out, d.first.c_str(), static_cast<UINT32>(d.first.size()));
+		PutValue(out, *d.second);
+	}
+	return out;
+}
+
+
+template<typename T> static T Get(FileViewReader &r)
+{
+	T v;
+	r.Read(&v, sizeof(v));
+	return v;
+}
+
+
+static void GetValue(FileViewReader &r, rapidjson::Value &v, rapidjson::Document::AllocatorType &a)
+{
+	switch (Get<BYTE>(r))
+	{
+		case TAG_NULL:   v.SetNull();                     break;
+		case TAG_FALSE:  v.SetBool(false);                break;
+		case TAG_TRUE:   v.SetBool(true);                 break;
+		case TAG_INT:    v.SetInt(Get<int>(r));           break;
+		case TAG_UINT:   v.SetUint(Get<unsigned>(r));     break;
+		case TAG_INT64:  v.SetInt64(Get<int64_t>(r));     break;
+		case TAG_UINT64: v.SetUint64(Get<uint64_t>(r));   break;
+		case TAG_DOUBLE: v.SetDouble(Get<double>(r));     break;
+
+		case TAG_STRING:
+		{
+			UINT32 const length = Get<UINT32>(r);
+			v.SetString(reinterpret_cast<const char*>(r.Take(length)), length, a);
+			break;
+		}
+
+		case TAG_ARRAY:
+		{
+			UINT32 const n = Get<UINT32>(r);
+			v.SetArray();
+			v.Reserve(n, a);
+			for (UINT32 i = 0; i != n; ++i)
+			{
+				rapidjson::Value e;
+				GetValue(r, e, a);
+				v.PushBack(e, a);
+			}
+			break;
+		}
+
+		case TAG_OBJECT:
+		{
+			UINT32 const n = Get<UINT32>(r);
+			v.SetObject();
+			for (UINT32 i = 0; i != n; ++i)
+			{
+				UINT32 const length = Get<UINT32>(r);
+				rapidjson::Value name(reinterpret_cast<const char*>(r.Take(length)), length, a);
+				rapidjson::Value e;
+				GetValue(r, e, a);
+				v.AddMember(name, e, a);
+			}
+			break;
+		}
+
+		default: throw std::runtime_error("Corrupt JSON cache");
+	}
+}
+
+
+bool DecodeJsonCache(const FileView &view, uint64_t const key, JsonDocuments &documents)
+{
+	FileViewReader r(view);
+	JsonCacheHeader const header = Get<JsonCacheHeader>(r);
+	if (memcmp(header.id, "JSNC", 4) != 0 || header.version != JSON_CACHE_VERSION || header.key != key)
+	{
+		return false;
+	}
+
+	JsonDocuments decoded;
+	for (UINT32 i = 0; i != header.n_documents; ++i)
+	{
+		UINT32 const length = Get<UINT32>(r);
+		std::string const name(reinterpret_cast<const char*>(r.Take(length)), length);
+		std::unique_ptr<rapidjson::Document> document(new rapidjson::Document());
+		GetValue(r, *document, document->GetAllocator());
+		decoded[name] = std::move(document);
+	}
+	for (JsonDocuments::value_type &d : decoded)
+	{
+		documents[d.first] = std::move(d.second);
+	}
+	return true;
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <map>
+#include <memory>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include "sgp/Types.h"
+
+#include "rapidjson/document.h"
+
+class FileView;
+
+/** Parsed JSON data files by file name. */
+typedef std::map<std::string, std::unique_ptr<rapidjson::Document> > JsonDocuments;
+
+/** Add a data file to a cache key. Start with JSON_CACHE_KEY_SEED. */
+uint64_t HashJsonCacheSource(uint64_t key, const std::string &name, BYTE const* data, size_t size);
+
+#define JSON_CACHE_KEY_SEED 14695981039346656037ULL
+
+/**
+ * Encode documents into the binary cache format. The documents are stored as
+ * typed values, so loading them back does not need to parse any text. The key
+ * says which data files the documents were parsed from.
+ */
+std::vector<BYTE> EncodeJsonCache(uint64_t key, const JsonDocuments &documents);
+
+/**
+ * Decode a cache made by EncodeJsonCache(). Returns false, without touching
+ * the documents, if the cache is of another format version or key. Throws if
+ * the cache is truncated.
+ */
+bool DecodeJsonCache(const FileView &view, uint64_t key, JsonDocuments &documents);
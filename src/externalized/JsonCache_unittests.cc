@@ -0,0 +1,63 @@
+#include "gtest/gtest.h"
+
+#include "JsonCache.h"
+#include "sgp/FileMan.h"
+
+static JsonDocuments ParseDocuments(const char* const json)
+{
+	JsonDocuments documents;
+	documents["test.json"].reset(new rapidjson::Document());
+	documents["test.json"]->Parse(json);
+	return documents;
+}
+
+static bool DecodeBuffer(const std::vector<BYTE> &data, uint64_t key, JsonDocuments &documents)
+{
+	std::shared_ptr<std::vector<BYTE> > const buffer(new std::vector<BYTE>(data));
+	AutoSGPFile f(FileMan::openInMemory(buffer, std::function<void()>()));
+	FileView const view(f);
+	return DecodeJsonCache(view, key, documents);
+}
+
+TEST(JsonCacheTest, roundTrip)
+{
+	const char* const json = "[{\"internalName\": \"GLOCK_17\", \"ubImpact\": 21, \"big\": 5000000000,"
+		" \"negative\": -3, \"rate\": 0.25, \"flag\": true, \"none\": null, \"list\": [\"a\", false, []]}, {}]";
+	JsonDocuments const source = ParseDocuments(json);
+	std::vector<BYTE> const data = EncodeJsonCache(42, source);
+
+	JsonDocuments decoded;
+	ASSERT_TRUE(DecodeBuffer(data, 42, decoded));
+	ASSERT_EQ(decoded.size(), 1u);
+	const rapidjson::Document &d = *decoded["test.json"];
+	ASSERT_FALSE(d.HasParseError());
+	ASSERT_TRUE(d == *source.at("test.json"));
+	ASSERT_STREQ(d[0]["internalName"].GetString(), "GLOCK_17");
+	ASSERT_EQ(d[0]["ubImpact"].GetInt(), 21);
+	ASSERT_EQ(d[0]["big"].GetUint64(), 5000000000u);
+	ASSERT_EQ(d[0]["negative"].GetInt(), -3);
+	ASSERT_EQ(d[0]["rate"].GetDouble(), 0.25);
+}
+
+TEST(JsonCacheTest, otherKey)
+{
+	std::vector<BYTE> const data = EncodeJsonCache(42, ParseDocuments("[1]"));
+
+	JsonDocuments decoded;
+	ASSERT_FALSE(DecodeBuffer(data, 43, decoded));
+	ASSERT_TRUE(decoded.empty());
+
+	std::vector<BYTE> truncated(data.begin(), data.end() - 1);
+	ASSERT_THROW(DecodeBuffer(truncated, 42, decoded), std::runtime_error);
+	ASSERT_TRUE(decoded.empty());
+}
+
+TEST(JsonCacheTest, keyDependsOnContents)
+{
+	const BYTE a[] = { '[', '1', ']' };
+	const BYTE b[] = { '[', '2', ']' };
+	uint64_t const key = HashJsonCacheSource(JSON_CACHE_KEY_SEED, "test.json", a, sizeof(a));
+	ASSERT_EQ(key, HashJsonCacheSource(JSON_CACHE_KEY_SEED, "test.json", a, sizeof(a)));
+	ASSERT_NE(key, HashJsonCacheSource(JSON_CACHE_KEY_SEED, "test.json", b, sizeof(b)));
+	ASSERT_NE(key, HashJsonCacheSource(JSON_CACHE_KEY_SEED, "other.json", a, sizeof(a)));
+}
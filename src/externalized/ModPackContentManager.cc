@@ -2,6 +2,7 @@
 
 #include "JsonUtility.h"
 #include "sgp/FileMan.h"
+#include "sgp/Prefetch.h"
 
 #include "Logger.h"
 
@@ -50,6 +51,7 @@ SGPFile* ModPackContentManager::openGameResForReading(const char* filename) cons
 		int d = FileMan::openFileCaseInsensitive(folder, filename, mode);
 		if (d >= 0) {
 			SLOGI("opening mod's resource: %s", filename);
+			recordGameRes(filename);
 			return FileMan::getSGPFileFromFD(d, filename, fmode);
 		}
 	}
@@ -73,15 +75,14 @@ std::string ModPackContentManager::getSavedGamesFolder() const
 	return FileMan::joinPaths(m_configFolder, folderName);
 }
 
-/** Load dialogue quote from file. */
-ST::string* ModPackContentManager::loadDialogQuoteFromFile(const char* filename, int quote_number)
+/** Get a dialogue quote from file. */
+const ST::string& ModPackContentManager::loadDialogQuoteFromFile(const char* filename, int quote_number)
 {
 	std::string jsonFileName = std::string(filename) + ".json";
-	std::map<std::string, std::vector<std::string> >::iterator it = m_dialogQuotesMap.find(jsonFileName);
+	std::map<std::string, std::vector<ST::string> >::iterator it = m_dialogQuotesMap.find(jsonFileName);
 	if(it != m_dialogQuotesMap.end())
 	{
-		SLOGD("cached quote %d %s", quote_number, jsonFileName.c_str());
-		return new ST::string(it->second[quote_number].c_str());
+		return it->second.at(quote_number);
 	}
 	else
 	{
@@ -91,8 +92,10 @@ ST::string* ModPackContentManager::loadDialogQuoteFromFile(const char* filename,
 			std::string jsonQuotes = FileMan::fileReadText(f);
 			std::vector<std::string> quotes;
 			JsonUtility::parseJsonToListStrings(jsonQuotes.c_str(), quotes);
-			m_dialogQuotesMap[jsonFileName] = quotes;
-			return new ST::string(quotes[quote_number].c_str());
+			std::vector<ST::string>& loaded = m_dialogQuotesMap[jsonFileName];
+			loaded.reserve(quotes.size());
+			for (const std::string& quote : quotes) loaded.push_back(ST::string(quote.c_str()));
+			return loaded.at(quote_number);
 		}
 		else
 		{
@@ -100,3 +103,18 @@ ST::string* ModPackContentManager::loadDialogQuoteFromFile(const char* filename,
 		}
 	}
 }
+
+/** Read a dialogue file in the background, if its quotes are not loaded yet. */
+void ModPackContentManager::preloadDialogQuotes(const char* filename)
+{
+	std::string jsonFileName = std::string(filename) + ".json";
+	if (m_dialogQuotesMap.find(jsonFileName) != m_dialogQuotesMap.end()) return;
+	if (doesGameResExists(jsonFileName.c_str()))
+	{
+		PrefetchFile(openGameResForReading(jsonFileName));
+	}
+	else
+	{
+		DefaultContentManager::preloadDialogQuotes(filename);
+	}
+}
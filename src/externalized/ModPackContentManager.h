@@ -27,11 +27,14 @@ public:
 	/** Get folder for saved games. */
 	std::string getSavedGamesFolder() const;
 
-	/** Load dialogue quote from file. */
-	virtual ST::string* loadDialogQuoteFromFile(const char* filename, int quote_number);
+	/** Get a dialogue quote from file. */
+	virtual const ST::string& loadDialogQuoteFromFile(const char* filename, int quote_number);
+
+	/** Read a dialogue file in the background, if its quotes are not loaded yet. */
+	virtual void preloadDialogQuotes(const char* filename);
 
 protected:
 	std::vector<std::string> m_modNames;
 	std::vector<std::string> m_modResFolders;
-	std::map<std::string, std::vector<std::string> > m_dialogQuotesMap;
+	std::map<std::string, std::vector<ST::string> > m_dialogQuotesMap;
 };
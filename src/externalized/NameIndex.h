@@ -0,0 +1,107 @@
+#pragma once
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+/**
+ * Flat hash index of content models by internal name.
+ *
+ * The names are not copied: a slot holds the hash and the model, and a lookup
+ * compares against the model's own getInternalName(), so the models have to
+ * outlive the index. Collisions are resolved by linear probing in a power of
+ * two table which is kept at most half full.
+ *
+ * Lookups and probes are counted for the load statistics. The counters are
+ * not synchronized, lookups are expected from one thread at a time.
+ */
+template<typename T>
+class NameIndex
+{
+public:
+	NameIndex() : m_size(0), m_lookups(0), m_probes(0) {}
+
+	/** Add a model under its internal name. As with std::map::insert() the first
+	 * model of a name is kept. Returns whether the model was added. */
+	bool insert(const T* model)
+	{
+		if ((m_size + 1) * 2 > m_slots.size()) grow();
+		const std::string& name = model->getInternalName();
+		const uint32_t hash = hashName(name);
+		for (size_t i = hash & (m_slots.size() - 1);; i = (i + 1) & (m_slots.size() - 1))
+		{
+			Slot& s = m_slots[i];
+			if (!s.model)
+			{
+				s.hash  = hash;
+				s.model = model;
+				++m_size;
+				return true;
+			}
+			if (s.hash == hash && s.model->getInternalName() == name) return false;
+		}
+	}
+
+	/** Get the model with the name, NULL if there is none. */
+	const T* find(const std::string& name) const
+	{
+		++m_lookups;
+		if (m_slots.empty()) return NULL;
+		const uint32_t hash = hashName(name);
+		for (size_t i = hash & (m_slots.size() - 1);; i = (i + 1) & (m_slots.size() - 1))
+		{
+			++m_probes;
+			const Slot& s = m_slots[i];
+			if (!s.model) return NULL;
+			if (s.hash == hash && s.model->getInternalName() == name) return s.model;
+		}
+	}
+
+	void clear()
+	{
+		m_slots.clear();
+		m_size = 0;
+	}
+
+	size_t   size()     const { return m_size; }
+	size_t   capacity() const { return m_slots.size(); }
+	uint64_t lookups()  const { return m_lookups; }
+	uint64_t probes()   const { return m_probes; }
+
+private:
+	struct Slot
+	{
+		uint32_t hash;
+		const T* model;
+	};
+
+	/* FNV-1a */
+	static uint32_t hashName(const std::string& name)
+	{
+		uint32_t h = 2166136261U;
+		for (const char c : name)
+		{
+			h = (h ^ static_cast<unsigned char>(c)) * 16777619U;
+		}
+		return h;
+	}
+
+	void grow()
+	{
+		std::vector<Slot> old;
+		old.swap(m_slots);
+		m_slots.resize(old.empty() ? 64 : old.size() * 2, Slot{ 0, NULL });
+		for (const Slot& s : old)
+		{
+			if (!s.model) continue;
+			size_t i = s.hash & (m_slots.size() - 1);
+			while (m_slots[i].model) i = (i + 1) & (m_slots.size() - 1);
+			m_slots[i] = s;
+		}
+	}
+
+	std::vector<Slot> m_slots;
+	size_t            m_size;
+	mutable uint64_t  m_lookups;
+	mutable uint64_t  m_probes;
+};
@@ -0,0 +1,53 @@
+#include "gtest/gtest.h"
+
+#include "NameIndex.h"
+
+#include <memory>
+
+namespace
+{
+	struct Named
+	{
+		explicit Named(const std::string &name) : name(name) {}
+		const std::string& getInternalName() const { return name; }
+		std::string name;
+	};
+}
+
+TEST(NameIndexTest, findAfterGrowing)
+{
+	std::vector<std::unique_ptr<Named> > models;
+	NameIndex<Named> index;
+	ASSERT_EQ(index.find("nothing"), nullptr);
+
+	for (int i = 0; i < 1000; i++)
+	{
+		models.emplace_back(new Named("item" + std::to_string(i)));
+		ASSERT_TRUE(index.insert(models.back().get()));
+	}
+	ASSERT_EQ(index.size(), 1000u);
+	ASSERT_GE(index.capacity(), 2000u);
+
+	for (int i = 0; i < 1000; i++)
+	{
+		ASSERT_EQ(index.find("item" + std::to_string(i)), models[i].get());
+	}
+	ASSERT_EQ(index.find("item1000"), nullptr);
+	ASSERT_EQ(index.lookups(), 1002u);
+	ASSERT_GE(index.probes(), 1001u);
+}
+
+TEST(NameIndexTest, keepsFirstOfName)
+{
+	Named first("GLOCK_17");
+	Named second("GLOCK_17");
+	NameIndex<Named> index;
+	ASSERT_TRUE(index.insert(&first));
+	ASSERT_FALSE(index.insert(&second));
+	ASSERT_EQ(index.size(), 1u);
+	ASSERT_EQ(index.find("GLOCK_17"), &first);
+
+	index.clear();
+	ASSERT_EQ(index.size(), 0u);
+	ASSERT_EQ(index.find("GLOCK_17"), nullptr);
+}
@@ -0,0 +1,39 @@
+#include "StringTable.h"
+
+
+void StringTable::load(const rapidjson::Value &list)
+{
+	m_blob.clear();
+	m_offsets.clear();
+	m_decoded.clear();
+	if (!list.IsArray()) return;
+
+	size_t length = 0;
+	for (const rapidjson::Value &s : list.GetArray())
+	{
+		if (s.IsString()) length += s.GetStringLength();
+	}
+	m_blob.reserve(length);
+	m_offsets.reserve(list.Size() + 1);
+	for (const rapidjson::Value &s : list.GetArray())
+	{
+		m_offsets.push_back(static_cast<uint32_t>(m_blob.size()));
+		if (s.IsString()) m_blob.append(s.GetString(), s.GetStringLength());
+	}
+	m_offsets.push_back(static_cast<uint32_t>(m_blob.size()));
+	m_decoded.resize(list.Size());
+}
+
+
+const ST::string* StringTable::get(size_t const index) const
+{
+	if (index >= m_decoded.size()) return NULL;
+
+	std::unique_ptr<ST::string>& s = m_decoded[index];
+	if (!s)
+	{
+		uint32_t const begin = m_offsets[index];
+		s.reset(new ST::string(m_blob.c_str() + begin, m_offsets[index + 1] - begin));
+	}
+	return s.get();
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <memory>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include <string_theory/string>
+
+#include "rapidjson/document.h"
+
+/**
+ * The strings of a string resource file, kept as one UTF-8 blob and the
+ * offsets of the strings in it. A string is only turned into an ST::string
+ * the first time it is asked for, so the tables cost little more than their
+ * text until they are used.
+ *
+ * Not synchronized, the strings are expected to be used by one thread.
+ */
+class StringTable
+{
+public:
+	/** Take the strings of a JSON list. Other values become empty strings. */
+	void load(const rapidjson::Value &list);
+
+	size_t size() const { return m_decoded.size(); }
+
+	/** Get a string, NULL if there is no such string. */
+	const ST::string* get(size_t index) const;
+
+private:
+	std::string m_blob;
+	std::vector<uint32_t> m_offsets; // one more than strings, the last is the end
+	mutable std::vector<std::unique_ptr<ST::string> > m_decoded;
+};
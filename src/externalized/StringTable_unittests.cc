@@ -0,0 +1,32 @@
+#include "gtest/gtest.h"
+
+#include "StringTable.h"
+
+TEST(StringTableTest, getStrings)
+{
+	rapidjson::Document document;
+	document.Parse("[\"foo\", \"\", \"b\\u00e4r\", 1]");
+
+	StringTable strings;
+	strings.load(document);
+	ASSERT_EQ(strings.size(), 4u);
+	ASSERT_STREQ(strings.get(0)->c_str(), "foo");
+	ASSERT_STREQ(strings.get(1)->c_str(), "");
+	ASSERT_STREQ(strings.get(2)->c_str(), "b\xC3\xA4r");
+	ASSERT_STREQ(strings.get(3)->c_str(), "");
+	ASSERT_EQ(strings.get(4), nullptr);
+
+	// Strings are decoded once
+	ASSERT_EQ(strings.get(0), strings.get(0));
+}
+
+TEST(StringTableTest, notAList)
+{
+	rapidjson::Document document;
+	document.Parse("{\"foo\": \"bar\"}");
+
+	StringTable strings;
+	strings.load(document);
+	ASSERT_EQ(strings.size(), 0u);
+	ASSERT_EQ(strings.get(0), nullptr);
+}
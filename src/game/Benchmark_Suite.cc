@@ -0,0 +1,128 @@
+#include "Benchmark_Suite.h"
+#include "Blitter_Benchmark.h"
+#include "Combat_Benchmark.h"
+#include "ContentManager.h"
+#include "GameInstance.h"
+#include "Isometric_Benchmark.h"
+#include "Logger.h"
+#include "Path_Benchmark.h"
+#include "Render_Benchmark.h"
+#include "SaveLoad_Benchmark.h"
+#include "Strategic_Benchmark.h"
+#include "Video.h"
+
+#include <map>
+#include <stdio.h>
+#include <string>
+#include <utility>
+#include <vector>
+
+
+#define BENCH_REGRESSION_PERCENT 10
+
+
+static bool                                        g_recording;
+static std::vector<std::pair<std::string, double>> g_results;
+
+
+void RecordBenchmarkResult(std::string const& name, double const value)
+{
+	if (!g_recording) return;
+	g_results.push_back(std::make_pair(name, value));
+}
+
+
+// The lines "name,value" of the file, empty if there is none
+static std::map<std::string, double> ReadBaseline(std::string const& path)
+{
+	std::map<std::string, double> baseline;
+	FILE* const f = fopen(path.c_str(), "r");
+	if (!f) return baseline;
+
+	char line[256];
+	while (fgets(line, sizeof(line), f))
+	{
+		char   name[200];
+		double value;
+		if (sscanf(line, "%199[^,],%lf", name, &value) != 2) continue;
+		baseline[name] = value;
+	}
+	fclose(f);
+	return baseline;
+}
+
+
+static void WriteBaseline(std::string const& path)
+{
+	FILE* const f = fopen(path.c_str(), "w");
+	if (!f)
+	{
+		SLOGW("Failed to write the benchmark baseline %s", path.c_str());
+		return;
+	}
+	for (auto const& r : g_results) fprintf(f, "%s,%.6f\n", r.first.c_str(), r.second);
+	fclose(f);
+}
+
+
+UINT32 RunBenchmarkSuite()
+{
+	g_results.clear();
+	g_recording = true;
+
+	// The ones which load maps first, as they need no sector to be loaded
+	BenchmarkAllMaps();
+	BenchmarkIsometricUtils();
+	BenchmarkBlitters();
+	// Sweep the camera over Omerta
+	BenchmarkTacticalRendering("A9.dat", 4);
+	BenchmarkScreenScaling(200);
+	// Then the ones which load save games and leave them loaded
+	BenchmarkSaveLoad();
+	// Simulate a month from the quick save
+	BenchmarkStrategicSimulation(0, 30);
+	// Let 16 enemies fight 16 militia in the sector of the quick save
+	BenchmarkTacticalCombat(0, 16, 50);
+
+	g_recording = false;
+
+	std::string const folder        = GCM->getScreenshotFolder();
+	std::string const baseline_path = folder + "/benchbaseline.csv";
+	std::string const path          = folder + "/benchsuite.csv";
+
+	std::map<std::string, double> const baseline = ReadBaseline(baseline_path);
+	if (baseline.empty())
+	{
+		SLOGI("Benchmark suite: no baseline yet, %u results become the baseline %s",
+			(UINT32)g_results.size(), baseline_path.c_str());
+		WriteBaseline(baseline_path);
+	}
+
+	FILE* const f = fopen(path.c_str(), "w");
+	if (!f) SLOGW("Failed to write the benchmark suite %s", path.c_str());
+	if (f) fputs("name,value,baseline,change_percent\n", f);
+
+	UINT32 n_regressions = 0;
+	for (auto const& r : g_results)
+	{
+		auto const b = baseline.find(r.first);
+		if (b == baseline.end() || b->second <= 0)
+		{
+			if (f) fprintf(f, "%s,%.6f,,\n", r.first.c_str(), r.second);
+			continue;
+		}
+
+		double const change = (r.second - b->second) * 100 / b->second;
+		if (f) fprintf(f, "%s,%.6f,%.6f,%.1f\n", r.first.c_str(), r.second, b->second, change);
+		if (change > BENCH_REGRESSION_PERCENT)
+		{
+			SLOGW("Benchmark suite: %s regressed by %.1f%%, %.3f against %.3f", r.first.c_str(), change, r.second, b->second);
+			++n_regressions;
+		}
+	}
+	if (f) fclose(f);
+
+	SLOGI("Benchmark suite: %u results, %u regressions of more than %u%%",
+		(UINT32)g_results.size(), n_regressions, BENCH_REGRESSION_PERCENT);
+	return n_regressions;
+}
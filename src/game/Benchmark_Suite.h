@@ -0,0 +1,24 @@
+#ifndef BENCHMARK_SUITE_H
+#define BENCHMARK_SUITE_H
+
+#include "Types.h"
+
+#include <string>
+
+
+/* Notes a result of a benchmark for the suite, e.g. the total time of its
+ * path searches. Lower values have to be better. Does nothing unless
+ * RunBenchmarkSuite() is running. */
+void RecordBenchmarkResult(std::string const& name, double value);
+
+/* Runs the path, isometric, blitter, rendering, screen scaling, save/load,
+ * strategic and combat benchmarks in turn, each with fixed parameters. The
+ * results they note are written to benchsuite.csv in the screenshot folder,
+ * next to the ones in benchbaseline.csv and the change against them, and
+ * results which got worse by more than BENCH_REGRESSION_PERCENT are logged as
+ * warnings. If there is no baseline yet, the results become the baseline.
+ * Returns the number of regressions. The game is left in the state the last
+ * benchmark reached, so this is only to be run from the main menu. */
+UINT32 RunBenchmarkSuite();
+
+#endif
@@ -2483,6 +2483,7 @@ try
 	{
 		LEVELNODE* const n = AddObjectToHead(pos, GOODRING1);
 		n->ubShadeLevel = DEFAULT_SHADE_LEVEL;
+		MarkMapIndexDirty(pos);
 	}
 
 	AddLightToUndoList(pos, 0);
@@ -2505,6 +2506,7 @@ BOOLEAN RemoveLight(const GridNo pos)
 {
 	// Check all lights if any at this given position
 	const char* pLastLightName = NULL;
+	SGPRect     area;
 	FOR_EACH_LIGHT_SPRITE(l)
 	{
 		if (MAPROWCOLTOPOS(l->iY, l->iX) == pos)
@@ -2512,6 +2514,18 @@ BOOLEAN RemoveLight(const GridNo pos)
 			if (!IsSoldierLight(l))
 			{
 				// Ok, it's not a merc's light so kill it!
+				SGPRect const a = LightSpriteGetArea(l);
+				if (pLastLightName == NULL)
+				{
+					area = a;
+				}
+				else
+				{
+					area.iLeft   = MIN(area.iLeft,   a.iLeft);
+					area.iTop    = MIN(area.iTop,    a.iTop);
+					area.iRight  = MAX(area.iRight,  a.iRight);
+					area.iBottom = MAX(area.iBottom, a.iBottom);
+				}
 				pLastLightName = LightSpriteGetTypeName(l);
 				LightSpritePower(l, FALSE);
 				LightSpriteDestroy(l);
@@ -2522,6 +2536,11 @@ BOOLEAN RemoveLight(const GridNo pos)
 
 	if (pLastLightName == NULL) return FALSE;
 
+	/* Erasing a light only approximately undoes where it overlaps other lights,
+	 * so relight the tiles it reached. */
+	LightSpriteRenderRect(area);
+	MarkMapIndexDirty(pos);
+
 	/* Assuming that the light naming convention doesn't change, then this
 	 * following conversion should work.  Basically, the radius values aren't
 	 * stored in the lights, so I have pull the radius out of the filename.
@@ -2660,7 +2679,7 @@ static void MapOptimize(void)
 				{
 					fChangedTail = TRUE;
 					temp = end->pPrev;
-					MemFree( end );
+					FreeLevelNode( end );
 					end = temp;
 					if ( end )
 						end->pNext = NULL;
@@ -2787,8 +2806,9 @@ static void HandleMouseClicksInGameScreen()
 				}
 			}
 
+			// RemoveLight() relit and marked the tiles it changed
 			if (iDrawMode == DRAW_MODE_LIGHT + DRAW_MODE_ERASE)
-				LightSpriteRenderAll();	// To adjust building's lighting
+				gfRenderWorld = prev_state;
 			return;
 		}
 
@@ -2830,6 +2850,8 @@ static void HandleMouseClicksInGameScreen()
 					PlaceLight(gsLightRadius, map_idx);
 					gfFirstPlacement = FALSE;
 				}
+				// PlaceLight() marked the tiles it changed
+				gfRenderWorld = prev_state;
 				break;
 
 			case DRAW_MODE_SAW_ROOM:
@@ -3286,7 +3308,25 @@ ScreenID EditScreenHandle(void)
 
 	UpdateCursorAreas();
 
+	UINT32 const structures_version = guiStructuresVersion;
 	HandleMouseClicksInGameScreen();
+	if (guiStructuresVersion != structures_version)
+	{ // Walls may block rays now or let them through, so relight around the edit
+		switch (iDrawMode)
+		{
+			case DRAW_MODE_NEWROOF:
+			case DRAW_MODE_KILL_BUILDING:
+			case DRAW_MODE_COPY_BUILDING:
+			case DRAW_MODE_MOVE_BUILDING:
+				// These change a whole building, not just the selected tiles
+				LightSpriteRenderAll();
+				break;
+
+			default:
+				LightSpriteRenderAround(gSelectRegion);
+				break;
+		}
+	}
 
 	if( !gfFirstPlacement && !gfLeftButtonState )
 		gfFirstPlacement = TRUE;
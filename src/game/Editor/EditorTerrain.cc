@@ -23,6 +23,9 @@
 #include "UILayout.h"
 #include "Random.h"
 
+#include <bitset>
+#include <vector>
+
 
 BOOLEAN gfShowTerrainTileButtons;
 UINT8 ubTerrainTileButtonWeight[NUM_TERRAIN_TILE_REGIONS];
@@ -203,43 +206,37 @@ void ChooseWeightedTerrainTile()
 
 
 UINT32 guiSearchType;
-UINT32 count, maxCount=0, calls=0;
 
 
-static void Fill(INT32 x, INT32 y)
+/* Floods the area of guiSearchType tiles around the start with the current
+ * paste. The tiles still to look at are kept on an explicit stack, as a
+ * recursion one call deep per tile overflowed the call stack on large areas,
+ * and each tile is looked at once, even if pasting failed to change its type. */
+static void Fill(INT32 const start_x, INT32 const start_y)
 {
-	INT32 iMapIndex;
-
-	count++;
-	calls++;
-
-	if( count > maxCount )
-		maxCount = count;
-
-	iMapIndex = y * WORLD_COLS + x;
-	if( !GridNoOnVisibleWorldTile( (INT16)iMapIndex ) )
+	std::bitset<WORLD_MAX> seen;
+	std::vector<INT32>     pending;
+	pending.push_back(start_y * WORLD_COLS + start_x);
+	while (!pending.empty())
 	{
-		count--;
-		return;
-	}
-	const UINT32 uiCheckType = GetTileType(gpWorldLevelData[iMapIndex].pLandHead->usIndex);
-	if( guiSearchType == uiCheckType )
+		INT32 const iMapIndex = pending.back();
+		pending.pop_back();
+		if (seen.test(iMapIndex)) continue;
+		seen.set(iMapIndex);
+
+		if( !GridNoOnVisibleWorldTile( (INT16)iMapIndex ) ) continue;
+		const UINT32 uiCheckType = GetTileType(gpWorldLevelData[iMapIndex].pLandHead->usIndex);
+		if( guiSearchType != uiCheckType ) continue;
 		PasteTextureCommon( iMapIndex );
-	else
-	{
-		count--;
-		return;
-	}
 
-	if( y > 0 )
-		Fill( x, y-1 );
-	if( y < WORLD_ROWS - 1 )
-		Fill( x, y+1 );
-	if( x > 0 )
-		Fill( x-1, y );
-	if( x < WORLD_COLS - 1 )
-		Fill( x+1, y );
-	count--;
+		INT32 const x = iMapIndex % WORLD_COLS;
+		INT32 const y = iMapIndex / WORLD_COLS;
+		// Pushed backwards, so they are taken in the order the recursion visited them
+		if( x < WORLD_COLS - 1 ) pending.push_back(iMapIndex + 1);
+		if( x > 0 )              pending.push_back(iMapIndex - 1);
+		if( y < WORLD_ROWS - 1 ) pending.push_back(iMapIndex + WORLD_COLS);
+		if( y > 0 )              pending.push_back(iMapIndex - WORLD_COLS);
+	}
 }
 
 
@@ -255,8 +252,6 @@ void TerrainFill( UINT32 iMapIndex )
 
 	ConvertGridNoToXY( (INT16)iMapIndex, &sX, &sY );
 
-	count = 0;
-
 	Fill( sX, sY );
 
 }
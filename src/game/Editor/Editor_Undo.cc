@@ -14,6 +14,8 @@
 #include "Exit_Grids.h"
 #include "MemMan.h"
 
+#include <bitset>
+
 
 /*
 Kris -- Notes on how the undo code works:
@@ -24,7 +26,7 @@ down and painting various objects in the world would all constitute a single und
 the mouse is release, then a new undo command is setup.  So, to automate this, there is a call every
 frame to DetermineUndoState().
 
-At the next level, there is a binary tree that keeps track of what map indices have been backup up in
+At the next level, there is a bitset that keeps track of what map indices have been backup up in
 the current undo command.  The whole reason to maintain this list, is to avoid multiple map elements of
 the same map index from being saved.  In the outer code, everytime something is changed, a call to
 AddToUndoList() is called, so there are many cases (especially with building/terrain smoothing) that the
@@ -32,7 +34,7 @@ same mapindex is added to the undo list.  This is also completely transparent, a
 maintained.
 
 In the outer code, there are several calls to AddToUndoList( iMapIndex ).  This function basically looks
-in the binary tree for an existing entry, and if there isn't, then the entire mapelement is saved (with
+in the bitset for an existing entry, and if there isn't, then the entire mapelement is saved (with
 the exception of the merc level ).  Lights are also supported, but there is a totally different methodology
 for accomplishing this.  The equivalent function is AddLightToUndoList( iMapIndex ).  In this case, only the
 light is saved, along with internal maintanance of several flags.
@@ -81,6 +83,7 @@ struct undo_stack
 	undo_struct							*pData;
 	undo_stack*  pNext;
 	INT32										iUndoType;
+	UINT32       uiBytes; // memory held by the saved map element
 };
 undo_stack			*gpTileUndoStack = NULL;
 
@@ -88,75 +91,22 @@ undo_stack			*gpTileUndoStack = NULL;
 BOOLEAN fNewUndoCmd = TRUE;
 BOOLEAN gfIgnoreUndoCmdsForLights = FALSE;
 
-//New pre-undo binary tree stuff
-//With this, new undo commands will not duplicate saves in the same command.  This will
-//increase speed, and save memory.
-struct MapIndexBinaryTree
-{
-	MapIndexBinaryTree* left;
-	MapIndexBinaryTree* right;
-	UINT16 usMapIndex;
-};
-
-MapIndexBinaryTree *top = NULL;
+//The map indices saved in the current undo command.  With this, new undo commands will not
+//duplicate saves in the same command.  This will increase speed, and save memory.  A tree
+//degenerated into a list when painting along a row, the bitset is a single lookup.
+static std::bitset<WORLD_MAX> g_undo_saved;
 
 
-//Recursively deletes all nodes below the node passed including itself.
-static void DeleteTreeNode(MapIndexBinaryTree** node)
-{
-	if( (*node)->left )
-		DeleteTreeNode( &((*node)->left) );
-	if( (*node)->right )
-		DeleteTreeNode( &((*node)->right) );
-	MemFree( *node );
-	*node = NULL;
-}
-
-
-//Recursively delete all nodes (from the top down).
 static void ClearUndoMapIndexTree(void)
 {
-	if( top )
-		DeleteTreeNode( &top );
+	g_undo_saved.reset();
 }
 
 
 static BOOLEAN AddMapIndexToTree(UINT16 usMapIndex)
 {
-	MapIndexBinaryTree *curr, *parent;
-	if( !top )
-	{
-		top = MALLOC(MapIndexBinaryTree);
-		top->usMapIndex = usMapIndex;
-		top->left = NULL;
-		top->right = NULL;
-		return TRUE;
-	}
-	curr = top;
-	parent = NULL;
-	//Traverse down the tree and attempt to find a matching mapindex.
-	//If one is encountered, then we fail, and don't add the mapindex to the
-	//tree.
-	while( curr )
-	{
-		parent = curr;
-		if( curr->usMapIndex == usMapIndex ) //found a match, so stop
-			return FALSE;
-		//if the mapIndex is < node's mapIndex, then go left, else right
-		curr = ( usMapIndex < curr->usMapIndex ) ? curr->left : curr->right;
-	}
-	//if we made it this far, then curr is null and parent is pointing
-	//directly above.
-	//Create the new node and fill in the information.
-	curr = MALLOC(MapIndexBinaryTree);
-	curr->usMapIndex = usMapIndex;
-	curr->left = NULL;
-	curr->right = NULL;
-	//Now link the new node to the parent.
-	if( curr->usMapIndex < parent->usMapIndex )
-		parent->left = curr;
-	else
-		parent->right = curr;
+	if (g_undo_saved.test(usMapIndex)) return FALSE;
+	g_undo_saved.set(usMapIndex);
 	return TRUE;
 }
 
@@ -207,32 +157,38 @@ static void DeleteTopStackNode(void)
 }
 
 
+/* Keeps the newest iMaxCmds commands, and of those only as many as fit into
+ * MAX_UNDO_BYTES, but always the newest one. Called when a command is started,
+ * so the walk is not repeated for every tile a large fill saves. */
 static void CropStackToMaxLength(INT32 iMaxCmds)
 {
 	INT32				iCmdCount;
 	undo_stack	*pCurrent;
+	UINT32      uiBytes;
 
 	iCmdCount = 0;
+	uiBytes   = 0;
 	pCurrent = gpTileUndoStack;
 
 	// If stack is empty, leave
 	if ( pCurrent == NULL )
 		return;
 
-	while ( (iCmdCount <= (iMaxCmds - 1)) && (pCurrent != NULL) )
+	for (;;)
 	{
+		uiBytes += pCurrent->uiBytes;
 		if ( pCurrent->iCmdCount == 1 )
+		{
 			iCmdCount++;
+			// The rest of the stack holds older commands only
+			if (iCmdCount >= iMaxCmds || uiBytes >= MAX_UNDO_BYTES) break;
+		}
+		if (pCurrent->pNext == NULL) return;
 		pCurrent = pCurrent->pNext;
 	}
 
-	// If the max number of commands was reached, and there is something
-	// to crop, from the rest of the stack, remove it.
-	if ( (iCmdCount >= iMaxCmds) && pCurrent != NULL )
-	{
-		while ( pCurrent->pNext != NULL )
-			pCurrent->pNext = DeleteStackNode(pCurrent->pNext);
-	}
+	while ( pCurrent->pNext != NULL )
+		pCurrent->pNext = DeleteStackNode(pCurrent->pNext);
 }
 
 
@@ -264,6 +220,7 @@ void AddLightToUndoList(INT32 const iMapIndex, INT32 const iLightRadius)
 	//Add to undo stack
 	SGP::PODObj<undo_stack> n;
 	n->iCmdCount    = 1;
+	n->uiBytes      = 0;
 	n->pData        = undo_info.Release();
 	n->pNext        = gpTileUndoStack;
 	gpTileUndoStack = n.Release();
@@ -307,6 +264,20 @@ BOOLEAN AddToUndoList( INT32 iMapIndex )
 static MAP_ELEMENT* CopyMapElementFromWorld(INT32 map_index);
 
 
+// The memory held by a map element saved by CopyMapElementFromWorld()
+static UINT32 SavedMapElementBytes(MAP_ELEMENT const* const me)
+{
+	UINT32 n = sizeof(*me) + sizeof(undo_struct) + sizeof(undo_stack);
+	for (STRUCTURE const* i = me->pStructureHead; i; i = i->pNext) n += sizeof(*i);
+	for (INT32 x = 0; x != 9; ++x)
+	{
+		if (x == 1 || x == 5) continue; // pLandStart and pMercLevel are not saved
+		for (LEVELNODE const* i = me->pLevelNodes[x]; i; i = i->pNext) n += sizeof(*i);
+	}
+	return n;
+}
+
+
 static void AddToUndoListCmd(INT32 const iMapIndex, INT32 const iCmdCount)
 {
 	INT32					iCoveredMapIndex;
@@ -330,9 +301,13 @@ static void AddToUndoListCmd(INT32 const iMapIndex, INT32 const iCmdCount)
 
 	pNode->pData = pUndoInfo.Release();
 	pNode->iCmdCount = iCmdCount;
+	pNode->uiBytes = SavedMapElementBytes(pData);
 	pNode->pNext = gpTileUndoStack;
 	gpTileUndoStack = pNode.Release();
 
+	// A new command may push the oldest ones out
+	if (iCmdCount == 1) CropStackToMaxLength(MAX_UNDO_COMMAND_LENGTH);
+
 	// loop through pData->pStructureHead list
 	// for each structure
 	//   find the base tile
@@ -350,8 +325,6 @@ static void AddToUndoListCmd(INT32 const iMapIndex, INT32 const iCmdCount)
 		}
 		pStructure = pStructure->pNext;
 	}
-
-	CropStackToMaxLength( MAX_UNDO_COMMAND_LENGTH );
 }
 
 
@@ -461,7 +434,7 @@ namespace
 				LEVELNODE *temp;
 				temp = pLevelNode;
 				pLevelNode = pLevelNode->pNext;
-				MemFree( temp );
+				FreeLevelNode( temp );
 			}
 		}
 		pStructure = pNewMapElement->pStructureHead;
@@ -506,7 +479,7 @@ static MAP_ELEMENT* CopyMapElementFromWorld(INT32 const map_index)
 		LEVELNODE** anchor = &new_me->pLevelNodes[x];
 		for (LEVELNODE const* i = old_me->pLevelNodes[x]; i; i = i->pNext)
 		{
-			LEVELNODE* const l = MALLOC(LEVELNODE);
+			LEVELNODE* const l = AllocLevelNode();
 			*l       = *i;
 			if (x == 0) l->pPrevNode = tail; // Land layer only
 			l->pNext = 0;
@@ -579,6 +552,9 @@ static void SwapMapElementWithWorld(INT32 const iMapIndex, MAP_ELEMENT* const pU
 	TempMapElement = *pCurrentMapElement;
 	*pCurrentMapElement = *pUndoMapElement;
 	*pUndoMapElement = TempMapElement;
+	UpdateWorldLayers(iMapIndex);
+	UpdateExitGridOfTile(iMapIndex);
+	StructuresOfTileReplaced(iMapIndex);
 }
 
 
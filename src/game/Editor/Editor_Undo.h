@@ -14,5 +14,6 @@ void DetermineUndoState(void);
 
 // Undo command flags
 #define MAX_UNDO_COMMAND_LENGTH		10
+#define MAX_UNDO_BYTES          (64 * 1024 * 1024) // older commands are dropped beyond this
 
 #endif
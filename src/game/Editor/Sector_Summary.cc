@@ -43,8 +43,10 @@
 #include "ContentManager.h"
 #include "GameInstance.h"
 #include "Logger.h"
+#include "WorkerPool.h"
 
 #include <algorithm>
+#include <vector>
 
 #define DEVINFO_DIR "../DevInfo"
 
@@ -2057,64 +2059,109 @@ static void CalculateOverrideStatus(void)
 }
 
 
-static BOOLEAN LoadSummary(const INT32 x, const INT32 y, const UINT8 level, const char* const suffix)
+static char const* const g_summary_level_suffix[8] =
 {
-	char summary_filename[40];
-	sprintf(summary_filename, DEVINFO_DIR "/%c%d%s.sum", 'A' + y, x + 1, suffix);
+	"",      // main ground level
+	"_b1",   // main B1 level
+	"_b2",   // main B2 level
+	"_b3",   // main B3 level
+	"_a",    // alternate ground level
+	"_b1_a", // alternate B1 level
+	"_b2_a", // alternate B2 level
+	"_b3_a"  // alternate B3 level
+};
+
+static BOOLEAN const g_summary_level_mask[8] =
+{
+	GROUND_LEVEL_MASK,
+	BASEMENT1_LEVEL_MASK,
+	BASEMENT2_LEVEL_MASK,
+	BASEMENT3_LEVEL_MASK,
+	ALTERNATE_GROUND_MASK,
+	ALTERNATE_B1_MASK,
+	ALTERNATE_B2_MASK,
+	ALTERNATE_B3_MASK
+};
+
+
+struct SummaryLoadJob
+{
+	bool         map_exists;
+	FLOAT        major_map_version;
+	SUMMARYFILE* sum; // NULL if there is no summary file for the map
+};
 
-	FLOAT dMajorMapVersion;
+
+/* Job i is level i % 8 of sector i / 8, the sectors row by row. Only reads the
+ * map's version and the summary file, so the jobs are independent of each
+ * other and of the game state. */
+static void ReadSummary(UINT const i, void* const ctx)
+{
+	SummaryLoadJob&   job    = static_cast<SummaryLoadJob*>(ctx)[i];
+	INT32       const x      = i / 8 % 16;
+	INT32       const y      = i / 8 / 16;
+	char const* const suffix = g_summary_level_suffix[i % 8];
+
+	job.map_exists = false;
+	job.sum        = 0;
 	{
 		char filename[40];
 		sprintf(filename, "%c%d%s.dat", 'A' + y, x + 1, suffix);
 
-		AutoSGPFile f_map;
 		try
 		{
-			f_map = GCM->openMapForReading(filename);
+			AutoSGPFile f_map(GCM->openMapForReading(filename));
+			FileRead(f_map, &job.major_map_version, sizeof(FLOAT));
 		}
 		catch (...)
 		{
-			return FALSE;
+			return;
 		}
-
-		FileRead(f_map, &dMajorMapVersion, sizeof(FLOAT));
+		job.map_exists = true;
 	}
 
+	char summary_filename[40];
+	sprintf(summary_filename, DEVINFO_DIR "/%c%d%s.sum", 'A' + y, x + 1, suffix);
 	FILE* const f_sum = fopen(summary_filename, "rb");
-	if (!f_sum)
+	if (!f_sum) return;
+
+	/* Even if the info is outdated (but existing), allocate the structure, but
+	 * indicate that the info is bad. */
+	SUMMARYFILE* const sum = MALLOC(SUMMARYFILE);
+	if (fread(sum, sizeof(SUMMARYFILE), 1, f_sum) != 1)
 	{
-		++gusNumEntriesWithOutdatedOrNoSummaryInfo;
+		// failed, initialize and force update
+		*sum = SUMMARYFILE{};
 	}
-	else
-	{
-		/* Even if the info is outdated (but existing), allocate the structure, but
-		 * indicate that the info is bad. */
-		SUMMARYFILE* const sum = MALLOC(SUMMARYFILE);
-		if (fread(sum, sizeof(SUMMARYFILE), 1, f_sum) != 1)
-		{
-			// failed, initialize and force update
-			*sum = SUMMARYFILE{};
-		}
-		fclose(f_sum);
+	fclose(f_sum);
+	job.sum = sum;
+}
 
-		if (sum->ubSummaryVersion < MINIMUMVERSION ||
-				dMajorMapVersion      < getMajorMapVersion())
-		{
-			++gusNumberOfMapsToBeForceUpdated;
-			gfMustForceUpdateAllMaps = TRUE;
-		}
-		sum->dMajorMapVersion = dMajorMapVersion;
-		UpdateSummaryInfo(sum);
 
-		SUMMARYFILE** const anchor = &gpSectorSummary[x][y][level];
-		if (*anchor) MemFree(*anchor);
-		*anchor = sum;
+static void LoadSummary(INT32 const x, INT32 const y, UINT8 const level, SummaryLoadJob const& job)
+{
+	SUMMARYFILE* const sum = job.sum;
+	if (!sum)
+	{
+		++gusNumEntriesWithOutdatedOrNoSummaryInfo;
+		return;
+	}
 
-		if (sum->ubSummaryVersion < GLOBAL_SUMMARY_VERSION)
-			++gusNumEntriesWithOutdatedOrNoSummaryInfo;
+	if (sum->ubSummaryVersion < MINIMUMVERSION ||
+			job.major_map_version < getMajorMapVersion())
+	{
+		++gusNumberOfMapsToBeForceUpdated;
+		gfMustForceUpdateAllMaps = TRUE;
 	}
+	sum->dMajorMapVersion = job.major_map_version;
+	UpdateSummaryInfo(sum);
 
-	return TRUE;
+	SUMMARYFILE** const anchor = &gpSectorSummary[x][y][level];
+	if (*anchor) MemFree(*anchor);
+	*anchor = sum;
+
+	if (sum->ubSummaryVersion < GLOBAL_SUMMARY_VERSION)
+		++gusNumEntriesWithOutdatedOrNoSummaryInfo;
 }
 
 
@@ -2137,23 +2184,25 @@ static void LoadGlobalSummary(void)
 	 * information will be stored in the gbSectorLevels array.  Also, it attempts
 	 * to load summaries for those maps.  If the summary information isn't found,
 	 * then the occurrences are recorded and reported to the user when finished to
-	 * give the option to generate them. */
+	 * give the option to generate them.  The maps and summary files are read on
+	 * the worker pool, the summaries are then taken over in order. */
+	std::vector<SummaryLoadJob> jobs(16 * 16 * 8);
+	RunParallel(static_cast<UINT>(jobs.size()), ReadSummary, &jobs[0]);
+
 	for (INT32 y = 0; y < 16; ++y)
 	{
 		for (INT32 x = 0; x < 16; ++x)
 		{
 			BOOLEAN sector_levels = 0;
-			if (LoadSummary(x, y, 0, ""))       sector_levels |= GROUND_LEVEL_MASK;     // main ground level
-			if (LoadSummary(x, y, 1, "_b1"))    sector_levels |= BASEMENT1_LEVEL_MASK;  // main B1 level
-			if (LoadSummary(x, y, 2, "_b2"))    sector_levels |= BASEMENT2_LEVEL_MASK;  // main B2 level
-			if (LoadSummary(x, y, 3, "_b3"))    sector_levels |= BASEMENT3_LEVEL_MASK;  // main B3 level
-			if (LoadSummary(x, y, 4, "_a"))     sector_levels |= ALTERNATE_GROUND_MASK; // alternate ground level
-			if (LoadSummary(x, y, 5, "_b1_a"))  sector_levels |= ALTERNATE_B1_MASK;     // alternate B1 level
-			if (LoadSummary(x, y, 6, "_b2_a"))  sector_levels |= ALTERNATE_B2_MASK;     // alternate B2 level
-			if (LoadSummary(x, y, 7, "_b3_a"))  sector_levels |= ALTERNATE_B3_MASK;     // alternate B2 level
+			for (UINT8 level = 0; level != 8; ++level)
+			{
+				SummaryLoadJob const& job = jobs[(y * 16 + x) * 8 + level];
+				if (!job.map_exists) continue;
+				LoadSummary(x, y, level, job);
+				sector_levels |= g_summary_level_mask[level];
+			}
 			gbSectorLevels[x][y] = sector_levels;
 		}
-		SLOGD("Sector Row %c complete...", y + 'A');
 	}
 
 	if (gfMustForceUpdateAllMaps)
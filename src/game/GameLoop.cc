@@ -1,8 +1,12 @@
 #include <stdexcept>
 
+#include <SDL.h>
+
+#include "BackgroundWriter.h"
 #include "GameLoop.h"
 #include "GameVersion.h"
 #include "Local.h"
+#include "Profiler.h"
 #include "SGP.h"
 #include "Screens.h"
 #include "ShopKeeper_Interface.h"
@@ -11,6 +15,7 @@
 #include "Init.h"
 #include "Music_Control.h"
 #include "Sys_Globals.h"
+#include "Timer_Control.h"
 #include "Laptop.h"
 #include "MapScreen.h"
 #include "Game_Clock.h"
@@ -32,6 +37,9 @@
 #include "UILayout.h"
 #include "GameState.h"
 #include "sgp/FileMan.h"
+#include "sgp/Prefetch.h"
+#include "ContentManager.h"
+#include "GameInstance.h"
 #include "Logger.h"
 
 ScreenID guiCurrentScreen = ERROR_SCREEN; // XXX TODO001A had no explicit initialisation
@@ -39,44 +47,156 @@ ScreenID guiPendingScreen = NO_PENDING_SCREEN;
 
 static BOOLEAN gfCheckForFreeSpaceOnHardDrive = FALSE;
 
-// The InitializeGame function is responsible for setting up all data and Gaming Engine
-// tasks which will run the game
+// Game resources which were opened by the last InitializeGame(), one per line
+#define STARTUP_FILES_CACHE "StartupFiles.cache"
 
-void InitializeGame(void)
-{
-	UINT32				uiIndex;
 
+static void InitMouseSystem()
+{
 	// Initlaize mouse subsystems
 	MSYS_Init( );
 	InitButtonSystem();
 	InitCursors( );
+}
 
-	// Init Fonts
-	InitializeFonts();
-
-	InitTacticalSave();
 
-	SLOGI("Version Label: %s", g_version_label);
-	SLOGI("Version #:     %s", g_version_number);
-
-	// Initialize Game Screens.
-	for (uiIndex = 0; uiIndex < MAX_SCREENS; uiIndex++)
+static void InitGameScreens()
+{
+	for (UINT32 uiIndex = 0; uiIndex < MAX_SCREENS; uiIndex++)
 	{
 		void (*const init)(void) = GameScreens[uiIndex].InitializeScreen;
 		if (init) init();
 	}
+}
 
-	//Init the help screen system
-	InitHelpScreenSystem();
 
+static void InitSettings()
+{
 	//Loads the saved (if any) general JA2 game settings
 	LoadGameSettings();
 
 	//Initialize the Game options ( Gun nut, scifi and dif. levels
 	InitGameOptions();
+}
 
-	// preload mapscreen graphics
-	HandlePreloadOfMapGraphics( );
+
+enum InitStepID
+{
+	INIT_MOUSE,
+	INIT_FONTS,
+	INIT_TACTICAL_SAVE,
+	INIT_SCREENS,
+	INIT_HELP_SCREEN,
+	INIT_SETTINGS,
+	INIT_MAP_GRAPHICS,
+	NUM_INIT_STEPS
+};
+
+#define AFTER(step) (1U << (step))
+
+/* The steps of InitializeGame() and the steps each of them needs to be done
+ * first. The steps run on the main thread, as they set up video objects and
+ * global state, in the order of the table, which has to respect the
+ * dependencies. The files they read are read ahead in the background. */
+struct InitStep
+{
+	const char* name;
+	void      (*init)();
+	UINT32      after;
+};
+
+static const InitStep g_init_steps[] =
+{
+	{ "mouse",         InitMouseSystem,            0                                     },
+	{ "fonts",         InitializeFonts,            0                                     },
+	{ "tactical save", InitTacticalSave,           0                                     },
+	{ "screens",       InitGameScreens,            AFTER(INIT_MOUSE) | AFTER(INIT_FONTS) },
+	{ "help screen",   InitHelpScreenSystem,       AFTER(INIT_SCREENS)                   },
+	{ "settings",      InitSettings,               AFTER(INIT_SCREENS)                   },
+	{ "map graphics",  HandlePreloadOfMapGraphics, AFTER(INIT_FONTS)                     }
+};
+static_assert(sizeof(g_init_steps) / sizeof(*g_init_steps) == NUM_INIT_STEPS, "one step per InitStepID");
+
+
+// Queue the files the last start read for reading in the background
+static void PrefetchStartupFiles()
+{
+	try
+	{
+		AutoSGPFile f(GCM->openUserPrivateFileForReading(STARTUP_FILES_CACHE));
+		std::string const text = FileMan::fileReadText(f);
+		UINT32 n = 0;
+		for (size_t start = 0; start < text.size();)
+		{
+			size_t end = text.find('\n', start);
+			if (end == std::string::npos) end = text.size();
+			std::string const name = text.substr(start, end - start);
+			start = end + 1;
+			if (name.empty() || !GCM->doesGameResExists(name)) continue;
+			PrefetchFile(GCM->openGameResForReading(name));
+			++n;
+		}
+		SLOGD("Reading %u startup files ahead", n);
+	}
+	catch (const std::exception& e)
+	{
+		// The first start or the list is gone, the steps just read the files themselves
+		SLOGD("No startup files read ahead: %s", e.what());
+	}
+}
+
+
+static void SaveStartupFiles()
+{
+	std::string text;
+	for (const std::string& name : GCM->getRecordedGameRes())
+	{
+		text += name;
+		text += '\n';
+	}
+	try
+	{
+		AutoSGPFile f(FileMan::openForWriting(STARTUP_FILES_CACHE));
+		FileWrite(f, text.data(), text.size());
+	}
+	catch (const std::exception& e)
+	{
+		SLOGW("Failed to write the startup file list: %s", e.what());
+	}
+}
+
+
+// The InitializeGame function is responsible for setting up all data and Gaming Engine
+// tasks which will run the game
+
+void InitializeGame(void)
+{
+	SLOGI("Version Label: %s", g_version_label);
+	SLOGI("Version #:     %s", g_version_number);
+
+	PrefetchStartupFiles();
+	GCM->recordGameResOpens(true);
+
+	double const   ms_per_tick = 1000.0 / SDL_GetPerformanceFrequency();
+	uint64_t const start       = SDL_GetPerformanceCounter();
+	UINT32         done        = 0;
+	for (UINT32 i = 0; i != NUM_INIT_STEPS; ++i)
+	{
+		InitStep const& step = g_init_steps[i];
+		Assert((step.after & ~done) == 0);
+
+		uint64_t const step_start = SDL_GetPerformanceCounter();
+		step.init();
+		uint64_t const step_end = SDL_GetPerformanceCounter();
+		done |= AFTER(i);
+
+		SLOGI("Startup: %-13s at %8.2f ms took %8.2f ms", step.name,
+			(step_start - start) * ms_per_tick, (step_end - step_start) * ms_per_tick);
+	}
+	SLOGI("Startup: done after %.2f ms", (SDL_GetPerformanceCounter() - start) * ms_per_tick);
+
+	GCM->recordGameResOpens(false);
+	SaveStartupFiles();
 
 	guiCurrentScreen = INIT_SCREEN;
 }
@@ -90,6 +210,9 @@ void    ShutdownGame(void)
 	// handle shutdown of game with respect to preloaded mapscreen graphics
 	HandleRemovalOfPreLoadedMapGraphics( );
 
+	// Do not quit in the middle of writing a save game
+	FinishBackgroundWrite(true);
+
 	ShutdownJA2( );
 
 	//Save the general save game settings to disk
@@ -111,15 +234,23 @@ try
 	InputAtom InputEvent;
 	ScreenID uiOldScreen = guiCurrentScreen;
 
+	PROFILE_ZONE("GameLoop");
+	ProfilerBeginFrame();
+	UpdateFixedJA2Clock();
+
 	SGPPoint MousePos;
 	GetMousePos(&MousePos);
-	// Hook into mouse stuff for MOVEMENT MESSAGES
-	MouseSystemHook(MOUSE_POS, MousePos.iX, MousePos.iY);
 	MusicPoll();
+	PollSaveGameWrite();
 
-	while (DequeueSpecificEvent(&InputEvent, MOUSE_EVENTS))
 	{
-		MouseSystemHook(InputEvent.usEvent, MousePos.iX, MousePos.iY);
+		PROFILE_SCOPE(PROFILE_INPUT);
+		// Hook into mouse stuff for MOVEMENT MESSAGES
+		MouseSystemHook(MOUSE_POS, MousePos.iX, MousePos.iY);
+		while (DequeueSpecificEvent(&InputEvent, MOUSE_EVENTS))
+		{
+			MouseSystemHook(InputEvent.usEvent, MousePos.iX, MousePos.iY);
+		}
 	}
 
 
@@ -197,7 +328,10 @@ try
 
 
 
-	uiOldScreen = (*(GameScreens[guiCurrentScreen].HandleScreen))();
+	{
+		PROFILE_SCOPE(PROFILE_SCREEN_HANDLER);
+		uiOldScreen = (*(GameScreens[guiCurrentScreen].HandleScreen))();
+	}
 
 	// if the screen has chnaged
 	if( uiOldScreen != guiCurrentScreen )
@@ -206,12 +340,26 @@ try
 		guiCurrentScreen = uiOldScreen;
 	}
 
-	RefreshScreen();
+	{
+		PROFILE_SCOPE(PROFILE_REFRESH_SCREEN);
+		// With frame pacing the main loop presents the frame
+		if (VideoFramePacing())
+		{
+			UpdateScreen();
+		}
+		else
+		{
+			RefreshScreen();
+		}
+	}
 
 	guiGameCycleCounter++;
 
 	UpdateClock();
 
+	ProfilerEndFrame();
+	PROFILE_FRAME_MARK();
+
 }
 catch (std::exception const& e)
 {
@@ -255,6 +403,27 @@ void SetPendingNewScreen(ScreenID const uiNewScreen)
 }
 
 
+bool IsGameScreenStatic()
+{
+	if (guiPendingScreen != NO_PENDING_SCREEN || gfInMsgBox) return false;
+
+	switch (guiCurrentScreen)
+	{
+		case MAINMENU_SCREEN:
+		case OPTIONS_SCREEN:
+			return true;
+
+		case LAPTOP_SCREEN:
+		case MAP_SCREEN:
+			// Only while no game time passes
+			return GamePaused();
+
+		default:
+			return false;
+	}
+}
+
+
 // Gets called when the screen changes, place any needed in code in here
 static void HandleNewScreenChange(UINT32 uiNewScreen, UINT32 uiOldScreen)
 {
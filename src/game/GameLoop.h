@@ -15,6 +15,10 @@ void HandleShortCutExitState();
 
 void SetPendingNewScreen(ScreenID);
 
+/* Whether the current screen only changes on input, e.g. the main menu, so
+ * the game cycles may be run less often while there is none. */
+bool IsGameScreenStatic();
+
 extern ScreenID guiPendingScreen;
 
 void NextLoopCheckForEnoughFreeHardDriveSpace(void);
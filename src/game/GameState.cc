@@ -26,6 +26,11 @@ bool GameState::debugging()
 	return debug;
 }
 
+bool GameState::benchmarking()
+{
+	return benchmark;
+}
+
 /** Set editor mode. */
 void GameState::setEditorMode(bool autoLoad)
 {
@@ -36,10 +41,15 @@ void GameState::setDebugging(bool enabled) {
 	debug = enabled;
 }
 
+void GameState::setBenchmarking(bool enabled) {
+	benchmark = enabled;
+}
+
 
 /** Private constructor to avoid instantiation. */
 GameState::GameState()
 	:m_mode(GAME_MODE_GAME)
 {
 	debug = false;
+	benchmark = false;
 }
@@ -23,15 +23,18 @@ public:
 	/** Set editor mode. */
 	void setEditorMode(bool autoLoad);
 	void setDebugging(bool enabled);
+	void setBenchmarking(bool enabled);
 
 	/** Check if we are in the editor mode. */
 	bool isEditorMode();
 	bool debugging();
+	bool benchmarking();
 
 private:
 
 	GameMode m_mode;
 	bool debug;
+	bool benchmark;
 
 	/** Private constructor to avoid instantiation. */
 	GameState();
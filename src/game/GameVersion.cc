@@ -22,7 +22,7 @@ char const g_version_number[16] = "Build 04.12.02";
 // Keeps track of the saved game version.  Increment the saved game version whenever
 // you will invalidate the saved game file
 
-#define SAVE_GAME_VERSION 100
+#define SAVE_GAME_VERSION 101
 
 const UINT32 guiSavedGameVersion = SAVE_GAME_VERSION;
 
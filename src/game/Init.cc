@@ -20,6 +20,7 @@
 #include "Cursor_Control.h"
 #include "Video.h"
 #include "Interface_Items.h"
+#include "Items.h"
 #include "Dialogue_Control.h"
 #include "Text.h"
 #include "Laptop.h"
@@ -51,6 +52,8 @@ try
 {
 	gfWorldLoaded = FALSE;
 
+	InitItemTables();
+
 	// Load external text
 	LoadAllExternalText();
 
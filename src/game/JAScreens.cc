@@ -41,8 +41,10 @@
 #include "UILayout.h"
 #include "Timer.h"
 #include "Logger.h"
+#include "MemMan.h"
+#include "Profiler.h"
 
-#define MAX_DEBUG_PAGES 4
+#define MAX_DEBUG_PAGES 5
 
 
 // GLOBAL FOR PAL EDITOR
@@ -61,6 +63,7 @@ static void DefaultDebugPage1(void);
 static void DefaultDebugPage2(void);
 static void DefaultDebugPage3(void);
 static void DefaultDebugPage4(void);
+static void DefaultDebugPage5(void);
 
 
 RENDER_HOOK				gDebugRenderOverride[ MAX_DEBUG_PAGES ] =
@@ -68,7 +71,8 @@ RENDER_HOOK				gDebugRenderOverride[ MAX_DEBUG_PAGES ] =
 	DefaultDebugPage1,
 	DefaultDebugPage2,
 	DefaultDebugPage3,
-	DefaultDebugPage4
+	DefaultDebugPage4,
+	DefaultDebugPage5
 };
 
 
@@ -407,7 +411,19 @@ void SetDebugRenderHook( RENDER_HOOK pDebugRenderOverride, INT8 ubPage )
 
 static void DefaultDebugPage1(void)
 {
-	MPageHeader(L"DEBUG PAGE ONE");
+	MPageHeader(L"DEBUG PAGE ONE - MEMORY");
+	INT32 y = DEBUG_PAGE_START_Y;
+	INT32 h = DEBUG_PAGE_LINE_HEIGHT;
+
+	MHeader(DEBUG_PAGE_FIRST_COLUMN, y += h, L"Tag");
+	mprintf(DEBUG_PAGE_FIRST_COLUMN + DEBUG_PAGE_LABEL_WIDTH, y, L"live KB     peak KB     blocks     allocs");
+	for (UINT i = 0; i != MEM_NUM_TAGS; ++i)
+	{
+		MemTagStats const s = GetMemTagStats(MemTag(i));
+		mprintf(DEBUG_PAGE_FIRST_COLUMN, y += h, L"%hs", GetMemTagName(MemTag(i)));
+		mprintf(DEBUG_PAGE_FIRST_COLUMN + DEBUG_PAGE_LABEL_WIDTH, y, L"%u     %u     %u     %u",
+			UINT32(s.live_bytes / 1024), UINT32(s.peak_bytes / 1024), UINT32(s.live_blocks), UINT32(s.allocs));
+	}
 }
 
 
@@ -429,6 +445,23 @@ static void DefaultDebugPage4(void)
 }
 
 
+static void DefaultDebugPage5(void)
+{
+	MPageHeader(L"DEBUG PAGE FIVE - COUNTERS");
+	INT32 y = DEBUG_PAGE_START_Y;
+	INT32 h = DEBUG_PAGE_LINE_HEIGHT;
+
+	MHeader(DEBUG_PAGE_FIRST_COLUMN, y += h, L"Counter");
+	mprintf(DEBUG_PAGE_FIRST_COLUMN + DEBUG_PAGE_LABEL_WIDTH, y, L"last frame     average");
+	for (UINT i = 0; i != PROFILE_NUM_COUNTERS; ++i)
+	{
+		ProfileCounter const c = ProfileCounter(i);
+		mprintf(DEBUG_PAGE_FIRST_COLUMN, y += h, L"%hs", ProfilerCounterName(c));
+		mprintf(DEBUG_PAGE_FIRST_COLUMN + DEBUG_PAGE_LABEL_WIDTH, y, L"%u     %.1f", ProfilerLastFrameCount(c), ProfilerAverageCount(c));
+	}
+}
+
+
 #define SMILY_DELAY						100
 #define SMILY_END_DELAY				1000
 
@@ -21,6 +21,8 @@
 #include "Font_Control.h"
 #include "FileMan.h"
 
+#include <vector>
+
 #include "ContentManager.h"
 #include "GameInstance.h"
 
@@ -110,14 +112,25 @@ enum{
 
 
 
-// sizeof one record
-#define RECORD_SIZE ( sizeof( UINT32 ) + sizeof( INT32 ) + sizeof( INT32 ) + sizeof( UINT8 ) + sizeof( UINT8 ) )
 
+// the financial record list
+static FinanceUnit* pFinanceListHead = NULL;
 
+struct FinanceRecord
+{
+	UINT8  ubCode;
+	UINT8  ubSecondCode;
+	UINT32 uiDate;
+	INT32  iAmount;
+	INT32  iBalanceToDate;
+};
 
+typedef std::vector<FinanceRecord> FinanceRecords;
 
-// the financial record list
-static FinanceUnit* pFinanceListHead = NULL;
+/* All records of the finance file while the finances are shown. Paging and the
+ * summary, which is drawn on every render, use these instead of reading the
+ * file again. */
+static FinanceRecords g_finance_records;
 
 // current page displayed
 static INT32 iCurrentPage = 0;
@@ -152,6 +165,7 @@ static void DestroyFinanceButtons(void);
 static void GetBalanceFromDisk(void);
 static void WriteBalanceToDisk(void);
 static void AppendFinanceToEndOfFile(void);
+static void ReadFinanceRecords(void);
 static void SetLastPageInRecords(void);
 static void LoadInRecords(UINT32 page);
 
@@ -264,6 +278,8 @@ void EnterFinances()
 	// get the balance
 	GetBalanceFromDisk( );
 
+	ReadFinanceRecords();
+
 	// set number of pages
 	SetLastPageInRecords( );
 
@@ -293,6 +309,7 @@ void ExitFinances( void )
 	// clear out list
 	ClearFinanceList( );
 
+	FinanceRecords().swap(g_finance_records);
 
 	// remove graphics
 	RemoveFinances( );
@@ -920,6 +937,40 @@ static void AppendFinanceToEndOfFile(void)
 	Assert(d == endof(data));
 
 	FileWrite(f, data, sizeof(data));
+
+	if (fInFinancialMode)
+	{
+		FinanceRecord const r = { fu->ubCode, fu->ubSecondCode, fu->uiDate, fu->iAmount, fu->iBalanceToDate };
+		g_finance_records.push_back(r);
+	}
+}
+
+
+static void ReadFinanceRecords(void)
+{
+	g_finance_records.clear();
+
+	AutoSGPFile f(GCM->openTempFileForReading(NEWTMP_FINANCES_DATA_FILE));
+
+	UINT32 const size = FileGetSize(f);
+	if (size < FINANCE_HEADER_SIZE + FINANCE_RECORD_SIZE) return;
+
+	UINT32 const records = (size - FINANCE_HEADER_SIZE) / FINANCE_RECORD_SIZE;
+	std::vector<BYTE> data(records * FINANCE_RECORD_SIZE);
+	FileSeek(f, FINANCE_HEADER_SIZE, FILE_SEEK_FROM_START);
+	FileRead(f, data.data(), data.size());
+
+	g_finance_records.resize(records);
+	const BYTE* d = data.data();
+	for (FinanceRecord& r : g_finance_records)
+	{
+		EXTR_U8(d, r.ubCode);
+		EXTR_U8(d, r.ubSecondCode);
+		EXTR_U32(d, r.uiDate);
+		EXTR_I32(d, r.iAmount);
+		EXTR_I32(d, r.iBalanceToDate);
+	}
+	Assert(d == data.data() + data.size());
 }
 
 
@@ -965,38 +1016,14 @@ static void LoadInRecords(UINT32 const page)
 	ClearFinanceList();
 	if (page == 0) return; // check if bad page
 
-	AutoSGPFile f(GCM->openTempFileForReading(NEWTMP_FINANCES_DATA_FILE));
-
-	UINT32 const size = FileGetSize(f);
-	if (size < FINANCE_HEADER_SIZE) return;
-
-	UINT32       records      = (size - FINANCE_HEADER_SIZE) / FINANCE_RECORD_SIZE;
 	UINT32 const skip_records = NUM_RECORDS_PER_PAGE * (page - 1);
-	if (records <= skip_records) return;
-
-	records -= skip_records;
-	FileSeek(f, FINANCE_HEADER_SIZE + FINANCE_RECORD_SIZE * skip_records, FILE_SEEK_FROM_START);
+	if (g_finance_records.size() <= skip_records) return;
 
-	if (records > NUM_RECORDS_PER_PAGE) records = NUM_RECORDS_PER_PAGE;
-	for (; records > 0; --records)
+	UINT32 const records = MIN(UINT32(g_finance_records.size()) - skip_records, UINT32(NUM_RECORDS_PER_PAGE));
+	for (UINT32 i = skip_records; i != skip_records + records; ++i)
 	{
-		BYTE data[FINANCE_RECORD_SIZE];
-		FileRead(f, data, sizeof(data));
-
-		UINT8  code;
-		UINT8  second_code;
-		UINT32 date;
-		INT32  amount;
-		INT32  balance_to_date;
-		const BYTE* d = data;
-		EXTR_U8(d, code);
-		EXTR_U8(d, second_code);
-		EXTR_U32(d, date);
-		EXTR_I32(d, amount);
-		EXTR_I32(d, balance_to_date);
-		Assert(d == endof(data));
-
-		ProcessAndEnterAFinacialRecord(code, date, amount, second_code, balance_to_date);
+		FinanceRecord const& r = g_finance_records[i];
+		ProcessAndEnterAFinacialRecord(r.ubCode, r.uiDate, r.iAmount, r.ubSecondCode, r.iBalanceToDate);
 	}
 }
 
@@ -1055,26 +1082,13 @@ static INT32 GetPreviousDaysBalance(void)
 
 	if (date_in_days < 2) return 0;
 
-	AutoSGPFile f(GCM->openTempFileForReading(NEWTMP_FINANCES_DATA_FILE));
-
 	INT32 balance = 0;
 	// start at the end, move back until Date / 24 * 60 on the record equals date_in_days - 2
 	// loop, make sure we don't pass beginning of file, if so, we have an error, and check for condifition above
-	for (UINT32 pos = FileGetSize(f); pos >= FINANCE_HEADER_SIZE + RECORD_SIZE;)
+	for (FinanceRecords::const_reverse_iterator i = g_finance_records.rbegin(); i != g_finance_records.rend(); ++i)
 	{
-		FileSeek(f, pos -= RECORD_SIZE, FILE_SEEK_FROM_START);
-
-		BYTE data[RECORD_SIZE];
-		FileRead(f, data, sizeof(data));
-
-		UINT32 date;
-		INT32 balance_to_date;
-		const BYTE* d = data;
-		EXTR_SKIP(d, 2);
-		EXTR_U32(d, date);
-		EXTR_SKIP(d, 4);
-		EXTR_I32(d, balance_to_date);
-		Assert(d == endof(data));
+		UINT32 const date            = i->uiDate;
+		INT32  const balance_to_date = i->iBalanceToDate;
 
 		// check to see if we are far enough
 		if (date / (24 * 60) == date_in_days - 2)
@@ -1096,25 +1110,12 @@ static INT32 GetTodaysBalance(void)
 	const UINT32 date_in_minutes = GetWorldTotalMin();
 	const UINT32 date_in_days    = date_in_minutes / (24 * 60);
 
-	AutoSGPFile f(GCM->openTempFileForReading(NEWTMP_FINANCES_DATA_FILE));
-
 	INT32 balance = 0;
 	// loop, make sure we don't pass beginning of file, if so, we have an error, and check for condifition above
-	for (UINT32 pos = FileGetSize(f); pos >= FINANCE_HEADER_SIZE + RECORD_SIZE;)
+	for (FinanceRecords::const_reverse_iterator i = g_finance_records.rbegin(); i != g_finance_records.rend(); ++i)
 	{
-		FileSeek(f, pos -= RECORD_SIZE, FILE_SEEK_FROM_START);
-
-		BYTE data[RECORD_SIZE];
-		FileRead(f, data, sizeof(data));
-
-		UINT32 date;
-		INT32 balance_to_date;
-		const BYTE* d = data;
-		EXTR_SKIP(d, 2);
-		EXTR_U32(d, date);
-		EXTR_SKIP(d, 4);
-		EXTR_I32(d, balance_to_date);
-		Assert(d == endof(data));
+		UINT32 const date            = i->uiDate;
+		INT32  const balance_to_date = i->iBalanceToDate;
 
 		// check to see if we are far enough
 		if (date / (24 * 60) == date_in_days - 1)
@@ -1135,29 +1136,15 @@ static INT32 GetPreviousDaysIncome(void)
 	const UINT32 date_in_minutes = GetWorldTotalMin();
 	const UINT32 date_in_days    = date_in_minutes / (24 * 60);
 
-	AutoSGPFile f(GCM->openTempFileForReading(NEWTMP_FINANCES_DATA_FILE));
-
 	INT32 iTotalPreviousIncome = 0;
 	// start at the end, move back until Date / 24 * 60 on the record is = date_in_days - 2
 	// loop, make sure we don't pass beginning of file, if so, we have an error, and check for condifition above
 	BOOLEAN fOkToIncrement = FALSE;
-	for (UINT32 pos = FileGetSize(f); pos >= FINANCE_HEADER_SIZE + RECORD_SIZE;)
+	for (FinanceRecords::const_reverse_iterator i = g_finance_records.rbegin(); i != g_finance_records.rend(); ++i)
 	{
-		FileSeek(f, pos -= RECORD_SIZE, FILE_SEEK_FROM_START);
-
-		BYTE data[RECORD_SIZE];
-		FileRead(f, data, sizeof(data));
-
-		UINT8  code;
-		UINT32 date;
-		INT32  amount;
-		const BYTE* d = data;
-		EXTR_U8(d, code);
-		EXTR_SKIP(d, 1);
-		EXTR_U32(d, date);
-		EXTR_I32(d, amount);
-		EXTR_SKIP(d, 4);
-		Assert(d == endof(data));
+		UINT8  const code   = i->ubCode;
+		UINT32 const date   = i->uiDate;
+		INT32  const amount = i->iAmount;
 
 		// now ok to increment amount
 		if (date / (24 * 60) == date_in_days - 1) fOkToIncrement = TRUE;
@@ -1181,28 +1168,14 @@ static INT32 GetTodaysDaysIncome(void)
 	const UINT32 date_in_minutes = GetWorldTotalMin();
 	const UINT32 date_in_days    = date_in_minutes / (24 * 60);
 
-	AutoSGPFile f(GCM->openTempFileForReading(NEWTMP_FINANCES_DATA_FILE));
-
 	INT32 iTotalIncome = 0;
 	// loop, make sure we don't pass beginning of file, if so, we have an error, and check for condifition above
 	BOOLEAN fOkToIncrement = FALSE;
-	for (UINT32 pos = FileGetSize(f); pos >= FINANCE_HEADER_SIZE + RECORD_SIZE;)
+	for (FinanceRecords::const_reverse_iterator i = g_finance_records.rbegin(); i != g_finance_records.rend(); ++i)
 	{
-		FileSeek(f, pos -= RECORD_SIZE, FILE_SEEK_FROM_START);
-
-		BYTE data[RECORD_SIZE];
-		FileRead(f, data, sizeof(data));
-
-		UINT8  code;
-		UINT32 date;
-		INT32  amount;
-		const BYTE* d = data;
-		EXTR_U8(d, code);
-		EXTR_SKIP(d, 1);
-		EXTR_U32(d, date);
-		EXTR_I32(d, amount);
-		EXTR_SKIP(d, 4);
-		Assert(d == endof(data));
+		UINT8  const code   = i->ubCode;
+		UINT32 const date   = i->uiDate;
+		INT32  const amount = i->iAmount;
 
 		// now ok to increment amount
 		if (date / (24 * 60) > date_in_days - 1) fOkToIncrement = TRUE;
@@ -1242,28 +1215,14 @@ static INT32 GetTodaysOtherDeposits(void)
 	const UINT32 date_in_minutes = GetWorldTotalMin();
 	const UINT32 date_in_days    = date_in_minutes / (24 * 60);
 
-	AutoSGPFile f(GCM->openTempFileForReading(NEWTMP_FINANCES_DATA_FILE));
-
 	INT32 iTotalIncome = 0;
 	// loop, make sure we don't pass beginning of file, if so, we have an error, and check for condifition above
 	BOOLEAN fOkToIncrement = FALSE;
-	for (UINT32 pos = FileGetSize(f); pos >= FINANCE_HEADER_SIZE + RECORD_SIZE;)
+	for (FinanceRecords::const_reverse_iterator i = g_finance_records.rbegin(); i != g_finance_records.rend(); ++i)
 	{
-		FileSeek(f, pos -= RECORD_SIZE, FILE_SEEK_FROM_START);
-
-		BYTE data[RECORD_SIZE];
-		FileRead(f, data, sizeof(data));
-
-		UINT8  code;
-		UINT32 date;
-		INT32  amount;
-		const BYTE* d = data;
-		EXTR_U8(d, code);
-		EXTR_SKIP(d, 1);
-		EXTR_U32(d, date);
-		EXTR_I32(d, amount);
-		EXTR_SKIP(d, 4);
-		Assert(d == endof(data));
+		UINT8  const code   = i->ubCode;
+		UINT32 const date   = i->uiDate;
+		INT32  const amount = i->iAmount;
 
 		// now ok to increment amount
 		if (date / (24 * 60) > date_in_days - 1) fOkToIncrement = TRUE;
@@ -1290,29 +1249,15 @@ static INT32 GetYesterdaysOtherDeposits(void)
 	const UINT32 iDateInMinutes = GetWorldTotalMin();
 	const UINT32 date_in_days   = iDateInMinutes / (24 * 60);
 
-	AutoSGPFile f(GCM->openTempFileForReading(NEWTMP_FINANCES_DATA_FILE));
-
 	INT32 iTotalPreviousIncome = 0;
 	// start at the end, move back until Date / 24 * 60 on the record is =  date_in_days - 2
 	// loop, make sure we don't pass beginning of file, if so, we have an error, and check for condifition above
 	BOOLEAN fOkToIncrement = FALSE;
-	for (UINT32 pos = FileGetSize(f); pos >= FINANCE_HEADER_SIZE + RECORD_SIZE;)
+	for (FinanceRecords::const_reverse_iterator i = g_finance_records.rbegin(); i != g_finance_records.rend(); ++i)
 	{
-		FileSeek(f, pos -= RECORD_SIZE, FILE_SEEK_FROM_START);
-
-		BYTE data[RECORD_SIZE];
-		FileRead(f, data, sizeof(data));
-
-		UINT8  code;
-		UINT32 date;
-		INT32  amount;
-		const BYTE* d = data;
-		EXTR_U8(d, code);
-		EXTR_SKIP(d, 1);
-		EXTR_U32(d, date);
-		EXTR_I32(d, amount);
-		EXTR_SKIP(d, 4);
-		Assert(d == endof(data));
+		UINT8  const code   = i->ubCode;
+		UINT32 const date   = i->uiDate;
+		INT32  const amount = i->iAmount;
 
 		// now ok to increment amount
 		if (date / (24 * 60) == date_in_days - 1) fOkToIncrement = TRUE;
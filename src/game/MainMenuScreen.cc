@@ -1,3 +1,4 @@
+#include "Benchmark_Suite.h"
 #include "Button_System.h"
 #include "Cursor_Control.h"
 #include "Cursors.h"
@@ -6,6 +7,7 @@
 #include "Font.h"
 #include "Font_Control.h"
 #include "GameSettings.h"
+#include "GameState.h"
 #include "GameLoop.h"
 #include "GameVersion.h"
 #include "Input.h"
@@ -121,6 +123,15 @@ ScreenID MainMenuScreenHandle(void)
 		SetMusicMode(MUSIC_MAIN_MENU);
 	}
 
+	if (GameState::getInstance()->benchmarking())
+	{
+		GameState::getInstance()->setBenchmarking(false);
+		// Regressions fail the run, so scripts notice them
+		UINT32 const n_regressions = RunBenchmarkSuite();
+		requestGameExit(n_regressions != 0 ? EXIT_FAILURE : EXIT_SUCCESS);
+		return MAINMENU_SCREEN;
+	}
+
 
 	if (fInitialRender)
 	{
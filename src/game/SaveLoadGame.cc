@@ -1,4 +1,6 @@
+#include "BackgroundWriter.h"
 #include "Buffer.h"
+#include "Compression.h"
 #include "Directories.h"
 #include "Font.h"
 #include "Font_Control.h"
@@ -16,6 +18,7 @@
 #include "FileMan.h"
 #include "Debug.h"
 #include "Overhead.h"
+#include "Profiler.h"
 #include "Keys.h"
 #include "Finances.h"
 #include "History.h"
@@ -109,8 +112,14 @@
 #include "GameInstance.h"
 #include "Logger.h"
 
+#include <SDL.h>
+
 #include <algorithm>
+#include <iterator>
+#include <set>
 #include <stdexcept>
+#include <string.h>
+#include <vector>
 
 static const char g_quicksave_name[] = "QuickSave";
 static const char g_savegame_name[]  = "SaveGame";
@@ -141,8 +150,6 @@ ScreenID guiScreenToGotoAfterLoadingSavedGame = ERROR_SCREEN; // XXX TODO001A wa
 
 extern		UINT32		guiCurrentUniqueSoldierId;
 
-static void SaveTempFileToSavedGame(const char* fileName, HWFILE const hFile);
-static void LoadTempFileFromSavedGame(const char* tempFileName, HWFILE const hFile);
 
 static BYTE const* ExtractGameOptions(BYTE const* const data, GAME_OPTIONS& g)
 {
@@ -184,11 +191,233 @@ static void SaveSoldierStructure(HWFILE hFile);
 static void SaveTacticalStatusToSavedGame(HWFILE);
 static void SaveWatchedLocsToSavedGame(HWFILE);
 
+static void ReportSaveGameWrite(BackgroundWriteStatus);
+
+
+static SavedGamePartStats g_part_stats[NUM_SAVED_GAME_PARTS];
+
+/* Charges the time and the bytes written or read since a part of the save game
+ * was entered to that part. The file may be null, then no bytes are counted. */
+class SavedGamePartClock
+{
+public:
+	explicit SavedGamePartClock(bool const load) :
+		load_(load),
+		part_(NUM_SAVED_GAME_PARTS),
+		file_(0),
+		pos_(0),
+		start_(0)
+	{}
+
+	void enter(SavedGamePart const part, HWFILE const f)
+	{
+		uint64_t const now = SDL_GetPerformanceCounter();
+		if (part_ != NUM_SAVED_GAME_PARTS)
+		{
+			SavedGamePartStats& s     = g_part_stats[part_];
+			UINT32       const  bytes = file_ ? FileGetPos(file_) - pos_ : 0;
+			(load_ ? s.load_bytes : s.save_bytes) += bytes;
+			(load_ ? s.load_ticks : s.save_ticks) += now - start_;
+		}
+		part_  = part;
+		file_  = f;
+		pos_   = f ? FileGetPos(f) : 0;
+		start_ = now;
+	}
+
+	void stop() { enter(NUM_SAVED_GAME_PARTS, 0); }
+
+private:
+	bool          load_;
+	SavedGamePart part_;
+	HWFILE        file_;
+	UINT32        pos_;
+	uint64_t      start_;
+};
+
+
+SavedGamePartStats const& GetSavedGamePartStats(SavedGamePart const part)
+{
+	return g_part_stats[part];
+}
+
+
+char const* GetSavedGamePartName(SavedGamePart const part)
+{
+	static char const* const names[] =
+	{
+		"world",
+		"header",
+		"tactical_status",
+		"events",
+		"laptop",
+		"profiles",
+		"soldiers",
+		"strategic",
+		"temp_files",
+		"opplists",
+		"general",
+		"packing"
+	};
+	static_assert(lengthof(names) == NUM_SAVED_GAME_PARTS, "Name every part of the save game");
+	return names[part];
+}
+
+
+void ResetSavedGamePartStats()
+{
+	std::fill(std::begin(g_part_stats), std::end(g_part_stats), SavedGamePartStats());
+}
+
+static size_t g_last_save_game_size;
+
+
+/* End of turn autosaves are written as deltas against a full save of their
+ * slot, the base. A new base is written after a few deltas, or once a delta
+ * has grown to half the size of the base, so the deltas stay small. Each slot
+ * has bases of its own, so writing a base never breaks the other slot. A base
+ * is named after the slot and its checksum, e.g. Auto01.1A2B3C4D.base, so a
+ * new base never replaces the one the delta in the slot was written against.
+ * The old base is only deleted once the delta refering to the new one is in
+ * place. */
+#define AUTOSAVE_DELTAS_PER_BASE 8
+
+struct AutosaveBase
+{
+	SavedGameBase base;
+	time_t        mtime;
+	uintmax_t     packed_size;
+	UINT32        n_deltas;
+};
+
+static AutosaveBase g_autosave_bases[2];
+
+
+static UINT32 SavedGameChecksum(BYTE const* data, size_t n);
+
+
+// The name of the base of the save game at path, empty if it has none or cannot be read
+static std::string ReadSavedGameBaseName(std::string const& path)
+{
+	try
+	{
+		AutoSGPFile const f(FileMan::openForReading(path));
+		return IsPackedSavedGame(f) ? GetSavedGameBaseName(f) : std::string();
+	}
+	catch (std::exception const&)
+	{
+		return std::string();
+	}
+}
+
+
+/* Deletes the bases of the save game at path which are next to it, but the
+ * ones named in keep. */
+static void DeleteAutosaveBases(std::string const& path, std::set<std::string> const& keep)
+{
+	std::string const dir    = FileMan::getParentPath(path, false);
+	std::string const prefix = FileMan::getFileNameWithoutExt(path) + ".";
+	try
+	{
+		for (std::string const& name : FindFilesInDir(dir, ".base", false, true))
+		{
+			if (name.compare(0, prefix.size(), prefix) != 0 || keep.count(name)) continue;
+			FileDelete(FileMan::joinPaths(dir, name));
+		}
+	}
+	catch (std::exception const& e)
+	{
+		SLOGW("Failed to delete the old bases of '%s': %s", path.c_str(), e.what());
+	}
+}
+
+
+static void WriteAutosave(HWFILE const f, UINT32 const slot, char const* const path)
+{
+	AutosaveBase&     b   = g_autosave_bases[slot];
+	std::string const dir = FileMan::getParentPath(path, false);
+
+	// The base file must still be the one the deltas were written against
+	time_t    mtime;
+	uintmax_t size;
+	bool const new_base =
+		b.base.data.empty() ||
+		b.n_deltas >= AUTOSAVE_DELTAS_PER_BASE ||
+		!FileMan::getFileStamp(FileMan::joinPaths(dir, b.base.name).c_str(), mtime, size) ||
+		mtime != b.mtime ||
+		size  != b.packed_size;
+	if (new_base)
+	{
+		std::vector<BYTE> const& data = FileMan::getMemoryFileData(f);
+		char name[64];
+		snprintf(name, lengthof(name), "%s.%08X.base",
+			FileMan::getFileNameWithoutExt(path).c_str(), SavedGameChecksum(data.data(), data.size()));
+		std::string const base_path = FileMan::joinPaths(dir, name);
+
+		b.base.data.clear();
+		AutoSGPFile packed(PackSavedGame(f));
+		uintmax_t const packed_size = FileGetSize(packed);
+		WriteFileInBackground(packed.Release(), base_path.c_str());
+		BackgroundWriteStatus const status = FinishBackgroundWrite(true);
+		ReportSaveGameWrite(status);
+		if (status == BACKGROUND_WRITE_FAILED ||
+				!FileMan::getFileStamp(base_path.c_str(), b.mtime, size))
+		{ // Fall back to a full save in the slot itself
+			WriteFileInBackground(PackSavedGame(f), path);
+			return;
+		}
+		b.base.name   = name;
+		b.base.data   = data;
+		b.packed_size = packed_size;
+		b.n_deltas    = 0;
+	}
+
+	AutoSGPFile delta(PackSavedGame(f, &b.base));
+	b.n_deltas = FileGetSize(delta) > b.packed_size / 2 ? AUTOSAVE_DELTAS_PER_BASE : b.n_deltas + 1;
+	WriteFileInBackground(delta.Release(), path);
+
+	if (new_base)
+	{ // The old bases may only go once the slot refers to the new one
+		BackgroundWriteStatus const status = FinishBackgroundWrite(true);
+		ReportSaveGameWrite(status);
+		if (status == BACKGROUND_WRITE_DONE) DeleteAutosaveBases(path, { b.base.name });
+	}
+}
+
+
+void DeleteSavedGame(char const* const path)
+{
+	std::string const base_name = ReadSavedGameBaseName(path);
+	FileDelete(path);
+	if (!base_name.empty())
+	{
+		FileDelete(FileMan::joinPaths(FileMan::getParentPath(path, false), base_name));
+	}
+}
+
+
+void DeleteUnusedAutosaveBases()
+{
+	for (UINT32 slot = 0; slot != lengthof(g_autosave_bases); ++slot)
+	{
+		char path[512];
+		sprintf(path, "%s/Auto%02d.%s", GCM->getSavedGamesFolder().c_str(), slot, g_savegame_ext);
+		std::set<std::string> keep;
+		std::string const base_name = ReadSavedGameBaseName(path);
+		if (!base_name.empty()) keep.insert(base_name);
+		DeleteAutosaveBases(path, keep);
+	}
+}
+
+
 BOOLEAN SaveGame(UINT8 const ubSaveGameID, wchar_t const* GameDesc)
 {
+	PROFILE_ZONE("SaveGame");
 	BOOLEAN	fPausedStateBeforeSaving    = gfGamePaused;
 	BOOLEAN	fLockPauseStateBeforeSaving = gfLockPauseState;
 
+	WaitForSaveGameWrite();
+
 	bool fWePausedIt = false;
 	if (!GamePaused())
 	{
@@ -235,6 +464,9 @@ BOOLEAN SaveGame(UINT8 const ubSaveGameID, wchar_t const* GameDesc)
 
 	try
 	{
+		SavedGamePartClock clock(false);
+		clock.enter(SAVED_GAME_PART_WORLD, 0);
+
 		//Save the current sectors open temp files to the disk
 		SaveCurrentSectorsInformationToTempItemFile();
 
@@ -254,10 +486,12 @@ BOOLEAN SaveGame(UINT8 const ubSaveGameID, wchar_t const* GameDesc)
 
 		FileMan::createDir(GCM->getSavedGamesFolder().c_str());
 
-		// Create the save game file
+		/* Snapshot the game into memory, which is quick. The file is written by
+		 * the background writer, while the game goes on. */
 		char savegame_name[512];
+		UINT32 const autosave_slot = guiLastSaveGameNum;
 		CreateSavedGameFileNameFromNumber(ubSaveGameID, savegame_name);
-		AutoSGPFile f(FileMan::openForWriting(savegame_name));
+		AutoSGPFile f(FileMan::openInMemory(g_last_save_game_size));
 
 		/* If there are no enemy or civilians to save, we have to check BEFORE
 		 * saving the sector info struct because the
@@ -267,6 +501,7 @@ BOOLEAN SaveGame(UINT8 const ubSaveGameID, wchar_t const* GameDesc)
 		NewWayOfSavingEnemyAndCivliansToTempFile(gWorldSectorX, gWorldSectorY, gbWorldSectorZ, FALSE, TRUE);
 
 		// Setup the save game header
+		clock.enter(SAVED_GAME_PART_HEADER, f);
 		header.uiSavedGameVersion = guiSavedGameVersion;
 		strcpy(header.zGameVersionNumber, g_version_number);
 
@@ -328,18 +563,24 @@ BOOLEAN SaveGame(UINT8 const ubSaveGameID, wchar_t const* GameDesc)
 		CalcJA2EncryptionSet(header);
 
 		// Save the gTactical Status array, plus the curent sector location
+		clock.enter(SAVED_GAME_PART_TACTICAL_STATUS, f);
 		SaveTacticalStatusToSavedGame(f);
 
 		SaveGameClock(f, fPausedStateBeforeSaving, fLockPauseStateBeforeSaving);
 
+		clock.enter(SAVED_GAME_PART_EVENTS, f);
 		SaveStrategicEventsToSavedGame(f);
 
+		clock.enter(SAVED_GAME_PART_LAPTOP, f);
 		SaveLaptopInfoToSavedGame(f);
 
+		clock.enter(SAVED_GAME_PART_PROFILES, f);
 		SaveMercProfiles(f);
 
+		clock.enter(SAVED_GAME_PART_SOLDIERS, f);
 		SaveSoldierStructure(f);
 
+		clock.enter(SAVED_GAME_PART_LAPTOP, f);
 		SaveTempFileToSavedGame(NEWTMP_FINANCES_DATA_FILE, f);
 
 		SaveFilesToSavedGame(HISTORY_DATA_FILE, f);
@@ -348,6 +589,7 @@ BOOLEAN SaveGame(UINT8 const ubSaveGameID, wchar_t const* GameDesc)
 
 		SaveEmailToSavedGame(f);
 
+		clock.enter(SAVED_GAME_PART_STRATEGIC, f);
 		SaveStrategicInfoToSavedFile(f);
 
 		SaveUnderGroundSectorInfoToSaveGame(f);
@@ -356,12 +598,16 @@ BOOLEAN SaveGame(UINT8 const ubSaveGameID, wchar_t const* GameDesc)
 
 		SaveStrategicMovementGroupsToSaveGameFile(f);
 
+		clock.enter(SAVED_GAME_PART_TEMP_FILES, f);
 		SaveMapTempFilesToSavedGameFile(f);
 
+		clock.enter(SAVED_GAME_PART_GENERAL, f);
 		SaveQuestInfoToSavedGameFile(f);
 
+		clock.enter(SAVED_GAME_PART_OPPLISTS, f);
 		SaveOppListInfoToSavedGame(f);
 
+		clock.enter(SAVED_GAME_PART_GENERAL, f);
 		SaveMapScreenMessagesToSaveGameFile(f);
 
 		SaveNPCInfoToSaveGameFile(f);
@@ -417,13 +663,25 @@ BOOLEAN SaveGame(UINT8 const ubSaveGameID, wchar_t const* GameDesc)
 		SaveLeaveItemList(f);
 
 		NewWayOfSavingBobbyRMailOrdersToSaveGameFile(f);
+
+		// Start the next snapshot big enough, the buffer is several megabytes
+		clock.enter(SAVED_GAME_PART_PACKING, f);
+		g_last_save_game_size = FileGetSize(f);
+		if (ubSaveGameID == SAVE__END_TURN_NUM)
+		{
+			WriteAutosave(f, autosave_slot, savegame_name);
+		}
+		else
+		{
+			WriteFileInBackground(PackSavedGame(f), savegame_name);
+		}
+		clock.stop();
 	}
 	catch (...)
 	{
 		if (fWePausedIt) UnPauseAfterSaveGame();
 
-		// Delete the failed attempt at saving
-		DeleteSaveGameNumber(ubSaveGameID);
+		// Nothing was written, so an old save in this slot is still intact
 
 		//Put out an error message
 		ScreenMsg(FONT_MCOLOR_WHITE, MSG_INTERFACE, zSaveLoadText[SLG_SAVE_GAME_ERROR]);
@@ -461,6 +719,26 @@ BOOLEAN SaveGame(UINT8 const ubSaveGameID, wchar_t const* GameDesc)
 }
 
 
+static void ReportSaveGameWrite(BackgroundWriteStatus const status)
+{
+	if (status != BACKGROUND_WRITE_FAILED) return;
+	ScreenMsg(FONT_MCOLOR_WHITE, MSG_INTERFACE, zSaveLoadText[SLG_SAVE_GAME_ERROR]);
+	NextLoopCheckForEnoughFreeHardDriveSpace();
+}
+
+
+void PollSaveGameWrite()
+{
+	ReportSaveGameWrite(FinishBackgroundWrite(false));
+}
+
+
+void WaitForSaveGameWrite()
+{
+	ReportSaveGameWrite(FinishBackgroundWrite(true));
+}
+
+
 /** Parse binary data and fill SAVED_GAME_HEADER structure.
  * @param data Data to be parsed.
  * @param h Header structure to be filled.
@@ -533,32 +811,451 @@ bool isValidSavedGameHeader(SAVED_GAME_HEADER& h)
 }
 
 
-void ExtractSavedGameHeaderFromFile(HWFILE const f, SAVED_GAME_HEADER& h, bool *stracLinuxFormat)
+/* Read the header of a save game as it is on disk into data, which has room
+ * for SAVED_GAME_HEADER_ON_DISK_SIZE_STRAC_LIN bytes, and parse it. */
+static void ReadSavedGameHeaderData(HWFILE const f, BYTE* const data, SAVED_GAME_HEADER& h, bool* const stracLinuxFormat)
 {
-	// first try Strac Linux format
-	try
+	// Packed save games are always written with the vanilla header
+	if (!IsPackedSavedGame(f))
 	{
-		BYTE data[SAVED_GAME_HEADER_ON_DISK_SIZE_STRAC_LIN];
-		FileRead(f, data, sizeof(data));
-		ParseSavedGameHeader(data, h, true);
-		if(isValidSavedGameHeader(h))
+		// first try Strac Linux format
+		try
 		{
-			*stracLinuxFormat = true;
-			return;
+			FileRead(f, data, SAVED_GAME_HEADER_ON_DISK_SIZE_STRAC_LIN);
+			ParseSavedGameHeader(data, h, true);
+			if(isValidSavedGameHeader(h))
+			{
+				*stracLinuxFormat = true;
+				return;
+			}
 		}
+		catch (...) {}
 	}
-	catch (...) {}
 
 	{
 		// trying vanilla format
-		BYTE data[SAVED_GAME_HEADER_ON_DISK_SIZE];
 		FileSeek(f, 0, FILE_SEEK_FROM_START);
-		FileRead(f, data, sizeof(data));
+		FileRead(f, data, SAVED_GAME_HEADER_ON_DISK_SIZE);
 		ParseSavedGameHeader(data, h, false);
 		*stracLinuxFormat = false;
 	}
 }
 
+
+void ExtractSavedGameHeaderFromFile(HWFILE const f, SAVED_GAME_HEADER& h, bool *stracLinuxFormat)
+{
+	BYTE data[SAVED_GAME_HEADER_ON_DISK_SIZE_STRAC_LIN];
+	ReadSavedGameHeaderData(f, data, h, stracLinuxFormat);
+}
+
+
+#define SAVED_GAME_HEADER_INDEX_FILE    "headers.idx"
+#define SAVED_GAME_HEADER_INDEX_VERSION 1
+
+
+SavedGameHeaderIndex::SavedGameHeaderIndex(std::string const& index_file) :
+	file_(index_file),
+	loaded_(false),
+	dirty_(false)
+{}
+
+
+bool SavedGameHeaderIndex::getHeader(char const* const filename, SAVED_GAME_HEADER& h)
+{
+	if (!loaded_) load();
+
+	time_t    mtime;
+	uintmax_t size;
+	if (!FileMan::getFileStamp(filename, mtime, size))
+	{
+		if (entries_.erase(filename) != 0) dirty_ = true;
+		return false;
+	}
+
+	std::map<std::string, Entry>::const_iterator const i = entries_.find(filename);
+	if (i != entries_.end() && i->second.mtime == mtime && i->second.size == size)
+	{
+		ParseSavedGameHeader(i->second.data, h, i->second.stracLinuxFormat);
+		return true;
+	}
+
+	Entry e = Entry();
+	try
+	{
+		AutoSGPFile f(FileMan::openForReading(filename));
+		ReadSavedGameHeaderData(f, e.data, h, &e.stracLinuxFormat);
+	}
+	catch (...)
+	{
+		if (entries_.erase(filename) != 0) dirty_ = true;
+		return false;
+	}
+	e.mtime            = mtime;
+	e.size             = size;
+	entries_[filename] = e;
+	dirty_             = true;
+	return true;
+}
+
+
+/* The index file starts with its version and the number of entries. Each entry
+ * is the length and the characters of the file name, the modification time and
+ * size of the file, the header format and the header as it is on disk. */
+void SavedGameHeaderIndex::load()
+{
+	loaded_ = true;
+	try
+	{
+		AutoSGPFile f(FileMan::openForReading(file_));
+		f = FileMan::readIntoMemory(f);
+
+		UINT32 version;
+		UINT32 n_entries;
+		FileRead(f, &version,   sizeof(version));
+		FileRead(f, &n_entries, sizeof(n_entries));
+		if (version != SAVED_GAME_HEADER_INDEX_VERSION) return;
+
+		std::map<std::string, Entry> entries;
+		for (UINT32 i = 0; i != n_entries; ++i)
+		{
+			UINT16 name_length;
+			FileRead(f, &name_length, sizeof(name_length));
+			std::string name(name_length, '\0');
+			FileRead(f, &name[0], name_length);
+
+			Entry& e = entries[name];
+			int64_t  mtime;
+			uint64_t size;
+			UINT8    format;
+			FileRead(f, &mtime,  sizeof(mtime));
+			FileRead(f, &size,   sizeof(size));
+			FileRead(f, &format, sizeof(format));
+			FileRead(f, e.data,  sizeof(e.data));
+			e.mtime            = static_cast<time_t>(mtime);
+			e.size             = size;
+			e.stracLinuxFormat = format != 0;
+		}
+		entries_.swap(entries);
+	}
+	catch (...)
+	{
+		// A missing or damaged index only means the headers are read again
+	}
+}
+
+
+void SavedGameHeaderIndex::save()
+{
+	if (!dirty_) return;
+
+	try
+	{
+		AutoSGPFile f(FileMan::openInMemory());
+		UINT32 const version   = SAVED_GAME_HEADER_INDEX_VERSION;
+		UINT32 const n_entries = static_cast<UINT32>(entries_.size());
+		FileWrite(f, &version,   sizeof(version));
+		FileWrite(f, &n_entries, sizeof(n_entries));
+		for (std::map<std::string, Entry>::const_iterator i = entries_.begin(); i != entries_.end(); ++i)
+		{
+			std::string const& name        = i->first;
+			Entry       const& e           = i->second;
+			UINT16      const  name_length = static_cast<UINT16>(name.size());
+			int64_t     const  mtime       = e.mtime;
+			uint64_t    const  size        = e.size;
+			UINT8       const  format      = e.stracLinuxFormat;
+			FileWrite(f, &name_length, sizeof(name_length));
+			FileWrite(f, name.data(),  name_length);
+			FileWrite(f, &mtime,       sizeof(mtime));
+			FileWrite(f, &size,        sizeof(size));
+			FileWrite(f, &format,      sizeof(format));
+			FileWrite(f, e.data,       sizeof(e.data));
+		}
+
+		std::vector<BYTE> const& data = FileMan::getMemoryFileData(f);
+		AutoSGPFile out(FileMan::openForWriting(file_.c_str()));
+		FileWrite(out, data.data(), data.size());
+		dirty_ = false;
+	}
+	catch (...)
+	{
+		SLOGW("Failed to write the save game header index '%s'", file_.c_str());
+	}
+}
+
+
+SavedGameHeaderIndex& GetSavedGameHeaderIndex()
+{
+	static SavedGameHeaderIndex index(FileMan::joinPaths(GCM->getSavedGamesFolder(), SAVED_GAME_HEADER_INDEX_FILE));
+	return index;
+}
+
+
+/* Sections end where a hash over the last 32 bytes has its upper 16 bits
+ * clear, but are at least SAVED_GAME_SECTION_MIN_SIZE bytes long. */
+#define SAVED_GAME_SECTION_MIN_SIZE (16 * 1024)
+#define SAVED_GAME_SECTION_MASK     0xFFFF0000U
+
+#define SAVED_GAME_DELTA            0x80000000U // Flag in the number of sections of a delta
+#define SAVED_GAME_SECTION_IN_BASE  0xFFFFFFFFU // Stored size of a section taken from the base
+#define SAVED_GAME_BASE_NAME_LENGTH 255
+
+
+static size_t NextSavedGameSection(BYTE const* const data, size_t const n)
+{
+	static UINT32 gear[256];
+	if (gear[0] == 0)
+	{
+		UINT32 x = 0x9E3779B9;
+		for (size_t i = 0; i != lengthof(gear); ++i)
+		{
+			x ^= x << 13;
+			x ^= x >> 17;
+			x ^= x << 5;
+			gear[i] = x;
+		}
+	}
+
+	if (n <= SAVED_GAME_SECTION_MIN_SIZE) return n;
+	size_t const max = std::min(n, (size_t)SAVED_GAME_SECTION_SIZE);
+	UINT32       h   = 0;
+	for (size_t i = SAVED_GAME_SECTION_MIN_SIZE - 32; i != max; ++i)
+	{
+		h = (h << 1) + gear[data[i]];
+		if (i >= SAVED_GAME_SECTION_MIN_SIZE && (h & SAVED_GAME_SECTION_MASK) == 0) return i + 1;
+	}
+	return max;
+}
+
+
+static UINT32 SavedGameChecksum(BYTE const* const data, size_t const n)
+{
+	// FNV-1a
+	UINT32 h = 2166136261U;
+	for (size_t i = 0; i != n; ++i) h = (h ^ data[i]) * 16777619U;
+	return h;
+}
+
+
+SGPFile* PackSavedGame(HWFILE const src, SavedGameBase const* const base)
+{
+	std::vector<BYTE> const& data = FileMan::getMemoryFileData(src);
+	if (data.size() < SAVED_GAME_HEADER_ON_DISK_SIZE) throw std::logic_error("Save game without header");
+	BYTE   const* const body      = data.data() + SAVED_GAME_HEADER_ON_DISK_SIZE;
+	size_t const        body_size = data.size() - SAVED_GAME_HEADER_ON_DISK_SIZE;
+
+	/* Index the sections of the base by their checksum. They are cut the same
+	 * way, so an unchanged part of the save game yields the same sections. */
+	std::map<UINT32, size_t> base_sections;
+	if (base)
+	{
+		if (base->data.size() < SAVED_GAME_HEADER_ON_DISK_SIZE || base->name.size() > SAVED_GAME_BASE_NAME_LENGTH)
+		{
+			throw std::logic_error("Invalid save game base");
+		}
+		BYTE const* const base_body = base->data.data() + SAVED_GAME_HEADER_ON_DISK_SIZE;
+		size_t const      base_size = base->data.size() - SAVED_GAME_HEADER_ON_DISK_SIZE;
+		for (size_t pos = 0; pos != base_size;)
+		{
+			size_t const size = NextSavedGameSection(base_body + pos, base_size - pos);
+			base_sections.insert(std::make_pair(SavedGameChecksum(base_body + pos, size), pos));
+			pos += size;
+		}
+	}
+
+	// The directory comes before the sections, so compress them aside first
+	std::vector<UINT32> directory;
+	std::vector<BYTE>   packed;
+	size_t              packed_size = 0;
+	for (size_t pos = 0; pos != body_size;)
+	{
+		BYTE   const* const section = body + pos;
+		size_t const        size    = NextSavedGameSection(section, body_size - pos);
+		pos += size;
+
+		size_t const needed = packed_size + std::max(CompressBound(size), sizeof(UINT32));
+		if (packed.size() < needed) packed.resize(std::max(needed, 2 * packed.size()));
+		BYTE* const dst = packed.data() + packed_size;
+
+		if (base)
+		{
+			std::map<UINT32, size_t>::const_iterator const i = base_sections.find(SavedGameChecksum(section, size));
+			if (i != base_sections.end())
+			{
+				BYTE   const* const base_body = base->data.data() + SAVED_GAME_HEADER_ON_DISK_SIZE;
+				size_t const        base_size = base->data.size() - SAVED_GAME_HEADER_ON_DISK_SIZE;
+				if (size <= base_size - i->second && memcmp(base_body + i->second, section, size) == 0)
+				{ // Refer to the section in the base by its offset
+					UINT32 const offset = (UINT32)i->second;
+					memcpy(dst, &offset, sizeof(offset));
+					directory.push_back((UINT32)size);
+					directory.push_back(SAVED_GAME_SECTION_IN_BASE);
+					packed_size += sizeof(offset);
+					continue;
+				}
+			}
+		}
+
+		size_t n = CompressBlock(section, size, dst);
+		if (n >= size)
+		{ // Store it as it is
+			memcpy(dst, section, size);
+			n = size;
+		}
+		directory.push_back((UINT32)size);
+		directory.push_back((UINT32)n);
+		packed_size += n;
+	}
+
+	UINT32 n_sections = (UINT32)(directory.size() / 2);
+	size_t header_size = SAVED_GAME_HEADER_ON_DISK_SIZE + sizeof(UINT32);
+	if (base)
+	{
+		n_sections  |= SAVED_GAME_DELTA;
+		header_size += sizeof(UINT32) * 3 + base->name.size();
+	}
+
+	AutoSGPFile f(FileMan::openInMemory(header_size + sizeof(UINT32) * directory.size() + packed_size));
+	FileWrite(f, data.data(), SAVED_GAME_HEADER_ON_DISK_SIZE);
+	FileWrite(f, &n_sections, sizeof(n_sections));
+	if (base)
+	{
+		/* Name the base and remember its size and checksum, so a base which was
+		 * replaced in the meantime is noticed. */
+		UINT32 const name_length   = (UINT32)base->name.size();
+		UINT32 const base_size     = (UINT32)base->data.size();
+		UINT32 const base_checksum = SavedGameChecksum(base->data.data(), base->data.size());
+		FileWrite(f, &name_length,     sizeof(name_length));
+		FileWrite(f, base->name.data(), name_length);
+		FileWrite(f, &base_size,       sizeof(base_size));
+		FileWrite(f, &base_checksum,   sizeof(base_checksum));
+	}
+	FileWrite(f, directory.data(), sizeof(UINT32) * directory.size());
+	FileWrite(f, packed.data(), packed_size);
+	return f.Release();
+}
+
+
+bool IsPackedSavedGame(HWFILE const f)
+{
+	// Packed save games are written with the vanilla header only
+	UINT32 version;
+	FileSeek(f, 0, FILE_SEEK_FROM_START);
+	FileRead(f, &version, sizeof(version));
+	FileSeek(f, 0, FILE_SEEK_FROM_START);
+	return version >= SAVED_GAME_VERSION_PACKED && FileGetSize(f) >= SAVED_GAME_HEADER_ON_DISK_SIZE + sizeof(UINT32);
+}
+
+
+/* Reads the number of sections and the name of the base, if there is one,
+ * after the header. */
+static UINT32 ReadSavedGameSectionCount(HWFILE const src, std::string* const base_name)
+{
+	FileSeek(src, SAVED_GAME_HEADER_ON_DISK_SIZE, FILE_SEEK_FROM_START);
+	UINT32 n_sections;
+	FileRead(src, &n_sections, sizeof(n_sections));
+	base_name->clear();
+	if (n_sections & SAVED_GAME_DELTA)
+	{
+		UINT32 name_length;
+		FileRead(src, &name_length, sizeof(name_length));
+		if (name_length == 0 || name_length > SAVED_GAME_BASE_NAME_LENGTH) throw std::runtime_error("Damaged save game");
+		base_name->resize(name_length);
+		FileRead(src, &(*base_name)[0], name_length);
+	}
+	return n_sections;
+}
+
+
+std::string GetSavedGameBaseName(HWFILE const f)
+{
+	std::string base_name;
+	ReadSavedGameSectionCount(f, &base_name);
+	FileSeek(f, 0, FILE_SEEK_FROM_START);
+	return base_name;
+}
+
+
+SGPFile* UnpackSavedGame(HWFILE const src, HWFILE const base)
+{
+	BYTE header[SAVED_GAME_HEADER_ON_DISK_SIZE];
+	FileSeek(src, 0, FILE_SEEK_FROM_START);
+	FileRead(src, header, sizeof(header));
+
+	std::string  base_name;
+	UINT32       n_sections = ReadSavedGameSectionCount(src, &base_name);
+	BYTE const*  base_body  = 0;
+	size_t       base_size  = 0;
+	if (n_sections & SAVED_GAME_DELTA)
+	{
+		n_sections &= ~SAVED_GAME_DELTA;
+		UINT32 size;
+		UINT32 checksum;
+		FileRead(src, &size,     sizeof(size));
+		FileRead(src, &checksum, sizeof(checksum));
+		if (!base) throw std::runtime_error("Save game base is missing");
+		std::vector<BYTE> const& base_data = FileMan::getMemoryFileData(base);
+		if (base_data.size() != size || SavedGameChecksum(base_data.data(), base_data.size()) != checksum)
+		{
+			throw std::runtime_error("Save game base does not match");
+		}
+		base_body = base_data.data() + SAVED_GAME_HEADER_ON_DISK_SIZE;
+		base_size = base_data.size() - SAVED_GAME_HEADER_ON_DISK_SIZE;
+	}
+	if (n_sections > FileGetSize(src) / (2 * sizeof(UINT32))) throw std::runtime_error("Damaged save game");
+	std::vector<UINT32> directory(2 * n_sections);
+	FileRead(src, directory.data(), sizeof(UINT32) * directory.size());
+
+	size_t size = sizeof(header);
+	for (UINT32 i = 0; i != n_sections; ++i)
+	{
+		UINT32 const section_size = directory[2 * i];
+		UINT32 const stored_size  = directory[2 * i + 1];
+		bool   const in_base      = stored_size == SAVED_GAME_SECTION_IN_BASE && base_body;
+		if (section_size > SAVED_GAME_SECTION_SIZE || (stored_size > section_size && !in_base))
+		{
+			throw std::runtime_error("Damaged save game");
+		}
+		size += section_size;
+	}
+
+	AutoSGPFile f(FileMan::openInMemory(size));
+	FileWrite(f, header, sizeof(header));
+	SGP::Buffer<BYTE> stored(SAVED_GAME_SECTION_SIZE);
+	SGP::Buffer<BYTE> section(SAVED_GAME_SECTION_SIZE);
+	for (UINT32 i = 0; i != n_sections; ++i)
+	{
+		UINT32 const section_size = directory[2 * i];
+		UINT32 const stored_size  = directory[2 * i + 1];
+		if (stored_size == SAVED_GAME_SECTION_IN_BASE)
+		{
+			UINT32 offset;
+			FileRead(src, &offset, sizeof(offset));
+			if (offset > base_size || section_size > base_size - offset)
+			{
+				throw std::runtime_error("Damaged save game");
+			}
+			FileWrite(f, base_body + offset, section_size);
+		}
+		else if (stored_size == section_size)
+		{
+			FileRead(src, stored, stored_size);
+			FileWrite(f, stored, section_size);
+		}
+		else
+		{
+			FileRead(src, stored, stored_size);
+			if (!DecompressBlock(stored, stored_size, section, section_size))
+			{
+				throw std::runtime_error("Damaged save game");
+			}
+			FileWrite(f, section, section_size);
+		}
+	}
+	FileSeek(f, 0, FILE_SEEK_FROM_START);
+	return f.Release();
+}
+
+
 static void HandleOldBobbyRMailOrders(void);
 static void LoadGeneralInfo(HWFILE, UINT32 savegame_version);
 static void LoadMeanwhileDefsFromSaveGameFile(HWFILE, UINT32 savegame_version);
@@ -571,6 +1268,32 @@ static void LoadWatchedLocsFromSavedGame(HWFILE);
 static void TruncateStrategicGroupSizes(void);
 static void UpdateMercMercContractInfo(void);
 
+SGPFile* ReadSavedGame(char const* const path)
+{
+	AutoSGPFile f;
+	{
+		AutoSGPFile const file(GCM->openUserPrivateFileForReading(std::string(path)));
+		f = FileMan::readIntoMemory(file);
+	}
+	if (IsPackedSavedGame(f))
+	{
+		// A delta autosave needs its base, which is a full save next to it
+		AutoSGPFile       base;
+		std::string const base_name = GetSavedGameBaseName(f);
+		if (!base_name.empty())
+		{
+			std::string const base_path = FileMan::joinPaths(FileMan::getParentPath(path, false), base_name);
+			AutoSGPFile const file(GCM->openUserPrivateFileForReading(base_path));
+			AutoSGPFile const packed(FileMan::readIntoMemory(file));
+			if (!IsPackedSavedGame(packed)) throw std::runtime_error("Damaged save game base");
+			base = UnpackSavedGame(packed);
+		}
+		f = UnpackSavedGame(f, base);
+	}
+	return f.Release();
+}
+
+
 void LoadSavedGame(UINT8 const save_slot_id)
 {
 	// Save the game before if we are in Dead is Dead Mode
@@ -582,6 +1305,7 @@ void LoadSavedGame(UINT8 const save_slot_id)
 		}
 		DoDeadIsDeadSave();
 	}
+	WaitForSaveGameWrite();
 	TrashAllSoldiers();
 	RemoveAllGroups();
 
@@ -615,10 +1339,16 @@ void LoadSavedGame(UINT8 const save_slot_id)
 	// ATE: Added to empty dialogue q
 	EmptyDialogueQueue();
 
+	/* The save game is read with a single read and parsed in memory, instead of
+	 * going to the file for each of the many small reads. */
+	SavedGamePartClock clock(true);
+	clock.enter(SAVED_GAME_PART_PACKING, 0);
+
 	char zSaveGameName[512];
 	CreateSavedGameFileNameFromNumber(save_slot_id, zSaveGameName);
-	AutoSGPFile f(GCM->openUserPrivateFileForReading(std::string(zSaveGameName)));
+	AutoSGPFile f(ReadSavedGame(zSaveGameName));
 
+	clock.enter(SAVED_GAME_PART_HEADER, f);
 	SAVED_GAME_HEADER SaveGameHeader;
 	bool stracLinuxFormat;
 	ExtractSavedGameHeaderFromFile(f, SaveGameHeader, &stracLinuxFormat);
@@ -641,6 +1371,7 @@ void LoadSavedGame(UINT8 const save_slot_id)
 #endif
 
 	//Load the gtactical status structure plus the current sector x,y,z
+	clock.enter(SAVED_GAME_PART_TACTICAL_STATUS, f);
 	LoadTacticalStatusFromSavedGame(f, stracLinuxFormat);
 
 	//This gets reset by the above function
@@ -658,6 +1389,7 @@ void LoadSavedGame(UINT8 const save_slot_id)
 	}
 
 	//if the world was loaded when saved, reload it, otherwise dont
+	clock.enter(SAVED_GAME_PART_WORLD, f);
 	if (SaveGameHeader.fWorldLoaded || version < 50)
 	{
 		//Get the current world sector coordinates
@@ -701,18 +1433,23 @@ void LoadSavedGame(UINT8 const save_slot_id)
 	uiRelStartPerc = uiRelEndPerc)                                             \
 
 	BAR(1, L"Strategic Events...");
+	clock.enter(SAVED_GAME_PART_EVENTS, f);
 	LoadStrategicEventsFromSavedGame(f);
 
 	BAR(0, L"Laptop Info");
+	clock.enter(SAVED_GAME_PART_LAPTOP, f);
 	LoadLaptopInfoFromSavedGame(f);
 
 	BAR(0, L"Merc Profiles...");
+	clock.enter(SAVED_GAME_PART_PROFILES, f);
 	LoadSavedMercProfiles(f, version, stracLinuxFormat);
 
 	BAR(30, L"Soldier Structure...");
+	clock.enter(SAVED_GAME_PART_SOLDIERS, f);
 	LoadSoldierStructure(f, version, stracLinuxFormat);
 
 	BAR(1, L"Finances Data File...");
+	clock.enter(SAVED_GAME_PART_LAPTOP, f);
 	LoadTempFileFromSavedGame(NEWTMP_FINANCES_DATA_FILE, f);
 
 	BAR(1, L"History File...");
@@ -725,6 +1462,7 @@ void LoadSavedGame(UINT8 const save_slot_id)
 	LoadEmailFromSavedGame(f);
 
 	BAR(1, L"Strategic Information...");
+	clock.enter(SAVED_GAME_PART_STRATEGIC, f);
 	LoadStrategicInfoFromSavedFile(f);
 
 	BAR(1, L"UnderGround Information...");
@@ -737,15 +1475,19 @@ void LoadSavedGame(UINT8 const save_slot_id)
 	LoadStrategicMovementGroupsFromSavedGameFile(f);
 
 	BAR(30, L"All the Map Temp files...");
+	clock.enter(SAVED_GAME_PART_TEMP_FILES, f);
 	LoadMapTempFilesFromSavedGameFile(f, version);
 
 	BAR(1, L"Quest Info...");
+	clock.enter(SAVED_GAME_PART_GENERAL, f);
 	LoadQuestInfoFromSavedGameFile(f);
 
 	BAR(1, L"OppList Info...");
+	clock.enter(SAVED_GAME_PART_OPPLISTS, f);
 	LoadOppListInfoFromSavedGame(f);
 
 	BAR(1, L"MapScreen Messages...");
+	clock.enter(SAVED_GAME_PART_GENERAL, f);
 	LoadMapScreenMessagesFromSaveGameFile(f, stracLinuxFormat);
 
 	BAR(1, L"NPC Info...");
@@ -942,6 +1684,7 @@ void LoadSavedGame(UINT8 const save_slot_id)
 	}
 
 	// if the world is loaded, apply the temp files to the loaded map
+	clock.enter(SAVED_GAME_PART_WORLD, f);
 	if (SaveGameHeader.fWorldLoaded || version < 50)
 	{
 		try
@@ -963,6 +1706,7 @@ void LoadSavedGame(UINT8 const save_slot_id)
 	UpdateMercsInSector();
 
 	PostSchedules();
+	clock.stop();
 
 	BAR(1, L"Final Checks...");
 
@@ -1110,8 +1854,10 @@ void LoadSavedGame(UINT8 const save_slot_id)
 	// fix squads
 	CheckSquadMovementGroups();
 
-	/* The above function LightSetBaseLevel adjusts ALL the level node light
-	 * values including the merc node, we must reset the values */
+	/* LightSetBaseLevel() above leaves the tiles alone, they follow the ambient
+	 * level by themselves (see SHADE_AMBIENT and LightNodeShade()). But it
+	 * recreates the lights of all our mercs, so take them away again if the
+	 * player turned the merc lights off */
 	HandlePlayerTogglingLightEffects(FALSE);
 
 	// on loading a gamestate or getting ambushed from the StrategicMap
@@ -1306,6 +2052,7 @@ static void LoadSoldierStructure(HWFILE const f, UINT32 savegame_version, bool s
 
 void BackupSavedGame(UINT8 const ubSaveGameID)
 {
+	WaitForSaveGameWrite();
 	std::string backupdir = FileMan::joinPaths(GCM->getSavedGamesFolder().c_str(),"Backup");
 	FileMan::createDir(backupdir.c_str());
 	char zSourceSaveGameName[512];
@@ -1330,6 +2077,21 @@ void BackupSavedGame(UINT8 const ubSaveGameID)
 												FileMan::joinPaths(backupdir,zTargetSaveGameName).c_str());
 		}
 	}
+
+	/* A delta takes a copy of its base along, as the one next to the slot is
+	 * replaced later. Bases no backup refers to any more are deleted. */
+	std::set<std::string> bases;
+	for (int i = 1; i <= NUM_SAVE_GAME_BACKUPS; ++i)
+	{
+		sprintf(zTargetSaveGameName, "%s.%01d", zSourceSaveGameName, i);
+		std::string const base_name = ReadSavedGameBaseName(FileMan::joinPaths(backupdir, zTargetSaveGameName));
+		if (base_name.empty()) continue;
+		bases.insert(base_name);
+		if (FileMan::checkFileExistance(backupdir.c_str(), base_name.c_str())) continue;
+		FileMan::copyFile(FileMan::joinPaths(GCM->getSavedGamesFolder(), base_name).c_str(),
+											FileMan::joinPaths(backupdir, base_name).c_str());
+	}
+	DeleteAutosaveBases(FileMan::joinPaths(backupdir, zSourceSaveGameName), bases);
 }
 
 static void SaveFileToSavedGame(SGPFile* fileToSave, HWFILE const hFile)
@@ -1350,7 +2112,7 @@ static void SaveFileToSavedGame(SGPFile* fileToSave, HWFILE const hFile)
 	FileWrite(hFile, pData, uiFileSize);
 }
 
-static void SaveTempFileToSavedGame(const char* fileName, HWFILE const hFile)
+void SaveTempFileToSavedGame(const char* fileName, HWFILE const hFile)
 {
 	AutoSGPFile fileToSave(GCM->openTempFileForReading(fileName));
 	SaveFileToSavedGame(fileToSave, hFile);
@@ -1381,8 +2143,21 @@ static void LoadFileFromSavedGame(SGPFile* fileToWrite, HWFILE const hFile)
 
 void LoadTempFileFromSavedGame(const char* tempFileName, HWFILE const hFile)
 {
-	AutoSGPFile fileToWrite(GCM->openTempFileForWriting(tempFileName, true));
-	LoadFileFromSavedGame(fileToWrite, hFile);
+	// The temp file refers to the data in the saved game and is only copied out
+	// when it is opened, which for most sectors does not happen before the next
+	// load
+	std::shared_ptr<std::vector<BYTE> > const buffer = FileMan::getMemoryFileBuffer(hFile);
+
+	UINT32 uiFileSize;
+	FileRead(hFile, &uiFileSize, sizeof(UINT32));
+
+	size_t const pos = FileGetPos(hFile);
+	if (pos > buffer->size() || uiFileSize > buffer->size() - pos)
+	{
+		throw std::runtime_error("Damaged save game");
+	}
+	GCM->addTempFileReference(tempFileName, buffer, pos, uiFileSize);
+	FileSeek(hFile, uiFileSize, FILE_SEEK_FROM_CURRENT);
 }
 
 void LoadFilesFromSavedGame(char const* const pSrcFileName, HWFILE const hFile)
@@ -1465,6 +2240,8 @@ static void LoadOppListInfoFromSavedGame(HWFILE const hFile)
 {
 	UINT32	uiLoadSize=0;
 
+	++guiOppListVersion;
+
 	// Load the Public Opplist
 	uiLoadSize = MAXTEAMS * TOTAL_SOLDIERS;
 	FileRead(hFile, gbPublicOpplist, uiLoadSize);
@@ -1600,7 +2377,7 @@ void LoadMercPath(HWFILE const hFile, PathSt** const head)
 	PathSt* path = NULL;
 	for (UINT32 cnt = 0; cnt < uiNumOfNodes; ++cnt)
 	{
-		PathSt* const n = MALLOC(PathSt);
+		PathSt* const n = AllocPathNode();
 
 		BYTE data[20];
 		FileRead(hFile, data, sizeof(data));
@@ -2257,6 +3034,8 @@ INT8 GetNumberForAutoSave( BOOLEAN fLatestAutoSave )
 	fFile1Exist = FALSE;
 	fFile2Exist = FALSE;
 
+	WaitForSaveGameWrite();
+
 	//The name of the file
 	char zFileName1[256];
 	sprintf(zFileName1, "%s/Auto%02d.%s", GCM->getSavedGamesFolder().c_str(), 0, g_savegame_ext);
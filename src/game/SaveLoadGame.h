@@ -4,6 +4,11 @@
 #include "GameSettings.h"
 #include "ScreenIDs.h"
 
+#include <map>
+#include <string>
+#include <time.h>
+#include <vector>
+
 
 #define BYTESINMEGABYTE				1048576 //1024*1024
 #define REQUIRED_FREE_SPACE				(20 * BYTESINMEGABYTE)
@@ -20,6 +25,9 @@
 #define SAVED_GAME_HEADER_ON_DISK_SIZE			(432) // Size of SAVED_GAME_HEADER on disk in Vanilla and Stracciatella Windows
 #define SAVED_GAME_HEADER_ON_DISK_SIZE_STRAC_LIN	(688) // Size of SAVED_GAME_HEADER on disk in Stracciatella Linux
 
+#define SAVED_GAME_VERSION_PACKED			(101) // Since this version everything after the header is compressed
+#define SAVED_GAME_SECTION_SIZE			(256 * 1024) // Maximum uncompressed size of a section of a packed save game
+
 struct SAVED_GAME_HEADER
 {
 	UINT32	uiSavedGameVersion;
@@ -69,6 +77,72 @@ extern bool isValidSavedGameHeader(SAVED_GAME_HEADER& h);
  * Return \a stracLinuxFormat = true, when the file is in "Stracciatella Linux" format. */
 void ExtractSavedGameHeaderFromFile(HWFILE, SAVED_GAME_HEADER&, bool *stracLinuxFormat);
 
+/** @brief A save game which later save games can be written as deltas against. */
+struct SavedGameBase
+{
+	std::string       name; // File name of the base, which is next to the deltas
+	std::vector<BYTE> data; // Unpacked contents of the base
+};
+
+/** @brief Compress a save game which was written into a memory file.
+ * The header is kept as it is. It is followed by the number of sections, a
+ * directory with the uncompressed and the stored size of each section and the
+ * sections themselves. A section which does not get smaller is stored as it
+ * is. Sections end where the data says so rather than at fixed offsets, so a
+ * change in one part of the save game leaves the other sections alone.
+ * With a \a base only the sections which are not found in the base are stored,
+ * the others refer to the base. Returns a new memory file. */
+SGPFile* PackSavedGame(HWFILE, SavedGameBase const* base = 0);
+
+/** @brief Check if a save game was written by PackSavedGame(). */
+bool IsPackedSavedGame(HWFILE);
+
+/** @brief Get the file name of the base of a packed save game.
+ * Returns an empty string if the save game was written without a base. */
+std::string GetSavedGameBaseName(HWFILE);
+
+/** @brief Undo PackSavedGame().
+ * A delta needs its unpacked \a base. Returns a new memory file positioned at
+ * the start. Throws if the data is damaged or the base is missing or does not
+ * match. */
+SGPFile* UnpackSavedGame(HWFILE, HWFILE base = 0);
+
+/** @brief Headers of save games, kept with the modification time and size of
+ * the file they were read from.
+ * A header is only read from its save game again when the file has changed.
+ * The index is stored in a small file of its own, so the save/load screen does
+ * not have to open every save game after a restart either. */
+class SavedGameHeaderIndex
+{
+public:
+	explicit SavedGameHeaderIndex(std::string const& index_file);
+
+	/* Returns false if the save game is missing or its header can't be read. */
+	bool getHeader(char const* filename, SAVED_GAME_HEADER&);
+
+	/* Write the index file if it changed since it was read. */
+	void save();
+
+private:
+	struct Entry
+	{
+		time_t    mtime;
+		uintmax_t size;
+		bool      stracLinuxFormat;
+		BYTE      data[SAVED_GAME_HEADER_ON_DISK_SIZE_STRAC_LIN];
+	};
+
+	void load();
+
+	std::string                  file_;
+	std::map<std::string, Entry> entries_;
+	bool                         loaded_;
+	bool                         dirty_;
+};
+
+/** @brief The header index of the save games folder. */
+SavedGameHeaderIndex& GetSavedGameHeaderIndex();
+
 
 extern ScreenID guiScreenToGotoAfterLoadingSavedGame;
 
@@ -78,11 +152,66 @@ void CreateSavedGameFileNameFromNumber(UINT8 ubSaveGameID, char* pzNewFileName);
 BOOLEAN SaveGame( UINT8 ubSaveGameID, const wchar_t *pGameDesc );
 void    LoadSavedGame(UINT8 save_slot_id);
 
+/** @brief Read a save game file into memory and unpack it, using its base if
+ * it is a delta. Returns a memory file positioned at the start. */
+SGPFile* ReadSavedGame(char const* path);
+
+/* The parts of a save game which SaveGame() and LoadSavedGame() time apart. */
+enum SavedGamePart
+{
+	SAVED_GAME_PART_WORLD,           // the loaded sector, before saving and after loading
+	SAVED_GAME_PART_HEADER,
+	SAVED_GAME_PART_TACTICAL_STATUS, // with the game clock
+	SAVED_GAME_PART_EVENTS,
+	SAVED_GAME_PART_LAPTOP,          // with finances, history, files and emails
+	SAVED_GAME_PART_PROFILES,
+	SAVED_GAME_PART_SOLDIERS,
+	SAVED_GAME_PART_STRATEGIC,       // sectors, squads and movement groups
+	SAVED_GAME_PART_TEMP_FILES,
+	SAVED_GAME_PART_OPPLISTS,
+	SAVED_GAME_PART_GENERAL,         // everything else
+	SAVED_GAME_PART_PACKING,         // compressing and reading or writing the file
+	NUM_SAVED_GAME_PARTS
+};
+
+/* The bytes written and read and the time spent on one part of the save game
+ * since the last reset, for benchmarking. */
+struct SavedGamePartStats
+{
+	UINT32   save_bytes;
+	uint64_t save_ticks; // SDL performance counter ticks
+	UINT32   load_bytes;
+	uint64_t load_ticks;
+};
+
+SavedGamePartStats const& GetSavedGamePartStats(SavedGamePart);
+char const* GetSavedGamePartName(SavedGamePart);
+void ResetSavedGamePartStats();
+
+/* SaveGame() only snapshots the game, the save game file is written in the
+ * background. PollSaveGameWrite() reports a failed write once it is finished,
+ * WaitForSaveGameWrite() waits for it first. Anything touching the save game
+ * files has to wait. */
+void PollSaveGameWrite();
+void WaitForSaveGameWrite();
+
 void BackupSavedGame(UINT8 const ubSaveGameID);
 
+/* Deletes a save game, and the base of an autosave with it. */
+void DeleteSavedGame(char const* path);
+
+/* Deletes the autosave bases which no autosave refers to, e.g. after a base
+ * was written but the delta against it was not. */
+void DeleteUnusedAutosaveBases();
+
 void SaveFilesToSavedGame(char const* pSrcFileName, HWFILE);
 void LoadFilesFromSavedGame(char const* pSrcFileName, HWFILE);
 
+void SaveTempFileToSavedGame(char const* fileName, HWFILE);
+/* The saved game must be a memory file, whose buffer is kept until the temp
+ * file is opened. */
+void LoadTempFileFromSavedGame(char const* tempFileName, HWFILE);
+
 void GetBestPossibleSectorXYZValues(INT16* psSectorX, INT16* psSectorY, INT8* pbSectorZ);
 
 void SaveMercPath(HWFILE, PathSt const* head);
@@ -4,6 +4,9 @@
 #include "SaveLoadGame.h"
 #include "FileMan.h"
 #include "externalized/TestUtils.h"
+#include "boost/filesystem.hpp"
+
+#include <stdexcept>
 
 const uint8_t s_savedGameHeaderVanilla[] = {
 	0x63,0x00,0x00,0x00,0x42,0x75,0x69,0x6c,0x64,0x20,0x30,0x34,0x2e,0x31,0x32,0x2e,
@@ -281,3 +284,126 @@ TEST(SaveLoadGameTest, parseHeaderMac)
 		EXPECT_EQ(header.sInitialGameOptions.ubGameSaveMode,          0);
 	}
 }
+
+TEST(SaveLoadGameTest, packedSaveGame)
+{
+	std::vector<BYTE> data(s_savedGameHeaderVanilla, s_savedGameHeaderVanilla + sizeof(s_savedGameHeaderVanilla));
+	data[0] = SAVED_GAME_VERSION_PACKED;
+	UINT32 seed = 1;
+	for (UINT i = 0; i != SAVED_GAME_SECTION_SIZE * 2 + 1000; ++i)
+	{
+		seed = seed * 1103515245 + 12345;
+		data.push_back(i < SAVED_GAME_SECTION_SIZE ? (BYTE)(i % 100) : (BYTE)(seed >> 16));
+	}
+
+	AutoSGPFile plain(FileMan::openInMemory());
+	FileWrite(plain, data.data(), data.size());
+
+	AutoSGPFile packed(PackSavedGame(plain));
+	ASSERT_EQ(IsPackedSavedGame(packed), true);
+	EXPECT_LT(FileGetSize(packed), data.size() - SAVED_GAME_SECTION_SIZE / 2);
+
+	// The save/load screen still reads the header directly
+	SAVED_GAME_HEADER header;
+	bool stracLinuxFormat;
+	ExtractSavedGameHeaderFromFile(packed, header, &stracLinuxFormat);
+	EXPECT_EQ(stracLinuxFormat, false);
+	EXPECT_EQ(header.uiSavedGameVersion, static_cast<UINT32>(SAVED_GAME_VERSION_PACKED));
+	EXPECT_EQ(header.iCurrentBalance,    13030);
+
+	AutoSGPFile unpacked(UnpackSavedGame(packed));
+	EXPECT_EQ(FileMan::getMemoryFileData(unpacked), data);
+
+	// Older save games are not packed
+	AutoSGPFile old(FileMan::openInMemory());
+	FileWrite(old, s_savedGameHeaderVanilla, sizeof(s_savedGameHeaderVanilla));
+	EXPECT_EQ(IsPackedSavedGame(old), false);
+}
+
+TEST(SaveLoadGameTest, headerIndex)
+{
+	boost::filesystem::path tmpDir = boost::filesystem::temp_directory_path();
+	tmpDir /= boost::filesystem::unique_path();
+	boost::filesystem::create_directories(tmpDir);
+	std::string const save  = (tmpDir / "SaveGame01.sav").string();
+	std::string const index = (tmpDir / "headers.idx").string();
+
+	{
+		AutoSGPFile f(FileMan::openForWriting(save.c_str()));
+		FileWrite(f, s_savedGameHeaderVanilla, sizeof(s_savedGameHeaderVanilla));
+	}
+	time_t const mtime = boost::filesystem::last_write_time(save);
+
+	SAVED_GAME_HEADER header;
+	{
+		SavedGameHeaderIndex headers(index);
+		ASSERT_EQ(headers.getHeader(save.c_str(), header), true);
+		EXPECT_EQ(header.iCurrentBalance, 13030);
+		headers.save();
+	}
+
+	// Change the save game behind the index's back, it is not read again
+	{
+		BYTE data[sizeof(s_savedGameHeaderVanilla)];
+		memcpy(data, s_savedGameHeaderVanilla, sizeof(data));
+		data[0x124] ^= 0xFF; // iCurrentBalance
+		AutoSGPFile f(FileMan::openForWriting(save.c_str()));
+		FileWrite(f, data, sizeof(data));
+	}
+	boost::filesystem::last_write_time(save, mtime);
+	{
+		SavedGameHeaderIndex headers(index);
+		ASSERT_EQ(headers.getHeader(save.c_str(), header), true);
+		EXPECT_EQ(header.iCurrentBalance, 13030);
+
+		// Until its modification time changes
+		boost::filesystem::last_write_time(save, mtime + 10);
+		ASSERT_EQ(headers.getHeader(save.c_str(), header), true);
+		EXPECT_NE(header.iCurrentBalance, 13030);
+
+		boost::filesystem::remove(save);
+		EXPECT_EQ(headers.getHeader(save.c_str(), header), false);
+	}
+
+	boost::filesystem::remove_all(tmpDir);
+}
+
+TEST(SaveLoadGameTest, deltaSaveGame)
+{
+	std::vector<BYTE> data(s_savedGameHeaderVanilla, s_savedGameHeaderVanilla + sizeof(s_savedGameHeaderVanilla));
+	data[0] = SAVED_GAME_VERSION_PACKED;
+	UINT32 seed = 1;
+	for (UINT i = 0; i != SAVED_GAME_SECTION_SIZE * 4; ++i)
+	{
+		seed = seed * 1103515245 + 12345;
+		data.push_back((BYTE)(seed >> 16));
+	}
+
+	SavedGameBase base;
+	base.name = "Auto00.base";
+	base.data = data;
+
+	// Change a few bytes and insert some, the sections after them still match
+	data[SAVED_GAME_SECTION_SIZE] ^= 0xFF;
+	data.insert(data.begin() + SAVED_GAME_SECTION_SIZE * 2, 100, 0x42);
+
+	AutoSGPFile plain(FileMan::openInMemory());
+	FileWrite(plain, data.data(), data.size());
+	AutoSGPFile full(PackSavedGame(plain));
+	AutoSGPFile delta(PackSavedGame(plain, &base));
+	ASSERT_EQ(IsPackedSavedGame(delta), true);
+	EXPECT_LT(FileGetSize(delta), FileGetSize(full) / 2);
+	EXPECT_EQ(GetSavedGameBaseName(full),  "");
+	EXPECT_EQ(GetSavedGameBaseName(delta), "Auto00.base");
+
+	AutoSGPFile base_file(FileMan::openInMemory());
+	FileWrite(base_file, base.data.data(), base.data.size());
+	AutoSGPFile unpacked(UnpackSavedGame(delta, base_file));
+	EXPECT_EQ(FileMan::getMemoryFileData(unpacked), data);
+
+	// The base is required and must be the one the delta was written against
+	EXPECT_THROW(UnpackSavedGame(delta), std::runtime_error);
+	AutoSGPFile other_base(FileMan::openInMemory());
+	FileWrite(other_base, data.data(), data.size());
+	EXPECT_THROW(UnpackSavedGame(delta, other_base), std::runtime_error);
+}
@@ -644,6 +644,9 @@ static void ExitSaveLoadScreen(void)
 
 	MSYS_RemoveRegion( &gSLSEntireScreenRegion );
 
+	// Keep the headers read on this visit for the next one
+	GetSavedGameHeaderIndex().save();
+
 	gfSaveLoadScreenEntry = TRUE;
 	gfSaveLoadScreenExit = FALSE;
 
@@ -1121,19 +1124,16 @@ static BOOLEAN LoadSavedGameHeader(const INT8 bEntry, SAVED_GAME_HEADER* const h
 	// make sure the entry is valid
 	if (0 <= bEntry && bEntry < NUM_SAVE_GAMES)
 	{
+		WaitForSaveGameWrite();
 		char zSavedGameName[512];
 		CreateSavedGameFileNameFromNumber(gfActiveTab ? (bEntry + NUM_SAVE_GAMES) : bEntry, zSavedGameName);
 
-		try
+		if (GetSavedGameHeaderIndex().getHeader(zSavedGameName, *header))
 		{
-			bool stracLinuxFormat;
-			AutoSGPFile f(GCM->openUserPrivateFileForReading(zSavedGameName));
-			ExtractSavedGameHeaderFromFile(f, *header, &stracLinuxFormat);
 			endof(header->zGameVersionNumber)[-1] =  '\0';
 			endof(header->sSavedGameDesc)[-1]     = L'\0';
 			return TRUE;
 		}
-		catch (...) { /* Handled below */ }
 
 		gbSaveGameArray[bEntry] = FALSE;
 	}
@@ -1498,6 +1498,7 @@ static void DeleteAllSaveGameFile(void)
 	{
 		DeleteSaveGameNumber( cnt );
 	}
+	DeleteUnusedAutosaveBases();
 
 	gGameSettings.bLastSavedGameSlot = -1;
 
@@ -1507,9 +1508,10 @@ static void DeleteAllSaveGameFile(void)
 
 void DeleteSaveGameNumber(UINT8 const save_slot_id)
 {
+	WaitForSaveGameWrite();
 	char filename[512];
 	CreateSavedGameFileNameFromNumber(save_slot_id, filename);
-	FileDelete(filename);
+	DeleteSavedGame(filename);
 }
 
 
@@ -1744,6 +1746,7 @@ void DoQuickLoad()
 
 bool AreThereAnySavedGameFiles()
 {
+	WaitForSaveGameWrite();
 	for (INT8 i = 0; i != (NUM_SAVE_GAMES_TABS * NUM_SAVE_GAMES); ++i)
 	{
 		char filename[512];
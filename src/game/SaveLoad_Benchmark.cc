@@ -0,0 +1,136 @@
+#include "SaveLoad_Benchmark.h"
+#include "Benchmark_Suite.h"
+#include "ContentManager.h"
+#include "FileMan.h"
+#include "GameInstance.h"
+#include "GameSettings.h"
+#include "Logger.h"
+#include "Profiler.h"
+#include "Random.h"
+#include "SaveLoadGame.h"
+#include "SaveLoadScreen.h"
+
+#include <SDL.h>
+
+#include <algorithm>
+#include <stdexcept>
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+
+// Both saves of a round trip start from the same random numbers
+#define BENCH_SEED 1
+
+
+// Loads the save game in the slot and saves it as the error save game
+static void LoadAndSave(UINT8 const slot, double& load_ms, double& save_ms)
+{
+	// Loading a game saves the current one first in dead is dead mode
+	gGameOptions.ubGameSaveMode = DIF_CAN_SAVE;
+	uint64_t start = SDL_GetPerformanceCounter();
+	LoadSavedGame(slot);
+	load_ms = TicksToMS(SDL_GetPerformanceCounter() - start);
+
+	SeedRandom(BENCH_SEED);
+	start = SDL_GetPerformanceCounter();
+	if (!SaveGame(SAVE__ERROR_NUM, L"Benchmark")) throw std::runtime_error("Saving failed");
+	WaitForSaveGameWrite();
+	save_ms = TicksToMS(SDL_GetPerformanceCounter() - start);
+}
+
+
+static std::vector<BYTE> ReadErrorSaveGame()
+{
+	char path[512];
+	CreateSavedGameFileNameFromNumber(SAVE__ERROR_NUM, path);
+	AutoSGPFile f(ReadSavedGame(path));
+	return FileMan::getMemoryFileData(f);
+}
+
+
+static void BenchmarkSaveGame(UINT8 const slot, FILE* const f)
+{
+	double load_ms;
+	double save_ms;
+	ResetSavedGamePartStats();
+	LoadAndSave(slot, load_ms, save_ms);
+
+	SavedGamePartStats parts[NUM_SAVED_GAME_PARTS];
+	for (UINT part = 0; part != NUM_SAVED_GAME_PARTS; ++part)
+	{
+		parts[part] = GetSavedGamePartStats(static_cast<SavedGamePart>(part));
+	}
+
+	char path[512];
+	CreateSavedGameFileNameFromNumber(SAVE__ERROR_NUM, path);
+	time_t    mtime;
+	uintmax_t packed_size = 0;
+	FileMan::getFileStamp(path, mtime, packed_size);
+	std::vector<BYTE> const first = ReadErrorSaveGame();
+
+	double round_trip_load_ms;
+	double round_trip_save_ms;
+	LoadAndSave(SAVE__ERROR_NUM, round_trip_load_ms, round_trip_save_ms);
+	std::vector<BYTE> const second = ReadErrorSaveGame();
+
+	// Where the saves first differ, or -1 if they are the same
+	INT32 mismatch = -1;
+	if (first != second)
+	{
+		size_t const n = std::min(first.size(), second.size());
+		mismatch = static_cast<INT32>(std::mismatch(first.begin(), first.begin() + n, second.begin()).first - first.begin());
+	}
+
+	SLOGI("Save/load benchmark, save game %u: loaded in %.1f ms, saved %u bytes (%u packed) in %.1f ms, round trip %s",
+		slot, load_ms, (UINT32)first.size(), (UINT32)packed_size, save_ms, mismatch < 0 ? "ok" : "differs");
+	std::string const name = "saveload." + std::to_string(slot);
+	RecordBenchmarkResult(name + ".load_ms", load_ms);
+	RecordBenchmarkResult(name + ".save_ms", save_ms);
+	if (mismatch >= 0)
+	{
+		SLOGW("Save/load benchmark, save game %u: the round trip differs at offset %d", slot, mismatch);
+	}
+	if (!f) return;
+
+	for (UINT part = 0; part != NUM_SAVED_GAME_PARTS; ++part)
+	{
+		SavedGamePartStats const& s = parts[part];
+		fprintf(f, "%u,%s,%u,%.3f,%u,%.3f,\n", slot, GetSavedGamePartName(static_cast<SavedGamePart>(part)),
+			s.save_bytes, TicksToMS(s.save_ticks), s.load_bytes, TicksToMS(s.load_ticks));
+	}
+	fprintf(f, "%u,total,%u,%.3f,%u,%.3f,%d\n", slot, (UINT32)first.size(), save_ms, (UINT32)packed_size, load_ms, mismatch);
+}
+
+
+void BenchmarkSaveLoad()
+{
+	std::string const path = GCM->getScreenshotFolder() + "/saveloadbench.csv";
+	FILE* const f = fopen(path.c_str(), "w");
+	if (!f) SLOGW("Failed to write the save/load benchmark %s", path.c_str());
+	if (f) fputs("save,part,save_bytes,save_ms,load_bytes,load_ms,round_trip_mismatch\n", f);
+
+	INT8 const last_slot = gGameSettings.bLastSavedGameSlot;
+	for (UINT8 slot = 0; slot != NUM_SAVE_GAMES; ++slot)
+	{
+		char save_path[512];
+		CreateSavedGameFileNameFromNumber(slot, save_path);
+		time_t    mtime;
+		uintmax_t size;
+		if (!FileMan::getFileStamp(save_path, mtime, size)) continue;
+
+		try
+		{
+			BenchmarkSaveGame(slot, f);
+		}
+		catch (std::exception const& e)
+		{
+			SLOGW("Save/load benchmark: save game %u failed: %s", slot, e.what());
+		}
+	}
+
+	// Loading the error save game made it the last one
+	gGameSettings.bLastSavedGameSlot = last_slot;
+	SaveGameSettings();
+	if (f) fclose(f);
+}
@@ -0,0 +1,14 @@
+#ifndef SAVELOAD_BENCHMARK_H
+#define SAVELOAD_BENCHMARK_H
+
+
+/* Loads every save game in the save/load screen slots in turn, saves it again
+ * and times both per part of the save game. The saved game is then loaded and
+ * saved once more, and the two saves are compared byte for byte, so anything
+ * which does not survive a round trip shows up. The saves go to the error save
+ * game, which is overwritten. The results are logged and written to
+ * saveloadbench.csv in the screenshot folder for comparing runs. The last save
+ * game checked stays loaded, so this is only to be run from the main menu. */
+void BenchmarkSaveLoad();
+
+#endif
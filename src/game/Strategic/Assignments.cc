@@ -75,6 +75,7 @@
 
 #include <algorithm>
 #include <iterator>
+#include <vector>
 
 // various reason an assignment can be aborted before completion
 enum AssignmentAbortReason
@@ -432,11 +433,95 @@ static INT8 FindRepairableItemOnOtherSoldier(const SOLDIERTYPE* pSoldier, UINT8
 static bool IsItemRepairable(UINT16 item_id, INT8 status);
 
 
+/* While the repairmen of a sector are at work, the inventory slots of the mercs
+ * there which hold something to repair or a jammed gun, one bit per slot. It is
+ * built when the sector's repairs begin and kept up to date by everything which
+ * repairs, unjams or moves items meanwhile, so the repair passes look at the
+ * damaged items only instead of going through every pocket again and again. */
+struct RepairSlots
+{
+	UINT32 damaged;
+	UINT32 jammed;
+};
+
+static_assert(NUM_INV_SLOTS <= 32, "one bit per inventory slot");
+
+static RepairSlots g_repair_slots[TOTAL_SOLDIERS];
+static bool        g_repair_slots_valid;
+
+
+static bool ObjectNeedsRepair(OBJECTTYPE const& o)
+{
+	for (UINT8 i = 0; i != o.ubNumberOfObjects; ++i)
+	{
+		if (IsItemRepairable(o.usItem, o.bStatus[i])) return true;
+	}
+	for (UINT8 i = 0; i != MAX_ATTACHMENTS; ++i)
+	{
+		if (o.usAttachItem[i] != NOTHING && IsItemRepairable(o.usAttachItem[i], o.bAttachStatus[i])) return true;
+	}
+	return false;
+}
+
+
+static bool ObjectIsJammedGun(OBJECTTYPE const& o)
+{
+	return GCM->getItem(o.usItem)->getItemClass() == IC_GUN && o.bGunAmmoStatus < 0;
+}
+
+
+static void UpdateRepairSlot(SOLDIERTYPE const& s, INT8 const slot)
+{
+	if (!g_repair_slots_valid) return;
+	RepairSlots&      r   = g_repair_slots[s.ubID];
+	OBJECTTYPE const& o   = s.inv[slot];
+	UINT32     const  bit = 1U << slot;
+	r.damaged = ObjectNeedsRepair(o) ? r.damaged | bit : r.damaged & ~bit;
+	r.jammed  = ObjectIsJammedGun(o) ? r.jammed  | bit : r.jammed  & ~bit;
+}
+
+
+static void UpdateRepairSlots(SOLDIERTYPE const& s)
+{
+	for (INT8 slot = 0; slot != NUM_INV_SLOTS; ++slot) UpdateRepairSlot(s, slot);
+}
+
+
+static UINT32 RepairPassSlots(UINT8 const pass)
+{
+	REPAIR_PASS_SLOTS_TYPE const& l = gRepairPassSlotList[pass];
+	UINT32 slots = 0;
+	for (UINT8 i = 0; i != l.ubChoices; ++i) slots |= 1U << l.bSlot[i];
+	return slots;
+}
+
+
 static BOOLEAN DoesCharacterHaveAnyItemsToRepair(SOLDIERTYPE const* const pSoldier, INT8 const bHighestPass)
 {
 	UINT8	ubItemsInPocket, ubObjectInPocketCounter;
 	UINT8 ubPassType;
 
+	if (g_repair_slots_valid)
+	{
+		RepairSlots const& own = g_repair_slots[pSoldier->ubID];
+		if (own.damaged != 0 || own.jammed != 0) return TRUE;
+		if (bHighestPass == -1) return FALSE;
+
+		UINT32 pass_slots = 0;
+		for (ubPassType = REPAIR_HANDS_AND_ARMOR; ubPassType <= (UINT8)bHighestPass; ++ubPassType)
+		{
+			pass_slots |= RepairPassSlots(ubPassType);
+		}
+		UINT32 const unjam_slots = (1U << (SMALLPOCK8POS + 1)) - (1U << HANDPOS);
+		CFOR_EACH_IN_TEAM(pOtherSoldier, OUR_TEAM)
+		{
+			RepairSlots const& other = g_repair_slots[pOtherSoldier->ubID];
+			if (!(other.jammed & unjam_slots) && !(other.damaged & pass_slots)) continue;
+			if (CanCharacterRepairAnotherSoldiersStuff(pSoldier, pOtherSoldier)) return TRUE;
+		}
+		return FALSE;
+	}
+
 	// check for jams
 	CFOR_EACH_SOLDIER_INV_SLOT(i, *pSoldier)
 	{
@@ -907,19 +992,27 @@ bool IsCharacterInTransit(SOLDIERTYPE const& s)
 
 
 static void CheckForAndHandleHospitalPatients(void);
-static void HandleDoctorsInSector(INT16 x, INT16 y, INT8 z);
+// The mercs of one sector, in team order
+typedef std::vector<SOLDIERTYPE*> SectorRoster;
+
+static void HandleDoctorsInSector(SectorRoster const&);
 static void HandleNaturalHealing(void);
-static void HandleRepairmenInSector(INT16 sX, INT16 sY, INT8 bZ);
+static void HandleRepairmenInSector(SectorRoster const&);
 static void HandleRestFatigueAndSleepStatus();
-static void HandleTrainingInSector(INT16 sMapX, INT16 sMapY, INT8 bZ);
+static void HandleTrainingInSector(INT16 sMapX, INT16 sMapY, INT8 bZ, SectorRoster const&);
 static void ReportTrainersTraineesWithoutPartners(void);
 static void UpdatePatientsWhoAreDoneHealing();
 
 
-void UpdateAssignments()
+// The order UpdateAssignments() handles the sectors in
+static UINT32 SectorOrder(SOLDIERTYPE const& s)
 {
-	INT8 sX,sY, bZ;
+	return (s.sSectorX * MAP_WORLD_Y + s.sSectorY) * 4 + s.bSectorZ;
+}
 
+
+void UpdateAssignments()
+{
 	// init sectors with soldiers list
 	InitSectorsWithSoldiersList( );
 
@@ -943,27 +1036,32 @@ void UpdateAssignments()
 	// check for mercs tired enough go to sleep, and wake up well-rested mercs
 	HandleRestFatigueAndSleepStatus( );
 
+	/* Sort the team by sector once, instead of scanning all of it for every
+	 * kind of assignment in every sector with somebody in it */
+	std::vector<SOLDIERTYPE*> team;
+	FOR_EACH_IN_TEAM(s, OUR_TEAM) team.push_back(s);
+	std::stable_sort(team.begin(), team.end(),
+		[](SOLDIERTYPE const* a, SOLDIERTYPE const* b) { return SectorOrder(*a) < SectorOrder(*b); });
+
 	// run through sectors and handle each type in sector
-	for(sX = 0 ; sX < MAP_WORLD_X; sX++ )
+	SectorRoster roster;
+	for (size_t i = 0; i != team.size();)
 	{
-		for( sY =0; sY < MAP_WORLD_X; sY++ )
+		SOLDIERTYPE const& first = *team[i];
+		roster.clear();
+		for (; i != team.size() && SectorOrder(*team[i]) == SectorOrder(first); ++i)
 		{
-			for( bZ = 0; bZ < 4; bZ++)
-			{
-				// is there anyone in this sector?
-				if (fSectorsWithSoldiers[sX + sY * MAP_WORLD_X][bZ])
-				{
-					// handle any doctors
-					HandleDoctorsInSector( sX, sY, bZ );
+			roster.push_back(team[i]);
+		}
 
-					// handle any repairmen
-					HandleRepairmenInSector( sX, sY, bZ );
+		// handle any doctors
+		HandleDoctorsInSector(roster);
 
-					// handle any training
-					HandleTrainingInSector( sX, sY, bZ );
-				}
-			}
-		}
+		// handle any repairmen
+		HandleRepairmenInSector(roster);
+
+		// handle any training
+		HandleTrainingInSector(first.sSectorX, first.sSectorY, first.bSectorZ, roster);
 	}
 
 	// check to see if anyone is done healing?
@@ -1181,17 +1279,14 @@ static void HealCharacters(SOLDIERTYPE* pDoctor);
 
 
 // handle doctor in this sector
-static void HandleDoctorsInSector(INT16 const x, INT16 const y, INT8 const z)
+static void HandleDoctorsInSector(SectorRoster const& roster)
 {
 	// will handle doctor/patient relationship in sector
 
 	// go through list of characters, find all doctors in sector
-	FOR_EACH_IN_TEAM(i, OUR_TEAM)
+	for (SOLDIERTYPE* const i : roster)
 	{
 		SOLDIERTYPE& s = *i;
-		if (s.sSectorX != x)         continue;
-		if (s.sSectorY != y)         continue;
-		if (s.bSectorZ != z)         continue;
 		if (s.bAssignment != DOCTOR) continue;
 		if (s.fMercAsleep)           continue;
 		MakeSureMedKitIsInHand(&s);
@@ -1590,18 +1685,29 @@ static void HandleRepairBySoldier(SOLDIERTYPE&);
 
 
 // handle any repair man in sector
-static void HandleRepairmenInSector(INT16 const x, INT16 const y, INT8 const z)
+static void HandleRepairmenInSector(SectorRoster const& roster)
 {
-	FOR_EACH_IN_TEAM(i, OUR_TEAM)
+	bool any_repairmen = false;
+	for (SOLDIERTYPE const* const s : roster)
+	{
+		if (s->bAssignment == REPAIR && !s->fMercAsleep) any_repairmen = true;
+	}
+	if (!any_repairmen) return;
+
+	/* Only the mercs of the sector are indexed, the repairmen cannot reach
+	 * anybody else's items */
+	std::fill(std::begin(g_repair_slots), std::end(g_repair_slots), RepairSlots{});
+	g_repair_slots_valid = true;
+	for (SOLDIERTYPE const* const s : roster) UpdateRepairSlots(*s);
+
+	for (SOLDIERTYPE* const i : roster)
 	{
 		SOLDIERTYPE& s = *i;
-		if (s.sSectorX    != x)      continue;
-		if (s.sSectorY    != y)      continue;
-		if (s.bSectorZ    != z)      continue;
 		if (s.bAssignment != REPAIR) continue;
 		if (s.fMercAsleep)           continue;
 
 		MakeSureToolKitIsInHand(&s);
+		UpdateRepairSlots(s);
 
 		// character is in sector, check if can repair
 		if (!CanCharacterRepair(&s))    continue;
@@ -1609,6 +1715,8 @@ static void HandleRepairmenInSector(INT16 const x, INT16 const y, INT8 const z)
 
 		HandleRepairBySoldier(s);
 	}
+
+	g_repair_slots_valid = false;
 }
 
 
@@ -1681,6 +1789,17 @@ static INT8 FindRepairableItemOnOtherSoldier(const SOLDIERTYPE* const pSoldier,
 
 	pPassList = &( gRepairPassSlotList[ ubPassType ] );
 
+	if (g_repair_slots_valid)
+	{
+		UINT32 const damaged = g_repair_slots[pSoldier->ubID].damaged;
+		if (!(damaged & RepairPassSlots(ubPassType))) return NO_SLOT;
+		for ( bLoop = 0; bLoop < pPassList->ubChoices; bLoop++ )
+		{
+			bSlotToCheck = pPassList->bSlot[ bLoop ];
+			if (damaged & 1U << bSlotToCheck) return bSlotToCheck;
+		}
+	}
+
 	for ( bLoop = 0; bLoop < pPassList->ubChoices; bLoop++ )
 	{
 		bSlotToCheck = pPassList->bSlot[ bLoop ];
@@ -1813,6 +1932,7 @@ static bool RepairObject(SOLDIERTYPE* const repairer, SOLDIERTYPE const* const o
 		if (*repair_pts_left == 0) break; // we're out of points!
 	}
 
+	if (something_was_repaired) UpdateRepairSlot(*owner, pObj - owner->inv);
 	return something_was_repaired;
 }
 
@@ -1925,6 +2045,7 @@ static void HandleRepairBySoldier(SOLDIERTYPE& s)
 		{
 			// kit item damaged/depleted, burn up points of toolkit..which is in right hand
 			UseKitPoints(s.inv[HANDPOS], 1, s);
+			UpdateRepairSlot(s, HANDPOS);
 		}
 	}
 
@@ -2056,13 +2177,11 @@ static BOOLEAN TrainTownInSector(SOLDIERTYPE* pTrainer, INT16 sMapX, INT16 sMapY
 
 
 // ONCE PER HOUR, will handle ALL kinds of training (self, teaching, and town) in this sector
-static void HandleTrainingInSector(const INT16 sMapX, const INT16 sMapY, const INT8 bZ)
+static void HandleTrainingInSector(const INT16 sMapX, const INT16 sMapY, const INT8 bZ, SectorRoster const& roster)
 {
-	UINT8 ubStat;
 	BOOLEAN fAtGunRange = FALSE;
 	INT16 sTotalTrainingPts = 0;
 	INT16 sTrainingPtsDueToInstructor = 0;
-	INT16 sBestTrainingPts;
 	INT16 sTownTrainingPts;
 	TOWN_TRAINER_TYPE TownTrainer[ MAX_CHARACTER_COUNT ];
 	UINT8 ubTownTrainers;
@@ -2092,87 +2211,76 @@ static void HandleTrainingInSector(const INT16 sMapX, const INT16 sMapY, const I
 	// init trainer list
 	const SOLDIERTYPE* pStatTrainerList[NUM_TRAINABLE_STATS]; // can't have more "best" trainers than trainable stats
 	std::fill(std::begin(pStatTrainerList), std::end(pStatTrainerList), nullptr);
+	INT16 sBestTrainingPts[NUM_TRAINABLE_STATS];
+	std::fill(std::begin(sBestTrainingPts), std::end(sBestTrainingPts), -1);
 
 	// build list of teammate trainers in this sector.
 
 	// Only the trainer with the HIGHEST training ability in each stat is effective.  This is mainly to avoid having to
 	// sort them from highest to lowest if some form of trainer degradation formula was to be used for multiple trainers.
 
-	// for each trainable stat
-	for (ubStat = 0; ubStat < NUM_TRAINABLE_STATS; ubStat++)
+	// search the sector for active instructors, each trains one stat
+	for (SOLDIERTYPE const* const pTrainer : roster)
 	{
-		sBestTrainingPts = -1;
-
-		// search team for active instructors in this sector
-		CFOR_EACH_IN_TEAM(pTrainer, OUR_TEAM)
+		INT8 const ubStat = pTrainer->bTrainStat;
+		if (pTrainer->bAssignment == TRAIN_TEAMMATE &&
+				0 <= ubStat && ubStat < NUM_TRAINABLE_STATS &&
+				EnoughTimeOnAssignment(*pTrainer)       &&
+				!pTrainer->fMercAsleep)
 		{
-			if (pTrainer->sSectorX == sMapX && pTrainer->sSectorY == sMapY && pTrainer->bSectorZ == bZ)
-			{
-				// if he's training teammates in this stat
-				if (pTrainer->bAssignment == TRAIN_TEAMMATE &&
-						pTrainer->bTrainStat  == ubStat         &&
-						EnoughTimeOnAssignment(*pTrainer)       &&
-						!pTrainer->fMercAsleep)
-				{
-					sTrainingPtsDueToInstructor = GetBonusTrainingPtsDueToInstructor( pTrainer, NULL, ubStat, fAtGunRange, &usMaxPts );
+			sTrainingPtsDueToInstructor = GetBonusTrainingPtsDueToInstructor( pTrainer, NULL, ubStat, fAtGunRange, &usMaxPts );
 
-					// if he's the best trainer so far for this stat
-					if (sTrainingPtsDueToInstructor > sBestTrainingPts)
-					{
-						// then remember him as that, and the points he scored
-						pStatTrainerList[ ubStat ] = pTrainer;
-						sBestTrainingPts = sTrainingPtsDueToInstructor;
-					}
-				}
+			// if he's the best trainer so far for this stat
+			if (sTrainingPtsDueToInstructor > sBestTrainingPts[ ubStat ])
+			{
+				// then remember him as that, and the points he scored
+				pStatTrainerList[ ubStat ] = pTrainer;
+				sBestTrainingPts[ ubStat ] = sTrainingPtsDueToInstructor;
 			}
 		}
 	}
 
 
-	// now search team for active self-trainers in this sector
-	FOR_EACH_IN_TEAM(pStudent, OUR_TEAM)
+	// now search the sector for active self-trainers
+	for (SOLDIERTYPE* const pStudent : roster)
 	{
-		// see if this merc is active and in the same sector
-		if (pStudent->sSectorX == sMapX && pStudent->sSectorY == sMapY && pStudent->bSectorZ == bZ)
+		// if he's training himself (alone, or by others), then he's a student
+		if ( ( pStudent -> bAssignment == TRAIN_SELF ) || ( pStudent -> bAssignment == TRAIN_BY_OTHER ) )
 		{
-			// if he's training himself (alone, or by others), then he's a student
-			if ( ( pStudent -> bAssignment == TRAIN_SELF ) || ( pStudent -> bAssignment == TRAIN_BY_OTHER ) )
+			if (EnoughTimeOnAssignment(*pStudent) && !pStudent->fMercAsleep)
 			{
-				if (EnoughTimeOnAssignment(*pStudent) && !pStudent->fMercAsleep)
+				// figure out how much the grunt can learn in one training period
+				sTotalTrainingPts = GetSoldierTrainingPts( pStudent, pStudent -> bTrainStat, fAtGunRange, &usMaxPts );
+
+				// if he's getting help
+				if ( pStudent -> bAssignment == TRAIN_BY_OTHER )
 				{
-					// figure out how much the grunt can learn in one training period
-					sTotalTrainingPts = GetSoldierTrainingPts( pStudent, pStudent -> bTrainStat, fAtGunRange, &usMaxPts );
+					// grab the pointer to the (potential) trainer for this stat
+					const SOLDIERTYPE* const pTrainer = pStatTrainerList[pStudent->bTrainStat];
 
-					// if he's getting help
-					if ( pStudent -> bAssignment == TRAIN_BY_OTHER )
+					// if this stat HAS a trainer in sector at all
+					if (pTrainer != NULL)
 					{
-						// grab the pointer to the (potential) trainer for this stat
-						const SOLDIERTYPE* const pTrainer = pStatTrainerList[pStudent->bTrainStat];
-
-						// if this stat HAS a trainer in sector at all
-						if (pTrainer != NULL)
-						{
 /* Assignment distance limits removed.  Sep/11/98.  ARM
-							// if this sector either ISN'T currently loaded, or it is but the trainer is close enough to the student
-							if ( ( sMapX != gWorldSectorX ) || ( sMapY != gWorldSectorY ) || ( pStudent -> bSectorZ != gbWorldSectorZ ) ||
-									PythSpacesAway(pStudent->sGridNo, pTrainer->sGridNo) < MAX_DISTANCE_FOR_TRAINING &&
-									EnoughTimeOnAssignment(*pTrainer))
+						// if this sector either ISN'T currently loaded, or it is but the trainer is close enough to the student
+						if ( ( sMapX != gWorldSectorX ) || ( sMapY != gWorldSectorY ) || ( pStudent -> bSectorZ != gbWorldSectorZ ) ||
+								PythSpacesAway(pStudent->sGridNo, pTrainer->sGridNo) < MAX_DISTANCE_FOR_TRAINING &&
+								EnoughTimeOnAssignment(*pTrainer))
 */
-							// NB this EnoughTimeOnAssignment() call is redundent since it is called up above
-							//if (EnoughTimeOnAssignment(*pTrainer))
-							{
-								// valid trainer is available, this gives the student a large training bonus!
-								sTrainingPtsDueToInstructor = GetBonusTrainingPtsDueToInstructor( pTrainer, pStudent, pStudent -> bTrainStat, fAtGunRange, &usMaxPts );
+						// NB this EnoughTimeOnAssignment() call is redundent since it is called up above
+						//if (EnoughTimeOnAssignment(*pTrainer))
+						{
+							// valid trainer is available, this gives the student a large training bonus!
+							sTrainingPtsDueToInstructor = GetBonusTrainingPtsDueToInstructor( pTrainer, pStudent, pStudent -> bTrainStat, fAtGunRange, &usMaxPts );
 
-								// add the bonus to what merc can learn on his own
-								sTotalTrainingPts += sTrainingPtsDueToInstructor;
-							}
+							// add the bonus to what merc can learn on his own
+							sTotalTrainingPts += sTrainingPtsDueToInstructor;
 						}
 					}
-
-					// now finally train the grunt
-					TrainSoldierWithPts( pStudent, sTotalTrainingPts );
 				}
+
+				// now finally train the grunt
+				TrainSoldierWithPts( pStudent, sTotalTrainingPts );
 			}
 		}
 	}
@@ -2185,24 +2293,21 @@ static void HandleTrainingInSector(const INT16 sMapX, const INT16 sMapY, const I
 		ubTownTrainers = 0;
 
 		// build list of all the town trainers in this sector and their training pts
-		FOR_EACH_IN_TEAM(pTrainer, OUR_TEAM)
+		for (SOLDIERTYPE* const pTrainer : roster)
 		{
-			if (pTrainer->sSectorX == sMapX && pTrainer->sSectorY == sMapY && pTrainer->bSectorZ == bZ)
+			if (pTrainer->bAssignment == TRAIN_TOWN &&
+					EnoughTimeOnAssignment(*pTrainer)   &&
+					!pTrainer->fMercAsleep)
 			{
-				if (pTrainer->bAssignment == TRAIN_TOWN &&
-						EnoughTimeOnAssignment(*pTrainer)   &&
-						!pTrainer->fMercAsleep)
-				{
-					sTownTrainingPts = GetTownTrainPtsForCharacter( pTrainer, &usMaxPts );
+				sTownTrainingPts = GetTownTrainPtsForCharacter( pTrainer, &usMaxPts );
 
-					// if he's actually worth anything
-					if( sTownTrainingPts > 0 )
-					{
-						// remember this guy as a town trainer
-						TownTrainer[ubTownTrainers].sTrainingPts = sTownTrainingPts;
-						TownTrainer[ubTownTrainers].pSoldier = pTrainer;
-						ubTownTrainers++;
-					}
+				// if he's actually worth anything
+				if( sTownTrainingPts > 0 )
+				{
+					// remember this guy as a town trainer
+					TownTrainer[ubTownTrainers].sTrainingPts = sTownTrainingPts;
+					TownTrainer[ubTownTrainers].pSoldier = pTrainer;
+					ubTownTrainers++;
 				}
 			}
 		}
@@ -5588,10 +5693,7 @@ static void RepositionMouseRegions(void)
 	for (UINT32 i = 0; i < GetNumberOfLinesOfTextInBox(ghAssignmentBox); ++i)
 	{
 		MOUSE_REGION* const r = &gAssignmentMenuRegion[i];
-		r->RegionTopLeftX     += sDeltaX;
-		r->RegionTopLeftY     += sDeltaY;
-		r->RegionBottomRightX += sDeltaX;
-		r->RegionBottomRightY += sDeltaY;
+		r->MoveTo(r->RegionTopLeftX + sDeltaX, r->RegionTopLeftY + sDeltaY);
 	}
 
 	gfPausedTacticalRenderFlags = TRUE;
@@ -7333,6 +7435,7 @@ static BOOLEAN UnjamGunsOnSoldier(SOLDIERTYPE* pOwnerSoldier, SOLDIERTYPE* pRepa
 				*pubRepairPtsLeft -= REPAIR_COST_PER_JAM;
 
 				pOwnerSoldier->inv [ bPocket ].bGunAmmoStatus *= -1;
+				UpdateRepairSlot(*pOwnerSoldier, bPocket);
 
 				// MECHANICAL/DEXTERITY GAIN: Unjammed a gun
 				StatChange(*pRepairSoldier, MECHANAMT, 5, FROM_SUCCESS);
@@ -1,4 +1,8 @@
+#include <SDL.h>
+
 #include <stdexcept>
+#include <stdio.h>
+#include <string>
 
 #include "Directories.h"
 #include "Font.h"
@@ -71,7 +75,9 @@
 #include "Easings.h"
 #include "ContentManager.h"
 #include "GameInstance.h"
+#include "JAScreens.h"
 #include "Logger.h"
+#include "Profiler.h"
 
 //#define INVULNERABILITY
 
@@ -112,6 +118,18 @@ struct SOLDIERCELL
 	INT8 bWeaponSlot;
 };
 
+/* Progress of the fight within a frame. A frame which runs late leaves the
+ * remaining attackers of the current round for the next frame. */
+struct AUTORESOLVE_ROUND
+{
+	BOOLEAN fPending;
+	INT32 iTimeSlice; // battle time left to fight, 0x7fffffff to fight until the end
+	UINT32 uiSlice;   // battle time of the current round
+	INT32 iTotal;
+	INT32 iMercs, iCivs, iEnemies;
+	INT32 iMercsLeft, iCivsLeft, iEnemiesLeft;
+};
+
 struct AUTORESOLVE_STRUCT
 {
 	SOLDIERCELL *pRobotCell;
@@ -172,6 +190,9 @@ struct AUTORESOLVE_STRUCT
 	BOOLEAN fEnteringAutoResolve;
 	BOOLEAN fMoraleEventsHandled;
 	BOOLEAN fCaptureNotPermittedDueToEPCs;
+	BOOLEAN fHeadless; // simulated battle without the interface, see SimulateAutoResolveBattles()
+
+	AUTORESOLVE_ROUND round;
 
 	MOUSE_REGION AutoResolveRegion;
 };
@@ -404,7 +425,8 @@ static void DoTransitionFromPreBattleInterfaceToAutoResolve(void)
 	BlitBufferToBuffer(guiEXTRABUFFER, FRAME_BUFFER, x, y, w, h);
 
 	PlayJA2SampleFromFile(SOUNDSDIR "/laptop power up (8-11).wav", HIGHVOLUME, 1, MIDDLEPAN);
-	while( GetClock() <= uiEndTime )
+	// A fixed clock does not advance during the animation, so it is skipped then
+	while (!ClockIsFixed() && GetClock() <= uiEndTime)
 	{
 		FLOAT fEasingProgress = EaseInCubic(uiStartTime, uiEndTime, GetClock());
 
@@ -425,14 +447,9 @@ static void DoTransitionFromPreBattleInterfaceToAutoResolve(void)
 	}
 }
 
-void EnterAutoResolveMode( UINT8 ubSectorX, UINT8 ubSectorY )
+//Allocate memory for all the globals while we are in this mode.
+static void AllocateAutoResolve(UINT8 const ubSectorX, UINT8 const ubSectorY)
 {
-	//Set up mapscreen for removal
-	SetPendingNewScreen( AUTORESOLVE_SCREEN );
-	CreateDestroyMapInvButton();
-	RenderButtons();
-
-	//Allocate memory for all the globals while we are in this mode.
 	gpAR = MALLOCZ(AUTORESOLVE_STRUCT);
 	//Mercs -- 20 max
 	gpMercs = MALLOCNZ(SOLDIERCELL, 20);
@@ -441,8 +458,6 @@ void EnterAutoResolveMode( UINT8 ubSectorX, UINT8 ubSectorY )
 	//Enemies -- 32 max
 	gpEnemies = MALLOCNZ(SOLDIERCELL, 32);
 
-	//Set up autoresolve
-	gpAR->fEnteringAutoResolve = TRUE;
 	gpAR->ubSectorX = ubSectorX;
 	gpAR->ubSectorY = ubSectorY;
 	gpAR->ubBattleStatus = BATTLE_IN_PROGRESS;
@@ -451,6 +466,36 @@ void EnterAutoResolveMode( UINT8 ubSectorX, UINT8 ubSectorY )
 	gpAR->fSound = TRUE;
 	gpAR->fMoraleEventsHandled = FALSE;
 	gpAR->uiPreRandomIndex = guiPreRandomIndex;
+}
+
+
+// Everything internal to the globals should have already been deleted.
+static void FreeAutoResolve()
+{
+	MemFree(gpAR);
+	gpAR = 0;
+
+	MemFree(gpMercs);
+	gpMercs = 0;
+
+	MemFree(gpCivs);
+	gpCivs = 0;
+
+	MemFree(gpEnemies);
+	gpEnemies = 0;
+}
+
+
+void EnterAutoResolveMode( UINT8 ubSectorX, UINT8 ubSectorY )
+{
+	//Set up mapscreen for removal
+	SetPendingNewScreen( AUTORESOLVE_SCREEN );
+	CreateDestroyMapInvButton();
+	RenderButtons();
+
+	//Set up autoresolve
+	AllocateAutoResolve(ubSectorX, ubSectorY);
+	gpAR->fEnteringAutoResolve = TRUE;
 
 	//Determine who gets the defensive advantage
 	switch( gubEnemyEncounterCode )
@@ -480,6 +525,7 @@ static void DetermineTeamLeader(BOOLEAN fFriendlyTeam);
 static void HandleAutoResolveInput(void);
 static void ProcessBattleFrame(void);
 static void RemoveAutoResolveInterface(bool delete_for_good);
+static void ResolveBattleInstantly();
 
 
 ScreenID AutoResolveScreenHandle()
@@ -520,7 +566,15 @@ ScreenID AutoResolveScreenHandle()
 	}
 	else if (gpAR->ubBattleStatus == BATTLE_IN_PROGRESS)
 	{
-		ProcessBattleFrame();
+		// The Finish button fights the rest of the battle at once
+		if (gpAR->uiTimeSlice == 0xffffffff)
+		{
+			ResolveBattleInstantly();
+		}
+		else
+		{
+			ProcessBattleFrame();
+		}
 	}
 	HandleAutoResolveInput();
 	RenderAutoResolve();
@@ -1474,6 +1528,26 @@ static SOLDIERCELL* MakeEnemyTroops(SOLDIERCELL* cell, size_t n, AUTORESOLVE_STR
 }
 
 
+static SOLDIERCELL* MakeMilitia(SOLDIERCELL* cell, size_t n, AUTORESOLVE_STRUCT* const ar, SoldierClass const sc, UINT16 const face, UINT16 const female_face)
+{
+	for (; n != 0; --n, ++cell)
+	{
+		// reset counter of how many mortars this team has rolled
+		ResetMortarsOnTeamCount();
+
+		SOLDIERTYPE* const s = TacticalCreateMilitia(sc);
+		AssertMsg(s, "Failed to create militia soldier for autoresolve.");
+		cell->pSoldier       = s;
+		cell->uiVObjectID    = ar->iFaces;
+		cell->usIndex        = s->ubBodyType == REGFEMALE ? female_face : face;
+		s->sSectorX          = ar->ubSectorX;
+		s->sSectorY          = ar->ubSectorY;
+		wcslcpy(s->name, gpStrategicString[STR_AR_MILITIA_NAME], lengthof(s->name));
+	}
+	return cell;
+}
+
+
 static SOLDIERCELL* MakeCreatures(SOLDIERCELL* cell, size_t n, AUTORESOLVE_STRUCT* const ar, INT8 const body_type, UINT16 const face)
 {
 	for (; n != 0; --n, ++cell)
@@ -1560,43 +1634,13 @@ static void CreateAutoResolveInterface(void)
 			case 2:	++n_militia_green; break;
 		}
 	}
-	for (INT32 i = 0; i < ar->ubCivs; ++i)
 	{
-		// reset counter of how many mortars this team has rolled
-		ResetMortarsOnTeamCount();
-
-		SOLDIERTYPE*       s;
-		UINT16             idx;
-		if (i < n_militia_elite)
-		{
-			s   = TacticalCreateMilitia(SOLDIER_CLASS_ELITE_MILITIA);
-			idx = s->ubBodyType == REGFEMALE ? MILITIA3F_FACE : MILITIA3_FACE;
-		}
-		else if (i < n_militia_reg + n_militia_elite)
-		{
-			s   = TacticalCreateMilitia(SOLDIER_CLASS_REG_MILITIA);
-			idx = s->ubBodyType == REGFEMALE ? MILITIA2F_FACE : MILITIA2_FACE;
-		}
-		else if (i < n_militia_green + n_militia_reg + n_militia_elite)
-		{
-			s   = TacticalCreateMilitia(SOLDIER_CLASS_GREEN_MILITIA);
-			idx = s->ubBodyType == REGFEMALE ? MILITIA1F_FACE : MILITIA1_FACE;
-		}
-		else
-		{
-			SLOGA("Attempting to illegally create a militia soldier.");
-			s   = 0;
-			idx = 0;
-		}
-		SOLDIERCELL* const cell = &gpCivs[i];
-		cell->pSoldier    = s;
-		cell->usIndex     = idx;
-		cell->uiVObjectID = ar->iFaces;
-
-		AssertMsg(s, "Failed to create militia soldier for autoresolve.");
-		s->sSectorX = ar->ubSectorX;
-		s->sSectorY = ar->ubSectorY;
-		wcslcpy(s->name, gpStrategicString[STR_AR_MILITIA_NAME], lengthof(s->name));
+		UINT8 const n_elite = MIN(n_militia_elite, ar->ubCivs);
+		UINT8 const n_reg   = MIN(n_militia_reg,   ar->ubCivs - n_elite);
+		SOLDIERCELL* cell = gpCivs;
+		cell = MakeMilitia(cell, n_elite,                        ar, SOLDIER_CLASS_ELITE_MILITIA, MILITIA3_FACE, MILITIA3F_FACE);
+		cell = MakeMilitia(cell, n_reg,                          ar, SOLDIER_CLASS_REG_MILITIA,   MILITIA2_FACE, MILITIA2F_FACE);
+		cell = MakeMilitia(cell, ar->ubCivs - n_elite - n_reg, ar, SOLDIER_CLASS_GREEN_MILITIA, MILITIA1_FACE, MILITIA1F_FACE);
 	}
 
 	if (gubEnemyEncounterCode != CREATURE_ATTACK_CODE)
@@ -1876,18 +1920,7 @@ static void RemoveAutoResolveInterface(bool const delete_for_good)
 		WarpGameTime(ar.uiTotalElapsedBattleTimeInMilliseconds / 1000, WARPTIME_NO_PROCESSING_OF_EVENTS);
 
 		// Deallocate all of the global memory.
-		// Everything internal to them, should have already been deleted.
-		MemFree(gpAR);
-		gpAR = 0;
-
-		MemFree(gpMercs);
-		gpMercs = 0;
-
-		MemFree(gpCivs);
-		gpCivs = 0;
-
-		MemFree(gpEnemies);
-		gpEnemies = 0;
+		FreeAutoResolve();
 	}
 
 	//KM : Aug 09, 1999 Patch fix -- Would break future dialog while time compressing
@@ -2266,6 +2299,7 @@ static void ResetAutoResolveInterface(void)
 	gpAR->uiTimeSlice = 1000;
 	gpAR->uiTotalElapsedBattleTimeInMilliseconds = 0;
 	gpAR->uiCurrTime = 0;
+	gpAR->round = AUTORESOLVE_ROUND();
 	gpAR->fPlayerRejectedSurrenderOffer = FALSE;
 	gpAR->fPendingSurrender = FALSE;
 	CalculateRowsAndColumns();
@@ -3482,7 +3516,7 @@ static BOOLEAN IsBattleOver(void)
 			gpAR->pRobotCell->usAttack = 0;
 			if( iNumInvolvedMercs == 1 && !gpAR->ubAliveCivs )
 			{ //Robot is the only one left in battle, so instantly kill him.
-				DoMercBattleSound( pRobot, BATTLE_SOUND_DIE1 );
+				if (!gpAR->fHeadless) DoMercBattleSound( pRobot, BATTLE_SOUND_DIE1 );
 				pRobot->bLife = 0;
 				gpAR->ubAliveMercs--;
 				iNumInvolvedMercs = 0;
@@ -3505,13 +3539,14 @@ static BOOLEAN IsBattleOver(void)
 			FOR_EACH_AR_MERC(i)
 			{
 				if (!(i->uiFlags & CELL_EPC)) continue;
-				DoMercBattleSound(i->pSoldier, BATTLE_SOUND_DIE1);
+				if (!gpAR->fHeadless) DoMercBattleSound(i->pSoldier, BATTLE_SOUND_DIE1);
 				i->pSoldier->bLife = 0;
 				gpAR->ubAliveMercs--;
 			}
 		}
 		FOR_EACH_AR_ENEMY(i)
 		{
+			if (gpAR->fHeadless)         break;
 			if (i->pSoldier->bLife == 0) continue;
 			if (gubEnemyEncounterCode != CREATURE_ATTACK_CODE)
 			{
@@ -3624,6 +3659,7 @@ static BOOLEAN AttemptPlayerCapture(void)
 
 static void SetupDoneInterface(void)
 {
+	if (gpAR->fHeadless) return;
 	gpAR->fRenderAutoResolve = TRUE;
 
 	HideButton( gpAR->iButton[ PAUSE_BUTTON ] );
@@ -3707,99 +3743,68 @@ static void RejectSurrenderCallback(GUI_BUTTON* btn, INT32 reason)
 }
 
 
-static void ProcessBattleFrame(void)
+/* Fights the battle time in gpAR->round, without anything of the interface, so
+ * the battle is resolved the same whether it is watched, finished at once or
+ * simulated. A deadline in GetJA2Clock() time (0 for none) or a maximum number
+ * of attacks (negative for none) interrupts the round, which is then continued
+ * by the next call. */
+static void FightBattle(UINT32 const uiDeadline, INT32 const iMaxAttacks)
 {
+	AUTORESOLVE_ROUND& r = gpAR->round;
 	INT32 iRandom;
 	SOLDIERCELL *pAttacker, *pTarget;
-	UINT32 uiDiff;
-	static INT32 iTimeSlice = 0;
-	static BOOLEAN fContinue = FALSE;
-	static UINT32 uiSlice = 0;
-	static INT32 iTotal = 0;
-	static INT32 iMercs = 0;
-	static INT32 iCivs = 0;
-	static INT32 iEnemies = 0;
-	static INT32 iMercsLeft = 0;
-	static INT32 iCivsLeft = 0;
-	static INT32 iEnemiesLeft = 0;
 	BOOLEAN found = FALSE;
-	INT32 iTime, iAttacksThisFrame;
+	INT32 iTime;
+	INT32 iAttacksThisFrame = 0;
 
 	pAttacker = NULL;
-	iAttacksThisFrame = 0;
 
-	if( fContinue )
+	if( r.fPending )
 	{
-		gpAR->uiCurrTime = GetJA2Clock();
-		fContinue = FALSE;
+		r.fPending = FALSE;
 		goto CONTINUE_BATTLE;
 	}
-	//determine how much real-time has passed since the last frame
-	if( gpAR->uiCurrTime )
-	{
-		gpAR->uiPrevTime = gpAR->uiCurrTime;
-		gpAR->uiCurrTime = GetJA2Clock();
-	}
-	else
-	{
-		gpAR->uiCurrTime = GetJA2Clock();
-		return;
-	}
-	if( gpAR->fPaused )
-		return;
 
-	uiDiff = gpAR->uiCurrTime - gpAR->uiPrevTime;
-	if( gpAR->uiTimeSlice < 0xffffffff )
+	while( r.iTimeSlice > 0 )
 	{
-		iTimeSlice = uiDiff*gpAR->uiTimeSlice/1000;
-	}
-	else
-	{ //largest positive signed value
-		iTimeSlice = 0x7fffffff;
-	}
-
-	while( iTimeSlice > 0 )
-	{
-		uiSlice = MIN( iTimeSlice, 1000 );
+		r.uiSlice = MIN( r.iTimeSlice, 1000 );
 		if( gpAR->ubBattleStatus == BATTLE_IN_PROGRESS )
-			gpAR->uiTotalElapsedBattleTimeInMilliseconds += uiSlice;
+			gpAR->uiTotalElapsedBattleTimeInMilliseconds += r.uiSlice;
 
 		//Now process each of the players
-		iTotal   = gpAR->ubMercs + gpAR->ubCivs + gpAR->ubEnemies + 1;
-		iMercs   = iMercsLeft   = gpAR->ubMercs;
-		iCivs    = iCivsLeft    = gpAR->ubCivs;
-		iEnemies = iEnemiesLeft = gpAR->ubEnemies;
+		r.iTotal   = gpAR->ubMercs + gpAR->ubCivs + gpAR->ubEnemies + 1;
+		r.iMercs   = r.iMercsLeft   = gpAR->ubMercs;
+		r.iCivs    = r.iCivsLeft    = gpAR->ubCivs;
+		r.iEnemies = r.iEnemiesLeft = gpAR->ubEnemies;
 		FOR_EACH_AR_MERC(i)
 			i->uiFlags &= ~CELL_PROCESSED;
 		FOR_EACH_AR_CIV(i)
 			i->uiFlags &= ~CELL_PROCESSED;
 		FOR_EACH_AR_ENEMY(i)
 			i->uiFlags &= ~CELL_PROCESSED;
-		while( --iTotal )
+		while( --r.iTotal )
 		{
 			INT32 cnt;
-			if( (iTimeSlice != 0x7fffffff && GetJA2Clock() > gpAR->uiCurrTime+17) ||
-				(!gpAR->fInstantFinish && iAttacksThisFrame > (gpAR->ubMercs+gpAR->ubCivs+gpAR->ubEnemies)/4) )
-			{ //We have spent too much time in here.  In order to maintain 60FPS, we will
-				//leave now, which will allow for updating of the graphics (and mouse cursor),
-				//and all of the necessary locals are saved via static variables.  It'll check
-				//the fContinue flag, and goto the CONTINUE_BATTLE label the next time this function
-				//is called.
-				fContinue = TRUE;
+			if( (uiDeadline != 0 && GetJA2Clock() > uiDeadline) ||
+				(iMaxAttacks >= 0 && iAttacksThisFrame > iMaxAttacks) )
+			{ //We have spent too much time in here.  We will leave now, and the progress of the
+				//round is saved in gpAR->round.  It'll check the fPending flag, and goto the
+				//CONTINUE_BATTLE label the next time this function is called.
+				r.fPending = TRUE;
 				return;
 			}
 			CONTINUE_BATTLE:
 			if( IsBattleOver() || (gubEnemyEncounterCode != CREATURE_ATTACK_CODE && AttemptPlayerCapture()) )
 				return;
 
-			iRandom = PreRandom( iTotal );
+			iRandom = PreRandom( r.iTotal );
 			found = FALSE;
-			if( iMercs && iRandom < iMercsLeft )
+			if( r.iMercs && iRandom < r.iMercsLeft )
 			{
-				iMercsLeft--;
+				r.iMercsLeft--;
 				while( !found )
 				{
-					iRandom = PreRandom( iMercs );
+					iRandom = PreRandom( r.iMercs );
 					pAttacker = &gpMercs[ iRandom ];
 					if( !(pAttacker->uiFlags & CELL_PROCESSED ) )
 					{
@@ -3808,12 +3813,12 @@ static void ProcessBattleFrame(void)
 					}
 				}
 			}
-			else if( iCivs && iRandom < iMercsLeft + iCivsLeft )
+			else if( r.iCivs && iRandom < r.iMercsLeft + r.iCivsLeft )
 			{
-				iCivsLeft--;
+				r.iCivsLeft--;
 				while( !found )
 				{
-					iRandom = PreRandom( iCivs );
+					iRandom = PreRandom( r.iCivs );
 					pAttacker = &gpCivs[ iRandom ];
 					if( !(pAttacker->uiFlags & CELL_PROCESSED ) )
 					{
@@ -3822,12 +3827,12 @@ static void ProcessBattleFrame(void)
 					}
 				}
 			}
-			else if( iEnemies && iEnemiesLeft )
+			else if( r.iEnemies && r.iEnemiesLeft )
 			{
-				iEnemiesLeft--;
+				r.iEnemiesLeft--;
 				while( !found )
 				{
-					iRandom = PreRandom( iEnemies );
+					iRandom = PreRandom( r.iEnemies );
 					pAttacker = &gpEnemies[ iRandom ];
 					if( !(pAttacker->uiFlags & CELL_PROCESSED ) )
 					{
@@ -3846,7 +3851,7 @@ static void ProcessBattleFrame(void)
 					if( pAttacker->usNextHit[ cnt ] )
 					{
 						iTime = pAttacker->usNextHit[ cnt ];
-						iTime -= uiSlice;
+						iTime -= r.uiSlice;
 						if( iTime >= 0 )
 						{ //Bullet still on route.
 							pAttacker->usNextHit[ cnt ] = (UINT16)iTime;
@@ -3865,7 +3870,7 @@ static void ProcessBattleFrame(void)
 					continue; //can't attack if you are unconcious or not around (Or a live creature)
 			}
 			iTime = pAttacker->usNextAttack;
-			iTime -= uiSlice;
+			iTime -= r.uiSlice;
 			if( iTime > 0 )
 			{
 				pAttacker->usNextAttack = (UINT16)iTime;
@@ -3903,14 +3908,70 @@ static void ProcessBattleFrame(void)
 				}
 			}
 		}
-		if( iTimeSlice != 0x7fffffff )//|| !gpAR->fInstantFinish )
+		if( r.iTimeSlice != 0x7fffffff )
 		{
-			iTimeSlice -= 1000;
+			r.iTimeSlice -= 1000;
 		}
 	}
 }
 
 
+static void ProcessBattleFrame(void)
+{
+	AUTORESOLVE_ROUND& r = gpAR->round;
+	if( r.fPending )
+	{
+		gpAR->uiCurrTime = GetJA2Clock();
+	}
+	else
+	{
+		//determine how much real-time has passed since the last frame
+		if( gpAR->uiCurrTime )
+		{
+			gpAR->uiPrevTime = gpAR->uiCurrTime;
+			gpAR->uiCurrTime = GetJA2Clock();
+		}
+		else
+		{
+			gpAR->uiCurrTime = GetJA2Clock();
+			return;
+		}
+		if( gpAR->fPaused )
+			return;
+
+		UINT32 const uiDiff = gpAR->uiCurrTime - gpAR->uiPrevTime;
+		if( gpAR->uiTimeSlice < 0xffffffff )
+		{
+			r.iTimeSlice = uiDiff*gpAR->uiTimeSlice/1000;
+		}
+		else
+		{ //largest positive signed value
+			r.iTimeSlice = 0x7fffffff;
+		}
+	}
+
+	//In order to maintain 60FPS, a frame is left after 17ms or a quarter of the soldiers
+	//attacking, which allows for updating of the graphics (and mouse cursor).
+	UINT32 const uiDeadline  = r.iTimeSlice != 0x7fffffff ? gpAR->uiCurrTime + 17 : 0;
+	INT32  const iMaxAttacks = gpAR->fInstantFinish ? -1 : (gpAR->ubMercs + gpAR->ubCivs + gpAR->ubEnemies) / 4;
+	FightBattle(uiDeadline, iMaxAttacks);
+}
+
+
+/* Fights the rest of the battle at once. It only stops early when the player is
+ * offered to surrender. */
+static void ResolveBattleInstantly()
+{
+	AUTORESOLVE_ROUND& r = gpAR->round;
+	r.iTimeSlice = 0x7fffffff;
+	while (gpAR->ubBattleStatus == BATTLE_IN_PROGRESS && !gpAR->fPendingSurrender)
+	{
+		FightBattle(0, -1);
+	}
+	gpAR->uiPrevTime = gpAR->uiCurrTime = GetJA2Clock();
+}
+
+
 BOOLEAN IsAutoResolveActive()
 {
 	//is the autoresolve up or not?
@@ -4005,3 +4066,113 @@ static void AutoBandageFinishedCallback(MessageBoxReturnValue const ubResult)
 {
 	SetupDoneInterface();
 }
+
+
+static char const* const g_battle_status_names[] =
+{
+	"in_progress",
+	"victory",
+	"defeat",
+	"retreat",
+	"surrendered",
+	"captured"
+};
+
+
+static void SimulateBattle(UINT8 const n_elite_militia, UINT8 const n_reg_militia, UINT8 const n_green_militia, UINT8 const n_elites, UINT8 const n_troops, UINT8 const n_admins)
+{
+	AllocateAutoResolve(1, 1);
+	AUTORESOLVE_STRUCT* const ar = gpAR;
+	ar->fHeadless   = TRUE;
+	ar->fSound      = FALSE;
+	ar->uiTimeSlice = 0xffffffff;
+	ar->ubPlayerDefenceAdvantage = 21; // as for ENEMY_ENCOUNTER_CODE
+	ar->ubCivs      = n_elite_militia + n_reg_militia + n_green_militia;
+	ar->ubElites    = n_elites;
+	ar->ubTroops    = n_troops;
+	ar->ubAdmins    = n_admins;
+	ar->ubEnemies   = n_elites + n_troops + n_admins;
+
+	SOLDIERCELL* cell = gpCivs;
+	cell = MakeMilitia(cell, n_elite_militia, ar, SOLDIER_CLASS_ELITE_MILITIA, MILITIA3_FACE, MILITIA3F_FACE);
+	cell = MakeMilitia(cell, n_reg_militia,   ar, SOLDIER_CLASS_REG_MILITIA,   MILITIA2_FACE, MILITIA2F_FACE);
+	cell = MakeMilitia(cell, n_green_militia, ar, SOLDIER_CLASS_GREEN_MILITIA, MILITIA1_FACE, MILITIA1F_FACE);
+	cell = gpEnemies;
+	cell = MakeEnemyTroops(cell, n_elites, ar, SOLDIER_CLASS_ELITE,         ELITE_FACE, gpStrategicString[STR_AR_ELITE_NAME]);
+	cell = MakeEnemyTroops(cell, n_troops, ar, SOLDIER_CLASS_ARMY,          TROOP_FACE, gpStrategicString[STR_AR_TROOP_NAME]);
+	cell = MakeEnemyTroops(cell, n_admins, ar, SOLDIER_CLASS_ADMINISTRATOR, ADMIN_FACE, gpStrategicString[STR_AR_ADMINISTRATOR_NAME]);
+
+	CalculateRowsAndColumns();
+	CalculateSoldierCells(FALSE);
+	DetermineTeamLeader(TRUE);
+	DetermineTeamLeader(FALSE);
+	CalculateAttackValues();
+	ResolveBattleInstantly();
+}
+
+
+static void EndSimulatedBattle()
+{
+	FOR_EACH_AR_CIV(i)   TacticalRemoveSoldier(*i->pSoldier);
+	FOR_EACH_AR_ENEMY(i) TacticalRemoveSoldier(*i->pSoldier);
+	FreeAutoResolve();
+}
+
+
+void SimulateAutoResolveBattles(UINT32 const n_battles, UINT32 const seed)
+{
+	if (gpAR) return; // a battle is being resolved
+
+	std::string const path = GCM->getScreenshotFolder() + "/autoresolve.csv";
+	FILE* const f = fopen(path.c_str(), "w");
+	if (!f) SLOGW("Failed to write the auto-resolve simulation %s", path.c_str());
+	if (f) fputs("battle,elite_militia,regular_militia,green_militia,elites,troops,admins,result,militia_left,enemies_left,battle_s\n", f);
+
+	/* The soldiers are allocated outside of the tactical teams, as for every
+	 * auto-resolve battle, and not taken from a loaded sector. */
+	ScreenID const screen    = guiCurrentScreen;
+	BOOLEAN  const pbi       = gfPersistantPBI;
+	UINT8    const encounter = gubEnemyEncounterCode;
+	guiCurrentScreen      = AUTORESOLVE_SCREEN;
+	gfPersistantPBI       = TRUE;
+	gubEnemyEncounterCode = ENEMY_ENCOUNTER_CODE;
+	SeedRandom(seed);
+
+	UINT32   n_won     = 0;
+	UINT32   battle_s  = 0;
+	uint64_t const start = SDL_GetPerformanceCounter();
+	for (UINT32 i = 0; i != n_battles; ++i)
+	{
+		UINT8 const n_militia       = 1 + Random(MAX_ALLOWABLE_MILITIA_PER_SECTOR);
+		UINT8 const n_elite_militia = Random(n_militia + 1);
+		UINT8 const n_reg_militia   = Random(n_militia - n_elite_militia + 1);
+		UINT8 const n_enemies       = 1 + Random(32);
+		UINT8 const n_elites        = Random(n_enemies + 1);
+		UINT8 const n_troops        = Random(n_enemies - n_elites + 1);
+		SimulateBattle(n_elite_militia, n_reg_militia, n_militia - n_elite_militia - n_reg_militia,
+			n_elites, n_troops, n_enemies - n_elites - n_troops);
+
+		AUTORESOLVE_STRUCT const& ar = *gpAR;
+		if (ar.ubBattleStatus == BATTLE_VICTORY) ++n_won;
+		battle_s += ar.uiTotalElapsedBattleTimeInMilliseconds / 1000;
+		if (f)
+		{
+			fprintf(f, "%u,%u,%u,%u,%u,%u,%u,%s,%u,%u,%u\n", i,
+				n_elite_militia, n_reg_militia, n_militia - n_elite_militia - n_reg_militia,
+				n_elites, n_troops, n_enemies - n_elites - n_troops,
+				g_battle_status_names[ar.ubBattleStatus], ar.ubAliveCivs, ar.ubAliveEnemies,
+				ar.uiTotalElapsedBattleTimeInMilliseconds / 1000);
+		}
+		EndSimulatedBattle();
+	}
+	double const ms = MSSince(start);
+
+	guiCurrentScreen      = screen;
+	gfPersistantPBI       = pbi;
+	gubEnemyEncounterCode = encounter;
+	InitializeRandom();
+	if (f) fclose(f);
+
+	SLOGI("Simulated %u auto-resolve battles in %.1f ms: militia won %u, %u s of battle time in total",
+		n_battles, ms, n_won, battle_s);
+}
@@ -29,4 +29,11 @@ BOOLEAN GetCurrentBattleSectorXYZAndReturnTRUEIfThereIsABattle(INT16* psSectorX,
 
 ScreenID AutoResolveScreenHandle(void);
 
+/* Fights the given number of battles between militia and enemy troops of
+ * random strength and rank without the interface and without any effect on the
+ * campaign, for balance testing and benchmarking. The same seed fights the same
+ * battles. Every battle is written to autoresolve.csv in the screenshot folder
+ * and a summary is logged. Random() is seeded from the clock again afterwards. */
+void SimulateAutoResolveBattles(UINT32 n_battles, UINT32 seed);
+
 #endif
@@ -30,6 +30,7 @@ static UNDERGROUND_SECTORINFO* NewUndergroundNode(UINT8 const x, UINT8 const y,
 	UNDERGROUND_SECTORINFO*& tail = gpUndergroundSectorInfoTail;
 	*(tail ? &tail->next : &gpUndergroundSectorInfoHead) = u;
 	tail = u;
+	IndexUnderGroundSector(u);
 
 	return u;
 }
@@ -83,6 +84,7 @@ void TrashUndergroundSectorInfo()
 	}
 	gpUndergroundSectorInfoHead = NULL;
 	gpUndergroundSectorInfoTail = NULL;
+	ClearUnderGroundSectorIndex();
 }
 
 //Defines the sectors that can be occupied by enemies, creatures, etc.  It also
@@ -268,3 +270,25 @@ void InitNewCampaign()
 	InitStrategicStatus();
 
 }
+
+
+#ifdef WITH_UNITTESTS
+#include "gtest/gtest.h"
+
+TEST(CampaignInit, undergroundSectorIndex)
+{
+	BuildUndergroundSectorInfoList();
+	UINT32 n = 0;
+	for (UNDERGROUND_SECTORINFO* u = gpUndergroundSectorInfoHead; u; u = u->next, ++n)
+	{
+		EXPECT_EQ(FindUnderGroundSector(u->ubSectorX, u->ubSectorY, u->ubSectorZ), u);
+	}
+	EXPECT_NE(n, 0u);
+	EXPECT_EQ(FindUnderGroundSector(1, 1, 1), (UNDERGROUND_SECTORINFO*)0);
+	EXPECT_EQ(FindUnderGroundSector(10, 1, 0), (UNDERGROUND_SECTORINFO*)0);
+
+	TrashUndergroundSectorInfo();
+	EXPECT_EQ(FindUnderGroundSector(10, 1, 1), (UNDERGROUND_SECTORINFO*)0);
+}
+
+#endif
@@ -98,13 +98,12 @@ enum
 	MINE_EXIT,		//the area that creatures can initiate town attacks if lots of monsters.
 };
 
-struct CREATURE_DIRECTIVE
-{
-	CREATURE_DIRECTIVE*     next;
-	UNDERGROUND_SECTORINFO *pLevel;
-};
+/* The sectors of the active lair, ordered by their distance from the queen.
+ * The distance of a sector is its index. */
+#define MAX_LAIR_SECTORS 8
 
-CREATURE_DIRECTIVE *lair;
+static UNDERGROUND_SECTORINFO* g_lair[MAX_LAIR_SECTORS];
+static UINT                    g_n_lair_sectors;
 INT32 giHabitatedDistance = 0;
 INT32 giPopulationModifier = 0;
 INT32 giLairID = 0;
@@ -123,122 +122,82 @@ UINT8 gubCreatureBattleCode = CREATURE_BATTLE_CODE_NONE;
 UINT8 gubSectorIDOfCreatureAttack = 0;
 
 
-static CREATURE_DIRECTIVE* NewDirective(UINT8 ubSectorID, UINT8 ubSectorZ, UINT8 ubCreatureHabitat)
+static void AddLairSector(UINT8 const ubSectorID, UINT8 const ubSectorZ, UINT8 const ubCreatureHabitat)
 {
-	UINT8 ubSectorX, ubSectorY;
-	CREATURE_DIRECTIVE* const curr = MALLOC(CREATURE_DIRECTIVE);
-	ubSectorX = (UINT8)((ubSectorID % 16) + 1);
-	ubSectorY = (UINT8)((ubSectorID / 16) + 1);
-	curr->pLevel = FindUnderGroundSector( ubSectorX, ubSectorY, ubSectorZ );
-	if( !curr->pLevel )
+	UINT8 const ubSectorX = (UINT8)((ubSectorID % 16) + 1);
+	UINT8 const ubSectorY = (UINT8)((ubSectorID / 16) + 1);
+	UNDERGROUND_SECTORINFO* const u = FindUnderGroundSector(ubSectorX, ubSectorY, ubSectorZ);
+	if (!u)
 	{
 		SLOGA("Could not find underground sector node (%c%db_%d) that should exist.",
 			ubSectorY + 'A' - 1, ubSectorX, ubSectorZ);
-		MemFree(curr);
-		return 0;
+		return;
 	}
+	Assert(g_n_lair_sectors < MAX_LAIR_SECTORS);
+	u->ubCreatureHabitat = ubCreatureHabitat;
+	g_lair[g_n_lair_sectors++] = u;
+}
+
 
-	curr->pLevel->ubCreatureHabitat = ubCreatureHabitat;
-	curr->next = NULL;
-	return curr;
+static void AddQueenLair(UINT8 const ubSectorID)
+{
+	g_n_lair_sectors = 0;
+	AddLairSector(ubSectorID, 3, QUEEN_LAIR);
+	if (g_n_lair_sectors != 0 && !g_lair[0]->ubNumCreatures)
+	{
+		g_lair[0]->ubNumCreatures = 1; //for the queen.
+	}
 }
 
 
 static void InitLairDrassen(void)
 {
-	CREATURE_DIRECTIVE *curr;
 	giLairID = 1;
-	//initialize the linked list of lairs
-	lair = NewDirective( SEC_F13, 3, QUEEN_LAIR );
-	curr = lair;
-	if( !curr->pLevel->ubNumCreatures )
-	{
-		curr->pLevel->ubNumCreatures = 1;	//for the queen.
-	}
-	curr->next = NewDirective( SEC_G13, 3, LAIR );
-	curr = curr->next;
-	curr->next = NewDirective( SEC_G13, 2, LAIR_ENTRANCE );
-	curr = curr->next;
-	curr->next = NewDirective( SEC_F13, 2, INNER_MINE );
-	curr = curr->next;
-	curr->next = NewDirective( SEC_E13, 2, INNER_MINE );
-	curr = curr->next;
-	curr->next = NewDirective( SEC_E13, 1, OUTER_MINE );
-	curr = curr->next;
-	curr->next = NewDirective( SEC_D13, 1, MINE_EXIT );
+	AddQueenLair(SEC_F13);
+	AddLairSector(SEC_G13, 3, LAIR);
+	AddLairSector(SEC_G13, 2, LAIR_ENTRANCE);
+	AddLairSector(SEC_F13, 2, INNER_MINE);
+	AddLairSector(SEC_E13, 2, INNER_MINE);
+	AddLairSector(SEC_E13, 1, OUTER_MINE);
+	AddLairSector(SEC_D13, 1, MINE_EXIT);
 }
 
 
 static void InitLairCambria(void)
 {
-	CREATURE_DIRECTIVE *curr;
 	giLairID = 2;
-	//initialize the linked list of lairs
-	lair = NewDirective( SEC_J8, 3, QUEEN_LAIR );
-	curr = lair;
-	if( !curr->pLevel->ubNumCreatures )
-	{
-		curr->pLevel->ubNumCreatures = 1;	//for the queen.
-	}
-	curr->next = NewDirective( SEC_I8, 3, LAIR );
-	curr = curr->next;
-	curr->next = NewDirective( SEC_H8, 3, LAIR );
-	curr = curr->next;
-	curr->next = NewDirective( SEC_H8, 2, LAIR_ENTRANCE );
-	curr = curr->next;
-	curr->next = NewDirective( SEC_H9, 2, INNER_MINE );
-	curr = curr->next;
-	curr->next = NewDirective( SEC_H9, 1, OUTER_MINE );
-	curr = curr->next;
-	curr->next = NewDirective( SEC_H8, 1, MINE_EXIT );
+	AddQueenLair(SEC_J8);
+	AddLairSector(SEC_I8, 3, LAIR);
+	AddLairSector(SEC_H8, 3, LAIR);
+	AddLairSector(SEC_H8, 2, LAIR_ENTRANCE);
+	AddLairSector(SEC_H9, 2, INNER_MINE);
+	AddLairSector(SEC_H9, 1, OUTER_MINE);
+	AddLairSector(SEC_H8, 1, MINE_EXIT);
 }
 
 
 static void InitLairAlma(void)
 {
-	CREATURE_DIRECTIVE *curr;
 	giLairID = 3;
-	//initialize the linked list of lairs
-	lair = NewDirective( SEC_K13, 3, QUEEN_LAIR );
-	curr = lair;
-	if( !curr->pLevel->ubNumCreatures )
-	{
-		curr->pLevel->ubNumCreatures = 1;	//for the queen.
-	}
-	curr->next = NewDirective( SEC_J13, 3, LAIR );
-	curr = curr->next;
-	curr->next = NewDirective( SEC_J13, 2, LAIR_ENTRANCE );
-	curr = curr->next;
-	curr->next = NewDirective( SEC_J14, 2, INNER_MINE );
-	curr = curr->next;
-	curr->next = NewDirective( SEC_J14, 1, OUTER_MINE );
-	curr = curr->next;
-	curr->next = NewDirective( SEC_I14, 1, MINE_EXIT );
+	AddQueenLair(SEC_K13);
+	AddLairSector(SEC_J13, 3, LAIR);
+	AddLairSector(SEC_J13, 2, LAIR_ENTRANCE);
+	AddLairSector(SEC_J14, 2, INNER_MINE);
+	AddLairSector(SEC_J14, 1, OUTER_MINE);
+	AddLairSector(SEC_I14, 1, MINE_EXIT);
 }
 
 
 static void InitLairGrumm(void)
 {
-	CREATURE_DIRECTIVE *curr;
 	giLairID = 4;
-	//initialize the linked list of lairs
-	lair = NewDirective( SEC_G4, 3, QUEEN_LAIR );
-	curr = lair;
-	if( !curr->pLevel->ubNumCreatures )
-	{
-		curr->pLevel->ubNumCreatures = 1;	//for the queen.
-	}
-	curr->next = NewDirective( SEC_H4, 3, LAIR );
-	curr = curr->next;
-	curr->next = NewDirective( SEC_H4, 2, LAIR_ENTRANCE );
-	curr = curr->next;
-	curr->next = NewDirective( SEC_H3, 2, INNER_MINE );
-	curr = curr->next;
-	curr->next = NewDirective( SEC_I3, 2, INNER_MINE );
-	curr = curr->next;
-	curr->next = NewDirective( SEC_I3, 1, OUTER_MINE );
-	curr = curr->next;
-	curr->next = NewDirective( SEC_H3, 1, MINE_EXIT );
+	AddQueenLair(SEC_G4);
+	AddLairSector(SEC_H4, 3, LAIR);
+	AddLairSector(SEC_H4, 2, LAIR_ENTRANCE);
+	AddLairSector(SEC_H3, 2, INNER_MINE);
+	AddLairSector(SEC_I3, 2, INNER_MINE);
+	AddLairSector(SEC_I3, 1, OUTER_MINE);
+	AddLairSector(SEC_H3, 1, MINE_EXIT);
 }
 
 
@@ -379,23 +338,22 @@ void InitCreatureQuest()
 }
 
 
-static void AddCreatureToNode(CREATURE_DIRECTIVE* node)
+static void AddCreatureToSector(UNDERGROUND_SECTORINFO& u)
 {
-	node->pLevel->ubNumCreatures++;
+	u.ubNumCreatures++;
 
-	if( node->pLevel->uiFlags & SF_PENDING_ALTERNATE_MAP )
+	if( u.uiFlags & SF_PENDING_ALTERNATE_MAP )
 	{ //there is an alternate map meaning that there is a dynamic opening.  From now on
 		//we substitute this map.
-		node->pLevel->uiFlags &= ~SF_PENDING_ALTERNATE_MAP;
-		node->pLevel->uiFlags |= SF_USE_ALTERNATE_MAP;
+		u.uiFlags &= ~SF_PENDING_ALTERNATE_MAP;
+		u.uiFlags |= SF_USE_ALTERNATE_MAP;
 	}
 }
 
 
-static BOOLEAN PlaceNewCreature(CREATURE_DIRECTIVE* node, INT32 iDistance)
+// Tries to place a creature in the lair sector at the given distance from the queen
+static BOOLEAN PlaceNewCreatureAt(UNDERGROUND_SECTORINFO& u, INT32 iDistance)
 {
-	if( !node )
-		return FALSE;
 	//check to see if the creatures are permitted to spread into certain areas.  There are 4 mines (human perspective), and
 	//creatures won't spread to them until the player controls them.  Additionally, if the player has recently cleared the
 	//mine, then temporarily prevent the spreading of creatures.
@@ -406,7 +364,7 @@ static BOOLEAN PlaceNewCreature(CREATURE_DIRECTIVE* node, INT32 iDistance)
 		//we have reached the distance limitation for the spreading.  We will determine if
 		//the area is populated enough to spread further.  The minimum population must be 4 before
 		//spreading is even considered.
-		if( node->pLevel->ubNumCreatures*10 - 10 <= (INT32)Random( 60 ) )
+		if( u.ubNumCreatures*10 - 10 <= (INT32)Random( 60 ) )
 		{
 			// x<=1 100%
 			// x==2  83%
@@ -415,21 +373,21 @@ static BOOLEAN PlaceNewCreature(CREATURE_DIRECTIVE* node, INT32 iDistance)
 			// x==5  33%
 			// x==6  17%
 			// x>=7   0%
-			AddCreatureToNode( node );
+			AddCreatureToSector(u);
 			return TRUE;
 		}
 	}
 	else if( giHabitatedDistance > iDistance )
 	{ //we are within the "safe" habitated area of the creature's area of influence.  The chance of
 		//increasing the population inside this sector depends on how deep we are within the sector.
-		if( node->pLevel->ubNumCreatures < MAX_STRATEGIC_TEAM_SIZE ||
-			(node->pLevel->ubNumCreatures < 32 && node->pLevel->ubCreatureHabitat == QUEEN_LAIR) )
+		if( u.ubNumCreatures < MAX_STRATEGIC_TEAM_SIZE ||
+			(u.ubNumCreatures < 32 && u.ubCreatureHabitat == QUEEN_LAIR) )
 		{ //there is ALWAYS a chance to habitate an interior sector, though the chances are slim for
 			//highly occupied sectors.  This chance is modified by the type of area we are in.
 			INT32 iAbsoluteMaxPopulation;
 			INT32 iMaxPopulation=-1;
 			INT32 iChanceToPopulate;
-			switch( node->pLevel->ubCreatureHabitat )
+			switch( u.ubCreatureHabitat )
 			{
 				case QUEEN_LAIR: //Defend the queen bonus
 					iAbsoluteMaxPopulation = 32;
@@ -480,24 +438,35 @@ static BOOLEAN PlaceNewCreature(CREATURE_DIRECTIVE* node, INT32 iDistance)
 
 			//The chance to populate a sector is higher for lower populations.  This is calculated on
 			//the ratio of current population to the max population.
-			iChanceToPopulate = 100 - node->pLevel->ubNumCreatures * 100 / iMaxPopulation;
+			iChanceToPopulate = 100 - u.ubNumCreatures * 100 / iMaxPopulation;
 
-			if( !node->pLevel->ubNumCreatures || (iChanceToPopulate > (INT32)Random( 100 )
-					&& iMaxPopulation > node->pLevel->ubNumCreatures) )
+			if( !u.ubNumCreatures || (iChanceToPopulate > (INT32)Random( 100 )
+					&& iMaxPopulation > u.ubNumCreatures) )
 			{
-				AddCreatureToNode( node );
+				AddCreatureToSector(u);
 				return TRUE;
 			}
 		}
 	}
 	else
 	{ //we are in a new area, so we will populate it
-		AddCreatureToNode( node );
+		AddCreatureToSector(u);
 		giHabitatedDistance++;
 		return TRUE;
 	}
-	if( PlaceNewCreature( node->next, iDistance + 1 ) )
-		return TRUE;
+	return FALSE;
+}
+
+
+/* Places a creature in the nearest lair sector which takes it. This stays a
+ * plain walk over the lair array, as every placement depends on the ones
+ * before it and on the random numbers drawn for them. */
+static BOOLEAN PlaceNewCreature()
+{
+	for (UINT i = 0; i != g_n_lair_sectors; ++i)
+	{
+		if (PlaceNewCreatureAt(*g_lair[i], i)) return TRUE;
+	}
 	return FALSE;
 }
 
@@ -526,7 +495,7 @@ void SpreadCreatures()
 		//Note, this function can and will fail if the population gets dense.  This is a necessary
 		//feature.  Otherwise, the queen would fill all the cave levels with MAX_STRATEGIC_TEAM_SIZE monsters, and that would
 		//be bad.
-		PlaceNewCreature( lair, 0 );
+		PlaceNewCreature();
 	}
 }
 
@@ -812,19 +781,9 @@ void CreatureAttackTown( UINT8 ubSectorID, BOOLEAN fOverrideTest )
 }
 
 
-static void DeleteDirectiveNode(CREATURE_DIRECTIVE** node)
-{
-	if( (*node)->next )
-		DeleteDirectiveNode( &((*node)->next) );
-	MemFree( *node );
-	*node = NULL;
-}
-
-//Recursively delete all nodes (from the top down).
 void DeleteCreatureDirectives()
 {
-	if( lair )
-		DeleteDirectiveNode( &lair );
+	g_n_lair_sectors = 0;
 	giLairID = 0;
 }
 
@@ -838,7 +797,6 @@ void ClearCreatureQuest()
 
 void EndCreatureQuest()
 {
-	CREATURE_DIRECTIVE *curr;
 	UNDERGROUND_SECTORINFO *pSector;
 	INT32 i;
 
@@ -849,15 +807,10 @@ void EndCreatureQuest()
 
 	//Also nuke all of the creatures in all of the other mine sectors.  This
 	//is keyed on the fact that the queen monster is killed.
-	curr = lair;
-	if( curr )
-	{ //skip first node (there could be other creatures around.
-		curr = curr->next;
-	}
-	while( curr )
+	//skip first node (there could be other creatures around.
+	for (UINT i = 1; i < g_n_lair_sectors; ++i)
 	{
-		curr->pLevel->ubNumCreatures = 0;
-		curr = curr->next;
+		g_lair[i]->ubNumCreatures = 0;
 	}
 
 	//Remove the creatures that are trapped underneath Tixa
@@ -1293,7 +1246,6 @@ void LoadCreatureDirectives(HWFILE const hFile, UINT32 const uiSavedGameVersion)
 
 BOOLEAN PlayerGroupIsInACreatureInfestedMine()
 {
-	CREATURE_DIRECTIVE *curr;
 	INT16 sSectorX, sSectorY;
 	INT8 bSectorZ;
 
@@ -1303,12 +1255,11 @@ BOOLEAN PlayerGroupIsInACreatureInfestedMine()
 	}
 
 	//Lair is active, so look for live soldier in any creature level
-	curr = lair;
-	while( curr )
+	for (UINT i = 0; i != g_n_lair_sectors; ++i)
 	{
-		sSectorX = curr->pLevel->ubSectorX;
-		sSectorY = curr->pLevel->ubSectorY;
-		bSectorZ = (INT8)curr->pLevel->ubSectorZ;
+		sSectorX = g_lair[i]->ubSectorX;
+		sSectorY = g_lair[i]->ubSectorY;
+		bSectorZ = (INT8)g_lair[i]->ubSectorZ;
 		//Loop through all the creature directives (mine sectors that are infectible) and
 		//see if players are there.
 		CFOR_EACH_IN_TEAM(pSoldier, OUR_TEAM)
@@ -1322,7 +1273,6 @@ BOOLEAN PlayerGroupIsInACreatureInfestedMine()
 				return TRUE;
 			}
 		}
-		curr = curr->next;
 	}
 
 	//Lair is active, but no mercs are in these sectors
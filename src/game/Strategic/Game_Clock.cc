@@ -30,6 +30,9 @@
 #include "ScreenIDs.h"
 #include "FileMan.h"
 #include "UILayout.h"
+#include "Logger.h"
+
+#include <SDL.h>
 
 
 //#define DEBUG_GAME_CLOCK
@@ -233,6 +236,20 @@ static void AdvanceClock(UINT8 ubWarpCode)
 }
 
 
+UINT32 FastForwardGameTime(UINT32 const max_seconds)
+{
+	UINT32   const before = guiGameClock;
+	uint64_t const start  = SDL_GetPerformanceCounter();
+	WarpGameTime(max_seconds, WARPTIME_PROCESS_EVENTS_NORMALLY);
+	double   const secs   = (double)(SDL_GetPerformanceCounter() - start) / SDL_GetPerformanceFrequency();
+
+	UINT32 const passed = guiGameClock - before;
+	SLOGI("Fast forward: %u game minutes in %.1f ms, %.0f game minutes per second",
+		passed / NUM_SEC_IN_MIN, secs * 1000, secs > 0 ? passed / NUM_SEC_IN_MIN / secs : 0);
+	return passed;
+}
+
+
 void AdvanceToNextDay()
 {
 	INT32  uiDiff;
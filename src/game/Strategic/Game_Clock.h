@@ -118,6 +118,13 @@ void WarpGameTime( UINT32 uiAdjustment, UINT8 ubWarpCode );
 
 void AdvanceToNextDay(void);
 
+/* Skips ahead by up to max_seconds in one warp, processing the events on the
+ * way as time compression would, but without the frames in between. It stops
+ * at the first event which interrupts time compression. The clock string is
+ * only formatted at the end. Logs the game minutes simulated per real second and
+ * returns the game seconds which passed. */
+UINT32 FastForwardGameTime(UINT32 max_seconds);
+
 //This function is called once per cycle in the game loop.  This determine how often the clock should be
 //as well as how much to update the clock by.
 void UpdateClock(void);
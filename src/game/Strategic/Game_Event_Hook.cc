@@ -36,9 +36,16 @@
 #include "Campaign.h"
 #include "Debug.h"
 
+#include <SDL.h>
+
+#include <algorithm>
+#include <iterator>
+
 extern UINT32	guiTimeStampOfCurrentlyExecutingEvent;
 extern BOOLEAN gfPreventDeletionOfAnyEvent;
 
+static StrategicEventStats g_event_stats[NUMBER_OF_EVENT_TYPES];
+
 
 static BOOLEAN DelayEventIfBattleInProgress(STRATEGICEVENT* pEvent)
 {
@@ -53,7 +60,7 @@ static BOOLEAN DelayEventIfBattleInProgress(STRATEGICEVENT* pEvent)
 	return FALSE;
 }
 
-BOOLEAN ExecuteStrategicEvent( STRATEGICEVENT *pEvent )
+static BOOLEAN RunStrategicEvent(STRATEGICEVENT* pEvent)
 {
 	BOOLEAN fOrigPreventFlag;
 
@@ -88,7 +95,7 @@ BOOLEAN ExecuteStrategicEvent( STRATEGICEVENT *pEvent )
 			}
 			else
 			{
-				pEvent->uiParam = SetupNewAmbientSound( pEvent->uiParam );
+				SetStrategicEventParam(*pEvent, SetupNewAmbientSound(pEvent->uiParam));
 			}
 			break;
 		case EVENT_AIM_RESET_MERC_ANNOYANCE:
@@ -305,3 +312,30 @@ BOOLEAN ExecuteStrategicEvent( STRATEGICEVENT *pEvent )
 	gfPreventDeletionOfAnyEvent = fOrigPreventFlag;
 	return TRUE;
 }
+
+
+BOOLEAN ExecuteStrategicEvent(STRATEGICEVENT* const e)
+{
+	UINT8    const kind  = e->ubCallbackID;
+	uint64_t const start = SDL_GetPerformanceCounter();
+	BOOLEAN  const ret   = RunStrategicEvent(e);
+	if (kind < NUMBER_OF_EVENT_TYPES)
+	{
+		StrategicEventStats& s = g_event_stats[kind];
+		++s.count;
+		s.ticks += SDL_GetPerformanceCounter() - start;
+	}
+	return ret;
+}
+
+
+StrategicEventStats const& GetStrategicEventStats(StrategicEventKind const kind)
+{
+	return g_event_stats[kind];
+}
+
+
+void ResetStrategicEventStats()
+{
+	std::fill(std::begin(g_event_stats), std::end(g_event_stats), StrategicEventStats());
+}
@@ -3,6 +3,8 @@
 
 #include "Types.h"
 
+#include <stdint.h>
+
 enum StrategicEventKind
 {
 	EVENT_CHANGELIGHTVAL                                 =  1,
@@ -69,6 +71,17 @@ enum StrategicEventKind
 	NUMBER_OF_EVENT_TYPES
 };
 
+/* The events executed of one kind and the time spent executing them since the
+ * last reset, for benchmarking the strategic simulation. */
+struct StrategicEventStats
+{
+	UINT32   count;
+	uint64_t ticks; // SDL performance counter ticks
+};
+
+StrategicEventStats const& GetStrategicEventStats(StrategicEventKind);
+void ResetStrategicEventStats();
+
 // This value is added to the param value for NPC-system-created events which are based on an
 // action rather than a fact:
 #define NPC_SYSTEM_EVENT_ACTION_PARAM_BONUS 10000
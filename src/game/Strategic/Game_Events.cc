@@ -9,41 +9,114 @@
 #include "Text.h"
 #include "FileMan.h"
 #include "Logger.h"
+#include "Profiler.h"
 
-STRATEGICEVENT									*gpEventList = NULL;
+#include <set>
+#include <vector>
+
+/* The events are kept in two sets: in the order they are processed, and by
+ * kind and parameter for DeleteStrategicEvent() and
+ * DeleteAllStrategicEventsOfType(). Both order by the time stamp and the
+ * serial last, so the first event of a kind and parameter is the one which
+ * runs first. */
+struct StrategicEventOrder
+{
+	bool operator ()(STRATEGICEVENT const* const a, STRATEGICEVENT const* const b) const
+	{
+		if (a->uiTimeStamp != b->uiTimeStamp) return a->uiTimeStamp < b->uiTimeStamp;
+		return a->uiSerial < b->uiSerial;
+	}
+};
+
+struct StrategicEventKindOrder
+{
+	bool operator ()(STRATEGICEVENT const* const a, STRATEGICEVENT const* const b) const
+	{
+		if (a->ubCallbackID != b->ubCallbackID) return a->ubCallbackID < b->ubCallbackID;
+		if (a->uiParam      != b->uiParam)      return a->uiParam      < b->uiParam;
+		return StrategicEventOrder()(a, b);
+	}
+};
+
+typedef std::set<STRATEGICEVENT*, StrategicEventOrder>     StrategicEventQueue;
+typedef std::set<STRATEGICEVENT*, StrategicEventKindOrder> StrategicEventIndex;
+
+static StrategicEventQueue           g_events;
+static StrategicEventIndex           g_events_by_kind;
+static UINT32                        g_event_serial;
+static std::vector<STRATEGICEVENT*>  g_events_deletion_pending;
 
 extern UINT32 guiGameClock;
 BOOLEAN gfPreventDeletionOfAnyEvent = FALSE;
-static BOOLEAN gfEventDeletionPending = FALSE;
 
 static BOOLEAN gfProcessingGameEvents = FALSE;
 UINT32	guiTimeStampOfCurrentlyExecutingEvent = 0;
 
 
+STRATEGICEVENT* FirstStrategicEvent()
+{
+	return g_events.empty() ? 0 : *g_events.begin();
+}
+
+
+STRATEGICEVENT* NextStrategicEvent(STRATEGICEVENT const* const e)
+{
+	StrategicEventQueue::const_iterator const i = g_events.upper_bound(const_cast<STRATEGICEVENT*>(e));
+	return i != g_events.end() ? *i : 0;
+}
+
+
+static void InsertStrategicEvent(STRATEGICEVENT* const e)
+{
+	e->uiSerial = g_event_serial++;
+	g_events.insert(e);
+	g_events_by_kind.insert(e);
+}
+
+
+static void FreeStrategicEvent(STRATEGICEVENT* const e)
+{
+	g_events.erase(e);
+	g_events_by_kind.erase(e);
+	MemFree(e);
+}
+
+
+// Deletes the event now, or marks it, if events are being executed
+static void DeleteOrMarkStrategicEvent(STRATEGICEVENT* const e)
+{
+	if (!gfPreventDeletionOfAnyEvent)
+	{
+		FreeStrategicEvent(e);
+		return;
+	}
+	e->ubFlags |= SEF_DELETION_PENDING;
+	g_events_deletion_pending.push_back(e);
+}
+
+
+void SetStrategicEventParam(STRATEGICEVENT& e, UINT32 const param)
+{
+	g_events_by_kind.erase(&e);
+	e.uiParam = param;
+	g_events_by_kind.insert(&e);
+}
+
+
 bool GameEventsPending(UINT32 const adjustment)
 {
-	STRATEGICEVENT* const e = gpEventList;
+	STRATEGICEVENT* const e = FirstStrategicEvent();
 	return e && e->uiTimeStamp <= GetWorldTotalSeconds() + adjustment;
 }
 
 
 static void DeleteEventsWithDeletionPending()
 {
-	if (!gfEventDeletionPending) return;
-	gfEventDeletionPending = FALSE;
-
-	for (STRATEGICEVENT** anchor = &gpEventList; *anchor;)
+	std::vector<STRATEGICEVENT*> pending;
+	pending.swap(g_events_deletion_pending);
+	for (std::vector<STRATEGICEVENT*>::const_iterator i = pending.begin(); i != pending.end(); ++i)
 	{
-		STRATEGICEVENT* const i = *anchor;
-		if (i->ubFlags & SEF_DELETION_PENDING)
-		{
-			*anchor = i->next;
-			MemFree(i);
-		}
-		else
-		{
-			anchor = &i->next;
-		}
+		FreeStrategicEvent(*i);
 	}
 }
 
@@ -61,21 +134,21 @@ static void AdjustClockToEventStamp(STRATEGICEVENT* pEvent, UINT32* puiAdjustmen
 	guiHour = ( guiGameClock - ( guiDay * NUM_SEC_IN_DAY ) ) / NUM_SEC_IN_HOUR;
 	guiMin	= ( guiGameClock - ( ( guiDay * NUM_SEC_IN_DAY ) + ( guiHour * NUM_SEC_IN_HOUR ) ) ) / NUM_SEC_IN_MIN;
 
-	swprintf(WORLDTIMESTR, lengthof(WORLDTIMESTR), L"%ls %d, %02d:%02d", gpGameClockString, guiDay, guiHour, guiMin);
+	// The clock string is formatted once the warp is done, by AdvanceClock()
 }
 
 
 void ProcessPendingGameEvents(UINT32 uiAdjustment, const UINT8 ubWarpCode)
 {
-	STRATEGICEVENT *curr, *pEvent, *prev, *temp;
-	BOOLEAN fDeleteEvent = FALSE, fDeleteQueuedEvent = FALSE;
+	PROFILE_ZONE("ProcessPendingGameEvents");
+	STRATEGICEVENT *curr, *pEvent;
+	BOOLEAN fDeleteEvent = FALSE;
 
 	gfTimeInterrupt = FALSE;
 	gfProcessingGameEvents = TRUE;
 
 	//While we have events inside the time range to be updated, process them...
-	curr = gpEventList;
-	prev = NULL; //prev only used when warping time to target time.
+	curr = FirstStrategicEvent();
 	while( !gfTimeInterrupt && curr && curr->uiTimeStamp <= guiGameClock + uiAdjustment )
 	{
 		fDeleteEvent = FALSE;
@@ -93,30 +166,24 @@ void ProcessPendingGameEvents(UINT32 uiAdjustment, const UINT8 ubWarpCode)
 		}
 		else if( curr->uiTimeStamp == guiGameClock + uiAdjustment )
 		{ //if we are warping to the target time to process that event first,
-			if( !curr->next || curr->next->uiTimeStamp > guiGameClock + uiAdjustment )
+			STRATEGICEVENT* const next = NextStrategicEvent(curr);
+			if( !next || next->uiTimeStamp > guiGameClock + uiAdjustment )
 			{ //make sure that we are processing the last event for that second
 				AdjustClockToEventStamp( curr, &uiAdjustment );
 
 				fDeleteEvent = ExecuteStrategicEvent( curr );
-
-				if( curr && prev && fDeleteQueuedEvent )
-				{ //The only case where we are deleting a node in the middle of the list
-					prev->next = curr->next;
-				}
 			}
 			else
 			{ //We are at the current target warp time however, there are still other events following in this time cycle.
 				//We will only target the final event in this time.  NOTE:  Events are posted using a FIFO method
-				prev = curr;
-				curr = curr->next;
+				curr = next;
 				continue;
 			}
 		}
 		else
 		{ //We are warping time to the target time.  We haven't found the event yet,
 			//so continuing will keep processing the list until we find it.  NOTE:  Events are posted using a FIFO method
-			prev = curr;
-			curr = curr->next;
+			curr = NextStrategicEvent(curr);
 			continue;
 		}
 		if( fDeleteEvent )
@@ -136,25 +203,14 @@ void ProcessPendingGameEvents(UINT32 uiAdjustment, const UINT8 ubWarpCode)
 					AddAdvancedStrategicEvent(EVERYDAY_EVENT, static_cast<StrategicEventKind>(curr->ubCallbackID), curr->uiTimeStamp + NUM_SEC_IN_DAY, curr->uiParam);
 					break;
 			}
-			if( curr == gpEventList )
-			{
-				gpEventList = gpEventList->next;
-				MemFree( curr );
-				curr = gpEventList;
-				prev = NULL;
-			}
-			else
-			{
-				temp = curr;
-				prev->next = curr->next;
-				curr = curr->next;
-				MemFree( temp );
-			}
+			// Events the callback posted are later, so they come after it
+			STRATEGICEVENT* const done = curr;
+			curr = NextStrategicEvent(curr);
+			FreeStrategicEvent(done);
 		}
 		else
 		{
-			prev = curr;
-			curr = curr->next;
+			curr = NextStrategicEvent(curr);
 		}
 	}
 
@@ -194,16 +250,7 @@ STRATEGICEVENT* AddAdvancedStrategicEvent(StrategicEventFrequency const event_ty
 	n->ubEventType  = event_type;
 	n->uiTimeStamp  = timestamp;
 	n->uiTimeOffset = 0;
-
-	// Search list for a place to insert
-	STRATEGICEVENT** anchor = &gpEventList;
-	for (; *anchor; anchor = &(*anchor)->next)
-	{
-		if (timestamp < (*anchor)->uiTimeStamp) break;
-	}
-	n->next = *anchor;
-	*anchor = n;
-
+	InsertStrategicEvent(n);
 	return n;
 }
 
@@ -274,59 +321,51 @@ BOOLEAN AddPeriodStrategicEventWithOffset(StrategicEventKind const ubCallbackID,
 	return FALSE;
 }
 
+// Lower bound of the events of a kind and parameter in g_events_by_kind
+static StrategicEventIndex::iterator FirstEventOfKind(StrategicEventKind const callback_id, UINT32 const param)
+{
+	STRATEGICEVENT key = STRATEGICEVENT();
+	key.ubCallbackID = callback_id;
+	key.uiParam      = param;
+	return g_events_by_kind.lower_bound(&key);
+}
+
+
 void DeleteAllStrategicEventsOfType(StrategicEventKind const callback_id)
 {
-	for (STRATEGICEVENT** anchor = &gpEventList; *anchor;)
+	for (StrategicEventIndex::iterator i = FirstEventOfKind(callback_id, 0); i != g_events_by_kind.end();)
 	{
-		STRATEGICEVENT* const e = *anchor;
-		if (e->ubCallbackID == callback_id && !(e->ubFlags & SEF_DELETION_PENDING))
-		{
-			if (!gfPreventDeletionOfAnyEvent)
-			{ // Detach and delete the node
-				*anchor = e->next;
-				MemFree(e);
-				continue;
-			}
-
-			e->ubFlags |= SEF_DELETION_PENDING;
-			gfEventDeletionPending = TRUE;
-		}
-		anchor = &e->next;
+		STRATEGICEVENT* const e = *i++;
+		if (e->ubCallbackID != callback_id) break;
+		if (e->ubFlags & SEF_DELETION_PENDING) continue;
+		DeleteOrMarkStrategicEvent(e);
 	}
 }
 
 
 void DeleteAllStrategicEvents()
 {
-	for (STRATEGICEVENT* i = gpEventList; i;)
+	for (StrategicEventQueue::const_iterator i = g_events.begin(); i != g_events.end(); ++i)
 	{
-		STRATEGICEVENT* const del = i;
-		i = i->next;
-		MemFree(del);
+		MemFree(*i);
 	}
-	gpEventList = 0;
+	g_events.clear();
+	g_events_by_kind.clear();
+	g_events_deletion_pending.clear();
+	g_event_serial = 0;
 }
 
 
 void DeleteStrategicEvent(StrategicEventKind const callback_id, UINT32 const param)
 {
-	for (STRATEGICEVENT** anchor = &gpEventList; *anchor; anchor = &(*anchor)->next)
+	for (StrategicEventIndex::iterator i = FirstEventOfKind(callback_id, param); i != g_events_by_kind.end(); ++i)
 	{
-		STRATEGICEVENT* const e = *anchor;
-		if (e->ubCallbackID != callback_id)    continue;
-		if (e->uiParam != param)               continue;
+		STRATEGICEVENT* const e = *i;
+		if (e->ubCallbackID != callback_id)    break;
+		if (e->uiParam != param)               break;
 		if (e->ubFlags & SEF_DELETION_PENDING) continue;
 
-		if (gfPreventDeletionOfAnyEvent)
-		{
-			e->ubFlags |= SEF_DELETION_PENDING;
-			gfEventDeletionPending = TRUE;
-		}
-		else
-		{
-			*anchor = e->next;
-			MemFree(e);
-		}
+		DeleteOrMarkStrategicEvent(e);
 		return;
 	}
 }
@@ -336,15 +375,13 @@ void DeleteStrategicEvent(StrategicEventKind const callback_id, UINT32 const par
 void SaveStrategicEventsToSavedGame(HWFILE const f)
 {
 	// Determine the number of events
-	UINT32 n_game_events = 0;
-	for (STRATEGICEVENT* i = gpEventList; i; i = i->next)
-	{
-		++n_game_events;
-	}
+	UINT32 const n_game_events = (UINT32)g_events.size();
 	FileWrite(f, &n_game_events, sizeof(UINT32));
 
-	for (STRATEGICEVENT* i = gpEventList; i; i = i->next)
+	// In the order they run, so the serials are restored by the order on loading
+	for (StrategicEventQueue::const_iterator e = g_events.begin(); e != g_events.end(); ++e)
 	{
+		STRATEGICEVENT const* const i = *e;
 		BYTE  data[28];
 		BYTE* d = data;
 		INJ_SKIP(d, 4)
@@ -371,7 +408,6 @@ void LoadStrategicEventsFromSavedGame(HWFILE const f)
 	UINT32 n_game_events;
 	FileRead(f, &n_game_events, sizeof(UINT32));
 
-	STRATEGICEVENT** anchor = &gpEventList;
 	for (size_t n = n_game_events; n != 0; --n)
 	{
 		BYTE data[28];
@@ -389,7 +425,40 @@ void LoadStrategicEventsFromSavedGame(HWFILE const f)
 		EXTR_SKIP(d, 9)
 		Assert(d == endof(data));
 
-		*anchor = sev;
-		anchor  = &sev->next;
+		InsertStrategicEvent(sev);
 	}
 }
+
+
+#ifdef WITH_UNITTESTS
+#include "gtest/gtest.h"
+
+TEST(GameEvents, orderAndDeletion)
+{
+	DeleteAllStrategicEvents();
+	STRATEGICEVENT* const late   = AddAdvancedStrategicEvent(ONETIME_EVENT, EVENT_AMBIENT,           200, 1);
+	STRATEGICEVENT* const first  = AddAdvancedStrategicEvent(ONETIME_EVENT, EVENT_BOBBYRAY_PURCHASE, 100, 2);
+	STRATEGICEVENT* const second = AddAdvancedStrategicEvent(ONETIME_EVENT, EVENT_AMBIENT,           100, 1);
+
+	// Events of the same second run in the order they were posted
+	EXPECT_EQ(FirstStrategicEvent(), first);
+	EXPECT_EQ(NextStrategicEvent(first), second);
+	EXPECT_EQ(NextStrategicEvent(second), late);
+	EXPECT_EQ(NextStrategicEvent(late), (STRATEGICEVENT*)0);
+
+	// The event of a kind and parameter which runs first is deleted
+	DeleteStrategicEvent(EVENT_AMBIENT, 1);
+	EXPECT_EQ(NextStrategicEvent(first), late);
+
+	SetStrategicEventParam(*late, 3);
+	DeleteStrategicEvent(EVENT_AMBIENT, 1);
+	EXPECT_EQ(NextStrategicEvent(first), late);
+
+	DeleteAllStrategicEventsOfType(EVENT_AMBIENT);
+	EXPECT_EQ(FirstStrategicEvent(), first);
+	EXPECT_EQ(NextStrategicEvent(first), (STRATEGICEVENT*)0);
+	DeleteAllStrategicEvents();
+	EXPECT_EQ(FirstStrategicEvent(), (STRATEGICEVENT*)0);
+}
+
+#endif
@@ -8,10 +8,10 @@
 
 struct STRATEGICEVENT
 {
-	STRATEGICEVENT* next;
 	UINT32          uiTimeStamp;
 	UINT32          uiParam;
 	UINT32          uiTimeOffset;
+	UINT32          uiSerial; // order of posting, events of the same second run in it
 	UINT8           ubEventType;
 	UINT8           ubCallbackID;
 	UINT8           ubFlags;
@@ -36,7 +36,15 @@ STRATEGICEVENT* AddAdvancedStrategicEvent(StrategicEventFrequency, StrategicEven
 
 BOOLEAN ExecuteStrategicEvent( STRATEGICEVENT *pEvent );
 
-extern STRATEGICEVENT *gpEventList;
+/* The events in the order they are processed, i.e. by time stamp and, within
+ * a second, in the order they were posted. NextStrategicEvent() returns 0 after
+ * the last one. */
+STRATEGICEVENT* FirstStrategicEvent();
+STRATEGICEVENT* NextStrategicEvent(STRATEGICEVENT const*);
+
+/* Events are looked up by kind and parameter, so the parameter of a posted
+ * event must only be changed by this. */
+void SetStrategicEventParam(STRATEGICEVENT&, UINT32 param);
 
 /* Determines if there are any events that will be processed between the current
 	* global time, and the beginning of the next global time. */
@@ -39,6 +39,7 @@
 #include "Creature_Spreading.h"
 #include "Quests.h"
 #include "Strategic_AI.h"
+#include "Strategic_Pathing.h"
 #include "LaptopSave.h"
 #include "AIMMembers.h"
 #include "Dialogue_Control.h"
@@ -327,6 +328,7 @@ void ShutdownStrategicLayer()
 	TrashUndergroundSectorInfo();
 	DeleteCreatureDirectives();
 	KillStrategicAI();
+	LogPathNodeUsage();
 }
 
 
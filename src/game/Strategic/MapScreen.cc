@@ -1889,7 +1889,13 @@ try
 	{
 		// force update of town mine info boxes
 		ForceUpDateOfBox( ghTownMineBox );
-		MapscreenMarkButtonsDirty();
+		// only the buttons under the box are drawn over on every frame
+		MarkButtonsDirty(GetBoxArea(ghTownMineBox));
+		if (!fShowMapInventoryPool && fShowAttributeMenu)
+		{
+			// don't redraw the town button, it would wipe out a chunk of the attribute menu
+			UnMarkButtonDirty(giMapBorderButtons[MAP_BORDER_TOWN_BTN]);
+		}
 	}
 
 	if( fShowAttributeMenu )
@@ -2981,6 +2987,18 @@ static void HandleModShift(UINT const key)
 			SelectAllCharactersInSquad(squad_no);
 			break;
 		}
+
+		case '+':
+		case '=':
+			// Skip ahead to the next event which stops time compression, at most a day
+			if (!CommonTimeCompressionChecks() && AllowedToTimeCompress())
+			{
+				FastForwardGameTime(NUM_SEC_IN_DAY);
+				fMapPanelDirty        = TRUE;
+				fTeamPanelDirty       = TRUE;
+				fMapScreenBottomDirty = TRUE;
+			}
+			break;
 	}
 }
 
@@ -3004,6 +3022,11 @@ static void HandleModCtrl(UINT const key)
 			}
 			break;
 
+		case 'b':
+			// Fight simulated auto-resolve battles for balance testing
+			if (CHEATER_CHEAT_LEVEL()) SimulateAutoResolveBattles(1000, 1);
+			break;
+
 	case 'i':
 		if (gamepolicy(isHotkeyEnabled(UI_Map, HKMOD_CTRL, 'i')))
 		{
@@ -3785,19 +3808,19 @@ static void BltCharInvPanel(void)
 	INT16 usY;
 
 	// Display armor
-	MPrint(MAP_ARMOR_LABEL_X, MAP_ARMOR_LABEL_Y, pInvPanelTitleStrings[0]);
+	MPrintCached(MAP_ARMOR_LABEL_X, MAP_ARMOR_LABEL_Y, pInvPanelTitleStrings[0]);
 	swprintf(sString, lengthof(sString), L"%3d%%", ArmourPercent(pSoldier));
 	FindFontRightCoordinates(MAP_ARMOR_X, MAP_ARMOR_Y, MAP_ARMOR_W, MAP_ARMOR_H, sString, BLOCKFONT2, &usX, &usY);
 	MPrint(usX, usY, sString);
 
 	// Display weight
-	MPrint(MAP_WEIGHT_LABEL_X, MAP_WEIGHT_LABEL_Y, pInvPanelTitleStrings[1]);
+	MPrintCached(MAP_WEIGHT_LABEL_X, MAP_WEIGHT_LABEL_Y, pInvPanelTitleStrings[1]);
 	swprintf(sString, lengthof(sString), L"%d%%", CalculateCarriedWeight(pSoldier));
 	FindFontRightCoordinates(MAP_WEIGHT_X, MAP_WEIGHT_Y, MAP_WEIGHT_W, MAP_WEIGHT_H, sString, BLOCKFONT2, &usX, &usY);
 	MPrint(usX, usY, sString);
 
 	// Display camouflage
-	MPrint(MAP_CAMO_LABEL_X, MAP_CAMO_LABEL_Y, pInvPanelTitleStrings[2]);
+	MPrintCached(MAP_CAMO_LABEL_X, MAP_CAMO_LABEL_Y, pInvPanelTitleStrings[2]);
 	swprintf(sString, lengthof(sString), L"%d%%", pSoldier->bCamo);
 	FindFontRightCoordinates(MAP_CAMO_X, MAP_CAMO_Y, MAP_CAMO_W, MAP_CAMO_H, sString, BLOCKFONT2, &usX, &usY);
 	MPrint(usX, usY, sString);
@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <stdexcept>
 
 #include "Directories.h"
@@ -599,10 +600,120 @@ static void ShowTeamAndVehicles();
 static void ShowTownText(void);
 
 
+// The shading colour of every sector, -1 for sectors which are not shaded
+static void GetMapShading(INT8* const shading)
+{
+	std::fill_n(shading, MAP_WORLD_X * MAP_WORLD_Y, -1);
+	for (INT16 cnt = 1; cnt < MAP_WORLD_X - 1; ++cnt)
+	{
+		for (INT16 cnt2 = 1; cnt2 < MAP_WORLD_Y - 1; ++cnt2)
+		{
+			INT8& color = shading[cnt + cnt2 * MAP_WORLD_X];
+			if (!GetSectorFlagStatus(cnt, cnt2, iCurrentMapSectorZ, SF_ALREADY_VISITED))
+			{
+				if (fShowAircraftFlag)
+				{
+					if (!StrategicMap[cnt + cnt2 * WORLD_MAP_X].fEnemyAirControlled)
+					{
+						// sector not visited, not air controlled
+						color = MAP_SHADE_DK_GREEN;
+					}
+					else
+					{
+						// sector not visited, controlled and air not
+						color = MAP_SHADE_DK_RED;
+					}
+				}
+				else
+				{
+					// not visited
+					color = MAP_SHADE_BLACK;
+				}
+			}
+			else
+			{
+				if (fShowAircraftFlag)
+				{
+					if (!StrategicMap[cnt + cnt2 * WORLD_MAP_X].fEnemyAirControlled)
+					{
+						// sector visited and air controlled
+						color = MAP_SHADE_LT_GREEN;
+					}
+					else
+					{
+						// sector visited but not air controlled
+						color = MAP_SHADE_LT_RED;
+					}
+				}
+			}
+		}
+	}
+}
+
+
+static void ShadeMapSectors(INT8 const* const shading)
+{
+	// shade map sectors (must be done after Tixa/Orta/Mine icons have been blitted, but before icons!)
+	for (INT16 cnt = 1; cnt < MAP_WORLD_X - 1; ++cnt)
+	{
+		for (INT16 cnt2 = 1; cnt2 < MAP_WORLD_Y - 1; ++cnt2)
+		{
+			INT8 const color = shading[cnt + cnt2 * MAP_WORLD_X];
+			if (color != -1) ShadeMapElem(cnt, cnt2, color);
+		}
+	}
+}
+
+
+/* The unzoomed map with its sector shading is kept, as drawn into the save
+ * buffer, along with the shading it was drawn with. Hovering over the map and
+ * plotting paths redraw the map panel all the time, but the shading only
+ * changes when a sector is visited, the airspace is toggled or the owner of
+ * the airspace changes, so usually the map is just copied back. */
+static SGPVSurface* guiMapShadingCache;
+static SGPBox       g_map_shading_box;
+static INT8         g_map_shading[MAP_WORLD_X * MAP_WORLD_Y];
+static bool         g_map_shading_valid;
+
+
+static void CreateMapShadingCache()
+{
+	// The map and the shading of the sectors at its right and bottom edges
+	INT32 const x = MAP_VIEW_START_X + 1;
+	INT32 const y = MAP_VIEW_START_Y - 1;
+	INT32 const w = MAX(guiBIGMAP->Width()  / 2, (MAP_WORLD_X - 1) * MAP_GRID_X);
+	INT32 const h = MAX(guiBIGMAP->Height() / 2, (MAP_WORLD_Y - 1) * MAP_GRID_Y) + 1;
+	SGPBox const box = { (UINT16)x, (UINT16)y, (UINT16)MIN(w, SCREEN_WIDTH - x), (UINT16)MIN(h, SCREEN_HEIGHT - y) };
+	g_map_shading_box   = box;
+	g_map_shading_valid = false;
+	guiMapShadingCache  = AddVideoSurface(box.w, box.h, PIXEL_DEPTH);
+}
+
+
+static bool RestoreCachedMapShading(INT8 const* const shading)
+{
+	if (!g_map_shading_valid) return false;
+	if (memcmp(g_map_shading, shading, sizeof(g_map_shading)) != 0) return false;
+	BltVideoSurface(guiSAVEBUFFER, guiMapShadingCache, g_map_shading_box.x, g_map_shading_box.y, NULL);
+	return true;
+}
+
+
+static void CacheMapShading(INT8 const* const shading)
+{
+	memcpy(g_map_shading, shading, sizeof(g_map_shading));
+	BltVideoSurface(guiMapShadingCache, guiSAVEBUFFER, 0, 0, &g_map_shading_box);
+	g_map_shading_valid = true;
+}
+
+
 void DrawMap(void)
 {
 	if (!iCurrentMapSectorZ)
 	{
+		INT8 shading[MAP_WORLD_X * MAP_WORLD_Y];
+		GetMapShading(shading);
+
 		if (fZoomFlag)
 		{
 			if (iZoomX < WEST_ZOOM_BOUND)      iZoomX = WEST_ZOOM_BOUND;
@@ -620,59 +731,13 @@ void DrawMap(void)
 			if (h > src_h - y) h = src_h - y;
 			SGPBox const clip = { x, y, w, h };
 			BltVideoSurface(guiSAVEBUFFER, guiBIGMAP, MAP_VIEW_START_X + MAP_GRID_X, MAP_VIEW_START_Y + MAP_GRID_Y - 2, &clip);
+			ShadeMapSectors(shading);
 		}
-		else
+		else if (!RestoreCachedMapShading(shading))
 		{
 			BltVideoSurfaceHalf(guiSAVEBUFFER, guiBIGMAP, MAP_VIEW_START_X + 1, MAP_VIEW_START_Y, NULL);
-		}
-
-		// shade map sectors (must be done after Tixa/Orta/Mine icons have been blitted, but before icons!)
-		for (INT16 cnt = 1; cnt < MAP_WORLD_X - 1; ++cnt)
-		{
-			for (INT16 cnt2 = 1; cnt2 < MAP_WORLD_Y - 1; ++cnt2)
-			{
-				if (!GetSectorFlagStatus(cnt, cnt2, iCurrentMapSectorZ, SF_ALREADY_VISITED))
-				{
-					INT32 color;
-					if (fShowAircraftFlag)
-					{
-						if (!StrategicMap[cnt + cnt2 * WORLD_MAP_X].fEnemyAirControlled)
-						{
-							// sector not visited, not air controlled
-							color = MAP_SHADE_DK_GREEN;
-						}
-						else
-						{
-							// sector not visited, controlled and air not
-							color = MAP_SHADE_DK_RED;
-						}
-					}
-					else
-					{
-						// not visited
-						color = MAP_SHADE_BLACK;
-					}
-					ShadeMapElem(cnt, cnt2, color);
-				}
-				else
-				{
-					if (fShowAircraftFlag)
-					{
-						INT32 color;
-						if (!StrategicMap[cnt + cnt2 * WORLD_MAP_X].fEnemyAirControlled)
-						{
-							// sector visited and air controlled
-							color = MAP_SHADE_LT_GREEN;
-						}
-						else
-						{
-							// sector visited but not air controlled
-							color = MAP_SHADE_LT_RED;
-						}
-						ShadeMapElem(cnt, cnt2, color);
-					}
-				}
-			}
+			ShadeMapSectors(shading);
+			CacheMapShading(shading);
 		}
 
 		/* unfortunately, we can't shade these icons as part of shading the map,
@@ -3684,6 +3749,7 @@ static void DropAPersonInASector(UINT8 const type, UINT8 const sector)
 void LoadMapScreenInterfaceMapGraphics()
 {
 	guiBIGMAP                      = AddVideoSurfaceFromFile(INTERFACEDIR "/b_map.pcx");
+	CreateMapShadingCache();
 	guiBULLSEYE                    = AddVideoObjectFromFile(INTERFACEDIR "/bullseye.sti");
 	guiSAMICON                     = AddVideoObjectFromFile(INTERFACEDIR "/sam.sti");
 	guiCHARBETWEENSECTORICONS      = AddVideoObjectFromFile(INTERFACEDIR "/merc_between_sector_icons.sti");
@@ -3708,6 +3774,9 @@ void LoadMapScreenInterfaceMapGraphics()
 void DeleteMapScreenInterfaceMapGraphics()
 {
 	DeleteVideoSurface(guiBIGMAP);
+	DeleteVideoSurface(guiMapShadingCache);
+	guiMapShadingCache  = 0;
+	g_map_shading_valid = false;
 	DeleteVideoObject(guiBULLSEYE);
 	DeleteVideoObject(guiSAMICON);
 	DeleteVideoObject(guiCHARBETWEENSECTORICONS);
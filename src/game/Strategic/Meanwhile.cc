@@ -434,7 +434,7 @@ bool AreInMeanwhile()
 	/* Check to make sure a meanwhile scene isn't in the event list occurring at
 	 * the exact same time as this call. Meanwhile scenes have precedence over a
 	 * new battle if they occur in the same second. */
-	for (STRATEGICEVENT const* i = gpEventList; i; i = i->next)
+	for (STRATEGICEVENT const* i = FirstStrategicEvent(); i; i = NextStrategicEvent(i))
 	{
 		if (i->uiTimeStamp != GetWorldTotalSeconds()) return false;
 		if (i->ubCallbackID == EVENT_MEANWHILE)       return true;
@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <stdexcept>
 
 #include "Creature_Spreading.h"
@@ -47,6 +48,11 @@
 SECTORINFO SectorInfo[256];
 UNDERGROUND_SECTORINFO *gpUndergroundSectorInfoHead = NULL;
 extern UNDERGROUND_SECTORINFO* gpUndergroundSectorInfoTail;
+
+#define NUM_UNDERGROUND_LEVELS 3
+
+// The nodes of the underground sector list by level and position
+static UNDERGROUND_SECTORINFO* g_underground_index[NUM_UNDERGROUND_LEVELS][256];
 BOOLEAN gfPendingEnemies = FALSE;
 
 extern GARRISON_GROUP *gGarrisonGroup;
@@ -1129,21 +1135,34 @@ void LoadUnderGroundSectorInfoFromSavedGame(HWFILE const f)
 		gpUndergroundSectorInfoTail = u;
 		*anchor = u;
 		anchor  = &u->next;
+		IndexUnderGroundSector(u);
 	}
 }
 
 
+void IndexUnderGroundSector(UNDERGROUND_SECTORINFO* const u)
+{
+	if (u->ubSectorZ < 1 || NUM_UNDERGROUND_LEVELS < u->ubSectorZ) return;
+	if (u->ubSectorX < 1 || 16 < u->ubSectorX) return;
+	if (u->ubSectorY < 1 || 16 < u->ubSectorY) return;
+	// Like the search of the list did, keep the first node of a position
+	UNDERGROUND_SECTORINFO*& slot = g_underground_index[u->ubSectorZ - 1][SECTOR(u->ubSectorX, u->ubSectorY)];
+	if (!slot) slot = u;
+}
+
+
+void ClearUnderGroundSectorIndex()
+{
+	std::fill_n(&g_underground_index[0][0], NUM_UNDERGROUND_LEVELS * 256, (UNDERGROUND_SECTORINFO*)0);
+}
+
+
 UNDERGROUND_SECTORINFO* FindUnderGroundSector(INT16 const x, INT16 const y, UINT8 const z)
 {
-	UNDERGROUND_SECTORINFO* i = gpUndergroundSectorInfoHead;
-	for (; i; i = i->next)
-	{
-		if (i->ubSectorX != x) continue;
-		if (i->ubSectorY != y) continue;
-		if (i->ubSectorZ != z) continue;
-		break;
-	}
-	return i;
+	if (z < 1 || NUM_UNDERGROUND_LEVELS < z) return 0;
+	if (x < 1 || 16 < x)                     return 0;
+	if (y < 1 || 16 < y)                     return 0;
+	return g_underground_index[z - 1][SECTOR(x, y)];
 }
 
 
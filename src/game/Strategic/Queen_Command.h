@@ -35,6 +35,11 @@ void LoadUnderGroundSectorInfoFromSavedGame(HWFILE);
 //Finds and returns the specified underground structure ( DONT MODIFY IT ).  Else returns NULL
 UNDERGROUND_SECTORINFO* FindUnderGroundSector( INT16 sMapX, INT16 sMapY, UINT8 bMapZ );
 
+/* FindUnderGroundSector() looks the sectors up in an index by position, which
+ * has to be kept in step with the list of underground sectors. */
+void IndexUnderGroundSector(UNDERGROUND_SECTORINFO*);
+void ClearUnderGroundSectorIndex();
+
 void EnemyCapturesPlayerSoldier( SOLDIERTYPE *pSoldier );
 void BeginCaptureSquence(void);
 void EndCaptureSequence(void);
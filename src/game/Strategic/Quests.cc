@@ -4,6 +4,7 @@
 #include "Quests.h"
 #include "Game_Clock.h"
 #include "StrategicMap.h"
+#include "Soldier_Grid.h"
 #include "Soldier_Profile.h"
 #include "LaptopSave.h"
 #include "Handle_Items.h"
@@ -193,15 +194,16 @@ static INT8 NumWoundedMercsNearby(ProfileID const pid)
 	SOLDIERTYPE const* const npc = FindSoldierByProfileID(pid);
 	if (!npc) return 0;
 
-	INT8         n      = 0;
-	GridNo const gridno = npc->sGridNo;
-	FOR_EACH_MERC(i)
+	SOLDIERTYPE* nearby[TOTAL_SOLDIERS];
+	UINT const n_nearby = FindSoldiersNear(npc->sGridNo, HOSPITAL_PATIENT_DISTANCE, nearby);
+
+	INT8 n = 0;
+	for (UINT i = 0; i != n_nearby; ++i)
 	{
-		SOLDIERTYPE const& s = **i;
-		if (s.bTeam != OUR_TEAM)                                        continue;
-		if (s.bLife <= 0 || s.bLifeMax <= s.bLife)                         continue;
-		if (s.bAssignment == ASSIGNMENT_HOSPITAL)                          continue;
-		if (PythSpacesAway(gridno, s.sGridNo) > HOSPITAL_PATIENT_DISTANCE) continue;
+		SOLDIERTYPE const& s = *nearby[i];
+		if (s.bTeam != OUR_TEAM)                   continue;
+		if (s.bLife <= 0 || s.bLifeMax <= s.bLife) continue;
+		if (s.bAssignment == ASSIGNMENT_HOSPITAL)  continue;
 		++n;
 	}
 	return n;
@@ -416,13 +418,14 @@ static BOOLEAN CheckNPCSector(UINT8 ubProfileID, INT16 sSectorX, INT16 sSectorY,
 
 static bool AIMMercWithin(GridNo const gridno, INT16 const distance)
 {
-	FOR_EACH_MERC(i)
+	SOLDIERTYPE* nearby[TOTAL_SOLDIERS];
+	UINT const n = FindSoldiersNear(gridno, distance, nearby);
+	for (UINT i = 0; i != n; ++i)
 	{
-		SOLDIERTYPE const& s = **i;
-		if (s.bTeam               != OUR_TEAM)         continue;
+		SOLDIERTYPE const& s = *nearby[i];
+		if (s.bTeam               != OUR_TEAM)            continue;
 		if (s.bLife               <  OKLIFE)              continue;
 		if (s.ubWhatKindOfMercAmI != MERC_TYPE__AIM_MERC) continue;
-		if (PythSpacesAway(gridno, s.sGridNo) > distance) continue;
 		return true;
 	}
 	return false;
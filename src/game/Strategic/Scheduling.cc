@@ -42,6 +42,23 @@ extern const wchar_t* gszScheduleActions[NUM_SCHEDULE_ACTIONS];
 SCHEDULENODE *gpScheduleList = NULL;
 UINT8				gubScheduleID = 0;
 
+// The schedules in gpScheduleList by ID, so the schedule events need not walk the list
+static SCHEDULENODE* g_schedule_by_id[256];
+
+
+// Must be called whenever schedules are added to or removed from the list or renumbered
+static void IndexSchedules()
+{
+	memset(g_schedule_by_id, 0, sizeof(g_schedule_by_id));
+	for (SCHEDULENODE* i = gpScheduleList; i; i = i->next)
+	{
+		// If a broken save has an ID twice, the first schedule wins, like it did
+		// when the list was searched
+		SCHEDULENODE*& by_id = g_schedule_by_id[i->ubScheduleID];
+		if (!by_id) by_id = i;
+	}
+}
+
 
 //IMPORTANT:
 //This function adds a NEWLY allocated schedule to the list.  The pointer passed is totally
@@ -68,19 +85,12 @@ void CopyScheduleToList( SCHEDULENODE *pSchedule, SOLDIERINITNODE *pNode )
 			SLOGW("too many Schedules posted." );
 		}
 	}
+	IndexSchedules();
 }
 
 SCHEDULENODE* GetSchedule( UINT8 ubScheduleID )
 {
-	SCHEDULENODE *curr;
-	curr = gpScheduleList;
-	while( curr )
-	{
-		if( curr->ubScheduleID == ubScheduleID )
-			return curr;
-		curr = curr->next;
-	}
-	return NULL;
+	return g_schedule_by_id[ubScheduleID];
 }
 
 //Removes all schedules from the event list, and cleans out the list.
@@ -98,6 +108,7 @@ void DestroyAllSchedules()
 	}
 	gpScheduleList = NULL;
 	gubScheduleID = 0;
+	IndexSchedules();
 }
 
 // cleans out the schedule list without touching events, for saving & loading games
@@ -114,6 +125,7 @@ void DestroyAllSchedulesWithoutDestroyingEvents()
 	}
 	gpScheduleList = NULL;
 	gubScheduleID = 0;
+	IndexSchedules();
 }
 
 void DeleteSchedule( UINT8 ubScheduleID )
@@ -147,6 +159,7 @@ void DeleteSchedule( UINT8 ubScheduleID )
 	{
 		DeleteStrategicEvent( EVENT_PROCESS_TACTICAL_SCHEDULE, temp->ubScheduleID );
 		MemFree( temp );
+		IndexSchedules();
 	}
 }
 
@@ -282,6 +295,7 @@ void OptimizeSchedules()
 			pNode->pDetailedPlacement->ubScheduleID -= 100;
 		}
 	}
+	IndexSchedules();
 }
 
 //Called when transferring from the game to the editor.
@@ -323,6 +337,7 @@ void PrepareSchedulesForEditorEntry()
 			curr = curr->next;
 		}
 	}
+	IndexSchedules();
 }
 
 //Called when leaving the editor to enter the game.  This posts all of the events that apply.
@@ -366,6 +381,7 @@ void LoadSchedules(HWFILE const f)
 		*anchor = node;
 		anchor  = &node->next;
 	}
+	IndexSchedules();
 	// Schedules are posted when the soldier is added
 }
 
@@ -404,6 +420,7 @@ void LoadSchedulesFromSave(HWFILE const f)
 
 		++gubScheduleID;
 	}
+	IndexSchedules();
 	// Schedules are posted when the soldier is added
 }
 
@@ -433,6 +450,7 @@ void ReverseSchedules()
 	}
 	//Now assign the schedule list to the reverse head.
 	gpScheduleList = pReverseHead;
+	IndexSchedules();
 }
 
 //Another debug feature.
@@ -919,6 +937,7 @@ static void PostDefaultSchedule(SOLDIERTYPE* pSoldier)
 			SLOGA("Too many schedules posted" );
 		}
 	}
+	IndexSchedules();
 
 	PostSchedule( pSoldier );
 }
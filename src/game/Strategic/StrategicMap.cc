@@ -284,7 +284,8 @@ void BeginLoadScreen( )
 		uiStartTime = GetClock();
 		BltVideoSurface(guiSAVEBUFFER, FRAME_BUFFER, 0, 0, NULL);
 		PlayJA2SampleFromFile(SOUNDSDIR "/final psionic blast 01 (16-44).wav", HIGHVOLUME, 1, MIDDLEPAN);
-		while( iPercentage < 100  )
+		// A fixed clock does not advance during the transition, so it is skipped then
+		while (!ClockIsFixed() && iPercentage < 100)
 		{
 			uiCurrTime = GetClock();
 			iPercentage = (uiCurrTime-uiStartTime) * 100 / uiTimeRange;
@@ -353,9 +354,7 @@ UINT8 GetTownIdForSector(UINT8 const sector)
 
 UINT8 GetTownSectorSize(INT8 const town_id)
 {
-	UINT8 n = 0;
-	FOR_EACH_SECTOR_IN_TOWN(i, town_id) ++n;
-	return n;
+	return g_town_sector_begin[town_id + 1] - g_town_sector_begin[town_id];
 }
 
 
@@ -432,6 +431,19 @@ void GetMapFileName(INT16 const x, INT16 const y, INT8 const z, char* const buf,
 }
 
 
+void PrefetchSector(INT16 const x, INT16 const y, INT8 const z)
+{
+	if (x == gWorldSectorX && y == gWorldSectorY && z == gbWorldSectorZ) return;
+
+	// GetMapFileName() clears the flag, but it is meant for the next real load
+	if (gfUseAlternateMap) return;
+
+	char filename[50];
+	GetMapFileName(x, y, z, filename, TRUE);
+	PrefetchWorld(filename);
+}
+
+
 static void HandleRPCDescriptionOfSector(INT16 const x, INT16 const y, INT16 const z)
 {
 	struct SectorDescriptionInfo
@@ -2516,6 +2528,7 @@ void UpdateAirspaceControl( void )
 			StrategicMap[ CALCULATE_STRATEGIC_INDEX( iCounterA, iCounterB ) ].fEnemyAirControlled = fEnemyControlsAir;
 		}
 	}
+	InvalidateStrategicPaths();
 
 
 	// check if currently selected arrival sector still has secure airspace
@@ -2615,6 +2628,8 @@ void LoadStrategicInfoFromSavedFile(HWFILE const f)
 
 	// Load fFoundOrta
 	FileRead(f, &fFoundOrta, sizeof(BOOLEAN));
+
+	InvalidateStrategicPaths();
 }
 
 
@@ -89,6 +89,10 @@ void GetSectorIDString(INT16 x, INT16 y, INT8 z, wchar_t* buf, size_t length, BO
 
 void GetMapFileName(INT16 x, INT16 y, INT8 z, char* buf, BOOLEAN add_alternate_map_letter);
 
+/* Starts reading the assets of a sector in the background, because a squad is
+ * heading there. Nothing is done for the loaded sector. */
+void PrefetchSector(INT16 x, INT16 y, INT8 z);
+
 // Called from within tactical.....
 void JumpIntoAdjacentSector( UINT8 ubDirection, UINT8 ubJumpCode, INT16 sAdditionalData );
 
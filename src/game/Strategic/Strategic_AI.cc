@@ -35,6 +35,7 @@
 
 #include <algorithm>
 #include <stdexcept>
+#include <vector>
 
 #define SAI_VERSION		29
 
@@ -553,6 +554,9 @@ static void ValidateLargeGroup(GROUP* pGroup)
 }
 
 
+static void ForgetWeightInputs();
+
+
 void InitStrategicAI()
 {
 	gfExtraElites                      = FALSE;
@@ -647,6 +651,7 @@ void InitStrategicAI()
 	}
 	memcpy(gGarrisonGroup, gOrigGarrisonGroup, sizeof(gOrigGarrisonGroup));
 	gubGarrisonReinforcementsDenied = MALLOCNZ(UINT8, giGarrisonArraySize);
+	ForgetWeightInputs();
 
 	// Modify initial force sizes?
 	INT32 const force_percentage = giForcePercentage;
@@ -1756,12 +1761,67 @@ void RemoveGroupFromStrategicAILists(GROUP const& g)
 }
 
 
+/* The inputs of the last weight calculation of each garrison and patrol. A
+ * weight only changes with them, so the polls over all garrisons and patrols
+ * skip those whose population, size and priority did not change since, e.g. in
+ * a battle, by the arrival of a group or by a change of the sector's owner. */
+#define WEIGHT_INPUTS_UNKNOWN 0xFFFFFFFF
+
+static std::vector<UINT32> g_garrison_weight_inputs;
+static std::vector<UINT32> g_patrol_weight_inputs;
+static UINT32              g_weight_hour;
+static UINT32              g_weights_calculated; // this strategic hour
+static UINT32              g_weights_unchanged;
+
+
+static void ForgetWeightInputs()
+{
+	g_garrison_weight_inputs.assign(giGarrisonArraySize, WEIGHT_INPUTS_UNKNOWN);
+	g_patrol_weight_inputs.assign(giPatrolArraySize, WEIGHT_INPUTS_UNKNOWN);
+}
+
+
+/* Returns whether a weight has to be calculated again and remembers the
+ * inputs. Also counts the calculations of every strategic hour. */
+static bool WeightInputsChanged(UINT32& cached, UINT32 const inputs)
+{
+	UINT32 const hour = GetWorldTotalMin() / 60;
+	if (hour != g_weight_hour)
+	{
+		if (g_weights_calculated != 0 || g_weights_unchanged != 0)
+		{
+			SLOGD("Strategic AI weights in hour %u: %u calculated, %u unchanged",
+				g_weight_hour, g_weights_calculated, g_weights_unchanged);
+		}
+		g_weight_hour        = hour;
+		g_weights_calculated = 0;
+		g_weights_unchanged  = 0;
+	}
+
+	if (cached == inputs)
+	{
+		++g_weights_unchanged;
+		return false;
+	}
+	cached = inputs;
+	++g_weights_calculated;
+	return true;
+}
+
+
 /* Recalculates a group's weight based on any changes.
  * @@@Alex, this is possibly missing in some areas. It is hard to ensure it is
  * everywhere with all the changes I've made. I'm sure you could probably find
  * some missing calls. */
 static void RecalculatePatrolWeight(PATROL_GROUP& p)
 {
+	UINT32 const inputs =
+		p.ubGroupID |
+		(p.ubGroupID != 0 ? GetGroup(p.ubGroupID)->ubGroupSize : 0) << 8 |
+		(UINT8)p.bSize     << 16 |
+		(UINT8)p.bPriority << 24;
+	if (!WeightInputsChanged(g_patrol_weight_inputs[&p - gPatrolGroup], inputs)) return;
+
 	// First, remove the previous weight from the applicable field
 	INT32 const prev_weight = p.bWeight;
 	if (prev_weight > 0) giRequestPoints -= prev_weight;
@@ -1801,6 +1861,9 @@ static void RecalculateGarrisonWeight(INT32 iGarrisonID)
 	iCurrentPop = pSector->ubNumAdmins + pSector->ubNumTroops + pSector->ubNumElites;
 	iPriority = gArmyComp[ gGarrisonGroup[ iGarrisonID ].ubComposition ].bPriority;
 
+	UINT32 const inputs = (UINT8)iDesiredPop | (UINT8)iPriority << 8 | iCurrentPop << 16;
+	if (!WeightInputsChanged(g_garrison_weight_inputs[iGarrisonID], inputs)) return;
+
 	//First, remove the previous weight from the applicable field.
 	iPrevWeight = gGarrisonGroup[ iGarrisonID ].bWeight;
 	if( iPrevWeight > 0 )
@@ -2504,6 +2567,7 @@ void LoadStrategicAI(HWFILE const hFile)
 	{
 		FileRead(hFile, &gTempGarrisonGroup, sizeof(GARRISON_GROUP));
 	}
+	ForgetWeightInputs();
 
 	//Load the list of reinforcement patrol points.
 	if( gubPatrolReinforcementsDenied )
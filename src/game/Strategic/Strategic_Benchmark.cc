@@ -0,0 +1,124 @@
+#include "Strategic_Benchmark.h"
+#include "Benchmark_Suite.h"
+#include "ContentManager.h"
+#include "GameInstance.h"
+#include "GameSettings.h"
+#include "Game_Clock.h"
+#include "Game_Event_Hook.h"
+#include "Logger.h"
+#include "Profiler.h"
+#include "SaveLoadGame.h"
+#include "SoundMan.h"
+#include "Sound_Control.h"
+
+#include <SDL.h>
+
+#include <stdexcept>
+#include <stdio.h>
+#include <string>
+
+#ifndef _WIN32
+#	include <sys/resource.h>
+#endif
+
+
+static UINT32 CountStrategicEvents()
+{
+	UINT32 n = 0;
+	for (UINT kind = 0; kind != NUMBER_OF_EVENT_TYPES; ++kind)
+	{
+		n += GetStrategicEventStats(static_cast<StrategicEventKind>(kind)).count;
+	}
+	return n;
+}
+
+
+// The peak resident memory of the process in KiB, 0 if it is not known
+static UINT32 PeakMemoryKB()
+{
+#ifdef _WIN32
+	return 0;
+#else
+	rusage usage;
+	if (getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+#	ifdef __APPLE__
+	return usage.ru_maxrss / 1024; // bytes
+#	else
+	return usage.ru_maxrss;
+#	endif
+#endif
+}
+
+
+void BenchmarkStrategicSimulation(UINT8 const save_slot, UINT32 const days)
+{
+	// Loading a game saves the current one first in dead is dead mode
+	gGameOptions.ubGameSaveMode = DIF_CAN_SAVE;
+	try
+	{
+		LoadSavedGame(save_slot);
+	}
+	catch (std::exception const& e)
+	{
+		SLOGW("Strategic benchmark: failed to load save game %u: %s", save_slot, e.what());
+		return;
+	}
+
+	UINT32 const sound_volume  = GetSoundEffectsVolume();
+	UINT32 const speech_volume = GetSpeechVolume();
+	SetSoundEffectsVolume(0);
+	SetSpeechVolume(0);
+
+	ResetStrategicEventStats();
+	UINT32   const start_clock = GetWorldTotalSeconds();
+	UINT32   const end_clock   = start_clock + days * NUM_SEC_IN_DAY;
+	UINT32         warps       = 0;
+	UINT32         interrupts  = 0;
+	uint64_t const start       = SDL_GetPerformanceCounter();
+	while (GetWorldTotalSeconds() < end_clock)
+	{
+		UINT32 const clock  = GetWorldTotalSeconds();
+		UINT32 const events = CountStrategicEvents();
+		WarpGameTime(MIN(NUM_SEC_IN_HOUR, end_clock - clock), WARPTIME_PROCESS_EVENTS_NORMALLY);
+		++warps;
+		// Interrupts stop time compression, here the simulation just goes on
+		if (gfTimeInterrupt) ++interrupts;
+		if (GetWorldTotalSeconds() == clock && CountStrategicEvents() == events)
+		{
+			SLOGW("Strategic benchmark: the clock got stuck at %u", clock);
+			break;
+		}
+	}
+	uint64_t const ticks = SDL_GetPerformanceCounter() - start;
+
+	SoundStopAll();
+	SetSoundEffectsVolume(sound_volume);
+	SetSpeechVolume(speech_volume);
+
+	UINT32 const n_events  = CountStrategicEvents();
+	double const ms        = TicksToMS(ticks);
+	double const game_days = (double)(GetWorldTotalSeconds() - start_clock) / NUM_SEC_IN_DAY;
+	SLOGI("Strategic benchmark, save game %u: %.2f days in %.1f ms, %u events, %u warps, %u interrupts, %.1f days per second, peak memory %u KiB",
+		save_slot, game_days, ms, n_events, warps, interrupts, ms > 0 ? game_days * 1000 / ms : 0, PeakMemoryKB());
+	if (game_days > 0) RecordBenchmarkResult("strategic.ms_per_day", ms / game_days);
+
+	std::string const path = GCM->getScreenshotFolder() + "/strategicbench.csv";
+	FILE* const f = fopen(path.c_str(), "w");
+	if (!f)
+	{
+		SLOGW("Failed to write the strategic benchmark %s", path.c_str());
+		return;
+	}
+	fputs("event,count,total_ms,average_us\n", f);
+	for (UINT kind = 0; kind != NUMBER_OF_EVENT_TYPES; ++kind)
+	{
+		StrategicEventStats const& s = GetStrategicEventStats(static_cast<StrategicEventKind>(kind));
+		if (s.count == 0) continue;
+		double const kind_ms = TicksToMS(s.ticks);
+		SLOGD("Strategic benchmark, event %u: %u times, %.2f ms", kind, s.count, kind_ms);
+		fprintf(f, "%u,%u,%.3f,%.1f\n", kind, s.count, kind_ms, kind_ms * 1000 / s.count);
+	}
+	fprintf(f, "total,%u,%.3f,\n", n_events, ms);
+	fprintf(f, "peak_memory_kb,%u,,\n", PeakMemoryKB());
+	fclose(f);
+}
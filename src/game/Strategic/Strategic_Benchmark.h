@@ -0,0 +1,16 @@
+#ifndef STRATEGIC_BENCHMARK_H
+#define STRATEGIC_BENCHMARK_H
+
+#include "Types.h"
+
+
+/* Loads the given save game and lets the strategic simulation run for the
+ * given number of days in one go, as time compression does but without
+ * rendering and with the sound muted. The events processed and the time spent
+ * in each kind of event, the throughput and the peak memory use of the process
+ * are logged and written to strategicbench.csv in the screenshot folder for
+ * comparing runs. The game is left in the state the simulation reached, so
+ * this is only to be run from the main menu. */
+void BenchmarkStrategicSimulation(UINT8 save_slot, UINT32 days);
+
+#endif
@@ -17,6 +17,7 @@
 #include "Game_Event_Hook.h"
 #include "GameSettings.h"
 #include "Strategic_AI.h"
+#include "Strategic_Movement.h"
 #include "History.h"
 #include "Campaign_Types.h"
 #include "Debug.h"
@@ -398,46 +399,49 @@ static UINT32 ExtractOreFromMine(INT8 bMineIndex, UINT32 uiAmount)
 }
 
 
-// get available workforce for the mine
-static INT32 GetAvailableWorkForceForMineForPlayer(INT8 bMineIndex)
+// whether the mine's workers work for the player at all
+static bool MineWorksForPlayer(INT8 const bMineIndex)
 {
-	// look for available workforce in the town associated with the mine
-	INT32 iWorkForceSize = 0;
-	INT8 bTownId = 0;
-
-	// return the loyalty of the town associated with the mine
-
 	Assert( ( bMineIndex >= 0 ) && ( bMineIndex < MAX_NUMBER_OF_MINES ) );
 
 	// if mine is shut down
 	if ( gMineStatus[ bMineIndex ].fShutDown)
 	{
-		return ( 0 );
+		return false;
 	}
 
 	// until the player contacts the head miner, production in mine ceases if in player's control
-	if ( !gMineStatus[ bMineIndex ].fSpokeToHeadMiner)
-	{
-		return ( 0 );
-	}
+	return gMineStatus[ bMineIndex ].fSpokeToHeadMiner;
+}
 
 
-	bTownId = gMineLocation[ bMineIndex ].bAssociatedTown;
+// workforce of a mine working for the player, given how many sectors of its town he controls
+static INT32 GetWorkForceForPlayer(INT8 const bMineIndex, UINT8 const ubSectorsUnderControl)
+{
+	INT8 const bTownId = gMineLocation[ bMineIndex ].bAssociatedTown;
 
 	Assert ( GetTownSectorSize( bTownId ) != 0 );
 
-
 	// get workforce size (is 0-100 based on local town's loyalty)
-	iWorkForceSize = gTownLoyalty[ bTownId ].ubRating;
+	INT32 iWorkForceSize = gTownLoyalty[ bTownId ].ubRating;
 
 	// now adjust for town size.. the number of sectors you control
-	iWorkForceSize *= GetTownSectorsUnderControl( bTownId );
+	iWorkForceSize *= ubSectorsUnderControl;
 	iWorkForceSize /= GetTownSectorSize( bTownId );
 
 	return ( iWorkForceSize );
 }
 
 
+// get available workforce for the mine
+static INT32 GetAvailableWorkForceForMineForPlayer(INT8 bMineIndex)
+{
+	// look for available workforce in the town associated with the mine
+	if (!MineWorksForPlayer(bMineIndex)) return 0;
+	return GetWorkForceForPlayer(bMineIndex, GetTownSectorsUnderControl(gMineLocation[bMineIndex].bAssociatedTown));
+}
+
+
 // get workforce conscripted by enemy for mine
 static INT32 GetAvailableWorkForceForMineForEnemy(INT8 bMineIndex)
 {
@@ -584,6 +588,18 @@ void HandleIncomeFromMines( void )
 }
 
 
+// the daily income from a mine the player controls, at the given workforce
+static UINT32 DailyIncomeFromMine(INT8 const mine_id, INT32 const work_force)
+{
+	/* Get daily income for this mine (regardless of what time of day it currently
+	 * is) */
+	UINT32 const rate      = gMineStatus[mine_id].uiMaxRemovalRate * work_force / 100;
+	UINT32 const amount    = MINE_PRODUCTION_NUMBER_OF_PERIODS * rate;
+	UINT32 const remaining = gMineStatus[mine_id].uiRemainingOreSupply;
+	return amount < remaining ? amount : remaining;
+}
+
+
 UINT32 PredictDailyIncomeFromAMine(INT8 const mine_id)
 {
 	/* Predict income from this mine, estimate assumes mining situation will not
@@ -592,23 +608,46 @@ UINT32 PredictDailyIncomeFromAMine(INT8 const mine_id)
 	 * change) */
 	if (!PlayerControlsMine(mine_id)) return 0;
 
-	/* Get daily income for this mine (regardless of what time of day it currently
-	 * is) */
-	UINT32 const amount    = MINE_PRODUCTION_NUMBER_OF_PERIODS * GetCurrentWorkRateOfMineForPlayer(mine_id);
-	UINT32 const remaining = gMineStatus[mine_id].uiRemainingOreSupply;
-	return amount < remaining ? amount : remaining;
+	return DailyIncomeFromMine(mine_id, GetAvailableWorkForceForMineForPlayer(mine_id));
 }
 
 
 INT32 PredictIncomeFromPlayerMines( void )
 {
-	INT32 iTotal = 0;
-	INT8 bCounter = 0;
+	/* Whether a town sector is under control depends on the enemy groups in it.
+	 * Count them by sector once for all mines, instead of walking the groups for
+	 * every sector of every mine's town. */
+	UINT8 mobile_enemies[256] = {};
+	CFOR_EACH_ENEMY_GROUP(g)
+	{
+		if (g->fVehicle) continue;
+		if (g->ubSectorX < 1 || 16 < g->ubSectorX || g->ubSectorY < 1 || 16 < g->ubSectorY) continue;
+		mobile_enemies[SECTOR(g->ubSectorX, g->ubSectorY)] += g->ubGroupSize;
+	}
 
-	for( bCounter = 0; bCounter < MAX_NUMBER_OF_MINES; bCounter++ )
+	INT32 iTotal = 0;
+	for (INT8 mine_id = 0; mine_id != MAX_NUMBER_OF_MINES; ++mine_id)
 	{
+		if (!PlayerControlsMine(mine_id)) continue;
+
+		INT32 work_force = 0;
+		if (MineWorksForPlayer(mine_id))
+		{
+			// as GetTownSectorsUnderControl() counts them
+			UINT8 n_under_control = 0;
+			FOR_EACH_SECTOR_IN_TOWN(i, gMineLocation[mine_id].bAssociatedTown)
+			{
+				if (StrategicMap[SECTOR_INFO_TO_STRATEGIC_INDEX(i->sector)].fEnemyControlled) continue;
+				SECTORINFO const& si        = SectorInfo[i->sector];
+				UINT8      const  n_enemies = si.ubNumAdmins + si.ubNumTroops + si.ubNumElites + mobile_enemies[i->sector];
+				if (n_enemies != 0) continue;
+				++n_under_control;
+			}
+			work_force = GetWorkForceForPlayer(mine_id, n_under_control);
+		}
+
 		// add up the total
-		iTotal += PredictDailyIncomeFromAMine( bCounter );
+		iTotal += DailyIncomeFromMine(mine_id, work_force);
 	}
 
 	return( iTotal );
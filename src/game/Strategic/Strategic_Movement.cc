@@ -97,6 +97,13 @@ static GROUP* gpGroupPrompting = NULL;
 
 static UINT32 uniqueIDMask[8] = { 0, 0, 0, 0, 0, 0, 0, 0 };
 
+/* Indexes of gpGroupList: the groups by ID, and the groups per current and
+ * next sector, so the lookups do not have to walk the whole list. */
+static GROUP*              g_groups_by_id[256];
+static std::vector<GROUP*> g_groups_in_sector[256];
+static std::vector<GROUP*> g_groups_heading_to[256];
+static UINT32              g_group_list_order;
+
 
 static GROUP* gpInitPrebattleGroup = NULL;
 
@@ -179,6 +186,7 @@ void AddPlayerToGroup(GROUP& g, SOLDIERTYPE& s)
 		g.ubSectorX   = s.sSectorX;
 		g.ubSectorY   = s.sSectorY;
 		g.ubSectorZ   = s.bSectorZ;
+		ReindexGroupSector(g);
 	}
 	else
 	{
@@ -267,6 +275,7 @@ BOOLEAN GroupReversingDirectionsBetweenSectors( GROUP *pGroup, UINT8 ubSectorX,
 	pGroup->ubNextY = pGroup->ubSectorY;
 	pGroup->ubSectorX = pGroup->ubPrevX;
 	pGroup->ubSectorY = pGroup->ubPrevY;
+	ReindexGroupSector(*pGroup);
 
 	if( pGroup->fPlayer )
 	{
@@ -518,6 +527,72 @@ GROUP* CreateNewEnemyGroupDepartingFromSector( UINT32 uiSector, UINT8 ubNumAdmin
 
 //INTERNAL LIST MANIPULATION FUNCTIONS
 
+static INT16 SectorIndexKey(UINT8 const x, UINT8 const y)
+{
+	if (x < 1 || 16 < x || y < 1 || 16 < y) return 0;
+	return SECTOR(x, y) + 1;
+}
+
+
+static bool EarlierInList(GROUP const* const a, GROUP const* const b)
+{
+	return a->uiListOrder < b->uiListOrder;
+}
+
+
+static void MoveInSectorIndex(std::vector<GROUP*>* const buckets, GROUP* const g, INT16& indexed, INT16 const key)
+{
+	if (indexed == key) return;
+	if (indexed != 0)
+	{
+		std::vector<GROUP*>& b = buckets[indexed - 1];
+		b.erase(std::find(b.begin(), b.end(), g));
+	}
+	if (key != 0)
+	{
+		std::vector<GROUP*>& b = buckets[key - 1];
+		b.insert(std::upper_bound(b.begin(), b.end(), g, EarlierInList), g);
+	}
+	indexed = key;
+}
+
+
+void ReindexGroupSector(GROUP& g)
+{
+	MoveInSectorIndex(g_groups_in_sector,  &g, g.sIndexedSector, SectorIndexKey(g.ubSectorX, g.ubSectorY));
+	MoveInSectorIndex(g_groups_heading_to, &g, g.sIndexedNext,   SectorIndexKey(g.ubNextX,   g.ubNextY));
+}
+
+
+// Enters a group which has just been appended to the list into the indexes
+static void IndexNewGroup(GROUP* const g)
+{
+	if (!g_groups_by_id[g->ubGroupID]) g_groups_by_id[g->ubGroupID] = g;
+	g->uiListOrder    = g_group_list_order++;
+	g->sIndexedSector = 0;
+	g->sIndexedNext   = 0;
+	ReindexGroupSector(*g);
+}
+
+
+static void UnindexGroup(GROUP* const g)
+{
+	MoveInSectorIndex(g_groups_in_sector,  g, g->sIndexedSector, 0);
+	MoveInSectorIndex(g_groups_heading_to, g, g->sIndexedNext,   0);
+
+	GROUP*& by_id = g_groups_by_id[g->ubGroupID];
+	if (by_id != g) return;
+	// Saves of an old version can have duplicate IDs, the next one takes over
+	by_id = NULL;
+	FOR_EACH_GROUP(i)
+	{
+		if (i == g || i->ubGroupID != g->ubGroupID) continue;
+		by_id = i;
+		break;
+	}
+}
+
+
 //When adding any new group to the list, this is what must be done:
 //1)  Find the first unused ID (unique)
 //2)  Assign that ID to the new group
@@ -540,6 +615,7 @@ static UINT8 AddGroupToList(GROUP* const g)
 		GROUP** i = &gpGroupList;
 		while (*i != NULL) i = &(*i)->next;
 		*i = g;
+		IndexNewGroup(g);
 
 		return id;
 	}
@@ -557,6 +633,7 @@ static void RemoveGroupFromList(GROUP* const g)
 
 		// Found the group, so now remove it.
 		*i = g->next;
+		UnindexGroup(g);
 
 		// Clear the unique group ID
 		const UINT32 index = g->ubGroupID / 32;
@@ -574,12 +651,23 @@ static void RemoveGroupFromList(GROUP* const g)
 
 GROUP* GetGroup( UINT8 ubGroupID )
 {
-	FOR_EACH_GROUP(curr)
-	{
-		if( curr->ubGroupID == ubGroupID )
-			return curr;
-	}
-	return NULL;
+	return g_groups_by_id[ubGroupID];
+}
+
+
+std::vector<GROUP*> const& GetGroupsInSector(UINT8 const x, UINT8 const y)
+{
+	static std::vector<GROUP*> const none;
+	INT16 const key = SectorIndexKey(x, y);
+	return key != 0 ? g_groups_in_sector[key - 1] : none;
+}
+
+
+std::vector<GROUP*> const& GetGroupsHeadingToSector(UINT8 const x, UINT8 const y)
+{
+	static std::vector<GROUP*> const none;
+	INT16 const key = SectorIndexKey(x, y);
+	return key != 0 ? g_groups_heading_to[key - 1] : none;
 }
 
 
@@ -753,9 +841,10 @@ static BOOLEAN CheckConditionsForBattle(GROUP* pGroup)
 
 	HandleOtherGroupsArrivingSimultaneously( pGroup->ubSectorX, pGroup->ubSectorY, pGroup->ubSectorZ );
 
-	FOR_EACH_PLAYER_GROUP(i)
+	for (GROUP* const i : GetGroupsInSector(pGroup->ubSectorX, pGroup->ubSectorY))
 	{
 		GROUP& g = *i;
+		if (!g.fPlayer) continue;
 		if (g.ubGroupSize)
 		{
 			if (!g.fBetweenSectors)
@@ -1180,6 +1269,7 @@ void GroupArrivedAtSector(GROUP& g, BOOLEAN const check_for_battle, BOOLEAN cons
 	g.ubSectorY = y;
 	g.ubNextX   = 0;
 	g.ubNextY   = 0;
+	ReindexGroupSector(g);
 
 	if (g.fPlayer)
 	{
@@ -1487,7 +1577,7 @@ static void HandleOtherGroupsArrivingSimultaneously(UINT8 const x, UINT8 const y
 	UINT32 const now = GetWorldTotalSeconds();
 	gubNumGroupsArrivedSimultaneously = 0;
 restart:
-	for (STRATEGICEVENT* i = gpEventList; i && i->uiTimeStamp <= now; i = i->next)
+	for (STRATEGICEVENT* i = FirstStrategicEvent(); i && i->uiTimeStamp <= now; i = NextStrategicEvent(i))
 	{
 		if (i->ubCallbackID != EVENT_GROUP_ARRIVAL) continue;
 		if (i->ubFlags & SEF_DELETION_PENDING)      continue;
@@ -1561,6 +1651,7 @@ static void PrepareGroupsForSimultaneousArrival()
 	first_group.ubNextY         = first_group.ubSectorY;
 	first_group.ubSectorX       = first_group.ubPrevX;
 	first_group.ubSectorY       = first_group.ubPrevY;
+	ReindexGroupSector(first_group);
 	SetGroupArrivalTime(first_group, latest_arrival_time);
 	first_group.fBetweenSectors = TRUE;
 
@@ -1658,9 +1749,10 @@ static void PlanSimultaneousGroupArrivalCallback(MessageBoxReturnValue const bMe
 
 static void DelayEnemyGroupsIfPathsCross(GROUP& player_group)
 {
-	FOR_EACH_ENEMY_GROUP(i)
+	for (GROUP* const i : GetGroupsHeadingToSector(player_group.ubSectorX, player_group.ubSectorY))
 	{
 		GROUP& g = *i;
+		if (g.fPlayer) continue;
 		// Check to see if this group will arrive in next sector before the player group.
 		if (g.uiArrivalTime >= player_group.uiArrivalTime) continue;
 		// Check to see if enemy group will cross paths with player group.
@@ -1741,6 +1833,11 @@ static void InitiateGroupMovementToNextSector(GROUP* pGroup)
 	//All conditions for moving to the next waypoint are now good.
 	pGroup->ubNextX = (UINT8)( dx + pGroup->ubSectorX );
 	pGroup->ubNextY = (UINT8)( dy + pGroup->ubSectorY );
+	ReindexGroupSector(*pGroup);
+	if (pGroup->fPlayer && !IsGroupTheHelicopterGroup(*pGroup))
+	{ // Warm up the disk cache while the squad travels
+		PrefetchSector(pGroup->ubNextX, pGroup->ubNextY, pGroup->ubSectorZ);
+	}
 	//Calc time to get to next waypoint...
 	ubSector = (UINT8)SECTOR( pGroup->ubSectorX, pGroup->ubSectorY );
 	if( !pGroup->ubSectorZ )
@@ -1944,6 +2041,7 @@ void SetGroupSectorValue(INT16 const x, INT16 const y, INT16 const z, GROUP& g)
 	g.ubNextY         = y;
 	g.ubSectorZ       = z;
 	g.fBetweenSectors = FALSE;
+	ReindexGroupSector(g);
 
 	// Set next sectors same as current
 	g.ubOriginalSector = SECTOR(x, y);
@@ -1974,6 +2072,7 @@ void SetEnemyGroupSector(GROUP& g, UINT8 const sector_id)
 	g.ubSectorY = g.ubNextY = SECTORY(sector_id);
 	g.ubSectorZ = 0;
 	g.fBetweenSectors = FALSE;
+	ReindexGroupSector(g);
 }
 
 
@@ -1985,6 +2084,7 @@ static void SetGroupNextSectorValue(INT16 const x, INT16 const y, GROUP& g)
 	g.ubNextX         = x;
 	g.ubNextY         = y;
 	g.fBetweenSectors = FALSE;
+	ReindexGroupSector(g);
 	// Set next sectors same as current
 	g.ubOriginalSector = SECTOR(g.ubSectorX, g.ubSectorY);
 }
@@ -2144,7 +2244,33 @@ INT32 GetSectorMvtTimeForGroup(UINT8 const ubSector, UINT8 const direction, GROU
 {
 	/* Determine the group's method(s) of transportation.  If more than one, we
 	 * will always use the highest time. */
-	UINT8 const transport_mask     = g->ubTransportationMask;
+	return GetSectorMvtTime(ubSector, direction, g->ubTransportationMask, GetGroupFootEncumbrance(*g));
+}
+
+
+INT32 GetGroupFootEncumbrance(GROUP const& g)
+{
+	INT32 highest_encumbrance = 100;
+	if (!g.fPlayer || !(g.ubTransportationMask & FOOT)) return highest_encumbrance;
+
+	CFOR_EACH_PLAYER_IN_GROUP(curr, &g)
+	{
+		SOLDIERTYPE const* const s = curr->pSoldier;
+		if (s->bAssignment == VEHICLE) continue;
+		/* Soldier is on foot and travelling.  Factor encumbrance into movement
+		 * rate. */
+		INT32 const encumbrance = CalculateCarriedWeight(s);
+		if (highest_encumbrance < encumbrance)
+		{
+			highest_encumbrance = encumbrance;
+		}
+	}
+	return highest_encumbrance;
+}
+
+
+INT32 GetSectorMvtTime(UINT8 const ubSector, UINT8 const direction, UINT8 const transport_mask, INT32 const foot_encumbrance)
+{
 	UINT8 const traverse_type      = SectorInfo[ubSector].ubTraversability[direction];
 	INT32       best_traverse_time = 1000000;
 
@@ -2181,23 +2307,7 @@ INT32 GetSectorMvtTimeForGroup(UINT8 const ubSector, UINT8 const direction, GROU
 		if (best_traverse_time > traverse_time)
 			best_traverse_time = traverse_time;
 
-		if (g->fPlayer)
-		{
-			INT32 highest_encumbrance = 100;
-			CFOR_EACH_PLAYER_IN_GROUP(curr, g)
-			{
-				SOLDIERTYPE const* const s = curr->pSoldier;
-				if (s->bAssignment == VEHICLE) continue;
-				/* Soldier is on foot and travelling.  Factor encumbrance into movement
-				 * rate. */
-				INT32 const encumbrance = CalculateCarriedWeight(s);
-				if (highest_encumbrance < encumbrance)
-				{
-					highest_encumbrance = encumbrance;
-				}
-			}
-			best_traverse_time = best_traverse_time * highest_encumbrance / 100;
-		}
+		best_traverse_time = best_traverse_time * foot_encumbrance / 100;
 	}
 
 	if (transport_mask & CAR)
@@ -2264,8 +2374,9 @@ INT32 GetSectorMvtTimeForGroup(UINT8 const ubSector, UINT8 const direction, GROU
 UINT8 PlayerMercsInSector(UINT8 const x, UINT8 const y, UINT8 const z)
 {
 	UINT8 n_mercs = 0;
-	CFOR_EACH_PLAYER_GROUP(g)
+	for (GROUP const* const g : GetGroupsInSector(x, y))
 	{
+		if (!g->fPlayer)        continue;
 		if (g->fBetweenSectors) continue;
 		if (g->ubSectorX != x || g->ubSectorY != y || g->ubSectorZ != z) continue;
 		/* We have a group, make sure that it isn't a group containing only dead
@@ -2286,8 +2397,9 @@ UINT8 PlayerMercsInSector(UINT8 const x, UINT8 const y, UINT8 const z)
 UINT8 PlayerGroupsInSector(UINT8 const x, UINT8 const y, UINT8 const z)
 {
 	UINT8 n_groups = 0;
-	CFOR_EACH_PLAYER_GROUP(g)
+	for (GROUP const* const g : GetGroupsInSector(x, y))
 	{
+		if (!g->fPlayer)        continue;
 		if (g->fBetweenSectors) continue;
 		if (g->ubSectorX != x || g->ubSectorY != y || g->ubSectorZ != z) continue;
 		/* We have a group, make sure that it isn't a group containing only dead
@@ -2452,6 +2564,7 @@ void MoveAllGroupsInCurrentSectorToSector(UINT8 const x, UINT8 const y, UINT8 co
 		g->ubSectorX = x;
 		g->ubSectorY = y;
 		g->ubSectorZ = z;
+		ReindexGroupSector(*g);
 		CFOR_EACH_PLAYER_IN_GROUP(p, g)
 		{
 			p->pSoldier->sSectorX        = x;
@@ -2596,6 +2709,7 @@ void LoadStrategicMovementGroupsFromSavedGameFile(HWFILE const f)
 		// Add the node to the list
 		*anchor = g;
 		anchor  = &g->next;
+		IndexNewGroup(g);
 	}
 
 	//@@@ TEMP!
@@ -2814,6 +2928,7 @@ void RetreatGroupToPreviousSector(GROUP& g)
 	{ // Group has a previous sector
 		g.ubNextX = g.ubPrevX;
 		g.ubNextY = g.ubPrevY;
+		ReindexGroupSector(g);
 
 		// Determine the correct direction
 		INT32 const dx = g.ubNextX - g.ubSectorX;
@@ -2890,9 +3005,10 @@ GROUP* FindEnemyMovementGroupInSector(const UINT8 ubSectorX, const UINT8 ubSecto
 
 GROUP* FindPlayerMovementGroupInSector(const UINT8 x, const UINT8 y)
 {
-	FOR_EACH_PLAYER_GROUP(i)
+	for (GROUP* const i : GetGroupsInSector(x, y))
 	{
 		GROUP& g = *i;
+		if (!g.fPlayer) continue;
 		// NOTE: These checks must always match the INVOLVED group checks in PBI!!!
 		if (g.ubGroupSize != 0 &&
 			!g.fBetweenSectors &&
@@ -3515,6 +3631,7 @@ static void CancelEmptyPersistentGroupMovement(GROUP& g)
 	g.ubSectorY       = 0;
 	g.ubNextX         = 0;
 	g.ubNextY         = 0;
+	ReindexGroupSector(g);
 }
 
 
@@ -3,6 +3,8 @@
 
 #include "JA2Types.h"
 
+#include <vector>
+
 
 enum //enemy intentions,
 {
@@ -110,6 +112,10 @@ struct GROUP
 		ENEMYGROUP *pEnemyGroup;		//a structure containing general enemy info
 	};
 	GROUP* next;						//next group
+
+	UINT32 uiListOrder;					//increases along gpGroupList, keeps the sector indexes in list order
+	INT16 sIndexedSector;				//sector index buckets the group is in, SECTOR() + 1, 0 for none
+	INT16 sIndexedNext;
 };
 
 
@@ -146,6 +152,16 @@ extern GROUP *gpGroupList;
 void RemoveAllGroups(void);
 GROUP* GetGroup( UINT8 ubGroupID );
 
+/* The groups whose ubSectorX/Y resp. ubNextX/Y is the given sector, in the
+ * order of gpGroupList, on any level. The list is only valid until a group is
+ * moved, added or removed. */
+std::vector<GROUP*> const& GetGroupsInSector(UINT8 x, UINT8 y);
+std::vector<GROUP*> const& GetGroupsHeadingToSector(UINT8 x, UINT8 y);
+
+/* Updates the sector indexes after ubSectorX/Y or ubNextX/Y of a group in the
+ * list has been changed. */
+void ReindexGroupSector(GROUP&);
+
 /* Remove a group from the list. This removes all of the waypoints as well as
  * the members of the group. Calling this function doesn't position them in a
  * sector. It is up to you to do that. The event system will automatically
@@ -206,6 +222,13 @@ static UINT32 const TRAVERSE_TIME_IMPOSSIBLE = 0xFFFFFFFF;
 // Get travel time for this group
 INT32 GetSectorMvtTimeForGroup(UINT8 ubSector, UINT8 ubDirection, GROUP const*);
 
+/* Travel time out of a sector for any group with these means of transportation,
+ * whose slowest merc on foot carries foot_encumbrance percent of his strength. */
+INT32 GetSectorMvtTime(UINT8 ubSector, UINT8 ubDirection, UINT8 transport_mask, INT32 foot_encumbrance);
+
+// 100 unless the group is the player's and has mercs walking
+INT32 GetGroupFootEncumbrance(GROUP const&);
+
 UINT8 PlayerMercsInSector( UINT8 ubSectorX, UINT8 ubSectorY, UINT8 ubSectorZ );
 UINT8 PlayerGroupsInSector( UINT8 ubSectorX, UINT8 ubSectorY, UINT8 ubSectorZ );
 
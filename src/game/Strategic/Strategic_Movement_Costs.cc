@@ -1,6 +1,7 @@
 #include "Campaign_Types.h"
 #include "Strategic_Movement.h"
 #include "Strategic_Movement_Costs.h"
+#include "Strategic_Pathing.h"
 
 
 #define A  SAND
@@ -155,6 +156,7 @@ void InitStrategicMovementCosts()
 			s.ubTraversability[THROUGH_STRATEGIC_MOVE] = g_traverse_through[y][x];
 		}
 	}
+	InvalidateStrategicPaths();
 }
 
 
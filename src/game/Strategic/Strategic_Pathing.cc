@@ -19,11 +19,62 @@
 #include "Strategic_AI.h"
 #include "Debug.h"
 #include "MemMan.h"
+#include "Prefetch.h"
 
 #include <algorithm>
 #include <iterator>
+#include <vector>
 
 static UINT16  gusMapPathingData[256];
+
+
+/* Path nodes are taken from slabs and go on a free list when they are freed,
+ * because the map screen builds and clears whole paths on every mouse move. */
+#define PATH_NODE_SLAB_SIZE 256 // nodes per slab
+
+static std::vector<PathSt*> g_path_node_slabs;
+static size_t               g_path_node_slab_used = PATH_NODE_SLAB_SIZE; // nodes taken from the last slab
+static PathSt*              g_free_path_nodes;  // linked through pNext
+static UINT32               g_path_nodes_used;
+static UINT32               g_path_nodes_peak;
+
+
+PathSt* AllocPathNode()
+{
+	PathSt* n = g_free_path_nodes;
+	if (n)
+	{
+		g_free_path_nodes = n->pNext;
+	}
+	else
+	{
+		if (g_path_node_slab_used == PATH_NODE_SLAB_SIZE)
+		{
+			g_path_node_slabs.push_back(MALLOCN(PathSt, PATH_NODE_SLAB_SIZE));
+			g_path_node_slab_used = 0;
+		}
+		n = &g_path_node_slabs.back()[g_path_node_slab_used++];
+	}
+
+	if (++g_path_nodes_used > g_path_nodes_peak) g_path_nodes_peak = g_path_nodes_used;
+	return n;
+}
+
+
+void FreePathNode(PathSt* const n)
+{
+	Assert(g_path_nodes_used != 0);
+	--g_path_nodes_used;
+	n->pNext          = g_free_path_nodes;
+	g_free_path_nodes = n;
+}
+
+
+void LogPathNodeUsage()
+{
+	SLOGD("Strategic path nodes: %u in use, peak %u in %u slabs",
+		g_path_nodes_used, g_path_nodes_peak, (UINT32)g_path_node_slabs.size());
+}
 static BOOLEAN gfPlotToAvoidPlayerInfuencedSectors = FALSE;
 
 
@@ -162,6 +213,61 @@ static short         trailStratTreedxB = 0;
 static INT32 queRequests;
 
 
+/* The travel times out of every sector in each direction are the same for all
+ * groups with the same means of transportation, so they are looked up once per
+ * transportation mask and kept until the traversability changes. */
+#define NUM_TRANSPORT_MASKS (AIR << 1)
+
+static INT32  g_travel_time[NUM_TRANSPORT_MASKS][256][4];
+static UINT32 g_travel_time_version[NUM_TRANSPORT_MASKS];
+
+/* The last searches of FindStratPath(), as the moves of their paths. */
+#define STRAT_PATH_CACHE_SIZE 16
+
+struct StratPathCacheEntry
+{
+	UINT32 uiLastUse; // 0 if unused
+	UINT32 uiVersion;
+	INT16  sStart;
+	INT16  sDestination;
+	UINT8  ubTransportMask;
+	INT32  iFootEncumbrance;
+	bool   fHelicopter;
+	bool   fTacticalTraversal;
+	bool   fDirectPath;
+	UINT8  ubLength;
+	UINT8  ubMoves[MAX_PATH_LIST_SIZE];
+};
+
+static StratPathCacheEntry g_strat_path_cache[STRAT_PATH_CACHE_SIZE];
+static UINT32              g_strat_path_uses;
+static UINT32              g_strat_path_version = 1;
+
+
+void InvalidateStrategicPaths()
+{
+	++g_strat_path_version;
+}
+
+
+static INT32 const* GetTravelTimes(UINT8 const transport_mask, UINT8 const sector)
+{
+	Assert(transport_mask < NUM_TRANSPORT_MASKS);
+	if (g_travel_time_version[transport_mask] != g_strat_path_version)
+	{
+		g_travel_time_version[transport_mask] = g_strat_path_version;
+		for (UINT s = 0; s != 256; ++s)
+		{
+			for (UINT8 dir = 0; dir != 4; ++dir)
+			{
+				g_travel_time[transport_mask][s][dir] = GetSectorMvtTime(s, dir, transport_mask, 100);
+			}
+		}
+	}
+	return g_travel_time[transport_mask][sector];
+}
+
+
 static INT16 const diStratDelta[]=
 {
 	-MAP_WIDTH,        //N
@@ -177,7 +283,7 @@ static INT16 const diStratDelta[]=
 
 // this will find if a shortest strategic path
 
-INT32 FindStratPath(INT16 const sStart, INT16 const sDestination, GROUP const& g, BOOLEAN const fTacticalTraversal)
+static INT32 InternalFindStratPath(INT16 const sStart, INT16 const sDestination, GROUP const& g, BOOLEAN const fTacticalTraversal, BOOLEAN const fPlotDirectPath, bool const fHelicopter)
 {
 	INT32 iCnt,ndx,insertNdx,qNewNdx;
 	INT32 iDestX,iDestY,locX,locY,dx,dy;
@@ -185,30 +291,12 @@ INT32 FindStratPath(INT16 const sStart, INT16 const sDestination, GROUP const& g
 	UINT16	newLoc,curLoc;
 	TRAILCELLTYPE curCost,newTotCost,nextCost;
 	INT16 sOrigination;
-	BOOLEAN fPlotDirectPath = FALSE;
-	static BOOLEAN fPreviousPlotDirectPath = FALSE;		// don't save
 
 	// ******** Fudge by Bret (for now), curAPcost is never initialized in this function, but should be!
 	// so this is just to keep things happy!
 
-	// for player groups only!
-	if (g.fPlayer)
-	{
-		// if player is holding down SHIFT key, find the shortest route instead of the quickest route!
-		if ( _KeyDown( SHIFT ) )
-		{
-			fPlotDirectPath = TRUE;
-		}
-
-
-		if ( fPlotDirectPath != fPreviousPlotDirectPath )
-		{
-			// must redraw map to erase the previous path...
-			fMapPanelDirty = TRUE;
-			fPreviousPlotDirectPath = fPlotDirectPath;
-		}
-	}
-
+	UINT8 const transport_mask   = g.ubTransportationMask;
+	INT32 const foot_encumbrance = GetGroupFootEncumbrance(g);
 
 	queRequests = 2;
 
@@ -259,9 +347,6 @@ INT32 FindStratPath(INT16 const sStart, INT16 const sDestination, GROUP const& g
 	pathQB[ndx].pathNdx		= trailStratTreedxB;
 	trailStratTreedxB++;
 
-	const GROUP* const heli_group = iHelicopterVehicleId != -1 ?
-		GetGroup(GetHelicopter().ubMovementGroup) : 0;
-
 	do
 	{
 		//remove the first and best path so far from the que
@@ -307,10 +392,18 @@ INT32 FindStratPath(INT16 const sStart, INT16 const sDestination, GROUP const& g
 			}
 
 			// are we plotting path or checking for existance of one?
-			nextCost = GetSectorMvtTimeForGroup(SECTOR(curLoc % MAP_WORLD_X, curLoc / MAP_WORLD_X), iCnt / 2, &g);
+			UINT8 const ubSector = SECTOR(curLoc % MAP_WORLD_X, curLoc / MAP_WORLD_X);
+			if (foot_encumbrance == 100)
+			{
+				nextCost = GetTravelTimes(transport_mask, ubSector)[iCnt / 2];
+			}
+			else
+			{
+				nextCost = GetSectorMvtTime(ubSector, iCnt / 2, transport_mask, foot_encumbrance);
+			}
 			if (nextCost == TRAVERSE_TIME_IMPOSSIBLE) continue;
 
-			if (&g == heli_group)
+			if (fHelicopter)
 			{
 				// is a heli, its pathing is determined not by time (it's always the same) but by total cost
 				// Skyrider will avoid uncontrolled airspace as much as possible...
@@ -436,6 +529,79 @@ INT32 FindStratPath(INT16 const sStart, INT16 const sDestination, GROUP const& g
 }
 
 
+INT32 FindStratPath(INT16 const sStart, INT16 const sDestination, GROUP const& g, BOOLEAN const fTacticalTraversal)
+{
+	BOOLEAN fPlotDirectPath = FALSE;
+	static BOOLEAN fPreviousPlotDirectPath = FALSE;		// don't save
+
+	// for player groups only!
+	if (g.fPlayer)
+	{
+		// if player is holding down SHIFT key, find the shortest route instead of the quickest route!
+		if ( _KeyDown( SHIFT ) )
+		{
+			fPlotDirectPath = TRUE;
+		}
+
+
+		if ( fPlotDirectPath != fPreviousPlotDirectPath )
+		{
+			// must redraw map to erase the previous path...
+			fMapPanelDirty = TRUE;
+			fPreviousPlotDirectPath = fPlotDirectPath;
+		}
+	}
+
+	const GROUP* const heli_group = iHelicopterVehicleId != -1 ?
+		GetGroup(GetHelicopter().ubMovementGroup) : 0;
+	bool const fHelicopter = &g == heli_group;
+
+	// the sectors to avoid depend on where everybody is, so don't keep the path
+	if (gfPlotToAvoidPlayerInfuencedSectors)
+	{
+		return InternalFindStratPath(sStart, sDestination, g, fTacticalTraversal, fPlotDirectPath, fHelicopter);
+	}
+
+	UINT8 const transport_mask   = g.ubTransportationMask;
+	INT32 const foot_encumbrance = GetGroupFootEncumbrance(g);
+
+	StratPathCacheEntry* lru = g_strat_path_cache;
+	FOR_EACH(StratPathCacheEntry, e, g_strat_path_cache)
+	{
+		if (e->uiLastUse != 0                           &&
+			e->uiVersion          == g_strat_path_version &&
+			e->sStart             == sStart               &&
+			e->sDestination       == sDestination         &&
+			e->ubTransportMask    == transport_mask       &&
+			e->iFootEncumbrance   == foot_encumbrance     &&
+			e->fHelicopter        == fHelicopter          &&
+			e->fTacticalTraversal == !!fTacticalTraversal &&
+			e->fDirectPath        == !!fPlotDirectPath)
+		{
+			e->uiLastUse = ++g_strat_path_uses;
+			std::copy_n(e->ubMoves, e->ubLength, gusMapPathingData);
+			return e->ubLength;
+		}
+		if (e->uiLastUse < lru->uiLastUse) lru = e;
+	}
+
+	INT32 const length = InternalFindStratPath(sStart, sDestination, g, fTacticalTraversal, fPlotDirectPath, fHelicopter);
+
+	lru->uiLastUse          = ++g_strat_path_uses;
+	lru->uiVersion          = g_strat_path_version;
+	lru->sStart             = sStart;
+	lru->sDestination       = sDestination;
+	lru->ubTransportMask    = transport_mask;
+	lru->iFootEncumbrance   = foot_encumbrance;
+	lru->fHelicopter        = fHelicopter;
+	lru->fTacticalTraversal = fTacticalTraversal;
+	lru->fDirectPath        = fPlotDirectPath;
+	lru->ubLength           = length;
+	std::copy_n(gusMapPathingData, length, lru->ubMoves);
+	return length;
+}
+
+
 PathSt* BuildAStrategicPath(INT16 const start_sector, INT16 const end_sector, GROUP const& g, BOOLEAN const fTacticalTraversal)
 {
 	if (end_sector < MAP_WORLD_X - 1) return NULL;
@@ -444,7 +610,7 @@ PathSt* BuildAStrategicPath(INT16 const start_sector, INT16 const end_sector, GR
 	if (path_len == 0) return NULL;
 
 	// start new path list
-	PathSt* const head = MALLOC(PathSt);
+	PathSt* const head = AllocPathNode();
 	head->uiSectorId = start_sector;
 	head->pNext      = NULL;
 	head->pPrev      = NULL;
@@ -470,7 +636,7 @@ PathSt* BuildAStrategicPath(INT16 const start_sector, INT16 const end_sector, GR
 			return NULL;
 		}
 
-		PathSt* const n = MALLOC(PathSt);
+		PathSt* const n = AllocPathNode();
 		n->uiSectorId = cur_sector;
 		n->pPrev      = path;
 		n->pNext      = NULL;
@@ -541,7 +707,7 @@ PathSt* ClearStrategicPathList(PathSt* const pHeadOfPath, const INT16 sMvtGroup)
 	{
 		PathSt* const del = n;
 		n = n->pNext;
-		MemFree(del);
+		FreePathNode(del);
 	}
 
 	if (sMvtGroup != -1 && sMvtGroup != 0)
@@ -646,12 +812,12 @@ PathSt* ClearStrategicPathListAfterThisSector(PathSt* pHeadOfPath, INT16 sX, INT
 		}
 
 		// delete delete node
-		MemFree( pDeleteNode );
+		FreePathNode( pDeleteNode );
 	}
 
 
 	// clear out last node
-	MemFree( pNode );
+	FreePathNode( pNode );
 	pNode = NULL;
 	pDeleteNode = NULL;
 
@@ -704,7 +870,7 @@ static PathSt* RemoveTailFromStrategicPath(PathSt* pHeadOfList)
 	pLastNode -> pNext = NULL;
 
 	// now remove old last node
-	MemFree( pNode );
+	FreePathNode( pNode );
 
 	// return head of new list
 	return( pHeadOfList );
@@ -740,7 +906,7 @@ PathSt* RemoveHeadFromStrategicPath(PathSt* pList)
 	}
 
 	// free old head
-	MemFree( pNode );
+	FreePathNode( pNode );
 
 	pNode = NULL;
 
@@ -771,7 +937,7 @@ PathSt* CopyPaths(PathSt* src)
 {
 	if (src == NULL) return NULL;
 
-	PathSt* const head = MALLOC(PathSt);
+	PathSt* const head = AllocPathNode();
 	head->uiSectorId = src->uiSectorId;
 	head->pPrev      = NULL;
 
@@ -784,7 +950,7 @@ PathSt* CopyPaths(PathSt* src)
 			break;
 		}
 
-		PathSt* const p = MALLOC(PathSt);
+		PathSt* const p = AllocPathNode();
 		p->uiSectorId	= src->uiSectorId;
 		p->pPrev      = dst;
 
@@ -1144,6 +1310,9 @@ void ClearMercPathsAndWaypointsForAllInGroup(GROUP& g)
 
 	// clear the waypoints for this group too - no mercpath = no waypoints!
 	RemoveGroupWaypoints(g);
+
+	// the sector prefetched for the group's next move may not be entered anymore
+	CancelPrefetch();
 }
 
 
@@ -1206,7 +1375,7 @@ void AddSectorToFrontOfMercPathForAllSoldiersInGroup( GROUP *pGroup, UINT8 ubSec
 static void AddSectorToFrontOfMercPath(PathSt** ppMercPath, UINT8 ubSectorX, UINT8 ubSectorY)
 {
 	// allocate and hang a new node at the front of the path list
-	PathSt* const pNode = MALLOC(PathSt);
+	PathSt* const pNode = AllocPathNode();
 	pNode->uiSectorId = CALCULATE_STRATEGIC_INDEX( ubSectorX, ubSectorY );
 	pNode->pNext = *ppMercPath;
 	pNode->pPrev = NULL;
@@ -28,6 +28,18 @@ enum{
 
 INT32 FindStratPath(INT16 sStart, INT16 sDestination, GROUP const&, BOOLEAN fTacticalTraversal);
 
+/* FindStratPath() keeps the travel times between the sectors and the paths it
+ * found last. Call this after changing the traversability of the sectors or who
+ * controls the airspace. */
+void InvalidateStrategicPaths();
+
+/* Path nodes come from a pool. Every node of a path must be given back with
+ * FreePathNode(), e.g. by ClearStrategicPathList(). */
+PathSt* AllocPathNode();
+void    FreePathNode(PathSt*);
+// Logs the nodes in use, to find paths which are never cleared
+void    LogPathNodeUsage();
+
 // build a stategic path
 PathSt* BuildAStrategicPath(INT16 iStartSectorNum, INT16 iEndSectorNum, GROUP const&, BOOLEAN fTacticalTraversal);
 
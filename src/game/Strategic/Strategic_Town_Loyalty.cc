@@ -75,6 +75,8 @@ TOWN_LOYALTY gTownLoyalty[ NUM_TOWNS ];
 
 // Town names and locations
 TownSectorInfo g_town_sectors[40];
+TownSectorInfo g_town_sectors_by_town[40];
+UINT8          g_town_sector_begin[NUM_TOWNS + 1];
 
 
 #define BASIC_COST_FOR_CIV_MURDER	(10 * GAIN_PTS_PER_LOYALTY_PT)
@@ -696,6 +698,18 @@ void BuildListOfTownSectors()
 			++i;
 		}
 	}
+
+	// Group them by town, so a town's sectors are found without a search
+	TownSectorInfo* by_town = g_town_sectors_by_town;
+	for (INT8 town = BLANK_SECTOR; town != NUM_TOWNS; ++town)
+	{
+		g_town_sector_begin[town] = by_town - g_town_sectors_by_town;
+		FOR_EACH_TOWN_SECTOR(s)
+		{
+			if (s->town == town) *by_town++ = *s;
+		}
+	}
+	g_town_sector_begin[NUM_TOWNS] = by_town - g_town_sectors_by_town;
 }
 
 
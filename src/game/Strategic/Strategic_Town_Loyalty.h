@@ -87,11 +87,17 @@ struct TownSectorInfo
 
 extern TownSectorInfo g_town_sectors[];
 
+/* The town sectors once more, grouped by town in the same order. The sectors
+ * of a town are the ones from g_town_sectors_by_town[g_town_sector_begin[town]]
+ * up to g_town_sectors_by_town[g_town_sector_begin[town + 1]]. */
+extern TownSectorInfo g_town_sectors_by_town[];
+extern UINT8          g_town_sector_begin[];
+
 #define FOR_EACH_TOWN_SECTOR(iter) \
 	for (TownSectorInfo const* iter = g_town_sectors; iter->town != BLANK_SECTOR; ++iter)
 
 #define FOR_EACH_SECTOR_IN_TOWN(iter, town_) \
-	FOR_EACH_TOWN_SECTOR(iter) if (iter->town != (town_)) continue; else
+	for (TownSectorInfo const* iter = g_town_sectors_by_town + g_town_sector_begin[(town_)], * const iter##_end = g_town_sectors_by_town + g_town_sector_begin[(town_) + 1]; iter != iter##_end; ++iter)
 
 
 // initialize a specific town's loyalty if it hasn't already been
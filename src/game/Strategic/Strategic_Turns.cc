@@ -13,6 +13,7 @@
 #include "RT_Time_Defines.h"
 #include "Assignments.h"
 #include "JAScreens.h"
+#include "MemMan.h"
 #include "ScreenIDs.h"
 
 
@@ -37,6 +38,8 @@ void SyncStrategicTurnTimes(void)
 
 void HandleStrategicTurn(void)
 {
+	MEM_TAG_SCOPE(MEM_TAG_STRATEGIC);
+
 	UINT32	uiTime;
 	UINT32	uiCheckTime; // XXX HACK000E
 
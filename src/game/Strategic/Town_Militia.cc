@@ -56,12 +56,30 @@ static void StrategicAddMilitiaToSector(INT16 sMapX, INT16 sMapY, UINT8 ubRank,
 static void StrategicPromoteMilitiaInSector(INT16 x, INT16 y, UINT8 current_rank, UINT8 n);
 
 
+/* Forces tactical to update the militia status, only if the sector is the
+ * loaded one. Recreating the militia of the loaded sector for a change
+ * elsewhere is a waste. */
+static void TrainedMilitiaInSector(INT16 const x, INT16 const y)
+{
+	if (SECTOR(x, y) == GetWorldSector()) gfStrategicMilitiaChangesMade = TRUE;
+}
+
+
+// How many of n more militia fit into the sector
+static UINT8 MilitiaRoomInSector(INT16 const x, INT16 const y, UINT8 const n)
+{
+	UINT8 const present = CountAllMilitiaInSector(x, y);
+	if (present >= MAX_ALLOWABLE_MILITIA_PER_SECTOR) return 0;
+	return std::min<UINT8>(n, MAX_ALLOWABLE_MILITIA_PER_SECTOR - present);
+}
+
+
 void TownMilitiaTrainingCompleted( SOLDIERTYPE *pTrainer, INT16 sMapX, INT16 sMapY )
 {
 	UINT8 ubMilitiaTrained = 0;
-	BOOLEAN fFoundOne;
 	INT16 sNeighbourX, sNeighbourY;
 	UINT8 ubTownId;
+	UINT8 n;
 
 
 	// get town index
@@ -73,95 +91,72 @@ void TownMilitiaTrainingCompleted( SOLDIERTYPE *pTrainer, INT16 sMapX, INT16 sMa
 	}
 
 
-	// force tactical to update militia status
-	gfStrategicMilitiaChangesMade = TRUE;
-
 	// ok, so what do we do with all this training?  Well, in order of decreasing priority:
 	// 1) If there's room in training sector, create new GREEN militia guys there
 	// 2) If not enough room there, create new GREEN militia guys in friendly sectors of the same town
 	// 3) If not enough room anywhere in town, promote a number of GREENs in this sector into regulars
 	// 4) If not enough GREENS there to promote, promote GREENs in other sectors.
 	// 5) If all friendly sectors of this town are completely filled with REGULAR militia, then training effect is wasted
+	// Every sector gets as many of the squad as it takes at once, in the same
+	// order as placing them one by one would.
 
-	while (ubMilitiaTrained < MILITIA_TRAINING_SQUAD_SIZE)
+	// is there room for more militia in the training sector itself?
+	n = MilitiaRoomInSector(sMapX, sMapY, MILITIA_TRAINING_SQUAD_SIZE - ubMilitiaTrained);
+	if (n > 0)
 	{
-		// is there room for another militia in the training sector itself?
-		if (CountAllMilitiaInSector(sMapX, sMapY) < MAX_ALLOWABLE_MILITIA_PER_SECTOR)
+		// great! Create new GREEN militia guys in the training sector
+		StrategicAddMilitiaToSector(sMapX, sMapY, GREEN_MILITIA, n);
+		TrainedMilitiaInSector(sMapX, sMapY);
+		ubMilitiaTrained += n;
+	}
+
+	if (ubMilitiaTrained < MILITIA_TRAINING_SQUAD_SIZE && ubTownId != BLANK_SECTOR)
+	{
+		InitFriendlyTownSectorServer(ubTownId, sMapX, sMapY);
+
+		// check other eligible sectors in this town for room for more militia
+		while (ubMilitiaTrained < MILITIA_TRAINING_SQUAD_SIZE && ServeNextFriendlySectorInTown(&sNeighbourX, &sNeighbourY))
 		{
-			// great! Create a new GREEN militia guy in the training sector
-			StrategicAddMilitiaToSector(sMapX, sMapY, GREEN_MILITIA, 1);
+			n = MilitiaRoomInSector(sNeighbourX, sNeighbourY, MILITIA_TRAINING_SQUAD_SIZE - ubMilitiaTrained);
+			if (n == 0) continue;
+			// great! Create new GREEN militia guys in the neighbouring sector
+			StrategicAddMilitiaToSector(sNeighbourX, sNeighbourY, GREEN_MILITIA, n);
+			TrainedMilitiaInSector(sNeighbourX, sNeighbourY);
+			ubMilitiaTrained += n;
 		}
-		else
-		{
-			fFoundOne = FALSE;
-
-			if( ubTownId != BLANK_SECTOR )
-			{
-				InitFriendlyTownSectorServer(ubTownId, sMapX, sMapY);
+	}
 
-				// check other eligible sectors in this town for room for another militia
-				while( ServeNextFriendlySectorInTown( &sNeighbourX, &sNeighbourY ) )
-				{
-					// is there room for another militia in this neighbouring sector ?
-					if (CountAllMilitiaInSector(sNeighbourX, sNeighbourY) < MAX_ALLOWABLE_MILITIA_PER_SECTOR)
-					{
-						// great! Create a new GREEN militia guy in the neighbouring sector
-						StrategicAddMilitiaToSector(sNeighbourX, sNeighbourY, GREEN_MILITIA, 1);
+	// alrighty, then.  We'll have to *promote* guys instead.
 
-						fFoundOne = TRUE;
-						break;
-					}
-				}
-			}
+	// are there any GREEN militia men in the training sector itself?
+	n = std::min<UINT8>(MilitiaInSectorOfRank(sMapX, sMapY, GREEN_MILITIA), MILITIA_TRAINING_SQUAD_SIZE - ubMilitiaTrained);
+	if (n > 0)
+	{
+		// great! Promote GREEN militia guys in the training sector to REGULARs
+		StrategicPromoteMilitiaInSector(sMapX, sMapY, GREEN_MILITIA, n);
+		TrainedMilitiaInSector(sMapX, sMapY);
+		ubMilitiaTrained += n;
+	}
 
-			// if we still haven't been able to train anyone
-			if (!fFoundOne)
-			{
-				// alrighty, then.  We'll have to *promote* guys instead.
-
-				// are there any GREEN militia men in the training sector itself?
-				if (MilitiaInSectorOfRank(sMapX, sMapY, GREEN_MILITIA) > 0)
-				{
-					// great! Promote a GREEN militia guy in the training sector to a REGULAR
-					StrategicPromoteMilitiaInSector(sMapX, sMapY, GREEN_MILITIA, 1);
-				}
-				else
-				{
-					if( ubTownId != BLANK_SECTOR )
-					{
-						// dammit! Last chance - try to find other eligible sectors in the same town with a Green guy to be promoted
-						InitFriendlyTownSectorServer(ubTownId, sMapX, sMapY);
-
-						// check other eligible sectors in this town for room for another militia
-						while( ServeNextFriendlySectorInTown( &sNeighbourX, &sNeighbourY ) )
-						{
-							// are there any GREEN militia men in the neighbouring sector ?
-							if (MilitiaInSectorOfRank(sNeighbourX, sNeighbourY, GREEN_MILITIA) > 0)
-							{
-								// great! Promote a GREEN militia guy in the neighbouring sector to a REGULAR
-								StrategicPromoteMilitiaInSector(sNeighbourX, sNeighbourY, GREEN_MILITIA, 1);
-
-								fFoundOne = TRUE;
-								break;
-							}
-						}
-					}
+	if (ubMilitiaTrained < MILITIA_TRAINING_SQUAD_SIZE && ubTownId != BLANK_SECTOR)
+	{
+		// dammit! Last chance - try to find other eligible sectors in the same town with Green guys to be promoted
+		InitFriendlyTownSectorServer(ubTownId, sMapX, sMapY);
 
-					// if we still haven't been able to train anyone
-					if (!fFoundOne)
-					{
-						// Well, that's it.  All eligible sectors of this town are full of REGULARs or ELITEs.
-						// The training goes to waste in this situation.
-						break; // the main while loop
-					}
-				}
-			}
+		while (ubMilitiaTrained < MILITIA_TRAINING_SQUAD_SIZE && ServeNextFriendlySectorInTown(&sNeighbourX, &sNeighbourY))
+		{
+			n = std::min<UINT8>(MilitiaInSectorOfRank(sNeighbourX, sNeighbourY, GREEN_MILITIA), MILITIA_TRAINING_SQUAD_SIZE - ubMilitiaTrained);
+			if (n == 0) continue;
+			// great! Promote GREEN militia guys in the neighbouring sector to REGULARs
+			StrategicPromoteMilitiaInSector(sNeighbourX, sNeighbourY, GREEN_MILITIA, n);
+			TrainedMilitiaInSector(sNeighbourX, sNeighbourY);
+			ubMilitiaTrained += n;
 		}
-
-		// next, please!
-		ubMilitiaTrained++;
 	}
 
+	// Whatever is left goes to waste: all eligible sectors of this town are
+	// full of REGULARs or ELITEs.
+
 
 	// if anyone actually got trained
 	if (ubMilitiaTrained > 0)
@@ -2569,6 +2569,35 @@ BOOLEAN SetSoldierAnimationSurface( SOLDIERTYPE *pSoldier, UINT16 usAnimState )
 }
 
 
+// Queues the surfaces of the animations the script of the given one jumps to
+static void PreloadNextAnimationSurfaces(SOLDIERTYPE const& s, UINT16 const anim_state)
+{
+	UINT16 const* const script = gusAnimInst[anim_state];
+	for (UINT i = 0; i != MAX_FRAMES_PER_ANIM && script[i] != 999; ++i)
+	{
+		UINT16 const code = script[i];
+		UINT16       next;
+		if (599 < code && code <= 699)
+		{
+			next = code - 600;
+		}
+		else if (799 < code && code < 999)
+		{
+			next = code - 700;
+		}
+		else
+		{
+			continue;
+		}
+		if (next >= NUMANIMATIONSTATES || next == anim_state) continue;
+
+		UINT16 const surface = DetermineSoldierAnimationSurface(&s, next);
+		if (surface == INVALID_ANIMATION_SURFACE) continue;
+		PreloadAnimationSurface(s.ubID, surface, next);
+	}
+}
+
+
 UINT16 LoadSoldierAnimationSurface(SOLDIERTYPE& s, UINT16 const anim_state)
 {
 	UINT16 const anim_surface = DetermineSoldierAnimationSurface(&s, anim_state);
@@ -2577,6 +2606,7 @@ UINT16 LoadSoldierAnimationSurface(SOLDIERTYPE& s, UINT16 const anim_state)
 	{
 		// Ensure that it's been loaded
 		GetCachedAnimationSurface(s.ubID, &s.AnimCache, anim_surface, s.usAnimState);
+		PreloadNextAnimationSurfaces(s, anim_state);
 		return anim_surface;
 	}
 	catch (...)
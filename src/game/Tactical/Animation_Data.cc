@@ -12,11 +12,14 @@
 #include "WorldDef.h"
 #include "FileMan.h"
 #include "MemMan.h"
+#include "Profiler.h"
 
 #include "ContentManager.h"
 #include "GameInstance.h"
 #include "Logger.h"
 
+#include <SDL.h>
+
 #include <algorithm>
 #include <iterator>
 #include <stdexcept>
@@ -29,6 +32,10 @@
 #define PATH_STRUCT					ANIMSDIR "/STRUCTDATA/"
 #define SUFFIX						".JSD"
 
+#define ANIM_SURFACE_RETAIN_BYTES (16 * 1024 * 1024) // pixel data kept of surfaces no soldier uses
+#define ANIM_PRELOAD_QUEUE        32
+#define ANIM_PRELOADS_PER_FRAME   1
+
 
 
 ANIM_PROF *gpAnimProfiles = NULL;
@@ -37,6 +44,24 @@ static UINT8 gubNumAnimProfiles = 0;
 INT8 gbAnimUsageHistory[ NUMANIMATIONSURFACETYPES ][ MAX_NUM_SOLDIERS ];
 
 
+/* Surfaces whose usage count dropped to zero keep their video object, so the
+ * next soldier of the same body type does not load it again. They are evicted
+ * least recently released first once their pixel data exceeds the budget. */
+static UINT32 g_anim_released[NUMANIMATIONSURFACETYPES]; // stamp of the release, for the eviction order
+static UINT32 g_anim_release_clock;
+static UINT32 g_anim_retained_bytes;
+
+struct AnimSurfacePreload
+{
+	UINT16 soldier;
+	UINT16 surface;
+	UINT16 anim_state;
+};
+
+static AnimSurfacePreload g_anim_preloads[ANIM_PRELOAD_QUEUE];
+static UINT32             g_anim_n_preloads;
+
+
 #define M(name, file, type, flags, dir, profile)	{ name, file, type, flags, dir, TO_INIT, NULL, 0, profile }
 
 AnimationSurfaceType gAnimSurfaceDatabase[NUMANIMATIONSURFACETYPES] =
@@ -574,6 +599,8 @@ void DeInitAnimationSystem()
 		DeleteVideoObject(vo);
 		vo = 0;
 	}
+	g_anim_retained_bytes = 0;
+	g_anim_n_preloads     = 0;
 
 	// Delete all animation structures
 	// ATE: Don't delete here, will be deleted when the structure database is destoryed
@@ -635,74 +662,129 @@ STRUCTURE_FILE_REF* GetAnimationStructureRef(const SOLDIERTYPE* const s, const U
 }
 
 
-// Surface mamagement functions
-void LoadAnimationSurface(UINT16 const usSoldierID, UINT16 const usSurfaceIndex, UINT16 const usAnimState)
+static bool IsRetained(AnimationSurfaceType const& a)
 {
-	if (usSurfaceIndex >= NUMANIMATIONSURFACETYPES)
-	{
-		throw std::logic_error("Invalid surface index");
-	}
+	return a.hVideoObject && a.bUsageCount == 0;
+}
 
-	AnimationSurfaceType* const a = &gAnimSurfaceDatabase[usSurfaceIndex];
 
-	// Check if surface is loaded
-	if (a->hVideoObject != NULL)
+static void EvictRetainedSurfaces()
+{
+	while (g_anim_retained_bytes > ANIM_SURFACE_RETAIN_BYTES)
 	{
-		// just increment usage counter ( below )
-		SLOGD("Surface Database: Hit %d", usSurfaceIndex);
+		AnimationSurfaceType* oldest = 0;
+		for (UINT16 i = 0; i != NUMANIMATIONSURFACETYPES; ++i)
+		{
+			AnimationSurfaceType& a = gAnimSurfaceDatabase[i];
+			if (!IsRetained(a)) continue;
+			if (oldest && g_anim_released[i] >= g_anim_released[oldest - gAnimSurfaceDatabase]) continue;
+			oldest = &a;
+		}
+		if (!oldest) break;
+
+		SLOGD("Surface Database: Unloading Surface: %d", (int)(oldest - gAnimSurfaceDatabase));
+		g_anim_retained_bytes -= oldest->hVideoObject->PixDataSize();
+		DeleteVideoObject(oldest->hVideoObject);
+		oldest->hVideoObject = NULL;
 	}
-	else
+}
+
+
+// Hands a surface no soldier uses any more to the retained surfaces
+static void RetainSurface(UINT16 const usSurfaceIndex)
+{
+	g_anim_released[usSurfaceIndex] = ++g_anim_release_clock;
+	g_anim_retained_bytes += gAnimSurfaceDatabase[usSurfaceIndex].hVideoObject->PixDataSize();
+	EvictRetainedSurfaces();
+}
+
+
+static void LoadSurfaceObject(UINT16 const usSoldierID, UINT16 const usSurfaceIndex, UINT16 const usAnimState)
+{
+	AnimationSurfaceType* const a = &gAnimSurfaceDatabase[usSurfaceIndex];
+	try
 	{
-		try
+		// Load into memory
+		SLOGD("Surface Database: Loading %d", usSurfaceIndex);
+
+		AutoSGPImage   hImage(CreateImage(a->Filename, IMAGE_ALLDATA));
+		AutoSGPVObject hVObject(AddVideoObjectFromHImage(hImage));
+
+		// Get aux data
+		if (hImage->uiAppDataSize != hVObject->SubregionCount() * sizeof(AuxObjectData))
 		{
-			// Load into memory
-			SLOGD("Surface Database: Loading %d", usSurfaceIndex);
+			throw std::runtime_error("Invalid # of animations given");
+		}
 
-			AutoSGPImage   hImage(CreateImage(a->Filename, IMAGE_ALLDATA));
-			AutoSGPVObject hVObject(AddVideoObjectFromHImage(hImage));
+		// Valid auxiliary data, so get # of frames from data
+		AuxObjectData const* const pAuxData = (AuxObjectData const*)(UINT8 const*)hImage->pAppData;
+		a->uiNumFramesPerDir = pAuxData->ubNumberOfFrames;
 
-			// Get aux data
-			if (hImage->uiAppDataSize != hVObject->SubregionCount() * sizeof(AuxObjectData))
+		// get structure data if any
+		const STRUCTURE_FILE_REF* const pStructureFileRef = InternalGetAnimationStructureRef(ID2SOLDIER(usSoldierID), usSurfaceIndex, usAnimState, TRUE);
+		if (pStructureFileRef != NULL)
+		{
+			INT16 sStartFrame = 0;
+			if (usSurfaceIndex == RGMPRONE)
 			{
-				throw std::runtime_error("Invalid # of animations given");
+				sStartFrame = 5;
 			}
-
-			// Valid auxiliary data, so get # of frames from data
-			AuxObjectData const* const pAuxData = (AuxObjectData const*)(UINT8 const*)hImage->pAppData;
-			a->uiNumFramesPerDir = pAuxData->ubNumberOfFrames;
-
-			// get structure data if any
-			const STRUCTURE_FILE_REF* const pStructureFileRef = InternalGetAnimationStructureRef(ID2SOLDIER(usSoldierID), usSurfaceIndex, usAnimState, TRUE);
-			if (pStructureFileRef != NULL)
+			else if (usSurfaceIndex >= QUEENMONSTERSTANDING && usSurfaceIndex <= QUEENMONSTERSWIPE)
 			{
-				INT16 sStartFrame = 0;
-				if (usSurfaceIndex == RGMPRONE)
-				{
-					sStartFrame = 5;
-				}
-				else if (usSurfaceIndex >= QUEENMONSTERSTANDING && usSurfaceIndex <= QUEENMONSTERSWIPE)
-				{
-					sStartFrame = -1;
-				}
-
-				AddZStripInfoToVObject(hVObject, pStructureFileRef, TRUE, sStartFrame);
+				sStartFrame = -1;
 			}
 
-			// Set video object index
-			a->hVideoObject = hVObject.Release();
+			AddZStripInfoToVObject(hVObject, pStructureFileRef, TRUE, sStartFrame);
+		}
 
-			// Determine if we have a problem with #frames + directions ( ie mismatch )
-			if (a->uiNumDirections * a->uiNumFramesPerDir != a->hVideoObject->SubregionCount())
-			{
-				SLOGW("Surface Database: Surface %d has #frames mismatch.", usSurfaceIndex);
-			}
+		// Set video object index
+		a->hVideoObject = hVObject.Release();
+
+		// Determine if we have a problem with #frames + directions ( ie mismatch )
+		if (a->uiNumDirections * a->uiNumFramesPerDir != a->hVideoObject->SubregionCount())
+		{
+			SLOGW("Surface Database: Surface %d has #frames mismatch.", usSurfaceIndex);
 		}
-		catch (...)
+	}
+	catch (...)
+	{
+		SLOGE("Could not load animation file: %s", a->Filename);
+		throw;
+	}
+}
+
+
+// Surface mamagement functions
+void LoadAnimationSurface(UINT16 const usSoldierID, UINT16 const usSurfaceIndex, UINT16 const usAnimState)
+{
+	if (usSurfaceIndex >= NUMANIMATIONSURFACETYPES)
+	{
+		throw std::logic_error("Invalid surface index");
+	}
+
+	AnimationSurfaceType* const a = &gAnimSurfaceDatabase[usSurfaceIndex];
+
+	// Check if surface is loaded
+	if (a->hVideoObject != NULL)
+	{
+		// just increment usage counter ( below )
+		SLOGD("Surface Database: Hit %d", usSurfaceIndex);
+		if (IsRetained(*a))
 		{
-			SLOGE("Could not load animation file: %s", a->Filename);
-			throw;
+			g_anim_retained_bytes -= a->hVideoObject->PixDataSize();
+			ProfilerCount(PROFILE_ANIM_SURFACE_REUSES, 1);
 		}
 	}
+	else
+	{
+		// The soldier waits for the load, so it is a stall of the game loop
+		uint64_t const start = SDL_GetPerformanceCounter();
+		LoadSurfaceObject(usSoldierID, usSurfaceIndex, usAnimState);
+		UINT32 const us = (UINT32)((SDL_GetPerformanceCounter() - start) * 1000000 / SDL_GetPerformanceFrequency());
+		ProfilerCount(PROFILE_ANIM_SURFACE_LOADS,    1);
+		ProfilerCount(PROFILE_ANIM_SURFACE_STALL_US, us);
+		SLOGD("Surface Database: Loading %d stalled for %u us", usSurfaceIndex, us);
+	}
 
 	// Increment usage count only if history for soldier is not yet set
 	if (gbAnimUsageHistory[usSurfaceIndex][usSoldierID] == 0)
@@ -739,14 +821,53 @@ void UnLoadAnimationSurface(const UINT16 usSoldierID, const UINT16 usSurfaceInde
 	Assert(*use_count >= 0);
 	if (*use_count < 0) *use_count = 0;
 
-	// Delete if count reched zero
+	// Retain if count reched zero, it is deleted when the budget runs out
 	if (*use_count == 0)
 	{
-		SLOGD("Surface Database: Unloading Surface: %d", usSurfaceIndex);
-		SGPVObject** const vo = &a->hVideoObject;
-		CHECKV(*vo != NULL);
-		DeleteVideoObject(*vo);
-		*vo = NULL;
+		CHECKV(a->hVideoObject != NULL);
+		RetainSurface(usSurfaceIndex);
+	}
+}
+
+
+void PreloadAnimationSurface(UINT16 const usSoldierID, UINT16 const usSurfaceIndex, UINT16 const usAnimState)
+{
+	if (usSurfaceIndex >= NUMANIMATIONSURFACETYPES) return;
+	if (gAnimSurfaceDatabase[usSurfaceIndex].hVideoObject) return;
+	for (UINT32 i = 0; i != g_anim_n_preloads; ++i)
+	{
+		if (g_anim_preloads[i].surface == usSurfaceIndex) return;
+	}
+	if (g_anim_n_preloads == ANIM_PRELOAD_QUEUE) return;
+
+	AnimSurfacePreload& p = g_anim_preloads[g_anim_n_preloads++];
+	p.soldier    = usSoldierID;
+	p.surface    = usSurfaceIndex;
+	p.anim_state = usAnimState;
+}
+
+
+void HandleAnimationSurfacePreloads()
+{
+	for (UINT n = 0; n != ANIM_PRELOADS_PER_FRAME && g_anim_n_preloads != 0; ++n)
+	{
+		AnimSurfacePreload const p = g_anim_preloads[0];
+		std::copy(g_anim_preloads + 1, g_anim_preloads + g_anim_n_preloads, g_anim_preloads);
+		--g_anim_n_preloads;
+
+		// The structure data of the surface depends on the body type of the soldier
+		if (gAnimSurfaceDatabase[p.surface].hVideoObject) continue;
+		if (!ID2SOLDIER(p.soldier)->bActive) continue;
+		try
+		{
+			LoadSurfaceObject(p.soldier, p.surface, p.anim_state);
+		}
+		catch (...)
+		{
+			// A missing surface is reported again when a soldier needs it
+			continue;
+		}
+		RetainSurface(p.surface);
 	}
 }
 
@@ -832,6 +953,9 @@ void ZeroAnimSurfaceCounts( )
 
 	for ( cnt = 0; cnt < NUMANIMATIONSURFACETYPES; cnt++ )
 	{
+		// Only the retained surfaces are not owned by any soldier any more
+		AnimationSurfaceType& a = gAnimSurfaceDatabase[cnt];
+		if (IsRetained(a)) DeleteVideoObject(a.hVideoObject);
 		gAnimSurfaceDatabase[ cnt ].bUsageCount   = 0;
 		gAnimSurfaceDatabase[ cnt ].hVideoObject  = NULL;
 	}
@@ -840,4 +964,6 @@ void ZeroAnimSurfaceCounts( )
 	{
 		std::fill(std::begin(i), std::end(i), 0);
 	}
+	g_anim_retained_bytes = 0;
+	g_anim_n_preloads     = 0;
 }
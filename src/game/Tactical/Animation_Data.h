@@ -536,6 +536,14 @@ void LoadAnimationSurface(UINT16 usSoldierID, UINT16 usSurfaceIndex, UINT16 usAn
 void UnLoadAnimationSurface(UINT16 usSoldierID, UINT16 usSurfaceIndex);
 void ClearAnimationSurfacesUsageHistory( UINT16 usSoldierID );
 
+/* Queues a surface the soldier is likely to need soon, e.g. the animation its
+ * current one jumps to. HandleAnimationSurfacePreloads() loads a few queued
+ * surfaces per frame, which are then kept like released surfaces, so the jump
+ * does not wait for the load. Resource loading is not thread safe, so this runs
+ * in the game loop instead of a loader thread. */
+void PreloadAnimationSurface(UINT16 usSoldierID, UINT16 usSurfaceIndex, UINT16 usAnimState);
+void HandleAnimationSurfacePreloads();
+
 
 STRUCTURE_FILE_REF* GetAnimationStructureRef(const SOLDIERTYPE* s, UINT16 usSurfaceIndex, UINT16 usAnimState);
 
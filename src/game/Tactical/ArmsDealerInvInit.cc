@@ -477,7 +477,23 @@ int CompareItemsForSorting(UINT16 const item_index1, UINT16 const item_index2, U
 }
 
 
+static UINT8 FindDealerItemCategoryNumber(UINT16 usItemIndex);
+
+
+/* Sorting compares the categories of two items for every comparison, so the
+ * categories are looked up in the table only once per item. */
 static UINT8 GetDealerItemCategoryNumber(UINT16 const usItemIndex)
+{
+	static UINT8 category_plus_one[MAXITEMS];
+	if (usItemIndex >= MAXITEMS) return FindDealerItemCategoryNumber(usItemIndex);
+
+	UINT8& cached = category_plus_one[usItemIndex];
+	if (cached == 0) cached = FindDealerItemCategoryNumber(usItemIndex) + 1;
+	return cached - 1;
+}
+
+
+static UINT8 FindDealerItemCategoryNumber(UINT16 const usItemIndex)
 {
 	UINT32 const item_class = GCM->getItem(usItemIndex)->getItemClass();
 
@@ -7,6 +7,7 @@
 #include "Faces.h"
 #include "Overhead.h"
 #include "Soldier_Profile.h"
+#include "Timer_Control.h"
 #include "Bullets.h"
 #include "LOS.h"
 #include "WorldMan.h"
@@ -186,119 +187,119 @@ void LocateBullet(BULLET* b)
 }
 
 
+static bool UsesBulletTiles(BULLET const* const b)
+{
+	return !(b->usFlags & (BULLET_FLAG_CREATURE_SPIT | BULLET_FLAG_KNIFE | BULLET_FLAG_MISSILE | BULLET_FLAG_SMALL_MISSILE | BULLET_FLAG_TANK_CANNON | BULLET_FLAG_FLAME));
+}
+
+
+static void DisplayBullet(BULLET* const b)
+{
+	if (b->usFlags & BULLET_FLAG_KNIFE)
+	{
+		if ( b->pAniTile != NULL )
+		{
+			b->pAniTile->sRelativeX	= FIXEDPT_TO_INT32(b->qCurrX);
+			b->pAniTile->sRelativeY	= FIXEDPT_TO_INT32(b->qCurrY);
+			b->pAniTile->pLevelNode->sRelativeZ = CONVERT_HEIGHTUNITS_TO_PIXELS(FIXEDPT_TO_INT32(b->qCurrZ));
+
+			// it seems some sectors deliver wrong depth informationen(Z)
+			// As there only a fixed amount of ways to throw a knife we can
+			// correct the relativeZ value
+			if(b->pAniTile->pLevelNode->sRelativeZ > 160)
+			{
+				b->pAniTile->pLevelNode->sRelativeZ -= 115;
+			}
+			else if(b->pAniTile->pLevelNode->sRelativeZ > 90)
+			{
+				b->pAniTile->pLevelNode->sRelativeZ -= 70;
+			}
+
+			b->pShadowAniTile->sRelativeX	= FIXEDPT_TO_INT32(b->qCurrX);
+			b->pShadowAniTile->sRelativeY	= FIXEDPT_TO_INT32(b->qCurrY);
+		}
+	}
+	// Are we a missle?
+	else if (UsesBulletTiles(b))
+	{
+		LEVELNODE* pNode = AddStructToTail(b->sGridNo, BULLETTILE1);
+		pNode->ubShadeLevel=DEFAULT_SHADE_LEVEL;
+		pNode->ubNaturalShadeLevel=DEFAULT_SHADE_LEVEL;
+		pNode->uiFlags |= ( LEVELNODE_USEABSOLUTEPOS | LEVELNODE_IGNOREHEIGHT );
+		pNode->sRelativeX = FIXEDPT_TO_INT32(b->qCurrX);
+		pNode->sRelativeY = FIXEDPT_TO_INT32(b->qCurrY);
+		pNode->sRelativeZ = CONVERT_HEIGHTUNITS_TO_PIXELS(FIXEDPT_TO_INT32(b->qCurrZ));
+
+		// Display shadow
+		pNode = AddStructToTail(b->sGridNo, BULLETTILE2);
+		pNode->ubShadeLevel=DEFAULT_SHADE_LEVEL;
+		pNode->ubNaturalShadeLevel=DEFAULT_SHADE_LEVEL;
+		pNode->uiFlags |= ( LEVELNODE_USEABSOLUTEPOS | LEVELNODE_IGNOREHEIGHT );
+		pNode->sRelativeX = FIXEDPT_TO_INT32(b->qCurrX);
+		pNode->sRelativeY = FIXEDPT_TO_INT32(b->qCurrY);
+		pNode->sRelativeZ = gpWorldLevelData[b->sGridNo].sHeight;
+	}
+	b->fShown = TRUE;
+}
+
+
+/* The bullets are stepped in two passes: the first one frees the deleted
+ * bullets and gathers the ones due to move this frame into a compact array,
+ * the second one moves and redraws them. A bullet which is shown and not due
+ * keeps its tiles, instead of taking them out of the world and putting them
+ * back at the same position. */
 void UpdateBullets(void)
 {
-	UINT32    uiCount;
-	LEVELNODE *pNode;
-	BOOLEAN   fDeletedSome = FALSE;
+	UINT32  const now          = GetJA2Clock();
+	BULLET*       due[NUM_BULLET_SLOTS];
+	UINT          n_due        = 0;
+	BOOLEAN       fDeletedSome = FALSE;
 
-	for ( uiCount = 0; uiCount < guiNumBullets; uiCount++ )
+	for ( UINT32 uiCount = 0; uiCount < guiNumBullets; uiCount++ )
 	{
 		BULLET* const b = &gBullets[uiCount];
-		if (b->fAllocated)
+		if (!b->fAllocated) continue;
+
+		// there are duplicate checks for deletion in case the bullet is deleted by shooting
+		// someone at point blank range, in the first MoveBullet call in the FireGun code
+		if (b->fToDelete)
 		{
-			if (b->fReal && !(b->usFlags & BULLET_STOPPED))
-			{
-				// there are duplicate checks for deletion in case the bullet is deleted by shooting
-				// someone at point blank range, in the first MoveBullet call in the FireGun code
-				if (b->fToDelete)
-				{
-					// Remove from old position
-					b->fAllocated = FALSE;
-					fDeletedSome = TRUE;
-					continue;
-				}
+			b->fAllocated = FALSE;
+			fDeletedSome = TRUE;
+			continue;
+		}
 
-				//if ( !( gGameSettings.fOptions[ TOPTION_HIDE_BULLETS ] ) )
-				{
-					// ALRIGHTY, CHECK WHAT TYPE OF BULLET WE ARE
-
-					if (b->usFlags & (BULLET_FLAG_CREATURE_SPIT | BULLET_FLAG_KNIFE | BULLET_FLAG_MISSILE | BULLET_FLAG_SMALL_MISSILE | BULLET_FLAG_TANK_CANNON | BULLET_FLAG_FLAME))
-					{
-					}
-					else
-					{
-						RemoveStruct(b->sGridNo, BULLETTILE1);
-						RemoveStruct(b->sGridNo, BULLETTILE2);
-					}
-				}
+		if (!b->fReal || b->usFlags & BULLET_STOPPED) continue;
+		// the same test as in MoveBullet()
+		if (b->fShown && now - b->uiLastUpdate < b->usClockTicksPerUpdate) continue;
+		due[n_due++] = b;
+	}
 
-				MoveBullet(b);
-				if (b->fToDelete)
-				{
-					// Remove from old position
-					b->fAllocated = FALSE;
-					fDeletedSome = TRUE;
-					continue;
-				}
+	for (UINT i = 0; i != n_due; ++i)
+	{
+		BULLET* const b = due[i];
+		// a hit of an earlier bullet may have stopped or deleted this one
+		if (!b->fAllocated || b->usFlags & BULLET_STOPPED) continue;
 
-				if (b->usFlags & BULLET_STOPPED) continue;
+		if (UsesBulletTiles(b))
+		{
+			// Remove from old position
+			RemoveStruct(b->sGridNo, BULLETTILE1);
+			RemoveStruct(b->sGridNo, BULLETTILE2);
+		}
+		b->fShown = FALSE;
 
-				// Display bullet
-				//if ( !( gGameSettings.fOptions[ TOPTION_HIDE_BULLETS ] ) )
-				{
-					if (b->usFlags & BULLET_FLAG_KNIFE)
-					{
-						if ( b->pAniTile != NULL )
-						{
-							b->pAniTile->sRelativeX	= FIXEDPT_TO_INT32(b->qCurrX);
-							b->pAniTile->sRelativeY	= FIXEDPT_TO_INT32(b->qCurrY);
-							b->pAniTile->pLevelNode->sRelativeZ = CONVERT_HEIGHTUNITS_TO_PIXELS(FIXEDPT_TO_INT32(b->qCurrZ));
-
-							// it seems some sectors deliver wrong depth informationen(Z)
-							// As there only a fixed amount of ways to throw a knife we can
-							// correct the relativeZ value
-							if(b->pAniTile->pLevelNode->sRelativeZ > 160)
-							{
-								b->pAniTile->pLevelNode->sRelativeZ -= 115;
-							}
-							else if(b->pAniTile->pLevelNode->sRelativeZ > 90)
-							{
-								b->pAniTile->pLevelNode->sRelativeZ -= 70;
-							}
-
-							if (b->usFlags & BULLET_FLAG_KNIFE)
-							{
-								b->pShadowAniTile->sRelativeX	= FIXEDPT_TO_INT32(b->qCurrX);
-								b->pShadowAniTile->sRelativeY	= FIXEDPT_TO_INT32(b->qCurrY);
-							}
-						}
-					}
-					// Are we a missle?
-					else if (b->usFlags & (BULLET_FLAG_MISSILE | BULLET_FLAG_SMALL_MISSILE |
-						BULLET_FLAG_TANK_CANNON | BULLET_FLAG_FLAME | BULLET_FLAG_CREATURE_SPIT))
-					{
-					}
-					else
-					{
-						pNode = AddStructToTail(b->sGridNo, BULLETTILE1);
-						pNode->ubShadeLevel=DEFAULT_SHADE_LEVEL;
-						pNode->ubNaturalShadeLevel=DEFAULT_SHADE_LEVEL;
-						pNode->uiFlags |= ( LEVELNODE_USEABSOLUTEPOS | LEVELNODE_IGNOREHEIGHT );
-						pNode->sRelativeX = FIXEDPT_TO_INT32(b->qCurrX);
-						pNode->sRelativeY = FIXEDPT_TO_INT32(b->qCurrY);
-						pNode->sRelativeZ = CONVERT_HEIGHTUNITS_TO_PIXELS(FIXEDPT_TO_INT32(b->qCurrZ));
-
-						// Display shadow
-						pNode = AddStructToTail(b->sGridNo, BULLETTILE2);
-						pNode->ubShadeLevel=DEFAULT_SHADE_LEVEL;
-						pNode->ubNaturalShadeLevel=DEFAULT_SHADE_LEVEL;
-						pNode->uiFlags |= ( LEVELNODE_USEABSOLUTEPOS | LEVELNODE_IGNOREHEIGHT );
-						pNode->sRelativeX = FIXEDPT_TO_INT32(b->qCurrX);
-						pNode->sRelativeY = FIXEDPT_TO_INT32(b->qCurrY);
-						pNode->sRelativeZ = gpWorldLevelData[b->sGridNo].sHeight;
-					}
-				}
-			}
-			else
-			{
-				if (b->fToDelete)
-				{
-					b->fAllocated = FALSE;
-					fDeletedSome = TRUE;
-				}
-			}
+		MoveBullet(b);
+		if (b->fToDelete)
+		{
+			b->fAllocated = FALSE;
+			fDeletedSome = TRUE;
+			continue;
 		}
+
+		if (b->usFlags & BULLET_STOPPED) continue;
+
+		DisplayBullet(b);
 	}
 
 	if ( fDeletedSome )
@@ -425,6 +426,7 @@ void LoadBulletStructureFromSavedGameFile(HWFILE const hFile)
 void StopBullet(BULLET* b)
 {
 	b->usFlags |= BULLET_STOPPED;
+	b->fShown   = FALSE;
 
 	RemoveStruct(b->sGridNo, BULLETTILE1);
 	RemoveStruct(b->sGridNo, BULLETTILE2);
@@ -57,6 +57,7 @@ struct BULLET
 	ANITILE *pAniTile;
 	ANITILE *pShadowAniTile;
 	UINT8   ubItemStatus;
+	BOOLEAN fShown; // the bullet tiles show the current position, not saved
 };
 
 extern UINT32 guiNumBullets;
@@ -0,0 +1,169 @@
+#include "Combat_Benchmark.h"
+#include "AITiming.h"
+#include "Benchmark_Suite.h"
+#include "Campaign_Types.h"
+#include "Dialogue_Control.h"
+#include "GameSettings.h"
+#include "Isometric_Utils.h"
+#include "Logger.h"
+#include "Map_Information.h"
+#include "OppList.h"
+#include "Overhead.h"
+#include "Profiler.h"
+#include "Random.h"
+#include "SaveLoadGame.h"
+#include "Soldier_Add.h"
+#include "Soldier_Control.h"
+#include "Soldier_Create.h"
+#include "SoundMan.h"
+#include "Sound_Control.h"
+#include "Strategic.h"
+#include "StrategicMap.h"
+#include "Timer.h"
+#include "Timer_Control.h"
+#include "WorldMan.h"
+
+#include <SDL.h>
+
+#include <stdexcept>
+
+
+// Every run places the soldiers and rolls the dice alike
+#define BENCH_SEED 1
+
+
+// A free tile to stand on in the west or east half of the map, or NOWHERE
+static GridNo PickTile(bool const west)
+{
+	for (UINT tries = 0; tries != 1024; ++tries)
+	{
+		INT16  const x = Random(WORLD_COLS / 2) + (west ? 0 : WORLD_COLS / 2);
+		INT16  const y = Random(WORLD_ROWS);
+		GridNo const g = y * WORLD_COLS + x;
+		if (!GridNoOnVisibleWorldTile(g))   continue;
+		if (!IsLocationSittable(g, FALSE))  continue;
+		if (WhoIsThere2(g, 0))              continue;
+		return g;
+	}
+	return NOWHERE;
+}
+
+
+static bool PlaceSoldier(SOLDIERTYPE* const s, bool const west)
+{
+	if (!s) return false;
+	GridNo const g = PickTile(west);
+	if (g == NOWHERE)
+	{
+		TacticalRemoveSoldier(*s);
+		return false;
+	}
+	s->ubStrategicInsertionCode = INSERTION_CODE_GRIDNO;
+	s->usStrategicInsertionData = g;
+	UpdateMercInSector(*s, gWorldSectorX, gWorldSectorY, gbWorldSectorZ);
+	return true;
+}
+
+
+static UINT CountCapable(UINT8 const team)
+{
+	UINT n = 0;
+	CFOR_EACH_IN_TEAM(s, team)
+	{
+		if (s->bInSector && s->bLife >= OKLIFE) ++n;
+	}
+	return n;
+}
+
+
+void BenchmarkTacticalCombat(UINT8 const save_slot, UINT8 const soldiers_per_side, UINT32 const max_rounds)
+{
+	// Loading a game saves the current one first in dead is dead mode
+	gGameOptions.ubGameSaveMode = DIF_CAN_SAVE;
+	try
+	{
+		LoadSavedGame(save_slot);
+	}
+	catch (std::exception const& e)
+	{
+		SLOGW("Combat benchmark: failed to load save game %u: %s", save_slot, e.what());
+		return;
+	}
+	if (!gfWorldLoaded || gbWorldSectorZ != 0)
+	{
+		SLOGW("Combat benchmark: save game %u is not in a sector on the surface", save_slot);
+		return;
+	}
+
+	SeedRandom(BENCH_SEED);
+
+	// The strategic counters have to know the soldiers, so they are not broken when they die
+	SECTORINFO& sector = SectorInfo[SECTOR(gWorldSectorX, gWorldSectorY)];
+	UINT enemies = 0;
+	UINT militia = 0;
+	for (UINT i = 0; i != soldiers_per_side; ++i)
+	{
+		if (PlaceSoldier(TacticalCreateEnemySoldier(SOLDIER_CLASS_ARMY), true))
+		{
+			++sector.ubNumTroops;
+			++sector.ubTroopsInBattle;
+			++enemies;
+		}
+		if (PlaceSoldier(TacticalCreateMilitia(SOLDIER_CLASS_REG_MILITIA), false))
+		{
+			++sector.ubNumberOfCivsAtLevel[REGULAR_MILITIA];
+			++militia;
+		}
+	}
+	AllTeamsLookForAll(NO_INTERRUPTS);
+
+	UINT32 const sound_volume  = GetSoundEffectsVolume();
+	UINT32 const speech_volume = GetSpeechVolume();
+	SetSoundEffectsVolume(0);
+	SetSpeechVolume(0);
+
+	ResetAITimers();
+	ResetProfilerTotals();
+	SetJA2ClockFixed(true);
+
+	UINT32 const max_steps = max_rounds * 60 * 1000 / BASETIMESLICE;
+	UINT32         steps   = 0;
+	UINT32         rounds  = 0;
+	bool           our_turn = false;
+	uint64_t const start   = SDL_GetPerformanceCounter();
+	while (steps != max_steps && rounds != max_rounds)
+	{
+		if (CountCapable(ENEMY_TEAM) == 0 || CountCapable(MILITIA_TEAM) == 0) break;
+
+		ProfilerBeginFrame();
+		AdvanceFixedClock(BASETIMESLICE);
+		UpdateFixedJA2Clock();
+		ExecuteOverhead();
+		HandleDialogue();
+		ProfilerEndFrame();
+		++steps;
+
+		// The player's team sits the battle out
+		bool const turn_based = (gTacticalStatus.uiFlags & INCOMBAT) != 0;
+		bool const now_ours   = turn_based && gTacticalStatus.ubCurrentTeam == OUR_TEAM;
+		if (now_ours && !our_turn) ++rounds;
+		our_turn = now_ours;
+		if (now_ours && gTacticalStatus.ubAttackBusyCount == 0) EndTurn(OUR_TEAM + 1);
+	}
+	uint64_t const ticks = SDL_GetPerformanceCounter() - start;
+
+	SetJA2ClockFixed(false);
+	SoundStopAll();
+	SetSoundEffectsVolume(sound_volume);
+	SetSpeechVolume(speech_volume);
+
+	double const ms       = TicksToMS(ticks);
+	double const game_sec = steps * BASETIMESLICE / 1000.0;
+	SLOGI("Combat benchmark, save game %u: %u enemies against %u militia, %u left against %u",
+		save_slot, enemies, militia, CountCapable(ENEMY_TEAM), CountCapable(MILITIA_TEAM));
+	SLOGI("  %u rounds and %.1f s of game time in %.1f ms, %.2f rounds per second, %.1f game seconds per second",
+		rounds, game_sec, ms, ms > 0 ? rounds * 1000 / ms : 0, ms > 0 ? game_sec * 1000 / ms : 0);
+	if (game_sec > 0) RecordBenchmarkResult("combat.ms_per_game_second", ms / game_sec);
+	LogProfilerTotals();
+	LogAITimers();
+}
@@ -0,0 +1,19 @@
+#ifndef COMBAT_BENCHMARK_H
+#define COMBAT_BENCHMARK_H
+
+#include "Types.h"
+
+
+/* Loads the given save game, which has to be in a loaded sector on the
+ * surface, and adds soldiers_per_side enemies in the west half of the map and
+ * as many militia in the east half. Then both sides are left to the AI: the
+ * overhead runs as fast as it can on a fixed clock, without rendering and with
+ * the sound muted, and the turns of the player's team are ended right away.
+ * The run stops when one side has nobody able to fight, after max_rounds
+ * rounds of turn based combat or after the game time of as many minutes.
+ * The rounds, the game time and the time spent in the overhead and in the
+ * parts of the AI are logged. The game is left in the state the battle
+ * reached, so this is only to be run from the main menu. */
+void BenchmarkTacticalCombat(UINT8 save_slot, UINT8 soldiers_per_side, UINT32 max_rounds);
+
+#endif
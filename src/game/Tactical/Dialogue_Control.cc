@@ -1,4 +1,6 @@
-#include <queue>
+#include <algorithm>
+#include <deque>
+#include <string>
 
 #include "Directories.h"
 #include "Font.h"
@@ -35,6 +37,7 @@
 #include "Cursors.h"
 #include "GameScreen.h"
 #include "Random.h"
+#include "Prefetch.h"
 #include "GameSettings.h"
 #include "ShopKeeper_Interface.h"
 #include "Map_Screen_Interface.h"
@@ -62,9 +65,10 @@
 
 #define DIALOGUE_DEFAULT_SUBTITLE_WIDTH	200
 #define TEXT_DELAY_MODIFIER			60
+#define DIALOGUE_PREFETCH_QUOTES	4 // queued events which read their files ahead
 
 
-typedef std::queue<DialogueEvent*>DialogueQueue;
+typedef std::deque<DialogueEvent*> DialogueQueue;
 
 BOOLEAN fExternFacesLoaded = FALSE;
 
@@ -201,7 +205,7 @@ void ShutdownStaticExternalNPCFaces()
 void EmptyDialogueQueue()
 {
 	while(!ghDialogueQ.empty())
-		ghDialogueQ.pop();
+		ghDialogueQ.pop_front();
 
 	gfWaitingForTriggerTimer = FALSE;
 }
@@ -246,6 +250,7 @@ void StopAnyCurrentlyTalkingSpeech( )
 
 
 static void CheckForStopTimeQuotes(UINT16 usQuoteNum);
+static void PrefetchQueuedDialogue();
 static void HandleTacticalSpeechUI(UINT8 ubCharacterNum, FACETYPE&);
 
 
@@ -448,7 +453,8 @@ void HandleDialogue()
 	if (gTacticalStatus.fAutoBandageMode || !d->Execute())
 	{
 		delete d;
-		if(!ghDialogueQ.empty()) ghDialogueQ.pop();
+		if(!ghDialogueQ.empty()) ghDialogueQ.pop_front();
+		PrefetchQueuedDialogue();
 	}
 }
 
@@ -457,13 +463,27 @@ void DialogueEvent::Add(DialogueEvent* const d)
 {
 	try
 	{
-		ghDialogueQ.push(d);
+		ghDialogueQ.push_back(d);
 	}
 	catch (...)
 	{
 		delete d;
 		throw;
 	}
+	PrefetchQueuedDialogue();
+}
+
+
+/* The front event is about to execute and the one behind it follows right
+ * after, so both decode their data now. The ones further back only have their
+ * files read into the page cache. */
+static void PrefetchQueuedDialogue()
+{
+	size_t const n = std::min(ghDialogueQ.size(), (size_t)DIALOGUE_PREFETCH_QUOTES);
+	for (size_t i = 0; i != n; ++i)
+	{
+		ghDialogueQ[i]->Prefetch(i < 2);
+	}
 }
 
 
@@ -596,6 +616,46 @@ BOOLEAN TacticalCharacterDialogue(const SOLDIERTYPE* pSoldier, UINT16 usQuoteNum
 // NB; The queued system is not yet implemented, but will be transpatent to the caller....
 
 
+/* Reads the text and voice files of a quote ahead. With decode set, the quotes
+ * of the text file are loaded and the voice sample starts decoding in the
+ * background, otherwise the files are only read into the page cache on the
+ * prefetch thread. The files are the ones GetDialogue() picks, unless the
+ * dialogue panel opens or closes in between; then the quote is loaded when it
+ * starts, as without prefetching. */
+static void PrefetchCharacterDialogue(ProfileID const character, UINT16 const quote, bool const decode)
+{
+	MercProfile const profile(character);
+	bool        const panel = ProfileCurrentlyTalkingInDialoguePanel(character);
+
+	std::string const text = Content::GetDialogueTextFilename(profile, false, panel);
+	if (decode)
+	{
+		try
+		{
+			GCM->loadDialogQuoteFromFile(text.c_str(), quote);
+		}
+		catch (...) { /* GetDialogue() reports it */ }
+	}
+	else
+	{
+		GCM->preloadDialogQuotes(text.c_str());
+	}
+
+	if (!gGameSettings.fOptions[TOPTION_SPEECH]) return;
+
+	std::string const voice = Content::GetDialogueVoiceFilename(profile, quote, false, panel, isRussianVersion() || isRussianGoldVersion());
+	if (!GCM->doesGameResExists(voice.c_str())) return;
+	if (decode)
+	{
+		SoundPrefetch(voice.c_str());
+	}
+	else
+	{
+		PrefetchFile(GCM->openGameResForReading(voice.c_str()));
+	}
+}
+
+
 void CharacterDialogue(UINT8 const character, UINT16 const quote, FACETYPE* const face, DialogueHandler const dialogue_handler, BOOLEAN const fFromSoldier, bool const delayed)
 {
 	class DialogueEventQuote : public DialogueEvent
@@ -607,9 +667,18 @@ void CharacterDialogue(UINT8 const character, UINT16 const quote, FACETYPE* cons
 				dialogue_handler_(dialogue_handler),
 				face(face_),
 				from_soldier_(from_soldier),
-				delayed_(delayed)
+				delayed_(delayed),
+				prefetched_(0)
 			{}
 
+			void Prefetch(bool const decode)
+			{
+				UINT8 const stage = decode ? 2 : 1;
+				if (prefetched_ >= stage) return;
+				PrefetchCharacterDialogue(character_, quote_, decode);
+				prefetched_ = stage;
+			}
+
 			bool Execute()
 			{
 				// Check if this one is to be delayed until we gain control.
@@ -663,6 +732,7 @@ void CharacterDialogue(UINT8 const character, UINT16 const quote, FACETYPE* cons
 			FACETYPE*       const face;
 			bool            const from_soldier_;
 			bool            const delayed_;
+			UINT8                 prefetched_; // 0 nothing, 1 files read, 2 decoded
 	};
 
 	DialogueEvent::Add(new DialogueEventQuote(character, quote, face, dialogue_handler, fFromSoldier, delayed));
@@ -885,14 +955,9 @@ static BOOLEAN GetDialogue(const MercProfile &profile, UINT16 usQuoteNum, wchar_
 		bool success = false;
 		try
 		{
-			ST::string* quote = GCM->loadDialogQuoteFromFile(pFilename, usQuoteNum);
-			if(quote)
-			{
-				ST::wchar_buffer buf = quote->to_wchar();
-				wcsncpy(zDialogueText, buf.c_str(), Length); // might not terminate with '\0'
-				delete quote;
-				success = zDialogueText[0] != L'\0';
-			}
+			ST::wchar_buffer buf = GCM->loadDialogQuoteFromFile(pFilename, usQuoteNum).to_wchar();
+			wcsncpy(zDialogueText, buf.c_str(), Length); // might not terminate with '\0'
+			success = zDialogueText[0] != L'\0';
 		}
 		catch (...) { success = false; }
 		if (!success)
@@ -1613,6 +1678,12 @@ bool IsMercSayingDialogue(ProfileID const pid)
 }
 
 
+void PreloadMercDialogue(ProfileID const pid)
+{
+	GCM->preloadDialogQuotes(Content::GetDialogueTextFilename(MercProfile(pid), false, false));
+}
+
+
 BOOLEAN GetMercPrecedentQuoteBitStatus(const MERCPROFILESTRUCT* const p, UINT8 const ubQuoteBit)
 {
 	return (p->uiPrecedentQuoteSaid & 1 << (ubQuoteBit - 1)) != 0;
@@ -258,6 +258,9 @@ void SetExternMapscreenSpeechPanelXY( INT16 sXPos, INT16 sYPos );
 
 bool IsMercSayingDialogue(ProfileID);
 
+// Reads the quotes of a merc in the background, e.g. when the merc is hired
+void PreloadMercDialogue(ProfileID);
+
 extern FACETYPE* gpCurrentTalkingFace;
 
 extern MercPopUpBox* g_dialogue_box;
@@ -272,6 +275,11 @@ class DialogueEvent
 
 		virtual bool Execute() = 0;
 
+		/* Called for the events near the front of the queue, so they can read
+		 * their files ahead. decode is set for the next one or two events, which
+		 * should have their data ready when they execute. */
+		virtual void Prefetch(bool decode) {}
+
 		static void Add(DialogueEvent*);
 };
 
@@ -1,4 +1,5 @@
 #include "DisplayCover.h"
+#include "Cover_Map.h"
 #include "Font_Control.h"
 #include "Isometric_Utils.h"
 #include "Overhead.h"
@@ -269,6 +270,8 @@ static void CalculateCoverInRadiusAroundGridno(INT16 const sTargetGridNo, INT8 s
 
 static INT8 CalcCoverForGridNoBasedOnTeamKnownEnemies(SOLDIERTYPE const* const pSoldier, INT16 const sTargetGridNo, INT8 const bStance)
 {
+	CoverStance const cover_stance = CoverStanceOfAnimHeight(bStance);
+
 	// loop through all the enemies and determine the cover
 	INT32 iTotalCoverPoints = 0;
 	INT8  bNumEnemies       = 0;
@@ -298,6 +301,13 @@ static INT8 CalcCoverForGridNoBasedOnTeamKnownEnemies(SOLDIERTYPE const* const p
 
 		if (usRange > usSightLimit * CELL_X_SIZE) continue;
 
+		// behind solid walls towards him on the ground, he has no line to us
+		if (pSoldier->bLevel == 0 && pOpponent->bLevel == 0 &&
+			CoverFromDirection(sTargetGridNo, GetDirectionToGridNoFromGridNo(sTargetGridNo, pOpponent->sGridNo), cover_stance) == 100)
+		{
+			continue;
+		}
+
 		// if actual LOS check fails, then chance to hit is 0, ignore this guy
 		if (SoldierToVirtualSoldierLineOfSightTest(pOpponent, sTargetGridNo, pSoldier->bLevel, bStance, usSightLimit, TRUE) == 0)
 		{
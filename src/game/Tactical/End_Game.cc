@@ -110,7 +110,7 @@ void ChangeO3SectorStatue( BOOLEAN fFromExplosion )
 		ExitGrid.usGridNo = 13037;
 
 		AddExitGridToWorld( 13669, &ExitGrid );
-		gpWorldLevelData[ 13669 ].uiFlags |= MAPELEMENT_REVEALED;
+		SetTileRevealed(13669);
 	}
 
 	// Re-render the world!
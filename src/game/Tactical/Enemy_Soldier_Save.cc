@@ -1,4 +1,5 @@
 #include <stdexcept>
+#include <vector>
 
 #include "Enemy_Soldier_Save.h"
 #include "LoadSaveSoldierCreate.h"
@@ -37,7 +38,7 @@ static void RemoveTempFile(INT16 const x, INT16 const y, INT8 const z, SectorFla
 	ReSetSectorFlag(x, y, z, file_flag);
 	char filename[128];
 	GetMapTempFileName(file_flag, filename, x, y, z);
-	FileDelete(filename);
+	GCM->deleteTempFile(filename);
 }
 
 
@@ -53,7 +54,7 @@ void LoadEnemySoldiersFromTempFile()
 	// STEP ONE: Set up the temp file to read from.
 	char map_name[128];
 	GetMapTempFileName(SF_ENEMY_PRESERVED_TEMP_FILE_EXISTS, map_name, x, y, z);
-	AutoSGPFile f(GCM->openGameResForReading(map_name));
+	AutoSGPFile f(GCM->openTempFileForReading(map_name));
 
 	// STEP TWO: Determine whether or not we should use this data.  Because it
 	// is the demo, it is automatically used.
@@ -257,7 +258,112 @@ no_add:
 }
 
 
-static void CountNumberOfElitesRegularsAdminsAndCreaturesFromEnemySoldiersTempFile(UINT8* n_elites, UINT8* n_regulars, UINT8* n_admins, UINT8* n_creatures);
+struct PreservedEnemy
+{
+	SOLDIERCREATE_STRUCT placement;
+	UINT16               checksum;
+};
+
+
+/* The enemies which were in the current sector when it was left, as its temp
+ * file keeps them */
+struct PreservedEnemies
+{
+	UINT32                      timestamp;
+	std::vector<PreservedEnemy> enemies;
+	UINT8                       n_elites;
+	UINT8                       n_troops;
+	UINT8                       n_admins;
+	UINT8                       n_creatures;
+};
+
+
+/* Reads the temp file of the preserved enemies of the current sector in one
+ * go. Loading them used to read it twice, once only to count the enemies. */
+static void ReadPreservedEnemies(PreservedEnemies& p)
+{
+	INT16 const x = gWorldSectorX;
+	INT16 const y = gWorldSectorY;
+	INT8  const z = gbWorldSectorZ;
+
+	p.enemies.clear();
+	p.n_elites    = 0;
+	p.n_troops    = 0;
+	p.n_admins    = 0;
+	p.n_creatures = 0;
+
+	// STEP ONE:  Set up the temp file to read from.
+	char map_name[128];
+	GetMapTempFileName(SF_ENEMY_PRESERVED_TEMP_FILE_EXISTS, map_name, x, y, z);
+	AutoSGPFile f(GCM->openTempFileForReading(map_name));
+
+	// STEP TWO:  Determine whether or not we should use this data.  Because it
+	// is the demo, it is automatically used.
+
+	INT16 saved_y;
+	FileRead(f, &saved_y, 2);
+	if (y != saved_y)
+	{
+		throw std::runtime_error("Sector Y mismatch");
+	}
+
+	NewWayOfLoadingEnemySoldierInitListLinks(f);
+
+	// STEP THREE:  read the data
+
+	INT16 saved_x;
+	FileRead(f, &saved_x, 2);
+	if (x != saved_x)
+	{
+		throw std::runtime_error("Sector X mismatch");
+	}
+
+	INT32 saved_slots;
+	FileRead(f, &saved_slots, 4);
+	INT32 const slots = saved_slots;
+
+	FileRead(f, &p.timestamp, 4);
+
+	INT8 saved_z;
+	FileRead(f, &saved_z, 1);
+	if (z != saved_z)
+	{
+		throw std::runtime_error("Sector Z mismatch");
+	}
+
+	if (slots == 0)
+	{
+		// no enemies to restore to the map.  This means we are restoring a saved
+		// game.
+		return;
+	}
+
+	if (slots < 0 || 64 <= slots)
+	{
+		//bad IO!
+		throw std::runtime_error("Invalid slot count");
+	}
+
+	p.enemies.resize(slots);
+	for (PreservedEnemy& e : p.enemies)
+	{
+		ExtractSoldierCreateFromFileWithChecksumAndGuess(f, &e.placement, &e.checksum);
+		switch (e.placement.ubSoldierClass)
+		{
+			case SOLDIER_CLASS_ELITE:         ++p.n_elites;    break;
+			case SOLDIER_CLASS_ARMY:          ++p.n_troops;    break;
+			case SOLDIER_CLASS_ADMINISTRATOR: ++p.n_admins;    break;
+			case SOLDIER_CLASS_CREATURE:      ++p.n_creatures; break;
+		}
+	}
+
+	UINT8 saved_sector_id;
+	FileRead(f, &saved_sector_id, 1);
+	if (saved_sector_id != SECTOR(x, y))
+	{
+		throw std::runtime_error("Sector ID mismatch");
+	}
+}
 
 
 void NewWayOfLoadingEnemySoldiersFromTempFile()
@@ -265,7 +371,6 @@ void NewWayOfLoadingEnemySoldiersFromTempFile()
 	UINT8 ubStrategicElites;
 	UINT8 ubStrategicTroops;
 	UINT8 ubStrategicAdmins;
-	UINT8 ubStrategicCreatures;
 
 	gfRestoringEnemySoldiersFromTempFile = TRUE;
 
@@ -297,15 +402,16 @@ void NewWayOfLoadingEnemySoldiersFromTempFile()
 		ubNumCreatures = sector_info->ubNumCreatures;
 	}
 
+	PreservedEnemies preserved;
+	ReadPreservedEnemies(preserved);
+
 	if (!(gTacticalStatus.uiFlags & LOADING_SAVED_GAME))
 	{
-		// Get the number of enemies form the temp file
-		CountNumberOfElitesRegularsAdminsAndCreaturesFromEnemySoldiersTempFile(&ubStrategicElites, &ubStrategicTroops, &ubStrategicAdmins, &ubStrategicCreatures);
-		// If any of the counts differ from what is in memory
-		if (ubStrategicElites != ubNumElites ||
-			ubStrategicTroops != ubNumTroops ||
-			ubStrategicAdmins != ubNumAdmins ||
-			ubStrategicCreatures != ubNumCreatures)
+		// If any of the counts in the temp file differ from what is in memory
+		if (preserved.n_elites    != ubNumElites ||
+			preserved.n_troops    != ubNumTroops ||
+			preserved.n_admins    != ubNumAdmins ||
+			preserved.n_creatures != ubNumCreatures)
 		{
 			RemoveTempFile(x, y, z, SF_ENEMY_PRESERVED_TEMP_FILE_EXISTS);
 			return;
@@ -318,56 +424,15 @@ void NewWayOfLoadingEnemySoldiersFromTempFile()
 	ubNumAdmins    = 0;
 	ubNumCreatures = 0;
 
-	// STEP ONE:  Set up the temp file to read from.
-	char map_name[128];
-	GetMapTempFileName(SF_ENEMY_PRESERVED_TEMP_FILE_EXISTS, map_name, x, y, z);
-	AutoSGPFile f(GCM->openGameResForReading(map_name));
-
-	// STEP TWO:  Determine whether or not we should use this data.  Because it
-	// is the demo, it is automatically used.
-
-	INT16 saved_y;
-	FileRead(f, &saved_y, 2);
-	if (y != saved_y)
-	{
-		throw std::runtime_error("Sector Y mismatch");
-	}
-
-	NewWayOfLoadingEnemySoldierInitListLinks(f);
-
-	// STEP THREE:  read the data
-
-	INT16 saved_x;
-	FileRead(f, &saved_x, 2);
-	if (x != saved_x)
-	{
-		throw std::runtime_error("Sector X mismatch");
-	}
-
-	INT32 saved_slots;
-	FileRead(f, &saved_slots, 4);
-	INT32 const slots = saved_slots;
-
-	UINT32 timestamp;
-	FileRead(f, &timestamp, 4);
-
-	INT8 saved_z;
-	FileRead(f, &saved_z, 1);
-	if (z != saved_z)
-	{
-		throw std::runtime_error("Sector Z mismatch");
-	}
-
-	if (GetWorldTotalMin() > timestamp + 300)
+	if (GetWorldTotalMin() > preserved.timestamp + 300)
 	{
 		// The file has aged.  Use the regular method for adding soldiers.
-		f.Deallocate(); // Close the file before deleting it
 		RemoveTempFile(x, y, z, SF_ENEMY_PRESERVED_TEMP_FILE_EXISTS);
 		gfRestoringEnemySoldiersFromTempFile = FALSE;
 		return;
 	}
 
-	if (slots == 0)
+	if (preserved.enemies.empty())
 	{
 		// no need to restore the enemy's to the map.  This means we are restoring
 		// a saved game.
@@ -375,12 +440,6 @@ void NewWayOfLoadingEnemySoldiersFromTempFile()
 		return;
 	}
 
-	if (slots < 0 || 64 <= slots)
-	{
-		//bad IO!
-		throw std::runtime_error("Invalid slot count");
-	}
-
 	// For all the enemy slots (enemy/creature), clear the fPriorityExistance
 	// flag.  We will use these flags to determine which slots have been
 	// modified as we load the data into the map pristine soldier init list.
@@ -400,20 +459,16 @@ void NewWayOfLoadingEnemySoldiersFromTempFile()
 		ubStrategicElites = underground_info->ubNumElites;
 		ubStrategicTroops = underground_info->ubNumTroops;
 		ubStrategicAdmins = underground_info->ubNumAdmins;
-		ubStrategicCreatures = underground_info->ubNumCreatures;
 	}
 	else
 	{
-		SECTORINFO const* const sector_info = &SectorInfo[SECTOR(x, y)];
-		ubStrategicCreatures = sector_info->ubNumCreatures;
 		GetNumberOfEnemiesInSector(x, y, &ubStrategicAdmins, &ubStrategicTroops, &ubStrategicElites);
 	}
 
-	for (INT32 i = 0; i != slots; ++i)
+	for (PreservedEnemy const& e : preserved.enemies)
 	{
-		UINT16 saved_checksum;
-		SOLDIERCREATE_STRUCT tempDetailedPlacement;
-		ExtractSoldierCreateFromFileWithChecksumAndGuess(f, &tempDetailedPlacement, &saved_checksum);
+		SOLDIERCREATE_STRUCT const& tempDetailedPlacement = e.placement;
+		UINT16               const  saved_checksum        = e.checksum;
 		FOR_EACH_SOLDIERINITNODE(curr)
 		{
 			BASIC_SOLDIERCREATE_STRUCT* const bp = curr->pBasicPlacement;
@@ -476,13 +531,6 @@ void NewWayOfLoadingEnemySoldiersFromTempFile()
 		}
 	}
 
-	UINT8 saved_sector_id;
-	FileRead(f, &saved_sector_id, 1);
-	if (saved_sector_id != SECTOR(x, y))
-	{
-		throw std::runtime_error("Sector ID mismatch");
-	}
-
 	//now add any extra enemies that have arrived since the temp file was made.
 	if (ubStrategicTroops > ubNumTroops ||
 		ubStrategicElites > ubNumElites ||
@@ -507,7 +555,7 @@ void NewWayOfLoadingCiviliansFromTempFile()
 	// STEP ONE: Set up the temp file to read from.
 	char map_name[128];
 	GetMapTempFileName(SF_CIV_PRESERVED_TEMP_FILE_EXISTS, map_name, x, y, z);
-	AutoSGPFile f(GCM->openGameResForReading(map_name));
+	AutoSGPFile f(GCM->openTempFileForReading(map_name));
 
 	// STEP TWO:  Determine whether or not we should use this data.  Because it
 	// is the demo, it is automatically used.
@@ -790,7 +838,7 @@ void NewWayOfSavingEnemyAndCivliansToTempFile(INT16 const sSectorX, INT16 const
 
 	char map_name[128];
 	GetMapTempFileName(file_flag, map_name, sSectorX, sSectorY, bSectorZ);
-	AutoSGPFile f(FileMan::openForWriting(map_name));
+	AutoSGPFile f(GCM->openTempFileForWriting(map_name, true));
 
 	FileWrite(f, &sSectorY, 2);
 
@@ -847,100 +895,3 @@ void NewWayOfSavingEnemyAndCivliansToTempFile(INT16 const sSectorX, INT16 const
 
 	SetSectorFlag(sSectorX, sSectorY, bSectorZ, file_flag);
 }
-
-
-static void CountNumberOfElitesRegularsAdminsAndCreaturesFromEnemySoldiersTempFile(UINT8* const n_elites, UINT8* const n_regulars, UINT8* const n_admins, UINT8* const n_creatures)
-{
-	// Make sure the variables are initialized
-	*n_elites    = 0;
-	*n_regulars  = 0;
-	*n_admins    = 0;
-	*n_creatures = 0;
-
-	INT16 const x = gWorldSectorX;
-	INT16 const y = gWorldSectorY;
-	INT8  const z = gbWorldSectorZ;
-
-	// STEP ONE: Set up the temp file to read from.
-	char map_name[128];
-	GetMapTempFileName(SF_ENEMY_PRESERVED_TEMP_FILE_EXISTS, map_name, x, y, z);
-	AutoSGPFile f(GCM->openGameResForReading(map_name));
-
-	// STEP TWO: Determine whether or not we should use this data.  Because it
-	// is the demo, it is automatically used.
-
-	INT16 saved_y;
-	FileRead(f, &saved_y, 2);
-	if (y != saved_y)
-	{
-		throw std::runtime_error("Sector Y mismatch");
-	}
-
-	NewWayOfLoadingEnemySoldierInitListLinks(f);
-
-	// STEP THREE: Read the data
-
-	INT16 saved_x;
-	FileRead(f, &saved_x, 2);
-	if (x != saved_x)
-	{
-		throw std::runtime_error("Sector X mismatch");
-	}
-
-	INT32 saved_slots = 0;
-	FileRead(f, &saved_slots, 4);
-	INT32 slots = saved_slots;
-
-	// Skip timestamp
-	FileSeek(f, 4, FILE_SEEK_FROM_CURRENT);
-
-	INT8 saved_z;
-	FileRead(f, &saved_z, 1);
-	if (z != saved_z)
-	{
-		throw std::runtime_error("Sector Z mismatch");
-	}
-
-	if (slots == 0)
-	{
-		// No need to restore the enemy's to the map.  This means we are restoring
-		// a saved game.
-		return;
-	}
-
-	if (slots < 0 || 64 <= slots)
-	{
-		//bad IO!
-		throw std::runtime_error("Invalid slot count");
-	}
-
-	for (INT32 i = 0; i != slots; ++i)
-	{
-		UINT16 saved_checksum;
-		SOLDIERCREATE_STRUCT tempDetailedPlacement;
-		ExtractSoldierCreateFromFileWithChecksumAndGuess(f, &tempDetailedPlacement, &saved_checksum);
-		// Increment the current type of soldier
-		switch (tempDetailedPlacement.ubSoldierClass)
-		{
-			case SOLDIER_CLASS_ELITE:
-				++*n_elites;
-				break;
-			case SOLDIER_CLASS_ARMY:
-				++*n_regulars;
-				break;
-			case SOLDIER_CLASS_ADMINISTRATOR:
-				++*n_admins;
-				break;
-			case SOLDIER_CLASS_CREATURE:
-				++*n_creatures;
-				break;
-		}
-	}
-
-	UINT8 saved_sector_id;
-	FileRead(f, &saved_sector_id, 1);
-	if (saved_sector_id != SECTOR(x, y))
-	{
-		throw std::runtime_error("Sector ID mismatch");
-	}
-}
@@ -698,7 +698,7 @@ void RevealRoofsAndItems(SOLDIERTYPE* const pSoldier, const BOOLEAN fShowLocator
 							// 2 ) we are not in a room
 							if (gubWorldRoomInfo[marker] != NO_ROOM || TypeRangeExistsInRoofLayer(marker, FIRSTROOF, FOURTHROOF) == NULL)
 							{
-								gpWorldLevelData[ marker ].uiFlags |= MAPELEMENT_REVEALED;
+								SetTileRevealed(marker);
 								if( gfCaves )
 								{
 									RemoveFogFromGridNo( marker );
@@ -707,7 +707,7 @@ void RevealRoofsAndItems(SOLDIERTYPE* const pSoldier, const BOOLEAN fShowLocator
 						}
 						else
 						{
-							gpWorldLevelData[ marker ].uiFlags |= MAPELEMENT_REVEALED;
+							SetTileRevealed(marker);
 						}
 
 						// CHECK FOR ROOMS
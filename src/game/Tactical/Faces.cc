@@ -387,6 +387,8 @@ static void InternalSetAutoFaceActive(SGPVSurface* const display, SGPVSurface* c
 	}
 
 	f.fDisabled        = FALSE;
+	f.sEyeFrameShown   = 0;
+	f.sMouthFrameShown = 0;
 	f.uiLastBlink      = GetJA2Clock();
 	f.uiLastExpression = GetJA2Clock();
 	f.uiEyelast        = GetJA2Clock();
@@ -466,12 +468,14 @@ static void HandleRenderFaceAdjustments(FACETYPE&, BOOLEAN fDisplayBuffer, SGPVS
 static void FaceRestoreSavedBackgroundRect(FACETYPE const&, INT16 sDestLeft, INT16 sDestTop, UINT16 sSrcLeft, UINT16 sSrcTop, UINT16 sWidth, UINT16 sHeight);
 
 
-static void BlinkAutoFace(FACETYPE& f)
+/* Both return whether the face changed, so that what is drawn over it has to
+ * be drawn again. */
+static bool BlinkAutoFace(FACETYPE& f)
 {
 	Assert(f.fAllocated);
 	Assert(!f.fDisabled);
 
-	if (f.fInvalidAnim) return;
+	if (f.fInvalidAnim) return false;
 
 	// CHECK IF BUDDY IS DEAD, UNCONSCIOUS, ASLEEP, OR POW!
 	SOLDIERTYPE const* const s = f.soldier;
@@ -480,7 +484,7 @@ static void BlinkAutoFace(FACETYPE& f)
 		s->bLife < OKLIFE ||
 		s->bAssignment == ASSIGNMENT_POW))
 	{
-		return;
+		return false;
 	}
 
 	if (f.ubExpression == NO_EXPRESSION)
@@ -508,7 +512,13 @@ static void BlinkAutoFace(FACETYPE& f)
 
 		NewEye(f);
 
-		INT16 sFrame = f.sEyeFrame;
+		INT16 const sFrame = f.sEyeFrame;
+		if (sFrame == 0) f.ubExpression = NO_EXPRESSION;
+
+		// A frown or surprise is held for a while without the eyes changing
+		if (sFrame == f.sEyeFrameShown) return false;
+		f.sEyeFrameShown = sFrame;
+
 		if (sFrame > 0)
 		{
 			// Blit Accordingly!
@@ -521,7 +531,6 @@ static void BlinkAutoFace(FACETYPE& f)
 		}
 		else
 		{
-			f.ubExpression = NO_EXPRESSION;
 			// Update rects just for eyes
 
 			if (f.uiAutoRestoreBuffer == guiSAVEBUFFER)
@@ -533,9 +542,9 @@ static void BlinkAutoFace(FACETYPE& f)
 				FaceRestoreSavedBackgroundRect(f, f.usEyesX, f.usEyesY, f.usEyesOffsetX, f.usEyesOffsetY, f.usEyesWidth, f.usEyesHeight);
 			}
 		}
-
-		HandleRenderFaceAdjustments(f, TRUE, 0, f.usFaceX, f.usFaceY, f.usEyesX, f.usEyesY);
+		return true;
 	}
+	return false;
 }
 
 
@@ -590,11 +599,12 @@ static void HandleFaceHilights(FACETYPE const& f, SGPVSurface* const uiBuffer, c
 static void NewMouth(FACETYPE&);
 
 
-static void MouthAutoFace(FACETYPE& f)
+static bool MouthAutoFace(FACETYPE& f)
 {
 	Assert(f.fAllocated);
 	Assert(!f.fDisabled);
 
+	bool changed = false;
 	if (f.fTalking && !f.fInvalidAnim && f.fAnimatingTalking)
 	{
 		// Check if we have an audio gap
@@ -602,13 +612,18 @@ static void MouthAutoFace(FACETYPE& f)
 		{
 			f.sMouthFrame = 0;
 
-			if (f.uiAutoRestoreBuffer == guiSAVEBUFFER)
+			// The mouth stays closed for the whole gap, restore it only once
+			if (f.sMouthFrameShown != 0)
 			{
-				FaceRestoreSavedBackgroundRect(f, f.usMouthX, f.usMouthY, f.usMouthX, f.usMouthY, f.usMouthWidth, f.usMouthHeight);
-			}
-			else
-			{
-				FaceRestoreSavedBackgroundRect(f, f.usMouthX, f.usMouthY, f.usMouthOffsetX, f.usMouthOffsetY, f.usMouthWidth, f.usMouthHeight);
+				if (f.uiAutoRestoreBuffer == guiSAVEBUFFER)
+				{
+					FaceRestoreSavedBackgroundRect(f, f.usMouthX, f.usMouthY, f.usMouthX, f.usMouthY, f.usMouthWidth, f.usMouthHeight);
+				}
+				else
+				{
+					FaceRestoreSavedBackgroundRect(f, f.usMouthX, f.usMouthY, f.usMouthOffsetX, f.usMouthOffsetY, f.usMouthWidth, f.usMouthHeight);
+				}
+				f.sMouthFrameShown = 0;
 			}
 		}
 		else if (GetJA2Clock() - f.uiMouthlast > f.uiMouthDelay)
@@ -618,6 +633,7 @@ static void MouthAutoFace(FACETYPE& f)
 			NewMouth(f);
 
 			INT16 const sFrame = f.sMouthFrame;
+			f.sMouthFrameShown = sFrame;
 			if (sFrame > 0)
 			{
 				// Blit Accordingly!
@@ -641,8 +657,7 @@ static void MouthAutoFace(FACETYPE& f)
 					FaceRestoreSavedBackgroundRect(f, f.usMouthX, f.usMouthY, f.usMouthOffsetX, f.usMouthOffsetY, f.usMouthWidth, f.usMouthHeight);
 				}
 			}
-
-			HandleRenderFaceAdjustments(f, TRUE, 0, f.usFaceX, f.usFaceY, f.usEyesX, f.usEyesY);
+			changed = true;
 		}
 	}
 
@@ -650,6 +665,7 @@ static void MouthAutoFace(FACETYPE& f)
 	{
 		HandleFaceHilights(f, f.uiAutoDisplayBuffer, f.usFaceX, f.usFaceY);
 	}
+	return changed;
 }
 
 
@@ -1015,6 +1031,8 @@ void RenderAutoFace(FACETYPE& f)
 	BltVideoObject(f.uiAutoRestoreBuffer, f.uiVideoObject, 0, x, y);
 	HandleRenderFaceAdjustments(f, FALSE, 0, f.usFaceX, f.usFaceY, f.usEyesX, f.usEyesY);
 	FaceRestoreSavedBackgroundRect(f, f.usFaceX, f.usFaceY, x, y, f.usFaceWidth, f.usFaceHeight);
+	f.sEyeFrameShown   = 0;
+	f.sMouthFrameShown = 0;
 }
 
 
@@ -1220,8 +1238,14 @@ void HandleAutoFaces(void)
 				RenderAutoFace(f);
 		}
 
-		BlinkAutoFace(f);
-		MouthAutoFace(f);
+		/* Draw what goes over the face once, after both the eyes and the mouth
+		 * changed */
+		bool const eyes_changed  = BlinkAutoFace(f);
+		bool const mouth_changed = MouthAutoFace(f);
+		if (eyes_changed || mouth_changed)
+		{
+			HandleRenderFaceAdjustments(f, TRUE, 0, f.usFaceX, f.usFaceY, f.usEyesX, f.usEyesY);
+		}
 	}
 }
 
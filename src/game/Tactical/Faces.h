@@ -99,6 +99,7 @@ struct FACETYPE
 	UINT16  usMouthHeight;
 
 	UINT16  sEyeFrame;
+	UINT16  sEyeFrameShown; // in the display buffer, 0 once the whole face was restored
 	INT8    ubEyeWait;
 	UINT32  uiEyelast;
 	UINT32  uiEyeDelay;
@@ -114,6 +115,7 @@ struct FACETYPE
 	const SOLDIERTYPE* old_service_partner;
 
 	UINT16   sMouthFrame;
+	UINT16   sMouthFrameShown;
 	UINT32   uiMouthlast;
 	UINT32   uiMouthDelay;
 
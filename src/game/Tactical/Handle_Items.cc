@@ -94,6 +94,10 @@ struct ITEM_POOL_LOCATOR
 static ITEM_POOL_LOCATOR FlashItemSlots[NUM_ITEM_FLASH_SLOTS];
 static UINT32 guiNumFlashItemSlots = 0;
 
+/* The head of the item pool of every tile on the ground and on the roof, so
+ * looking for the items at a spot does not walk the structure nodes there */
+static ITEM_POOL* g_item_pools[2][WORLD_MAX];
+
 
 // Disgusting hacks: have to keep track of these values for accesses in callbacks
 static SOLDIERTYPE *gpTempSoldier;
@@ -972,6 +976,7 @@ void HandleSoldierDropBomb(SOLDIERTYPE* const s, INT16 const sGridNo)
 
 		// we now know there is something nasty here
 		gpWorldLevelData[sGridNo].uiFlags |= MAPELEMENT_PLAYER_MINE_PRESENT;
+		InvalidatePathCache();
 
 		AddItemToPool(sGridNo, &o, BURIED, s->bLevel, WORLD_ITEM_ARMED_BOMB, 0);
 		DeleteObj(&o);
@@ -1606,6 +1611,7 @@ INT32 InternalAddItemToPool(INT16* const psGridNo, OBJECTTYPE* const pObject, Vi
 			case ACTION_ITEM_LARGE_PIT:
 				// mark as known about by civs and creatures
 				gpWorldLevelData[sNewGridNo].uiFlags |= MAPELEMENT_ENEMY_MINE_PRESENT;
+				InvalidatePathCache();
 				break;
 
 			default: break;
@@ -1645,6 +1651,7 @@ INT32 InternalAddItemToPool(INT16* const psGridNo, OBJECTTYPE* const pObject, Vi
 	else
 	{
 		pNode->pItemPool = new_item;
+		g_item_pools[ubLevel != 0][sNewGridNo] = new_item;
 
 		// Set flag to indicate item pool presence
 		gpWorldLevelData[sNewGridNo].uiFlags |= MAPELEMENT_ITEMPOOL_PRESENT;
@@ -1894,11 +1901,16 @@ void RemoveItemFromPool(WORLDITEM* const wi)
 				continue;
 			l->pItemPool = next;
 		}
+		g_item_pools[wi->ubLevel != 0][wi->sGridNo] = next;
 	}
 	else
 	{
 		// This was the last item in the pool
-		gpWorldLevelData[wi->sGridNo].uiFlags &= ~MAPELEMENT_ITEMPOOL_PRESENT;
+		g_item_pools[wi->ubLevel != 0][wi->sGridNo] = NULL;
+		if (!g_item_pools[wi->ubLevel == 0][wi->sGridNo])
+		{ // There are no items on the other level either
+			gpWorldLevelData[wi->sGridNo].uiFlags &= ~MAPELEMENT_ITEMPOOL_PRESENT;
+		}
 
 		// If there is a structure with the has item on top flag set, reset it,
 		// because there are no more items here
@@ -1937,13 +1949,8 @@ void MoveItemPools(INT16 const sStartPos, INT16 const sEndPos)
 
 ITEM_POOL* GetItemPool(UINT16 const usMapPos, UINT8 const ubLevel)
 {
-	for (LEVELNODE* n = GetStructNodes(usMapPos, ubLevel); n; n = n->pNext)
-	{
-		if (!(n->uiFlags & LEVELNODE_ITEM))
-			continue;
-		return n->pItemPool;
-	}
-	return 0;
+	if (usMapPos >= WORLD_MAX) return 0;
+	return g_item_pools[ubLevel != 0][usMapPos];
 }
 
 
@@ -3127,13 +3134,9 @@ BOOLEAN NearbyGroundSeemsWrong(SOLDIERTYPE* const s, const INT16 sGridNo, const
 		if (pMapElement->uiFlags & fCheckFlag) continue;
 
 		// check for boobytraps
-		CFOR_EACH_WORLD_BOMB(wb)
+		for (UINT32 const idx : WorldBombsInGridNo(sNextGridNo))
 		{
-			WORLDITEM& wi = GetWorldItem(wb->iItemIndex);
-			if (wi.sGridNo != sNextGridNo)
-				continue;
-
-			OBJECTTYPE& o = wi.o;
+			OBJECTTYPE& o = GetWorldItem(gWorldBombs[idx].iItemIndex).o;
 			if (o.bDetonatorType != BOMB_PRESSURE)
 				continue;
 			if (o.fFlags & OBJECT_KNOWN_TO_BE_TRAPPED)
@@ -3223,6 +3226,7 @@ static void AddBlueFlag(INT16 sGridNo, INT8 bLevel)
 	LEVELNODE *pNode;
 
 	gpWorldLevelData[ sGridNo ].uiFlags |= MAPELEMENT_PLAYER_MINE_PRESENT;
+	InvalidatePathCache();
 
 	{ ApplyMapChangesToMapTempFile app;
 		pNode = AddStructToTail( sGridNo, BLUEFLAG_GRAPHIC );
@@ -3236,6 +3240,7 @@ static void AddBlueFlag(INT16 sGridNo, INT8 bLevel)
 void RemoveBlueFlag( INT16 sGridNo, INT8 bLevel )
 {
 	gpWorldLevelData[sGridNo].uiFlags &= ~(MAPELEMENT_PLAYER_MINE_PRESENT);
+	InvalidatePathCache();
 
 	{ ApplyMapChangesToMapTempFile app;
 		if ( bLevel == 0 )
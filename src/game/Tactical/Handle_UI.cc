@@ -9,6 +9,7 @@
 #include "Debug.h"
 #include "JAScreens.h"
 #include "PathAI.h"
+#include "Path_Regions.h"
 #include "Soldier_Control.h"
 #include "Animation_Control.h"
 #include "Animation_Data.h"
@@ -65,6 +66,7 @@
 #include "SaveLoadGame.h"
 #include "Spread_Burst.h"
 #include "AI.h"
+#include "AITiming.h"
 #include "Game_Clock.h"
 #include "Civ_Quotes.h"
 #include "QArray.h"
@@ -79,6 +81,7 @@
 #include "Soldier.h"
 
 #include <algorithm>
+#include <climits>
 #include <iterator>
 
 #define MAX_ON_DUTY_SOLDIERS 6
@@ -2711,7 +2714,10 @@ static ScreenID UIHandleILOSDebug(UI_EVENT* pUIEvent)
 
 static ScreenID UIHandleILevelNodeDebug(UI_EVENT* pUIEvent)
 {
-	SetDebugRenderHook(DebugLevelNodePage, 0);
+	SetDebugRenderHook(DebugLevelNodePage,   0);
+	SetDebugRenderHook(DebugPathAIPage,      1);
+	SetDebugRenderHook(DebugPathRegionsPage, 2);
+	SetDebugRenderHook(DebugAIPage,          3);
 	return( DEBUG_SCREEN );
 }
 
@@ -2871,6 +2877,26 @@ MouseMoveState GetCursorMovementFlags()
 static INT8 DrawUIMovementPath(SOLDIERTYPE* pSoldier, UINT16 usMapPos, MoveUITarget);
 
 
+/* The frame in which the movement path was last plotted. A path search a frame
+ * is enough for the cursor, another one in the same frame is put off to the
+ * next frame by leaving gfPlotNewMovement set. */
+static UINT32 guiUIPathPlotFrame = UINT_MAX;
+
+
+static bool UIPathPlottedThisFrame()
+{
+	return guiUIPathPlotFrame == guiGameCycleCounter;
+}
+
+
+static void PlotUIMovementPath(SOLDIERTYPE* const s, UINT16 const map_pos, MoveUITarget const target)
+{
+	DrawUIMovementPath(s, map_pos, target);
+	guiUIPathPlotFrame = guiGameCycleCounter;
+	gfPlotNewMovement  = FALSE;
+}
+
+
 BOOLEAN HandleUIMovementCursor(SOLDIERTYPE* const pSoldier, MouseMoveState const uiCursorFlags, UINT16 const usMapPos, MoveUITarget const uiFlags)
 {
 	static const SOLDIERTYPE* target = NULL;
@@ -2900,8 +2926,15 @@ BOOLEAN HandleUIMovementCursor(SOLDIERTYPE* const pSoldier, MouseMoveState const
 				// ERASE PATH
 				ErasePath();
 
-				// Try and get a path right away
-				DrawUIMovementPath( pSoldier, usMapPos,  uiFlags );
+				// Try and get a path right away, unless one was searched for this frame
+				if (UIPathPlottedThisFrame())
+				{
+					gfPlotNewMovement = TRUE;
+				}
+				else
+				{
+					PlotUIMovementPath(pSoldier, usMapPos, uiFlags);
+				}
 			}
 
 			// Save for next time...
@@ -2967,11 +3000,9 @@ BOOLEAN HandleUIMovementCursor(SOLDIERTYPE* const pSoldier, MouseMoveState const
 				// Reset counter
 				RESETCOUNTER( PATHFINDCOUNTER );
 
-				if ( gfPlotNewMovement  )
+				if ( gfPlotNewMovement && !UIPathPlottedThisFrame() )
 				{
-					DrawUIMovementPath( pSoldier, usMapPos,  uiFlags );
-
-					gfPlotNewMovement = FALSE;
+					PlotUIMovementPath(pSoldier, usMapPos, uiFlags);
 				}
 			}
 
@@ -411,6 +411,10 @@ struct REMOVE_MONEY
 static REMOVE_MONEY gRemoveMoney;
 
 static MOUSE_REGION gSMInvRegion[NUM_INV_SLOTS];
+/* The contents each slot's fast help text was made for. The text only has to be
+ * made again when they change, e.g. when the panel shows another merc. */
+static OBJECTTYPE   gSMInvHelpObject[NUM_INV_SLOTS];
+static bool         gfSMInvHelpValid[NUM_INV_SLOTS];
 static MOUSE_REGION gKeyRingPanel;
 static MOUSE_REGION gSMInvCamoRegion;
 static INT8 gbCompatibleAmmo[NUM_INV_SLOTS];
@@ -697,6 +701,7 @@ void InitInvSlotInterface(INV_REGION_DESC const* const pRegionDesc, INV_REGION_D
 	}
 
 	std::fill(std::begin(gbCompatibleAmmo), std::end(gbCompatibleAmmo), 0);
+	std::fill(std::begin(gfSMInvHelpValid), std::end(gfSMInvHelpValid), false);
 }
 
 
@@ -803,9 +808,14 @@ static void INVRenderINVPanelItem(SOLDIERTYPE const& s, INT16 const pocket, Dirt
 	UINT16 outline   = SGP_TRANSPARENT;
 	if (dirty_level == DIRTYLEVEL2)
 	{
-		wchar_t buf[150];
-		GetHelpTextForItem(buf, lengthof(buf), o);
-		r.SetFastHelpText(buf);
+		if (!gfSMInvHelpValid[pocket] || memcmp(&gSMInvHelpObject[pocket], &o, sizeof(o)) != 0)
+		{
+			wchar_t buf[150];
+			GetHelpTextForItem(buf, lengthof(buf), o);
+			r.SetFastHelpText(buf);
+			memcpy(&gSMInvHelpObject[pocket], &o, sizeof(o));
+			gfSMInvHelpValid[pocket] = true;
+		}
 
 		// If it's the second hand and this hand cannot contain anything, remove the
 		// second hand position graphic
@@ -1904,7 +1904,7 @@ void ReplaceExtendedGuns( SOLDIERCREATE_STRUCT *pp, INT8 bSoldierClass )
 		{
 			if ( bSoldierClass == SOLDIER_CLASS_NONE )
 			{
-				usNewGun = GCM->getWeaponByName(weapon->getStandardReplacement())->getItemIndex();
+				usNewGun = GCM->getWeaponReplacement(weapon)->getItemIndex();
 			}
 			else
 			{
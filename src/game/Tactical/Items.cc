@@ -22,6 +22,7 @@
 #include "Explosion_Control.h"
 #include "Keys.h"
 #include "WCheck.h"
+#include "Soldier_Grid.h"
 #include "Soldier_Profile.h"
 #include "SkillCheck.h"
 #include "LOS.h"
@@ -610,6 +611,68 @@ ComboMergeInfoStruct AttachmentComboMerge[] =
 };
 
 
+#define ITEM_PAIR_WORDS ((MAXITEMS + 31) / 32)
+
+// One bit for every pair of items, whether the first goes with the second
+struct ItemPairTable
+{
+	UINT32 bits[MAXITEMS][ITEM_PAIR_WORDS];
+
+	void Set(UINT16 const a, UINT16 const b)       { bits[a][b / 32] |= 1U << (b % 32); }
+	bool Get(UINT16 const a, UINT16 const b) const { return (bits[a][b / 32] >> (b % 32) & 1) != 0; }
+};
+
+ItemProperties       g_item_properties[MAXITEMS];
+static ItemPairTable g_attachable;            // attachment, item
+static ItemPairTable g_launchable;            // launchable, launcher
+static ItemPairTable g_compatible_face_items; // both ways round
+
+
+void InitItemTables()
+{
+	memset(g_item_properties, 0, sizeof(g_item_properties));
+	memset(&g_attachable,            0, sizeof(g_attachable));
+	memset(&g_launchable,            0, sizeof(g_launchable));
+	memset(&g_compatible_face_items, 0, sizeof(g_compatible_face_items));
+
+	for (UINT16 i = 0; i != MAXITEMS; ++i)
+	{
+		ItemModel const* const item = GCM->getItem(i);
+		if (!item) continue;
+
+		ItemProperties& p = g_item_properties[i];
+		p.uiItemClass  = item->getItemClass();
+		p.fFlags       = item->getFlags();
+		p.ubClassIndex = item->getClassIndex();
+		p.ubWeight     = item->getWeight();
+		p.ubPerPocket  = item->getPerPocket();
+		p.bReliability = item->getReliability();
+
+		for (UINT16 attachment = 0; attachment != MAXITEMS; ++attachment)
+		{
+			if (item->canBeAttached(attachment)) g_attachable.Set(attachment, i);
+		}
+	}
+
+	UINT16 const (*attachments)[2] = gamepolicy(extra_attachments) ? g_attachments_mod : g_attachments;
+	for (UINT16 const (*i)[2] = attachments; (*i)[0] != NOTHING; ++i)
+	{
+		g_attachable.Set((*i)[0], (*i)[1]);
+	}
+
+	for (UINT16 const (*i)[2] = Launchable; (*i)[0] != NOTHING; ++i)
+	{
+		g_launchable.Set((*i)[0], (*i)[1]);
+	}
+
+	for (UINT16 const (*i)[2] = CompatibleFaceItems; (*i)[0] != NOTHING; ++i)
+	{
+		g_compatible_face_items.Set((*i)[0], (*i)[1]);
+		g_compatible_face_items.Set((*i)[1], (*i)[0]);
+	}
+}
+
+
 BOOLEAN ItemIsLegal( UINT16 usItemIndex )
 {
 	//if the user has selected the reduced gun list
@@ -633,7 +696,7 @@ BOOLEAN ItemIsLegal( UINT16 usItemIndex )
 
 BOOLEAN WeaponInHand(const SOLDIERTYPE* const pSoldier)
 {
-	if ( GCM->getItem(pSoldier->inv[HANDPOS].usItem)->getItemClass() & (IC_WEAPON | IC_THROWN) )
+	if ( GetItemProperties(pSoldier->inv[HANDPOS].usItem).uiItemClass & (IC_WEAPON | IC_THROWN) )
 	{
 		OBJECTTYPE const& o = pSoldier->inv[HANDPOS];
 		if (HasObjectImprint(o))
@@ -672,7 +735,7 @@ UINT8 ItemSlotLimit( UINT16 usItem, INT8 bSlot )
 	}
 	else
 	{
-		ubSlotLimit = GCM->getItem(usItem)->getPerPocket();
+		ubSlotLimit = GetItemProperties(usItem).ubPerPocket;
 		if (bSlot >= SMALLPOCK1POS && ubSlotLimit > 1)
 		{
 			ubSlotLimit /= 2;
@@ -800,7 +863,7 @@ INT8 FindObjClass(const SOLDIERTYPE* const pSoldier, const UINT32 usItemClass)
 
 	for (bLoop = 0; bLoop < NUM_INV_SLOTS; bLoop++)
 	{
-		if (GCM->getItem(pSoldier->inv[bLoop].usItem)->getItemClass() & usItemClass)
+		if (GetItemProperties(pSoldier->inv[bLoop].usItem).uiItemClass & usItemClass)
 		{
 			return( bLoop );
 		}
@@ -823,7 +886,7 @@ INT8 FindAIUsableObjClass( const SOLDIERTYPE * pSoldier, 	UINT32 usItemClass )
 
 	for (bLoop = 0; bLoop < NUM_INV_SLOTS; bLoop++)
 	{
-		if ( (GCM->getItem(pSoldier->inv[bLoop].usItem)->getItemClass() & usItemClass) && !(pSoldier->inv[bLoop].fFlags & OBJECT_AI_UNUSABLE) && (pSoldier->inv[bLoop].bStatus[0] >= USABLE ) )
+		if ( (GetItemProperties(pSoldier->inv[bLoop].usItem).uiItemClass & usItemClass) && !(pSoldier->inv[bLoop].fFlags & OBJECT_AI_UNUSABLE) && (pSoldier->inv[bLoop].bStatus[0] >= USABLE ) )
 		{
 			if ( usItemClass == IC_GUN && EXPLOSIVE_GUN( pSoldier->inv[bLoop].usItem ) )
 			{
@@ -844,7 +907,7 @@ INT8 FindAIUsableObjClassWithin( const SOLDIERTYPE * pSoldier, 	UINT32 usItemCla
 
 	for (bLoop = bLower; bLoop <= bUpper; bLoop++)
 	{
-		if ( (GCM->getItem(pSoldier->inv[bLoop].usItem)->getItemClass() & usItemClass) && !(pSoldier->inv[bLoop].fFlags & OBJECT_AI_UNUSABLE) && (pSoldier->inv[bLoop].bStatus[0] >= USABLE ) )
+		if ( (GetItemProperties(pSoldier->inv[bLoop].usItem).uiItemClass & usItemClass) && !(pSoldier->inv[bLoop].fFlags & OBJECT_AI_UNUSABLE) && (pSoldier->inv[bLoop].bStatus[0] >= USABLE ) )
 		{
 			if ( usItemClass == IC_GUN && EXPLOSIVE_GUN( pSoldier->inv[bLoop].usItem ) )
 			{
@@ -965,7 +1028,7 @@ INT8 FindAttachmentByClass(OBJECTTYPE const* const pObj, UINT32 const uiItemClas
 
 	for (bLoop = 0; bLoop < MAX_ATTACHMENTS; bLoop++)
 	{
-		if (GCM->getItem(pObj->usAttachItem[bLoop])->getItemClass() == uiItemClass)
+		if (GetItemProperties(pObj->usAttachItem[bLoop]).uiItemClass == uiItemClass)
 		{
 			return( bLoop );
 		}
@@ -1022,7 +1085,7 @@ static BOOLEAN ValidAttachmentClass(UINT16 usAttachment, UINT16 usItem)
 		// see comment for AttachmentInfo array for why we skip IC_NONE
 		if (i->uiItemClass == IC_NONE) continue;
 
-		if (i->usItem == usAttachment && i->uiItemClass == GCM->getItem(usItem)->getItemClass())
+		if (i->usItem == usAttachment && i->uiItemClass == GetItemProperties(usItem).uiItemClass)
 		{
 			return TRUE;
 		}
@@ -1043,25 +1106,7 @@ static const AttachmentInfoStruct* GetAttachmentInfo(const UINT16 usItem)
 
 bool ValidAttachment(UINT16 const attachment, UINT16 const item)
 {
-	const ItemModel *itemModel = GCM->getItem(item);
-	if(itemModel->canBeAttached(attachment))
-	{
-		return true;
-	}
-
-	UINT16 const (*i)[2] = gamepolicy(extra_attachments) ? g_attachments_mod : g_attachments;
-	for (;; ++i)
-	{
-		UINT16 const (&a)[2] = *i;
-		if (a[0] == NOTHING)    return false; // Cannot be attached to anything
-		if (a[0] == attachment) break;
-	}
-	for (;; ++i)
-	{
-		UINT16 const (&a)[2] = *i;
-		if (a[0] != attachment) return false; // Cannot be attached to item
-		if (a[1] == item)       return true;
-	}
+	return g_attachable.Get(attachment, item);
 }
 
 
@@ -1176,7 +1221,7 @@ BOOLEAN ValidItemAttachment(const OBJECTTYPE* const pObj, const UINT16 usAttachm
 //Determines if it is possible to equip this weapon with this ammo.
 bool ValidAmmoType( UINT16 usItem, UINT16 usAmmoType )
 {
-	if (GCM->getItem(usItem)->getItemClass() == IC_GUN && GCM->getItem(usAmmoType)->getItemClass() == IC_AMMO)
+	if (GetItemProperties(usItem).uiItemClass == IC_GUN && GetItemProperties(usAmmoType).uiItemClass == IC_AMMO)
 	{
 		return GCM->getWeapon(usItem)->matches(GCM->getItem(usAmmoType)->asAmmo()->calibre);
 	}
@@ -1187,12 +1232,7 @@ bool ValidAmmoType( UINT16 usItem, UINT16 usAmmoType )
 BOOLEAN CompatibleFaceItem(UINT16 const item1, UINT16 const item2)
 {
 	if (item2 == NOTHING) return TRUE;
-	for (UINT16 const (*i)[2] = CompatibleFaceItems; (*i)[0] != NOTHING; ++i)
-	{
-		if ((*i)[0] == item1 && (*i)[1] == item2) return TRUE;
-		if ((*i)[0] == item2 && (*i)[1] == item1) return TRUE;
-	}
-	return FALSE;
+	return g_compatible_face_items.Get(item1, item2);
 }
 
 
@@ -1208,37 +1248,7 @@ static BOOLEAN TwoHandedItem(UINT16 usItem)
 
 BOOLEAN ValidLaunchable( UINT16 usLaunchable, UINT16 usItem )
 {
-	INT32 iLoop = 0;
-
-	// look for the section of the array pertaining to this launchable item...
-	while( 1 )
-	{
-		if (Launchable[iLoop][0] == usLaunchable)
-		{
-			break;
-		}
-		iLoop++;
-		if (Launchable[iLoop][0] == 0)
-		{
-			// the proposed item cannot be attached to anything!
-			return( FALSE );
-		}
-	}
-	// now look through this section for the item in question
-	while( 1 )
-	{
-		if (Launchable[iLoop][1] == usItem)
-		{
-			break;
-		}
-		iLoop++;
-		if (Launchable[iLoop][0] != usLaunchable)
-		{
-			// the proposed item cannot be attached to the item in question
-			return( FALSE );
-		}
-	}
-	return( TRUE );
+	return g_launchable.Get(usLaunchable, usItem);
 }
 
 
@@ -1270,7 +1280,7 @@ static BOOLEAN EvaluateValidMerge(UINT16 const usMerge, UINT16 const usItem, UIN
 	// NB "usMerge" is the object being merged with (e.g. compound 18)
 	// "usItem" is the item being merged "onto" (e.g. kevlar vest)
 
-	if (usMerge == usItem && GCM->getItem(usItem)->getItemClass() == IC_AMMO)
+	if (usMerge == usItem && GetItemProperties(usItem).uiItemClass == IC_AMMO)
 	{
 		*pusResult = usItem;
 		*pubType   = COMBINE_POINTS;
@@ -1300,21 +1310,21 @@ BOOLEAN ValidMerge( UINT16 usMerge, UINT16 usItem )
 
 UINT8 CalculateObjectWeight(OBJECTTYPE const* const o)
 {
-	const ItemModel *item  = GCM->getItem(o->usItem);
-	UINT16          weight = item->getWeight(); // Start with base weight
+	ItemProperties const& item   = GetItemProperties(o->usItem);
+	UINT16                weight = item.ubWeight; // Start with base weight
 
-	if (item->getPerPocket() <= 1)
+	if (item.ubPerPocket <= 1)
 	{
 		// Account for any attachments
 		FOR_EACH(UINT16 const, i, o->usAttachItem)
 		{
 			if (*i == NOTHING) continue;
-			weight += GCM->getItem(*i)->getWeight();
+			weight += GetItemProperties(*i).ubWeight;
 		}
 
-		if (GCM->getItem(o->usItem)->getItemClass() == IC_GUN && o->ubGunShotsLeft > 0)
+		if (item.uiItemClass == IC_GUN && o->ubGunShotsLeft > 0)
 		{ // Add in weight of ammo
-			weight += GCM->getItem(o->usGunAmmoItem)->getWeight();
+			weight += GetItemProperties(o->usGunAmmoItem).ubWeight;
 		}
 	}
 
@@ -1331,7 +1341,7 @@ UINT32 CalculateCarriedWeight(SOLDIERTYPE const* const s)
 	CFOR_EACH_SOLDIER_INV_SLOT(i, *s)
 	{
 		UINT16 weight = i->ubWeight;
-		if (GCM->getItem(i->usItem)->getPerPocket() > 1)
+		if (GetItemProperties(i->usItem).ubPerPocket > 1)
 		{
 			// Account for # of items
 			weight *= i->ubNumberOfObjects;
@@ -1595,7 +1605,7 @@ BOOLEAN ReloadGun( SOLDIERTYPE * pSoldier, OBJECTTYPE * pGun, OBJECTTYPE * pAmmo
 
 	}
 
-	if ( GCM->getItem(pGun->usItem)->getItemClass() == IC_LAUNCHER || pGun->usItem == TANK_CANNON )
+	if ( GetItemProperties(pGun->usItem).uiItemClass == IC_LAUNCHER || pGun->usItem == TANK_CANNON )
 	{
 		if (!AttachObject(pSoldier, pGun, pAmmo))
 		{
@@ -1911,7 +1921,7 @@ INT8 FindAmmoToReload( const SOLDIERTYPE * pSoldier, INT8 bWeaponIn, INT8 bExclu
 		return( NO_SLOT );
 	}
 	pObj = &(pSoldier->inv[bWeaponIn]);
-	if ( GCM->getItem(pObj->usItem)->getItemClass() == IC_GUN && pObj->usItem != TANK_CANNON )
+	if ( GetItemProperties(pObj->usItem).uiItemClass == IC_GUN && pObj->usItem != TANK_CANNON )
 	{
 		// look for same ammo as before
 		bSlot = FindObjExcludingSlot( pSoldier, pObj->usGunAmmoItem, bExcludeSlot );
@@ -1958,7 +1968,7 @@ BOOLEAN AutoReload( SOLDIERTYPE * pSoldier )
 	CHECKF( pSoldier );
 	pObj = &(pSoldier->inv[HANDPOS]);
 
-	if (GCM->getItem(pObj->usItem)->getItemClass() == IC_GUN || GCM->getItem(pObj->usItem)->getItemClass() == IC_LAUNCHER)
+	if (GetItemProperties(pObj->usItem).uiItemClass == IC_GUN || GetItemProperties(pObj->usItem).uiItemClass == IC_LAUNCHER)
 	{
 		bSlot = FindAmmoToReload( pSoldier, HANDPOS, NO_SLOT );
 		if (bSlot != NO_SLOT)
@@ -2060,7 +2070,7 @@ bool AttachObject(SOLDIERTYPE* const s, OBJECTTYPE* const pTargetObj, OBJECTTYPE
 		if (valid_launchable || (GL_HE_GRENADE <= attachment.usItem && attachment.usItem <= GL_SMOKE_GRENADE))
 		{
 			// try replacing if possible
-			attach_pos = FindAttachmentByClass(&target, GCM->getItem(attachment.usItem)->getItemClass());
+			attach_pos = FindAttachmentByClass(&target, GetItemProperties(attachment.usItem).uiItemClass);
 			if (attach_pos != NO_SLOT && attachment.ubNumberOfObjects > 1)
 			{
 				// we can only do a swap if there is only 1 grenade being attached
@@ -2281,7 +2291,7 @@ BOOLEAN CanItemFitInPosition(SOLDIERTYPE* pSoldier, OBJECTTYPE* pObj, INT8 bPos,
 				if (pSoldier->inv[HANDPOS].usItem != NOTHING && pSoldier->inv[SECONDHANDPOS].usItem != NOTHING)
 				{
 					// two items in hands; try moving the second one so we can swap
-					if (GCM->getItem(pSoldier->inv[SECONDHANDPOS].usItem)->getPerPocket() == 0)
+					if (GetItemProperties(pSoldier->inv[SECONDHANDPOS].usItem).ubPerPocket == 0)
 					{
 						bNewPos = FindEmptySlotWithin( pSoldier, BIGPOCK1POS, BIGPOCK4POS );
 					}
@@ -2307,26 +2317,26 @@ BOOLEAN CanItemFitInPosition(SOLDIERTYPE* pSoldier, OBJECTTYPE* pObj, INT8 bPos,
 		case VESTPOS:
 		case HELMETPOS:
 		case LEGPOS:
-			if (GCM->getItem(pObj->usItem)->getItemClass() != IC_ARMOUR)
+			if (GetItemProperties(pObj->usItem).uiItemClass != IC_ARMOUR)
 			{
 				return( FALSE );
 			}
 			switch (bPos)
 			{
 				case VESTPOS:
-					if (Armour[GCM->getItem(pObj->usItem)->getClassIndex()].ubArmourClass != ARMOURCLASS_VEST)
+					if (Armour[GetItemProperties(pObj->usItem).ubClassIndex].ubArmourClass != ARMOURCLASS_VEST)
 					{
 						return( FALSE );
 					}
 					break;
 				case HELMETPOS:
-					if (Armour[GCM->getItem(pObj->usItem)->getClassIndex()].ubArmourClass != ARMOURCLASS_HELMET)
+					if (Armour[GetItemProperties(pObj->usItem).ubClassIndex].ubArmourClass != ARMOURCLASS_HELMET)
 					{
 						return( FALSE );
 					}
 					break;
 				case LEGPOS:
-					if (Armour[GCM->getItem(pObj->usItem)->getClassIndex()].ubArmourClass != ARMOURCLASS_LEGGINGS)
+					if (Armour[GetItemProperties(pObj->usItem).ubClassIndex].ubArmourClass != ARMOURCLASS_LEGGINGS)
 					{
 						return( FALSE );
 					}
@@ -2337,7 +2347,7 @@ BOOLEAN CanItemFitInPosition(SOLDIERTYPE* pSoldier, OBJECTTYPE* pObj, INT8 bPos,
 			break;
 		case HEAD1POS:
 		case HEAD2POS:
-			if (GCM->getItem(pObj->usItem)->getItemClass() != IC_FACE)
+			if (GetItemProperties(pObj->usItem).uiItemClass != IC_FACE)
 			{
 				return( FALSE );
 			}
@@ -2423,7 +2433,7 @@ BOOLEAN PlaceObject( SOLDIERTYPE * pSoldier, INT8 bPos, OBJECTTYPE * pObj )
 		}
 	}
 
-	if (GCM->getItem(pObj->usItem)->getItemClass() == IC_KEY) CollectKey(*pSoldier, *pObj);
+	if (GetItemProperties(pObj->usItem).uiItemClass == IC_KEY) CollectKey(*pSoldier, *pObj);
 
 	ubSlotLimit = ItemSlotLimit( pObj->usItem, bPos );
 
@@ -2475,10 +2485,10 @@ BOOLEAN PlaceObject( SOLDIERTYPE * pSoldier, INT8 bPos, OBJECTTYPE * pObj )
 	{
 		// replacement/reloading/merging/stacking
 		// keys have an additional check for key ID being the same
-		if ((pObj->usItem == pInSlot->usItem) && (GCM->getItem(pObj->usItem)->getItemClass() != IC_KEY ||
+		if ((pObj->usItem == pInSlot->usItem) && (GetItemProperties(pObj->usItem).uiItemClass != IC_KEY ||
 			pObj->ubKeyID == pInSlot->ubKeyID))
 		{
-			if (GCM->getItem(pObj->usItem)->getItemClass() == IC_MONEY)
+			if (GetItemProperties(pObj->usItem).uiItemClass == IC_MONEY)
 			{
 
 				UINT32 uiMoneyMax = MoneySlotLimit( bPos );
@@ -2529,10 +2539,10 @@ BOOLEAN PlaceObject( SOLDIERTYPE * pSoldier, INT8 bPos, OBJECTTYPE * pObj )
 		else
 		{
 			// replacement, unless reloading...
-			switch (GCM->getItem(pInSlot->usItem)->getItemClass())
+			switch (GetItemProperties(pInSlot->usItem).uiItemClass)
 			{
 				case IC_GUN:
-					if (GCM->getItem(pObj->usItem)->getItemClass() == IC_AMMO)
+					if (GetItemProperties(pObj->usItem).uiItemClass == IC_AMMO)
 					{
 						if (GCM->getWeapon(pInSlot->usItem)->matches(GCM->getItem(pObj->usItem)->asAmmo()->calibre))
 						{
@@ -2640,7 +2650,7 @@ static BOOLEAN InternalAutoPlaceObject(SOLDIERTYPE* pSoldier, OBJECTTYPE* pObj,
 			break;
 
 		case IC_ARMOUR:
-			switch (Armour[GCM->getItem(pObj->usItem)->getClassIndex()].ubArmourClass)
+			switch (Armour[GetItemProperties(pObj->usItem).ubClassIndex].ubArmourClass)
 			{
 				case ARMOURCLASS_VEST:
 					if (pSoldier->inv[VESTPOS].usItem == NONE)
@@ -2742,7 +2752,7 @@ static BOOLEAN InternalAutoPlaceObject(SOLDIERTYPE* pSoldier, OBJECTTYPE* pObj,
 	{
 		// Small items; don't allow stack/dumping for keys right now as that
 		// would require a bunch of functions for finding the same object by two values...
-		if ( ubPerSlot > 1 || GCM->getItem(pObj->usItem)->getItemClass() == IC_KEY || GCM->getItem(pObj->usItem)->getItemClass() == IC_MONEY )
+		if ( ubPerSlot > 1 || GetItemProperties(pObj->usItem).uiItemClass == IC_KEY || GetItemProperties(pObj->usItem).uiItemClass == IC_MONEY )
 		{
 			// First, look for slots with the same object, and dump into them.
 			bSlot = HANDPOS;
@@ -2755,7 +2765,7 @@ static BOOLEAN InternalAutoPlaceObject(SOLDIERTYPE* pSoldier, OBJECTTYPE* pObj,
 				}
 				if ( bSlot != bExcludeSlot )
 				{
-					if ( ( (GCM->getItem(pObj->usItem)->getItemClass() == IC_MONEY) && pSoldier->inv[ bSlot ].uiMoneyAmount < MoneySlotLimit( bSlot ) ) || (GCM->getItem(pObj->usItem)->getItemClass() != IC_MONEY && pSoldier->inv[bSlot].ubNumberOfObjects < ItemSlotLimit( pObj->usItem, bSlot ) ) )
+					if ( ( (GetItemProperties(pObj->usItem).uiItemClass == IC_MONEY) && pSoldier->inv[ bSlot ].uiMoneyAmount < MoneySlotLimit( bSlot ) ) || (GetItemProperties(pObj->usItem).uiItemClass != IC_MONEY && pSoldier->inv[bSlot].ubNumberOfObjects < ItemSlotLimit( pObj->usItem, bSlot ) ) )
 					{
 						// NEW: If in SKI, don't auto-place anything into a stackable slot that's currently hatched out!  Such slots
 						// will disappear in their entirety if sold/moved, causing anything added through here to vanish also!
@@ -2912,7 +2922,7 @@ UINT8 AddKeysToSlot(SOLDIERTYPE& s, INT8 const key_ring_pos, OBJECTTYPE const& k
 	KEY_ON_RING& keyring = s.pKeyRing[key_ring_pos];
 	if (keyring.ubNumber == 0) keyring.ubKeyID = key.ubKeyID;
 	// Only take what we can
-	UINT8 const n_added = MIN(key.ubNumberOfObjects, GCM->getItem(key.usItem)->getPerPocket() - keyring.ubNumber);
+	UINT8 const n_added = MIN(key.ubNumberOfObjects, GetItemProperties(key.usItem).ubPerPocket - keyring.ubNumber);
 	keyring.ubNumber += n_added;
 	return n_added;
 }
@@ -3165,11 +3175,11 @@ void CreateItem(UINT16 const usItem, INT8 const bStatus, OBJECTTYPE* const pObj)
 		throw std::logic_error("Tried to create item with invalid ID");
 	}
 
-	if (GCM->getItem(usItem)->getItemClass() == IC_GUN)
+	if (GetItemProperties(usItem).uiItemClass == IC_GUN)
 	{
 		CreateGun( usItem, bStatus, pObj );
 	}
-	else if (GCM->getItem(usItem)->getItemClass() == IC_AMMO)
+	else if (GetItemProperties(usItem).uiItemClass == IC_AMMO)
 	{
 		CreateMagazine(usItem, pObj);
 	}
@@ -3191,7 +3201,7 @@ void CreateItem(UINT16 const usItem, INT8 const bStatus, OBJECTTYPE* const pObj)
 		pObj->ubWeight = CalculateObjectWeight( pObj );
 	}
 
-	if (GCM->getItem(usItem)->getFlags() & ITEM_DEFAULT_UNDROPPABLE)
+	if (GetItemProperties(usItem).fFlags & ITEM_DEFAULT_UNDROPPABLE)
 	{
 		pObj->fFlags |= OBJECT_UNDROPPABLE;
 	}
@@ -3380,7 +3390,7 @@ BOOLEAN RemoveAttachment( OBJECTTYPE * pObj, INT8 bAttachPos, OBJECTTYPE * pNewO
 		return( FALSE );
 	}
 
-	if ( GCM->getItem(pObj->usAttachItem[bAttachPos])->getFlags() & ITEM_INSEPARABLE )
+	if ( GetItemProperties(pObj->usAttachItem[bAttachPos]).fFlags & ITEM_INSEPARABLE )
 	{
 		return( FALSE );
 	}
@@ -3438,7 +3448,7 @@ BOOLEAN PlaceObjectInSoldierProfile( UINT8 ubProfile, OBJECTTYPE *pObject )
 	bStatus = pObject->bStatus[0];
 	SOLDIERTYPE* const pSoldier = FindSoldierByProfileID(ubProfile);
 
-	if ( GCM->getItem(usItem)->getItemClass() == IC_MONEY && gMercProfiles[ ubProfile ].uiMoney > 0 )
+	if ( GetItemProperties(usItem).uiItemClass == IC_MONEY && gMercProfiles[ ubProfile ].uiMoney > 0 )
 	{
 		gMercProfiles[ ubProfile ].uiMoney += pObject->uiMoneyAmount;
 		SetMoneyInSoldierProfile( ubProfile, gMercProfiles[ ubProfile ].uiMoney );
@@ -3451,7 +3461,7 @@ BOOLEAN PlaceObjectInSoldierProfile( UINT8 ubProfile, OBJECTTYPE *pObject )
 		{
 
 			// CJC: Deal with money by putting money into # stored in profile
-			if ( GCM->getItem(usItem)->getItemClass() == IC_MONEY )
+			if ( GetItemProperties(usItem).uiItemClass == IC_MONEY )
 			{
 				gMercProfiles[ ubProfile ].uiMoney += pObject->uiMoneyAmount;
 				// change any gold/silver to money
@@ -3612,12 +3622,12 @@ static INT8 CheckItemForDamage(UINT16 usItem, INT32 iMaxDamage)
 
 	// if the item is protective armour, reduce the amount of damage
 	// by its armour value
-	if (GCM->getItem(usItem)->getItemClass() == IC_ARMOUR)
+	if (GetItemProperties(usItem).uiItemClass == IC_ARMOUR)
 	{
-		iMaxDamage -= (iMaxDamage * Armour[GCM->getItem(usItem)->getClassIndex()].ubProtection) / 100;
+		iMaxDamage -= (iMaxDamage * Armour[GetItemProperties(usItem).ubClassIndex].ubProtection) / 100;
 	}
 	// metal items are tough and will be damaged less
-	if (GCM->getItem(usItem)->getFlags() & ITEM_METAL)
+	if (GetItemProperties(usItem).fFlags & ITEM_METAL)
 	{
 		iMaxDamage /= 2;
 	}
@@ -3637,7 +3647,7 @@ static BOOLEAN CheckForChainReaction(UINT16 usItem, INT8 bStatus, INT8 bDamage,
 {
 	INT32 iChance;
 
-	iChance = Explosive[GCM->getItem(usItem)->getClassIndex()].ubVolatility;
+	iChance = Explosive[GetItemProperties(usItem).ubClassIndex].ubVolatility;
 	if (iChance > 0)
 	{
 
@@ -3665,7 +3675,7 @@ static BOOLEAN DamageItem(OBJECTTYPE* pObject, INT32 iDamage, BOOLEAN fOnGround)
 	INT8 bLoop;
 	INT8 bDamage;
 
-	if ( (GCM->getItem(pObject->usItem)->getFlags() & ITEM_DAMAGEABLE || GCM->getItem(pObject->usItem)->getItemClass() == IC_AMMO) && pObject->ubNumberOfObjects > 0)
+	if ( (GetItemProperties(pObject->usItem).fFlags & ITEM_DAMAGEABLE || GetItemProperties(pObject->usItem).uiItemClass == IC_AMMO) && pObject->ubNumberOfObjects > 0)
 	{
 
 		for (bLoop = 0; bLoop < pObject->ubNumberOfObjects; bLoop++)
@@ -3690,7 +3700,7 @@ static BOOLEAN DamageItem(OBJECTTYPE* pObject, INT32 iDamage, BOOLEAN fOnGround)
 					default:
 						break;
 				}
-				if ( GCM->getItem(pObject->usItem)->getItemClass() == IC_AMMO  )
+				if ( GetItemProperties(pObject->usItem).uiItemClass == IC_AMMO  )
 				{
 					if ( PreRandom( 100 ) < (UINT32) bDamage )
 					{
@@ -3879,7 +3889,7 @@ void WaterDamage(SOLDIERTYPE& s)
 		FOR_EACH_SOLDIER_INV_SLOT(i, s)
 		{
 			// if there's an item here that can get water damaged...
-			if (i->usItem && GCM->getItem(i->usItem)->getFlags() & ITEM_WATER_DAMAGES)
+			if (i->usItem && GetItemProperties(i->usItem).fFlags & ITEM_WATER_DAMAGES)
 			{
 				// roll the 'ol 100-sided dice
 				uiRoll = PreRandom(100);
@@ -4126,11 +4136,12 @@ void ActivateXRayDevice( SOLDIERTYPE * pSoldier )
 		}
 	}
 	// now turn on xray for anyone within range
-	FOR_EACH_MERC(i)
+	SOLDIERTYPE* nearby[TOTAL_SOLDIERS];
+	UINT const n = FindSoldiersNear(pSoldier->sGridNo, XRAY_RANGE - 1, nearby);
+	for (UINT i = 0; i != n; ++i)
 	{
-		SOLDIERTYPE* const tgt = *i;
-		if (tgt->bTeam != pSoldier->bTeam &&
-			PythSpacesAway(pSoldier->sGridNo, tgt->sGridNo) < XRAY_RANGE)
+		SOLDIERTYPE* const tgt = nearby[i];
+		if (tgt->bTeam != pSoldier->bTeam)
 		{
 			tgt->ubMiscSoldierFlags |= SOLDIER_MISC_XRAYED;
 			tgt->xrayed_by           = pSoldier;
@@ -11,6 +11,32 @@ struct CalibreModel;
 struct ItemModel;
 struct WeaponModel;
 
+/* The item model properties the inventory code and the AI ask for again and
+ * again, in a dense table by item index. It saves the content manager lookup
+ * and the virtual call of the model. */
+struct ItemProperties
+{
+	UINT32 uiItemClass;
+	UINT16 fFlags;
+	UINT8  ubClassIndex;
+	UINT8  ubWeight;
+	UINT8  ubPerPocket;
+	INT8   bReliability;
+};
+
+extern ItemProperties g_item_properties[MAXITEMS];
+
+static inline ItemProperties const& GetItemProperties(UINT16 const item)
+{
+	return g_item_properties[item];
+}
+
+/* Fills in the item properties and the tables of which items can be attached
+ * to, launched from or worn together with which, from the item models and the
+ * game policy. Must be called after the content is loaded and before any of
+ * the functions here are used. */
+void InitItemTables();
+
 void DamageObj(OBJECTTYPE* pObj, INT8 bAmount);
 
 extern UINT8 SlotToPocket[7];
@@ -33,6 +33,7 @@
 #include "MapScreen.h"
 #include "Game_Clock.h"
 #include "Handle_Doors.h"
+#include "PathAI.h"
 #include "Map_Screen_Interface.h"
 #include "MemMan.h"
 #include "FileMan.h"
@@ -825,7 +826,7 @@ void SaveDoorTableToDoorTableTempFile(INT16 const x, INT16 const y, INT8 const z
 {
 	char map_name[128];
 	GetMapTempFileName(SF_DOOR_TABLE_TEMP_FILES_EXISTS, map_name, x, y, z);
-	AutoSGPFile f(FileMan::openForWriting(map_name));
+	AutoSGPFile f(GCM->openTempFileForWriting(map_name, true));
 	FileWriteArray(f, gubNumDoors, DoorTable);
 	// Set the sector flag indicating that there is a Door table temp file present
 	SetSectorFlag(x, y, z, SF_DOOR_TABLE_TEMP_FILES_EXISTS);
@@ -841,12 +842,12 @@ void LoadDoorTableFromDoorTableTempFile()
 	GetMapTempFileName( SF_DOOR_TABLE_TEMP_FILES_EXISTS, zMapName, gWorldSectorX, gWorldSectorY, gbWorldSectorZ );
 
 	//If the file doesnt exists, its no problem.
-	if (!GCM->doesGameResExists(zMapName)) return;
+	if (!GCM->doesTempFileExist(zMapName)) return;
 
 	//Get rid of the existing door table
 	TrashDoorTable();
 
-	AutoSGPFile hFile(GCM->openGameResForReading(zMapName));
+	AutoSGPFile hFile(GCM->openTempFileForReading(zMapName));
 
 	//Read in the number of doors
 	FileRead(hFile, &gubMaxDoors, sizeof(UINT8));
@@ -873,6 +874,9 @@ bool ModifyDoorStatus(GridNo const gridno, BOOLEAN const is_open, BOOLEAN const
 	if (!base) return false;
 	GridNo const base_gridno = base->sGridNo;
 
+	// Paths for the player depend on the perceived status
+	InvalidatePathCache();
+
 	// Check to see if the user is adding an existing door
 	FOR_EACH_DOOR_STATUS(i)
 	{
@@ -940,6 +944,7 @@ void TrashDoorStatusArray( )
 	}
 
 	gubNumDoorStatus = 0;
+	InvalidatePathCache();
 }
 
 
@@ -1062,6 +1067,8 @@ static void SynchronizeDoorStatusToStructureData(DOOR_STATUS const& d)
 
 void UpdateDoorGraphicsFromStatus()
 {
+	// The doors of a room are near each other, so compile their tiles only once
+	MovementCostBatch batch;
 	FOR_EACH_DOOR_STATUS(i)
 	{
 		DOOR_STATUS const& d = *i;
@@ -1194,6 +1201,7 @@ static void InternalUpdateDoorsPerceivedValue(DOOR_STATUS& d)
 	// Set perceived value the same as actual
 	d.ubFlags &= ~(DOOR_PERCEIVED_NOTSET | DOOR_PERCEIVED_OPEN);
 	d.ubFlags |= (d.ubFlags & DOOR_OPEN ? DOOR_PERCEIVED_OPEN : 0);
+	InvalidatePathCache();
 }
 
 
@@ -1204,7 +1212,7 @@ void SaveDoorStatusArrayToDoorStatusTempFile(INT16 const x, INT16 const y, INT8
 
 	char map_name[128];
 	GetMapTempFileName(SF_DOOR_STATUS_TEMP_FILE_EXISTS, map_name, x, y, z);
-	AutoSGPFile f(FileMan::openForWriting(map_name));
+	AutoSGPFile f(GCM->openTempFileForWriting(map_name, true));
 	FileWriteArray(f, gubNumDoorStatus, gpDoorStatus);
 
 	// Set the flag indicating that there is a door status array
@@ -1218,7 +1226,7 @@ void LoadDoorStatusArrayFromDoorStatusTempFile()
 
 	char map_name[128];
 	GetMapTempFileName(SF_DOOR_STATUS_TEMP_FILE_EXISTS, map_name, gWorldSectorX, gWorldSectorY, gbWorldSectorZ);
-	AutoSGPFile f(GCM->openGameResForReading(map_name));
+	AutoSGPFile f(GCM->openTempFileForReading(map_name));
 
 	// Load the number of elements in the door status array
 	FileRead(f, &gubNumDoorStatus, sizeof(UINT8));
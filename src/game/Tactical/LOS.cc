@@ -25,12 +25,14 @@
 #include "Campaign.h"
 #include "Environment.h"
 #include "PathAI.h"
+#include "Profiler.h"
 #include "Soldier_Macros.h"
 #include "StrategicMap.h"
 #include "Quests.h"
 #include "Interface.h"
 #include "Points.h"
 #include "Smell.h"
+#include "SmokeEffects.h"
 #include "Text.h"
 
 #include "CalibreModel.h"
@@ -38,6 +40,9 @@
 #include "GameInstance.h"
 #include "WeaponModels.h"
 #include "Logger.h"
+#include "WorkerPool.h"
+
+#include <vector>
 
 #define STEPS_FOR_BULLET_MOVE_TRAILS				10
 #define STEPS_FOR_BULLET_MOVE_SMALL_TRAILS			5
@@ -165,16 +170,18 @@ static const UINT32 guiStructureHitChance[MAX_DIST_FOR_LESS_THAN_MAX_CHANCE_TO_H
 
 // MoveBullet and ChanceToGetThrough use this array to maintain which
 // of which structures in a tile might be hit by a bullet.
+// There is one per thread, as chances to get through are traced on the worker
+// threads, too.
 
 #define MAX_LOCAL_STRUCTURES					20
 
-static STRUCTURE* gpLocalStructure[MAX_LOCAL_STRUCTURES];
-static UINT32     guiLocalStructureCTH[MAX_LOCAL_STRUCTURES];
-static UINT8      gubLocalStructureNumTimesHit[MAX_LOCAL_STRUCTURES];
+static thread_local STRUCTURE* gpLocalStructure[MAX_LOCAL_STRUCTURES];
+static thread_local UINT32     guiLocalStructureCTH[MAX_LOCAL_STRUCTURES];
+static thread_local UINT8      gubLocalStructureNumTimesHit[MAX_LOCAL_STRUCTURES];
 
 
 #ifdef LOS_DEBUG
-LOSResults gLOSTestResults = {0};
+thread_local LOSResults gLOSTestResults = {0};
 #endif
 
 
@@ -588,6 +595,8 @@ static INT32 LineOfSightTest(GridNo start_pos, FLOAT dStartZ, GridNo end_pos, FL
 
 	// Now returns not a boolean but the adjusted (by cover) distance to the target, or 0 for unseen
 
+	ProfilerCount(PROFILE_LOS_TESTS, 1);
+
 	FIXEDPT qCurrX;
 	FIXEDPT qCurrY;
 	FIXEDPT qCurrZ;
@@ -1003,6 +1012,11 @@ static INT32 LineOfSightTest(GridNo start_pos, FLOAT dStartZ, GridNo end_pos, FL
 						sDesiredLevel = STRUCTURE_ON_ROOF;
 						iCurrCubesAboveLevelZ -= STRUCTURE_ON_ROOF;
 					}
+					// skip the structures if none of them occupies this voxel
+					if (!(gTileVoxels[iGridNo].opaque[sDesiredLevel / PROFILE_Z_SIZE][iCurrCubesAboveLevelZ] & VOXEL_COLUMN(bLOSIndexX, bLOSIndexY)))
+					{
+						pStructure = NULL;
+					}
 					// check structures for collision
 					while (pStructure != NULL)
 					{
@@ -1607,6 +1621,144 @@ INT32 SoldierToSoldierLineOfSightTest(const SOLDIERTYPE* const pStartSoldier, co
 	return LineOfSightTest(pStartSoldier->sGridNo, dStartZPos, pEndSoldier->sGridNo, dEndZPos, ubTileSightLimit, ubTreeReduction, bAware, bEffectiveCamo, fSmell, NULL);
 }
 
+
+// What SoldierToSoldierLineOfSightTest() looks at of each soldier
+struct SightState
+{
+	INT16 sGridNo;
+	INT8  bLevel;
+	INT8  bTeam;
+	UINT8 ubBodyType;
+	UINT8 ubHeight;
+	INT8  bOverTerrainType;
+	INT8  bCamo;
+	INT8  bTilesMoved;
+};
+
+struct SightCacheEntry
+{
+	SightState looker;
+	SightState target;
+	UINT32     uiOpaqueStructuresVersion;
+	UINT32     uiSmokeEffectsVersion;
+	UINT8      ubTileSightLimit;
+	INT8       bAware;
+	bool       fValid;
+	INT32      iResult;
+};
+
+static SightCacheEntry gSightCache[TOTAL_SOLDIERS][TOTAL_SOLDIERS];
+
+
+static SightState GetSightState(SOLDIERTYPE const& s)
+{
+	SightState st;
+	st.sGridNo          = s.sGridNo;
+	st.bLevel           = s.bLevel;
+	st.bTeam            = s.bTeam;
+	st.ubBodyType       = s.ubBodyType;
+	st.ubHeight         = gAnimControl[s.usAnimState].ubEndHeight;
+	st.bOverTerrainType = s.bOverTerrainType;
+	st.bCamo            = s.bCamo;
+	st.bTilesMoved      = s.bTilesMoved;
+	return st;
+}
+
+
+static bool SightStatesEqual(SightState const& a, SightState const& b)
+{
+	return
+		a.sGridNo          == b.sGridNo          &&
+		a.bLevel           == b.bLevel           &&
+		a.bTeam            == b.bTeam            &&
+		a.ubBodyType       == b.ubBodyType       &&
+		a.ubHeight         == b.ubHeight         &&
+		a.bOverTerrainType == b.bOverTerrainType &&
+		a.bCamo            == b.bCamo            &&
+		a.bTilesMoved      == b.bTilesMoved;
+}
+
+
+// The cache entry for the test, or NULL if it holds the result already
+static SightCacheEntry* SightCacheMiss(SOLDIERTYPE const& looker, SOLDIERTYPE const& target, UINT8 const ubTileSightLimit, INT8 const bAware)
+{
+	SightCacheEntry& e = gSightCache[looker.ubID][target.ubID];
+	if (e.fValid                                                  &&
+		e.uiOpaqueStructuresVersion == guiOpaqueStructuresVersion &&
+		e.uiSmokeEffectsVersion     == guiSmokeEffectsVersion     &&
+		e.ubTileSightLimit          == ubTileSightLimit           &&
+		e.bAware                    == bAware                     &&
+		SightStatesEqual(e.looker, GetSightState(looker))         &&
+		SightStatesEqual(e.target, GetSightState(target)))
+	{
+		return NULL;
+	}
+	return &e;
+}
+
+
+static void StoreSightCacheEntry(SightCacheEntry& e, SOLDIERTYPE const& looker, SOLDIERTYPE const& target, UINT8 const ubTileSightLimit, INT8 const bAware, INT32 const iResult)
+{
+	e.looker                    = GetSightState(looker);
+	e.target                    = GetSightState(target);
+	e.uiOpaqueStructuresVersion = guiOpaqueStructuresVersion;
+	e.uiSmokeEffectsVersion     = guiSmokeEffectsVersion;
+	e.ubTileSightLimit          = ubTileSightLimit;
+	e.bAware                    = bAware;
+	e.iResult                   = iResult;
+	e.fValid                    = true;
+}
+
+
+INT32 CachedSoldierToSoldierLineOfSightTest(SOLDIERTYPE const* const pStartSoldier, SOLDIERTYPE const* const pEndSoldier, UINT8 const ubTileSightLimit, INT8 const bAware)
+{
+	// the flag is only set for a moment, not worth a cache entry
+	if (gTacticalStatus.uiFlags & DISALLOW_SIGHT)
+	{
+		return SoldierToSoldierLineOfSightTest(pStartSoldier, pEndSoldier, ubTileSightLimit, bAware);
+	}
+
+	SightCacheEntry* const e = SightCacheMiss(*pStartSoldier, *pEndSoldier, ubTileSightLimit, bAware);
+	if (!e) return gSightCache[pStartSoldier->ubID][pEndSoldier->ubID].iResult;
+
+	INT32 const iResult = SoldierToSoldierLineOfSightTest(pStartSoldier, pEndSoldier, ubTileSightLimit, bAware);
+	StoreSightCacheEntry(*e, *pStartSoldier, *pEndSoldier, ubTileSightLimit, bAware, iResult);
+	return iResult;
+}
+
+
+static void SightQueryJob(UINT const i, void* const ctx)
+{
+	SightQuery& q = static_cast<SightQuery*>(ctx)[i];
+	q.iResult = SoldierToSoldierLineOfSightTest(q.looker, q.target, q.ubTileSightLimit, q.bAware);
+}
+
+
+void SoldierToSoldierLineOfSightTests(SightQuery* const queries, UINT const n)
+{
+	RunParallel(n, SightQueryJob, queries);
+}
+
+
+void PrefetchSoldierToSoldierLineOfSightTests(SightQuery const* const queries, UINT const n)
+{
+	if (gTacticalStatus.uiFlags & DISALLOW_SIGHT) return;
+
+	std::vector<SightQuery> misses;
+	for (SightQuery const* q = queries; q != queries + n; ++q)
+	{
+		if (SightCacheMiss(*q->looker, *q->target, q->ubTileSightLimit, q->bAware)) misses.push_back(*q);
+	}
+	SoldierToSoldierLineOfSightTests(misses.data(), (UINT)misses.size());
+
+	// Stored in order, so a pair given twice ends up the same every time
+	for (SightQuery const& q : misses)
+	{
+		SightCacheEntry& e = gSightCache[q.looker->ubID][q.target->ubID];
+		StoreSightCacheEntry(e, *q.looker, *q.target, q.ubTileSightLimit, q.bAware, q.iResult);
+	}
+}
+
 INT16 SoldierToLocationWindowTest(const SOLDIERTYPE* pStartSoldier, INT16 sEndGridNo)
 {
 	// figure out if there is a SINGLE window between the looker and target
@@ -2733,8 +2885,11 @@ static UINT8 CalcChanceToGetThrough(BULLET* pBullet)
 						sDesiredLevel = STRUCTURE_ON_ROOF;
 						iCurrCubesAboveLevelZ -= STRUCTURE_ON_ROOF;
 					}
+					// skip the structures if none of them occupies this voxel
+					UINT32 const occupied = gTileVoxels[iGridNo].occupied[sDesiredLevel / PROFILE_Z_SIZE][iCurrCubesAboveLevelZ];
+					iStructureLoop = occupied & VOXEL_COLUMN(pBullet->bLOSIndexX, pBullet->bLOSIndexY) ? 0 : iNumLocalStructures;
 					// check structures for collision
-					for ( iStructureLoop = 0; iStructureLoop < iNumLocalStructures; iStructureLoop++)
+					for ( ; iStructureLoop < iNumLocalStructures; iStructureLoop++)
 					{
 						pStructure = gpLocalStructure[iStructureLoop];
 						if (pStructure && pStructure->sCubeOffset == sDesiredLevel)
@@ -2885,46 +3040,58 @@ static UINT8 CalcChanceToGetThrough(BULLET* pBullet)
 }
 
 
-static INT8 ChanceToGetThrough(SOLDIERTYPE* pFirer, GridNo end_pos, FLOAT dEndZ);
+static void PrepareChanceToGetThrough(CTGTQuery&, SOLDIERTYPE* pFirer, GridNo end_pos, FLOAT dEndZ, const SOLDIERTYPE* target);
+static UINT8 TraceChanceToGetThrough(CTGTQuery const&);
+static UINT8 CachedTraceChanceToGetThrough(CTGTQuery const&);
 
 
-static UINT8 SoldierToSoldierChanceToGetThrough(SOLDIERTYPE* const pStartSoldier, const SOLDIERTYPE* const pEndSoldier)
+static void PrepareSoldierToSoldierChanceToGetThrough(CTGTQuery& q, SOLDIERTYPE* const pStartSoldier, const SOLDIERTYPE* const pEndSoldier)
 {
 	FLOAT dEndZPos;
 	BOOLEAN fOk;
 
+	q = CTGTQuery{};
 	if (pStartSoldier == pEndSoldier)
 	{
-		return( 0 );
+		return;
 	}
-	CHECKF( pStartSoldier );
-	CHECKF( pEndSoldier );
+	CHECKV( pStartSoldier );
+	CHECKV( pEndSoldier );
 	fOk = CalculateSoldierZPos( pEndSoldier, TARGET_POS, &dEndZPos );
 	if (!fOk)
 	{
-		return( FALSE );
+		return;
 	}
 
 	// set startsoldier's target ID ... need an ID stored in case this
 	// is the AI calculating cover to a location where he might not be any more
 	pStartSoldier->CTGTTarget = pEndSoldier;
-	return ChanceToGetThrough(pStartSoldier, pEndSoldier->sGridNo, dEndZPos);
+	PrepareChanceToGetThrough(q, pStartSoldier, pEndSoldier->sGridNo, dEndZPos, pEndSoldier);
 }
 
 
-UINT8 SoldierToSoldierBodyPartChanceToGetThrough(SOLDIERTYPE* const pStartSoldier, const SOLDIERTYPE* const pEndSoldier, const UINT8 ubAimLocation)
+static UINT8 SoldierToSoldierChanceToGetThrough(SOLDIERTYPE* const pStartSoldier, const SOLDIERTYPE* const pEndSoldier)
+{
+	CTGTQuery q;
+	PrepareSoldierToSoldierChanceToGetThrough(q, pStartSoldier, pEndSoldier);
+	return TraceChanceToGetThrough(q);
+}
+
+
+static void PrepareSoldierToSoldierBodyPartChanceToGetThrough(CTGTQuery& q, SOLDIERTYPE* const pStartSoldier, const SOLDIERTYPE* const pEndSoldier, const UINT8 ubAimLocation)
 {
 	// does like StS-CTGT but with a particular body part in mind
 	FLOAT dEndZPos;
 	BOOLEAN fOk;
 	UINT8 ubPosType;
 
+	q = CTGTQuery{};
 	if (pStartSoldier == pEndSoldier)
 	{
-		return( 0 );
+		return;
 	}
-	CHECKF( pStartSoldier );
-	CHECKF( pEndSoldier );
+	CHECKV( pStartSoldier );
+	CHECKV( pEndSoldier );
 	switch( ubAimLocation )
 	{
 		case AIM_SHOT_HEAD:
@@ -2944,30 +3111,47 @@ UINT8 SoldierToSoldierBodyPartChanceToGetThrough(SOLDIERTYPE* const pStartSoldie
 	fOk = CalculateSoldierZPos( pEndSoldier, ubPosType, &dEndZPos );
 	if (!fOk)
 	{
-		return( FALSE );
+		return;
 	}
 
 	// set startsoldier's target ID ... need an ID stored in case this
 	// is the AI calculating cover to a location where he might not be any more
 	pStartSoldier->CTGTTarget = pEndSoldier;
-	return ChanceToGetThrough(pStartSoldier, pEndSoldier->sGridNo, dEndZPos);
+	PrepareChanceToGetThrough(q, pStartSoldier, pEndSoldier->sGridNo, dEndZPos, pEndSoldier);
 }
 
 
-UINT8 SoldierToLocationChanceToGetThrough(SOLDIERTYPE* const pStartSoldier, const INT16 sGridNo, const INT8 bLevel, const INT8 bCubeLevel, const SOLDIERTYPE* const target)
+UINT8 SoldierToSoldierBodyPartChanceToGetThrough(SOLDIERTYPE* const pStartSoldier, const SOLDIERTYPE* const pEndSoldier, const UINT8 ubAimLocation)
+{
+	CTGTQuery q;
+	PrepareSoldierToSoldierBodyPartChanceToGetThrough(q, pStartSoldier, pEndSoldier, ubAimLocation);
+	return TraceChanceToGetThrough(q);
+}
+
+
+UINT8 CachedSoldierToSoldierBodyPartChanceToGetThrough(SOLDIERTYPE* const pStartSoldier, const SOLDIERTYPE* const pEndSoldier, const UINT8 ubAimLocation)
+{
+	CTGTQuery q;
+	PrepareSoldierToSoldierBodyPartChanceToGetThrough(q, pStartSoldier, pEndSoldier, ubAimLocation);
+	return CachedTraceChanceToGetThrough(q);
+}
+
+
+void PrepareSoldierToLocationChanceToGetThrough(CTGTQuery& q, SOLDIERTYPE* const pStartSoldier, const INT16 sGridNo, const INT8 bLevel, const INT8 bCubeLevel, const SOLDIERTYPE* const target)
 {
 	FLOAT dEndZPos;
 
+	q = CTGTQuery{};
 	if (pStartSoldier->sGridNo == sGridNo)
 	{
-		return( 0 );
+		return;
 	}
-	CHECKF( pStartSoldier );
+	CHECKV( pStartSoldier );
 
 	const SOLDIERTYPE* const pEndSoldier = WhoIsThere2(sGridNo, bLevel);
 	if (pEndSoldier != NULL)
 	{
-		return( SoldierToSoldierChanceToGetThrough( pStartSoldier, pEndSoldier ) );
+		PrepareSoldierToSoldierChanceToGetThrough(q, pStartSoldier, pEndSoldier);
 	}
 	else
 	{
@@ -2996,29 +3180,45 @@ UINT8 SoldierToLocationChanceToGetThrough(SOLDIERTYPE* const pStartSoldier, cons
 		// set startsoldier's target ID ... need an ID stored in case this
 		// is the AI calculating cover to a location where he might not be any more
 		pStartSoldier->CTGTTarget = target;
-		return ChanceToGetThrough(pStartSoldier, sGridNo, dEndZPos);
+		PrepareChanceToGetThrough(q, pStartSoldier, sGridNo, dEndZPos, target);
 	}
 }
 
 
-UINT8 AISoldierToSoldierChanceToGetThrough(SOLDIERTYPE* const pStartSoldier, const SOLDIERTYPE* const pEndSoldier)
+UINT8 SoldierToLocationChanceToGetThrough(SOLDIERTYPE* const pStartSoldier, const INT16 sGridNo, const INT8 bLevel, const INT8 bCubeLevel, const SOLDIERTYPE* const target)
+{
+	CTGTQuery q;
+	PrepareSoldierToLocationChanceToGetThrough(q, pStartSoldier, sGridNo, bLevel, bCubeLevel, target);
+	return TraceChanceToGetThrough(q);
+}
+
+
+UINT8 CachedSoldierToLocationChanceToGetThrough(SOLDIERTYPE* const pStartSoldier, const INT16 sGridNo, const INT8 bLevel, const INT8 bCubeLevel, const SOLDIERTYPE* const target)
+{
+	CTGTQuery q;
+	PrepareSoldierToLocationChanceToGetThrough(q, pStartSoldier, sGridNo, bLevel, bCubeLevel, target);
+	return CachedTraceChanceToGetThrough(q);
+}
+
+
+void PrepareAISoldierToSoldierChanceToGetThrough(CTGTQuery& q, SOLDIERTYPE* const pStartSoldier, const SOLDIERTYPE* const pEndSoldier)
 {
 	// Like a standard CTGT algorithm BUT fakes the start soldier at standing height
 	FLOAT dEndZPos;
 	BOOLEAN fOk;
-	UINT8 ubChance;
 	UINT16 usTrueState;
 
+	q = CTGTQuery{};
 	if (pStartSoldier == pEndSoldier)
 	{
-		return( 0 );
+		return;
 	}
-	CHECKF( pStartSoldier );
-	CHECKF( pEndSoldier );
+	CHECKV( pStartSoldier );
+	CHECKV( pEndSoldier );
 	fOk = CalculateSoldierZPos( pEndSoldier, TARGET_POS, &dEndZPos );
 	if (!fOk)
 	{
-		return( FALSE );
+		return;
 	}
 	usTrueState = pStartSoldier->usAnimState;
 	pStartSoldier->usAnimState = STANDING;
@@ -3027,28 +3227,36 @@ UINT8 AISoldierToSoldierChanceToGetThrough(SOLDIERTYPE* const pStartSoldier, con
 	// is the AI calculating cover to a location where he might not be any more
 	pStartSoldier->CTGTTarget = NULL;
 
-	ubChance = ChanceToGetThrough(pStartSoldier, pEndSoldier->sGridNo, dEndZPos);
+	PrepareChanceToGetThrough(q, pStartSoldier, pEndSoldier->sGridNo, dEndZPos, NULL);
 	pStartSoldier->usAnimState = usTrueState;
-	return( ubChance );
 }
 
-UINT8 AISoldierToLocationChanceToGetThrough( SOLDIERTYPE * pStartSoldier, INT16 sGridNo, INT8 bLevel, INT8 bCubeLevel )
+
+UINT8 AISoldierToSoldierChanceToGetThrough(SOLDIERTYPE* const pStartSoldier, const SOLDIERTYPE* const pEndSoldier)
+{
+	CTGTQuery q;
+	PrepareAISoldierToSoldierChanceToGetThrough(q, pStartSoldier, pEndSoldier);
+	return TraceChanceToGetThrough(q);
+}
+
+
+void PrepareAISoldierToLocationChanceToGetThrough(CTGTQuery& q, SOLDIERTYPE* const pStartSoldier, const INT16 sGridNo, const INT8 bLevel, const INT8 bCubeLevel)
 {
 	FLOAT dEndZPos;
 
 	UINT16 usTrueState;
-	UINT8 ubChance;
 
+	q = CTGTQuery{};
 	if (pStartSoldier->sGridNo == sGridNo)
 	{
-		return( 0 );
+		return;
 	}
-	CHECKF( pStartSoldier );
+	CHECKV( pStartSoldier );
 
 	const SOLDIERTYPE* const pEndSoldier = WhoIsThere2(sGridNo, bLevel);
 	if (pEndSoldier != NULL)
 	{
-		return( AISoldierToSoldierChanceToGetThrough( pStartSoldier, pEndSoldier ) );
+		PrepareAISoldierToSoldierChanceToGetThrough(q, pStartSoldier, pEndSoldier);
 	}
 	else
 	{
@@ -3081,15 +3289,34 @@ UINT8 AISoldierToLocationChanceToGetThrough( SOLDIERTYPE * pStartSoldier, INT16
 		usTrueState = pStartSoldier->usAnimState;
 		pStartSoldier->usAnimState = STANDING;
 
-		ubChance = ChanceToGetThrough(pStartSoldier, sGridNo, dEndZPos);
+		PrepareChanceToGetThrough(q, pStartSoldier, sGridNo, dEndZPos, NULL);
 
 		pStartSoldier->usAnimState = usTrueState;
-
-		return( ubChance );
 	}
 }
 
 
+UINT8 AISoldierToLocationChanceToGetThrough(SOLDIERTYPE* const pStartSoldier, const INT16 sGridNo, const INT8 bLevel, const INT8 bCubeLevel)
+{
+	CTGTQuery q;
+	PrepareAISoldierToLocationChanceToGetThrough(q, pStartSoldier, sGridNo, bLevel, bCubeLevel);
+	return TraceChanceToGetThrough(q);
+}
+
+
+static void CTGTQueryJob(UINT const i, void* const ctx)
+{
+	CTGTQuery& q = static_cast<CTGTQuery*>(ctx)[i];
+	if (q.fTrace) q.ubChance = TraceChanceToGetThrough(q);
+}
+
+
+void ChanceToGetThroughTests(CTGTQuery* const queries, UINT const n)
+{
+	RunParallel(n, CTGTQueryJob, queries);
+}
+
+
 static void CalculateFiringIncrements(DOUBLE ddHorizAngle, DOUBLE ddVerticAngle, DOUBLE dd2DDistance, BULLET* pBullet, DOUBLE* pddNewHorizAngle, DOUBLE* pddNewVerticAngle)
 {
 	INT32 iMissedBy = - pBullet->sHitBy;
@@ -3194,7 +3421,7 @@ static INT8 FireBullet(BULLET* pBullet, BOOLEAN fFake)
 	SOLDIERTYPE* const pFirer = pBullet->pFirer;
 	if (fFake)
 	{
-		pBullet->target = pFirer->CTGTTarget;
+		// the target was set by the caller
 		return( CalcChanceToGetThrough( pBullet ) );
 	}
 	else
@@ -3239,11 +3466,11 @@ static INT8 FireBullet(BULLET* pBullet, BOOLEAN fFake)
 }
 
 
-INT8 FireBulletGivenTarget(SOLDIERTYPE* const pFirer, const FLOAT dEndX, const FLOAT dEndY, const FLOAT dEndZ, const UINT16 usHandItem, INT16 sHitBy, const BOOLEAN fBuckshot, const BOOLEAN fFake)
+/* Fires from the given position instead of the firer's, for chances to get
+ * through worked out beforehand. A fake bullet goes for fake_target. */
+static INT8 FireBulletFrom(SOLDIERTYPE* const pFirer, const GridNo sStartGridNo, const FLOAT dStartZ, const FLOAT dEndX, const FLOAT dEndY, const FLOAT dEndZ, const UINT16 usHandItem, INT16 sHitBy, const BOOLEAN fBuckshot, const BOOLEAN fFake, const SOLDIERTYPE* const fake_target)
 {
 	// fFake indicates that we should set things up for a call to ChanceToGetThrough
-	FLOAT dStartZ;
-
 	FLOAT d2DDistance;
 	FLOAT dDeltaX;
 	FLOAT dDeltaY;
@@ -3270,10 +3497,8 @@ INT8 FireBulletGivenTarget(SOLDIERTYPE* const pFirer, const FLOAT dEndX, const F
 	UINT8 ubSpreadIndex = 0;
 	UINT16 usBulletFlags = 0;
 
-	CalculateSoldierZPos( pFirer, FIRING_POS, &dStartZ );
-
-	dStartX = (FLOAT) CenterX( pFirer->sGridNo );
-	dStartY = (FLOAT) CenterY( pFirer->sGridNo );
+	dStartX = (FLOAT) CenterX( sStartGridNo );
+	dStartY = (FLOAT) CenterY( sStartGridNo );
 
 	dDeltaX = dEndX - dStartX;
 	dDeltaY = dEndY - dStartY;
@@ -3350,11 +3575,27 @@ INT8 FireBulletGivenTarget(SOLDIERTYPE* const pFirer, const FLOAT dEndX, const F
 	// GET BULLET
 	for (ubLoop = 0; ubLoop < ubShots; ubLoop++)
 	{
-		BULLET* const pBullet = CreateBullet(pFirer, fFake, usBulletFlags);
-		if (pBullet == NULL)
+		// Fake bullets are kept off the list of bullets, so chances to get through
+		// can be traced on any thread
+		BULLET  fake_bullet;
+		BULLET* pBullet;
+		if (fFake)
+		{
+			fake_bullet            = BULLET{};
+			fake_bullet.fAllocated = TRUE;
+			fake_bullet.pFirer     = pFirer;
+			fake_bullet.usFlags    = usBulletFlags;
+			fake_bullet.fReal      = FALSE;
+			pBullet = &fake_bullet;
+		}
+		else
 		{
-			SLOGW("Failed to create bullet");
-			return FALSE;
+			pBullet = CreateBullet(pFirer, fFake, usBulletFlags);
+			if (pBullet == NULL)
+			{
+				SLOGW("Failed to create bullet");
+				return FALSE;
+			}
 		}
 		pBullet->sHitBy	= sHitBy;
 
@@ -3451,7 +3692,7 @@ INT8 FireBulletGivenTarget(SOLDIERTYPE* const pFirer, const FLOAT dEndX, const F
 		pBullet->iRange = GunRange(pFirer->inv[pFirer->ubAttackingHand]);
 		pBullet->sTargetGridNo = ((INT32)dEndX) / CELL_X_SIZE + ((INT32)dEndY) / CELL_Y_SIZE * WORLD_COLS;
 
-		pBullet->bStartCubesAboveLevelZ = (INT8) CONVERT_HEIGHTUNITS_TO_INDEX( (INT32)dStartZ - CONVERT_PIXELS_TO_HEIGHTUNITS( gpWorldLevelData[ pFirer->sGridNo ].sHeight ) );
+		pBullet->bStartCubesAboveLevelZ = (INT8) CONVERT_HEIGHTUNITS_TO_INDEX( (INT32)dStartZ - CONVERT_PIXELS_TO_HEIGHTUNITS( gpWorldLevelData[ sStartGridNo ].sHeight ) );
 		pBullet->bEndCubesAboveLevelZ = (INT8) CONVERT_HEIGHTUNITS_TO_INDEX( (INT32)dEndZ - CONVERT_PIXELS_TO_HEIGHTUNITS( gpWorldLevelData[ pBullet->sTargetGridNo ].sHeight ) );
 
 		// this distance limit only applies in a "hard" sense to fake bullets for chance-to-get-through,
@@ -3459,8 +3700,8 @@ INT8 FireBulletGivenTarget(SOLDIERTYPE* const pFirer, const FLOAT dEndX, const F
 		pBullet->iDistanceLimit = iDistance;
 		if (fFake)
 		{
+			pBullet->target = fake_target;
 			bCTGT = FireBullet(pBullet, TRUE);
-			RemoveBullet(pBullet);
 			return( bCTGT );
 		}
 		else
@@ -3473,10 +3714,32 @@ INT8 FireBulletGivenTarget(SOLDIERTYPE* const pFirer, const FLOAT dEndX, const F
 }
 
 
-static INT8 ChanceToGetThrough(SOLDIERTYPE* const pFirer, const GridNo end_pos, const FLOAT dEndZ)
+INT8 FireBulletGivenTarget(SOLDIERTYPE* const pFirer, const FLOAT dEndX, const FLOAT dEndY, const FLOAT dEndZ, const UINT16 usHandItem, const INT16 sHitBy, const BOOLEAN fBuckshot, const BOOLEAN fFake)
 {
-	UINT16  weapon = pFirer->usAttackingWeapon;
-	BOOLEAN buck_shot;
+	FLOAT dStartZ;
+	CalculateSoldierZPos( pFirer, FIRING_POS, &dStartZ );
+	return FireBulletFrom(pFirer, pFirer->sGridNo, dStartZ, dEndX, dEndY, dEndZ, usHandItem, sHitBy, fBuckshot, fFake, pFirer->CTGTTarget);
+}
+
+
+// Works out where the shot starts, which depends on the firer's position and stance
+static void PrepareChanceToGetThrough(CTGTQuery& q, SOLDIERTYPE* const pFirer, const GridNo end_pos, const FLOAT dEndZ, const SOLDIERTYPE* const target)
+{
+	q.firer        = pFirer;
+	q.target       = target;
+	q.sStartGridNo = pFirer->sGridNo;
+	q.dStartZ      = 0;
+	CalculateSoldierZPos(pFirer, FIRING_POS, &q.dStartZ);
+	q.sEndGridNo   = end_pos;
+	q.dEndZ        = dEndZ;
+	q.fTrace       = true;
+}
+
+
+// The weapon the fake bullet of a chance to get through trace is fired from
+static void GetChanceToGetThroughWeapon(SOLDIERTYPE const* const pFirer, UINT16& weapon, BOOLEAN& buck_shot)
+{
+	weapon = pFirer->usAttackingWeapon;
 	if (GCM->getItem(weapon)->getItemClass() == IC_GUN ||
 		GCM->getItem(weapon)->getItemClass() == IC_THROWING_KNIFE)
 	{
@@ -3490,11 +3753,135 @@ static INT8 ChanceToGetThrough(SOLDIERTYPE* const pFirer, const GridNo end_pos,
 		weapon    = GLOCK_17;
 		buck_shot = FALSE;
 	}
+}
+
 
+static UINT8 TraceChanceToGetThrough(CTGTQuery const& q, UINT16 const weapon, BOOLEAN const buck_shot)
+{
 	INT16 end_x;
 	INT16 end_y;
-	ConvertGridNoToCenterCellXY(end_pos, &end_x, &end_y);
-	return FireBulletGivenTarget(pFirer, end_x, end_y, dEndZ, weapon, 0, buck_shot, TRUE);
+	ConvertGridNoToCenterCellXY(q.sEndGridNo, &end_x, &end_y);
+	return FireBulletFrom(q.firer, q.sStartGridNo, q.dStartZ, end_x, end_y, q.dEndZ, weapon, 0, buck_shot, TRUE, q.target);
+}
+
+
+static UINT8 TraceChanceToGetThrough(CTGTQuery const& q)
+{
+	if (!q.fTrace) return q.ubChance;
+
+	UINT16  weapon;
+	BOOLEAN buck_shot;
+	GetChanceToGetThroughWeapon(q.firer, weapon, buck_shot);
+	return TraceChanceToGetThrough(q, weapon, buck_shot);
+}
+
+
+#define CTGT_CACHE_SIZE 64
+
+struct CTGTCacheEntry
+{
+	CTGTQuery query; // ubChance holds the result
+	UINT16    usWeapon;
+	BOOLEAN   fBuckshot;
+	UINT32    uiStructuresVersion;
+	UINT32    uiSoldiersSignature;
+	UINT32    uiLastUse; // 0 if the entry is unused
+};
+
+static CTGTCacheEntry gCTGTCache[CTGT_CACHE_SIZE];
+static UINT32         guiCTGTCacheUses;
+
+
+/* Moving soldiers bump guiStructuresVersion, but whether a bullet may hit a
+ * soldier on the way also depends on their visibility and stance, which do not.
+ * Sum these up for every soldier near the line from start to end, so a soldier
+ * who stands up or becomes visible between firer and target spoils the entry.
+ * The margin covers the tiles of vehicles, which are bigger than one tile. */
+static UINT32 CTGTSoldiersSignature(CTGTQuery const& q)
+{
+	INT16 sx;
+	INT16 sy;
+	INT16 ex;
+	INT16 ey;
+	ConvertGridNoToXY(q.sStartGridNo, &sx, &sy);
+	ConvertGridNoToXY(q.sEndGridNo,   &ex, &ey);
+	INT16 const margin = 2;
+	INT16 const min_x  = MIN(sx, ex) - margin;
+	INT16 const max_x  = MAX(sx, ex) + margin;
+	INT16 const min_y  = MIN(sy, ey) - margin;
+	INT16 const max_y  = MAX(sy, ey) + margin;
+
+	UINT32 sig = 2166136261U;
+	FOR_EACH_MERC(i)
+	{
+		SOLDIERTYPE const& s = **i;
+		INT16 x;
+		INT16 y;
+		ConvertGridNoToXY(s.sGridNo, &x, &y);
+		if (x < min_x || max_x < x || y < min_y || max_y < y) continue;
+
+		UINT32 const state =
+			s.ubID                                         << 16 |
+			(s.bVisible == TRUE)                           <<  8 |
+			gAnimControl[s.usAnimState].ubEndHeight;
+		sig = (sig ^ state) * 16777619U;
+		sig = (sig ^ (UINT16)s.sGridNo) * 16777619U;
+	}
+	return sig;
+}
+
+
+static bool CTGTCacheEntryMatches(CTGTCacheEntry const& e, CTGTQuery const& q, UINT16 const weapon, BOOLEAN const buck_shot, UINT32 const soldiers)
+{
+	return
+		e.uiLastUse           != 0                    &&
+		e.uiStructuresVersion == guiStructuresVersion &&
+		e.uiSoldiersSignature == soldiers             &&
+		e.usWeapon            == weapon               &&
+		e.fBuckshot           == buck_shot            &&
+		e.query.firer         == q.firer              &&
+		e.query.target        == q.target             &&
+		e.query.sStartGridNo  == q.sStartGridNo       &&
+		e.query.dStartZ       == q.dStartZ            &&
+		e.query.sEndGridNo    == q.sEndGridNo         &&
+		e.query.dEndZ         == q.dEndZ;
+}
+
+
+/* Like TraceChanceToGetThrough(), but the results of the last traces are kept.
+ * The start and end of the trace include the stance of the firer and target,
+ * every structure which can stop the bullet is counted by guiStructuresVersion
+ * and the soldiers in the way by CTGTSoldiersSignature(), so a result stays
+ * valid until one of them changes. */
+static UINT8 CachedTraceChanceToGetThrough(CTGTQuery const& q)
+{
+	if (!q.fTrace) return q.ubChance;
+
+	UINT16  weapon;
+	BOOLEAN buck_shot;
+	GetChanceToGetThroughWeapon(q.firer, weapon, buck_shot);
+	UINT32 const soldiers = CTGTSoldiersSignature(q);
+
+	CTGTCacheEntry* lru = gCTGTCache;
+	FOR_EACH(CTGTCacheEntry, e, gCTGTCache)
+	{
+		if (CTGTCacheEntryMatches(*e, q, weapon, buck_shot, soldiers))
+		{
+			e->uiLastUse = ++guiCTGTCacheUses;
+			return e->query.ubChance;
+		}
+		if (e->uiLastUse < lru->uiLastUse) lru = e;
+	}
+
+	UINT8 const chance = TraceChanceToGetThrough(q, weapon, buck_shot);
+	lru->query               = q;
+	lru->query.ubChance      = chance;
+	lru->usWeapon            = weapon;
+	lru->fBuckshot           = buck_shot;
+	lru->uiStructuresVersion = guiStructuresVersion;
+	lru->uiSoldiersSignature = soldiers;
+	lru->uiLastUse           = ++guiCTGTCacheUses;
+	return chance;
 }
 
 
@@ -4030,8 +4417,11 @@ void MoveBullet(BULLET* const pBullet)
 						sDesiredLevel = STRUCTURE_ON_ROOF;
 						iCurrCubesAboveLevelZ -= STRUCTURE_ON_ROOF;
 					}
+					// skip the structures if none of them occupies this voxel
+					UINT32 const occupied = gTileVoxels[iGridNo].occupied[sDesiredLevel / PROFILE_Z_SIZE][iCurrCubesAboveLevelZ];
+					iStructureLoop = occupied & VOXEL_COLUMN(pBullet->bLOSIndexX, pBullet->bLOSIndexY) ? 0 : iNumLocalStructures;
 					// check structures for collision
-					for ( iStructureLoop = 0; iStructureLoop < iNumLocalStructures; iStructureLoop++)
+					for ( ; iStructureLoop < iNumLocalStructures; iStructureLoop++)
 					{
 						pStructure = gpLocalStructure[iStructureLoop];
 						if (pStructure && pStructure->sCubeOffset == sDesiredLevel)
@@ -4488,6 +4878,17 @@ INT32 CheckForCollision(FLOAT dX, FLOAT dY, FLOAT dZ, FLOAT dDeltaX, FLOAT dDelt
 				iCurrCubesAboveLevelZ -= STRUCTURE_ON_ROOF;
 			}
 
+			// Nothing to hit in this voxel, unless the object passes through a roof
+			TILE_VOXELS const& voxels = gTileVoxels[pMapElement - gpWorldLevelData];
+			bool const fThroughRoof =
+				(dOldZUnits > HEIGHT_UNITS && dZUnits < HEIGHT_UNITS) ||
+				(dOldZUnits < HEIGHT_UNITS && dZUnits > HEIGHT_UNITS);
+			if (!(voxels.occupied[sDesiredLevel / PROFILE_Z_SIZE][iCurrCubesAboveLevelZ] & VOXEL_COLUMN(bLOSIndexX, bLOSIndexY)) &&
+				!(fThroughRoof && (voxels.fRoof || gfCaves || gfBasement)))
+			{
+				pStructure = NULL;
+			}
+
 			// check structures for collision
 			while (pStructure != NULL)
 			{
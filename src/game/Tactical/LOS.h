@@ -51,6 +51,29 @@ INT32 CheckForCollision(FLOAT dX, FLOAT dY, FLOAT dZ, FLOAT dDeltaX, FLOAT dDelt
 INT8 FireBulletGivenTarget( SOLDIERTYPE * pFirer, FLOAT dEndX, FLOAT dEndY, FLOAT dEndZ, UINT16 usHandItem, INT16 sHitBy, BOOLEAN fBuckshot, BOOLEAN fFake );
 
 INT32 SoldierToSoldierLineOfSightTest(const SOLDIERTYPE* pStartSoldier, const SOLDIERTYPE* pEndSoldier, UINT8 ubTileSightLimit, INT8 bAware);
+/* SoldierToSoldierLineOfSightTest(), but the result is kept for every pair of
+ * soldiers. It is returned again while neither soldier changed tile, stance or
+ * anything else the test looks at, and no smoke or structure which can block
+ * sight was added to or removed from the world. */
+INT32 CachedSoldierToSoldierLineOfSightTest(const SOLDIERTYPE* pStartSoldier, const SOLDIERTYPE* pEndSoldier, UINT8 ubTileSightLimit, INT8 bAware);
+
+struct SightQuery
+{
+	const SOLDIERTYPE* looker;
+	const SOLDIERTYPE* target;
+	UINT8              ubTileSightLimit;
+	INT8               bAware;
+	INT32              iResult;
+};
+
+/* Runs SoldierToSoldierLineOfSightTest() for every query on the worker threads
+ * and fills in the results. Every query only writes its own result, so they do
+ * not depend on the threads. Nothing else may run until all are done. */
+void SoldierToSoldierLineOfSightTests(SightQuery*, UINT n);
+/* Runs the tests the line of sight cache has no result for and puts the results
+ * into it, so the CachedSoldierToSoldierLineOfSightTest() calls which follow
+ * find them. */
+void PrefetchSoldierToSoldierLineOfSightTests(const SightQuery*, UINT n);
 INT32 SoldierToLocationLineOfSightTest( SOLDIERTYPE * pStartSoldier, INT16 sGridNo, UINT8 ubSightLimit, INT8 bAware );
 INT32 SoldierTo3DLocationLineOfSightTest(const SOLDIERTYPE* pStartSoldier, INT16 sGridNo, INT8 bLevel, INT8 bCubeLevel, UINT8 ubTileSightLimit, INT8 bAware);
 INT32 SoldierToBodyPartLineOfSightTest( const SOLDIERTYPE * pStartSoldier, INT16 sGridNo, INT8 bLevel, UINT8 ubAimLocation, UINT8 ubTileSightLimit, INT8 bAware );
@@ -59,6 +82,39 @@ UINT8 SoldierToSoldierBodyPartChanceToGetThrough(SOLDIERTYPE* pStartSoldier, con
 UINT8 AISoldierToSoldierChanceToGetThrough(SOLDIERTYPE* pStartSoldier, const SOLDIERTYPE* pEndSoldier);
 UINT8 AISoldierToLocationChanceToGetThrough( SOLDIERTYPE * pStartSoldier, INT16 sGridNo, INT8 bLevel, INT8 bCubeLevel );
 UINT8 SoldierToLocationChanceToGetThrough(SOLDIERTYPE* pStartSoldier, INT16 sGridNo, INT8 bLevel, INT8 bCubeLevel, const SOLDIERTYPE* target);
+/* Like the functions without Cached, for the targeting cursor, which asks again
+ * and again while the player aims. The result of the last traces is returned
+ * again while the shot starts and ends at the same spots, with the same weapon,
+ * and no structure or soldier was added to, moved in or removed from the world.
+ * The side effects on the firer are the same. */
+UINT8 CachedSoldierToSoldierBodyPartChanceToGetThrough(SOLDIERTYPE* pStartSoldier, const SOLDIERTYPE* pEndSoldier, UINT8 ubAimLocation);
+UINT8 CachedSoldierToLocationChanceToGetThrough(SOLDIERTYPE* pStartSoldier, INT16 sGridNo, INT8 bLevel, INT8 bCubeLevel, const SOLDIERTYPE* target);
+
+/* A chance to get through with everything about the firer and the target worked
+ * out, up to the trace of the fake bullet. The trace reads nothing the AI fakes
+ * when it tries out positions, i.e. the grid numbers and stances of the
+ * soldiers, so they can be put back before it runs. */
+struct CTGTQuery
+{
+	SOLDIERTYPE*       firer;
+	const SOLDIERTYPE* target;
+	GridNo             sStartGridNo;
+	FLOAT              dStartZ;
+	GridNo             sEndGridNo;
+	FLOAT              dEndZ;
+	bool               fTrace;   // false if the chance is known without a trace
+	UINT8              ubChance;
+};
+
+/* Like the functions of the same name, but only set up the query. The side
+ * effects on the firer are the same. */
+void PrepareSoldierToLocationChanceToGetThrough(CTGTQuery&, SOLDIERTYPE* pStartSoldier, INT16 sGridNo, INT8 bLevel, INT8 bCubeLevel, const SOLDIERTYPE* target);
+void PrepareAISoldierToSoldierChanceToGetThrough(CTGTQuery&, SOLDIERTYPE* pStartSoldier, const SOLDIERTYPE* pEndSoldier);
+void PrepareAISoldierToLocationChanceToGetThrough(CTGTQuery&, SOLDIERTYPE* pStartSoldier, INT16 sGridNo, INT8 bLevel, INT8 bCubeLevel);
+
+/* Traces the queries on the worker threads and fills in ubChance, like
+ * SoldierToSoldierLineOfSightTests(). */
+void ChanceToGetThroughTests(CTGTQuery*, UINT n);
 INT16 SoldierToLocationWindowTest(const SOLDIERTYPE* pStartSoldier, INT16 sEndGridNo);
 INT32 LocationToLocationLineOfSightTest( INT16 sStartGridNo, INT8 bStartLevel, INT16 sEndGridNo, INT8 bEndLevel, UINT8 ubTileSightLimit, INT8 bAware );
 
@@ -152,7 +208,8 @@ struct LOSResults
 	UINT8   ubChanceToGetThrough;
 };
 
-extern LOSResults gLOSTestResults;
+// The last test of the thread
+extern thread_local LOSResults gLOSTestResults;
 
 #endif
 
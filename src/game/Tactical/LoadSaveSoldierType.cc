@@ -4,6 +4,7 @@
 #include "LoadSaveSoldierType.h"
 #include "Overhead.h"
 #include "Tactical_Save.h"
+#include "Timer_Control.h"
 #include "Types.h"
 
 #include <algorithm>
@@ -129,7 +130,7 @@ void ExtractSoldierType(const BYTE* const data, SOLDIERTYPE* const s, bool strac
 	EXTR_SKIP(d, 1)
 	EXTR_BOOL(d, s->fUICloseMerc)
 	EXTR_SKIP(d, 5)
-	EXTR_I32(d, s->UpdateCounter)
+	EXTR_SKIP_I32(d) // UpdateCounter, the next animation frame is due right away
 	EXTR_I32(d, s->DamageCounter)
 	EXTR_SKIP_I32(d)
 	EXTR_SKIP(d, 4)
@@ -642,7 +643,7 @@ void InjectSoldierType(BYTE* const data, const SOLDIERTYPE* const s)
 	INJ_SKIP(d, 1)
 	INJ_BOOL(d, s->fUICloseMerc)
 	INJ_SKIP(d, 5)
-	INJ_I32(d, s->UpdateCounter)
+	INJ_I32(d, std::max((INT32)(s->UpdateCounter - GetJA2Clock()), 0)) // UpdateCounter, saved as the time left
 	INJ_I32(d, s->DamageCounter)
 	INJ_SKIP_I32(d)
 	INJ_SKIP(d, 4)
@@ -10,6 +10,7 @@
 #include "Rotting_Corpses.h"
 #include "Isometric_Utils.h"
 #include "Animation_Control.h"
+#include "Animation_Data.h"
 #include "Game_Clock.h"
 #include "Soldier_Create.h"
 #include "RenderWorld.h"
@@ -437,6 +438,16 @@ void StartHelicopterRun( INT16 sGridNoSweetSpot )
 
 	gfFirstGuyDown = TRUE;
 
+	// Load the drop animations while the helicopter approaches, so no merc
+	// waits for the disk when he jumps
+	for (INT32 cnt = 0; cnt < gbNumHeliSeatsOccupied; ++cnt)
+	{
+		SOLDIERTYPE&  s       = *gHeliSeats[cnt];
+		UINT16  const surface = DetermineSoldierAnimationSurface(&s, HELIDROP);
+		if (surface == INVALID_ANIMATION_SURFACE) continue;
+		PreloadAnimationSurface(s.ubID, surface, HELIDROP);
+	}
+
 	guiPendingOverrideEvent = LU_BEGINUILOCK;
 }
 
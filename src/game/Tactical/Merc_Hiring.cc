@@ -217,6 +217,9 @@ INT8 HireMerc(MERC_HIRE_STRUCT& h)
 	// remove the merc from the Personnel screens departed list (if they have never been hired before, its ok to call it)
 	RemoveNewlyHiredMercFromPersonnelDepartedList(s->ubProfile);
 
+	// The merc will talk soon, so have the quotes read by then
+	PreloadMercDialogue(pid);
+
 	gfAtLeastOneMercWasHired = TRUE;
 	return MERC_HIRE_OK;
 }
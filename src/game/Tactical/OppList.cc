@@ -3,6 +3,7 @@
 #include "Debug_Pages.h"
 #include "Isometric_Utils.h"
 #include "Overhead.h"
+#include "Event_Manager.h"
 #include "Event_Pump.h"
 #include "Random.h"
 #include "Overhead_Types.h"
@@ -56,6 +57,7 @@
 
 #include <algorithm>
 #include <iterator>
+#include <vector>
 
 #define WE_SEE_WHAT_MILITIA_SEES_AND_VICE_VERSA
 
@@ -97,6 +99,7 @@ INT16 gsLastKnownOppLoc[TOTAL_SOLDIERS][TOTAL_SOLDIERS]; // merc vs. merc
 INT8 gbLastKnownOppLevel[TOTAL_SOLDIERS][TOTAL_SOLDIERS];
 INT16 gsPublicLastKnownOppLoc[MAXTEAMS][TOTAL_SOLDIERS]; // team vs. merc
 INT8 gbPublicLastKnownOppLevel[MAXTEAMS][TOTAL_SOLDIERS];
+UINT32 guiOppListVersion;
 UINT8 gubPublicNoiseVolume[MAXTEAMS];
 INT16 gsPublicNoiseGridno[MAXTEAMS];
 INT8	gbPublicNoiseLevel[MAXTEAMS];
@@ -205,6 +208,7 @@ SightFlags gubSightFlags;
 
 #define DECAY_OPPLIST_VALUE( value )\
 {\
+	++guiOppListVersion;\
 	if ( (value) >= SEEN_THIS_TURN)\
 	{\
 		(value)++;\
@@ -608,6 +612,7 @@ void CheckHostileOrSayQuoteList( void )
 			if (speaker->bVisible != TRUE)
 			{
 				gbPublicOpplist[OUR_TEAM][speaker->ubID] = HEARD_THIS_TURN;
+				++guiOppListVersion;
 				HandleSight(*speaker, SIGHT_LOOK | SIGHT_RADIO);
 			}
 			// trigger hater
@@ -620,6 +625,7 @@ void CheckHostileOrSayQuoteList( void )
 static void ManLooksForOtherTeams(SOLDIERTYPE* pSoldier);
 static void OurTeamRadiosRandomlyAbout(SOLDIERTYPE* about);
 static void OtherTeamsLookForMan(SOLDIERTYPE* pOpponent);
+static void PrefetchSight(SOLDIERTYPE const* only);
 
 
 void HandleSight(SOLDIERTYPE& s, SightFlags const sight_flags)
@@ -661,6 +667,8 @@ void HandleSight(SOLDIERTYPE& s, SightFlags const sight_flags)
 	// If we've been told to make this soldier look (& others look back at him)
 	if (sight_flags & SIGHT_LOOK)
 	{
+		PrefetchSight(&s);
+
 		// If this soldier's under our control and well enough to look
 		if (s.bLife >= OKLIFE)
 		{
@@ -1094,6 +1102,11 @@ void TurnOffTeamsMuzzleFlashes( UINT8 ubTeam )
 }
 
 
+// The most DecideHearing() adds: experience, two night ops traits, extended
+// ears in full repair and the night bonus
+#define MAX_HEARING_BONUS (1 + 2 + 6 + 3 + 2)
+
+
 static INT8 DecideHearing(const SOLDIERTYPE* pSoldier)
 {
 	// calculate the hearing value for the merc...
@@ -1187,6 +1200,7 @@ void AllTeamsLookForAll(UINT8 ubAllowInterrupts)
 		}
 	}
 
+	PrefetchSight(NULL);
 	FOR_EACH_MERC(i)
 	{
 		SOLDIERTYPE& s = **i;
@@ -1228,6 +1242,65 @@ void AllTeamsLookForAll(UINT8 ubAllowInterrupts)
 static INT16 ManLooksForMan(SOLDIERTYPE* pSoldier, SOLDIERTYPE* pOpponent, UINT8 ubCaller);
 
 
+// How far the soldier sees the opponent, and whether he knows about him
+static INT16 SightDistanceTo(SOLDIERTYPE const& s, SOLDIERTYPE const& opp, INT8& bAware)
+{
+	// if soldier is known about (SEEN or HEARD within last few turns)
+	if (s.bOppList[opp.ubID] || gbPublicOpplist[s.bTeam][opp.ubID])
+	{
+		bAware = TRUE;
+
+		// then we look for him full viewing distance in EVERY direction
+		return DistanceVisible(&s, DIRECTION_IRRELEVANT, 0, opp.sGridNo, opp.bLevel);
+	}
+	else // soldier is not currently known about
+	{
+		bAware = FALSE;
+
+		// distance we "see" then depends on the direction he is located from us
+		INT8 const bDir = atan8(s.sX, s.sY, opp.sX, opp.sY);
+		// BIG NOTE: must use desdir instead of direction, since in a projected
+		// situation, the direction may still be changing if it's one of the first
+		// few animation steps when this guy's turn to do his stepped look comes up
+		return DistanceVisible(&s, s.bDesiredDirection, bDir, opp.sGridNo, opp.bLevel);
+	}
+}
+
+
+/* Runs the line of sight tests ManLooksForMan() is about to make in parallel,
+ * for the soldiers looking for the given one and him looking for them, or for
+ * everybody looking for everybody. They end up in the line of sight cache. */
+static void PrefetchSight(SOLDIERTYPE const* const only)
+{
+	std::vector<SightQuery> queries;
+	FOR_EACH_MERC(i)
+	{
+		SOLDIERTYPE const& s = **i;
+		// as ManLooksForMan() checks the looker
+		if (!s.bInSector || s.bLife < OKLIFE || s.fMercAsleep) continue;
+		if (s.ubBodyType == LARVAE_MONSTER) continue;
+		if (s.uiStatusFlags & SOLDIER_VEHICLE && s.bTeam == OUR_TEAM) continue;
+
+		FOR_EACH_MERC(j)
+		{
+			SOLDIERTYPE const& opp = **j;
+			if (only && &s != only && &opp != only) continue;
+			// and the one looked for
+			if (!opp.bInSector || opp.bLife <= 0 || opp.sGridNo == NOWHERE) continue;
+			if (s.bTeam == opp.bTeam) continue;
+
+			INT8        bAware;
+			INT16 const sDistVisible = SightDistanceTo(s, opp, bAware);
+			if (PythSpacesAway(s.sGridNo, opp.sGridNo) > sDistVisible) continue;
+
+			SightQuery const q = { &s, &opp, (UINT8)sDistVisible, bAware, 0 };
+			queries.push_back(q);
+		}
+	}
+	PrefetchSoldierToSoldierLineOfSightTests(queries.data(), (UINT)queries.size());
+}
+
+
 static void ManLooksForOtherTeams(SOLDIERTYPE* pSoldier)
 {
 	SLOGD("MANLOOKSFOROTHERTEAMS ID %d(%ls) team %d side %d",
@@ -1268,6 +1341,8 @@ static void RemoveOneOpponent(SOLDIERTYPE* pSoldier);
 
 static void HandleManNoLongerSeen(SOLDIERTYPE* pSoldier, SOLDIERTYPE* pOpponent, INT8* pPersOL, INT8* pbPublOL)
 {
+	++guiOppListVersion;
+
 	// if neither side is neutral AND
 	// if this soldier is an opponent (fights for different side)
 	if (!CONSIDERED_NEUTRAL( pOpponent, pSoldier ) && !CONSIDERED_NEUTRAL( pSoldier, pOpponent ) &&
@@ -1342,7 +1417,7 @@ static void ManSeesMan(SOLDIERTYPE& s, SOLDIERTYPE& opponent, UINT8 caller2);
 
 static INT16 ManLooksForMan(SOLDIERTYPE* pSoldier, SOLDIERTYPE* pOpponent, UINT8 ubCaller)
 {
-	INT8 bDir,bAware = FALSE,bSuccess = FALSE;
+	INT8 bAware = FALSE,bSuccess = FALSE;
 	INT16 sDistVisible,sDistAway;
 	INT8  *pPersOL,*pbPublOL;
 
@@ -1440,26 +1515,7 @@ static INT16 ManLooksForMan(SOLDIERTYPE* pSoldier, SOLDIERTYPE* pOpponent, UINT8
 	pPersOL = &(pSoldier->bOppList[pOpponent->ubID]);
 	pbPublOL = &(gbPublicOpplist[pSoldier->bTeam][pOpponent->ubID]);
 
-
-	// if soldier is known about (SEEN or HEARD within last few turns)
-	if (*pPersOL || *pbPublOL)
-	{
-		bAware = TRUE;
-
-		// then we look for him full viewing distance in EVERY direction
-		sDistVisible = DistanceVisible(pSoldier, DIRECTION_IRRELEVANT, 0, pOpponent->sGridNo,
-						pOpponent->bLevel );
-	}
-	else // soldier is not currently known about
-	{
-		// distance we "see" then depends on the direction he is located from us
-		bDir = atan8(pSoldier->sX,pSoldier->sY,pOpponent->sX,pOpponent->sY);
-		// BIG NOTE: must use desdir instead of direction, since in a projected
-		// situation, the direction may still be changing if it's one of the first
-		// few animation steps when this guy's turn to do his stepped look comes up
-		sDistVisible = DistanceVisible(pSoldier,pSoldier->bDesiredDirection,bDir, pOpponent->sGridNo,
-						pOpponent->bLevel);
-	}
+	sDistVisible = SightDistanceTo(*pSoldier, *pOpponent, bAware);
 
 	// calculate how many spaces away soldier is (using Pythagoras' theorem)
 	sDistAway = PythSpacesAway(pSoldier->sGridNo,pOpponent->sGridNo);
@@ -1471,7 +1527,7 @@ static INT16 ManLooksForMan(SOLDIERTYPE* pSoldier, SOLDIERTYPE* pOpponent, UINT8
 	{
 		// and we can trace a line of sight to his x,y coordinates
 		// must use the REAL opplist value here since we may or may not know of him
-		if (SoldierToSoldierLineOfSightTest(pSoldier,pOpponent,(UINT8)sDistVisible,bAware))
+		if (CachedSoldierToSoldierLineOfSightTest(pSoldier,pOpponent,(UINT8)sDistVisible,bAware))
 		{
 			ManSeesMan(*pSoldier, *pOpponent, ubCaller);
 			bSuccess = TRUE;
@@ -1672,6 +1728,7 @@ static void ManSeesMan(SOLDIERTYPE& s, SOLDIERTYPE& opponent, UINT8 const caller
 								TriggerNPCRecord(s.ubProfile, 9);
 								iggy.ubMiscFlags2 |= PROFILE_MISC_FLAG2_SAID_FIRSTSEEN_QUOTE;
 								gbPublicOpplist[OUR_TEAM][s.ubID] = HEARD_THIS_TURN;
+								++guiOppListVersion;
 							}
 							break;
 						}
@@ -1913,8 +1970,8 @@ static void ManSeesMan(SOLDIERTYPE& s, SOLDIERTYPE& opponent, UINT8 const caller
 			opponent.fBeginFade = FALSE;
 
 			MAP_ELEMENT& me = gpWorldLevelData[opponent.sGridNo];
-			opponent.ubFadeLevel = opponent.bLevel > 0 && me.pRoofHead ? me.pRoofHead->ubShadeLevel :
-						me.pLandHead->ubShadeLevel;
+			opponent.ubFadeLevel = LightNodeShade(opponent.bLevel > 0 && me.pRoofHead ? *me.pRoofHead :
+						*me.pLandHead);
 
 			// Set levelnode shade level
 			if (opponent.pLevelNode)
@@ -2140,6 +2197,7 @@ static void UpdatePublic(const UINT8 ubTeam, SOLDIERTYPE* const s, const INT8 bN
 {
 	UINT8 ubTeamMustLookAgain = FALSE;
 
+	++guiOppListVersion;
 	INT8* const pbPublOL = &gbPublicOpplist[ubTeam][s->ubID];
 
 	// if new opplist is more up-to-date, or we are just wiping it for some reason
@@ -2187,6 +2245,8 @@ static void UpdatePublic(const UINT8 ubTeam, SOLDIERTYPE* const s, const INT8 bN
 
 static void UpdatePersonal(SOLDIERTYPE* pSoldier, UINT8 ubID, INT8 bNewOpplist, INT16 sGridno, INT8 bLevel)
 {
+	++guiOppListVersion;
+
 	// if new opplist is more up-to-date, or we are just wiping it for some reason
 	if ((gubKnowledgeValue[pSoldier->bOppList[ubID] - OLDEST_HEARD_VALUE][bNewOpplist - OLDEST_HEARD_VALUE] > 0) ||
 		(bNewOpplist == NOT_HEARD_OR_SEEN))
@@ -2202,6 +2262,7 @@ static void UpdatePersonal(SOLDIERTYPE* pSoldier, UINT8 ubID, INT8 bNewOpplist,
 
 static void ResetLastKnownLocs(SOLDIERTYPE const& s)
 {
+	++guiOppListVersion;
 	FOR_EACH_MERC(i)
 	{
 		const SoldierID tgt_id = (*i)->ubID;
@@ -2241,6 +2302,7 @@ void InitOpponentKnowledgeSystem(void)
 {
 	INT32 iTeam, cnt, cnt2;
 
+	++guiOppListVersion;
 	for (auto& i : gbSeenOpponents)
 	{
 		std::fill(std::begin(i), std::end(i), 0);
@@ -2284,6 +2346,7 @@ void InitOpponentKnowledgeSystem(void)
 
 void InitSoldierOppList(SOLDIERTYPE& s)
 {
+	++guiOppListVersion;
 	std::fill(std::begin(s.bOppList), std::end(s.bOppList), NOT_HEARD_OR_SEEN);
 	s.bOppCnt = 0;
 	ResetLastKnownLocs(s);
@@ -3430,6 +3493,39 @@ UINT8 DoorOpeningNoise( SOLDIERTYPE *pSoldier )
 }
 
 
+/* Bursts and explosions make the same noise over and over while the attack is
+ * busy. Folds the noise into an equal one at the same spot which is already
+ * waiting, keeping the louder volume, so it is only processed once when the
+ * attack is over. Only the noises queued since the last other event are
+ * looked at, so no noise is moved ahead of e.g. a weapon hit. */
+static bool MergeWithDelayedNoise(EV_S_NOISE const& n)
+{
+	for (UINT32 i = EventQueueSize(DEMAND_EVENT_QUEUE); i-- != 0;)
+	{
+		EVENT* const e = PeekEvent(i, DEMAND_EVENT_QUEUE);
+		if (e->uiEvent != S_NOISE) break;
+
+		EV_S_NOISE pending;
+		memcpy(&pending, e->Data, sizeof(pending));
+		if (pending.ubNoiseMaker != n.ubNoiseMaker ||
+			pending.sGridNo      != n.sGridNo      ||
+			pending.bLevel       != n.bLevel       ||
+			pending.ubNoiseType  != n.ubNoiseType)
+		{
+			continue;
+		}
+
+		if (n.ubVolume > pending.ubVolume)
+		{
+			pending.ubVolume = n.ubVolume;
+			memcpy(e->Data, &pending, sizeof(pending));
+		}
+		return true;
+	}
+	return false;
+}
+
+
 void MakeNoise(SOLDIERTYPE* const noise_maker, INT16 const sGridNo, INT8 const bLevel, UINT8 const ubVolume, NoiseKind const ubNoiseType)
 {
 	if ( gTacticalStatus.ubAttackBusyCount )
@@ -3441,7 +3537,10 @@ void MakeNoise(SOLDIERTYPE* const noise_maker, INT16 const sGridNo, INT8 const b
 		SNoise.bLevel       = bLevel;
 		SNoise.ubVolume     = ubVolume;
 		SNoise.ubNoiseType  = ubNoiseType;
-		AddGameEvent( S_NOISE, DEMAND_EVENT_DELAY, &SNoise );
+		if (!MergeWithDelayedNoise(SNoise))
+		{
+			AddGameEvent( S_NOISE, DEMAND_EVENT_DELAY, &SNoise );
+		}
 	}
 	else
 	{
@@ -3527,6 +3626,15 @@ static void ProcessNoise(SOLDIERTYPE* const noise_maker, INT16 const sGridNo, IN
 	// else give up trying to get terrain type, just assume sound isn't muffled
 
 
+	// The volume fades by a point per tile beyond the first and at best is raised
+	// by the hearing of the listener and the roof, so nobody this far away or
+	// further in either direction can hear the noise
+	INT16 sNoiseX;
+	INT16 sNoiseY;
+	ConvertGridNoToXY(sGridNo, &sNoiseX, &sNoiseY);
+	INT16 const sAudibleRange = ubBaseVolume + MAX_HEARING_BONUS + 5 + 1;
+
+
 	// DETERMINE THE *PERCEIVED* SOURCE OF THE NOISE
 	SOLDIERTYPE* source;
 	switch (ubNoiseType)
@@ -3741,6 +3849,14 @@ static void ProcessNoise(SOLDIERTYPE* const noise_maker, INT16 const sGridNo, IN
 				pSoldier->ubMiscSoldierFlags |= SOLDIER_MISC_HEARD_GUNSHOT;
 			}
 
+			INT16 sX;
+			INT16 sY;
+			ConvertGridNoToXY(pSoldier->sGridNo, &sX, &sY);
+			if (ABS(sX - sNoiseX) >= sAudibleRange || ABS(sY - sNoiseY) >= sAudibleRange)
+			{
+				continue; // too far away to hear it in any case
+			}
+
 			// Can the listener hear noise of that volume given his circumstances?
 			ubEffVolume = CalcEffVolume(pSoldier, sGridNo, bLevel, ubNoiseType,
 							ubBaseVolume, bCheckTerrain,
@@ -4341,6 +4457,8 @@ void VerifyAndDecayOpplist(SOLDIERTYPE *pSoldier)
 	// 2) increment opplist value if opponent is known but not currenly seen
 	// 3) forget about known opponents who haven't been noticed in some time
 
+	++guiOppListVersion;
+
 	// if soldier is unconscious, make sure his opplist is wiped out & bail out
 	if (pSoldier->bLife < OKLIFE)
 	{
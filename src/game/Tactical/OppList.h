@@ -61,6 +61,10 @@ extern INT16 gsLastKnownOppLoc[TOTAL_SOLDIERS][TOTAL_SOLDIERS]; // merc vs. merc
 extern INT8  gbLastKnownOppLevel[TOTAL_SOLDIERS][TOTAL_SOLDIERS];
 extern INT16 gsPublicLastKnownOppLoc[MAXTEAMS][TOTAL_SOLDIERS]; // team vs. merc
 extern INT8  gbPublicLastKnownOppLevel[MAXTEAMS][TOTAL_SOLDIERS];
+/* Incremented whenever one of the personal or public opplists, the last known
+ * locations or the seen opponents above change, so anything derived from what
+ * the soldiers know about their opponents can tell whether it is stale. */
+extern UINT32 guiOppListVersion;
 extern UINT8 gubPublicNoiseVolume[MAXTEAMS];
 extern INT16 gsPublicNoiseGridno[MAXTEAMS];
 extern INT8  gbPublicNoiseLevel[MAXTEAMS];
@@ -1,7 +1,9 @@
 #include "Handle_Doors.h"
 #include "Handle_Items.h"
 #include "MapScreen.h"
+#include "Profiler.h"
 #include "Soldier_Find.h"
+#include "Soldier_Grid.h"
 #include "Spread_Burst.h"
 #include "TileDef.h"
 #include "VObject.h"
@@ -25,6 +27,7 @@
 #include "Points.h"
 #include "Random.h"
 #include "AI.h"
+#include "AITiming.h"
 #include "Interactive_Tiles.h"
 #include "Soldier_Ani.h"
 #include "Overhead.h"
@@ -107,7 +110,6 @@
 #include <iterator>
 
 #define RT_DELAY_BETWEEN_AI_HANDLING	50
-#define RT_AI_TIMESLICE			10
 
 INT32         giRTAILastUpdateTime = 0;
 static UINT32 guiAISlotToHandle    = 0;
@@ -265,7 +267,9 @@ static void RecountMercSlots(void)
 void AddMercSlot(SOLDIERTYPE* pSoldier)
 {
 	const INT32 iMercIndex = GetFreeMercSlot();
-	if (iMercIndex != -1) MercSlots[iMercIndex] = pSoldier;
+	if (iMercIndex == -1) return;
+	MercSlots[iMercIndex] = pSoldier;
+	AddSoldierToGrid(*pSoldier);
 }
 
 
@@ -279,6 +283,7 @@ BOOLEAN RemoveMercSlot(SOLDIERTYPE* pSoldier)
 		{
 			MercSlots[i] = NULL;
 			RecountMercSlots();
+			RemoveSoldierFromGrid(*pSoldier);
 			return TRUE;
 		}
 	}
@@ -407,6 +412,7 @@ void InitOverhead()
 {
 	std::fill(std::begin(MercSlots), std::end(MercSlots), nullptr);
 	std::fill(std::begin(AwaySlots), std::end(AwaySlots), nullptr);
+	ClearSoldierGrid();
 	std::fill(std::begin(Menptr), std::end(Menptr), SOLDIERTYPE{});
 
 	TacticalStatusType& t = gTacticalStatus;
@@ -549,6 +555,9 @@ static void HandleCreatureTenseQuote(void);
 
 void ExecuteOverhead(void)
 {
+	PROFILE_SCOPE(PROFILE_EXECUTE_OVERHEAD);
+	PROFILE_ZONE("ExecuteOverhead");
+
 	// Diagnostic Stuff
 	static INT32 iTimerTest = 0;
 
@@ -569,6 +578,9 @@ void ExecuteOverhead(void)
 		// BOMBS!!!
 		HandleExplosionQueue();
 
+		// Animation surfaces the soldiers are about to jump to
+		HandleAnimationSurfacePreloads();
+
 		HandleCreatureTenseQuote();
 
 		CheckHostileOrSayQuoteList();
@@ -580,6 +592,7 @@ void ExecuteOverhead(void)
 		}
 
 		BOOLEAN fHandleAI = FALSE;
+		AIBeginThinkSlice();
 		if (!gfPauseAllAI)
 		{
 			// AI limiting crap
@@ -663,9 +676,9 @@ void ExecuteOverhead(void)
 						//ubShadeLevel =__max(ubShadeLevel-1, gpWorldLevelData[ pSoldier->sGridNo ].pLandHead->ubShadeLevel );
 						bShadeLevel = MAX(0, bShadeLevel - 1);
 
-						if (bShadeLevel <= gpWorldLevelData[pSoldier->sGridNo].pLandHead->ubShadeLevel)
+						if (bShadeLevel <= LightNodeShade(*gpWorldLevelData[pSoldier->sGridNo].pLandHead))
 						{
-							bShadeLevel = gpWorldLevelData[pSoldier->sGridNo].pLandHead->ubShadeLevel;
+							bShadeLevel = LightNodeShade(*gpWorldLevelData[pSoldier->sGridNo].pLandHead);
 
 							pSoldier->fBeginFade = FALSE;
 							//pSoldier->bVisible = -1;
@@ -696,7 +709,7 @@ void ExecuteOverhead(void)
 					{
 						if (pSoldier->sGridNo != NOWHERE)
 						{
-							pSoldier->ubFadeLevel = gpWorldLevelData[pSoldier->sGridNo].pLandHead->ubShadeLevel;
+							pSoldier->ubFadeLevel = LightNodeShade(*gpWorldLevelData[pSoldier->sGridNo].pLandHead);
 						}
 						pSoldier->fBeginFade           = TRUE;
 						pSoldier->sLocationOfFadeStart = pSoldier->sGridNo;
@@ -754,7 +767,7 @@ void ExecuteOverhead(void)
 				// Handle animation update counters
 				// ATE: Added additional check here for special value of anispeed that pauses all updates
 #ifndef BOUNDS_CHECKER
-				if (TIMECOUNTERDONE(pSoldier->UpdateCounter, pSoldier->sAniDelay) &&
+				if (TIMEDEADLINEDONE(pSoldier->UpdateCounter) &&
 					pSoldier->sAniDelay != 10000)
 #endif
 				{
@@ -765,7 +778,7 @@ void ExecuteOverhead(void)
 						pSoldier->uiStatusFlags &= ~SOLDIER_LOOKFOR_ITEMS;
 					}
 
-					RESETTIMECOUNTER(pSoldier->UpdateCounter, pSoldier->sAniDelay);
+					RESETTIMEDEADLINE(pSoldier->UpdateCounter, pSoldier->sAniDelay);
 
 					BOOLEAN fNoAPsForPendingAction = FALSE;
 
@@ -1121,7 +1134,7 @@ void ExecuteOverhead(void)
 					HandleSoldierAI(pSoldier);
 					if (!(gTacticalStatus.uiFlags & INCOMBAT))
 					{
-						if (GetJA2Clock() - iTimerVal > RT_AI_TIMESLICE)
+						if (AIThinkSliceSpent())
 						{
 							// don't do any more AI this time!
 							fHandleAI = FALSE;
@@ -1320,6 +1333,7 @@ static void CheckIfNearbyGroundSeemsWrong(SOLDIERTYPE* const s, UINT16 const gri
 		*keep_moving = FALSE;
 
 		gpWorldLevelData[mine_gridno].uiFlags |= MAPELEMENT_ENEMY_MINE_PRESENT;
+		InvalidatePathCache();
 
 		// Better stop and reconsider what to do
 		SetNewSituation(s);
@@ -1821,11 +1835,11 @@ static BOOLEAN HandleAtNewGridNo(SOLDIERTYPE* pSoldier, BOOLEAN* pfKeepMoving)
 
 			if (pSoldier->bLevel > 0 && gpWorldLevelData[pSoldier->sGridNo].pRoofHead != NULL)
 			{
-				pSoldier->ubFadeLevel = gpWorldLevelData[pSoldier->sGridNo].pRoofHead->ubShadeLevel;
+				pSoldier->ubFadeLevel = LightNodeShade(*gpWorldLevelData[pSoldier->sGridNo].pRoofHead);
 			}
 			else
 			{
-				pSoldier->ubFadeLevel = gpWorldLevelData[pSoldier->sGridNo].pLandHead->ubShadeLevel;
+				pSoldier->ubFadeLevel = LightNodeShade(*gpWorldLevelData[pSoldier->sGridNo].pLandHead);
 			}
 
 			// Set levelnode shade level....
@@ -2280,7 +2294,18 @@ void SlideToLocation(const INT16 sDestGridNo)
 
 void RebuildAllSoldierShadeTables(void)
 {
-	FOR_EACH_SOLDIER(i) CreateSoldierPalettes(*i);
+	// Soldiers in the same colours get the tables made for the first of them
+	BeginSoldierPaletteBatch();
+	try
+	{
+		FOR_EACH_SOLDIER(i) CreateSoldierPalettes(*i);
+	}
+	catch (...)
+	{
+		EndSoldierPaletteBatch();
+		throw;
+	}
+	EndSoldierPaletteBatch();
 }
 
 
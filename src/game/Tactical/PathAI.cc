@@ -24,8 +24,11 @@
 #include "WorldMan.h"
 #include "PathAI.h"
 #include "PathAIDebug.h"
+#include "Profiler.h"
+#include "Path_Regions.h"
 #include "Points.h"
 #include "AI.h"
+#include "AITiming.h"
 #include "Random.h"
 #include "Message.h"
 #include "Structure_Wrap.h"
@@ -52,8 +55,12 @@ static BOOLEAN gfDrawPathPoints = FALSE;
 #endif
 
 #include "Logger.h"
+#include "Debug_Pages.h"
+
+#include <SDL.h>
 
 #include <algorithm>
+#include <vector>
 
 BOOLEAN gfPlotPathToExitGrid = FALSE;
 BOOLEAN gfRecalculatingExistingPathCost = FALSE;
@@ -75,6 +82,8 @@ INT32 iMaxSkipListLevel = MAX_SKIPLIST_LEVEL;
 INT32 iMaxTrailTree = MAX_TRAIL_TREE;
 INT32 iMaxPathQ = MAX_PATHQ;
 
+PathAIOpenList gPathAIOpenList = PATHAI_OPENLIST_HEAP;
+
 extern BOOLEAN gfGeneratingMapEdgepoints;
 
 #define VEHICLE
@@ -121,6 +130,14 @@ static INT32  iClosedListSize;
 static INT8   bSkipListLevel;
 static INT32  iSkipListLevelLimit[9] = {0, 4, 16, 64, 256, 1024, 4096, 16384, 65536};
 
+// The heap open list, used instead of the skip list if fHeapOpenList is set
+#define OPENHEAP_ARITY				4
+
+static path_t* pOpenHeap[ABSMAX_PATHQ];
+static INT32   iOpenHeapSize;
+static BOOLEAN fHeapOpenList;
+static UINT32  uiPathNodesExpanded;
+
 // The estimated cost must never exceed the real cost, otherwise you lose the
 // guarantee that you're getting the least-cost path from start to goal. (issue #375)
 #define LOWESTCOST				(EASYWATERCOST)
@@ -162,8 +179,9 @@ static path_t *pQueueHead;
 static path_t *pClosedHead;
 
 
-#define pathQNotEmpty				(pQueueHead->pNext[0] != NULL)
-#define pathFound				(pQueueHead->pNext[0]->iLocation == iDestination)
+#define pathQHead				(fHeapOpenList ? (iOpenHeapSize != 0 ? pOpenHeap[0] : NULL) : pQueueHead->pNext[0])
+#define pathQNotEmpty				(pathQHead != NULL)
+#define pathFound				(pathQHead->iLocation == iDestination)
 #define pathNotYetFound			(!pathFound)
 
 // Note, the closed list is maintained as a doubly-linked list;
@@ -341,7 +359,18 @@ static path_t *pClosedHead;
 
 #define REMQUEHEADNODE()			SkipListRemoveHead();
 
-#define DELQUENODE(ndx)				SkipListRemoveHead()
+#define DELQUENODE(ndx)\
+{\
+	if (fHeapOpenList)\
+	{\
+		OpenHeapRemoveHead();\
+	}\
+	else\
+	{\
+		SkipListRemoveHead();\
+	}\
+	uiPathNodesExpanded++;\
+}
 
 #define REMAININGCOST(ptr)\
 (\
@@ -407,6 +436,56 @@ static INT8 RandomSkipListLevel(void)
 }
 
 
+/* Orders the open list like the sorted skip list insert: by total cost, then
+ * by the leg distance to the destination, and of two equal nodes the one
+ * queued later comes first. As this is a total order the heap expands the same
+ * nodes in the same order as the skip list. */
+static bool OpenListBefore(const path_t* a, const path_t* b)
+{
+	if (TOTALCOST(a) != TOTALCOST(b)) return TOTALCOST(a) < TOTALCOST(b);
+	if (a->ubLegDistance != b->ubLegDistance) return a->ubLegDistance < b->ubLegDistance;
+	return (UINT16)a->sPathNdx > (UINT16)b->sPathNdx;
+}
+
+
+static void OpenHeapInsert(path_t* const pNew)
+{
+	INT32 i = iOpenHeapSize++;
+	while (i != 0)
+	{
+		INT32 const parent = (i - 1) / OPENHEAP_ARITY;
+		if (!OpenListBefore(pNew, pOpenHeap[parent])) break;
+		pOpenHeap[i] = pOpenHeap[parent];
+		i = parent;
+	}
+	pOpenHeap[i] = pNew;
+}
+
+
+static void OpenHeapRemoveHead(void)
+{
+	path_t* const pDel  = pOpenHeap[0];
+	path_t* const pLast = pOpenHeap[--iOpenHeapSize];
+	INT32 i = 0;
+	for (;;)
+	{
+		INT32 const first = i * OPENHEAP_ARITY + 1;
+		if (first >= iOpenHeapSize) break;
+		INT32 const end  = __min(first + OPENHEAP_ARITY, iOpenHeapSize);
+		INT32       best = first;
+		for (INT32 c = first + 1; c < end; ++c)
+		{
+			if (OpenListBefore(pOpenHeap[c], pOpenHeap[best])) best = c;
+		}
+		if (!OpenListBefore(pOpenHeap[best], pLast)) break;
+		pOpenHeap[i] = pOpenHeap[best];
+		i = best;
+	}
+	pOpenHeap[i] = pLast;
+	ClosedListAdd( pDel );
+}
+
+
 void InitPathAI(void)
 {
 	pathQ         = MALLOCN( path_t,        ABSMAX_PATHQ);
@@ -456,7 +535,7 @@ static void RestorePathAIToDefaults(void)
 ///////////////////////////////////////////////////////////////////////
 //	FINDBESTPATH                                                   /
 ////////////////////////////////////////////////////////////////////////
-INT32 FindBestPath(SOLDIERTYPE* s, INT16 sDestination, INT8 ubLevel, INT16 usMovementMode, INT8 bCopy, UINT8 fFlags)
+static INT32 InternalFindBestPath(SOLDIERTYPE* s, INT16 sDestination, INT8 ubLevel, INT16 usMovementMode, INT8 bCopy, UINT8 fFlags)
 {
 	INT32 iDestination = sDestination, iOrigination;
 	UINT8 ubCnt = 0 , ubLoopStart = 0, ubLoopEnd = 0, ubLastDir = 0, ubStructIndex;
@@ -634,6 +713,15 @@ INT32 FindBestPath(SOLDIERTYPE* s, INT16 sDestination, INT8 ubLevel, INT16 usMov
 		{
 			return( FALSE );
 		}
+
+		// a destination in another region cannot be reached, so don't flood
+		// the whole region of the origin to find that out
+		if (gfPathAroundObstacles && !fCloseGoodEnough && !PathRegionsConnected(s->sGridNo, sDestination, ubLevel))
+		{
+			gubNPCAPBudget = 0;
+			gubNPCDistLimit = 0;
+			return( 0 );
+		}
 	}
 
 	if (gubNPCAPBudget)
@@ -732,6 +820,8 @@ INT32 FindBestPath(SOLDIERTYPE* s, INT16 sDestination, INT8 ubLevel, INT16 usMov
 	}
 #endif
 
+	fHeapOpenList = gPathAIOpenList == PATHAI_OPENLIST_HEAP;
+	iOpenHeapSize = 0;
 	bSkipListLevel = 1;
 	iSkipListSize = 0;
 	iClosedListSize = 0;
@@ -794,12 +884,19 @@ INT32 FindBestPath(SOLDIERTYPE* s, INT16 sDestination, INT8 ubLevel, INT16 usMov
 	pathQ[1].usTotalCost = pathQ[1].usCostSoFar + pathQ[1].usCostToGo;
 	pathQ[1].ubLegDistance = LEGDISTANCE( iLocX, iLocY, iDestX, iDestY );
 	pathQ[1].bLevel = 1;
-	pQueueHead->pNext[0] = &( pathQ[1] );
-	iSkipListSize++;
+	if (fHeapOpenList)
+	{
+		OpenHeapInsert( &( pathQ[1] ) );
+	}
+	else
+	{
+		pQueueHead->pNext[0] = &( pathQ[1] );
+		iSkipListSize++;
+	}
 
 	trailTreeNdx = 0;
 	trailCost[iOrigination] = 0;
-	pCurrPtr = pQueueHead->pNext[0];
+	pCurrPtr = pathQHead;
 	pCurrPtr->sPathNdx = trailTreeNdx;
 	trailTreeNdx++;
 
@@ -807,7 +904,7 @@ INT32 FindBestPath(SOLDIERTYPE* s, INT16 sDestination, INT8 ubLevel, INT16 usMov
 	do
 	{
 		//remove the first and best path so far from the que
-		pCurrPtr = pQueueHead->pNext[0];
+		pCurrPtr = pathQHead;
 		curLoc = pCurrPtr->iLocation;
 		curCost = pCurrPtr->usCostSoFar;
 		sCurPathNdx = pCurrPtr->sPathNdx;
@@ -1332,38 +1429,9 @@ INT32 FindBestPath(SOLDIERTYPE* s, INT16 sDestination, INT8 ubLevel, INT16 usMov
 			{
 				switch(nextCost)
 				{
-					case TRAVELCOST_NONE:
-						ubAPCost = 0;
-						break;
-
-					case TRAVELCOST_DIRTROAD:
-					case TRAVELCOST_FLAT:
-						ubAPCost = AP_MOVEMENT_FLAT;
-						break;
-					//case TRAVELCOST_BUMPY:
-					case TRAVELCOST_GRASS:
-						ubAPCost = AP_MOVEMENT_GRASS;
-						break;
-					case TRAVELCOST_THICK:
-						ubAPCost = AP_MOVEMENT_BUSH;
-						break;
-					case TRAVELCOST_DEBRIS:
-						ubAPCost = AP_MOVEMENT_RUBBLE;
-						break;
-					case TRAVELCOST_SHORE:
-						ubAPCost = AP_MOVEMENT_SHORE; // wading shallow water
-						break;
-					case TRAVELCOST_KNEEDEEP:
-						ubAPCost = AP_MOVEMENT_LAKE; // wading waist/chest deep - very slow
-						break;
-
-					case TRAVELCOST_DEEPWATER:
-						ubAPCost = AP_MOVEMENT_OCEAN; // can swim, so it's faster than wading
-						break;
-
-					//case TRAVELCOST_DOOR:
-					//	ubAPCost = AP_MOVEMENT_FLAT;
-					//	break;
+					case TRAVELCOST_DOOR:
+					case TRAVELCOST_OBSTACLE:
+						goto NEXTDIR; // Cost too much to be considered!
 
 					case TRAVELCOST_FENCE:
 						ubAPCost = AP_JUMPFENCE;
@@ -1404,9 +1472,13 @@ INT32 FindBestPath(SOLDIERTYPE* s, INT16 sDestination, INT8 ubLevel, INT16 usMov
 
 						break;
 
-					case TRAVELCOST_OBSTACLE:
 					default:
-						goto NEXTDIR; // Cost too much to be considered!
+					{
+						INT8 const terrain_aps = TravelCostAPs((UINT8)nextCost);
+						if (terrain_aps < 0) goto NEXTDIR; // Cost too much to be considered!
+						ubAPCost = terrain_aps;
+						break;
+					}
 				}
 
 
@@ -1490,12 +1562,12 @@ INT32 FindBestPath(SOLDIERTYPE* s, INT16 sDestination, INT8 ubLevel, INT16 usMov
 				}
 
 
-				ubNewAPCost = ubCurAPCost + ubAPCost;
-
-
-				if (ubNewAPCost > gubNPCAPBudget)
+				// compare before storing, so the UINT8 can't wrap to a cheap cost
+				if (ubCurAPCost + ubAPCost > gubNPCAPBudget)
 				goto NEXTDIR;
 
+				ubNewAPCost = ubCurAPCost + ubAPCost;
+
 			}
 
 			if ( fCloseGoodEnough )
@@ -1570,7 +1642,7 @@ INT32 FindBestPath(SOLDIERTYPE* s, INT16 sDestination, INT8 ubLevel, INT16 usMov
 					pNewPtr = pathQ + (queRequests);
 					queRequests++;
 					std::fill_n(pNewPtr->pNext, ABSMAX_SKIPLIST_LEVEL, nullptr);
-					pNewPtr->bLevel = RandomSkipListLevel();
+					pNewPtr->bLevel = fHeapOpenList ? 1 : RandomSkipListLevel();
 				}
 				else if (iClosedListSize > 0)
 				{
@@ -1579,7 +1651,7 @@ INT32 FindBestPath(SOLDIERTYPE* s, INT16 sDestination, INT8 ubLevel, INT16 usMov
 					iClosedListSize--;
 					queRequests++;
 					std::fill_n(pNewPtr->pNext, ABSMAX_SKIPLIST_LEVEL, nullptr);
-					pNewPtr->bLevel = RandomSkipListLevel();
+					pNewPtr->bLevel = fHeapOpenList ? 1 : RandomSkipListLevel();
 				}
 				else
 				{
@@ -1660,6 +1732,11 @@ INT32 FindBestPath(SOLDIERTYPE* s, INT16 sDestination, INT8 ubLevel, INT16 usMov
 				// COMMENTED OUT TO DO BOUNDS CHECKER CC JAN 18 99
 				//QUEINSERT(pNewPtr);
 				//#define SkipListInsert( pNewPtr )
+				if (fHeapOpenList)
+				{
+					OpenHeapInsert( pNewPtr );
+				}
+				else
 				{
 					pCurr = pQueueHead;
 					uiCost = TOTALCOST( pNewPtr );
@@ -1824,7 +1901,7 @@ ENDOFLOOP:
 		INT16 z,_z,_nextLink; //,tempgrid;
 
 		_z=0;
-		z = (INT16) pQueueHead->pNext[0]->sPathNdx;
+		z = (INT16) pathQHead->sPathNdx;
 
 		while (z)
 		{
@@ -1916,6 +1993,193 @@ ENDOFLOOP:
 	return(0);
 }
 
+
+// Results of the last path searches, reused while nothing they depend on changed
+#define PATH_CACHE_SIZE				16
+
+struct PathCacheKey
+{
+	UINT32  uiCostsVersion;
+	UINT32  uiStructuresVersion;
+	UINT32  uiStatusFlags;
+	INT16   sOrigination;
+	INT16   sDestination;
+	UINT16  usMovementMode;
+	UINT8   ubID;
+	UINT8   ubBodyType;
+	UINT8   fFlags;
+	INT8    bCopy;
+	INT8    bLevel;
+	INT8    bDirection;
+	INT8    bSide;
+	INT8    bHasKeys;
+	BOOLEAN fAutoBandageMode;
+	BOOLEAN fPlotPathToExitGrid;
+	BOOLEAN fEstimatePath;
+	BOOLEAN fPathAroundObstacles;
+	BOOLEAN fPlotDirectPath;
+};
+
+struct PathCacheEntry
+{
+	PathCacheKey key;
+	UINT32       uiLastUse; // 0 if the entry is unused
+	INT32        iResult;
+	UINT16       usPathSize;
+	UINT8        ubPathingData[256];
+};
+
+static PathCacheEntry gPathCache[PATH_CACHE_SIZE];
+static UINT32         guiPathCacheUses;
+static UINT32         guiPathCacheHits;
+static UINT32         guiPathCacheMisses;
+static UINT32         guiPathCacheUncacheable;
+UINT32                guiPathCacheGeneration;
+
+
+static bool PathCacheKeysEqual(const PathCacheKey& a, const PathCacheKey& b)
+{
+	return
+		a.uiCostsVersion       == b.uiCostsVersion       &&
+		a.uiStructuresVersion  == b.uiStructuresVersion  &&
+		a.uiStatusFlags        == b.uiStatusFlags        &&
+		a.sOrigination         == b.sOrigination         &&
+		a.sDestination         == b.sDestination         &&
+		a.usMovementMode       == b.usMovementMode       &&
+		a.ubID                 == b.ubID                 &&
+		a.ubBodyType           == b.ubBodyType           &&
+		a.fFlags               == b.fFlags               &&
+		a.bCopy                == b.bCopy                &&
+		a.bLevel               == b.bLevel               &&
+		a.bDirection           == b.bDirection           &&
+		a.bSide                == b.bSide                &&
+		a.bHasKeys             == b.bHasKeys             &&
+		a.fAutoBandageMode     == b.fAutoBandageMode     &&
+		a.fPlotPathToExitGrid  == b.fPlotPathToExitGrid  &&
+		a.fEstimatePath        == b.fEstimatePath        &&
+		a.fPathAroundObstacles == b.fPathAroundObstacles &&
+		a.fPlotDirectPath      == b.fPlotDirectPath;
+}
+
+
+/* Searches which fill the reachable flags or the AI path costs, are limited by
+ * an AP budget or a distance, or run with enlarged limits have side effects or
+ * depend on state which is not part of the key, so they are not cached. */
+static bool MakePathCacheKey(PathCacheKey& k, const SOLDIERTYPE* s, INT16 sDestination, INT8 ubLevel, INT16 usMovementMode, INT8 bCopy, UINT8 fFlags)
+{
+	if (bCopy != COPYROUTE && bCopy != NO_COPYROUTE) return false;
+	if (gubNPCAPBudget != 0 || gubNPCDistLimit != 0) return false;
+	if (sDestination == NOWHERE || gfGeneratingMapEdgepoints) return false;
+	if (iMaxTrailTree != MAX_TRAIL_TREE || iMaxPathQ != MAX_PATHQ) return false;
+
+	k.uiCostsVersion       = guiMovementCostsVersion;
+	k.uiStructuresVersion  = guiStructuresVersion;
+	k.uiStatusFlags        = s->uiStatusFlags;
+	k.sOrigination         = s->sGridNo;
+	k.sDestination         = sDestination;
+	k.usMovementMode       = usMovementMode;
+	k.ubID                 = s->ubID;
+	k.ubBodyType           = s->ubBodyType;
+	k.fFlags               = fFlags | gubGlobalPathFlags;
+	k.bCopy                = bCopy;
+	k.bLevel               = ubLevel;
+	k.bDirection           = s->bDirection;
+	k.bSide                = s->bSide;
+	k.bHasKeys             = s->bHasKeys;
+	k.fAutoBandageMode     = gTacticalStatus.fAutoBandageMode;
+	k.fPlotPathToExitGrid  = gfPlotPathToExitGrid;
+	k.fEstimatePath        = gfEstimatePath;
+	k.fPathAroundObstacles = gfPathAroundObstacles;
+	k.fPlotDirectPath      = gfPlotDirectPath;
+	return true;
+}
+
+
+INT32 FindBestPath(SOLDIERTYPE* const s, INT16 const sDestination, INT8 const ubLevel, INT16 const usMovementMode, INT8 const bCopy, UINT8 const fFlags)
+{
+	AI_TIME_SCOPE(AI_TIMER_PATH);
+	ProfilerCount(PROFILE_PATHS, 1);
+	PathCacheKey key;
+	if (!MakePathCacheKey(key, s, sDestination, ubLevel, usMovementMode, bCopy, fFlags))
+	{
+		guiPathCacheUncacheable++;
+		return InternalFindBestPath(s, sDestination, ubLevel, usMovementMode, bCopy, fFlags);
+	}
+
+	PathCacheEntry* lru = &gPathCache[0];
+	FOR_EACH(PathCacheEntry, e, gPathCache)
+	{
+		if (e->uiLastUse != 0 && PathCacheKeysEqual(e->key, key))
+		{
+			guiPathCacheHits++;
+			ProfilerCount(PROFILE_PATH_CACHE_HITS, 1);
+			e->uiLastUse = ++guiPathCacheUses;
+			gubNPCPathCount++;
+			if (e->iResult != 0)
+			{
+				if (bCopy == COPYROUTE)
+				{
+					std::copy_n(e->ubPathingData, e->usPathSize, s->ubPathingData);
+					s->ubPathIndex    = 0;
+					s->ubPathDataSize = (UINT8)e->usPathSize;
+				}
+				else
+				{
+					std::copy_n(e->ubPathingData, e->usPathSize, guiPathingData);
+					giPathDataSize = e->usPathSize;
+				}
+			}
+			return e->iResult;
+		}
+		if (e->uiLastUse < lru->uiLastUse) lru = e;
+	}
+
+	guiPathCacheMisses++;
+	INT32 const result = InternalFindBestPath(s, sDestination, ubLevel, usMovementMode, bCopy, fFlags);
+
+	// A search which found a path copied it, see above
+	lru->key       = key;
+	lru->uiLastUse = ++guiPathCacheUses;
+	lru->iResult   = result;
+	if (result == 0)
+	{
+		lru->usPathSize = 0;
+	}
+	else if (bCopy == COPYROUTE)
+	{
+		lru->usPathSize = s->ubPathDataSize;
+		std::copy_n(s->ubPathingData, lru->usPathSize, lru->ubPathingData);
+	}
+	else
+	{
+		lru->usPathSize = (UINT16)giPathDataSize;
+		std::copy_n(guiPathingData, lru->usPathSize, lru->ubPathingData);
+	}
+	return result;
+}
+
+
+void InvalidatePathCache(void)
+{
+	FOR_EACH(PathCacheEntry, e, gPathCache) e->uiLastUse = 0;
+	++guiPathCacheGeneration;
+}
+
+
+void DebugPathAIPage(void)
+{
+	MPageHeader(L"DEBUG PATHAI PAGE 1 OF 1");
+	INT32 y = DEBUG_PAGE_START_Y;
+	INT32 h = DEBUG_PAGE_LINE_HEIGHT;
+
+	UINT32 const lookups = guiPathCacheHits + guiPathCacheMisses;
+	MPrintStat(DEBUG_PAGE_FIRST_COLUMN, y += h, L"Path cache hits:",   guiPathCacheHits);
+	MPrintStat(DEBUG_PAGE_FIRST_COLUMN, y += h, L"Path cache misses:", guiPathCacheMisses);
+	MPrintStat(DEBUG_PAGE_FIRST_COLUMN, y += h, L"Not cacheable:",     guiPathCacheUncacheable);
+	mprintf(DEBUG_PAGE_FIRST_COLUMN, y += h, L"Hit rate %d%%", lookups != 0 ? guiPathCacheHits * 100 / lookups : 0);
+	mprintf(DEBUG_PAGE_FIRST_COLUMN, y += h, L"Nodes expanded %u", uiPathNodesExpanded);
+}
+
 void GlobalReachableTest( INT16 sStartGridNo )
 {
 	SOLDIERTYPE s;
@@ -2265,7 +2529,7 @@ INT16 PlotPath(SOLDIERTYPE* const pSold, const INT16 sDestGridno, const INT8 bCo
 				switch( usMovementModeToUseForAPs )
 				{
 					case RUNNING:
-						sPoints += (INT16)((DOUBLE)(sTileCost) / RUNDIVISOR) + sExtraCostStand;	break;
+						sPoints += MovementModeAPs(sTileCost, RUNNING) + sExtraCostStand;	break;
 					case WALKING :
 						sPoints += (sTileCost + WALKCOST) + sExtraCostStand;
 						break;
@@ -2298,7 +2562,7 @@ INT16 PlotPath(SOLDIERTYPE* const pSold, const INT16 sDestGridno, const INT8 bCo
 				sPointsSwat += (sTileCost + SWATCOST) + sExtraCostSwat;
 
 				// now get cost as if RUNNING
-				sPointsRun += (INT16)((DOUBLE)(sTileCost) / RUNDIVISOR) + sExtraCostStand;
+				sPointsRun += MovementModeAPs(sTileCost, RUNNING) + sExtraCostStand;
 			}
 
 			if ( iCnt == 0 && bPlot )
@@ -2728,3 +2992,71 @@ UINT8 DoorTravelCost(const SOLDIERTYPE* pSoldier, INT32 iGridNo, UINT8 ubMovemen
 {
 	return( InternalDoorTravelCost( pSoldier, iGridNo, ubMovementCost, fReturnPerceivedValue, piDoorGridNo, FALSE ) );
 }
+
+
+UINT32 PathAINodesExpanded(void)
+{
+	return uiPathNodesExpanded;
+}
+
+
+void BenchmarkPathAI(SOLDIERTYPE* const s)
+{
+	static char const* const names[] = { "skip list", "heap" };
+	static PathAIOpenList const lists[] = { PATHAI_OPENLIST_SKIPLIST, PATHAI_OPENLIST_HEAP };
+
+	PathAIOpenList const old_list = gPathAIOpenList;
+	std::vector<INT32> lengths[lengthof(lists)];
+	for (size_t l = 0; l != lengthof(lists); ++l)
+	{
+		gPathAIOpenList = lists[l];
+		UINT32   const nodes_before = uiPathNodesExpanded;
+		UINT32         paths        = 0;
+		uint64_t const start        = SDL_GetPerformanceCounter();
+		for (INT32 dest = 0; dest < WORLD_MAX; dest += 37)
+		{
+			INT32 const len = InternalFindBestPath(s, dest, s->bLevel, WALKING, NO_COPYROUTE, 0);
+			lengths[l].push_back(len);
+			if (len != 0) ++paths;
+		}
+		SLOGI("Path benchmark, %s: %u paths found, %u nodes expanded, %.2f ms",
+			names[l], paths, uiPathNodesExpanded - nodes_before, MSSince(start));
+	}
+	gPathAIOpenList = old_list;
+
+	if (lengths[0] != lengths[1])
+	{
+		SLOGW("Path benchmark: the open lists found paths of different length");
+	}
+}
+
+
+#ifdef WITH_UNITTESTS
+#undef FAIL
+#include "gtest/gtest.h"
+
+TEST(PathAI, cacheKeyCoversDirectPath)
+{
+	SOLDIERTYPE s;
+	s = SOLDIERTYPE{};
+	s.sGridNo = 100;
+
+	// The same query once as a normal and once as a shift plotted path
+	BOOLEAN const direct = gfPlotDirectPath;
+	PathCacheKey normal;
+	PathCacheKey shifted;
+	PathCacheKey again;
+
+	gfPlotDirectPath = FALSE;
+	ASSERT_TRUE(MakePathCacheKey(normal, &s, 200, 0, WALKING, NO_COPYROUTE, 0));
+	gfPlotDirectPath = TRUE;
+	ASSERT_TRUE(MakePathCacheKey(shifted, &s, 200, 0, WALKING, NO_COPYROUTE, 0));
+	gfPlotDirectPath = FALSE;
+	ASSERT_TRUE(MakePathCacheKey(again, &s, 200, 0, WALKING, NO_COPYROUTE, 0));
+	gfPlotDirectPath = direct;
+
+	EXPECT_FALSE(PathCacheKeysEqual(normal, shifted));
+	EXPECT_TRUE(PathCacheKeysEqual(normal, again));
+}
+
+#endif
@@ -30,6 +30,33 @@ UINT8 InternalDoorTravelCost(const SOLDIERTYPE* pSoldier, INT32 iGridNo, UINT8 u
 
 INT16 RecalculatePathCost( SOLDIERTYPE *pSoldier, UINT16 usMovementMode );
 
+/* The priority queue holding the open list of FindBestPath(). Both find the
+ * same paths. */
+enum PathAIOpenList
+{
+	PATHAI_OPENLIST_SKIPLIST,
+	PATHAI_OPENLIST_HEAP
+};
+extern PathAIOpenList gPathAIOpenList;
+
+/* Finds paths from the soldier to tiles spread over the map with every open
+ * list and logs the number of paths found, the nodes expanded and the time
+ * taken. */
+void BenchmarkPathAI(SOLDIERTYPE*);
+
+// counts the nodes taken off the open list by all searches so far
+UINT32 PathAINodesExpanded(void);
+
+/* FindBestPath() keeps the results of the last searches and returns them again
+ * while the movement costs and the structures in the world are unchanged. Call
+ * this after changing anything else a search depends on, e.g. the perceived
+ * state of a door or the mine flags of a tile. */
+void InvalidatePathCache(void);
+// counts the calls of InvalidatePathCache(), for caches built on top of paths
+extern UINT32 guiPathCacheGeneration;
+
+void DebugPathAIPage(void);
+
 // Exporting these global variables
 extern UINT8 guiPathingData[256];
 extern UINT8 gubNPCAPBudget;
@@ -0,0 +1,232 @@
+#include "Path_Batch.h"
+#include "Animation_Control.h"
+#include "Isometric_Utils.h"
+#include "Overhead.h"
+#include "PathAI.h"
+#include "Points.h"
+#include "Soldier_Control.h"
+#include "WorkerPool.h"
+#include "WorldDef.h"
+
+#include <algorithm>
+#include <functional>
+#include <utility>
+#include <vector>
+
+
+#define NO_PATH 0xFFFFFFFF
+
+
+struct PathCostField
+{
+	SOLDIERTYPE const*  soldier;
+	// what the field was made for
+	UINT8               ubID;
+	INT16               sGridNo;
+	INT8                bLevel;
+	INT8                bStealthMode;
+	UINT32              uiMovementCostsVersion;
+	UINT32              uiPathCacheGeneration;
+
+	std::vector<UINT32> cost;   // per grid no, without the APs to start moving
+	std::vector<UINT32> landed; // per grid no, for landing there from a fence jump
+};
+
+static std::vector<PathCostField> g_fields;
+static UINT                       g_n_fields;
+
+
+/* Dijkstra's search over the movement costs, run on a worker thread. It only
+ * reads the world and writes the field it is handed. The step costs are those
+ * PlotPath() adds up for walking, including standing up after a fence jump
+ * only if the path goes on from where it lands. */
+static void BuildPathCostField(UINT const i, void* const ctx)
+{
+	PathCostField&       f      = static_cast<PathCostField*>(ctx)[i];
+	SOLDIERTYPE const*   s      = f.soldier;
+	INT8 const           level  = f.bLevel;
+	std::vector<UINT32>& cost   = f.cost;
+	std::vector<UINT32>& landed = f.landed;
+	std::fill(cost.begin(),   cost.end(),   NO_PATH);
+	std::fill(landed.begin(), landed.end(), NO_PATH);
+
+	// cost so far, tile * 2 + whether it was reached by a fence jump
+	typedef std::pair<UINT32, UINT32> OpenNode;
+	std::vector<OpenNode> open;
+	cost[f.sGridNo] = 0;
+	open.push_back(OpenNode(0, f.sGridNo * 2));
+	while (!open.empty())
+	{
+		std::pop_heap(open.begin(), open.end(), std::greater<OpenNode>());
+		OpenNode const cur = open.back();
+		open.pop_back();
+		GridNo const here      = cur.second / 2;
+		bool   const from_jump = cur.second & 1;
+		// skip tiles which were reached more cheaply since they were queued
+		if (cur.first != (from_jump ? landed : cost)[here]) continue;
+		// stand up after the jump, before moving on
+		UINT32 const start = cur.first + (from_jump ? AP_CROUCH : 0);
+
+		for (UINT8 dir = 0; dir != NUM_WORLD_DIRECTIONS; ++dir)
+		{
+			GridNo next = NewGridNo(here, DirectionInc(dir));
+			if (next == here) continue;
+
+			UINT8 const travel_cost = gubWorldMovementCosts[next][dir][level];
+			INT32       step        = TerrainActionPoints(s, next, dir, level);
+			if (step >= 100) continue; // blocked
+
+			if (travel_cost == TRAVELCOST_FENCE)
+			{
+				// the jump over the fence lands on the tile beyond it
+				GridNo const landing = NewGridNo(next, DirectionInc(dir));
+				if (landing == next) continue;
+				if (TerrainActionPoints(s, landing, dir, level) >= 100) continue;
+				next = landing;
+			}
+			else if (step > 0)
+			{
+				step += WALKCOST;
+				// duck the head
+				if (travel_cost == TRAVELCOST_NOT_STANDING) step += AP_CROUCH;
+			}
+
+			bool     const jump     = travel_cost == TRAVELCOST_FENCE;
+			UINT32&        best     = (jump ? landed : cost)[next];
+			UINT32   const new_cost = start + step;
+			if (new_cost >= best) continue;
+			best = new_cost;
+			open.push_back(OpenNode(new_cost, next * 2 + jump));
+			std::push_heap(open.begin(), open.end(), std::greater<OpenNode>());
+		}
+	}
+
+	for (UINT32 k = 0; k != cost.size(); ++k) cost[k] = __min(cost[k], landed[k]);
+}
+
+
+void EstimatePathCosts(SOLDIERTYPE* const* const soldiers, UINT const n)
+{
+	if (g_fields.size() < n) g_fields.resize(n);
+	for (UINT i = 0; i != n; ++i)
+	{
+		SOLDIERTYPE const& s = *soldiers[i];
+		PathCostField&     f = g_fields[i];
+		f.soldier                = &s;
+		f.ubID                   = s.ubID;
+		f.sGridNo                = s.sGridNo;
+		f.bLevel                 = s.bLevel;
+		f.bStealthMode           = s.bStealthMode;
+		f.uiMovementCostsVersion = guiMovementCostsVersion;
+		f.uiPathCacheGeneration  = guiPathCacheGeneration;
+		f.cost.resize(WORLD_MAX);
+		f.landed.resize(WORLD_MAX);
+	}
+	g_n_fields = n;
+
+	RunParallel(n, BuildPathCostField, &g_fields[0]);
+}
+
+
+void EstimatePathCostsForTeam(UINT8 const team)
+{
+	// Without worker threads the searches would only be made up front instead of
+	// when needed
+	if (WorkerPoolSize() == 1) return;
+
+	std::vector<SOLDIERTYPE*> soldiers;
+	FOR_EACH_IN_TEAM(i, team)
+	{
+		SOLDIERTYPE& s = *i;
+		if (!s.bInSector || s.bLife < OKLIFE) continue;
+		if (s.uiStatusFlags & (SOLDIER_VEHICLE | SOLDIER_MULTITILE)) continue;
+		soldiers.push_back(&s);
+	}
+	if (soldiers.empty()) return;
+	EstimatePathCosts(&soldiers[0], soldiers.size());
+}
+
+
+INT16 GetBatchedPathCost(SOLDIERTYPE const* const s, GridNo const dest)
+{
+	for (UINT i = 0; i != g_n_fields; ++i)
+	{
+		PathCostField const& f = g_fields[i];
+		if (f.ubID != s->ubID) continue;
+
+		if (f.sGridNo                != s->sGridNo             ||
+			f.bLevel                 != s->bLevel              ||
+			f.bStealthMode           != s->bStealthMode        ||
+			f.uiMovementCostsVersion != guiMovementCostsVersion ||
+			f.uiPathCacheGeneration  != guiPathCacheGeneration)
+		{
+			return -1;
+		}
+
+		// like PlotPath(), there is no path to where we stand
+		if (dest == f.sGridNo) return 0;
+
+		UINT32 const cost = f.cost[dest];
+		if (cost == NO_PATH) return 0;
+		return (INT16)__min(cost + MinAPsToStartMovement(s, WALKING), 0x7FFF);
+	}
+	return -1;
+}
+
+
+#ifdef WITH_UNITTESTS
+#undef FAIL
+#include "gtest/gtest.h"
+
+#include <string.h>
+
+TEST(PathBatch, agreesWithPlotPathCosts)
+{
+	static UINT8 saved[WORLD_MAX][MAXDIR][2];
+	memcpy(saved, gubWorldMovementCosts, sizeof(saved));
+	memset(gubWorldMovementCosts, TRAVELCOST_OBSTACLE, sizeof(gubWorldMovementCosts));
+
+	// A patch of open ground and a corridor with a fence across it
+	for (INT16 row = 80; row != 84; ++row)
+	{
+		for (INT16 col = 80; col != 85; ++col)
+		{
+			memset(gubWorldMovementCosts[row * WORLD_COLS + col], TRAVELCOST_FLAT, sizeof(gubWorldMovementCosts[0]));
+		}
+	}
+	for (INT16 col = 80; col != 86; ++col)
+	{
+		memset(gubWorldMovementCosts[60 * WORLD_COLS + col], TRAVELCOST_FLAT, sizeof(gubWorldMovementCosts[0]));
+	}
+	gubWorldMovementCosts[60 * WORLD_COLS + 82][EAST][0] = TRAVELCOST_FENCE;
+
+	SOLDIERTYPE open;
+	open = SOLDIERTYPE{};
+	open.ubID    = 1;
+	open.sGridNo = 80 * WORLD_COLS + 80;
+	SOLDIERTYPE fence;
+	fence = SOLDIERTYPE{};
+	fence.ubID    = 2;
+	fence.sGridNo = 60 * WORLD_COLS + 80;
+
+	SOLDIERTYPE* const soldiers[] = { &open, &fence };
+	EstimatePathCosts(soldiers, lengthof(soldiers));
+
+	// What PlotPath() adds up for walking a flat straight and diagonal step
+	INT16 const straight = AP_MOVEMENT_FLAT + WALKCOST;
+	INT16 const diagonal = AP_MOVEMENT_FLAT * 14 / 10 + WALKCOST;
+
+	INT16 const start = MinAPsToStartMovement(&open, WALKING);
+	EXPECT_EQ(start + 2 * diagonal + straight, GetBatchedPathCost(&open, 82 * WORLD_COLS + 83));
+	EXPECT_EQ(start + 4 * straight,            GetBatchedPathCost(&open, 80 * WORLD_COLS + 84));
+	EXPECT_EQ(0,                               GetBatchedPathCost(&open, 70 * WORLD_COLS + 80));
+
+	// Standing up after the jump is only paid when walking on
+	INT16 const start_fence = MinAPsToStartMovement(&fence, WALKING);
+	EXPECT_EQ(start_fence + straight + AP_JUMPFENCE,                        GetBatchedPathCost(&fence, 60 * WORLD_COLS + 83));
+	EXPECT_EQ(start_fence + straight + AP_JUMPFENCE + AP_CROUCH + straight, GetBatchedPathCost(&fence, 60 * WORLD_COLS + 84));
+
+	memcpy(gubWorldMovementCosts, saved, sizeof(saved));
+}
+
+#endif
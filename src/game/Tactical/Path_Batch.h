@@ -0,0 +1,29 @@
+#ifndef PATH_BATCH_H
+#define PATH_BATCH_H
+
+#include "JA2Types.h"
+
+
+/* Estimates, for each soldier, the AP cost to walk to every tile of his level,
+ * ignoring people like EstimatePlotPath() does. The soldiers are searched in
+ * parallel on the worker threads. No copy of the world is made: the searches
+ * read the live movement costs, which cannot change while the calling thread
+ * waits for them.
+ *
+ * The estimate adds up the same step costs as PlotPath(), including doors,
+ * diagonal steps, ducking and fence jumps, plus the APs to start moving from
+ * the soldier's stance, but along the route which is cheapest in APs.
+ * EstimatePlotPath() adds them up along the route FindBestPath() picks by
+ * movement costs. Both agree where that route is also the cheapest in APs,
+ * e.g. on open ground, elsewhere the estimate may be lower. */
+void EstimatePathCosts(SOLDIERTYPE* const* soldiers, UINT n);
+
+// Starts a batch for the soldiers of an AI team at the start of its turn
+void EstimatePathCostsForTeam(UINT8 team);
+
+/* The estimated AP cost for the soldier to walk to the tile on his level, 0 if
+ * there is no path, or -1 if there is no estimate, e.g. because the soldier
+ * moved or the movement costs changed since the batch. */
+INT16 GetBatchedPathCost(SOLDIERTYPE const*, GridNo dest);
+
+#endif
@@ -0,0 +1,202 @@
+#include "Path_Benchmark.h"
+#include "Animation_Control.h"
+#include "Benchmark_Suite.h"
+#include "Campaign_Types.h"
+#include "ContentManager.h"
+#include "GameInstance.h"
+#include "Isometric_Utils.h"
+#include "Logger.h"
+#include "Profiler.h"
+#include "Overhead_Types.h"
+#include "PathAI.h"
+#include "Soldier_Control.h"
+#include "StrategicMap.h"
+#include "Strategic_Movement.h"
+#include "Strategic_Pathing.h"
+#include "WorldDef.h"
+
+#include <SDL.h>
+
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+
+#define BENCH_PATHS            256 // FindBestPath() searches per map
+#define BENCH_GLOBAL_REACHABLE 4   // GlobalReachableTest() calls per map
+#define BENCH_LOCAL_REACHABLE  16  // LocalReachableTest() calls per map
+#define BENCH_LOCAL_RADIUS     20
+#define BENCH_STRAT_PATHS      256
+
+
+struct PathBenchResult
+{
+	UINT32 paths;     // searches which found a path
+	UINT32 length;    // summed length of the paths found
+	UINT32 nodes;     // nodes expanded
+	UINT32 reachable; // tiles found by the global reachable tests
+	double path_ms;
+	double reachable_ms;
+};
+
+
+/* A linear congruential generator, so the tiles picked do not depend on the
+ * state of Random() */
+static UINT32 NextSample(UINT32& seed)
+{
+	seed = seed * 1103515245 + 12345;
+	return (seed >> 16) & 0x7FFF;
+}
+
+
+// Picks a tile which can be entered at all, or NOWHERE
+static GridNo SampleTile(UINT32& seed)
+{
+	for (UINT tries = 0; tries != 64; ++tries)
+	{
+		GridNo const g = (NextSample(seed) << 15 | NextSample(seed)) % WORLD_MAX;
+		for (UINT8 dir = 0; dir != NUM_WORLD_DIRECTIONS; ++dir)
+		{
+			if (gubWorldMovementCosts[g][dir][0] < TRAVELCOST_BLOCKED) return g;
+		}
+	}
+	return NOWHERE;
+}
+
+
+static UINT32 CountReachableTiles()
+{
+	UINT32 n = 0;
+	FOR_EACH_WORLD_TILE(i)
+	{
+		if (i->uiFlags & MAPELEMENT_REACHABLE) ++n;
+	}
+	return n;
+}
+
+
+static PathBenchResult BenchmarkMap(UINT32 seed)
+{
+	static UINT16 const modes[] = { WALKING, RUNNING, SWATTING, CRAWLING };
+
+	PathBenchResult r = PathBenchResult();
+	SOLDIERTYPE s = SOLDIERTYPE{};
+	s.bTeam      = ENEMY_TEAM;
+	s.bSide      = 1;
+	s.bDirection = NORTH;
+
+	UINT32   const nodes_before = PathAINodesExpanded();
+	uint64_t       start        = SDL_GetPerformanceCounter();
+	for (UINT i = 0; i != BENCH_PATHS; ++i)
+	{
+		GridNo const from = SampleTile(seed);
+		GridNo const to   = SampleTile(seed);
+		if (from == NOWHERE || to == NOWHERE) continue;
+		s.sGridNo = from;
+		INT32 const len = FindBestPath(&s, to, 0, modes[i % lengthof(modes)], NO_COPYROUTE, 0);
+		if (len == 0) continue;
+		++r.paths;
+		r.length += len;
+	}
+	r.path_ms = MSSince(start);
+	r.nodes   = PathAINodesExpanded() - nodes_before;
+
+	start = SDL_GetPerformanceCounter();
+	for (UINT i = 0; i != BENCH_GLOBAL_REACHABLE; ++i)
+	{
+		GridNo const g = SampleTile(seed);
+		if (g == NOWHERE) continue;
+		GlobalReachableTest(g);
+		r.reachable += CountReachableTiles();
+	}
+	for (UINT i = 0; i != BENCH_LOCAL_REACHABLE; ++i)
+	{
+		GridNo const g = SampleTile(seed);
+		if (g == NOWHERE) continue;
+		LocalReachableTest(g, BENCH_LOCAL_RADIUS);
+	}
+	r.reachable_ms = MSSince(start);
+	return r;
+}
+
+
+static void BenchmarkStrategicPaths(FILE* const f)
+{
+	GROUP g = GROUP();
+	g.ubTransportationMask = FOOT;
+
+	InvalidateStrategicPaths();
+	UINT32         seed   = 0;
+	UINT32         paths  = 0;
+	UINT32         length = 0;
+	uint64_t const start  = SDL_GetPerformanceCounter();
+	for (UINT i = 0; i != BENCH_STRAT_PATHS; ++i)
+	{
+		INT16 const from = CALCULATE_STRATEGIC_INDEX(1 + NextSample(seed) % 16, 1 + NextSample(seed) % 16);
+		INT16 const to   = CALCULATE_STRATEGIC_INDEX(1 + NextSample(seed) % 16, 1 + NextSample(seed) % 16);
+		INT32 const len  = FindStratPath(from, to, g, FALSE);
+		if (len == 0) continue;
+		++paths;
+		length += len;
+	}
+	double const ms = MSSince(start);
+
+	SLOGI("Path benchmark, strategic: %u paths, length %u, %.2f ms", paths, length, ms);
+	RecordBenchmarkResult("path.strategic_ms", ms);
+	if (f) fprintf(f, "strategic,%u,%u,,,%.3f,\n", paths, length, ms);
+}
+
+
+void BenchmarkAllMaps()
+{
+	std::string const path = GCM->getScreenshotFolder() + "/pathbench.csv";
+	FILE* const f = fopen(path.c_str(), "w");
+	if (!f) SLOGW("Failed to write the path benchmark %s", path.c_str());
+	if (f) fputs("map,paths,length,nodes,reachable,path_ms,reachable_ms\n", f);
+
+	std::vector<std::string> const maps = GCM->getAllMaps();
+	PathBenchResult total = PathBenchResult();
+	UINT32 seed = 1;
+	for (std::string const& map : maps)
+	{
+		try
+		{
+			LoadWorld(map.c_str());
+		}
+		catch (...)
+		{
+			SLOGW("Path benchmark: failed to load %s", map.c_str());
+			continue;
+		}
+
+		// every map gets its own sequence, so one map does not shift the others
+		PathBenchResult const r = BenchmarkMap(seed++);
+		SLOGD("Path benchmark, %s: %u paths, %u nodes, %.2f ms, reachable tests %.2f ms",
+			map.c_str(), r.paths, r.nodes, r.path_ms, r.reachable_ms);
+		if (f)
+		{
+			fprintf(f, "%s,%u,%u,%u,%u,%.3f,%.3f\n", map.c_str(),
+				r.paths, r.length, r.nodes, r.reachable, r.path_ms, r.reachable_ms);
+		}
+		total.paths        += r.paths;
+		total.length       += r.length;
+		total.nodes        += r.nodes;
+		total.reachable    += r.reachable;
+		total.path_ms      += r.path_ms;
+		total.reachable_ms += r.reachable_ms;
+	}
+	TrashWorld();
+
+	SLOGI("Path benchmark, %u maps: %u paths, length %u, %u nodes, %.2f ms, reachable tests %.2f ms",
+		(UINT32)maps.size(), total.paths, total.length, total.nodes, total.path_ms, total.reachable_ms);
+	RecordBenchmarkResult("path.search_ms",    total.path_ms);
+	RecordBenchmarkResult("path.reachable_ms", total.reachable_ms);
+	if (f)
+	{
+		fprintf(f, "total,%u,%u,%u,%u,%.3f,%.3f\n",
+			total.paths, total.length, total.nodes, total.reachable, total.path_ms, total.reachable_ms);
+	}
+
+	BenchmarkStrategicPaths(f);
+	if (f) fclose(f);
+}
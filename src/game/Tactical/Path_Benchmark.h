@@ -0,0 +1,13 @@
+#ifndef PATH_BENCHMARK_H
+#define PATH_BENCHMARK_H
+
+
+/* Loads every map of the game in turn and times the path searches on it:
+ * FindBestPath() between tiles picked by a fixed sequence, so every run
+ * searches the same paths, the reachable tests and, once, FindStratPath()
+ * between the sectors. The results are logged and written to pathbench.csv in
+ * the screenshot folder for comparing runs. The world is trashed afterwards, so
+ * this is only to be run while no sector is loaded, i.e. from the main menu. */
+void BenchmarkAllMaps();
+
+#endif
@@ -0,0 +1,109 @@
+#include "Path_Regions.h"
+#include "Debug_Pages.h"
+#include "Font.h"
+#include "Font_Control.h"
+#include "Isometric_Utils.h"
+#include "PathAI.h"
+#include "WorldDef.h"
+
+#include <algorithm>
+
+
+#define NO_REGION 0
+
+
+static UINT16 gusPathRegion[2][WORLD_MAX];
+static UINT16 gusNumPathRegions[2];
+static UINT32 guiPathRegionsVersion;
+static bool   gfPathRegionsBuilt;
+static UINT32 guiPathRegionRebuilds;
+static UINT32 guiPathRegionRejects;
+
+
+/* Whether a move in the direction onto the tile may be passable for anyone.
+ * Closed doors, exit grids and water depend on who moves, so they count as
+ * passable. */
+static bool MayEnter(GridNo const gridno, UINT8 const dir, INT8 const level)
+{
+	UINT8 const cost = gubWorldMovementCosts[gridno][dir][level];
+	return cost < TRAVELCOST_BLOCKED || cost == TRAVELCOST_EXITGRID;
+}
+
+
+static void BuildLevelRegions(INT8 const level)
+{
+	static GridNo stack[WORLD_MAX];
+
+	UINT16* const region = gusPathRegion[level];
+	std::fill_n(region, WORLD_MAX, NO_REGION);
+
+	UINT16 n_regions = 0;
+	for (GridNo start = 0; start != WORLD_MAX; ++start)
+	{
+		if (region[start] != NO_REGION) continue;
+
+		// Tiles which cannot be entered from anywhere become regions of their own
+		UINT16 const id = ++n_regions;
+		region[start] = id;
+		INT32 top = 0;
+		stack[top++] = start;
+		while (top != 0)
+		{
+			GridNo const cur = stack[--top];
+			UINT8  const height = gpWorldLevelData[cur].sHeight;
+			for (UINT8 dir = 0; dir != MAXDIR; ++dir)
+			{
+				INT32 const next = cur + DirIncrementer[dir];
+				if (next < 0 || WORLD_MAX <= next) continue;
+				if (region[next] != NO_REGION) continue;
+				if (gpWorldLevelData[next].sHeight != height) continue;
+				if (!MayEnter(next, dir, level) && !MayEnter(cur, OppositeDirection(dir), level)) continue;
+				region[next] = id;
+				stack[top++] = next;
+			}
+		}
+	}
+	gusNumPathRegions[level] = n_regions;
+}
+
+
+static void UpdatePathRegions()
+{
+	if (gfPathRegionsBuilt && guiPathRegionsVersion == guiMovementCostsVersion) return;
+	BuildLevelRegions(0);
+	BuildLevelRegions(1);
+	guiPathRegionsVersion = guiMovementCostsVersion;
+	gfPathRegionsBuilt    = true;
+	++guiPathRegionRebuilds;
+}
+
+
+bool PathRegionsConnected(GridNo const from, GridNo const to, INT8 const level)
+{
+	if (from < 0 || WORLD_MAX <= from) return true;
+	if (to   < 0 || WORLD_MAX <= to)   return true;
+	UpdatePathRegions();
+	UINT16 const* const region = gusPathRegion[level != 0];
+	if (region[from] == region[to]) return true;
+	++guiPathRegionRejects;
+	return false;
+}
+
+
+void DebugPathRegionsPage(void)
+{
+	MPageHeader(L"DEBUG PATH REGIONS PAGE 1 OF 1");
+	INT32 y = DEBUG_PAGE_START_Y;
+	INT32 h = DEBUG_PAGE_LINE_HEIGHT;
+
+	MPrintStat(DEBUG_PAGE_FIRST_COLUMN, y += h, L"Ground regions:",    gusNumPathRegions[0]);
+	MPrintStat(DEBUG_PAGE_FIRST_COLUMN, y += h, L"Roof regions:",      gusNumPathRegions[1]);
+	MPrintStat(DEBUG_PAGE_FIRST_COLUMN, y += h, L"Rebuilds:",          guiPathRegionRebuilds);
+	MPrintStat(DEBUG_PAGE_FIRST_COLUMN, y += h, L"Searches skipped:",  guiPathRegionRejects);
+
+	GridNo const gridno = GetMouseMapPos();
+	if (gridno != NOWHERE && gfPathRegionsBuilt)
+	{
+		MPrintStat(DEBUG_PAGE_FIRST_COLUMN, y += h, L"Region at cursor:", gusPathRegion[0][gridno]);
+	}
+}
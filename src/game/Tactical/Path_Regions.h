@@ -0,0 +1,16 @@
+#ifndef PATH_REGIONS_H
+#define PATH_REGIONS_H
+
+#include "JA2Types.h"
+
+
+/* Splits each level of the world into regions of tiles which are connected by
+ * moves that FindBestPath() could ever take, whoever is moving, regardless of
+ * doors, people or water. There is no path between tiles in different regions,
+ * so a search between them can be skipped. The regions are rebuilt on the
+ * first query after the movement costs changed. */
+bool PathRegionsConnected(GridNo from, GridNo to, INT8 level);
+
+void DebugPathRegionsPage(void);
+
+#endif
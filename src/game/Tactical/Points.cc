@@ -34,6 +34,107 @@
 
 #include "Logger.h"
 
+
+#define MAX_TABLED_TILE_APS 100 // what TerrainActionPoints() charges for a blocked tile, every other tile costs less
+
+enum MovementAPKind
+{
+	MOVE_APS_RUN,
+	MOVE_APS_WALK,
+	MOVE_APS_SWAT,
+	MOVE_APS_CRAWL,
+	NUM_MOVE_APS
+};
+
+static INT8  g_travel_cost_aps[256];
+static INT16 g_movement_aps[NUM_MOVE_APS][MAX_TABLED_TILE_APS + 1];
+
+
+static bool InitMovementAPTables()
+{
+	for (UINT i = 0; i != lengthof(g_travel_cost_aps); ++i) g_travel_cost_aps[i] = -1;
+	g_travel_cost_aps[TRAVELCOST_NONE]      = 0;
+	g_travel_cost_aps[TRAVELCOST_DIRTROAD]  = AP_MOVEMENT_FLAT;
+	g_travel_cost_aps[TRAVELCOST_FLAT]      = AP_MOVEMENT_FLAT;
+	g_travel_cost_aps[TRAVELCOST_GRASS]     = AP_MOVEMENT_GRASS;
+	g_travel_cost_aps[TRAVELCOST_THICK]     = AP_MOVEMENT_BUSH;
+	g_travel_cost_aps[TRAVELCOST_DEBRIS]    = AP_MOVEMENT_RUBBLE;
+	g_travel_cost_aps[TRAVELCOST_SHORE]     = AP_MOVEMENT_SHORE;  // wading shallow water
+	g_travel_cost_aps[TRAVELCOST_KNEEDEEP]  = AP_MOVEMENT_LAKE;   // wading waist/chest deep - very slow
+	g_travel_cost_aps[TRAVELCOST_DEEPWATER] = AP_MOVEMENT_OCEAN;  // can swim, so it's faster than wading
+	g_travel_cost_aps[TRAVELCOST_FENCE]     = AP_JUMPFENCE;
+	g_travel_cost_aps[TRAVELCOST_DOOR]      = AP_MOVEMENT_FLAT;
+
+	for (INT16 cost = 0; cost <= MAX_TABLED_TILE_APS; ++cost)
+	{
+		g_movement_aps[MOVE_APS_RUN][cost]   = (INT16)(((DOUBLE)cost) / RUNDIVISOR);
+		g_movement_aps[MOVE_APS_WALK][cost]  = cost + WALKCOST;
+		g_movement_aps[MOVE_APS_SWAT][cost]  = cost + SWATCOST;
+		g_movement_aps[MOVE_APS_CRAWL][cost] = cost + CRAWLCOST;
+	}
+	return true;
+}
+
+static bool const g_movement_ap_tables_ready = InitMovementAPTables();
+
+
+INT8 TravelCostAPs(UINT8 const travel_cost)
+{
+	return g_travel_cost_aps[travel_cost];
+}
+
+
+static MovementAPKind GetMovementAPKind(UINT16 const usMovementMode)
+{
+	switch (usMovementMode)
+	{
+		case RUNNING:
+		case ADULTMONSTER_WALKING:
+		case BLOODCAT_RUN:
+			return MOVE_APS_RUN;
+
+		case CROW_FLY:
+		case SIDE_STEP:
+		case WALK_BACKWARDS:
+		case ROBOT_WALK:
+		case BLOODCAT_WALK_BACKWARDS:
+		case MONSTER_WALK_BACKWARDS:
+		case LARVAE_WALK:
+		case KID_SKIPPING:
+		case WALKING:
+			return MOVE_APS_WALK;
+
+		case CROW_WALK:
+		case START_SWAT:
+		case SWAT_BACKWARDS:
+		case SWATTING:
+			return MOVE_APS_SWAT;
+
+		case CRAWLING:
+			return MOVE_APS_CRAWL;
+
+		default:
+			return NUM_MOVE_APS;
+	}
+}
+
+
+INT16 MovementModeAPs(INT16 const sTileCost, UINT16 const usMovementMode)
+{
+	MovementAPKind const kind = GetMovementAPKind(usMovementMode);
+	if (kind == NUM_MOVE_APS) return -1;
+	if (0 <= sTileCost && sTileCost <= MAX_TABLED_TILE_APS) return g_movement_aps[kind][sTileCost];
+
+	switch (kind)
+	{
+		case MOVE_APS_RUN:  return (INT16)(((DOUBLE)sTileCost) / RUNDIVISOR);
+		case MOVE_APS_WALK: return sTileCost + WALKCOST;
+		case MOVE_APS_SWAT: return sTileCost + SWATCOST;
+		default:            return sTileCost + CRAWLCOST;
+	}
+}
+
+
 INT16 TerrainActionPoints(const SOLDIERTYPE* const pSoldier, const INT16 sGridno, const INT8 bDir, const INT8 bLevel)
 {
 	INT16 sAPCost = 0;
@@ -65,34 +166,6 @@ INT16 TerrainActionPoints(const SOLDIERTYPE* const pSoldier, const INT16 sGridno
 
 	switch( sSwitchValue )
 	{
-		case TRAVELCOST_DIRTROAD:
-		case TRAVELCOST_FLAT:
-			sAPCost += AP_MOVEMENT_FLAT;
-			break;
-		//case TRAVELCOST_BUMPY:
-		case TRAVELCOST_GRASS:
-			sAPCost += AP_MOVEMENT_GRASS;
-			break;
-		case TRAVELCOST_THICK:
-			sAPCost += AP_MOVEMENT_BUSH;
-			break;
-		case TRAVELCOST_DEBRIS:
-			sAPCost += AP_MOVEMENT_RUBBLE;
-			break;
-		case TRAVELCOST_SHORE:
-			sAPCost += AP_MOVEMENT_SHORE; // wading shallow water
-			break;
-		case TRAVELCOST_KNEEDEEP:
-			sAPCost += AP_MOVEMENT_LAKE; // wading waist/chest deep - very slow
-			break;
-
-		case TRAVELCOST_DEEPWATER:
-			sAPCost += AP_MOVEMENT_OCEAN; // can swim, so it's faster than wading
-			break;
-		case TRAVELCOST_DOOR:
-			sAPCost += AP_MOVEMENT_FLAT;
-			break;
-
 		// cost for jumping a fence REPLACES all other AP costs!
 		case TRAVELCOST_FENCE:
 			return( AP_JUMPFENCE );
@@ -101,10 +174,18 @@ INT16 TerrainActionPoints(const SOLDIERTYPE* const pSoldier, const INT16 sGridno
 			return( 0 );
 
 		default:
-			SLOGD(
-				"Calc AP: Unrecongnized MP type %d in %d, direction %d",
-				sSwitchValue, sGridno, bDir);
+		{
+			INT8 const terrain_aps = TravelCostAPs((UINT8)sSwitchValue);
+			if (terrain_aps < 0)
+			{
+				SLOGD(
+					"Calc AP: Unrecongnized MP type %d in %d, direction %d",
+					sSwitchValue, sGridno, bDir);
+				break;
+			}
+			sAPCost += terrain_aps;
 			break;
+		}
 	}
 
 	if (bDir & 1)
@@ -274,43 +355,14 @@ INT16 ActionPointCost(const SOLDIERTYPE* const pSoldier, const INT16 sGridNo, co
 	// so, then we must modify it for other movement styles and accumulate
 	if (sTileCost > 0)
 	{
-		switch(usMovementMode)
+		sPoints = MovementModeAPs(sTileCost, usMovementMode);
+		if (sPoints < 0)
 		{
-			case RUNNING:
-			case ADULTMONSTER_WALKING:
-			case BLOODCAT_RUN:
-				sPoints = (INT16)( ((DOUBLE)sTileCost) / RUNDIVISOR);
-				break;
-
-			case CROW_FLY:
-			case SIDE_STEP:
-			case WALK_BACKWARDS:
-			case ROBOT_WALK:
-			case BLOODCAT_WALK_BACKWARDS:
-			case MONSTER_WALK_BACKWARDS:
-			case LARVAE_WALK:
-			case KID_SKIPPING:
-			case WALKING:
-				sPoints = (sTileCost + WALKCOST);
-				break;
-
-			case CROW_WALK:
-			case START_SWAT:
-			case SWAT_BACKWARDS:
-			case SWATTING:
-				sPoints = (sTileCost + SWATCOST);
-				break;
-			case CRAWLING:
-				sPoints = (sTileCost + CRAWLCOST);
-				break;
-
-			default:
-
-				// Invalid movement mode
-				SLOGW(
-					"Invalid movement mode %d used in ActionPointCost",
-					usMovementMode);
-				sPoints = 1;
+			// Invalid movement mode
+			SLOGW(
+				"Invalid movement mode %d used in ActionPointCost",
+				usMovementMode);
+			sPoints = 1;
 		}
 	}
 
@@ -348,43 +400,14 @@ INT16 EstimateActionPointCost( SOLDIERTYPE *pSoldier, INT16 sGridNo, INT8 bDir,
 	// so, then we must modify it for other movement styles and accumulate
 	if (sTileCost > 0)
 	{
-		switch(usMovementMode)
+		sPoints = MovementModeAPs(sTileCost, usMovementMode);
+		if (sPoints < 0)
 		{
-			case RUNNING:
-			case ADULTMONSTER_WALKING:
-			case BLOODCAT_RUN:
-				sPoints = (INT16)(((DOUBLE)sTileCost) / RUNDIVISOR);
-				break;
-
-			case CROW_FLY:
-			case SIDE_STEP:
-			case ROBOT_WALK:
-			case WALK_BACKWARDS:
-			case BLOODCAT_WALK_BACKWARDS:
-			case MONSTER_WALK_BACKWARDS:
-			case LARVAE_WALK:
-			case KID_SKIPPING:
-			case WALKING :
-				sPoints = (sTileCost + WALKCOST);
-				break;
-
-			case CROW_WALK:
-			case START_SWAT:
-			case SWAT_BACKWARDS:
-			case SWATTING:
-				sPoints = (sTileCost + SWATCOST);
-				break;
-			case CRAWLING:
-				sPoints = (sTileCost + CRAWLCOST);
-				break;
-
-			default:
-
-				// Invalid movement mode
-				SLOGW(
-					"Invalid movement mode %d used in EstimateActionPointCost",
-					usMovementMode);
-				sPoints = 1;
+			// Invalid movement mode
+			SLOGW(
+				"Invalid movement mode %d used in EstimateActionPointCost",
+				usMovementMode);
+			sPoints = 1;
 		}
 	}
 
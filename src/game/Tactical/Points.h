@@ -275,6 +275,13 @@
 
 UINT8 BaseAPsToShootOrStab(INT8 bAPs, INT8 bAimSkill, OBJECTTYPE const&);
 
+/* The APs of a step onto a tile of the travel cost (see gubWorldMovementCosts),
+ * walking straight and without modifiers. -1 if the travel cost is none of a
+ * terrain, fence or door. */
+INT8 TravelCostAPs(UINT8 travel_cost);
+/* The APs of a step with the tile cost, as given by TerrainActionPoints(), in
+ * the movement mode. -1 if the movement mode is none of moving. */
+INT16 MovementModeAPs(INT16 sTileCost, UINT16 usMovementMode);
 INT16 TerrainActionPoints(const SOLDIERTYPE* s, INT16 sGridno, INT8 bDir, INT8 bLevel);
 INT16 ActionPointCost(const SOLDIERTYPE* s, INT16 sGridNo, INT8 bDir, UINT16 usMovementMode);
 INT16 EstimateActionPointCost( SOLDIERTYPE *pSoldier, INT16 sGridNo, INT8 bDir, UINT16 usMovementMode, INT8 bPathIndex, INT8 bPathLength );
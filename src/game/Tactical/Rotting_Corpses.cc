@@ -48,6 +48,9 @@
 #include "GameInstance.h"
 #include "policy/GamePolicy.h"
 
+#include <algorithm>
+#include <unordered_map>
+
 #define CORPSE_WARNING_MAX			5
 #define CORPSE_WARNING_DIST			5
 
@@ -60,6 +63,17 @@
 #define MAX_NUM_CROWS				6
 
 
+/* Corpses of the same body type in the same clothes under the same light have
+ * the same shade tables, so they share one set */
+struct CorpseShadeTables
+{
+	UINT32  uiRefs;
+	UINT16* pShades[16];
+};
+
+static std::unordered_map<uint64_t, CorpseShadeTables> g_corpse_shades;
+
+
 // When adding a corpse, add struct data...
 static const char* const zCorpseFilenames[NUM_CORPSES] =
 {
@@ -538,16 +552,16 @@ catch (...) { return 0; }
 
 static void FreeCorpsePalettes(ROTTING_CORPSE* pCorpse)
 {
-	INT32 cnt;
+	if (pCorpse->pShades[0] == NULL) return;
+	std::fill(pCorpse->pShades, endof(pCorpse->pShades), (UINT16*)NULL);
 
-	for ( cnt = 0; cnt < NUM_CORPSE_SHADES; cnt++ )
-	{
-		if ( pCorpse->pShades[ cnt ] != NULL )
-		{
-			MemFree( pCorpse->pShades[ cnt ] );
-			pCorpse->pShades[ cnt ] = NULL;
-		}
-	}
+	std::unordered_map<uint64_t, CorpseShadeTables>::iterator const i = g_corpse_shades.find(pCorpse->uiShadesKey);
+	Assert(i != g_corpse_shades.end());
+	if (--i->second.uiRefs != 0) return;
+
+	// The last corpse with these tables is gone
+	FOR_EACH(UINT16*, t, i->second.pShades) MemFree(*t);
+	g_corpse_shades.erase(i);
 }
 
 
@@ -601,7 +615,11 @@ static void CreateCorpsePalette(ROTTING_CORPSE* const c)
 		pal = gpTileCache[c->pAniTile->sCachedTileID].pImagery->vo->Palette();
 	}
 
-	CreateBiasedShadedPalettes(c->pShades, pal);
+	uint64_t           const key = BiasedShadedPalettesKey(pal);
+	CorpseShadeTables&       t   = g_corpse_shades[key];
+	if (t.uiRefs++ == 0) CreateBiasedShadedPalettes(t.pShades, pal);
+	std::copy(t.pShades, endof(t.pShades), c->pShades);
+	c->uiShadesKey = key;
 }
 
 
@@ -117,6 +117,7 @@ struct ROTTING_CORPSE
 	ANITILE *pAniTile;
 
 	UINT16  *pShades[ NUM_CORPSE_SHADES ];
+	uint64_t uiShadesKey; // of the shade tables shared with other corpses
 };
 
 
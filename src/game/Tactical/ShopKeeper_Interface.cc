@@ -1842,7 +1842,7 @@ static void CalculateFirstItemIndexOnPage(void)
 }
 
 
-static UINT32 DisplayInvSlot(UINT8 slot_num, UINT16 usItemIndex, UINT16 x, UINT16 y, OBJECTTYPE const& pItemObject, bool hatched_out, UINT8 ubItemArea);
+static UINT32 DisplayInvSlot(UINT16 slot_num, UINT16 usItemIndex, UINT16 x, UINT16 y, OBJECTTYPE const& pItemObject, bool hatched_out, UINT8 ubItemArea);
 static void HatchOutInvSlot(UINT16 usPosX, UINT16 usPosY);
 static void SetSkiFaceRegionHelpText(const INVENTORY_IN_SLOT* pInv, MOUSE_REGION* pRegion, UINT8 ubScreenArea);
 static void SetSkiRegionHelpText(const INVENTORY_IN_SLOT* pInv, MOUSE_REGION* pRegion, UINT8 ubScreenArea);
@@ -1987,7 +1987,23 @@ static INT8 GetSlotNumberForMerc(UINT8 ubProfile);
 static bool IsGunOrAmmoOfSameTypeSelected(OBJECTTYPE const&);
 
 
-static UINT32 DisplayInvSlot(UINT8 const slot_num, UINT16 const item_idx, UINT16 const x, UINT16 const y, OBJECTTYPE const& item_o, bool const hatched_out, UINT8 const item_area)
+/* The unit price of an item in the dealer's inventory. It is kept in the slot,
+ * as it only changes with the number of items left, which the unit price does
+ * not depend on, and with whether Flo is trading. */
+static UINT32 GetDealerInvSlotUnitPrice(INVENTORY_IN_SLOT& inv)
+{
+	UINT32 const priced = gpSMCurrentMerc->ubProfile == FLO ? ARMS_INV_ITEM_PRICED_FOR_FLO : ARMS_INV_ITEM_PRICED;
+	if (!(inv.uiFlags & priced))
+	{
+		inv.uiItemPrice = CalcShopKeeperItemPrice(DEALER_SELLING, TRUE, inv.sItemIndex, ArmsDealerInfo[gbSelectedArmsDealerID].u.price.sell, &inv.ItemObject);
+		inv.uiFlags    &= ~(ARMS_INV_ITEM_PRICED | ARMS_INV_ITEM_PRICED_FOR_FLO);
+		inv.uiFlags    |= priced;
+	}
+	return inv.uiItemPrice;
+}
+
+
+static UINT32 DisplayInvSlot(UINT16 const slot_num, UINT16 const item_idx, UINT16 const x, UINT16 const y, OBJECTTYPE const& item_o, bool const hatched_out, UINT8 const item_area)
 {
 	wchar_t buf[64];
 
@@ -2047,7 +2063,7 @@ static UINT32 DisplayInvSlot(UINT8 const slot_num, UINT16 const item_idx, UINT16
 			if (!hatched_out || item_o.ubNumberOfObjects != 0)
 			{
 				// Show the unit price, not the total value of all if stacked
-				item_cost = CalcShopKeeperItemPrice(DEALER_SELLING, TRUE, item_idx, dealer_info.u.price.sell, &item_o);
+				item_cost = GetDealerInvSlotUnitPrice(gpTempDealersInventory[slot_num]);
 			}
 		}
 		else
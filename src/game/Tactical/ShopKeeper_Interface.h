@@ -25,6 +25,8 @@ enum
 #define ARMS_INV_ITEM_REPAIRED				0x00000020 // The item is repaired
 #define ARMS_INV_JUST_PURCHASED			0x00000040 // The item was just purchased
 #define ARMS_INV_PLAYERS_ITEM_HAS_BEEN_EVALUATED	0x00000080 // The Players item has been evaluated
+#define ARMS_INV_ITEM_PRICED				0x00000100 // uiItemPrice holds the unit price of the dealer's item
+#define ARMS_INV_ITEM_PRICED_FOR_FLO			0x00000200 // Same, with Flo's discount
 
 
 struct INVENTORY_IN_SLOT
@@ -39,7 +41,7 @@ struct INVENTORY_IN_SLOT
 	INT8       bSlotIdInOtherLocation;
 
 	UINT8      ubIdOfMercWhoOwnsTheItem;
-	UINT32     uiItemPrice; //Only used for the players item that have been evaluated
+	UINT32     uiItemPrice; //The value of the players items that have been evaluated, or the unit price of the dealers items
 
 	INT16      sSpecialItemElement;	// refers to which special item element an item in a dealer's inventory area
 					// occupies.  -1 Means the item is "perfect" and has no associated special item.
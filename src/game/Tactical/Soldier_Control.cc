@@ -5,6 +5,7 @@
 #include "MapScreen.h"
 #include "Overhead.h"
 #include "Soldier_Find.h"
+#include "Soldier_Grid.h"
 #include "Structure.h"
 #include "TileDef.h"
 #include "Timer_Control.h"
@@ -92,6 +93,7 @@
 
 #include <algorithm>
 #include <stdexcept>
+#include <unordered_map>
 
 #define PALETTEFILENAME			BINARYDATADIR "/ja2pal.dat"
 
@@ -654,6 +656,9 @@ catch (...)
 }
 
 
+static void FreeSoldierPalettes(SOLDIERTYPE&);
+
+
 void DeleteSoldier(SOLDIERTYPE& s)
 {
 	if (s.sGridNo != NOWHERE)
@@ -677,25 +682,7 @@ void DeleteSoldier(SOLDIERTYPE& s)
 
 	DeleteSoldierFace(&s);
 
-	FOR_EACH(UINT16*, i, s.pShades)
-	{
-		if (*i == NULL) continue;
-		MemFree(*i);
-		*i = NULL;
-	}
-
-	if (s.effect_shade)
-	{
-		MemFree(s.effect_shade);
-		s.effect_shade = 0;
-	}
-
-	FOR_EACH(UINT16*, i, s.pGlowShades)
-	{
-		if (*i == NULL) continue;
-		MemFree(*i);
-		*i = NULL;
-	}
+	FreeSoldierPalettes(s);
 
 	if (s.ubBodyType == QUEENMONSTER)
 	{
@@ -1767,7 +1754,7 @@ void EVENT_InitNewSoldierAnim(SOLDIERTYPE* const pSoldier, UINT16 usNewState, UI
 	SetSoldierAniSpeed( pSoldier );
 
 	// Reset counters
-	RESETTIMECOUNTER( pSoldier->UpdateCounter, pSoldier->sAniDelay );
+	RESETTIMEDEADLINE( pSoldier->UpdateCounter, pSoldier->sAniDelay );
 
 	// Adjust to new animation frame ( the first one )
 	AdjustToNextAnimationFrame( pSoldier );
@@ -1823,6 +1810,7 @@ static void InternalRemoveSoldierFromGridNo(SOLDIERTYPE& s, BOOLEAN const force)
 	UnMarkMovementReserved(s);
 	HandleCrowShadowRemoveGridNo(s);
 	s.sGridNo = NOWHERE;
+	UpdateSoldierGrid(s);
 }
 
 
@@ -1948,6 +1936,7 @@ static void SetSoldierGridNo(SOLDIERTYPE& s, GridNo new_grid_no, BOOLEAN const f
 	}
 
 	s.sGridNo = new_grid_no;
+	UpdateSoldierGrid(s);
 
 	// Check if our new gridno is valid, if not do not set!
 	if (!GridNoOnVisibleWorldTile(new_grid_no)) return;
@@ -4673,109 +4662,207 @@ static UINT16* CreateEnemyGlow16BPPPalette(const SGPPaletteEntry* pPalette, UINT
 static UINT16* CreateEnemyGreyGlow16BPPPalette(const SGPPaletteEntry* pPalette, UINT32 rscale, UINT32 gscale);
 
 
-void CreateSoldierPalettes(SOLDIERTYPE& s)
+/* Soldiers of the same body type in the same clothes under the same light have
+ * the same shade tables, so a squad of them shares one set */
+struct SoldierShadeTables
 {
-	// --- TAKE FROM CURRENT ANIMATION HVOBJECT!
-	UINT16 const anim_surface = GetSoldierAnimationSurface(&s);
-	if (anim_surface == INVALID_ANIMATION_SURFACE)
-	{
-		throw std::runtime_error("Palette creation failed, soldier has invalid animation");
-	}
+	UINT32  uiRefs;
+	UINT16* pShades[NUM_SOLDIER_SHADES];
+	UINT16* pGlowShades[20];
+	UINT16* effect_shade;
+};
 
-	SGPPaletteEntry tmp_pal[256];
-	std::fill_n(tmp_pal, 256, SGPPaletteEntry{});
+static std::unordered_map<uint64_t, SoldierShadeTables> g_soldier_shades;
 
-	SGPPaletteEntry const*       pal;
-	char            const* const substitution = GetBodyTypePaletteSubstitution(&s, s.ubBodyType);
-	if (!substitution)
-	{
-		// ATE: here we want to use the breath cycle for the palette.....
-		UINT16 const palette_anim_surface = LoadSoldierAnimationSurface(s, STANDING);
-		if (palette_anim_surface != INVALID_ANIMATION_SURFACE)
-		{
-			// Use palette from HVOBJECT, then use substitution for pants, etc
-			memcpy(tmp_pal, gAnimSurfaceDatabase[palette_anim_surface].hVideoObject->Palette(), sizeof(*tmp_pal) * 256);
 
-			// Substitute based on head, etc
-			SetPaletteReplacement(tmp_pal, s.HeadPal);
-			SetPaletteReplacement(tmp_pal, s.VestPal);
-			SetPaletteReplacement(tmp_pal, s.PantsPal);
-			SetPaletteReplacement(tmp_pal, s.SkinPal);
-		}
-		pal = tmp_pal;
-	}
-	else if (substitution[0] != '\0' && CreateSGPPaletteFromCOLFile(tmp_pal, substitution))
-	{
-		pal = tmp_pal;
-	}
-	else
+// The glow tables are made from the palette without the light colour
+static uint64_t SoldierShadesKey(SGPPaletteEntry const* const pal)
+{
+	uint64_t hash = BiasedShadedPalettesKey(pal);
+	for (UINT i = 0; i != 256; ++i)
 	{
-		// Use palette from hvobject
-		pal = gAnimSurfaceDatabase[anim_surface].hVideoObject->Palette();
+		hash = (hash ^ pal[i].r) * 1099511628211ULL;
+		hash = (hash ^ pal[i].g) * 1099511628211ULL;
+		hash = (hash ^ pal[i].b) * 1099511628211ULL;
 	}
+	return hash;
+}
 
 
-	for (INT32 i = 0; i < NUM_SOLDIER_SHADES; ++i)
-	{
-		if (s.pShades[i])
-		{
-			MemFree(s.pShades[i]);
-			s.pShades[i] = 0;
-		}
-	}
+static void FreeSoldierPalettes(SOLDIERTYPE& s)
+{
+	if (s.pShades[0] == NULL) return;
+	std::fill(s.pShades,     endof(s.pShades),     (UINT16*)NULL);
+	std::fill(s.pGlowShades, endof(s.pGlowShades), (UINT16*)NULL);
+	s.effect_shade = NULL;
+
+	std::unordered_map<uint64_t, SoldierShadeTables>::iterator const i = g_soldier_shades.find(s.shades_key);
+	Assert(i != g_soldier_shades.end());
+	if (--i->second.uiRefs != 0) return;
+
+	// The last soldier with these tables is gone
+	SoldierShadeTables& t = i->second;
+	FOR_EACH(UINT16*, p, t.pShades)     MemFree(*p);
+	FOR_EACH(UINT16*, p, t.pGlowShades) MemFree(*p);
+	MemFree(t.effect_shade);
+	g_soldier_shades.erase(i);
+}
+
+
+// Gives the soldier the shade tables under the key, which must exist
+static void UseSoldierShadeTables(SOLDIERTYPE& s, uint64_t const key)
+{
+	SoldierShadeTables& t = g_soldier_shades.find(key)->second;
+	// Taken before the old tables are let go, they may be these
+	++t.uiRefs;
+	FreeSoldierPalettes(s);
+	std::copy(t.pShades,     endof(t.pShades),     s.pShades);
+	std::copy(t.pGlowShades, endof(t.pGlowShades), s.pGlowShades);
+	s.effect_shade = t.effect_shade;
+	s.shades_key   = key;
+}
+
+
+/* While a batch of soldier palettes is made, the shade tables made for each
+ * colour scheme are remembered, so the other soldiers in the scheme get them
+ * without making the palette again */
+static bool                                   g_palette_batch = false;
+static std::unordered_map<uint64_t, uint64_t> g_palette_batch_keys;
 
-	if (s.effect_shade)
-	{
-		MemFree(s.effect_shade);
-		s.effect_shade = 0;
-	}
 
-	for (INT32 i = 0; i < 20; ++i)
+void BeginSoldierPaletteBatch()
+{
+	g_palette_batch = true;
+}
+
+
+void EndSoldierPaletteBatch()
+{
+	g_palette_batch = false;
+	g_palette_batch_keys.clear();
+}
+
+
+// Everything besides the light the palette of the soldier is made from
+static uint64_t SoldierPaletteSchemeKey(SOLDIERTYPE const& s, UINT16 const surface, char const* const substitution)
+{
+	uint64_t hash = 14695981039346656037ULL; // FNV-1a
+	hash = (hash ^ surface) * 1099511628211ULL;
+	// The substitutions are string literals
+	hash = (hash ^ reinterpret_cast<uintptr_t>(substitution)) * 1099511628211ULL;
+	if (!substitution)
 	{
-		if (s.pGlowShades[i])
+		char const* const reps[] = { s.HeadPal, s.VestPal, s.PantsPal, s.SkinPal };
+		FOR_EACH(char const* const, i, reps)
 		{
-			MemFree(s.pGlowShades[i]);
-			s.pGlowShades[i] = 0;
+			for (char const* c = *i; *c != '\0'; ++c) hash = (hash ^ (UINT8)*c) * 1099511628211ULL;
+			hash = (hash ^ 0xFF) * 1099511628211ULL;
 		}
 	}
+	return hash;
+}
 
 
-	CreateBiasedShadedPalettes(s.pShades, pal);
+static void CreateSoldierShadeTables(SoldierShadeTables& t, SGPPaletteEntry const* const pal)
+{
+	CreateBiasedShadedPalettes(t.pShades, pal);
 
-	s.effect_shade = Create16BPPPaletteShaded(pal, 100, 100, 100, TRUE);
+	t.effect_shade = Create16BPPPaletteShaded(pal, 100, 100, 100, TRUE);
 
 	// Build shades for glowing visible bad guy
 
 	// First do visible guy
-	s.pGlowShades[0] = Create16BPPPaletteShaded(pal, 255, 255, 255, FALSE);
+	t.pGlowShades[0] = Create16BPPPaletteShaded(pal, 255, 255, 255, FALSE);
 	for (INT32 i = 1; i < 10; ++i)
 	{
-		s.pGlowShades[i] = CreateEnemyGlow16BPPPalette(pal, gRedGlowR[i], 0);
+		t.pGlowShades[i] = CreateEnemyGlow16BPPPalette(pal, gRedGlowR[i], 0);
 	}
 
 	// Now for gray guy...
-	s.pGlowShades[10] = Create16BPPPaletteShaded(pal, 100, 100, 100, TRUE);
+	t.pGlowShades[10] = Create16BPPPaletteShaded(pal, 100, 100, 100, TRUE);
 	for (INT32 i = 11; i < 19; ++i)
 	{
-		s.pGlowShades[i] = CreateEnemyGreyGlow16BPPPalette(pal, gRedGlowR[i], 0);
+		t.pGlowShades[i] = CreateEnemyGreyGlow16BPPPalette(pal, gRedGlowR[i], 0);
 	}
-	s.pGlowShades[19] = CreateEnemyGreyGlow16BPPPalette(pal, gRedGlowR[18], 0);
+	t.pGlowShades[19] = CreateEnemyGreyGlow16BPPPalette(pal, gRedGlowR[18], 0);
 
 	// ATE: OK, piggyback on the shades we are not using for 2 colored lighting....
 	// ORANGE, VISIBLE GUY
-	s.pShades[20] = Create16BPPPaletteShaded(pal, 255, 255, 255, FALSE);
+	t.pShades[20] = Create16BPPPaletteShaded(pal, 255, 255, 255, FALSE);
 	for (INT32 i = 21; i < 30; ++i)
 	{
-		s.pShades[i] = CreateEnemyGlow16BPPPalette(pal, gOrangeGlowR[i - 20], gOrangeGlowG[i - 20]);
+		t.pShades[i] = CreateEnemyGlow16BPPPalette(pal, gOrangeGlowR[i - 20], gOrangeGlowG[i - 20]);
 	}
 
 	// ORANGE, GREY GUY
-	s.pShades[30] = Create16BPPPaletteShaded(pal, 100, 100, 100, TRUE);
+	t.pShades[30] = Create16BPPPaletteShaded(pal, 100, 100, 100, TRUE);
 	for (INT32 i = 31; i < 39; ++i)
 	{
-		s.pShades[i] = CreateEnemyGreyGlow16BPPPalette(pal, gOrangeGlowR[i - 20], gOrangeGlowG[i - 20]);
+		t.pShades[i] = CreateEnemyGreyGlow16BPPPalette(pal, gOrangeGlowR[i - 20], gOrangeGlowG[i - 20]);
+	}
+	t.pShades[39] = CreateEnemyGreyGlow16BPPPalette(pal, gOrangeGlowR[18], gOrangeGlowG[18]);
+}
+
+
+void CreateSoldierPalettes(SOLDIERTYPE& s)
+{
+	// --- TAKE FROM CURRENT ANIMATION HVOBJECT!
+	UINT16 const anim_surface = GetSoldierAnimationSurface(&s);
+	if (anim_surface == INVALID_ANIMATION_SURFACE)
+	{
+		throw std::runtime_error("Palette creation failed, soldier has invalid animation");
+	}
+
+	char const* const substitution = GetBodyTypePaletteSubstitution(&s, s.ubBodyType);
+	// ATE: here we want to use the breath cycle for the palette.....
+	UINT16 const palette_anim_surface = substitution ? anim_surface : LoadSoldierAnimationSurface(s, STANDING);
+
+	uint64_t scheme = 0;
+	if (g_palette_batch)
+	{
+		scheme = SoldierPaletteSchemeKey(s, palette_anim_surface, substitution);
+		std::unordered_map<uint64_t, uint64_t>::const_iterator const i = g_palette_batch_keys.find(scheme);
+		if (i != g_palette_batch_keys.end())
+		{
+			UseSoldierShadeTables(s, i->second);
+			return;
+		}
 	}
-	s.pShades[39] = CreateEnemyGreyGlow16BPPPalette(pal, gOrangeGlowR[18], gOrangeGlowG[18]);
+
+	SGPPaletteEntry tmp_pal[256];
+	std::fill_n(tmp_pal, 256, SGPPaletteEntry{});
+
+	SGPPaletteEntry const* pal;
+	if (!substitution)
+	{
+		if (palette_anim_surface != INVALID_ANIMATION_SURFACE)
+		{
+			// Use palette from HVOBJECT, then use substitution for pants, etc
+			memcpy(tmp_pal, gAnimSurfaceDatabase[palette_anim_surface].hVideoObject->Palette(), sizeof(*tmp_pal) * 256);
+
+			// Substitute based on head, etc
+			SetPaletteReplacement(tmp_pal, s.HeadPal);
+			SetPaletteReplacement(tmp_pal, s.VestPal);
+			SetPaletteReplacement(tmp_pal, s.PantsPal);
+			SetPaletteReplacement(tmp_pal, s.SkinPal);
+		}
+		pal = tmp_pal;
+	}
+	else if (substitution[0] != '\0' && CreateSGPPaletteFromCOLFile(tmp_pal, substitution))
+	{
+		pal = tmp_pal;
+	}
+	else
+	{
+		// Use palette from hvobject
+		pal = gAnimSurfaceDatabase[anim_surface].hVideoObject->Palette();
+	}
+
+	uint64_t            const key = SoldierShadesKey(pal);
+	SoldierShadeTables&       t   = g_soldier_shades[key];
+	if (t.uiRefs == 0) CreateSoldierShadeTables(t, pal);
+	UseSoldierShadeTables(s, key);
+	if (g_palette_batch) g_palette_batch_keys[scheme] = key;
 }
 
 
@@ -4794,7 +4881,7 @@ static void AdjustAniSpeed(SOLDIERTYPE* pSoldier)
 	}
 
 
-	RESETTIMECOUNTER( pSoldier->UpdateCounter, pSoldier->sAniDelay );
+	RESETTIMEDEADLINE( pSoldier->UpdateCounter, pSoldier->sAniDelay );
 }
 
 
@@ -4957,7 +5044,7 @@ void SetSoldierAniSpeed(SOLDIERTYPE* pSoldier)
 			gTacticalStatus.fAutoBandageMode ) && pSoldier->usAnimState != MONSTER_UP )
 		{
 			pSoldier->sAniDelay = 0;
-			RESETTIMECOUNTER( pSoldier->UpdateCounter, pSoldier->sAniDelay );
+			RESETTIMEDEADLINE( pSoldier->UpdateCounter, pSoldier->sAniDelay );
 			return;
 		}
 	}
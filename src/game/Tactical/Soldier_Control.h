@@ -313,7 +313,23 @@ struct SOLDIERTYPE
 	INT8 bActionPoints;
 	INT8 bInitialActionPoints;
 
-	UINT32 uiStatusFlags;
+	/* ExecuteOverhead() reads these for every soldier on every update, so they
+	 * are kept together to cost a soldier with nothing to do only a cache line
+	 * or two instead of one per field */
+	UINT32      uiStatusFlags;
+	TIMECOUNTER UpdateCounter;
+	INT16       sAniDelay;
+	UINT16      usAnimState;
+	INT8        bActive;
+	INT8        bTeam; // Team identifier
+	INT8        bVisible; // to render or not to render...
+	INT8        bLastRenderVisibleValue;
+	BOOLEAN     fBeginFade;
+	INT8        fDisplayDamage;
+	BOOLEAN     fNoAPToFinishMove;
+	BOOLEAN     fSoldierWasMoving;
+	BOOLEAN     fPauseAllAnimation;
+	INT8        fAIFlags;
 
 	OBJECTTYPE inv[ NUM_INV_SLOTS ];
 	OBJECTTYPE *pTempObject;
@@ -336,19 +352,11 @@ struct SOLDIERTYPE
 	INT8 ubInsertionDirection;
 	// skills
 	SOLDIERTYPE* opponent;
-	INT8 bLastRenderVisibleValue;
 	UINT8 ubAttackingHand;
 	// traits
 	INT16 sWeightCarriedAtTurnStart;
 	wchar_t name[ 10 ];
 
-	INT8 bVisible; // to render or not to render...
-
-
-	INT8 bActive;
-
-	INT8 bTeam; // Team identifier
-
 	//NEW MOVEMENT INFORMATION for Strategic Movement
 	UINT8 ubGroupID; //the movement group the merc is currently part of.
 	BOOLEAN fBetweenSectors; //set when the group isn't actually in a sector.
@@ -378,15 +386,12 @@ struct SOLDIERTYPE
 	UINT8 ubDesiredHeight;
 	UINT16 usPendingAnimation;
 	UINT8 ubPendingStanceChange;
-	UINT16 usAnimState;
-	BOOLEAN fNoAPToFinishMove;
 	BOOLEAN fPausedMove;
 	BOOLEAN fUIdeadMerc; // UI Flags for removing a newly dead merc
 	BOOLEAN fUICloseMerc; // UI Flags for closing panels
 
 
 
-	TIMECOUNTER UpdateCounter;
 	TIMECOUNTER DamageCounter;
 	TIMECOUNTER AICounter;
 	TIMECOUNTER FadeCounter;
@@ -402,7 +407,6 @@ struct SOLDIERTYPE
 	BOOLEAN fTurnInProgress;
 
 	BOOLEAN fIntendedTarget; // intentionally shot?
-	BOOLEAN fPauseAllAnimation;
 
 	INT8 bExpLevel; // general experience level
 	INT16 sInsertionGridNo;
@@ -418,7 +422,6 @@ struct SOLDIERTYPE
 
 	UINT16 usAniCode;
 	UINT16 usAniFrame;
-	INT16 sAniDelay;
 
 	// MOVEMENT TO NEXT TILE HANDLING STUFF
 	INT8 bAgility; // agility (speed) value
@@ -464,7 +467,6 @@ struct SOLDIERTYPE
 	UINT16 *pShades[ NUM_SOLDIER_SHADES ]; // Shading tables
 	UINT16 *pGlowShades[ 20 ]; //
 	INT8 bMedical;
-	BOOLEAN fBeginFade;
 	UINT8 ubFadeLevel;
 	UINT8 ubServiceCount;
 	SOLDIERTYPE* service_partner;
@@ -564,7 +566,6 @@ struct SOLDIERTYPE
 	INT8 bNormalSmell;
 	INT8 bMonsterSmell;
 	INT8 bMobility;
-	INT8 fAIFlags;
 
 	BOOLEAN fDontChargeReadyAPs;
 	UINT16 usAnimSurface;
@@ -579,7 +580,6 @@ struct SOLDIERTYPE
 	UINT16 *pForcedShade;
 
 	INT8 bDisplayDamageCount;
-	INT8 fDisplayDamage;
 	INT16 sDamage;
 	INT16 sDamageX;
 	INT16 sDamageY;
@@ -621,6 +621,7 @@ struct SOLDIERTYPE
 	UINT8 ubHitLocation;
 
 	UINT16* effect_shade; // Shading table for effects
+	uint64_t shades_key; // of the shade tables shared with other soldiers
 
 	INT16 sSpreadLocations[ 6 ];
 	BOOLEAN fDoSpread;
@@ -749,7 +750,6 @@ struct SOLDIERTYPE
 	INT8 bTurningIncrement;
 	UINT32 uiBattleSoundID;
 
-	BOOLEAN fSoldierWasMoving;
 	BOOLEAN fSayAmmoQuotePending;
 	UINT16 usValueGoneUp;
 
@@ -932,6 +932,11 @@ void ReviveSoldier( SOLDIERTYPE *pSoldier );
 
 // Palette functions for soldiers
 void  CreateSoldierPalettes(SOLDIERTYPE&);
+
+/* Between these the palettes of many soldiers are made under the same light.
+ * Nothing else the palettes are made from may change meanwhile. */
+void BeginSoldierPaletteBatch();
+void EndSoldierPaletteBatch();
 UINT8 GetPaletteRepIndexFromID(const PaletteRepID pal_rep);
 void  SetPaletteReplacement(SGPPaletteEntry*, PaletteRepID);
 void  LoadPaletteData(void);
@@ -0,0 +1,123 @@
+#include "Soldier_Grid.h"
+#include "Isometric_Utils.h"
+#include "Overhead_Types.h"
+#include "Soldier_Control.h"
+#include "WorldDef.h"
+
+#include <algorithm>
+#include <iterator>
+
+
+#define GRID_CELL_SIZE 8 // tiles along each side of a cell
+#define GRID_COLS      ((WORLD_COLS + GRID_CELL_SIZE - 1) / GRID_CELL_SIZE)
+#define GRID_ROWS      ((WORLD_ROWS + GRID_CELL_SIZE - 1) / GRID_CELL_SIZE)
+#define GRID_CELLS     (GRID_COLS * GRID_ROWS)
+
+// Soldiers in the index which are not on a map tile, e.g. before they are
+// placed, are kept out of the cells
+#define CELL_NOWHERE   GRID_CELLS
+// Soldiers not in the index
+#define CELL_NONE      (GRID_CELLS + 1)
+
+
+static SOLDIERTYPE* g_head[GRID_CELLS];
+static SOLDIERTYPE* g_next[TOTAL_SOLDIERS];
+static SOLDIERTYPE* g_prev[TOTAL_SOLDIERS];
+static UINT16       g_cell[TOTAL_SOLDIERS];
+
+
+static UINT16 CellOf(GridNo const gridno)
+{
+	if (gridno < 0 || WORLD_MAX <= gridno) return CELL_NOWHERE;
+	INT16 x;
+	INT16 y;
+	ConvertGridNoToXY(gridno, &x, &y);
+	return y / GRID_CELL_SIZE * GRID_COLS + x / GRID_CELL_SIZE;
+}
+
+
+static void Link(SOLDIERTYPE& s, UINT16 const cell)
+{
+	g_cell[s.ubID] = cell;
+	g_prev[s.ubID] = NULL;
+	g_next[s.ubID] = NULL;
+	if (cell >= GRID_CELLS) return;
+
+	SOLDIERTYPE* const head = g_head[cell];
+	if (head) g_prev[head->ubID] = &s;
+	g_next[s.ubID] = head;
+	g_head[cell]   = &s;
+}
+
+
+static void Unlink(SOLDIERTYPE& s)
+{
+	UINT16 const cell = g_cell[s.ubID];
+	if (cell >= GRID_CELLS) return;
+
+	SOLDIERTYPE* const prev = g_prev[s.ubID];
+	SOLDIERTYPE* const next = g_next[s.ubID];
+	if (prev) g_next[prev->ubID] = next;
+	else      g_head[cell]       = next;
+	if (next) g_prev[next->ubID] = prev;
+}
+
+
+void ClearSoldierGrid()
+{
+	std::fill(std::begin(g_head), std::end(g_head), nullptr);
+	std::fill(std::begin(g_cell), std::end(g_cell), CELL_NONE);
+}
+
+
+void AddSoldierToGrid(SOLDIERTYPE& s)
+{
+	if (g_cell[s.ubID] != CELL_NONE) Unlink(s);
+	Link(s, CellOf(s.sGridNo));
+}
+
+
+void RemoveSoldierFromGrid(SOLDIERTYPE& s)
+{
+	if (g_cell[s.ubID] == CELL_NONE) return;
+	Unlink(s);
+	g_cell[s.ubID] = CELL_NONE;
+}
+
+
+void UpdateSoldierGrid(SOLDIERTYPE& s)
+{
+	UINT16 const old_cell = g_cell[s.ubID];
+	if (old_cell == CELL_NONE) return;
+
+	UINT16 const new_cell = CellOf(s.sGridNo);
+	if (new_cell == old_cell) return;
+	Unlink(s);
+	Link(s, new_cell);
+}
+
+
+UINT FindSoldiersNear(GridNo const gridno, INT16 const radius, SOLDIERTYPE** const out)
+{
+	INT16 x;
+	INT16 y;
+	ConvertGridNoToXY(gridno, &x, &y);
+	INT16 const min_col = std::max(0,             (x - radius) / GRID_CELL_SIZE);
+	INT16 const max_col = std::min(GRID_COLS - 1, (x + radius) / GRID_CELL_SIZE);
+	INT16 const min_row = std::max(0,             (y - radius) / GRID_CELL_SIZE);
+	INT16 const max_row = std::min(GRID_ROWS - 1, (y + radius) / GRID_CELL_SIZE);
+
+	UINT n = 0;
+	for (INT16 row = min_row; row <= max_row; ++row)
+	{
+		for (INT16 col = min_col; col <= max_col; ++col)
+		{
+			for (SOLDIERTYPE* s = g_head[row * GRID_COLS + col]; s; s = g_next[s->ubID])
+			{
+				if (PythSpacesAway(gridno, s->sGridNo) > radius) continue;
+				out[n++] = s;
+			}
+		}
+	}
+	return n;
+}
@@ -0,0 +1,24 @@
+#ifndef SOLDIER_GRID_H
+#define SOLDIER_GRID_H
+
+#include "JA2Types.h"
+
+
+/* An index of the soldiers in the merc slots by where they stand, so the
+ * soldiers around a tile are found without walking all merc slots. The map is
+ * split into square cells of tiles and every cell keeps a list of the soldiers
+ * in it. AddMercSlot() and RemoveMercSlot() add and remove the soldiers and
+ * SetSoldierGridNo() moves them. */
+void ClearSoldierGrid();
+void AddSoldierToGrid(SOLDIERTYPE&);
+void RemoveSoldierFromGrid(SOLDIERTYPE&);
+
+// Files the soldier under his current sGridNo, if he is in the index at all
+void UpdateSoldierGrid(SOLDIERTYPE&);
+
+/* Stores the soldiers in the merc slots which are at most radius tiles away
+ * from the grid number, by PythSpacesAway(), in no particular order. The
+ * array must have room for TOTAL_SOLDIERS. Returns their number. */
+UINT FindSoldiersNear(GridNo, INT16 radius, SOLDIERTYPE** out);
+
+#endif
@@ -156,7 +156,7 @@ void LoadMercProfiles()
 					if (!item->isGun() || !item->isInBigGunList()) continue;
 
 					const WeaponModel *oldWeapon = item->asWeapon();
-					const WeaponModel *newWeapon = GCM->getWeaponByName(oldWeapon->getStandardReplacement());
+					const WeaponModel *newWeapon = GCM->getWeaponReplacement(oldWeapon);
 
 					*k = newWeapon->getItemIndex();
 
@@ -248,7 +248,7 @@ static INT8 TileIsClear(SOLDIERTYPE* pSoldier, INT8 bDirection, INT16 sGridNo, I
 				// ATE: HIdden structs - we do something here... reveal it!
 				if ( gubWorldMovementCosts[ sGridNo ][ bDirection ][ pSoldier->bLevel ] == TRAVELCOST_HIDDENOBSTACLE )
 				{
-					gpWorldLevelData[ sGridNo ].uiFlags|=MAPELEMENT_REVEALED;
+					SetTileRevealed(sGridNo);
 					gpWorldLevelData[ sGridNo ].uiFlags|=MAPELEMENT_REDRAW;
 					SetRenderFlags(RENDER_FLAG_MARKED);
 					RecompileLocalMovementCosts( (UINT16)sGridNo );
@@ -27,6 +27,9 @@ SOLDIERTYPE *Squad[ NUMBER_OF_SQUADS ][ NUMBER_OF_SOLDIERS_PER_SQUAD ];
 // list of dead guys for squads...in id values -> -1 means no one home
 INT16 sDeadMercs[ NUMBER_OF_SQUADS ][ NUMBER_OF_SOLDIERS_PER_SQUAD ];
 
+// number of members of each squad, who fill the front slots of the squad
+static UINT8 g_squad_size[NUMBER_OF_SQUADS];
+
 // the movement group ids
 INT8 SquadMovementGroups[ NUMBER_OF_SQUADS ];
 
@@ -35,6 +38,19 @@ BOOLEAN fExitingVehicleToSquad = FALSE;
 
 INT32 iCurrentTacticalSquad = FIRST_SQUAD;
 
+
+static UINT8 SquadSize(INT32 const squad)
+{
+#ifdef _DEBUG
+	UINT8 n = 0;
+	FOR_EACH_IN_SQUAD(i, squad) ++n;
+	Assert(n == g_squad_size[squad]);
+	Assert(n == NUMBER_OF_SOLDIERS_PER_SQUAD || !Squad[squad][n]);
+#endif
+	return g_squad_size[squad];
+}
+
+
 void InitSquads( void )
 {
 	// init the squad lists to NULL ptrs.
@@ -47,6 +63,7 @@ void InitSquads( void )
 		{
 			*i = 0;
 		}
+		g_squad_size[iCounter] = 0;
 
 		// create mvt groups
 		GROUP* const g = CreateNewPlayerGroupDepartingFromSector(1, 1);
@@ -62,12 +79,7 @@ void InitSquads( void )
 
 BOOLEAN IsThisSquadFull( INT8 bSquadValue )
 {
-	// run through entries in the squad list, make sure there is a free entry
-	FOR_EACH_SLOT_IN_SQUAD(i, bSquadValue)
-	{
-		if (!*i) return FALSE;
-	}
-	return TRUE;
+	return SquadSize(bSquadValue) == NUMBER_OF_SOLDIERS_PER_SQUAD;
 }
 
 INT8 GetFirstEmptySquad( void )
@@ -85,6 +97,7 @@ INT8 GetFirstEmptySquad( void )
 
 
 static BOOLEAN CopyPathOfSquadToCharacter(SOLDIERTYPE* pCharacter, INT8 bSquadValue);
+static void RebuildSquad(INT8 bSquadValue);
 
 
 BOOLEAN AddCharacterToSquad(SOLDIERTYPE* const s, INT8 const bSquadValue)
@@ -191,6 +204,8 @@ BOOLEAN AddCharacterToSquad(SOLDIERTYPE* const s, INT8 const bSquadValue)
 		}
 
 		*i = s;
+		// Leaving a vehicle above may have squeezed the squad together
+		RebuildSquad(bSquadValue);
 
 		if (s->bAssignment != bSquadValue)
 		{
@@ -272,17 +287,11 @@ INT8 AddCharacterToUniqueSquad(SOLDIERTYPE* const s)
 
 BOOLEAN SquadIsEmpty( INT8 bSquadValue )
 {
-	// run through this squad's slots and find if they ALL are empty
-	FOR_EACH_IN_SQUAD(i, bSquadValue)
-	{
-		return FALSE;
-	}
-	return TRUE;
+	return SquadSize(bSquadValue) == 0;
 }
 
 
 static BOOLEAN AddDeadCharacterToSquadDeadGuys(SOLDIERTYPE* pSoldier, INT32 iSquadValue);
-static void RebuildSquad(INT8 bSquadValue);
 static void UpdateCurrentlySelectedMerc(SOLDIERTYPE* pSoldier, INT8 bSquadValue);
 
 
@@ -333,21 +342,12 @@ BOOLEAN RemoveCharacterFromSquads(SOLDIERTYPE* const s)
 
 INT8 NumberOfPeopleInSquad( INT8 bSquadValue )
 {
-	INT8 bSquadCount = 0;
-
 	if( bSquadValue == NO_CURRENT_SQUAD )
 	{
 		return( 0 );
 	}
 
-	// find number of characters in particular squad.
-	FOR_EACH_IN_SQUAD(i, bSquadValue)
-	{
-		++bSquadCount;
-	}
-
-	// return number found
-	return( bSquadCount );
+	return SquadSize(bSquadValue);
 }
 
 INT8 NumberOfNonEPCsInSquad( INT8 bSquadValue )
@@ -394,18 +394,15 @@ BOOLEAN SectorSquadIsIn(const INT8 bSquadValue, INT16* const sMapX, INT16* const
 	// returns if there is anyone on the squad and what sector ( strategic ) they are in
 	Assert( bSquadValue < ON_DUTY );
 
-	FOR_EACH_IN_SQUAD(i, bSquadValue)
-	{
-		SOLDIERTYPE const* const s = *i;
-		// if valid soldier, get current sector and return
-		*sMapX = s->sSectorX;
-		*sMapY = s->sSectorY;
-		*sMapZ = s->bSectorZ;
-		return TRUE;
-	}
-
 	// return there is no squad
-	return ( FALSE );
+	if (SquadSize(bSquadValue) == 0) return FALSE;
+
+	// the first member is where the squad is
+	SOLDIERTYPE const* const s = Squad[bSquadValue][0];
+	*sMapX = s->sSectorX;
+	*sMapY = s->sSectorY;
+	*sMapZ = s->bSectorZ;
+	return TRUE;
 }
 
 
@@ -585,6 +582,8 @@ BOOLEAN IsSquadOnCurrentTacticalMap( INT32 iCurrentSquad )
 		return ( FALSE );
 	}
 
+	if (SquadSize(iCurrentSquad) == 0) return FALSE;
+
 	// go through memebrs of squad...if anyone on this map, return true
 	FOR_EACH_IN_SQUAD(i, iCurrentSquad)
 	{
@@ -640,11 +639,7 @@ INT32 GetLastSquadActive( void )
 
 	for( iCounter = 0; iCounter < NUMBER_OF_SQUADS; iCounter++ )
 	{
-		FOR_EACH_IN_SQUAD(i, iCounter)
-		{
-			iLastSquad = iCounter;
-			break;
-		}
+		if (SquadSize(iCounter) != 0) iLastSquad = iCounter;
 	}
 
 	return ( iLastSquad );
@@ -688,6 +683,7 @@ void LoadSquadInfoFromSavedGameFile(HWFILE const f)
 			EXTR_SKIP(d, 10)
 			*slot = id != -1 ? &GetMan(id) : 0;
 		}
+		RebuildSquad(squad);
 	}
 	Assert(d == endof(data));
 
@@ -698,11 +694,7 @@ void LoadSquadInfoFromSavedGameFile(HWFILE const f)
 
 BOOLEAN IsThisSquadOnTheMove( INT8 bSquadValue )
 {
-	FOR_EACH_IN_SQUAD(i, bSquadValue)
-	{
-		return (*i)->fBetweenSectors;
-	}
-	return FALSE;
+	return SquadSize(bSquadValue) != 0 && Squad[bSquadValue][0]->fBetweenSectors;
 }
 
 
@@ -717,6 +709,7 @@ static void RebuildSquad(INT8 const squad_id)
 		if (!*i) continue;
 		*dst++ = *i;
 	}
+	g_squad_size[squad_id] = dst - squad;
 	for (; dst != end; ++dst) *dst = 0;
 }
 
@@ -1,5 +1,6 @@
 #include "Buffer.h"
 #include "Directories.h"
+#include "ETRLEBlitter.h"
 #include "Font_Control.h"
 #include "LoadSaveRottingCorpse.h"
 #include "MapScreen.h"
@@ -55,6 +56,9 @@
 #include "GameInstance.h"
 #include "Logger.h"
 
+#include <algorithm>
+#include <vector>
+
 static BOOLEAN gfWasInMeanwhile = FALSE;
 
 
@@ -64,7 +68,7 @@ static void AddTempFileToSavedGame(HWFILE const f, UINT32 const flags, SectorFla
 
 	char map_name[128];
 	GetMapTempFileName(type, map_name, x, y, z);
-	SaveFilesToSavedGame(map_name, f);
+	SaveTempFileToSavedGame(map_name, f);
 }
 
 
@@ -116,11 +120,11 @@ static void RetrieveTempFileFromSavedGame(HWFILE const f, UINT32 const flags, Se
 
 	char map_name[128];
 	GetMapTempFileName(type, map_name, x, y, z);
-	LoadFilesFromSavedGame(map_name, f);
+	LoadTempFileFromSavedGame(map_name, f);
 }
 
 
-static void SynchronizeItemTempFileVisbleItemsToSectorInfoVisbleItems(INT16 sMapX, INT16 sMapY, INT8 bMapZ, bool check_consistency);
+static void SynchronizeItemTempFileVisbleItemsToSectorInfoVisbleItems(INT16 sMapX, INT16 sMapY, INT8 bMapZ);
 
 
 static void RetrieveTempFilesFromSavedGame(HWFILE const f, UINT32& flags, INT16 const x, INT16 const y, INT8 const z, UINT32 const savegame_version)
@@ -136,9 +140,11 @@ static void RetrieveTempFilesFromSavedGame(HWFILE const f, UINT32& flags, INT16
 	RetrieveTempFileFromSavedGame(f, flags, SF_SMOKE_EFFECTS_TEMP_FILE_EXISTS,     x, y, z);
 	RetrieveTempFileFromSavedGame(f, flags, SF_LIGHTING_EFFECTS_TEMP_FILE_EXISTS,  x, y, z);
 
-	if (flags & SF_ITEM_TEMP_FILE_EXISTS)
+	/* Since version 86 the visible item count is saved with the sector info, so
+	 * the item file is not read until the sector is visited */
+	if (flags & SF_ITEM_TEMP_FILE_EXISTS && savegame_version < 86)
 	{
-		SynchronizeItemTempFileVisbleItemsToSectorInfoVisbleItems(x, y, z, savegame_version >= 86);
+		SynchronizeItemTempFileVisbleItemsToSectorInfoVisbleItems(x, y, z);
 	}
 
 	if (flags & SF_CIV_PRESERVED_TEMP_FILE_EXISTS && savegame_version < 78)
@@ -146,7 +152,7 @@ static void RetrieveTempFilesFromSavedGame(HWFILE const f, UINT32& flags, INT16
 		// Delete the file, because it is corrupted
 		char map_name[128];
 		GetMapTempFileName(SF_CIV_PRESERVED_TEMP_FILE_EXISTS, map_name, x, y, z);
-		FileDelete(map_name);
+		GCM->deleteTempFile(map_name);
 		flags &= ~SF_CIV_PRESERVED_TEMP_FILE_EXISTS;
 	}
 }
@@ -213,19 +219,27 @@ void LoadMapTempFilesFromSavedGameFile(HWFILE const f, UINT32 const savegame_ver
 }
 
 
+/* The item temp file holds a count and that many items, as written by
+ * SaveWorldItemsToTempItemFile(). AddItemsToUnLoadedSector() appends single
+ * items after these, so it doesn't have to read and rewrite the whole file for
+ * every item dropped into a sector. Once more items are appended than the file
+ * started with, it is rewritten without the items which no longer exist. */
+#define MIN_APPENDED_ITEMS_BEFORE_COMPACTING 32
+
+
 void SaveWorldItemsToTempItemFile(INT16 const sMapX, INT16 const sMapY, INT8 const bMapZ, UINT32 const uiNumberOfItems, WORLDITEM const* const pData)
 {
 	{
 		char filename[128];
 		GetMapTempFileName(SF_ITEM_TEMP_FILE_EXISTS, filename, sMapX, sMapY, bMapZ);
-		AutoSGPFile f(FileMan::openForWriting(filename));
+		AutoSGPFile f(GCM->openTempFileForWriting(filename, true));
 		FileWriteArray(f, uiNumberOfItems, pData);
 		// Close the file before
 		// SynchronizeItemTempFileVisbleItemsToSectorInfoVisbleItems() reads it
 	}
 
 	SetSectorFlag(sMapX, sMapY, bMapZ, SF_ITEM_TEMP_FILE_EXISTS);
-	SynchronizeItemTempFileVisbleItemsToSectorInfoVisbleItems(sMapX, sMapY, bMapZ, false);
+	SynchronizeItemTempFileVisbleItemsToSectorInfoVisbleItems(sMapX, sMapY, bMapZ);
 }
 
 
@@ -237,11 +251,17 @@ void LoadWorldItemsFromTempItemFile(INT16 const x, INT16 const y, INT8 const z,
 	UINT32                 l_item_count;
 	SGP::Buffer<WORLDITEM> l_items;
 	// If the file doesn't exists, it's no problem
-	if (GCM->doesGameResExists(filename))
+	if (GCM->doesTempFileExist(filename))
 	{
-		AutoSGPFile f(GCM->openGameResForReading(filename));
+		AutoSGPFile f(GCM->openTempFileForReading(filename));
 
 		FileRead(f, &l_item_count, sizeof(l_item_count));
+		// Add the items appended after the counted ones
+		UINT32 const size = FileGetSize(f) - sizeof(l_item_count);
+		if (l_item_count * sizeof(*l_items) < size)
+		{
+			l_item_count = size / sizeof(*l_items);
+		}
 		if (l_item_count != 0)
 		{
 			l_items.Allocate(l_item_count);
@@ -257,50 +277,70 @@ void LoadWorldItemsFromTempItemFile(INT16 const x, INT16 const y, INT8 const z,
 }
 
 
-void AddItemsToUnLoadedSector(INT16 const sMapX, INT16 const sMapY, INT8 const bMapZ, INT16 const sGridNo, UINT32 const uiNumberOfItemsToAdd, OBJECTTYPE const* const pObject, UINT8 const ubLevel, UINT16 const usFlags, INT8 const bRenderZHeightAboveLevel, Visibility const bVisible)
+static void CompactWorldItemsTempFile(INT16 const x, INT16 const y, INT8 const z)
 {
-	UINT32     uiNumberOfItems;
+	UINT32     n_items;
 	WORLDITEM* wis;
-	LoadWorldItemsFromTempItemFile(sMapX, sMapY, bMapZ, &uiNumberOfItems, &wis);
+	LoadWorldItemsFromTempItemFile(x, y, z, &n_items, &wis);
+	WORLDITEM* const end = std::remove_if(wis, wis + n_items, [](WORLDITEM const& wi) { return !wi.fExists; });
+	SaveWorldItemsToTempItemFile(x, y, z, end - wis, wis);
+	MemFree(wis);
+}
+
+
+void AddItemsToUnLoadedSector(INT16 const sMapX, INT16 const sMapY, INT8 const bMapZ, INT16 const sGridNo, UINT32 const uiNumberOfItemsToAdd, OBJECTTYPE const* const pObject, UINT8 const ubLevel, UINT16 const usFlags, INT8 const bRenderZHeightAboveLevel, Visibility const bVisible)
+{
+	char filename[128];
+	GetMapTempFileName(SF_ITEM_TEMP_FILE_EXISTS, filename, sMapX, sMapY, bMapZ);
 
-	//loop through all the objects to add
-	for (UINT32 uiLoop1 = 0; uiLoop1 < uiNumberOfItemsToAdd; ++uiLoop1)
+	bool   const existed   = GCM->doesTempFileExist(filename);
+	UINT32       n_visible = existed ? GetNumberOfVisibleWorldItemsFromSectorStructureForSector(sMapX, sMapY, bMapZ) : 0;
+	UINT32       n_counted = 0;
+	UINT32       n_appended;
 	{
-		// Loop through the array to see if there is a free spot to add an item to it
-		UINT32 cnt;
-		for (cnt = 0;; ++cnt)
+		AutoSGPFile f(GCM->openTempFileForAppend(filename));
+		if (FileGetSize(f) == 0)
 		{
-			if (cnt == uiNumberOfItems)
-			{
-				//Error, there wasnt a free spot.  Reallocate memory for the array
-				wis = REALLOC(wis, WORLDITEM, ++uiNumberOfItems);
-				break;
-			}
-			if (!wis[cnt].fExists) break;
+			FileWrite(f, &n_counted, sizeof(n_counted));
 		}
 
-		WORLDITEM* const wi = &wis[cnt];
-		wi->fExists                  = TRUE;
-		wi->sGridNo                  = sGridNo;
-		wi->ubLevel                  = ubLevel;
-		wi->usFlags                  = usFlags;
-		wi->bVisible                 = bVisible;
-		wi->bRenderZHeightAboveLevel = bRenderZHeightAboveLevel;
-		wi->o                        = pObject[uiLoop1];
-
-		if (sGridNo == NOWHERE && !(wi->usFlags & WORLD_ITEM_GRIDNO_NOT_SET_USE_ENTRY_POINT))
+		//loop through all the objects to add
+		for (UINT32 uiLoop1 = 0; uiLoop1 < uiNumberOfItemsToAdd; ++uiLoop1)
 		{
-			wi->usFlags |= WORLD_ITEM_GRIDNO_NOT_SET_USE_ENTRY_POINT;
-			// Display warning.....
-			SLOGW(
-				"Trying to add item ( %d: %ls ) to invalid gridno in unloaded sector. Please Report.",
-				wi->o.usItem, ItemNames[wi->o.usItem]);
+			WORLDITEM wi = WORLDITEM();
+			wi.fExists                  = TRUE;
+			wi.sGridNo                  = sGridNo;
+			wi.ubLevel                  = ubLevel;
+			wi.usFlags                  = usFlags;
+			wi.bVisible                 = bVisible;
+			wi.bRenderZHeightAboveLevel = bRenderZHeightAboveLevel;
+			wi.o                        = pObject[uiLoop1];
+
+			if (sGridNo == NOWHERE && !(wi.usFlags & WORLD_ITEM_GRIDNO_NOT_SET_USE_ENTRY_POINT))
+			{
+				wi.usFlags |= WORLD_ITEM_GRIDNO_NOT_SET_USE_ENTRY_POINT;
+				// Display warning.....
+				SLOGW(
+					"Trying to add item ( %d: %ls ) to invalid gridno in unloaded sector. Please Report.",
+					wi.o.usItem, ItemNames[wi.o.usItem]);
+			}
+
+			FileWrite(f, &wi, sizeof(wi));
+			if (IsMapScreenWorldItemVisibleInMapInventory(&wi)) n_visible += wi.o.ubNumberOfObjects;
 		}
+
+		FileSeek(f, 0, FILE_SEEK_FROM_START);
+		FileRead(f, &n_counted, sizeof(n_counted));
+		n_appended = (FileGetSize(f) - sizeof(n_counted)) / sizeof(WORLDITEM) - n_counted;
 	}
 
-	SaveWorldItemsToTempItemFile(sMapX, sMapY, bMapZ, uiNumberOfItems, wis);
+	SetSectorFlag(sMapX, sMapY, bMapZ, SF_ITEM_TEMP_FILE_EXISTS);
+	SetNumberOfVisibleWorldItemsInSectorStructureForSector(sMapX, sMapY, bMapZ, n_visible);
 
-	MemFree(wis);
+	if (n_appended > std::max(n_counted, UINT32(MIN_APPENDED_ITEMS_BEFORE_COMPACTING)))
+	{
+		CompactWorldItemsTempFile(sMapX, sMapY, bMapZ);
+	}
 }
 
 
@@ -658,6 +698,7 @@ static void LoadAndAddWorldItemsFromTempFile(INT16 const sMapX, INT16 const sMap
 void InitTacticalSave()
 {
 	FileMan::createDir(TEMPDIR);
+	GCM->deleteAllTempFiles();
 	EraseDirectory(TEMPDIR);
 }
 
@@ -666,7 +707,7 @@ static void SaveRottingCorpsesToTempCorpseFile(INT16 const x, INT16 const y, INT
 {
 	char map_name[128];
 	GetMapTempFileName(SF_ROTTING_CORPSE_TEMP_FILE_EXISTS, map_name, x, y, z);
-	AutoSGPFile f(FileMan::openForWriting(map_name));
+	AutoSGPFile f(GCM->openTempFileForWriting(map_name, true));
 
 	// Save the number of the rotting corpses
 	UINT32 n_corpses = 0;
@@ -691,9 +732,9 @@ static void LoadRottingCorpsesFromTempCorpseFile(INT16 const x, INT16 const y, I
 	GetMapTempFileName(SF_ROTTING_CORPSE_TEMP_FILE_EXISTS, map_name, x, y, z);
 
 	// If the file doesn't exist, it's no problem.
-	if (!GCM->doesGameResExists(map_name)) return;
+	if (!GCM->doesTempFileExist(map_name)) return;
 
-	AutoSGPFile f(GCM->openGameResForReading(map_name));
+	AutoSGPFile f(GCM->openTempFileForReading(map_name));
 
 	// Load the number of Rotting corpses
 	UINT32 n_corpses;
@@ -816,7 +857,7 @@ void AddRottingCorpseToUnloadedSectorsRottingCorpseFile(INT16 const sMapX, INT16
 	char map_name[128];
 	GetMapTempFileName(SF_ROTTING_CORPSE_TEMP_FILE_EXISTS, map_name, sMapX, sMapY, bMapZ);
 
-	AutoSGPFile f(FileMan::openForReadWrite(map_name));
+	AutoSGPFile f(GCM->openTempFileForWriting(map_name, false));
 
 	UINT32 corpse_count;
 	if (FileGetSize(f) != 0)
@@ -1016,36 +1057,198 @@ void InitExitGameDialogBecauseFileHackDetected()
 static UINT8 const* GetRotationArray();
 
 
-void NewJA2EncryptedFileRead(HWFILE const f, BYTE* const pDest, UINT32 const uiBytesToRead)
+/* The rotation cipher adds the previous encrypted byte and a byte of the
+ * rotation array to every byte. Decrypting only depends on the encrypted
+ * bytes, so it is done 16 bytes at a time. Encrypting is a running sum, which
+ * is done as a prefix sum over 16 bytes at a time. Both read the rotation
+ * array from a copy tiled by 15 bytes, so 16 bytes starting at any index are
+ * contiguous. The scalar loops handle the rest and are the reference
+ * implementation. */
+#define ROTATION_BLOCK 16
+
+
+static void DecryptRotationScalar(BYTE* const data, UINT32 const n, UINT8 const* const rotation, UINT32 const rotation_size, UINT32 idx, UINT8 last)
 {
-	FileRead(f, pDest, uiBytesToRead);
+	for (UINT32 i = 0; i < n; ++i)
+	{
+		UINT8 const encrypted = data[i];
+		data[i] -= last + rotation[idx];
+		if (++idx >= rotation_size) idx = 0;
+		last = encrypted;
+	}
+}
 
-	const UINT8* const pubRotationArray = GetRotationArray();
-	UINT8              ubArrayIndex     = 0;
-	UINT8              ubLastByte       = 0;
-	for (UINT32 i = 0; i < uiBytesToRead; ++i)
+
+static void EncryptRotationScalar(BYTE* const dst, BYTE const* const src, UINT32 const n, UINT8 const* const rotation, UINT32 const rotation_size, UINT32 idx, UINT8 last)
+{
+	for (UINT32 i = 0; i < n; ++i)
 	{
-		UINT8 const ubLastByteForNextLoop = pDest[i];
-		pDest[i] -= ubLastByte + pubRotationArray[ubArrayIndex];
-		if (++ubArrayIndex >= NEW_ROTATION_ARRAY_SIZE) ubArrayIndex = 0;
-		ubLastByte = ubLastByteForNextLoop;
+		last = dst[i] = src[i] + last + rotation[idx];
+		if (++idx >= rotation_size) idx = 0;
 	}
 }
 
 
-void NewJA2EncryptedFileWrite(HWFILE const hFile, BYTE const* const data, UINT32 const uiBytesToWrite)
+static void TileRotation(UINT8* const tiled, UINT8 const* const rotation, UINT32 const rotation_size)
 {
-	SGP::Buffer<UINT8> buf(uiBytesToWrite);
-	const UINT8* const pubRotationArray = GetRotationArray();
-	UINT8              ubArrayIndex     = 0;
-	UINT8              last_byte        = 0;
-	for (UINT32 i = 0; i < uiBytesToWrite; ++i)
+	for (UINT32 i = 0; i != rotation_size + ROTATION_BLOCK - 1; ++i)
 	{
-		buf[i] = data[i] + last_byte + pubRotationArray[ubArrayIndex];
-		last_byte = buf[i];
-		if (++ubArrayIndex >= NEW_ROTATION_ARRAY_SIZE) ubArrayIndex = 0;
+		tiled[i] = rotation[i % rotation_size];
 	}
+}
+
 
+#if defined BLT_SSE2
+static void DecryptRotationSSE2(BYTE* const data, UINT32 const n, UINT8 const* const rotation, UINT32 const rotation_size)
+{
+	UINT8 tiled[NEW_ROTATION_ARRAY_SIZE + ROTATION_BLOCK - 1];
+	TileRotation(tiled, rotation, rotation_size);
+
+	UINT32  i    = 0;
+	UINT32  idx  = 0;
+	__m128i prev = _mm_setzero_si128(); // the last block, still encrypted
+	for (; i + ROTATION_BLOCK <= n; i += ROTATION_BLOCK)
+	{
+		__m128i const c    = _mm_loadu_si128(reinterpret_cast<__m128i const*>(data + i));
+		__m128i const last = _mm_or_si128(_mm_slli_si128(c, 1), _mm_srli_si128(prev, 15));
+		__m128i const key  = _mm_loadu_si128(reinterpret_cast<__m128i const*>(tiled + idx));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(data + i), _mm_sub_epi8(c, _mm_add_epi8(last, key)));
+		prev = c;
+		idx += ROTATION_BLOCK;
+		if (idx >= rotation_size) idx -= rotation_size;
+	}
+	UINT8 const last = (UINT8)_mm_cvtsi128_si32(_mm_srli_si128(prev, 15));
+	DecryptRotationScalar(data + i, n - i, rotation, rotation_size, idx, last);
+}
+
+
+static void EncryptRotationSSE2(BYTE* const dst, BYTE const* const src, UINT32 const n, UINT8 const* const rotation, UINT32 const rotation_size)
+{
+	UINT8 tiled[NEW_ROTATION_ARRAY_SIZE + ROTATION_BLOCK - 1];
+	TileRotation(tiled, rotation, rotation_size);
+
+	UINT32  i     = 0;
+	UINT32  idx   = 0;
+	__m128i carry = _mm_setzero_si128(); // the last encrypted byte in all lanes
+	for (; i + ROTATION_BLOCK <= n; i += ROTATION_BLOCK)
+	{
+		__m128i const p   = _mm_loadu_si128(reinterpret_cast<__m128i const*>(src + i));
+		__m128i const key = _mm_loadu_si128(reinterpret_cast<__m128i const*>(tiled + idx));
+		__m128i       x   = _mm_add_epi8(p, key);
+		x = _mm_add_epi8(x, _mm_slli_si128(x, 1));
+		x = _mm_add_epi8(x, _mm_slli_si128(x, 2));
+		x = _mm_add_epi8(x, _mm_slli_si128(x, 4));
+		x = _mm_add_epi8(x, _mm_slli_si128(x, 8));
+		x = _mm_add_epi8(x, carry);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), x);
+		carry = _mm_shuffle_epi32(_mm_shufflehi_epi16(_mm_unpackhi_epi8(x, x), 0xFF), 0xFF);
+		idx += ROTATION_BLOCK;
+		if (idx >= rotation_size) idx -= rotation_size;
+	}
+	EncryptRotationScalar(dst + i, src + i, n - i, rotation, rotation_size, idx, (UINT8)_mm_cvtsi128_si32(carry));
+}
+
+#elif defined BLT_NEON
+static void DecryptRotationNEON(BYTE* const data, UINT32 const n, UINT8 const* const rotation, UINT32 const rotation_size)
+{
+	UINT8 tiled[NEW_ROTATION_ARRAY_SIZE + ROTATION_BLOCK - 1];
+	TileRotation(tiled, rotation, rotation_size);
+
+	UINT32     i    = 0;
+	UINT32     idx  = 0;
+	uint8x16_t prev = vdupq_n_u8(0); // the last block, still encrypted
+	for (; i + ROTATION_BLOCK <= n; i += ROTATION_BLOCK)
+	{
+		uint8x16_t const c    = vld1q_u8(data + i);
+		uint8x16_t const last = vextq_u8(prev, c, 15);
+		uint8x16_t const key  = vld1q_u8(tiled + idx);
+		vst1q_u8(data + i, vsubq_u8(c, vaddq_u8(last, key)));
+		prev = c;
+		idx += ROTATION_BLOCK;
+		if (idx >= rotation_size) idx -= rotation_size;
+	}
+	DecryptRotationScalar(data + i, n - i, rotation, rotation_size, idx, vgetq_lane_u8(prev, 15));
+}
+
+
+static void EncryptRotationNEON(BYTE* const dst, BYTE const* const src, UINT32 const n, UINT8 const* const rotation, UINT32 const rotation_size)
+{
+	UINT8 tiled[NEW_ROTATION_ARRAY_SIZE + ROTATION_BLOCK - 1];
+	TileRotation(tiled, rotation, rotation_size);
+
+	UINT32           i    = 0;
+	UINT32           idx  = 0;
+	UINT8            last = 0;
+	uint8x16_t const zero = vdupq_n_u8(0);
+	for (; i + ROTATION_BLOCK <= n; i += ROTATION_BLOCK)
+	{
+		uint8x16_t x = vaddq_u8(vld1q_u8(src + i), vld1q_u8(tiled + idx));
+		x = vaddq_u8(x, vextq_u8(zero, x, 15));
+		x = vaddq_u8(x, vextq_u8(zero, x, 14));
+		x = vaddq_u8(x, vextq_u8(zero, x, 12));
+		x = vaddq_u8(x, vextq_u8(zero, x, 8));
+		x = vaddq_u8(x, vdupq_n_u8(last));
+		vst1q_u8(dst + i, x);
+		last = vgetq_lane_u8(x, 15);
+		idx += ROTATION_BLOCK;
+		if (idx >= rotation_size) idx -= rotation_size;
+	}
+	EncryptRotationScalar(dst + i, src + i, n - i, rotation, rotation_size, idx, last);
+}
+#endif
+
+
+static void DecryptRotation(BYTE* const data, UINT32 const n, UINT8 const* const rotation, UINT32 const rotation_size)
+{
+	Assert(ROTATION_BLOCK <= rotation_size && rotation_size <= NEW_ROTATION_ARRAY_SIZE);
+#if defined BLT_SSE2
+	if (g_simd_blitters)
+	{
+		DecryptRotationSSE2(data, n, rotation, rotation_size);
+		return;
+	}
+#elif defined BLT_NEON
+	if (g_simd_blitters)
+	{
+		DecryptRotationNEON(data, n, rotation, rotation_size);
+		return;
+	}
+#endif
+	DecryptRotationScalar(data, n, rotation, rotation_size, 0, 0);
+}
+
+
+static void EncryptRotation(BYTE* const dst, BYTE const* const src, UINT32 const n, UINT8 const* const rotation, UINT32 const rotation_size)
+{
+	Assert(ROTATION_BLOCK <= rotation_size && rotation_size <= NEW_ROTATION_ARRAY_SIZE);
+#if defined BLT_SSE2
+	if (g_simd_blitters)
+	{
+		EncryptRotationSSE2(dst, src, n, rotation, rotation_size);
+		return;
+	}
+#elif defined BLT_NEON
+	if (g_simd_blitters)
+	{
+		EncryptRotationNEON(dst, src, n, rotation, rotation_size);
+		return;
+	}
+#endif
+	EncryptRotationScalar(dst, src, n, rotation, rotation_size, 0, 0);
+}
+
+
+void NewJA2EncryptedFileRead(HWFILE const f, BYTE* const pDest, UINT32 const uiBytesToRead)
+{
+	FileRead(f, pDest, uiBytesToRead);
+	DecryptRotation(pDest, uiBytesToRead, GetRotationArray(), NEW_ROTATION_ARRAY_SIZE);
+}
+
+
+void NewJA2EncryptedFileWrite(HWFILE const hFile, BYTE const* const data, UINT32 const uiBytesToWrite)
+{
+	SGP::Buffer<UINT8> buf(uiBytesToWrite);
+	EncryptRotation(buf, data, uiBytesToWrite, GetRotationArray(), NEW_ROTATION_ARRAY_SIZE);
 	FileWrite(hFile, buf, uiBytesToWrite);
 }
 
@@ -1056,31 +1259,14 @@ static const UINT8 ubRotationArray[46] = { 132, 235, 125, 99, 15, 220, 140, 89,
 void JA2EncryptedFileRead(HWFILE const f, BYTE* const pDest, UINT32 const uiBytesToRead)
 {
 	FileRead(f, pDest, uiBytesToRead);
-
-	UINT8 ubArrayIndex = 0;
-	UINT8 ubLastByte   = 0;
-	for (UINT32 i = 0; i < uiBytesToRead; ++i)
-	{
-		UINT8 const ubLastByteForNextLoop = pDest[i];
-		pDest[i] -= ubLastByte + ubRotationArray[ubArrayIndex];
-		if (++ubArrayIndex >= ROTATION_ARRAY_SIZE) ubArrayIndex = 0;
-		ubLastByte = ubLastByteForNextLoop;
-	}
+	DecryptRotation(pDest, uiBytesToRead, ubRotationArray, ROTATION_ARRAY_SIZE);
 }
 
 
 void JA2EncryptedFileWrite(HWFILE const hFile, BYTE const* const data, UINT32 const uiBytesToWrite)
 {
 	SGP::Buffer<UINT8> buf(uiBytesToWrite);
-	UINT8              ubArrayIndex = 0;
-	UINT8              last_byte    = 0;
-	for (UINT32 i = 0; i < uiBytesToWrite; ++i)
-	{
-		buf[i] += data[i] + last_byte + ubRotationArray[ubArrayIndex];
-		last_byte = buf[i];
-		if (++ubArrayIndex >= ROTATION_ARRAY_SIZE) ubArrayIndex = 0;
-	}
-
+	EncryptRotation(buf, data, uiBytesToWrite, ubRotationArray, ROTATION_ARRAY_SIZE);
 	FileWrite(hFile, buf, uiBytesToWrite);
 }
 
@@ -1107,7 +1293,7 @@ void GetMapTempFileName(SectorFlags const uiType, char* const pMapName, INT16 co
 
 		default: SLOGA("GetMapTempFileName: invalid Type"); return;
 	}
-	sprintf(pMapName, TEMPDIR "/%s_%s", prefix, zTempName);
+	sprintf(pMapName, "%s_%s", prefix, zTempName);
 }
 
 
@@ -1156,7 +1342,7 @@ void SetNumberOfVisibleWorldItemsInSectorStructureForSector(INT16 const x, INT16
 }
 
 
-static void SynchronizeItemTempFileVisbleItemsToSectorInfoVisbleItems(INT16 const sMapX, INT16 const sMapY, INT8 const bMapZ, bool const check_consistency)
+static void SynchronizeItemTempFileVisbleItemsToSectorInfoVisbleItems(INT16 const sMapX, INT16 const sMapY, INT8 const bMapZ)
 {
 	UINT32     uiTotalNumberOfItems;
 	WORLDITEM* pTotalSectorList;
@@ -1173,14 +1359,6 @@ static void SynchronizeItemTempFileVisbleItemsToSectorInfoVisbleItems(INT16 cons
 		MemFree(pTotalSectorList);
 	}
 
-	if (check_consistency)
-	{
-		const UINT32 uiReported = GetNumberOfVisibleWorldItemsFromSectorStructureForSector(sMapX, sMapY, bMapZ);
-		if (uiItemCount != uiReported)
-		{
-			SLOGW("SynchronizeItemTempFile() Reported %d, should be %d", uiReported, uiItemCount);
-		}
-	}
 	SetNumberOfVisibleWorldItemsInSectorStructureForSector(sMapX, sMapY, bMapZ, uiItemCount);
 }
 
@@ -3503,4 +3681,38 @@ TEST(TacticalSave, asserts)
 	EXPECT_EQ(lengthof(g_encryption_array), static_cast<size_t>(BASE_NUMBER_OF_ROTATION_ARRAYS * 12));
 }
 
+TEST(TacticalSave, rotationCipher)
+{
+	UINT8 const* const rotations[]     = { g_encryption_array[0], g_encryption_array[lengthof(g_encryption_array) - 1], ubRotationArray };
+	UINT32 const       rotation_size[] = { NEW_ROTATION_ARRAY_SIZE, NEW_ROTATION_ARRAY_SIZE, ROTATION_ARRAY_SIZE };
+
+	UINT32 seed = 1;
+	std::vector<BYTE> plain(1000);
+	for (size_t i = 0; i != plain.size(); ++i)
+	{
+		seed = seed * 1103515245 + 12345;
+		plain[i] = (BYTE)(seed >> 16);
+	}
+
+	// Lengths around the block size and across several rotations
+	UINT32 const lengths[] = { 0, 1, 15, 16, 17, 31, 32, 33, 49, 100, 1000 };
+	for (size_t r = 0; r != lengthof(rotations); ++r)
+	{
+		for (UINT32 const n : lengths)
+		{
+			std::vector<BYTE> expected(n);
+			std::vector<BYTE> encrypted(n);
+			EncryptRotationScalar(expected.data(), plain.data(), n, rotations[r], rotation_size[r], 0, 0);
+			EncryptRotation(encrypted.data(), plain.data(), n, rotations[r], rotation_size[r]);
+			EXPECT_EQ(encrypted, expected);
+
+			std::vector<BYTE> decrypted(encrypted);
+			DecryptRotationScalar(expected.data(), n, rotations[r], rotation_size[r], 0, 0);
+			DecryptRotation(decrypted.data(), n, rotations[r], rotation_size[r]);
+			EXPECT_EQ(decrypted, expected);
+			EXPECT_TRUE(std::equal(decrypted.begin(), decrypted.end(), plain.begin()));
+		}
+	}
+}
+
 #endif
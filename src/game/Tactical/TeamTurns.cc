@@ -34,6 +34,7 @@
 #include "SkillCheck.h"
 #include "AIInternals.h"
 #include "AIList.h"
+#include "AIPlan.h"
 #include "RenderWorld.h"
 #include "Rotting_Corpses.h"
 #include "Squads.h"
@@ -359,6 +360,9 @@ void BeginTeamTurn( UINT8 ubTeam )
 			// Set First enemy merc to AI control
 			if ( BuildAIListForTeam( ubTeam ) )
 			{
+				// work out what the whole team will ask while deciding at once, in parallel
+				PlanAITeamTurn(ubTeam);
+
 				SOLDIERTYPE* const s = RemoveFirstAIListEntry();
 				if (s != NULL)
 				{
@@ -1694,6 +1694,14 @@ static void HandleModCtrl(UINT32 const key, UIEventKind* const new_event)
 
 		case 'o': if (CHEATER_CHEAT_LEVEL()) CreatePlayerControlledMonster(); break;
 
+		case 'p':
+			if (DEBUG_CHEAT_LEVEL())
+			{
+				SOLDIERTYPE* const sel = GetSelectedMan();
+				if (sel) BenchmarkPathAI(sel);
+			}
+			break;
+
 		case 'q':
 			if (gamepolicy(isHotkeyEnabled(UI_Tactical, HKMOD_CTRL, 'q')))
 			{
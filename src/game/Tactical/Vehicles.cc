@@ -51,6 +51,13 @@ VEHICLETYPE *pVehicleList = NULL;
 // number of vehicle slots on the list
 UINT8 ubNumberOfVehicles = 0;
 
+/* Where the last lookups found the soldier of each vehicle and the vehicle of
+ * each movement group. An entry is only a hint: it is checked on use and looked
+ * up anew if it went stale, because soldiers change their slot, e.g. when they
+ * change sides, and vehicles are added and removed without notice. */
+static SOLDIERTYPE* g_vehicle_soldier[256];
+static UINT8        g_group_vehicle[256];
+
 
 //ATE: These arrays below should all be in a large LUT which contains
 // static info for each vehicle....
@@ -141,6 +148,7 @@ INT32 AddVehicleToList(const INT16 sMapX, const INT16 sMapY, const INT16 sGridNo
 	g->ubNextX              = sMapX;
 	g->ubSectorY            = sMapY;
 	g->ubNextY              = sMapY;
+	ReindexGroupSector(*g);
 	g->uiTraverseTime       = 0;
 	g->uiArrivalTime        = 0;
 
@@ -467,11 +475,20 @@ VEHICLETYPE& GetVehicle(INT32 const vehicle_id)
 
 VEHICLETYPE& GetVehicleFromMvtGroup(GROUP const& g)
 {
+	UINT8 const hint = g_group_vehicle[g.ubGroupID];
+	if (hint < ubNumberOfVehicles)
+	{
+		VEHICLETYPE& v = pVehicleList[hint];
+		if (v.fValid && v.ubMovementGroup == g.ubGroupID) return v;
+	}
+
 	// given the id of a mvt group, find a vehicle in this group
 	FOR_EACH_VEHICLE(i)
 	{
 		VEHICLETYPE& v = *i;
-		if (v.ubMovementGroup == g.ubGroupID) return v;
+		if (v.ubMovementGroup != g.ubGroupID) continue;
+		g_group_vehicle[g.ubGroupID] = VEHICLE2ID(v);
+		return v;
 	}
 	throw std::logic_error("Group does not contain a vehicle");
 }
@@ -606,6 +623,7 @@ BOOLEAN ExitVehicle(SOLDIERTYPE* const s)
 
 	//AllTeamsLookForAll( FALSE );
 	s->bOppList[vs.ubID] = 1;
+	++guiOppListVersion;
 
 	// Add to sector....
 	EVENT_SetSoldierPosition(s, sGridNo, SSP_NONE);
@@ -753,12 +771,25 @@ INT8 RepairVehicle(VEHICLETYPE const& v, INT8 const bRepairPtsLeft, BOOLEAN* con
 }
 
 
+static bool IsSoldierOfVehicle(SOLDIERTYPE const& s, UINT32 const vehicle_id)
+{
+	return
+		s.bActive                          &&
+		s.uiStatusFlags & SOLDIER_VEHICLE  &&
+		(UINT32)s.bVehicleID == vehicle_id;
+}
+
+
 SOLDIERTYPE& GetSoldierStructureForVehicle(VEHICLETYPE const& v)
 {
+	UINT32       const id   = VEHICLE2ID(v);
+	SOLDIERTYPE* const hint = g_vehicle_soldier[id];
+	if (hint && IsSoldierOfVehicle(*hint, id)) return *hint;
+
 	FOR_EACH_SOLDIER(s)
 	{
-		if (!(s->uiStatusFlags & SOLDIER_VEHICLE)) continue;
-		if (s->bVehicleID != VEHICLE2ID(v))        continue;
+		if (!IsSoldierOfVehicle(*s, id)) continue;
+		g_vehicle_soldier[id] = s;
 		return *s;
 	}
 	throw std::logic_error("Vehicle has no corresponding soldier");
@@ -199,7 +199,7 @@ INT8 EffectiveArmour(OBJECTTYPE const* const o)
 	INT8  const plate_pos  = FindAttachment(o, CERAMIC_PLATES);
 	if (plate_pos != ITEM_NOT_FOUND)
 	{
-		armour_val += Armour[GCM->getItem(CERAMIC_PLATES)->getClassIndex()].ubProtection * o->bAttachStatus[plate_pos] / 100;
+		armour_val += Armour[GetItemProperties(CERAMIC_PLATES).ubClassIndex].ubProtection * o->bAttachStatus[plate_pos] / 100;
 	}
 	return armour_val;
 }
@@ -213,7 +213,7 @@ INT8 ArmourPercent(const SOLDIERTYPE* pSoldier)
 	{
 		iVest = EffectiveArmour( &(pSoldier->inv[VESTPOS]) );
 		// convert to % of best; ignoring bug-treated stuff
-		iVest = 65 * iVest / ( Armour[ GCM->getItem(SPECTRA_VEST_18)->getClassIndex() ].ubProtection + Armour[ GCM->getItem(CERAMIC_PLATES)->getClassIndex() ].ubProtection );
+		iVest = 65 * iVest / ( Armour[ GetItemProperties(SPECTRA_VEST_18).ubClassIndex ].ubProtection + Armour[ GetItemProperties(CERAMIC_PLATES).ubClassIndex ].ubProtection );
 	}
 	else
 	{
@@ -224,7 +224,7 @@ INT8 ArmourPercent(const SOLDIERTYPE* pSoldier)
 	{
 		iHelmet = EffectiveArmour( &(pSoldier->inv[HELMETPOS]) );
 		// convert to % of best; ignoring bug-treated stuff
-		iHelmet = 15 * iHelmet / Armour[ GCM->getItem(SPECTRA_HELMET_18)->getClassIndex() ].ubProtection;
+		iHelmet = 15 * iHelmet / Armour[ GetItemProperties(SPECTRA_HELMET_18).ubClassIndex ].ubProtection;
 	}
 	else
 	{
@@ -235,7 +235,7 @@ INT8 ArmourPercent(const SOLDIERTYPE* pSoldier)
 	{
 		iLeg = EffectiveArmour( &(pSoldier->inv[LEGPOS]) );
 		// convert to % of best; ignoring bug-treated stuff
-		iLeg = 25 * iLeg / Armour[ GCM->getItem(SPECTRA_LEGGINGS_18)->getClassIndex() ].ubProtection;
+		iLeg = 25 * iLeg / Armour[ GetItemProperties(SPECTRA_LEGGINGS_18).ubClassIndex ].ubProtection;
 	}
 	else
 	{
@@ -250,11 +250,11 @@ static INT8 ExplosiveEffectiveArmour(OBJECTTYPE* pObj)
 	INT32 iValue;
 	INT8  bPlate;
 
-	if (pObj == NULL || GCM->getItem(pObj->usItem)->getItemClass() != IC_ARMOUR)
+	if (pObj == NULL || GetItemProperties(pObj->usItem).uiItemClass != IC_ARMOUR)
 	{
 		return( 0 );
 	}
-	iValue = Armour[ GCM->getItem(pObj->usItem)->getClassIndex() ].ubProtection;
+	iValue = Armour[ GetItemProperties(pObj->usItem).ubClassIndex ].ubProtection;
 	iValue = iValue * pObj->bStatus[0] / 100;
 	if ( pObj->usItem == FLAK_JACKET || pObj->usItem == FLAK_JACKET_18 || pObj->usItem == FLAK_JACKET_Y )
 	{
@@ -267,7 +267,7 @@ static INT8 ExplosiveEffectiveArmour(OBJECTTYPE* pObj)
 	{
 		INT32 iValue2;
 
-		iValue2 = Armour[ GCM->getItem(CERAMIC_PLATES)->getClassIndex() ].ubProtection;
+		iValue2 = Armour[ GetItemProperties(CERAMIC_PLATES).ubClassIndex ].ubProtection;
 		iValue2 = iValue2 * pObj->bAttachStatus[ bPlate ] / 100;
 
 		iValue += iValue2;
@@ -284,7 +284,7 @@ INT8 ArmourVersusExplosivesPercent( SOLDIERTYPE * pSoldier )
 	{
 		iVest = ExplosiveEffectiveArmour( &(pSoldier->inv[VESTPOS]) );
 		// convert to % of best; ignoring bug-treated stuff
-		iVest = __min( 65, 65 * iVest / ( Armour[ GCM->getItem(SPECTRA_VEST_18)->getClassIndex() ].ubProtection + Armour[ GCM->getItem(CERAMIC_PLATES)->getClassIndex() ].ubProtection) );
+		iVest = __min( 65, 65 * iVest / ( Armour[ GetItemProperties(SPECTRA_VEST_18).ubClassIndex ].ubProtection + Armour[ GetItemProperties(CERAMIC_PLATES).ubClassIndex ].ubProtection) );
 	}
 	else
 	{
@@ -295,7 +295,7 @@ INT8 ArmourVersusExplosivesPercent( SOLDIERTYPE * pSoldier )
 	{
 		iHelmet = ExplosiveEffectiveArmour( &(pSoldier->inv[HELMETPOS]) );
 		// convert to % of best; ignoring bug-treated stuff
-		iHelmet = __min( 15, 15 * iHelmet / Armour[ GCM->getItem(SPECTRA_HELMET_18)->getClassIndex() ].ubProtection );
+		iHelmet = __min( 15, 15 * iHelmet / Armour[ GetItemProperties(SPECTRA_HELMET_18).ubClassIndex ].ubProtection );
 	}
 	else
 	{
@@ -306,7 +306,7 @@ INT8 ArmourVersusExplosivesPercent( SOLDIERTYPE * pSoldier )
 	{
 		iLeg = ExplosiveEffectiveArmour( &(pSoldier->inv[LEGPOS]) );
 		// convert to % of best; ignoring bug-treated stuff
-		iLeg = __min( 25, 25 * iLeg / Armour[ GCM->getItem(SPECTRA_LEGGINGS_18)->getClassIndex() ].ubProtection );
+		iLeg = __min( 25, 25 * iLeg / Armour[ GetItemProperties(SPECTRA_LEGGINGS_18).ubClassIndex ].ubProtection );
 	}
 	else
 	{
@@ -362,7 +362,7 @@ BOOLEAN CheckForGunJam( SOLDIERTYPE * pSoldier )
 	// should jams apply to enemies?
 	if (pSoldier->uiStatusFlags & SOLDIER_PC)
 	{
-		if ( GCM->getItem(pSoldier->usAttackingWeapon)->getItemClass() == IC_GUN && !EXPLOSIVE_GUN( pSoldier->usAttackingWeapon ) )
+		if ( GetItemProperties(pSoldier->usAttackingWeapon).uiItemClass == IC_GUN && !EXPLOSIVE_GUN( pSoldier->usAttackingWeapon ) )
 		{
 			pObj = &(pSoldier->inv[pSoldier->ubAttackingHand]);
 				if (pObj->bGunAmmoStatus > 0)
@@ -410,7 +410,7 @@ BOOLEAN CheckForGunJam( SOLDIERTYPE * pSoldier )
 			else if (pObj->bGunAmmoStatus < 0)
 			{
 				// try to unjam gun
-				iResult = SkillCheck( pSoldier, UNJAM_GUN_CHECK, (INT8) (GCM->getItem(pObj->usItem)->getReliability() * 4) );
+				iResult = SkillCheck( pSoldier, UNJAM_GUN_CHECK, (INT8) (GetItemProperties(pObj->usItem).bReliability * 4) );
 				if (iResult > 0)
 				{
 					// yay! unjammed the gun
@@ -492,7 +492,7 @@ BOOLEAN FireWeapon( SOLDIERTYPE *pSoldier , INT16 sTargetGridNo )
 	// SET ATTACKER TO NOBODY, WILL GET SET EVENTUALLY
 	pSoldier->opponent = NULL;
 
-	switch( GCM->getItem(pSoldier->usAttackingWeapon)->getItemClass() )
+	switch( GetItemProperties(pSoldier->usAttackingWeapon).uiItemClass )
 	{
 		case IC_THROWING_KNIFE:
 		case IC_GUN:
@@ -774,7 +774,7 @@ static BOOLEAN UseGun(SOLDIERTYPE* pSoldier, INT16 sTargetGridNo)
 
 		//PLAY SOUND
 		// ( For throwing knife.. it's earlier in the animation
-		if ( GCM->getWeapon( usItemNum )->hasSound() && GCM->getItem(usItemNum)->getItemClass() != IC_THROWING_KNIFE )
+		if ( GCM->getWeapon( usItemNum )->hasSound() && GetItemProperties(usItemNum).uiItemClass != IC_THROWING_KNIFE )
 		{
 			// Switch on silencer...
 			if( FindAttachment( &( pSoldier->inv[ pSoldier->ubAttackingHand ] ), SILENCER ) != NO_SLOT )
@@ -791,7 +791,7 @@ static BOOLEAN UseGun(SOLDIERTYPE* pSoldier, INT16 sTargetGridNo)
 
 
 	// CALC CHANCE TO HIT
-	if ( GCM->getItem(usItemNum)->getItemClass() == IC_THROWING_KNIFE )
+	if ( GetItemProperties(usItemNum).uiItemClass == IC_THROWING_KNIFE )
 	{
 		uiHitChance = CalcThrownChanceToHit( pSoldier, sTargetGridNo, pSoldier->bAimTime, pSoldier->bAimShotLocation );
 	}
@@ -816,7 +816,7 @@ static BOOLEAN UseGun(SOLDIERTYPE* pSoldier, INT16 sTargetGridNo)
 	GetTargetWorldPositions( pSoldier, sTargetGridNo, &dTargetX, &dTargetY, &dTargetZ );
 
 	// Some things we don't do for knives...
-	if ( GCM->getItem(usItemNum)->getItemClass() != IC_THROWING_KNIFE )
+	if ( GetItemProperties(usItemNum).uiItemClass != IC_THROWING_KNIFE )
 	{
 		// Deduct AMMO!
 		DeductAmmo( pSoldier, pSoldier->ubAttackingHand );
@@ -953,7 +953,7 @@ static BOOLEAN UseGun(SOLDIERTYPE* pSoldier, INT16 sTargetGridNo)
 
 	ubVolume = GCM->getWeapon( pSoldier->usAttackingWeapon )->ubAttackVolume;
 
-	if ( GCM->getItem(usItemNum)->getItemClass() == IC_THROWING_KNIFE )
+	if ( GetItemProperties(usItemNum).uiItemClass == IC_THROWING_KNIFE )
 	{
 		// Here, remove the knife...	or (for now) rocket launcher
 		RemoveObjs( &(pSoldier->inv[ HANDPOS ] ), 1 );
@@ -1013,7 +1013,7 @@ static BOOLEAN UseGun(SOLDIERTYPE* pSoldier, INT16 sTargetGridNo)
 	}
 
 	// CJC: since jamming is no longer affected by reliability, increase chance of status going down for really unreliabile guns
-	uiDepreciateTest = BASIC_DEPRECIATE_CHANCE + 3 * GCM->getItem(usItemNum)->getReliability();
+	uiDepreciateTest = BASIC_DEPRECIATE_CHANCE + 3 * GetItemProperties(usItemNum).bReliability;
 
 	if ( !PreRandom( uiDepreciateTest ) && ( pSoldier->inv[ pSoldier->ubAttackingHand ].bStatus[0] > 1) )
 	{
@@ -1546,7 +1546,7 @@ static BOOLEAN UseLauncher(SOLDIERTYPE* pSoldier, INT16 sTargetGridNo)
 
 	uiDiceRoll = PreRandom( 100 );
 
-	if ( GCM->getItem(usItemNum)->getItemClass() == IC_LAUNCHER )
+	if ( GetItemProperties(usItemNum).uiItemClass == IC_LAUNCHER )
 	{
 		// Preserve gridno!
 		//pSoldier->sLastTarget = sTargetGridNo;
@@ -1783,7 +1783,7 @@ void StructureHit(BULLET* const pBullet, const INT16 sXPos, const INT16 sYPos, c
 		case KNIFECLASS:
 
 			// When it hits the ground, leave on map...
-			if ( GCM->getItem(usWeaponIndex)->getItemClass() == IC_THROWING_KNIFE )
+			if ( GetItemProperties(usWeaponIndex).uiItemClass == IC_THROWING_KNIFE )
 			{
 				OBJECTTYPE Object;
 
@@ -2045,13 +2045,13 @@ BOOLEAN InRange(const SOLDIERTYPE* pSoldier, INT16 sGridNo)
 
 	usInHand = pSoldier->inv[HANDPOS].usItem;
 
-	if ( GCM->getItem(usInHand)->getItemClass() == IC_GUN ||
-		GCM->getItem(usInHand)->getItemClass() == IC_THROWING_KNIFE  )
+	if ( GetItemProperties(usInHand).uiItemClass == IC_GUN ||
+		GetItemProperties(usInHand).uiItemClass == IC_THROWING_KNIFE  )
 	{
 		// Determine range
 		sRange = (INT16)GetRangeInCellCoordsFromGridNoDiff( pSoldier->sGridNo, sGridNo );
 
-		if ( GCM->getItem(usInHand)->getItemClass() == IC_THROWING_KNIFE )
+		if ( GetItemProperties(usInHand).uiItemClass == IC_THROWING_KNIFE )
 		{
 			// NB CalcMaxTossRange returns range in tiles, not in world units
 			if ( sRange <= CalcMaxTossRange( pSoldier, THROWING_KNIFE, TRUE ) * CELL_X_SIZE )
@@ -2291,7 +2291,7 @@ UINT32 CalcChanceToHitGun(SOLDIERTYPE *pSoldier, UINT16 sGridNo, UINT8 ubAimTime
 	if (pSoldier->bShock)
 		iChance -= (pSoldier->bShock * AIM_PENALTY_PER_SHOCK);
 
-	if ( GCM->getItem(usInHand)->getItemClass() == IC_GUN )
+	if ( GetItemProperties(usInHand).uiItemClass == IC_GUN )
 	{
 		bAttachPos = FindAttachment( pInHand, GUN_BARREL_EXTENDER );
 		if ( bAttachPos != ITEM_NOT_FOUND )
@@ -2803,7 +2803,7 @@ INT32 TotalArmourProtection(SOLDIERTYPE& pTarget, const UINT8 ubHitLocation, con
 				if (bPlatePos != -1)
 				{
 					// bullet got through jacket; apply ceramic plate armour
-					iTotalProtection += ArmourProtection(pTarget, GCM->getItem(pArmour->usAttachItem[bPlatePos])->getClassIndex(), &(pArmour->bAttachStatus[bPlatePos]), iImpact, ubAmmoType);
+					iTotalProtection += ArmourProtection(pTarget, GetItemProperties(pArmour->usAttachItem[bPlatePos]).ubClassIndex, &(pArmour->bAttachStatus[bPlatePos]), iImpact, ubAmmoType);
 					if ( pArmour->bAttachStatus[bPlatePos] < USABLE )
 					{
 						// destroy plates!
@@ -2822,7 +2822,7 @@ INT32 TotalArmourProtection(SOLDIERTYPE& pTarget, const UINT8 ubHitLocation, con
 			// if the plate didn't stop the bullet...
 			if ( iImpact > iTotalProtection )
 			{
-				iTotalProtection += ArmourProtection( pTarget, GCM->getItem(pArmour->usItem)->getClassIndex(), &(pArmour->bStatus[0]), iImpact, ubAmmoType );
+				iTotalProtection += ArmourProtection( pTarget, GetItemProperties(pArmour->usItem).ubClassIndex, &(pArmour->bStatus[0]), iImpact, ubAmmoType );
 				if ( pArmour->bStatus[ 0 ] < USABLE )
 				{
 					DeleteObj( pArmour );
@@ -2844,7 +2844,7 @@ INT32 BulletImpact( SOLDIERTYPE *pFirer, SOLDIERTYPE * pTarget, UINT8 ubHitLocat
 	// in MoveBullet.
 
 	// Set a few things up:
-	if ( GCM->getItem(pFirer->usAttackingWeapon)->getItemClass() == IC_THROWING_KNIFE )
+	if ( GetItemProperties(pFirer->usAttackingWeapon).uiItemClass == IC_THROWING_KNIFE )
 	{
 		ubAmmoType = AMMO_KNIFE;
 	}
@@ -3323,7 +3323,7 @@ static UINT32 CalcChanceHTH(SOLDIERTYPE* pAttacker, SOLDIERTYPE* pDefender, UINT
 	}
 	else
 	{
-		if ( GCM->getItem(usInHand)->getItemClass() != IC_PUNCH )
+		if ( GetItemProperties(usInHand).uiItemClass != IC_PUNCH )
 		{
 			return(0);
 		}
@@ -3507,7 +3507,7 @@ static UINT32 CalcChanceHTH(SOLDIERTYPE* pAttacker, SOLDIERTYPE* pDefender, UINT
 	{
 		if (ubMode == HTH_MODE_STAB)
 		{
-			if (GCM->getItem(pDefender->inv[HANDPOS].usItem)->getItemClass() == IC_BLADE)
+			if (GetItemProperties(pDefender->inv[HANDPOS].usItem).uiItemClass == IC_BLADE)
 			{
 				// good with knives, got one, so we're good at parrying
 				iDefRating += gbSkillTraitBonus[KNIFING] * NUM_SKILL_TRAITS(pDefender, KNIFING);
@@ -3524,7 +3524,7 @@ static UINT32 CalcChanceHTH(SOLDIERTYPE* pAttacker, SOLDIERTYPE* pDefender, UINT
 		}
 		else
 		{	// punch/hand-to-hand/martial arts attack/steal
-			if (GCM->getItem(pDefender->inv[HANDPOS].usItem)->getItemClass() == IC_BLADE && ubMode != HTH_MODE_STEAL)
+			if (GetItemProperties(pDefender->inv[HANDPOS].usItem).uiItemClass == IC_BLADE && ubMode != HTH_MODE_STEAL)
 			{
 				// with our knife, we get some bonus at defending from HTH attacks
 				iDefRating += gbSkillTraitBonus[KNIFING] * NUM_SKILL_TRAITS(pDefender, KNIFING) / 2;
@@ -3632,28 +3632,28 @@ INT32 CalcMaxTossRange(const SOLDIERTYPE* pSoldier, UINT16 usItem, BOOLEAN fArme
 		usItem = usSubItem;
 	}
 
-	if ( GCM->getItem(usItem)->getItemClass() == IC_LAUNCHER && fArmed )
+	if ( GetItemProperties(usItem).uiItemClass == IC_LAUNCHER && fArmed )
 	{
 		// this function returns range in tiles so, stupidly, we have to divide by 10 here
 		iRange = GCM->getWeapon(usItem)->usRange / CELL_X_SIZE;
 	}
 	else
 	{
-		if ( GCM->getItem(usItem)->getFlags() & ITEM_UNAERODYNAMIC )
+		if ( GetItemProperties(usItem).fFlags & ITEM_UNAERODYNAMIC )
 		{
 			iRange = 1;
 		}
-		else if ( GCM->getItem(usItem)->getItemClass() == IC_GRENADE )
+		else if ( GetItemProperties(usItem).uiItemClass == IC_GRENADE )
 		{
 			// start with the range based on the soldier's strength and the item's weight
 			INT32 iThrowingStrength = ( EffectiveStrength( pSoldier ) * 2 + 100 ) / 3;
-			iRange = 2 + ( iThrowingStrength / __min( ( 3 + (GCM->getItem(usItem)->getWeight()) / 3 ), 4 ) );
+			iRange = 2 + ( iThrowingStrength / __min( ( 3 + (GetItemProperties(usItem).ubWeight) / 3 ), 4 ) );
 		}
 		else
 		{	// not as aerodynamic!
 
 			// start with the range based on the soldier's strength and the item's weight
-			iRange = 2 + ( ( EffectiveStrength( pSoldier ) / ( 5 + GCM->getItem(usItem)->getWeight()) ) );
+			iRange = 2 + ( ( EffectiveStrength( pSoldier ) / ( 5 + GetItemProperties(usItem).ubWeight) ) );
 		}
 
 		// adjust for thrower's remaining breath (lose up to 1/2 of range)
@@ -3687,7 +3687,7 @@ UINT32 CalcThrownChanceToHit(SOLDIERTYPE *pSoldier, INT16 sGridNo, UINT8 ubAimTi
 		usHandItem = pSoldier->inv[HANDPOS].usItem;
 	}
 
-	if ( GCM->getItem(usHandItem)->getItemClass() != IC_LAUNCHER && pSoldier->bWeaponMode != WM_ATTACHED )
+	if ( GetItemProperties(usHandItem).uiItemClass != IC_LAUNCHER && pSoldier->bWeaponMode != WM_ATTACHED )
 	{
 		// PHYSICALLY THROWN arced projectile (ie. grenade)
 		// for lack of anything better, base throwing accuracy on dex & marskmanship
@@ -3785,7 +3785,7 @@ UINT32 CalcThrownChanceToHit(SOLDIERTYPE *pSoldier, INT16 sGridNo, UINT8 ubAimTi
 				(3 * pSoldier->bLifeMax);
 
 		// for mechanically-fired projectiles, reduce penalty in half
-		if ( GCM->getItem(usHandItem)->getItemClass() == IC_LAUNCHER )
+		if ( GetItemProperties(usHandItem).uiItemClass == IC_LAUNCHER )
 		{
 			bPenalty /= 2;
 		}
@@ -3801,7 +3801,7 @@ UINT32 CalcThrownChanceToHit(SOLDIERTYPE *pSoldier, INT16 sGridNo, UINT8 ubAimTi
 		bPenalty = (iChance * (100 - pSoldier->bBreath)) / 200;
 
 		// for mechanically-fired projectiles, reduce penalty in half
-		if ( GCM->getItem(usHandItem)->getItemClass() == IC_LAUNCHER )
+		if ( GetItemProperties(usHandItem).uiItemClass == IC_LAUNCHER )
 			bPenalty /= 2;
 
 		// reduce breath penalty due to merc's dexterity (he can compensate!)
@@ -3809,7 +3809,7 @@ UINT32 CalcThrownChanceToHit(SOLDIERTYPE *pSoldier, INT16 sGridNo, UINT8 ubAimTi
 	}
 
 	// if iChance exists, but it's a mechanical item being used
-	if ((iChance > 0) && (GCM->getItem(usHandItem)->getItemClass() == IC_LAUNCHER ))
+	if ((iChance > 0) && (GetItemProperties(usHandItem).uiItemClass == IC_LAUNCHER ))
 		// reduce iChance to hit DIRECTLY by the item's working condition
 		iChance = (iChance * WEAPON_STATUS_MOD(pSoldier->inv[HANDPOS].bStatus[0])) / 100;
 
@@ -15,6 +15,7 @@
 #include "Campaign_Types.h"
 #include "Random.h"
 #include "Action_Items.h"
+#include "PathAI.h"
 #include "GameSettings.h"
 #include "Quests.h"
 #include "Soldier_Profile.h"
@@ -27,6 +28,8 @@
 
 #include <algorithm>
 #include <stdexcept>
+#include <unordered_map>
+#include <vector>
 
 //Global dynamic array of all of the items in a loaded map.
 WORLDITEM *gWorldItems = NULL;
@@ -35,6 +38,71 @@ UINT32    guiNumWorldItems = 0;
 WORLDBOMB *gWorldBombs = NULL;
 UINT32    guiNumWorldBombs = 0;
 
+/* Indices into gWorldBombs by the tile, the frequency of the remote bombs and
+ * of the timed bombs, so triggers and turns need not scan the whole table.
+ * Each list is in ascending order, like a scan of the table, as the order
+ * decides which bomb goes off first. */
+static std::unordered_map<INT16, std::vector<UINT32>> g_bombs_in_gridno;
+static std::unordered_map<INT8,  std::vector<UINT32>> g_remote_bombs;
+static std::vector<UINT32>                            g_timed_bombs;
+static std::vector<UINT32> const                      g_no_bombs;
+
+
+static void InsertBombIndex(std::vector<UINT32>& v, UINT32 const idx)
+{
+	v.insert(std::lower_bound(v.begin(), v.end(), idx), idx);
+}
+
+
+static void EraseBombIndex(std::vector<UINT32>& v, UINT32 const idx)
+{
+	std::vector<UINT32>::iterator const i = std::lower_bound(v.begin(), v.end(), idx);
+	if (i != v.end() && *i == idx) v.erase(i);
+}
+
+
+std::vector<UINT32> const& WorldBombsInGridNo(INT16 const sGridNo)
+{
+	std::unordered_map<INT16, std::vector<UINT32>>::const_iterator const i = g_bombs_in_gridno.find(sGridNo);
+	return i != g_bombs_in_gridno.end() ? i->second : g_no_bombs;
+}
+
+
+std::vector<UINT32> const& RemoteWorldBombsOnFrequency(INT8 const bFrequency)
+{
+	std::unordered_map<INT8, std::vector<UINT32>>::const_iterator const i = g_remote_bombs.find(bFrequency);
+	return i != g_remote_bombs.end() ? i->second : g_no_bombs;
+}
+
+
+std::vector<UINT32> const& TimedWorldBombs()
+{
+	return g_timed_bombs;
+}
+
+
+static void IndexWorldBomb(UINT32 const idx)
+{
+	WORLDITEM const& wi = GetWorldItem(gWorldBombs[idx].iItemIndex);
+	InsertBombIndex(g_bombs_in_gridno[wi.sGridNo], idx);
+	switch (wi.o.bDetonatorType)
+	{
+		case BOMB_REMOTE: InsertBombIndex(g_remote_bombs[wi.o.bFrequency], idx); break;
+		case BOMB_TIMED:  InsertBombIndex(g_timed_bombs, idx);                   break;
+	}
+}
+
+
+static void UnindexWorldBomb(UINT32 const idx)
+{
+	WORLDITEM const& wi = GetWorldItem(gWorldBombs[idx].iItemIndex);
+	std::vector<UINT32>& here = g_bombs_in_gridno[wi.sGridNo];
+	EraseBombIndex(here, idx);
+	if (here.empty()) g_bombs_in_gridno.erase(wi.sGridNo);
+	EraseBombIndex(g_remote_bombs[wi.o.bFrequency], idx);
+	EraseBombIndex(g_timed_bombs, idx);
+}
+
 
 static INT32 GetFreeWorldBombIndex(void)
 {
@@ -70,6 +138,7 @@ static INT32 AddBombToWorld(INT32 iItemIndex)
 	//Add the new world item to the table.
 	gWorldBombs[ iBombIndex ].fExists = TRUE;
 	gWorldBombs[ iBombIndex ].iItemIndex = iItemIndex;
+	IndexWorldBomb(iBombIndex);
 
 	return ( iBombIndex );
 }
@@ -79,11 +148,12 @@ static void RemoveBombFromWorldByItemIndex(INT32 iItemIndex)
 {
 	// Find the world bomb which corresponds with a particular world item, then
 	// remove the world bomb from the table.
-	FOR_EACH_WORLD_BOMB(wb)
+	for (UINT32 const idx : WorldBombsInGridNo(GetWorldItem(iItemIndex).sGridNo))
 	{
-		if (wb->iItemIndex != iItemIndex) continue;
+		if (gWorldBombs[idx].iItemIndex != iItemIndex) continue;
 
-		wb->fExists = FALSE;
+		UnindexWorldBomb(idx);
+		gWorldBombs[idx].fExists = FALSE;
 		return;
 	}
 }
@@ -91,12 +161,12 @@ static void RemoveBombFromWorldByItemIndex(INT32 iItemIndex)
 
 INT32 FindWorldItemForBombInGridNo(const INT16 sGridNo, const INT8 bLevel)
 {
-	CFOR_EACH_WORLD_BOMB(wb)
+	for (UINT32 const idx : WorldBombsInGridNo(sGridNo))
 	{
-		WORLDITEM const& wi = GetWorldItem(wb->iItemIndex);
-		if (wi.sGridNo != sGridNo || wi.ubLevel != bLevel) continue;
+		WORLDITEM const& wi = GetWorldItem(gWorldBombs[idx].iItemIndex);
+		if (wi.ubLevel != bLevel) continue;
 
-		return wb->iItemIndex;
+		return gWorldBombs[idx].iItemIndex;
 	}
 	throw std::logic_error("Cannot find bomb item");
 }
@@ -250,6 +320,9 @@ void TrashWorldItems()
 		gWorldBombs = NULL;
 		guiNumWorldBombs = 0;
 	}
+	g_bombs_in_gridno.clear();
+	g_remote_bombs.clear();
+	g_timed_bombs.clear();
 }
 
 
@@ -309,7 +382,7 @@ void LoadWorldItemsFromMap(HWFILE const f)
 				const MagazineModel *mag = item->asAmmo();
 				if (weapon && weapon->isInBigGunList())
 				{
-					const WeaponModel *replacement = GCM->getWeaponByName(item->asWeapon()->getStandardReplacement());
+					const WeaponModel *replacement = GCM->getWeaponReplacement(weapon);
 
 						// everything else can be the same? no.
 						INT8 const ammo     = o.ubGunShotsLeft;
@@ -320,7 +393,7 @@ void LoadWorldItemsFromMap(HWFILE const f)
 				}
 				else if (mag && mag->isInBigGunList())
 				{
-					const MagazineModel *replacement = GCM->getMagazineByName(mag->getStandardReplacement());
+					const MagazineModel *replacement = GCM->getMagazineReplacement(mag);
 
 						// Go through status values and scale up/down
 						UINT8 const mag_size     = mag->capacity;
@@ -358,6 +431,7 @@ void LoadWorldItemsFromMap(HWFILE const f)
 					wi.usFlags |= WORLD_ITEM_ARMED_BOMB;
 					// this is coming from the map so the enemy must know about it.
 					gpWorldLevelData[wi.sGridNo].uiFlags |= MAPELEMENT_ENEMY_MINE_PRESENT;
+					InvalidatePathCache();
 				}
 				break;
 		}
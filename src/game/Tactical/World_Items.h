@@ -4,6 +4,8 @@
 #include "Debug.h"
 #include "Item_Types.h"
 
+#include <vector>
+
 
 #define WORLD_ITEM_DONTRENDER				0x0001
 #define WOLRD_ITEM_FIND_SWEETSPOT_FROM_GRIDNO		0x0002
@@ -81,6 +83,13 @@ extern UINT32 guiNumWorldBombs;
 #define FOR_EACH_WORLD_BOMB( iter) BASE_FOR_EACH_WORLD_BOMB(      WORLDBOMB, iter)
 #define CFOR_EACH_WORLD_BOMB(iter) BASE_FOR_EACH_WORLD_BOMB(const WORLDBOMB, iter)
 
+/* The indices into gWorldBombs of the bombs on a tile, of the remote bombs on a
+ * frequency and of the timed bombs, in ascending order. The detonator is the
+ * one the bomb had when it was put into the world. */
+std::vector<UINT32> const& WorldBombsInGridNo(INT16 sGridNo);
+std::vector<UINT32> const& RemoteWorldBombsOnFrequency(INT8 bFrequency);
+std::vector<UINT32> const& TimedWorldBombs();
+
 extern void FindPanicBombsAndTriggers( void );
 extern INT32 FindWorldItemForBombInGridNo( INT16 sGridNo, INT8 bLevel);
 
@@ -5,8 +5,9 @@
 #include "WorldDef.h"
 #include "Logger.h"
 
-extern INT8	gubAIPathCosts[19][19];
-#define AI_PATHCOST_RADIUS 9
+#define AI_PATHCOST_RADIUS 25
+#define AI_PATHCOST_SIZE   (2 * AI_PATHCOST_RADIUS + 1)
+extern UINT8	gubAIPathCosts[AI_PATHCOST_SIZE][AI_PATHCOST_SIZE];
 
 extern BOOLEAN gfDisplayCoverValues;
 extern INT16 gsCoverValue[WORLD_MAX];
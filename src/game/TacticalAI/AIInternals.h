@@ -181,3 +181,67 @@ BOOLEAN InLightAtNight( INT16 sGridNo, INT8 bLevel );
 INT16 FindNearbyDarkerSpot( SOLDIERTYPE *pSoldier );
 
 BOOLEAN ArmySeesOpponents( void );
+
+/* The location searches of a realtime decision are steps, whose results are
+ * kept. If the think time of the frame is spent, the decision gives up before
+ * its next search and is made again in the next frame, where the steps it got
+ * through are replayed from what was kept. */
+enum AIThinkStepKind
+{
+	AI_STEP_COVER,
+	AI_STEP_DISTURBANCE,
+	AI_STEP_FRIEND,
+	AI_STEP_DARKER_SPOT
+};
+
+struct AIThinkStep
+{
+	AIThinkStepKind kind;
+	INT32           arg;
+	BOOLEAN         done;
+	INT16           sGridNo;
+	INT32           iData;
+};
+
+/* Returns the step to fill in or replay, or NULL outside of a realtime
+ * decision, where the search is simply made. */
+AIThinkStep* ResumeThinkStep(SOLDIERTYPE const&, AIThinkStepKind, INT32 arg);
+
+/* What a soldier knows about one of his opponents, from whichever of his
+ * personal and his team's public opplist is more recent. */
+struct KnownOpponent
+{
+	SOLDIERTYPE* pOpponent;
+	BOOLEAN      fKnown;            // known personally or publicly, not only seen before
+	INT8         bPersOL;           // personal opplist value
+	INT8         bOppList;          // the more recent of the personal and public value
+	BOOLEAN      fPersonal;         // the personal knowledge is at least as recent
+	INT16        sKnownLoc;         // "best guess" gridno of the opponent
+	INT8         bKnownLevel;
+	INT32        iCertainty;        // ThreatPercent[] of bOppList
+	INT32        iThreatValue;      // CalcManThreatValue() at our gridno, not reduced for cover
+	INT32        iCoverThreatValue; // the same reduced for cover, -1 until asked for
+};
+
+struct KnownOpponents
+{
+	UINT          n;
+	KnownOpponent opp[TOTAL_SOLDIERS];
+};
+
+/* The opponents, neither neutral nor on our side, the soldier knows about
+ * personally or publicly, or has only seen before in the sector, in merc slot
+ * order. During a decision the list is built
+ * once and shared by the helpers of the decision until an opplist changes;
+ * outside of one it is built anew on every call. The list stays valid until it
+ * is asked for for another soldier. */
+KnownOpponents& GetKnownOpponents(SOLDIERTYPE* pSoldier);
+INT32 KnownOpponentCoverThreatValue(SOLDIERTYPE* pSoldier, KnownOpponent&);
+
+/* Brackets a decision of DecideAction() or CreatureDecideAction(). */
+class AIDecisionScope
+{
+	public:
+		AIDecisionScope();
+		~AIDecisionScope();
+};
@@ -13,8 +13,11 @@
 #include "Points.h"
 #include "Weapons.h"
 #include "Items.h"
+#include "MemMan.h"
 #include "Handle_Items.h"
 #include "AIInternals.h"
+#include "AITiming.h"
+#include "FindLocations.h"
 #include "Animation_Data.h"
 #include "LOS.h"
 #include "Message.h"
@@ -39,6 +42,7 @@
 #include "Quests.h"
 #include "Queen_Command.h"
 #include "Debug.h"
+#include "Profiler.h"
 
 #include <algorithm>
 
@@ -90,6 +94,9 @@ static void TurnBasedHandleNPCAI(SOLDIERTYPE* pSoldier);
 
 void HandleSoldierAI( SOLDIERTYPE *pSoldier )
 {
+	PROFILE_ZONE("HandleSoldierAI");
+	MEM_TAG_SCOPE(MEM_TAG_AI);
+
 	// ATE
 	// Bail if we are engaged in a NPC conversation/ and/or sequence ... or we have a pause because
 	// we just saw someone... or if there are bombs on the bomb queue
@@ -399,6 +406,7 @@ void HandleSoldierAI( SOLDIERTYPE *pSoldier )
 		}
 
 		// figure out what to do!
+		AIThinkScope const think(*pSoldier);
 		if (gfTurnBasedAI)
 		{
 			if (pSoldier->fNoAPToFinishMove)
@@ -1169,6 +1177,7 @@ static void TurnBasedHandleNPCAI(SOLDIERTYPE* pSoldier)
 		{
 			if (!(gTacticalStatus.uiFlags & ENGAGED_IN_CONV))
 			{
+				InvalidateAPDistanceField();
 				if (CREATURE_OR_BLOODCAT( pSoldier ))
 				{
 					pSoldier->bAction = CreatureDecideAction( pSoldier );
@@ -0,0 +1,201 @@
+#include "AIPlan.h"
+#include "Animation_Control.h"
+#include "Isometric_Utils.h"
+#include "LOS.h"
+#include "Overhead.h"
+#include "Path_Batch.h"
+#include "Soldier_Control.h"
+#include "Structure.h"
+#include "WorkerPool.h"
+
+#include <utility>
+#include <vector>
+
+
+#define PLAN_CLEARANCE 2 // squared tile distance from a shot within which people may be in the way
+
+
+// What the trace reads of the firer besides the query
+struct PlannedShot
+{
+	UINT16 usAttackingWeapon;
+	UINT16 usHandItem;
+	UINT8  ubGunAmmoType;
+};
+
+// What of a soldier can change what lies in the way of a shot
+struct PlannedSoldier
+{
+	GridNo  sGridNo;
+	INT8    bLevel;
+	UINT16  usAnimState;
+	BOOLEAN fInWorld;
+};
+
+
+static std::vector<CTGTQuery>   g_queries;
+static std::vector<PlannedShot> g_shots; // one per query
+static PlannedSoldier           g_soldiers[TOTAL_SOLDIERS];
+static UINT32                   g_fixed_structures_version;
+
+
+static PlannedSoldier SoldierState(SOLDIERTYPE const& s)
+{
+	PlannedSoldier p;
+	p.sGridNo     = s.sGridNo;
+	p.bLevel      = s.bLevel;
+	p.usAnimState = s.usAnimState;
+	p.fInWorld    = s.bActive && s.bInSector && s.pLevelNode != NULL;
+	return p;
+}
+
+
+static bool SameSoldierState(PlannedSoldier const& a, PlannedSoldier const& b)
+{
+	return
+		a.fInWorld    == b.fInWorld &&
+		a.sGridNo     == b.sGridNo  &&
+		a.bLevel      == b.bLevel   &&
+		a.usAnimState == b.usAnimState;
+}
+
+
+static bool NearShot(GridNo const g, CTGTQuery const& q)
+{
+	INT16 x;
+	INT16 y;
+	INT16 x0;
+	INT16 y0;
+	INT16 x1;
+	INT16 y1;
+	ConvertGridNoToXY(g,              &x,  &y);
+	ConvertGridNoToXY(q.sStartGridNo, &x0, &y0);
+	ConvertGridNoToXY(q.sEndGridNo,   &x1, &y1);
+
+	// squared distance from the tile to the segment between firer and target
+	INT32 const dx  = x1 - x0;
+	INT32 const dy  = y1 - y0;
+	INT32 const len = dx * dx + dy * dy;
+	INT32 const t   = (x - x0) * dx + (y - y0) * dy;
+	double px = x0;
+	double py = y0;
+	if (len != 0 && t > 0)
+	{
+		double const f = t >= len ? 1 : (double)t / len;
+		px += f * dx;
+		py += f * dy;
+	}
+	double const ex = x - px;
+	double const ey = y - py;
+	return ex * ex + ey * ey <= PLAN_CLEARANCE;
+}
+
+
+static bool SamePreparedShot(CTGTQuery const& a, CTGTQuery const& b)
+{
+	return
+		a.firer        == b.firer        &&
+		a.target       == b.target       &&
+		a.sStartGridNo == b.sStartGridNo &&
+		a.dStartZ      == b.dStartZ      &&
+		a.sEndGridNo   == b.sEndGridNo   &&
+		a.dEndZ        == b.dEndZ;
+}
+
+
+// Whether nobody stepped into or out of the way of the shot since the plan
+static bool ShotStillClear(CTGTQuery const& q)
+{
+	for (UINT i = 0; i != TOTAL_SOLDIERS; ++i)
+	{
+		PlannedSoldier const& then = g_soldiers[i];
+		PlannedSoldier const  now  = SoldierState(GetMan(i));
+		if (SameSoldierState(then, now)) continue;
+		if (then.fInWorld && NearShot(then.sGridNo, q)) return false;
+		if (now.fInWorld  && NearShot(now.sGridNo,  q)) return false;
+	}
+	return true;
+}
+
+
+static void PlanShots(UINT8 const team)
+{
+	g_queries.clear();
+	g_shots.clear();
+
+	// the trace reads the weapon, so it is set as CalcBestShot() does until the
+	// traces are done
+	std::vector<std::pair<SOLDIERTYPE*, UINT16> > weapons;
+	FOR_EACH_IN_TEAM(i, team)
+	{
+		SOLDIERTYPE& s = *i;
+		if (!s.bInSector || s.bLife < OKLIFE) continue;
+
+		weapons.push_back(std::make_pair(&s, s.usAttackingWeapon));
+		s.usAttackingWeapon = s.inv[HANDPOS].usItem;
+		FOR_EACH_MERC(j)
+		{
+			SOLDIERTYPE const* const o = *j;
+			if (!o->bLife) continue;
+			if (CONSIDERED_NEUTRAL(&s, o) || s.bSide == o->bSide) continue;
+			if (s.bOppList[o->ubID] != SEEN_CURRENTLY) continue;
+
+			CTGTQuery q;
+			PrepareAISoldierToSoldierChanceToGetThrough(q, &s, o);
+			if (!q.fTrace) continue;
+
+			PlannedShot p;
+			p.usAttackingWeapon = s.usAttackingWeapon;
+			p.usHandItem        = s.inv[HANDPOS].usItem;
+			p.ubGunAmmoType     = s.inv[HANDPOS].ubGunAmmoType;
+			g_queries.push_back(q);
+			g_shots.push_back(p);
+		}
+	}
+	if (!g_queries.empty()) ChanceToGetThroughTests(&g_queries[0], (UINT)g_queries.size());
+	for (auto const& w : weapons) w.first->usAttackingWeapon = w.second;
+
+	for (UINT i = 0; i != TOTAL_SOLDIERS; ++i) g_soldiers[i] = SoldierState(GetMan(i));
+	g_fixed_structures_version = guiFixedStructuresVersion;
+}
+
+
+void PlanAITeamTurn(UINT8 const team)
+{
+	g_queries.clear();
+	g_shots.clear();
+	// Without worker threads the work would only be done up front instead of
+	// when needed
+	if (WorkerPoolSize() == 1) return;
+
+	EstimatePathCostsForTeam(team);
+	PlanShots(team);
+}
+
+
+UINT8 PlannedAISoldierToSoldierChanceToGetThrough(SOLDIERTYPE* const firer, SOLDIERTYPE const* const target)
+{
+	CTGTQuery q;
+	PrepareAISoldierToSoldierChanceToGetThrough(q, firer, target);
+	if (!q.fTrace) return q.ubChance;
+
+	if (guiFixedStructuresVersion == g_fixed_structures_version)
+	{
+		for (size_t i = 0; i != g_queries.size(); ++i)
+		{
+			if (!SamePreparedShot(g_queries[i], q)) continue;
+			PlannedShot const& p = g_shots[i];
+			if (p.usAttackingWeapon != firer->usAttackingWeapon ||
+					p.usHandItem        != firer->inv[HANDPOS].usItem ||
+					p.ubGunAmmoType     != firer->inv[HANDPOS].ubGunAmmoType)
+			{
+				break;
+			}
+			if (!ShotStillClear(q)) break;
+			return g_queries[i].ubChance;
+		}
+	}
+
+	ChanceToGetThroughTests(&q, 1);
+	return q.ubChance;
+}
@@ -0,0 +1,19 @@
+#ifndef AI_PLAN_H
+#define AI_PLAN_H
+
+#include "JA2Types.h"
+
+
+/* Works out, at the start of an AI team's turn, what its soldiers will ask
+ * while deciding, for the whole team at once on the worker threads: the path
+ * cost estimates and the chance to get through from every soldier to every
+ * opponent he sees. Each soldier acts on a world the earlier ones changed, so
+ * the answers are checked again when they are asked for. */
+void PlanAITeamTurn(UINT8 team);
+
+/* Like AISoldierToSoldierChanceToGetThrough(), but takes the chance planned at
+ * the start of the turn if the shot and everything which could be in the way
+ * are still the same. */
+UINT8 PlannedAISoldierToSoldierChanceToGetThrough(SOLDIERTYPE* firer, SOLDIERTYPE const* target);
+
+#endif
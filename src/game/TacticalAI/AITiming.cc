@@ -0,0 +1,183 @@
+#include "AITiming.h"
+#include "Debug_Pages.h"
+#include "Font.h"
+#include "Font_Control.h"
+#include "Logger.h"
+#include "Overhead.h"
+#include "Soldier_Control.h"
+#include "Timer.h"
+
+#include <SDL.h>
+
+
+#define AI_THINK_BUDGET_US 5000 // think time per frame in realtime
+
+
+struct AITimerStats
+{
+	UINT32   calls;
+	uint64_t ticks;
+	uint64_t max;
+};
+
+
+static wchar_t const* const g_timer_names[] =
+{
+	L"Think:",
+	L"Decide green:",
+	L"Decide yellow:",
+	L"Decide red:",
+	L"Decide black:",
+	L"Decide creature:",
+	L"Find locations:",
+	L"Closest reachable:",
+	L"Best attack:",
+	L"Path searches:"
+};
+
+static AITimerStats      g_timers[AI_NUM_TIMERS];
+static thread_local UINT g_depth[AI_NUM_TIMERS];
+static uint64_t          g_slice_ticks;      // think time in the current slice
+static uint64_t          g_last_slice_ticks;
+static UINT32            g_slices_cut;       // slices which ran out of budget
+static UINT32            g_yields;           // decisions continued in a later frame
+static uint64_t          g_think_start;      // of the think in progress, 0 if none
+static SoldierID         g_slowest_id = NOBODY;
+static uint64_t          g_slowest_ticks;
+
+
+static double TicksToUS(uint64_t const ticks)
+{
+	return ticks * 1000000.0 / SDL_GetPerformanceFrequency();
+}
+
+
+uint64_t AITimerStart(AITimer const timer)
+{
+	if (g_depth[timer]++ != 0) return 0;
+	/* Only what happens while a soldier thinks is recorded. The depth is per
+	 * thread, so this also keeps the workers out. */
+	if (timer != AI_TIMER_THINK && g_depth[AI_TIMER_THINK] == 0) return 0;
+	return SDL_GetPerformanceCounter();
+}
+
+
+void AITimerStop(AITimer const timer, uint64_t const start)
+{
+	if (--g_depth[timer] != 0 || start == 0) return;
+	uint64_t const ticks = SDL_GetPerformanceCounter() - start;
+	AITimerStats& t = g_timers[timer];
+	++t.calls;
+	t.ticks += ticks;
+	if (t.max < ticks) t.max = ticks;
+}
+
+
+AIThinkScope::AIThinkScope(SOLDIERTYPE const& s) :
+	s_(s),
+	start_(AITimerStart(AI_TIMER_THINK))
+{
+	if (start_ != 0) g_think_start = start_;
+}
+
+
+AIThinkScope::~AIThinkScope()
+{
+	AITimerStop(AI_TIMER_THINK, start_);
+	if (start_ == 0) return;
+	g_think_start = 0;
+	uint64_t const ticks = SDL_GetPerformanceCounter() - start_;
+	g_slice_ticks += ticks;
+	if (g_slowest_ticks < ticks)
+	{
+		g_slowest_ticks = ticks;
+		g_slowest_id    = s_.ubID;
+	}
+}
+
+
+void AIBeginThinkSlice()
+{
+	if (g_slice_ticks != 0) g_last_slice_ticks = g_slice_ticks;
+	g_slice_ticks = 0;
+}
+
+
+bool AIThinkSliceSpent()
+{
+	// The budget depends on the speed of the machine, which a replay must not
+	if (ClockIsFixed()) return false;
+	if (TicksToUS(g_slice_ticks) <= AI_THINK_BUDGET_US) return false;
+	++g_slices_cut;
+	return true;
+}
+
+
+bool AIThinkBudgetSpent()
+{
+	if (ClockIsFixed()) return false;
+	uint64_t ticks = g_slice_ticks;
+	if (g_think_start != 0) ticks += SDL_GetPerformanceCounter() - g_think_start;
+	return TicksToUS(ticks) > AI_THINK_BUDGET_US;
+}
+
+
+void AICountThinkYield()
+{
+	++g_yields;
+}
+
+
+void ResetAITimers()
+{
+	for (UINT i = 0; i != AI_NUM_TIMERS; ++i) g_timers[i] = AITimerStats{};
+	g_slice_ticks      = 0;
+	g_last_slice_ticks = 0;
+	g_slices_cut       = 0;
+	g_yields           = 0;
+	g_slowest_id       = NOBODY;
+	g_slowest_ticks    = 0;
+}
+
+
+void LogAITimers()
+{
+	for (UINT i = 0; i != AI_NUM_TIMERS; ++i)
+	{
+		AITimerStats const& t = g_timers[i];
+		if (t.calls == 0) continue;
+		SLOGI("  %-20ls %8u calls %10.1f ms %8.0f us avg %8.0f us max",
+			g_timer_names[i], t.calls, TicksToUS(t.ticks) / 1000, TicksToUS(t.ticks) / t.calls, TicksToUS(t.max));
+	}
+	if (g_slowest_id != NOBODY)
+	{
+		SLOGI("  Slowest think %.0f us by soldier %d", TicksToUS(g_slowest_ticks), g_slowest_id);
+	}
+}
+
+
+void DebugAIPage(void)
+{
+	MPageHeader(L"DEBUG AI PAGE 1 OF 1");
+	INT32 y = DEBUG_PAGE_START_Y;
+	INT32 h = DEBUG_PAGE_LINE_HEIGHT;
+
+	MHeader(DEBUG_PAGE_FIRST_COLUMN, y += h, L"Timer");
+	mprintf(DEBUG_PAGE_FIRST_COLUMN + DEBUG_PAGE_LABEL_WIDTH, y, L"calls     total ms     avg us     max us");
+	for (UINT i = 0; i != AI_NUM_TIMERS; ++i)
+	{
+		AITimerStats const& t = g_timers[i];
+		MHeader(DEBUG_PAGE_FIRST_COLUMN, y += h, g_timer_names[i]);
+		mprintf(DEBUG_PAGE_FIRST_COLUMN + DEBUG_PAGE_LABEL_WIDTH, y, L"%u     %.1f     %.0f     %.0f",
+			t.calls, TicksToUS(t.ticks) / 1000, t.calls != 0 ? TicksToUS(t.ticks) / t.calls : 0., TicksToUS(t.max));
+	}
+
+	y += h;
+	mprintf(DEBUG_PAGE_FIRST_COLUMN, y += h, L"Last realtime slice %.0f us of %d us", TicksToUS(g_last_slice_ticks), AI_THINK_BUDGET_US);
+	mprintf(DEBUG_PAGE_FIRST_COLUMN, y += h, L"Slices out of budget %u", g_slices_cut);
+	mprintf(DEBUG_PAGE_FIRST_COLUMN, y += h, L"Decisions continued in a later frame %u", g_yields);
+	if (g_slowest_id != NOBODY)
+	{
+		mprintf(DEBUG_PAGE_FIRST_COLUMN, y += h, L"Slowest think %.0f us by soldier %d", TicksToUS(g_slowest_ticks), g_slowest_id);
+	}
+}
@@ -0,0 +1,81 @@
+#ifndef AI_TIMING_H
+#define AI_TIMING_H
+
+#include "JA2Types.h"
+
+#include <stdint.h>
+
+
+/* Parts of the AI decisions which are timed. The time of a part includes the
+ * parts nested in it, e.g. a path search made while deciding in red alert
+ * counts towards both. */
+enum AITimer
+{
+	AI_TIMER_THINK,             // HandleSoldierAI() as a whole
+	AI_TIMER_DECIDE_GREEN,
+	AI_TIMER_DECIDE_YELLOW,
+	AI_TIMER_DECIDE_RED,
+	AI_TIMER_DECIDE_BLACK,
+	AI_TIMER_DECIDE_CREATURE,   // creatures and crows
+	AI_TIMER_FIND_LOCATIONS,    // cover, darker spots, items, ...
+	AI_TIMER_CLOSEST_REACHABLE, // closest reachable disturbance or friend
+	AI_TIMER_BEST_ATTACK,       // CalcBestShot(), CalcBestStab(), CalcBestThrow()
+	AI_TIMER_PATH,              // FindBestPath() on behalf of the AI
+	AI_NUM_TIMERS
+};
+
+uint64_t AITimerStart(AITimer);
+void     AITimerStop(AITimer, uint64_t start);
+
+/* Times the enclosing scope. Only scopes inside an AIThinkScope are recorded,
+ * and only the outermost one if a timer is entered recursively. */
+class AITimeScope
+{
+	public:
+		explicit AITimeScope(AITimer const timer) :
+			timer_(timer),
+			start_(AITimerStart(timer))
+		{}
+
+		~AITimeScope() { AITimerStop(timer_, start_); }
+
+	private:
+		AITimer  const timer_;
+		uint64_t const start_;
+};
+
+#define AI_TIME_SCOPE(timer) AITimeScope const ai_time_scope_(timer)
+
+/* Times HandleSoldierAI() for a soldier and remembers the slowest one. */
+class AIThinkScope
+{
+	public:
+		explicit AIThinkScope(SOLDIERTYPE const&);
+		~AIThinkScope();
+
+	private:
+		SOLDIERTYPE const& s_;
+		uint64_t     const start_;
+};
+
+/* In realtime the soldiers get to think one after the other until the think
+ * time spent since AIBeginThinkSlice() exceeds the budget. The rest think in
+ * later frames, so an expensive decision does not make the frame hitch. While
+ * the clock is fixed for a replay there is no budget. */
+void AIBeginThinkSlice();
+bool AIThinkSliceSpent();
+
+/* Whether the think time of the slice, including the think in progress, is
+ * over the budget. A realtime decision gives up at its next step then. */
+bool AIThinkBudgetSpent();
+void AICountThinkYield();
+
+/* Clears the timers, the slice statistics and the slowest think. */
+void ResetAITimers();
+
+/* Logs the timers, e.g. at the end of a benchmark. */
+void LogAITimers();
+
+void DebugAIPage(void);
+
+#endif
@@ -1,10 +1,12 @@
 #include "AI.h"
+#include "AITiming.h"
 #include "Animation_Control.h"
 #include "Isometric_Utils.h"
 #include "Weapons.h"
 #include "OppList.h"
 #include "Points.h"
 #include "PathAI.h"
+#include "Path_Batch.h"
 #include "WorldMan.h"
 #include "AIInternals.h"
 #include "Items.h"
@@ -771,17 +773,16 @@ INT16 RandDestWithinRange(SOLDIERTYPE *pSoldier)
 	return(sRandDest); // defaults to NOWHERE
 }
 
-INT16 ClosestReachableDisturbance(SOLDIERTYPE *pSoldier, UINT8 ubUnconsciousOK, BOOLEAN * pfChangeLevel )
+static INT16 SearchClosestReachableDisturbance(SOLDIERTYPE* pSoldier, UINT8 ubUnconsciousOK, BOOLEAN* pfChangeLevel)
 {
-	INT16   *psLastLoc, *pusNoiseGridNo;
-	INT8    *pbLastLevel;
+	AI_TIME_SCOPE(AI_TIMER_CLOSEST_REACHABLE);
+	INT16   *pusNoiseGridNo;
 	INT16   sGridNo=-1;
 	INT8    bLevel;
 	BOOLEAN fClimbingNecessary, fClosestClimbingNecessary = FALSE;
 	INT32   iPathCost;
 	INT16   sClosestDisturbance = NOWHERE;
 	INT8    *pbNoiseLevel;
-	INT8    *pbPersOL,*pbPublOL;
 	INT16   sClimbGridNo;
 
 	// CJC: can't trace a path to every known disturbance!
@@ -793,57 +794,32 @@ INT16 ClosestReachableDisturbance(SOLDIERTYPE *pSoldier, UINT8 ubUnconsciousOK,
 	pusNoiseGridNo = &gsPublicNoiseGridno[pSoldier->bTeam];
 	pbNoiseLevel = &gbPublicNoiseLevel[pSoldier->bTeam];
 
-	// hang pointers at start of this guy's personal and public opponent opplists
-	//pbPersOL = &pSoldier->bOppList[0];
-	//pbPublOL = &(gbPublicOpplist[pSoldier->bTeam][0]);
-	//psLastLoc = &(gsLastKnownOppLoc[pSoldier->ubID][0]);
-
 	// look through this man's personal & public opplists for opponents known
 	INT8 bClosestLevel = 0; // XXX HACK000E
-	FOR_EACH_MERC(i)
+	KnownOpponents& known = GetKnownOpponents(pSoldier);
+	for (UINT i = 0; i != known.n; ++i)
 	{
-		const SOLDIERTYPE* const pOpp = *i;
-
-		// if this merc is neutral/on same side, he's not an opponent
-		if ( CONSIDERED_NEUTRAL( pSoldier, pOpp ) || (pSoldier->bSide == pOpp->bSide) )
-		{
-			continue;          // next merc
-		}
-
-		pbPersOL = pSoldier->bOppList + pOpp->ubID;
-		pbPublOL = gbPublicOpplist[pSoldier->bTeam] + pOpp->ubID;
-		psLastLoc = gsLastKnownOppLoc[pSoldier->ubID] + pOpp->ubID;
-		pbLastLevel = gbLastKnownOppLevel[pSoldier->ubID] + pOpp->ubID;
+		KnownOpponent const& k    = known.opp[i];
+		SOLDIERTYPE   const* pOpp = k.pOpponent;
 
 		// if this opponent is unknown personally and publicly
-		if ((*pbPersOL == NOT_HEARD_OR_SEEN) && (*pbPublOL == NOT_HEARD_OR_SEEN))
+		if (!k.fKnown)
 		{
 			continue;          // next merc
 		}
 
 		// this is possible if get here from BLACK AI in one of those rare
 		// instances when we couldn't get a meaningful shot off at a guy in sight
-		if ((*pbPersOL == SEEN_CURRENTLY) && (pOpp->bLife >= OKLIFE))
+		if ((k.bPersOL == SEEN_CURRENTLY) && (pOpp->bLife >= OKLIFE))
 		{
 			// don't allow this to return any valid values, this guy remains a
 			// serious threat and the last thing we want to do is approach him!
 			return(NOWHERE);
 		}
 
-		// if personal knowledge is more up to date or at least equal
-		if ((gubKnowledgeValue[*pbPublOL - OLDEST_HEARD_VALUE][*pbPersOL - OLDEST_HEARD_VALUE] > 0) ||
-			(*pbPersOL == *pbPublOL))
-		{
-			// using personal knowledge, obtain opponent's "best guess" gridno
-			sGridNo = *psLastLoc;
-			bLevel = *pbLastLevel;
-		}
-		else
-		{
-			// using public knowledge, obtain opponent's "best guess" gridno
-			sGridNo = gsPublicLastKnownOppLoc[pSoldier->bTeam][pOpp->ubID];
-			bLevel = gbPublicLastKnownOppLevel[pSoldier->bTeam][pOpp->ubID];
-		}
+		// the opponent's "best guess" gridno from the more recent knowledge
+		sGridNo = k.sKnownLoc;
+		bLevel  = k.bKnownLevel;
 
 		// if we are standing at that gridno (!, obviously our info is old...)
 		if (sGridNo == pSoldier->sGridNo)
@@ -959,11 +935,26 @@ INT16 ClosestReachableDisturbance(SOLDIERTYPE *pSoldier, UINT8 ubUnconsciousOK,
 }
 
 
+INT16 ClosestReachableDisturbance(SOLDIERTYPE* const pSoldier, UINT8 const ubUnconsciousOK, BOOLEAN* const pfChangeLevel)
+{
+	AIThinkStep* const step = ResumeThinkStep(*pSoldier, AI_STEP_DISTURBANCE, ubUnconsciousOK);
+	if (!step) return SearchClosestReachableDisturbance(pSoldier, ubUnconsciousOK, pfChangeLevel);
+	if (!step->done)
+	{
+		BOOLEAN change_level = FALSE;
+		step->sGridNo = SearchClosestReachableDisturbance(pSoldier, ubUnconsciousOK, &change_level);
+		step->iData   = change_level;
+		step->done    = TRUE;
+	}
+	*pfChangeLevel = step->iData;
+	return step->sGridNo;
+}
+
+
 INT16 ClosestKnownOpponent(SOLDIERTYPE *pSoldier, INT16 * psGridNo, INT8 * pbLevel)
 {
 	INT16 sGridNo, sClosestOpponent = NOWHERE;
 	INT32 iRange, iClosestRange = 1500;
-	INT8  *pbPersOL, *pbPublOL;
 	INT8  bLevel, bClosestLevel;
 
 	bClosestLevel = -1;
@@ -971,20 +962,12 @@ INT16 ClosestKnownOpponent(SOLDIERTYPE *pSoldier, INT16 * psGridNo, INT8 * pbLev
 
 	// NOTE: THIS FUNCTION ALLOWS RETURN OF UNCONSCIOUS AND UNREACHABLE OPPONENTS
 
-	// hang pointers at start of this guy's personal and public opponent opplists
-	pbPersOL = &pSoldier->bOppList[0];
-	pbPublOL = &(gbPublicOpplist[pSoldier->bTeam][0]);
-
 	// look through this man's personal & public opplists for opponents known
-	FOR_EACH_MERC(i)
+	KnownOpponents& known = GetKnownOpponents(pSoldier);
+	for (UINT i = 0; i != known.n; ++i)
 	{
-		const SOLDIERTYPE* const pOpp = *i;
-
-		// if this merc is neutral/on same side, he's not an opponent
-		if ( CONSIDERED_NEUTRAL( pSoldier, pOpp ) || (pSoldier->bSide == pOpp->bSide))
-		{
-			continue;          // next merc
-		}
+		KnownOpponent const& k    = known.opp[i];
+		SOLDIERTYPE   const* pOpp = k.pOpponent;
 
 		// Special stuff for Carmen the bounty hunter
 		if (pSoldier->bAttitude == ATTACKSLAYONLY && pOpp->ubProfile != SLAY)
@@ -992,29 +975,15 @@ INT16 ClosestKnownOpponent(SOLDIERTYPE *pSoldier, INT16 * psGridNo, INT8 * pbLev
 			continue;  // next opponent
 		}
 
-		pbPersOL = pSoldier->bOppList + pOpp->ubID;
-		pbPublOL = gbPublicOpplist[pSoldier->bTeam] + pOpp->ubID;
-
 		// if this opponent is unknown personally and publicly
-		if ((*pbPersOL == NOT_HEARD_OR_SEEN) && (*pbPublOL == NOT_HEARD_OR_SEEN))
+		if (!k.fKnown)
 		{
 			continue;          // next merc
 		}
 
-		// if personal knowledge is more up to date or at least equal
-		if ((gubKnowledgeValue[*pbPublOL - OLDEST_HEARD_VALUE][*pbPersOL - OLDEST_HEARD_VALUE] > 0) ||
-			(*pbPersOL == *pbPublOL))
-		{
-			// using personal knowledge, obtain opponent's "best guess" gridno
-			sGridNo = gsLastKnownOppLoc[pSoldier->ubID][pOpp->ubID];
-			bLevel = gbLastKnownOppLevel[pSoldier->ubID][pOpp->ubID];
-		}
-		else
-		{
-			// using public knowledge, obtain opponent's "best guess" gridno
-			sGridNo = gsPublicLastKnownOppLoc[pSoldier->bTeam][pOpp->ubID];
-			bLevel = gbPublicLastKnownOppLevel[pSoldier->bTeam][pOpp->ubID];
-		}
+		// the opponent's "best guess" gridno from the more recent knowledge
+		sGridNo = k.sKnownLoc;
+		bLevel  = k.bKnownLevel;
 
 		// if we are standing at that gridno(!, obviously our info is old...)
 		if (sGridNo == pSoldier->sGridNo)
@@ -1276,7 +1245,9 @@ INT16 EstimatePathCostToLocation( SOLDIERTYPE * pSoldier, INT16 sDestGridNo, INT
 		if ( (pSoldier->bLevel == 0) || ( gubBuildingInfo[ pSoldier->sGridNo ] == gubBuildingInfo[ sDestGridNo ] ) )
 		{
 			// on ground or same building... normal!
-			sPathCost = EstimatePlotPath(pSoldier, sDestGridNo, FALSE, FALSE, WALKING, 0);
+			// use the estimate made at the start of the turn if it is still good
+			sPathCost = GetBatchedPathCost(pSoldier, sDestGridNo);
+			if (sPathCost == -1) sPathCost = EstimatePlotPath(pSoldier, sDestGridNo, FALSE, FALSE, WALKING, 0);
 			*pfClimbingNecessary = FALSE;
 			*psClimbGridNo = NOWHERE;
 		}
@@ -1391,8 +1362,9 @@ static BOOLEAN GuySawEnemyThisTurnOrBefore(SOLDIERTYPE* pSoldier)
 	return( FALSE );
 }
 
-INT16 ClosestReachableFriendInTrouble(SOLDIERTYPE *pSoldier, BOOLEAN * pfClimbingNecessary)
+static INT16 SearchClosestReachableFriendInTrouble(SOLDIERTYPE* pSoldier, BOOLEAN* pfClimbingNecessary)
 {
+	AI_TIME_SCOPE(AI_TIMER_CLOSEST_REACHABLE);
 	INT16 sPathCost, sClosestFriend = NOWHERE, sShortestPath = 1000, sClimbGridNo;
 	BOOLEAN fClimbingNecessary, fClosestClimbingNecessary = FALSE;
 
@@ -1454,6 +1426,22 @@ INT16 ClosestReachableFriendInTrouble(SOLDIERTYPE *pSoldier, BOOLEAN * pfClimbin
 	return(sClosestFriend);
 }
 
+
+INT16 ClosestReachableFriendInTrouble(SOLDIERTYPE* const pSoldier, BOOLEAN* const pfClimbingNecessary)
+{
+	AIThinkStep* const step = ResumeThinkStep(*pSoldier, AI_STEP_FRIEND, 0);
+	if (!step) return SearchClosestReachableFriendInTrouble(pSoldier, pfClimbingNecessary);
+	if (!step->done)
+	{
+		BOOLEAN climb = FALSE;
+		step->sGridNo = SearchClosestReachableFriendInTrouble(pSoldier, &climb);
+		step->iData   = climb;
+		step->done    = TRUE;
+	}
+	*pfClimbingNecessary = step->iData;
+	return step->sGridNo;
+}
+
 INT16 DistanceToClosestFriend( SOLDIERTYPE * pSoldier )
 {
 	// find the distance to the closest person on the same team
@@ -1588,7 +1576,6 @@ INT8 CalcMorale(SOLDIERTYPE *pSoldier)
 	INT32 iPercent;
 	INT8  bMostRecentOpplistValue;
 	INT8  bMoraleCategory;
-	INT8  *pbPersOL, *pbPublOL;
 
 	// if army guy has NO weapons left then panic!
 	if ( pSoldier->bTeam == ENEMY_TEAM )
@@ -1599,54 +1586,30 @@ INT8 CalcMorale(SOLDIERTYPE *pSoldier)
 		}
 	}
 
-	// hang pointers to my personal opplist, my team's public opplist, and my
-	// list of previously seen opponents
-	const INT8* pSeenOpp = &gbSeenOpponents[pSoldier->ubID][0];
-
-	// loop through every one of my possible opponents
-	FOR_EACH_MERC(i)
+	// loop through every one of my possible opponents, including the ones
+	// unknown to me and my team, but seen before anywhere in this sector
+	KnownOpponents& known = GetKnownOpponents(pSoldier);
+	for (UINT i = 0; i != known.n; ++i)
 	{
-		SOLDIERTYPE* const pOpponent = *i;
+		KnownOpponent const& k         = known.opp[i];
+		SOLDIERTYPE*   const pOpponent = k.pOpponent;
 
 		// if this merc is inactive, at base, on assignment, dead, unconscious
 		if (pOpponent->bLife < OKLIFE) continue; // next merc
 
-		// if this merc is neutral/on same side, he's not an opponent, skip him!
-		if ( CONSIDERED_NEUTRAL( pSoldier, pOpponent ) || (pSoldier->bSide == pOpponent->bSide))
-			continue;          // next merc
-
 		// Special stuff for Carmen the bounty hunter
 		if (pSoldier->bAttitude == ATTACKSLAYONLY && pOpponent->ubProfile != SLAY)
 		{
 			continue;  // next opponent
 		}
 
-		pbPersOL = pSoldier->bOppList + pOpponent->ubID;
-		pbPublOL = gbPublicOpplist[pSoldier->bTeam] + pOpponent->ubID;
-		pSeenOpp = gbSeenOpponents[pSoldier->ubID] + pOpponent->ubID;
-
-		// if this opponent is unknown to me personally AND unknown to my team, too
-		if ((*pbPersOL == NOT_HEARD_OR_SEEN) && (*pbPublOL == NOT_HEARD_OR_SEEN))
-		{
-			// if I have never seen him before anywhere in this sector, either
-			if (!(*pSeenOpp))
-				continue;        // next merc
-
-			// have seen him in the past, so he remains something of a threat
-			bMostRecentOpplistValue = 0;        // uses the free slot for 0 opplist
-		}
-		else         // decide which opplist is more current
-		{
-			// if personal knowledge is more up to date or at least equal
-			if ((gubKnowledgeValue[*pbPublOL - OLDEST_HEARD_VALUE][*pbPersOL - OLDEST_HEARD_VALUE] > 0) || (*pbPersOL == *pbPublOL))
-				bMostRecentOpplistValue = *pbPersOL;      // use personal
-			else
-				bMostRecentOpplistValue = *pbPublOL;      // use public
-		}
+		// the more current opplist, or the free slot for 0 opplist if he has
+		// only been seen in the past, so he remains something of a threat
+		bMostRecentOpplistValue = k.bOppList;
 
 		iPercent = ThreatPercent[bMostRecentOpplistValue - OLDEST_HEARD_VALUE];
 
-		sOppThreatValue = (iPercent * CalcManThreatValue(pOpponent,pSoldier->sGridNo,FALSE,pSoldier)) / 100;
+		sOppThreatValue = (iPercent * k.iThreatValue) / 100;
 
 		// ADD this to their running total threatValue (decreases my MORALE)
 		iTheirTotalThreat += sOppThreatValue;
@@ -1920,6 +1883,106 @@ INT32 CalcManThreatValue( SOLDIERTYPE *pEnemy, INT16 sMyGrid, UINT8 ubReduceForC
 	return(iThreatValue);
 }
 
+static KnownOpponents g_known;
+static SoldierID      g_known_id = NOBODY;
+static INT16          g_known_gridno;
+static UINT32         g_known_version;
+static UINT32         g_known_decision;
+static UINT32         g_decision;       // counts the decisions begun and ended
+static UINT           g_decision_depth;
+
+
+AIDecisionScope::AIDecisionScope()
+{
+	++g_decision_depth;
+	++g_decision;
+}
+
+
+AIDecisionScope::~AIDecisionScope()
+{
+	--g_decision_depth;
+	++g_decision;
+}
+
+
+static void BuildKnownOpponents(SOLDIERTYPE* const pSoldier)
+{
+	KnownOpponents& k = g_known;
+	k.n = 0;
+	FOR_EACH_MERC(i)
+	{
+		SOLDIERTYPE* const pOpponent = *i;
+
+		// if this man is neutral / on the same side, he's not an opponent
+		if (CONSIDERED_NEUTRAL(pSoldier, pOpponent) || pSoldier->bSide == pOpponent->bSide)
+		{
+			continue;
+		}
+
+		INT8 const bPersOL = pSoldier->bOppList[pOpponent->ubID];
+		INT8 const bPublOL = gbPublicOpplist[pSoldier->bTeam][pOpponent->ubID];
+		if (bPersOL == NOT_HEARD_OR_SEEN && bPublOL == NOT_HEARD_OR_SEEN &&
+			!gbSeenOpponents[pSoldier->ubID][pOpponent->ubID])
+		{
+			continue;
+		}
+
+		KnownOpponent& o = k.opp[k.n++];
+		o.pOpponent = pOpponent;
+		o.fKnown    = bPersOL != NOT_HEARD_OR_SEEN || bPublOL != NOT_HEARD_OR_SEEN;
+		o.bPersOL   = bPersOL;
+		// if personal knowledge is more up to date or at least equal
+		o.fPersonal =
+			gubKnowledgeValue[bPublOL - OLDEST_HEARD_VALUE][bPersOL - OLDEST_HEARD_VALUE] > 0 ||
+			bPersOL == bPublOL;
+		if (o.fPersonal)
+		{
+			o.bOppList    = bPersOL;
+			o.sKnownLoc   = gsLastKnownOppLoc[pSoldier->ubID][pOpponent->ubID];
+			o.bKnownLevel = gbLastKnownOppLevel[pSoldier->ubID][pOpponent->ubID];
+		}
+		else
+		{
+			o.bOppList    = bPublOL;
+			o.sKnownLoc   = gsPublicLastKnownOppLoc[pSoldier->bTeam][pOpponent->ubID];
+			o.bKnownLevel = gbPublicLastKnownOppLevel[pSoldier->bTeam][pOpponent->ubID];
+		}
+		o.iCertainty        = ThreatPercent[o.bOppList - OLDEST_HEARD_VALUE];
+		o.iThreatValue      = CalcManThreatValue(pOpponent, pSoldier->sGridNo, FALSE, pSoldier);
+		o.iCoverThreatValue = -1;
+	}
+}
+
+
+KnownOpponents& GetKnownOpponents(SOLDIERTYPE* const pSoldier)
+{
+	if (g_decision_depth == 0 ||
+		g_known_id       != pSoldier->ubID    ||
+		g_known_gridno   != pSoldier->sGridNo ||
+		g_known_version  != guiOppListVersion ||
+		g_known_decision != g_decision)
+	{
+		BuildKnownOpponents(pSoldier);
+		g_known_id       = pSoldier->ubID;
+		g_known_gridno   = pSoldier->sGridNo;
+		g_known_version  = guiOppListVersion;
+		g_known_decision = g_decision;
+	}
+	return g_known;
+}
+
+
+INT32 KnownOpponentCoverThreatValue(SOLDIERTYPE* const pSoldier, KnownOpponent& o)
+{
+	if (o.iCoverThreatValue == -1)
+	{
+		o.iCoverThreatValue = CalcManThreatValue(o.pOpponent, pSoldier->sGridNo, TRUE, pSoldier);
+	}
+	return o.iCoverThreatValue;
+}
+
+
 INT16 RoamingRange(SOLDIERTYPE *pSoldier, INT16 * pusFromGridNo)
 {
 	if ( CREATURE_OR_BLOODCAT( pSoldier ) )
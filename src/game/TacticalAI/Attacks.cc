@@ -1,4 +1,6 @@
 #include "AI.h"
+#include "AIPlan.h"
+#include "AITiming.h"
 #include "Animation_Control.h"
 #include "OppList.h"
 #include "AIInternals.h"
@@ -11,6 +13,7 @@
 #include "Spread_Burst.h"
 #include "Overhead.h"
 #include "SkillCheck.h"
+#include "Soldier_Grid.h"
 #include "Soldier_Profile.h"
 #include "Isometric_Utils.h"
 #include "Soldier_Macros.h"
@@ -105,6 +108,7 @@ static INT32 EstimateShotDamage(SOLDIERTYPE* pSoldier, SOLDIERTYPE* pOpponent, U
 
 void CalcBestShot(SOLDIERTYPE *pSoldier, ATTACKTYPE *pBestShot)
 {
+	AI_TIME_SCOPE(AI_TIMER_BEST_ATTACK);
 	INT32 iAttackValue;
 	INT32 iThreatValue;
 	INT32 iHitRate,iBestHitRate,iPercentBetter;
@@ -124,19 +128,17 @@ void CalcBestShot(SOLDIERTYPE *pSoldier, ATTACKTYPE *pBestShot)
 	//pbPersOL = &(pSoldier->bOppList[0]);
 
 	// determine which attack against which target has the greatest attack value
-	FOR_EACH_MERC(i)
+	KnownOpponents& known = GetKnownOpponents(pSoldier);
+	for (UINT i = 0; i != known.n; ++i)
 	{
-		SOLDIERTYPE* const pOpponent = *i;
+		KnownOpponent&     k         = known.opp[i];
+		SOLDIERTYPE* const pOpponent = k.pOpponent;
 
 		// if this merc is inactive, at base, on assignment, or dead
 		if (!pOpponent->bLife) continue; // next merc
 
-		// if this man is neutral / on the same side, he's not an opponent
-		if ( CONSIDERED_NEUTRAL( pSoldier, pOpponent ) || (pSoldier->bSide == pOpponent->bSide))
-			continue;          // next merc
-
 		// if this opponent is not currently in sight (ignore known but unseen!)
-		if (pSoldier->bOppList[pOpponent->ubID] != SEEN_CURRENTLY)
+		if (k.bPersOL != SEEN_CURRENTLY)
 			continue;  // next opponent
 
 		// Special stuff for Carmen the bounty hunter
@@ -152,7 +154,7 @@ void CalcBestShot(SOLDIERTYPE *pSoldier, ATTACKTYPE *pBestShot)
 
 		// calculate chance to get through the opponent's cover (if any)
 
-		ubChanceToGetThrough = AISoldierToSoldierChanceToGetThrough( pSoldier, pOpponent );
+		ubChanceToGetThrough = PlannedAISoldierToSoldierChanceToGetThrough(pSoldier, pOpponent);
 
 		//   ubChanceToGetThrough = ChanceToGetThrough(pSoldier,pOpponent->sGridNo,NOTFAKE,ACTUAL,TESTWALLS,9999,M9PISTOL,NOT_FOR_LOS);
 
@@ -263,7 +265,7 @@ void CalcBestShot(SOLDIERTYPE *pSoldier, ATTACKTYPE *pBestShot)
 			continue; // don't bother... next opponent
 
 		// calculate this opponent's threat value (factor in my cover from him)
-		iThreatValue = CalcManThreatValue(pOpponent,pSoldier->sGridNo,TRUE,pSoldier);
+		iThreatValue = KnownOpponentCoverThreatValue(pSoldier, k);
 
 		// estimate the damage this shot would do to this opponent
 		iEstDamage = EstimateShotDamage(pSoldier,pOpponent,ubBestChanceToHit);
@@ -383,6 +385,7 @@ static INT32 EstimateThrowDamage(SOLDIERTYPE* pSoldier, UINT8 ubItemPos, SOLDIER
 
 static void CalcBestThrow(SOLDIERTYPE* pSoldier, ATTACKTYPE* pBestThrow)
 {
+	AI_TIME_SCOPE(AI_TIMER_BEST_ATTACK);
 	// September 9, 1998: added code for LAWs (CJC)
 	UINT8 ubLoop2;
 	INT32 iAttackValue;
@@ -1005,6 +1008,7 @@ static INT32 EstimateStabDamage(SOLDIERTYPE* pSoldier, SOLDIERTYPE* pOpponent, U
 
 void CalcBestStab(SOLDIERTYPE *pSoldier, ATTACKTYPE *pBestStab, BOOLEAN fBladeAttack )
 {
+	AI_TIME_SCOPE(AI_TIMER_BEST_ATTACK);
 	INT32 iAttackValue;
 	INT32 iThreatValue,iHitRate,iBestHitRate,iPercentBetter, iEstDamage;
 	BOOLEAN fSurpriseStab;
@@ -1318,13 +1322,14 @@ void CalcTentacleAttack(SOLDIERTYPE *pSoldier, ATTACKTYPE *pBestStab )
 
 static UINT8 NumMercsCloseTo(INT16 sGridNo, UINT8 ubMaxDist)
 {
+	SOLDIERTYPE* nearby[TOTAL_SOLDIERS];
+	UINT const n = FindSoldiersNear(sGridNo, ubMaxDist, nearby);
+
 	INT8 bNumber = 0;
-	FOR_EACH_MERC(i)
+	for (UINT i = 0; i != n; ++i)
 	{
-		const SOLDIERTYPE* const s = *i;
-		if (s->bTeam == OUR_TEAM &&
-			s->bLife >= OKLIFE      &&
-			PythSpacesAway(sGridNo, s->sGridNo) <= ubMaxDist)
+		const SOLDIERTYPE* const s = nearby[i];
+		if (s->bTeam == OUR_TEAM && s->bLife >= OKLIFE)
 		{
 			++bNumber;
 		}
@@ -5,6 +5,7 @@
 #include "Soldier_Control.h"
 #include "AI.h"
 #include "AIInternals.h"
+#include "AITiming.h"
 #include "OppList.h"
 #include "Items.h"
 #include "Rotting_Corpses.h"
@@ -1312,6 +1313,8 @@ static INT8 CreatureDecideActionBlack(SOLDIERTYPE* pSoldier)
 
 INT8 CreatureDecideAction( SOLDIERTYPE *pSoldier )
 {
+	AI_TIME_SCOPE(AI_TIMER_DECIDE_CREATURE);
+	AIDecisionScope const decision;
 	INT8 bAction = AI_ACTION_NONE;
 
 	switch (pSoldier->bAlertStatus)
@@ -1554,6 +1557,7 @@ static INT8 CrowDecideActionGreen(SOLDIERTYPE* pSoldier)
 
 INT8 CrowDecideAction( SOLDIERTYPE * pSoldier )
 {
+	AI_TIME_SCOPE(AI_TIMER_DECIDE_CREATURE);
 	if ( pSoldier->usAnimState == CROW_FLY )
 	{
 		return( AI_ACTION_NONE );
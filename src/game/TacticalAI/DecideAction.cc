@@ -1,5 +1,6 @@
 #include "AI.h"
 #include "AIInternals.h"
+#include "AITiming.h"
 #include "Animation_Control.h"
 #include "Font_Control.h"
 #include "Isometric_Utils.h"
@@ -36,15 +37,6 @@
 
 extern BOOLEAN gfUseAlternateQueenPosition;
 
-// global status time counters to determine what takes the most time
-
-#ifdef AI_TIMING_TESTS
-static UINT32 guiGreenTimeTotal = 0, guiYellowTimeTotal = 0, guiRedTimeTotal = 0, guiBlackTimeTotal = 0;
-static UINT32 guiGreenCounter = 0, guiYellowCounter = 0, guiRedCounter = 0, guiBlackCounter = 0;
-static UINT32 guiRedSeekTimeTotal = 0, guiRedHelpTimeTotal = 0, guiRedHideTimeTotal = 0;
-static UINT32 guiRedSeekCounter = 0, guiRedHelpCounter = 0; guiRedHideCounter = 0;
-#endif
-
 #define CENTER_OF_RING 11237
 
 
@@ -641,6 +633,7 @@ static INT8 DecideActionNamedNPC(SOLDIERTYPE* pSoldier)
 
 static INT8 DecideActionGreen(SOLDIERTYPE* pSoldier)
 {
+	AI_TIME_SCOPE(AI_TIMER_DECIDE_GREEN);
 	INT32 iChance, iSneaky = 10;
 	INT8  bInWater,bInGas;
 
@@ -1075,6 +1068,7 @@ static INT8 DecideActionGreen(SOLDIERTYPE* pSoldier)
 
 static INT8 DecideActionYellow(SOLDIERTYPE* pSoldier)
 {
+	AI_TIME_SCOPE(AI_TIMER_DECIDE_YELLOW);
 	INT32 iDummy;
 	INT16 sNoiseGridNo;
 	INT32 iNoiseValue;
@@ -1451,6 +1445,7 @@ static INT8 DecideActionYellow(SOLDIERTYPE* pSoldier)
 
 INT8 DecideActionRed(SOLDIERTYPE *pSoldier, UINT8 ubUnconsciousOK)
 {
+	AI_TIME_SCOPE(AI_TIMER_DECIDE_RED);
 	INT8 bActionReturned;
 	INT32 iDummy;
 	INT16 iChance,sClosestOpponent,sClosestFriend;
@@ -1459,9 +1454,6 @@ INT8 DecideActionRed(SOLDIERTYPE *pSoldier, UINT8 ubUnconsciousOK)
 	INT8 bSeekPts = 0, bHelpPts = 0, bHidePts = 0, bWatchPts = 0;
 	INT8	bHighestWatchLoc;
 	ATTACKTYPE BestThrow;
-#ifdef AI_TIMING_TEST
-	UINT32	uiStartTime, uiEndTime;
-#endif
 	BOOLEAN fClimb;
 	const BOOLEAN fCivilian =
 		IsOnCivTeam(pSoldier) &&
@@ -1959,18 +1951,9 @@ INT8 DecideActionRed(SOLDIERTYPE *pSoldier, UINT8 ubUnconsciousOK)
 				// if SEEKING is possible and at least as desirable as helping or hiding
 				if ( (bSeekPts > -90) && (bSeekPts >= bHelpPts) && (bSeekPts >= bHidePts) && (bSeekPts >= bWatchPts ) )
 				{
-					#ifdef AI_TIMING_TESTS
-					uiStartTime = GetJA2Clock();
-					#endif
-
 					// get the location of the closest reachable opponent
 					sClosestDisturbance = ClosestReachableDisturbance(pSoldier,ubUnconsciousOK, &fClimb);
 
-					#ifdef AI_TIMING_TESTS
-					uiEndTime = GetJA2Clock();
-					guiRedSeekTimeTotal += (uiEndTime - uiStartTime);
-					guiRedSeekCounter++;
-					#endif
 					// if there is an opponent reachable
 					if (sClosestDisturbance != NOWHERE)
 					{
@@ -2089,16 +2072,7 @@ INT8 DecideActionRed(SOLDIERTYPE *pSoldier, UINT8 ubUnconsciousOK)
 				// if HELPING is possible and at least as desirable as seeking or hiding
 				if ((bHelpPts > -90) && (bHelpPts >= bSeekPts) && (bHelpPts >= bHidePts) && (bHelpPts >= bWatchPts ))
 				{
-					#ifdef AI_TIMING_TESTS
-					uiStartTime = GetJA2Clock();
-					#endif
 					sClosestFriend = ClosestReachableFriendInTrouble(pSoldier, &fClimb );
-					#ifdef AI_TIMING_TESTS
-					uiEndTime = GetJA2Clock();
-
-					guiRedHelpTimeTotal += (uiEndTime - uiStartTime);
-					guiRedHelpCounter++;
-					#endif
 
 					if (sClosestFriend != NOWHERE)
 					{
@@ -2132,17 +2106,8 @@ INT8 DecideActionRed(SOLDIERTYPE *pSoldier, UINT8 ubUnconsciousOK)
 						//////////////////////////////////////////////////////////////////////
 						// TAKE BEST NEARBY COVER FROM ALL KNOWN OPPONENTS
 						//////////////////////////////////////////////////////////////////////
-						#ifdef AI_TIMING_TESTS
-						uiStartTime = GetJA2Clock();
-						#endif
 
 						pSoldier->usActionData = FindBestNearbyCover(pSoldier,pSoldier->bAIMorale,&iDummy);
-						#ifdef AI_TIMING_TESTS
-						uiEndTime = GetJA2Clock();
-
-						guiRedHideTimeTotal += (uiEndTime - uiStartTime);
-						guiRedHideCounter++;
-						#endif
 
 						// let's be a bit cautious about going right up to a location without enough APs to shoot
 						if ( pSoldier->usActionData != NOWHERE )
@@ -2434,6 +2399,7 @@ INT8 DecideActionRed(SOLDIERTYPE *pSoldier, UINT8 ubUnconsciousOK)
 
 static INT8 DecideActionBlack(SOLDIERTYPE* pSoldier)
 {
+	AI_TIME_SCOPE(AI_TIMER_DECIDE_BLACK);
 	INT32	iCoverPercentBetter, iOffense, iDefense, iChance;
 	INT16	sClosestOpponent,sBestCover = NOWHERE;
 	INT16	sClosestDisturbance;
@@ -3613,12 +3579,9 @@ static INT8 DecideActionBlack(SOLDIERTYPE* pSoldier)
 
 INT8 DecideAction(SOLDIERTYPE *pSoldier)
 {
+	AIDecisionScope const decision;
 	INT8 bAction = AI_ACTION_NONE;
 
-#ifdef AI_TIMING_TESTS
-	UINT32 uiStartTime, uiEndTime;
-#endif
-
 	// turn off cautious flag
 	pSoldier->fAIFlags &= (~AI_CAUTIOUS);
 
@@ -3637,51 +3600,19 @@ INT8 DecideAction(SOLDIERTYPE *pSoldier)
 		switch (pSoldier->bAlertStatus)
 		{
 			case STATUS_GREEN:
-#ifdef AI_TIMING_TESTS
-				uiStartTime = GetJA2Clock();
-#endif
 				bAction = DecideActionGreen(pSoldier);
-#ifdef AI_TIMING_TESTS
-				uiEndTime = GetJA2Clock();
-				guiGreenTimeTotal += (uiEndTime - uiStartTime);
-				guiGreenCounter++;
-#endif
 				break;
 
 			case STATUS_YELLOW:
-#ifdef AI_TIMING_TESTS
-				uiStartTime = GetJA2Clock();
-#endif
 				bAction = DecideActionYellow(pSoldier);
-#ifdef AI_TIMING_TESTS
-				uiEndTime = GetJA2Clock();
-				guiYellowTimeTotal += (uiEndTime - uiStartTime);
-				guiYellowCounter++;
-#endif
 				break;
 
 			case STATUS_RED:
-#ifdef AI_TIMING_TESTS
-				uiStartTime = GetJA2Clock();
-#endif
 				bAction = DecideActionRed(pSoldier,TRUE);
-#ifdef AI_TIMING_TESTS
-				uiEndTime = GetJA2Clock();
-				guiRedTimeTotal += (uiEndTime - uiStartTime);
-				guiRedCounter++;
-#endif
 				break;
 
 			case STATUS_BLACK:
-#ifdef AI_TIMING_TESTS
-				uiStartTime = GetJA2Clock();
-#endif
 				bAction = DecideActionBlack(pSoldier);
-#ifdef AI_TIMING_TESTS
-				uiEndTime = GetJA2Clock();
-				guiBlackTimeTotal += (uiEndTime - uiStartTime);
-				guiBlackCounter++;
-#endif
 				break;
 		}
 	}
@@ -1,10 +1,12 @@
 #include "Animation_Control.h"
 #include "Animation_Data.h"
+#include "Cover_Map.h"
 #include "FindLocations.h"
 #include "Handle_Items.h"
 #include "Isometric_Utils.h"
 #include "AI.h"
 #include "AIInternals.h"
+#include "AITiming.h"
 #include "LOS.h"
 #include "Soldier_Profile.h"
 #include "Structure.h"
@@ -35,6 +37,7 @@
 #include "WeaponModels.h"
 
 #include <algorithm>
+#include <vector>
 
 #ifdef _DEBUG
 	INT16 gsCoverValue[WORLD_MAX];
@@ -45,7 +48,122 @@
 	#endif
 #endif
 
-INT8 gubAIPathCosts[19][19];
+UINT8 gubAIPathCosts[AI_PATHCOST_SIZE][AI_PATHCOST_SIZE];
+
+
+struct APDistanceField
+{
+	bool   fValid;
+	// what the field was made for
+	UINT8  ubID;
+	INT16  sGridNo;
+	INT8   bLevel;
+	UINT8  bDirection;
+	UINT16 usAnimState;
+	UINT32 uiStatusFlags;
+	INT8   bHasKeys;
+	UINT16 usMovementMode;
+	INT32  iRange;
+	UINT8  ubAPBudget;
+	UINT32 uiMovementCostsVersion;
+	UINT32 uiStructuresVersion;
+	UINT32 uiPathCacheGeneration;
+
+	UINT8  ubAPCost[AI_PATHCOST_SIZE][AI_PATHCOST_SIZE];
+};
+
+static APDistanceField gAPField;
+
+
+void MakeAPDistanceField(SOLDIERTYPE* const s, UINT16 const usMovementMode, INT32 iRange, UINT8 ubAPBudget)
+{
+	if (iRange > AI_PATHCOST_RADIUS) iRange = AI_PATHCOST_RADIUS;
+	// the path costs are only found with a budget
+	if (ubAPBudget == 0) ubAPBudget = AP_FIELD_UNREACHABLE;
+
+	APDistanceField& f = gAPField;
+	if (f.fValid                                              &&
+		f.ubID                   == s->ubID                   &&
+		f.sGridNo                == s->sGridNo                &&
+		f.bLevel                 == s->bLevel                 &&
+		f.bDirection             == s->bDirection             &&
+		f.usAnimState            == s->usAnimState            &&
+		f.uiStatusFlags          == s->uiStatusFlags          &&
+		f.bHasKeys               == s->bHasKeys               &&
+		f.usMovementMode         == usMovementMode            &&
+		f.iRange                 == iRange                    &&
+		f.ubAPBudget             == ubAPBudget                &&
+		f.uiMovementCostsVersion == guiMovementCostsVersion   &&
+		f.uiStructuresVersion    == guiStructuresVersion      &&
+		f.uiPathCacheGeneration  == guiPathCacheGeneration)
+	{
+		return;
+	}
+
+	f.fValid                 = true;
+	f.ubID                   = s->ubID;
+	f.sGridNo                = s->sGridNo;
+	f.bLevel                 = s->bLevel;
+	f.bDirection             = s->bDirection;
+	f.usAnimState            = s->usAnimState;
+	f.uiStatusFlags          = s->uiStatusFlags;
+	f.bHasKeys               = s->bHasKeys;
+	f.usMovementMode         = usMovementMode;
+	f.iRange                 = iRange;
+	f.ubAPBudget             = ubAPBudget;
+	f.uiMovementCostsVersion = guiMovementCostsVersion;
+	f.uiStructuresVersion    = guiStructuresVersion;
+	f.uiPathCacheGeneration  = guiPathCacheGeneration;
+
+	INT16 const sMaxLeft  = MIN(iRange, s->sGridNo % MAXCOL);
+	INT16 const sMaxRight = MIN(iRange, MAXCOL - (s->sGridNo % MAXCOL + 1));
+	INT16 const sMaxUp    = MIN(iRange, s->sGridNo / MAXCOL);
+	INT16 const sMaxDown  = MIN(iRange, MAXROW - (s->sGridNo / MAXCOL + 1));
+
+	// reset the "reachable" flags in the region we're looking at
+	for (INT16 sYOffset = -sMaxUp; sYOffset <= sMaxDown; ++sYOffset)
+	{
+		for (INT16 sXOffset = -sMaxLeft; sXOffset <= sMaxRight; ++sXOffset)
+		{
+			gpWorldLevelData[s->sGridNo + sXOffset + MAXCOL * sYOffset].uiFlags &= ~MAPELEMENT_REACHABLE;
+		}
+	}
+
+	gubNPCDistLimit = (UINT8)iRange;
+	gubNPCAPBudget  = ubAPBudget;
+	FindBestPath(s, NOWHERE, s->bLevel, usMovementMode, COPYREACHABLE_AND_APS, 0);
+
+	std::fill_n(&f.ubAPCost[0][0], AI_PATHCOST_SIZE * AI_PATHCOST_SIZE, AP_FIELD_UNREACHABLE);
+	for (INT16 sYOffset = -sMaxUp; sYOffset <= sMaxDown; ++sYOffset)
+	{
+		for (INT16 sXOffset = -sMaxLeft; sXOffset <= sMaxRight; ++sXOffset)
+		{
+			GridNo const sGridNo = s->sGridNo + sXOffset + MAXCOL * sYOffset;
+			if (!(gpWorldLevelData[sGridNo].uiFlags & MAPELEMENT_REACHABLE)) continue;
+
+			UINT8& ubCost = f.ubAPCost[AI_PATHCOST_RADIUS + sXOffset][AI_PATHCOST_RADIUS + sYOffset];
+			ubCost = sGridNo == s->sGridNo ? 0 : gubAIPathCosts[AI_PATHCOST_RADIUS + sXOffset][AI_PATHCOST_RADIUS + sYOffset];
+		}
+	}
+}
+
+
+UINT8 APDistanceTo(GridNo const sGridNo)
+{
+	APDistanceField const& f = gAPField;
+	if (!f.fValid || sGridNo < 0 || WORLD_MAX <= sGridNo) return AP_FIELD_UNREACHABLE;
+
+	INT32 const iXOffset = sGridNo % MAXCOL - f.sGridNo % MAXCOL;
+	INT32 const iYOffset = sGridNo / MAXCOL - f.sGridNo / MAXCOL;
+	if (ABS(iXOffset) > f.iRange || ABS(iYOffset) > f.iRange) return AP_FIELD_UNREACHABLE;
+	return f.ubAPCost[AI_PATHCOST_RADIUS + iXOffset][AI_PATHCOST_RADIUS + iYOffset];
+}
+
+
+void InvalidateAPDistanceField(void)
+{
+	gAPField.fValid = false;
+}
 
 
 static INT32 CalcPercentBetter(INT32 iOldValue, INT32 iNewValue, INT32 iOldScale, INT32 iNewScale)
@@ -88,11 +206,11 @@ static void AICenterXY(INT16 sGridNo, FLOAT* pdX, FLOAT* pdY)
 }
 
 
-static INT8 CalcWorstCTGTForPosition(SOLDIERTYPE* const pSoldier, const SOLDIERTYPE* const opponent, const INT16 sOppGridNo, const INT8 bLevel, const INT32 iMyAPsLeft)
+static void PrepareCTGTForPosition(std::vector<CTGTQuery>& queries, SOLDIERTYPE* const pSoldier, const SOLDIERTYPE* const opponent, const INT16 sOppGridNo, const INT8 bLevel, const INT32 iMyAPsLeft)
 {
 	// When considering a gridno for cover, we want to take into account cover if we
-	// lie down, so we return the LOWEST chance to get through for that location.
-	INT8 bCubeLevel, bThisCTGT,bWorstCTGT = 100;
+	// lie down, so we look at every stance we can take there.
+	INT8 bCubeLevel;
 
 	for (bCubeLevel = 1; bCubeLevel <= 3; bCubeLevel++)
 	{
@@ -114,56 +232,41 @@ static INT8 CalcWorstCTGTForPosition(SOLDIERTYPE* const pSoldier, const SOLDIERT
 				break;
 		}
 
-		bThisCTGT = SoldierToLocationChanceToGetThrough(pSoldier, sOppGridNo, bLevel, bCubeLevel, opponent);
-		if (bThisCTGT < bWorstCTGT)
-		{
-			bWorstCTGT = bThisCTGT;
-			// if there is perfect cover
-			if (bWorstCTGT == 0)
-				// then bail from the for loop, it can't possible get any better
-				break;
-		}
+		CTGTQuery q;
+		PrepareSoldierToLocationChanceToGetThrough(q, pSoldier, sOppGridNo, bLevel, bCubeLevel, opponent);
+		queries.push_back(q);
 	}
-	return( bWorstCTGT );
 }
 
 
-static INT8 CalcAverageCTGTForPosition(SOLDIERTYPE* const pSoldier, const SOLDIERTYPE* const opponent, const INT16 sOppGridNo, const INT8 bLevel, const INT32 iMyAPsLeft)
+static INT8 CalcWorstCTGTForPosition(const CTGTQuery* const begin, const CTGTQuery* const end)
 {
 	// When considering a gridno for cover, we want to take into account cover if we
 	// lie down, so we return the LOWEST chance to get through for that location.
-	INT8  bCubeLevel;
-	INT32 iTotalCTGT       = 0;
-	INT32 bValidCubeLevels = 0;
+	INT8 bWorstCTGT = 100;
+	for (const CTGTQuery* i = begin; i != end; ++i)
+	{
+		bWorstCTGT = std::min(bWorstCTGT, (INT8)i->ubChance);
+	}
+	return( bWorstCTGT );
+}
 
-	for (bCubeLevel = 1; bCubeLevel <= 3; bCubeLevel++)
+
+static INT8 CalcAverageCTGTForPosition(const CTGTQuery* const begin, const CTGTQuery* const end)
+{
+	INT32 iTotalCTGT = 0;
+	for (const CTGTQuery* i = begin; i != end; ++i)
 	{
-		switch (bCubeLevel)
-		{
-			case 1:
-				if (iMyAPsLeft < AP_CROUCH + AP_PRONE)
-				{
-					continue;
-				}
-				break;
-			case 2:
-				if (iMyAPsLeft < AP_CROUCH)
-				{
-					continue;
-				}
-				break;
-			default:
-				break;
-		}
-		iTotalCTGT += SoldierToLocationChanceToGetThrough(pSoldier, sOppGridNo, bLevel, bCubeLevel, opponent);
-		bValidCubeLevels++;
+		iTotalCTGT += i->ubChance;
 	}
-	iTotalCTGT /= bValidCubeLevels;
+	iTotalCTGT /= (INT32)(end - begin);
 	return( (INT8) iTotalCTGT );
 }
 
 
-static INT8 CalcBestCTGT(SOLDIERTYPE* const pSoldier, const SOLDIERTYPE* const opponent, const INT16 sOppGridNo, const INT8 bLevel, const INT32 iMyAPsLeft)
+/* Sets up the chances to get through from every spot next to the soldier, each
+ * one ending a group in group_ends. The soldier is left at the last spot. */
+static void PrepareBestCTGT(std::vector<CTGTQuery>& queries, std::vector<size_t>& group_ends, SOLDIERTYPE* const pSoldier, const SOLDIERTYPE* const opponent, const INT16 sOppGridNo, const INT8 bLevel, const INT32 iMyAPsLeft)
 {
 	// NOTE: CTGT stands for "ChanceToGetThrough..."
 
@@ -171,8 +274,6 @@ static INT8 CalcBestCTGT(SOLDIERTYPE* const pSoldier, const SOLDIERTYPE* const o
 	// CJC: Well, so much for THAT idea!
 	INT16 sCentralGridNo, sAdjSpot, sNorthGridNo, sSouthGridNo, sDir, sCheckSpot;
 
-	INT8 bThisCTGT, bBestCTGT = 0;
-
 	sCheckSpot = -1;
 
 	sCentralGridNo = pSoldier->sGridNo;
@@ -224,24 +325,44 @@ static INT8 CalcBestCTGT(SOLDIERTYPE* const pSoldier, const SOLDIERTYPE* const o
 					// NOTE: GOTTA SET THESE 3 FIELDS *BACK* AFTER USING THIS FUNCTION!!!
 					pSoldier->sGridNo = sAdjSpot;     // pretend he's standing at 'sAdjSpot'
 					AICenterXY( sAdjSpot, &(pSoldier->dXPos), &(pSoldier->dYPos) );
-					bThisCTGT = CalcWorstCTGTForPosition(pSoldier, opponent, sOppGridNo, bLevel, iMyAPsLeft);
-					if (bThisCTGT > bBestCTGT)
-					{
-						bBestCTGT = bThisCTGT;
-						// if there is no cover
-						if (bBestCTGT == 100)
-							// then bail from the for loop, it can't possible get any better
-							break;
-					}
+					PrepareCTGTForPosition(queries, pSoldier, opponent, sOppGridNo, bLevel, iMyAPsLeft);
+					group_ends.push_back(queries.size());
 				}
 			}
 		}
 	}
+}
 
+
+// The best of the worst chances to get through of the groups
+static INT8 CalcBestCTGT(const std::vector<CTGTQuery>& queries, const std::vector<size_t>& group_ends)
+{
+	INT8   bBestCTGT = 0;
+	size_t begin     = 0;
+	for (size_t const end : group_ends)
+	{
+		bBestCTGT = std::max(bBestCTGT, CalcWorstCTGTForPosition(queries.data() + begin, queries.data() + end));
+		begin     = end;
+	}
 	return( bBestCTGT );
 }
 
 
+// Whether the structures around the spot protect it towards any of the threats
+static bool CoverTowardsThreats(INT16 const sGridNo, UINT32 const uiThreatCnt)
+{
+	for (UINT32 i = 0; i != uiThreatCnt; ++i)
+	{
+		UINT8 const dir = GetDirectionToGridNoFromGridNo(sGridNo, Threat[i].sGridNo);
+		for (UINT stance = 0; stance != NUM_COVER_STANCES; ++stance)
+		{
+			if (CoverFromDirection(sGridNo, dir, (CoverStance)stance) != 0) return true;
+		}
+	}
+	return false;
+}
+
+
 static INT32 CalcCoverValue(SOLDIERTYPE* pMe, INT16 sMyGridNo, INT32 iMyThreat, INT32 iMyAPsLeft, UINT32 uiThreatIndex, INT32 iRange, INT32 morale, INT32* iTotalScale)
 {
 	// all 32-bit integers for max. speed
@@ -289,7 +410,28 @@ static INT32 CalcCoverValue(SOLDIERTYPE* pMe, INT16 sMyGridNo, INT32 iMyThreat,
 	}
 
 
-	if (InWaterOrGas(pHim,sHisGridNo))
+	// The chances to get through are set up here, while the soldiers are put
+	// where they are looked at, and traced together on the worker threads
+	std::vector<CTGTQuery> queries;
+	BOOLEAN const fHisInWaterOrGas = InWaterOrGas(pHim, sHisGridNo);
+	if (!fHisInWaterOrGas)
+	{
+		PrepareCTGTForPosition(queries, pHim, pMe, sMyGridNo, pMe->bLevel, iMyAPsLeft);
+	}
+	size_t const uiHisQueries = queries.size();
+
+	// if my intended gridno is in water or gas, I can't attack at all from there
+	// here, for smoke, consider bad
+	BOOLEAN const fMeInWaterGasOrSmoke = InWaterGasOrSmoke(pMe, sMyGridNo);
+	if (!fMeInWaterGasOrSmoke)
+	{
+		// let's not assume anything about the stance the enemy might take, so take an average
+		// value... no cover give a higher value than partial cover
+		PrepareCTGTForPosition(queries, pMe, pHim, sHisGridNo, pHim->bLevel, iMyAPsLeft);
+	}
+	ChanceToGetThroughTests(queries.data(), (UINT)queries.size());
+
+	if (fHisInWaterOrGas)
 	{
 		bHisActualCTGT = 0;
 	}
@@ -298,7 +440,7 @@ static INT32 CalcCoverValue(SOLDIERTYPE* pMe, INT16 sMyGridNo, INT32 iMyThreat,
 		// optimistically assume we'll be behind the best cover available at this spot
 
 		//bHisActualCTGT = ChanceToGetThrough(pHim,sMyGridNo,FAKE,ACTUAL,TESTWALLS,9999,M9PISTOL,NOT_FOR_LOS); // assume a gunshot
-		bHisActualCTGT = CalcWorstCTGTForPosition(pHim, pMe, sMyGridNo, pMe->bLevel, iMyAPsLeft);
+		bHisActualCTGT = CalcWorstCTGTForPosition(queries.data(), queries.data() + uiHisQueries);
 	}
 
 	// normally, that will be the cover I'll use, unless worst case over-rides it
@@ -317,7 +459,11 @@ static INT32 CalcCoverValue(SOLDIERTYPE* pMe, INT16 sMyGridNo, INT32 iMyThreat,
 		}
 
 		// calculate where my cover is worst if opponent moves just 1 tile over
-		bHisBestCTGT = CalcBestCTGT(pHim, pMe, sMyGridNo, pMe->bLevel, iMyAPsLeft);
+		std::vector<CTGTQuery> best_queries;
+		std::vector<size_t>    group_ends;
+		PrepareBestCTGT(best_queries, group_ends, pHim, pMe, sMyGridNo, pMe->bLevel, iMyAPsLeft);
+		ChanceToGetThroughTests(best_queries.data(), (UINT)best_queries.size());
+		bHisBestCTGT = CalcBestCTGT(best_queries, group_ends);
 
 		// if he can actually improve his CTGT by moving to a nearby gridno
 		if (bHisBestCTGT > bHisActualCTGT)
@@ -327,28 +473,17 @@ static INT32 CalcCoverValue(SOLDIERTYPE* pMe, INT16 sMyGridNo, INT32 iMyThreat,
 		}
 	}
 
-	// if my intended gridno is in water or gas, I can't attack at all from there
-	// here, for smoke, consider bad
-	if (InWaterGasOrSmoke(pMe,sMyGridNo))
+	if (fMeInWaterGasOrSmoke)
 	{
 		bMyCTGT = 0;
 	}
 	else
 	{
-		// put him at sHisGridNo if necessary!
-		if (pHim->sGridNo != sHisGridNo )
-		{
-			pHim->sGridNo = sHisGridNo;
-			ConvertGridNoToCenterCellXY( sHisGridNo, &sTempX, &sTempY );
-			pHim->dXPos = (FLOAT) sTempX;
-			pHim->dYPos = (FLOAT) sTempY;
-		}
 		// bMyCTGT = ChanceToGetThrough(pMe,sHisGridNo,FAKE,ACTUAL,TESTWALLS,9999,M9PISTOL,NOT_FOR_LOS); // assume a gunshot
 		// bMyCTGT = SoldierToLocationChanceToGetThrough( pMe, sHisGridNo, pMe->bTargetLevel, pMe->bTargetCubeLevel );
 
-		// let's not assume anything about the stance the enemy might take, so take an average
-		// value... no cover give a higher value than partial cover
-		bMyCTGT = CalcAverageCTGTForPosition(pMe, pHim, sHisGridNo, pHim->bLevel, iMyAPsLeft);
+		// my chances were set up above, while he was still at sHisGridNo
+		bMyCTGT = CalcAverageCTGTForPosition(queries.data() + uiHisQueries, queries.data() + queries.size());
 
 		// since NPCs are too dumb to shoot "blind", ie. at opponents that they
 		// themselves can't see (mercs can, using another as a spotter!), if the
@@ -499,8 +634,9 @@ static UINT8 NumberOfTeamMatesAdjacent(SOLDIERTYPE* pSoldier, INT16 sGridNo)
 	return( ubCount );
 }
 
-INT16 FindBestNearbyCover(SOLDIERTYPE *pSoldier, INT32 morale, INT32 *piPercentBetter)
+static INT16 SearchBestNearbyCover(SOLDIERTYPE* pSoldier, INT32 morale, INT32* piPercentBetter)
 {
+	AI_TIME_SCOPE(AI_TIMER_FIND_LOCATIONS);
 	// all 32-bit integers for max. speed
 	INT32 iCurrentCoverValue, iCoverValue, iBestCoverValue;
 	INT32 iCurrentScale, iCoverScale;
@@ -516,9 +652,6 @@ INT16 FindBestNearbyCover(SOLDIERTYPE *pSoldier, INT32 morale, INT32 *piPercentB
 	INT32 iMaxMoveTilesLeft, iSearchRange, iRoamRange;
 	INT16 sMaxLeft, sMaxRight, sMaxUp, sMaxDown, sXOffset, sYOffset;
 	INT16 sOrigin;	// has to be a short, need a pointer
-	INT16 *pusLastLoc;
-	INT8 *pbPersOL;
-	INT8 *pbPublOL;
 
 	UINT8 ubBackgroundLightLevel;
 	UINT8 ubBackgroundLightPercent = 0;
@@ -560,13 +693,6 @@ INT16 FindBestNearbyCover(SOLDIERTYPE *pSoldier, INT32 morale, INT32 *piPercentB
 
 	// BUILD A LIST OF THREATENING GRID #s FROM PERSONAL & PUBLIC opplists
 
-	pusLastLoc = &(gsLastKnownOppLoc[pSoldier->ubID][0]);
-
-	// hang a pointer into personal opplist
-	pbPersOL = &(pSoldier->bOppList[0]);
-	// hang a pointer into public opplist
-	pbPublOL = &(gbPublicOpplist[pSoldier->bTeam][0]);
-
 	// decide how far we're gonna be looking
 	iSearchRange = gbDiff[DIFF_MAX_COVER_RANGE][ SoldierDifficultyLevel( pSoldier ) ];
 
@@ -623,25 +749,17 @@ INT16 FindBestNearbyCover(SOLDIERTYPE *pSoldier, INT32 morale, INT32 *piPercentB
 	iMyThreatValue = CalcManThreatValue(pSoldier,NOWHERE,FALSE,pSoldier);
 
 	// look through all opponents for those we know of
-	FOR_EACH_MERC(i)
+	KnownOpponents& known = GetKnownOpponents(pSoldier);
+	for (UINT i = 0; i != known.n; ++i)
 	{
-		SOLDIERTYPE* const pOpponent = *i;
+		KnownOpponent const& k         = known.opp[i];
+		SOLDIERTYPE*   const pOpponent = k.pOpponent;
 
 		// if this merc is inactive, at base, on assignment, dead, unconscious
 		if (pOpponent->bLife < OKLIFE) continue; // next merc
 
-		// if this man is neutral / on the same side, he's not an opponent
-		if ( CONSIDERED_NEUTRAL( pSoldier, pOpponent ) || (pSoldier->bSide == pOpponent->bSide))
-		{
-			continue;          // next merc
-		}
-
-		pbPersOL = pSoldier->bOppList + pOpponent->ubID;
-		pbPublOL = gbPublicOpplist[pSoldier->bTeam] + pOpponent->ubID;
-		pusLastLoc = gsLastKnownOppLoc[pSoldier->ubID] + pOpponent->ubID;
-
 		// if this opponent is unknown personally and publicly
-		if ((*pbPersOL == NOT_HEARD_OR_SEEN) && (*pbPublOL == NOT_HEARD_OR_SEEN))
+		if (!k.fKnown)
 		{
 			continue;          // next merc
 		}
@@ -652,20 +770,9 @@ INT16 FindBestNearbyCover(SOLDIERTYPE *pSoldier, INT32 morale, INT32 *piPercentB
 			continue;  // next opponent
 		}
 
-		// if personal knowledge is more up to date or at least equal
-		if ((gubKnowledgeValue[*pbPublOL - OLDEST_HEARD_VALUE][*pbPersOL - OLDEST_HEARD_VALUE] > 0) ||
-			(*pbPersOL == *pbPublOL))
-		{
-			// using personal knowledge, obtain opponent's "best guess" gridno
-			sThreatLoc = *pusLastLoc;
-			iThreatCertainty = ThreatPercent[*pbPersOL - OLDEST_HEARD_VALUE];
-		}
-		else
-		{
-			// using public knowledge, obtain opponent's "best guess" gridno
-			sThreatLoc = gsPublicLastKnownOppLoc[pSoldier->bTeam][pOpponent->ubID];
-			iThreatCertainty = ThreatPercent[*pbPublOL - OLDEST_HEARD_VALUE];
-		}
+		// the opponent's "best guess" gridno from the more recent knowledge
+		sThreatLoc = k.sKnownLoc;
+		iThreatCertainty = k.iCertainty;
 
 		// calculate how far away this threat is (in adjusted pixels)
 		//iThreatRange = AdjPixelsAway(CenterX(pSoldier->sGridNo),CenterY(pSoldier->sGridNo),CenterX(sThreatLoc),CenterY(sThreatLoc));
@@ -678,7 +785,7 @@ INT16 FindBestNearbyCover(SOLDIERTYPE *pSoldier, INT32 morale, INT32 *piPercentB
 		}
 
 		// remember this opponent as a current threat, but DON'T REDUCE FOR COVER!
-		Threat[uiThreatCnt].iValue = CalcManThreatValue(pOpponent,pSoldier->sGridNo,FALSE,pSoldier);
+		Threat[uiThreatCnt].iValue = k.iThreatValue;
 
 		// if the opponent is no threat at all for some reason
 		if (Threat[uiThreatCnt].iValue == -999)
@@ -756,44 +863,22 @@ INT16 FindBestNearbyCover(SOLDIERTYPE *pSoldier, INT32 morale, INT32 *piPercentB
 	iBestCoverValue = iCurrentCoverValue;
 	SLOGD("FBNC: CURRENT iCoverValue = %d\n",iCurrentCoverValue);
 
+	UINT8 ubAPBudget;
 	if (pSoldier->bAlertStatus >= STATUS_RED)          // if already in battle
 	{
 		// to speed this up, tell PathAI to cancel any paths beyond our AP reach!
-		gubNPCAPBudget = pSoldier->bActionPoints;
+		ubAPBudget = pSoldier->bActionPoints;
 	}
 	else
 	{
 		// even if not under pressure, limit to 1 turn's travelling distance
 		// hope this isn't too expensive...
-		gubNPCAPBudget = CalcActionPoints( pSoldier );
-		//gubNPCAPBudget = pSoldier->bInitialAPs;
+		ubAPBudget = CalcActionPoints( pSoldier );
+		//ubAPBudget = pSoldier->bInitialAPs;
 	}
 
-	// Call FindBestPath to set flags in all locations that we can
-	// walk into within range.  We have to set some things up first...
-
-	// set the distance limit of the square region
-	gubNPCDistLimit = (UINT8) iSearchRange;
-
-	// reset the "reachable" flags in the region we're looking at
-	for (sYOffset = -sMaxUp; sYOffset <= sMaxDown; sYOffset++)
-	{
-		for (sXOffset = -sMaxLeft; sXOffset <= sMaxRight; sXOffset++)
-		{
-			sGridNo = pSoldier->sGridNo + sXOffset + (MAXCOL * sYOffset);
-			if ( !(sGridNo >=0 && sGridNo < WORLD_MAX) )
-			{
-				continue;
-			}
-			gpWorldLevelData[sGridNo].uiFlags &= ~(MAPELEMENT_REACHABLE);
-		}
-	}
-
-	FindBestPath( pSoldier, NOWHERE, pSoldier->bLevel, DetermineMovementMode( pSoldier, AI_ACTION_TAKE_COVER ), COPYREACHABLE_AND_APS, 0 );
-
-	// Turn off the "reachable" flag for his current location
-	// so we don't consider it
-	gpWorldLevelData[pSoldier->sGridNo].uiFlags &= ~(MAPELEMENT_REACHABLE);
+	// find the AP costs of all locations that we can walk into within range
+	MakeAPDistanceField(pSoldier, DetermineMovementMode(pSoldier, AI_ACTION_TAKE_COVER), iSearchRange, ubAPBudget);
 
 	// SET UP DOUBLE-LOOP TO STEP THROUGH POTENTIAL GRID #s
 	for (sYOffset = -sMaxUp; sYOffset <= sMaxDown; sYOffset++)
@@ -822,7 +907,11 @@ INT16 FindBestNearbyCover(SOLDIERTYPE *pSoldier, INT32 morale, INT32 *piPercentB
 				}
 			}
 
-			if (!(gpWorldLevelData[sGridNo].uiFlags & MAPELEMENT_REACHABLE))
+			// don't consider our current location
+			if (sGridNo == pSoldier->sGridNo) continue;
+
+			iPathCost = APDistanceTo(sGridNo);
+			if (iPathCost == AP_FIELD_UNREACHABLE)
 			{
 				continue;
 			}
@@ -841,7 +930,12 @@ INT16 FindBestNearbyCover(SOLDIERTYPE *pSoldier, INT32 morale, INT32 *piPercentB
 				continue;
 			}
 
-			iPathCost = gubAIPathCosts[AI_PATHCOST_RADIUS + sXOffset][AI_PATHCOST_RADIUS + sYOffset];
+			// without anything to hide behind towards the threats it is no cover
+			if (pSoldier->bLevel == 0 && !CoverTowardsThreats(sGridNo, uiThreatCnt))
+			{
+				continue;
+			}
+
 			/*
 			// water is OK, if the only good hiding place requires us to get wet, OK
 			iPathCost = LegalNPCDestination(pSoldier,sGridNo,ENSURE_PATH_COST,WATEROK);
@@ -984,8 +1078,23 @@ INT16 FindBestNearbyCover(SOLDIERTYPE *pSoldier, INT32 morale, INT32 *piPercentB
 	return(NOWHERE);       // return that no suitable cover was found
 }
 
+
+INT16 FindBestNearbyCover(SOLDIERTYPE* const pSoldier, INT32 const morale, INT32* const piPercentBetter)
+{
+	AIThinkStep* const step = ResumeThinkStep(*pSoldier, AI_STEP_COVER, morale);
+	if (!step) return SearchBestNearbyCover(pSoldier, morale, piPercentBetter);
+	if (!step->done)
+	{
+		step->sGridNo = SearchBestNearbyCover(pSoldier, morale, &step->iData);
+		step->done    = TRUE;
+	}
+	*piPercentBetter = step->iData;
+	return step->sGridNo;
+}
+
 INT16 FindSpotMaxDistFromOpponents(SOLDIERTYPE *pSoldier)
 {
+	AI_TIME_SCOPE(AI_TIMER_FIND_LOCATIONS);
 	INT16 sGridNo;
 	INT16 sBestSpot = NOWHERE;
 	INT32 iThreatRange,iClosestThreatRange = 1500, iSpotClosestThreatRange;
@@ -993,7 +1102,7 @@ INT16 FindSpotMaxDistFromOpponents(SOLDIERTYPE *pSoldier)
 	UINT32 uiThreatCnt = 0;
 	INT32 iSearchRange;
 	INT16	sMaxLeft, sMaxRight, sMaxUp, sMaxDown, sXOffset, sYOffset;
-	INT8 * pbPersOL,*pbPublOL, bEscapeDirection, bBestEscapeDirection = -1;
+	INT8 bEscapeDirection, bBestEscapeDirection = -1;
 	INT16	sOrigin;
 	INT32	iRoamRange;
 
@@ -1002,24 +1111,17 @@ INT16 FindSpotMaxDistFromOpponents(SOLDIERTYPE *pSoldier)
 	// BUILD A LIST OF THREATENING GRID #s FROM PERSONAL & PUBLIC opplistS
 
 	// look through all opponents for those we know of
-	FOR_EACH_MERC(i)
+	KnownOpponents& known = GetKnownOpponents(pSoldier);
+	for (UINT i = 0; i != known.n; ++i)
 	{
-		SOLDIERTYPE* const pOpponent = *i;
+		KnownOpponent const& k         = known.opp[i];
+		SOLDIERTYPE*   const pOpponent = k.pOpponent;
 
 		// if this merc is inactive, at base, on assignment, dead, unconscious
 		if (pOpponent->bLife < OKLIFE) continue; // next merc
 
-		// if this man is neutral / on the same side, he's not an opponent
-		if ( CONSIDERED_NEUTRAL( pSoldier, pOpponent ) || (pSoldier->bSide == pOpponent->bSide))
-		{
-			continue;          // next merc
-		}
-
-		pbPersOL = &(pSoldier->bOppList[pOpponent->ubID]);
-		pbPublOL = &(gbPublicOpplist[pSoldier->bTeam][pOpponent->ubID]);
-
 		// if this opponent is unknown personally and publicly
-		if ((*pbPersOL == NOT_HEARD_OR_SEEN) && (*pbPublOL == NOT_HEARD_OR_SEEN))
+		if (!k.fKnown)
 		{
 			continue;          // check next opponent
 		}
@@ -1031,23 +1133,13 @@ INT16 FindSpotMaxDistFromOpponents(SOLDIERTYPE *pSoldier)
 		}
 
 		// if the opponent is no threat at all for some reason
-		if (CalcManThreatValue(pOpponent,pSoldier->sGridNo,FALSE,pSoldier) == -999)
+		if (k.iThreatValue == -999)
 		{
 			continue;          // check next opponent
 		}
 
-		// if personal knowledge is more up to date or at least equal
-		if ((gubKnowledgeValue[*pbPublOL - OLDEST_HEARD_VALUE][*pbPersOL - OLDEST_HEARD_VALUE] > 0) ||
-			(*pbPersOL == *pbPublOL))
-		{
-			// using personal knowledge, obtain opponent's "best guess" gridno
-			sThreatLoc = gsLastKnownOppLoc[pSoldier->ubID][pOpponent->ubID];
-		}
-		else
-		{
-			// using public knowledge, obtain opponent's "best guess" gridno
-			sThreatLoc = gsPublicLastKnownOppLoc[pSoldier->bTeam][pOpponent->ubID];
-		}
+		// the opponent's "best guess" gridno from the more recent knowledge
+		sThreatLoc = k.sKnownLoc;
 
 		// calculate how far away this threat is (in adjusted pixels)
 		iThreatRange = GetRangeInCellCoordsFromGridNoDiff( pSoldier->sGridNo, sThreatLoc );
@@ -1133,32 +1225,8 @@ INT16 FindSpotMaxDistFromOpponents(SOLDIERTYPE *pSoldier)
 	sMaxUp   = MIN( iSearchRange, (pSoldier->sGridNo / MAXROW));
 	sMaxDown = MIN( iSearchRange, MAXROW - ((pSoldier->sGridNo / MAXROW) + 1));
 
-	// Call FindBestPath to set flags in all locations that we can
-	// walk into within range.  We have to set some things up first...
-
-	// set the distance limit of the square region
-	gubNPCDistLimit = (UINT8) iSearchRange;
-
-	// reset the "reachable" flags in the region we're looking at
-	for (sYOffset = -sMaxUp; sYOffset <= sMaxDown; sYOffset++)
-	{
-		for (sXOffset = -sMaxLeft; sXOffset <= sMaxRight; sXOffset++)
-		{
-			sGridNo = pSoldier->sGridNo + sXOffset + (MAXCOL * sYOffset);
-			if ( !(sGridNo >=0 && sGridNo < WORLD_MAX) )
-			{
-				continue;
-			}
-
-			gpWorldLevelData[sGridNo].uiFlags &= ~(MAPELEMENT_REACHABLE);
-		}
-	}
-
-	FindBestPath( pSoldier, NOWHERE, pSoldier->bLevel, DetermineMovementMode( pSoldier, AI_ACTION_RUN_AWAY ), COPYREACHABLE, 0 );
-
-	// Turn off the "reachable" flag for his current location
-	// so we don't consider it
-	gpWorldLevelData[pSoldier->sGridNo].uiFlags &= ~(MAPELEMENT_REACHABLE);
+	// find the AP costs of all locations that we can walk into within range
+	MakeAPDistanceField(pSoldier, DetermineMovementMode(pSoldier, AI_ACTION_RUN_AWAY), iSearchRange, gubNPCAPBudget);
 
 	for (sYOffset = -sMaxUp; sYOffset <= sMaxDown; sYOffset++)
 	{
@@ -1171,7 +1239,10 @@ INT16 FindSpotMaxDistFromOpponents(SOLDIERTYPE *pSoldier)
 				continue;
 			}
 
-			if (!(gpWorldLevelData[sGridNo].uiFlags & MAPELEMENT_REACHABLE))
+			// don't consider our current location
+			if (sGridNo == pSoldier->sGridNo) continue;
+
+			if (APDistanceTo(sGridNo) == AP_FIELD_UNREACHABLE)
 			{
 				continue;
 			}
@@ -1264,6 +1335,7 @@ INT16 FindSpotMaxDistFromOpponents(SOLDIERTYPE *pSoldier)
 
 INT16 FindNearestUngassedLand(SOLDIERTYPE *pSoldier)
 {
+	AI_TIME_SCOPE(AI_TIMER_FIND_LOCATIONS);
 	INT16 sGridNo,sClosestLand = NOWHERE,sPathCost,sShortestPath = 1000;
 	INT16 sMaxLeft,sMaxRight,sMaxUp,sMaxDown,sXOffset,sYOffset;
 	INT32 iSearchRange;
@@ -1280,32 +1352,8 @@ INT16 FindNearestUngassedLand(SOLDIERTYPE *pSoldier)
 		sMaxUp   = MIN(iSearchRange,(pSoldier->sGridNo / MAXROW));
 		sMaxDown = MIN(iSearchRange,MAXROW - ((pSoldier->sGridNo / MAXROW) + 1));
 
-		// Call FindBestPath to set flags in all locations that we can
-		// walk into within range.  We have to set some things up first...
-
-		// set the distance limit of the square region
-		gubNPCDistLimit = (UINT8) iSearchRange;
-
-		// reset the "reachable" flags in the region we're looking at
-		for (sYOffset = -sMaxUp; sYOffset <= sMaxDown; sYOffset++)
-		{
-			for (sXOffset = -sMaxLeft; sXOffset <= sMaxRight; sXOffset++)
-			{
-				sGridNo = pSoldier->sGridNo + sXOffset + (MAXCOL * sYOffset);
-				if ( !(sGridNo >=0 && sGridNo < WORLD_MAX) )
-				{
-					continue;
-				}
-
-				gpWorldLevelData[sGridNo].uiFlags &= ~(MAPELEMENT_REACHABLE);
-			}
-		}
-
-		FindBestPath( pSoldier, NOWHERE, pSoldier->bLevel, DetermineMovementMode( pSoldier, AI_ACTION_LEAVE_WATER_GAS ), COPYREACHABLE, 0 );
-
-		// Turn off the "reachable" flag for his current location
-		// so we don't consider it
-		gpWorldLevelData[pSoldier->sGridNo].uiFlags &= ~(MAPELEMENT_REACHABLE);
+		// find the AP costs of all locations that we can walk into within range
+		MakeAPDistanceField(pSoldier, DetermineMovementMode(pSoldier, AI_ACTION_LEAVE_WATER_GAS), iSearchRange, 0);
 
 		// SET UP DOUBLE-LOOP TO STEP THROUGH POTENTIAL GRID #s
 		for (sYOffset = -sMaxUp; sYOffset <= sMaxDown; sYOffset++)
@@ -1319,7 +1367,11 @@ INT16 FindNearestUngassedLand(SOLDIERTYPE *pSoldier)
 					continue;
 				}
 
-				if (!(gpWorldLevelData[sGridNo].uiFlags & MAPELEMENT_REACHABLE))
+				// don't consider our current location
+				if (sGridNo == pSoldier->sGridNo) continue;
+
+				sPathCost = APDistanceTo(sGridNo);
+				if (sPathCost == AP_FIELD_UNREACHABLE)
 				{
 					continue;
 				}
@@ -1330,12 +1382,8 @@ INT16 FindNearestUngassedLand(SOLDIERTYPE *pSoldier)
 					continue;
 				}
 
-				// CJC: here, unfortunately, we must calculate a path so we have an AP cost
-
 				// obviously, we're looking for LAND, so water is out!
-				sPathCost = LegalNPCDestination(pSoldier,sGridNo,ENSURE_PATH_COST,NOWATER,0);
-
-				if (!sPathCost)
+				if (!LegalNPCDestination(pSoldier,sGridNo,IGNORE_PATH,NOWATER,0))
 				{
 					continue;      // skip on to the next potential grid
 				}
@@ -1357,8 +1405,9 @@ INT16 FindNearestUngassedLand(SOLDIERTYPE *pSoldier)
 	return(sClosestLand);
 }
 
-INT16 FindNearbyDarkerSpot( SOLDIERTYPE *pSoldier )
+static INT16 SearchNearbyDarkerSpot(SOLDIERTYPE* pSoldier)
 {
+	AI_TIME_SCOPE(AI_TIMER_FIND_LOCATIONS);
 	INT16 sGridNo, sClosestSpot = NOWHERE, sPathCost;
 	INT32 iSpotValue, iBestSpotValue = 1000;
 	INT16 sMaxLeft,sMaxRight,sMaxUp,sMaxDown,sXOffset,sYOffset;
@@ -1383,32 +1432,8 @@ INT16 FindNearbyDarkerSpot( SOLDIERTYPE *pSoldier )
 		sMaxUp   = MIN(iSearchRange,(pSoldier->sGridNo / MAXROW));
 		sMaxDown = MIN(iSearchRange,MAXROW - ((pSoldier->sGridNo / MAXROW) + 1));
 
-		// Call FindBestPath to set flags in all locations that we can
-		// walk into within range.  We have to set some things up first...
-
-		// set the distance limit of the square region
-		gubNPCDistLimit = (UINT8) iSearchRange;
-
-		// reset the "reachable" flags in the region we're looking at
-		for (sYOffset = -sMaxUp; sYOffset <= sMaxDown; sYOffset++)
-		{
-			for (sXOffset = -sMaxLeft; sXOffset <= sMaxRight; sXOffset++)
-			{
-				sGridNo = pSoldier->sGridNo + sXOffset + (MAXCOL * sYOffset);
-				if ( !(sGridNo >=0 && sGridNo < WORLD_MAX) )
-				{
-					continue;
-				}
-
-				gpWorldLevelData[sGridNo].uiFlags &= ~(MAPELEMENT_REACHABLE);
-			}
-		}
-
-		FindBestPath( pSoldier, NOWHERE, pSoldier->bLevel, DetermineMovementMode( pSoldier, AI_ACTION_LEAVE_WATER_GAS ), COPYREACHABLE, 0 );
-
-		// Turn off the "reachable" flag for his current location
-		// so we don't consider it
-		gpWorldLevelData[pSoldier->sGridNo].uiFlags &= ~(MAPELEMENT_REACHABLE);
+		// find the AP costs of all locations that we can walk into within range
+		MakeAPDistanceField(pSoldier, DetermineMovementMode(pSoldier, AI_ACTION_LEAVE_WATER_GAS), iSearchRange, 0);
 
 		// SET UP DOUBLE-LOOP TO STEP THROUGH POTENTIAL GRID #s
 		for (sYOffset = -sMaxUp; sYOffset <= sMaxDown; sYOffset++)
@@ -1422,7 +1447,11 @@ INT16 FindNearbyDarkerSpot( SOLDIERTYPE *pSoldier )
 					continue;
 				}
 
-				if (!(gpWorldLevelData[sGridNo].uiFlags & MAPELEMENT_REACHABLE))
+				// don't consider our current location
+				if (sGridNo == pSoldier->sGridNo) continue;
+
+				sPathCost = APDistanceTo(sGridNo);
+				if (sPathCost == AP_FIELD_UNREACHABLE)
 				{
 					continue;
 				}
@@ -1451,11 +1480,7 @@ INT16 FindNearbyDarkerSpot( SOLDIERTYPE *pSoldier )
 					continue;
 				}
 
-				// CJC: here, unfortunately, we must calculate a path so we have an AP cost
-
-				sPathCost = LegalNPCDestination(pSoldier,sGridNo,ENSURE_PATH_COST,NOWATER,0);
-
-				if (!sPathCost)
+				if (!LegalNPCDestination(pSoldier,sGridNo,IGNORE_PATH,NOWATER,0))
 				{
 					continue;      // skip on to the next potential grid
 				}
@@ -1483,6 +1508,19 @@ INT16 FindNearbyDarkerSpot( SOLDIERTYPE *pSoldier )
 }
 
 
+INT16 FindNearbyDarkerSpot(SOLDIERTYPE* const pSoldier)
+{
+	AIThinkStep* const step = ResumeThinkStep(*pSoldier, AI_STEP_DARKER_SPOT, 0);
+	if (!step) return SearchNearbyDarkerSpot(pSoldier);
+	if (!step->done)
+	{
+		step->sGridNo = SearchNearbyDarkerSpot(pSoldier);
+		step->done    = TRUE;
+	}
+	return step->sGridNo;
+}
+
+
 static bool IsGunUsable(OBJECTTYPE const& o, SOLDIERTYPE const& s)
 {
 	Assert(GCM->getItem(o.usItem)->isGun());
@@ -1497,6 +1535,7 @@ static bool IsGunUsable(OBJECTTYPE const& o, SOLDIERTYPE const& s)
 
 INT8 SearchForItems(SOLDIERTYPE& s, ItemSearchReason const reason, UINT16 const usItem)
 {
+	AI_TIME_SCOPE(AI_TIMER_FIND_LOCATIONS);
 	if (s.bActionPoints < AP_PICKUP_ITEM) return AI_ACTION_NONE;
 
 	if (!IS_MERC_BODY_TYPE(&s)) return AI_ACTION_NONE;
@@ -1535,28 +1574,10 @@ INT8 SearchForItems(SOLDIERTYPE& s, ItemSearchReason const reason, UINT16 const
 	INT16 const max_up   = MIN(search_range, s.sGridNo / MAXROW);
 	INT16 const max_down = MIN(search_range, MAXROW - (s.sGridNo / MAXROW + 1));
 
-	// Call FindBestPath to set flags in all locations that we can
-	// walk into within range.  We have to set some things up first...
-
-	// set the distance limit of the square region
-	gubNPCDistLimit = search_range;
-
-	// set an AP limit too, to our APs less the cost of picking up an item
+	// find the AP costs of all locations that we can walk into within range,
+	// limited to our APs less the cost of picking up an item
 	// and less the cost of dropping an item since we might need to do that
-	gubNPCAPBudget = s.bActionPoints - AP_PICKUP_ITEM;
-
-	// reset the "reachable" flags in the region we're looking at
-	for (INT16 dy = -max_up; dy <= max_down; ++dy)
-	{
-		for (INT16 dx = -max_left; dx <= max_right; ++dx)
-		{
-			GridNo const grid_no = s.sGridNo + dx + MAXCOL * dy;
-			if (grid_no < 0 || WORLD_MAX <= grid_no) continue;
-			gpWorldLevelData[grid_no].uiFlags &= ~MAPELEMENT_REACHABLE;
-		}
-	}
-
-	FindBestPath(&s, NOWHERE, s.bLevel, DetermineMovementMode(&s, AI_ACTION_PICKUP_ITEM), COPYREACHABLE, 0);
+	MakeAPDistanceField(&s, DetermineMovementMode(&s, AI_ACTION_PICKUP_ITEM), search_range, s.bActionPoints - AP_PICKUP_ITEM);
 
 	GridNo best_spot     = NOWHERE;
 	INT32  best_value    =  0;
@@ -1573,14 +1594,15 @@ INT8 SearchForItems(SOLDIERTYPE& s, ItemSearchReason const reason, UINT16 const
 			// exclude locations with tear/mustard gas (at this point, smoke is cool!)
 			if (InGasOrSmoke(&s, grid_no)) continue;
 
-			if (!(gpWorldLevelData[grid_no].uiFlags & MAPELEMENT_ITEMPOOL_PRESENT)) continue;
-			if (!(gpWorldLevelData[grid_no].uiFlags & MAPELEMENT_REACHABLE))        continue;
+			ITEM_POOL const* const item_pool = GetItemPool(grid_no, s.bLevel);
+			if (!item_pool)                                    continue;
+			if (APDistanceTo(grid_no) == AP_FIELD_UNREACHABLE) continue;
 
 			// ignore blacklisted spot
 			if (grid_no == s.sBlackList) continue;
 
 			INT32 value = 0;
-			for (ITEM_POOL const* pItemPool = GetItemPool(grid_no, s.bLevel); pItemPool; pItemPool = pItemPool->pNext)
+			for (ITEM_POOL const* pItemPool = item_pool; pItemPool; pItemPool = pItemPool->pNext)
 			{
 				OBJECTTYPE const& o    = GetWorldItem(pItemPool->iItemIndex).o;
 				const ItemModel * item = GCM->getItem(o.usItem);
@@ -1,6 +1,21 @@
 #ifndef FINDLOCATIONS_H
 #define FINDLOCATIONS_H
 
+#include "JA2Types.h"
+
 INT16 FindNearestOpenableNonDoor(INT16 sStartGridNo);
 
+/* The AP costs for a soldier to move to the tiles within range of him, as found
+ * by a single search of FindBestPath(). The location searches of one decision
+ * share it, so the search is only made again if the soldier, his movement mode,
+ * the range, the AP budget or the world changed. A budget of 0 means no limit.
+ * The costs do not include the APs to start moving. */
+#define AP_FIELD_UNREACHABLE 255
+
+void  MakeAPDistanceField(SOLDIERTYPE*, UINT16 usMovementMode, INT32 iRange, UINT8 ubAPBudget);
+// AP_FIELD_UNREACHABLE if the tile is out of range or cannot be reached
+UINT8 APDistanceTo(GridNo);
+// Forgets the field, as other soldiers may have moved since it was made
+void  InvalidateAPDistanceField(void);
+
 #endif
@@ -1,5 +1,6 @@
 #include "AI.h"
 #include "AIInternals.h"
+#include "AITiming.h"
 #include "Animation_Control.h"
 #include "Isometric_Utils.h"
 #include "Points.h"
@@ -14,6 +15,7 @@
 #include "NPC.h"
 #include "Render_Fun.h"
 #include "Quests.h"
+#include "Timer_Control.h"
 
 
 static INT8 RTPlayerDecideAction(SOLDIERTYPE* pSoldier)
@@ -66,6 +68,88 @@ static INT8 RTDecideAction(SOLDIERTYPE* pSoldier)
 	}
 }
 
+#define MAX_THINK_STEPS  8
+#define THINK_STASH_TIME 1000 // the steps kept are replayed within this time only
+
+
+struct AIThinkStash
+{
+	UINT        n_steps;
+	GridNo      sGridNo;      // where the soldier was when the decision gave up
+	INT8        bAlertStatus;
+	UINT32      uiTime;
+	AIThinkStep steps[MAX_THINK_STEPS];
+};
+
+struct AIThinkYield {};
+
+
+static AIThinkStash       g_think_stash[TOTAL_SOLDIERS];
+static SOLDIERTYPE const* g_resumable; // the soldier making a realtime decision
+static UINT               g_think_pos; // steps taken by the decision so far
+static UINT               g_think_new; // steps of them not replayed
+
+
+AIThinkStep* ResumeThinkStep(SOLDIERTYPE const& s, AIThinkStepKind const kind, INT32 const arg)
+{
+	if (&s != g_resumable || g_think_pos == MAX_THINK_STEPS) return NULL;
+
+	AIThinkStash& t   = g_think_stash[s.ubID];
+	UINT const    pos = g_think_pos++;
+	if (pos < t.n_steps)
+	{
+		AIThinkStep& step = t.steps[pos];
+		if (step.kind == kind && step.arg == arg && step.done) return &step;
+		// the decision took another turn this time, the rest is of no use
+		t.n_steps = pos;
+	}
+
+	/* Every decision gets through one new step at least, so a decision which
+	 * gives up every frame still gets done eventually */
+	if (g_think_new != 0 && AIThinkBudgetSpent()) throw AIThinkYield();
+	++g_think_new;
+
+	AIThinkStep& step = t.steps[t.n_steps++];
+	step = AIThinkStep{};
+	step.kind = kind;
+	step.arg  = arg;
+	return &step;
+}
+
+
+// Returns false if the decision gave up, to be made again in the next frame
+static bool RTResumeDecideAction(SOLDIERTYPE* const pSoldier)
+{
+	AIThinkStash& t = g_think_stash[pSoldier->ubID];
+	if (t.sGridNo != pSoldier->sGridNo ||
+			t.bAlertStatus != pSoldier->bAlertStatus ||
+			GetJA2Clock() - t.uiTime > THINK_STASH_TIME)
+	{
+		t.n_steps = 0;
+	}
+
+	g_resumable = pSoldier;
+	g_think_pos = 0;
+	g_think_new = 0;
+	try
+	{
+		pSoldier->bAction = RTDecideAction(pSoldier);
+	}
+	catch (AIThinkYield const&)
+	{
+		g_resumable    = NULL;
+		t.sGridNo      = pSoldier->sGridNo;
+		t.bAlertStatus = pSoldier->bAlertStatus;
+		t.uiTime       = GetJA2Clock();
+		AICountThinkYield();
+		return false;
+	}
+	g_resumable = NULL;
+	t.n_steps   = 0;
+	return true;
+}
+
+
 UINT16 RealtimeDelay( SOLDIERTYPE * pSoldier )
 {
 	if ( PTR_CIV_OR_MILITIA && !(pSoldier->ubCivilianGroup == KINGPIN_CIV_GROUP ) )
@@ -205,9 +289,12 @@ void RTHandleAI( SOLDIERTYPE * pSoldier )
 			}
 			else
 			{
-				if (!(gTacticalStatus.uiFlags & ENGAGED_IN_CONV))
+				if (!(gTacticalStatus.uiFlags & ENGAGED_IN_CONV) && !RTResumeDecideAction(pSoldier))
 				{
-					pSoldier->bAction = RTDecideAction( pSoldier );
+					// out of think time, carry on with the decision in the next frame
+					pSoldier->bAction = AI_ACTION_NONE;
+					pSoldier->fAIFlags |= AI_HANDLE_EVERY_FRAME;
+					return;
 				}
 			}
 		}
@@ -0,0 +1,371 @@
+#include "Blitter_Benchmark.h"
+#include "Benchmark_Suite.h"
+#include "ContentManager.h"
+#include "Directories.h"
+#include "GameInstance.h"
+#include "HImage.h"
+#include "Logger.h"
+#include "Profiler.h"
+#include "RenderWorld.h"
+#include "Shading.h"
+#include "VObject.h"
+#include "VObject_Blitters.h"
+#include "VSurface.h"
+
+#include <SDL.h>
+
+#include <algorithm>
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+
+#define BENCH_WIDTH   1024
+#define BENCH_HEIGHT  768
+#define BENCH_BLITS   4096 // blits per blitter and sample
+#define BENCH_OUTLINE 0x07E0
+
+
+// A blit, with the pixels of the image which end up inside of its clipping rectangle
+struct BenchBlit
+{
+	INT32   x;
+	INT32   y;
+	UINT16  index;
+	SGPRect clip;
+	UINT32  pixels;
+};
+
+struct BenchSample
+{
+	char const*            name;
+	SGPVObject*            vo;
+	std::vector<BenchBlit> unclipped;
+	std::vector<BenchBlit> clipped;
+};
+
+
+static std::vector<BenchSample> g_samples;
+static BlitterBenchTarget       g_target;
+static FILE*                    g_csv;
+
+
+/* A linear congruential generator, so the blits do not depend on the state of
+ * Random() */
+static UINT32 NextSample(UINT32& seed)
+{
+	seed = seed * 1103515245 + 12345;
+	return (seed >> 16) & 0x7FFF;
+}
+
+
+static SGPRect SampleClipRect(UINT32& seed)
+{
+	SGPRect r;
+	r.iLeft   = NextSample(seed) % (BENCH_WIDTH  / 2);
+	r.iTop    = NextSample(seed) % (BENCH_HEIGHT / 2);
+	r.iRight  = r.iLeft + BENCH_WIDTH  / 4 + NextSample(seed) % (BENCH_WIDTH  / 4);
+	r.iBottom = r.iTop  + BENCH_HEIGHT / 4 + NextSample(seed) % (BENCH_HEIGHT / 4);
+	return r;
+}
+
+
+static UINT32 VisiblePixels(ETRLEObject const& e, INT32 const x, INT32 const y, SGPRect const& clip)
+{
+	INT32 const l = std::max<INT32>(x + e.sOffsetX,             clip.iLeft);
+	INT32 const t = std::max<INT32>(y + e.sOffsetY,             clip.iTop);
+	INT32 const r = std::min<INT32>(x + e.sOffsetX + e.usWidth,  clip.iRight);
+	INT32 const b = std::min<INT32>(y + e.sOffsetY + e.usHeight, clip.iBottom);
+	return l < r && t < b ? (r - l) * (b - t) : 0;
+}
+
+
+static void SampleBlits(BenchSample& s, UINT32& seed)
+{
+	SGPRect const all = { 0, 0, BENCH_WIDTH, BENCH_HEIGHT };
+	UINT16  const n   = s.vo->SubregionCount();
+	for (UINT i = 0; i != BENCH_BLITS; ++i)
+	{
+		UINT16      const idx = NextSample(seed) % n;
+		ETRLEObject const& e  = s.vo->SubregionProperties(idx);
+
+		if (e.usWidth < BENCH_WIDTH && e.usHeight < BENCH_HEIGHT)
+		{
+			BenchBlit b;
+			b.x      = NextSample(seed) % (BENCH_WIDTH  - e.usWidth)  - e.sOffsetX;
+			b.y      = NextSample(seed) % (BENCH_HEIGHT - e.usHeight) - e.sOffsetY;
+			b.index  = idx;
+			b.clip   = all;
+			b.pixels = e.usWidth * e.usHeight;
+			s.unclipped.push_back(b);
+		}
+
+		// Anywhere from just left of and above the clipping rectangle to just right of and below it
+		BenchBlit b;
+		b.clip   = SampleClipRect(seed);
+		b.x      = b.clip.iLeft - e.usWidth  + NextSample(seed) % (b.clip.iRight  - b.clip.iLeft + e.usWidth)  - e.sOffsetX;
+		b.y      = b.clip.iTop  - e.usHeight + NextSample(seed) % (b.clip.iBottom - b.clip.iTop  + e.usHeight) - e.sOffsetY;
+		b.index  = idx;
+		b.pixels = VisiblePixels(e, b.x, b.y, b.clip);
+		s.clipped.push_back(b);
+	}
+}
+
+
+static void ClearTarget()
+{
+	std::fill_n(g_target.buf,  BENCH_WIDTH * BENCH_HEIGHT, 0);
+	std::fill_n(g_target.zbuf, BENCH_WIDTH * BENCH_HEIGHT, 0);
+	g_target.z = 0;
+}
+
+
+static void LogResult(char const* const name, char const* const sample, UINT32 const blits, uint64_t const pixels, double const ms)
+{
+	double const mpixels = ms > 0 ? pixels / (ms * 1000) : 0;
+	SLOGI("Blitter benchmark, %-48s %-10s %6u blits, %10llu pixels, %8.2f ms, %8.1f Mpixels/s",
+		name, sample, blits, (unsigned long long)pixels, ms, mpixels);
+	if (g_csv) fprintf(g_csv, "%s,%s,%u,%llu,%.3f,%.2f\n", name, sample, blits, (unsigned long long)pixels, ms, mpixels);
+	RecordBenchmarkResult(std::string("blit.") + name + "." + sample + "_ms", ms);
+}
+
+
+void BenchmarkObjectBlitter(char const* const name, bool const clipped, BlitterBenchFn const blt)
+{
+	for (BenchSample const& s : g_samples)
+	{
+		std::vector<BenchBlit> const& blits = clipped ? s.clipped : s.unclipped;
+		ClearTarget();
+		uint64_t pixels = 0;
+		uint64_t const start = SDL_GetPerformanceCounter();
+		for (BenchBlit const& b : blits)
+		{
+			g_target.clip = b.clip;
+			++g_target.z;
+			blt(g_target, s.vo, b.x, b.y, b.index);
+			pixels += b.pixels;
+		}
+		LogResult(name, s.name, (UINT32)blits.size(), pixels, MSSince(start));
+	}
+}
+
+
+/* The rectangle blitters get the clipping rectangles of the clipped blits of
+ * the first sample */
+static void BenchmarkRectBlitter(char const* const name, void (*blt)(BlitterBenchTarget&, SGPRect&))
+{
+	std::vector<BenchBlit> const& blits = g_samples.front().clipped;
+	ClearTarget();
+	uint64_t pixels = 0;
+	uint64_t const start = SDL_GetPerformanceCounter();
+	for (BenchBlit const& b : blits)
+	{
+		SGPRect r = b.clip;
+		blt(g_target, r);
+		pixels += (r.iRight - r.iLeft) * (r.iBottom - r.iTop);
+	}
+	LogResult(name, "rects", (UINT32)blits.size(), pixels, MSSince(start));
+}
+
+
+static void BenchmarkObjectBlitters()
+{
+#define UNCLIPPED(blt, call) BenchmarkObjectBlitter(#blt, false, [](BlitterBenchTarget& t, SGPVObject* vo, INT32 x, INT32 y, UINT16 i) { call; })
+#define CLIPPED(blt, call)   BenchmarkObjectBlitter(#blt, true,  [](BlitterBenchTarget& t, SGPVObject* vo, INT32 x, INT32 y, UINT16 i) { call; })
+	UNCLIPPED(Transparent,                   Blt8BPPDataTo16BPPBufferTransparent(t.buf, t.pitch, vo, x, y, i));
+	CLIPPED(  TransparentClip,               Blt8BPPDataTo16BPPBufferTransparentClip(t.buf, t.pitch, vo, x, y, i, &t.clip));
+	UNCLIPPED(TransZ,                        Blt8BPPDataTo16BPPBufferTransZ(t.buf, t.pitch, t.zbuf, t.z, vo, x, y, i));
+	UNCLIPPED(TransZNB,                      Blt8BPPDataTo16BPPBufferTransZNB(t.buf, t.pitch, t.zbuf, t.z, vo, x, y, i));
+	CLIPPED(  TransZClip,                    Blt8BPPDataTo16BPPBufferTransZClip(t.buf, t.pitch, t.zbuf, t.z, vo, x, y, i, &t.clip));
+	CLIPPED(  TransZNBClip,                  Blt8BPPDataTo16BPPBufferTransZNBClip(t.buf, t.pitch, t.zbuf, t.z, vo, x, y, i, &t.clip));
+	UNCLIPPED(TransZPixelateObscured,        Blt8BPPDataTo16BPPBufferTransZPixelateObscured(t.buf, t.pitch, t.zbuf, t.z, vo, x, y, i));
+	CLIPPED(  TransZClipPixelateObscured,    Blt8BPPDataTo16BPPBufferTransZClipPixelateObscured(t.buf, t.pitch, t.zbuf, t.z, vo, x, y, i, &t.clip));
+	UNCLIPPED(TransZTranslucent,             Blt8BPPDataTo16BPPBufferTransZTranslucent(t.buf, t.pitch, t.zbuf, t.z, vo, x, y, i));
+	UNCLIPPED(TransZNBTranslucent,           Blt8BPPDataTo16BPPBufferTransZNBTranslucent(t.buf, t.pitch, t.zbuf, t.z, vo, x, y, i));
+	CLIPPED(  TransZNBClipTranslucent,       Blt8BPPDataTo16BPPBufferTransZNBClipTranslucent(t.buf, t.pitch, t.zbuf, t.z, vo, x, y, i, &t.clip));
+	UNCLIPPED(TransShadow,                   Blt8BPPDataTo16BPPBufferTransShadow(t.buf, t.pitch, vo, x, y, i, vo->CurrentShade()));
+	CLIPPED(  TransShadowClip,               Blt8BPPDataTo16BPPBufferTransShadowClip(t.buf, t.pitch, vo, x, y, i, &t.clip, vo->CurrentShade()));
+	UNCLIPPED(TransShadowZ,                  Blt8BPPDataTo16BPPBufferTransShadowZ(t.buf, t.pitch, t.zbuf, t.z, vo, x, y, i, vo->CurrentShade()));
+	UNCLIPPED(TransShadowZNB,                Blt8BPPDataTo16BPPBufferTransShadowZNB(t.buf, t.pitch, t.zbuf, t.z, vo, x, y, i, vo->CurrentShade()));
+	CLIPPED(  TransShadowZClip,              Blt8BPPDataTo16BPPBufferTransShadowZClip(t.buf, t.pitch, t.zbuf, t.z, vo, x, y, i, &t.clip, vo->CurrentShade()));
+	CLIPPED(  TransShadowZNBClip,            Blt8BPPDataTo16BPPBufferTransShadowZNBClip(t.buf, t.pitch, t.zbuf, t.z, vo, x, y, i, &t.clip, vo->CurrentShade()));
+	UNCLIPPED(TransShadowZNBObscured,        Blt8BPPDataTo16BPPBufferTransShadowZNBObscured(t.buf, t.pitch, t.zbuf, t.z, vo, x, y, i, vo->CurrentShade()));
+	CLIPPED(  TransShadowZNBObscuredClip,    Blt8BPPDataTo16BPPBufferTransShadowZNBObscuredClip(t.buf, t.pitch, t.zbuf, t.z, vo, x, y, i, &t.clip, vo->CurrentShade()));
+	UNCLIPPED(Shadow,                        Blt8BPPDataTo16BPPBufferShadow(t.buf, t.pitch, vo, x, y, i));
+	CLIPPED(  ShadowClip,                    Blt8BPPDataTo16BPPBufferShadowClip(t.buf, t.pitch, vo, x, y, i, &t.clip));
+	UNCLIPPED(ShadowZ,                       Blt8BPPDataTo16BPPBufferShadowZ(t.buf, t.pitch, t.zbuf, t.z, vo, x, y, i));
+	UNCLIPPED(ShadowZNB,                     Blt8BPPDataTo16BPPBufferShadowZNB(t.buf, t.pitch, t.zbuf, t.z, vo, x, y, i));
+	CLIPPED(  ShadowZClip,                   Blt8BPPDataTo16BPPBufferShadowZClip(t.buf, t.pitch, t.zbuf, t.z, vo, x, y, i, &t.clip));
+	CLIPPED(  ShadowZNBClip,                 Blt8BPPDataTo16BPPBufferShadowZNBClip(t.buf, t.pitch, t.zbuf, t.z, vo, x, y, i, &t.clip));
+	CLIPPED(  MonoShadowClip,                Blt8BPPDataTo16BPPBufferMonoShadowClip(t.buf, t.pitch, vo, x, y, i, &t.clip, 0xFFFF, 0, 0));
+	UNCLIPPED(Intensity,                     Blt8BPPDataTo16BPPBufferIntensity(t.buf, t.pitch, vo, x, y, i));
+	CLIPPED(  IntensityClip,                 Blt8BPPDataTo16BPPBufferIntensityClip(t.buf, t.pitch, vo, x, y, i, &t.clip));
+	UNCLIPPED(IntensityZ,                    Blt8BPPDataTo16BPPBufferIntensityZ(t.buf, t.pitch, t.zbuf, t.z, vo, x, y, i));
+	UNCLIPPED(IntensityZNB,                  Blt8BPPDataTo16BPPBufferIntensityZNB(t.buf, t.pitch, t.zbuf, t.z, vo, x, y, i));
+	CLIPPED(  IntensityZClip,                Blt8BPPDataTo16BPPBufferIntensityZClip(t.buf, t.pitch, t.zbuf, t.z, vo, x, y, i, &t.clip));
+	UNCLIPPED(Outline,                       Blt8BPPDataTo16BPPBufferOutline(t.buf, t.pitch, vo, x, y, i, BENCH_OUTLINE));
+	CLIPPED(  OutlineClip,                   Blt8BPPDataTo16BPPBufferOutlineClip(t.buf, t.pitch, vo, x, y, i, BENCH_OUTLINE, &t.clip));
+	UNCLIPPED(OutlineZ,                      Blt8BPPDataTo16BPPBufferOutlineZ(t.buf, t.pitch, t.zbuf, t.z, vo, x, y, i, BENCH_OUTLINE));
+	UNCLIPPED(OutlineZNB,                    Blt8BPPDataTo16BPPBufferOutlineZNB(t.buf, t.pitch, t.zbuf, t.z, vo, x, y, i));
+	CLIPPED(  OutlineZClip,                  Blt8BPPDataTo16BPPBufferOutlineZClip(t.buf, t.pitch, t.zbuf, t.z, vo, x, y, i, BENCH_OUTLINE, &t.clip));
+	UNCLIPPED(OutlineZPixelateObscured,      Blt8BPPDataTo16BPPBufferOutlineZPixelateObscured(t.buf, t.pitch, t.zbuf, t.z, vo, x, y, i, BENCH_OUTLINE));
+	CLIPPED(  OutlineZPixelateObscuredClip,  Blt8BPPDataTo16BPPBufferOutlineZPixelateObscuredClip(t.buf, t.pitch, t.zbuf, t.z, vo, x, y, i, BENCH_OUTLINE, &t.clip));
+	UNCLIPPED(OutlineShadow,                 Blt8BPPDataTo16BPPBufferOutlineShadow(t.buf, t.pitch, vo, x, y, i));
+	CLIPPED(  OutlineShadowClip,             Blt8BPPDataTo16BPPBufferOutlineShadowClip(t.buf, t.pitch, vo, x, y, i, &t.clip));
+#undef CLIPPED
+#undef UNCLIPPED
+}
+
+
+static void BenchmarkRectBlitters()
+{
+	static UINT16 src[BENCH_WIDTH * BENCH_HEIGHT];
+	BenchmarkRectBlitter("Blt16BPPTo16BPP", [](BlitterBenchTarget& t, SGPRect& r)
+	{
+		Blt16BPPTo16BPP(t.buf, t.pitch, src, BENCH_WIDTH * sizeof(*src), r.iLeft, r.iTop, BENCH_WIDTH - r.iRight, BENCH_HEIGHT - r.iBottom, r.iRight - r.iLeft, r.iBottom - r.iTop);
+	});
+	BenchmarkRectBlitter("Blt16BPPBufferHatchRect", [](BlitterBenchTarget& t, SGPRect& r)
+	{
+		Blt16BPPBufferHatchRect(t.buf, t.pitch, &r);
+	});
+	BenchmarkRectBlitter("Blt16BPPBufferLooseHatchRectWithColor", [](BlitterBenchTarget& t, SGPRect& r)
+	{
+		Blt16BPPBufferLooseHatchRectWithColor(t.buf, t.pitch, &r, BENCH_OUTLINE);
+	});
+	BenchmarkRectBlitter("Blt16BPPBufferFilterRect", [](BlitterBenchTarget& t, SGPRect& r)
+	{
+		Blt16BPPBufferFilterRect(t.buf, t.pitch, ShadeTable, &r);
+	});
+}
+
+
+// The blitters from flat 8 bit surfaces, with parts of an interface graphic
+static void BenchmarkSurfaceBlitters(UINT32& seed)
+{
+	char const* const file = INTERFACEDIR "/inventory_bottom_panel.sti";
+	SGPVSurface* vs;
+	try
+	{
+		vs = AddVideoSurfaceFromFile(file);
+	}
+	catch (...)
+	{
+		SLOGW("Blitter benchmark: failed to load %s", file);
+		return;
+	}
+	if (vs->BPP() != 8 || vs->Width() > BENCH_WIDTH || vs->Height() > BENCH_HEIGHT)
+	{
+		SLOGW("Blitter benchmark: %s is no 8 bit surface which fits into the buffer", file);
+		DeleteVideoSurface(vs);
+		return;
+	}
+
+	UINT16 const w = vs->Width();
+	UINT16 const h = vs->Height();
+	std::vector<SGPBox> boxes;
+	for (UINT i = 0; i != BENCH_BLITS; ++i)
+	{
+		SGPBox b;
+		b.x = NextSample(seed) % w;
+		b.y = NextSample(seed) % h;
+		b.w = 1 + NextSample(seed) % (w - b.x);
+		b.h = 1 + NextSample(seed) % (h - b.y);
+		boxes.push_back(b);
+	}
+
+	{ SGPVSurface::Lock l(vs);
+		UINT8* const src   = l.Buffer<UINT8>();
+		UINT32 const pitch = l.Pitch();
+
+		ClearTarget();
+		uint64_t start = SDL_GetPerformanceCounter();
+		for (UINT i = 0; i != BENCH_BLITS; ++i)
+		{
+			Blt8BPPDataTo16BPPBuffer(g_target.buf, g_target.pitch, vs, src, NextSample(seed) % (BENCH_WIDTH - w + 1), NextSample(seed) % (BENCH_HEIGHT - h + 1));
+		}
+		LogResult("Blt8BPPDataTo16BPPBuffer", "surface", BENCH_BLITS, (uint64_t)BENCH_BLITS * w * h, MSSince(start));
+
+		ClearTarget();
+		uint64_t pixels = 0;
+		start = SDL_GetPerformanceCounter();
+		for (SGPBox const& b : boxes)
+		{
+			Blt8BPPDataSubTo16BPPBuffer(g_target.buf, g_target.pitch, vs, src, pitch, b.x, b.y, &b);
+			pixels += b.w * b.h;
+		}
+		LogResult("Blt8BPPDataSubTo16BPPBuffer", "surface", BENCH_BLITS, pixels, MSSince(start));
+
+		ClearTarget();
+		pixels = 0;
+		start = SDL_GetPerformanceCounter();
+		for (SGPBox const& b : boxes)
+		{
+			Blt8BPPDataTo16BPPBufferHalf(g_target.buf, g_target.pitch, vs, src, pitch, b.x, b.y, &b);
+			pixels += (b.w / 2) * (b.h / 2);
+		}
+		LogResult("Blt8BPPDataTo16BPPBufferHalf", "surface", BENCH_BLITS, pixels, MSSince(start));
+	}
+	DeleteVideoSurface(vs);
+}
+
+
+static void AddSample(char const* const name, std::string const& file, UINT32& seed)
+{
+	BenchSample s;
+	s.name = name;
+	try
+	{
+		s.vo = AddVideoObjectFromFile(file.c_str());
+	}
+	catch (...)
+	{
+		SLOGW("Blitter benchmark: failed to load %s", file.c_str());
+		return;
+	}
+	SampleBlits(s, seed);
+	g_samples.push_back(s);
+}
+
+
+void BenchmarkBlitters()
+{
+	std::string const path = GCM->getScreenshotFolder() + "/blitbench.csv";
+	g_csv = fopen(path.c_str(), "w");
+	if (!g_csv) SLOGW("Failed to write the blitter benchmark %s", path.c_str());
+	if (g_csv) fputs("blitter,sample,blits,pixels,ms,mpixels_per_s\n", g_csv);
+
+	UINT32 seed = 1;
+	AddSample("tile",      GCM->getTilesetResourceName(0, "grass.sti"), seed);
+	AddSample("soldier",   ANIMSDIR "/s_merc/s_r_walk.sti",             seed);
+	AddSample("interface", INTERFACEDIR "/bottom_bar.sti",             seed);
+
+	std::vector<UINT16> buf(BENCH_WIDTH * BENCH_HEIGHT);
+	g_target.buf   = buf.data();
+	g_target.pitch = BENCH_WIDTH * sizeof(UINT16);
+	g_target.zbuf  = InitZBuffer(BENCH_WIDTH, BENCH_HEIGHT);
+
+	// The rectangle blitters clip to the global clipping rectangle
+	SGPRect old_clip;
+	GetClippingRect(&old_clip);
+	SGPRect all = { 0, 0, BENCH_WIDTH, BENCH_HEIGHT };
+	SetClippingRect(&all);
+
+	if (!g_samples.empty())
+	{
+		BenchmarkObjectBlitters();
+		BenchmarkRenderWorldBlitters();
+		BenchmarkRectBlitters();
+	}
+	BenchmarkSurfaceBlitters(seed);
+
+	SetClippingRect(&old_clip);
+	ShutdownZBuffer(g_target.zbuf);
+	g_target = BlitterBenchTarget();
+	for (BenchSample const& s : g_samples) DeleteVideoObject(s.vo);
+	g_samples.clear();
+	if (g_csv)
+	{
+		fclose(g_csv);
+		g_csv = 0;
+	}
+}
@@ -0,0 +1,33 @@
+#ifndef BLITTER_BENCHMARK_H
+#define BLITTER_BENCHMARK_H
+
+#include "Types.h"
+
+
+/* The buffers the blitter benchmark draws into and the parameters of the
+ * current blit. */
+struct BlitterBenchTarget
+{
+	UINT16* buf;
+	UINT32  pitch; // in bytes
+	UINT16* zbuf;  // as large as buf
+	UINT16  z;     // rises with every blit, so the Z tests mostly pass, like when rendering the world
+	SGPRect clip;
+};
+
+typedef void (*BlitterBenchFn)(BlitterBenchTarget&, SGPVObject*, INT32 x, INT32 y, UINT16 index);
+
+/* Times a blitter of video objects on each of the sample objects. Unclipped
+ * blitters only get blits which fit into the buffer, clipped ones get random
+ * clipping rectangles and positions partly outside of them. Every blitter gets
+ * the same blits. Only to be called while BenchmarkBlitters() runs. */
+void BenchmarkObjectBlitter(char const* name, bool clipped, BlitterBenchFn);
+
+/* Loads a tile, a soldier animation and an interface graphic and times every
+ * blitter of VObject_Blitters.h and the ones of the world renderer on them, at
+ * positions and with clipping rectangles picked by a fixed sequence. The
+ * million pixels per second of each blitter are logged and written to
+ * blitbench.csv in the screenshot folder for comparing runs. */
+void BenchmarkBlitters();
+
+#endif
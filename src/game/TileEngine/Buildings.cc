@@ -13,8 +13,12 @@
 #include "Sys_Globals.h"
 #include "WorldMan.h"
 #include "Logger.h"
+#include "FileMan.h"
 
 #include <algorithm>
+#include <stdexcept>
+#include <string.h>
+#include <vector>
 
 #define ROOF_LOCATION_CHANCE 8
 
@@ -431,15 +435,14 @@ INT16 FindClosestClimbPoint( INT16 sStartGridNo, INT16 sDesiredGridNo, BOOLEAN f
 
 	for ( ubLoop = 0; ubLoop < ubNumClimbSpots; ubLoop++ )
 	{
-		if (WhoIsThere2(pBuilding->sUpClimbSpots[ubLoop],   0) == NULL &&
+		// only look for somebody in the way of spots which would be closer
+		sDistance = PythSpacesAway( sStartGridNo, psClimbSpots[ ubLoop ] );
+		if (sDistance < sClosestDistance &&
+				WhoIsThere2(pBuilding->sUpClimbSpots[ubLoop],   0) == NULL &&
 				WhoIsThere2(pBuilding->sDownClimbSpots[ubLoop], 1) == NULL)
 		{
-			sDistance = PythSpacesAway( sStartGridNo, psClimbSpots[ ubLoop ] );
-			if (sDistance < sClosestDistance )
-			{
-				sClosestDistance = sDistance;
-				sClosestSpot = psClimbSpots[ ubLoop ];
-			}
+			sClosestDistance = sDistance;
+			sClosestSpot = psClimbSpots[ ubLoop ];
 		}
 	}
 
@@ -458,3 +461,41 @@ BOOLEAN SameBuilding( INT16 sGridNo1, INT16 sGridNo2 )
 	}
 	return gubBuildingInfo[sGridNo1] == gubBuildingInfo[sGridNo2];
 }
+
+
+void SaveBuildings(HWFILE const f)
+{
+	FileWrite(f, &gubNumberOfBuildings, sizeof(gubNumberOfBuildings));
+	for (UINT8 i = 1; i <= gubNumberOfBuildings; ++i)
+	{
+		BUILDING const& b = gBuildings[i];
+		FileWrite(f, &b.ubNumClimbSpots, sizeof(b.ubNumClimbSpots));
+		FileWrite(f, b.sUpClimbSpots,    sizeof(*b.sUpClimbSpots)   * b.ubNumClimbSpots);
+		FileWrite(f, b.sDownClimbSpots,  sizeof(*b.sDownClimbSpots) * b.ubNumClimbSpots);
+	}
+	FileWrite(f, gubBuildingInfo, sizeof(gubBuildingInfo));
+}
+
+
+void LoadBuildings(HWFILE const f)
+{
+	UINT8 n_buildings;
+	FileRead(f, &n_buildings, sizeof(n_buildings));
+	if (n_buildings >= MAX_BUILDINGS) throw std::runtime_error("Too many buildings");
+
+	BUILDING buildings[MAX_BUILDINGS] = {};
+	for (UINT8 i = 1; i <= n_buildings; ++i)
+	{
+		BUILDING& b = buildings[i];
+		FileRead(f, &b.ubNumClimbSpots, sizeof(b.ubNumClimbSpots));
+		if (b.ubNumClimbSpots > MAX_CLIMBSPOTS_PER_BUILDING) throw std::runtime_error("Too many climb spots");
+		FileRead(f, b.sUpClimbSpots,   sizeof(*b.sUpClimbSpots)   * b.ubNumClimbSpots);
+		FileRead(f, b.sDownClimbSpots, sizeof(*b.sDownClimbSpots) * b.ubNumClimbSpots);
+	}
+	std::vector<UINT8> info(WORLD_MAX);
+	FileRead(f, info.data(), WORLD_MAX);
+
+	gubNumberOfBuildings = n_buildings;
+	std::copy(buildings, buildings + MAX_BUILDINGS, gBuildings);
+	memcpy(gubBuildingInfo, info.data(), sizeof(gubBuildingInfo));
+}
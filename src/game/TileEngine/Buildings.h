@@ -27,4 +27,12 @@ void GenerateBuildings( void );
 INT16 FindClosestClimbPoint( INT16 sStartGridNo, INT16 sDesiredGridNo, BOOLEAN fClimbUp );
 BOOLEAN SameBuilding( INT16 sGridNo1, INT16 sGridNo2 );
 
+/* Writes the generated buildings, their climb points and the building of every
+ * tile. */
+void SaveBuildings(HWFILE);
+
+/* Reads the buildings written by SaveBuildings(). The buildings are only
+ * replaced if all of them could be read. */
+void LoadBuildings(HWFILE);
+
 #endif
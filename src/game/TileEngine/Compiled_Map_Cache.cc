@@ -0,0 +1,263 @@
+#include "Compiled_Map_Cache.h"
+
+#include "Buildings.h"
+#include "ContentManager.h"
+#include "FileMan.h"
+#include "GameInstance.h"
+#include "Logger.h"
+#include "Map_Edgepoints.h"
+#include "WorldDat.h"
+#include "WorldDef.h"
+
+#include <map>
+#include <stdexcept>
+#include <stdio.h>
+#include <string.h>
+#include <string>
+
+
+#define COMPILED_MAP_DIR     "compiled_maps"
+#define COMPILED_MAP_VERSION 1
+
+
+/* The file starts with this header, followed by the terrain ID of every tile
+ * and the movement costs. */
+struct CompiledMapHeader
+{
+	char     id[4];
+	UINT32   version;
+	UINT32   world_max;
+	UINT32   padding;
+	uint64_t key;
+};
+
+
+static CompiledMapHeader CurrentHeader(uint64_t const key, char const* const id = "CMAP")
+{
+	CompiledMapHeader const h =
+	{
+		{ id[0], id[1], id[2], id[3] },
+		COMPILED_MAP_VERSION,
+		WORLD_MAX,
+		0,
+		key
+	};
+	return h;
+}
+
+
+static std::string CompiledMapPath(uint64_t const key, char const* const ext = "cmap")
+{
+	char name[32];
+	snprintf(name, lengthof(name), "%016llx.%s", (unsigned long long)key, ext);
+	return FileMan::joinPaths(COMPILED_MAP_DIR, name);
+}
+
+
+// FNV-1a
+static uint64_t HashBytes(uint64_t h, void const* const data, size_t const n)
+{
+	for (BYTE const* i = static_cast<BYTE const*>(data), * const end = i + n; i != end; ++i)
+	{
+		h = (h ^ *i) * 1099511628211ULL;
+	}
+	return h;
+}
+
+
+/* Hashes what the compiled data depends on besides the map, the tile surfaces
+ * of the tileset and their structure files. They may come from another game
+ * version or a mod than the ones the compiled data was made with, as the cache
+ * is shared by them. The data does not change while the game runs, so every
+ * tileset is hashed once. */
+static uint64_t TilesetDataKey(TileSetID const id)
+{
+	static std::map<TileSetID, uint64_t> keys;
+	std::map<TileSetID, uint64_t>::const_iterator const i = keys.find(id);
+	if (i != keys.end()) return i->second;
+
+	uint64_t h = 14695981039346656037ULL;
+	for (UINT32 type = 0; type != NUMBEROFTILETYPES; ++type)
+	{
+		// The same fallback to the first tileset as when loading it
+		char const* filename = gTilesets[id].TileSurfaceFilenames[type];
+		TileSetID   tileset  = id;
+		if (filename[0] == '\0')
+		{
+			filename = gTilesets[GENERIC_1].TileSurfaceFilenames[type];
+			tileset  = GENERIC_1;
+		}
+		if (filename[0] == '\0') continue;
+
+		std::string const image = GCM->getTilesetResourceName(tileset, filename);
+		h = HashBytes(h, image.c_str(), image.size() + 1);
+		if (!GCM->doesGameResExists(image)) continue;
+		{ // The number of tiles of the surface follows its image
+			AutoSGPFile f(GCM->openGameResForReading(image));
+			UINT32 const size = FileGetSize(f);
+			h = HashBytes(h, &size, sizeof(size));
+		}
+
+		std::string const structure = FileMan::replaceExtension(image, ".jsd");
+		if (!GCM->doesGameResExists(structure)) continue;
+		AutoSGPFile    f(GCM->openGameResForReading(structure));
+		FileView const view(f);
+		h = HashBytes(h, view.data(), view.size());
+	}
+
+	keys[id] = h;
+	return h;
+}
+
+
+uint64_t CompiledMapKey(SGPFile* const f, TileSetID const tileset)
+{
+	FileView const view(f);
+
+	// The format version is mixed in first, so a new version of the compiled
+	// data does not pick up old files
+	uint64_t h = 14695981039346656037ULL;
+	h = (h ^ COMPILED_MAP_VERSION) * 1099511628211ULL;
+	uint64_t const tileset_key = TilesetDataKey(tileset);
+	h = HashBytes(h, &tileset_key, sizeof(tileset_key));
+	return HashBytes(h, view.data(), view.size());
+}
+
+
+bool LoadCompiledMap(uint64_t const key)
+try
+{
+	AutoSGPFile    f(GCM->openUserPrivateFileForReading(CompiledMapPath(key)));
+	FileView const view(f);
+	FileViewReader r(view);
+
+	CompiledMapHeader header;
+	r.Read(&header, sizeof(header));
+	CompiledMapHeader const expected = CurrentHeader(key);
+	if (memcmp(&header, &expected, sizeof(header)) != 0)
+	{
+		SLOGI("Ignoring the compiled map %s, it was made for a different version", CompiledMapPath(key).c_str());
+		return false;
+	}
+
+	// Read everything before touching the world, so a truncated file changes nothing
+	BYTE const* const terrain = r.Take(WORLD_MAX);
+	BYTE const* const costs   = r.Take(sizeof(gubWorldMovementCosts));
+
+	for (UINT i = 0; i != WORLD_MAX; ++i) gpWorldLevelData[i].ubTerrainID = terrain[i];
+	memcpy(gubWorldMovementCosts, costs, sizeof(gubWorldMovementCosts));
+	++guiMovementCostsVersion;
+	return true;
+}
+catch (const std::exception& e)
+{
+	// A missing compiled map just means compiling it
+	SLOGD("No compiled map loaded: %s", e.what());
+	return false;
+}
+
+
+void SaveCompiledMap(uint64_t const key)
+try
+{
+	FileMan::createDir(COMPILED_MAP_DIR);
+	AutoSGPFile f(FileMan::openForWriting(CompiledMapPath(key).c_str()));
+
+	CompiledMapHeader const header = CurrentHeader(key);
+	FileWrite(f, &header, sizeof(header));
+
+	BYTE terrain[WORLD_MAX];
+	for (UINT i = 0; i != WORLD_MAX; ++i) terrain[i] = gpWorldLevelData[i].ubTerrainID;
+	FileWrite(f, terrain, sizeof(terrain));
+	FileWrite(f, gubWorldMovementCosts, sizeof(gubWorldMovementCosts));
+}
+catch (const std::exception& e)
+{
+	SLOGW("Failed to write the compiled map: %s", e.what());
+}
+
+
+/* The generated edgepoints are kept in a file of their own, as most maps store
+ * theirs, in the format of the map file. */
+bool LoadCompiledEdgepoints(uint64_t const key)
+try
+{
+	AutoSGPFile f(GCM->openUserPrivateFileForReading(CompiledMapPath(key, "cedg")));
+
+	CompiledMapHeader header;
+	FileRead(f, &header, sizeof(header));
+	CompiledMapHeader const expected = CurrentHeader(key, "CEDG");
+	if (memcmp(&header, &expected, sizeof(header)) != 0)
+	{
+		SLOGI("Ignoring the compiled edgepoints %s, they were made for a different version", CompiledMapPath(key, "cedg").c_str());
+		return false;
+	}
+
+	LoadGeneratedMapEdgepoints(f);
+	return true;
+}
+catch (const std::exception& e)
+{
+	// Whatever was read of a truncated file is dropped, they are generated anew
+	TrashMapEdgepoints();
+	SLOGD("No compiled edgepoints loaded: %s", e.what());
+	return false;
+}
+
+
+void SaveCompiledEdgepoints(uint64_t const key)
+try
+{
+	FileMan::createDir(COMPILED_MAP_DIR);
+	AutoSGPFile f(FileMan::openForWriting(CompiledMapPath(key, "cedg").c_str()));
+
+	CompiledMapHeader const header = CurrentHeader(key, "CEDG");
+	FileWrite(f, &header, sizeof(header));
+	SaveMapEdgepoints(f);
+}
+catch (const std::exception& e)
+{
+	SLOGW("Failed to write the compiled edgepoints: %s", e.what());
+}
+
+
+/* The climb points are chosen at random once per map, not on every load of
+ * it. */
+bool LoadCompiledBuildings(uint64_t const key)
+try
+{
+	AutoSGPFile f(GCM->openUserPrivateFileForReading(CompiledMapPath(key, "cbld")));
+
+	CompiledMapHeader header;
+	FileRead(f, &header, sizeof(header));
+	CompiledMapHeader const expected = CurrentHeader(key, "CBLD");
+	if (memcmp(&header, &expected, sizeof(header)) != 0)
+	{
+		SLOGI("Ignoring the compiled buildings %s, they were made for a different version", CompiledMapPath(key, "cbld").c_str());
+		return false;
+	}
+
+	LoadBuildings(f);
+	return true;
+}
+catch (const std::exception& e)
+{
+	SLOGD("No compiled buildings loaded: %s", e.what());
+	return false;
+}
+
+
+void SaveCompiledBuildings(uint64_t const key)
+try
+{
+	FileMan::createDir(COMPILED_MAP_DIR);
+	AutoSGPFile f(FileMan::openForWriting(CompiledMapPath(key, "cbld").c_str()));
+
+	CompiledMapHeader const header = CurrentHeader(key, "CBLD");
+	FileWrite(f, &header, sizeof(header));
+	SaveBuildings(f);
+}
+catch (const std::exception& e)
+{
+	SLOGW("Failed to write the compiled buildings: %s", e.what());
+}
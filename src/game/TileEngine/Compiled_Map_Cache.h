@@ -0,0 +1,41 @@
+#ifndef COMPILED_MAP_CACHE_H
+#define COMPILED_MAP_CACHE_H
+
+#include "Types.h"
+#include "World_Tileset_Enums.h"
+
+#include <stdint.h>
+
+
+/* Keeps the data compiled from a loaded map, the terrain IDs and the movement
+ * costs, in a file under a hash of the map file and its tileset, so loading
+ * the same map again reads them instead of compiling them. */
+
+/* Hashes the whole map file and the tile surfaces and structure files of its
+ * tileset. The file position is not changed. */
+uint64_t CompiledMapKey(SGPFile*, TileSetID);
+
+/* Reads the terrain IDs and movement costs stored under the key into the
+ * world. Returns false and leaves the world alone if there are none. */
+bool LoadCompiledMap(uint64_t key);
+
+/* Stores the terrain IDs and movement costs of the world under the key. */
+void SaveCompiledMap(uint64_t key);
+
+/* Reads the edgepoints generated for the map stored under the key. Returns
+ * false, with no edgepoints, if there are none. */
+bool LoadCompiledEdgepoints(uint64_t key);
+
+/* Stores the generated edgepoints of the world under the key, next to its
+ * terrain IDs and movement costs. */
+void SaveCompiledEdgepoints(uint64_t key);
+
+/* Reads the buildings and climb points generated for the map stored under the
+ * key. Returns false and leaves the buildings alone if there are none. */
+bool LoadCompiledBuildings(uint64_t key);
+
+/* Stores the generated buildings and climb points of the world under the
+ * key. */
+void SaveCompiledBuildings(uint64_t key);
+
+#endif
@@ -0,0 +1,167 @@
+#include "Cover_Map.h"
+#include "Animation_Control.h"
+#include "Isometric_Utils.h"
+#include "LOS.h"
+#include "Structure.h"
+#include "Structure_Internals.h"
+#include "WorldDef.h"
+
+#include <algorithm>
+
+
+// Voxel heights of the heads looked at, see LOS.h
+static UINT8 const g_stance_height[NUM_COVER_STANCES] =
+{
+	CONVERT_HEIGHTUNITS_TO_INDEX((INT32)PRONE_LOS_POS),
+	CONVERT_HEIGHTUNITS_TO_INDEX((INT32)CROUCHED_LOS_POS),
+	CONVERT_HEIGHTUNITS_TO_INDEX((INT32)STANDING_LOS_POS)
+};
+
+static UINT8 g_cover[WORLD_MAX][NUM_WORLD_DIRECTIONS][NUM_COVER_STANCES];
+static bool  g_cover_valid[WORLD_MAX]; // false until the tile is computed after a change
+
+
+// Density of the densest fixed structure on the ground per voxel of a tile
+typedef UINT8 TileDensity[NUM_COVER_STANCES][PROFILE_X_SIZE][PROFILE_Y_SIZE];
+
+
+static void GetTileDensity(GridNo const g, TileDensity& d)
+{
+	std::fill_n(&d[0][0][0], sizeof(d), 0);
+	for (STRUCTURE const* s = gpWorldLevelData[g].pStructureHead; s; s = s->pNext)
+	{
+		if (s->sCubeOffset != STRUCTURE_ON_GROUND || !s->pShape) continue;
+		if (s->fFlags & (STRUCTURE_PERSON | STRUCTURE_CORPSE | STRUCTURE_ROOF)) continue;
+
+		UINT8   const density = s->pDBStructureRef->pDBStructure->ubDensity;
+		PROFILE const& shape  = *s->pShape;
+		for (UINT stance = 0; stance != NUM_COVER_STANCES; ++stance)
+		{
+			UINT8 const z = g_stance_height[stance];
+			for (UINT x = 0; x != PROFILE_X_SIZE; ++x)
+			{
+				for (UINT y = 0; y != PROFILE_Y_SIZE; ++y)
+				{
+					if (!(shape[x][y] & AtHeight[z])) continue;
+					UINT8& v = d[stance][x][y];
+					v = std::max(v, density);
+				}
+			}
+		}
+	}
+}
+
+
+/* The voxels of a side are indexed by lane, i.e. the position along the side,
+ * and depth, 0 being the row at the side and increasing away from it. */
+static UINT8 SideVoxel(TileDensity const& d, UINT const stance, UINT8 const side, UINT const lane, UINT const depth)
+{
+	switch (side)
+	{
+		case NORTH: return d[stance][lane][depth];
+		case SOUTH: return d[stance][lane][PROFILE_Y_SIZE - 1 - depth];
+		case WEST:  return d[stance][depth][lane];
+		default:    return d[stance][PROFILE_X_SIZE - 1 - depth][lane]; // EAST
+	}
+}
+
+
+static GridNo Neighbour(GridNo const g, UINT8 const dir)
+{
+	INT16 const x = g % WORLD_COLS;
+	INT16 const y = g / WORLD_COLS;
+	switch (dir)
+	{
+		case NORTH: return y != 0              ? g - WORLD_COLS : NOWHERE;
+		case SOUTH: return y != WORLD_ROWS - 1 ? g + WORLD_COLS : NOWHERE;
+		case WEST:  return x != 0              ? g - 1          : NOWHERE;
+		default:    return x != WORLD_COLS - 1 ? g + 1          : NOWHERE; // EAST
+	}
+}
+
+
+static void ComputeCover(GridNo const g)
+{
+	static UINT8 const sides[] = { NORTH, EAST, SOUTH, WEST };
+
+	TileDensity here;
+	GetTileDensity(g, here);
+
+	UINT8 (&cover)[NUM_WORLD_DIRECTIONS][NUM_COVER_STANCES] = g_cover[g];
+	for (UINT8 const side : sides)
+	{
+		// A shot in from this side crosses the row of the tile along the side and
+		// the whole neighbouring tile in its lane
+		GridNo const n = Neighbour(g, side);
+		TileDensity there;
+		if (n != NOWHERE)
+		{
+			GetTileDensity(n, there);
+		}
+		else
+		{
+			std::fill_n(&there[0][0][0], sizeof(there), 0);
+		}
+
+		UINT8 const opposite = OppositeDirection(side);
+		for (UINT stance = 0; stance != NUM_COVER_STANCES; ++stance)
+		{
+			UINT total = 0;
+			for (UINT lane = 0; lane != PROFILE_X_SIZE; ++lane)
+			{
+				UINT8 blocked = SideVoxel(here, stance, side, lane, 0);
+				for (UINT depth = 0; depth != PROFILE_Y_SIZE; ++depth)
+				{
+					blocked = std::max(blocked, SideVoxel(there, stance, opposite, lane, depth));
+				}
+				total += std::min<UINT>(blocked, 100);
+			}
+			cover[side][stance] = total / PROFILE_X_SIZE;
+		}
+	}
+
+	for (UINT stance = 0; stance != NUM_COVER_STANCES; ++stance)
+	{
+		cover[NORTHEAST][stance] = (cover[NORTH][stance] + cover[EAST][stance]) / 2;
+		cover[SOUTHEAST][stance] = (cover[SOUTH][stance] + cover[EAST][stance]) / 2;
+		cover[SOUTHWEST][stance] = (cover[SOUTH][stance] + cover[WEST][stance]) / 2;
+		cover[NORTHWEST][stance] = (cover[NORTH][stance] + cover[WEST][stance]) / 2;
+	}
+	g_cover_valid[g] = true;
+}
+
+
+void BuildCoverMap()
+{
+	for (GridNo g = 0; g != WORLD_MAX; ++g) ComputeCover(g);
+}
+
+
+void CoverMapStructuresChanged(GridNo const g)
+{
+	// The tile's own sides and the sides of its neighbours facing it
+	g_cover_valid[g] = false;
+	for (UINT8 dir = NORTH; dir != NUM_WORLD_DIRECTIONS; dir += 2)
+	{
+		GridNo const n = Neighbour(g, dir);
+		if (n != NOWHERE) g_cover_valid[n] = false;
+	}
+}
+
+
+UINT8 CoverFromDirection(GridNo const g, UINT8 const direction, CoverStance const stance)
+{
+	if (!g_cover_valid[g]) ComputeCover(g);
+	return g_cover[g][direction][stance];
+}
+
+
+CoverStance CoverStanceOfAnimHeight(UINT8 const anim_height)
+{
+	switch (anim_height)
+	{
+		case ANIM_PRONE:  return COVER_PRONE;
+		case ANIM_CROUCH: return COVER_CROUCHED;
+		default:          return COVER_STANDING;
+	}
+}
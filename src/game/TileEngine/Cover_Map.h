@@ -0,0 +1,36 @@
+#ifndef COVER_MAP_H
+#define COVER_MAP_H
+
+#include "JA2Types.h"
+
+
+/* How much the structures on the ground around a tile protect a soldier on it
+ * from shots coming in from each of the 8 directions, at the height of his head
+ * in each stance. For a side of the tile the voxel columns along that side are
+ * looked at, as far as the neighbouring tile reaches; a column counts with the
+ * density of the densest structure in it at that height. The diagonal
+ * directions get the average of the two sides they lie between. People and
+ * corpses are left out, so the map only changes with the fixed structures. */
+enum CoverStance
+{
+	COVER_PRONE,
+	COVER_CROUCHED,
+	COVER_STANDING,
+	NUM_COVER_STANCES
+};
+
+/* Computes the map for the whole world, after it was loaded. */
+void BuildCoverMap();
+
+/* Called by the structure code whenever a structure, which is no person, is
+ * added to or removed from the tile. The map is brought up to date around the
+ * tile when it is next looked at. */
+void CoverMapStructuresChanged(GridNo);
+
+/* Protection in percent towards the direction, 100 behind solid walls. */
+UINT8 CoverFromDirection(GridNo, UINT8 direction, CoverStance);
+
+/* The stance of an animation height, ANIM_STAND etc. */
+CoverStance CoverStanceOfAnimHeight(UINT8 anim_height);
+
+#endif
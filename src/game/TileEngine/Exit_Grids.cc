@@ -20,6 +20,9 @@
 #include "SaveLoadMap.h"
 #include "Text.h"
 
+#include <bitset>
+#include <vector>
+
 
 BOOLEAN gfLoadingExitGrids = FALSE;
 
@@ -28,6 +31,12 @@ EXITGRID		gExitGrid	= {0,1,1,0};
 
 BOOLEAN gfOverrideInsertionWithExitGrid = FALSE;
 
+/* The exit grids of the world by gridno. The level nodes stay, the renderer and
+ * the editor's undo go by them, but looking up the table spares walking the
+ * shadow list of a tile and decoding the exit grid from it. */
+static EXITGRID               g_exit_grids[WORLD_MAX];
+static std::bitset<WORLD_MAX> g_exit_grid_at;
+
 
 static INT32 ConvertExitGridToINT32(EXITGRID* pExitGrid)
 {
@@ -51,17 +60,10 @@ static void ConvertINT32ToExitGrid(INT32 iExitGridInfo, EXITGRID* pExitGrid)
 
 BOOLEAN	GetExitGrid( UINT16 usMapIndex, EXITGRID *pExitGrid )
 {
-	LEVELNODE *pShadow;
-	pShadow = gpWorldLevelData[ usMapIndex ].pShadowHead;
-	//Search through object layer for an exitgrid
-	while( pShadow )
+	if (usMapIndex < WORLD_MAX && g_exit_grid_at.test(usMapIndex))
 	{
-		if ( pShadow->uiFlags & LEVELNODE_EXITGRID )
-		{
-			ConvertINT32ToExitGrid( pShadow->iExitGridInfo, pExitGrid );
-			return TRUE;
-		}
-		pShadow = pShadow->pNext;
+		*pExitGrid = g_exit_grids[usMapIndex];
+		return TRUE;
 	}
 	pExitGrid->ubGotoSectorX = 0;
 	pExitGrid->ubGotoSectorY = 0;
@@ -72,18 +74,27 @@ BOOLEAN	GetExitGrid( UINT16 usMapIndex, EXITGRID *pExitGrid )
 
 BOOLEAN	ExitGridAtGridNo( UINT16 usMapIndex )
 {
-	LEVELNODE *pShadow;
-	pShadow = gpWorldLevelData[ usMapIndex ].pShadowHead;
-	//Search through object layer for an exitgrid
-	while( pShadow )
+	return usMapIndex < WORLD_MAX && g_exit_grid_at.test(usMapIndex);
+}
+
+
+void UpdateExitGridOfTile(INT32 const map_idx)
+{
+	// Search through object layer for an exitgrid
+	for (LEVELNODE const* i = gpWorldLevelData[map_idx].pShadowHead; i; i = i->pNext)
 	{
-		if ( pShadow->uiFlags & LEVELNODE_EXITGRID )
-		{
-			return TRUE;
-		}
-		pShadow = pShadow->pNext;
+		if (!(i->uiFlags & LEVELNODE_EXITGRID)) continue;
+		ConvertINT32ToExitGrid(i->iExitGridInfo, &g_exit_grids[map_idx]);
+		g_exit_grid_at.set(map_idx);
+		return;
 	}
-	return FALSE;
+	g_exit_grid_at.reset(map_idx);
+}
+
+
+void TrashExitGrids()
+{
+	g_exit_grid_at.reset();
 }
 
 
@@ -95,6 +106,7 @@ void AddExitGridToWorld(INT32 const map_idx, EXITGRID* const xg)
 		if (!(i->uiFlags & LEVELNODE_EXITGRID)) continue;
 		// We have found an existing exitgrid in this node, so replace it with the new information.
 		i->iExitGridInfo = ConvertExitGridToINT32(xg);
+		UpdateExitGridOfTile(map_idx);
 		return;
 	}
 
@@ -102,6 +114,7 @@ void AddExitGridToWorld(INT32 const map_idx, EXITGRID* const xg)
 	// Fill in the information for the new exitgrid levelnode.
 	n->iExitGridInfo  = ConvertExitGridToINT32(xg);
 	n->uiFlags       |= LEVELNODE_EXITGRID | LEVELNODE_HIDDEN;
+	UpdateExitGridOfTile(map_idx);
 
 	// Add the exit grid to the sector, only if ApplyMapChangesToMapTempFile is held.
 	if (!gfEditMode && !gfLoadingExitGrids)
@@ -215,7 +228,39 @@ UINT16 FindGridNoFromSweetSpotCloseToExitGrid(const SOLDIERTYPE* const pSoldier,
 	UINT8 ubSaveNPCAPBudget;
 	UINT8 ubSaveNPCDistLimit;
 	EXITGRID	ExitGrid;
-	UINT8	ubGotoSectorX, ubGotoSectorY, ubGotoSectorZ;
+
+	// OK, Get an exit grid ( if possible )
+	if ( !GetExitGrid( sSweetGridNo, &ExitGrid ) )
+	{
+		return( NOWHERE );
+	}
+
+	sTop		= ubRadius;
+	sBottom = -ubRadius;
+	sLeft   = - ubRadius;
+	sRight  = ubRadius;
+
+	/* Collect the exit grids to the same place around the soldier first. Only
+	 * they are candidates, so without any the path search is not needed. */
+	std::vector<INT16> candidates;
+	for( cnt1 = sBottom; cnt1 <= sTop; cnt1++ )
+	{
+		leftmost = ( ( pSoldier->sGridNo + ( WORLD_COLS * cnt1 ) )/ WORLD_COLS ) * WORLD_COLS;
+
+		for( cnt2 = sLeft; cnt2 <= sRight; cnt2++ )
+		{
+			sGridNo = pSoldier->sGridNo + ( WORLD_COLS * cnt1 ) + cnt2;
+			if ( sGridNo < 0 || sGridNo >= WORLD_MAX || sGridNo < leftmost || sGridNo >= ( leftmost + WORLD_COLS ) ) continue;
+			if ( !g_exit_grid_at.test( sGridNo ) ) continue;
+
+			// Is it the same exitgrid?
+			EXITGRID const& xg = g_exit_grids[sGridNo];
+			if ( xg.ubGotoSectorX != ExitGrid.ubGotoSectorX || xg.ubGotoSectorY != ExitGrid.ubGotoSectorY || xg.ubGotoSectorZ != ExitGrid.ubGotoSectorZ ) continue;
+
+			candidates.push_back( sGridNo );
+		}
+	}
+	if ( candidates.empty() ) return NOWHERE;
 
 	// Turn off at end of function...
 	gfPlotPathToExitGrid = TRUE;
@@ -234,23 +279,6 @@ UINT16 FindGridNoFromSweetSpotCloseToExitGrid(const SOLDIERTYPE* const pSoldier,
 	soldier.bTeam = 1;
 	soldier.sGridNo = pSoldier->sGridNo;
 
-	// OK, Get an exit grid ( if possible )
-	if ( !GetExitGrid( sSweetGridNo, &ExitGrid ) )
-	{
-		return( NOWHERE );
-	}
-
-	// Copy our dest values.....
-	ubGotoSectorX = ExitGrid.ubGotoSectorX;
-	ubGotoSectorY = ExitGrid.ubGotoSectorY;
-	ubGotoSectorZ = ExitGrid.ubGotoSectorZ;
-
-
-	sTop		= ubRadius;
-	sBottom = -ubRadius;
-	sLeft   = - ubRadius;
-	sRight  = ubRadius;
-
 	//clear the mapelements of potential residue MAPELEMENT_REACHABLE flags
 	//in the square region.
 	for( cnt1 = sBottom; cnt1 <= sTop; cnt1++ )
@@ -272,37 +300,20 @@ UINT16 FindGridNoFromSweetSpotCloseToExitGrid(const SOLDIERTYPE* const pSoldier,
 	uiLowestRange = 999999;
 
 	INT16 sLowestGridNo = NOWHERE;
-	for( cnt1 = sBottom; cnt1 <= sTop; cnt1++ )
+	for (INT16 const sGridNo : candidates)
 	{
-		leftmost = ( ( pSoldier->sGridNo + ( WORLD_COLS * cnt1 ) )/ WORLD_COLS ) * WORLD_COLS;
+		if ( !( gpWorldLevelData[ sGridNo ].uiFlags & MAPELEMENT_REACHABLE ) ) continue;
 
-		for( cnt2 = sLeft; cnt2 <= sRight; cnt2++ )
+		// Go on sweet stop
+		// ATE: Added this check because for all intensive purposes, cavewalls will be not an OKDEST
+		// but we want thenm too...
+		if ( !NewOKDestination( pSoldier, sGridNo, TRUE, pSoldier->bLevel ) ) continue;
+
+		uiRange = GetRangeInCellCoordsFromGridNoDiff( pSoldier->sGridNo, sGridNo );
+		if ( uiRange < uiLowestRange )
 		{
-			sGridNo = pSoldier->sGridNo + ( WORLD_COLS * cnt1 ) + cnt2;
-			if ( sGridNo >=0 && sGridNo < WORLD_MAX && sGridNo >= leftmost && sGridNo < ( leftmost + WORLD_COLS ) &&
-				gpWorldLevelData[ sGridNo ].uiFlags & MAPELEMENT_REACHABLE )
-			{
-				// Go on sweet stop
-				// ATE: Added this check because for all intensive purposes, cavewalls will be not an OKDEST
-				// but we want thenm too...
-				if ( NewOKDestination( pSoldier, sGridNo, TRUE, pSoldier->bLevel ) )
-				{
-					if ( GetExitGrid( sGridNo, &ExitGrid ) )
-					{
-						// Is it the same exitgrid?
-						if ( ExitGrid.ubGotoSectorX == ubGotoSectorX && ExitGrid.ubGotoSectorY == ubGotoSectorY && ExitGrid.ubGotoSectorZ == ubGotoSectorZ )
-						{
-							uiRange = GetRangeInCellCoordsFromGridNoDiff( pSoldier->sGridNo, sGridNo );
-
-							if ( uiRange < uiLowestRange )
-							{
-								sLowestGridNo = sGridNo;
-								uiLowestRange = uiRange;
-							}
-						}
-					}
-				}
-			}
+			sLowestGridNo = sGridNo;
+			uiLowestRange = uiRange;
 		}
 	}
 	gubNPCAPBudget = ubSaveNPCAPBudget;
@@ -322,7 +333,6 @@ UINT16 FindClosestExitGrid( SOLDIERTYPE *pSoldier, INT16 sSrcGridNo, INT8 ubRadi
 	INT16		sGridNo;
 	INT32		uiRange, uiLowestRange = 999999;
 	INT32					leftmost;
-	EXITGRID	ExitGrid;
 
 
 	sTop		= ubRadius;
@@ -343,7 +353,7 @@ UINT16 FindClosestExitGrid( SOLDIERTYPE *pSoldier, INT16 sSrcGridNo, INT8 ubRadi
 			sGridNo = sSrcGridNo + ( WORLD_COLS * cnt1 ) + cnt2;
 			if( sGridNo >=0 && sGridNo < WORLD_MAX && sGridNo >= leftmost && sGridNo < ( leftmost + WORLD_COLS ) )
 			{
-				if ( GetExitGrid( sGridNo, &ExitGrid ) )
+				if ( g_exit_grid_at.test( sGridNo ) )
 				{
 					uiRange = GetRangeInCellCoordsFromGridNoDiff( sSrcGridNo, sGridNo );
 
@@ -18,6 +18,13 @@ BOOLEAN	GetExitGrid( UINT16 usMapIndex, EXITGRID *pExitGrid );
 void AddExitGridToWorld( INT32 iMapIndex, EXITGRID *pExitGrid );
 void RemoveExitGridFromWorld( INT32 iMapIndex );
 
+/* Rereads the exit grid of the tile from its level nodes into the exit grid
+ * table. For code which removes or swaps shadow level nodes. */
+void UpdateExitGridOfTile(INT32 map_idx);
+
+// Forgets all exit grids, when the world is trashed
+void TrashExitGrids();
+
 void SaveExitGrids( HWFILE fp, UINT16 usNumExitGrids );
 
 void LoadExitGrids(HWFILE);
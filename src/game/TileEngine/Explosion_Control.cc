@@ -64,6 +64,8 @@
 #include "GameInstance.h"
 #include "Logger.h"
 
+#include <vector>
+
 extern INT8 gbSAMGraphicList[NUMBER_OF_SAMS];
 
 
@@ -1527,46 +1529,15 @@ static void GetRayStopInfo(UINT32 uiNewSpot, UINT8 ubDir, INT8 bLevel, BOOLEAN f
 }
 
 
-void SpreadEffect(const INT16 sGridNo, const UINT8 ubRadius, const UINT16 usItem, SOLDIERTYPE* const owner, const BOOLEAN fSubsequent, const INT8 bLevel, const SMOKEEFFECT* const smoke)
+/* Casts the rays of an explosion of the given range, in half tiles, from the
+ * main spot and calls visit(gridno, distance) for every other tile they reach,
+ * in the order they reach it. */
+template<typename Visit>
+static void WalkExplosionRays(INT16 const sGridNo, INT16 const sRange, INT8 const bLevel, BOOLEAN const fSmokeEffect, Visit&& visit)
 {
-	INT32   uiNewSpot, uiTempSpot, uiBranchSpot, branchCnt;
-	INT32   uiTempRange, ubBranchRange;
-	UINT8   ubDir,ubBranchDir, ubKeepGoing;
-	INT16   sRange;
-	BOOLEAN fRecompileMovement = FALSE;
-	BOOLEAN fAnyMercHit = FALSE;
-	BOOLEAN fSmokeEffect = FALSE;
-
-	switch( usItem )
-	{
-		case MUSTARD_GRENADE:
-		case TEARGAS_GRENADE:
-		case GL_TEARGAS_GRENADE:
-		case BIG_TEAR_GAS:
-		case SMOKE_GRENADE:
-		case GL_SMOKE_GRENADE:
-		case SMALL_CREATURE_GAS:
-		case LARGE_CREATURE_GAS:
-		case VERY_SMALL_CREATURE_GAS:
-			fSmokeEffect = TRUE;
-			break;
-	}
-
-	// Set values for recompile region to optimize area we need to recompile for MPs
-	gsRecompileAreaTop = sGridNo / WORLD_COLS;
-	gsRecompileAreaLeft = sGridNo % WORLD_COLS;
-	gsRecompileAreaRight = gsRecompileAreaLeft;
-	gsRecompileAreaBottom = gsRecompileAreaTop;
-
-	// multiply range by 2 so we can correctly calculate approximately round explosion regions
-	sRange = ubRadius * 2;
-
-	// first, affect main spot
-	if (ExpAffect(sGridNo, sGridNo, 0, usItem, owner, fSubsequent, &fAnyMercHit, bLevel, smoke))
-	{
-		fRecompileMovement = TRUE;
-	}
-
+	INT32 uiNewSpot, uiTempSpot, uiBranchSpot, branchCnt;
+	INT32 uiTempRange, ubBranchRange;
+	UINT8 ubDir, ubBranchDir, ubKeepGoing;
 
 	for (ubDir = NORTH; ubDir <= NORTHWEST; ubDir++ )
 	{
@@ -1604,12 +1575,8 @@ void SpreadEffect(const INT16 sGridNo, const UINT8 ubRadius, const UINT16 usItem
 			{
 				uiTempSpot = uiNewSpot;
 
-				SLOGD("Explosion affects %d", uiNewSpot);
 				// ok, do what we do here...
-				if (ExpAffect(sGridNo, uiNewSpot, cnt / 2, usItem, owner, fSubsequent, &fAnyMercHit, bLevel, smoke))
-				{
-					fRecompileMovement = TRUE;
-				}
+				visit(uiNewSpot, cnt / 2);
 
 				// how far should we branch out here?
 				ubBranchRange = (UINT8)( sRange - cnt );
@@ -1644,11 +1611,7 @@ void SpreadEffect(const INT16 sGridNo, const UINT8 ubRadius, const UINT16 usItem
 							if ( ubKeepGoing )
 							{
 								// ok, do what we do here
-								SLOGD("Explosion affects %d", uiNewSpot);
-								if (ExpAffect(sGridNo, uiNewSpot, (INT16)((cnt + branchCnt) / 2), usItem, owner, fSubsequent, &fAnyMercHit, bLevel, smoke))
-								{
-									fRecompileMovement = TRUE;
-								}
+								visit(uiNewSpot, (cnt + branchCnt) / 2);
 								uiBranchSpot = uiNewSpot;
 							}
 							//else
@@ -1692,6 +1655,130 @@ void SpreadEffect(const INT16 sGridNo, const UINT8 ubRadius, const UINT16 usItem
 		}
 
 	} // end of dir loop
+}
+
+
+#define SMOKE_RAY_CACHE_SIZE 16
+
+struct ExplosionRayTile
+{
+	INT16  sGridNo;
+	UINT16 usDist;
+};
+
+/* The tiles reached by the rays of a smoke or gas cloud. They depend only on
+ * the fixed structures and the movement costs, so a cloud which spreads again
+ * every turn takes them from here until something in the world changes. */
+struct SmokeRays
+{
+	INT16  sGridNo;
+	INT16  sRange;
+	INT8   bLevel;
+	UINT32 uiFixedStructuresVersion;
+	UINT32 uiMovementCostsVersion;
+	UINT32 uiLastUse; // 0 if unused
+	std::vector<ExplosionRayTile> tiles;
+};
+
+static SmokeRays g_smoke_rays[SMOKE_RAY_CACHE_SIZE];
+static UINT32    g_smoke_ray_clock;
+
+
+static std::vector<ExplosionRayTile> const& GetSmokeRays(INT16 const sGridNo, INT16 const sRange, INT8 const bLevel)
+{
+	SmokeRays* r = g_smoke_rays;
+	FOR_EACH(SmokeRays, i, g_smoke_rays)
+	{
+		if (i->uiLastUse                != 0                         &&
+				i->sGridNo                  == sGridNo                   &&
+				i->sRange                   == sRange                    &&
+				i->bLevel                   == bLevel                    &&
+				i->uiFixedStructuresVersion == guiFixedStructuresVersion &&
+				i->uiMovementCostsVersion   == guiMovementCostsVersion)
+		{
+			i->uiLastUse = ++g_smoke_ray_clock;
+			return i->tiles;
+		}
+		if (i->uiLastUse < r->uiLastUse) r = i;
+	}
+
+	r->sGridNo                  = sGridNo;
+	r->sRange                   = sRange;
+	r->bLevel                   = bLevel;
+	r->uiFixedStructuresVersion = guiFixedStructuresVersion;
+	r->uiMovementCostsVersion   = guiMovementCostsVersion;
+	r->uiLastUse                = ++g_smoke_ray_clock;
+	std::vector<ExplosionRayTile>& tiles = r->tiles;
+	tiles.clear();
+	WalkExplosionRays(sGridNo, sRange, bLevel, TRUE, [&tiles](INT16 const g, UINT32 const dist)
+	{
+		ExplosionRayTile const t = { g, (UINT16)dist };
+		tiles.push_back(t);
+	});
+	return tiles;
+}
+
+
+void SpreadEffect(const INT16 sGridNo, const UINT8 ubRadius, const UINT16 usItem, SOLDIERTYPE* const owner, const BOOLEAN fSubsequent, const INT8 bLevel, const SMOKEEFFECT* const smoke)
+{
+	INT16   sRange;
+	BOOLEAN fRecompileMovement = FALSE;
+	BOOLEAN fAnyMercHit = FALSE;
+	BOOLEAN fSmokeEffect = FALSE;
+
+	switch( usItem )
+	{
+		case MUSTARD_GRENADE:
+		case TEARGAS_GRENADE:
+		case GL_TEARGAS_GRENADE:
+		case BIG_TEAR_GAS:
+		case SMOKE_GRENADE:
+		case GL_SMOKE_GRENADE:
+		case SMALL_CREATURE_GAS:
+		case LARGE_CREATURE_GAS:
+		case VERY_SMALL_CREATURE_GAS:
+			fSmokeEffect = TRUE;
+			break;
+	}
+
+	// Set values for recompile region to optimize area we need to recompile for MPs
+	gsRecompileAreaTop = sGridNo / WORLD_COLS;
+	gsRecompileAreaLeft = sGridNo % WORLD_COLS;
+	gsRecompileAreaRight = gsRecompileAreaLeft;
+	gsRecompileAreaBottom = gsRecompileAreaTop;
+
+	// multiply range by 2 so we can correctly calculate approximately round explosion regions
+	sRange = ubRadius * 2;
+
+	// first, affect main spot
+	if (ExpAffect(sGridNo, sGridNo, 0, usItem, owner, fSubsequent, &fAnyMercHit, bLevel, smoke))
+	{
+		fRecompileMovement = TRUE;
+	}
+
+	auto const affect = [&](INT16 const sSpot, UINT32 const uiDist)
+	{
+		SLOGD("Explosion affects %d", sSpot);
+		if (ExpAffect(sGridNo, sSpot, uiDist, usItem, owner, fSubsequent, &fAnyMercHit, bLevel, smoke))
+		{
+			fRecompileMovement = TRUE;
+		}
+	};
+
+	if (fSmokeEffect)
+	{
+		/* Smoke does not change what stops the rays, so the tiles can be collected
+		 * first, and recurring gas clouds take them from the cache */
+		for (ExplosionRayTile const& t : GetSmokeRays(sGridNo, sRange, bLevel))
+		{
+			affect(t.sGridNo, t.usDist);
+		}
+	}
+	else
+	{
+		// A blast breaks windows and structures as it spreads
+		WalkExplosionRays(sGridNo, sRange, bLevel, FALSE, affect);
+	}
 
 	// Recompile movement costs...
 	if ( fRecompileMovement )
@@ -1700,8 +1787,10 @@ void SpreadEffect(const INT16 sGridNo, const UINT8 ubRadius, const UINT16 usItem
 		SetRecalculateWireFrameFlagRadius(sGridNo, ubRadius);
 		CalculateWorldWireFrameTiles( FALSE );
 
-		RecompileLocalMovementCostsInAreaWithFlags();
-		RecompileLocalMovementCostsFromRadius( sGridNo, MAX_DISTANCE_EXPLOSIVE_CAN_DESTROY_STRUCTURES );
+		{ MovementCostBatch batch;
+			RecompileLocalMovementCostsInAreaWithFlags();
+			RecompileLocalMovementCostsFromRadius( sGridNo, MAX_DISTANCE_EXPLOSIVE_CAN_DESTROY_STRUCTURES );
+		}
 
 		// if anything has been done to change movement costs and this is a potential POW situation, check
 		// paths for POWs
@@ -1747,10 +1836,10 @@ void SpreadEffectSmoke(const SMOKEEFFECT* const s, const BOOLEAN subsequent, con
 
 static void ToggleActionItemsByFrequency(INT8 bFrequency)
 {
-	// Go through all the bombs in the world, and look for remote ones
-	CFOR_EACH_WORLD_BOMB(wb)
+	// Go through the remote bombs on this frequency
+	for (UINT32 const idx : RemoteWorldBombsOnFrequency(bFrequency))
 	{
-		OBJECTTYPE& o = GetWorldItem(wb->iItemIndex).o;
+		OBJECTTYPE& o = GetWorldItem(gWorldBombs[idx].iItemIndex).o;
 		if (o.bDetonatorType == BOMB_REMOTE)
 		{
 			// Found a remote bomb, so check to see if it has the same frequency
@@ -1773,13 +1862,10 @@ static void ToggleActionItemsByFrequency(INT8 bFrequency)
 
 static void TogglePressureActionItemsInGridNo(INT16 sGridNo)
 {
-	// Go through all the bombs in the world, and look for remote ones
-	CFOR_EACH_WORLD_BOMB(wb)
+	// Go through the bombs at this location, and look for pressure ones
+	for (UINT32 const idx : WorldBombsInGridNo(sGridNo))
 	{
-		WORLDITEM& wi = GetWorldItem(wb->iItemIndex);
-		if (wi.sGridNo != sGridNo) continue;
-
-		OBJECTTYPE& o = wi.o;
+		OBJECTTYPE& o = GetWorldItem(gWorldBombs[idx].iItemIndex).o;
 		if (o.bDetonatorType == BOMB_PRESSURE)
 		{
 			// Found a pressure item
@@ -2252,6 +2338,7 @@ void HandleExplosionQueue()
 				RemoveBlueFlag(gridno, level);
 			}
 			flags &= ~MAPELEMENT_ENEMY_MINE_PRESENT;
+			InvalidatePathCache();
 
 			// Bomb objects only store the side who placed the bomb.
 			SOLDIERTYPE* const owner = o.ubBombOwner > 1 ? ID2SOLDIER(o.ubBombOwner - 2) : 0;
@@ -2308,39 +2395,35 @@ void HandleExplosionQueue()
 
 void DecayBombTimers( void )
 {
-	UINT32				uiWorldBombIndex;
 	UINT32				uiTimeStamp;
 
 	uiTimeStamp = GetJA2Clock();
 
-	// Go through all the bombs in the world, and look for timed ones
-	for (uiWorldBombIndex = 0; uiWorldBombIndex < guiNumWorldBombs; uiWorldBombIndex++)
+	// Go through the timed bombs in the world
+	for (UINT32 const uiWorldBombIndex : TimedWorldBombs())
 	{
-		if (gWorldBombs[uiWorldBombIndex].fExists)
+		OBJECTTYPE& o = GetWorldItem(gWorldBombs[uiWorldBombIndex].iItemIndex).o;
+		if (o.bDetonatorType == BOMB_TIMED && !(o.fFlags & OBJECT_DISABLED_BOMB))
 		{
-			OBJECTTYPE& o = GetWorldItem(gWorldBombs[uiWorldBombIndex].iItemIndex).o;
-			if (o.bDetonatorType == BOMB_TIMED && !(o.fFlags & OBJECT_DISABLED_BOMB))
+			// Found a timed bomb, so decay its delay value and see if it goes off
+			o.bDelay--;
+			if (o.bDelay == 0)
 			{
-				// Found a timed bomb, so decay its delay value and see if it goes off
-				o.bDelay--;
-				if (o.bDelay == 0)
+				// put this bomb on the queue
+				AddBombToQueue( uiWorldBombIndex, uiTimeStamp );
+				// ATE: CC black magic....
+				if (o.ubBombOwner > 1)
 				{
-					// put this bomb on the queue
-					AddBombToQueue( uiWorldBombIndex, uiTimeStamp );
-					// ATE: CC black magic....
-					if (o.ubBombOwner > 1)
-					{
-						gPersonToSetOffExplosions = &GetMan(o.ubBombOwner - 2);
-					}
-					else
-					{
-						gPersonToSetOffExplosions = NULL;
-					}
+					gPersonToSetOffExplosions = &GetMan(o.ubBombOwner - 2);
+				}
+				else
+				{
+					gPersonToSetOffExplosions = NULL;
+				}
 
-					if (o.usItem != ACTION_ITEM || o.bActionValue == ACTION_ITEM_BLOW_UP)
-					{
-						uiTimeStamp += BOMB_QUEUE_DELAY;
-					}
+				if (o.usItem != ACTION_ITEM || o.bActionValue == ACTION_ITEM_BLOW_UP)
+				{
+					uiTimeStamp += BOMB_QUEUE_DELAY;
 				}
 			}
 		}
@@ -2350,30 +2433,26 @@ void DecayBombTimers( void )
 
 void SetOffBombsByFrequency(SOLDIERTYPE* const s, const INT8 bFrequency)
 {
-	UINT32 uiWorldBombIndex;
 	UINT32 uiTimeStamp;
 
 	uiTimeStamp = GetJA2Clock();
 
-	// Go through all the bombs in the world, and look for remote ones
-	for (uiWorldBombIndex = 0; uiWorldBombIndex < guiNumWorldBombs; uiWorldBombIndex++)
+	// Go through the remote bombs on this frequency
+	for (UINT32 const uiWorldBombIndex : RemoteWorldBombsOnFrequency(bFrequency))
 	{
-		if (gWorldBombs[uiWorldBombIndex].fExists)
+		OBJECTTYPE const& o = GetWorldItem(gWorldBombs[uiWorldBombIndex].iItemIndex).o;
+		if (o.bDetonatorType == BOMB_REMOTE && !(o.fFlags & OBJECT_DISABLED_BOMB))
 		{
-			OBJECTTYPE const& o = GetWorldItem(gWorldBombs[uiWorldBombIndex].iItemIndex).o;
-			if (o.bDetonatorType == BOMB_REMOTE && !(o.fFlags & OBJECT_DISABLED_BOMB))
+			// Found a remote bomb, so check to see if it has the same frequency
+			if (o.bFrequency == bFrequency)
 			{
-				// Found a remote bomb, so check to see if it has the same frequency
-				if (o.bFrequency == bFrequency)
-				{
-					gPersonToSetOffExplosions = s;
+				gPersonToSetOffExplosions = s;
 
-					// put this bomb on the queue
-					AddBombToQueue( uiWorldBombIndex, uiTimeStamp );
-					if (o.usItem != ACTION_ITEM || o.bActionValue == ACTION_ITEM_BLOW_UP)
-					{
-						uiTimeStamp += BOMB_QUEUE_DELAY;
-					}
+				// put this bomb on the queue
+				AddBombToQueue( uiWorldBombIndex, uiTimeStamp );
+				if (o.usItem != ACTION_ITEM || o.bActionValue == ACTION_ITEM_BLOW_UP)
+				{
+					uiTimeStamp += BOMB_QUEUE_DELAY;
 				}
 			}
 		}
@@ -2417,19 +2496,16 @@ void SetOffPanicBombs(SOLDIERTYPE* const s, const INT8 bPanicTrigger)
 
 BOOLEAN SetOffBombsInGridNo(SOLDIERTYPE* const s, const INT16 sGridNo, const BOOLEAN fAllBombs, const INT8 bLevel)
 {
-	UINT32  uiWorldBombIndex;
 	UINT32  uiTimeStamp;
 	BOOLEAN fFoundMine = FALSE;
 
 	uiTimeStamp = GetJA2Clock();
 
-	// Go through all the bombs in the world, and look for mines at this location
-	for (uiWorldBombIndex = 0; uiWorldBombIndex < guiNumWorldBombs; uiWorldBombIndex++)
+	// Go through the bombs at this location, and look for mines
+	for (UINT32 const uiWorldBombIndex : WorldBombsInGridNo(sGridNo))
 	{
-		if (!gWorldBombs[uiWorldBombIndex].fExists) continue;
-
 		WORLDITEM const& wi = GetWorldItem(gWorldBombs[uiWorldBombIndex].iItemIndex);
-		if (wi.sGridNo != sGridNo || wi.ubLevel != bLevel) continue;
+		if (wi.ubLevel != bLevel) continue;
 
 		OBJECTTYPE const& o = wi.o;
 		if (!(o.fFlags & OBJECT_DISABLED_BOMB))
@@ -2485,13 +2561,10 @@ BOOLEAN SetOffBombsInGridNo(SOLDIERTYPE* const s, const INT16 sGridNo, const BOO
 
 void ActivateSwitchInGridNo(SOLDIERTYPE* const s, const INT16 sGridNo)
 {
-	// Go through all the bombs in the world, and look for mines at this location
-	CFOR_EACH_WORLD_BOMB(wb)
+	// Go through the bombs at this location, and look for switches
+	for (UINT32 const idx : WorldBombsInGridNo(sGridNo))
 	{
-		WORLDITEM const& wi = GetWorldItem(wb->iItemIndex);
-		if (wi.sGridNo != sGridNo) continue;
-
-		OBJECTTYPE const& o = wi.o;
+		OBJECTTYPE const& o = GetWorldItem(gWorldBombs[idx].iItemIndex).o;
 		if (o.usItem == SWITCH && !(o.fFlags & OBJECT_DISABLED_BOMB) && o.bDetonatorType == BOMB_SWITCH)
 		{
 			// send out a signal to detonate other bombs, rather than this which
@@ -2714,13 +2787,13 @@ static void HandleBuldingDestruction(const INT16 sGridNo, const SOLDIERTYPE* con
 
 static INT32 FindActiveTimedBomb(void)
 {
-	// Go through all the bombs in the world, and look for timed ones
-	FOR_EACH_WORLD_BOMB(wb)
+	// Go through the timed bombs in the world
+	for (UINT32 const idx : TimedWorldBombs())
 	{
-		OBJECTTYPE const& o = GetWorldItem(wb->iItemIndex).o;
+		OBJECTTYPE const& o = GetWorldItem(gWorldBombs[idx].iItemIndex).o;
 		if (o.bDetonatorType != BOMB_TIMED || o.fFlags & OBJECT_DISABLED_BOMB) continue;
 
-		return wb->iItemIndex;
+		return gWorldBombs[idx].iItemIndex;
 	}
 	return -1;
 }
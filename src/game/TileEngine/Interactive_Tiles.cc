@@ -240,7 +240,8 @@ void SetActionModeDoorCursorText()
 }
 
 
-static void GetLevelNodeScreenRect(LEVELNODE const& n, SGPRect& rect, INT16 const x, INT16 const y, GridNo const gridno)
+// The screen position the images of the tiles at the gridno are placed from
+static void GetTileScreenAnchor(INT16 const x, INT16 const y, GridNo const gridno, INT16& anchor_x, INT16& anchor_y)
 {
 	// Get 'TRUE' merc position
 	INT16 sTempX_S;
@@ -249,6 +250,30 @@ static void GetLevelNodeScreenRect(LEVELNODE const& n, SGPRect& rect, INT16 cons
 	INT16 const offset_y = y - gsRenderCenterY;
 	FromCellToScreenCoordinates(offset_x, offset_y, &sTempX_S, &sTempY_S);
 
+	INT16 sScreenX = (g_ui.m_tacticalMapCenterX) + (INT16)sTempX_S;
+	INT16 sScreenY = (g_ui.m_tacticalMapCenterY) + (INT16)sTempY_S;
+
+	// Adjust for offset position on screen
+	sScreenX -= gsRenderWorldOffsetX;
+	sScreenY -= gsRenderWorldOffsetY;
+	sScreenY -=	gpWorldLevelData[gridno].sHeight;
+
+	// Adjust based on interface level
+	if (gsInterfaceLevel > 0)
+	{
+		sScreenY += ROOF_LEVEL_HEIGHT;
+	}
+
+	// Adjust for render height
+	sScreenY += gsRenderHeight;
+
+	anchor_x = sScreenX - WORLD_TILE_X / 2;
+	anchor_y = sScreenY - WORLD_TILE_Y / 2;
+}
+
+
+static void GetLevelNodeScreenRect(LEVELNODE const& n, SGPRect& rect, INT16 const anchor_x, INT16 const anchor_y)
+{
 	ETRLEObject const* pTrav;
 	if (n.uiFlags & LEVELNODE_CACHEDANITILE)
 	{
@@ -271,26 +296,9 @@ static void GetLevelNodeScreenRect(LEVELNODE const& n, SGPRect& rect, INT16 cons
 		pTrav = &te->hTileSurface->SubregionProperties(te->usRegionIndex);
 	}
 
-	INT16 sScreenX = (g_ui.m_tacticalMapCenterX) + (INT16)sTempX_S;
-	INT16 sScreenY = (g_ui.m_tacticalMapCenterY) + (INT16)sTempY_S;
-
-	// Adjust for offset position on screen
-	sScreenX -= gsRenderWorldOffsetX;
-	sScreenY -= gsRenderWorldOffsetY;
-	sScreenY -=	gpWorldLevelData[gridno].sHeight;
-
-	// Adjust based on interface level
-	if (gsInterfaceLevel > 0)
-	{
-		sScreenY += ROOF_LEVEL_HEIGHT;
-	}
-
-	// Adjust for render height
-	sScreenY += gsRenderHeight;
-
 	// Add to start position of dest buffer
-	sScreenX += pTrav->sOffsetX - WORLD_TILE_X / 2;
-	sScreenY += pTrav->sOffsetY - WORLD_TILE_Y / 2;
+	INT16 const sScreenX = anchor_x + pTrav->sOffsetX;
+	INT16       sScreenY = anchor_y + pTrav->sOffsetY;
 
 	// Adjust y offset!
 	sScreenY += WORLD_TILE_Y / 2;
@@ -324,10 +332,24 @@ void LogMouseOverInteractiveTile(INT16 const sGridNo)
 	INT16 const sScreenX = gusMouseXPos;
 	INT16 const sScreenY = gusMouseYPos;
 
+	INT16 anchor_x;
+	INT16 anchor_y;
+	GetTileScreenAnchor(sXMapPos, sYMapPos, sGridNo, anchor_x, anchor_y);
+
+	/* This is called for every tile on screen, so the tile is passed over unless
+	 * the mouse is within the reach of the images in the tile database. The
+	 * cached animated tiles are not in the database, so they are always tested. */
+	TileImageExtent const& ext = gTileImageExtent;
+	bool const in_reach =
+		anchor_x + ext.left                    <= sScreenX && sScreenX <= anchor_x + ext.right &&
+		anchor_y + ext.top + WORLD_TILE_Y / 2  <= sScreenY && sScreenY <= anchor_y + ext.bottom + WORLD_TILE_Y / 2;
+
 	for (LEVELNODE const* n = gpWorldLevelData[sGridNo].pStructHead; n; n = n->pNext)
 	{
+		if (!in_reach && !(n->uiFlags & LEVELNODE_CACHEDANITILE)) continue;
+
 		SGPRect aRect;
-		GetLevelNodeScreenRect(*n, aRect, sXMapPos, sYMapPos, sGridNo);
+		GetLevelNodeScreenRect(*n, aRect, anchor_x, anchor_y);
 
 		// Make sure we are always on guy if we are on same gridno
 		if (!IsPointInScreenRect(sScreenX, sScreenY, aRect)) continue;
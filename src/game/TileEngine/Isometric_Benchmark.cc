@@ -0,0 +1,96 @@
+#include "Isometric_Benchmark.h"
+#include "Benchmark_Suite.h"
+#include "Isometric_Utils.h"
+#include "Logger.h"
+
+#include <SDL.h>
+
+#include <math.h>
+#include <vector>
+
+
+#define BENCH_PAIRS  65536
+#define BENCH_ROUNDS 64 // over all pairs, per function
+
+
+struct GridNoPair
+{
+	INT16 a;
+	INT16 b;
+};
+
+
+/* A linear congruential generator, so the pairs do not depend on the state of
+ * Random() */
+static UINT32 NextSample(UINT32& seed)
+{
+	seed = seed * 1103515245 + 12345;
+	return seed >> 8;
+}
+
+
+// The distance as it was computed before the table
+static INT16 ReferencePythSpacesAway(INT16 const origin, INT16 const dest)
+{
+	INT16 const rows = ABS(origin / MAXCOL - dest / MAXCOL);
+	INT16 const cols = ABS(origin % MAXROW - dest % MAXROW);
+	return (INT16)sqrt(double(rows * rows + cols * cols));
+}
+
+
+static double NSPerCall(uint64_t const start)
+{
+	double const calls = double(BENCH_PAIRS) * BENCH_ROUNDS;
+	return (SDL_GetPerformanceCounter() - start) * 1e9 / SDL_GetPerformanceFrequency() / calls;
+}
+
+
+template<typename F> static double TimeCalls(std::vector<GridNoPair> const& pairs, F const f, INT32& sink)
+{
+	uint64_t const start = SDL_GetPerformanceCounter();
+	for (UINT round = 0; round != BENCH_ROUNDS; ++round)
+	{
+		for (GridNoPair const& p : pairs) sink += f(p.a, p.b);
+	}
+	return NSPerCall(start);
+}
+
+
+void BenchmarkIsometricUtils()
+{
+	std::vector<GridNoPair> pairs(BENCH_PAIRS);
+	UINT32 seed = 1;
+	for (GridNoPair& p : pairs)
+	{
+		p.a = NextSample(seed) % WORLD_MAX;
+		p.b = NextSample(seed) % WORLD_MAX;
+	}
+
+	UINT32 mismatches = 0;
+	for (GridNoPair const& p : pairs)
+	{
+		if (PythSpacesAway(p.a, p.b) != ReferencePythSpacesAway(p.a, p.b)) ++mismatches;
+	}
+	if (mismatches != 0) SLOGE("Isometric benchmark: %u distances differ from the floating point ones", mismatches);
+
+	// Summed up and logged, so the calls are not optimised away
+	INT32 sink = 0;
+	double const pyth      = TimeCalls(pairs, PythSpacesAway,          sink);
+	double const reference = TimeCalls(pairs, ReferencePythSpacesAway, sink);
+	double const range     = TimeCalls(pairs, GetRangeFromGridNoDiff,  sink);
+	double const spaces    = TimeCalls(pairs, SpacesAway,              sink);
+	double const cell_xy   = TimeCalls(pairs, [](INT16 const a, INT16) -> INT32
+	{
+		INT16 x;
+		INT16 y;
+		ConvertGridNoToCellXY(a, &x, &y);
+		return x + y;
+	}, sink);
+
+	SLOGI("Isometric benchmark, ns per call: PythSpacesAway %.2f (floating point %.2f), GetRangeFromGridNoDiff %.2f, SpacesAway %.2f, ConvertGridNoToCellXY %.2f (checksum %d)",
+		pyth, reference, range, spaces, cell_xy, sink);
+	RecordBenchmarkResult("isometric.PythSpacesAway_ns",         pyth);
+	RecordBenchmarkResult("isometric.GetRangeFromGridNoDiff_ns", range);
+	RecordBenchmarkResult("isometric.SpacesAway_ns",             spaces);
+	RecordBenchmarkResult("isometric.ConvertGridNoToCellXY_ns",  cell_xy);
+}
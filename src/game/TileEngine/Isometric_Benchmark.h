@@ -0,0 +1,11 @@
+#ifndef ISOMETRIC_BENCHMARK_H
+#define ISOMETRIC_BENCHMARK_H
+
+
+/* Times the tile distance and grid number conversion functions of
+ * Isometric_Utils.h on a fixed sequence of pairs of grid numbers, next to the
+ * floating point distance they replaced, and logs the nanoseconds per call.
+ * Pairs where the distances differ are logged as errors. */
+void BenchmarkIsometricUtils();
+
+#endif
@@ -16,6 +16,37 @@
 
 UINT32 guiForceRefreshMousePositionCalculation = 0;
 
+/* floor(sqrt(rows * rows + cols * cols)) for every distance in rows and
+ * columns on the map, so the distances between tiles need no floating point */
+static UINT8 g_tile_distance[WORLD_ROWS][WORLD_COLS];
+
+static bool InitTileDistances()
+{
+	for (INT32 rows = 0; rows != WORLD_ROWS; ++rows)
+	{
+		// The distance only grows along the row, so the root is carried along
+		INT32 d = rows;
+		for (INT32 cols = 0; cols != WORLD_COLS; ++cols)
+		{
+			INT32 const n = rows * rows + cols * cols;
+			while ((d + 1) * (d + 1) <= n) ++d;
+			g_tile_distance[rows][cols] = d;
+		}
+	}
+	return true;
+}
+
+static bool const g_tile_distances_ready = InitTileDistances();
+
+
+// rows and cols are not negative
+static INT16 TileDistance(INT32 const rows, INT32 const cols)
+{
+	if (rows < WORLD_ROWS && cols < WORLD_COLS) return g_tile_distance[rows][cols];
+	// Only between a tile and one off the map, e.g. NOWHERE
+	return (INT16)sqrt(double(rows * rows + cols * cols));
+}
+
 // GLOBALS
 const INT16 DirIncrementer[8] =
 {
@@ -409,7 +440,7 @@ INT32 GetRangeFromGridNoDiff( INT16 sGridNo1, INT16 sGridNo2 )
 	// Convert our grid-not into an XY
 	ConvertGridNoToXY( sGridNo2, &sXPos2, &sYPos2 );
 
-	uiDist = (INT16)sqrt(double(( sXPos2 - sXPos )*( sXPos2 - sXPos ) + ( sYPos2 - sYPos ) * ( sYPos2 - sYPos )));
+	uiDist = TileDistance(ABS(sYPos2 - sYPos), ABS(sXPos2 - sXPos));
 
 	return( uiDist );
 }
@@ -424,7 +455,7 @@ INT32 GetRangeInCellCoordsFromGridNoDiff( INT16 sGridNo1, INT16 sGridNo2 )
 	// Convert our grid-not into an XY
 	ConvertGridNoToXY( sGridNo2, &sXPos2, &sYPos2 );
 
-	return( (INT32)( sqrt(double(( sXPos2 - sXPos ) * ( sXPos2 - sXPos ) + ( sYPos2 - sYPos ) * ( sYPos2 - sYPos ) )) ) * CELL_X_SIZE );
+	return TileDistance(ABS(sYPos2 - sYPos), ABS(sXPos2 - sXPos)) * CELL_X_SIZE;
 }
 
 
@@ -460,7 +491,7 @@ INT16 PythSpacesAway(INT16 sOrigin, INT16 sDest)
 
 	// apply Pythagoras's theorem for right-handed triangle:
 	// dist^2 = rows^2 + cols^2, so use the square root to get the distance
-	sResult = (INT16)sqrt(double((sRows * sRows) + (sCols * sCols)));
+	sResult = TileDistance(sRows, sCols);
 
 	return(sResult);
 }
@@ -827,3 +858,24 @@ INT16 RandomGridNo()
 	} while( !GridNoOnVisibleWorldTile( (INT16)iMapIndex ) );
 	return (INT16)iMapIndex;
 }
+
+
+#ifdef WITH_UNITTESTS
+#undef FAIL
+#include "gtest/gtest.h"
+
+TEST(IsometricUtils, tileDistances)
+{
+	EXPECT_TRUE(g_tile_distances_ready);
+	for (INT32 rows = 0; rows <= WORLD_ROWS; ++rows)
+	{
+		for (INT32 cols = 0; cols <= WORLD_COLS; ++cols)
+		{
+			EXPECT_EQ(TileDistance(rows, cols), (INT16)sqrt(double(rows * rows + cols * cols)));
+		}
+	}
+	EXPECT_EQ(PythSpacesAway(0, WORLD_MAX - 1), 224);
+	EXPECT_EQ(GetRangeInCellCoordsFromGridNoDiff(0, 3 * WORLD_COLS + 4), 5 * CELL_X_SIZE);
+}
+
+#endif
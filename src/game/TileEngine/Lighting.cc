@@ -40,7 +40,10 @@
 #include "FileMan.h"
 #include "Environment.h"
 #include "PathAI.h"
+#include "Profiler.h"
 #include "MemMan.h"
+#include "Shade_Table_Cache.h"
+#include "WorkerPool.h"
 
 #include "ContentManager.h"
 #include "GameInstance.h"
@@ -49,6 +52,7 @@
 #include <algorithm>
 #include <iterator>
 #include <stdexcept>
+#include <vector>
 
 #define MAX_LIGHT_TEMPLATES 32 // maximum number of light types
 
@@ -74,6 +78,46 @@ struct LightTemplate
 
 static LightTemplate g_light_templates[MAX_LIGHT_TEMPLATES];
 
+
+#define LIGHT_RASTER_CACHE_SIZE 32 // light positions whose lit tiles are kept
+
+// A tile lit by a light, relative to the position of the light
+struct LightRasterTile
+{
+	INT16 src_dx; // the tile the ray came from
+	INT16 src_dy;
+	INT16 dx;
+	INT16 dy;
+	UINT8 shade;
+	bool  backlight;
+	bool  only_walls;
+};
+
+// The tiles lit by a light template at a position, see GetLightRaster()
+struct LightRaster
+{
+	LightTemplate const*         light_template;
+	UINT16                       n_lights;
+	UINT16                       n_rays;
+	INT16                        iX;
+	INT16                        iY;
+	bool                         on_roof;
+	UINT32                       uiStructuresVersion;
+	UINT32                       uiMovementCostsVersion;
+	UINT32                       uiPathCacheGeneration;
+	UINT32                       uiLastUse;
+	std::vector<LightRasterTile> tiles;
+};
+
+static LightRaster g_light_rasters[LIGHT_RASTER_CACHE_SIZE];
+static UINT32      g_light_raster_clock;
+
+// Tiles lights were added to or subtracted from since CommitLightChanges(),
+// with the shade levels of their nodes as they were before
+static std::vector<UINT32> g_light_touched;
+static bool                g_light_touched_tile[WORLD_MAX];
+static uint64_t            g_light_shade_before[WORLD_MAX];
+
 #define FOR_EACH_LIGHT_TEMPLATE_SLOT(iter) \
 	FOR_EACH(LightTemplate, iter, g_light_templates)
 
@@ -228,6 +272,7 @@ InitLightingSystem
 void InitLightingSystem(void)
 {
 	LoadShadeTablesFromTextFile();
+	LoadShadeTableCache();
 
 	// init all light lists
 	std::fill(std::begin(g_light_templates), std::end(g_light_templates), LightTemplate{});
@@ -264,6 +309,8 @@ void ShutdownLightingSystem(void)
 	{
 		LightDelete(t);
 	}
+
+	SaveShadeTableCache();
 }
 
 
@@ -510,6 +557,12 @@ static BOOLEAN LightDelete(LightTemplate* const t)
 {
 	if (t->lights == NULL) return FALSE;
 
+	// the slot may be reused by another template with as many nodes
+	FOR_EACH(LightRaster, i, g_light_rasters)
+	{
+		if (i->light_template == t) i->light_template = NULL;
+	}
+
 	MemFree(t->lights);
 	t->lights = NULL;
 
@@ -582,7 +635,10 @@ UINT8 LightTrueLevel( INT16 sGridNo, INT8 bLevel )
 	}
 	else
 	{
-		iSum=pNode->ubNaturalShadeLevel - (pNode->ubSumLights - pNode->ubFakeShadeLevel );
+		INT32 const natural = pNode->ubNaturalShadeLevel == SHADE_AMBIENT ?
+			__max(SHADE_MAX, __min(SHADE_MIN, ubAmbientLightLevel)) :
+			pNode->ubNaturalShadeLevel;
+		iSum=natural - (pNode->ubSumLights - pNode->ubFakeShadeLevel );
 
 		iSum=__min(SHADE_MIN, iSum);
 		iSum=__max(SHADE_MAX, iSum);
@@ -591,6 +647,53 @@ UINT8 LightTrueLevel( INT16 sGridNo, INT8 bLevel )
 }
 
 
+static void HashShadeLevels(uint64_t& hash, LEVELNODE const* n)
+{
+	for (; n; n = n->pNext) hash = (hash ^ LightNodeShade(*n)) * 1099511628211ULL;
+	hash = (hash ^ 0xFF) * 1099511628211ULL; // end of the list
+}
+
+
+/* Hash of the shade levels of all nodes on a tile which lights change. */
+static uint64_t TileShadeKey(MAP_ELEMENT const& e)
+{
+	uint64_t hash = 14695981039346656037ULL; // FNV-1a
+	HashShadeLevels(hash, e.pLandHead);
+	HashShadeLevels(hash, e.pObjectHead);
+	HashShadeLevels(hash, e.pStructHead);
+	HashShadeLevels(hash, e.pMercHead);
+	HashShadeLevels(hash, e.pRoofHead);
+	HashShadeLevels(hash, e.pOnRoofHead);
+	return hash;
+}
+
+
+/* Notes that a light is about to change the tile. The tile is only marked for
+ * redrawing by CommitLightChanges(), if its shade levels differ by then, so a
+ * light erased and drawn again, e.g. when a merc with a flashlight steps to
+ * the next tile, does not redraw the tiles both positions light the same. */
+static void LightTouchTile(UINT32 const uiTile)
+{
+	if (g_light_touched_tile[uiTile]) return;
+	g_light_touched_tile[uiTile] = true;
+	g_light_shade_before[uiTile] = TileShadeKey(gpWorldLevelData[uiTile]);
+	g_light_touched.push_back(uiTile);
+}
+
+
+void CommitLightChanges()
+{
+	for (UINT32 const uiTile : g_light_touched)
+	{
+		g_light_touched_tile[uiTile] = false;
+		if (!gpWorldLevelData) continue;
+		MAP_ELEMENT& e = gpWorldLevelData[uiTile];
+		if (TileShadeKey(e) != g_light_shade_before[uiTile]) e.uiFlags |= MAPELEMENT_REDRAW;
+	}
+	g_light_touched.clear();
+}
+
+
 // Does the addition of light values to individual LEVELNODEs in the world tile list.
 static void LightAddTileNode(LEVELNODE* const pNode, const UINT8 ubShadeAdd, const BOOLEAN fFake)
 {
@@ -605,6 +708,13 @@ static void LightAddTileNode(LEVELNODE* const pNode, const UINT8 ubShadeAdd, con
 	// Now set max
 	pNode->ubMaxLights = __max( pNode->ubMaxLights, ubShadeAdd );
 
+	// LightNodeShade() takes the lights into account for these
+	if (pNode->ubNaturalShadeLevel == SHADE_AMBIENT)
+	{
+		pNode->ubShadeLevel = SHADE_AMBIENT;
+		return;
+	}
+
 	sSum=pNode->ubNaturalShadeLevel - pNode->ubMaxLights;
 
 	sSum=__min(SHADE_MIN, sSum);
@@ -642,6 +752,11 @@ static void LightSubtractTileNode(LEVELNODE* const pNode, const UINT8 ubShadeSub
 	// Now set max
 	pNode->ubMaxLights = __min( pNode->ubMaxLights, pNode->ubSumLights );
 
+	if (pNode->ubNaturalShadeLevel == SHADE_AMBIENT)
+	{
+		pNode->ubShadeLevel = SHADE_AMBIENT;
+		return;
+	}
 
 	sSum=pNode->ubNaturalShadeLevel - pNode->ubMaxLights;
 
@@ -673,7 +788,7 @@ static BOOLEAN LightAddTile(const INT16 iSrcX, const INT16 iSrcY, const INT16 iX
 		return( FALSE );
 	}
 
-	gpWorldLevelData[uiTile].uiFlags|=MAPELEMENT_REDRAW;
+	LightTouchTile(uiTile);
 
 	//if((uiFlags&LIGHT_BACKLIGHT) && !(uiFlags&LIGHT_ROOF_ONLY))
 	//	ubShadeAdd = ubShade*7/10;
@@ -809,7 +924,7 @@ static BOOLEAN LightSubtractTile(const INT16 iSrcX, const INT16 iSrcY, const INT
 	}
 
 
-	gpWorldLevelData[uiTile].uiFlags|=MAPELEMENT_REDRAW;
+	LightTouchTile(uiTile);
 
 //	if((uiFlags&LIGHT_BACKLIGHT) && !(uiFlags&LIGHT_ROOF_ONLY))
 //		ubShadeSubtract=ubShade*7/10;
@@ -928,35 +1043,6 @@ static BOOLEAN LightSubtractTile(const INT16 iSrcX, const INT16 iSrcY, const INT
 }
 
 
-/* Set the natural light level (as well as the current) on all LEVELNODEs on a
-	* level. */
-static void LightSetNaturalLevel(LEVELNODE* n, UINT8 const shade)
-{
-	for (; n; n = n->pNext)
-	{
-		n->ubSumLights         = 0;
-		n->ubMaxLights         = 0;
-		n->ubNaturalShadeLevel = shade;
-		n->ubShadeLevel        = shade;
-	}
-}
-
-
-/* Set the natural light value of all objects on a given tile to the specified
-	* value.  This is the light value a tile has with no artificial lighting
-	* affecting it. */
-static void LightSetNaturalTile(MAP_ELEMENT const& e, UINT8 shade)
-{
-	LightSetNaturalLevel(e.pLandHead,    shade);
-	LightSetNaturalLevel(e.pObjectHead,  shade);
-	LightSetNaturalLevel(e.pStructHead,  shade);
-	LightSetNaturalLevel(e.pMercHead,    shade);
-	LightSetNaturalLevel(e.pRoofHead,    shade);
-	LightSetNaturalLevel(e.pOnRoofHead,  shade);
-	LightSetNaturalLevel(e.pTopmostHead, shade);
-}
-
-
 /* Reset the light level of all LEVELNODEs on a level to the value contained in
 	* the natural light level. */
 static void LightResetLevel(LEVELNODE* n)
@@ -971,18 +1057,24 @@ static void LightResetLevel(LEVELNODE* n)
 }
 
 
+static void LightResetTile(MAP_ELEMENT& e)
+{
+	LightResetLevel(e.pLandHead);
+	LightResetLevel(e.pObjectHead);
+	LightResetLevel(e.pStructHead);
+	LightResetLevel(e.pMercHead);
+	LightResetLevel(e.pRoofHead);
+	LightResetLevel(e.pOnRoofHead);
+	LightResetLevel(e.pTopmostHead);
+}
+
+
 // Reset all tiles on the map to their baseline values.
 static void LightResetAllTiles(void)
 {
 	FOR_EACH_WORLD_TILE(i)
 	{
-		LightResetLevel(i->pLandHead);
-		LightResetLevel(i->pObjectHead);
-		LightResetLevel(i->pStructHead);
-		LightResetLevel(i->pMercHead);
-		LightResetLevel(i->pRoofHead);
-		LightResetLevel(i->pOnRoofHead);
-		LightResetLevel(i->pTopmostHead);
+		LightResetTile(*i);
 	}
 }
 
@@ -1481,6 +1573,8 @@ static void LightGenerateElliptical(LightTemplate* const t, const UINT8 iIntensi
 	LightSetBaseLevel
 
 		Sets the current and natural light settings for all tiles in the world.
+		The tiles follow the ambient level by themselves, so this is the same
+		amount of work whatever the size of the map.
 
 ***************************************************************************************/
 void LightSetBaseLevel(UINT8 iIntensity)
@@ -1497,15 +1591,7 @@ void LightSetBaseLevel(UINT8 iIntensity)
 		}
 	}
 
-	UINT16 shade = iIntensity;
-	shade = __max(SHADE_MAX, shade);
-	shade = __min(SHADE_MIN, shade);
-	FOR_EACH_WORLD_TILE(i)
-	{
-		LightSetNaturalTile(*i, shade);
-	}
-
-	LightSpriteRenderAll();
+	SetRenderFlags(RENDER_FLAG_FULL);
 
 	if(iIntensity >= LIGHT_DUSK_CUTOFF)
 		RenderSetShadows(FALSE);
@@ -1516,13 +1602,8 @@ void LightSetBaseLevel(UINT8 iIntensity)
 
 void LightAddBaseLevel(const UINT8 iIntensity)
 {
-	INT16 iCountY, iCountX;
-
 	ubAmbientLightLevel=__max(SHADE_MAX, ubAmbientLightLevel-iIntensity);
-
-	for(iCountY=0; iCountY < WORLD_ROWS; iCountY++)
-		for(iCountX=0; iCountX < WORLD_COLS; iCountX++)
-			LightAddTile(iCountX, iCountY, iCountX, iCountY, iIntensity, LIGHT_IGNORE_WALLS|LIGHT_EVERYTHING, FALSE);
+	SetRenderFlags(RENDER_FLAG_FULL);
 
 	if(ubAmbientLightLevel >= LIGHT_DUSK_CUTOFF)
 		RenderSetShadows(FALSE);
@@ -1533,13 +1614,8 @@ void LightAddBaseLevel(const UINT8 iIntensity)
 
 void LightSubtractBaseLevel(const UINT8 iIntensity)
 {
-	INT16 iCountY, iCountX;
-
 	ubAmbientLightLevel=__min(SHADE_MIN, ubAmbientLightLevel+iIntensity);
-
-	for(iCountY=0; iCountY < WORLD_ROWS; iCountY++)
-		for(iCountX=0; iCountX < WORLD_COLS; iCountX++)
-			LightSubtractTile(iCountX, iCountY, iCountX, iCountY, iIntensity, LIGHT_IGNORE_WALLS|LIGHT_EVERYTHING, FALSE);
+	SetRenderFlags(RENDER_FLAG_FULL);
 
 	if(ubAmbientLightLevel >= LIGHT_DUSK_CUTOFF)
 		RenderSetShadows(FALSE);
@@ -1591,15 +1667,50 @@ static BOOLEAN LightIlluminateWall(INT16 iSourceX, INT16 iSourceY, INT16 iTileX,
 }
 
 
-BOOLEAN LightDraw(const LIGHT_SPRITE* const l)
+/* Walks the rays of the template of a light at a position, skipping the rest of
+ * a ray at the first tile blocking light, and records the tiles to light. The
+ * walk only depends on the walls, windows and doors, so the result is kept for
+ * the position until the structures or movement costs change or a door is seen
+ * to open or close. Moving a light back and forth or switching it on and off
+ * then does not walk the rays again, and LightErase() finds what LightDraw()
+ * recorded. */
+static LightRaster const& GetLightRaster(LIGHT_SPRITE const* const l)
 {
-	UINT32  uiFlags;
-	INT32   iOldX, iOldY;
-	BOOLEAN fBlocked = FALSE;
-	BOOLEAN fOnlyWalls;
+	LightTemplate* const t       = l->light_template;
+	bool           const on_roof = l->uiFlags & LIGHT_SPR_ONROOF;
+	INT16          const iX      = l->iX;
+	INT16          const iY      = l->iY;
+
+	LightRaster* r = g_light_rasters;
+	FOR_EACH(LightRaster, i, g_light_rasters)
+	{
+		if (i->light_template         == t                       &&
+				i->n_lights               == t->n_lights             &&
+				i->n_rays                 == t->n_rays               &&
+				i->iX                     == iX                      &&
+				i->iY                     == iY                      &&
+				i->on_roof                == on_roof                 &&
+				i->uiStructuresVersion    == guiStructuresVersion    &&
+				i->uiMovementCostsVersion == guiMovementCostsVersion &&
+				i->uiPathCacheGeneration  == guiPathCacheGeneration)
+		{
+			i->uiLastUse = ++g_light_raster_clock;
+			return *i;
+		}
+		if (i->uiLastUse < r->uiLastUse) r = i;
+	}
 
-	const LightTemplate* const t = l->light_template;
-	if (t->lights == NULL) return FALSE;
+	r->light_template         = t;
+	r->n_lights               = t->n_lights;
+	r->n_rays                 = t->n_rays;
+	r->iX                     = iX;
+	r->iY                     = iY;
+	r->on_roof                = on_roof;
+	r->uiStructuresVersion    = guiStructuresVersion;
+	r->uiMovementCostsVersion = guiMovementCostsVersion;
+	r->uiPathCacheGeneration  = guiPathCacheGeneration;
+	r->uiLastUse              = ++g_light_raster_clock;
+	r->tiles.clear();
 
 	// clear out all the flags
 	for (UINT16 uiCount = 0; uiCount < t->n_lights; ++uiCount)
@@ -1607,23 +1718,19 @@ BOOLEAN LightDraw(const LIGHT_SPRITE* const l)
 		t->lights[uiCount].uiFlags &= ~LIGHT_NODE_DRAWN;
 	}
 
-	const INT16 iX = l->iX;
-	const INT16 iY = l->iY;
-
-	iOldX = iX;
-	iOldY = iY;
-
+	INT32 iOldX = iX;
+	INT32 iOldY = iY;
 	for (UINT16 uiCount = 0; uiCount < t->n_rays; ++uiCount)
 	{
 		const UINT16 usNodeIndex = t->rays[uiCount];
 		if(!(usNodeIndex&LIGHT_NEW_RAY))
 		{
-			fBlocked = FALSE;
-			fOnlyWalls = FALSE;
+			BOOLEAN fBlocked   = FALSE;
+			BOOLEAN fOnlyWalls = FALSE;
 
 			LIGHT_NODE* const pLight = &t->lights[usNodeIndex & ~LIGHT_BACKLIGHT];
 
-			if (!(l->uiFlags & LIGHT_SPR_ONROOF))
+			if (!on_roof)
 			{
 				if(LightTileBlocked( (INT16)iOldX, (INT16)iOldY, (INT16)(iX+pLight->iDX), (INT16)(iY+pLight->iDY)))
 				{
@@ -1636,11 +1743,15 @@ BOOLEAN LightDraw(const LIGHT_SPRITE* const l)
 
 			if(!(pLight->uiFlags&LIGHT_NODE_DRAWN) && (pLight->ubLight) )
 			{
-				uiFlags=(UINT32)(usNodeIndex&LIGHT_BACKLIGHT);
-				if (l->uiFlags & MERC_LIGHT)       uiFlags |= LIGHT_FAKE;
-				if (l->uiFlags & LIGHT_SPR_ONROOF) uiFlags |= LIGHT_ROOF_ONLY;
-
-				LightAddTile(iOldX, iOldY, iX + pLight->iDX, iY + pLight->iDY, pLight->ubLight, uiFlags, fOnlyWalls);
+				LightRasterTile tile;
+				tile.src_dx     = iOldX - iX;
+				tile.src_dy     = iOldY - iY;
+				tile.dx         = pLight->iDX;
+				tile.dy         = pLight->iDY;
+				tile.shade      = pLight->ubLight;
+				tile.backlight  = usNodeIndex & LIGHT_BACKLIGHT;
+				tile.only_walls = fOnlyWalls;
+				r->tiles.push_back(tile);
 
 				pLight->uiFlags|=LIGHT_NODE_DRAWN;
 			}
@@ -1664,6 +1775,35 @@ BOOLEAN LightDraw(const LIGHT_SPRITE* const l)
 		}
 	}
 
+	return *r;
+}
+
+
+// The flags LightAddTile() and LightSubtractTile() get for a tile of a light
+static UINT32 LightRasterTileFlags(LIGHT_SPRITE const* const l, LightRasterTile const& tile)
+{
+	UINT32 uiFlags = tile.backlight ? LIGHT_BACKLIGHT : 0;
+	if (l->uiFlags & MERC_LIGHT)       uiFlags |= LIGHT_FAKE;
+	if (l->uiFlags & LIGHT_SPR_ONROOF) uiFlags |= LIGHT_ROOF_ONLY;
+	return uiFlags;
+}
+
+
+BOOLEAN LightDraw(const LIGHT_SPRITE* const l)
+{
+	ProfilerCount(PROFILE_LIGHT_DRAWS, 1);
+
+	const LightTemplate* const t = l->light_template;
+	if (t->lights == NULL) return FALSE;
+
+	const INT16 iX = l->iX;
+	const INT16 iY = l->iY;
+	LightRaster const& r = GetLightRaster(l);
+	for (LightRasterTile const& tile : r.tiles)
+	{
+		LightAddTile(iX + tile.src_dx, iY + tile.src_dy, iX + tile.dx, iY + tile.dy, tile.shade, LightRasterTileFlags(l, tile), tile.only_walls);
+	}
+
 	return(TRUE);
 }
 
@@ -1769,72 +1909,15 @@ BOOLEAN ApplyTranslucencyToWalls(INT16 iX, INT16 iY)
 // Reverts all tiles a given light affects to their natural light levels.
 static BOOLEAN LightErase(const LIGHT_SPRITE* const l)
 {
-	UINT32  uiFlags;
-	INT32   iOldX, iOldY;
-	BOOLEAN fBlocked = FALSE;
-	BOOLEAN fOnlyWalls;
-
-	LightTemplate* const t = l->light_template;
+	const LightTemplate* const t = l->light_template;
 	if (t->lights == NULL) return FALSE;
 
-	// clear out all the flags
-	for (UINT16 uiCount = 0; uiCount < t->n_lights; ++uiCount)
-	{
-		t->lights[uiCount].uiFlags &= ~LIGHT_NODE_DRAWN;
-	}
-
 	const INT16 iX = l->iX;
 	const INT16 iY = l->iY;
-	iOldX = iX;
-	iOldY = iY;
-
-	for (UINT16 uiCount = 0; uiCount < t->n_rays; ++uiCount)
+	LightRaster const& r = GetLightRaster(l);
+	for (LightRasterTile const& tile : r.tiles)
 	{
-		const UINT16 usNodeIndex = t->rays[uiCount];
-		if (!(usNodeIndex & LIGHT_NEW_RAY))
-		{
-			fBlocked = FALSE;
-			fOnlyWalls = FALSE;
-
-			LIGHT_NODE* const pLight = &t->lights[usNodeIndex & ~LIGHT_BACKLIGHT];
-
-			if (!(l->uiFlags&LIGHT_SPR_ONROOF))
-			{
-				if(LightTileBlocked( (INT16)iOldX, (INT16)iOldY, (INT16)(iX+pLight->iDX), (INT16)(iY+pLight->iDY)))
-				{
-					uiCount = LightFindNextRay(t, uiCount);
-
-					fOnlyWalls = TRUE;
-					fBlocked = TRUE;
-				}
-			}
-
-			if(!(pLight->uiFlags&LIGHT_NODE_DRAWN) && (pLight->ubLight) )
-			{
-				uiFlags=(UINT32)(usNodeIndex&LIGHT_BACKLIGHT);
-				if (l->uiFlags & MERC_LIGHT)       uiFlags |= LIGHT_FAKE;
-				if (l->uiFlags & LIGHT_SPR_ONROOF) uiFlags |= LIGHT_ROOF_ONLY;
-
-				LightSubtractTile(iOldX, iOldY, iX + pLight->iDX, iY + pLight->iDY, pLight->ubLight, uiFlags, fOnlyWalls);
-				pLight->uiFlags|=LIGHT_NODE_DRAWN;
-			}
-
-			if ( fBlocked )
-			{
-				iOldX = iX;
-				iOldY = iY;
-			}
-			else
-			{
-				iOldX = iX+pLight->iDX;
-				iOldY = iY+pLight->iDY;
-			}
-		}
-		else
-		{
-			iOldX = iX;
-			iOldY = iY;
-		}
+		LightSubtractTile(iX + tile.src_dx, iY + tile.src_dy, iX + tile.dx, iY + tile.dy, tile.shade, LightRasterTileFlags(l, tile), tile.only_walls);
 	}
 
 	return(TRUE);
@@ -2021,6 +2104,106 @@ void LightSpriteRenderAll()
 }
 
 
+SGPRect LightSpriteGetArea(LIGHT_SPRITE const* const l)
+{
+	INT32 left   = l->iX;
+	INT32 top    = l->iY;
+	INT32 right  = l->iX;
+	INT32 bottom = l->iY;
+	LightTemplate const* const t = l->light_template;
+	for (UINT16 i = 0; i != t->n_lights; ++i)
+	{
+		LIGHT_NODE const& n = t->lights[i];
+		left   = MIN(left,   l->iX + n.iDX);
+		top    = MIN(top,    l->iY + n.iDY);
+		right  = MAX(right,  l->iX + n.iDX);
+		bottom = MAX(bottom, l->iY + n.iDY);
+	}
+
+	SGPRect area;
+	area.iLeft   = MAX(left,   0);
+	area.iTop    = MAX(top,    0);
+	area.iRight  = MIN(right,  WORLD_COLS - 1);
+	area.iBottom = MIN(bottom, WORLD_ROWS - 1);
+	return area;
+}
+
+
+static bool RectsOverlap(SGPRect const& a, SGPRect const& b)
+{
+	return
+		a.iLeft <= b.iRight && b.iLeft <= a.iRight &&
+		a.iTop <= b.iBottom && b.iTop <= a.iBottom;
+}
+
+
+// Whether the light is drawn into the tiles, so it has a part in their shades
+static bool LightSpriteIsDrawn(LIGHT_SPRITE const& l)
+{
+	return
+		l.uiFlags & LIGHT_SPR_ACTIVE &&
+		l.uiFlags & LIGHT_SPR_ERASE  &&
+		l.iX < WORLD_COLS && l.iY < WORLD_ROWS;
+}
+
+
+void LightSpriteRenderRect(SGPRect const& rect)
+{
+	SGPRect r = rect;
+	r.iRight  = MIN(r.iRight,  WORLD_COLS - 1);
+	r.iBottom = MIN(r.iBottom, WORLD_ROWS - 1);
+	if (r.iLeft > r.iRight || r.iTop > r.iBottom) return;
+
+	for (INT32 y = r.iTop; y <= r.iBottom; ++y)
+	{
+		for (INT32 x = r.iLeft; x <= r.iRight; ++x)
+		{
+			UINT32 const uiTile = MAPROWCOLTOPOS(y, x);
+			LightTouchTile(uiTile);
+			LightResetTile(gpWorldLevelData[uiTile]);
+		}
+	}
+
+	FOR_EACH(LIGHT_SPRITE const, i, LightSprites)
+	{
+		LIGHT_SPRITE const& l = *i;
+		if (!LightSpriteIsDrawn(l))                   continue;
+		if (!RectsOverlap(LightSpriteGetArea(&l), r)) continue;
+		if (l.light_template->lights == NULL)         continue;
+
+		INT16 const iX = l.iX;
+		INT16 const iY = l.iY;
+		LightRaster const& raster = GetLightRaster(&l);
+		for (LightRasterTile const& tile : raster.tiles)
+		{
+			INT32 const x = iX + tile.dx;
+			INT32 const y = iY + tile.dy;
+			if (x < r.iLeft || r.iRight < x || y < r.iTop || r.iBottom < y) continue;
+			LightAddTile(iX + tile.src_dx, iY + tile.src_dy, x, y, tile.shade, LightRasterTileFlags(&l, tile), tile.only_walls);
+		}
+	}
+
+	SetRenderFlags(RENDER_FLAG_MARKED);
+}
+
+
+void LightSpriteRenderAround(SGPRect const& r)
+{
+	SGPRect area = r;
+	FOR_EACH(LIGHT_SPRITE const, i, LightSprites)
+	{
+		if (!LightSpriteIsDrawn(*i)) continue;
+		SGPRect const a = LightSpriteGetArea(i);
+		if (!RectsOverlap(a, r)) continue;
+		area.iLeft   = MIN(area.iLeft,   a.iLeft);
+		area.iTop    = MIN(area.iTop,    a.iTop);
+		area.iRight  = MAX(area.iRight,  a.iRight);
+		area.iBottom = MAX(area.iBottom, a.iBottom);
+	}
+	LightSpriteRenderRect(area);
+}
+
+
 void LightSpritePosition(LIGHT_SPRITE* const l, const INT16 iX, const INT16 iY)
 {
 	Assert(l->uiFlags & LIGHT_SPR_ACTIVE);
@@ -2141,15 +2324,42 @@ static void AddSaturatePalette(SGPPaletteEntry Dst[256], const SGPPaletteEntry S
 }
 
 
+/* Hash of everything the shade tables of a palette are computed from. */
+static uint64_t ShadeTableKey(const SGPPaletteEntry ShadePal[256])
+{
+	uint64_t hash = 14695981039346656037ULL; // FNV-1a
+	for (UINT i = 0; i < 256; i++)
+	{
+		UINT8 const rgb[] = { ShadePal[i].r, ShadePal[i].g, ShadePal[i].b };
+		for (UINT j = 0; j < lengthof(rgb); j++) hash = (hash ^ rgb[j]) * 1099511628211ULL;
+	}
+	for (UINT i = 0; i < 16; i++)
+	{
+		for (UINT j = 0; j < 3; j++) hash = (hash ^ gusShadeLevels[i][j]) * 1099511628211ULL;
+	}
+	return hash;
+}
+
+
+// The first table is the monochrome one
+static void BuildShadedPalette(UINT16* const dst, const SGPPaletteEntry ShadePal[256], UINT const i)
+{
+	const UINT16* sl = gusShadeLevels[i];
+	Build16BPPPaletteShaded(dst, ShadePal, sl[0], sl[1], sl[2], i == 0);
+}
+
+
 static void CreateShadedPalettes(UINT16* Shades[16], const SGPPaletteEntry ShadePal[256])
 {
-	const UINT16* sl0 = gusShadeLevels[0];
-	Shades[0] = Create16BPPPaletteShaded(ShadePal, sl0[0], sl0[1], sl0[2], TRUE);
-	for (UINT i = 1; i < 16; i++)
+	uint64_t const key = ShadeTableKey(ShadePal);
+	if (GetCachedShadeTables(key, Shades)) return;
+
+	for (UINT i = 0; i < 16; i++)
 	{
-		const UINT16* sl = gusShadeLevels[i];
-		Shades[i] = Create16BPPPaletteShaded(ShadePal, sl[0], sl[1], sl[2], FALSE);
+		Shades[i] = MALLOCN(UINT16, 256);
+		BuildShadedPalette(Shades[i], ShadePal, i);
 	}
+	AddCachedShadeTables(key, Shades);
 }
 
 
@@ -2161,6 +2371,14 @@ void CreateBiasedShadedPalettes(UINT16* Shades[16], const SGPPaletteEntry ShadeP
 }
 
 
+uint64_t BiasedShadedPalettesKey(const SGPPaletteEntry ShadePal[256])
+{
+	SGPPaletteEntry LightPal[256];
+	AddSaturatePalette(LightPal, ShadePal, &g_light_color);
+	return ShadeTableKey(LightPal);
+}
+
+
 /**********************************************************************************************
 CreateObjectPaletteTables
 
@@ -2184,6 +2402,72 @@ void CreateTilePaletteTables(const HVOBJECT pObj)
 }
 
 
+struct ShadeTableJob
+{
+	SGPPaletteEntry pal[256];
+	uint64_t        key;
+	UINT16          tables[16][256];
+};
+
+
+static void BuildShadeTableJob(UINT const i, void* const ctx)
+{
+	ShadeTableJob& job = static_cast<ShadeTableJob*>(ctx)[i];
+	for (UINT t = 0; t != 16; ++t) BuildShadedPalette(job.tables[t], job.pal, t);
+}
+
+
+void CreateTilePaletteTables(HVOBJECT const objs[], UINT const n)
+{
+	// Look up the cache first, every palette missing is computed only once
+	std::vector<ShadeTableJob> jobs;
+	std::vector<size_t>        job_of(n, SIZE_MAX);
+	for (UINT i = 0; i != n; ++i)
+	{
+		HVOBJECT const vo = objs[i];
+		SGPPaletteEntry pal[256];
+		AddSaturatePalette(pal, vo->Palette(), &g_light_color);
+		uint64_t const key = ShadeTableKey(pal);
+		if (GetCachedShadeTables(key, vo->pShades))
+		{
+			vo->CurrentShade(4);
+			continue;
+		}
+
+		size_t j = 0;
+		while (j != jobs.size() && jobs[j].key != key) ++j;
+		if (j == jobs.size())
+		{
+			jobs.emplace_back();
+			memcpy(jobs.back().pal, pal, sizeof(pal));
+			jobs.back().key = key;
+		}
+		job_of[i] = j;
+	}
+	if (jobs.empty()) return;
+
+	RunParallel(jobs.size(), BuildShadeTableJob, &jobs[0]);
+
+	for (ShadeTableJob const& job : jobs)
+	{
+		UINT16 const* tables[16];
+		for (UINT t = 0; t != 16; ++t) tables[t] = job.tables[t];
+		AddCachedShadeTables(job.key, tables);
+	}
+	for (UINT i = 0; i != n; ++i)
+	{
+		if (job_of[i] == SIZE_MAX) continue;
+		HVOBJECT const vo = objs[i];
+		for (UINT t = 0; t != 16; ++t)
+		{
+			vo->pShades[t] = MALLOCN(UINT16, 256);
+			memcpy(vo->pShades[t], jobs[job_of[i]].tables[t], sizeof(jobs[0].tables[t]));
+		}
+		vo->CurrentShade(4);
+	}
+}
+
+
 const char* LightSpriteGetTypeName(const LIGHT_SPRITE* const l)
 {
 	return l->light_template->name;
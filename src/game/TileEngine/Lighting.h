@@ -2,6 +2,7 @@
 #define _LIGHTING_H_
 
 #include "JA2Types.h"
+#include "WorldDef.h"
 
 
 /****************************************************************************************
@@ -49,6 +50,12 @@
 #define SHADE_MIN			15 // DARKEST shade value
 #define SHADE_MAX			1 // LIGHTEST shade value
 
+/* ubNaturalShadeLevel of the LEVELNODEs which follow the ambient light level,
+ * and their ubShadeLevel as long as they do. The shade they are drawn with is
+ * resolved by LightNodeShade(), so a change of the ambient light level does
+ * not touch the tiles. */
+#define SHADE_AMBIENT			0x80
+
 
 // light sprite flags
 #define LIGHT_SPR_ACTIVE		0x0001
@@ -84,11 +91,12 @@ void SetDefaultWorldLightingColors(void);
 
 // Low-Level Template Interface
 
-// Sets the normal light level for all tiles in the world
+/* Sets the normal light level for all tiles in the world. Only the tiles
+ * following the ambient level change, see SHADE_AMBIENT. */
 void LightSetBaseLevel(UINT8 iIntensity);
-// Adds a light value to all tiles in the world
+// Brightens the ambient light level
 void LightAddBaseLevel(UINT8 iIntensity);
-// Subtracts a light value from all tiles
+// Darkens the ambient light level
 void LightSubtractBaseLevel(UINT8 iIntensity);
 // Creates an omni (circular) light
 LightTemplate* LightCreateOmni(UINT8 ubIntensity, INT16 iRadius);
@@ -120,6 +128,23 @@ BOOLEAN LightSpriteFake(LIGHT_SPRITE* l);
 	* lights. */
 void LightSpriteRenderAll();
 
+/* The map tiles the light reaches at most, whatever blocks its rays. */
+SGPRect LightSpriteGetArea(LIGHT_SPRITE const*);
+
+/* Resets the tiles of the map rectangle r and draws the lights anew which are
+	* drawn and reach into it, but only within it. Other than erasing a light, this
+	* leaves the tiles exactly as LightSpriteRenderAll() would, when a light was
+	* destroyed within r. */
+void LightSpriteRenderRect(SGPRect const& r);
+
+/* Draws the lights anew which reach into the map rectangle r, after the
+	* structures there changed and so may block other rays now. */
+void LightSpriteRenderAround(SGPRect const& r);
+
+/* Marks the tiles for redrawing whose shade levels the lights changed since the
+	* last call. Called once a frame before the world is rendered. */
+void CommitLightChanges();
+
 // Turns on/off power to a light
 void LightSpritePower(LIGHT_SPRITE* l, BOOLEAN fOn);
 // Moves light to/from roof position
@@ -130,6 +155,9 @@ BOOLEAN ApplyTranslucencyToWalls(INT16 iX, INT16 iY);
 
 // makes the 16-bit palettes
 void CreateTilePaletteTables(HVOBJECT pObj);
+/* Same for several objects at once. The tables missing in the shade table
+ * cache are computed on the worker pool. */
+void CreateTilePaletteTables(HVOBJECT const objs[], UINT n);
 
 // returns the true light value at a tile (ignoring fake/merc lights)
 UINT8 LightTrueLevel( INT16 sGridNo, INT8 bLevel );
@@ -154,10 +182,23 @@ extern SGPPaletteEntry g_light_color;
 // macros
 #define LightGetAmbient() (ubAmbientLightLevel)
 
+// The shade level to draw a LEVELNODE with
+static inline UINT8 LightNodeShade(LEVELNODE const& n)
+{
+	if (!(n.ubShadeLevel & SHADE_AMBIENT)) return n.ubShadeLevel;
+	INT16 const natural = __max(SHADE_MAX, __min(SHADE_MIN, ubAmbientLightLevel));
+	INT16 const shade   = natural - n.ubMaxLights;
+	return (UINT8)__max(SHADE_MAX, __min(SHADE_MIN, shade));
+}
+
 const char* LightSpriteGetTypeName(const LIGHT_SPRITE*);
 
 void CreateBiasedShadedPalettes(UINT16* Shades[16], const SGPPaletteEntry ShadePal[256]);
 
+/* Hash of everything CreateBiasedShadedPalettes() computes the tables of the
+ * palette from, the light colour included. Equal keys give equal tables. */
+uint64_t BiasedShadedPalettesKey(const SGPPaletteEntry ShadePal[256]);
+
 void LoadShadeTablesFromTextFile(void);
 
 #endif
@@ -19,6 +19,8 @@
 
 #include "Message.h"
 
+#include <string.h>
+
 
 //dynamic arrays that contain the valid gridno's for each edge
 INT16 *gps1stNorthEdgepointArray					= NULL;
@@ -922,6 +924,21 @@ bool LoadMapEdgepoints(HWFILE const f)
 }
 
 
+void LoadGeneratedMapEdgepoints(HWFILE const f)
+{
+	TrashMapEdgepoints();
+
+	LoadMapEdgepoint(f, gus1stNorthEdgepointArraySize, gus1stNorthEdgepointMiddleIndex, gps1stNorthEdgepointArray);
+	LoadMapEdgepoint(f, gus1stEastEdgepointArraySize,  gus1stEastEdgepointMiddleIndex,  gps1stEastEdgepointArray);
+	LoadMapEdgepoint(f, gus1stSouthEdgepointArraySize, gus1stSouthEdgepointMiddleIndex, gps1stSouthEdgepointArray);
+	LoadMapEdgepoint(f, gus1stWestEdgepointArraySize,  gus1stWestEdgepointMiddleIndex,  gps1stWestEdgepointArray);
+	LoadMapEdgepoint(f, gus2ndNorthEdgepointArraySize, gus2ndNorthEdgepointMiddleIndex, gps2ndNorthEdgepointArray);
+	LoadMapEdgepoint(f, gus2ndEastEdgepointArraySize,  gus2ndEastEdgepointMiddleIndex,  gps2ndEastEdgepointArray);
+	LoadMapEdgepoint(f, gus2ndSouthEdgepointArraySize, gus2ndSouthEdgepointMiddleIndex, gps2ndSouthEdgepointArray);
+	LoadMapEdgepoint(f, gus2ndWestEdgepointArraySize,  gus2ndWestEdgepointMiddleIndex,  gps2ndWestEdgepointArray);
+}
+
+
 UINT16 ChooseMapEdgepoint( UINT8 ubStrategicInsertionCode )
 {
 	INT16 *psArray=NULL;
@@ -1044,6 +1061,104 @@ void ChooseMapEdgepoints(MAPEDGEPOINTINFO* const pMapEdgepointInfo, const UINT8
 INT16 *gpReservedGridNos = NULL;
 INT16 gsReservedIndex	= 0;
 
+/* For every tile the kinds of edgepoints it is, one bit per insertion code for
+ * the primary and for the secondary edgepoints, so the closest edgepoint
+ * searches test a tile instead of scanning the edgepoint arrays. It is built by
+ * BeginMapEdgepointSearch(). */
+static UINT8 g_edgepoint_tiles[WORLD_MAX];
+
+
+static UINT8 EdgepointTileBit(UINT8 const insertion_code, bool const secondary)
+{
+	UINT8 bit;
+	switch (insertion_code)
+	{
+		case INSERTION_CODE_NORTH: bit = 1U << 0; break;
+		case INSERTION_CODE_EAST:  bit = 1U << 1; break;
+		case INSERTION_CODE_SOUTH: bit = 1U << 2; break;
+		case INSERTION_CODE_WEST:  bit = 1U << 3; break;
+		default:                   return 0;
+	}
+	return secondary ? bit << 4 : bit;
+}
+
+
+static void IndexEdgepoints(INT16 const* const array, UINT16 const n, UINT8 const bit)
+{
+	for (UINT16 i = 0; i != n; ++i)
+	{
+		INT16 const gridno = array[i];
+		if (0 <= gridno && gridno < WORLD_MAX) g_edgepoint_tiles[gridno] |= bit;
+	}
+}
+
+
+static void IndexMapEdgepoints()
+{
+	memset(g_edgepoint_tiles, 0, sizeof(g_edgepoint_tiles));
+	IndexEdgepoints(gps1stNorthEdgepointArray, gus1stNorthEdgepointArraySize, EdgepointTileBit(INSERTION_CODE_NORTH, false));
+	IndexEdgepoints(gps1stEastEdgepointArray,  gus1stEastEdgepointArraySize,  EdgepointTileBit(INSERTION_CODE_EAST,  false));
+	IndexEdgepoints(gps1stSouthEdgepointArray, gus1stSouthEdgepointArraySize, EdgepointTileBit(INSERTION_CODE_SOUTH, false));
+	IndexEdgepoints(gps1stWestEdgepointArray,  gus1stWestEdgepointArraySize,  EdgepointTileBit(INSERTION_CODE_WEST,  false));
+	IndexEdgepoints(gps2ndNorthEdgepointArray, gus2ndNorthEdgepointArraySize, EdgepointTileBit(INSERTION_CODE_NORTH, true));
+	IndexEdgepoints(gps2ndEastEdgepointArray,  gus2ndEastEdgepointArraySize,  EdgepointTileBit(INSERTION_CODE_EAST,  true));
+	IndexEdgepoints(gps2ndSouthEdgepointArray, gus2ndSouthEdgepointArraySize, EdgepointTileBit(INSERTION_CODE_SOUTH, true));
+	IndexEdgepoints(gps2ndWestEdgepointArray,  gus2ndWestEdgepointArraySize,  EdgepointTileBit(INSERTION_CODE_WEST,  true));
+}
+
+
+// Reserves the tile if it is an edgepoint of the kind and not reserved yet
+static bool ReserveEdgepoint(INT16 const sGridNo, UINT8 const bit)
+{
+	if (!(g_edgepoint_tiles[sGridNo] & bit)) return false;
+	for (INT16 i = 0; i < gsReservedIndex; ++i)
+	{
+		if (gpReservedGridNos[i] == sGridNo) return false;
+	}
+	gpReservedGridNos[gsReservedIndex++] = sGridNo;
+	return true;
+}
+
+
+static INT16 SearchForClosestMapEdgepoint(INT16 sGridNo, UINT8 const bit)
+{
+	//Check the initial gridno, to see if it is available and an edgepoint.
+	if (0 <= sGridNo && sGridNo < WORLD_MAX && ReserveEdgepoint(sGridNo, bit)) return sGridNo;
+
+	//spiral outwards, until we find an unreserved mapedgepoint.
+	//
+	// 09 08 07 06
+	// 10	01 00 05
+	// 11 02 03 04
+	// 12 13 14 15 ..
+	INT16 const sOriginalGridNo = sGridNo;
+	for (INT16 sRadius = 1; sRadius < (INT16)(gbWorldSectorZ ? 30 : 10); ++sRadius)
+	{
+		sGridNo = sOriginalGridNo + (-1 - WORLD_COLS)*sRadius; //start at the TOP-LEFT gridno
+		for (INT32 iDirectionLoop = 0; iDirectionLoop < 4; iDirectionLoop++)
+		{
+			INT16 sDirection = WORLD_COLS;
+			switch( iDirectionLoop )
+			{
+				case 0:	sDirection = WORLD_COLS;	break;
+				case 1:	sDirection = 1;						break;
+				case 2:	sDirection = -WORLD_COLS;	break;
+				case 3:	sDirection = -1;					break;
+			}
+			INT16 sDistance = sRadius * 2;
+			while( sDistance-- )
+			{
+				sGridNo += sDirection;
+				if( sGridNo < 0 || sGridNo >= WORLD_MAX )
+					continue;
+				if (ReserveEdgepoint(sGridNo, bit)) return sGridNo;
+			}
+		}
+	}
+	return NOWHERE;
+}
+
+
 void BeginMapEdgepointSearch()
 {
 	INT16 sGridNo;
@@ -1053,6 +1168,8 @@ void BeginMapEdgepointSearch()
 	gpReservedGridNos = MALLOCN(INT16, 20);
 	gsReservedIndex   = 0;
 
+	IndexMapEdgepoints();
+
 	if( gMapInformation.sNorthGridNo != -1 )
 		sGridNo = gMapInformation.sNorthGridNo;
 	else if( gMapInformation.sEastGridNo != -1 )
@@ -1081,11 +1198,7 @@ void EndMapEdgepointSearch()
 //THIS CODE ISN'T RECOMMENDED FOR TIME CRITICAL AREAS.
 INT16 SearchForClosestPrimaryMapEdgepoint( INT16 sGridNo, UINT8 ubInsertionCode )
 {
-	INT32 i, iDirectionLoop;
-	INT16 *psArray=NULL;
-	INT16 sRadius, sDistance, sDirection, sOriginalGridNo;
 	UINT16 usArraySize=0;
-	BOOLEAN fReserved;
 
 	if( gsReservedIndex >= 20 )
 	{ //Everything is reserved.
@@ -1094,22 +1207,18 @@ INT16 SearchForClosestPrimaryMapEdgepoint( INT16 sGridNo, UINT8 ubInsertionCode
 	switch( ubInsertionCode )
 	{
 		case INSERTION_CODE_NORTH:
-			psArray = gps1stNorthEdgepointArray;
 			usArraySize = gus1stNorthEdgepointArraySize;
 			AssertMsg(usArraySize != 0, String("Sector %c%d level %d doesn't have any north mapedgepoints. LC:1", gWorldSectorY + 'A' - 1, gWorldSectorX, gbWorldSectorZ));
 			break;
 		case INSERTION_CODE_EAST:
-			psArray = gps1stEastEdgepointArray;
 			usArraySize = gus1stEastEdgepointArraySize;
 			AssertMsg(usArraySize != 0, String("Sector %c%d level %d doesn't have any east mapedgepoints. LC:1", gWorldSectorY + 'A' - 1, gWorldSectorX, gbWorldSectorZ));
 			break;
 		case INSERTION_CODE_SOUTH:
-			psArray = gps1stSouthEdgepointArray;
 			usArraySize = gus1stSouthEdgepointArraySize;
 			AssertMsg(usArraySize != 0, String("Sector %c%d level %d doesn't have any south mapedgepoints. LC:1", gWorldSectorY + 'A' - 1, gWorldSectorX, gbWorldSectorZ));
 			break;
 		case INSERTION_CODE_WEST:
-			psArray = gps1stWestEdgepointArray;
 			usArraySize = gus1stWestEdgepointArraySize;
 			AssertMsg(usArraySize != 0, String("Sector %c%d level %d doesn't have any west mapedgepoints. LC:1", gWorldSectorY + 'A' - 1, gWorldSectorX, gbWorldSectorZ));
 			break;
@@ -1119,92 +1228,12 @@ INT16 SearchForClosestPrimaryMapEdgepoint( INT16 sGridNo, UINT8 ubInsertionCode
 		return NOWHERE;
 	}
 
-	//Check the initial gridno, to see if it is available and an edgepoint.
-	fReserved = FALSE;
-	for( i = 0; i < gsReservedIndex; i++ )
-	{
-		if( gpReservedGridNos[ i ] == sGridNo )
-		{
-			fReserved = TRUE;
-			break;
-		}
-	}
-	if( !fReserved )
-	{	//Not reserved, so see if we can find this gridno in the edgepoint array.
-		for( i = 0 ; i < usArraySize; i++ )
-		{
-			if( psArray[ i ] == sGridNo )
-			{ //Yes, the gridno is in the edgepoint array.
-				gpReservedGridNos[ gsReservedIndex ] = sGridNo;
-				gsReservedIndex++;
-				return sGridNo;
-			}
-		}
-	}
-
-	//spiral outwards, until we find an unreserved mapedgepoint.
-	//
-	// 09 08 07 06
-	// 10	01 00 05
-	// 11 02 03 04
-	// 12 13 14 15 ..
-	sRadius = 1;
-	sDirection = WORLD_COLS;
-	sOriginalGridNo = sGridNo;
-	while( sRadius < (INT16)(gbWorldSectorZ ? 30 : 10) )
-	{
-		sGridNo = sOriginalGridNo + (-1 - WORLD_COLS)*sRadius; //start at the TOP-LEFT gridno
-		for( iDirectionLoop = 0; iDirectionLoop < 4; iDirectionLoop++ )
-		{
-			switch( iDirectionLoop )
-			{
-				case 0:	sDirection = WORLD_COLS;	break;
-				case 1:	sDirection = 1;						break;
-				case 2:	sDirection = -WORLD_COLS;	break;
-				case 3:	sDirection = -1;					break;
-			}
-			sDistance = sRadius * 2;
-			while( sDistance-- )
-			{
-				sGridNo += sDirection;
-				if( sGridNo < 0 || sGridNo >= WORLD_MAX )
-					continue;
-				//Check the gridno, to see if it is available and an edgepoint.
-				fReserved = FALSE;
-				for( i = 0; i < gsReservedIndex; i++ )
-				{
-					if( gpReservedGridNos[ i ] == sGridNo )
-					{
-						fReserved = TRUE;
-						break;
-					}
-				}
-				if( !fReserved )
-				{	//Not reserved, so see if we can find this gridno in the edgepoint array.
-					for( i = 0 ; i < usArraySize; i++ )
-					{
-						if( psArray[ i ] == sGridNo )
-						{ //Yes, the gridno is in the edgepoint array.
-							gpReservedGridNos[ gsReservedIndex ] = sGridNo;
-							gsReservedIndex++;
-							return sGridNo;
-						}
-					}
-				}
-			}
-		}
-		sRadius++;
-	}
-	return NOWHERE ;
+	return SearchForClosestMapEdgepoint(sGridNo, EdgepointTileBit(ubInsertionCode, false));
 }
 
 INT16 SearchForClosestSecondaryMapEdgepoint( INT16 sGridNo, UINT8 ubInsertionCode )
 {
-	INT32 i, iDirectionLoop;
-	INT16 *psArray=NULL;
-	INT16 sRadius, sDistance, sDirection, sOriginalGridNo;
 	UINT16 usArraySize=0;
-	BOOLEAN fReserved;
 
 	if( gsReservedIndex >= 20 )
 	{ //Everything is reserved.
@@ -1213,22 +1242,18 @@ INT16 SearchForClosestSecondaryMapEdgepoint( INT16 sGridNo, UINT8 ubInsertionCod
 	switch( ubInsertionCode )
 	{
 		case INSERTION_CODE_NORTH:
-			psArray = gps2ndNorthEdgepointArray;
 			usArraySize = gus2ndNorthEdgepointArraySize;
 			AssertMsg(usArraySize != 0, String("Sector %c%d level %d doesn't have any isolated north mapedgepoints. KM:1", gWorldSectorY + 'A' - 1, gWorldSectorX, gbWorldSectorZ));
 			break;
 		case INSERTION_CODE_EAST:
-			psArray = gps2ndEastEdgepointArray;
 			usArraySize = gus2ndEastEdgepointArraySize;
 			AssertMsg(usArraySize != 0, String("Sector %c%d level %d doesn't have any isolated east mapedgepoints. KM:1", gWorldSectorY + 'A' - 1, gWorldSectorX, gbWorldSectorZ));
 			break;
 		case INSERTION_CODE_SOUTH:
-			psArray = gps2ndSouthEdgepointArray;
 			usArraySize = gus2ndSouthEdgepointArraySize;
 			AssertMsg(usArraySize != 0, String("Sector %c%d level %d doesn't have any isolated south mapedgepoints. KM:1", gWorldSectorY + 'A' - 1, gWorldSectorX, gbWorldSectorZ));
 			break;
 		case INSERTION_CODE_WEST:
-			psArray = gps2ndWestEdgepointArray;
 			usArraySize = gus2ndWestEdgepointArraySize;
 			AssertMsg(usArraySize != 0, String("Sector %c%d level %d doesn't have any isolated west mapedgepoints. KM:1", gWorldSectorY + 'A' - 1, gWorldSectorX, gbWorldSectorZ));
 			break;
@@ -1238,83 +1263,7 @@ INT16 SearchForClosestSecondaryMapEdgepoint( INT16 sGridNo, UINT8 ubInsertionCod
 		return NOWHERE;
 	}
 
-	//Check the initial gridno, to see if it is available and an edgepoint.
-	fReserved = FALSE;
-	for( i = 0; i < gsReservedIndex; i++ )
-	{
-		if( gpReservedGridNos[ i ] == sGridNo )
-		{
-			fReserved = TRUE;
-			break;
-		}
-	}
-	if( !fReserved )
-	{	//Not reserved, so see if we can find this gridno in the edgepoint array.
-		for( i = 0 ; i < usArraySize; i++ )
-		{
-			if( psArray[ i ] == sGridNo )
-			{ //Yes, the gridno is in the edgepoint array.
-				gpReservedGridNos[ gsReservedIndex ] = sGridNo;
-				gsReservedIndex++;
-				return sGridNo;
-			}
-		}
-	}
-
-	//spiral outwards, until we find an unreserved mapedgepoint.
-	//
-	// 09 08 07 06
-	// 10	01 00 05
-	// 11 02 03 04
-	// 12 13 14 15 ..
-	sRadius = 1;
-	sDirection = WORLD_COLS;
-	sOriginalGridNo = sGridNo;
-	while( sRadius < (INT16)(gbWorldSectorZ ? 30 : 10) )
-	{
-		sGridNo = sOriginalGridNo + (-1 - WORLD_COLS)*sRadius; //start at the TOP-LEFT gridno
-		for( iDirectionLoop = 0; iDirectionLoop < 4; iDirectionLoop++ )
-		{
-			switch( iDirectionLoop )
-			{
-				case 0:	sDirection = WORLD_COLS;	break;
-				case 1:	sDirection = 1;						break;
-				case 2:	sDirection = -WORLD_COLS;	break;
-				case 3:	sDirection = -1;					break;
-			}
-			sDistance = sRadius * 2;
-			while( sDistance-- )
-			{
-				sGridNo += sDirection;
-				if( sGridNo < 0 || sGridNo >= WORLD_MAX )
-					continue;
-				//Check the gridno, to see if it is available and an edgepoint.
-				fReserved = FALSE;
-				for( i = 0; i < gsReservedIndex; i++ )
-				{
-					if( gpReservedGridNos[ i ] == sGridNo )
-					{
-						fReserved = TRUE;
-						break;
-					}
-				}
-				if( !fReserved )
-				{	//Not reserved, so see if we can find this gridno in the edgepoint array.
-					for( i = 0 ; i < usArraySize; i++ )
-					{
-						if( psArray[ i ] == sGridNo )
-						{ //Yes, the gridno is in the edgepoint array.
-							gpReservedGridNos[ gsReservedIndex ] = sGridNo;
-							gsReservedIndex++;
-							return sGridNo;
-						}
-					}
-				}
-			}
-		}
-		sRadius++;
-	}
-	return NOWHERE ;
+	return SearchForClosestMapEdgepoint(sGridNo, EdgepointTileBit(ubInsertionCode, true));
 }
 
 
@@ -17,6 +17,9 @@ void GenerateMapEdgepoints(void);
 void SaveMapEdgepoints(HWFILE);
 
 bool LoadMapEdgepoints(HWFILE);
+/* Reads both layers of edgepoints written by SaveMapEdgepoints(), whatever the
+ * version of the loaded map. */
+void LoadGeneratedMapEdgepoints(HWFILE);
 void TrashMapEdgepoints(void);
 
 //dynamic arrays that contain the valid gridno's for each edge
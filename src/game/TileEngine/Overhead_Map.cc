@@ -9,6 +9,7 @@
 #include "TileDef.h"
 #include "VSurface.h"
 #include "WorldDef.h"
+#include "Lighting.h"
 #include "Isometric_Utils.h"
 #include "RenderWorld.h"
 #include "WorldDat.h"
@@ -84,6 +85,11 @@ static INT16           gsStartRestrictedX;
 static INT16           gsStartRestrictedY;
 static INT16           gsOveritemPoolGridNo           = NOWHERE;
 
+/* The tiles of the map as last rendered, which are put back as long as nothing
+ * they are rendered from changed. Only the mercs and items are drawn anew. */
+static SGPVSurface*    g_overhead_map_cache;
+static UINT32          g_overhead_map_cache_key;
+
 
 static void CopyOverheadDBShadetablesFromTileset(void);
 
@@ -472,16 +478,8 @@ static INT16 GetModifiedOffsetLandHeight(INT32 const gridno)
 }
 
 
-void RenderOverheadMap(INT16 const sStartPointX_M, INT16 const sStartPointY_M, INT16 const sStartPointX_S, INT16 const sStartPointY_S, INT16 const sEndXS, INT16 const sEndYS, BOOLEAN const fFromMapUtility)
+static void RenderOverheadTiles(INT16 const sStartPointX_M, INT16 const sStartPointY_M, INT16 const sStartPointX_S, INT16 const sStartPointY_S, INT16 const sEndXS, INT16 const sEndYS)
 {
-	if (!gfOverheadMapDirty) return;
-
-	// Black out
-	ColorFillVideoSurfaceArea(FRAME_BUFFER, sStartPointX_S, sStartPointY_S, sEndXS,	sEndYS, 0);
-
-	InvalidateScreen();
-	gfOverheadMapDirty = FALSE;
-
 	{ SGPVSurface::Lock l(FRAME_BUFFER);
 		UINT16* const pDestBuf         = l.Buffer<UINT16>();
 		UINT32  const uiDestPitchBYTES = l.Pitch();
@@ -510,7 +508,7 @@ void RenderOverheadMap(INT16 const sStartPointX_M, INT16 const sStartPointY_M, I
 							SMALL_TILE_DB const& pTile = gSmTileDB[n->usIndex];
 							INT16         const  sX    = sTempPosX_S;
 							INT16         const  sY    = sTempPosY_S - sHeight + gsRenderHeight / 5;
-							pTile.vo->CurrentShade(n->ubShadeLevel);
+							pTile.vo->CurrentShade(LightNodeShade(*n));
 							Blt8BPPDataTo16BPPBufferTransparent(pDestBuf, uiDestPitchBYTES, pTile.vo, sX, sY, pTile.usSubIndex);
 						}
 					}
@@ -578,7 +576,7 @@ void RenderOverheadMap(INT16 const sStartPointX_M, INT16 const sStartPointY_M, I
 
 							sY += gsRenderHeight / 5;
 
-							pTile.vo->CurrentShade(n->ubShadeLevel);
+							pTile.vo->CurrentShade(LightNodeShade(*n));
 							Blt8BPPDataTo16BPPBufferTransparent(pDestBuf, uiDestPitchBYTES, pTile.vo, sX, sY, pTile.usSubIndex);
 						}
 
@@ -592,7 +590,7 @@ void RenderOverheadMap(INT16 const sStartPointX_M, INT16 const sStartPointY_M, I
 
 							sY += gsRenderHeight / 5;
 
-							pTile.vo->CurrentShade(n->ubShadeLevel);
+							pTile.vo->CurrentShade(LightNodeShade(*n));
 							Blt8BPPDataTo16BPPBufferShadow(pDestBuf, uiDestPitchBYTES, pTile.vo, sX, sY, pTile.usSubIndex);
 						}
 
@@ -617,7 +615,7 @@ void RenderOverheadMap(INT16 const sStartPointX_M, INT16 const sStartPointY_M, I
 
 							sY += gsRenderHeight / 5;
 
-							pTile.vo->CurrentShade(n->ubShadeLevel);
+							pTile.vo->CurrentShade(LightNodeShade(*n));
 							Blt8BPPDataTo16BPPBufferTransparent(pDestBuf, uiDestPitchBYTES, pTile.vo, sX, sY, pTile.usSubIndex);
 						}
 					}
@@ -676,7 +674,7 @@ void RenderOverheadMap(INT16 const sStartPointX_M, INT16 const sStartPointY_M, I
 							sY -= WALL_HEIGHT / 5;
 							sY += gsRenderHeight / 5;
 
-							pTile.vo->CurrentShade(n->ubShadeLevel);
+							pTile.vo->CurrentShade(LightNodeShade(*n));
 
 							// RENDER!
 							Blt8BPPDataTo16BPPBufferTransparent(pDestBuf, uiDestPitchBYTES, pTile.vo, sX, sY, pTile.usSubIndex);
@@ -704,6 +702,84 @@ void RenderOverheadMap(INT16 const sStartPointX_M, INT16 const sStartPointY_M, I
 			while (sAnchorPosY_S < sEndYS);
 		}
 	}
+}
+
+
+/* Hash of everything the tiles of the overhead map are rendered from */
+static UINT32 HashOverheadMap(INT16 const sStartPointX_M, INT16 const sStartPointY_M, INT16 const sStartPointX_S, INT16 const sStartPointY_S, INT16 const sEndXS, INT16 const sEndYS)
+{
+	UINT32 h = 2166136261U; // FNV-1a
+#define HASH(v) (h = (h ^ UINT32(v)) * 16777619U)
+	HASH(sStartPointX_M);
+	HASH(sStartPointY_M);
+	HASH(sStartPointX_S);
+	HASH(sStartPointY_S);
+	HASH(sEndXS);
+	HASH(sEndYS);
+	HASH(gsRenderHeight);
+	HASH(giCurrentTilesetID);
+	HASH(g_light_color.r << 16 | g_light_color.g << 8 | g_light_color.b);
+#define HASH_NODE(n) (HASH(n->usIndex << 8 | LightNodeShade(*n)), HASH(n->uiFlags & (LEVELNODE_ITEM | LEVELNODE_HIDDEN)))
+	for (UINT32 i = 0; i != GRIDSIZE; ++i)
+	{
+		MAP_ELEMENT const& e = gpWorldLevelData[i];
+		HASH(e.sHeight);
+		for (LEVELNODE const* n = e.pLandStart;  n; n = n->pPrevNode) HASH_NODE(n);
+		for (LEVELNODE const* n = e.pObjectHead; n; n = n->pNext)     HASH_NODE(n);
+		for (LEVELNODE const* n = e.pShadowHead; n; n = n->pNext)     HASH_NODE(n);
+		for (LEVELNODE const* n = e.pStructHead; n; n = n->pNext)     HASH_NODE(n);
+		for (LEVELNODE const* n = e.pRoofHead;   n; n = n->pNext)     HASH_NODE(n);
+	}
+#undef HASH_NODE
+#undef HASH
+	return h;
+}
+
+
+static bool RestoreOverheadMapFromCache(UINT32 const key, INT16 const x1, INT16 const y1, INT16 const x2, INT16 const y2)
+{
+	SGPVSurface* const vs = g_overhead_map_cache;
+	if (!vs || key != g_overhead_map_cache_key)        return false;
+	if (vs->Width() != x2 - x1 || vs->Height() != y2 - y1) return false;
+
+	BltVideoSurface(FRAME_BUFFER, vs, x1, y1, NULL);
+	return true;
+}
+
+
+static void CacheOverheadMap(UINT32 const key, INT16 const x1, INT16 const y1, INT16 const x2, INT16 const y2)
+{
+	if (g_overhead_map_cache &&
+			(g_overhead_map_cache->Width() != x2 - x1 || g_overhead_map_cache->Height() != y2 - y1))
+	{
+		DeleteVideoSurface(g_overhead_map_cache);
+		g_overhead_map_cache = NULL;
+	}
+	if (!g_overhead_map_cache) g_overhead_map_cache = AddVideoSurface(x2 - x1, y2 - y1, PIXEL_DEPTH);
+
+	SGPBox const r = { UINT16(x1), UINT16(y1), UINT16(x2 - x1), UINT16(y2 - y1) };
+	BltVideoSurface(g_overhead_map_cache, FRAME_BUFFER, 0, 0, &r);
+	g_overhead_map_cache_key = key;
+}
+
+
+void RenderOverheadMap(INT16 const sStartPointX_M, INT16 const sStartPointY_M, INT16 const sStartPointX_S, INT16 const sStartPointY_S, INT16 const sEndXS, INT16 const sEndYS, BOOLEAN const fFromMapUtility)
+{
+	if (!gfOverheadMapDirty) return;
+
+	// Black out
+	ColorFillVideoSurfaceArea(FRAME_BUFFER, sStartPointX_S, sStartPointY_S, sEndXS,	sEndYS, 0);
+
+	InvalidateScreen();
+	gfOverheadMapDirty = FALSE;
+
+	// The map utility renders each map once, so don't bother with the cache
+	UINT32 const key = fFromMapUtility ? 0 : HashOverheadMap(sStartPointX_M, sStartPointY_M, sStartPointX_S, sStartPointY_S, sEndXS, sEndYS);
+	if (fFromMapUtility || !RestoreOverheadMapFromCache(key, sStartPointX_S, sStartPointY_S, sEndXS, sEndYS))
+	{
+		RenderOverheadTiles(sStartPointX_M, sStartPointY_M, sStartPointX_S, sStartPointY_S, sEndXS, sEndYS);
+		if (!fFromMapUtility) CacheOverheadMap(key, sStartPointX_S, sStartPointY_S, sEndXS, sEndYS);
+	}
 
 	// OK, blacken out edges of smaller maps...
 	if (gMapInformation.ubRestrictedScrollID != 0)
@@ -959,6 +1035,12 @@ static void CopyOverheadDBShadetablesFromTileset(void)
 
 void TrashOverheadMap(void)
 {
+	if (g_overhead_map_cache)
+	{
+		DeleteVideoSurface(g_overhead_map_cache);
+		g_overhead_map_cache = NULL;
+	}
+
 	if (gubSmTileNum == TILESET_INVALID) return;
 	gubSmTileNum = TILESET_INVALID;
 
@@ -196,26 +196,40 @@ static BOOLEAN RemoveRealObject(REAL_OBJECT* const o)
 static void SimulateObject(REAL_OBJECT* pObject, float deltaT);
 
 
+#define MAX_PHYSICS_STEPS 4 // steps caught up with in one call at most
+
+
+// JA2 clock time the objects have been simulated up to
+static UINT32 guiPhysicsClock;
+
+
+/* Every step simulates PHYSICSUPDATE ms of the JA2 clock, and as many steps
+ * are run as fit into the time passed since the last call. So objects fly at
+ * the same speed whatever the frame rate, instead of slowing down with it. */
 void SimulateWorld(  )
 {
-	UINT32					cnt;
-	REAL_OBJECT		*pObject;
+	UINT32 const now  = GetJA2Clock();
+	UINT32 const step = giTimerIntervals[PHYSICSUPDATE];
 
+	/* Nothing flying, or the clock was set back, e.g. by loading a game. A new
+	 * object starts with the next step. */
+	if (guiNumObjectSlots == 0 || now < guiPhysicsClock) guiPhysicsClock = now;
 
-	if ( COUNTERDONE( PHYSICSUPDATE ) )
+	// Do not try to catch up after a long frame
+	if (now - guiPhysicsClock > MAX_PHYSICS_STEPS * step)
 	{
-		RESETCOUNTER( PHYSICSUPDATE );
+		guiPhysicsClock = now - MAX_PHYSICS_STEPS * step;
+	}
 
-		for( cnt = 0;cnt < guiNumObjectSlots; cnt++)
+	for (; now - guiPhysicsClock >= step; guiPhysicsClock += step)
+	{
+		for (UINT32 cnt = 0; cnt < guiNumObjectSlots; cnt++)
 		{
 			// CHECK FOR ALLOCATED
-			if( ObjectSlots[ cnt ].fAllocated )
-			{
-				// Get object
-				pObject = &( ObjectSlots[ cnt ] );
+			REAL_OBJECT* const pObject = &ObjectSlots[cnt];
+			if (!pObject->fAllocated) continue;
 
-				SimulateObject( pObject, (float)DELTA_T );
-			}
+			SimulateObject( pObject, (float)DELTA_T );
 		}
 	}
 }
@@ -1226,6 +1240,145 @@ static BOOLEAN PhysicsMoveObject(REAL_OBJECT* pObject)
 static FLOAT CalculateObjectTrajectory(INT16 sTargetZ, const OBJECTTYPE* pItem, vector_3* vPosition, vector_3* vForce, INT16* psFinalGridNo);
 
 
+/* The same throws are searched for over and over, by the AI for every tile it
+ * considers a grenade for and by the UI while the cursor rests on a tile.
+ * Trajectories without collisions only depend on the throw, so the forces and
+ * angles found for them are kept. The trajectories through the world depend on
+ * the structures as well and are kept under guiStructuresVersion. */
+#define TRAJECTORY_CACHE_SIZE 512
+
+enum TrajectorySearch
+{
+	SEARCH_FORCE, // the force for a given angle
+	SEARCH_ANGLE  // the angle for a given force
+};
+
+struct TrajectorySolution
+{
+	bool             valid;
+	TrajectorySearch search;
+	INT16            src;
+	INT16            dst;
+	INT16            start_z;
+	INT16            end_z;
+	float            given;    // angle or force
+	UINT16           item;
+	float            result;   // force or angle
+	INT16            grid_no;  // where the object came down
+};
+
+struct TrajectoryCollision
+{
+	bool     valid;
+	UINT32   uiStructuresVersion;
+	vector_3 position;
+	vector_3 force;
+	INT16    target_z;
+	UINT16   item;
+	BOOLEAN  from_ui;
+	INT32    chance;
+	INT16    grid_no;
+	INT8     level;
+};
+
+static TrajectorySolution  g_trajectory_solutions[TRAJECTORY_CACHE_SIZE];
+static TrajectoryCollision g_trajectory_collisions[TRAJECTORY_CACHE_SIZE];
+
+
+static void HashTrajectory(UINT32& hash, UINT32 const v)
+{
+	hash = (hash ^ v) * 16777619U; // FNV-1a
+}
+
+
+static void HashTrajectory(UINT32& hash, float const v)
+{
+	UINT32 bits;
+	memcpy(&bits, &v, sizeof(bits));
+	HashTrajectory(hash, bits);
+}
+
+
+static TrajectorySolution& TrajectorySolutionSlot(TrajectorySearch const search, INT16 const src, INT16 const dst, INT16 const start_z, INT16 const end_z, float const given, OBJECTTYPE const* const item)
+{
+	UINT32 hash = 2166136261U;
+	HashTrajectory(hash, (UINT32)search);
+	HashTrajectory(hash, (UINT32)(UINT16)src << 16 | (UINT16)dst);
+	HashTrajectory(hash, (UINT32)(UINT16)start_z << 16 | (UINT16)end_z);
+	HashTrajectory(hash, given);
+	HashTrajectory(hash, (UINT32)item->usItem);
+	return g_trajectory_solutions[hash % TRAJECTORY_CACHE_SIZE];
+}
+
+
+static bool IsTrajectorySolution(TrajectorySolution const& s, TrajectorySearch const search, INT16 const src, INT16 const dst, INT16 const start_z, INT16 const end_z, float const given, OBJECTTYPE const* const item)
+{
+	return
+		s.valid                &&
+		s.search  == search    &&
+		s.src     == src       &&
+		s.dst     == dst       &&
+		s.start_z == start_z   &&
+		s.end_z   == end_z     &&
+		s.given   == given     &&
+		s.item    == item->usItem;
+}
+
+
+static void SetTrajectorySolution(TrajectorySolution& s, TrajectorySearch const search, INT16 const src, INT16 const dst, INT16 const start_z, INT16 const end_z, float const given, OBJECTTYPE const* const item, float const result, INT16 const grid_no)
+{
+	s.valid   = true;
+	s.search  = search;
+	s.src     = src;
+	s.dst     = dst;
+	s.start_z = start_z;
+	s.end_z   = end_z;
+	s.given   = given;
+	s.item    = item->usItem;
+	s.result  = result;
+	s.grid_no = grid_no;
+}
+
+
+/* The ballistic force for a range ignores the air resistance. How far off it
+ * was for the last searches of an angle is the first guess for the next one, so
+ * the search mostly starts next to the force it is looking for. */
+#define FORCE_GUESSES 8
+
+struct ForceGuess
+{
+	float degrees;
+	float ratio; // force found / ballistic force
+};
+
+static ForceGuess g_force_guesses[FORCE_GUESSES];
+static UINT       g_next_force_guess;
+
+
+static float ForceGuessRatio(float const degrees)
+{
+	for (ForceGuess const& g : g_force_guesses)
+	{
+		if (g.ratio != 0 && g.degrees == degrees) return g.ratio;
+	}
+	return 1;
+}
+
+
+static void SetForceGuessRatio(float const degrees, float const ratio)
+{
+	for (ForceGuess& g : g_force_guesses)
+	{
+		if (g.ratio == 0 || g.degrees != degrees) continue;
+		g.ratio = ratio;
+		return;
+	}
+	ForceGuess& g = g_force_guesses[g_next_force_guess++ % FORCE_GUESSES];
+	g.degrees = degrees;
+	g.ratio   = ratio;
+}
+
+
 static vector_3 FindBestForceForTrajectory(INT16 sSrcGridNo, INT16 sGridNo, INT16 sStartZ, INT16 sEndZ, float dzDegrees, const OBJECTTYPE* pItem, INT16* psGridNo, float* pdMagForce)
 {
 	vector_3 vDirNormal, vPosition, vForce;
@@ -1259,11 +1412,23 @@ static vector_3 FindBestForceForTrajectory(INT16 sSrcGridNo, INT16 sGridNo, INT1
 	// Get range
 	dRange = (float)GetRangeInCellCoordsFromGridNoDiff( sGridNo, sSrcGridNo );
 
-	//calculate force needed
+	TrajectorySolution& cached = TrajectorySolutionSlot(SEARCH_FORCE, sSrcGridNo, sGridNo, sStartZ, sEndZ, dzDegrees, pItem);
+	if (IsTrajectorySolution(cached, SEARCH_FORCE, sSrcGridNo, sGridNo, sStartZ, sEndZ, dzDegrees, pItem))
 	{
-		dForce = (float)( 12 * ( sqrt( ( GRAVITY * dRange ) / sin( 2 * dzDegrees ) ) ) );
+		dForce = cached.result;
+		if (psGridNo) *psGridNo = cached.grid_no;
+		if (pdMagForce) *pdMagForce = dForce;
+		vForce.x = dForce * vDirNormal.x;
+		vForce.y = dForce * vDirNormal.y;
+		vForce.z = dForce * vDirNormal.z;
+		return vForce;
 	}
 
+	//calculate force needed
+	float const dBallisticForce = (float)( 12 * ( sqrt( ( GRAVITY * dRange ) / sin( 2 * dzDegrees ) ) ) );
+	dForce = dBallisticForce * ForceGuessRatio(dzDegrees);
+
+	INT16 sGridNoReached;
 	do
 	{
 		// This first force is just an estimate...
@@ -1276,7 +1441,7 @@ static vector_3 FindBestForceForTrajectory(INT16 sSrcGridNo, INT16 sGridNo, INT1
 		vForce.y = dForce * vDirNormal.y;
 		vForce.z = dForce * vDirNormal.z;
 
-		dTestRange = CalculateObjectTrajectory( sEndZ, pItem, &vPosition, &vForce, psGridNo );
+		dTestRange = CalculateObjectTrajectory( sEndZ, pItem, &vPosition, &vForce, &sGridNoReached );
 
 		// What's the diff?
 		dTestDiff = dTestRange - dRange;
@@ -1285,6 +1450,7 @@ static vector_3 FindBestForceForTrajectory(INT16 sSrcGridNo, INT16 sGridNo, INT1
 		// < 5% off...
 		if ( fabs( ( dTestDiff / dRange ) ) < .01 )
 		{
+			if (dBallisticForce > 0) SetForceGuessRatio(dzDegrees, dForce / dBallisticForce);
 			break;
 		}
 
@@ -1311,13 +1477,15 @@ static vector_3 FindBestForceForTrajectory(INT16 sSrcGridNo, INT16 sGridNo, INT1
 	{
 		(*pdMagForce) = dForce;
 	}
+	if (psGridNo) *psGridNo = sGridNoReached;
+	SetTrajectorySolution(cached, SEARCH_FORCE, sSrcGridNo, sGridNo, sStartZ, sEndZ, dzDegrees, pItem, dForce, sGridNoReached);
 	SLOGD("Number of integration: %d", iNumChecks );
 
 	return( vForce );
 }
 
 
-static float FindBestAngleForTrajectory(INT16 sSrcGridNo, INT16 sGridNo, INT16 sStartZ, INT16 sEndZ, float dForce, const OBJECTTYPE* pItem, INT16* psGridNo)
+static float SearchBestAngleForTrajectory(INT16 sSrcGridNo, INT16 sGridNo, INT16 sStartZ, INT16 sEndZ, float dForce, const OBJECTTYPE* pItem, INT16* psGridNo)
 {
 	vector_3 vDirNormal, vPosition, vForce;
 	INT16    sDestX, sDestY, sSrcX, sSrcY;
@@ -1416,6 +1584,20 @@ static float FindBestAngleForTrajectory(INT16 sSrcGridNo, INT16 sGridNo, INT16 s
 }
 
 
+static float FindBestAngleForTrajectory(INT16 const sSrcGridNo, INT16 const sGridNo, INT16 const sStartZ, INT16 const sEndZ, float const dForce, const OBJECTTYPE* const pItem, INT16* const psGridNo)
+{
+	TrajectorySolution& cached = TrajectorySolutionSlot(SEARCH_ANGLE, sSrcGridNo, sGridNo, sStartZ, sEndZ, dForce, pItem);
+	if (!IsTrajectorySolution(cached, SEARCH_ANGLE, sSrcGridNo, sGridNo, sStartZ, sEndZ, dForce, pItem))
+	{
+		INT16       grid_no;
+		float const degrees = SearchBestAngleForTrajectory(sSrcGridNo, sGridNo, sStartZ, sEndZ, dForce, pItem, &grid_no);
+		SetTrajectorySolution(cached, SEARCH_ANGLE, sSrcGridNo, sGridNo, sStartZ, sEndZ, dForce, pItem, degrees, grid_no);
+	}
+	if (psGridNo) *psGridNo = cached.grid_no;
+	return cached.result;
+}
+
+
 static void FindTrajectory(INT16 sSrcGridNo, INT16 sGridNo, INT16 sStartZ, INT16 sEndZ, float dForce, float dzDegrees, const OBJECTTYPE* pItem, INT16* psGridNo)
 {
 	vector_3 vDirNormal, vPosition, vForce;
@@ -1496,7 +1678,7 @@ static FLOAT CalculateObjectTrajectory(INT16 sTargetZ, const OBJECTTYPE* pItem,
 }
 
 
-static INT32 ChanceToGetThroughObjectTrajectory(INT16 sTargetZ, const OBJECTTYPE* pItem, vector_3* vPosition, vector_3* vForce, INT16* psNewGridNo, INT8* pbLevel, BOOLEAN fFromUI)
+static INT32 SimulateChanceToGetThroughObjectTrajectory(INT16 sTargetZ, const OBJECTTYPE* pItem, vector_3* vPosition, vector_3* vForce, INT16* psNewGridNo, INT8* pbLevel, BOOLEAN fFromUI)
 {
 	REAL_OBJECT* const pObject = CreatePhysicalObject(pItem, -1, vPosition->x, vPosition->y, vPosition->z, vForce->x, vForce->y, vForce->z, NULL, NO_THROW_ACTION, 0);
 
@@ -1542,6 +1724,53 @@ static INT32 ChanceToGetThroughObjectTrajectory(INT16 sTargetZ, const OBJECTTYPE
 }
 
 
+static bool SameVector(vector_3 const& a, vector_3 const& b)
+{
+	return a.x == b.x && a.y == b.y && a.z == b.z;
+}
+
+
+static INT32 ChanceToGetThroughObjectTrajectory(INT16 const sTargetZ, const OBJECTTYPE* const pItem, vector_3* const vPosition, vector_3* const vForce, INT16* const psNewGridNo, INT8* const pbLevel, BOOLEAN const fFromUI)
+{
+	UINT32 hash = 2166136261U;
+	HashTrajectory(hash, vPosition->x);
+	HashTrajectory(hash, vPosition->y);
+	HashTrajectory(hash, vPosition->z);
+	HashTrajectory(hash, vForce->x);
+	HashTrajectory(hash, vForce->y);
+	HashTrajectory(hash, vForce->z);
+	HashTrajectory(hash, (UINT32)(UINT16)sTargetZ << 16 | pItem->usItem);
+	HashTrajectory(hash, (UINT32)fFromUI);
+	TrajectoryCollision& c = g_trajectory_collisions[hash % TRAJECTORY_CACHE_SIZE];
+	if (!c.valid                                         ||
+		c.uiStructuresVersion != guiStructuresVersion ||
+		!SameVector(c.position, *vPosition)           ||
+		!SameVector(c.force,    *vForce)              ||
+		c.target_z            != sTargetZ             ||
+		c.item                != pItem->usItem        ||
+		c.from_ui             != fFromUI)
+	{
+		c.valid               = true;
+		c.uiStructuresVersion = guiStructuresVersion;
+		c.position            = *vPosition;
+		c.force               = *vForce;
+		c.target_z            = sTargetZ;
+		c.item                = pItem->usItem;
+		c.from_ui             = fFromUI;
+		c.grid_no             = NOWHERE;
+		c.level               = 0;
+		c.chance              = SimulateChanceToGetThroughObjectTrajectory(sTargetZ, pItem, vPosition, vForce, &c.grid_no, &c.level, fFromUI);
+	}
+
+	if (psNewGridNo != NULL)
+	{
+		*psNewGridNo = c.grid_no;
+		*pbLevel     = c.level;
+	}
+	return c.chance;
+}
+
+
 static FLOAT CalculateForceFromRange(INT16 sRange, FLOAT dDegrees);
 static FLOAT CalculateSoldierMaxForce(const SOLDIERTYPE* pSoldier, FLOAT dDegrees, const OBJECTTYPE* pItem, BOOLEAN fArmed);
 
@@ -115,11 +115,7 @@ void MoveRadarScreen( )
 	// check if we are allowed to do anything?
 	if (!fRenderRadarScreen) return;
 
-	gRadarRegion.RegionTopLeftX     = RADAR_WINDOW_X;
-	gRadarRegion.RegionTopLeftY     = RADAR_WINDOW_TM_Y;
-	gRadarRegion.RegionBottomRightX = RADAR_WINDOW_X + RADAR_WINDOW_WIDTH;
-	gRadarRegion.RegionBottomRightY = RADAR_WINDOW_TM_Y + RADAR_WINDOW_HEIGHT;
-
+	gRadarRegion.MoveTo(RADAR_WINDOW_X, RADAR_WINDOW_TM_Y);
 }
 
 
@@ -1,7 +1,9 @@
 #include "Animation_Control.h"
 #include "Animation_Data.h"
+#include "Blitter_Benchmark.h"
 #include "Debug.h"
 #include "English.h"
+#include "ETRLEBlitter.h"
 #include "Font.h"
 #include "Font_Control.h"
 #include "GameSettings.h"
@@ -12,8 +14,11 @@
 #include "Interface.h"
 #include "Interface_Control.h"
 #include "Isometric_Utils.h"
+#include "Lighting.h"
 #include "Local.h"
+#include "MemMan.h"
 #include "Overhead.h"
+#include "Profiler.h"
 #include "Radar_Screen.h"
 #include "Render_Dirty.h"
 #include "Render_Fun.h"
@@ -32,6 +37,8 @@
 #include "VObject_Blitters.h"
 #include "VSurface.h"
 #include "WCheck.h"
+#include "WorkerPool.h"
+#include "WorldMan.h"
 #include "UILayout.h"
 #include "GameState.h"
 #include "Logger.h"
@@ -39,6 +46,7 @@
 #include <algorithm>
 #include <math.h>
 #include <stdint.h>
+#include <vector>
 
 UINT16* gpZBuffer = NULL;
 UINT16  gZBufferPitch = 0;
@@ -60,8 +68,10 @@ enum RenderTilesFlags
 	TILES_DYNAMIC_CHECKFOR_INT_TILE = 0x00000400,
 	TILES_DIRTY                     = 0x80000000,
 	TILES_MARKED                    = 0x10000000,
-	TILES_OBSCURED                  = 0x01000000
+	TILES_OBSCURED                  = 0x01000000,
+	TILES_BANDED                    = 0x00100000  // Blits may be rendered in bands of the viewport by the worker threads
 };
+ENUM_BITSET(RenderTilesFlags)
 
 
 #define MAX_RENDERED_ITEMS 2
@@ -343,6 +353,46 @@ static void Blt8BPPDataTo16BPPBufferTransZTransShadowIncClip(UINT16* pBuffer, UI
 static void Blt8BPPDataTo16BPPBufferTransZTransShadowIncObscureClip(UINT16* pBuffer, UINT32 uiDestPitchBYTES, UINT16* pZBuffer, UINT16 usZValue, HVOBJECT hSrcVObject, INT32 iX, INT32 iY, UINT16 usIndex, SGPRect* clipregion, INT16 sZIndex, const UINT16* p16BPPPalette);
 
 
+/* With TILES_BANDED the blits, which only depend on their parameters, are
+ * recorded while walking the tiles. They are replayed for horizontal bands of
+ * the clipping rectangle on the worker threads, each clipped to its band.
+ * Every band sees all blits, so sprites reaching into a band from a tile row
+ * outside of it are rendered correctly. Anything else first flushes the
+ * recorded blits and is then done right away, which keeps the order of all
+ * blits. */
+enum TileBlitType
+{
+	TILE_BLIT_NONE,   // nothing to blit
+	TILE_BLIT_SERIAL, // must be done by the normal path
+	TILE_BLIT_TRANSPARENT,
+	TILE_BLIT_Z,
+	TILE_BLIT_ZNB,
+	TILE_BLIT_SHADOW,
+	TILE_BLIT_SHADOW_Z,
+	TILE_BLIT_SHADOW_ZNB,
+	TILE_BLIT_Z_INC,
+	TILE_BLIT_Z_INC_SAME_Z_BURNS_THROUGH,
+	TILE_BLIT_Z_INC_OBSCURE,
+	TILE_BLIT_Z_TRANS_SHADOW_INC
+};
+
+struct TileBlit
+{
+	TileBlitType      type;
+	SGPVObject const* vo;
+	UINT16 const*     pal; // the palette is recorded, as the current shade of the video object changes while walking
+	INT16             x;
+	INT16             y;
+	UINT16            index;
+	INT16             z;
+	INT16             z_strip_index;
+};
+
+static std::vector<TileBlit> g_tile_blits;
+
+static void FlushTileBlits(UINT16* buf, UINT32 uiDestPitchBYTES);
+
+
 static void RenderTiles(RenderTilesFlags const uiFlags, INT32 const iStartPointX_M, INT32 const iStartPointY_M, INT32 const iStartPointX_S, INT32 const iStartPointY_S, INT32 const iEndXS, INT32 const iEndYS, UINT8 const ubNumLevels, RenderLayerID const* const psLevelIDs)
 {
 	static UINT8        ubLevelNodeStartIndex[NUM_RENDER_FX_TYPES];
@@ -377,6 +427,8 @@ static void RenderTiles(RenderTilesFlags const uiFlags, INT32 const iStartPointX
 		uiDestPitchBYTES = lock.Pitch();
 	}
 
+	bool const banded = uiFlags & TILES_BANDED && !(uiFlags & TILES_DIRTY) && WorkerPoolSize() > 1;
+
 	bool check_for_mouse_detections = false;
 	if (uiFlags & TILES_DYNAMIC_CHECKFOR_INT_TILE &&
 			ShouldCheckForMouseDetections())
@@ -447,6 +499,9 @@ static void RenderTiles(RenderTilesFlags const uiFlags, INT32 const iStartPointX
 						LogMouseOverInteractiveTile(uiTileIndex);
 					}
 
+					// Skip empty layers without loading the map element
+					if (!(gusWorldLayers[uiTileIndex] & 1U << ubLevelNodeStartIndex[cnt])) goto next_tile;
+
 					if (uiFlags & TILES_MARKED && !(me.uiFlags & MAPELEMENT_REDRAW)) goto next_tile;
 
 					INT8             n_visible_items = 0;
@@ -624,7 +679,7 @@ static void RenderTiles(RenderTilesFlags const uiFlags, INT32 const iStartPointX
 									if (uiLevelNodeFlags & LEVELNODE_ROTTINGCORPSE)
 									{
 										pCorpse     = ID2CORPSE(a.v.user.uiData);
-										pShadeTable = pCorpse->pShades[pNode->ubShadeLevel];
+										pShadeTable = pCorpse->pShades[LightNodeShade(*pNode)];
 
 										// OK, if this is a corpse.... stop if not visible
 										if (pCorpse->def.bVisible != 1 && !(gTacticalStatus.uiFlags & SHOW_ALL_MERCS)) goto next_prev_node;
@@ -669,7 +724,7 @@ static void RenderTiles(RenderTilesFlags const uiFlags, INT32 const iStartPointX
 
 									if (!(uiFlags & TILES_DIRTY))
 									{
-										hVObject->CurrentShade(pNode->ubShadeLevel);
+										hVObject->CurrentShade(LightNodeShade(*pNode));
 									}
 								}
 
@@ -985,9 +1040,10 @@ zlevel_topmost:
 								}
 								else
 								{
-									ubShadeLevel  = pNode->ubShadeLevel & 0x0f;
+									UINT8 const node_shade = LightNodeShade(*pNode);
+									ubShadeLevel  = node_shade & 0x0f;
 									ubShadeLevel  = __max(ubShadeLevel - 2, DEFAULT_SHADE_LEVEL);
-									ubShadeLevel |= pNode->ubShadeLevel & 0x30;
+									ubShadeLevel |= node_shade & 0x30;
 								}
 								pShadeTable = s.pShades[ubShadeLevel];
 
@@ -1194,6 +1250,8 @@ zlevel_topmost:
 						}
 						else if (uiLevelNodeFlags & LEVELNODE_DISPLAY_AP)
 						{
+							if (banded) FlushTileBlits(pDestBuf, uiDestPitchBYTES);
+
 							ETRLEObject const& pTrav = hVObject->SubregionProperties(usImageIndex);
 							sXPos += pTrav.sOffsetX;
 							sYPos += pTrav.sOffsetY;
@@ -1211,6 +1269,8 @@ zlevel_topmost:
 						}
 						else if (uiLevelNodeFlags & LEVELNODE_ITEM)
 						{
+							if (banded) FlushTileBlits(pDestBuf, uiDestPitchBYTES);
+
 							UINT16     outline_colour;
 							bool const on_roof = uiRowFlags == TILES_STATIC_ONROOF || uiRowFlags == TILES_DYNAMIC_ONROOF;
 							if (gGameSettings.fOptions[TOPTION_GLOW_ITEMS])
@@ -1255,6 +1315,8 @@ zlevel_topmost:
 						// ATE: Check here for a lot of conditions!
 						else if (uiLevelNodeFlags & LEVELNODE_PHYSICSOBJECT)
 						{
+							if (banded) FlushTileBlits(pDestBuf, uiDestPitchBYTES);
+
 							const BOOLEAN bBlitClipVal = BltIsClippedOrOffScreen(hVObject, sXPos, sYPos, usImageIndex, &gClippingRect);
 
 							if (fShadowBlitter)
@@ -1282,6 +1344,72 @@ zlevel_topmost:
 						}
 						else
 						{
+							if (banded)
+							{
+								TileBlit b;
+								b.vo            = hVObject;
+								b.pal           = hVObject->CurrentShade();
+								b.x             = sXPos;
+								b.y             = sYPos;
+								b.index         = usImageIndex;
+								b.z             = sZLevel;
+								b.z_strip_index = usImageIndex;
+
+								if (uiLevelNodeFlags & LEVELNODE_UPDATESAVEBUFFERONCE)
+								{
+									b.type = TILE_BLIT_SERIAL;
+								}
+								else if (fMultiTransShadowZBlitter)
+								{
+									// The obscured variant does not count the lines clipped at the top for its pixelation pattern, so it would differ between bands
+									b.type =
+										!fZBlitter       ? TILE_BLIT_NONE   :
+										fObscuredBlitter ? TILE_BLIT_SERIAL :
+										TILE_BLIT_Z_TRANS_SHADOW_INC;
+									b.pal           = pShadeTable;
+									b.z_strip_index = sMultiTransShadowZBlitterIndex;
+								}
+								else if (fMultiZBlitter)
+								{
+									b.type =
+										!fZBlitter       ? TILE_BLIT_TRANSPARENT                :
+										fObscuredBlitter ? TILE_BLIT_Z_INC_OBSCURE              :
+										fWallTile        ? TILE_BLIT_Z_INC_SAME_Z_BURNS_THROUGH :
+										TILE_BLIT_Z_INC;
+								}
+								else
+								{
+									CHAR8 const clipped = BltIsClippedOrOffScreen(hVObject, sXPos, sYPos, usImageIndex, &gClippingRect);
+									b.type =
+										clipped != TRUE && clipped != FALSE    ? TILE_BLIT_NONE        :
+										fPixelate || fMerc || fIntensityBlitter ? TILE_BLIT_SERIAL      :
+										fShadowBlitter                          ? (
+											!fZBlitter                            ? TILE_BLIT_SHADOW      :
+											clipped == TRUE || fZWrite            ? TILE_BLIT_SHADOW_Z    :
+											TILE_BLIT_SHADOW_ZNB
+										) :
+										!fZBlitter                              ? TILE_BLIT_TRANSPARENT :
+										!fZWrite                                ? TILE_BLIT_ZNB         :
+										fObscuredBlitter                        ? TILE_BLIT_SERIAL      :
+										TILE_BLIT_Z;
+								}
+
+								if (b.type >= TILE_BLIT_Z_INC)
+								{ // Let the normal path warn about missing Z-strip info
+									if (!hVObject->ppZStripInfo || !hVObject->ppZStripInfo[b.z_strip_index]) b.type = TILE_BLIT_SERIAL;
+								}
+
+								if (b.type == TILE_BLIT_NONE) goto next_prev_node;
+								if (b.type != TILE_BLIT_SERIAL)
+								{
+									// Validate the index here, the worker threads must not throw
+									hVObject->SubregionProperties(usImageIndex);
+									g_tile_blits.push_back(b);
+									goto next_prev_node;
+								}
+								FlushTileBlits(pDestBuf, uiDestPitchBYTES);
+							}
+
 							if (fMultiTransShadowZBlitter)
 							{
 								if (fZBlitter)
@@ -1575,6 +1703,8 @@ next_node:
 				{
 					if (gfEditMode)
 					{
+						if (banded) FlushTileBlits(pDestBuf, uiDestPitchBYTES);
+
 						// ATE: Used here in the editor to denote when an area is not in the world
 						/* Kris:  Fixed a couple things here...
 						 * It seems that scrolling to the bottom right hand corner of the
@@ -1612,6 +1742,8 @@ next_tile:
 	}
 	while (iAnchorPosY_S < iEndYS);
 
+	if (banded) FlushTileBlits(pDestBuf, uiDestPitchBYTES);
+
 	if (uiFlags & TILES_DYNAMIC_CHECKFOR_INT_TILE) EndCurInteractiveTileCheck();
 }
 
@@ -1659,8 +1791,14 @@ static void RenderStaticWorld(void);
 // For coordinate transformations
 void RenderWorld(void)
 {
+	PROFILE_SCOPE(PROFILE_RENDER_WORLD);
+	PROFILE_ZONE("RenderWorld");
+	MEM_TAG_SCOPE(MEM_TAG_RENDER);
+
 	gfRenderFullThisFrame = FALSE;
 
+	CommitLightChanges();
+
 	// If we are testing renderer, set background to pink!
 	if (gTacticalStatus.uiFlags & DEBUGCLIFFS)
 	{
@@ -1780,45 +1918,354 @@ static void CalcRenderParameters(INT16 sLeft, INT16 sTop, INT16 sRight, INT16 sB
 static void ResetRenderParameters(void);
 
 
-// Start with a center X,Y,Z world coordinate and render direction
-// Determine WorldIntersectionPoint and the starting block from these
-// Then render away!
-void RenderStaticWorldRect(INT16 sLeft, INT16 sTop, INT16 sRight, INT16 sBottom, BOOLEAN fDynamicsToo)
+/* The static layers of the world, i.e. everything RenderStaticWorld() draws,
+ * are kept in a cache of chunks of STATIC_CACHE_CHUNK_SIZE pixels square. The
+ * chunks are placed in world screen coordinates, in which a tile is at the
+ * same position no matter where the view is centered, so they can be copied
+ * back to the frame and Z buffer after scrolling.
+ * A chunk is keyed by a signature of all tiles the renderer visits when
+ * drawing it, which covers the level nodes, their flags and shade levels and
+ * the height of the tiles. Adding or removing structures or changing the light
+ * of a tile thereby only invalidates the chunks it touches. Tiles which are
+ * not fully described by the world data (items, corpses, AP numbers, ...)
+ * keep their chunks from being cached at all.
+ * The obscured blitters pixelate the tiles shown through (LEVELNODE_SHOW_THROUGH)
+ * in a pattern fixed to the pixels of the frame buffer, not to the world, so
+ * chunks containing such tiles are also keyed by the parity of the frame
+ * buffer position.
+ * Only chunks completely inside the viewport are cached. */
+#define STATIC_CACHE_CHUNK_SIZE 128
+#define STATIC_CACHE_MAX_CHUNKS 256
+
+#define STATIC_CACHE_UNCACHEABLE_NODES \
+	(LEVELNODE_CACHEDANITILE | LEVELNODE_ROTTINGCORPSE | LEVELNODE_DISPLAY_AP | LEVELNODE_USEABSOLUTEPOS | LEVELNODE_UPDATESAVEBUFFERONCE | LEVELNODE_ITEM | LEVELNODE_LASTDYNAMIC | LEVELNODE_PHYSICSOBJECT)
+
+struct StaticWorldChunk
 {
-	RenderLayerID sLevelIDs[10];
+	INT32  x; // position in world screen coordinates
+	INT32  y;
+	uint64_t signature;
+	UINT32 last_used;
+	UINT16 pixels[STATIC_CACHE_CHUNK_SIZE * STATIC_CACHE_CHUNK_SIZE];
+	UINT16 z[STATIC_CACHE_CHUNK_SIZE * STATIC_CACHE_CHUNK_SIZE];
+};
 
-	// Calculate render starting parameters
-	CalcRenderParameters(sLeft, sTop, sRight, sBottom);
+static StaticWorldChunk* g_static_chunks[STATIC_CACHE_MAX_CHUNKS];
+static UINT32            g_static_cache_frame;
+static UINT32            g_static_cache_generation;
 
-	// Reset layer optimizations
-	ResetLayerOptimizing();
 
-	// STATICS
+void InvalidateStaticWorldCache()
+{
+	++g_static_cache_generation;
+}
+
+
+static inline void HashStaticWorld(uint64_t& h, UINT32 const v)
+{
+	// FNV-1a
+	h = (h ^ v) * 1099511628211ULL;
+}
+
+
+static inline INT32 FloorDiv(INT32 const a, INT32 const b)
+{
+	return (a >= 0 ? a : a - (b - 1)) / b;
+}
+
+
+/* Returns false if the chunk at world screen position x/y must not be cached.
+ * pixelate_phase is the parity of the position of the chunk in the frame
+ * buffer. */
+static bool StaticWorldChunkSignature(INT32 const x, INT32 const y, uint64_t h, UINT32 const pixelate_phase, uint64_t& signature)
+{
+	bool pixelated = false;
+	/* Tile X/Y is at world screen position 20 * (X - Y), 10 * (X + Y). Visit the
+	 * tiles RenderTiles() does for the chunk, plus one tile of slack in every
+	 * direction. The tile index is calculated like there, including the wrap
+	 * around at the edges of the map. */
+	INT32 const u0 = FloorDiv(x - LARGER_VIEWPORT_XOFFSET_S,                           WORLD_TILE_X / 2) - 2;
+	INT32 const u1 = FloorDiv(x + STATIC_CACHE_CHUNK_SIZE + LARGER_VIEWPORT_XOFFSET_S, WORLD_TILE_X / 2) + 2;
+	INT32 const v0 = FloorDiv(y - LARGER_VIEWPORT_YOFFSET_S,                           WORLD_TILE_Y / 2) - 2;
+	INT32 const v1 = FloorDiv(y + STATIC_CACHE_CHUNK_SIZE + LARGER_VIEWPORT_YOFFSET_S, WORLD_TILE_Y / 2) + 2;
+	for (INT32 v = v0; v <= v1; ++v)
+	{
+		for (INT32 u = u0 + ((u0 ^ v) & 1); u <= u1; u += 2)
+		{
+			INT32  const tile_x  = (u + v) / 2;
+			INT32  const tile_y  = (v - u) / 2;
+			UINT32 const grid_no = FASTMAPROWCOLTOPOS(tile_y, tile_x);
+			if (grid_no >= GRIDSIZE) continue;
+
+			MAP_ELEMENT const& me = gpWorldLevelData[grid_no];
+			HashStaticWorld(h, grid_no);
+			HashStaticWorld(h, me.sHeight);
+			HashStaticWorld(h, me.uiFlags & (MAPELEMENT_REDUNDENT | MAPELEMENT_REEVALUATE_REDUNDENCY));
+			for (UINT layer = LAND_START_INDEX; layer != lengthof(me.pLevelNodes); ++layer)
+			{
+				if (layer == MERC_START_INDEX) continue;
+				HashStaticWorld(h, layer);
+				for (LEVELNODE const* n = me.pLevelNodes[layer]; n; n = layer == LAND_START_INDEX ? n->pPrevNode : n->pNext)
+				{
+					LevelnodeFlags const flags = n->uiFlags;
+					if (flags & STATIC_CACHE_UNCACHEABLE_NODES) return false;
+					if (flags & LEVELNODE_SHOW_THROUGH) pixelated = true;
+					HashStaticWorld(h, n->usIndex);
+					HashStaticWorld(h, flags);
+					HashStaticWorld(h, LightNodeShade(*n));
+					if (flags & LEVELNODE_USERELPOS) HashStaticWorld(h, (UINT32)(UINT16)n->sRelativeX << 16 | (UINT16)n->sRelativeY);
+					if (flags & LEVELNODE_USEZ)      HashStaticWorld(h, (UINT16)n->sRelativeZ);
+				}
+			}
+		}
+	}
+	if (pixelated) HashStaticWorld(h, pixelate_phase);
+	signature = h;
+	return true;
+}
+
+
+static StaticWorldChunk* FindStaticWorldChunk(INT32 const x, INT32 const y)
+{
+	for (UINT i = 0; i != lengthof(g_static_chunks); ++i)
+	{
+		StaticWorldChunk* const c = g_static_chunks[i];
+		if (c && c->x == x && c->y == y) return c;
+	}
+	return 0;
+}
+
+
+static StaticWorldChunk* AllocStaticWorldChunk(INT32 const x, INT32 const y)
+{
+	StaticWorldChunk* c = FindStaticWorldChunk(x, y);
+	if (!c)
+	{
+		// Take a free slot or evict the least recently used chunk
+		StaticWorldChunk** slot = 0;
+		for (UINT i = 0; i != lengthof(g_static_chunks); ++i)
+		{
+			StaticWorldChunk** const s = &g_static_chunks[i];
+			if (!*s) { slot = s; break; }
+			if (!slot || (*s)->last_used < (*slot)->last_used) slot = s;
+		}
+		if (!*slot) *slot = new StaticWorldChunk;
+		c    = *slot;
+		c->x = x;
+		c->y = y;
+	}
+	c->last_used = g_static_cache_frame;
+	return c;
+}
+
+
+static void RenderStaticTiles(void)
+{
+	RenderLayerID sLevelIDs[4];
+
 	sLevelIDs[0] = RENDER_STATIC_LAND;
-	RenderTiles(TILES_NONE, gsLStartPointX_M, gsLStartPointY_M, gsLStartPointX_S, gsLStartPointY_S, gsLEndXS, gsLEndYS, 1, sLevelIDs);
+	RenderTiles(TILES_BANDED, gsLStartPointX_M, gsLStartPointY_M, gsLStartPointX_S, gsLStartPointY_S, gsLEndXS, gsLEndYS, 1, sLevelIDs);
 
 	sLevelIDs[0] = RENDER_STATIC_OBJECTS;
-	RenderTiles(TILES_NONE, gsLStartPointX_M, gsLStartPointY_M, gsLStartPointX_S, gsLStartPointY_S, gsLEndXS, gsLEndYS, 1, sLevelIDs);
+	RenderTiles(TILES_BANDED, gsLStartPointX_M, gsLStartPointY_M, gsLStartPointX_S, gsLStartPointY_S, gsLEndXS, gsLEndYS, 1, sLevelIDs);
 
 	if (gRenderFlags & RENDER_FLAG_SHADOWS)
 	{
 		sLevelIDs[0] = RENDER_STATIC_SHADOWS;
-		RenderTiles(TILES_NONE, gsLStartPointX_M, gsLStartPointY_M, gsLStartPointX_S, gsLStartPointY_S, gsLEndXS, gsLEndYS, 1, sLevelIDs);
+		RenderTiles(TILES_BANDED, gsLStartPointX_M, gsLStartPointY_M, gsLStartPointX_S, gsLStartPointY_S, gsLEndXS, gsLEndYS, 1, sLevelIDs);
 	}
 
 	sLevelIDs[0] = RENDER_STATIC_STRUCTS;
 	sLevelIDs[1] = RENDER_STATIC_ROOF;
 	sLevelIDs[2] = RENDER_STATIC_ONROOF;
 	sLevelIDs[3] = RENDER_STATIC_TOPMOST;
-	RenderTiles(TILES_NONE, gsLStartPointX_M, gsLStartPointY_M, gsLStartPointX_S, gsLStartPointY_S, gsLEndXS, gsLEndYS, 4, sLevelIDs);
+	RenderTiles(TILES_BANDED, gsLStartPointX_M, gsLStartPointY_M, gsLStartPointX_S, gsLStartPointY_S, gsLEndXS, gsLEndYS, 4, sLevelIDs);
 
 	//ATE: Do obsucred layer!
 	sLevelIDs[0] = RENDER_STATIC_STRUCTS;
 	sLevelIDs[1] = RENDER_STATIC_ONROOF;
-	RenderTiles(TILES_OBSCURED, gsLStartPointX_M, gsLStartPointY_M, gsLStartPointX_S, gsLStartPointY_S, gsLEndXS, gsLEndYS, 2, sLevelIDs);
+	RenderTiles(TILES_OBSCURED | TILES_BANDED, gsLStartPointX_M, gsLStartPointY_M, gsLStartPointX_S, gsLStartPointY_S, gsLEndXS, gsLEndYS, 2, sLevelIDs);
+}
+
+
+static void RenderStaticTilesRect(INT16 const sLeft, INT16 const sTop, INT16 const sRight, INT16 const sBottom)
+{
+	CalcRenderParameters(sLeft, sTop, sRight, sBottom);
+	RenderStaticTiles();
+	ResetRenderParameters();
+}
+
+
+// Copies between a chunk and the frame and Z buffer. x/y is the screen position of the chunk, r the part to copy.
+static void CopyStaticWorldChunk(StaticWorldChunk& c, INT32 const x, INT32 const y, SGPRect const& r, bool const store)
+{
+	SGPVSurface::Lock l(FRAME_BUFFER);
+	UINT32  const pitch = l.Pitch() / 2;
+	UINT16* const buf   = l.Buffer<UINT16>();
+	UINT32  const w     = r.iRight - r.iLeft;
+	for (INT32 row = r.iTop; row != r.iBottom; ++row)
+	{
+		size_t  const src = (row - y) * STATIC_CACHE_CHUNK_SIZE + r.iLeft - x;
+		UINT16* const dst = buf       + row * pitch         + r.iLeft;
+		UINT16* const zb  = gpZBuffer + row * SCREEN_WIDTH  + r.iLeft;
+		if (store)
+		{
+			std::copy(dst, dst + w, c.pixels + src);
+			std::copy(zb,  zb  + w, c.z      + src);
+		}
+		else
+		{
+			std::copy(c.pixels + src, c.pixels + src + w, dst);
+			std::copy(c.z      + src, c.z      + src + w, zb);
+		}
+	}
+}
+
+
+/* Renders the static layers in the given part of the viewport, taking what
+ * is unchanged from the cache. The Z buffer must be cleared for the rectangle
+ * already. */
+static void RenderStaticWorldCached(INT16 sLeft, INT16 sTop, INT16 sRight, INT16 sBottom)
+{
+	if (GameState::getInstance()->isEditorMode() ||
+			gRenderFlags & RENDER_FLAG_NOZ ||
+			gTacticalStatus.uiFlags & (DEBUGCLIFFS | SHOW_Z_BUFFER))
+	{
+		RenderStaticTilesRect(sLeft, sTop, sRight, sBottom);
+		return;
+	}
+
+	sLeft   = __max(sLeft,   gsVIEWPORT_START_X);
+	sTop    = __max(sTop,    gsVIEWPORT_WINDOW_START_Y);
+	sRight  = __min(sRight,  gsVIEWPORT_END_X);
+	sBottom = __min(sBottom, gsVIEWPORT_WINDOW_END_Y);
+	if (sLeft >= sRight || sTop >= sBottom) return;
+
+	// Offset from screen to world screen coordinates, taken from the position of the first tile
+	CalcRenderParameters(gsVIEWPORT_START_X, gsVIEWPORT_START_Y, gsVIEWPORT_END_X, gsVIEWPORT_END_Y);
+	INT32 const off_x = (gsLStartPointX_M - gsLStartPointY_M) * (WORLD_TILE_X / 2) - gsLStartPointX_S;
+	INT32 const off_y = (gsLStartPointX_M + gsLStartPointY_M) * (WORLD_TILE_Y / 2) - gsLStartPointY_S;
+	ResetRenderParameters();
+
+	// Everything not stored in the world data which influences the rendering
+	uint64_t key = 14695981039346656037ULL;
+	HashStaticWorld(key, g_static_cache_generation);
+	HashStaticWorld(key, gRenderFlags & RENDER_FLAG_SHADOWS);
+	HashStaticWorld(key, gTacticalStatus.uiFlags & (NOHIDE_REDUNDENCY | SHOW_ALL_ROOFS));
+	HashStaticWorld(key, (UINT16)gsRenderHeight);
+	HashStaticWorld(key, gGameSettings.fOptions[TOPTION_TOGGLE_WIREFRAME]);
+
+	++g_static_cache_frame;
+
+	INT32 const chunk_x0 = FloorDiv(sLeft   + off_x,     STATIC_CACHE_CHUNK_SIZE) * STATIC_CACHE_CHUNK_SIZE;
+	INT32 const chunk_y0 = FloorDiv(sTop    + off_y,     STATIC_CACHE_CHUNK_SIZE) * STATIC_CACHE_CHUNK_SIZE;
+	INT32 const chunk_x1 = FloorDiv(sRight  + off_x - 1, STATIC_CACHE_CHUNK_SIZE) * STATIC_CACHE_CHUNK_SIZE;
+	INT32 const chunk_y1 = FloorDiv(sBottom + off_y - 1, STATIC_CACHE_CHUNK_SIZE) * STATIC_CACHE_CHUNK_SIZE;
+	for (INT32 wy = chunk_y0; wy <= chunk_y1; wy += STATIC_CACHE_CHUNK_SIZE)
+	{
+		INT32 const y = wy - off_y;
+
+		/* Adjacent chunks which are not in the cache are rendered together and
+		 * then stored, if they are completely visible. */
+		struct Pending { StaticWorldChunk* c; INT32 x; SGPRect r; };
+		Pending pending[32];
+		UINT    n_pending = 0;
+		SGPRect run;
+		bool    in_run = false;
+
+		for (INT32 wx = chunk_x0;; wx += STATIC_CACHE_CHUNK_SIZE)
+		{
+			bool const end = wx > chunk_x1;
+			INT32 const x = wx - off_x;
+
+			SGPRect r;
+			r.iLeft   = __max(sLeft,   x);
+			r.iTop    = __max(sTop,    y);
+			r.iRight  = __min(sRight,  x + STATIC_CACHE_CHUNK_SIZE);
+			r.iBottom = __min(sBottom, y + STATIC_CACHE_CHUNK_SIZE);
+
+			StaticWorldChunk* hit   = 0;
+			StaticWorldChunk* store = 0;
+			uint64_t            signature;
+			if (!end &&
+					x >= gsVIEWPORT_START_X        && x + STATIC_CACHE_CHUNK_SIZE <= gsVIEWPORT_END_X &&
+					y >= gsVIEWPORT_WINDOW_START_Y && y + STATIC_CACHE_CHUNK_SIZE <= gsVIEWPORT_WINDOW_END_Y &&
+					StaticWorldChunkSignature(wx, wy, key, (x & 1) | (y & 1) << 1, signature))
+			{
+				StaticWorldChunk* const c = FindStaticWorldChunk(wx, wy);
+				if (c && c->signature == signature)
+				{
+					hit = c;
+					hit->last_used = g_static_cache_frame;
+				}
+				else if (r.iLeft == x && r.iTop == y && r.iRight == x + STATIC_CACHE_CHUNK_SIZE && r.iBottom == y + STATIC_CACHE_CHUNK_SIZE)
+				{
+					store            = AllocStaticWorldChunk(wx, wy);
+					store->signature = signature;
+				}
+			}
+
+			if (in_run && (end || hit || n_pending == lengthof(pending)))
+			{
+				RenderStaticTilesRect(run.iLeft, run.iTop, run.iRight, run.iBottom);
+				for (UINT i = 0; i != n_pending; ++i)
+				{
+					CopyStaticWorldChunk(*pending[i].c, pending[i].x, y, pending[i].r, true);
+				}
+				n_pending = 0;
+				in_run    = false;
+			}
+			if (end) break;
+
+			if (hit)
+			{
+				CopyStaticWorldChunk(*hit, x, y, r, false);
+				continue;
+			}
+
+			if (!in_run)
+			{
+				run    = r;
+				in_run = true;
+			}
+			else
+			{
+				run.iRight = r.iRight;
+			}
+
+			if (store)
+			{
+				/* Pixels not covered by any tile would keep what was in the frame
+				 * buffer before, so start from black to store something defined. */
+				ColorFillVideoSurfaceArea(FRAME_BUFFER, r.iLeft, r.iTop, r.iRight, r.iBottom, 0);
+				Pending& p = pending[n_pending++];
+				p.c = store;
+				p.x = x;
+				p.r = r;
+			}
+		}
+	}
+}
+
+
+// Start with a center X,Y,Z world coordinate and render direction
+// Determine WorldIntersectionPoint and the starting block from these
+// Then render away!
+void RenderStaticWorldRect(INT16 sLeft, INT16 sTop, INT16 sRight, INT16 sBottom, BOOLEAN fDynamicsToo)
+{
+	RenderLayerID sLevelIDs[10];
+
+	// Reset layer optimizations
+	ResetLayerOptimizing();
+
+	// STATICS
+	RenderStaticWorldCached(sLeft, sTop, sRight, sBottom);
 
 	if (fDynamicsToo)
 	{
+		// Calculate render starting parameters
+		CalcRenderParameters(sLeft, sTop, sRight, sBottom);
+
 		// DYNAMICS
 		sLevelIDs[0] = RENDER_DYNAMIC_LAND;
 		sLevelIDs[1] = RENDER_DYNAMIC_OBJECTS;
@@ -1829,12 +2276,12 @@ void RenderStaticWorldRect(INT16 sLeft, INT16 sTop, INT16 sRight, INT16 sBottom,
 		sLevelIDs[6] = RENDER_DYNAMIC_ROOF;
 		sLevelIDs[7] = RENDER_DYNAMIC_HIGHMERCS;
 		sLevelIDs[8] = RENDER_DYNAMIC_ONROOF;
-		RenderTiles(TILES_NONE, gsLStartPointX_M, gsLStartPointY_M, gsLStartPointX_S, gsLStartPointY_S, gsLEndXS, gsLEndYS, 9, sLevelIDs);
+		RenderTiles(TILES_BANDED, gsLStartPointX_M, gsLStartPointY_M, gsLStartPointX_S, gsLStartPointY_S, gsLEndXS, gsLEndYS, 9, sLevelIDs);
 
 		SumAdditiveLayerOptimization();
-	}
 
-	ResetRenderParameters();
+		ResetRenderParameters();
+	}
 
 	if (!gfDoVideoScroll) AddBaseDirtyRect(sLeft, sTop, sRight, sBottom);
 }
@@ -1842,10 +2289,7 @@ void RenderStaticWorldRect(INT16 sLeft, INT16 sTop, INT16 sRight, INT16 sBottom,
 
 static void RenderStaticWorld(void)
 {
-	RenderLayerID sLevelIDs[9];
-
-	// Calculate render starting parameters
-	CalcRenderParameters(gsVIEWPORT_START_X, gsVIEWPORT_START_Y, gsVIEWPORT_END_X, gsVIEWPORT_END_Y);
+	PROFILE_SCOPE(PROFILE_RENDER_STATIC);
 
 	// Clear z-buffer
 	std::fill_n(gpZBuffer, gsVIEWPORT_END_Y * SCREEN_WIDTH, LAND_Z_LEVEL);
@@ -1853,36 +2297,16 @@ static void RenderStaticWorld(void)
 	FreeBackgroundRectType(BGND_FLAG_ANIMATED);
 	InvalidateBackgroundRects();
 
-	sLevelIDs[0] = RENDER_STATIC_LAND;
-	RenderTiles(TILES_NONE, gsLStartPointX_M, gsLStartPointY_M, gsLStartPointX_S, gsLStartPointY_S, gsLEndXS, gsLEndYS, 1, sLevelIDs);
-
-	sLevelIDs[0] = RENDER_STATIC_OBJECTS;
-	RenderTiles(TILES_NONE, gsLStartPointX_M, gsLStartPointY_M, gsLStartPointX_S, gsLStartPointY_S, gsLEndXS, gsLEndYS, 1, sLevelIDs);
-
-	if (gRenderFlags & RENDER_FLAG_SHADOWS)
-	{
-		sLevelIDs[0] = RENDER_STATIC_SHADOWS;
-		RenderTiles(TILES_NONE, gsLStartPointX_M, gsLStartPointY_M, gsLStartPointX_S, gsLStartPointY_S, gsLEndXS, gsLEndYS, 1, sLevelIDs);
-	}
-
-	sLevelIDs[0] = RENDER_STATIC_STRUCTS;
-	sLevelIDs[1] = RENDER_STATIC_ROOF;
-	sLevelIDs[2] = RENDER_STATIC_ONROOF;
-	sLevelIDs[3] = RENDER_STATIC_TOPMOST;
-	RenderTiles(TILES_NONE, gsLStartPointX_M, gsLStartPointY_M, gsLStartPointX_S, gsLStartPointY_S, gsLEndXS, gsLEndYS, 4, sLevelIDs);
-
-	//ATE: Do obsucred layer!
-	sLevelIDs[0] = RENDER_STATIC_STRUCTS;
-	sLevelIDs[1] = RENDER_STATIC_ONROOF;
-	RenderTiles(TILES_OBSCURED, gsLStartPointX_M, gsLStartPointY_M, gsLStartPointX_S, gsLStartPointY_S, gsLEndXS, gsLEndYS, 2, sLevelIDs);
+	RenderStaticWorldCached(gsVIEWPORT_START_X, gsVIEWPORT_START_Y, gsVIEWPORT_END_X, gsVIEWPORT_END_Y);
 
 	AddBaseDirtyRect(gsVIEWPORT_START_X, gsVIEWPORT_WINDOW_START_Y, gsVIEWPORT_END_X, gsVIEWPORT_WINDOW_END_Y);
-	ResetRenderParameters();
 }
 
 
 static void RenderMarkedWorld(void)
 {
+	PROFILE_SCOPE(PROFILE_RENDER_MARKED);
+
 	RenderLayerID sLevelIDs[4];
 
 	CalcRenderParameters(gsVIEWPORT_START_X, gsVIEWPORT_START_Y, gsVIEWPORT_END_X, gsVIEWPORT_END_Y);
@@ -1923,6 +2347,8 @@ static void RenderMarkedWorld(void)
 
 static void RenderDynamicWorld(void)
 {
+	PROFILE_SCOPE(PROFILE_RENDER_DYNAMIC);
+
 	RenderLayerID sLevelIDs[10];
 
 	CalcRenderParameters(gsVIEWPORT_START_X, gsVIEWPORT_START_Y, gsVIEWPORT_END_X, gsVIEWPORT_END_Y);
@@ -1952,12 +2378,12 @@ static void RenderDynamicWorld(void)
 	sLevelIDs[2] = RENDER_DYNAMIC_STRUCT_MERCS;
 	sLevelIDs[3] = RENDER_DYNAMIC_MERCS;
 	sLevelIDs[4] = RENDER_DYNAMIC_STRUCTS;
-	RenderTiles(TILES_NONE, gsStartPointX_M, gsStartPointY_M, gsStartPointX_S, gsStartPointY_S, gsEndXS, gsEndYS, 5, sLevelIDs);
+	RenderTiles(TILES_BANDED, gsStartPointX_M, gsStartPointY_M, gsStartPointX_S, gsStartPointY_S, gsEndXS, gsEndYS, 5, sLevelIDs);
 
 	sLevelIDs[0] = RENDER_DYNAMIC_ROOF;
 	sLevelIDs[1] = RENDER_DYNAMIC_HIGHMERCS;
 	sLevelIDs[2] = RENDER_DYNAMIC_ONROOF;
-	RenderTiles(TILES_NONE, gsStartPointX_M, gsStartPointY_M, gsStartPointX_S, gsStartPointY_S, gsEndXS, gsEndYS, 3, sLevelIDs);
+	RenderTiles(TILES_BANDED, gsStartPointX_M, gsStartPointY_M, gsStartPointX_S, gsStartPointY_S, gsEndXS, gsEndYS, 3, sLevelIDs);
 
 	sLevelIDs[0] = RENDER_DYNAMIC_TOPMOST;
 	// ATE: check here for mouse over structs.....
@@ -2425,266 +2851,163 @@ void InvalidateWorldRedundency(void)
 
 #define Z_STRIP_DELTA_Y  (Z_SUBLAYERS * 10)
 
-/**********************************************************************************************
-Blt8BPPDataTo16BPPBufferTransZIncClip
-
-	Blits an image into the destination buffer, using an ETRLE brush as a source, and a 16-bit
-	buffer as a destination. As it is blitting, it checks the Z value of the ZBuffer, and if the
-	pixel's Z level is below that of the current pixel, it is written on, and the Z value is
-	updated to the current value, for any non-transparent pixels. The Z-buffer is 16 bit, and
-	must be the same dimensions (including Pitch) as the destination.
-
-**********************************************************************************************/
-static void Blt8BPPDataTo16BPPBufferTransZIncClip(UINT16* pBuffer, UINT32 uiDestPitchBYTES, UINT16* pZBuffer, UINT16 usZValue, HVOBJECT hSrcVObject, INT32 iX, INT32 iY, UINT16 usIndex, SGPRect* clipregion)
+/* Pixel policy for the ETRLE blitter, which blits objects spanning several Z
+ * levels. The object is divided into vertical strips of 20 pixels, the Z-strip
+ * info of the object holds the change of the Z level from strip to strip.
+ * Pixels are written and the Z buffer is updated where the Z buffer is below
+ * the Z level of the current strip.
+ *
+ * SameZBurnsThrough also writes pixels where the Z buffer equals the Z level.
+ * Obscure pixelates the pixels which are hidden, rather than not rendering them
+ * at all.
+ * TransShadow makes a shadow for the value 254. The strip index is passed in
+ * and the Z level steps for the left clipping differ. The unobscured variant
+ * also steps by Z_SUBLAYERS instead of Z_STRIP_DELTA_Y between strips of
+ * non-transparent pixels, and the obscured one does not count lines clipped at
+ * the top for the pixelation pattern. */
+template<bool SameZBurnsThrough, bool Obscure, bool TransShadow>
+struct ZStripPolicy : ETRLEPolicy
 {
-	UINT32 Unblitted;
-	INT32  LSCount;
-	UINT16 usZLevel, usZColsToGo, usZIndex;
+	static UINT16 const CLIP_DELTA    = TransShadow ? Z_SUBLAYERS : Z_STRIP_DELTA_Y;
+	static UINT16 const OPAQUE_DELTA  = TransShadow && !Obscure ? Z_SUBLAYERS : Z_STRIP_DELTA_Y;
+
+	UINT16*                  zbuf;
+	UINT16                   zval;
+	UINT16 const*            pal;
+	ZStripInfo const* const* strips;
+	UINT16                   strip_index;
+	UINT32                   line_flag;
+
+	INT8 const* z_array;
+	UINT16      start_level;
+	UINT16      start_cols;
+	UINT16      start_index;
+	UINT16      level;
+	UINT16      cols_to_go;
+	UINT16      index;
+
+	ZStripPolicy(UINT16* const zbuf_, UINT16 const zval_, UINT16 const* const pal_, SGPVObject const* const vo, INT32 const iY, UINT16 const usIndex, UINT16 const strip_index_) :
+		zbuf(zbuf_),
+		zval(zval_),
+		pal(pal_),
+		strips(vo->ppZStripInfo),
+		strip_index(strip_index_),
+		line_flag((iY + vo->SubregionProperties(usIndex).sOffsetY) & 1)
+	{}
+
+	bool Begin(INT32 const left_skip)
+	{
+		ZStripInfo const* const zi = strips ? strips[strip_index] : NULL;
+		if (!zi)
+		{
+			SLOGW("Missing Z-Strip info on multi-Z object");
+			return false;
+		}
 
-	Assert(hSrcVObject != NULL);
-	Assert(pBuffer     != NULL);
+		z_array     = zi->pbZChange;
+		start_level = (INT16)zval + zi->bInitialZChange * Z_STRIP_DELTA_Y;
 
-	// Get Offsets from Index into structure
-	ETRLEObject const& pTrav    = hSrcVObject->SubregionProperties(usIndex);
-	INT32       const  usHeight = pTrav.usHeight;
-	INT32       const  usWidth  = pTrav.usWidth;
+		// set to odd number of pixels for first column
+		if (left_skip > zi->ubFirstZStripWidth)
+		{
+			start_cols = 20 - (left_skip - zi->ubFirstZStripWidth) % 20;
+		}
+		else if (left_skip < zi->ubFirstZStripWidth)
+		{
+			start_cols = zi->ubFirstZStripWidth - left_skip;
+		}
+		else
+		{
+			start_cols = 20;
+		}
 
-	// Add to start position of dest buffer
-	INT32 const iTempX = iX + pTrav.sOffsetX;
-	INT32 const iTempY = iY + pTrav.sOffsetY;
+		start_index = 0;
+		if (left_skip >= (TransShadow ? start_cols : zi->ubFirstZStripWidth))
+		{
+			// Index into array after doing left clipping
+			start_index = 1 + (left_skip - zi->ubFirstZStripWidth) / 20;
 
-	INT32 ClipX1;
-	INT32 ClipY1;
-	INT32 ClipX2;
-	INT32 ClipY2;
-	if (clipregion == NULL)
-	{
-		ClipX1 = ClippingRect.iLeft;
-		ClipY1 = ClippingRect.iTop;
-		ClipX2 = ClippingRect.iRight;
-		ClipY2 = ClippingRect.iBottom;
-	}
-	else
-	{
-		ClipX1 = clipregion->iLeft;
-		ClipY1 = clipregion->iTop;
-		ClipX2 = clipregion->iRight;
-		ClipY2 = clipregion->iBottom;
+			//calculates the Z-value after left-side clipping
+			UINT16 const clipped = start_index < zi->ubNumberOfZChanges ? start_index : zi->ubNumberOfZChanges;
+			start_level += zi->psZLevel[clipped] * CLIP_DELTA;
+		}
+		return true;
 	}
 
-	// Calculate rows hanging off each side of the screen
-	const INT32 LeftSkip   = __min(ClipX1 -   MIN(ClipX1, iTempX), usWidth);
-	INT32       TopSkip    = __min(ClipY1 - __min(ClipY1, iTempY), usHeight);
-	const INT32 RightSkip  = __min(  MAX(ClipX2, iTempX + usWidth)  - ClipX2, usWidth);
-	const INT32 BottomSkip = __min(__max(ClipY2, iTempY + usHeight) - ClipY2, usHeight);
-
-	// calculate the remaining rows and columns to blit
-	const INT32 BlitLength = usWidth  - LeftSkip - RightSkip;
-	INT32       BlitHeight = usHeight - TopSkip  - BottomSkip;
-
-	// check if whole thing is clipped
-	if (LeftSkip >= usWidth  || RightSkip  >= usWidth)  return;
-	if (TopSkip  >= usHeight || BottomSkip >= usHeight) return;
-
-	UINT8 const* SrcPtr   = hSrcVObject->PixData(pTrav);
-	UINT8*       DestPtr  = (UINT8*)pBuffer  + uiDestPitchBYTES * (iTempY + TopSkip) + (iTempX + LeftSkip) * 2;
-	UINT8*       ZPtr     = (UINT8*)pZBuffer + uiDestPitchBYTES * (iTempY + TopSkip) + (iTempX + LeftSkip) * 2;
-	const UINT32 LineSkip = uiDestPitchBYTES - BlitLength * 2;
-	UINT16 const* const p16BPPPalette = hSrcVObject->CurrentShade();
-
-	if (hSrcVObject->ppZStripInfo == NULL)
-	{
-		SLOGW("Missing Z-Strip info on multi-Z object");
-		return;
-	}
-	// setup for the z-column blitting stuff
-	const ZStripInfo* const pZInfo = hSrcVObject->ppZStripInfo[usIndex];
-	if (pZInfo == NULL)
+	void SkipLine()
 	{
-		SLOGW("Missing Z-Strip info on multi-Z object");
-		return;
+		if (Obscure && !TransShadow) line_flag ^= 1;
 	}
 
-	UINT16 usZStartLevel = (INT16)usZValue + pZInfo->bInitialZChange * Z_STRIP_DELTA_Y;
-	// set to odd number of pixels for first column
-
-	UINT16 usZStartCols;
-	if  (LeftSkip > pZInfo->ubFirstZStripWidth)
-	{
-		usZStartCols = LeftSkip - pZInfo->ubFirstZStripWidth;
-		usZStartCols = 20 - usZStartCols % 20;
-	}
-	else if (LeftSkip < pZInfo->ubFirstZStripWidth)
+	void BeginLine()
 	{
-		usZStartCols = pZInfo->ubFirstZStripWidth - LeftSkip;
+		level      = start_level;
+		index      = start_index;
+		cols_to_go = start_cols;
 	}
-	else
+
+	void EndLine()
 	{
-		usZStartCols = 20;
+		if (Obscure) line_flag ^= 1;
 	}
 
-	usZColsToGo = usZStartCols;
-
-	const INT8* const pZArray = pZInfo->pbZChange;
-
-	UINT16 usZStartIndex;
-	if (LeftSkip >= pZInfo->ubFirstZStripWidth)
+	void NextStrip(UINT16 const delta)
 	{
-		// Index into array after doing left clipping
-		usZStartIndex = 1 + (LeftSkip - pZInfo->ubFirstZStripWidth) / 20;
-
-		//calculates the Z-value after left-side clipping
-		if (usZStartIndex)
+		cols_to_go = 20;
+		INT8 const d = z_array[index++];
+		if (d < 0)
 		{
-			for (UINT16 i = 0; i < usZStartIndex; i++)
-			{
-				switch (pZArray[i])
-				{
-					case -1: usZStartLevel -= Z_STRIP_DELTA_Y; break;
-					case  0: /* no change */                   break;
-					case  1: usZStartLevel += Z_STRIP_DELTA_Y; break;
-				}
-			}
+			level -= delta;
+		}
+		else if (d > 0)
+		{
+			level += delta;
 		}
 	}
-	else
-	{
-		usZStartIndex = 0;
-	}
-
-	usZLevel = usZStartLevel;
-	usZIndex = usZStartIndex;
-
-	UINT32 PxCount;
 
-	while (TopSkip > 0)
+	void Transparent(UINT16*, size_t, UINT32 n)
 	{
-		for (;;)
+		while (n >= cols_to_go)
 		{
-			PxCount = *SrcPtr++;
-			if (PxCount & 0x80) continue;
-			if (PxCount == 0) break;
-			SrcPtr += PxCount;
+			n -= cols_to_go;
+			NextStrip(Z_STRIP_DELTA_Y);
 		}
-		TopSkip--;
+		cols_to_go -= n;
 	}
 
-	do
+	void Opaque(UINT16* const dst, size_t const pos, UINT8 const* const src, UINT32 const n)
 	{
-		usZLevel = usZStartLevel;
-		usZIndex = usZStartIndex;
-		usZColsToGo = usZStartCols;
-		for (LSCount = LeftSkip; LSCount > 0; LSCount -= PxCount)
+		UINT16* const z = zbuf + pos;
+		for (UINT32 i = 0; i != n; ++i)
 		{
-			PxCount = *SrcPtr++;
-			if (PxCount & 0x80)
-			{
-				PxCount &= 0x7F;
-				if (PxCount > LSCount)
-				{
-					PxCount -= LSCount;
-					LSCount = BlitLength;
-					goto BlitTransparent;
-				}
-			}
-			else
+			if (z[i] < level ||
+					(SameZBurnsThrough && z[i] == level) ||
+					(Obscure && line_flag == (((uintptr_t)(dst + i) & 2) != 0))) // XXX update Z when pixelating?
 			{
-				if (PxCount > LSCount)
-				{
-					SrcPtr += LSCount;
-					PxCount -= LSCount;
-					LSCount = BlitLength;
-					goto BlitNonTransLoop;
-				}
-				SrcPtr += PxCount;
+				z[i] = level;
+				UINT8 const px = src[i];
+				dst[i] = TransShadow && px == 254 ? ShadeTable[dst[i]] : pal[px];
 			}
+			if (--cols_to_go == 0) NextStrip(OPAQUE_DELTA);
 		}
+	}
+};
 
-		LSCount = BlitLength;
-		while (LSCount > 0)
-		{
-			PxCount = *SrcPtr++;
-			if (PxCount & 0x80)
-			{
-BlitTransparent: // skip transparent pixels
-				PxCount &= 0x7F;
-				if (PxCount > LSCount) PxCount = LSCount;
-				LSCount -= PxCount;
-				DestPtr += 2 * PxCount;
-				ZPtr    += 2 * PxCount;
-				for (;;)
-				{
-					if (PxCount >= usZColsToGo)
-					{
-						PxCount -= usZColsToGo;
-						usZColsToGo = 20;
 
-						INT8 delta = pZArray[usZIndex++];
-						if (delta < 0)
-						{
-							usZLevel -= Z_STRIP_DELTA_Y;
-						}
-						else if (delta > 0)
-						{
-							usZLevel += Z_STRIP_DELTA_Y;
-						}
-					}
-					else
-					{
-						usZColsToGo -= PxCount;
-						break;
-					}
-				}
-			}
-			else
-			{
-BlitNonTransLoop: // blit non-transparent pixels
-				if (PxCount > LSCount)
-				{
-					Unblitted = PxCount - LSCount;
-					PxCount = LSCount;
-				}
-				else
-				{
-					Unblitted = 0;
-				}
-				LSCount -= PxCount;
-
-				do
-				{
-					if (*(UINT16*)ZPtr < usZLevel)
-					{
-						*(UINT16*)ZPtr = usZLevel;
-						*(UINT16*)DestPtr = p16BPPPalette[*SrcPtr];
-					}
-					SrcPtr++;
-					DestPtr += 2;
-					ZPtr += 2;
-					if (--usZColsToGo == 0)
-					{
-						usZColsToGo = 20;
+/**********************************************************************************************
+Blt8BPPDataTo16BPPBufferTransZIncClip
 
-						INT8 delta = pZArray[usZIndex++];
-						if (delta < 0)
-						{
-							usZLevel -= Z_STRIP_DELTA_Y;
-						}
-						else if (delta > 0)
-						{
-							usZLevel += Z_STRIP_DELTA_Y;
-						}
-					}
-				}
-				while (--PxCount > 0);
-				SrcPtr += Unblitted;
-			}
-		}
+	Blits an image into the destination buffer, using an ETRLE brush as a source, and a 16-bit
+	buffer as a destination. As it is blitting, it checks the Z value of the ZBuffer, and if the
+	pixel's Z level is below that of the current pixel, it is written on, and the Z value is
+	updated to the current value, for any non-transparent pixels. The Z-buffer is 16 bit, and
+	must be the same dimensions (including Pitch) as the destination.
 
-		while (*SrcPtr++ != 0) {} // skip along until we hit and end-of-line marker
-		DestPtr += LineSkip;
-		ZPtr += LineSkip;
-	}
-	while (--BlitHeight > 0);
+**********************************************************************************************/
+static void Blt8BPPDataTo16BPPBufferTransZIncClip(UINT16* pBuffer, UINT32 uiDestPitchBYTES, UINT16* pZBuffer, UINT16 usZValue, HVOBJECT hSrcVObject, INT32 iX, INT32 iY, UINT16 usIndex, SGPRect* clipregion)
+{
+	ZStripPolicy<false, false, false> const p(pZBuffer, usZValue, hSrcVObject->CurrentShade(), hSrcVObject, iY, usIndex, usIndex);
+	BltETRLE<true>(pBuffer, uiDestPitchBYTES, hSrcVObject, iX, iY, usIndex, clipregion, p);
 }
 
 
@@ -2700,253 +3023,8 @@ Blt8BPPDataTo16BPPBufferTransZIncClipSaveZBurnsThrough
 **********************************************************************************************/
 static void Blt8BPPDataTo16BPPBufferTransZIncClipZSameZBurnsThrough(UINT16* pBuffer, UINT32 uiDestPitchBYTES, UINT16* pZBuffer, UINT16 usZValue, HVOBJECT hSrcVObject, INT32 iX, INT32 iY, UINT16 usIndex, SGPRect* clipregion)
 {
-	UINT32 Unblitted;
-	INT32  LSCount;
-	UINT16 usZLevel, usZColsToGo, usZStartIndex, usZIndex;
-
-	Assert(hSrcVObject != NULL);
-	Assert(pBuffer     != NULL);
-
-	// Get Offsets from Index into structure
-	ETRLEObject const& pTrav    = hSrcVObject->SubregionProperties(usIndex);
-	INT32       const  usHeight = pTrav.usHeight;
-	INT32       const  usWidth  = pTrav.usWidth;
-
-	// Add to start position of dest buffer
-	INT32 const iTempX = iX + pTrav.sOffsetX;
-	INT32 const iTempY = iY + pTrav.sOffsetY;
-
-	INT32 ClipX1;
-	INT32 ClipY1;
-	INT32 ClipX2;
-	INT32 ClipY2;
-	if (clipregion == NULL)
-	{
-		ClipX1 = ClippingRect.iLeft;
-		ClipY1 = ClippingRect.iTop;
-		ClipX2 = ClippingRect.iRight;
-		ClipY2 = ClippingRect.iBottom;
-	}
-	else
-	{
-		ClipX1 = clipregion->iLeft;
-		ClipY1 = clipregion->iTop;
-		ClipX2 = clipregion->iRight;
-		ClipY2 = clipregion->iBottom;
-	}
-
-	// Calculate rows hanging off each side of the screen
-	const INT32 LeftSkip   = __min(ClipX1 -   MIN(ClipX1, iTempX), usWidth);
-	INT32       TopSkip    = __min(ClipY1 - __min(ClipY1, iTempY), usHeight);
-	const INT32 RightSkip  = __min(  MAX(ClipX2, iTempX + usWidth)  - ClipX2, usWidth);
-	const INT32 BottomSkip = __min(__max(ClipY2, iTempY + usHeight) - ClipY2, usHeight);
-
-	// calculate the remaining rows and columns to blit
-	const INT32 BlitLength = usWidth  - LeftSkip - RightSkip;
-	INT32       BlitHeight = usHeight - TopSkip  - BottomSkip;
-
-	// check if whole thing is clipped
-	if (LeftSkip >= usWidth  || RightSkip  >= usWidth)  return;
-	if (TopSkip  >= usHeight || BottomSkip >= usHeight) return;
-
-	UINT8 const* SrcPtr   = hSrcVObject->PixData(pTrav);
-	UINT8*       DestPtr  = (UINT8*)pBuffer  + uiDestPitchBYTES * (iTempY + TopSkip) + (iTempX + LeftSkip) * 2;
-	UINT8*       ZPtr     = (UINT8*)pZBuffer + uiDestPitchBYTES * (iTempY + TopSkip) + (iTempX + LeftSkip) * 2;
-	const UINT32 LineSkip = uiDestPitchBYTES - BlitLength * 2;
-	UINT16 const* const p16BPPPalette = hSrcVObject->CurrentShade();
-
-	if (hSrcVObject->ppZStripInfo == NULL)
-	{
-		SLOGW("Missing Z-Strip info on multi-Z object");
-		return;
-	}
-	// setup for the z-column blitting stuff
-	const ZStripInfo* const pZInfo = hSrcVObject->ppZStripInfo[usIndex];
-	if (pZInfo == NULL)
-	{
-		SLOGW("Missing Z-Strip info on multi-Z object");
-		return;
-	}
-
-	UINT16 usZStartLevel = (INT16)usZValue + pZInfo->bInitialZChange * Z_STRIP_DELTA_Y;
-	// set to odd number of pixels for first column
-
-	UINT16 usZStartCols;
-	if (LeftSkip > pZInfo->ubFirstZStripWidth)
-	{
-		usZStartCols = LeftSkip - pZInfo->ubFirstZStripWidth;
-		usZStartCols = 20 - usZStartCols % 20;
-	}
-	else if (LeftSkip < pZInfo->ubFirstZStripWidth)
-	{
-		usZStartCols  = pZInfo->ubFirstZStripWidth - LeftSkip;
-	}
-	else
-	{
-		usZStartCols = 20;
-	}
-
-	usZColsToGo = usZStartCols;
-
-	const INT8* const pZArray = pZInfo->pbZChange;
-
-	if (LeftSkip >= pZInfo->ubFirstZStripWidth)
-	{
-		// Index into array after doing left clipping
-		usZStartIndex = 1 + (LeftSkip - pZInfo->ubFirstZStripWidth) / 20;
-
-		//calculates the Z-value after left-side clipping
-		if (usZStartIndex)
-		{
-			for (UINT16 i = 0; i < usZStartIndex; i++)
-			{
-				switch (pZArray[i])
-				{
-					case -1: usZStartLevel -= Z_STRIP_DELTA_Y; break;
-					case  0: /* no change */                   break;
-					case  1: usZStartLevel += Z_STRIP_DELTA_Y; break;
-				}
-			}
-		}
-	}
-	else
-	{
-		usZStartIndex = 0;
-	}
-
-	usZLevel = usZStartLevel;
-	usZIndex = usZStartIndex;
-
-	UINT32 PxCount;
-
-	while (TopSkip > 0)
-	{
-		for (;;)
-		{
-			PxCount = *SrcPtr++;
-			if (PxCount & 0x80) continue;
-			if (PxCount == 0) break;
-			SrcPtr += PxCount;
-		}
-		TopSkip--;
-	}
-
-	do
-	{
-		usZLevel = usZStartLevel;
-		usZIndex = usZStartIndex;
-		usZColsToGo = usZStartCols;
-		for (LSCount = LeftSkip; LSCount > 0; LSCount -= PxCount)
-		{
-			PxCount = *SrcPtr++;
-			if (PxCount & 0x80)
-			{
-				PxCount &= 0x7F;
-				if (PxCount > LSCount)
-				{
-					PxCount -= LSCount;
-					LSCount = BlitLength;
-					goto BlitTransparent;
-				}
-			}
-			else
-			{
-				if (PxCount > LSCount)
-				{
-					SrcPtr += LSCount;
-					PxCount -= LSCount;
-					LSCount = BlitLength;
-					goto BlitNonTransLoop;
-				}
-				SrcPtr += PxCount;
-			}
-		}
-
-		LSCount = BlitLength;
-		while (LSCount > 0)
-		{
-			PxCount = *SrcPtr++;
-			if (PxCount & 0x80)
-			{
-BlitTransparent: // skip transparent pixels
-				PxCount &= 0x7F;
-				if (PxCount > LSCount) PxCount = LSCount;
-				LSCount -= PxCount;
-				DestPtr += 2 * PxCount;
-				ZPtr    += 2 * PxCount;
-				for (;;)
-				{
-					if (PxCount >= usZColsToGo)
-					{
-						PxCount -= usZColsToGo;
-						usZColsToGo = 20;
-
-						INT8 delta = pZArray[usZIndex++];
-						if (delta < 0)
-						{
-							usZLevel -= Z_STRIP_DELTA_Y;
-						}
-						else if (delta > 0)
-						{
-							usZLevel += Z_STRIP_DELTA_Y;
-						}
-					}
-					else
-					{
-						usZColsToGo -= PxCount;
-						break;
-					}
-				}
-			}
-			else
-			{
-BlitNonTransLoop: // blit non-transparent pixels
-				if (PxCount > LSCount)
-				{
-					Unblitted = PxCount - LSCount;
-					PxCount = LSCount;
-				}
-				else
-				{
-					Unblitted = 0;
-				}
-				LSCount -= PxCount;
-
-				do
-				{
-					if (*(UINT16*)ZPtr <= usZLevel)
-					{
-						*(UINT16*)ZPtr = usZLevel;
-						*(UINT16*)DestPtr = p16BPPPalette[*SrcPtr];
-					}
-					SrcPtr++;
-					DestPtr += 2;
-					ZPtr += 2;
-					if (--usZColsToGo == 0)
-					{
-						usZColsToGo = 20;
-
-						INT8 delta = pZArray[usZIndex++];
-						if (delta < 0)
-						{
-							usZLevel -= Z_STRIP_DELTA_Y;
-						}
-						else if (delta > 0)
-						{
-							usZLevel += Z_STRIP_DELTA_Y;
-						}
-					}
-				}
-				while (--PxCount > 0);
-				SrcPtr += Unblitted;
-			}
-		}
-
-		while (*SrcPtr++ != 0) {} // skip along until we hit and end-of-line marker
-		DestPtr += LineSkip;
-		ZPtr += LineSkip;
-	}
-	while (--BlitHeight > 0);
+	ZStripPolicy<true, false, false> const p(pZBuffer, usZValue, hSrcVObject->CurrentShade(), hSrcVObject, iY, usIndex, usIndex);
+	BltETRLE<true>(pBuffer, uiDestPitchBYTES, hSrcVObject, iX, iY, usIndex, clipregion, p);
 }
 
 
@@ -2965,793 +3043,135 @@ Blt8BPPDataTo16BPPBufferTransZIncObscureClip
 **********************************************************************************************/
 static void Blt8BPPDataTo16BPPBufferTransZIncObscureClip(UINT16* pBuffer, UINT32 uiDestPitchBYTES, UINT16* pZBuffer, UINT16 usZValue, HVOBJECT hSrcVObject, INT32 iX, INT32 iY, UINT16 usIndex, SGPRect* clipregion)
 {
-	UINT32 Unblitted;
-	INT32  LSCount;
-	UINT16 usZLevel, usZColsToGo, usZIndex;
+	ZStripPolicy<false, true, false> const p(pZBuffer, usZValue, hSrcVObject->CurrentShade(), hSrcVObject, iY, usIndex, usIndex);
+	BltETRLE<true>(pBuffer, uiDestPitchBYTES, hSrcVObject, iX, iY, usIndex, clipregion, p);
+}
 
-	Assert(hSrcVObject != NULL);
-	Assert(pBuffer     != NULL);
 
-	// Get Offsets from Index into structure
-	ETRLEObject const& pTrav    = hSrcVObject->SubregionProperties(usIndex);
-	INT32       const  usHeight = pTrav.usHeight;
-	INT32       const  usWidth  = pTrav.usWidth;
+/* Blitter Specs
+	* 1) 8 to 16 bpp
+	* 2) strip z-blitter
+	* 3) clipped
+	* 4) trans shadow - if value is 254, makes a shadow */
+static void Blt8BPPDataTo16BPPBufferTransZTransShadowIncObscureClip(UINT16* pBuffer, UINT32 uiDestPitchBYTES, UINT16* pZBuffer, UINT16 usZValue, HVOBJECT hSrcVObject, INT32 iX, INT32 iY, UINT16 usIndex, SGPRect* clipregion, INT16 sZIndex, const UINT16* p16BPPPalette)
+{
+	ZStripPolicy<false, true, true> const p(pZBuffer, usZValue, p16BPPPalette, hSrcVObject, iY, usIndex, sZIndex);
+	BltETRLE<true>(pBuffer, uiDestPitchBYTES, hSrcVObject, iX, iY, usIndex, clipregion, p);
+}
 
-	// Add to start position of dest buffer
-	INT32 const iTempX = iX + pTrav.sOffsetX;
-	INT32 const iTempY = iY + pTrav.sOffsetY;
+/* Blitter Specs
+	* 1) 8 to 16 bpp
+	* 2) strip z-blitter
+	* 3) clipped
+	* 4) trans shadow - if value is 254, makes a shadow */
+static void Blt8BPPDataTo16BPPBufferTransZTransShadowIncClip(UINT16* pBuffer, UINT32 uiDestPitchBYTES, UINT16* pZBuffer, UINT16 usZValue, HVOBJECT hSrcVObject, INT32 iX, INT32 iY, UINT16 usIndex, SGPRect* clipregion, INT16 sZIndex, const UINT16* p16BPPPalette)
+{
+	ZStripPolicy<true, false, true> const p(pZBuffer, usZValue, p16BPPPalette, hSrcVObject, iY, usIndex, sZIndex);
+	BltETRLE<true>(pBuffer, uiDestPitchBYTES, hSrcVObject, iX, iY, usIndex, clipregion, p);
+}
 
-	INT32 ClipX1;
-	INT32 ClipY1;
-	INT32 ClipX2;
-	INT32 ClipY2;
-	if (clipregion == NULL)
-	{
-		ClipX1 = ClippingRect.iLeft;
-		ClipY1 = ClippingRect.iTop;
-		ClipX2 = ClippingRect.iRight;
-		ClipY2 = ClippingRect.iBottom;
-	}
-	else
-	{
-		ClipX1 = clipregion->iLeft;
-		ClipY1 = clipregion->iTop;
-		ClipX2 = clipregion->iRight;
-		ClipY2 = clipregion->iBottom;
-	}
 
-	// Calculate rows hanging off each side of the screen
-	const INT32 LeftSkip   = __min(ClipX1 -   MIN(ClipX1, iTempX), usWidth);
-	INT32       TopSkip    = __min(ClipY1 - __min(ClipY1, iTempY), usHeight);
-	const INT32 RightSkip  = __min(  MAX(ClipX2, iTempX + usWidth)  - ClipX2, usWidth);
-	const INT32 BottomSkip = __min(__max(ClipY2, iTempY + usHeight) - ClipY2, usHeight);
+void BenchmarkRenderWorldBlitters()
+{
+#define CLIPPED(blt, call) BenchmarkObjectBlitter(#blt, true, [](BlitterBenchTarget& t, SGPVObject* vo, INT32 x, INT32 y, UINT16 i) { call; })
+	CLIPPED(TransZIncClip,                   Blt8BPPDataTo16BPPBufferTransZIncClip(t.buf, t.pitch, t.zbuf, t.z, vo, x, y, i, &t.clip));
+	CLIPPED(TransZIncClipZSameZBurnsThrough, Blt8BPPDataTo16BPPBufferTransZIncClipZSameZBurnsThrough(t.buf, t.pitch, t.zbuf, t.z, vo, x, y, i, &t.clip));
+	CLIPPED(TransZIncObscureClip,            Blt8BPPDataTo16BPPBufferTransZIncObscureClip(t.buf, t.pitch, t.zbuf, t.z, vo, x, y, i, &t.clip));
+	CLIPPED(TransZTransShadowIncClip,        Blt8BPPDataTo16BPPBufferTransZTransShadowIncClip(t.buf, t.pitch, t.zbuf, t.z, vo, x, y, i, &t.clip, i, vo->CurrentShade()));
+	CLIPPED(TransZTransShadowIncObscureClip, Blt8BPPDataTo16BPPBufferTransZTransShadowIncObscureClip(t.buf, t.pitch, t.zbuf, t.z, vo, x, y, i, &t.clip, i, vo->CurrentShade()));
+#undef CLIPPED
+}
 
-	UINT32 uiLineFlag = iTempY & 1;
 
-	// calculate the remaining rows and columns to blit
-	const INT32 BlitLength = usWidth  - LeftSkip - RightSkip;
-	INT32       BlitHeight = usHeight - TopSkip  - BottomSkip;
+#define MIN_TILE_BAND_HEIGHT 16
 
-	// check if whole thing is clipped
-	if (LeftSkip >= usWidth  || RightSkip  >= usWidth)  return;
-	if (TopSkip  >= usHeight || BottomSkip >= usHeight) return;
+struct TileBlitBands
+{
+	UINT16* buf;
+	UINT32  pitch;
+	SGPRect clip;
+	UINT    n_bands;
+};
 
-	UINT8 const* SrcPtr   = hSrcVObject->PixData(pTrav);
-	UINT8*       DestPtr  = (UINT8*)pBuffer  + uiDestPitchBYTES * (iTempY + TopSkip) + (iTempX + LeftSkip) * 2;
-	UINT8*       ZPtr     = (UINT8*)pZBuffer + uiDestPitchBYTES * (iTempY + TopSkip) + (iTempX + LeftSkip) * 2;
-	const UINT32 LineSkip = uiDestPitchBYTES - BlitLength * 2;
-	UINT16 const* const p16BPPPalette = hSrcVObject->CurrentShade();
 
-	if (hSrcVObject->ppZStripInfo == NULL)
-	{
-		SLOGW("Missing Z-Strip info on multi-Z object");
-		return;
-	}
-	// setup for the z-column blitting stuff
-	const ZStripInfo* const pZInfo = hSrcVObject->ppZStripInfo[usIndex];
-	if (pZInfo == NULL)
+static void ExecuteTileBlit(TileBlit const& b, UINT16* const buf, UINT32 const pitch, SGPRect const* const clip)
+{
+	switch (b.type)
 	{
-		SLOGW("Missing Z-Strip info on multi-Z object");
-		return;
-	}
+		case TILE_BLIT_TRANSPARENT:
+			BltETRLE<true>(buf, pitch, b.vo, b.x, b.y, b.index, clip, ETRLEPalettePolicy(b.pal));
+			break;
 
-	UINT16 usZStartLevel = (INT16)usZValue + pZInfo->bInitialZChange * Z_STRIP_DELTA_Y;
-	// set to odd number of pixels for first column
+		case TILE_BLIT_Z:
+			BltETRLE<true>(buf, pitch, b.vo, b.x, b.y, b.index, clip, ETRLEPaletteZPolicy<true>(gpZBuffer, b.z, b.pal));
+			break;
 
-	UINT16 usZStartCols;
-	if (LeftSkip > pZInfo->ubFirstZStripWidth)
-	{
-		usZStartCols = LeftSkip - pZInfo->ubFirstZStripWidth;
-		usZStartCols = 20 - usZStartCols % 20;
-	}
-	else if (LeftSkip < pZInfo->ubFirstZStripWidth)
-	{
-		usZStartCols = pZInfo->ubFirstZStripWidth - LeftSkip;
-	}
-	else
-	{
-		usZStartCols = 20;
-	}
+		case TILE_BLIT_ZNB:
+			BltETRLE<true>(buf, pitch, b.vo, b.x, b.y, b.index, clip, ETRLEPaletteZPolicy<false>(gpZBuffer, b.z, b.pal));
+			break;
+
+		case TILE_BLIT_SHADOW:
+			BltETRLE<true>(buf, pitch, b.vo, b.x, b.y, b.index, clip, ETRLEShadePolicy());
+			break;
 
-	usZColsToGo = usZStartCols;
+		case TILE_BLIT_SHADOW_Z:
+			BltETRLE<true>(buf, pitch, b.vo, b.x, b.y, b.index, clip, ETRLEShadeZPolicy<true>(gpZBuffer, b.z));
+			break;
 
-	const INT8* const pZArray  = pZInfo->pbZChange;
+		case TILE_BLIT_SHADOW_ZNB:
+			BltETRLE<true>(buf, pitch, b.vo, b.x, b.y, b.index, clip, ETRLEShadeZPolicy<false>(gpZBuffer, b.z));
+			break;
 
-	UINT16 usZStartIndex;
-	if (LeftSkip >= pZInfo->ubFirstZStripWidth)
-	{
-		// Index into array after doing left clipping
-		usZStartIndex = 1 + (LeftSkip - pZInfo->ubFirstZStripWidth) / 20;
+		case TILE_BLIT_Z_INC:
+			BltETRLE<true>(buf, pitch, b.vo, b.x, b.y, b.index, clip, ZStripPolicy<false, false, false>(gpZBuffer, b.z, b.pal, b.vo, b.y, b.index, b.z_strip_index));
+			break;
 
-		//calculates the Z-value after left-side clipping
-		if (usZStartIndex)
-		{
-			for (UINT16 i = 0; i < usZStartIndex; i++)
-			{
-				switch (pZArray[i])
-				{
-					case -1: usZStartLevel -= Z_STRIP_DELTA_Y; break;
-					case  0: /* no change */                   break;
-					case  1: usZStartLevel += Z_STRIP_DELTA_Y; break;
-				}
-			}
-		}
-	}
-	else
-	{
-		usZStartIndex = 0;
-	}
+		case TILE_BLIT_Z_INC_SAME_Z_BURNS_THROUGH:
+			BltETRLE<true>(buf, pitch, b.vo, b.x, b.y, b.index, clip, ZStripPolicy<true, false, false>(gpZBuffer, b.z, b.pal, b.vo, b.y, b.index, b.z_strip_index));
+			break;
 
-	usZLevel = usZStartLevel;
-	usZIndex = usZStartIndex;
+		case TILE_BLIT_Z_INC_OBSCURE:
+			BltETRLE<true>(buf, pitch, b.vo, b.x, b.y, b.index, clip, ZStripPolicy<false, true, false>(gpZBuffer, b.z, b.pal, b.vo, b.y, b.index, b.z_strip_index));
+			break;
 
-	UINT32 PxCount;
+		case TILE_BLIT_Z_TRANS_SHADOW_INC:
+			BltETRLE<true>(buf, pitch, b.vo, b.x, b.y, b.index, clip, ZStripPolicy<true, false, true>(gpZBuffer, b.z, b.pal, b.vo, b.y, b.index, b.z_strip_index));
+			break;
 
-	while (TopSkip > 0)
-	{
-		for (;;)
-		{
-			PxCount = *SrcPtr++;
-			if (PxCount & 0x80) continue;
-			if (PxCount == 0) break;
-			SrcPtr += PxCount;
-		}
-		uiLineFlag ^= 1; // XXX evaluate before loop
-		TopSkip--;
+		default: break;
 	}
+}
 
-	do
+
+static void RenderTileBlitBand(UINT const band, void* const ctx)
+{
+	TileBlitBands const& bands = *static_cast<TileBlitBands const*>(ctx);
+	INT32   const h    = bands.clip.iBottom - bands.clip.iTop;
+	SGPRect       clip = bands.clip;
+	clip.iTop    = bands.clip.iTop + h *  band      / bands.n_bands;
+	clip.iBottom = bands.clip.iTop + h * (band + 1) / bands.n_bands;
+	if (clip.iTop == clip.iBottom) return;
+
+	for (std::vector<TileBlit>::const_iterator i = g_tile_blits.begin(), end = g_tile_blits.end(); i != end; ++i)
 	{
-		usZLevel = usZStartLevel;
-		usZIndex = usZStartIndex;
-		usZColsToGo = usZStartCols;
-		for (LSCount = LeftSkip; LSCount > 0; LSCount -= PxCount)
-		{
-			PxCount = *SrcPtr++;
-			if (PxCount & 0x80)
-			{
-				PxCount &= 0x7F;
-				if (PxCount > LSCount)
-				{
-					PxCount -= LSCount;
-					LSCount = BlitLength;
-					goto BlitTransparent;
-				}
-			}
-			else
-			{
-				if (PxCount > LSCount)
-				{
-					SrcPtr += LSCount;
-					PxCount -= LSCount;
-					LSCount = BlitLength;
-					goto BlitNonTransLoop;
-				}
-				SrcPtr += PxCount;
-			}
-		}
+		ExecuteTileBlit(*i, bands.buf, bands.pitch, &clip);
+	}
+}
 
-		LSCount = BlitLength;
-		while (LSCount > 0)
-		{
-			PxCount = *SrcPtr++;
-			if (PxCount & 0x80)
-			{
-BlitTransparent: // skip transparent pixels
-				PxCount &= 0x7F;
-				if (PxCount > LSCount) PxCount = LSCount;
-				LSCount -= PxCount;
-				DestPtr += 2 * PxCount;
-				ZPtr    += 2 * PxCount;
-				for (;;)
-				{
-					if (PxCount >= usZColsToGo)
-					{
-						PxCount -= usZColsToGo;
-						usZColsToGo = 20;
 
-						INT8 delta = pZArray[usZIndex++];
-						if (delta < 0)
-						{
-							usZLevel -= Z_STRIP_DELTA_Y;
-						}
-						else if (delta > 0)
-						{
-							usZLevel += Z_STRIP_DELTA_Y;
-						}
-					}
-					else
-					{
-						usZColsToGo -= PxCount;
-						break;
-					}
-				}
-			}
-			else
-			{
-BlitNonTransLoop: // blit non-transparent pixels
-				if (PxCount > LSCount)
-				{
-					Unblitted = PxCount - LSCount;
-					PxCount = LSCount;
-				}
-				else
-				{
-					Unblitted = 0;
-				}
-				LSCount -= PxCount;
-
-				do
-				{
-					if (*(UINT16*)ZPtr < usZLevel ||
-							uiLineFlag == (((uintptr_t)DestPtr & 2) != 0)) // XXX update Z when pixelating?
-					{
-						*(UINT16*)ZPtr = usZLevel;
-						*(UINT16*)DestPtr = p16BPPPalette[*SrcPtr];
-					}
-					SrcPtr++;
-					DestPtr += 2;
-					ZPtr += 2;
-					if (--usZColsToGo == 0)
-					{
-						usZColsToGo = 20;
-
-						INT8 delta = pZArray[usZIndex++];
-						if (delta < 0)
-						{
-							usZLevel -= Z_STRIP_DELTA_Y;
-						}
-						else if (delta > 0)
-						{
-							usZLevel += Z_STRIP_DELTA_Y;
-						}
-					}
-				}
-				while (--PxCount > 0);
-				SrcPtr += Unblitted;
-			}
-		}
-
-		while (*SrcPtr++ != 0) {} // skip along until we hit and end-of-line marker
-		uiLineFlag ^= 1;
-		DestPtr += LineSkip;
-		ZPtr += LineSkip;
-	}
-	while (--BlitHeight > 0);
-}
-
-
-/* Blitter Specs
-	* 1) 8 to 16 bpp
-	* 2) strip z-blitter
-	* 3) clipped
-	* 4) trans shadow - if value is 254, makes a shadow */
-static void Blt8BPPDataTo16BPPBufferTransZTransShadowIncObscureClip(UINT16* pBuffer, UINT32 uiDestPitchBYTES, UINT16* pZBuffer, UINT16 usZValue, HVOBJECT hSrcVObject, INT32 iX, INT32 iY, UINT16 usIndex, SGPRect* clipregion, INT16 sZIndex, const UINT16* p16BPPPalette)
-{
-	UINT32 Unblitted;
-	INT32  LSCount;
-	UINT16 usZLevel, usZColsToGo, usZIndex;
-
-	Assert(hSrcVObject != NULL);
-	Assert(pBuffer     != NULL);
-
-	// Get Offsets from Index into structure
-	ETRLEObject const& pTrav    = hSrcVObject->SubregionProperties(usIndex);
-	INT32       const  usHeight = pTrav.usHeight;
-	INT32       const  usWidth  = pTrav.usWidth;
-
-	// Add to start position of dest buffer
-	INT32 const iTempX = iX + pTrav.sOffsetX;
-	INT32 const iTempY = iY + pTrav.sOffsetY;
-
-	INT32 ClipX1;
-	INT32 ClipY1;
-	INT32 ClipX2;
-	INT32 ClipY2;
-	if (clipregion == NULL)
-	{
-		ClipX1 = ClippingRect.iLeft;
-		ClipY1 = ClippingRect.iTop;
-		ClipX2 = ClippingRect.iRight;
-		ClipY2 = ClippingRect.iBottom;
-	}
-	else
-	{
-		ClipX1 = clipregion->iLeft;
-		ClipY1 = clipregion->iTop;
-		ClipX2 = clipregion->iRight;
-		ClipY2 = clipregion->iBottom;
-	}
-
-	// Calculate rows hanging off each side of the screen
-	const INT32 LeftSkip   = __min(ClipX1 -   MIN(ClipX1, iTempX), usWidth);
-	INT32       TopSkip    = __min(ClipY1 - __min(ClipY1, iTempY), usHeight);
-	const INT32 RightSkip  = __min(  MAX(ClipX2, iTempX + usWidth)  - ClipX2, usWidth);
-	const INT32 BottomSkip = __min(__max(ClipY2, iTempY + usHeight) - ClipY2, usHeight);
-
-	UINT32 uiLineFlag = iTempY & 1;
-
-	// calculate the remaining rows and columns to blit
-	const INT32 BlitLength = usWidth - LeftSkip - RightSkip;
-	INT32       BlitHeight = usHeight - TopSkip - BottomSkip;
-
-	// check if whole thing is clipped
-	if (LeftSkip >= usWidth  || RightSkip  >= usWidth)  return;
-	if (TopSkip  >= usHeight || BottomSkip >= usHeight) return;
-
-	UINT8 const* SrcPtr   = hSrcVObject->PixData(pTrav);
-	UINT8*       DestPtr = (UINT8*)pBuffer  + uiDestPitchBYTES * (iTempY + TopSkip) + (iTempX + LeftSkip) * 2;
-	UINT8*       ZPtr    = (UINT8*)pZBuffer + uiDestPitchBYTES * (iTempY + TopSkip) + (iTempX + LeftSkip) * 2;
-	const UINT32 LineSkip = uiDestPitchBYTES - BlitLength * 2;
-
-	if (hSrcVObject->ppZStripInfo == NULL)
-	{
-		SLOGW("Missing Z-Strip info on multi-Z object");
-		return;
-	}
-	// setup for the z-column blitting stuff
-	const ZStripInfo* const pZInfo = hSrcVObject->ppZStripInfo[sZIndex];
-	if (pZInfo == NULL)
-	{
-		SLOGW("Missing Z-Strip info on multi-Z object");
-		return;
-	}
-
-	UINT16 usZStartLevel = (INT16)usZValue + pZInfo->bInitialZChange * Z_SUBLAYERS * 10;
-
-	UINT16 usZStartCols;
-	if (LeftSkip > pZInfo->ubFirstZStripWidth)
-	{
-		usZStartCols = LeftSkip - pZInfo->ubFirstZStripWidth;
-		usZStartCols = 20 - usZStartCols % 20;
-	}
-	else if (LeftSkip < pZInfo->ubFirstZStripWidth)
-	{
-		usZStartCols = pZInfo->ubFirstZStripWidth - LeftSkip;
-	}
-	else
-	{
-		usZStartCols = 20;
-	}
-
-	// set to odd number of pixels for first column
-	usZColsToGo = usZStartCols;
-
-	const INT8* const pZArray = pZInfo->pbZChange;
-
-	UINT16 usZStartIndex;
-	if (LeftSkip >= usZColsToGo)
-	{
-		// Index into array after doing left clipping
-		usZStartIndex = 1 + (LeftSkip - pZInfo->ubFirstZStripWidth) / 20;
-
-		//calculates the Z-value after left-side clipping
-		if (usZStartIndex)
-		{
-			for (UINT16 i = 0; i < usZStartIndex; i++)
-			{
-				switch (pZArray[i])
-				{
-					case -1: usZStartLevel -= Z_SUBLAYERS; break;
-					case  0: /* no change */               break;
-					case  1: usZStartLevel += Z_SUBLAYERS; break;
-				}
-			}
-		}
-	}
-	else
-	{
-		usZStartIndex = 0;
-	}
-
-	usZLevel = usZStartLevel;
-	usZIndex = usZStartIndex;
-
-	UINT32 PxCount;
-
-	while (TopSkip > 0)
-	{
-		for (;;)
-		{
-			PxCount = *SrcPtr++;
-			if (PxCount & 0x80) continue;
-			if (PxCount == 0) break;
-			SrcPtr += PxCount;
-		}
-		TopSkip--;
-	}
-
-	do
-	{
-		usZLevel = usZStartLevel;
-		usZIndex = usZStartIndex;
-		usZColsToGo = usZStartCols;
-		for (LSCount = LeftSkip; LSCount > 0; LSCount -= PxCount)
-		{
-			PxCount = *SrcPtr++;
-			if (PxCount & 0x80)
-			{
-				PxCount &= 0x7F;
-				if (PxCount > LSCount)
-				{
-					PxCount -= LSCount;
-					LSCount = BlitLength;
-					goto BlitTransparent;
-				}
-			}
-			else
-			{
-				if (PxCount > LSCount)
-				{
-					SrcPtr += LSCount;
-					PxCount -= LSCount;
-					LSCount = BlitLength;
-					goto BlitNonTransLoop;
-				}
-				SrcPtr += PxCount;
-			}
-		}
-
-		LSCount = BlitLength;
-		while (LSCount > 0)
-		{
-			PxCount = *SrcPtr++;
-			if (PxCount & 0x80)
-			{
-BlitTransparent: // skip transparent pixels
-				PxCount &= 0x7F;
-				if (PxCount > LSCount) PxCount = LSCount;
-				LSCount -= PxCount;
-				DestPtr += 2 * PxCount;
-				ZPtr    += 2 * PxCount;
-				for (;;)
-				{
-					if (PxCount >= usZColsToGo)
-					{
-						PxCount -= usZColsToGo;
-						usZColsToGo = 20;
-
-						INT8 delta = pZArray[usZIndex++];
-						if (delta < 0)
-						{
-							usZLevel -= Z_STRIP_DELTA_Y;
-						}
-						else if (delta > 0)
-						{
-							usZLevel += Z_STRIP_DELTA_Y;
-						}
-					}
-					else
-					{
-						usZColsToGo -= PxCount;
-						break;
-					}
-				}
-			}
-			else
-			{
-BlitNonTransLoop: // blit non-transparent pixels
-				if (PxCount > LSCount)
-				{
-					Unblitted = PxCount - LSCount;
-					PxCount = LSCount;
-				}
-				else
-				{
-					Unblitted = 0;
-				}
-				LSCount -= PxCount;
-
-				do
-				{
-					if (*(UINT16*)ZPtr < usZLevel ||
-							uiLineFlag == (((uintptr_t)DestPtr & 2) != 0)) // XXX update Z when pixelating?
-					{
-						*(UINT16*)ZPtr = usZLevel;
-						UINT8 Px = *SrcPtr;
-						if (Px == 254)
-						{
-							*(UINT16*)DestPtr = ShadeTable[*(UINT16*)DestPtr];
-						}
-						else
-						{
-							*(UINT16*)DestPtr = p16BPPPalette[Px];
-						}
-					}
-					SrcPtr++;
-					DestPtr += 2;
-					ZPtr += 2;
-					if (--usZColsToGo == 0)
-					{
-						usZColsToGo = 20;
-
-						INT8 delta = pZArray[usZIndex++];
-						if (delta < 0)
-						{
-							usZLevel -= Z_STRIP_DELTA_Y;
-						}
-						else if (delta > 0)
-						{
-							usZLevel += Z_STRIP_DELTA_Y;
-						}
-					}
-				}
-				while (--PxCount > 0);
-				SrcPtr += Unblitted;
-			}
-		}
-
-		while (*SrcPtr++ != 0) {} // skip along until we hit and end-of-line marker
-		uiLineFlag ^= 1;
-		DestPtr += LineSkip;
-		ZPtr += LineSkip;
-	}
-	while (--BlitHeight > 0);
-}
-
-/* Blitter Specs
-	* 1) 8 to 16 bpp
-	* 2) strip z-blitter
-	* 3) clipped
-	* 4) trans shadow - if value is 254, makes a shadow */
-static void Blt8BPPDataTo16BPPBufferTransZTransShadowIncClip(UINT16* pBuffer, UINT32 uiDestPitchBYTES, UINT16* pZBuffer, UINT16 usZValue, HVOBJECT hSrcVObject, INT32 iX, INT32 iY, UINT16 usIndex, SGPRect* clipregion, INT16 sZIndex, const UINT16* p16BPPPalette)
+static void FlushTileBlits(UINT16* const buf, UINT32 const uiDestPitchBYTES)
 {
-	UINT32 Unblitted;
-	INT32  LSCount;
-	UINT16 usZLevel, usZColsToGo, usZIndex;
-
-	Assert(hSrcVObject != NULL);
-	Assert(pBuffer     != NULL);
-
-	// Get Offsets from Index into structure
-	ETRLEObject const& pTrav    = hSrcVObject->SubregionProperties(usIndex);
-	INT32       const  usHeight = pTrav.usHeight;
-	INT32       const  usWidth  = pTrav.usWidth;
-
-	// Add to start position of dest buffer
-	INT32 const iTempX = iX + pTrav.sOffsetX;
-	INT32 const iTempY = iY + pTrav.sOffsetY;
-
-	INT32 ClipX1;
-	INT32 ClipY1;
-	INT32 ClipX2;
-	INT32 ClipY2;
-	if (clipregion == NULL)
-	{
-		ClipX1 = ClippingRect.iLeft;
-		ClipY1 = ClippingRect.iTop;
-		ClipX2 = ClippingRect.iRight;
-		ClipY2 = ClippingRect.iBottom;
-	}
-	else
-	{
-		ClipX1 = clipregion->iLeft;
-		ClipY1 = clipregion->iTop;
-		ClipX2 = clipregion->iRight;
-		ClipY2 = clipregion->iBottom;
-	}
-
-	// Calculate rows hanging off each side of the screen
-	const INT32 LeftSkip   = __min(ClipX1 -   MIN(ClipX1, iTempX), usWidth);
-	INT32       TopSkip    = __min(ClipY1 - __min(ClipY1, iTempY), usHeight);
-	const INT32 RightSkip  = __min(  MAX(ClipX2, iTempX + usWidth)  - ClipX2, usWidth);
-	const INT32 BottomSkip = __min(__max(ClipY2, iTempY + usHeight) - ClipY2, usHeight);
-
-	// calculate the remaining rows and columns to blit
-	const INT32 BlitLength = usWidth  - LeftSkip - RightSkip;
-	INT32       BlitHeight = usHeight - TopSkip  - BottomSkip;
-
-	// check if whole thing is clipped
-	if (LeftSkip >= usWidth  || RightSkip  >= usWidth)  return;
-	if (TopSkip  >= usHeight || BottomSkip >= usHeight) return;
-
-	UINT8 const* SrcPtr   = hSrcVObject->PixData(pTrav);
-	UINT8*       DestPtr  = (UINT8*)pBuffer  + uiDestPitchBYTES * (iTempY + TopSkip) + (iTempX + LeftSkip) * 2;
-	UINT8*       ZPtr     = (UINT8*)pZBuffer + uiDestPitchBYTES * (iTempY + TopSkip) + (iTempX + LeftSkip) * 2;
-	const UINT32 LineSkip = uiDestPitchBYTES - BlitLength * 2;
-
-	if (hSrcVObject->ppZStripInfo == NULL)
-	{
-		SLOGW("Missing Z-Strip info on multi-Z object");
-		return;
-	}
-	// setup for the z-column blitting stuff
-	const ZStripInfo* const pZInfo = hSrcVObject->ppZStripInfo[sZIndex];
-	if (pZInfo == NULL)
-	{
-		SLOGW("Missing Z-Strip info on multi-Z object");
-		return;
-	}
-
-	UINT16 usZStartLevel = (INT16)usZValue + pZInfo->bInitialZChange * Z_SUBLAYERS * 10;
-
-	UINT16 usZStartCols;
-	if (LeftSkip > pZInfo->ubFirstZStripWidth)
-	{
-		usZStartCols = LeftSkip - pZInfo->ubFirstZStripWidth;
-		usZStartCols = 20 - usZStartCols % 20;
-	}
-	else if (LeftSkip < pZInfo->ubFirstZStripWidth)
-	{
-		usZStartCols = pZInfo->ubFirstZStripWidth - LeftSkip;
-	}
-	else
-	{
-		usZStartCols = 20;
-	}
-
-	// set to odd number of pixels for first column
-	usZColsToGo = usZStartCols;
-
-	const INT8* const pZArray = pZInfo->pbZChange;
-
-	UINT16 usZStartIndex;
-	if (LeftSkip >= usZColsToGo)
-	{
-		// Index into array after doing left clipping
-		usZStartIndex = 1 + (LeftSkip - pZInfo->ubFirstZStripWidth) / 20;
-
-		// calculates the Z-value after left-side clipping
-		if (usZStartIndex)
-		{
-			for (UINT16 i = 0; i < usZStartIndex; i++)
-			{
-				switch (pZArray[i])
-				{
-					case -1: usZStartLevel -= Z_SUBLAYERS; break;
-					case  0: /* no change */               break;
-					case  1: usZStartLevel += Z_SUBLAYERS; break;
-				}
-			}
-		}
-	}
-	else
-	{
-		usZStartIndex = 0;
-	}
-
-	usZLevel = usZStartLevel;
-	usZIndex = usZStartIndex;
-
-	UINT32 PxCount;
-
-	while (TopSkip > 0)
-	{
-		for (;;)
-		{
-			PxCount = *SrcPtr++;
-			if (PxCount & 0x80) continue;
-			if (PxCount == 0) break;
-			SrcPtr += PxCount;
-		}
-		TopSkip--;
-	}
-
-	do
-	{
-		usZLevel = usZStartLevel;
-		usZIndex = usZStartIndex;
-		usZColsToGo = usZStartCols;
-		for (LSCount = LeftSkip; LSCount > 0; LSCount -= PxCount)
-		{
-			PxCount = *SrcPtr++;
-			if (PxCount & 0x80)
-			{
-				PxCount &= 0x7F;
-				if (PxCount > LSCount)
-				{
-					PxCount -= LSCount;
-					LSCount = BlitLength;
-					goto BlitTransparent;
-				}
-			}
-			else
-			{
-				if (PxCount > LSCount)
-				{
-					SrcPtr += LSCount;
-					PxCount -= LSCount;
-					LSCount = BlitLength;
-					goto BlitNonTransLoop;
-				}
-				SrcPtr += PxCount;
-			}
-		}
-
-		LSCount = BlitLength;
-		while (LSCount > 0)
-		{
-			PxCount = *SrcPtr++;
-			if (PxCount & 0x80)
-			{
-BlitTransparent: // skip transparent pixels
-				PxCount &= 0x7F;
-				if (PxCount > LSCount) PxCount = LSCount;
-				LSCount -= PxCount;
-				DestPtr += 2 * PxCount;
-				ZPtr    += 2 * PxCount;
-				for (;;)
-				{
-					if (PxCount >= usZColsToGo)
-					{
-						PxCount -= usZColsToGo;
-						usZColsToGo = 20;
-
-						INT8 delta = pZArray[usZIndex++];
-						if (delta < 0)
-						{
-							usZLevel -= Z_STRIP_DELTA_Y;
-						}
-						else if (delta > 0)
-						{
-							usZLevel += Z_STRIP_DELTA_Y;
-						}
-					}
-					else
-					{
-						usZColsToGo -= PxCount;
-						break;
-					}
-				}
-			}
-			else
-			{
-BlitNonTransLoop: // blit non-transparent pixels
-				if (PxCount > LSCount)
-				{
-					Unblitted = PxCount - LSCount;
-					PxCount = LSCount;
-				}
-				else
-				{
-					Unblitted = 0;
-				}
-				LSCount -= PxCount;
-
-				do
-				{
-					if (*(UINT16*)ZPtr <= usZLevel)
-					{
-						*(UINT16*)ZPtr = usZLevel;
-
-						UINT32 Px = *SrcPtr;
-						if (Px == 254)
-						{
-							*(UINT16*)DestPtr = ShadeTable[*(UINT16*)DestPtr];
-						}
-						else
-						{
-							*(UINT16*)DestPtr = p16BPPPalette[*SrcPtr];
-						}
-					}
-					SrcPtr++;
-					DestPtr += 2;
-					ZPtr += 2;
-					if (--usZColsToGo == 0)
-					{
-						usZColsToGo = 20;
-
-						INT8 delta = pZArray[usZIndex++];
-						if (delta < 0)
-						{
-							usZLevel -= Z_SUBLAYERS;
-						}
-						else if (delta > 0)
-						{
-							usZLevel += Z_SUBLAYERS;
-						}
-					}
-				}
-				while (--PxCount > 0);
-				SrcPtr += Unblitted;
-			}
-		}
-
-		while (*SrcPtr++ != 0) {} // skip along until we hit and end-of-line marker
-		DestPtr += LineSkip;
-		ZPtr += LineSkip;
-	}
-	while (--BlitHeight > 0);
+	if (g_tile_blits.empty()) return;
+
+	TileBlitBands bands;
+	bands.buf     = buf;
+	bands.pitch   = uiDestPitchBYTES;
+	bands.clip    = gClippingRect;
+	INT32 const h = bands.clip.iBottom - bands.clip.iTop;
+	// Twice as many bands as threads evens out bands with few sprites
+	bands.n_bands = __max(__min(WorkerPoolSize() * 2, (UINT)(h / MIN_TILE_BAND_HEIGHT)), 1U);
+	RunParallel(bands.n_bands, RenderTileBlitBand, &bands);
+	g_tile_blits.clear();
 }
 
 
@@ -118,8 +118,16 @@ void RenderStaticWorldRect(INT16 sLeft, INT16 sTop, INT16 sRight, INT16 sBottom,
 
 void InvalidateWorldRedundency(void);
 
+/* Drops the cached static world, for changes which are not visible in the world
+ * data, like new shade tables. */
+void InvalidateStaticWorldCache();
+
 void SetRenderCenter(INT16 sNewX, INT16 sNewY);
 
+/* Times the blitters which only the world renderer uses, see
+ * BenchmarkBlitters(). */
+void BenchmarkRenderWorldBlitters();
+
 #if defined _DEBUG
 void RenderFOVDebug(void);
 void RenderCoverDebug(void);
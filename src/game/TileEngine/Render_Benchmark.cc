@@ -0,0 +1,192 @@
+#include "Render_Benchmark.h"
+#include "Benchmark_Suite.h"
+#include "ContentManager.h"
+#include "GameInstance.h"
+#include "Isometric_Utils.h"
+#include "Logger.h"
+#include "Profiler.h"
+#include "RenderWorld.h"
+#include "Render_Dirty.h"
+#include "Simple_Render_Utils.h"
+#include "WorldDef.h"
+
+#include <SDL.h>
+
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+
+#define BENCH_STOPS_PER_ROW 8 // the path runs over a grid of as many by as many stops
+#define BENCH_MARKED_RADIUS 2 // tiles around the centre marked dirty for the marked frames
+
+
+enum RenderBenchPhase
+{
+	BENCH_RENDER_WORLD,
+	BENCH_STATIC,
+	BENCH_DYNAMIC,
+	BENCH_MARKED,
+	BENCH_OVERLAYS,
+	BENCH_NUM_PHASES
+};
+
+static ProfilePhase const g_bench_phases[] =
+{
+	PROFILE_RENDER_WORLD,
+	PROFILE_RENDER_STATIC,
+	PROFILE_RENDER_DYNAMIC,
+	PROFILE_RENDER_MARKED,
+	PROFILE_VIDEO_OVERLAYS
+};
+
+
+struct RenderBenchResult
+{
+	UINT32 frames;
+	double frame_ms;
+	double ms[BENCH_NUM_PHASES];
+};
+
+
+// The centres of the stops, row by row, every other row backwards
+static std::vector<GridNo> CameraPath()
+{
+	std::vector<GridNo> path;
+	for (UINT row = 0; row != BENCH_STOPS_PER_ROW; ++row)
+	{
+		for (UINT i = 0; i != BENCH_STOPS_PER_ROW; ++i)
+		{
+			UINT   const col = row % 2 == 0 ? i : BENCH_STOPS_PER_ROW - 1 - i;
+			INT16  const x   = (2 * col + 1) * WORLD_COLS / (2 * BENCH_STOPS_PER_ROW);
+			INT16  const y   = (2 * row + 1) * WORLD_ROWS / (2 * BENCH_STOPS_PER_ROW);
+			GridNo const g   = y * WORLD_COLS + x;
+			if (GridNoOnVisibleWorldTile(g)) path.push_back(g);
+		}
+	}
+	return path;
+}
+
+
+static void MarkTilesAround(GridNo const centre)
+{
+	for (INT16 dy = -BENCH_MARKED_RADIUS; dy <= BENCH_MARKED_RADIUS; ++dy)
+	{
+		for (INT16 dx = -BENCH_MARKED_RADIUS; dx <= BENCH_MARKED_RADIUS; ++dx)
+		{
+			GridNo const g = centre + dy * WORLD_COLS + dx;
+			if (0 <= g && g < WORLD_MAX) MarkMapIndexDirty(g);
+		}
+	}
+}
+
+
+static void RenderFrame(RenderBenchResult& r)
+{
+	ProfilerBeginFrame();
+	uint64_t const start = SDL_GetPerformanceCounter();
+	RenderWorld();
+	ExecuteVideoOverlays();
+	ExecuteBaseDirtyRectQueue();
+	r.frame_ms += MSSince(start);
+	ProfilerEndFrame();
+
+	++r.frames;
+	for (UINT p = 0; p != BENCH_NUM_PHASES; ++p) r.ms[p] += ProfilerLastFrameMS(g_bench_phases[p]);
+}
+
+
+static void AddResult(RenderBenchResult& total, RenderBenchResult const& r)
+{
+	total.frames   += r.frames;
+	total.frame_ms += r.frame_ms;
+	for (UINT p = 0; p != BENCH_NUM_PHASES; ++p) total.ms[p] += r.ms[p];
+}
+
+
+// Writes the milliseconds per frame
+static void WriteResult(FILE* const f, char const* const pass, char const* const kind, char const* const stop, RenderBenchResult const& r)
+{
+	if (!f || r.frames == 0) return;
+	fprintf(f, "%s,%s,%s,%u,%.3f", pass, kind, stop, r.frames, r.frame_ms / r.frames);
+	for (UINT p = 0; p != BENCH_NUM_PHASES; ++p) fprintf(f, ",%.3f", r.ms[p] / r.frames);
+	fputc('\n', f);
+}
+
+
+static void LogResult(char const* const pass, char const* const kind, RenderBenchResult const& r)
+{
+	if (r.frames == 0) return;
+	double const n = r.frames;
+	SLOGI("Render benchmark, %s, %s frames: %u frames, %.3f ms per frame, RenderWorld %.3f ms (static %.3f, dynamic %.3f, marked %.3f), video overlays %.3f ms",
+		pass, kind, r.frames, r.frame_ms / n, r.ms[BENCH_RENDER_WORLD] / n,
+		r.ms[BENCH_STATIC] / n, r.ms[BENCH_DYNAMIC] / n, r.ms[BENCH_MARKED] / n, r.ms[BENCH_OVERLAYS] / n);
+	RecordBenchmarkResult(std::string("render.") + pass + "." + kind + "_frame_ms", r.frame_ms / n);
+}
+
+
+void BenchmarkTacticalRendering(char const* const map, UINT32 const frames_per_view)
+{
+	try
+	{
+		LoadWorld(map);
+	}
+	catch (...)
+	{
+		SLOGW("Render benchmark: failed to load %s", map);
+		return;
+	}
+
+	std::string const path = GCM->getScreenshotFolder() + "/renderbench.csv";
+	FILE* const f = fopen(path.c_str(), "w");
+	if (!f) SLOGW("Failed to write the render benchmark %s", path.c_str());
+	if (f) fputs("pass,kind,stop,frames,frame_ms,render_world_ms,static_ms,dynamic_ms,marked_ms,overlays_ms\n", f);
+
+	std::vector<GridNo> const stops = CameraPath();
+	for (UINT pass = 0; pass != 2; ++pass)
+	{
+		bool        const cold      = pass == 0;
+		char const* const pass_name = cold ? "cold" : "cached";
+		RenderBenchResult full_total   = RenderBenchResult();
+		RenderBenchResult marked_total = RenderBenchResult();
+		InvalidateStaticWorldCache();
+		for (GridNo const g : stops)
+		{
+			INT16 x;
+			INT16 y;
+			ConvertGridNoToCenterCellXY(g, &x, &y);
+			SetRenderCenter(x, y);
+
+			RenderBenchResult full = RenderBenchResult();
+			for (UINT32 i = 0; i != frames_per_view; ++i)
+			{
+				if (cold) InvalidateStaticWorldCache();
+				InvalidateWorldRedundency();
+				SetRenderFlags(RENDER_FLAG_FULL);
+				RenderFrame(full);
+			}
+
+			RenderBenchResult marked = RenderBenchResult();
+			for (UINT32 i = 0; i != frames_per_view; ++i)
+			{
+				MarkTilesAround(g);
+				RenderFrame(marked);
+			}
+
+			char stop[16];
+			sprintf(stop, "%d", g);
+			WriteResult(f, pass_name, "full",   stop, full);
+			WriteResult(f, pass_name, "marked", stop, marked);
+			AddResult(full_total,   full);
+			AddResult(marked_total, marked);
+		}
+
+		LogResult(pass_name, "full",   full_total);
+		LogResult(pass_name, "marked", marked_total);
+		WriteResult(f, pass_name, "full",   "total", full_total);
+		WriteResult(f, pass_name, "marked", "total", marked_total);
+	}
+	if (f) fclose(f);
+
+	TrashWorld();
+}
@@ -0,0 +1,18 @@
+#ifndef RENDER_BENCHMARK_H
+#define RENDER_BENCHMARK_H
+
+#include "Types.h"
+
+
+/* Loads the given map and moves the camera over it on a fixed path. At every
+ * stop the world is redrawn completely frames_per_view times and then as many
+ * times with only a few tiles marked dirty. The whole path is run twice, first
+ * with the static world cache dropped before every frame, then with the cache
+ * kept. The time of RenderWorld(), its static, dynamic and marked parts and of
+ * the video overlays are logged and written to renderbench.csv in the
+ * screenshot folder, per stop and in total, for tracking them across builds.
+ * The world is trashed afterwards, so this is only to be run while no sector is
+ * loaded, i.e. from the main menu. */
+void BenchmarkTacticalRendering(char const* map, UINT32 frames_per_view);
+
+#endif
@@ -2,6 +2,7 @@
 
 #include "Font.h"
 #include "Local.h"
+#include "Profiler.h"
 #include "WorldDef.h"
 #include "RenderWorld.h"
 #include "VSurface.h"
@@ -100,6 +101,63 @@ void ExecuteBaseDirtyRectQueue(void)
 }
 
 
+/* Save areas are recycled in size classes of powers of two, as the same
+ * tooltips, cursor texts and labels come and go every few frames. */
+#define SAVE_AREA_MIN_BITS   6 // 64 pixels
+#define SAVE_AREA_CLASSES   14 // up to 512K pixels
+#define SAVE_AREA_POOL_DEPTH 8 // spare buffers kept per class
+
+static std::vector<UINT16*> g_save_area_pool[SAVE_AREA_CLASSES];
+
+
+static INT32 GetSaveAreaClass(UINT32 const n_pixels)
+{
+	for (INT32 c = 0; c < SAVE_AREA_CLASSES; ++c)
+	{
+		if (n_pixels <= 1U << (SAVE_AREA_MIN_BITS + c)) return c;
+	}
+	return -1;
+}
+
+
+static UINT16* AllocSaveArea(UINT32 const n_pixels)
+{
+	INT32 const c = GetSaveAreaClass(n_pixels);
+	if (c < 0) return MALLOCN(UINT16, n_pixels);
+
+	std::vector<UINT16*>& pool = g_save_area_pool[c];
+	if (pool.empty()) return MALLOCN(UINT16, 1U << (SAVE_AREA_MIN_BITS + c));
+
+	UINT16* const buf = pool.back();
+	pool.pop_back();
+	return buf;
+}
+
+
+static void FreeSaveArea(UINT16* const buf, UINT32 const n_pixels)
+{
+	if (!buf) return;
+
+	INT32 const c = GetSaveAreaClass(n_pixels);
+	if (c < 0 || g_save_area_pool[c].size() >= SAVE_AREA_POOL_DEPTH)
+	{
+		MemFree(buf);
+		return;
+	}
+	g_save_area_pool[c].push_back(buf);
+}
+
+
+static void FreeSaveAreas(BACKGROUND_SAVE* const b)
+{
+	UINT32 const n_pixels = b->sWidth * b->sHeight;
+	FreeSaveArea(b->pSaveArea,  n_pixels);
+	FreeSaveArea(b->pZSaveArea, n_pixels);
+	b->pSaveArea  = NULL;
+	b->pZSaveArea = NULL;
+}
+
+
 static BACKGROUND_SAVE* GetFreeBackgroundBuffer(void)
 {
 	for (UINT32 i = 0; i < guiNumBackSaves; ++i)
@@ -153,13 +211,15 @@ BACKGROUND_SAVE* RegisterBackgroundRect(BackgroundFlags const uiFlags, INT16 sLe
 	sBottom -= uiBottomSkip;
 
 	BACKGROUND_SAVE* const b = GetFreeBackgroundBuffer();
+	// A rect which was freed before it was ever saved still holds its areas
+	if (b->fFreeMemory) FreeSaveAreas(b);
 	*b = BACKGROUND_SAVE{};
 
 	const UINT32 uiBufSize = (sRight - sLeft) * (sBottom - sTop);
 	if (uiBufSize == 0) return NO_BGND_RECT;
 
-	if (uiFlags & BGND_FLAG_SAVERECT) b->pSaveArea  = MALLOCN(UINT16, uiBufSize);
-	if (uiFlags & BGND_FLAG_SAVE_Z)   b->pZSaveArea = MALLOCN(UINT16, uiBufSize);
+	if (uiFlags & BGND_FLAG_SAVERECT) b->pSaveArea  = AllocSaveArea(uiBufSize);
+	if (uiFlags & BGND_FLAG_SAVE_Z)   b->pZSaveArea = AllocSaveArea(uiBufSize);
 
 	b->fFreeMemory = TRUE;
 	b->fAllocated  = TRUE;
@@ -186,6 +246,27 @@ void RegisterBackgroundRectSingleFilled(INT16 const x, INT16 const y, INT16 cons
 }
 
 
+/* Whether a later background, which is also restored from the save buffer,
+ * contains the background completely. Overlays often overlap each other, for
+ * example the names of mercs standing together. */
+static bool IsCoveredByLaterRect(UINT32 const idx)
+{
+	const BACKGROUND_SAVE* const b = gBackSaves[idx];
+	for (UINT32 i = idx + 1; i < guiNumBackSaves; ++i)
+	{
+		const BACKGROUND_SAVE* const o = gBackSaves[i];
+		if (!o->fFilled || o->fDisabled) continue;
+		if (o->pSaveArea != NULL || o->pZSaveArea != NULL) continue;
+		if (o->sLeft <= b->sLeft && b->sRight  <= o->sRight &&
+				o->sTop  <= b->sTop  && b->sBottom <= o->sBottom)
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+
 void RestoreBackgroundRects(void)
 {
 	{ SGPVSurface::Lock lsrc(guiSAVEBUFFER);
@@ -200,6 +281,11 @@ void RestoreBackgroundRects(void)
 			const BACKGROUND_SAVE* const b = gBackSaves[i];
 			if (!b->fFilled || b->fDisabled) continue;
 
+			if (b->pSaveArea == NULL && b->pZSaveArea == NULL && IsCoveredByLaterRect(i))
+			{ // Restored from the save buffer anyway, which overwrites whatever is drawn in between
+				continue;
+			}
+
 			if (b->pSaveArea != NULL)
 			{
 				Blt16BPPTo16BPP(pDestBuf, uiDestPitchBYTES, b->pSaveArea, b->sWidth * 2, b->sLeft, b->sTop, 0, 0, b->sWidth, b->sHeight);
@@ -232,23 +318,17 @@ void EmptyBackgroundRects(void)
 
 			if (!b->fAllocated && b->fFreeMemory)
 			{
-				if (b->pSaveArea  != NULL) MemFree(b->pSaveArea);
-				if (b->pZSaveArea != NULL) MemFree(b->pZSaveArea);
+				FreeSaveAreas(b);
 
 				b->fAllocated  = FALSE;
 				b->fFreeMemory = FALSE;
 				b->fFilled     = FALSE;
-				b->pSaveArea   = NULL;
 			}
 		}
 
 		if (b->uiFlags & BGND_FLAG_SINGLE || b->fPendingDelete)
 		{
-			if (b->fFreeMemory)
-			{
-				if (b->pSaveArea != NULL)  MemFree(b->pSaveArea);
-				if (b->pZSaveArea != NULL) MemFree(b->pZSaveArea);
-			}
+			if (b->fFreeMemory) FreeSaveAreas(b);
 
 			b->fAllocated     = FALSE;
 			b->fFreeMemory    = FALSE;
@@ -308,11 +388,7 @@ void FreeBackgroundRectPending(BACKGROUND_SAVE* const b)
 
 static void FreeBackgroundRectNow(BACKGROUND_SAVE* const b)
 {
-	if (b->fFreeMemory)
-	{
-		if (b->pSaveArea)  MemFree(b->pSaveArea);
-		if (b->pZSaveArea) MemFree(b->pZSaveArea);
-	}
+	if (b->fFreeMemory) FreeSaveAreas(b);
 
 	b->fAllocated  = FALSE;
 	b->fFreeMemory = FALSE;
@@ -354,6 +430,12 @@ void ShutdownBackgroundRects(void)
 		BACKGROUND_SAVE* const b = gBackSaves[i];
 		if (b->fAllocated) FreeBackgroundRectNow(b);
 	}
+
+	for (std::vector<UINT16*>& pool : g_save_area_pool)
+	{
+		for (UINT16* const buf : pool) MemFree(buf);
+		pool.clear();
+	}
 }
 
 
@@ -508,6 +590,8 @@ void RemoveVideoOverlay(VIDEO_OVERLAY* const v)
 // FUnctions for entrie array of blitters
 void ExecuteVideoOverlays(void)
 {
+	PROFILE_SCOPE(PROFILE_VIDEO_OVERLAYS);
+
 	FOR_EACH_VIDEO_OVERLAY(v)
 	{
 		// If we are scrolling but haven't saved yet, don't!
@@ -680,6 +764,9 @@ void SetVideoOverlayPos(VIDEO_OVERLAY* const v, const INT16 X, const INT16 Y)
 	// If position has changed and there is text, adjust
 	if (v->zText[0] != L'\0')
 	{
+		// The scroll messages are repositioned every frame, mostly to where they are
+		if (X == v->sX && Y == v->sY && v->background && !v->background->fPendingDelete) return;
+
 		UINT16 uiStringLength = StringPixLength(v->zText, v->uiFontID);
 		UINT16 uiStringHeight = GetFontHeight(v->uiFontID);
 
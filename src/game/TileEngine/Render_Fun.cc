@@ -61,10 +61,11 @@ void SetRecalculateWireFrameFlagRadius(const GridNo pos, const INT16 sRadius)
 	const INT16 pos_y = pos_y_;
 	for (INT16 y = pos_y - sRadius; y < pos_y + sRadius + 2; ++y)
 	{
+		if (y < 0 || WORLD_ROWS <= y) continue;
 		for (INT16 x = pos_x - sRadius; x < pos_x + sRadius + 2; ++x)
 		{
-			const UINT32 uiTile = MAPROWCOLTOPOS(y, x);
-			gpWorldLevelData[uiTile].uiFlags |= MAPELEMENT_RECALCULATE_WIREFRAMES;
+			if (x < 0 || WORLD_COLS <= x) continue;
+			MarkWireFrameTileDirty(MAPROWCOLTOPOS(y, x));
 		}
 	}
 }
@@ -93,7 +94,7 @@ void SetGridNoRevealedFlag(UINT16 const grid_no)
 	}
 
 	// Set gridno as revealed
-	gpWorldLevelData[grid_no].uiFlags |= MAPELEMENT_REVEALED;
+	SetTileRevealed(grid_no);
 	if (gfCaves) RemoveFogFromGridNo(grid_no);
 
 	// ATE: If there are any structs here, we can render them with the obscured flag!
@@ -43,7 +43,7 @@ static void SaveModifiedMapStructToMapTempFile(MODIFY_MAP const* const pMap, INT
 
 	GetMapTempFileName( SF_MAP_MODIFICATIONS_TEMP_FILE_EXISTS, zMapName, sSectorX, sSectorY, bSectorZ );
 
-	AutoSGPFile hFile(FileMan::openForAppend(zMapName));
+	AutoSGPFile hFile(GCM->openTempFileForAppend(zMapName));
 	FileWrite(hFile, pMap, sizeof(MODIFY_MAP));
 
 	SetSectorFlag( sSectorX, sSectorY, bSectorZ, SF_MAP_MODIFICATIONS_TEMP_FILE_EXISTS );
@@ -68,12 +68,12 @@ void LoadAllMapChangesFromMapTempFileAndApplyThem()
 	GetMapTempFileName( SF_MAP_MODIFICATIONS_TEMP_FILE_EXISTS, zMapName, gWorldSectorX, gWorldSectorY, gbWorldSectorZ );
 
 	//If the file doesnt exists, its no problem.
-	if (!GCM->doesGameResExists(zMapName)) return;
+	if (!GCM->doesTempFileExist(zMapName)) return;
 
 	UINT32                  uiNumberOfElements;
 	SGP::Buffer<MODIFY_MAP> pTempArrayOfMaps;
 	{
-		AutoSGPFile hFile(GCM->openGameResForReading(zMapName));
+		AutoSGPFile hFile(GCM->openTempFileForReading(zMapName));
 
 		//Get the size of the file
 		uiNumberOfElements = FileGetSize(hFile) / sizeof(MODIFY_MAP);
@@ -84,7 +84,7 @@ void LoadAllMapChangesFromMapTempFileAndApplyThem()
 	}
 
 	//Delete the file
-	FileDelete( zMapName );
+	GCM->deleteTempFile(zMapName);
 
 	for( cnt=0; cnt< uiNumberOfElements; cnt++ )
 	{
@@ -289,7 +289,6 @@ static void RemoveSavedStructFromMap(UINT32 uiMapIndex, UINT16 usIndex)
 
 
 static void AddOpenableStructStatusToMapTempFile(UINT32 uiMapIndex, BOOLEAN fOpened);
-static void SetSectorsRevealedBit(UINT16 usMapIndex);
 
 
 void SaveBloodSmellAndRevealedStatesFromMapToTempFile()
@@ -298,7 +297,14 @@ void SaveBloodSmellAndRevealedStatesFromMapToTempFile()
 	UINT16	cnt;
 	STRUCTURE * pStructure;
 
+	// The file keeps the tiles in the order of the bitset, a byte at a time
 	gpRevealedMap = MALLOCNZ(UINT8, NUM_REVEALED_BYTES);
+	for (UINT i = 0; i != REVEALED_TILE_WORDS; ++i)
+	{
+		UINT32 const w = guiRevealedTiles[i];
+		if (w == 0) continue;
+		for (UINT b = 0; b != 4; ++b) gpRevealedMap[i * 4 + b] = (UINT8)(w >> (b * 8));
+	}
 
 	//Loop though all the map elements
 	for ( cnt = 0; cnt < WORLD_MAX; cnt++ )
@@ -323,12 +329,6 @@ void SaveBloodSmellAndRevealedStatesFromMapToTempFile()
 		}
 
 
-		//if the element has been revealed
-		if( gpWorldLevelData[cnt].uiFlags & MAPELEMENT_REVEALED )
-		{
-			SetSectorsRevealedBit( cnt );
-		}
-
 		//if there is a structure that is damaged
 		if( gpWorldLevelData[cnt].uiFlags & MAPELEMENT_STRUCTURE_DAMAGED )
 		{
@@ -384,7 +384,7 @@ void SaveBloodSmellAndRevealedStatesFromMapToTempFile()
 // The BloodInfo is saved in the bottom byte and the smell info in the upper byte
 static void AddBloodOrSmellFromMapTempFileToMap(MODIFY_MAP* pMap)
 {
-	gpWorldLevelData[ pMap->usGridNo ].ubBloodInfo = (UINT8)pMap->usImageType;
+	SetSmellAndBlood(pMap->usGridNo, (UINT8)pMap->usSubImageIndex, (UINT8)pMap->usImageType);
 
 	//if the blood and gore option IS set, add blood
 	if( gGameSettings.fOptions[ TOPTION_BLOOD_N_GORE ] )
@@ -395,8 +395,6 @@ static void AddBloodOrSmellFromMapTempFileToMap(MODIFY_MAP* pMap)
 		gpWorldLevelData[ pMap->usGridNo ].uiFlags |= MAPELEMENT_REEVALUATEBLOOD;
 		UpdateBloodGraphics( pMap->usGridNo, 1 );
 	}
-
-	gpWorldLevelData[ pMap->usGridNo ].ubSmellInfo = (UINT8)pMap->usSubImageIndex;
 }
 
 
@@ -408,7 +406,7 @@ void SaveRevealedStatusArrayToRevealedTempFile(INT16 const sSectorX, INT16 const
 
 	GetMapTempFileName( SF_REVEALED_STATUS_TEMP_FILE_EXISTS, zMapName, sSectorX, sSectorY, bSectorZ );
 
-	AutoSGPFile hFile(FileMan::openForWriting(zMapName));
+	AutoSGPFile hFile(GCM->openTempFileForWriting(zMapName, true));
 
 	//Write the revealed array to the Revealed temp file
 	FileWrite(hFile, gpRevealedMap, NUM_REVEALED_BYTES);
@@ -430,10 +428,10 @@ void LoadRevealedStatusArrayFromRevealedTempFile()
 	GetMapTempFileName( SF_REVEALED_STATUS_TEMP_FILE_EXISTS, zMapName, gWorldSectorX, gWorldSectorY, gbWorldSectorZ );
 
 	//If the file doesnt exists, its no problem.
-	if (!GCM->doesGameResExists(zMapName)) return;
+	if (!GCM->doesTempFileExist(zMapName)) return;
 
 	{
-		AutoSGPFile hFile(GCM->openGameResForReading(zMapName));
+		AutoSGPFile hFile(GCM->openTempFileForReading(zMapName));
 
 		Assert( gpRevealedMap == NULL );
 		gpRevealedMap = MALLOCNZ(UINT8, NUM_REVEALED_BYTES);
@@ -450,18 +448,6 @@ void LoadRevealedStatusArrayFromRevealedTempFile()
 }
 
 
-static void SetSectorsRevealedBit(UINT16 usMapIndex)
-{
-	UINT16	usByteNumber;
-	UINT8		ubBitNumber;
-
-	usByteNumber = usMapIndex / 8;
-	ubBitNumber  = usMapIndex % 8;
-
-	gpRevealedMap[ usByteNumber ] |= 1 << ubBitNumber;
-}
-
-
 static void SetMapRevealedStatus(void)
 {
 	UINT16	usByteCnt;
@@ -482,12 +468,12 @@ static void SetMapRevealedStatus(void)
 
 			if( gpRevealedMap[ usByteCnt ] & ( 1 << ubBitCnt ) )
 			{
-				gpWorldLevelData[ usMapIndex ].uiFlags |= MAPELEMENT_REVEALED;
+				SetTileRevealed(usMapIndex);
 				SetGridNoRevealedFlag( usMapIndex );
 			}
 			else
 			{
-				gpWorldLevelData[ usMapIndex ].uiFlags &= (~MAPELEMENT_REVEALED );
+				ClearTileRevealed(usMapIndex);
 			}
 		}
 	}
@@ -617,7 +603,7 @@ try
 	UINT32                  uiNumberOfElements;
 	SGP::Buffer<MODIFY_MAP> pTempArrayOfMaps;
 	{
-		AutoSGPFile hFile(GCM->openGameResForReading(zMapName));
+		AutoSGPFile hFile(GCM->openTempFileForReading(zMapName));
 
 		//Get the number of elements in the file
 		uiNumberOfElements = FileGetSize(hFile) / sizeof(MODIFY_MAP);
@@ -628,7 +614,7 @@ try
 	}
 
 	//Delete the file
-	FileDelete( zMapName );
+	GCM->deleteTempFile(zMapName);
 
 	//Get the image type and subindex
 	const UINT32 uiType     = GetTileType(usIndex);
@@ -748,13 +734,13 @@ void ChangeStatusOfOpenableStructInUnloadedSector(UINT16 const usSectorX, UINT16
 	GetMapTempFileName(SF_MAP_MODIFICATIONS_TEMP_FILE_EXISTS, map_name, usSectorX, usSectorY, bSectorZ);
 
 	// If the file doesn't exists, it's no problem.
-	if (!GCM->doesGameResExists(map_name)) return;
+	if (!GCM->doesTempFileExist(map_name)) return;
 
 	UINT32                  uiNumberOfElements;
 	SGP::Buffer<MODIFY_MAP> mm;
 	{
 		// Read the map temp file into a buffer
-		AutoSGPFile src(GCM->openGameResForReading(map_name));
+		AutoSGPFile src(GCM->openTempFileForReading(map_name));
 
 		uiNumberOfElements = FileGetSize(src) / sizeof(MODIFY_MAP);
 
@@ -773,6 +759,6 @@ void ChangeStatusOfOpenableStructInUnloadedSector(UINT16 const usSectorX, UINT16
 		break;
 	}
 
-	AutoSGPFile dst(FileMan::openForWriting(map_name));
+	AutoSGPFile dst(GCM->openTempFileForWriting(map_name, true));
 	FileWrite(dst, mm, sizeof(*mm) * uiNumberOfElements);
 }
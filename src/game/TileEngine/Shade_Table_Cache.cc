@@ -0,0 +1,141 @@
+#include "Shade_Table_Cache.h"
+
+#include "ContentManager.h"
+#include "FileMan.h"
+#include "GameInstance.h"
+#include "Logger.h"
+#include "MemMan.h"
+#include "HImage.h"
+
+#include <stdexcept>
+#include <string.h>
+#include <unordered_map>
+
+
+#define SHADE_TABLE_CACHE_FILE    "ShadeTables.cache"
+#define SHADE_TABLE_CACHE_VERSION 1
+#define SHADE_TABLE_CACHE_MAX     2048 // entries, 8 kB each
+
+
+struct ShadeTableSet
+{
+	UINT16 table[SHADE_TABLE_CACHE_TABLES][256];
+};
+
+/* The file starts with this header, followed by the entries as the key and the
+ * tables. The tables depend on the pixel format of the screen, so they are
+ * only valid for the same colour masks. */
+struct ShadeTableCacheHeader
+{
+	char   id[4];
+	UINT32 version;
+	UINT16 red_mask;
+	UINT16 green_mask;
+	UINT16 blue_mask;
+	UINT16 padding;
+	UINT32 n_entries;
+};
+
+static std::unordered_map<uint64_t, ShadeTableSet> g_shade_tables;
+static bool                                        g_shade_tables_changed;
+
+
+static ShadeTableCacheHeader CurrentHeader(UINT32 const n_entries)
+{
+	ShadeTableCacheHeader const h =
+	{
+		{ 'S', 'H', 'T', 'C' },
+		SHADE_TABLE_CACHE_VERSION,
+		gusRedMask,
+		gusGreenMask,
+		gusBlueMask,
+		0,
+		n_entries
+	};
+	return h;
+}
+
+
+void LoadShadeTableCache()
+{
+	g_shade_tables.clear();
+	g_shade_tables_changed = false;
+	try
+	{
+		AutoSGPFile    f(GCM->openUserPrivateFileForReading(SHADE_TABLE_CACHE_FILE));
+		FileView const view(f);
+		FileViewReader r(view);
+
+		ShadeTableCacheHeader header;
+		r.Read(&header, sizeof(header));
+		ShadeTableCacheHeader const expected = CurrentHeader(header.n_entries);
+		if (memcmp(&header, &expected, sizeof(header)) != 0)
+		{
+			SLOGI("Ignoring the shade table cache, it was made for a different version or pixel format");
+			return;
+		}
+
+		for (UINT32 i = 0; i != header.n_entries && i != SHADE_TABLE_CACHE_MAX; ++i)
+		{
+			uint64_t key;
+			r.Read(&key, sizeof(key));
+			r.Read(&g_shade_tables[key], sizeof(ShadeTableSet));
+		}
+		SLOGD("Loaded %u shade table sets", (UINT32)g_shade_tables.size());
+	}
+	catch (const std::exception& e)
+	{
+		// A missing or truncated cache just means computing the tables again
+		SLOGD("No shade table cache loaded: %s", e.what());
+		g_shade_tables.clear();
+	}
+}
+
+
+void SaveShadeTableCache()
+{
+	if (!g_shade_tables_changed) return;
+	try
+	{
+		AutoSGPFile f(FileMan::openForWriting(SHADE_TABLE_CACHE_FILE));
+		ShadeTableCacheHeader const header = CurrentHeader((UINT32)g_shade_tables.size());
+		FileWrite(f, &header, sizeof(header));
+		for (std::unordered_map<uint64_t, ShadeTableSet>::const_iterator i = g_shade_tables.begin(); i != g_shade_tables.end(); ++i)
+		{
+			FileWrite(f, &i->first,  sizeof(i->first));
+			FileWrite(f, &i->second, sizeof(i->second));
+		}
+		g_shade_tables_changed = false;
+	}
+	catch (const std::exception& e)
+	{
+		SLOGW("Failed to write the shade table cache: %s", e.what());
+	}
+}
+
+
+bool GetCachedShadeTables(uint64_t const key, UINT16* tables[SHADE_TABLE_CACHE_TABLES])
+{
+	std::unordered_map<uint64_t, ShadeTableSet>::const_iterator const i = g_shade_tables.find(key);
+	if (i == g_shade_tables.end()) return false;
+
+	for (size_t t = 0; t != SHADE_TABLE_CACHE_TABLES; ++t)
+	{
+		tables[t] = MALLOCN(UINT16, 256);
+		memcpy(tables[t], i->second.table[t], sizeof(i->second.table[t]));
+	}
+	return true;
+}
+
+
+void AddCachedShadeTables(uint64_t const key, UINT16 const* const tables[SHADE_TABLE_CACHE_TABLES])
+{
+	if (g_shade_tables.size() >= SHADE_TABLE_CACHE_MAX) return;
+
+	ShadeTableSet& s = g_shade_tables[key];
+	for (size_t t = 0; t != SHADE_TABLE_CACHE_TABLES; ++t)
+	{
+		memcpy(s.table[t], tables[t], sizeof(s.table[t]));
+	}
+	g_shade_tables_changed = true;
+}
@@ -0,0 +1,23 @@
+#ifndef SHADE_TABLE_CACHE_H
+#define SHADE_TABLE_CACHE_H
+
+#include "Types.h"
+
+#include <stdint.h>
+
+
+#define SHADE_TABLE_CACHE_TABLES 16
+
+/* Keeps the shade tables made of a palette under their key, a hash of all
+ * they are computed from, so equal palettes under the same light are computed
+ * only once. The tables are kept in a file between runs. */
+void LoadShadeTableCache();
+void SaveShadeTableCache();
+
+/* If there are tables for the key, copies them into newly allocated tables
+ * and returns true. */
+bool GetCachedShadeTables(uint64_t key, UINT16* tables[SHADE_TABLE_CACHE_TABLES]);
+
+void AddCachedShadeTables(uint64_t key, UINT16 const* const tables[SHADE_TABLE_CACHE_TABLES]);
+
+#endif
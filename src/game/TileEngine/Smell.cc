@@ -13,6 +13,9 @@
 #include "Game_Clock.h"
 #include "Overhead.h"
 
+#include <algorithm>
+#include <vector>
+
 
 /*
  * Smell & Blood system
@@ -136,6 +139,50 @@
 }
 
 
+/* The tiles which may have smell or blood, so the decay only looks at these
+ * instead of the whole map. Tiles whose smell and blood are gone are dropped
+ * by the next decay. */
+static std::vector<GridNo> g_smell_tiles;
+static bool                g_smell_tile_listed[WORLD_MAX];
+
+
+static void ListSmellTile(GridNo const gridno)
+{
+	if (g_smell_tile_listed[gridno]) return;
+	g_smell_tile_listed[gridno] = true;
+	g_smell_tiles.push_back(gridno);
+}
+
+
+static void DropClearedSmellTiles()
+{
+	auto const cleared = [](GridNo const g)
+	{
+		MAP_ELEMENT const& me = gpWorldLevelData[g];
+		if (me.ubSmellInfo != 0 || me.ubBloodInfo != 0) return false;
+		g_smell_tile_listed[g] = false;
+		return true;
+	};
+	g_smell_tiles.erase(std::remove_if(g_smell_tiles.begin(), g_smell_tiles.end(), cleared), g_smell_tiles.end());
+}
+
+
+void ResetSmellTiles()
+{
+	g_smell_tiles.clear();
+	std::fill(std::begin(g_smell_tile_listed), std::end(g_smell_tile_listed), false);
+}
+
+
+void SetSmellAndBlood(GridNo const gridno, UINT8 const smell, UINT8 const blood)
+{
+	MAP_ELEMENT& me = gpWorldLevelData[gridno];
+	me.ubSmellInfo = smell;
+	me.ubBloodInfo = blood;
+	if (smell != 0 || blood != 0) ListSmellTile(gridno);
+}
+
+
 void RemoveBlood(GridNo const gridno, INT8 const level)
 {
 	MAP_ELEMENT& me = gpWorldLevelData[gridno];
@@ -147,21 +194,25 @@ void RemoveBlood(GridNo const gridno, INT8 const level)
 
 void DecaySmells()
 {
-	FOR_EACH_WORLD_TILE(i)
+	for (GridNo const g : g_smell_tiles)
 	{
-		UINT8& smell = i->ubSmellInfo;
+		UINT8& smell = gpWorldLevelData[g].ubSmellInfo;
 		if (smell == 0) continue;
 		DECAY_SMELL_STRENGTH(smell);
 		// If the strength left is 0, wipe the whole byte to clear the type
 		if (SMELL_STRENGTH(smell) == 0) smell = 0;
 	}
+	DropClearedSmellTiles();
 }
 
 
 static void DecayBlood(void)
 {
-	FOR_EACH_WORLD_TILE(pMapElement)
+	// In map order, as the tiles draw random decay times
+	std::sort(g_smell_tiles.begin(), g_smell_tiles.end());
+	for (GridNo const g : g_smell_tiles)
 	{
+		MAP_ELEMENT* const pMapElement = &gpWorldLevelData[g];
 		if (pMapElement->ubBloodInfo)
 		{
 			// delay blood timer!
@@ -212,6 +263,7 @@ static void DecayBlood(void)
 
 		// now go on to the next gridno
 	}
+	DropClearedSmellTiles();
 }
 
 void DecayBloodAndSmells( UINT32 uiTime )
@@ -331,6 +383,7 @@ void DropSmell(SOLDIERTYPE& s)
 			// the simple case, dropping a smell in a location where there is none
 			SET_SMELL( pMapElement->ubSmellInfo, ubStrength, ubSmell );
 		}
+		if (pMapElement->ubSmellInfo) ListSmellTile(s.sGridNo);
 	}
 	// otherwise skip dropping smell
 }
@@ -418,6 +471,7 @@ void InternalDropBlood(GridNo const gridno, INT8 const level, BloodKind const bl
 	}
 
 	me.uiFlags |= MAPELEMENT_REEVALUATEBLOOD;
+	ListSmellTile(gridno);
 
 	if (visible != -1) UpdateBloodGraphics(gridno, level);
 }
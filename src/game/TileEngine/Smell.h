@@ -26,3 +26,10 @@ void DropBlood(SOLDIERTYPE const&, UINT8 strength);
 void UpdateBloodGraphics(GridNo, INT8 level);
 void RemoveBlood(GridNo, INT8 level);
 void InternalDropBlood(GridNo, INT8 level, BloodKind, UINT8 strength, INT8 visible);
+
+/* Sets the smell and blood bytes of a tile as they were saved, so the tile
+ * decays again. */
+void SetSmellAndBlood(GridNo, UINT8 smell, UINT8 blood);
+
+/* Forgets the tiles with smell or blood, when the world is trashed. */
+void ResetSmellTiles();
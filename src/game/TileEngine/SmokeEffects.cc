@@ -34,6 +34,8 @@
 static SMOKEEFFECT gSmokeEffectData[NUM_SMOKE_EFFECT_SLOTS];
 static UINT32      guiNumSmokeEffects = 0;
 
+UINT32 guiSmokeEffectsVersion;
+
 
 #define BASE_FOR_EACH_SMOKE_EFFECT(type, iter)                    \
 	for (type* iter        = gSmokeEffectData,                      \
@@ -290,6 +292,7 @@ void AddSmokeEffectToTile(SMOKEEFFECT const* const smoke, SmokeEffectKind const
 	CreateAnimationTile(&ani_params);
 
 	gpWorldLevelData[sGridNo].ubExtFlags[bLevel] |= FromSmokeTypeToWorldFlags(bType);
+	++guiSmokeEffectsVersion;
 	SetRenderFlags(RENDER_FLAG_FULL);
 }
 
@@ -323,6 +326,7 @@ void RemoveSmokeEffectFromTile( INT16 sGridNo, INT8 bLevel )
 	if ( GetCachedAniTileOfType( sGridNo, ubLevelID, ANITILE_SMOKE_EFFECT ) == NULL )
 	{
 		gpWorldLevelData[ sGridNo ].ubExtFlags[ bLevel ] &= ( ~ANY_SMOKE_EFFECT );
+		++guiSmokeEffectsVersion;
 	}
 }
 
@@ -494,7 +498,7 @@ void SaveSmokeEffectsToMapTempFile(INT16 const sMapX, INT16 const sMapY, INT8 co
 	GetMapTempFileName( SF_SMOKE_EFFECTS_TEMP_FILE_EXISTS, zMapName, sMapX, sMapY, bMapZ );
 
 	//delete file the file.
-	FileDelete( zMapName );
+	GCM->deleteTempFile(zMapName);
 
 	//loop through and count the number of smoke effects
 	CFOR_EACH_SMOKE_EFFECT(s) ++uiNumSmokeEffects;
@@ -507,7 +511,7 @@ void SaveSmokeEffectsToMapTempFile(INT16 const sMapX, INT16 const sMapY, INT8 co
 		return;
 	}
 
-	AutoSGPFile hFile(FileMan::openForWriting(zMapName));
+	AutoSGPFile hFile(GCM->openTempFileForWriting(zMapName, true));
 
 	//Save the Number of Smoke Effects
 	FileWrite(hFile, &uiNumSmokeEffects, sizeof(UINT32));
@@ -528,7 +532,7 @@ void LoadSmokeEffectsFromMapTempFile(INT16 const sMapX, INT16 const sMapY, INT8
 
 	GetMapTempFileName( SF_SMOKE_EFFECTS_TEMP_FILE_EXISTS, zMapName, sMapX, sMapY, bMapZ );
 
-	AutoSGPFile hFile(GCM->openGameResForReading(zMapName));
+	AutoSGPFile hFile(GCM->openTempFileForReading(zMapName));
 
 	//Clear out the old list
 	ResetSmokeEffects();
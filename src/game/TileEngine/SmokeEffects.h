@@ -46,6 +46,9 @@ void AddSmokeEffectToTile(SMOKEEFFECT const*, SmokeEffectKind, INT16 sGridNo, IN
 
 void RemoveSmokeEffectFromTile( INT16 sGridNo, INT8 bLevel );
 
+// Incremented whenever smoke or gas is added to or removed from a tile
+extern UINT32 guiSmokeEffectsVersion;
+
 void NewSmokeEffect(INT16 sGridNo, UINT16 usItem, INT8 bLevel, SOLDIERTYPE* owner);
 
 
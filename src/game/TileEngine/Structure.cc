@@ -1,6 +1,8 @@
 #include <stdexcept>
+#include <vector>
 
 #include "Buffer.h"
+#include "Cover_Map.h"
 #include "HImage.h"
 #include "LoadSaveData.h"
 #include "Soldier_Control.h"
@@ -59,6 +61,11 @@ UINT8 AtHeight[PROFILE_Z_SIZE] = { 0x01, 0x02, 0x04, 0x08 };
 
 static UINT16 gusNextAvailableStructureID = FIRST_AVAILABLE_STRUCTURE_ID;
 
+UINT32 guiStructuresVersion;
+UINT32 guiOpaqueStructuresVersion;
+UINT32 guiFixedStructuresVersion;
+TILE_VOXELS gTileVoxels[WORLD_MAX];
+
 static STRUCTURE_FILE_REF* gpStructureFileRefs;
 
 
@@ -235,10 +242,11 @@ void FreeStructureFile(STRUCTURE_FILE_REF* const sfr)
 // Loads a structure file's data as a honking chunk o' memory
 static void LoadStructureData(char const* const filename, STRUCTURE_FILE_REF* const sfr, UINT32* const structure_data_size)
 {
-	AutoSGPFile f(GCM->openGameResForReading(filename));
+	AutoSGPFile    file(GCM->openGameResForReading(filename));
+	FileView const view(file);
+	FileViewReader f(view);
 
-	BYTE data[16];
-	FileRead(f, data, sizeof(data));
+	BYTE const* const data = f.Take(16);
 
 	char   id[4];
 	UINT16 n_structures;
@@ -255,7 +263,7 @@ static void LoadStructureData(char const* const filename, STRUCTURE_FILE_REF* co
 	EXTR_U8(  d, flags)
 	EXTR_SKIP(d, 3)
 	EXTR_U16( d, n_tile_locs_stored)
-	Assert(d == endof(data));
+	Assert(d == data + 16);
 
 	if (strncmp(id, STRUCTURE_FILE_ID, STRUCTURE_FILE_ID_LEN) != 0 ||
 			n_structures == 0)
@@ -269,12 +277,12 @@ static void LoadStructureData(char const* const filename, STRUCTURE_FILE_REF* co
 	if (flags & STRUCTURE_FILE_CONTAINS_AUXIMAGEDATA)
 	{
 		aux_data.Allocate(n_structures);
-		FileRead(f, aux_data, sizeof(*aux_data) * n_structures);
+		f.Read(aux_data, sizeof(*aux_data) * n_structures);
 
 		if (n_tile_locs_stored > 0)
 		{
 			tile_loc_data.Allocate(n_tile_locs_stored);
-			FileRead(f, tile_loc_data, sizeof(*tile_loc_data) * n_tile_locs_stored);
+			f.Read(tile_loc_data, sizeof(*tile_loc_data) * n_tile_locs_stored);
 		}
 	}
 
@@ -283,7 +291,7 @@ static void LoadStructureData(char const* const filename, STRUCTURE_FILE_REF* co
 	{
 		sfr->usNumberOfStructuresStored = n_structures_stored;
 		structure_data.Allocate(data_size);
-		FileRead(f, structure_data, data_size);
+		f.Read(structure_data, data_size);
 
 		*structure_data_size = data_size;
 	}
@@ -341,17 +349,36 @@ static void CreateFileStructureArrays(STRUCTURE_FILE_REF* const pFileRef, UINT32
 }
 
 
-STRUCTURE_FILE_REF* LoadStructureFile(char const* const filename)
+STRUCTURE_FILE_REF* ReadStructureFile(char const* const filename)
 { // NB should be passed in expected number of structures so we can check equality
 	SGP::AutoObj<STRUCTURE_FILE_REF, FreeStructureFileRef> sfr(MALLOCZ(STRUCTURE_FILE_REF));
 	UINT32 data_size = 0;
 	LoadStructureData(filename, sfr, &data_size);
 	if (sfr->pubStructureData) CreateFileStructureArrays(sfr, data_size);
+	return sfr.Release();
+}
+
+
+void AddStructureFile(STRUCTURE_FILE_REF* const sfr)
+{
 	// Add the file reference to the master list, at the head for convenience
 	if (gpStructureFileRefs) gpStructureFileRefs->pPrev = sfr;
 	sfr->pNext = gpStructureFileRefs;
 	gpStructureFileRefs = sfr;
-	return sfr.Release();
+}
+
+
+void FreeUnaddedStructureFile(STRUCTURE_FILE_REF* const sfr)
+{
+	FreeStructureFileRef(sfr);
+}
+
+
+STRUCTURE_FILE_REF* LoadStructureFile(char const* const filename)
+{
+	STRUCTURE_FILE_REF* const sfr = ReadStructureFile(filename);
+	AddStructureFile(sfr);
+	return sfr;
 }
 
 
@@ -619,6 +646,46 @@ BOOLEAN OkayToAddStructureToWorld(const INT16 sBaseGridNo, const INT8 bLevel, co
 }
 
 
+static void UpdateTileVoxels(MAP_ELEMENT const* const me)
+{
+	TILE_VOXELS& v = gTileVoxels[me - gpWorldLevelData];
+	v = TILE_VOXELS{};
+	for (STRUCTURE const* s = me->pStructureHead; s; s = s->pNext)
+	{
+		if (s->fFlags & STRUCTURE_ROOF) v.fRoof = true;
+
+		// only those on the ground and on the roof are looked at
+		UINT const level = s->sCubeOffset / PROFILE_Z_SIZE;
+		if (level >= 2 || !s->pShape) continue;
+
+		bool    const opaque = !(s->fFlags & STRUCTURE_TRANSPARENT);
+		PROFILE const& shape = *s->pShape;
+		for (UINT x = 0; x != PROFILE_X_SIZE; ++x)
+		{
+			for (UINT y = 0; y != PROFILE_Y_SIZE; ++y)
+			{
+				for (UINT z = 0; z != PROFILE_Z_SIZE; ++z)
+				{
+					if (!(shape[x][y] & AtHeight[z])) continue;
+					v.occupied[level][z] |= VOXEL_COLUMN(x, y);
+					if (opaque) v.opaque[level][z] |= VOXEL_COLUMN(x, y);
+				}
+			}
+		}
+	}
+}
+
+
+void StructuresOfTileReplaced(GridNo const grid_no)
+{
+	++guiStructuresVersion;
+	++guiOpaqueStructuresVersion;
+	++guiFixedStructuresVersion;
+	UpdateTileVoxels(&gpWorldLevelData[grid_no]);
+	CoverMapStructuresChanged(grid_no);
+}
+
+
 static void AddStructureToTile(MAP_ELEMENT* const me, STRUCTURE* const s, UINT16 const structure_id)
 { // Add a STRUCTURE to a MAP_ELEMENT (Add part of a structure to a location on the map)
 	STRUCTURE* const tail = me->pStructureTail;
@@ -627,6 +694,14 @@ static void AddStructureToTile(MAP_ELEMENT* const me, STRUCTURE* const s, UINT16
 	*(tail ? &tail->pNext : &me->pStructureHead) = s;
 	me->pStructureTail = s;
 	if (s->fFlags & STRUCTURE_OPENABLE) me->uiFlags |= MAPELEMENT_INTERACTIVETILE;
+	++guiStructuresVersion;
+	if (!(s->fFlags & STRUCTURE_TRANSPARENT)) ++guiOpaqueStructuresVersion;
+	if (!(s->fFlags & STRUCTURE_PERSON))
+	{
+		++guiFixedStructuresVersion;
+		CoverMapStructuresChanged(me - gpWorldLevelData);
+	}
+	UpdateTileVoxels(me);
 }
 
 
@@ -786,6 +861,14 @@ static void DeleteStructureFromTile(MAP_ELEMENT* const me, STRUCTURE* const s)
 
 	// only one allowed in a tile, so we are safe to do this
 	if (s->fFlags & STRUCTURE_OPENABLE) me->uiFlags &= ~MAPELEMENT_INTERACTIVETILE;
+	++guiStructuresVersion;
+	if (!(s->fFlags & STRUCTURE_TRANSPARENT)) ++guiOpaqueStructuresVersion;
+	if (!(s->fFlags & STRUCTURE_PERSON))
+	{
+		++guiFixedStructuresVersion;
+		CoverMapStructuresChanged(me - gpWorldLevelData);
+	}
+	UpdateTileVoxels(me);
 
 	MemFree(s);
 }
@@ -1454,9 +1537,19 @@ void DebugStructurePage1()
 }
 
 
-void AddZStripInfoToVObject(HVOBJECT const hVObject, STRUCTURE_FILE_REF const* const pStructureFileRef, BOOLEAN const fFromAnimation, INT16 sSTIStartIndex)
+struct ZStripCalc
+{
+	UINT32 index;       // subregion of the strips
+	UINT8  first_width;
+	UINT8  increasing;  // strips which step the Z value up, then stay, then step down
+	UINT8  stable;
+	UINT8  decreasing;
+};
+
+
+ZStripInfo** BuildZStripInfo(ETRLEObject const* const etrle, UINT16 const zcount, STRUCTURE_FILE_REF const* const pStructureFileRef, BOOLEAN const fFromAnimation, INT16 sSTIStartIndex)
 {
-	if (pStructureFileRef->usNumberOfStructuresStored == 0) return;
+	if (pStructureFileRef->usNumberOfStructuresStored == 0) return NULL;
 
 	BOOLEAN             fFound       = FALSE;
 	const DB_STRUCTURE* pDBStructure = NULL;
@@ -1486,10 +1579,7 @@ void AddZStripInfoToVObject(HVOBJECT const hVObject, STRUCTURE_FILE_REF const* c
 	}
 
 	// if no multi-tile images in this vobject, that's okay... return!
-	if (!fFound) return;
-
-	UINT         const zcount = hVObject->SubregionCount();
-	ZStripInfo** const zinfo  = MALLOCNZ(ZStripInfo*, zcount);
+	if (!fFound) return NULL;
 
 	INT16 sSTIStep;
 	if (fFromAnimation)
@@ -1511,13 +1601,13 @@ void AddZStripInfoToVObject(HVOBJECT const hVObject, STRUCTURE_FILE_REF const* c
 		sSTIStep = 1;
 	}
 
+	std::vector<ZStripCalc> strips;
 	INT16   sLeftHalfWidth;
 	INT16   sRightHalfWidth;
 	INT16   sStructIndex    = 0;
 	INT16   sNext           = sSTIStartIndex + sSTIStep;
 	BOOLEAN fFirstTime      = TRUE;
 	for (UINT32 uiLoop = sSTIStartIndex; uiLoop < zcount; ++uiLoop)
-	try
 	{
 		// Defualt to true
 		BOOLEAN fCopyIntoVo = TRUE;
@@ -1551,16 +1641,16 @@ void AddZStripInfoToVObject(HVOBJECT const hVObject, STRUCTURE_FILE_REF const* c
 				// ATE: We allow SLIDING DOORS of 2 tile sizes...
 				if (!(pDBStructure->fFlags & STRUCTURE_ANYDOOR) || pDBStructure->fFlags & STRUCTURE_SLIDINGDOOR)
 				{
-					ZStripInfo* const pCurr = MALLOC(ZStripInfo);
 					Assert(uiDestVoIndex < zcount);
-					zinfo[uiDestVoIndex] = pCurr;
+					ZStripCalc z = ZStripCalc();
+					z.index = uiDestVoIndex;
 
 					UINT8 ubNumIncreasing = 0;
 					UINT8 ubNumStable     = 0;
 					UINT8 ubNumDecreasing = 0;
 
 					// time to do our calculations!
-					ETRLEObject const& e        = hVObject->SubregionProperties(uiLoop);
+					ETRLEObject const& e        = etrle[uiLoop];
 					INT16              sOffsetX = e.sOffsetX;
 					INT16              sOffsetY = e.sOffsetY;
 					UINT16      const  usWidth  = e.usWidth;
@@ -1645,76 +1735,105 @@ void AddZStripInfoToVObject(HVOBJECT const hVObject, STRUCTURE_FILE_REF const* c
 					}
 					if (sLeftHalfWidth > 0)
 					{
-						pCurr->ubFirstZStripWidth = sLeftHalfWidth % (WORLD_TILE_X / 2);
-						if (pCurr->ubFirstZStripWidth == 0)
+						z.first_width = sLeftHalfWidth % (WORLD_TILE_X / 2);
+						if (z.first_width == 0)
 						{
 							ubNumIncreasing--;
-							pCurr->ubFirstZStripWidth = (WORLD_TILE_X / 2);
+							z.first_width = (WORLD_TILE_X / 2);
 						}
 					}
 					else // right side only; offset is at least 20 (= WORLD_TILE_X / 2)
 					{
 						if (sOffsetX > WORLD_TILE_X)
 						{
-							pCurr->ubFirstZStripWidth = (WORLD_TILE_X / 2) - (sOffsetX - WORLD_TILE_X) % (WORLD_TILE_X / 2);
+							z.first_width = (WORLD_TILE_X / 2) - (sOffsetX - WORLD_TILE_X) % (WORLD_TILE_X / 2);
 						}
 						else
 						{
-							pCurr->ubFirstZStripWidth = WORLD_TILE_X - sOffsetX;
+							z.first_width = WORLD_TILE_X - sOffsetX;
 						}
-						if (pCurr->ubFirstZStripWidth == 0)
+						if (z.first_width == 0)
 						{
 							ubNumDecreasing--;
-							pCurr->ubFirstZStripWidth = (WORLD_TILE_X / 2);
+							z.first_width = (WORLD_TILE_X / 2);
 						}
 					}
 
-					// now create the array!
-					pCurr->ubNumberOfZChanges = ubNumIncreasing + ubNumStable + ubNumDecreasing;
-					pCurr->pbZChange = MALLOCN(INT8, pCurr->ubNumberOfZChanges);
-
-					UINT8 ubLoop2;
-					for (ubLoop2 = 0; ubLoop2 < ubNumIncreasing; ubLoop2++)
-					{
-						pCurr->pbZChange[ubLoop2] = 1;
-					}
-					for (; ubLoop2 < ubNumIncreasing + ubNumStable; ubLoop2++)
-					{
-						pCurr->pbZChange[ubLoop2] = 0;
-					}
-					for (; ubLoop2 < pCurr->ubNumberOfZChanges; ubLoop2++)
-					{
-						pCurr->pbZChange[ubLoop2] = -1;
-					}
-					if (ubNumIncreasing > 0)
-					{
-						pCurr->bInitialZChange = -ubNumIncreasing;
-					}
-					else if (ubNumStable > 0)
-					{
-						pCurr->bInitialZChange = 0;
-					}
-					else
-					{
-						pCurr->bInitialZChange = -ubNumDecreasing;
-					}
+					z.increasing = ubNumIncreasing;
+					z.stable     = ubNumStable;
+					z.decreasing = ubNumDecreasing;
+					strips.push_back(z);
 				}
 			}
 		}
 	}
-	catch (...)
+
+	if (strips.empty()) return NULL;
+
+	/* Lay out the pointer table, the records and their Z changes and levels in
+	 * one block, so the blitters find them next to each other and the video
+	 * object frees them at once. */
+	UINT32 n_changes = 0;
+	for (std::vector<ZStripCalc>::const_iterator i = strips.begin(); i != strips.end(); ++i)
 	{
-		for (UINT ubLoop2 = 0; ubLoop2 < uiLoop; ++ubLoop2)
+		n_changes += (UINT8)(i->increasing + i->stable + i->decreasing);
+	}
+	size_t const table_size  = zcount        * sizeof(ZStripInfo*);
+	size_t const info_size   = strips.size() * sizeof(ZStripInfo);
+	size_t const levels_size = (n_changes + strips.size()) * sizeof(INT16);
+	UINT8* const block = MALLOCNZ(UINT8, table_size + info_size + levels_size + n_changes);
+
+	ZStripInfo** const zinfo   = reinterpret_cast<ZStripInfo**>(block);
+	ZStripInfo*        info    = reinterpret_cast<ZStripInfo*>(block + table_size);
+	INT16*             levels  = reinterpret_cast<INT16*>(block + table_size + info_size);
+	INT8*              changes = reinterpret_cast<INT8*>(block + table_size + info_size + levels_size);
+	for (std::vector<ZStripCalc>::const_iterator i = strips.begin(); i != strips.end(); ++i)
+	{
+		ZStripCalc const& z = *i;
+		UINT8 const n = z.increasing + z.stable + z.decreasing;
+
+		ZStripInfo& zi = *info++;
+		zi.ubFirstZStripWidth = z.first_width;
+		zi.ubNumberOfZChanges = n;
+		zi.pbZChange          = changes;
+		zi.psZLevel           = levels;
+		if (z.increasing > 0)
 		{
-			if (zinfo[ubLoop2] != NULL)
-			{
-				MemFree(zinfo[uiLoop]);
-			}
+			zi.bInitialZChange = -z.increasing;
 		}
-		MemFree(zinfo);
-		throw;
+		else if (z.stable > 0)
+		{
+			zi.bInitialZChange = 0;
+		}
+		else
+		{
+			zi.bInitialZChange = -z.decreasing;
+		}
+
+		INT16 level = 0;
+		for (UINT8 k = 0; k != n; ++k)
+		{
+			INT8 const d = k < z.increasing ? 1 : k < z.increasing + z.stable ? 0 : -1;
+			*levels++  = level;
+			*changes++ = d;
+			level     += d;
+		}
+		*levels++ = level;
+
+		// A later structure of an animation may reuse the subregion, the last one wins
+		zinfo[z.index] = &zi;
 	}
+	return zinfo;
+}
 
+
+void AddZStripInfoToVObject(HVOBJECT const hVObject, STRUCTURE_FILE_REF const* const pStructureFileRef, BOOLEAN const fFromAnimation, INT16 const sSTIStartIndex)
+{
+	UINT16 const zcount = hVObject->SubregionCount();
+	if (zcount == 0) return;
+	ZStripInfo** const zinfo = BuildZStripInfo(&hVObject->SubregionProperties(0), zcount, pStructureFileRef, fFromAnimation, sSTIStartIndex);
+	if (!zinfo) return;
+	if (hVObject->ppZStripInfo) MemFree(hVObject->ppZStripInfo);
 	hVObject->ppZStripInfo = zinfo;
 }
 
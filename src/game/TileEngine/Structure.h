@@ -6,6 +6,7 @@
 #include "Structure_Internals.h"
 #include "Overhead_Types.h"
 #include "Sound_Control.h"
+#include "WorldDef.h"
 
 #define NOTHING_BLOCKING			0
 #define BLOCKING_REDUCE_RANGE			1
@@ -36,6 +37,14 @@ STRUCTURE_FILE_REF* LoadStructureFile(const char* szFileName);
 void FreeAllStructureFiles( void );
 void FreeStructureFile(STRUCTURE_FILE_REF*);
 
+/* LoadStructureFile() in two steps. ReadStructureFile() only touches the data
+ * it returns, so it may run on a worker thread. AddStructureFile() then adds it
+ * to the structure database. A file which is not added is freed with
+ * FreeUnaddedStructureFile(). */
+STRUCTURE_FILE_REF* ReadStructureFile(char const* filename);
+void                AddStructureFile(STRUCTURE_FILE_REF*);
+void                FreeUnaddedStructureFile(STRUCTURE_FILE_REF*);
+
 //
 // functions at the structure instance level
 //
@@ -83,6 +92,44 @@ BOOLEAN FindAndSwapStructure( INT16 sGridNo );
 
 void DebugStructurePage1( void );
 
+/* Incremented whenever a structure is added to or removed from a tile, so
+ * anything derived from the structures in the world, e.g. cached paths, can
+ * tell whether it is stale. */
+extern UINT32 guiStructuresVersion;
+/* The same for the structures which are not transparent, i.e. the ones which
+ * can block a line of sight. */
+extern UINT32 guiOpaqueStructuresVersion;
+/* The same for the structures which are not people, which change far less
+ * often than soldiers step. */
+extern UINT32 guiFixedStructuresVersion;
+
+/* The voxels of a tile which its structures occupy, as in the structure
+ * profiles. Index 0 is for the structures on the ground and index 1 for those
+ * on the roof. There is a mask per height index with the bit VOXEL_COLUMN(x, y)
+ * for each voxel column. Bullets, thrown objects and the line of sight test
+ * look a voxel up here to skip the structures of a tile where nothing could be
+ * hit. */
+struct TILE_VOXELS
+{
+	UINT32 occupied[2][PROFILE_Z_SIZE]; // by any structure
+	UINT32 opaque[2][PROFILE_Z_SIZE];   // by structures which are not transparent
+	bool   fRoof;                       // the tile has a STRUCTURE_ROOF
+};
+
+#define VOXEL_COLUMN(x, y) (1U << ((x) * PROFILE_Y_SIZE + (y)))
+
+extern TILE_VOXELS gTileVoxels[WORLD_MAX];
+
+/* Updates the versions and the voxels after the structure list of the tile was
+ * replaced as a whole, e.g. by the editor's undo. */
+void StructuresOfTileReplaced(GridNo);
+
+/* Computes the Z strips of the subregions of an image for the structures of
+ * the file, as one block for SGPVObject::ppZStripInfo, or NULL if no subregion
+ * needs them. It only reads the subregion offsets and the structure file, so it
+ * may run on a worker thread while the image is decoded. */
+ZStripInfo** BuildZStripInfo(ETRLEObject const*, UINT16 n_subregions, STRUCTURE_FILE_REF const*, BOOLEAN fFromAnimation, INT16 sSTIStartIndex);
+
 void AddZStripInfoToVObject(HVOBJECT, STRUCTURE_FILE_REF const*, BOOLEAN fFromAnimation, INT16 sSTIStartIndex);
 
 // FUNCTIONS FOR DETERMINING STUFF THAT BLOCKS VIEW FOR TILE_bASED LOS
@@ -52,6 +52,8 @@ struct MERCPLACEMENT
 	MOUSE_REGION	region;
 	UINT8					ubStrategicInsertionCode;
 	BOOLEAN				fPlaced;
+	UINT8         ubLabelColour; // colour the name was last drawn in, 0 if the label has to be drawn again
+	BOOLEAN       fLabelPlaced;  // whether the label was last drawn without the question mark
 };
 
 static MERCPLACEMENT* gMercPlacement = 0;
@@ -189,6 +191,7 @@ void InitTacticalPlacementGUI()
 		m.pSoldier                 = s;
 		m.ubStrategicInsertionCode = s->ubStrategicInsertionCode;
 		m.fPlaced                  = FALSE;
+		m.ubLabelColour            = 0;
 		m.uiVObjectID              = Load65Portrait(GetProfile(m.pSoldier->ubProfile));
 		INT32 const x = STD_SCREEN_X +  91 + i / 2 * 54;
 		INT32 const y = STD_SCREEN_Y + 361 + i % 2 * 51;
@@ -265,7 +268,8 @@ static void RenderTacticalPlacementGUI()
 		MarkButtonsDirty();
 		for (INT32 i = 0; i != giPlacements; ++i)
 		{ // Render the mercs
-			MERCPLACEMENT const& m = gMercPlacement[i];
+			MERCPLACEMENT& m = gMercPlacement[i];
+			m.ubLabelColour = 0;
 			INT32         const  x = STD_SCREEN_X +  95 + i / 2 * 54;
 			INT32         const  y = STD_SCREEN_Y + 371 + i % 2 * 51;
 			ColorFillVideoSurfaceArea(buf, x + 36, y + 2, x + 44, y + 30, 0);
@@ -332,12 +336,17 @@ static void RenderTacticalPlacementGUI()
 		INT32 const x = STD_SCREEN_X +  95 + i / 2 * 54;
 		INT32 const y = STD_SCREEN_Y + 371 + i % 2 * 51;
 
-		MERCPLACEMENT const& m     = gMercPlacement[i];
+		MERCPLACEMENT&       m     = gMercPlacement[i];
 		SOLDIERTYPE   const& s     = *m.pSoldier;
 		UINT8         const colour =
 			(is_group ? s.ubGroupID == gubSelectedGroupID  : i == gbSelectedMercID)  ? FONT_YELLOW :
 			(is_group ? s.ubGroupID == gubHilightedGroupID : i == gbHilightedMercID) ? FONT_WHITE  :
 			FONT_GRAY3;
+		// The panel keeps the label until it is drawn anew
+		if (m.ubLabelColour == colour && m.fLabelPlaced == m.fPlaced) continue;
+		m.ubLabelColour = colour;
+		m.fLabelPlaced  = m.fPlaced;
+
 		SetFontAttributes(BLOCKFONT, colour);
 		INT32 const w  = StringPixLength(s.name, BLOCKFONT);
 		INT32 const nx = x + (48 - w) / 2;
@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <stdexcept>
 
 #include "HImage.h"
@@ -18,6 +19,7 @@ TILE_ELEMENT		gTileDatabase[ NUMBEROFTILES ];
 static UINT16 gTileDatabaseSize;
 UINT16					gusNumAnimatedTiles = 0;
 UINT16					gusAnimatedTiles[ MAX_ANIMATED_TILES ];
+TileImageExtent gTileImageExtent;
 
 
 
@@ -40,8 +42,21 @@ UINT8		gTileTypeMovementCost[ NUM_TERRAIN_TYPES ] =
 };
 
 
+static void AddToTileImageExtent(HVOBJECT const vo, UINT16 const region)
+{
+	ETRLEObject const& e   = vo->SubregionProperties(region);
+	TileImageExtent&   ext = gTileImageExtent;
+	ext.left   = std::min<INT16>(ext.left,   e.sOffsetX);
+	ext.top    = std::min<INT16>(ext.top,    e.sOffsetY);
+	ext.right  = std::max<INT16>(ext.right,  e.sOffsetX + e.usWidth);
+	ext.bottom = std::max<INT16>(ext.bottom, e.sOffsetY + e.usHeight);
+}
+
+
 void CreateTileDatabase()
 {
+	gTileImageExtent = TileImageExtent();
+
 	// Loop through all surfaces and tiles and build database
 	for (UINT32 cnt1 = 0; cnt1 < NUMBEROFTILETYPES; ++cnt1)
 	{
@@ -118,6 +133,7 @@ void CreateTileDatabase()
 			}
 
 			SetSpecificDatabaseValues(cnt1, gTileDatabaseSize, TileElement, TileSurf->bRaisedObjectType);
+			AddToTileImageExtent(TileElement.hTileSurface, TileElement.usRegionIndex);
 
 			gTileDatabase[gTileDatabaseSize++] = TileElement;
 		}
@@ -110,6 +110,17 @@ static inline const TILE_ELEMENT* TileElemFromTileType(const UINT16 tile_type)
 	return &gTileDatabase[gTileTypeStartIndex[tile_type]];
 }
 
+/* The box around the images of all tiles in the database, relative to the
+ * point they are placed from. */
+struct TileImageExtent
+{
+	INT16 left;
+	INT16 top;
+	INT16 right;
+	INT16 bottom;
+};
+extern TileImageExtent gTileImageExtent;
+
 extern UINT16 gusNumAnimatedTiles;
 extern UINT16 gusAnimatedTiles[MAX_ANIMATED_TILES];
 extern UINT8  gTileTypeMovementCost[NUM_TERRAIN_TYPES];
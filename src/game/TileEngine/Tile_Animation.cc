@@ -26,9 +26,54 @@
 #include "GameInstance.h"
 #include "Logger.h"
 
+#include <vector>
+
 static ANITILE* pAniTileHead = NULL;
 
 
+/* Animated tiles are taken from slabs and go on a free list when they are
+ * deleted, because explosions, bullets and smoke create and delete them by the
+ * dozen. */
+#define ANI_TILE_SLAB_SIZE 64 // tiles per slab
+
+static std::vector<ANITILE*> g_ani_tile_slabs;
+static size_t                g_ani_tile_slab_used = ANI_TILE_SLAB_SIZE; // tiles taken from the last slab
+static ANITILE*              g_free_ani_tiles; // linked through pNext
+
+/* The JA2 clock at which UpdateAniTiles() has something to do next, i.e. the
+ * first tile advances its frame or a slowly moving tile has to leave the
+ * dynamic layer. Until then the list is not walked at all. */
+static UINT32  guiAniTilesDue;
+static BOOLEAN gfAniTileCreated; // during the current update
+
+
+static ANITILE* AllocAniTile()
+{
+	ANITILE* a = g_free_ani_tiles;
+	if (a)
+	{
+		g_free_ani_tiles = a->pNext;
+	}
+	else
+	{
+		if (g_ani_tile_slab_used == ANI_TILE_SLAB_SIZE)
+		{
+			g_ani_tile_slabs.push_back(MALLOCN(ANITILE, ANI_TILE_SLAB_SIZE));
+			g_ani_tile_slab_used = 0;
+		}
+		a = &g_ani_tile_slabs.back()[g_ani_tile_slab_used++];
+	}
+	return a;
+}
+
+
+static void FreeAniTile(ANITILE* const a)
+{
+	a->pNext         = g_free_ani_tiles;
+	g_free_ani_tiles = a;
+}
+
+
 static UINT16 SetFrameByDir(UINT16 frame, const ANITILE* const a)
 {
 	if (a->uiFlags & ANITILE_USE_DIRECTION_FOR_START_FRAME)
@@ -49,7 +94,7 @@ static UINT16 SetFrameByDir(UINT16 frame, const ANITILE* const a)
 
 ANITILE* CreateAnimationTile(const ANITILE_PARAMS* const parms)
 {
-	ANITILE* const a = MALLOC(ANITILE);
+	ANITILE* const a = AllocAniTile();
 
 	INT32                cached_tile = -1;
 	INT16          const gridno      = parms->sGridNo;
@@ -143,6 +188,9 @@ ANITILE* CreateAnimationTile(const ANITILE_PARAMS* const parms)
 	a->sStartFrame      = start_frame;
 	a->pNext            = pAniTileHead;
 	pAniTileHead = a;
+	// The new tile may be due before every other one
+	guiAniTilesDue   = GetJA2Clock();
+	gfAniTileCreated = TRUE;
 	return a;
 }
 
@@ -240,7 +288,30 @@ void DeleteAniTile(ANITILE* const a)
 		}
 	}
 
-	MemFree(a);
+	FreeAniTile(a);
+}
+
+
+// Lowers uiNextDue to the clock at which the tile has something to do next
+static void NoteAniTileDue(ANITILE const* const a, UINT32 const uiClock, UINT32& uiNextDue)
+{
+	UINT32 uiDue = uiNextDue;
+	if (!(a->uiFlags & ANITILE_PAUSED) && a->sDelay >= 0)
+	{
+		uiDue = a->uiTimeLastUpdate + a->sDelay + 1;
+	}
+
+	if (a->uiFlags & ANITILE_OPTIMIZEFORSLOWMOVING)
+	{
+		// It leaves the dynamic layer as soon as it does not advance
+		if (!(a->uiFlags & ANITILE_ERASEITEMFROMSAVEBUFFFER) ||
+				(a->uiFlags & ANITILE_PAUSED && a->pLevelNode->uiFlags & LEVELNODE_DYNAMIC))
+		{
+			uiDue = uiClock;
+		}
+	}
+
+	if ((INT32)(uiDue - uiNextDue) < 0) uiNextDue = uiDue;
 }
 
 
@@ -250,10 +321,18 @@ void UpdateAniTiles( )
 	ANITILE *pNode				= NULL;
 	UINT32	uiClock				= GetJA2Clock( );
 
+	if ((INT32)(uiClock - guiAniTilesDue) < 0) return;
+
+	/* If the walk stops early, the tiles after the one it stopped at are due
+	 * again at the next update */
+	guiAniTilesDue   = uiClock;
+	gfAniTileCreated = FALSE;
+	UINT32 uiNextDue = uiClock + INT32_MAX;
+
 	// LOOP THROUGH EACH NODE
 	pAniNode = pAniTileHead;
 
-	while( pAniNode != NULL )
+	for (; pAniNode != NULL; NoteAniTileDue(pNode, uiClock, uiNextDue))
 	{
 		pNode = pAniNode;
 		pAniNode = pAniNode->pNext;
@@ -468,6 +547,8 @@ void UpdateAniTiles( )
 			}
 		}
 	}
+
+	if (!gfAniTileCreated) guiAniTilesDue = uiNextDue;
 }
 
 
@@ -1,4 +1,6 @@
+#include <map>
 #include <stdexcept>
+#include <string>
 
 #include "HImage.h"
 #include "PODObj.h"
@@ -16,6 +18,7 @@
 #include "FileMan.h"
 #include "MemMan.h"
 #include "Tile_Cache.h"
+#include "Lighting.h"
 
 #include "ContentManager.h"
 #include "GameInstance.h"
@@ -25,30 +28,84 @@
 TILE_IMAGERY				*gTileSurfaceArray[ NUMBEROFTILETYPES ];
 
 
-TILE_IMAGERY* LoadTileSurface(const char* cFilename)
+struct CachedTileSurface
+{
+	TILE_IMAGERY*   surface;
+	SGPPaletteEntry light;     // light colour of the shade tables
+	size_t          size;
+	UINT32          last_used;
+};
+
+typedef std::map<std::string, CachedTileSurface>   TileSurfaceCache;
+typedef std::map<TILE_IMAGERY const*, std::string> AcquiredTileSurfaces;
+
+static TileSurfaceCache     g_tile_surface_cache;
+static AcquiredTileSurfaces g_acquired_tile_surfaces; // file name of every surface handed out
+static size_t               g_tile_surface_cache_budget;
+static size_t               g_tile_surface_cache_size;
+static UINT32               g_tile_surface_cache_clock;
+
+
+TileSurfaceData::~TileSurfaceData()
+{
+	delete image;
+	if (structure) FreeUnaddedStructureFile(structure);
+	if (zstrips)   MemFree(zstrips);
+}
+
+
+void ReadTileSurface(char const* const filename, TileSurfaceData& data)
 try
 {
-	// Add tile surface
-	AutoSGPImage   hImage(CreateImage(cFilename, IMAGE_ALLDATA));
-	AutoSGPVObject hVObject(AddVideoObjectFromHImage(hImage));
+	data.image = CreateImage(filename, IMAGE_ALLDATA);
 
 	// Load structure data, if any.
 	// Start by hacking the image filename into that for the structure data
-	std::string cStructureFilename(FileMan::replaceExtension(cFilename, ".jsd"));
+	std::string const structure_filename(FileMan::replaceExtension(filename, ".jsd"));
+	if (GCM->doesGameResExists(structure_filename))
+	{
+		data.structure = ReadStructureFile(structure_filename.c_str());
+
+		// CreateTileSurface() rejects the files if the counts do not match
+		SGPImage const& img = *data.image;
+		if (img.usNumberOfObjects != 0 && img.usNumberOfObjects == data.structure->usNumberOfStructures)
+		{
+			data.zstrips = BuildZStripInfo(img.pETRLEObject, img.usNumberOfObjects, data.structure, FALSE, 0);
+		}
+	}
+}
+catch (const std::exception& e)
+{
+	data.error = e.what();
+}
+
+
+TILE_IMAGERY* CreateTileSurface(char const* const cFilename, TileSurfaceData& data)
+try
+{
+	if (!data.error.empty()) throw std::runtime_error(data.error);
+
+	// Add tile surface
+	AutoSGPImage   hImage(data.image);
+	data.image = 0;
+	AutoSGPVObject hVObject(AddVideoObjectFromHImage(hImage));
 
 	AutoStructureFileRef pStructureFileRef;
-	if (GCM->doesGameResExists( cStructureFilename ))
+	if (data.structure)
 	{
-		SLOGD("loading tile %s", cStructureFilename.c_str());
+		SLOGD("loading tile %s", cFilename);
 
-		pStructureFileRef = LoadStructureFile( cStructureFilename.c_str() );
+		AddStructureFile(data.structure);
+		pStructureFileRef = data.structure;
+		data.structure    = 0;
 
 		if (hVObject->SubregionCount() != pStructureFileRef->usNumberOfStructures)
 		{
 			throw std::runtime_error("Structure file error");
 		}
 
-		AddZStripInfoToVObject(hVObject, pStructureFileRef, FALSE, 0);
+		hVObject->ppZStripInfo = data.zstrips;
+		data.zstrips           = 0;
 	}
 
 	SGP::PODObj<TILE_IMAGERY> pTileSurf;
@@ -80,6 +137,14 @@ catch (...)
 }
 
 
+TILE_IMAGERY* LoadTileSurface(const char* cFilename)
+{
+	TileSurfaceData data;
+	ReadTileSurface(cFilename, data);
+	return CreateTileSurface(cFilename, data);
+}
+
+
 void DeleteTileSurface(TILE_IMAGERY* const pTileSurf)
 {
 	if ( pTileSurf->pStructureFileRef != NULL )
@@ -102,6 +167,113 @@ void DeleteTileSurface(TILE_IMAGERY* const pTileSurf)
 }
 
 
+/* Estimated memory used by a surface, which is dominated by the pixel data and
+ * the shade tables. */
+static size_t TileSurfaceSize(TILE_IMAGERY const* const t)
+{
+	SGPVObject const* const vo = t->vo;
+	size_t size = vo->PixDataSize() + vo->SubregionCount() * sizeof(ETRLEObject);
+	for (size_t i = 0; i != HVOBJECT_SHADE_TABLES; ++i)
+	{
+		if (vo->pShades[i]) size += 256 * sizeof(*vo->pShades[i]);
+	}
+	return size;
+}
+
+
+static void EvictTileSurfaces(size_t const budget)
+{
+	while (g_tile_surface_cache_size > budget)
+	{
+		TileSurfaceCache::iterator oldest = g_tile_surface_cache.begin();
+		for (TileSurfaceCache::iterator i = oldest; i != g_tile_surface_cache.end(); ++i)
+		{
+			if (i->second.last_used < oldest->second.last_used) oldest = i;
+		}
+		g_tile_surface_cache_size -= oldest->second.size;
+		DeleteTileSurface(oldest->second.surface);
+		g_tile_surface_cache.erase(oldest);
+	}
+}
+
+
+void SetTileSurfaceCacheBudget(size_t const bytes)
+{
+	g_tile_surface_cache_budget = bytes;
+	EvictTileSurfaces(bytes);
+}
+
+
+bool IsTileSurfaceCached(char const* const filename)
+{
+	return g_tile_surface_cache.count(filename) != 0;
+}
+
+
+TILE_IMAGERY* AcquireTileSurface(char const* const filename, bool* const shades_valid, TileSurfaceData* const data)
+{
+	TILE_IMAGERY* t;
+	TileSurfaceCache::iterator const i = g_tile_surface_cache.find(filename);
+	if (i != g_tile_surface_cache.end())
+	{
+		CachedTileSurface const& c     = i->second;
+		SGPPaletteEntry   const& light = *LightGetColor();
+		t             = c.surface;
+		*shades_valid =
+			t->vo->pShades[0] &&
+			c.light.r == light.r && c.light.g == light.g && c.light.b == light.b;
+		// Get rid of outdated shade tables now, so released surfaces only have valid ones
+		if (!*shades_valid) t->vo->DestroyPalettes();
+		g_tile_surface_cache_size -= c.size;
+		g_tile_surface_cache.erase(i);
+		SLOGD("Reusing cached tile surface %s", filename);
+	}
+	else
+	{
+		t             = data ? CreateTileSurface(filename, *data) : LoadTileSurface(filename);
+		*shades_valid = false;
+	}
+	g_acquired_tile_surfaces[t] = filename;
+	return t;
+}
+
+
+void ReleaseTileSurface(TILE_IMAGERY* const t)
+{
+	AcquiredTileSurfaces::iterator const i = g_acquired_tile_surfaces.find(t);
+	if (i == g_acquired_tile_surfaces.end())
+	{
+		DeleteTileSurface(t);
+		return;
+	}
+	std::string const filename(i->second);
+	g_acquired_tile_surfaces.erase(i);
+
+	size_t const size = TileSurfaceSize(t);
+	if (size > g_tile_surface_cache_budget || g_tile_surface_cache.count(filename) != 0)
+	{
+		DeleteTileSurface(t);
+		return;
+	}
+
+	/* If the surface has shade tables, they were built for the current light
+	 * colour, because changing it rebuilds all of them. */
+	CachedTileSurface& c = g_tile_surface_cache[filename];
+	c.surface   = t;
+	c.light     = *LightGetColor();
+	c.size      = size;
+	c.last_used = ++g_tile_surface_cache_clock;
+	g_tile_surface_cache_size += size;
+	EvictTileSurfaces(g_tile_surface_cache_budget);
+}
+
+
+void FlushTileSurfaceCache()
+{
+	EvictTileSurfaces(0);
+}
+
+
 void SetRaisedObjectFlag(char const* const filename, TILE_IMAGERY* const t)
 {
 	static char const RaisedObjectFiles[][9] =
@@ -1,16 +1,63 @@
 #ifndef _TILE_SURFACE_H
 #define _TILE_SURFACE_H
 
+#include "TileDat.h"
 #include "WorldDef.h"
 
+#include <string>
+
 
 extern TILE_IMAGERY* gTileSurfaceArray[NUMBEROFTILETYPES];
 
 
 TILE_IMAGERY* LoadTileSurface(const char* cFilename);
 
+/* The decoded files of a tile surface. Whatever is not used up by
+ * CreateTileSurface() is freed with it. */
+struct TileSurfaceData
+{
+	TileSurfaceData() : image(0), structure(0), zstrips(0) {}
+	~TileSurfaceData();
+
+	SGPImage*           image;
+	STRUCTURE_FILE_REF* structure;
+	ZStripInfo**        zstrips;
+	std::string         error; // set if decoding failed
+
+	private:
+		TileSurfaceData(TileSurfaceData const&);  /* no copy */
+		void operator =(TileSurfaceData const&); /* no assignment */
+};
+
+/* LoadTileSurface() in two steps. ReadTileSurface() decodes the image and the
+ * structure file and computes the Z strips of the image. It only touches data
+ * and does not throw, so it may run on a
+ * worker thread. CreateTileSurface() makes the surface of them on the main
+ * thread, and throws if decoding failed. */
+void          ReadTileSurface(char const* filename, TileSurfaceData&);
+TILE_IMAGERY* CreateTileSurface(char const* filename, TileSurfaceData&);
+
 void DeleteTileSurface(TILE_IMAGERY* pTileSurf);
 
 void SetRaisedObjectFlag(char const* filename, TILE_IMAGERY*);
 
+/* Tile surfaces of a tileset are taken from and given back to the tile surface
+ * cache. Surfaces which are given back are kept with their shade tables up to
+ * the memory budget, and handed out again when a later tileset uses the same
+ * file. The least recently used surfaces are deleted first. */
+void SetTileSurfaceCacheBudget(size_t bytes);
+
+bool IsTileSurfaceCached(char const* filename);
+
+/* Returns the surface of the file, from the cache, made of the decoded data if
+ * given, or freshly loaded. shades_valid is set if the surface still has shade
+ * tables for the current light colour. */
+TILE_IMAGERY* AcquireTileSurface(char const* filename, bool* shades_valid, TileSurfaceData* = 0);
+
+/* Gives a surface from AcquireTileSurface() back to the cache. */
+void ReleaseTileSurface(TILE_IMAGERY*);
+
+/* Deletes all surfaces in the cache. */
+void FlushTileSurfaceCache();
+
 #endif
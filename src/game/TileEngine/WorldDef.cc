@@ -1,5 +1,6 @@
 #include "Animation_Data.h"
 #include "Buffer.h"
+#include "Cover_Map.h"
 #include "Directories.h"
 #include "HImage.h"
 #include "LoadSaveBasicSoldierCreateStruct.h"
@@ -45,14 +46,20 @@
 #include "Structure_Wrap.h"
 #include "Scheduling.h"
 #include "EditorMapInfo.h"
+#include "Editor_Undo.h"
 #include "Game_Clock.h"
 #include "Buildings.h"
+#include "Compiled_Map_Cache.h"
 #include "StrategicMap.h"
 #include "Overhead_Map.h"
 #include "Meanwhile.h"
+#include "Smell.h"
 #include "SmokeEffects.h"
 #include "LightEffects.h"
 #include "MemMan.h"
+#include "Prefetch.h"
+#include "Profiler.h"
+#include "WorkerPool.h"
 #include "JAScreens.h"
 #include "GameState.h"
 #include "GameRes.h"
@@ -61,9 +68,12 @@
 #include "GameInstance.h"
 #include "Logger.h"
 
+#include <SDL.h>
+
 #include <algorithm>
 #include <iterator>
 #include <stdexcept>
+#include <vector>
 
 #define SET_MOVEMENTCOST( a, b, c, d )		( ( gubWorldMovementCosts[ a ][ b ][ c ] < d ) ? ( gubWorldMovementCosts[ a ][ b ][ c ] = d ) : 0 );
 #define FORCE_SET_MOVEMENTCOST( a, b, c, d )	( gubWorldMovementCosts[ a ][ b ][ c ] = d )
@@ -98,6 +108,9 @@ void SetAllNewTileSurfacesLoaded( BOOLEAN fNew )
 
 // Global Variables
 MAP_ELEMENT			*gpWorldLevelData;
+static std::vector<GridNo> g_wireframe_dirty; // tiles with MAPELEMENT_RECALCULATE_WIREFRAMES
+static bool                g_wireframes_all_dirty = true;
+UINT32          guiRevealedTiles[REVEALED_TILE_WORDS];
 UINT8						gubWorldMovementCosts[ WORLD_MAX ][MAXDIR][2];
 
 // set to nonzero (locs of base gridno of structure are good) to have it defined by structure code
@@ -189,6 +202,7 @@ static void DestroyTileSurfaces(void);
 void DeinitializeWorld( )
 {
 	TrashWorld();
+	FreeLevelNodeSlabs();
 
 	if ( gpWorldLevelData != NULL )
 	{
@@ -203,18 +217,39 @@ void DeinitializeWorld( )
 }
 
 
-static void AddTileSurface(char const* filename, UINT32 type, TileSetID);
+static void AddTileSurface(char const* filename, UINT32 type, TileSetID, TileSurfaceData*);
+
+
+struct TileSurfaceJob
+{
+	std::string     filename;
+	TileSetID       tileset;
+	bool            decode;   // false if the surface is taken from the cache
+	TileSurfaceData data;
+};
+
+
+static void DecodeTileSurface(UINT const i, void* const ctx)
+{
+	TileSurfaceJob& job = static_cast<TileSurfaceJob*>(ctx)[i];
+	if (job.decode) ReadTileSurface(job.filename.c_str(), job.data);
+}
 
 
+/* The image and structure files are independent of each other, so they are
+ * decoded on the worker pool first. The surfaces are then made of them in order
+ * on the main thread, as that touches the video object and structure lists. */
 static void LoadTileSurfaces(char const tile_surface_filenames[][32], TileSetID const tileset_id)
 try
 {
 	SetRelativeStartAndEndPercentage(0, 1, 35, L"Tile Surfaces");
+	RenderProgressBar(0, 0);
+
+	uint64_t const start = SDL_GetPerformanceCounter();
+	std::vector<TileSurfaceJob> jobs(NUMBEROFTILETYPES);
+	UINT n_decoded = 0;
 	for (UINT32 i = 0; i != NUMBEROFTILETYPES; ++i)
 	{
-		UINT32 const percentage = i * 100 / (NUMBEROFTILETYPES - 1);
-		RenderProgressBar(0, percentage);
-
 		char const* filename       = tile_surface_filenames[i];
 		TileSetID   tileset_to_add = tileset_id;
 		if (filename[0] == '\0')
@@ -228,9 +263,29 @@ try
 		}
 
 		// Adjust for tileset position
-		std::string adjusted_filename(GCM->getTilesetResourceName(tileset_to_add, filename));
-		AddTileSurface(adjusted_filename.c_str(), i, tileset_to_add);
+		TileSurfaceJob& job = jobs[i];
+		job.filename = GCM->getTilesetResourceName(tileset_to_add, filename);
+		job.tileset  = tileset_to_add;
+		job.decode   = !IsTileSurfaceCached(job.filename.c_str());
+		if (job.decode) ++n_decoded;
 	}
+
+	RunParallel(NUMBEROFTILETYPES, DecodeTileSurface, &jobs[0]);
+	double const decode_ms = MSSince(start);
+
+	uint64_t const commit_start = SDL_GetPerformanceCounter();
+	for (UINT32 i = 0; i != NUMBEROFTILETYPES; ++i)
+	{
+		UINT32 const percentage = i * 100 / (NUMBEROFTILETYPES - 1);
+		RenderProgressBar(0, percentage);
+
+		TileSurfaceJob& job = jobs[i];
+		if (job.filename.empty()) continue;
+		AddTileSurface(job.filename.c_str(), i, job.tileset, job.decode ? &job.data : 0);
+	}
+
+	SLOGD("Tileset %d: decoded %u tile surfaces in %.1f ms on %u threads, made the surfaces in %.1f ms",
+		tileset_id, n_decoded, decode_ms, WorkerPoolSize(), MSSince(commit_start));
 }
 catch (...)
 {
@@ -239,18 +294,19 @@ catch (...)
 }
 
 
-static void AddTileSurface(char const* const filename, UINT32 const type, TileSetID const tileset_id)
+static void AddTileSurface(char const* const filename, UINT32 const type, TileSetID const tileset_id, TileSurfaceData* const data)
 {
 	TILE_IMAGERY*& slot = gTileSurfaceArray[type];
 
-	// Delete the surface first!
+	// Give the surface back first, a later tileset may use it again
 	if (slot)
 	{
-		DeleteTileSurface(slot);
+		ReleaseTileSurface(slot);
 		slot = 0;
 	}
 
-	TILE_IMAGERY* const t = LoadTileSurface(filename);
+	bool                shades_valid;
+	TILE_IMAGERY* const t = AcquireTileSurface(filename, &shades_valid, data);
 	t->fType = type;
 	SetRaisedObjectFlag(filename, t);
 
@@ -259,7 +315,8 @@ static void AddTileSurface(char const* const filename, UINT32 const type, TileSe
 	// OK, if we are the default tileset, set value indicating that!
 	gbDefaultSurfaceUsed[type] = tileset_id == GENERIC_1;
 
-	gbNewTileSurfaceLoaded[type] = TRUE;
+	// A surface from the cache may still have its shade tables
+	gbNewTileSurfaceLoaded[type] = !shades_valid;
 }
 
 
@@ -275,6 +332,8 @@ void BuildTileShadeTables()
 		std::fill(std::begin(gbNewTileSurfaceLoaded), std::end(gbNewTileSurfaceLoaded), 1);
 	}
 
+	HVOBJECT objs[NUMBEROFTILETYPES];
+	UINT     n_objs = 0;
 	for (UINT32 i = 0; i != NUMBEROFTILETYPES; ++i)
 	{
 		TILE_IMAGERY const* const t = gTileSurfaceArray[i];
@@ -289,9 +348,13 @@ void BuildTileShadeTables()
 		{
 			if (!gbNewTileSurfaceLoaded[i]) continue;
 		}
-		RenderProgressBar(0, i * 100 / NUMBEROFTILETYPES);
-		CreateTilePaletteTables(t->vo);
+		objs[n_objs++] = t->vo;
 	}
+	RenderProgressBar(0, 0);
+	CreateTilePaletteTables(objs, n_objs);
+	RenderProgressBar(0, 100);
+
+	InvalidateStaticWorldCache();
 }
 
 
@@ -326,9 +389,10 @@ static void DestroyTileSurfaces(void)
 	FOR_EACH(TILE_IMAGERY*, i, gTileSurfaceArray)
 	{
 		if (!*i) continue;
-		DeleteTileSurface(*i);
+		ReleaseTileSurface(*i);
 		*i = 0;
 	}
+	FlushTileSurfaceCache();
 }
 
 
@@ -1063,92 +1127,123 @@ static void CompileTileMovementCosts(UINT16 usGridNo)
 	}
 }
 
-#define LOCAL_RADIUS 4
+/* Tiles of the pending movement cost recompilation. The costs of the tiles
+ * marked to be wiped are cleared first, then the tiles marked to be compiled
+ * are compiled. A tile is compiled once, however many recompilations of a
+ * batch cover it. */
+#define COSTS_WIPE    0x01
+#define COSTS_COMPILE 0x02
 
-void RecompileLocalMovementCosts( INT16 sCentreGridNo )
+static UINT8               g_costs_dirty[WORLD_MAX];
+static std::vector<UINT16> g_costs_dirty_tiles;
+static UINT                g_costs_batch_depth;
+
+UINT32 guiMovementCostsVersion;
+
+
+static void MarkMovementCosts(INT32 const gridno, UINT8 const what)
 {
-	INT16		usGridNo;
-	INT16		sGridX, sGridY;
-	INT16		sCentreGridX, sCentreGridY;
-	INT8		bDirLoop;
+	if (!isValidGridNo(gridno)) return;
+	UINT8& dirty = g_costs_dirty[gridno];
+	if (dirty == 0) g_costs_dirty_tiles.push_back(gridno);
+	dirty |= what;
+}
+
+
+static void FlushMovementCosts()
+{
+	if (g_costs_batch_depth != 0 || g_costs_dirty_tiles.empty()) return;
 
-	ConvertGridNoToXY( sCentreGridNo, &sCentreGridX, &sCentreGridY );
-	for( sGridY = sCentreGridY - LOCAL_RADIUS; sGridY < sCentreGridY + LOCAL_RADIUS; sGridY++ )
+	// Compile in the order of the grid numbers, like the whole world is compiled
+	std::sort(g_costs_dirty_tiles.begin(), g_costs_dirty_tiles.end());
+	for (std::vector<UINT16>::const_iterator i = g_costs_dirty_tiles.begin(); i != g_costs_dirty_tiles.end(); ++i)
 	{
-		for( sGridX = sCentreGridX - LOCAL_RADIUS; sGridX < sCentreGridX + LOCAL_RADIUS; sGridX++ )
+		if (!(g_costs_dirty[*i] & COSTS_WIPE)) continue;
+		for (INT8 bDirLoop = 0; bDirLoop < MAXDIR; bDirLoop++)
 		{
-			usGridNo = MAPROWCOLTOPOS( sGridY, sGridX );
-			if (isValidGridNo(usGridNo))
-			{
-				for( bDirLoop = 0; bDirLoop < MAXDIR; bDirLoop++)
-				{
-					gubWorldMovementCosts[usGridNo][bDirLoop][0] = 0;
-					gubWorldMovementCosts[usGridNo][bDirLoop][1] = 0;
-				}
-			}
+			gubWorldMovementCosts[*i][bDirLoop][0] = 0;
+			gubWorldMovementCosts[*i][bDirLoop][1] = 0;
+		}
+	}
+	UINT32 n_compiled = 0;
+	for (std::vector<UINT16>::const_iterator i = g_costs_dirty_tiles.begin(); i != g_costs_dirty_tiles.end(); ++i)
+	{
+		if (g_costs_dirty[*i] & COSTS_COMPILE)
+		{
+			CompileTileMovementCosts(*i);
+			++n_compiled;
+		}
+		g_costs_dirty[*i] = 0;
+	}
+	g_costs_dirty_tiles.clear();
+
+	++guiMovementCostsVersion;
+	ProfilerCount(PROFILE_MOVEMENT_COST_TILES, n_compiled);
+}
+
+
+void BeginMovementCostBatch()
+{
+	++g_costs_batch_depth;
+}
+
+
+void EndMovementCostBatch()
+{
+	Assert(g_costs_batch_depth != 0);
+	--g_costs_batch_depth;
+	FlushMovementCosts();
+}
+
+
+/* Wipes the square of the radius around the centre and compiles it, with a
+ * border of one tile, as the costs of a tile spill over to its neighbours. */
+static void MarkMovementCostsInRadius(INT16 const sCentreGridNo, INT16 const sRadius)
+{
+	INT16 sCentreGridX;
+	INT16 sCentreGridY;
+	ConvertGridNoToXY(sCentreGridNo, &sCentreGridX, &sCentreGridY);
+	for (INT16 sGridY = sCentreGridY - sRadius; sGridY < sCentreGridY + sRadius; sGridY++)
+	{
+		for (INT16 sGridX = sCentreGridX - sRadius; sGridX < sCentreGridX + sRadius; sGridX++)
+		{
+			MarkMovementCosts(MAPROWCOLTOPOS(sGridY, sGridX), COSTS_WIPE);
 		}
 	}
 
 	// note the radius used in this loop is larger, to guarantee that the
 	// edges of the recompiled areas are correct (i.e. there could be spillover)
-	for( sGridY = sCentreGridY - LOCAL_RADIUS - 1; sGridY < sCentreGridY + LOCAL_RADIUS + 1; sGridY++ )
+	for (INT16 sGridY = sCentreGridY - sRadius - 1; sGridY < sCentreGridY + sRadius + 1; sGridY++)
 	{
-		for( sGridX = sCentreGridX - LOCAL_RADIUS - 1; sGridX < sCentreGridX + LOCAL_RADIUS + 1; sGridX++ )
+		for (INT16 sGridX = sCentreGridX - sRadius - 1; sGridX < sCentreGridX + sRadius + 1; sGridX++)
 		{
-			usGridNo = MAPROWCOLTOPOS( sGridY, sGridX );
-			CompileTileMovementCosts( usGridNo );
+			MarkMovementCosts(MAPROWCOLTOPOS(sGridY, sGridX), COSTS_COMPILE);
 		}
 	}
 }
 
 
-void RecompileLocalMovementCostsFromRadius( INT16 sCentreGridNo, INT8 bRadius )
+#define LOCAL_RADIUS 4
+
+void RecompileLocalMovementCosts( INT16 sCentreGridNo )
 {
-	INT16		usGridNo;
-	INT16		sGridX, sGridY;
-	INT16		sCentreGridX, sCentreGridY;
-	INT8		bDirLoop;
+	MarkMovementCostsInRadius(sCentreGridNo, LOCAL_RADIUS);
+	FlushMovementCosts();
+}
 
-	ConvertGridNoToXY( sCentreGridNo, &sCentreGridX, &sCentreGridY );
+
+void RecompileLocalMovementCostsFromRadius( INT16 sCentreGridNo, INT8 bRadius )
+{
 	if (bRadius == 0)
 	{
 		// one tile check only
-		for( bDirLoop = 0; bDirLoop < MAXDIR; bDirLoop++)
-		{
-			gubWorldMovementCosts[sCentreGridNo][bDirLoop][0] = 0;
-			gubWorldMovementCosts[sCentreGridNo][bDirLoop][1] = 0;
-		}
-		CompileTileMovementCosts( sCentreGridNo );
+		MarkMovementCosts(sCentreGridNo, COSTS_WIPE | COSTS_COMPILE);
 	}
 	else
 	{
-		for( sGridY = sCentreGridY - bRadius; sGridY < sCentreGridY + bRadius; sGridY++ )
-		{
-			for( sGridX = sCentreGridX - bRadius; sGridX < sCentreGridX + bRadius; sGridX++ )
-			{
-				usGridNo = MAPROWCOLTOPOS( sGridY, sGridX );
-				if (isValidGridNo(usGridNo))
-				{
-					for( bDirLoop = 0; bDirLoop < MAXDIR; bDirLoop++)
-					{
-						gubWorldMovementCosts[usGridNo][bDirLoop][0] = 0;
-						gubWorldMovementCosts[usGridNo][bDirLoop][1] = 0;
-					}
-				}
-			}
-		}
-
-		// note the radius used in this loop is larger, to guarantee that the
-		// edges of the recompiled areas are correct (i.e. there could be spillover)
-		for( sGridY = sCentreGridY - bRadius - 1; sGridY < sCentreGridY + bRadius + 1; sGridY++ )
-		{
-			for( sGridX = sCentreGridX - bRadius - 1; sGridX < sCentreGridX + bRadius + 1; sGridX++ )
-			{
-				usGridNo = MAPROWCOLTOPOS( sGridY, sGridX );
-				CompileTileMovementCosts( usGridNo );
-			}
-		}
+		MarkMovementCostsInRadius(sCentreGridNo, bRadius);
 	}
+	FlushMovementCosts();
 }
 
 void AddTileToRecompileArea( INT16 sGridNo )
@@ -1196,7 +1291,6 @@ void RecompileLocalMovementCostsInAreaWithFlags( void )
 {
 	INT16		usGridNo;
 	INT16		sGridX, sGridY;
-	INT8		bDirLoop;
 
 	for( sGridY = gsRecompileAreaTop; sGridY <= gsRecompileAreaBottom; sGridY++ )
 	{
@@ -1206,11 +1300,7 @@ void RecompileLocalMovementCostsInAreaWithFlags( void )
 			if ( isValidGridNo(usGridNo) && gpWorldLevelData[ usGridNo ].ubExtFlags[0] & MAPELEMENT_EXT_RECALCULATE_MOVEMENT )
 			{
 				// wipe MPs in this tile!
-				for( bDirLoop = 0; bDirLoop < MAXDIR; bDirLoop++)
-				{
-					gubWorldMovementCosts[usGridNo][bDirLoop][0] = 0;
-					gubWorldMovementCosts[usGridNo][bDirLoop][1] = 0;
-				}
+				MarkMovementCosts(usGridNo, COSTS_WIPE);
 				// reset flag
 				gpWorldLevelData[ usGridNo ].ubExtFlags[0] &= (~MAPELEMENT_EXT_RECALCULATE_MOVEMENT);
 			}
@@ -1221,17 +1311,16 @@ void RecompileLocalMovementCostsInAreaWithFlags( void )
 	{
 		for( sGridX = gsRecompileAreaLeft; sGridX <= gsRecompileAreaRight; sGridX++ )
 		{
-			usGridNo = MAPROWCOLTOPOS( sGridY, sGridX );
-			CompileTileMovementCosts( usGridNo );
+			MarkMovementCosts(MAPROWCOLTOPOS(sGridY, sGridX), COSTS_COMPILE);
 		}
 	}
+	FlushMovementCosts();
 }
 
 void RecompileLocalMovementCostsForWall( INT16 sGridNo, UINT8 ubOrientation )
 {
-	INT8		bDirLoop;
 	INT16		sUp, sDown, sLeft, sRight;
-	INT16		sX, sY, sTempGridNo;
+	INT16		sX, sY;
 
 	switch( ubOrientation )
 	{
@@ -1257,16 +1346,10 @@ void RecompileLocalMovementCostsForWall( INT16 sGridNo, UINT8 ubOrientation )
 	{
 		for ( sX = sLeft; sX <= sRight; sX++ )
 		{
-			sTempGridNo = sGridNo + sX + sY * WORLD_COLS;
-			for( bDirLoop = 0; bDirLoop < MAXDIR; bDirLoop++)
-			{
-				gubWorldMovementCosts[sTempGridNo][bDirLoop][0] = 0;
-				gubWorldMovementCosts[sTempGridNo][bDirLoop][1] = 0;
-			}
-
-			CompileTileMovementCosts( sTempGridNo );
+			MarkMovementCosts(sGridNo + sX + sY * WORLD_COLS, COSTS_WIPE | COSTS_COMPILE);
 		}
 	}
+	FlushMovementCosts();
 }
 
 
@@ -1289,6 +1372,8 @@ void CompileWorldMovementCosts( )
 	{
 		CompileTileMovementCosts( usGridNo );
 	}
+	++guiMovementCostsVersion;
+	ProfilerCount(PROFILE_MOVEMENT_COST_TILES, WORLD_MAX);
 }
 
 
@@ -1657,7 +1742,9 @@ static void SetBlueFlagFlags(void)
 }
 
 
-void InitLoadedWorld(void)
+/* The movement costs need not be compiled if they were read from the compiled
+ * map. */
+static void InitLoadedWorld(bool const compile_movement_costs)
 {
 	//if the current sector is not valid, dont init the world
 	if( gWorldSectorX == 0 || gWorldSectorY == 0 )
@@ -1666,11 +1753,13 @@ void InitLoadedWorld(void)
 	}
 
 	// COMPILE MOVEMENT COSTS
-	CompileWorldMovementCosts( );
+	if (compile_movement_costs) CompileWorldMovementCosts( );
 
 	// COMPILE WORLD VISIBLIY TILES
 	CalculateWorldWireFrameTiles( TRUE );
 
+	BuildCoverMap();
+
 	LightSpriteRenderAll();
 
 	OptimizeMapForShadows( );
@@ -1684,6 +1773,12 @@ void InitLoadedWorld(void)
 }
 
 
+void InitLoadedWorld(void)
+{
+	InitLoadedWorld(true);
+}
+
+
 extern double MasterStart, MasterEnd;
 extern BOOLEAN gfUpdatingNow;
 
@@ -2031,6 +2126,14 @@ static void LoadMapLights(HWFILE);
 void LoadWorld(char const* const filename)
 try
 {
+	PROFILE_ZONE("LoadWorld");
+	MEM_TAG_SCOPE(MEM_TAG_WORLD);
+
+	// Do not compete with the prefetcher for the disk
+	CancelPrefetch();
+
+	uint64_t const start = SDL_GetPerformanceCounter();
+
 	LoadShadeTablesFromTextFile();
 
 	// Reset flags for outdoors/indoors
@@ -2072,7 +2175,9 @@ try
 	INT32 iTilesetID;
 	FileRead(f, &iTilesetID, sizeof(iTilesetID));
 
+	uint64_t const tileset_start = SDL_GetPerformanceCounter();
 	LoadMapTileset(static_cast<TileSetID>(iTilesetID));
+	double const tileset_ms = MSSince(tileset_start);
 
 	// Skip soldier size
 	FileSeek(f, 4, FILE_SEEK_FROM_CURRENT);
@@ -2358,6 +2463,7 @@ try
 		SetDefaultWorldLightingColors();
 	}
 	LightSetBaseLevel(ubAmbientLightLevel);
+	LightSpriteRenderAll();
 
 	SetRelativeStartAndEndPercentage(0, 85, 86, L"Loading map information...");
 	RenderProgressBar(0, 0);
@@ -2431,14 +2537,28 @@ try
 
 	SetRelativeStartAndEndPercentage(0, 93, 94, L"Init Loaded World...");
 	RenderProgressBar(0, 0);
-	InitLoadedWorld();
+	/* The terrain IDs and movement costs only depend on the map file and its
+	 * tileset, so they are kept compiled under their hash */
+	uint64_t const compiled_key    = CompiledMapKey(f, static_cast<TileSetID>(iTilesetID));
+	bool     const compiled_loaded = LoadCompiledMap(compiled_key);
+	InitLoadedWorld(!compiled_loaded);
+	if (!compiled_loaded && gWorldSectorX != 0 && gWorldSectorY != 0)
+	{
+		SaveCompiledMap(compiled_key);
+	}
 
-	if (generate_edge_points)
+	/* Maps without stored edgepoints have them generated, which takes long, so
+	 * they are kept with the compiled map */
+	if (generate_edge_points && !LoadCompiledEdgepoints(compiled_key))
 	{
 		SetRelativeStartAndEndPercentage(0, 94, 95, L"Generating map edgepoints...");
 		RenderProgressBar(0, 0);
 		CompileWorldMovementCosts();
 		GenerateMapEdgepoints();
+		if (gWorldSectorX != 0 && gWorldSectorY != 0)
+		{
+			SaveCompiledEdgepoints(compiled_key);
+		}
 	}
 
 	RenderProgressBar(0, 20);
@@ -2470,10 +2590,24 @@ try
 	}
 
 	// ATE: Not while updating maps!
-	if (guiCurrentScreen != MAPUTILITY_SCREEN) GenerateBuildings();
+	if (guiCurrentScreen != MAPUTILITY_SCREEN)
+	{
+		/* Walking around every roof for the climb points takes long, so the
+		 * buildings of a sector map are kept with the compiled map, too */
+		bool const keep_buildings = gWorldSectorX != 0 && gWorldSectorY != 0 && gbWorldSectorZ == 0 && !gfEditMode;
+		if (!keep_buildings || !LoadCompiledBuildings(compiled_key))
+		{
+			GenerateBuildings();
+			if (keep_buildings) SaveCompiledBuildings(compiled_key);
+		}
+	}
 
 	RenderProgressBar(0, 100);
 	DequeueAllKeyBoardEvents();
+
+	double const total_ms = MSSince(start);
+	SLOGI("Loaded map %s in %.1f ms: tileset %.1f ms, map data and initialization %.1f ms",
+		filename, total_ms, tileset_ms, total_ms - tileset_ms);
 }
 catch (const std::runtime_error& err)
 {
@@ -2508,7 +2642,7 @@ void FreeLevelNodeList(LEVELNODE** const head)
 	while (i != NULL)
 	{
 		LEVELNODE* const next = i->pNext;
-		MemFree(i);
+		FreeLevelNode(i);
 		i = next;
 	}
 }
@@ -2550,18 +2684,13 @@ void TrashWorld(void)
 	// On trash world check if we have to set up the first meanwhile
 	HandleFirstMeanWhileSetUpWithTrashWorld();
 
+	InvalidateStaticWorldCache();
+
+	// The undo stack holds level nodes and makes no sense for another map
+	RemoveAllFromUndoList();
+
 	FOR_EACH_WORLD_TILE(me)
 	{
-		// Free the memory associated with the map tile link lists
-		FreeLevelNodeList(&me->pLandHead);
-		FreeLevelNodeList(&me->pObjectHead);
-		FreeLevelNodeList(&me->pStructHead);
-		FreeLevelNodeList(&me->pShadowHead);
-		FreeLevelNodeList(&me->pMercHead);
-		FreeLevelNodeList(&me->pRoofHead);
-		FreeLevelNodeList(&me->pOnRoofHead);
-		FreeLevelNodeList(&me->pTopmostHead);
-
 		while (me->pStructureHead != NULL)
 		{
 			if (!DeleteStructureFromWorld(me->pStructureHead))
@@ -2574,14 +2703,23 @@ void TrashWorld(void)
 
 	// Zero world
 	std::fill_n(gpWorldLevelData, WORLD_MAX, MAP_ELEMENT{});
+	std::fill(std::begin(guiRevealedTiles), std::end(guiRevealedTiles), 0);
+	ResetSmellTiles();
+
+	// The map tile link lists are given back all at once
+	ResetLevelNodes();
+	std::fill(std::begin(gusWorldLayers), std::end(gusWorldLayers), 0);
 
 	// Set some default flags
 	FOR_EACH_WORLD_TILE(i)
 	{
 		i->uiFlags |= MAPELEMENT_RECALCULATE_WIREFRAMES;
 	}
+	g_wireframe_dirty.clear();
+	g_wireframes_all_dirty = true;
 
 	TrashDoorTable();
+	TrashExitGrids();
 	TrashMapEdgepoints();
 	TrashDoorStatusArray();
 
@@ -2606,6 +2744,7 @@ static void TrashMapTile(const INT16 MapTile)
 	FreeLevelNodeList(&me->pRoofHead);
 	FreeLevelNodeList(&me->pOnRoofHead);
 	FreeLevelNodeList(&me->pTopmostHead);
+	UpdateWorldLayers(MapTile);
 
 	while (me->pStructureHead != NULL)
 	{
@@ -2647,6 +2786,55 @@ void LoadMapTileset(TileSetID const id)
 }
 
 
+static void PrefetchGameRes(char const* const filename)
+{
+	if (GCM->doesGameResExists(filename)) PrefetchFile(GCM->openGameResForReading(filename));
+}
+
+
+void PrefetchWorld(char const* const filename)
+try
+{
+	CancelPrefetch();
+
+	AutoSGPFile f(GCM->openMapForReading(filename));
+
+	// Read just enough of the header to know the tileset
+	FLOAT dMajorMapVersion;
+	FileRead(f, &dMajorMapVersion, sizeof(dMajorMapVersion));
+	if (dMajorMapVersion >= 4.00) FileSeek(f, 1, FILE_SEEK_FROM_CURRENT); // minor version
+	FileSeek(f, 4, FILE_SEEK_FROM_CURRENT); // flags
+	INT32 iTilesetID;
+	FileRead(f, &iTilesetID, sizeof(iTilesetID));
+	PrefetchFile(f.Release());
+
+	// LoadMapTileset() keeps the current tileset
+	if (iTilesetID < 0 || NUM_TILESETS <= iTilesetID || iTilesetID == giCurrentTilesetID) return;
+
+	// Same choice of surfaces as LoadTileSurfaces()
+	TileSetID const id = static_cast<TileSetID>(iTilesetID);
+	for (UINT32 i = 0; i != NUMBEROFTILETYPES; ++i)
+	{
+		char const* filename       = gTilesets[id].TileSurfaceFilenames[i];
+		TileSetID   tileset_to_use = id;
+		if (filename[0] == '\0')
+		{
+			if (gbDefaultSurfaceUsed[i]) continue;
+			filename       = gTilesets[GENERIC_1].TileSurfaceFilenames[i];
+			tileset_to_use = GENERIC_1;
+		}
+
+		std::string const image(GCM->getTilesetResourceName(tileset_to_use, filename));
+		PrefetchGameRes(image.c_str());
+		PrefetchGameRes(FileMan::replaceExtension(image, ".jsd").c_str());
+	}
+}
+catch (const std::exception& e)
+{
+	SLOGW("Failed to prefetch world %s: %s", filename, e.what());
+}
+
+
 static void AddWireFrame(GridNo const gridno, UINT16 const idx, bool const forced)
 {
 	for (LEVELNODE* i = gpWorldLevelData[gridno].pTopmostHead; i; i = i->pNext)
@@ -2704,193 +2892,211 @@ static bool IsRoofVisibleForWireframe(GridNo);
 static void RemoveWireFrameTiles(GridNo);
 
 
-void CalculateWorldWireFrameTiles( BOOLEAN fForce )
+void MarkWireFrameTileDirty(GridNo const grid_no)
+{
+	if (grid_no < 0 || WORLD_MAX <= grid_no) return;
+	UINT16& flags = gpWorldLevelData[grid_no].uiFlags;
+	if (flags & MAPELEMENT_RECALCULATE_WIREFRAMES) return;
+	flags |= MAPELEMENT_RECALCULATE_WIREFRAMES;
+	g_wireframe_dirty.push_back(grid_no);
+}
+
+
+static void CalculateWireFrameTile(INT32 const cnt)
 {
-	INT32     cnt;
 	STRUCTURE *pStructure;
 	INT16     sGridNo;
 	UINT8     ubWallOrientation;
 	INT8      bNumWallsSameGridNo;
 	UINT16    usWireFrameIndex;
 
-	// Create world randomly from tiles
-	for ( cnt = 0; cnt < WORLD_MAX; cnt++ )
-	{
-		if ( gpWorldLevelData[ cnt ].uiFlags & MAPELEMENT_RECALCULATE_WIREFRAMES || fForce )
-		{
-			// Turn off flag
-			gpWorldLevelData[ cnt ].uiFlags &= (~MAPELEMENT_RECALCULATE_WIREFRAMES );
+	// Turn off flag
+	gpWorldLevelData[ cnt ].uiFlags &= (~MAPELEMENT_RECALCULATE_WIREFRAMES );
 
-			// Remove old ones
-			RemoveWireFrameTiles( (INT16)cnt );
+	// Remove old ones
+	RemoveWireFrameTiles( (INT16)cnt );
 
-			bNumWallsSameGridNo = 0;
+	bNumWallsSameGridNo = 0;
 
-			// Check our gridno, if we have a roof over us that has not beenr evealed, no need for a wiereframe
-			if ( IsRoofVisibleForWireframe( (UINT16)cnt ) && !( gpWorldLevelData[ cnt ].uiFlags & MAPELEMENT_REVEALED ) )
-			{
-				continue;
-			}
+	// Check our gridno, if we have a roof over us that has not beenr evealed, no need for a wiereframe
+	if ( IsRoofVisibleForWireframe( (UINT16)cnt ) && !( gpWorldLevelData[ cnt ].uiFlags & MAPELEMENT_REVEALED ) )
+	{
+		return;
+	}
 
-			pStructure = gpWorldLevelData[ cnt ].pStructureHead;
+	pStructure = gpWorldLevelData[ cnt ].pStructureHead;
 
-			while ( pStructure != NULL )
+	while ( pStructure != NULL )
+	{
+		// Check for doors
+		if ( pStructure->fFlags & STRUCTURE_ANYDOOR )
+		{
+			// ATE: need this additional check here for hidden doors!
+			if ( pStructure->fFlags & STRUCTURE_OPENABLE )
 			{
-				// Check for doors
-				if ( pStructure->fFlags & STRUCTURE_ANYDOOR )
-				{
-					// ATE: need this additional check here for hidden doors!
-					if ( pStructure->fFlags & STRUCTURE_OPENABLE )
-					{
-						// Does the gridno we are over have a non-visible tile?
-						// Based on orientation
-						ubWallOrientation = pStructure->ubWallOrientation;
+				// Does the gridno we are over have a non-visible tile?
+				// Based on orientation
+				ubWallOrientation = pStructure->ubWallOrientation;
 
-						switch( ubWallOrientation )
-						{
-							case OUTSIDE_TOP_LEFT:
-							case INSIDE_TOP_LEFT:
+				switch( ubWallOrientation )
+				{
+					case OUTSIDE_TOP_LEFT:
+					case INSIDE_TOP_LEFT:
 
-								// Get gridno
-								sGridNo = NewGridNo( (INT16)cnt, DirectionInc( SOUTH ) );
+						// Get gridno
+						sGridNo = NewGridNo( (INT16)cnt, DirectionInc( SOUTH ) );
 
-								if ( IsRoofVisibleForWireframe( sGridNo ) && !( gpWorldLevelData[ sGridNo ].uiFlags & MAPELEMENT_REVEALED ) )
-								{
-									AddWireFrame((INT16)cnt, WIREFRAMES4, (gpWorldLevelData[sGridNo].uiFlags & MAPELEMENT_REVEALED) != 0);
-								}
-								break;
+						if ( IsRoofVisibleForWireframe( sGridNo ) && !( gpWorldLevelData[ sGridNo ].uiFlags & MAPELEMENT_REVEALED ) )
+						{
+							AddWireFrame((INT16)cnt, WIREFRAMES4, (gpWorldLevelData[sGridNo].uiFlags & MAPELEMENT_REVEALED) != 0);
+						}
+						break;
 
-							case OUTSIDE_TOP_RIGHT:
-							case INSIDE_TOP_RIGHT:
+					case OUTSIDE_TOP_RIGHT:
+					case INSIDE_TOP_RIGHT:
 
-								// Get gridno
-								sGridNo = NewGridNo( (INT16)cnt, DirectionInc( EAST ) );
-
-								if ( IsRoofVisibleForWireframe( sGridNo ) && !( gpWorldLevelData[ sGridNo ].uiFlags & MAPELEMENT_REVEALED ) )
-								{
-									AddWireFrame((INT16)cnt, WIREFRAMES3, (gpWorldLevelData[sGridNo].uiFlags & MAPELEMENT_REVEALED) != 0);
-								}
-								break;
+						// Get gridno
+						sGridNo = NewGridNo( (INT16)cnt, DirectionInc( EAST ) );
 
+						if ( IsRoofVisibleForWireframe( sGridNo ) && !( gpWorldLevelData[ sGridNo ].uiFlags & MAPELEMENT_REVEALED ) )
+						{
+							AddWireFrame((INT16)cnt, WIREFRAMES3, (gpWorldLevelData[sGridNo].uiFlags & MAPELEMENT_REVEALED) != 0);
 						}
-					}
+						break;
+
 				}
-				// Check for windows
-				else
+			}
+		}
+		// Check for windows
+		else
+		{
+			if ( pStructure->fFlags & STRUCTURE_WALLNWINDOW )
+			{
+				// Does the gridno we are over have a non-visible tile?
+				// Based on orientation
+				ubWallOrientation = pStructure->ubWallOrientation;
+
+				switch( ubWallOrientation )
 				{
-					if ( pStructure->fFlags & STRUCTURE_WALLNWINDOW )
-					{
-						// Does the gridno we are over have a non-visible tile?
-						// Based on orientation
-						ubWallOrientation = pStructure->ubWallOrientation;
+					case OUTSIDE_TOP_LEFT:
+					case INSIDE_TOP_LEFT:
 
-						switch( ubWallOrientation )
+						// Get gridno
+						sGridNo = NewGridNo( (INT16)cnt, DirectionInc( SOUTH ) );
+
+						if ( IsRoofVisibleForWireframe( sGridNo ) && !( gpWorldLevelData[ sGridNo ].uiFlags & MAPELEMENT_REVEALED ) )
 						{
-							case OUTSIDE_TOP_LEFT:
-							case INSIDE_TOP_LEFT:
+							AddWireFrame((INT16)cnt, WIREFRAMES2, (gpWorldLevelData[sGridNo].uiFlags & MAPELEMENT_REVEALED) != 0);
+						}
+						break;
 
-								// Get gridno
-								sGridNo = NewGridNo( (INT16)cnt, DirectionInc( SOUTH ) );
+					case OUTSIDE_TOP_RIGHT:
+					case INSIDE_TOP_RIGHT:
 
-								if ( IsRoofVisibleForWireframe( sGridNo ) && !( gpWorldLevelData[ sGridNo ].uiFlags & MAPELEMENT_REVEALED ) )
-								{
-									AddWireFrame((INT16)cnt, WIREFRAMES2, (gpWorldLevelData[sGridNo].uiFlags & MAPELEMENT_REVEALED) != 0);
-								}
-								break;
+						// Get gridno
+						sGridNo = NewGridNo( (INT16)cnt, DirectionInc( EAST ) );
 
-							case OUTSIDE_TOP_RIGHT:
-							case INSIDE_TOP_RIGHT:
+						if ( IsRoofVisibleForWireframe( sGridNo ) && !( gpWorldLevelData[ sGridNo ].uiFlags & MAPELEMENT_REVEALED ) )
+						{
+							AddWireFrame((INT16)cnt, WIREFRAMES1, (gpWorldLevelData[sGridNo].uiFlags & MAPELEMENT_REVEALED) != 0);
+						}
+						break;
 
-								// Get gridno
-								sGridNo = NewGridNo( (INT16)cnt, DirectionInc( EAST ) );
+				}
 
-								if ( IsRoofVisibleForWireframe( sGridNo ) && !( gpWorldLevelData[ sGridNo ].uiFlags & MAPELEMENT_REVEALED ) )
-								{
-									AddWireFrame((INT16)cnt, WIREFRAMES1, (gpWorldLevelData[sGridNo].uiFlags & MAPELEMENT_REVEALED) != 0);
-								}
-								break;
+			}
 
-						}
+			// Check for walls
+			if ( pStructure->fFlags & STRUCTURE_WALLSTUFF )
+			{
+				// Does the gridno we are over have a non-visible tile?
+				// Based on orientation
+				ubWallOrientation = pStructure->ubWallOrientation;
 
-					}
+				usWireFrameIndex = GetWireframeGraphicNumToUseForWall( (UINT16)cnt, pStructure );
 
-					// Check for walls
-					if ( pStructure->fFlags & STRUCTURE_WALLSTUFF )
-					{
-						// Does the gridno we are over have a non-visible tile?
-						// Based on orientation
-						ubWallOrientation = pStructure->ubWallOrientation;
+				switch( ubWallOrientation )
+				{
+					case OUTSIDE_TOP_LEFT:
+					case INSIDE_TOP_LEFT:
 
-						usWireFrameIndex = GetWireframeGraphicNumToUseForWall( (UINT16)cnt, pStructure );
+						// Get gridno
+						sGridNo = NewGridNo( (INT16)cnt, DirectionInc( SOUTH ) );
 
-						switch( ubWallOrientation )
+						if ( IsRoofVisibleForWireframe( sGridNo ) )
 						{
-							case OUTSIDE_TOP_LEFT:
-							case INSIDE_TOP_LEFT:
+							bNumWallsSameGridNo++;
 
-								// Get gridno
-								sGridNo = NewGridNo( (INT16)cnt, DirectionInc( SOUTH ) );
+							AddWireFrame((INT16)cnt, usWireFrameIndex, (gpWorldLevelData[sGridNo].uiFlags & MAPELEMENT_REVEALED) != 0);
 
-								if ( IsRoofVisibleForWireframe( sGridNo ) )
-								{
-									bNumWallsSameGridNo++;
-
-									AddWireFrame((INT16)cnt, usWireFrameIndex, (gpWorldLevelData[sGridNo].uiFlags & MAPELEMENT_REVEALED) != 0);
-
-									// Check along our direction to see if we are a corner
-									sGridNo = NewGridNo( (INT16)cnt, DirectionInc( WEST ) );
-									sGridNo = NewGridNo( sGridNo, DirectionInc( SOUTH ) );
-									if (!IsHiddenTileMarkerThere(sGridNo))
-									{
-										// Place corner!
-										AddWireFrame((INT16)cnt, WIREFRAMES9, (gpWorldLevelData[sGridNo].uiFlags & MAPELEMENT_REVEALED) != 0);
-									}
-								}
-								break;
-
-							case OUTSIDE_TOP_RIGHT:
-							case INSIDE_TOP_RIGHT:
+							// Check along our direction to see if we are a corner
+							sGridNo = NewGridNo( (INT16)cnt, DirectionInc( WEST ) );
+							sGridNo = NewGridNo( sGridNo, DirectionInc( SOUTH ) );
+							if (!IsHiddenTileMarkerThere(sGridNo))
+							{
+								// Place corner!
+								AddWireFrame((INT16)cnt, WIREFRAMES9, (gpWorldLevelData[sGridNo].uiFlags & MAPELEMENT_REVEALED) != 0);
+							}
+						}
+						break;
 
-								// Get gridno
-								sGridNo = NewGridNo( (INT16)cnt, DirectionInc( EAST ) );
+					case OUTSIDE_TOP_RIGHT:
+					case INSIDE_TOP_RIGHT:
 
-								if ( IsRoofVisibleForWireframe( sGridNo ) )
-								{
-									bNumWallsSameGridNo++;
+						// Get gridno
+						sGridNo = NewGridNo( (INT16)cnt, DirectionInc( EAST ) );
 
-									AddWireFrame((INT16)cnt, usWireFrameIndex, (gpWorldLevelData[sGridNo].uiFlags & MAPELEMENT_REVEALED) != 0);
+						if ( IsRoofVisibleForWireframe( sGridNo ) )
+						{
+							bNumWallsSameGridNo++;
 
-									// Check along our direction to see if we are a corner
-									sGridNo = NewGridNo( (INT16)cnt, DirectionInc( NORTH ) );
-									sGridNo = NewGridNo( sGridNo, DirectionInc( EAST ) );
-									if (!IsHiddenTileMarkerThere(sGridNo))
-									{
-										// Place corner!
-										AddWireFrame((INT16)cnt, WIREFRAMES8, (gpWorldLevelData[sGridNo].uiFlags & MAPELEMENT_REVEALED) != 0);
-									}
+							AddWireFrame((INT16)cnt, usWireFrameIndex, (gpWorldLevelData[sGridNo].uiFlags & MAPELEMENT_REVEALED) != 0);
 
-								}
-								break;
+							// Check along our direction to see if we are a corner
+							sGridNo = NewGridNo( (INT16)cnt, DirectionInc( NORTH ) );
+							sGridNo = NewGridNo( sGridNo, DirectionInc( EAST ) );
+							if (!IsHiddenTileMarkerThere(sGridNo))
+							{
+								// Place corner!
+								AddWireFrame((INT16)cnt, WIREFRAMES8, (gpWorldLevelData[sGridNo].uiFlags & MAPELEMENT_REVEALED) != 0);
+							}
 
 						}
+						break;
 
-						// Check for both walls
-						if ( bNumWallsSameGridNo == 2 )
-						{
-							sGridNo = NewGridNo( (INT16)cnt, DirectionInc( EAST ) );
-							sGridNo = NewGridNo( sGridNo, DirectionInc( SOUTH ) );
-							AddWireFrame((INT16)cnt, WIREFRAMES7, (gpWorldLevelData[sGridNo].uiFlags & MAPELEMENT_REVEALED) != 0);
-						}
-					}
 				}
 
-				pStructure = pStructure->pNext;
+				// Check for both walls
+				if ( bNumWallsSameGridNo == 2 )
+				{
+					sGridNo = NewGridNo( (INT16)cnt, DirectionInc( EAST ) );
+					sGridNo = NewGridNo( sGridNo, DirectionInc( SOUTH ) );
+					AddWireFrame((INT16)cnt, WIREFRAMES7, (gpWorldLevelData[sGridNo].uiFlags & MAPELEMENT_REVEALED) != 0);
+				}
 			}
 		}
+
+		pStructure = pStructure->pNext;
 	}
 }
 
 
+void CalculateWorldWireFrameTiles( BOOLEAN fForce )
+{
+	if (fForce || g_wireframes_all_dirty)
+	{
+		for (INT32 cnt = 0; cnt != WORLD_MAX; ++cnt) CalculateWireFrameTile(cnt);
+		g_wireframe_dirty.clear();
+		g_wireframes_all_dirty = false;
+		return;
+	}
+
+	// Only the tiles around changed walls, roofs and rooms
+	for (GridNo const g : g_wireframe_dirty) CalculateWireFrameTile(g);
+	g_wireframe_dirty.clear();
+}
+
+
 static void RemoveWorldWireFrameTiles()
 {
 	for (INT32 cnt = 0; cnt != WORLD_MAX; ++cnt)
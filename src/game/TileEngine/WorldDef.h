@@ -226,9 +226,36 @@ extern MAP_ELEMENT* gpWorldLevelData;
 #define FOR_EACH_WORLD_TILE(iter) \
 	for (MAP_ELEMENT* iter = gpWorldLevelData, * const iter##__end = gpWorldLevelData + WORLD_MAX; iter != iter##__end; ++iter)
 
+/* MAPELEMENT_REVEALED of all tiles as a dense bitset, bit i % 32 of word i / 32
+ * for gridno i, so it can be copied and scanned a word at a time. The flag and
+ * the bitset are only to be changed together, by the functions below. */
+#define REVEALED_TILE_WORDS (WORLD_MAX / 32)
+extern UINT32 guiRevealedTiles[REVEALED_TILE_WORDS];
+
+static inline void SetTileRevealed(GridNo const grid_no)
+{
+	gpWorldLevelData[grid_no].uiFlags |= MAPELEMENT_REVEALED;
+	guiRevealedTiles[grid_no / 32]    |= 1U << (grid_no % 32);
+}
+
+static inline void ClearTileRevealed(GridNo const grid_no)
+{
+	gpWorldLevelData[grid_no].uiFlags &= ~MAPELEMENT_REVEALED;
+	guiRevealedTiles[grid_no / 32]    &= ~(1U << (grid_no % 32));
+}
+
+static inline bool IsTileRevealed(GridNo const grid_no)
+{
+	return guiRevealedTiles[grid_no / 32] & 1U << (grid_no % 32);
+}
+
 // World Movement Costs
 extern UINT8 gubWorldMovementCosts[WORLD_MAX][MAXDIR][2];
 
+/* Incremented whenever movement costs are changed, so anything derived from
+ * them, e.g. cached paths, can tell whether it is stale. */
+extern UINT32 guiMovementCostsVersion;
+
 
 extern TileSetID giCurrentTilesetID;
 
@@ -259,8 +286,18 @@ void RecompileLocalMovementCostsFromRadius( INT16 sCentreGridNo, INT8 bRadius );
 
 void LoadMapTileset(TileSetID);
 
+/* Reads the map and the tileset it uses in the background, so a following
+ * LoadWorld() of it finds them in the page cache. The previous prefetch is
+ * cancelled. */
+void PrefetchWorld(char const* filename);
+
+/* Recalculates the wireframes of the tiles marked by MarkWireFrameTileDirty(),
+ * or of the whole map if fForce is set or the world has been trashed since. */
 void CalculateWorldWireFrameTiles( BOOLEAN fForce );
 
+// Has the wireframes of the tile recalculated by the next CalculateWorldWireFrameTiles()
+void MarkWireFrameTileDirty(GridNo);
+
 void ReloadTileset(TileSetID);
 
 bool FloorAtGridNo(UINT32 map_idx);
@@ -283,4 +320,17 @@ void SetAllNewTileSurfacesLoaded(BOOLEAN fNew);
 
 void RecompileLocalMovementCostsForWall(INT16 sGridNo, UINT8 ubOrientation);
 
+/* Defers the local movement cost recompilations until the batch ends, and then
+ * compiles every affected tile once. Batches nest. The costs must not be read
+ * within a batch, as they are not updated yet. */
+void BeginMovementCostBatch();
+void EndMovementCostBatch();
+
+class MovementCostBatch
+{
+	public:
+		MovementCostBatch()  { BeginMovementCostBatch(); }
+		~MovementCostBatch() { EndMovementCostBatch(); }
+};
+
 #endif
@@ -1,6 +1,7 @@
 #include <stdexcept>
 
 #include "Debug_Pages.h"
+#include "Exit_Grids.h"
 #include "Animation_Data.h"
 #include "Environment.h"
 #include "Font.h"
@@ -23,6 +24,10 @@
 #include "Render_Fun.h"
 #include "GameSettings.h"
 #include "MemMan.h"
+#include "Logger.h"
+
+#include <string.h>
+#include <vector>
 
 
 static UINT32 guiLNCount[9];
@@ -40,12 +45,107 @@ static const wchar_t gzLevelString[][15] =
 };
 
 
+/* Level nodes are taken one after the other from slabs, so the nodes of a map,
+ * which is loaded tile by tile and layer by layer, lie next to each other.
+ * Freed nodes are reused, and all nodes are given back at once when the world
+ * is trashed. The slabs are kept for the next map. */
+#define LEVELNODE_SLAB_SIZE 4096 // nodes per slab
+
+static std::vector<LEVELNODE*> g_level_node_slabs;
+static size_t                  g_level_node_slab;      // slab nodes are taken from
+static size_t                  g_level_node_slab_used; // nodes taken from it
+static LEVELNODE*              g_free_level_nodes;     // linked through pNext
+static UINT32                  g_level_nodes_used;
+static UINT32                  g_level_nodes_peak;
+
+
+LEVELNODE* AllocLevelNode()
+{
+	LEVELNODE* n = g_free_level_nodes;
+	if (n)
+	{
+		g_free_level_nodes = n->pNext;
+	}
+	else
+	{
+		if (g_level_node_slab_used == LEVELNODE_SLAB_SIZE)
+		{
+			++g_level_node_slab;
+			g_level_node_slab_used = 0;
+		}
+		if (g_level_node_slab == g_level_node_slabs.size())
+		{
+			g_level_node_slabs.push_back(MALLOCN(LEVELNODE, LEVELNODE_SLAB_SIZE));
+		}
+		n = &g_level_node_slabs[g_level_node_slab][g_level_node_slab_used++];
+	}
+
+	if (++g_level_nodes_used > g_level_nodes_peak) g_level_nodes_peak = g_level_nodes_used;
+	return n;
+}
+
+
+void FreeLevelNode(LEVELNODE* const n)
+{
+	Assert(g_level_nodes_used != 0);
+	--g_level_nodes_used;
+	n->pNext           = g_free_level_nodes;
+	g_free_level_nodes = n;
+}
+
+
+void ResetLevelNodes()
+{
+	SLOGD("Level nodes: %u in use, peak %u in %u slabs of %u bytes",
+		g_level_nodes_used, g_level_nodes_peak, (UINT32)g_level_node_slabs.size(), (UINT32)(LEVELNODE_SLAB_SIZE * sizeof(LEVELNODE)));
+	g_level_node_slab      = 0;
+	g_level_node_slab_used = 0;
+	g_free_level_nodes     = 0;
+	g_level_nodes_used     = 0;
+}
+
+
+void FreeLevelNodeSlabs()
+{
+	ResetLevelNodes();
+	for (std::vector<LEVELNODE*>::const_iterator i = g_level_node_slabs.begin(); i != g_level_node_slabs.end(); ++i)
+	{
+		MemFree(*i);
+	}
+	g_level_node_slabs.clear();
+}
+
+
+UINT16 gusWorldLayers[WORLD_MAX];
+
+
+static void MarkWorldLayer(UINT32 const map_idx, UINT const layer)
+{
+	// The land list is walked from both its head and its start
+	UINT16 const bits = layer == LAND_START_INDEX ? 1U << 0 | 1U << LAND_START_INDEX : 1U << layer;
+	gusWorldLayers[map_idx] |= bits;
+}
+
+
+void UpdateWorldLayers(UINT32 const map_idx)
+{
+	MAP_ELEMENT const& me   = gpWorldLevelData[map_idx];
+	UINT16             bits = 0;
+	for (UINT i = 0; i != lengthof(me.pLevelNodes); ++i)
+	{
+		if (me.pLevelNodes[i]) bits |= 1U << i;
+	}
+	gusWorldLayers[map_idx] = bits;
+}
+
+
 // LEVEL NODE MANIPLULATION FUNCTIONS
 static LEVELNODE* CreateLevelNode(void)
 {
-	LEVELNODE* const Node = MALLOCZ(LEVELNODE);
-	Node->ubShadeLevel        = LightGetAmbient();
-	Node->ubNaturalShadeLevel = LightGetAmbient();
+	LEVELNODE* const Node = AllocLevelNode();
+	memset(Node, 0, sizeof(*Node));
+	Node->ubShadeLevel        = SHADE_AMBIENT;
+	Node->ubNaturalShadeLevel = SHADE_AMBIENT;
 	Node->pSoldier            = NULL;
 	Node->pNext               = NULL;
 	Node->sRelativeX          = 0;
@@ -89,6 +189,7 @@ void DebugLevelNodePage(void)
 	mprintf(DEBUG_PAGE_FIRST_COLUMN, y += h, L"%d land nodes in excess of world max (25600)", guiLNCount[1] - WORLD_MAX);
 	mprintf(DEBUG_PAGE_FIRST_COLUMN, y += h, L"Total # levelnodes %d, %d bytes each", guiLNCount[0], sizeof(LEVELNODE));
 	mprintf(DEBUG_PAGE_FIRST_COLUMN, y += h, L"Total memory for levelnodes %d", guiLNCount[0] * sizeof(LEVELNODE));
+	mprintf(DEBUG_PAGE_FIRST_COLUMN, y += h, L"Peak # levelnodes %d in %d slabs", g_level_nodes_peak, (UINT32)g_level_node_slabs.size());
 }
 
 
@@ -118,6 +219,7 @@ LEVELNODE* AddObjectToTail(const UINT32 iMapIndex, const UINT16 usIndex)
 	LEVELNODE** anchor = &gpWorldLevelData[iMapIndex].pObjectHead;
 	while (*anchor != NULL) anchor = &(*anchor)->pNext;
 	*anchor = n;
+	MarkWorldLayer(iMapIndex, OBJECT_START_INDEX);
 
 	ResetSpecificLayerOptimizing(TILES_DYNAMIC_OBJECTS);
 	return n;
@@ -132,6 +234,7 @@ LEVELNODE* AddObjectToHead(const UINT32 iMapIndex, const UINT16 usIndex)
 	LEVELNODE** const head = &gpWorldLevelData[iMapIndex].pObjectHead;
 	n->pNext = *head;
 	*head    = n;
+	MarkWorldLayer(iMapIndex, OBJECT_START_INDEX);
 
 	ResetSpecificLayerOptimizing(TILES_DYNAMIC_OBJECTS);
 	AddObjectToMapTempFile(iMapIndex, usIndex);
@@ -161,7 +264,7 @@ BOOLEAN RemoveObject(UINT32 iMapIndex, UINT16 usIndex)
 
 			CheckForAndDeleteTileCacheStructInfo(pObject, usIndex);
 
-			MemFree(pObject);
+			FreeLevelNode(pObject);
 
 			//Add the index to the maps temp file so we can remove it after reloading the map
 			AddRemoveObjectToMapTempFile(iMapIndex, usIndex);
@@ -244,6 +347,7 @@ LEVELNODE* AddLandToTail(const UINT32 iMapIndex, const UINT16 usIndex)
 		anchor = &prev->pNext;
 	}
 	*anchor      = n;
+	MarkWorldLayer(iMapIndex, LAND_START_INDEX);
 	n->pPrevNode = prev;
 
 	ResetSpecificLayerOptimizing(TILES_DYNAMIC_LAND);
@@ -261,6 +365,7 @@ void AddLandToHead(const UINT32 iMapIndex, const UINT16 usIndex)
 	n->pNext     = *head;
 	n->pPrevNode = NULL;
 	*head = n;
+	MarkWorldLayer(iMapIndex, LAND_START_INDEX);
 
 	if (usIndex < NUMBEROFTILES && gTileDatabase[usIndex].ubFullTile)
 	{
@@ -306,7 +411,7 @@ static void RemoveLandEx(UINT32 iMapIndex, UINT16 usIndex)
 				pLand->pNext->pPrevNode = pLand->pPrevNode;
 			}
 
-			MemFree(pLand);
+			FreeLevelNode(pLand);
 			break;
 		}
 	}
@@ -517,7 +622,7 @@ static LEVELNODE* AddNodeToWorld(UINT32 const iMapIndex, UINT16 const usIndex, I
 
 	if (AddStructureToWorld(iMapIndex, level, sr, n)) return n;
 
-	MemFree(n);
+	FreeLevelNode(n);
 	throw FailedToAddNode();
 }
 
@@ -532,6 +637,7 @@ static LEVELNODE* AddStructToTailCommon(UINT32 const map_idx, UINT16 const idx,
 	LEVELNODE** anchor = &me.pStructHead;
 	while (*anchor) anchor = &(*anchor)->pNext;
 	*anchor = n;
+	MarkWorldLayer(map_idx, STRUCT_START_INDEX);
 
 	if (idx < NUMBEROFTILES)
 	{
@@ -589,6 +695,7 @@ void AddStructToHead(UINT32 const map_idx, UINT16 const idx)
 	LEVELNODE** const head = &me.pStructHead;
 	n->pNext = *head;
 	*head = n;
+	MarkWorldLayer(map_idx, STRUCT_START_INDEX);
 
 	if (idx < NUMBEROFTILES)
 	{
@@ -693,7 +800,7 @@ void ForceRemoveStructFromTail(UINT32 const iMapIndex)
 			//If we have to, make sure to remove this node when we reload the map from a saved game
 			RemoveStructFromMapTempFile(iMapIndex, usIndex);
 
-			MemFree(pStruct);
+			FreeLevelNode(pStruct);
 
 			RemoveShadowBuddy(iMapIndex, usIndex);
 			return;
@@ -718,7 +825,7 @@ static void InternalRemoveStruct(UINT32 const map_idx, LEVELNODE** const anchor)
 	RemoveStructFromMapTempFile(map_idx, idx);
 
 	RemoveShadowBuddy(map_idx, idx);
-	MemFree(removee);
+	FreeLevelNode(removee);
 }
 
 
@@ -908,7 +1015,7 @@ void HideStructOfGivenType(UINT32 const iMapIndex, UINT32 const fType, BOOLEAN c
 	else
 	{
 		// ONLY UNHIDE IF NOT REAVEALED ALREADY
-		if (!(gpWorldLevelData[iMapIndex].uiFlags & MAPELEMENT_REVEALED))
+		if (!IsTileRevealed(iMapIndex))
 		{
 			RemoveRoofIndexFlagsFromTypeRange(iMapIndex, fType, fType, LEVELNODE_HIDDEN);
 		}
@@ -928,6 +1035,7 @@ void AddShadowToTail(UINT32 const iMapIndex, UINT16 const usIndex)
 	LEVELNODE** anchor = &gpWorldLevelData[iMapIndex].pShadowHead;
 	while (*anchor != NULL) anchor = &(*anchor)->pNext;
 	*anchor = n;
+	MarkWorldLayer(iMapIndex, SHADOW_START_INDEX);
 
 	ResetSpecificLayerOptimizing(TILES_DYNAMIC_SHADOWS);
 }
@@ -957,6 +1065,7 @@ LEVELNODE* AddShadowToHead(const UINT32 iMapIndex, const UINT16 usIndex)
 	LEVELNODE** const head = &gpWorldLevelData[iMapIndex].pShadowHead;
 	n->pNext = *head;
 	*head = n;
+	MarkWorldLayer(iMapIndex, SHADOW_START_INDEX);
 
 	ResetSpecificLayerOptimizing(TILES_DYNAMIC_SHADOWS);
 	return n;
@@ -983,7 +1092,8 @@ static BOOLEAN RemoveShadow(UINT32 iMapIndex, UINT16 usIndex)
 				pOldShadow->pNext = pShadow->pNext;
 			}
 
-			MemFree(pShadow);
+			if (pShadow->uiFlags & LEVELNODE_EXITGRID) UpdateExitGridOfTile(iMapIndex);
+			FreeLevelNode(pShadow);
 			return TRUE;
 		}
 
@@ -1014,7 +1124,8 @@ BOOLEAN RemoveShadowFromLevelNode(UINT32 iMapIndex, LEVELNODE* pNode)
 				pOldShadow->pNext = pShadow->pNext;
 			}
 
-			MemFree(pShadow);
+			if (pShadow->uiFlags & LEVELNODE_EXITGRID) UpdateExitGridOfTile(iMapIndex);
+			FreeLevelNode(pShadow);
 			return TRUE;
 		}
 
@@ -1097,6 +1208,7 @@ LEVELNODE* AddMercToHead(UINT32 const iMapIndex, SOLDIERTYPE& s, BOOLEAN const f
 	}
 
 	gpWorldLevelData[iMapIndex].pMercHead = pNextMerc;
+	MarkWorldLayer(iMapIndex, MERC_START_INDEX);
 
 	ResetSpecificLayerOptimizing(TILES_DYNAMIC_MERCS | TILES_DYNAMIC_STRUCT_MERCS | TILES_DYNAMIC_HIGHMERCS);
 	return pNextMerc;
@@ -1212,7 +1324,7 @@ void RemoveMerc(UINT32 const map_idx, SOLDIERTYPE& s, bool const placeholder)
 			DeleteStructureFromWorld(merc->pStructureData);
 		}
 
-		MemFree(merc);
+		FreeLevelNode(merc);
 		break;
 	}
 	// XXX exception?
@@ -1238,6 +1350,7 @@ LEVELNODE* AddRoofToTail(const UINT32 iMapIndex, const UINT16 usIndex)
 	LEVELNODE** anchor = &gpWorldLevelData[iMapIndex].pRoofHead;
 	while (*anchor != NULL) anchor = &(*anchor)->pNext;
 	*anchor = n;
+	MarkWorldLayer(iMapIndex, ROOF_START_INDEX);
 
 	return n;
 }
@@ -1251,6 +1364,7 @@ LEVELNODE* AddRoofToHead(const UINT32 iMapIndex, const UINT16 usIndex)
 	LEVELNODE** const head = &gpWorldLevelData[iMapIndex].pRoofHead;
 	n->pNext = *head;
 	*head = n;
+	MarkWorldLayer(iMapIndex, ROOF_START_INDEX);
 
 	return n;
 }
@@ -1277,7 +1391,7 @@ BOOLEAN RemoveRoof(UINT32 iMapIndex, UINT16 usIndex)
 			}
 
 			DeleteStructureFromWorld(pRoof->pStructureData);
-			MemFree(pRoof);
+			FreeLevelNode(pRoof);
 			return TRUE;
 		}
 
@@ -1405,6 +1519,7 @@ LEVELNODE* AddOnRoofToTail(const UINT32 iMapIndex, const UINT16 usIndex)
 	LEVELNODE** anchor = &gpWorldLevelData[iMapIndex].pOnRoofHead;
 	while (*anchor != NULL) anchor = &(*anchor)->pNext;
 	*anchor = n;
+	MarkWorldLayer(iMapIndex, ONROOF_START_INDEX);
 
 	return n;
 }
@@ -1418,6 +1533,7 @@ LEVELNODE* AddOnRoofToHead(const UINT32 iMapIndex, const UINT16 usIndex)
 	LEVELNODE** const head = &gpWorldLevelData[iMapIndex].pOnRoofHead;
 	n->pNext = *head;
 	*head = n;
+	MarkWorldLayer(iMapIndex, ONROOF_START_INDEX);
 
 	return n;
 }
@@ -1444,7 +1560,7 @@ BOOLEAN RemoveOnRoof(UINT32 iMapIndex, UINT16 usIndex)
 				pOldOnRoof->pNext = pOnRoof->pNext;
 			}
 
-			MemFree(pOnRoof);
+			FreeLevelNode(pOnRoof);
 			return TRUE;
 		}
 
@@ -1476,7 +1592,7 @@ BOOLEAN RemoveOnRoofFromLevelNode( UINT32 iMapIndex, LEVELNODE *pNode )
 				pOldOnRoof->pNext = pOnRoof->pNext;
 			}
 
-			MemFree(pOnRoof);
+			FreeLevelNode(pOnRoof);
 			return TRUE;
 		}
 
@@ -1532,6 +1648,7 @@ LEVELNODE* AddTopmostToTail(const UINT32 iMapIndex, const UINT16 usIndex)
 	LEVELNODE** anchor = &gpWorldLevelData[iMapIndex].pTopmostHead;
 	while (*anchor != NULL) anchor = &(*anchor)->pNext;
 	*anchor = n;
+	MarkWorldLayer(iMapIndex, TOPMOST_START_INDEX);
 
 	ResetSpecificLayerOptimizing(TILES_DYNAMIC_TOPMOST);
 	return n;
@@ -1561,6 +1678,7 @@ LEVELNODE* AddTopmostToHead(const UINT32 iMapIndex, const UINT16 usIndex)
 	LEVELNODE** const head = &gpWorldLevelData[iMapIndex].pTopmostHead;
 	n->pNext = *head;
 	*head = n;
+	MarkWorldLayer(iMapIndex, TOPMOST_START_INDEX);
 
 	ResetSpecificLayerOptimizing(TILES_DYNAMIC_TOPMOST);
 	return n;
@@ -1587,7 +1705,7 @@ BOOLEAN RemoveTopmost(UINT32 iMapIndex, UINT16 usIndex)
 				pOldTopmost->pNext = pTopmost->pNext;
 			}
 
-			MemFree(pTopmost);
+			FreeLevelNode(pTopmost);
 			return TRUE;
 		}
 
@@ -1619,7 +1737,7 @@ BOOLEAN RemoveTopmostFromLevelNode(UINT32 iMapIndex, LEVELNODE* pNode)
 				pOldTopmost->pNext = pTopmost->pNext;
 			}
 
-			MemFree(pTopmost);
+			FreeLevelNode(pTopmost);
 			return TRUE;
 		}
 
@@ -1676,7 +1794,7 @@ BOOLEAN IsRoofVisible(INT16 sMapPos)
 	const STRUCTURE* pStructure = FindStructure(sMapPos, STRUCTURE_ROOF);
 	return
 		pStructure != NULL &&
-		!(gpWorldLevelData[sMapPos].uiFlags & MAPELEMENT_REVEALED);
+		!IsTileRevealed(sMapPos);
 }
 
 
@@ -1688,7 +1806,7 @@ BOOLEAN IsRoofVisible2(INT16 sMapPos)
 		if (pStructure == NULL) return FALSE;
 	}
 
-	return !(gpWorldLevelData[sMapPos].uiFlags & MAPELEMENT_REVEALED);
+	return !IsTileRevealed(sMapPos);
 }
 
 
@@ -8,6 +8,24 @@
 // memory-accounting function
 void CountLevelNodes( void );
 
+/* Level nodes come from a pool, whose nodes are all given back at once by
+ * ResetLevelNodes(), so they must not be allocated or freed in any other way.
+ * FreeLevelNodeSlabs() also releases the memory of the pool. */
+LEVELNODE* AllocLevelNode();
+void       FreeLevelNode(LEVELNODE*);
+void       ResetLevelNodes();
+void       FreeLevelNodeSlabs();
+
+/* Layers of every tile which may hold level nodes, one bit per index into
+ * MAP_ELEMENT::pLevelNodes, so the renderer can skip empty layers without
+ * touching the map element. A bit is set whenever a node is added to the
+ * layer, and only cleared by UpdateWorldLayers(), so a set bit does not mean
+ * the layer is not empty. Code which links nodes into the world besides the
+ * functions here must call UpdateWorldLayers(). */
+extern UINT16 gusWorldLayers[WORLD_MAX];
+
+void UpdateWorldLayers(UINT32 map_idx);
+
 
 class FailedToAddNode : public std::exception
 {
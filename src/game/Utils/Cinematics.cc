@@ -8,6 +8,7 @@
 //------------------------------------------------------------------------------
 
 #include <cmath>
+#include <string.h>
 #include <vector>
 
 #include <SDL.h>
@@ -24,6 +25,7 @@ extern "C" {
 #include "sgp/VObject.h"
 #include "sgp/VSurface.h"
 #include "sgp/SoundMan.h"
+#include "sgp/Timer.h"
 
 struct SMKFLIC
 {
@@ -37,6 +39,9 @@ struct SMKFLIC
 	UINT32 frame_no;
 	double milliseconds_per_frame;
 	char status;
+	bool palette_valid;              // palette16 has been converted from palette_rgb
+	unsigned char palette_rgb[256 * 3]; // the smacker palette palette16 was converted from
+	UINT16 palette16[256];
 };
 
 
@@ -164,7 +169,7 @@ SMKFLIC* SmkPlayFlic(const char* const filename, const UINT32 left, const UINT32
 	status = smk_enable_all(sf->smacker, SMK_VIDEO_TRACK);
 	Assert(status == 0);
 	sf->status = smk_first(sf->smacker);
-	sf->start_tick = SDL_GetTicks();
+	sf->start_tick = GetClock();
 	sf->frame_no = 0;
 	for (uint8_t i = 0; i < 7; i++)
 	{
@@ -209,6 +214,7 @@ static SMKFLIC* SmkOpenFlic(const char* const filename)
 		// open with smacker
 		sf->smacker = smk_open_memory(sf->file_in_memory, bytes);
 		if (sf->smacker == nullptr) throw new std::runtime_error("smk_open_memory failed");
+		sf->palette_valid = false;
 		sf->flags |= SMK_FLIC_OPEN;
 		return sf;
 	}
@@ -261,7 +267,7 @@ static SMKFLIC* SmkGetFreeFlic(void)
 static void SmkSkipFrames(SMKFLIC* sf)
 {
 	// get target frame
-	UINT32 milliseconds = SDL_GetTicks() - sf->start_tick;
+	UINT32 milliseconds = GetClock() - sf->start_tick;
 	UINT32 frame_no = static_cast<UINT32>(milliseconds / sf->milliseconds_per_frame);
 
 	// skip until the target frame (video repeats if there is a ring frame)
@@ -287,13 +293,18 @@ static void SmkBlitVideoFrame(SMKFLIC* const sf, SGPVSurface* surface)
 	if (src_palette == nullptr) return;
 	if (smk_info_video(sf->smacker, &src_width, &src_height, nullptr) < 0) return;
 
-	// convert palette
-	UINT16 palette[256];
-	for (int i = 0; i < 256; i++)
+	// convert palette, only when the video changed it
+	if (!sf->palette_valid || memcmp(sf->palette_rgb, src_palette, sizeof(sf->palette_rgb)) != 0)
 	{
-		unsigned char* rgb = src_palette + i * 3;
-		palette[i] = Get16BPPColor(FROMRGB(rgb[0], rgb[1], rgb[2]));
+		memcpy(sf->palette_rgb, src_palette, sizeof(sf->palette_rgb));
+		for (int i = 0; i < 256; i++)
+		{
+			unsigned char* rgb = src_palette + i * 3;
+			sf->palette16[i] = Get16BPPColor(FROMRGB(rgb[0], rgb[1], rgb[2]));
+		}
+		sf->palette_valid = true;
 	}
+	UINT16 const* const palette = sf->palette16;
 
 	// get surface (destination)
 	SGPVSurface::Lock lock(surface);
@@ -66,6 +66,7 @@ void InitializeFonts(void)
 
 void ShutdownFonts(void)
 {
+	ClearTextCache();
 	UnloadFont(gp10PointArial);
 	UnloadFont(gp10PointArialBold);
 	UnloadFont(gp12PointArial);
@@ -105,8 +105,8 @@ static void BlitString(VIDEO_OVERLAY* pBlitter)
 	if (fScrollMessagesHidden) return;
 
 	SetFontAttributes(pBlitter->uiFontID, pBlitter->ubFontFore, DEFAULT_SHADOW, pBlitter->ubFontBack);
-	SGPVSurface::Lock l(pBlitter->uiDestBuff);
-	MPrintBuffer(l.Buffer<UINT16>(), l.Pitch(), pBlitter->sX, pBlitter->sY, pBlitter->zText);
+	// The messages stay on screen for many frames, so keep them rendered
+	MPrintCached(pBlitter->uiDestBuff, pBlitter->sX, pBlitter->sY, pBlitter->zText);
 }
 
 
@@ -3,10 +3,13 @@
 #include "Quantize.h"
 
 #include <algorithm>
+#include <vector>
 
 
 #define COLOUR_BITS   6
 #define MAX_COLOURS 255
+#define NODE_SLAB_SIZE 512
+#define NO_COLOUR     255 // never a palette index, as there are at most MAX_COLOURS
 
 
 struct NODE
@@ -21,13 +24,35 @@ struct NODE
 };
 
 
-static UINT  g_leaf_count;
-static NODE* g_reducible_nodes[COLOUR_BITS];
+// Per thread, so images can be quantized in parallel
+static thread_local UINT  g_leaf_count;
+static thread_local NODE* g_reducible_nodes[COLOUR_BITS];
+
+/* The nodes of a tree are taken from slabs, and the children a reduction drops
+ * go on a free list linked through pNext. The slabs are freed all at once when
+ * the image is done. */
+static thread_local std::vector<NODE*> g_node_slabs;
+static thread_local size_t             g_node_slab_used = NODE_SLAB_SIZE; // nodes taken from the last slab
+static thread_local NODE*              g_free_nodes;
 
 
 static NODE* CreateNode(const UINT level)
 {
-	NODE* const node = MALLOCZ(NODE);
+	NODE* node = g_free_nodes;
+	if (node)
+	{
+		g_free_nodes = node->pNext;
+	}
+	else
+	{
+		if (g_node_slab_used == NODE_SLAB_SIZE)
+		{
+			g_node_slabs.push_back(MALLOCN(NODE, NODE_SLAB_SIZE));
+			g_node_slab_used = 0;
+		}
+		node = &g_node_slabs.back()[g_node_slab_used++];
+	}
+	*node = NODE{};
 
 	node->bIsLeaf = level == COLOUR_BITS;
 	if (node->bIsLeaf)
@@ -94,7 +119,8 @@ static void ReduceTree(void)
 			nGreenSum += child->nGreenSum;
 			nBlueSum  += child->nBlueSum;
 			node->nPixelCount += child->nPixelCount;
-			free(child);
+			child->pNext = g_free_nodes;
+			g_free_nodes = child;
 			node->pChild[i] = NULL;
 			++nChildren;
 		}
@@ -143,42 +169,54 @@ static size_t GetPaletteColors(const NODE* const pTree, SGPPaletteEntry* const p
 }
 
 
-static void DeleteTree(NODE* const node)
+static void DeleteTree()
 {
-	for (int i = 0; i < 8; i++)
+	for (NODE* const slab : g_node_slabs) MemFree(slab);
+	g_node_slabs.clear();
+	g_node_slab_used = NODE_SLAB_SIZE;
+	g_free_nodes     = NULL;
+}
+
+
+static UINT8 ClosestColor(const BYTE r, const BYTE g, const BYTE b, const INT16 sNumColors, const SGPPaletteEntry* const pTable)
+{
+	INT32  best        = 0;
+	UINT32 lowest_dist = 9999999;
+	for (INT32 cnt = 0; cnt < sNumColors; ++cnt)
 	{
-		NODE* const child = node->pChild[i];
-		if (child != NULL) DeleteTree(child);
+		const SGPPaletteEntry* const p = &pTable[cnt];
+		const INT32  dr   = r - p->r;
+		const INT32  dg   = g - p->g;
+		const INT32  db   = b - p->b;
+		const UINT32 dist = dr * dr + dg * dg + db * db;
+		if (dist < lowest_dist)
+		{
+			lowest_dist = dist;
+			best        = cnt;
+		}
 	}
-	free(node);
+	return best;
 }
 
 
+/* Maps the pixels through an inverse colour map with COLOUR_BITS per channel,
+ * the resolution the tree was built with. A cell is filled with the colour
+ * closest to its centre the first time a pixel falls into it. */
 static void MapPalette(UINT8* const pDest, const SGPPaletteEntry* const pSrc, const INT16 sWidth, const INT16 sHeight, const INT16 sNumColors, const SGPPaletteEntry* pTable)
 {
-	for (size_t i = sWidth * sHeight; i != 0; --i)
+	const UINT shift = 8 - COLOUR_BITS;
+	const UINT half  = 1 << shift >> 1;
+	std::vector<UINT8> inverse(1 << 3 * COLOUR_BITS, NO_COLOUR);
+	for (size_t i = 0; i != (size_t)sWidth * sHeight; ++i)
 	{
-		// For each palette entry, find closest
-		INT32  best        = 0;
-		UINT32 lowest_dist = 9999999;
-		for (INT32 cnt = 0; cnt < sNumColors; ++cnt)
+		const SGPPaletteEntry& c    = pSrc[i];
+		const UINT             cell = (c.r >> shift) << 2 * COLOUR_BITS | (c.g >> shift) << COLOUR_BITS | c.b >> shift;
+		UINT8&                 idx  = inverse[cell];
+		if (idx == NO_COLOUR)
 		{
-			const SGPPaletteEntry* const a = &pSrc[i];
-			const SGPPaletteEntry* const b = &pTable[cnt];
-			const INT32  dr   = a->r - b->r;
-			const INT32  dg   = a->g - b->g;
-			const INT32  db   = a->b - b->b;
-			const UINT32 dist = dr * dr + dg * dg + db * db;
-			if (dist < lowest_dist)
-			{
-				lowest_dist = dist;
-				best        = cnt;
-			}
+			idx = ClosestColor(c.r >> shift << shift | half, c.g >> shift << shift | half, c.b >> shift << shift | half, sNumColors, pTable);
 		}
-
-		// Now we have the lowest value
-		// Set into dest
-		pDest[i] = best;
+		pDest[i] = idx;
 	}
 }
 
@@ -192,7 +230,7 @@ void QuantizeImage(UINT8* const pDest, const SGPPaletteEntry* const pSrc, const
 
 	std::fill_n(pPalette, 256, SGPPaletteEntry{});
 	GetPaletteColors(tree, pPalette, 0);
-	DeleteTree(tree);
+	DeleteTree();
 
 	// Then map image to palette
 	MapPalette(pDest, pSrc, sWidth, sHeight, g_leaf_count, pPalette);
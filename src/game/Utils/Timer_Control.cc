@@ -4,6 +4,7 @@
 #include "Debug.h"
 #include "MapScreen.h"
 #include "Soldier_Control.h"
+#include "Timer.h"
 #include "Timer_Control.h"
 #include "Overhead.h"
 #include "Handle_Items.h"
@@ -56,6 +57,9 @@ CUSTOMIZABLE_TIMER_CALLBACK gpCustomizableTimerCallback = 0;
 // Clock Callback event ID
 static SDL_TimerID g_timer;
 
+// GetClock() up to which the JA2 clock has been advanced while the clock is fixed
+static UINT32 g_fixed_clock_done;
+
 
 extern UINT32 guiCompressionStringBaseTime;
 extern INT32  giFlashHighlightedItemBaseTime;
@@ -70,7 +74,7 @@ extern UINT32 guiFlashCursorBaseTime;
 extern INT32  giPotCharPathBaseTime;
 
 
-static UINT32 TimeProc(UINT32 const interval, void*)
+static void AdvanceJA2Clock()
 {
 	if (!gfPauseClock)
 	{
@@ -108,7 +112,6 @@ static UINT32 TimeProc(UINT32 const interval, void*)
 			FOR_EACH_MERC(i)
 			{
 				SOLDIERTYPE* const s = *i;
-				UPDATETIMECOUNTER(s->UpdateCounter);
 				UPDATETIMECOUNTER(s->DamageCounter);
 				UPDATETIMECOUNTER(s->BlinkSelCounter);
 				UPDATETIMECOUNTER(s->PortraitFlashCounter);
@@ -120,7 +123,13 @@ static UINT32 TimeProc(UINT32 const interval, void*)
 		}
 #endif
 	}
+}
 
+
+static UINT32 TimeProc(UINT32 const interval, void*)
+{
+	// A fixed clock is followed by UpdateFixedJA2Clock() instead
+	if (!ClockIsFixed()) AdvanceJA2Clock();
 	return interval;
 }
 
@@ -136,6 +145,8 @@ void InitializeJA2Clock(void)
 		giTimerCounters[i] = giTimerIntervals[i];
 	}
 
+	g_fixed_clock_done = GetClock();
+
 	g_timer = SDL_AddTimer(BASETIMESLICE, TimeProc, 0);
 	if (!g_timer) throw std::runtime_error("Could not create timer callback");
 #endif
@@ -150,6 +161,26 @@ void ShutdownJA2Clock(void)
 }
 
 
+void UpdateFixedJA2Clock(void)
+{
+#ifdef CALLBACKTIMER
+	if (!ClockIsFixed()) return;
+	while (GetClock() - g_fixed_clock_done >= BASETIMESLICE)
+	{
+		g_fixed_clock_done += BASETIMESLICE;
+		AdvanceJA2Clock();
+	}
+#endif
+}
+
+
+void SetJA2ClockFixed(bool const fixed)
+{
+	SetClockFixed(fixed);
+	g_fixed_clock_done = GetClock();
+}
+
+
 void PauseTime(BOOLEAN const fPaused)
 {
 	gfPauseClock = fPaused;
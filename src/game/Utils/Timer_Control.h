@@ -54,6 +54,13 @@ extern INT32 giTimerTeamTurnUpdate;
 void InitializeJA2Clock(void);
 void ShutdownJA2Clock(void);
 
+/* While the clock is fixed (see ClockIsFixed()) the JA2 clock is not driven by
+ * a timer, but catches up with GetClock() here once per game cycle. */
+void UpdateFixedJA2Clock(void);
+
+/* Fixes the clock, or lets it run again, while the JA2 clock is running. */
+void SetJA2ClockFixed(bool fixed);
+
 #define GetJA2Clock() guiBaseJA2Clock
 
 void PauseTime( BOOLEAN fPaused );
@@ -99,6 +106,12 @@ extern CUSTOMIZABLE_TIMER_CALLBACK gpCustomizableTimerCallback;
 
 #endif
 
+/* A deadline on the JA2 clock for the counters which are checked too often to
+ * have the clock count them down. It is reached after as many time slices as
+ * such a counter, reset to the same delay, would have taken to run out. */
+#define RESETTIMEDEADLINE(c, d) ((c) = GetJA2Clock() + ((d) <= 0 ? ((d) < 0 ? BASETIMESLICE : 0) : ((d) + BASETIMESLICE - 1) / BASETIMESLICE * BASETIMESLICE))
+#define TIMEDEADLINEDONE(c)     ((INT32)(GetJA2Clock() - (c)) >= 0)
+
 // whenever guiBaseJA2Clock changes, we must reset all the timer variables that
 // use it as a reference
 void ResetJA2ClockGlobalTimers(void);
@@ -6,6 +6,9 @@
 #include "MemMan.h"
 #include "VSurface.h"
 
+#include <string>
+#include <vector>
+
 
 static WRAPPED_STRING* AllocWrappedString(const wchar_t* start, const wchar_t* end)
 {
@@ -18,12 +21,67 @@ static WRAPPED_STRING* AllocWrappedString(const wchar_t* start, const wchar_t* e
 }
 
 
-WRAPPED_STRING* LineWrap(SGPFont const font, UINT16 const usLineWidthPixels, wchar_t const* const pString)
+/* Layouts of recently measured strings. Text heavy screens lay out the same
+ * strings every frame, so a string is only measured again when it, its font or
+ * the width changes. The cache is direct-mapped by a hash of the key. */
+#define LAYOUT_CACHE_SIZE 256
+
+enum LayoutKind
 {
-	size_t const max_w = usLineWidthPixels;
+	LAYOUT_LINE_WRAP,   // line breaks of LineWrap()
+	LAYOUT_IAN_HEIGHT   // result of IanWrappedStringHeight()
+};
 
-	WRAPPED_STRING*  head   = 0;
-	WRAPPED_STRING** anchor = &head;
+struct TextLayout
+{
+	SGPFont             font;
+	UINT16              width;
+	UINT8               gap;
+	LayoutKind          kind;
+	std::wstring        text;
+	std::vector<UINT32> lines;  // start and end offset of each line
+	UINT16              height;
+};
+
+static TextLayout g_layouts[LAYOUT_CACHE_SIZE];
+
+
+/* Returns the cache slot of a layout. If it holds a different layout, it is
+ * reset to the key and hit is false. */
+static TextLayout& LookUpLayout(SGPFont const font, UINT16 const width, UINT8 const gap, LayoutKind const kind, wchar_t const* const str, bool& hit)
+{
+	// FNV-1a
+	UINT32 h = 2166136261U;
+	size_t len = 0;
+	for (; str[len] != L'\0'; ++len) h = (h ^ static_cast<UINT32>(str[len])) * 16777619U;
+	h = (h ^ static_cast<UINT32>(reinterpret_cast<uintptr_t>(font) >> 4)) * 16777619U;
+	h = (h ^ (width << 8 | gap << 1 | kind)) * 16777619U;
+
+	TextLayout& l = g_layouts[h % LAYOUT_CACHE_SIZE];
+	hit =
+		l.font  == font  &&
+		l.width == width &&
+		l.gap   == gap   &&
+		l.kind  == kind  &&
+		l.text.size() == len &&
+		l.text.compare(0, len, str, len) == 0;
+	if (!hit)
+	{
+		l.font   = font;
+		l.width  = width;
+		l.gap    = gap;
+		l.kind   = kind;
+		l.text.assign(str, len);
+		l.lines.clear();
+		l.height = 0;
+	}
+	return l;
+}
+
+
+static void MeasureLineWrap(SGPFont const font, UINT16 const usLineWidthPixels, wchar_t const* const pString, std::vector<UINT32>& lines)
+{
+	size_t const max_w = usLineWidthPixels;
 
 	wchar_t const* i = pString;
 	while (*i == L' ') ++i; // Skip leading spaces
@@ -49,10 +107,10 @@ WRAPPED_STRING* LineWrap(SGPFont const font, UINT16 const usLineWidthPixels, wch
 		{
 			if (line_start != i) // Append last line
 			{
-				WRAPPED_STRING* const ws = AllocWrappedString(line_start, i);
-				*anchor = ws;
+				lines.push_back(UINT32(line_start - pString));
+				lines.push_back(UINT32(i          - pString));
 			}
-			return head;
+			return;
 		}
 		size_t const w = GetCharWidth(font, *i);
 		word_w += w;
@@ -65,9 +123,8 @@ WRAPPED_STRING* LineWrap(SGPFont const font, UINT16 const usLineWidthPixels, wch
 				word_start = i;
 				word_w     = 0;
 			}
-			WRAPPED_STRING* const ws = AllocWrappedString(line_start, line_end);
-			*anchor    = ws;
-			anchor     = &ws->pNextWrappedString;
+			lines.push_back(UINT32(line_start - pString));
+			lines.push_back(UINT32(line_end   - pString));
 			line_start = word_start;
 			line_end   = word_start;
 			line_w     = word_w;
@@ -82,6 +139,24 @@ WRAPPED_STRING* LineWrap(SGPFont const font, UINT16 const usLineWidthPixels, wch
 }
 
 
+WRAPPED_STRING* LineWrap(SGPFont const font, UINT16 const usLineWidthPixels, wchar_t const* const pString)
+{
+	bool hit;
+	TextLayout& l = LookUpLayout(font, usLineWidthPixels, 0, LAYOUT_LINE_WRAP, pString, hit);
+	if (!hit) MeasureLineWrap(font, usLineWidthPixels, pString, l.lines);
+
+	WRAPPED_STRING*  head   = 0;
+	WRAPPED_STRING** anchor = &head;
+	for (size_t i = 0; i != l.lines.size(); i += 2)
+	{
+		WRAPPED_STRING* const ws = AllocWrappedString(pString + l.lines[i], pString + l.lines[i + 1]);
+		*anchor = ws;
+		anchor  = &ws->pNextWrappedString;
+	}
+	return head;
+}
+
+
 // Pass in, the x,y location for the start of the string,
 //					the width of the buffer
 //					the gap in between the lines
@@ -141,6 +216,10 @@ void DrawTextToScreen(wchar_t const* const str, UINT16 x, UINT16 const y, UINT16
 	{
 		GDirtyPrint(x, y, str);
 	}
+	else if (flags & CACHE_TEXT)
+	{
+		MPrintCached(x, y, str);
+	}
 	else
 	{
 		MPrint(x, y, str);
@@ -365,8 +444,20 @@ void CleanOutControlCodesFromString(wchar_t const* const src, wchar_t* const dst
 }
 
 
+static UINT16 MeasureIanWrappedStringHeight(UINT16 max_w, UINT8 gap, SGPFont, wchar_t const* str);
+
+
 // now variant for grabbing height
 UINT16 IanWrappedStringHeight(UINT16 const max_w, UINT8 const gap, SGPFont const font, wchar_t const* const str)
+{
+	bool hit;
+	TextLayout& l = LookUpLayout(font, max_w, gap, LAYOUT_IAN_HEIGHT, str, hit);
+	if (!hit) l.height = MeasureIanWrappedStringHeight(max_w, gap, font, str);
+	return l.height;
+}
+
+
+static UINT16 MeasureIanWrappedStringHeight(UINT16 const max_w, UINT8 const gap, SGPFont const font, wchar_t const* const str)
 {
 	UINT16  line_w             = 0;
 	UINT16  n_lines            = 1;
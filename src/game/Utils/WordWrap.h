@@ -26,6 +26,7 @@ UINT16 IanDisplayWrappedString(UINT16 usPosX, UINT16 usPosY, UINT16 usWidth, UIN
 #define DONT_DISPLAY_TEXT	0x00000020 //Wont display the text.  Used if you just want to get how many lines will be displayed
 
 #define MARK_DIRTY		0x00000040
+#define CACHE_TEXT		0x00000080 // Static text, draw it with MPrintCached()
 
 
 #define IAN_WRAP_NO_SHADOW	32
@@ -0,0 +1,376 @@
+#include "FileMan.h"
+#include "HImage.h"
+#include "ImpTGA.h"
+#include "Logger.h"
+#include "MemMan.h"
+#include "PCX.h"
+#include "Quantize.h"
+#include "RustInterface.h"
+#include "STCI.h"
+#include "STIConvert.h"
+#include "Types.h"
+#include "WorkerPool.h"
+
+#include "boost/filesystem.hpp"
+
+#include <SDL.h>
+
+#include <algorithm>
+#include <exception>
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+namespace fs = boost::filesystem;
+
+
+struct ConvertJob
+{
+	fs::path    src;
+	fs::path    dst;   // the extension is the format to convert to
+	std::string error; // empty if the conversion succeeded
+};
+
+
+static std::string Lowercase(std::string s)
+{
+	std::transform(s.begin(), s.end(), s.begin(), ::tolower);
+	return s;
+}
+
+
+static void WriteIndexedSTI(SGPImage const& img, UINT8* const pixels, SGPPaletteEntry* const palette, fs::path const& dst)
+{
+	if (img.usWidth > 0x7FFF || img.usHeight > 0x7FFF)
+	{
+		throw std::runtime_error("Image is too large for an STI file");
+	}
+	WriteSTIFile(pixels, palette, img.usWidth, img.usHeight, dst.string().c_str(), CONVERT_ETRLE_COMPRESS, 0);
+	if (!fs::exists(dst)) throw std::runtime_error("Failed to write the STI file");
+}
+
+
+static void ConvertPCXToSTI(fs::path const& src, fs::path const& dst)
+{
+	AutoSGPFile        f(FileMan::openForReading(src.string()));
+	AutoSGPImage const img(LoadPCXImage(f, IMAGE_ALLDATA));
+	WriteIndexedSTI(*img, img->pImageData, img->pPalette, dst);
+}
+
+
+/* The pixels are quantized to 255 colours, which go to the palette after
+ * index 0, as that one is transparent in STI files. */
+static void ConvertTGAToSTI(fs::path const& src, fs::path const& dst)
+{
+	AutoSGPFile        f(FileMan::openForReading(src.string()));
+	AutoSGPImage const img(LoadTGAImage(f, IMAGE_BITMAPDATA));
+
+	size_t const n = static_cast<size_t>(img->usWidth) * img->usHeight;
+	SGP::Buffer<SGPPaletteEntry> rgb(n);
+	UINT8 const* const data = img->pImageData;
+	for (size_t i = 0; i != n; ++i)
+	{
+		SGPPaletteEntry& c = rgb[i];
+		if (img->ubBitDepth == 16)
+		{ // 5-6-5, as the game keeps 16 bit images
+			UINT16 const px = reinterpret_cast<UINT16 const*>(data)[i];
+			c.r = (px >> 11 & 0x1F) << 3;
+			c.g = (px >>  5 & 0x3F) << 2;
+			c.b = (px       & 0x1F) << 3;
+		}
+		else
+		{
+			c.r = data[i * 3    ];
+			c.g = data[i * 3 + 1];
+			c.b = data[i * 3 + 2];
+		}
+		c.a = 0;
+	}
+
+	SGP::Buffer<UINT8> pixels(n);
+	SGPPaletteEntry    quantized[256];
+	QuantizeImage(pixels, rgb, img->usWidth, img->usHeight, quantized);
+
+	SGPPaletteEntry palette[256];
+	palette[0] = SGPPaletteEntry{};
+	std::copy(quantized, quantized + 255, palette + 1);
+	for (size_t i = 0; i != n; ++i) ++pixels[i];
+
+	WriteIndexedSTI(*img, pixels, palette, dst);
+}
+
+
+// Run length encodes a scanline as the game's PCX loader reads it
+static void WritePCXLine(std::vector<UINT8>& out, UINT8 const* const line, UINT16 const w)
+{
+	for (UINT16 x = 0; x != w;)
+	{
+		UINT8 const colour = line[x];
+		UINT8       n      = 1;
+		while (x + n != w && line[x + n] == colour && n != 0x3F) ++n;
+		if (n > 1 || colour >= 0xC0) out.push_back(0xC0 | n);
+		out.push_back(colour);
+		x += n;
+	}
+}
+
+
+static void WritePCXFile(fs::path const& dst, UINT8 const* const pixels, UINT16 const w, UINT16 const h, SGPPaletteEntry const* const palette)
+{
+	// The loader expects no padding at the end of the scanlines
+	BYTE header[128];
+	memset(header, 0, sizeof(header));
+	header[0] = 10; // manufacturer
+	header[1] = 5;  // version
+	header[2] = 1;  // run length encoding
+	header[3] = 8;  // bits per pixel
+	UINT16 const fields[] =
+	{
+		0, 0, static_cast<UINT16>(w - 1), static_cast<UINT16>(h - 1), // window
+		72, 72                                                        // resolution
+	};
+	for (size_t i = 0; i != lengthof(fields); ++i)
+	{
+		header[4 + 2 * i]     = fields[i] & 0xFF;
+		header[4 + 2 * i + 1] = fields[i] >> 8;
+	}
+	header[65] = 1;         // colour planes
+	header[66] = w & 0xFF;  // bytes per line
+	header[67] = w >> 8;
+	header[68] = 1;         // colour palette
+
+	std::vector<UINT8> out(header, header + sizeof(header));
+	for (UINT16 y = 0; y != h; ++y) WritePCXLine(out, pixels + static_cast<size_t>(y) * w, w);
+	out.push_back(0x0C);
+	for (size_t i = 0; i != 256; ++i)
+	{
+		out.push_back(palette[i].r);
+		out.push_back(palette[i].g);
+		out.push_back(palette[i].b);
+	}
+
+	FILE* const f = fopen(dst.string().c_str(), "wb");
+	if (!f) throw std::runtime_error("Failed to open the PCX file for writing");
+	size_t const written = fwrite(&out[0], 1, out.size(), f);
+	fclose(f);
+	if (written != out.size()) throw std::runtime_error("Failed to write the PCX file");
+}
+
+
+static void DecodeETRLE(UINT8 const* src, UINT8* dst, UINT16 const w, UINT16 const h)
+{
+	for (UINT16 y = 0; y != h; ++y)
+	{
+		UINT8* const line = dst + static_cast<size_t>(y) * w;
+		UINT16       x    = 0;
+		for (UINT8 run; (run = *src++) != 0;)
+		{
+			UINT16 const n = run & 0x7F;
+			if (x + n > w) throw std::runtime_error("Corrupt ETRLE data");
+			if (!(run & 0x80))
+			{
+				memcpy(line + x, src, n);
+				src += n;
+			}
+			x += n;
+		}
+	}
+}
+
+
+/* Every subimage goes to a PCX file of its own, named after the STI file and
+ * the number of the subimage if there is more than one. The offsets of the
+ * subimages are lost. */
+static void ConvertSTIToPCX(fs::path const& src, fs::path const& dst)
+{
+	AutoSGPFile        f(FileMan::openForReading(src.string()));
+	AutoSGPImage const img(LoadSTCIImage(f, IMAGE_ALLDATA));
+	if (img->ubBitDepth != 8) throw std::runtime_error("Only indexed STI files can be converted to PCX");
+
+	if (!(img->fFlags & IMAGE_TRLECOMPRESSED))
+	{
+		WritePCXFile(dst, img->pImageData, img->usWidth, img->usHeight, img->pPalette);
+		return;
+	}
+
+	UINT16 const n_objects = img->usNumberOfObjects;
+	for (UINT16 i = 0; i != n_objects; ++i)
+	{
+		ETRLEObject const& o = img->pETRLEObject[i];
+		if (o.usWidth == 0 || o.usHeight == 0) continue;
+		if (o.uiDataOffset >= img->uiSizePixData) throw std::runtime_error("Corrupt subimage offset");
+
+		std::vector<UINT8> pixels(static_cast<size_t>(o.usWidth) * o.usHeight, 0);
+		DecodeETRLE(img->pImageData + o.uiDataOffset, &pixels[0], o.usWidth, o.usHeight);
+
+		fs::path out = dst;
+		if (n_objects > 1)
+		{
+			char suffix[16];
+			snprintf(suffix, lengthof(suffix), "_%03u.pcx", i);
+			out.replace_extension();
+			out += suffix;
+		}
+		WritePCXFile(out, &pixels[0], o.usWidth, o.usHeight, img->pPalette);
+	}
+}
+
+
+static void ConvertImage(UINT const i, void* const ctx)
+{
+	ConvertJob& job = static_cast<ConvertJob*>(ctx)[i];
+	try
+	{
+		std::string const from = Lowercase(job.src.extension().string());
+		if (from == ".sti")
+		{
+			ConvertSTIToPCX(job.src, job.dst);
+		}
+		else if (from == ".tga")
+		{
+			ConvertTGAToSTI(job.src, job.dst);
+		}
+		else
+		{
+			ConvertPCXToSTI(job.src, job.dst);
+		}
+	}
+	catch (std::exception const& e)
+	{
+		job.error = e.what();
+	}
+}
+
+
+// The last parts of the path, as many as it lies levels below the top directory
+static fs::path PathBelow(fs::path const& path, int const level)
+{
+	std::vector<fs::path> const parts(path.begin(), path.end());
+	fs::path below;
+	for (size_t i = parts.size() - level - 1; i != parts.size(); ++i) below /= parts[i];
+	return below;
+}
+
+
+/* Collects the images below src, sorted, so the order of the output and of
+ * the messages does not depend on the file system. */
+static std::vector<ConvertJob> FindImages(fs::path const& src, fs::path const& dst, bool const to_sti, bool const to_pcx)
+{
+	std::vector<ConvertJob> jobs;
+	for (fs::recursive_directory_iterator i(src), end; i != end; ++i)
+	{
+		if (!fs::is_regular_file(i->status())) continue;
+
+		fs::path const&   path = i->path();
+		std::string const ext  = Lowercase(path.extension().string());
+		char const*       to;
+		if ((ext == ".tga" || ext == ".pcx") && to_sti)
+		{
+			to = ".sti";
+		}
+		else if (ext == ".sti" && to_pcx)
+		{
+			to = ".pcx";
+		}
+		else
+		{
+			continue;
+		}
+
+		ConvertJob job;
+		job.src = path;
+		job.dst = dst / PathBelow(path, i.level());
+		job.dst.replace_extension(to);
+		jobs.push_back(job);
+	}
+	std::sort(jobs.begin(), jobs.end(),
+		[](ConvertJob const& a, ConvertJob const& b) { return a.src < b.src; });
+	return jobs;
+}
+
+
+static void PrintUsage()
+{
+	fputs(
+		"Usage: ja2-convert-images [--to-sti | --to-pcx] <source dir> <target dir>\n"
+		"\n"
+		"Converts the TGA and PCX images below the source directory to STI files and\n"
+		"the STI files to PCX images, in parallel. The directory layout is kept.\n"
+		"\n"
+		"  --to-sti  only convert TGA and PCX images to STI files\n"
+		"  --to-pcx  only convert STI files to PCX images\n"
+		"\n"
+		"TGA images are quantized to 255 colours. Every subimage of an STI file goes to\n"
+		"a PCX image of its own, without its offsets.\n",
+		stderr);
+}
+
+
+int main(int argc, char* argv[])
+{
+	bool to_sti = true;
+	bool to_pcx = true;
+	std::vector<char const*> dirs;
+	for (int i = 1; i != argc; ++i)
+	{
+		if (strcmp(argv[i], "--to-sti") == 0)
+		{
+			to_pcx = false;
+		}
+		else if (strcmp(argv[i], "--to-pcx") == 0)
+		{
+			to_sti = false;
+		}
+		else if (argv[i][0] == '-')
+		{
+			PrintUsage();
+			return 1;
+		}
+		else
+		{
+			dirs.push_back(argv[i]);
+		}
+	}
+	if (dirs.size() != 2 || (!to_sti && !to_pcx))
+	{
+		PrintUsage();
+		return 1;
+	}
+
+	Logger_initialize("ja2-convert-images.log");
+	InitializeMemoryManager();
+
+	fs::path const src(dirs[0]);
+	fs::path const dst(dirs[1]);
+	std::vector<ConvertJob> jobs;
+	try
+	{
+		jobs = FindImages(src, dst, to_sti, to_pcx);
+		for (ConvertJob const& job : jobs) fs::create_directories(job.dst.parent_path());
+	}
+	catch (std::exception const& e)
+	{
+		fprintf(stderr, "%s\n", e.what());
+		return 1;
+	}
+
+	uint64_t const start = SDL_GetPerformanceCounter();
+	InitializeWorkerPool();
+	if (!jobs.empty()) RunParallel(static_cast<UINT>(jobs.size()), ConvertImage, &jobs[0]);
+	ShutdownWorkerPool();
+	double const ms = (SDL_GetPerformanceCounter() - start) * 1000.0 / SDL_GetPerformanceFrequency();
+
+	UINT n_failed = 0;
+	for (ConvertJob const& job : jobs)
+	{
+		if (job.error.empty()) continue;
+		fprintf(stderr, "%s: %s\n", job.src.string().c_str(), job.error.c_str());
+		++n_failed;
+	}
+	printf("Converted %u of %u images in %.0f ms using %u threads\n",
+		static_cast<UINT>(jobs.size()) - n_failed, static_cast<UINT>(jobs.size()), ms, WorkerPoolSize());
+
+	ShutdownMemoryManager();
+	return n_failed == 0 ? 0 : 1;
+}
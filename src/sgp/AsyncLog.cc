@@ -0,0 +1,209 @@
+#include "AsyncLog.h"
+#include "Logger.h"
+#include "Types.h"
+
+#include <SDL.h>
+
+#include <atomic>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+
+#define LOG_QUEUE_SIZE        1024 // power of two
+#define LOG_MESSAGE_SIZE      256
+#define LOG_SITES             1024 // power of two
+#define LOG_SITE_PROBES       8
+#define LOG_SITE_RATE         100  // messages per call site and second
+#define LOG_WRITE_INTERVAL_MS 10
+
+
+/* A bounded multi-producer queue after Dmitry Vyukov. A slot is free for the
+ * producer which claims position pos when its sequence is pos, and holds a
+ * message for the writer when its sequence is pos + 1. */
+struct LogSlot
+{
+	std::atomic<size_t> seq;
+	LogLevel            level;
+	char const*         file;       // __FILE__, so it outlives the message
+	UINT32              suppressed; // messages of the site which were suppressed before this one
+	char                message[LOG_MESSAGE_SIZE];
+};
+
+struct LogSite
+{
+	std::atomic<char const*> format;
+	std::atomic<UINT32>      second;
+	std::atomic<UINT32>      count;      // messages in this second
+	std::atomic<UINT32>      suppressed; // messages beyond the rate since the last one written
+};
+
+
+static LogSlot             g_slots[LOG_QUEUE_SIZE];
+static std::atomic<size_t> g_enqueue_pos;
+static size_t              g_dequeue_pos; // only touched by the writer
+static std::atomic<UINT32> g_dropped;
+static LogSite             g_sites[LOG_SITES];
+static SDL_Thread*         g_writer;
+static std::atomic<bool>   g_quit;
+
+
+// NULL if the table is full around the site's place
+static LogSite* FindSite(char const* const format)
+{
+	size_t const h = (reinterpret_cast<uintptr_t>(format) >> 3) * 2654435761u;
+	for (size_t i = 0; i != LOG_SITE_PROBES; ++i)
+	{
+		LogSite&    site     = g_sites[(h + i) & (LOG_SITES - 1)];
+		char const* expected = site.format.load(std::memory_order_relaxed);
+		if (expected == format) return &site;
+		if (!expected && site.format.compare_exchange_strong(expected, format)) return &site;
+		if (expected == format) return &site;
+	}
+	return NULL;
+}
+
+
+/* Whether the site may log another message this second. Gives the number of
+ * messages suppressed since the last one. */
+static bool SiteMayLog(char const* const format, UINT32& suppressed)
+{
+	suppressed = 0;
+	LogSite* const site = FindSite(format);
+	if (!site) return true;
+
+	UINT32 const now = SDL_GetTicks() / 1000;
+	UINT32       sec = site->second.load(std::memory_order_relaxed);
+	if (sec != now && site->second.compare_exchange_strong(sec, now))
+	{
+		site->count.store(0, std::memory_order_relaxed);
+	}
+	if (site->count.fetch_add(1, std::memory_order_relaxed) >= LOG_SITE_RATE)
+	{
+		site->suppressed.fetch_add(1, std::memory_order_relaxed);
+		return false;
+	}
+	suppressed = site->suppressed.exchange(0, std::memory_order_relaxed);
+	return true;
+}
+
+
+static bool EnqueueMessage(LogLevel const level, char const* const file, char const* const format, va_list args)
+{
+	// Errors are often the last word before the game goes down
+	if (level == LogLevel::Error) return false;
+
+	UINT32 suppressed;
+	if (!SiteMayLog(format, suppressed)) return true;
+
+	size_t   pos = g_enqueue_pos.load(std::memory_order_relaxed);
+	LogSlot* slot;
+	for (;;)
+	{
+		slot = &g_slots[pos & (LOG_QUEUE_SIZE - 1)];
+		size_t   const seq  = slot->seq.load(std::memory_order_acquire);
+		intptr_t const diff = (intptr_t)seq - (intptr_t)pos;
+		if (diff == 0)
+		{
+			if (g_enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+		}
+		else if (diff < 0)
+		{
+			// Full
+			g_dropped.fetch_add(1 + suppressed, std::memory_order_relaxed);
+			return true;
+		}
+		else
+		{
+			pos = g_enqueue_pos.load(std::memory_order_relaxed);
+		}
+	}
+
+	slot->level      = level;
+	slot->file       = file;
+	slot->suppressed = suppressed;
+	vsnprintf(slot->message, sizeof(slot->message), format, args);
+	slot->seq.store(pos + 1, std::memory_order_release);
+	return true;
+}
+
+
+static void WriteQueuedMessages()
+{
+	for (;;)
+	{
+		LogSlot& slot = g_slots[g_dequeue_pos & (LOG_QUEUE_SIZE - 1)];
+		if (slot.seq.load(std::memory_order_acquire) != g_dequeue_pos + 1) break;
+
+		if (slot.suppressed != 0)
+		{
+			char note[64];
+			snprintf(note, sizeof(note), "(%u more messages from here were suppressed)", slot.suppressed);
+			Logger_log(slot.level, note, slot.file);
+		}
+		Logger_log(slot.level, slot.message, slot.file);
+
+		slot.seq.store(g_dequeue_pos + LOG_QUEUE_SIZE, std::memory_order_release);
+		++g_dequeue_pos;
+	}
+
+	UINT32 const dropped = g_dropped.exchange(0, std::memory_order_relaxed);
+	if (dropped != 0)
+	{
+		char note[64];
+		snprintf(note, sizeof(note), "%u log messages were dropped, the queue was full", dropped);
+		Logger_log(LogLevel::Warn, note, __FILE__);
+	}
+}
+
+
+static int WriterMain(void*)
+{
+	while (!g_quit.load())
+	{
+		WriteQueuedMessages();
+		SDL_Delay(LOG_WRITE_INTERVAL_MS);
+	}
+	return 0;
+}
+
+
+void StartAsyncLogging()
+{
+	if (g_writer) return;
+
+	for (size_t i = 0; i != LOG_QUEUE_SIZE; ++i) g_slots[i].seq.store(i);
+	g_enqueue_pos.store(0);
+	g_dequeue_pos = 0;
+	g_quit.store(false);
+
+	g_writer = SDL_CreateThread(WriterMain, "log", 0);
+	if (!g_writer)
+	{
+		SLOGW("Failed to create the log thread, logging synchronously: %s", SDL_GetError());
+		return;
+	}
+	SetLogHook(EnqueueMessage);
+
+	// Every return from main() and exit() writes what is still queued
+	static bool registered;
+	if (!registered)
+	{
+		atexit(StopAsyncLogging);
+		registered = true;
+	}
+}
+
+
+void StopAsyncLogging()
+{
+	if (!g_writer) return;
+
+	SetLogHook(NULL);
+	g_quit.store(true);
+	SDL_WaitThread(g_writer, 0);
+	g_writer = 0;
+
+	// A message another thread is queueing just now may be lost
+	WriteQueuedMessages();
+}
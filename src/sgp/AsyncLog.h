@@ -0,0 +1,21 @@
+#ifndef ASYNC_LOG_H
+#define ASYNC_LOG_H
+
+
+/* Starts writing the log on a thread of its own. The threads which log only
+ * format the message into a bounded lock-free queue, so logging does not block,
+ * not even in the audio callback. If the queue is full the message is dropped,
+ * and the number of dropped messages is logged later. Every call site, told
+ * apart by its format string, may log LOG_SITE_RATE messages per second; the
+ * ones beyond are not even formatted, only counted, and the count is logged
+ * with the next message of the site. Assertions and errors are written right
+ * away, so they are not lost when the game goes down, even if that puts them
+ * before messages queued earlier. The messages still queued are written when
+ * main() returns or exit() is called. */
+void StartAsyncLogging();
+
+/* Writes the messages still queued and goes back to writing every message
+ * right away. */
+void StopAsyncLogging();
+
+#endif
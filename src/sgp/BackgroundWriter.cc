@@ -0,0 +1,77 @@
+#include "BackgroundWriter.h"
+#include "FileMan.h"
+#include "Logger.h"
+
+#include "boost/filesystem.hpp"
+
+#include <SDL.h>
+
+#include <stdio.h>
+#include <string>
+
+
+static SDL_Thread*  g_thread;
+static SGPFile*     g_file;     // the memory file being written
+static std::string  g_path;
+static SDL_atomic_t g_finished; // set by the thread when it is done
+static bool         g_failed;   // only read after the thread is finished
+
+
+static bool WriteAndReplace(std::vector<BYTE> const& data, std::string const& path)
+{
+	std::string const tmp_path = path + ".tmp";
+	FILE* const f = fopen(tmp_path.c_str(), "wb");
+	if (!f) return false;
+	bool ok = data.empty() || fwrite(data.data(), data.size(), 1, f) == 1;
+	if (fclose(f) != 0) ok = false;
+
+	boost::system::error_code ec;
+	if (ok) boost::filesystem::rename(tmp_path, path, ec);
+	if (!ok || ec)
+	{
+		remove(tmp_path.c_str());
+		return false;
+	}
+	return true;
+}
+
+
+static int WriterMain(void*)
+{
+	g_failed = !WriteAndReplace(FileMan::getMemoryFileData(g_file), g_path);
+	SDL_AtomicSet(&g_finished, 1);
+	return 0;
+}
+
+
+void WriteFileInBackground(SGPFile* const memory_file, char const* const path)
+{
+	FinishBackgroundWrite(true);
+
+	g_file = memory_file;
+	g_path = path;
+	SDL_AtomicSet(&g_finished, 0);
+	g_thread = SDL_CreateThread(WriterMain, "writer", 0);
+	if (!g_thread)
+	{
+		SLOGW("Failed to create writer thread, writing %s directly: %s", path, SDL_GetError());
+		WriterMain(0);
+	}
+}
+
+
+BackgroundWriteStatus FinishBackgroundWrite(bool const wait)
+{
+	if (!g_file) return BACKGROUND_WRITE_IDLE;
+	if (!wait && !SDL_AtomicGet(&g_finished)) return BACKGROUND_WRITE_BUSY;
+
+	if (g_thread)
+	{
+		SDL_WaitThread(g_thread, 0);
+		g_thread = 0;
+	}
+	FileClose(g_file);
+	g_file = 0;
+	if (g_failed) SLOGE("Writing %s failed", g_path.c_str());
+	return g_failed ? BACKGROUND_WRITE_FAILED : BACKGROUND_WRITE_DONE;
+}
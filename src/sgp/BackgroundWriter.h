@@ -0,0 +1,27 @@
+#ifndef BACKGROUND_WRITER_H
+#define BACKGROUND_WRITER_H
+
+struct SGPFile;
+
+
+enum BackgroundWriteStatus
+{
+	BACKGROUND_WRITE_IDLE,    // no write was started since the last was finished
+	BACKGROUND_WRITE_BUSY,    // a write is still running
+	BACKGROUND_WRITE_DONE,    // the last write succeeded
+	BACKGROUND_WRITE_FAILED   // the last write failed, the old file is still there
+};
+
+/* Writes the contents of a file opened with FileMan::openInMemory() to path on
+ * a thread of its own and takes over the memory file. The data goes into a
+ * temporary file next to path first, which replaces the file at path once it
+ * is complete, so a write which fails or is cut short leaves the old file
+ * intact. Only one write runs at a time, a new one waits for the last. */
+void WriteFileInBackground(SGPFile* memory_file, char const* path);
+
+/* Collects the result of the last write. If wait is false and the write still
+ * runs, BACKGROUND_WRITE_BUSY is returned. DONE and FAILED are only returned
+ * once per write. */
+BackgroundWriteStatus FinishBackgroundWrite(bool wait);
+
+#endif
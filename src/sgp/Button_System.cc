@@ -274,9 +274,12 @@ remove_pic:
 }
 
 
+/* Only a change of state makes the button dirty, many screens set the state of
+ * their buttons on every frame. */
 void EnableButton(GUIButtonRef const b)
 {
 	CHECKV(b != NULL); // XXX HACK000C
+	if (b->uiFlags & BUTTON_ENABLED) return;
 	b->uiFlags |= BUTTON_ENABLED | BUTTON_DIRTY;
 }
 
@@ -284,6 +287,7 @@ void EnableButton(GUIButtonRef const b)
 void DisableButton(GUIButtonRef const b)
 {
 	CHECKV(b != NULL); // XXX HACK000C
+	if (!(b->uiFlags & BUTTON_ENABLED)) return;
 	b->uiFlags &= ~BUTTON_ENABLED;
 	b->uiFlags |= BUTTON_DIRTY;
 }
@@ -688,6 +692,10 @@ GUIButtonRef CreateLabel(const wchar_t* text, SGPFont const font, INT16 forecolo
 
 void GUI_BUTTON::SpecifyText(wchar_t const* const text)
 {
+	// Setting the same text again, like when it is updated every frame, does not need a redraw
+	bool const empty = text == NULL || text[0] == L'\0';
+	if (empty ? string == NULL : string != NULL && wcscmp(string, text) == 0) return;
+
 	//free the previous strings memory if applicable
 	if (string) MemFree(string);
 	string = NULL;
@@ -1017,6 +1025,18 @@ void MarkButtonsDirty(void)
 }
 
 
+void MarkButtonsDirty(SGPBox const& area)
+{
+	FOR_EACH_BUTTON(i)
+	{
+		GUI_BUTTON* const b = *i;
+		if (b->BottomRightX() < area.x || area.x + area.w <= b->X()) continue;
+		if (b->BottomRightY() < area.y || area.y + area.h <= b->Y()) continue;
+		b->uiFlags |= BUTTON_DIRTY;
+	}
+}
+
+
 void UnMarkButtonDirty(GUIButtonRef const b)
 {
 	CHECKV(b != NULL); // XXX HACK000C
@@ -277,6 +277,7 @@ GUIButtonRef CreateLabel(const wchar_t* text, SGPFont, INT16 forecolor, INT16 sh
 
 void MarkAButtonDirty(GUIButtonRef); // will mark only selected button dirty
 void MarkButtonsDirty(void);// Function to mark buttons dirty ( all will redraw at next RenderButtons )
+void MarkButtonsDirty(SGPBox const&); // only the buttons overlapping the area, e.g. after it was drawn over
 void UnMarkButtonDirty(GUIButtonRef);  // unmark button
 void UnmarkButtonsDirty(void); // unmark ALL the buttoms on the screen dirty
 void ForceButtonUnDirty(GUIButtonRef); // forces button undirty no matter the reason, only lasts one frame
@@ -0,0 +1,148 @@
+#include "Compression.h"
+
+#include <string.h>
+#include <vector>
+
+
+#define HASH_LOG     14
+#define MIN_MATCH    4
+#define MAX_OFFSET   65535
+#define LAST_LITERALS 5  // the format demands that a block ends with literals
+#define MATCH_LIMIT  12 // and that no match starts in its last bytes
+
+
+static UINT32 Read32(BYTE const* const p)
+{
+	UINT32 v;
+	memcpy(&v, p, sizeof(v));
+	return v;
+}
+
+
+static UINT32 Hash(UINT32 const v)
+{
+	return v * 2654435761U >> (32 - HASH_LOG);
+}
+
+
+static BYTE* WriteLength(BYTE* d, size_t n)
+{
+	for (; n >= 255; n -= 255) *d++ = 255;
+	*d++ = (BYTE)n;
+	return d;
+}
+
+
+static BYTE* WriteLiterals(BYTE* d, BYTE* const token, BYTE const* const src, size_t const n)
+{
+	*token = (BYTE)((n < 15 ? n : 15) << 4);
+	if (n >= 15) d = WriteLength(d, n - 15);
+	if (n != 0) memcpy(d, src, n);
+	return d + n;
+}
+
+
+size_t CompressBound(size_t const n)
+{
+	return n + n / 255 + 16;
+}
+
+
+size_t CompressBlock(BYTE const* const src, size_t const n, BYTE* const dst)
+{
+	BYTE*             d      = dst;
+	BYTE const*       anchor = src; // start of the literals not written yet
+	BYTE const* const end    = src + n;
+
+	if (n > MATCH_LIMIT)
+	{
+		// Positions of the last four byte sequences seen, by their hash
+		std::vector<UINT32> table(1U << HASH_LOG, 0);
+		BYTE const* const match_limit = end - MATCH_LIMIT;
+		BYTE const* const copy_limit  = end - LAST_LITERALS;
+		BYTE const*       p           = src;
+		while (p < match_limit)
+		{
+			UINT32 const v    = Read32(p);
+			UINT32&      slot = table[Hash(v)];
+			BYTE const*  m    = src + slot;
+			slot = (UINT32)(p - src);
+			if (m >= p || p - m > MAX_OFFSET || Read32(m) != v)
+			{
+				++p;
+				continue;
+			}
+
+			// Extend the match backwards into the literals and forwards
+			while (p > anchor && m > src && p[-1] == m[-1]) { --p; --m; }
+			BYTE const* q  = p + MIN_MATCH;
+			BYTE const* mq = m + MIN_MATCH;
+			while (q < copy_limit && *q == *mq) { ++q; ++mq; }
+
+			BYTE* const  token = d++;
+			d = WriteLiterals(d, token, anchor, p - anchor);
+			size_t const offset = p - m;
+			*d++ = (BYTE)offset;
+			*d++ = (BYTE)(offset >> 8);
+			size_t const len = q - p - MIN_MATCH;
+			*token |= (BYTE)(len < 15 ? len : 15);
+			if (len >= 15) d = WriteLength(d, len - 15);
+			p = anchor = q;
+		}
+	}
+
+	BYTE* const token = d++;
+	d = WriteLiterals(d, token, anchor, end - anchor);
+	return d - dst;
+}
+
+
+static bool ReadLength(BYTE const*& s, BYTE const* const end, size_t& n)
+{
+	for (;;)
+	{
+		if (s == end) return false;
+		BYTE const b = *s++;
+		n += b;
+		if (b != 255) return true;
+	}
+}
+
+
+bool DecompressBlock(BYTE const* const src, size_t const n, BYTE* const dst, size_t const dst_size)
+{
+	BYTE const*       s     = src;
+	BYTE const* const s_end = src + n;
+	BYTE*             d     = dst;
+	BYTE*       const d_end = dst + dst_size;
+	for (;;)
+	{
+		if (s == s_end) return false;
+		UINT const token = *s++;
+
+		size_t lit = token >> 4;
+		if (lit == 15 && !ReadLength(s, s_end, lit)) return false;
+		if ((size_t)(s_end - s) < lit || (size_t)(d_end - d) < lit) return false;
+		if (lit != 0) memcpy(d, s, lit);
+		d += lit;
+		s += lit;
+
+		// The last sequence has no match
+		if (s == s_end) return d == d_end;
+
+		if (s_end - s < 2) return false;
+		size_t const offset = s[0] | s[1] << 8;
+		s += 2;
+		if (offset == 0 || offset > (size_t)(d - dst)) return false;
+
+		size_t len = token & 15;
+		if (len == 15 && !ReadLength(s, s_end, len)) return false;
+		len += MIN_MATCH;
+		if ((size_t)(d_end - d) < len) return false;
+
+		// The match may overlap the bytes it produces
+		BYTE const* const m = d - offset;
+		for (size_t i = 0; i != len; ++i) d[i] = m[i];
+		d += len;
+	}
+}
@@ -0,0 +1,25 @@
+#ifndef COMPRESSION_H
+#define COMPRESSION_H
+
+#include "Types.h"
+
+#include <stddef.h>
+
+
+/* A fast byte oriented LZ77 compression in the LZ4 block format, so any LZ4
+ * block decoder can read the data, too. It is meant for large buffers which
+ * are written often, e.g. save games, where speed matters more than ratio. */
+
+/* Size of the buffer CompressBlock() needs in the worst case for n bytes. */
+size_t CompressBound(size_t n);
+
+/* Compresses n bytes from src into dst, which must hold CompressBound(n) bytes,
+ * and returns the size of the compressed data. */
+size_t CompressBlock(BYTE const* src, size_t n, BYTE* dst);
+
+/* Decompresses n bytes from src into dst, which must be exactly as large as the
+ * uncompressed data. Returns false if the data is damaged, without reading or
+ * writing outside of the buffers. */
+bool DecompressBlock(BYTE const* src, size_t n, BYTE* dst, size_t dst_size);
+
+#endif
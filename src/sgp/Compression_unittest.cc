@@ -0,0 +1,53 @@
+#include "gtest/gtest.h"
+
+#include "Compression.h"
+
+#include <vector>
+
+
+static std::vector<BYTE> RoundTrip(std::vector<BYTE> const& data)
+{
+	std::vector<BYTE> packed(CompressBound(data.size()));
+	packed.resize(CompressBlock(data.data(), data.size(), packed.data()));
+	std::vector<BYTE> unpacked(data.size());
+	EXPECT_TRUE(DecompressBlock(packed.data(), packed.size(), unpacked.data(), unpacked.size()));
+	return unpacked;
+}
+
+
+TEST(CompressionTest, RoundTrip)
+{
+	std::vector<BYTE> data;
+	EXPECT_EQ(RoundTrip(data), data);
+
+	data.assign(5, 7);
+	EXPECT_EQ(RoundTrip(data), data);
+
+	// Runs, repeated records and noise
+	UINT32 seed = 1;
+	for (UINT i = 0; i != 100000; ++i)
+	{
+		seed = seed * 1103515245 + 12345;
+		BYTE const b = i % 3000 < 1000 ? 0 : i % 3000 < 2000 ? (BYTE)(i % 37) : (BYTE)(seed >> 16);
+		data.push_back(b);
+	}
+	EXPECT_EQ(RoundTrip(data), data);
+
+	std::vector<BYTE> packed(CompressBound(data.size()));
+	size_t const n = CompressBlock(data.data(), data.size(), packed.data());
+	EXPECT_LT(n, data.size() / 2);
+}
+
+
+TEST(CompressionTest, DamagedData)
+{
+	std::vector<BYTE> data(1000);
+	for (size_t i = 0; i != data.size(); ++i) data[i] = (BYTE)(i % 10);
+	std::vector<BYTE> packed(CompressBound(data.size()));
+	packed.resize(CompressBlock(data.data(), data.size(), packed.data()));
+
+	std::vector<BYTE> out(data.size());
+	EXPECT_FALSE(DecompressBlock(packed.data(), packed.size() - 1, out.data(), out.size()));
+	EXPECT_FALSE(DecompressBlock(packed.data(), packed.size(), out.data(), out.size() - 1));
+	EXPECT_FALSE(DecompressBlock(packed.data(), 0, out.data(), out.size()));
+}
@@ -0,0 +1,638 @@
+#ifndef ETRLE_BLITTER_H
+#define ETRLE_BLITTER_H
+
+#include "Types.h"
+#include "Debug.h"
+#include "HImage.h"
+#include "Profiler.h"
+#include "Shading.h"
+#include "VObject.h"
+#include "VObject_Blitters.h"
+#include "WCheck.h"
+
+#include <stddef.h>
+
+#if defined __SSE2__ || defined _M_X64 || (defined _M_IX86_FP && _M_IX86_FP >= 2)
+#	define BLT_SSE2
+#	include <emmintrin.h>
+#elif defined __ARM_NEON
+#	define BLT_NEON
+#	include <arm_neon.h>
+#endif
+
+
+/* Set if the vector kernels are compiled in and supported by the CPU we are
+ * running on. */
+extern bool const g_simd_blitters;
+
+
+/* Blit a run of n non-transparent ETRLE pixels, writing every pixel whose Z
+ * buffer value is lower than or equal to zval. If UpdateZ is set, the Z buffer
+ * is set to zval for every written pixel. Blocks of eight pixels are done with
+ * vector instructions, the scalar loop handles the rest and is the reference
+ * implementation. */
+template<bool UpdateZ>
+static inline void BlitZRun(UINT16* dst, UINT16* zdst, UINT8 const* src, UINT32 n, UINT16 const* const pal, UINT16 const zval)
+{
+#if defined BLT_SSE2
+	if (g_simd_blitters)
+	{
+		__m128i const z = _mm_set1_epi16(zval);
+		for (; n >= 8; n -= 8, src += 8, dst += 8, zdst += 8)
+		{
+			__m128i const zbuf = _mm_loadu_si128(reinterpret_cast<__m128i const*>(zdst));
+			// SSE2 only compares signed: zbuf <= zval iff zbuf - zval saturates to 0
+			__m128i const mask = _mm_cmpeq_epi16(_mm_subs_epu16(zbuf, z), _mm_setzero_si128());
+			if (_mm_movemask_epi8(mask) == 0) continue;
+
+			__m128i const px  = _mm_setr_epi16(pal[src[0]], pal[src[1]], pal[src[2]], pal[src[3]], pal[src[4]], pal[src[5]], pal[src[6]], pal[src[7]]);
+			__m128i const old = _mm_loadu_si128(reinterpret_cast<__m128i const*>(dst));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dst), _mm_or_si128(_mm_and_si128(mask, px), _mm_andnot_si128(mask, old)));
+			if (UpdateZ)
+			{
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(zdst), _mm_or_si128(_mm_and_si128(mask, z), _mm_andnot_si128(mask, zbuf)));
+			}
+		}
+	}
+#elif defined BLT_NEON
+	if (g_simd_blitters)
+	{
+		uint16x8_t const z = vdupq_n_u16(zval);
+		for (; n >= 8; n -= 8, src += 8, dst += 8, zdst += 8)
+		{
+			uint16x8_t const zbuf = vld1q_u16(zdst);
+			uint16x8_t const mask = vcleq_u16(zbuf, z);
+
+			UINT16 const gathered[8] = { pal[src[0]], pal[src[1]], pal[src[2]], pal[src[3]], pal[src[4]], pal[src[5]], pal[src[6]], pal[src[7]] };
+			vst1q_u16(dst, vbslq_u16(mask, vld1q_u16(gathered), vld1q_u16(dst)));
+			if (UpdateZ) vst1q_u16(zdst, vbslq_u16(mask, z, zbuf));
+		}
+	}
+#endif
+
+	for (; n != 0; --n, ++src, ++dst, ++zdst)
+	{
+		if (*zdst <= zval)
+		{
+			if (UpdateZ) *zdst = zval;
+			*dst = pal[*src];
+		}
+	}
+}
+
+
+/* Replace each of a run of n destination pixels whose Z buffer value is lower
+ * than zval by its entry in table, as the shadow and intensity blitters do. If
+ * UpdateZ is set, the Z buffer is set to zval for every written pixel. Blocks
+ * of eight pixels are done with vector instructions like in BlitZRun(). */
+template<bool UpdateZ>
+static inline void ShadeZRun(UINT16* dst, UINT16* zdst, UINT32 n, UINT16 const* const table, UINT16 const zval)
+{
+#if defined BLT_SSE2
+	if (g_simd_blitters)
+	{
+		__m128i const z = _mm_set1_epi16(zval);
+		for (; n >= 8; n -= 8, dst += 8, zdst += 8)
+		{
+			__m128i const zbuf = _mm_loadu_si128(reinterpret_cast<__m128i const*>(zdst));
+			// zbuf < zval iff zval - zbuf does not saturate to 0
+			__m128i const keep = _mm_cmpeq_epi16(_mm_subs_epu16(z, zbuf), _mm_setzero_si128());
+			if (_mm_movemask_epi8(keep) == 0xFFFF) continue;
+
+			__m128i const px  = _mm_setr_epi16(table[dst[0]], table[dst[1]], table[dst[2]], table[dst[3]], table[dst[4]], table[dst[5]], table[dst[6]], table[dst[7]]);
+			__m128i const old = _mm_loadu_si128(reinterpret_cast<__m128i const*>(dst));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dst), _mm_or_si128(_mm_and_si128(keep, old), _mm_andnot_si128(keep, px)));
+			if (UpdateZ)
+			{
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(zdst), _mm_or_si128(_mm_and_si128(keep, zbuf), _mm_andnot_si128(keep, z)));
+			}
+		}
+	}
+#elif defined BLT_NEON
+	if (g_simd_blitters)
+	{
+		uint16x8_t const z = vdupq_n_u16(zval);
+		for (; n >= 8; n -= 8, dst += 8, zdst += 8)
+		{
+			uint16x8_t const zbuf = vld1q_u16(zdst);
+			uint16x8_t const mask = vcltq_u16(zbuf, z);
+
+			UINT16 const gathered[8] = { table[dst[0]], table[dst[1]], table[dst[2]], table[dst[3]], table[dst[4]], table[dst[5]], table[dst[6]], table[dst[7]] };
+			vst1q_u16(dst, vbslq_u16(mask, vld1q_u16(gathered), vld1q_u16(dst)));
+			if (UpdateZ) vst1q_u16(zdst, vbslq_u16(mask, z, zbuf));
+		}
+	}
+#endif
+
+	for (; n != 0; --n, ++dst, ++zdst)
+	{
+		if (*zdst < zval)
+		{
+			if (UpdateZ) *zdst = zval;
+			*dst = table[*dst];
+		}
+	}
+}
+
+
+/* Walks the ETRLE data of a subregion of a video object and hands the visible
+ * runs to a pixel policy, which decides what is written. Clipping is a
+ * template parameter, so every combination of traversal and policy is compiled
+ * into its own loop without runtime branching.
+ *
+ * A policy provides
+ *   bool Begin(INT32 left_skip)  called once after clipping, return false to abort
+ *   void SkipLine()              called for every line clipped at the top
+ *   void BeginLine()             called before every blitted line
+ *   void EndLine()               called after every blitted line
+ *   void Opaque(UINT16* dst, size_t pos, UINT8 const* src, UINT32 n)
+ *   void Transparent(UINT16* dst, size_t pos, UINT32 n)
+ * where pos is the offset of dst in pixels from the start of the destination
+ * buffer. It is meant for indexing a Z buffer of the same dimensions.
+ * ETRLEPolicy provides the no-op defaults.
+ *
+ * Unclipped blits bail out if the image starts left of or above the buffer. */
+template<bool Clip, typename Policy>
+static inline void BltETRLE(UINT16* const buf, UINT32 const uiDestPitchBYTES, SGPVObject const* const hSrcVObject, INT32 const iX, INT32 const iY, UINT16 const usIndex, SGPRect const* clipregion, Policy p)
+{
+	Assert(hSrcVObject);
+	Assert(buf);
+
+	// Get offsets from index into structure
+	ETRLEObject const& e      = hSrcVObject->SubregionProperties(usIndex);
+	INT32       const  height = e.usHeight;
+	INT32       const  width  = e.usWidth;
+
+	ProfilerCount(PROFILE_BLITS,       1);
+	ProfilerCount(PROFILE_BLIT_PIXELS, width * height);
+
+	// Add to start position of dest buffer
+	INT32 const x = iX + e.sOffsetX;
+	INT32 const y = iY + e.sOffsetY;
+
+	UINT32       const pitch = uiDestPitchBYTES / 2;
+	UINT8  const*      src   = hSrcVObject->PixData(e);
+
+	if (!Clip)
+	{
+		CHECKV(x >= 0);
+		CHECKV(y >= 0);
+
+		if (!p.Begin(0)) return;
+
+		size_t        pos       = pitch * y + x;
+		UINT16*       dst       = buf + pos;
+		UINT32  const line_skip = pitch - width;
+		INT32         lines     = height;
+		do
+		{
+			p.BeginLine();
+			for (;;)
+			{
+				UINT32 data = *src++;
+				if (data == 0) break;
+				if (data & 0x80)
+				{
+					data &= 0x7F;
+					p.Transparent(dst, pos, data);
+				}
+				else
+				{
+					p.Opaque(dst, pos, src, data);
+					src += data;
+				}
+				dst += data;
+				pos += data;
+			}
+			p.EndLine();
+			dst += line_skip;
+			pos += line_skip;
+		}
+		while (--lines > 0);
+		return;
+	}
+
+	if (!clipregion) clipregion = &ClippingRect;
+
+	// Calculate rows hanging off each side of the screen
+	INT32 const left_skip   = __min(clipregion->iLeft - __min(clipregion->iLeft, x), width);
+	INT32       top_skip    = __min(clipregion->iTop - __min(clipregion->iTop, y), height);
+	INT32 const right_skip  = __min(__max(clipregion->iRight, x + width) - clipregion->iRight, width);
+	INT32 const bottom_skip = __min(__max(clipregion->iBottom, y + height) - clipregion->iBottom, height);
+
+	// check if whole thing is clipped
+	if (left_skip >= width  || right_skip  >= width)  return;
+	if (top_skip  >= height || bottom_skip >= height) return;
+
+	if (!p.Begin(left_skip)) return;
+
+	// calculate the remaining rows and columns to blit
+	INT32 const blit_length = width  - left_skip - right_skip;
+	INT32       blit_height = height - top_skip  - bottom_skip;
+
+	size_t        pos       = pitch * (y + top_skip) + x + left_skip;
+	UINT16*       dst       = buf + pos;
+	UINT32  const line_skip = pitch - blit_length;
+
+	for (; top_skip > 0; --top_skip)
+	{
+		for (;;)
+		{
+			UINT32 const data = *src++;
+			if (data & 0x80) continue;
+			if (data == 0) break;
+			src += data;
+		}
+		p.SkipLine();
+	}
+
+	do
+	{
+		p.BeginLine();
+		INT32 to_skip = left_skip;
+		INT32 to_blit = blit_length;
+		while (to_blit > 0)
+		{
+			UINT32       data        = *src++;
+			bool   const transparent = (data & 0x80) != 0;
+			data &= 0x7F;
+
+			if (to_skip > 0)
+			{ // still left of the clipping rectangle
+				if ((INT32)data <= to_skip)
+				{
+					if (!transparent) src += data;
+					to_skip -= data;
+					continue;
+				}
+				if (!transparent) src += to_skip;
+				data    -= to_skip;
+				to_skip  = 0;
+			}
+
+			UINT32 const n = __min((INT32)data, to_blit);
+			if (transparent)
+			{
+				p.Transparent(dst, pos, n);
+			}
+			else
+			{
+				p.Opaque(dst, pos, src, n);
+				src += data;
+			}
+			dst     += n;
+			pos     += n;
+			to_blit -= n;
+		}
+
+		while (*src++ != 0) {} // skip along until we hit and end-of-line marker
+		p.EndLine();
+		dst += line_skip;
+		pos += line_skip;
+	}
+	while (--blit_height > 0);
+}
+
+
+/* No-op defaults for the optional policy hooks. */
+struct ETRLEPolicy
+{
+	bool Begin(INT32) { return true; }
+	void SkipLine() {}
+	void BeginLine() {}
+	void EndLine() {}
+	void Transparent(UINT16*, size_t, UINT32) {}
+};
+
+
+/* Writes every non-transparent pixel through the palette. */
+struct ETRLEPalettePolicy : ETRLEPolicy
+{
+	UINT16 const* pal;
+
+	explicit ETRLEPalettePolicy(UINT16 const* const pal_) : pal(pal_) {}
+
+	void Opaque(UINT16* const dst, size_t, UINT8 const* const src, UINT32 const n)
+	{
+		for (UINT32 i = 0; i != n; ++i) dst[i] = pal[src[i]];
+	}
+};
+
+
+/* Writes non-transparent pixels through the palette where the Z buffer is
+ * lower than or equal to zval, optionally updating the Z buffer. */
+template<bool UpdateZ>
+struct ETRLEPaletteZPolicy : ETRLEPolicy
+{
+	UINT16*       zbuf;
+	UINT16        zval;
+	UINT16 const* pal;
+
+	ETRLEPaletteZPolicy(UINT16* const zbuf_, UINT16 const zval_, UINT16 const* const pal_) :
+		zbuf(zbuf_), zval(zval_), pal(pal_) {}
+
+	void Opaque(UINT16* const dst, size_t const pos, UINT8 const* const src, UINT32 const n)
+	{
+		BlitZRun<UpdateZ>(dst, zbuf + pos, src, n, pal, zval);
+	}
+};
+
+
+/* Darkens the destination under every non-transparent pixel. The intensity
+ * blitters pass the IntensityTable instead of the ShadeTable. */
+struct ETRLEShadePolicy : ETRLEPolicy
+{
+	UINT16 const* table;
+
+	explicit ETRLEShadePolicy(UINT16 const* const table_ = ShadeTable) : table(table_) {}
+
+	void Opaque(UINT16* const dst, size_t, UINT8 const*, UINT32 const n)
+	{
+		for (UINT32 i = 0; i != n; ++i) dst[i] = table[dst[i]];
+	}
+};
+
+
+/* Darkens the destination under non-transparent pixels where the Z buffer is
+ * lower than zval, optionally updating the Z buffer. The intensity blitters
+ * pass the IntensityTable instead of the ShadeTable. */
+template<bool UpdateZ>
+struct ETRLEShadeZPolicy : ETRLEPolicy
+{
+	UINT16*       zbuf;
+	UINT16        zval;
+	UINT16 const* table;
+
+	ETRLEShadeZPolicy(UINT16* const zbuf_, UINT16 const zval_, UINT16 const* const table_ = ShadeTable) :
+		zbuf(zbuf_), zval(zval_), table(table_) {}
+
+	void Opaque(UINT16* const dst, size_t const pos, UINT8 const*, UINT32 const n)
+	{
+		ShadeZRun<UpdateZ>(dst, zbuf + pos, n, table, zval);
+	}
+};
+
+
+/* Tracks the checkerboard the obscured and pixelating blitters draw through:
+ * every second pixel, shifted by one on every line, so what is behind the
+ * object stays half visible. */
+struct ETRLEObscuredPolicy : ETRLEPolicy
+{
+	UINT32 line_flag;
+
+	ETRLEObscuredPolicy(SGPVObject const* const vo, INT32 const iY, UINT16 const usIndex) :
+		line_flag((iY + vo->SubregionProperties(usIndex).sOffsetY) & 1)
+	{}
+
+	void SkipLine() { line_flag ^= 1; }
+	void EndLine()  { line_flag ^= 1; }
+
+	bool OnPattern(UINT16 const* const dst) const
+	{
+		return line_flag == (((uintptr_t)dst & 2) != 0);
+	}
+};
+
+
+/* Blends non-transparent pixels half and half with the destination where the
+ * Z buffer is lower than or equal to zval, optionally updating the Z buffer. */
+template<bool UpdateZ>
+struct ETRLETranslucentZPolicy : ETRLEPolicy
+{
+	UINT16*       zbuf;
+	UINT16        zval;
+	UINT16 const* pal;
+	UINT32        mask;
+
+	ETRLETranslucentZPolicy(UINT16* const zbuf_, UINT16 const zval_, UINT16 const* const pal_) :
+		zbuf(zbuf_), zval(zval_), pal(pal_), mask(guiTranslucentMask) {}
+
+	void Opaque(UINT16* const dst, size_t const pos, UINT8 const* const src, UINT32 const n)
+	{
+		UINT16* const z = zbuf + pos;
+		for (UINT32 i = 0; i != n; ++i)
+		{
+			if (z[i] > zval) continue;
+			if (UpdateZ) z[i] = zval;
+			dst[i] = (pal[src[i]] >> 1 & mask) + (dst[i] >> 1 & mask);
+		}
+	}
+};
+
+
+/* Draws a bitmap in fixed colours: index 1 as shadow, any other index as
+ * foreground and transparent pixels as background. A shadow or background
+ * colour of 0 leaves the destination alone. */
+struct ETRLEMonoShadowPolicy : ETRLEPolicy
+{
+	UINT16 foreground;
+	UINT16 background;
+	UINT16 shadow;
+
+	ETRLEMonoShadowPolicy(UINT16 const foreground_, UINT16 const background_, UINT16 const shadow_) :
+		foreground(foreground_), background(background_), shadow(shadow_) {}
+
+	void Opaque(UINT16* const dst, size_t, UINT8 const* const src, UINT32 const n)
+	{
+		for (UINT32 i = 0; i != n; ++i)
+		{
+			switch (src[i])
+			{
+				case 0:  if (background != 0) dst[i] = background; break;
+				case 1:  if (shadow     != 0) dst[i] = shadow;     break;
+				default:                      dst[i] = foreground; break;
+			}
+		}
+	}
+
+	void Transparent(UINT16* const dst, size_t, UINT32 const n)
+	{
+		if (background == 0) return;
+		for (UINT32 i = 0; i != n; ++i) dst[i] = background;
+	}
+};
+
+
+/* Writes non-transparent pixels through the palette, except for index 254,
+ * which gets the outline colour. SGP_TRANSPARENT leaves the outline out. */
+struct ETRLEOutlinePolicy : ETRLEPolicy
+{
+	UINT16 const* pal;
+	INT16         outline;
+
+	ETRLEOutlinePolicy(UINT16 const* const pal_, INT16 const outline_) : pal(pal_), outline(outline_) {}
+
+	void Opaque(UINT16* const dst, size_t, UINT8 const* const src, UINT32 const n)
+	{
+		for (UINT32 i = 0; i != n; ++i)
+		{
+			if (src[i] != 254)
+			{
+				dst[i] = pal[src[i]];
+			}
+			else if (outline != SGP_TRANSPARENT)
+			{
+				dst[i] = outline;
+			}
+		}
+	}
+};
+
+
+/* Darkens the destination under every non-transparent pixel but the outline. */
+struct ETRLEOutlineShadowPolicy : ETRLEPolicy
+{
+	void Opaque(UINT16* const dst, size_t, UINT8 const* const src, UINT32 const n)
+	{
+		for (UINT32 i = 0; i != n; ++i)
+		{
+			if (src[i] != 254) dst[i] = ShadeTable[dst[i]];
+		}
+	}
+};
+
+
+/* Like ETRLEOutlinePolicy where the Z buffer is lower than or equal to zval.
+ * Only the palette pixels update the Z buffer, the outline is always drawn. */
+struct ETRLEOutlineZPolicy : ETRLEPolicy
+{
+	UINT16*       zbuf;
+	UINT16        zval;
+	UINT16 const* pal;
+	INT16         outline;
+
+	ETRLEOutlineZPolicy(UINT16* const zbuf_, UINT16 const zval_, UINT16 const* const pal_, INT16 const outline_) :
+		zbuf(zbuf_), zval(zval_), pal(pal_), outline(outline_) {}
+
+	void Opaque(UINT16* const dst, size_t const pos, UINT8 const* const src, UINT32 const n)
+	{
+		UINT16* const z = zbuf + pos;
+		for (UINT32 i = 0; i != n; ++i)
+		{
+			if (z[i] > zval) continue;
+			if (src[i] == 254)
+			{
+				dst[i] = outline;
+			}
+			else
+			{
+				z[i]   = zval;
+				dst[i] = pal[src[i]];
+			}
+		}
+	}
+};
+
+
+/* Writes non-transparent pixels but the outline through the palette where the
+ * Z buffer is lower than zval, without updating it. */
+struct ETRLEOutlineZNBPolicy : ETRLEPolicy
+{
+	UINT16*       zbuf;
+	UINT16        zval;
+	UINT16 const* pal;
+
+	ETRLEOutlineZNBPolicy(UINT16* const zbuf_, UINT16 const zval_, UINT16 const* const pal_) :
+		zbuf(zbuf_), zval(zval_), pal(pal_) {}
+
+	void Opaque(UINT16* const dst, size_t const pos, UINT8 const* const src, UINT32 const n)
+	{
+		UINT16 const* const z = zbuf + pos;
+		for (UINT32 i = 0; i != n; ++i)
+		{
+			if (z[i] < zval && src[i] != 254) dst[i] = pal[src[i]];
+		}
+	}
+};
+
+
+/* Writes non-transparent pixels through the palette where the Z buffer is
+ * lower than zval, updating it, and pixelates them where it is not. With
+ * Outline set index 254 gets the outline colour. */
+template<bool Outline>
+struct ETRLEPixelateZPolicy : ETRLEObscuredPolicy
+{
+	UINT16*       zbuf;
+	UINT16        zval;
+	UINT16 const* pal;
+	INT16         outline;
+
+	ETRLEPixelateZPolicy(UINT16* const zbuf_, UINT16 const zval_, UINT16 const* const pal_, INT16 const outline_, SGPVObject const* const vo, INT32 const iY, UINT16 const usIndex) :
+		ETRLEObscuredPolicy(vo, iY, usIndex), zbuf(zbuf_), zval(zval_), pal(pal_), outline(outline_) {}
+
+	void Opaque(UINT16* const dst, size_t const pos, UINT8 const* const src, UINT32 const n)
+	{
+		UINT16* const z = zbuf + pos;
+		for (UINT32 i = 0; i != n; ++i)
+		{
+			if (z[i] < zval)
+			{
+				z[i] = zval;
+			}
+			else if (!OnPattern(dst + i))
+			{
+				continue;
+			}
+			dst[i] = Outline && src[i] == 254 ? outline : pal[src[i]];
+		}
+	}
+};
+
+
+/* Writes non-transparent pixels through the palette, except for index 254,
+ * which darkens the destination instead. */
+struct ETRLETransShadowPolicy : ETRLEPolicy
+{
+	UINT16 const* pal;
+
+	explicit ETRLETransShadowPolicy(UINT16 const* const pal_) : pal(pal_) {}
+
+	void Opaque(UINT16* const dst, size_t, UINT8 const* const src, UINT32 const n)
+	{
+		for (UINT32 i = 0; i != n; ++i)
+		{
+			dst[i] = src[i] == 254 ? ShadeTable[dst[i]] : pal[src[i]];
+		}
+	}
+};
+
+
+/* ETRLETransShadowPolicy with a Z test: the shadow is drawn where the Z buffer
+ * is lower than zval, palette pixels where it is lower than or equal to zval,
+ * or, if Obscured is set, on the checkerboard pattern. With UpdateZ both need
+ * a lower Z buffer value and set it to zval. */
+template<bool UpdateZ, bool Obscured>
+struct ETRLETransShadowZPolicy : ETRLEObscuredPolicy
+{
+	UINT16*       zbuf;
+	UINT16        zval;
+	UINT16 const* pal;
+
+	ETRLETransShadowZPolicy(UINT16* const zbuf_, UINT16 const zval_, UINT16 const* const pal_, SGPVObject const* const vo, INT32 const iY, UINT16 const usIndex) :
+		ETRLEObscuredPolicy(vo, iY, usIndex), zbuf(zbuf_), zval(zval_), pal(pal_) {}
+
+	void Opaque(UINT16* const dst, size_t const pos, UINT8 const* const src, UINT32 const n)
+	{
+		UINT16* const z = zbuf + pos;
+		for (UINT32 i = 0; i != n; ++i)
+		{
+			UINT8 const px = src[i];
+			if (UpdateZ)
+			{
+				if (z[i] >= zval) continue;
+				z[i] = zval;
+			}
+			else if (px == 254)
+			{
+				if (z[i] >= zval) continue;
+			}
+			else
+			{
+				if (z[i] > zval && !(Obscured && OnPattern(dst + i))) continue;
+			}
+			dst[i] = px == 254 ? ShadeTable[dst[i]] : pal[px];
+		}
+	}
+};
+
+#endif
@@ -1,8 +1,12 @@
+#include <algorithm>
+#include <functional>
+#include <memory>
 #include <stdexcept>
 
 #include <errno.h>
 #include <fcntl.h>
 #include <stdlib.h>
+#include <string.h>
 #include <sys/stat.h>
 #include <sys/types.h>
 #include "FileMan.h"
@@ -18,6 +22,7 @@
 #include <shlobj.h>
 #else
 #include <pwd.h>
+#include <sys/mman.h>
 #endif
 
 #include "PlatformIO.h"
@@ -35,6 +40,16 @@
 
 // XXX: remove FileMan class and make it into a namespace
 
+struct SGPMemoryFile
+{
+	SGPMemoryFile(std::shared_ptr<std::vector<BYTE> > const& b) : buffer(b), data(*b), pos(0) {}
+
+	std::shared_ptr<std::vector<BYTE> > buffer;
+	std::vector<BYTE>&                  data; // *buffer
+	size_t                              pos;
+	std::function<void()>               on_close;
+};
+
 #define LOCAL_CURRENT_DIR "tmp"
 #define SDL_RWOPS_SGP 222
 
@@ -109,12 +124,35 @@ std::string FileMan::switchTmpFolder(std::string home)
 }
 
 
+/* Joins two path components like FileMan::joinPaths(), but into the buffer.
+ * Returns false if the path does not fit. */
+static bool JoinPathsInto(char* const buf, size_t const size, const std::string& first, const char* const second)
+{
+	size_t const first_len  = first.length();
+	size_t const second_len = strlen(second);
+	bool   const separate   =
+		(first_len == 0 || first[first_len - 1] != PATH_SEPARATOR) &&
+		second[0] != PATH_SEPARATOR;
+	if (first_len + separate + second_len >= size) return false;
+
+	char* p = buf;
+	memcpy(p, first.c_str(), first_len);
+	p += first_len;
+	if (separate) *p++ = PATH_SEPARATOR;
+	memcpy(p, second, second_len + 1);
+	return true;
+}
+
+
 /** Open file in the given folder in case-insensitive manner.
  * @return file descriptor or -1 if file is not found. */
 int FileMan::openFileCaseInsensitive(const std::string &folderPath, const char *filename, int mode)
 {
-	std::string path = FileMan::joinPaths(folderPath, filename);
-	int d = open(path.c_str(), mode);
+	// Game resources are opened all the time, most paths fit here without allocating
+	char buf[512];
+	int d = JoinPathsInto(buf, sizeof(buf), folderPath, filename) ?
+		open(buf, mode) :
+		open(FileMan::joinPaths(folderPath, filename).c_str(), mode);
 	if (d < 0)
 	{
 #if CASE_SENSITIVE_FS
@@ -122,7 +160,7 @@ int FileMan::openFileCaseInsensitive(const std::string &folderPath, const char *
 		std::string newFileName;
 		if(findObjectCaseInsensitive(folderPath.c_str(), filename, true, false, newFileName))
 		{
-			path = FileMan::joinPaths(folderPath, newFileName);
+			std::string const path = FileMan::joinPaths(folderPath, newFileName);
 			d = open(path.c_str(), mode);
 		}
 #endif
@@ -195,15 +233,24 @@ static const char* GetFileOpenModes(FileOpenFlags flags, int *posixMode)
 
 void FileClose(SGPFile* f)
 {
+	std::function<void()> on_close;
 	if (f->flags & SGPFILE_REAL)
 	{
 		fclose(f->u.file);
 	}
+	else if (f->flags & SGPFILE_MEMORY)
+	{
+		on_close.swap(f->u.mem->on_close);
+		delete f->u.mem;
+	}
 	else
 	{
 		LibraryFile_close(f->u.lib);
 	}
 	MemFree(f);
+
+	// The file no longer holds its buffer, so the owner may do with it as it likes
+	if (on_close) on_close();
 }
 
 void FileRead(SGPFile* const f, void* const pDest, size_t const uiBytesToRead)
@@ -213,6 +260,16 @@ void FileRead(SGPFile* const f, void* const pDest, size_t const uiBytesToRead)
 	{
 		ret = fread(pDest, uiBytesToRead, 1, f->u.file) == 1;
 	}
+	else if (f->flags & SGPFILE_MEMORY)
+	{
+		SGPMemoryFile& m = *f->u.mem;
+		ret = m.pos <= m.data.size() && uiBytesToRead <= m.data.size() - m.pos;
+		if (ret && uiBytesToRead != 0)
+		{
+			memcpy(pDest, m.data.data() + m.pos, uiBytesToRead);
+			m.pos += uiBytesToRead;
+		}
+	}
 	else
 	{
 		ret = LibraryFile_read(f->u.lib, static_cast<uint8_t *>(pDest), uiBytesToRead);
@@ -224,6 +281,16 @@ void FileRead(SGPFile* const f, void* const pDest, size_t const uiBytesToRead)
 
 void FileWrite(SGPFile* const f, void const* const pDest, size_t const uiBytesToWrite)
 {
+	if (f->flags & SGPFILE_MEMORY)
+	{
+		// Like a real file, a gap left by seeking past the end is zero filled
+		SGPMemoryFile& m   = *f->u.mem;
+		size_t const   end = m.pos + uiBytesToWrite;
+		if (end > m.data.size()) m.data.resize(end);
+		if (uiBytesToWrite != 0) memcpy(m.data.data() + m.pos, pDest, uiBytesToWrite);
+		m.pos = end;
+		return;
+	}
 	if (!(f->flags & SGPFILE_REAL)) throw std::logic_error("Tried to write to library file");
 	if (fwrite(pDest, uiBytesToWrite, 1, f->u.file) != 1) throw std::runtime_error("Writing to file failed");
 }
@@ -318,6 +385,19 @@ void FileSeek(SGPFile* const f, INT32 distance, FileSeekMode const how)
 
 		success = fseek(f->u.file, distance, whence) == 0;
 	}
+	else if (f->flags & SGPFILE_MEMORY)
+	{
+		SGPMemoryFile& m = *f->u.mem;
+		int64_t base;
+		switch (how)
+		{
+			case FILE_SEEK_FROM_START: base = 0;                      break;
+			case FILE_SEEK_FROM_END:   base = (int64_t)m.data.size(); break;
+			default:                   base = (int64_t)m.pos;         break;
+		}
+		success = base + distance >= 0;
+		if (success) m.pos = (size_t)(base + distance);
+	}
 	else
 	{
 		success = LibraryFile_seek(f->u.lib, distance, how);
@@ -328,6 +408,7 @@ void FileSeek(SGPFile* const f, INT32 distance, FileSeekMode const how)
 
 INT32 FileGetPos(const SGPFile* f)
 {
+	if (f->flags & SGPFILE_MEMORY) return (INT32)f->u.mem->pos;
 	return f->flags & SGPFILE_REAL ? (INT32)ftell(f->u.file) : (INT32)LibraryFile_getPosition(f->u.lib);
 }
 
@@ -343,6 +424,10 @@ UINT32 FileGetSize(const SGPFile* f)
 		}
 		return (UINT32)sb.st_size;
 	}
+	else if (f->flags & SGPFILE_MEMORY)
+	{
+		return (UINT32)f->u.mem->data.size();
+	}
 	else
 	{
 		return (UINT32)LibraryFile_getSize(f->u.lib);
@@ -350,6 +435,73 @@ UINT32 FileGetSize(const SGPFile* f)
 }
 
 
+FileView::FileView(SGPFile* const f) :
+	data_(0),
+	size_(0),
+	mapping_(0)
+{
+	if (f->flags & SGPFILE_MEMORY)
+	{
+		data_ = f->u.mem->data.data();
+		size_ = f->u.mem->data.size();
+		return;
+	}
+
+	if (!(f->flags & SGPFILE_REAL))
+	{
+		size_t      length;
+		BYTE const* data = LibraryFile_getMappedData(f->u.lib, &length);
+		if (data)
+		{
+			data_ = data;
+			size_ = length;
+			return;
+		}
+	}
+
+	size_ = FileGetSize(f);
+	if (size_ == 0) return;
+
+#ifndef _WIN32
+	if (f->flags & SGPFILE_REAL)
+	{
+		void* const mapping = mmap(0, size_, PROT_READ, MAP_PRIVATE, fileno(f->u.file), 0);
+		if (mapping != MAP_FAILED)
+		{
+			mapping_ = mapping;
+			data_    = static_cast<BYTE const*>(mapping);
+			return;
+		}
+	}
+#endif
+
+	// Not mappable, read the whole file and restore the position
+	INT32 const pos = FileGetPos(f);
+	buffer_.Allocate(size_);
+	FileSeek(f, 0, FILE_SEEK_FROM_START);
+	FileRead(f, buffer_, size_);
+	FileSeek(f, pos, FILE_SEEK_FROM_START);
+	data_ = buffer_;
+}
+
+
+FileView::~FileView()
+{
+#ifndef _WIN32
+	if (mapping_) munmap(mapping_, size_);
+#endif
+}
+
+
+BYTE const* FileViewReader::Take(size_t const n)
+{
+	if (n > view_.size() - pos_) throw std::runtime_error("Reading from file failed");
+	BYTE const* const data = view_.data() + pos_;
+	pos_ += n;
+	return data;
+}
+
+
 static void SetFileManCurrentDirectory(char const* const pcDirectory)
 {
 #if 1 // XXX TODO
@@ -644,6 +796,44 @@ SGPFile* FileMan::openForReading(const char *filename)
 	return getSGPFileFromFD(d, filename, fmode);
 }
 
+SGPFile* FileMan::openInMemory(size_t const reserve)
+{
+	SGPFile* const file = openInMemory(std::make_shared<std::vector<BYTE> >(), std::function<void()>());
+	file->u.mem->data.reserve(reserve);
+	return file;
+}
+
+SGPFile* FileMan::openInMemory(std::shared_ptr<std::vector<BYTE> > const& buffer, std::function<void()> const& on_close)
+{
+	SGPMemoryFile* const m = new SGPMemoryFile(buffer);
+	m->on_close = on_close;
+	SGPFile* const file = MALLOCZ(SGPFile);
+	file->flags = SGPFILE_MEMORY;
+	file->u.mem = m;
+	return file;
+}
+
+SGPFile* FileMan::readIntoMemory(SGPFile* const src)
+{
+	AutoSGPFile        f(openInMemory());
+	FileView    const  view(src);
+	std::vector<BYTE>& data = f->u.mem->data;
+	data.assign(view.data(), view.data() + view.size());
+	return f.Release();
+}
+
+std::vector<BYTE> const& FileMan::getMemoryFileData(const SGPFile* const f)
+{
+	if (!(f->flags & SGPFILE_MEMORY)) throw std::logic_error("Not a memory file");
+	return f->u.mem->data;
+}
+
+std::shared_ptr<std::vector<BYTE> > FileMan::getMemoryFileBuffer(const SGPFile* const f)
+{
+	if (!(f->flags & SGPFILE_MEMORY)) throw std::logic_error("Not a memory file");
+	return f->u.mem->buffer;
+}
+
 /** Open file for reading. */
 SGPFile* FileMan::openForReading(const std::string &filename)
 {
@@ -804,13 +994,10 @@ void FileMan::slashifyPath(std::string &path)
 /** Read the whole file as text. */
 std::string FileMan::fileReadText(SGPFile* file)
 {
-	uint32_t size = FileGetSize(file);
-	char *data = new char[size+1];
-	FileRead(file, data, size);
-	data[size] = 0;
-	std::string result(data);
-	delete[] data;
-	return result;
+	FileView const view(file);
+	char const* const data = reinterpret_cast<char const*>(view.data());
+	// Like a C string, the text ends at the first NUL
+	return std::string(data, std::find(data, data + view.size(), '\0'));
 }
 
 /** Check file existance. */
@@ -827,3 +1014,18 @@ void FileMan::moveFile(const char *from, const char *to)
 	boost::filesystem::path toPath(to);
 	boost::filesystem::rename(fromPath, toPath);
 }
+
+void FileMan::copyFile(const char *from, const char *to)
+{
+	boost::filesystem::copy_file(from, to, boost::filesystem::copy_option::overwrite_if_exists);
+}
+
+bool FileMan::getFileStamp(const char *path, time_t &mtime, uintmax_t &size)
+{
+	boost::system::error_code ec;
+	boost::filesystem::path const p(path);
+	size = boost::filesystem::file_size(p, ec);
+	if (ec) return false;
+	mtime = boost::filesystem::last_write_time(p, ec);
+	return !ec;
+}
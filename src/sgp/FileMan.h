@@ -1,9 +1,14 @@
 #ifndef FILEMAN_H
 #define FILEMAN_H
 
+#include <functional>
+#include <memory>
 #include <string>
 #include <vector>
 
+#include <string.h>
+
+#include "sgp/Buffer.h"
 #include "sgp/SGPFile.h"
 #include "sgp/Types.h"
 
@@ -34,6 +39,46 @@ INT32 FileGetPos(const SGPFile*);
 
 UINT32 FileGetSize(const SGPFile*);
 
+/* A read-only view of the whole contents of a file. Library files are viewed
+ * in the memory mapped library and real files are memory mapped, so nothing is
+ * copied. If the file cannot be mapped, it is read into a buffer owned by the
+ * view. The file position is not changed. The view must not outlive the file. */
+class FileView
+{
+	public:
+		explicit FileView(SGPFile*);
+		~FileView();
+
+		BYTE const* data() const { return data_; }
+		size_t      size() const { return size_; }
+
+	private:
+		BYTE const*       data_;
+		size_t            size_;
+		void*             mapping_; // set if the view mapped a real file itself
+		SGP::Buffer<BYTE> buffer_;
+
+		FileView(const FileView&);        /* no copy */
+		void operator =(const FileView&); /* no assignment */
+};
+
+/* Reads consecutive parts of a FileView from its start, like FileRead() and
+ * FileSeek() do with a file. Reading past the end throws. */
+class FileViewReader
+{
+	public:
+		explicit FileViewReader(FileView const& view) : view_(view), pos_(0) {}
+
+		/* Returns the next n bytes in the view and skips them. */
+		BYTE const* Take(size_t n);
+
+		void Read(void* const dst, size_t const n) { memcpy(dst, Take(n), n); }
+
+	private:
+		FileView const& view_;
+		size_t          pos_;
+};
+
 /* Removes ALL FILES in the specified directory, but leaves the directory alone.
  * Does not affect any subdirectories! */
 void EraseDirectory(char const* pcDirectory);
@@ -95,6 +140,27 @@ public:
 	/** Open file for reading. */
 	static SGPFile* openForReading(const char *filename);
 
+	/** Open an empty file which lives in memory only.
+	 * It can be written, read and seeked like a real file.
+	 * Space for \a reserve bytes is allocated up front. */
+	static SGPFile* openInMemory(size_t reserve = 0);
+
+	/** Open a file in memory on a buffer which is shared with its owner.
+	 * The file starts at position 0 with the contents of the buffer.
+	 * \a on_close, if set, is called after the file has been closed. */
+	static SGPFile* openInMemory(std::shared_ptr<std::vector<BYTE> > const& buffer, std::function<void()> const& on_close);
+
+	/** Read the whole contents of a file with one read into a memory file,
+	 * positioned at the start. The source file is not changed. */
+	static SGPFile* readIntoMemory(SGPFile*);
+
+	/** Get the contents of a file opened with openInMemory(). */
+	static std::vector<BYTE> const& getMemoryFileData(const SGPFile*);
+
+	/** Get the buffer of a file opened with openInMemory(), which can be kept
+	 * after the file is closed. */
+	static std::shared_ptr<std::vector<BYTE> > getMemoryFileBuffer(const SGPFile*);
+
 	/** Open file for reading. */
 	static SGPFile* openForReading(const std::string &filename);
 
@@ -160,6 +226,13 @@ public:
 	/** Move a file */
 	static void moveFile(const char *from, const char *to);
 
+	/** Copy a file, replacing the target if it exists */
+	static void copyFile(const char *from, const char *to);
+
+	/** Get the modification time and size of a file.
+	 * Returns false if there is no such file. */
+	static bool getFileStamp(const char *path, time_t &mtime, uintmax_t &size);
+
 private:
 	/** Private constructor to avoid instantiation. */
 	FileMan() {};
@@ -202,3 +202,32 @@ TEST(FileManTest, SlashifyPath)
 	FileMan::slashifyPath(test);
 	EXPECT_STREQ(test.c_str(), "foo/bar/baz");
 }
+
+TEST(FileManTest, MemoryFile)
+{
+	AutoSGPFile f(FileMan::openInMemory());
+	UINT32 const a = 0x12345678;
+	FileWrite(f, &a, sizeof(a));
+	FileSeek(f, 4, FILE_SEEK_FROM_CURRENT);
+	FileWrite(f, &a, sizeof(a));
+	EXPECT_EQ(FileGetSize(f), 12u);
+	EXPECT_EQ(FileGetPos(f), 12);
+
+	// The gap left by seeking is zero filled
+	UINT32 b = 1;
+	FileSeek(f, 4, FILE_SEEK_FROM_START);
+	FileRead(f, &b, sizeof(b));
+	EXPECT_EQ(b, 0u);
+	FileRead(f, &b, sizeof(b));
+	EXPECT_EQ(b, a);
+	EXPECT_THROW(FileRead(f, &b, 1), std::runtime_error);
+
+	std::vector<BYTE> const& data = FileMan::getMemoryFileData(f);
+	ASSERT_EQ(data.size(), 12u);
+	EXPECT_EQ(memcmp(data.data(), &a, sizeof(a)), 0);
+
+	AutoSGPFile const copy(FileMan::readIntoMemory(f));
+	EXPECT_EQ(FileGetPos(copy), 0);
+	EXPECT_EQ(FileMan::getMemoryFileData(copy), data);
+	EXPECT_EQ(FileGetPos(f), 12);
+}
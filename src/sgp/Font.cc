@@ -1,4 +1,9 @@
+#include <list>
+#include <map>
+#include <memory>
 #include <stdarg.h>
+#include <string>
+#include <unordered_map>
 #include "HImage.h"
 #include "Local.h"
 #include "Types.h"
@@ -32,6 +37,50 @@ static UINT16       SaveFontForeground16 = 0;
 static UINT16       SaveFontShadow16     = 0;
 static UINT16       SaveFontBackground16 = 0;
 
+// Character widths by font, indexed like the TranslationTable
+#define NO_GLYPH_WIDTH 0xFFFF
+static std::unordered_map<SGPFont, std::unique_ptr<UINT16[]> > g_font_widths;
+static SGPFont                                                 g_last_font;
+static UINT16 const*                                           g_last_font_widths;
+
+static GlyphIdx GetGlyphIndex(wchar_t c);
+
+// Memory for strings rendered by MPrintCached()
+#define TEXT_CACHE_BUDGET (1024 * 1024)
+
+struct CachedTextKey
+{
+	SGPFont      font;
+	UINT16       foreground;
+	UINT16       background;
+	UINT16       shadow;
+	std::wstring text;
+
+	bool operator <(CachedTextKey const& o) const
+	{
+		if (font       != o.font)       return font       < o.font;
+		if (foreground != o.foreground) return foreground < o.foreground;
+		if (background != o.background) return background < o.background;
+		if (shadow     != o.shadow)     return shadow     < o.shadow;
+		return text < o.text;
+	}
+};
+
+struct CachedText
+{
+	SGPVSurface* surface;
+	UINT32       size;
+};
+
+// Most recently used first
+typedef std::list<std::pair<CachedTextKey, CachedText> > CachedTextList;
+
+static CachedTextList                                     g_text_cache;
+static std::map<CachedTextKey, CachedTextList::iterator> g_text_cache_index;
+static UINT32                                             g_text_cache_size;
+static UINT32                                             g_text_cache_hits;
+static UINT32                                             g_text_cache_misses;
+
 
 /* Sets both the foreground and the background colors of the current font. The
  * top byte of the parameter word is the background color, and the bottom byte
@@ -97,6 +146,20 @@ SGPFont LoadFontFile(const char *filename)
 void UnloadFont(SGPFont const font)
 {
 	Assert(font);
+	for (CachedTextList::iterator i = g_text_cache.begin(); i != g_text_cache.end();)
+	{
+		if (i->first.font != font) { ++i; continue; }
+		DeleteVideoSurface(i->second.surface);
+		g_text_cache_size -= i->second.size;
+		g_text_cache_index.erase(i->first);
+		i = g_text_cache.erase(i);
+	}
+	g_font_widths.erase(font);
+	if (g_last_font == font)
+	{
+		g_last_font        = 0;
+		g_last_font_widths = 0;
+	}
 	DeleteVideoObject(font);
 }
 
@@ -110,15 +173,49 @@ static UINT32 GetWidth(HVOBJECT const hSrcVObject, GlyphIdx const ssIndex)
 }
 
 
+/* Returns the table of character widths of a font, which is made the first
+ * time the font is measured. Characters without a glyph in the font are
+ * NO_GLYPH_WIDTH, they take the slow way which reports them. */
+static UINT16 const* GetFontWidths(SGPFont const font)
+{
+	if (font == g_last_font) return g_last_font_widths;
+
+	std::unique_ptr<UINT16[]>& widths = g_font_widths[font];
+	if (!widths)
+	{
+		widths.reset(new UINT16[TRANSLATION_TABLE_SIZE]);
+		wchar_t const zero_glyph = getZeroGlyphChar();
+		for (wchar_t c = 0; c != TRANSLATION_TABLE_SIZE; ++c)
+		{
+			GlyphIdx const idx = TranslationTable[c];
+			bool const has_glyph = (idx != 0 || c == zero_glyph) && idx < font->SubregionCount();
+			widths[c] = has_glyph ? GetWidth(font, idx) : NO_GLYPH_WIDTH;
+		}
+	}
+	g_last_font        = font;
+	g_last_font_widths = widths.get();
+	return widths.get();
+}
+
+
 /* Returns the length of a string in pixels, depending on the font given. */
 INT16 StringPixLength(wchar_t const* const string, SGPFont const font)
 {
 	if (!string) return 0;
 
+	UINT16 const* const widths = GetFontWidths(font);
 	UINT32 w = 0;
 	for (wchar_t const* c = string; *c != L'\0'; ++c)
 	{
-		w += GetCharWidth(font, *c);
+		wchar_t const ch = *c;
+		if (0 <= ch && ch < TRANSLATION_TABLE_SIZE && widths[ch] != NO_GLYPH_WIDTH)
+		{
+			w += widths[ch];
+		}
+		else
+		{
+			w += GetWidth(font, GetGlyphIndex(ch));
+		}
 	}
 	return w;
 }
@@ -187,6 +284,11 @@ static GlyphIdx GetGlyphIndex(wchar_t const c)
 
 UINT32 GetCharWidth(HVOBJECT SGPFont, wchar_t c)
 {
+	if (0 <= c && c < TRANSLATION_TABLE_SIZE)
+	{
+		UINT16 const w = GetFontWidths(SGPFont)[c];
+		if (w != NO_GLYPH_WIDTH) return w;
+	}
 	return GetWidth(SGPFont, GetGlyphIndex(c));
 }
 
@@ -313,6 +415,126 @@ void MPrint(INT32 const x, INT32 const y, wchar_t const* const str)
 }
 
 
+static void EvictCachedText()
+{
+	CachedTextList::value_type& e = g_text_cache.back();
+	DeleteVideoSurface(e.second.surface);
+	g_text_cache_size -= e.second.size;
+	g_text_cache_index.erase(e.first);
+	g_text_cache.pop_back();
+}
+
+
+/* Renders a string into a new surface whose background is transparent by a
+ * colour key, which is none of the colours of the string. Returns NULL for
+ * strings which do not fit into a box of their advance width and font height,
+ * or which are empty. */
+static SGPVSurface* RenderText(SGPFont const font, wchar_t const* const str)
+{
+	UINT32 w = 0;
+	UINT32 h = 0;
+	for (wchar_t const* i = str; *i != L'\0'; ++i)
+	{
+		ETRLEObject const& e = font->SubregionProperties(GetGlyphIndex(*i));
+		if (e.sOffsetX < 0 || e.sOffsetY < 0) return NULL;
+		w += e.usWidth + e.sOffsetX;
+		h  = MAX(h, UINT32(e.usHeight + e.sOffsetY));
+	}
+	if (w == 0 || h == 0 || w > 0xFFFF || h > 0xFFFF) return NULL;
+
+	static COLORVAL const keys[] = { FROMRGB(255, 0, 255), FROMRGB(0, 255, 255), FROMRGB(255, 255, 0), FROMRGB(1, 2, 3) };
+	COLORVAL key = keys[0];
+	for (COLORVAL const k : keys)
+	{
+		UINT16 const k16 = Get16BPPColor(k);
+		key = k;
+		if (k16 != FontForeground16 && k16 != FontBackground16 && k16 != FontShadow16) break;
+	}
+
+	SGPVSurface* const vs = AddVideoSurface(w, h, PIXEL_DEPTH);
+	vs->Fill(Get16BPPColor(key));
+	vs->SetTransparency(key);
+	{ SGPVSurface::Lock l(vs);
+		UINT16* const buf   = l.Buffer<UINT16>();
+		UINT32  const pitch = l.Pitch();
+		SGPRect clip = { 0, 0, UINT16(w), UINT16(h) };
+		INT32   x    = 0;
+		for (wchar_t const* i = str; *i != L'\0'; ++i)
+		{
+			GlyphIdx const glyph = GetGlyphIndex(*i);
+			Blt8BPPDataTo16BPPBufferMonoShadowClip(buf, pitch, font, x, 0, glyph, &clip, FontForeground16, FontBackground16, FontShadow16);
+			x += GetWidth(font, glyph);
+		}
+	}
+	return vs;
+}
+
+
+void MPrintCached(INT32 const x, INT32 const y, wchar_t const* const str)
+{
+	MPrintCached(FontDestBuffer, x, y, str);
+}
+
+
+void MPrintCached(SGPVSurface* const dst, INT32 const x, INT32 const y, wchar_t const* const str)
+{
+	CachedTextKey key = { FontDefault, FontForeground16, FontBackground16, FontShadow16, str };
+	SGPVSurface* vs;
+	std::map<CachedTextKey, CachedTextList::iterator>::iterator const i = g_text_cache_index.find(key);
+	if (i != g_text_cache_index.end())
+	{
+		++g_text_cache_hits;
+		g_text_cache.splice(g_text_cache.begin(), g_text_cache, i->second);
+		vs = i->second->second.surface;
+	}
+	else
+	{
+		++g_text_cache_misses;
+		vs = RenderText(FontDefault, str);
+		if (!vs)
+		{
+			SGPVSurface::Lock l(dst);
+			MPrintBuffer(l.Buffer<UINT16>(), l.Pitch(), x, y, str);
+			return;
+		}
+
+		CachedText const t = { vs, UINT32(vs->Width()) * vs->Height() * 2 };
+		while (!g_text_cache.empty() && g_text_cache_size + t.size > TEXT_CACHE_BUDGET)
+		{
+			EvictCachedText();
+		}
+		g_text_cache.push_front(std::make_pair(key, t));
+		g_text_cache_index[key] = g_text_cache.begin();
+		g_text_cache_size += t.size;
+	}
+
+	// Clip to the print region like the glyph blitter does
+	INT32 const x1 = MAX(x, INT32(FontDestRegion.iLeft));
+	INT32 const y1 = MAX(y, INT32(FontDestRegion.iTop));
+	INT32 const x2 = MIN(x + vs->Width(),  INT32(FontDestRegion.iRight));
+	INT32 const y2 = MIN(y + vs->Height(), INT32(FontDestRegion.iBottom));
+	if (x1 >= x2 || y1 >= y2) return;
+
+	SGPBox const box = { UINT16(x1 - x), UINT16(y1 - y), UINT16(x2 - x1), UINT16(y2 - y1) };
+	BltVideoSurface(dst, vs, x1, y1, &box);
+}
+
+
+void ClearTextCache()
+{
+	UINT32 const n = g_text_cache_hits + g_text_cache_misses;
+	if (n != 0)
+	{
+		SLOGD("Text cache: %u hits, %u misses (%u%%), %u strings in %u bytes",
+			g_text_cache_hits, g_text_cache_misses, g_text_cache_hits * 100 / n,
+			UINT32(g_text_cache.size()), g_text_cache_size);
+	}
+	while (!g_text_cache.empty()) EvictCachedText();
+	g_text_cache_hits   = 0;
+	g_text_cache_misses = 0;
+}
+
+
 /* Prints to the currently selected destination buffer, at the X/Y coordinates
  * specified, using the currently selected font. Other than the X/Y coordinates,
  * the parameters are identical to printf. The resulting string may be no longer
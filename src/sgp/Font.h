@@ -41,6 +41,19 @@ void   MPrint(INT32 x, INT32 y, wchar_t const* str);
 void   mprintf(INT32 x, INT32 y, wchar_t const* fmt, ...);
 void   mprintf_buffer(UINT16* pDestBuf, UINT32 uiDestPitchBYTES, INT32 x, INT32 y, wchar_t const* fmt, ...);
 
+/* Like MPrint(), but the string is rendered once into a surface of its own,
+ * which is blitted as a whole while the font, colours and string stay the
+ * same. Meant for static labels, which are drawn over and over. The least
+ * recently used strings are dropped beyond a memory budget. */
+void   MPrintCached(INT32 x, INT32 y, wchar_t const* str);
+
+/* Like MPrintCached(), but to another surface than the font destination
+ * buffer. The clipping rectangle is still the font destination region. */
+void   MPrintCached(SGPVSurface* dst, INT32 x, INT32 y, wchar_t const* str);
+
+/* Drops all strings cached by MPrintCached() and logs the hit rate. */
+void   ClearTextCache();
+
 /* Sets the destination buffer for printing to and the clipping rectangle. */
 void SetFontDestBuffer(SGPVSurface* dst, INT32 x1, INT32 y1, INT32 x2, INT32 y2);
 
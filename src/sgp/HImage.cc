@@ -4,21 +4,12 @@
 #include "Debug.h"
 #include "FileMan.h"
 #include "HImage.h"
-#include "ImpTGA.h"
-#include "PCX.h"
-#include "STCI.h"
 #include "WCheck.h"
 #include "VObject.h"
 #include "MemMan.h"
 
 #include "Logger.h"
 
-// This is the color substituted to keep a 24bpp -> 16bpp color
-// from going transparent (0x0000) -- DB
-
-#define BLACK_SUBSTITUTE	0x0001
-
-
 UINT16 gusRedMask = 0;
 UINT16 gusGreenMask = 0;
 UINT16 gusBlueMask = 0;
@@ -27,24 +18,6 @@ INT16  gusBlueShift = 0;
 INT16  gusGreenShift = 0;
 
 
-SGPImage* CreateImage(const char* const filename, const UINT16 fContents)
-{
-	// depending on extension of filename, use different image readers
-	const char* const dot = strstr(filename, ".");
-	if (!dot)
-	{
-		throw std::logic_error("Tried to load image with no extension");
-	}
-	const char* const ext = dot + 1;
-
-	return
-		strcasecmp(ext, "STI") == 0 ? LoadSTCIFileToImage(filename, fContents) :
-		strcasecmp(ext, "PCX") == 0 ? LoadPCXFileToImage( filename, fContents) :
-		strcasecmp(ext, "TGA") == 0 ? LoadTGAFileToImage( filename, fContents) :
-		throw std::logic_error("Tried to load image with unknown extension");
-}
-
-
 static BOOLEAN Copy8BPPImageTo8BPPBuffer(SGPImage const* const img, BYTE* const pDestBuf, UINT16 const usDestWidth, UINT16 const usDestHeight, UINT16 const usX, UINT16 const usY, SGPBox const* const src_box)
 {
 	CHECKF(usX < usDestWidth);
@@ -184,64 +157,6 @@ UINT16* Create16BPPPalette(const SGPPaletteEntry* pPalette)
 }
 
 
-/**********************************************************************************************
-Create16BPPPaletteShaded
-
-	Creates an 8 bit to 16 bit palette table, and modifies the colors as it builds.
-
-	Parameters:
-		rscale, gscale, bscale:
-				Color mode: Percentages (255=100%) of color to translate into destination palette.
-				Mono mode:  Color for monochrome palette.
-		mono:
-				TRUE or FALSE to create a monochrome palette. In mono mode, Luminance values for
-				colors are calculated, and the RGB color is shaded according to each pixel's brightness.
-
-	This can be used in several ways:
-
-	1) To "brighten" a palette, pass down RGB values that are higher than 100% ( > 255) for all
-			three. mono=FALSE.
-	2) To "darken" a palette, do the same with less than 100% ( < 255) values. mono=FALSE.
-
-	3) To create a "glow" palette, select mono=TRUE, and pass the color in the RGB parameters.
-
-	4) For gamma correction, pass in weighted values for each color.
-
-**********************************************************************************************/
-UINT16* Create16BPPPaletteShaded(const SGPPaletteEntry* pPalette, UINT32 rscale, UINT32 gscale, UINT32 bscale, BOOLEAN mono)
-{
-	Assert(pPalette != NULL);
-
-	UINT16* const p16BPPPalette = MALLOCN(UINT16, 256);
-
-	for (UINT32 cnt = 0; cnt < 256; cnt++)
-	{
-		UINT32 rmod;
-		UINT32 gmod;
-		UINT32 bmod;
-		if (mono)
-		{
-			UINT32 lumin = (pPalette[cnt].r * 299 + pPalette[cnt].g * 587 + pPalette[cnt].b * 114) / 1000;
-			rmod = rscale * lumin / 256;
-			gmod = gscale * lumin / 256;
-			bmod = bscale * lumin / 256;
-		}
-		else
-		{
-			rmod = rscale * pPalette[cnt].r / 256;
-			gmod = gscale * pPalette[cnt].g / 256;
-			bmod = bscale * pPalette[cnt].b / 256;
-		}
-
-		UINT8 r = __min(rmod, 255);
-		UINT8 g = __min(gmod, 255);
-		UINT8 b = __min(bmod, 255);
-		p16BPPPalette[cnt] = Get16BPPColor(FROMRGB(r, g, b));
-	}
-	return p16BPPPalette;
-}
-
-
 // Convert from RGB to 16 bit value
 UINT16 Get16BPPColor( UINT32 RGBValue )
 {
@@ -284,21 +199,18 @@ UINT32 GetRGBColor(UINT16 Value16BPP)
 }
 
 
-void GetETRLEImageData(SGPImage const* const img, ETRLEData* const buf)
+void TakeETRLEImageData(SGPImage* const img, ETRLEData* const buf)
 {
 	Assert(img);
 	Assert(buf);
 
-	SGP::Buffer<ETRLEObject> etrle_objs(img->usNumberOfObjects);
-	memcpy(etrle_objs, img->pETRLEObject, sizeof(*etrle_objs) * img->usNumberOfObjects);
-
-	SGP::Buffer<UINT8> pix_data(img->uiSizePixData);
-	memcpy(pix_data, img->pImageData, sizeof(*pix_data) * img->uiSizePixData);
-
-	buf->pPixData          = pix_data.Release();
+	buf->pPixData          = img->pImageData.Release();
 	buf->uiSizePixData     = img->uiSizePixData;
-	buf->pETRLEObject      = etrle_objs.Release();
+	buf->pETRLEObject      = img->pETRLEObject.Release();
 	buf->usNumberOfObjects = img->usNumberOfObjects;
+
+	img->uiSizePixData     = 0;
+	img->usNumberOfObjects = 0;
 }
 
 
@@ -104,23 +104,33 @@ struct SGPImage
 #define SGPGetGValue(rgb)   ((BYTE) (((UINT16) (rgb)) >> 8))
 
 
+/* Loads the image from the game resources, found in ImageLoader.cc. The image
+ * code itself does not need the content manager. */
 SGPImage* CreateImage(const char* ImageFile, UINT16 fContents);
 
 // This function will run the appropriate copy function based on the type of SGPImage object
 BOOLEAN CopyImageToBuffer(SGPImage const*, UINT32 fBufferType, BYTE* pDestBuf, UINT16 usDestWidth, UINT16 usDestHeight, UINT16 usX, UINT16 usY, SGPBox const* src_rect);
 
 
-// This function will create a buffer in memory of ETRLE data, excluding palette
-void GetETRLEImageData(SGPImage const*, ETRLEData*);
+/* Hands the ETRLE pixel data and objects of the image, excluding palette, over
+ * to the caller without copying them. The image is left without them. */
+void TakeETRLEImageData(SGPImage*, ETRLEData*);
 
 // UTILITY FUNCTIONS
 
-// Used to create a 16BPP Palette from an 8 bit palette, found in himage.c
+// Used to create a 16BPP Palette from an 8 bit palette, found in Shading.cc
 UINT16* Create16BPPPaletteShaded(const SGPPaletteEntry* pPalette, UINT32 rscale, UINT32 gscale, UINT32 bscale, BOOLEAN mono);
+/* Same, into a table of 256 entries the caller provides. Does not allocate, so
+ * it may be called from the worker threads. */
+void    Build16BPPPaletteShaded(UINT16* dst, const SGPPaletteEntry* pPalette, UINT32 rscale, UINT32 gscale, UINT32 bscale, BOOLEAN mono);
 UINT16* Create16BPPPalette(const SGPPaletteEntry* pPalette);
 UINT16 Get16BPPColor( UINT32 RGBValue );
 UINT32 GetRGBColor( UINT16 Value16BPP );
 
+// This is the color substituted to keep a 24bpp -> 16bpp color
+// from going transparent (0x0000) -- DB
+#define BLACK_SUBSTITUTE	0x0001
+
 extern UINT16 gusRedMask;
 extern UINT16 gusGreenMask;
 extern UINT16 gusBlueMask;
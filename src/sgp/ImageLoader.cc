@@ -0,0 +1,31 @@
+#include <stdexcept>
+
+#include "FileMan.h"
+#include "HImage.h"
+#include "ImpTGA.h"
+#include "PCX.h"
+#include "STCI.h"
+
+#include "ContentManager.h"
+#include "GameInstance.h"
+
+
+SGPImage* CreateImage(const char* const filename, const UINT16 fContents)
+{
+	// depending on extension of filename, use different image readers
+	const char* const dot = strstr(filename, ".");
+	if (!dot)
+	{
+		throw std::logic_error("Tried to load image with no extension");
+	}
+	const char* const ext = dot + 1;
+
+	SGPImage* (*const load)(HWFILE, UINT16) =
+		strcasecmp(ext, "STI") == 0 ? LoadSTCIImage :
+		strcasecmp(ext, "PCX") == 0 ? LoadPCXImage  :
+		strcasecmp(ext, "TGA") == 0 ? LoadTGAImage  :
+		throw std::logic_error("Tried to load image with unknown extension");
+
+	AutoSGPFile f(GCM->openGameResForReading(filename));
+	return load(f, fContents);
+}
@@ -9,8 +9,6 @@
 #include "MemMan.h"
 #include "Debug.h"
 
-#include "ContentManager.h"
-#include "GameInstance.h"
 
 static SGPImage* ReadRLEColMapImage(   HWFILE, UINT8 uiImgID, UINT8 uiColMap, UINT16 fContents);
 static SGPImage* ReadRLERGBImage(      HWFILE, UINT8 uiImgID, UINT8 uiColMap, UINT16 fContents);
@@ -18,12 +16,10 @@ static SGPImage* ReadUncompColMapImage(HWFILE, UINT8 uiImgID, UINT8 uiColMap, UI
 static SGPImage* ReadUncompRGBImage(   HWFILE, UINT8 uiImgID, UINT8 uiColMap, UINT16 fContents);
 
 
-SGPImage* LoadTGAFileToImage(char const* const filename, UINT16 const fContents)
+SGPImage* LoadTGAImage(HWFILE const hFile, UINT16 const fContents)
 {
 	UINT8		uiImgID, uiColMap, uiType;
 
-	AutoSGPFile hFile(GCM->openGameResForReading(filename));
-
 	FileRead(hFile, &uiImgID,  sizeof(UINT8));
 	FileRead(hFile, &uiColMap, sizeof(UINT8));
 	FileRead(hFile, &uiType,   sizeof(UINT8));
@@ -8,6 +8,7 @@
 #include "Timer.h"
 #include "Video.h"
 #include "Local.h"
+#include "Profiler.h"
 #include "UILayout.h"
 
 
@@ -317,6 +318,12 @@ void KeyDown(const SDL_Keysym* KeySym)
 		case SDLK_SCROLLLOCK:
 			break;
 
+		case SDLK_F11:
+		case SDLK_F12:
+			// Alt+F11 and Alt+F12 are the profiler hotkeys, see KeyUp()
+			if (_KeyDown(ALT)) break;
+			/* FALLTHROUGH */
+
 		default:
 			KeyChange(KeySym, true);
 			break;
@@ -344,7 +351,14 @@ void KeyUp(const SDL_Keysym* KeySym)
 			break;
 
 		case SDLK_PRINTSCREEN:
-			PrintScreen();
+			if (_KeyDown(CTRL))
+			{
+				VideoToggleCapture();
+			}
+			else
+			{
+				PrintScreen();
+			}
 			break;
 
 		case SDLK_SCROLLLOCK:
@@ -356,6 +370,24 @@ void KeyUp(const SDL_Keysym* KeySym)
 			);
 			break;
 
+		case SDLK_F11:
+			if (_KeyDown(ALT))
+			{
+				ToggleProfilerOverlay();
+				break;
+			}
+			KeyChange(KeySym, false);
+			break;
+
+		case SDLK_F12:
+			if (_KeyDown(ALT))
+			{
+				DumpProfilerTrace();
+				break;
+			}
+			KeyChange(KeySym, false);
+			break;
+
 		case SDLK_RETURN:
 			if (_KeyDown(ALT))
 			{
@@ -0,0 +1,287 @@
+#include "InputReplay.h"
+
+#include "FileMan.h"
+#include "Logger.h"
+#include "Profiler.h"
+#include "Timer.h"
+#include "Video.h"
+
+#include <SDL.h>
+
+#include <chrono>
+#include <random>
+#include <stdexcept>
+#include <string.h>
+#include <string>
+#include <vector>
+
+
+#define INPUT_REPLAY_MAGIC   "JA2R"
+#define INPUT_REPLAY_VERSION 1
+
+
+struct InputReplayHeader
+{
+	char   magic[4];
+	UINT32 version;
+	UINT32 seed;
+	UINT32 ms_per_cycle;
+};
+
+/* An event and the game cycle it was handled before. The end of a recording
+ * is marked by an event of type SDL_FIRSTEVENT, which gives the number of game
+ * cycles which were run. */
+struct InputReplayEvent
+{
+	UINT32 cycle;
+	UINT32 type;
+	INT32  a; // key: keycode,  button: button, wheel: x
+	INT32  b; // key: scancode, button/motion: x, wheel: y
+	INT32  c; // key: modifiers, button/motion: y, wheel: direction
+	INT32  d; // key: repeat,   button: clicks
+	char   text[SDL_TEXTINPUTEVENT_TEXT_SIZE];
+};
+
+
+enum InputReplayMode
+{
+	INPUT_REPLAY_OFF,
+	INPUT_REPLAY_RECORD,
+	INPUT_REPLAY_PLAY
+};
+
+static InputReplayMode               g_mode;
+static InputReplayHeader             g_header;
+static SGPFile*                      g_record_file;
+static std::vector<InputReplayEvent> g_events;
+static size_t                        g_next_event;
+static UINT32                        g_cycle;
+static uint64_t                      g_replay_start; // performance counter at the first replayed cycle
+
+
+static void StartFixedClock(UINT32 const ms_per_cycle)
+{
+	g_header.ms_per_cycle = ms_per_cycle;
+	g_cycle               = 0;
+	SetClockFixed(true);
+}
+
+
+void StartInputRecording(char const* const path, UINT32 const msPerCycle)
+{
+	g_record_file = FileMan::openForWriting(path);
+
+	std::random_device random_device;
+	UINT32 const seed = random_device() ^ (UINT32)std::chrono::system_clock::now().time_since_epoch().count();
+
+	memcpy(g_header.magic, INPUT_REPLAY_MAGIC, sizeof(g_header.magic));
+	g_header.version = INPUT_REPLAY_VERSION;
+	g_header.seed    = seed;
+	StartFixedClock(msPerCycle);
+	FileWrite(g_record_file, &g_header, sizeof(g_header));
+
+	g_mode = INPUT_REPLAY_RECORD;
+	SLOGI("Recording input into '%s', seed %u", path, seed);
+}
+
+
+void StartInputReplay(char const* const path, bool const present)
+{
+	AutoSGPFile f(FileMan::openForReading(path));
+	UINT32 const size = FileGetSize(f);
+	if (size < sizeof(g_header) || (size - sizeof(g_header)) % sizeof(InputReplayEvent) != 0)
+	{
+		throw std::runtime_error(std::string("Not an input recording: ") + path);
+	}
+	FileRead(f, &g_header, sizeof(g_header));
+	if (memcmp(g_header.magic, INPUT_REPLAY_MAGIC, sizeof(g_header.magic)) != 0 ||
+		g_header.version != INPUT_REPLAY_VERSION)
+	{
+		throw std::runtime_error(std::string("Not an input recording of this version: ") + path);
+	}
+	g_events.resize((size - sizeof(g_header)) / sizeof(InputReplayEvent));
+	if (!g_events.empty()) FileRead(f, g_events.data(), g_events.size() * sizeof(InputReplayEvent));
+	if (g_events.empty() || g_events.back().type != SDL_FIRSTEVENT)
+	{
+		SLOGW("The input recording '%s' is incomplete, it is replayed up to its last event", path);
+	}
+	g_next_event = 0;
+
+	StartFixedClock(g_header.ms_per_cycle);
+	VideoSetPresent(present);
+
+	g_mode = INPUT_REPLAY_PLAY;
+	SLOGI("Replaying input from '%s', %u events, seed %u", path, static_cast<UINT>(g_events.size()), g_header.seed);
+}
+
+
+bool IsRecordingInput()
+{
+	return g_mode == INPUT_REPLAY_RECORD;
+}
+
+
+bool IsReplayingInput()
+{
+	return g_mode == INPUT_REPLAY_PLAY;
+}
+
+
+UINT32 GetInputReplaySeed()
+{
+	return g_header.seed;
+}
+
+
+static void WriteEvent(InputReplayEvent const& e)
+{
+	FileWrite(g_record_file, &e, sizeof(e));
+}
+
+
+void RecordInputEvent(SDL_Event const& event)
+{
+	if (g_mode != INPUT_REPLAY_RECORD) return;
+
+	InputReplayEvent e;
+	memset(&e, 0, sizeof(e));
+	e.cycle = g_cycle;
+	e.type  = event.type;
+	switch (event.type)
+	{
+		case SDL_KEYDOWN:
+		case SDL_KEYUP:
+			e.a = event.key.keysym.sym;
+			e.b = event.key.keysym.scancode;
+			e.c = event.key.keysym.mod;
+			e.d = event.key.repeat;
+			break;
+
+		case SDL_TEXTINPUT:
+			memcpy(e.text, event.text.text, sizeof(e.text));
+			break;
+
+		case SDL_MOUSEBUTTONDOWN:
+		case SDL_MOUSEBUTTONUP:
+			e.a = event.button.button;
+			e.b = event.button.x;
+			e.c = event.button.y;
+			e.d = event.button.clicks;
+			break;
+
+		case SDL_MOUSEMOTION:
+			e.b = event.motion.x;
+			e.c = event.motion.y;
+			break;
+
+		case SDL_MOUSEWHEEL:
+			e.a = event.wheel.x;
+			e.b = event.wheel.y;
+			e.c = event.wheel.direction;
+			break;
+
+		default: return;
+	}
+	WriteEvent(e);
+}
+
+
+bool PollReplayEvent(SDL_Event& event)
+{
+	if (g_replay_start == 0) g_replay_start = SDL_GetPerformanceCounter();
+
+	if (g_next_event == g_events.size()) return false;
+	InputReplayEvent const& e = g_events[g_next_event];
+	if (e.cycle != g_cycle || e.type == SDL_FIRSTEVENT) return false;
+	++g_next_event;
+
+	memset(&event, 0, sizeof(event));
+	event.type = e.type;
+	event.common.timestamp = GetClock();
+	switch (e.type)
+	{
+		case SDL_KEYDOWN:
+		case SDL_KEYUP:
+			event.key.state           = e.type == SDL_KEYDOWN ? SDL_PRESSED : SDL_RELEASED;
+			event.key.repeat          = e.d;
+			event.key.keysym.sym      = e.a;
+			event.key.keysym.scancode = static_cast<SDL_Scancode>(e.b);
+			event.key.keysym.mod      = e.c;
+			break;
+
+		case SDL_TEXTINPUT:
+			memcpy(event.text.text, e.text, sizeof(event.text.text));
+			event.text.text[sizeof(event.text.text) - 1] = '\0';
+			break;
+
+		case SDL_MOUSEBUTTONDOWN:
+		case SDL_MOUSEBUTTONUP:
+			event.button.state  = e.type == SDL_MOUSEBUTTONDOWN ? SDL_PRESSED : SDL_RELEASED;
+			event.button.button = e.a;
+			event.button.x      = e.b;
+			event.button.y      = e.c;
+			event.button.clicks = e.d;
+			break;
+
+		case SDL_MOUSEMOTION:
+			event.motion.x = e.b;
+			event.motion.y = e.c;
+			break;
+
+		case SDL_MOUSEWHEEL:
+			event.wheel.x         = e.a;
+			event.wheel.y         = e.b;
+			event.wheel.direction = e.c;
+			break;
+	}
+	return true;
+}
+
+
+bool InputReplayFinished()
+{
+	if (g_next_event == g_events.size()) return true;
+	InputReplayEvent const& e = g_events[g_next_event];
+	return e.type == SDL_FIRSTEVENT && g_cycle >= e.cycle;
+}
+
+
+void EndInputReplayCycle()
+{
+	if (g_mode == INPUT_REPLAY_OFF) return;
+	++g_cycle;
+	AdvanceFixedClock(g_header.ms_per_cycle);
+}
+
+
+void ShutdownInputReplay()
+{
+	switch (g_mode)
+	{
+		case INPUT_REPLAY_OFF: return;
+
+		case INPUT_REPLAY_RECORD:
+		{
+			InputReplayEvent end;
+			memset(&end, 0, sizeof(end));
+			end.cycle = g_cycle;
+			end.type  = SDL_FIRSTEVENT;
+			WriteEvent(end);
+			FileClose(g_record_file);
+			g_record_file = 0;
+			SLOGI("Recorded %u game cycles", g_cycle);
+			break;
+		}
+
+		case INPUT_REPLAY_PLAY:
+		{
+			double const ms = g_replay_start == 0 ? 0 :
+				(SDL_GetPerformanceCounter() - g_replay_start) * 1000.0 / SDL_GetPerformanceFrequency();
+			SLOGI("Replayed %u game cycles in %.1f ms, %.3f ms per cycle", g_cycle, ms, g_cycle != 0 ? ms / g_cycle : 0.);
+			LogProfilerTotals();
+			break;
+		}
+	}
+	g_mode = INPUT_REPLAY_OFF;
+	SetClockFixed(false);
+}
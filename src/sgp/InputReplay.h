@@ -0,0 +1,50 @@
+#ifndef INPUT_REPLAY_H
+#define INPUT_REPLAY_H
+
+#include "Types.h"
+
+#include <SDL_events.h>
+
+
+/* Recording and replaying of the input, for reproducible benchmarks.
+ *
+ * While recording or replaying the game runs on a fixed clock, which advances
+ * by one game cycle per GameLoop() call, and the random numbers are seeded
+ * from the recording. So the game takes the same course on replay as long as
+ * it gets the same input in the same game cycles, however long the cycles
+ * take. The SDL input events are recorded rather than the input atoms, because
+ * the mouse position is not part of the atoms. */
+
+/* Starts recording into a new file. The game cycles are msPerCycle apart on
+ * the fixed clock. Throws if the file cannot be created. */
+void StartInputRecording(char const* path, UINT32 msPerCycle);
+
+/* Loads a recording to replay. With present off the frames are rendered, but
+ * not shown in the window. Throws if the file is not a recording. */
+void StartInputReplay(char const* path, bool present);
+
+bool IsRecordingInput();
+bool IsReplayingInput();
+
+/* The seed for SeedRandom() while recording or replaying. */
+UINT32 GetInputReplaySeed();
+
+/* Records an event which is handled before the current game cycle. Events
+ * which do not reach the game are ignored. */
+void RecordInputEvent(SDL_Event const&);
+
+/* Gets the next recorded event which was handled before the current game
+ * cycle. Returns false when there are no more for this cycle. */
+bool PollReplayEvent(SDL_Event&);
+
+/* Whether all game cycles of the recording have been run. */
+bool InputReplayFinished();
+
+/* Counts a game cycle and advances the fixed clock, if input is recorded or
+ * replayed. */
+void EndInputReplayCycle();
+
+/* Finishes the recording file, or logs the time the replay took. */
+void ShutdownInputReplay();
+
+#endif
@@ -2,6 +2,67 @@
 
 #include <algorithm>
 
+#if defined __SSE2__ || defined _M_X64 || (defined _M_IX86_FP && _M_IX86_FP >= 2)
+#	define ASCII_SSE2
+#	include <emmintrin.h>
+#endif
+
+
+/** Whether the UTF-16 code unit is half of a surrogate pair. */
+static inline bool IsSurrogate(uint32_t const unit)
+{
+	return 0xD800 <= unit && unit < 0xE000;
+}
+
+
+/** Copy the UTF-16 code units up to the first 0x0000, at most \a numChars, into
+ * the buffer as chars, if they are all ASCII.
+ * @return the number of characters, or -1 if one of them is not ASCII */
+static ptrdiff_t NarrowASCII(const char16_t *units, size_t numChars, char *buf)
+{
+	size_t i = 0;
+#if defined ASCII_SSE2
+	__m128i const zero     = _mm_setzero_si128();
+	__m128i const non_ascii = _mm_set1_epi16(static_cast<short>(0xFF80));
+	for (; i + 8 <= numChars; i += 8)
+	{
+		__m128i const v     = _mm_loadu_si128(reinterpret_cast<__m128i const*>(units + i));
+		__m128i const ascii = _mm_cmpeq_epi16(_mm_and_si128(v, non_ascii), zero);
+		__m128i const end   = _mm_cmpeq_epi16(v, zero);
+		// the block with the end or a non-ASCII unit is left to the loop below
+		if (_mm_movemask_epi8(_mm_andnot_si128(end, ascii)) != 0xFFFF) break;
+		_mm_storel_epi64(reinterpret_cast<__m128i*>(buf + i), _mm_packus_epi16(v, v));
+	}
+#endif
+	for (; i < numChars; ++i)
+	{
+		char16_t const c = units[i];
+		if (c == u'\0') break;
+		if (c >= 0x80) return -1;
+		buf[i] = static_cast<char>(c);
+	}
+	return static_cast<ptrdiff_t>(i);
+}
+
+
+/** Make a string of the UTF-16 code units up to the first 0x0000, at most \a numChars.
+ * Plain ASCII text, most of the text of the game, is copied without a conversion.
+ * Can throw ST::unicode_error. */
+ST::string utf16_to_string(const char16_t *units, size_t numChars)
+{
+	char ascii[256];
+	if (numChars <= lengthof(ascii))
+	{
+		ptrdiff_t const n = NarrowASCII(units, numChars, ascii);
+		if (n >= 0) return ST::string::from_utf8(ascii, n, ST::assume_valid);
+	}
+
+	size_t n = 0;
+	while (n < numChars && units[n] != u'\0') ++n;
+	return ST::string::from_utf16(units, n);
+}
+
+
 /** Encode wchar_t into UTF-16 and write to the buffer.
  * @param string        String to encode
  * @param outputBuf     Output buffer for the encoded string
@@ -10,6 +71,22 @@ void wchar_to_utf16(const wchar_t *string, void *outputBuf, size_t charsToWrite)
 {
 	if(charsToWrite > 0)
 	{
+		// Characters of the BMP are their own code unit, only the others need converting
+		char16_t* const out = static_cast<char16_t*>(outputBuf);
+		size_t i = 0;
+		for (; i < charsToWrite; ++i)
+		{
+			uint32_t const c = static_cast<uint32_t>(string[i]);
+			if (c == 0)
+			{
+				std::fill_n(out + i, charsToWrite - i, u'\0');
+				return;
+			}
+			if (c > 0xFFFF || IsSurrogate(c)) break;
+			out[i] = static_cast<char16_t>(c);
+		}
+		if (i == charsToWrite) return; // might not terminate with '\0'
+
 		ST::utf16_buffer data = ST::string::from_wchar(string).to_utf16();
 		size_t charsToCopy = std::min<size_t>(charsToWrite, data.size());
 		memcpy(outputBuf, data.c_str(), charsToCopy * 2);
@@ -97,23 +174,20 @@ DataReader::DataReader(const void *buf)
 ST::string DataReader::readUTF16(size_t numChars, const IEncodingCorrector *fixer)
 {
 	if (numChars == 0) return ST::null;
-	ST::utf16_buffer data;
-	data.allocate(numChars);
-	if (fixer)
+	if (!fixer)
 	{
-		for (size_t i = 0; i < numChars; i++)
-		{
-			data[i] = fixer->fix(readU16());
-		}
+		ST::string const s = utf16_to_string(static_cast<const char16_t*>(m_buf), numChars); // can throw ST::unicode_error
+		move(static_cast<int>(2 * numChars));
+		return s;
 	}
-	else
+
+	ST::utf16_buffer data;
+	data.allocate(numChars);
+	for (size_t i = 0; i < numChars; i++)
 	{
-		for (size_t i = 0; i < numChars; i++)
-		{
-			data[i] = readU16();
-		}
+		data[i] = fixer->fix(readU16());
 	}
-	return ST::string::from_utf16(data.c_str()); // can throw ST::unicode_error
+	return utf16_to_string(data.c_str(), numChars); // can throw ST::unicode_error
 }
 
 /** Read UTF-32 encoded string.
@@ -137,6 +211,21 @@ ST::string DataReader::readUTF32(size_t numChars)
 void DataReader::readUTF16(wchar_t *buffer, size_t numChars, const IEncodingCorrector *fixer)
 {
 	if (numChars == 0) return;
+
+	// Code units outside of surrogate pairs are their own character
+	const uint16_t* const units = static_cast<const uint16_t*>(m_buf);
+	for (size_t i = 0; i < numChars; ++i)
+	{
+		uint16_t const c = fixer ? fixer->fix(units[i]) : units[i];
+		if (IsSurrogate(c)) break;
+		buffer[i] = c;
+		if (c == 0 || i + 1 == numChars) // might not terminate with '\0'
+		{
+			move(static_cast<int>(2 * numChars));
+			return;
+		}
+	}
+
 	ST::wchar_buffer wstr = readUTF16(numChars, fixer).to_wchar();
 	size_t const charsToCopy = std::min<size_t>(wstr.size() + 1, numChars);
 	memcpy(buffer, wstr.c_str(), charsToCopy * sizeof(wchar_t)); // might not terminate with '\0'
@@ -39,6 +39,11 @@
 ////////////////////////////////////////////////////////////////////////////
 
 
+/** Make a string of UTF-16 code units.
+ * @param units     Code units of the string
+ * @param numChars  Number of code units, the string ends earlier at 0x0000 */
+ST::string utf16_to_string(const char16_t *units, size_t numChars);
+
 /** Encode wchar_t into UTF-16 and write to the buffer.
  * @param string        String to encode
  * @param outputBuf     Output buffer for the encoded string
@@ -126,6 +126,49 @@ TEST(LoadSaveData, utf16ToWideString)
 	}
 }
 
+TEST(LoadSaveData, utf16FastPaths)
+{
+	char buf[100];
+	DataWriter writer(buf);
+
+	// ASCII, longer than one SIMD block
+	writer.writeStringAsUTF16(L"Hello, Arulco!", 16);
+	// not ASCII, and a pair of surrogates
+	writer.writeU16(0x0442);
+	writer.writeU16(0xD83D);
+	writer.writeU16(0xDE00);
+	writer.writeU16(0x0000);
+
+	{
+		DataReader reader(buf);
+		EXPECT_EQ(reader.readUTF16(16), "Hello, Arulco!"_st);
+		EXPECT_EQ(reader.readUTF16(4), "т\xF0\x9F\x98\x80"_st);
+		EXPECT_EQ(reader.getConsumed(), 40u);
+	}
+
+	{
+		DataReader reader(buf);
+		wchar_t wideBuf[20];
+		reader.readUTF16(wideBuf, 16);
+		EXPECT_STREQ(wideBuf, L"Hello, Arulco!");
+		EXPECT_EQ(reader.getConsumed(), 32u);
+	}
+
+	{
+		// without a terminator within the characters read
+		DataReader reader(buf);
+		wchar_t wideBuf[6];
+		wideBuf[5] = L'x';
+		reader.readUTF16(wideBuf, 5);
+		EXPECT_EQ(wideBuf[4], L'o');
+		EXPECT_EQ(wideBuf[5], L'x');
+		EXPECT_EQ(reader.getConsumed(), 10u);
+	}
+
+	EXPECT_EQ(utf16_to_string(u"plain\0rest", 10), "plain"_st);
+	EXPECT_EQ(utf16_to_string(u"plain", 3), "pla"_st);
+}
+
 TEST(LoadSaveData, utf32ToWideString)
 {
 	char buf[100];
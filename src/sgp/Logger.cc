@@ -1,5 +1,6 @@
 #include "Logger.h"
 
+#include <atomic>
 #include <stdio.h>
 #if defined(_MSC_VER)
   /* Visual Studio */
@@ -12,9 +13,23 @@
   #include <unistd.h>
 #endif
 
+static std::atomic<LogHook> g_hook(NULL);
+
+void SetLogHook(LogHook hook) {
+  g_hook.store(hook);
+}
+
 void LogMessage(bool isAssert, LogLevel level, const char *file, const char *format, ...) {
-  char message[256];
   va_list args;
+  LogHook const hook = g_hook.load();
+  if (!isAssert && hook) {
+    va_start(args, format);
+    bool const taken = hook(level, file, format, args);
+    va_end(args);
+    if (taken) return;
+  }
+
+  char message[256];
   va_start(args, format);
   vsnprintf(message, 256, format, args);
   va_end(args);
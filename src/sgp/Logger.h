@@ -2,8 +2,19 @@
 
 #include "RustInterface.h"
 
+#include <stdarg.h>
+
 void LogMessage(bool isAssert, LogLevel level, const char *file, const char *format, ...);
 
+/**
+ * Takes over the messages of LogMessage(), but for assertions, before they are
+ * formatted. Returns false to have the message written right away.
+ */
+typedef bool (*LogHook)(LogLevel level, const char *file, const char *format, va_list args);
+
+/** Sets the hook, or NULL to write every message right away. */
+void SetLogHook(LogHook hook);
+
 /** Print debug message macro. */
 #define SLOGD(FORMAT, ...) LogMessage(false, LogLevel::Debug, __FILE__, FORMAT, ##__VA_ARGS__)
 
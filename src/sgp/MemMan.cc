@@ -5,6 +5,8 @@
 //		11sep96:HJH	- Creation
 //    29may97:ARM - Fix & improve MemDebugCounter handling, logging of
 //                    MemAlloc/MemFree, and reporting of any errors
+#include <atomic>
+#include <cstddef>
 #include <stdexcept>
 #include <new> // std::bad_alloc
 
@@ -16,18 +18,45 @@
 #include "MouseSystem.h"
 #include "MessageBoxScreen.h"
 
-// debug variable for total memory currently allocated
-static size_t guiMemAlloced    = 0;
-static size_t guiMemFreed      = 0;
-static UINT32 MemDebugCounter  = 0;
+/* Every block starts with a header, which records the size and tag for the
+ * accounting. It is as large as the alignment malloc() guarantees, so the
+ * memory handed out stays aligned. */
+struct alignas(std::max_align_t) MemHeader
+{
+	size_t size;
+	UINT32 tag;
+	UINT32 magic;
+};
+
+#define MEM_MAGIC 0x4D454D54 // "MEMT"
+
+struct MemTagCounters
+{
+	std::atomic<size_t> live_bytes;
+	std::atomic<size_t> peak_bytes;
+	std::atomic<size_t> live_blocks;
+	std::atomic<size_t> allocs;
+};
+
+static MemTagCounters g_mem_tags[MEM_NUM_TAGS];
+
+static char const* const g_mem_tag_names[] =
+{
+	"other",
+	"world",
+	"render",
+	"sound",
+	"ai",
+	"strategic"
+};
+
+static thread_local MemTag g_mem_tag = MEM_TAG_OTHER;
+
 static BOOLEAN fMemManagerInit = FALSE;
 
 
 void InitializeMemoryManager(void)
 {
-	MemDebugCounter = 0;
-	guiMemAlloced   = 0;
-	guiMemFreed     = 0;
 	fMemManagerInit = TRUE;
 }
 
@@ -35,27 +64,108 @@ void InitializeMemoryManager(void)
 // Shuts down the memory manager.
 void ShutdownMemoryManager(void)
 {
-	if (MemDebugCounter != 0)
+	for (UINT i = 0; i != MEM_NUM_TAGS; ++i)
 	{
-		SLOGE("Memory leak detected: \n\
-					%d memory blocks still allocated\n\
-					%d bytes memory total was allocated\n\
-					%d bytes memory total was freed",
-					MemDebugCounter, guiMemAlloced, guiMemFreed);
+		MemTagStats const s = GetMemTagStats(MemTag(i));
+		if (s.live_blocks == 0) continue;
+		SLOGW("Memory leak detected: %u blocks of %u bytes still allocated for %s (peak %u bytes)",
+			UINT32(s.live_blocks), UINT32(s.live_bytes), g_mem_tag_names[i], UINT32(s.peak_bytes));
 	}
 	fMemManagerInit = FALSE;
 }
 
-void* XMalloc(size_t const size)
+
+static void CountAlloc(MemTagCounters& c, size_t const size)
+{
+	size_t const live = c.live_bytes += size;
+	++c.live_blocks;
+	++c.allocs;
+	size_t peak = c.peak_bytes;
+	while (live > peak && !c.peak_bytes.compare_exchange_weak(peak, live)) {}
+}
+
+
+static void CountFree(MemTagCounters& c, size_t const size)
+{
+	c.live_bytes -= size;
+	--c.live_blocks;
+}
+
+
+static void* InitHeader(void* const block, size_t const size, MemTag const tag)
+{
+	MemHeader* const h = static_cast<MemHeader*>(block);
+	h->size  = size;
+	h->tag   = tag;
+	h->magic = MEM_MAGIC;
+	CountAlloc(g_mem_tags[tag], size);
+	return h + 1;
+}
+
+
+void* XMallocTag(size_t const size, MemTag const tag)
 {
-	void* const p = malloc(size);
+	void* const p = malloc(sizeof(MemHeader) + size);
 	if (!p) throw std::bad_alloc();
-	return p;
+	return InitHeader(p, size, tag);
+}
+
+
+void* XMalloc(size_t const size)
+{
+	return XMallocTag(size, g_mem_tag);
 }
 
+
 void* XRealloc(void* const ptr, size_t const size)
 {
-	void* const p = realloc(ptr, size);
+	if (!ptr) return XMalloc(size);
+
+	MemHeader* const old = static_cast<MemHeader*>(ptr) - 1;
+	Assert(old->magic == MEM_MAGIC);
+	size_t const old_size = old->size;
+	MemTag const tag      = MemTag(old->tag);
+
+	void* const p = realloc(old, sizeof(MemHeader) + size);
 	if (!p) throw std::bad_alloc();
-	return p;
+	CountFree(g_mem_tags[tag], old_size);
+	return InitHeader(p, size, tag);
+}
+
+
+void XFree(void* const ptr)
+{
+	if (!ptr) return;
+
+	/* Memory of another allocator must go back to that one, freeing it here is
+	 * a bug of the caller. If assertions do not abort, it is leaked rather
+	 * than handed to free() at the wrong address. */
+	MemHeader* const h = static_cast<MemHeader*>(ptr) - 1;
+	AssertMsg(h->magic == MEM_MAGIC, "Freeing memory which was not allocated by the memory manager");
+	if (h->magic != MEM_MAGIC) return;
+	h->magic = 0;
+	CountFree(g_mem_tags[h->tag], h->size);
+	free(h);
+}
+
+
+MemTagStats GetMemTagStats(MemTag const tag)
+{
+	MemTagCounters const& c = g_mem_tags[tag];
+	MemTagStats const s = { c.live_bytes, c.peak_bytes, c.live_blocks, c.allocs };
+	return s;
+}
+
+
+char const* GetMemTagName(MemTag const tag)
+{
+	return g_mem_tag_names[tag];
+}
+
+
+MemTag SetMemTag(MemTag const tag)
+{
+	MemTag const prev = g_mem_tag;
+	g_mem_tag = tag;
+	return prev;
 }
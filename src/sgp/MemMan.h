@@ -11,14 +11,57 @@
 #include <algorithm>
 #include <stdlib.h>
 
-#define MemAlloc(size)        XMalloc((size))
-#define MemFree(ptr)          free((ptr))
-#define MemRealloc(ptr, size) XRealloc((ptr), (size))
+#define MemAlloc(size)          XMalloc((size))
+#define MemAllocTag(size, tag)  XMallocTag((size), (tag))
+#define MemFree(ptr)            XFree((ptr))
+#define MemRealloc(ptr, size)   XRealloc((ptr), (size))
+
+/* Subsystems the allocations are accounted to. An allocation is accounted to
+ * the tag given to MemAllocTag(), else to the innermost MemTagScope of the
+ * allocating thread. Reallocating keeps the tag. */
+enum MemTag
+{
+	MEM_TAG_OTHER,
+	MEM_TAG_WORLD,
+	MEM_TAG_RENDER,
+	MEM_TAG_SOUND,
+	MEM_TAG_AI,
+	MEM_TAG_STRATEGIC,
+	MEM_NUM_TAGS
+};
+
+struct MemTagStats
+{
+	size_t live_bytes;
+	size_t peak_bytes;
+	size_t live_blocks;
+	size_t allocs; // allocations and reallocations over all time
+};
 
 void InitializeMemoryManager(void);
 void ShutdownMemoryManager(void);
 void* XMalloc(size_t size);
+void* XMallocTag(size_t size, MemTag);
 void* XRealloc(void* ptr, size_t size);
+void  XFree(void* ptr);
+
+MemTagStats GetMemTagStats(MemTag);
+char const* GetMemTagName(MemTag);
+
+/* Sets the tag of the allocations of this thread and returns the former one. */
+MemTag SetMemTag(MemTag);
+
+class MemTagScope
+{
+	public:
+		explicit MemTagScope(MemTag const tag) : prev_(SetMemTag(tag)) {}
+		~MemTagScope() { SetMemTag(prev_); }
+
+	private:
+		MemTag const prev_;
+};
+
+#define MEM_TAG_SCOPE(tag) MemTagScope const mem_tag_scope_(tag)
 
 static inline void* MallocZ(const size_t n)
 {
@@ -0,0 +1,41 @@
+#include "gtest/gtest.h"
+
+#include "MemMan.h"
+
+
+TEST(MemManTest, CountsPerTag)
+{
+	MemTagStats const before = GetMemTagStats(MEM_TAG_AI);
+
+	UINT8* p;
+	{
+		MEM_TAG_SCOPE(MEM_TAG_AI);
+		p = MALLOCN(UINT8, 100);
+	}
+	MemTagStats s = GetMemTagStats(MEM_TAG_AI);
+	EXPECT_EQ(s.live_bytes,  before.live_bytes + 100);
+	EXPECT_EQ(s.live_blocks, before.live_blocks + 1);
+	EXPECT_GE(s.peak_bytes,  s.live_bytes);
+
+	// Growing keeps the tag, even outside of the scope
+	p = REALLOC(p, UINT8, 300);
+	s = GetMemTagStats(MEM_TAG_AI);
+	EXPECT_EQ(s.live_bytes,  before.live_bytes + 300);
+	EXPECT_EQ(s.live_blocks, before.live_blocks + 1);
+
+	MemFree(p);
+	s = GetMemTagStats(MEM_TAG_AI);
+	EXPECT_EQ(s.live_bytes,  before.live_bytes);
+	EXPECT_EQ(s.live_blocks, before.live_blocks);
+	EXPECT_EQ(s.allocs,      before.allocs + 2);
+}
+
+
+TEST(MemManTest, ExplicitTag)
+{
+	MemTagStats const before = GetMemTagStats(MEM_TAG_SOUND);
+	void* const p = MemAllocTag(64, MEM_TAG_SOUND);
+	EXPECT_EQ(GetMemTagStats(MEM_TAG_SOUND).live_bytes, before.live_bytes + 64);
+	MemFree(p);
+	EXPECT_EQ(GetMemTagStats(MEM_TAG_SOUND).live_bytes, before.live_bytes);
+}
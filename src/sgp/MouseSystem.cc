@@ -11,7 +11,9 @@
 //
 //=================================================================================================
 
+#include <algorithm>
 #include <stdexcept>
+#include <vector>
 
 #include "Font.h"
 #include "HImage.h"
@@ -58,6 +60,24 @@ static MOUSE_REGION* g_clicked_region;
 
 static MOUSE_REGION* MSYS_RegList = NULL;
 
+/* The regions are also kept in a coarse grid over the screen, so finding the
+ * region under the mouse does not have to walk the whole list. A cell holds
+ * the regions overlapping it in the order of the list. The stamp orders regions
+ * of equal priority, the latest to enter the list comes first. Anything beyond
+ * the grid falls into the cells on its edge. */
+#define MSYS_GRID_CELL_SIZE 64
+#define MSYS_GRID_W         32
+#define MSYS_GRID_H         32
+
+struct MSYS_GridEntry
+{
+	UINT32        stamp;
+	MOUSE_REGION* region;
+};
+
+static std::vector<MSYS_GridEntry> MSYS_Grid[MSYS_GRID_W * MSYS_GRID_H];
+static UINT32                      MSYS_GridStamp = 0;
+
 static MOUSE_REGION* MSYS_PrevRegion = 0;
 static MOUSE_REGION* MSYS_CurrRegion = NULL;
 
@@ -202,6 +222,64 @@ static void MSYS_TrashRegList(void)
 }
 
 
+static INT32 MSYS_GridCell(INT32 const v, INT32 const n)
+{
+	INT32 const c = v / MSYS_GRID_CELL_SIZE;
+	return c < 0 ? 0 : c < n ? c : n - 1;
+}
+
+
+static void MSYS_AddRegionToGrid(MOUSE_REGION* const r, UINT32 const stamp)
+{
+	INT32 const x0 = MSYS_GridCell(r->RegionTopLeftX,     MSYS_GRID_W);
+	INT32 const y0 = MSYS_GridCell(r->RegionTopLeftY,     MSYS_GRID_H);
+	INT32 const x1 = MSYS_GridCell(r->RegionBottomRightX, MSYS_GRID_W);
+	INT32 const y1 = MSYS_GridCell(r->RegionBottomRightY, MSYS_GRID_H);
+	for (INT32 y = y0; y <= y1; ++y)
+	{
+		for (INT32 x = x0; x <= x1; ++x)
+		{
+			std::vector<MSYS_GridEntry>& cell = MSYS_Grid[y * MSYS_GRID_W + x];
+			std::vector<MSYS_GridEntry>::iterator i = cell.begin();
+			for (; i != cell.end(); ++i)
+			{
+				if (i->region->PriorityLevel < r->PriorityLevel) break;
+				if (i->region->PriorityLevel == r->PriorityLevel && i->stamp < stamp) break;
+			}
+			MSYS_GridEntry const e = { stamp, r };
+			cell.insert(i, e);
+		}
+	}
+}
+
+
+/* Remove a region from the cells of its current area. Returns its stamp, 0 if
+ * it was not in the grid. */
+static UINT32 MSYS_DeleteRegionFromGrid(MOUSE_REGION* const r)
+{
+	UINT32 stamp = 0;
+	INT32 const x0 = MSYS_GridCell(r->RegionTopLeftX,     MSYS_GRID_W);
+	INT32 const y0 = MSYS_GridCell(r->RegionTopLeftY,     MSYS_GRID_H);
+	INT32 const x1 = MSYS_GridCell(r->RegionBottomRightX, MSYS_GRID_W);
+	INT32 const y1 = MSYS_GridCell(r->RegionBottomRightY, MSYS_GRID_H);
+	for (INT32 y = y0; y <= y1; ++y)
+	{
+		for (INT32 x = x0; x <= x1; ++x)
+		{
+			std::vector<MSYS_GridEntry>& cell = MSYS_Grid[y * MSYS_GRID_W + x];
+			for (std::vector<MSYS_GridEntry>::iterator i = cell.begin(); i != cell.end(); ++i)
+			{
+				if (i->region != r) continue;
+				stamp = i->stamp;
+				cell.erase(i);
+				break;
+			}
+		}
+	}
+	return stamp;
+}
+
+
 static void MSYS_DeleteRegionFromList(MOUSE_REGION*);
 
 
@@ -242,12 +320,16 @@ static void MSYS_AddRegionToList(MOUSE_REGION* const r)
 			i->prev = r;
 		}
 	}
+
+	MSYS_AddRegionToGrid(r, ++MSYS_GridStamp);
 }
 
 
 // Removes a region from the current list.
 static void MSYS_DeleteRegionFromList(MOUSE_REGION* const r)
 {
+	MSYS_DeleteRegionFromGrid(r);
+
 	MOUSE_REGION* const prev = r->prev;
 	MOUSE_REGION* const next = r->next;
 	if (prev) prev->next = next;
@@ -264,15 +346,20 @@ static void MSYS_DeleteRegionFromList(MOUSE_REGION* const r)
  * also dispatches the callback functions */
 static void MSYS_UpdateMouseRegion(void)
 {
-	MOUSE_REGION* cur;
-	for (cur = MSYS_RegList; cur != NULL; cur = cur->next)
+	INT32 const cx = MSYS_GridCell(MSYS_CurrentMX, MSYS_GRID_W);
+	INT32 const cy = MSYS_GridCell(MSYS_CurrentMY, MSYS_GRID_H);
+	std::vector<MSYS_GridEntry> const& cell = MSYS_Grid[cy * MSYS_GRID_W + cx];
+	MOUSE_REGION* cur = NULL;
+	for (MSYS_GridEntry const& e : cell)
 	{
-		if (cur->uiFlags & (MSYS_REGION_ENABLED | MSYS_ALLOW_DISABLED_FASTHELP) &&
-			cur->RegionTopLeftX <= MSYS_CurrentMX && MSYS_CurrentMX <= cur->RegionBottomRightX &&
-			cur->RegionTopLeftY <= MSYS_CurrentMY && MSYS_CurrentMY <= cur->RegionBottomRightY)
+		MOUSE_REGION* const r = e.region;
+		if (r->uiFlags & (MSYS_REGION_ENABLED | MSYS_ALLOW_DISABLED_FASTHELP) &&
+			r->RegionTopLeftX <= MSYS_CurrentMX && MSYS_CurrentMX <= r->RegionBottomRightX &&
+			r->RegionTopLeftY <= MSYS_CurrentMY && MSYS_CurrentMY <= r->RegionBottomRightY)
 		{
 			/* We got the right region. We don't need to check for priorities because
-			 * the whole list is sorted the right way! */
+			 * the cell is sorted the same way as the list! */
+			cur = r;
 			break;
 		}
 	}
@@ -583,6 +670,17 @@ void MOUSE_REGION::ChangeCursor(UINT16 const crsr)
 }
 
 
+void MOUSE_REGION::MoveTo(INT16 const x, INT16 const y)
+{
+	UINT32 const stamp = MSYS_DeleteRegionFromGrid(this);
+	RegionBottomRightX += x - RegionTopLeftX;
+	RegionBottomRightY += y - RegionTopLeftY;
+	RegionTopLeftX      = x;
+	RegionTopLeftY      = y;
+	if (stamp != 0) MSYS_AddRegionToGrid(this, stamp);
+}
+
+
 void MSYS_RemoveRegion(MOUSE_REGION* const r)
 {
 #ifdef MOUSESYSTEM_DEBUGGING
@@ -37,6 +37,10 @@ struct MOUSE_REGION
 {
 	void ChangeCursor(UINT16 crsr);
 
+	/* Move the region, keeping its size. Regions must not be moved by setting
+	 * their coordinates, the mouse system keeps an index of them. */
+	void MoveTo(INT16 x, INT16 y);
+
 	void Enable()  { uiFlags |=  MSYS_REGION_ENABLED; }
 	void Disable() { uiFlags &= ~MSYS_REGION_ENABLED; }
 
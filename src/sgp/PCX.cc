@@ -6,8 +6,6 @@
 #include "MemMan.h"
 #include "FileMan.h"
 
-#include "ContentManager.h"
-#include "GameInstance.h"
 
 struct PcxHeader
 {
@@ -33,10 +31,8 @@ struct PcxHeader
 static void BlitPcxToBuffer(UINT8 const* src, UINT8* dst, UINT16 w, UINT16 h);
 
 
-SGPImage* LoadPCXFileToImage(char const* const filename, UINT16 const contents)
+SGPImage* LoadPCXImage(HWFILE const f, UINT16 const contents)
 {
-	AutoSGPFile f(GCM->openGameResForReading(filename));
-
 	PcxHeader header;
 	FileRead(f, &header, sizeof(header));
 	if (header.ubManufacturer != 10 || header.ubEncoding != 1)
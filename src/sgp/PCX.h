@@ -4,6 +4,8 @@
 #include "Types.h"
 
 
-SGPImage* LoadPCXFileToImage(char const* filename, UINT16 fContents);
+/* Reads the image from an open file. CreateImage() opens the game resources
+ * with it, other files may be passed as well. */
+SGPImage* LoadPCXImage(HWFILE, UINT16 fContents);
 
 #endif
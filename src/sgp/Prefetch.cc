@@ -0,0 +1,137 @@
+#include "Debug.h"
+#include "FileMan.h"
+#include "Prefetch.h"
+
+#include <SDL.h>
+
+#include <deque>
+#include <stdexcept>
+
+
+#define PREFETCH_PAGE_SIZE 4096
+#define PREFETCH_CHUNK     (64 * PREFETCH_PAGE_SIZE) // bytes read between checks for cancellation
+
+
+static SDL_mutex*           g_lock;
+static SDL_cond*            g_work;       // signalled when a file is queued
+static SDL_Thread*          g_thread;
+static std::deque<SGPFile*> g_queue;
+static bool                 g_quit;
+static SDL_atomic_t         g_generation; // incremented by CancelPrefetch()
+
+
+/* Touches every page of the file, so the OS reads it into the page cache. */
+static void TouchFilePages(SGPFile* const f, int const generation)
+{
+	FileView const view(f);
+	BYTE const*       i   = view.data();
+	BYTE const* const end = i + view.size();
+	volatile BYTE sum = 0;
+	while (i < end)
+	{
+		if (SDL_AtomicGet(&g_generation) != generation) return;
+		BYTE const* const chunk_end = end - i > PREFETCH_CHUNK ? i + PREFETCH_CHUNK : end;
+		for (; i < chunk_end; i += PREFETCH_PAGE_SIZE) sum += *i;
+	}
+}
+
+
+static int PrefetchMain(void*)
+{
+	SDL_LockMutex(g_lock);
+	for (;;)
+	{
+		while (!g_quit && g_queue.empty()) SDL_CondWait(g_work, g_lock);
+		if (g_quit) break;
+		SGPFile* const f = g_queue.front();
+		g_queue.pop_front();
+		int const generation = SDL_AtomicGet(&g_generation);
+		SDL_UnlockMutex(g_lock);
+
+		try
+		{
+			TouchFilePages(f, generation);
+		}
+		catch (const std::exception& e)
+		{
+			SLOGW("Prefetching a file failed: %s", e.what());
+		}
+		FileClose(f);
+
+		SDL_LockMutex(g_lock);
+	}
+	SDL_UnlockMutex(g_lock);
+	return 0;
+}
+
+
+void InitializePrefetcher()
+{
+	g_lock = SDL_CreateMutex();
+	g_work = SDL_CreateCond();
+	if (g_lock && g_work)
+	{
+		g_thread = SDL_CreateThread(PrefetchMain, "prefetch", 0);
+		if (g_thread) return;
+	}
+	SLOGW("Failed to start the prefetch thread: %s", SDL_GetError());
+	ShutdownPrefetcher();
+}
+
+
+void ShutdownPrefetcher()
+{
+	if (g_thread)
+	{
+		SDL_LockMutex(g_lock);
+		g_quit = true;
+		SDL_AtomicIncRef(&g_generation);
+		SDL_CondSignal(g_work);
+		SDL_UnlockMutex(g_lock);
+
+		SDL_WaitThread(g_thread, 0);
+		g_thread = 0;
+	}
+
+	while (!g_queue.empty())
+	{
+		FileClose(g_queue.front());
+		g_queue.pop_front();
+	}
+
+	if (g_work) { SDL_DestroyCond(g_work);  g_work = 0; }
+	if (g_lock) { SDL_DestroyMutex(g_lock); g_lock = 0; }
+	g_quit = false;
+}
+
+
+void PrefetchFile(SGPFile* const f)
+{
+	if (!g_thread)
+	{
+		FileClose(f);
+		return;
+	}
+
+	SDL_LockMutex(g_lock);
+	g_queue.push_back(f);
+	SDL_CondSignal(g_work);
+	SDL_UnlockMutex(g_lock);
+}
+
+
+void CancelPrefetch()
+{
+	if (!g_thread) return;
+
+	std::deque<SGPFile*> dropped;
+	SDL_LockMutex(g_lock);
+	SDL_AtomicIncRef(&g_generation);
+	dropped.swap(g_queue);
+	SDL_UnlockMutex(g_lock);
+
+	for (std::deque<SGPFile*>::const_iterator i = dropped.begin(); i != dropped.end(); ++i)
+	{
+		FileClose(*i);
+	}
+}
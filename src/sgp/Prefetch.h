@@ -0,0 +1,23 @@
+#ifndef PREFETCH_H
+#define PREFETCH_H
+
+#include <stdio.h>
+
+#include "SGPFile.h"
+
+
+/* Starts the thread which reads prefetched files in the background, so a later
+ * load finds their data in the page cache instead of waiting for the disk. */
+void InitializePrefetcher();
+void ShutdownPrefetcher();
+
+/* Queues an open file to be read in the background. The prefetcher takes over
+ * the file and closes it when it is done. Files are read in the order they are
+ * queued. */
+void PrefetchFile(SGPFile*);
+
+/* Drops the queued files and stops reading the current one, e.g. because the
+ * plans which made them interesting have changed. */
+void CancelPrefetch();
+
+#endif
@@ -0,0 +1,487 @@
+#include "Profiler.h"
+
+#include "ContentManager.h"
+#include "GameInstance.h"
+#include "Logger.h"
+#include "MemMan.h"
+
+#include <SDL.h>
+
+#include <algorithm>
+#include <atomic>
+#include <stdio.h>
+#include <string>
+
+
+#define PROFILER_FRAMES         256  // frames kept in the ring buffer
+#define PROFILER_EVENTS         4096 // phase intervals kept for the trace
+#define PROFILER_OVERLAY_FRAMES 128  // frames shown in the overlay graph
+#define PROFILER_OVERLAY_MS     50   // height of the overlay graph in milliseconds
+#define PROFILER_PRESENTS       512  // present intervals kept for the histogram
+#define PROFILER_HISTOGRAM_BINS 50   // 1 ms wide, the last one takes the longer intervals too
+
+
+struct ProfileFrame
+{
+	uint64_t start;
+	uint64_t end;
+	uint64_t phase[PROFILE_NUM_PHASES]; // accumulated ticks per phase
+	UINT32   counter[PROFILE_NUM_COUNTERS];
+};
+
+struct ProfileEvent
+{
+	uint64_t     start;
+	uint64_t     end;
+	ProfilePhase phase;
+};
+
+
+static char const* const g_phase_names[] =
+{
+	"Input",
+	"ScreenHandler",
+	"ExecuteOverhead",
+	"RenderWorld",
+	"RenderStaticWorld",
+	"RenderDynamicWorld",
+	"RenderMarkedWorld",
+	"VideoOverlays",
+	"RefreshScreen",
+	"ScreenCapture",
+	"SoundServiceStreams"
+};
+
+static char const* const g_counter_names[] =
+{
+	"dirty_regions",
+	"dirty_pixels",
+	"full_refreshes",
+	"movement_cost_tiles",
+	"anim_surface_loads",
+	"anim_surface_stall_us",
+	"anim_surface_reuses",
+	"sound_underruns",
+	"sound_mix_us",
+	"sound_channels",
+	"sound_cache_hits",
+	"sound_cache_misses",
+	"paths",
+	"path_cache_hits",
+	"los_tests",
+	"light_draws",
+	"blits",
+	"blit_pixels",
+	"allocs",
+	"wakeups"
+};
+
+/* Overlay colours. The screen handler and RenderWorld() are drawn without the
+ * phases nested in them, so the bars stack up to the frame time. */
+static SDL_Color const g_phase_colours[] =
+{
+	{ 255, 255,   0, 255 }, // input
+	{  64, 160, 255, 255 }, // screen handler
+	{ 255, 128,   0, 255 }, // ExecuteOverhead
+	{   0, 220,   0, 255 }, // RenderWorld
+	{   0, 140,   0, 255 }, // RenderStaticWorld
+	{ 128, 255, 128, 255 }, // RenderDynamicWorld
+	{   0,  96,  48, 255 }, // RenderMarkedWorld
+	{ 255,   0, 255, 255 }, // video overlays
+	{ 255,  32,  32, 255 }, // RefreshScreen
+	{ 255, 255, 255, 255 }, // ScreenCapture
+	{   0, 255, 255, 255 }  // sound streams
+};
+
+static ProfileFrame g_frames[PROFILER_FRAMES];
+static UINT32       g_n_frames;    // frames begun in total
+static bool         g_in_frame;
+static ProfileEvent g_events[PROFILER_EVENTS];
+static UINT32       g_n_events;    // events recorded in total
+static UINT32       g_depth[PROFILE_NUM_PHASES];
+static bool         g_show_overlay;
+static uint64_t     g_total_ticks; // sums over all frames
+static uint64_t     g_total_phase[PROFILE_NUM_PHASES];
+static uint64_t     g_total_counter[PROFILE_NUM_COUNTERS];
+static UINT32       g_n_totals;    // frames in the sums
+static std::atomic<UINT32> g_pending_counter[PROFILE_NUM_COUNTERS]; // counted since the last frame ended
+static size_t              g_last_allocs;
+static uint64_t            g_last_present;
+static float               g_present_ms[PROFILER_PRESENTS]; // intervals between presents
+static UINT32              g_n_presents; // intervals recorded in total
+
+
+static ProfileFrame& CurrentFrame()
+{
+	return g_frames[(g_n_frames - 1) % PROFILER_FRAMES];
+}
+
+
+void ProfilerBeginFrame()
+{
+	ProfileFrame& f = g_frames[g_n_frames++ % PROFILER_FRAMES];
+	f = ProfileFrame();
+	f.start    = SDL_GetPerformanceCounter();
+	g_in_frame = true;
+}
+
+
+void ProfilerEndFrame()
+{
+	if (!g_in_frame) return;
+	ProfileFrame& f = CurrentFrame();
+	f.end      = SDL_GetPerformanceCounter();
+	g_in_frame = false;
+
+	size_t allocs = 0;
+	for (UINT i = 0; i != MEM_NUM_TAGS; ++i) allocs += GetMemTagStats(MemTag(i)).allocs;
+	if (g_last_allocs != 0) ProfilerCount(PROFILE_ALLOCS, UINT32(allocs - g_last_allocs));
+	g_last_allocs = allocs;
+
+	for (UINT c = 0; c != PROFILE_NUM_COUNTERS; ++c)
+	{
+		f.counter[c] = g_pending_counter[c].exchange(0, std::memory_order_relaxed);
+	}
+
+	g_total_ticks += f.end - f.start;
+	for (UINT p = 0; p != PROFILE_NUM_PHASES;   ++p) g_total_phase[p]   += f.phase[p];
+	for (UINT c = 0; c != PROFILE_NUM_COUNTERS; ++c) g_total_counter[c] += f.counter[c];
+	++g_n_totals;
+}
+
+
+void ProfilerCount(ProfileCounter const counter, UINT32 const n)
+{
+	g_pending_counter[counter].fetch_add(n, std::memory_order_relaxed);
+}
+
+
+uint64_t ProfilerEnterPhase(ProfilePhase const phase)
+{
+	if (g_depth[phase]++ != 0) return 0;
+	return SDL_GetPerformanceCounter();
+}
+
+
+void ProfilerLeavePhase(ProfilePhase const phase, uint64_t const start)
+{
+	if (--g_depth[phase] != 0) return;
+	uint64_t const end = SDL_GetPerformanceCounter();
+
+	// Phases outside of a game loop cycle, e.g. during shutdown, are not recorded
+	if (!g_in_frame) return;
+	CurrentFrame().phase[phase] += end - start;
+
+	ProfileEvent& e = g_events[g_n_events++ % PROFILER_EVENTS];
+	e.start = start;
+	e.end   = end;
+	e.phase = phase;
+}
+
+
+double TicksToMS(uint64_t const ticks)
+{
+	return ticks * 1000.0 / SDL_GetPerformanceFrequency();
+}
+
+
+double MSSince(uint64_t const start)
+{
+	return TicksToMS(SDL_GetPerformanceCounter() - start);
+}
+
+
+/* Number of complete frames in the ring buffer and the index of the oldest. */
+static UINT32 CompleteFrames(UINT32* const first)
+{
+	UINT32 n = g_n_frames < PROFILER_FRAMES ? g_n_frames : PROFILER_FRAMES;
+	if (g_in_frame && n != 0) --n;
+	UINT32 const end = g_in_frame ? g_n_frames - 1 : g_n_frames;
+	*first = end - n;
+	return n;
+}
+
+
+double ProfilerLastFrameMS(ProfilePhase const phase)
+{
+	UINT32       first;
+	UINT32 const n = CompleteFrames(&first);
+	if (n == 0) return 0;
+	return TicksToMS(g_frames[(first + n - 1) % PROFILER_FRAMES].phase[phase]);
+}
+
+
+UINT32 ProfilerLastFrameCount(ProfileCounter const counter)
+{
+	UINT32       first;
+	UINT32 const n = CompleteFrames(&first);
+	if (n == 0) return 0;
+	return g_frames[(first + n - 1) % PROFILER_FRAMES].counter[counter];
+}
+
+
+double ProfilerAverageCount(ProfileCounter const counter)
+{
+	UINT32       first;
+	UINT32 const n = CompleteFrames(&first);
+	if (n == 0) return 0;
+	uint64_t sum = 0;
+	for (UINT32 i = 0; i != n; ++i) sum += g_frames[(first + i) % PROFILER_FRAMES].counter[counter];
+	return double(sum) / n;
+}
+
+
+char const* ProfilerCounterName(ProfileCounter const counter)
+{
+	return g_counter_names[counter];
+}
+
+
+void ProfilerPresent()
+{
+	uint64_t const now = SDL_GetPerformanceCounter();
+	if (g_last_present != 0)
+	{
+		g_present_ms[g_n_presents++ % PROFILER_PRESENTS] = TicksToMS(now - g_last_present);
+	}
+	g_last_present = now;
+}
+
+
+void ToggleProfilerOverlay()
+{
+	g_show_overlay = !g_show_overlay;
+	if (!g_show_overlay) return;
+
+	// Log the averages as well, as the graph has no labels
+	UINT32       first;
+	UINT32 const n = CompleteFrames(&first);
+	if (n == 0) return;
+
+	uint64_t total = 0;
+	uint64_t phase[PROFILE_NUM_PHASES] = { 0 };
+	uint64_t counter[PROFILE_NUM_COUNTERS] = { 0 };
+	for (UINT32 i = first; i != first + n; ++i)
+	{
+		ProfileFrame const& f = g_frames[i % PROFILER_FRAMES];
+		total += f.end - f.start;
+		for (UINT p = 0; p != PROFILE_NUM_PHASES;   ++p) phase[p]   += f.phase[p];
+		for (UINT c = 0; c != PROFILE_NUM_COUNTERS; ++c) counter[c] += f.counter[c];
+	}
+	SLOGI("Average of the last %u frames: %.2f ms", n, TicksToMS(total) / n);
+	for (UINT p = 0; p != PROFILE_NUM_PHASES; ++p)
+	{
+		SLOGI("  %-20s %.2f ms", g_phase_names[p], TicksToMS(phase[p]) / n);
+	}
+	for (UINT c = 0; c != PROFILE_NUM_COUNTERS; ++c)
+	{
+		SLOGI("  %-20s %.1f", g_counter_names[c], (double)counter[c] / n);
+	}
+}
+
+
+void LogProfilerTotals()
+{
+	UINT32 const n = g_n_totals;
+	if (n == 0) return;
+
+	SLOGI("Total of %u frames: %.1f ms, %.3f ms per frame", n, TicksToMS(g_total_ticks), TicksToMS(g_total_ticks) / n);
+	for (UINT p = 0; p != PROFILE_NUM_PHASES; ++p)
+	{
+		SLOGI("  %-20s %10.1f ms %8.3f ms", g_phase_names[p], TicksToMS(g_total_phase[p]), TicksToMS(g_total_phase[p]) / n);
+	}
+	for (UINT c = 0; c != PROFILE_NUM_COUNTERS; ++c)
+	{
+		SLOGI("  %-20s %10llu %8.1f", g_counter_names[c], (unsigned long long)g_total_counter[c], (double)g_total_counter[c] / n);
+	}
+}
+
+
+void ResetProfilerTotals()
+{
+	g_total_ticks = 0;
+	for (UINT p = 0; p != PROFILE_NUM_PHASES;   ++p) g_total_phase[p]   = 0;
+	for (UINT c = 0; c != PROFILE_NUM_COUNTERS; ++c) g_total_counter[c] = 0;
+	g_n_totals = 0;
+}
+
+
+static void FillBar(SDL_Renderer* const r, SDL_Color const& c, int const x, int& y, double const ms, double const px_per_ms)
+{
+	int const h = (int)(ms * px_per_ms + .5);
+	if (h <= 0) return;
+	SDL_Rect const rect = { x, y - h, 2, h };
+	SDL_SetRenderDrawColor(r, c.r, c.g, c.b, c.a);
+	SDL_RenderFillRect(r, &rect);
+	y -= h;
+}
+
+
+void DrawProfilerOverlay(SDL_Renderer* const r)
+{
+	if (!g_show_overlay) return;
+
+	int w;
+	int h;
+	SDL_RenderGetLogicalSize(r, &w, &h);
+	if (w == 0 || h == 0) SDL_GetRendererOutputSize(r, &w, &h);
+
+	int    const graph_h   = 2 * PROFILER_OVERLAY_MS;
+	int    const bottom    = h - 4;
+	int    const left      = 4;
+	double const px_per_ms = (double)graph_h / PROFILER_OVERLAY_MS;
+
+	SDL_BlendMode old_mode;
+	SDL_GetRenderDrawBlendMode(r, &old_mode);
+	SDL_SetRenderDrawBlendMode(r, SDL_BLENDMODE_BLEND);
+
+	SDL_Rect const background = { left - 2, bottom - graph_h - 2, 2 * PROFILER_OVERLAY_FRAMES + 4, graph_h + 4 };
+	SDL_SetRenderDrawColor(r, 0, 0, 0, 160);
+	SDL_RenderFillRect(r, &background);
+
+	// A line every 10 ms
+	SDL_SetRenderDrawColor(r, 128, 128, 128, 160);
+	for (int ms = 10; ms <= PROFILER_OVERLAY_MS; ms += 10)
+	{
+		int const y = bottom - (int)(ms * px_per_ms);
+		SDL_RenderDrawLine(r, left, y, left + 2 * PROFILER_OVERLAY_FRAMES - 1, y);
+	}
+
+	UINT32       first;
+	UINT32 const n     = CompleteFrames(&first);
+	UINT32 const shown = n < PROFILER_OVERLAY_FRAMES ? n : PROFILER_OVERLAY_FRAMES;
+	SDL_Color const other = { 160, 160, 160, 255 };
+	for (UINT32 i = 0; i != shown; ++i)
+	{
+		ProfileFrame const& f = g_frames[(first + n - shown + i) % PROFILER_FRAMES];
+		double ms[PROFILE_NUM_PHASES];
+		for (UINT p = 0; p != PROFILE_NUM_PHASES; ++p) ms[p] = TicksToMS(f.phase[p]);
+
+		double nested = ms[PROFILE_EXECUTE_OVERHEAD] + ms[PROFILE_RENDER_WORLD] + ms[PROFILE_VIDEO_OVERLAYS];
+		double const top_level = ms[PROFILE_INPUT] + ms[PROFILE_SCREEN_HANDLER] + ms[PROFILE_REFRESH_SCREEN] + ms[PROFILE_SOUND_STREAMS];
+		ms[PROFILE_SCREEN_HANDLER] = ms[PROFILE_SCREEN_HANDLER] > nested ? ms[PROFILE_SCREEN_HANDLER] - nested : 0;
+		double const parts = ms[PROFILE_RENDER_STATIC] + ms[PROFILE_RENDER_DYNAMIC] + ms[PROFILE_RENDER_MARKED];
+		ms[PROFILE_RENDER_WORLD] = ms[PROFILE_RENDER_WORLD] > parts ? ms[PROFILE_RENDER_WORLD] - parts : 0;
+		ms[PROFILE_REFRESH_SCREEN] = ms[PROFILE_REFRESH_SCREEN] > ms[PROFILE_SCREEN_CAPTURE] ? ms[PROFILE_REFRESH_SCREEN] - ms[PROFILE_SCREEN_CAPTURE] : 0;
+		double const rest = TicksToMS(f.end - f.start) - top_level;
+
+		int const x = left + 2 * i;
+		int       y = bottom;
+		for (UINT p = 0; p != PROFILE_NUM_PHASES; ++p)
+		{
+			FillBar(r, g_phase_colours[p], x, y, ms[p], px_per_ms);
+		}
+		FillBar(r, other, x, y, rest > 0 ? rest : 0, px_per_ms);
+	}
+
+	// The histogram of the present intervals, right of the graph
+	UINT32 const n_presents = g_n_presents < PROFILER_PRESENTS ? g_n_presents : PROFILER_PRESENTS;
+	if (n_presents != 0)
+	{
+		UINT32 bins[PROFILER_HISTOGRAM_BINS] = {};
+		UINT32 highest = 0;
+		for (UINT32 i = 0; i != n_presents; ++i)
+		{
+			UINT32 const b = std::min((UINT32)g_present_ms[i], (UINT32)PROFILER_HISTOGRAM_BINS - 1);
+			highest = std::max(highest, ++bins[b]);
+		}
+
+		int const hist_left = left + 2 * PROFILER_OVERLAY_FRAMES + 8;
+		SDL_Rect const hist_background = { hist_left - 2, bottom - graph_h - 2, 2 * PROFILER_HISTOGRAM_BINS + 4, graph_h + 4 };
+		SDL_SetRenderDrawColor(r, 0, 0, 0, 160);
+		SDL_RenderFillRect(r, &hist_background);
+
+		// A tick every 10 ms
+		SDL_SetRenderDrawColor(r, 128, 128, 128, 160);
+		for (int ms = 10; ms < PROFILER_HISTOGRAM_BINS; ms += 10)
+		{
+			int const x = hist_left + 2 * ms;
+			SDL_RenderDrawLine(r, x, bottom - graph_h, x, bottom);
+		}
+
+		SDL_SetRenderDrawColor(r, 255, 255, 255, 255);
+		for (UINT b = 0; b != PROFILER_HISTOGRAM_BINS; ++b)
+		{
+			int const bar_h = bins[b] * graph_h / highest;
+			if (bar_h == 0) continue;
+			SDL_Rect const bar = { hist_left + 2 * (int)b, bottom - bar_h, 2, bar_h };
+			SDL_RenderFillRect(r, &bar);
+		}
+	}
+
+	SDL_SetRenderDrawBlendMode(r, old_mode);
+}
+
+
+static FILE* OpenProfilerFile(char const* const name)
+{
+	std::string const path = GCM->getScreenshotFolder() + "/" + name;
+	FILE* const f = fopen(path.c_str(), "w");
+	if (!f) SLOGW("Failed to write the profiler trace %s", path.c_str());
+	else    SLOGI("Writing the profiler trace %s", path.c_str());
+	return f;
+}
+
+
+void DumpProfilerTrace()
+{
+	UINT32       first;
+	UINT32 const n = CompleteFrames(&first);
+	if (n == 0) return;
+
+	if (FILE* const f = OpenProfilerFile("profile.csv"))
+	{
+		fputs("frame,total_ms", f);
+		for (UINT p = 0; p != PROFILE_NUM_PHASES;   ++p) fprintf(f, ",%s_ms", g_phase_names[p]);
+		for (UINT c = 0; c != PROFILE_NUM_COUNTERS; ++c) fprintf(f, ",%s", g_counter_names[c]);
+		fputc('\n', f);
+		for (UINT32 i = first; i != first + n; ++i)
+		{
+			ProfileFrame const& fr = g_frames[i % PROFILER_FRAMES];
+			fprintf(f, "%u,%.3f", i, TicksToMS(fr.end - fr.start));
+			for (UINT p = 0; p != PROFILE_NUM_PHASES;   ++p) fprintf(f, ",%.3f", TicksToMS(fr.phase[p]));
+			for (UINT c = 0; c != PROFILE_NUM_COUNTERS; ++c) fprintf(f, ",%u", fr.counter[c]);
+			fputc('\n', f);
+		}
+		fclose(f);
+	}
+
+	if (FILE* const f = OpenProfilerFile("profile.json"))
+	{
+		ProfileFrame const& oldest = g_frames[first % PROFILER_FRAMES];
+		ProfileFrame const& newest = g_frames[(first + n - 1) % PROFILER_FRAMES];
+		uint64_t const base = oldest.start;
+		double   const us   = 1000000.0 / SDL_GetPerformanceFrequency();
+
+		fputs("{\"traceEvents\":[\n", f);
+		char const* sep = "";
+		for (UINT32 i = first; i != first + n; ++i)
+		{
+			ProfileFrame const& fr = g_frames[i % PROFILER_FRAMES];
+			fprintf(f, "%s{\"name\":\"GameLoop\",\"ph\":\"X\",\"pid\":1,\"tid\":1,\"ts\":%.1f,\"dur\":%.1f,\"args\":{\"frame\":%u}}", sep, (fr.start - base) * us, (fr.end - fr.start) * us, i);
+			sep = ",\n";
+		}
+
+		UINT32 const n_events = g_n_events < PROFILER_EVENTS ? g_n_events : PROFILER_EVENTS;
+		for (UINT32 i = g_n_events - n_events; i != g_n_events; ++i)
+		{
+			ProfileEvent const& e = g_events[i % PROFILER_EVENTS];
+			if (e.start < base || e.end > newest.end) continue;
+			fprintf(f, "%s{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":1,\"ts\":%.1f,\"dur\":%.1f}", sep, g_phase_names[e.phase], (e.start - base) * us, (e.end - e.start) * us);
+		}
+		fputs("\n]}\n", f);
+		fclose(f);
+	}
+
+	if (FILE* const f = OpenProfilerFile("memory.csv"))
+	{
+		fputs("tag,live_bytes,peak_bytes,live_blocks,allocs\n", f);
+		for (UINT i = 0; i != MEM_NUM_TAGS; ++i)
+		{
+			MemTagStats const s = GetMemTagStats(MemTag(i));
+			fprintf(f, "%s,%lu,%lu,%lu,%lu\n", GetMemTagName(MemTag(i)),
+				(unsigned long)s.live_bytes, (unsigned long)s.peak_bytes, (unsigned long)s.live_blocks, (unsigned long)s.allocs);
+		}
+		fclose(f);
+	}
+}
@@ -0,0 +1,139 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include "Types.h"
+
+#include <stdint.h>
+
+struct SDL_Renderer;
+
+
+/* Phases of a game loop cycle which are timed. Phases may nest, e.g.
+ * RenderWorld() runs inside the screen handler, and the time of a phase
+ * includes the time of the phases nested in it. */
+enum ProfilePhase
+{
+	PROFILE_INPUT,
+	PROFILE_SCREEN_HANDLER,
+	PROFILE_EXECUTE_OVERHEAD,
+	PROFILE_RENDER_WORLD,
+	PROFILE_RENDER_STATIC,  // the parts of RenderWorld()
+	PROFILE_RENDER_DYNAMIC,
+	PROFILE_RENDER_MARKED,
+	PROFILE_VIDEO_OVERLAYS,
+	PROFILE_REFRESH_SCREEN,
+	PROFILE_SCREEN_CAPTURE, // copying the screen for screenshots and video capture, part of RefreshScreen()
+	PROFILE_SOUND_STREAMS,
+	PROFILE_NUM_PHASES
+};
+
+/* Per frame counters, which are summed over a frame. */
+enum ProfileCounter
+{
+	PROFILE_DIRTY_REGIONS,       // rectangles copied to the screen
+	PROFILE_DIRTY_AREA,          // pixels copied to the screen
+	PROFILE_FULL_REFRESHES,      // 1 if the whole screen was copied
+	PROFILE_MOVEMENT_COST_TILES, // tiles whose movement costs were compiled
+	PROFILE_ANIM_SURFACE_LOADS,    // animation surfaces a soldier had to wait for
+	PROFILE_ANIM_SURFACE_STALL_US, // microseconds spent in these loads
+	PROFILE_ANIM_SURFACE_REUSES,   // released or preloaded surfaces taken up again
+	PROFILE_SOUND_UNDERRUNS,       // sound callbacks which took longer than the audio they mixed
+	PROFILE_SOUND_MIX_US,          // microseconds spent in the sound callback
+	PROFILE_SOUND_CHANNELS,        // channels playing at the end of the frame
+	PROFILE_SOUND_CACHE_HITS,      // sounds played from a cached sample
+	PROFILE_SOUND_CACHE_MISSES,    // sounds which had to be loaded
+	PROFILE_PATHS,                 // FindBestPath() calls
+	PROFILE_PATH_CACHE_HITS,       // of these, answered from the path cache
+	PROFILE_LOS_TESTS,             // line of sight tests
+	PROFILE_LIGHT_DRAWS,           // light sprites drawn into the light map
+	PROFILE_BLITS,                 // video object images blitted
+	PROFILE_BLIT_PIXELS,           // pixels of these images, before clipping
+	PROFILE_ALLOCS,                // memory allocations and reallocations
+	PROFILE_WAKEUPS,               // times the main loop woke up, for an event or a game cycle
+	PROFILE_NUM_COUNTERS
+};
+
+/* Brackets one game loop cycle. The last frames are kept in a ring buffer. */
+void ProfilerBeginFrame();
+void ProfilerEndFrame();
+
+/* Adds to a counter of the current frame. May be called from any thread; the
+ * counts are added to the frame which ends next. */
+void     ProfilerCount(ProfileCounter, UINT32 n);
+
+uint64_t ProfilerEnterPhase(ProfilePhase);
+void     ProfilerLeavePhase(ProfilePhase, uint64_t start);
+
+/* Times the enclosing scope as the given phase. Only the outermost scope of a
+ * phase is recorded if it is entered recursively. */
+class ProfileScope
+{
+	public:
+		explicit ProfileScope(ProfilePhase const phase) :
+			phase_(phase),
+			start_(ProfilerEnterPhase(phase))
+		{}
+
+		~ProfileScope() { ProfilerLeavePhase(phase_, start_); }
+
+	private:
+		ProfilePhase const phase_;
+		uint64_t     const start_;
+};
+
+#define PROFILE_SCOPE(phase) ProfileScope const profile_scope_(phase)
+
+/* Named zones and frame marks for an external sampling profiler, to look at the
+ * frame timeline of a release build. Built WITH_TRACY they are Tracy zones;
+ * otherwise they compile to nothing. The name must be a string literal. */
+#ifdef WITH_TRACY
+#	include <tracy/Tracy.hpp>
+#	define PROFILE_ZONE(name)   ZoneScopedN(name)
+#	define PROFILE_FRAME_MARK() FrameMark
+#else
+#	define PROFILE_ZONE(name)   ((void)0)
+#	define PROFILE_FRAME_MARK() ((void)0)
+#endif
+
+/* Converts a difference of SDL_GetPerformanceCounter() values to
+ * milliseconds, and gives the milliseconds since such a value, for timing
+ * benchmarks and slow operations. */
+double TicksToMS(uint64_t ticks);
+double MSSince(uint64_t start);
+
+/* The time of a phase in the last complete frame, in milliseconds. */
+double ProfilerLastFrameMS(ProfilePhase);
+
+/* A counter of the last complete frame and its average over the frames in the
+ * ring buffer. */
+UINT32 ProfilerLastFrameCount(ProfileCounter);
+double ProfilerAverageCount(ProfileCounter);
+
+char const* ProfilerCounterName(ProfileCounter);
+
+/* Logs the time of all frames so far, in total and per frame, and of every
+ * phase, and the counters, e.g. at the end of a benchmark. */
+void LogProfilerTotals();
+
+/* Starts summing up the frames for LogProfilerTotals() again. */
+void ResetProfilerTotals();
+
+/* Marks a frame shown in the window. The intervals between the last presents
+ * are drawn as a histogram next to the frame time graph, where uneven pacing
+ * shows as a spread even if the average is fine. */
+void ProfilerPresent();
+
+/* Shows or hides the frame time graph drawn by DrawProfilerOverlay(). */
+void ToggleProfilerOverlay();
+
+/* Draws the frame times of the last frames as stacked bars, one colour per
+ * phase, directly with the renderer, so the game buffers are not touched. */
+void DrawProfilerOverlay(SDL_Renderer*);
+
+/* Writes the frames in the ring buffer into the screenshot folder, as a CSV
+ * file with the time of every phase in milliseconds and the counters, and as a
+ * trace in the Chrome trace event format, which chrome://tracing and Perfetto
+ * load. The memory in use per MemTag goes into memory.csv alongside. */
+void DumpProfilerTrace();
+
+#endif
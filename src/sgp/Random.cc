@@ -2,30 +2,51 @@
 
 #include <chrono>
 #include <random>
+#include <stdint.h>
 
-/// Pseudo-random number engine.
-static std::mt19937 gRandomEngine;
+/// PCG32 (XSH RR) pseudo-random number engine, see pcg-random.org.
+/// Small and fast, and every stream gets its own increment.
+struct RandomEngine
+{
+	uint64_t state;
+	uint64_t inc;
 
-/// Uniform distribution in the range [0,UINT32_MAX].
-static std::uniform_int_distribution<UINT32> guiDistribution(0, UINT32_MAX);
+	void Seed(uint64_t const seed, uint64_t const stream)
+	{
+		state = 0;
+		inc   = stream << 1 | 1;
+		Next();
+		state += seed;
+		Next();
+	}
+
+	UINT32 Next()
+	{
+		uint64_t const old = state;
+		state = old * 6364136223846793005ULL + inc;
+		UINT32 const xorshifted = UINT32(((old >> 18) ^ old) >> 27);
+		UINT32 const rot        = UINT32(old >> 59);
+		return xorshifted >> rot | xorshifted << (-rot & 31);
+	}
+};
+
+static RandomEngine gRandomEngines[RANDOM_NUM_STREAMS];
 
 // Pregenerated pseudo-random numbers.
 UINT32 guiPreRandomIndex = 0;
 UINT32 guiPreRandomNums[ MAX_PREGENERATED_NUMS ];
 
 /// Pre-generated pseudo-random number engine.
-struct PreRandomEngine {
-	typedef UINT32 result_type;
-	static constexpr result_type min() { return 0; }
-	static constexpr result_type max() { return UINT32_MAX; }
-	result_type operator()()
+struct PreRandomEngine
+{
+	UINT32 Next()
 	{
 		// Extract the current pregenerated number
 		UINT32 uiNum = guiPreRandomNums[ guiPreRandomIndex ];
 
 		// Replace the current pregenerated number with a new one.
 		// NOTE the original code has this commented out in the name of optimization.
-		guiPreRandomNums[ guiPreRandomIndex ] = guiDistribution(gRandomEngine);
+		guiPreRandomNums[ guiPreRandomIndex ] = gRandomEngines[RANDOM_STREAM_GAME].Next();
 
 		// Go to the next index.
 		guiPreRandomIndex++;
@@ -36,36 +57,81 @@ struct PreRandomEngine {
 };
 static PreRandomEngine gPreRandomEngine;
 
+
+/// Returns an integer in the range [0,range), range > 0, without bias.
+/// Multiplies instead of dividing and only divides to reject the few numbers
+/// which would make some results more likely (Lemire's method).
+template<typename Engine> static UINT32 Bounded(Engine& e, UINT32 const range)
+{
+	uint64_t m = uint64_t(e.Next()) * range;
+	UINT32   l = UINT32(m);
+	if (l < range)
+	{
+		UINT32 const threshold = (0U - range) % range;
+		while (l < threshold)
+		{
+			m = uint64_t(e.Next()) * range;
+			l = UINT32(m);
+		}
+	}
+	return UINT32(m >> 32);
+}
+
+
+static void PregenerateRandomNums()
+{
+	for (guiPreRandomIndex = 0; guiPreRandomIndex < MAX_PREGENERATED_NUMS; ++guiPreRandomIndex)
+	{
+		guiPreRandomNums[ guiPreRandomIndex ] = gRandomEngines[RANDOM_STREAM_GAME].Next();
+	}
+	guiPreRandomIndex = 0;
+}
+
+
 void InitializeRandom(void)
 {
-	// Seed the pseudo-random number engine with the current time
+	// Seed the pseudo-random number engines with the current time
 	// so that the numbers will be different every time we run.
-	UINT32 uiSeed1 = std::chrono::system_clock::now().time_since_epoch().count();
+	uint64_t const uiSeed1 = std::chrono::system_clock::now().time_since_epoch().count();
 
-	// Also try to seed the pseudo-random number engine with a non-deterministic
-	// random number (entropy is 0 when not available).
+	// Also try to seed them with a non-deterministic random number (entropy is
+	// 0 when not available).
 	std::random_device randomDevice;
-	UINT32 uiSeed2 = guiDistribution(randomDevice);
+	uint64_t const uiSeed2 = randomDevice();
 
-	std::seed_seq seed = { uiSeed1, uiSeed2 };
-	gRandomEngine = std::mt19937(seed);
+	for (UINT32 i = 0; i != RANDOM_NUM_STREAMS; ++i)
+	{
+		gRandomEngines[i].Seed(uiSeed1 ^ uiSeed2 << 32, i);
+	}
+	PregenerateRandomNums();
+}
 
-	// Pregenerate random numbers.
-	for (guiPreRandomIndex = 0; guiPreRandomIndex < MAX_PREGENERATED_NUMS; ++guiPreRandomIndex)
+void SeedRandom(UINT32 const seed)
+{
+	for (UINT32 i = 0; i != RANDOM_NUM_STREAMS; ++i)
 	{
-		guiPreRandomNums[ guiPreRandomIndex ] = guiDistribution(gRandomEngine);
+		gRandomEngines[i].Seed(seed, i);
 	}
-	guiPreRandomIndex = 0;
+	PregenerateRandomNums();
+}
+
+void SeedRandomStream(RandomStream const stream, UINT32 const seed)
+{
+	gRandomEngines[stream].Seed(seed, stream);
 }
 
 /// Returns a pseudo-random integer in the range [0,uiRange).
 /// Returns 0 if no range is given (not an error).
 UINT32 Random(UINT32 uiRange)
+{
+	return StreamRandom(RANDOM_STREAM_GAME, uiRange);
+}
+
+UINT32 StreamRandom(RandomStream const stream, UINT32 const uiRange)
 {
 	if (!uiRange)
 		return 0;
-	std::uniform_int_distribution<UINT32> distribution(0, uiRange - 1);
-	return distribution(gRandomEngine);
+	return Bounded(gRandomEngines[stream], uiRange);
 }
 
 BOOLEAN Chance(UINT32 uiChance)
@@ -79,8 +145,7 @@ UINT32 PreRandom(UINT32 uiRange)
 {
 	if (!uiRange)
 		return 0;
-	std::uniform_int_distribution<UINT32> distribution(0, uiRange - 1);
-	return distribution(gPreRandomEngine);
+	return Bounded(gPreRandomEngine, uiRange);
 }
 
 BOOLEAN PreChance(UINT32 uiChance)
@@ -4,9 +4,31 @@
 #include "Types.h"
 
 
+/* Independent sequences of random numbers. What happens in one subsystem does
+ * not shift the numbers another one gets, e.g. the random ambient sounds,
+ * which depend on timing, leave the numbers of the game alone. */
+enum RandomStream
+{
+	RANDOM_STREAM_GAME,  // Random() and Chance()
+	RANDOM_STREAM_SOUND, // random ambient sounds
+	RANDOM_NUM_STREAMS
+};
+
+
 extern void InitializeRandom(void);
+
+/* Seeds all streams and pregenerates the numbers again, so the same sequence
+ * of Random() and PreRandom() numbers follows every time. */
+void SeedRandom(UINT32 seed);
+
+/* Seeds a single stream. The pregenerated numbers are not touched. */
+void SeedRandomStream(RandomStream, UINT32 seed);
+
 extern UINT32 Random( UINT32 uiRange );
 
+/* Random() from another stream than the one of the game. */
+UINT32 StreamRandom(RandomStream, UINT32 uiRange);
+
 //Chance( 74 ) returns TRUE 74% of the time.  If uiChance >= 100, then it will always return TRUE.
 extern BOOLEAN Chance( UINT32 uiChance );
 
@@ -0,0 +1,52 @@
+#include "gtest/gtest.h"
+
+#include "Random.h"
+
+
+TEST(RandomTest, SeedRepeatsSequence)
+{
+	UINT32 a[64];
+	SeedRandom(1234);
+	for (UINT32& i : a) i = Random(1000);
+	UINT32 const pre = PreRandom(1000);
+
+	SeedRandom(1234);
+	for (UINT32 const i : a) EXPECT_EQ(Random(1000), i);
+	EXPECT_EQ(PreRandom(1000), pre);
+}
+
+
+TEST(RandomTest, StaysInRange)
+{
+	SeedRandom(1);
+	EXPECT_EQ(Random(0), 0u);
+	EXPECT_EQ(Random(1), 0u);
+
+	UINT32 counts[3] = { 0, 0, 0 };
+	for (int i = 0; i != 30000; ++i)
+	{
+		UINT32 const r = Random(3);
+		ASSERT_LT(r, 3u);
+		++counts[r];
+	}
+	for (UINT32 const c : counts) EXPECT_NEAR(c, 10000, 500);
+
+	for (int i = 0; i != 1000; ++i) ASSERT_LT(Random(0x80000001), 0x80000001u);
+}
+
+
+TEST(RandomTest, StreamsAreIndependent)
+{
+	SeedRandom(42);
+	UINT32 a[16];
+	for (UINT32& i : a) i = Random(1000);
+
+	SeedRandom(42);
+	for (int i = 0; i != 100; ++i) StreamRandom(RANDOM_STREAM_SOUND, 1000);
+	for (UINT32 const i : a) EXPECT_EQ(Random(1000), i);
+
+	SeedRandomStream(RANDOM_STREAM_SOUND, 7);
+	UINT32 const s = StreamRandom(RANDOM_STREAM_SOUND, 1000000);
+	SeedRandomStream(RANDOM_STREAM_SOUND, 7);
+	EXPECT_EQ(StreamRandom(RANDOM_STREAM_SOUND, 1000000), s);
+}
@@ -2,6 +2,7 @@
 #include <exception>
 #include <new>
 
+#include "AsyncLog.h"
 #include "Button_System.h"
 #include "Cheats.h"
 #include "Debug.h"
@@ -10,16 +11,21 @@
 #include "GameLoop.h"
 #include "Init.h" // XXX should not be used in SGP
 #include "Input.h"
+#include "InputReplay.h"
 #include "Intro.h"
 #include "JA2_Splash.h"
 #include "MemMan.h"
+#include "Prefetch.h"
+#include "Profiler.h"
 #include "Random.h"
 #include "SGP.h"
 #include "SaveLoadGame.h" // XXX should not be used in SGP
 #include "SoundMan.h"
+#include "Tile_Surface.h" // XXX should not be used in SGP
 #include "VObject.h"
 #include "Video.h"
 #include "VSurface.h"
+#include "WorkerPool.h"
 #include <SDL.h>
 #include "UILayout.h"
 #include "GameRes.h"
@@ -125,11 +131,14 @@ extern BOOLEAN gfPauseDueToPlayerGamePause;
 ////////////////////////////////////////////////////////////////////////////
 
 static BOOLEAN gfGameInitialized = FALSE;
+static int     g_exit_status     = EXIT_SUCCESS;
 
 /** Deinitialize the game an exit. */
 static void deinitGameAndExit()
 {
 	SLOGD("Deinitializing Game");
+	ShutdownInputReplay();
+
 	// If we are in Dead is Dead mode, save before exit
 	// Does this code also fire on crash? Let's hope not!
 	DoDeadIsDeadSaveIfNecessary();
@@ -160,88 +169,249 @@ static void deinitGameAndExit()
 	ShutdownVideoObjectManager();
 	SLOGD("Shutting Down Video Manager");
 	ShutdownVideoManager();
+	SLOGD("Shutting Down Prefetcher");
+	ShutdownPrefetcher();
+	SLOGD("Shutting Down Worker Pool");
+	ShutdownWorkerPool();
 	SLOGD("Shutting Down Memory Manager");
 	ShutdownMemoryManager();  // must go last, for MemDebugCounter to work right...
 
+	StopAsyncLogging();
+
 	SLOGD("Shutting Down SDL");
 	SDL_Quit();
 
-	exit(0);
+	exit(g_exit_status);
 }
 
 
 /** Request game exit.
  * Call this function if you want to exit the game. */
-void requestGameExit()
+void requestGameExit(int const exit_status)
 {
+	g_exit_status = exit_status;
 	SDL_Event event;
 	event.type = SDL_QUIT;
 	SDL_PushEvent(&event);
 }
 
+static void HandleSDLEvent(SDL_Event const& event, BOOLEAN& doGameCycles)
+{
+	RecordInputEvent(event);
+
+	switch (event.type)
+	{
+		case SDL_APP_WILLENTERBACKGROUND:
+			doGameCycles = false;
+			break;
+
+		case SDL_APP_WILLENTERFOREGROUND:
+			doGameCycles = true;
+			break;
+
+		case SDL_KEYDOWN: KeyDown(&event.key.keysym); break;
+		case SDL_KEYUP:   KeyUp(  &event.key.keysym); break;
+		case SDL_TEXTINPUT: TextInput(&event.text); break;
+
+		case SDL_MOUSEBUTTONDOWN: MouseButtonDown(&event.button); break;
+		case SDL_MOUSEBUTTONUP:   MouseButtonUp(&event.button);   break;
+
+		case SDL_MOUSEMOTION:
+			SetSafeMousePosition(event.motion.x, event.motion.y);
+			break;
+
+		case SDL_MOUSEWHEEL: MouseWheelScroll(&event.wheel); break;
+
+		case SDL_QUIT: deinitGameAndExit(); break;
+	}
+}
+
+
+#define IDLE_AFTER_MS          1000 // without input before a static screen counts as idle
+#define IDLE_MS_PER_GAME_CYCLE  100
+
+
+/* Runs a game cycle every msPerGameCycle milliseconds. In between the loop
+ * blocks until an event arrives or the next cycle is due, so input is handled
+ * immediately and no time is spent polling. Screens which only change on input,
+ * like the main menu, get a cycle every IDLE_MS_PER_GAME_CYCLE milliseconds
+ * once there was no input for a while, and the next input runs a cycle right
+ * away. Input recordings need the same cycles throughout, so they always run
+ * at full rate. The wakeups are counted by the profiler. */
 static void MainLoop(int msPerGameCycle)
 {
 	BOOLEAN s_doGameCycles = TRUE;
+	UINT32  nextGameCycleMS = SDL_GetTicks();
+	UINT32  lastInputMS     = SDL_GetTicks();
+	bool    idle            = false;
 
 	while (true)
 	{
 		// cycle until SDL_Quit is received
 
 		SDL_Event event;
-		if (SDL_PollEvent(&event))
+		int gotEvent;
+		if (s_doGameCycles)
+		{
+			INT32 const waitMS = (INT32)(nextGameCycleMS - SDL_GetTicks());
+			gotEvent = waitMS > 0 ? SDL_WaitEventTimeout(&event, waitMS) : SDL_PollEvent(&event);
+		}
+		else
 		{
-			switch (event.type)
+			gotEvent = SDL_WaitEvent(&event);
+		}
+		ProfilerCount(PROFILE_WAKEUPS, 1);
+
+		if (gotEvent)
+		{
+			lastInputMS = SDL_GetTicks();
+			if (idle)
 			{
-				case SDL_APP_WILLENTERBACKGROUND:
-					s_doGameCycles = false;
-					break;
+				idle            = false;
+				nextGameCycleMS = lastInputMS;
+			}
+
+			HandleSDLEvent(event, s_doGameCycles);
+			if (!s_doGameCycles) continue;
+			// Keep handling queued events until the next game cycle is due
+			if ((INT32)(nextGameCycleMS - SDL_GetTicks()) > 0) continue;
+		}
+		else if (!s_doGameCycles)
+		{
+			continue;
+		}
 
-				case SDL_APP_WILLENTERFOREGROUND:
-					s_doGameCycles = true;
-					break;
+#if DEBUG_PRINT_GAME_CYCLE_TIME
+		UINT32 const gameCycleStartMS = SDL_GetTicks();
+#endif
+		GameLoop();
+		EndInputReplayCycle();
+
+		idle =
+			!IsRecordingInput() &&
+			SDL_GetTicks() - lastInputMS >= IDLE_AFTER_MS &&
+			IsGameScreenStatic();
+		int const cycleMS = idle ? IDLE_MS_PER_GAME_CYCLE : msPerGameCycle;
+
+		/* Schedule relative to the previous deadline so a late wakeup is made up
+		 * for by the next cycle, but do not try to catch up after long stalls
+		 * (loading, dragging the window, ...). */
+		nextGameCycleMS += cycleMS;
+		if ((INT32)(SDL_GetTicks() - nextGameCycleMS) > cycleMS)
+		{
+			nextGameCycleMS = SDL_GetTicks() + cycleMS;
+		}
 
-				case SDL_KEYDOWN: KeyDown(&event.key.keysym); break;
-				case SDL_KEYUP:   KeyUp(  &event.key.keysym); break;
-				case SDL_TEXTINPUT: TextInput(&event.text); break;
+#if DEBUG_PRINT_GAME_CYCLE_TIME
+		printf("game cycle: %4d\n", SDL_GetTicks() - gameCycleStartMS);
+#endif
+	}
+}
 
-				case SDL_MOUSEBUTTONDOWN: MouseButtonDown(&event.button); break;
-				case SDL_MOUSEBUTTONUP:   MouseButtonUp(&event.button);   break;
 
-				case SDL_MOUSEMOTION:
-					SetSafeMousePosition(event.motion.x, event.motion.y);
-					break;
+#define MAX_GAME_CYCLES_PER_FRAME 4 // more are not caught up after a stall
 
-				case SDL_MOUSEWHEEL: MouseWheelScroll(&event.wheel); break;
 
-				case SDL_QUIT: deinitGameAndExit(); break;
-			}
+/* Sleeps until the deadline in performance counter ticks, handling the events
+ * which arrive meanwhile. SDL sleeps in whole milliseconds, so the last one is
+ * spent polling. */
+static void WaitForDeadline(uint64_t const deadline, BOOLEAN& doGameCycles)
+{
+	uint64_t const freq = SDL_GetPerformanceFrequency();
+	for (;;)
+	{
+		uint64_t const now = SDL_GetPerformanceCounter();
+		if (now >= deadline) return;
+		int const ms = (int)((deadline - now) * 1000 / freq);
+		SDL_Event event;
+		bool const got_event = ms > 1 ? SDL_WaitEventTimeout(&event, ms - 1) : SDL_PollEvent(&event);
+		if (ms > 1) ProfilerCount(PROFILE_WAKEUPS, 1);
+		if (got_event)
+		{
+			HandleSDLEvent(event, doGameCycles);
+		}
+	}
+}
+
+
+/* Runs the game cycles on the same fixed timestep as MainLoop(), but timed by
+ * the performance counter, and presents the frame separately: with vsync once
+ * per refresh of the display, which also paces the loop, otherwise after every
+ * game cycle. Game cycles which fall due while waiting for the refresh are run
+ * before the next present, so the game runs at its speed whatever the refresh
+ * rate is. */
+static void PacedMainLoop(int const msPerGameCycle)
+{
+	uint64_t const freq         = SDL_GetPerformanceFrequency();
+	uint64_t const cycle_ticks  = freq * msPerGameCycle / 1000;
+	bool     const vsync        = VideoHasVSync();
+	BOOLEAN        doGameCycles = TRUE;
+	uint64_t       next_cycle   = SDL_GetPerformanceCounter();
+	uint64_t       last_present = 0;
+
+	while (true)
+	{
+		SDL_Event event;
+		if (!doGameCycles)
+		{
+			if (SDL_WaitEvent(&event)) HandleSDLEvent(event, doGameCycles);
+			next_cycle = SDL_GetPerformanceCounter();
+			continue;
+		}
+		while (SDL_PollEvent(&event)) HandleSDLEvent(event, doGameCycles);
+		if (!doGameCycles) continue;
+
+		UINT     cycles = 0;
+		uint64_t now    = SDL_GetPerformanceCounter();
+		while (now >= next_cycle && cycles != MAX_GAME_CYCLES_PER_FRAME)
+		{
+			GameLoop();
+			EndInputReplayCycle();
+			next_cycle += cycle_ticks;
+			++cycles;
+			now = SDL_GetPerformanceCounter();
+		}
+		if (now >= next_cycle) next_cycle = now + cycle_ticks;
+
+		if (vsync)
+		{
+			PresentScreen();
+			/* A hidden or minimised window may not wait for the refresh, so do not
+			 * spin then */
+			now = SDL_GetPerformanceCounter();
+			if (now - last_present < freq / 1000) WaitForDeadline(next_cycle, doGameCycles);
+			last_present = now;
 		}
 		else
 		{
-			if (s_doGameCycles)
-			{
-				UINT32 gameCycleMS = GetClock();
-#if DEBUG_PRINT_GAME_CYCLE_TIME
-				UINT32 totalGameCycleMS = gameCycleMS;
-#endif
-				GameLoop();
-				gameCycleMS = GetClock() - gameCycleMS;
+			if (cycles != 0) PresentScreen();
+			WaitForDeadline(next_cycle, doGameCycles);
+		}
+	}
+}
 
-				if(gameCycleMS < msPerGameCycle)
-				{
-					SDL_Delay(msPerGameCycle - gameCycleMS);
-				}
 
-#if DEBUG_PRINT_GAME_CYCLE_TIME
-				totalGameCycleMS = GetClock() - totalGameCycleMS;
-				printf("game cycle: %4d %4d\n", gameCycleMS, totalGameCycleMS);
-#endif
-			}
-			else
-			{
-				SDL_WaitEvent(NULL);
-			}
+/* Runs the game cycles of a replay back to back, each with the input which was
+ * recorded for it, and exits at the end of the recording. */
+static void ReplayLoop()
+{
+	BOOLEAN doGameCycles = TRUE;
+	while (true)
+	{
+		SDL_Event event;
+		while (SDL_PollEvent(&event))
+		{
+			// Only quitting is taken from the user, the input is the recorded one
+			if (event.type == SDL_QUIT) deinitGameAndExit();
 		}
+		while (PollReplayEvent(event))
+		{
+			HandleSDLEvent(event, doGameCycles);
+		}
+		if (InputReplayFinished()) deinitGameAndExit();
+
+		GameLoop();
+		EndInputReplayCycle();
 	}
 }
 
@@ -340,6 +510,10 @@ int main(int argc, char* argv[])
 		GameState::getInstance()->setEditorMode(false);
 	}
 
+	if (EngineOptions_shouldRunBenchmarks(params.get())) {
+		GameState::getInstance()->setBenchmarking(true);
+	}
+
 	uint16_t width = EngineOptions_getResolutionX(params.get());
 	uint16_t height = EngineOptions_getResolutionY(params.get());
 	bool result = g_ui.setScreenSize(width, height);
@@ -358,13 +532,26 @@ int main(int argc, char* argv[])
 #endif
 	}
 
+	// The checks above log right away, so their last word is never lost
+	StartAsyncLogging();
+
 	GameVersion version = EngineOptions_getResourceVersion(params.get());
 	setGameVersion(version);
 
 	VideoScaleQuality scalingQuality = EngineOptions_getScalingQuality(params.get());
 
+	BOOLEAN gpuCompositing = EngineOptions_shouldUseGPUCompositing(params.get());
+	BOOLEAN hardwareCursor = EngineOptions_shouldUseHardwareCursor(params.get());
+	BOOLEAN framePacing    = EngineOptions_shouldPaceFrames(params.get());
+
+	UINT32 tileCacheSize = EngineOptions_getTileCacheSize(params.get());
+
 	FLOAT brightness = EngineOptions_getBrightness(params.get());
 
+	RustPointer<char> recordInput(EngineOptions_getRecordInput(params.get()));
+	RustPointer<char> replayInput(EngineOptions_getReplayInput(params.get()));
+	bool replayPresent = !EngineOptions_shouldReplayWithoutRendering(params.get());
+
 	////////////////////////////////////////////////////////////
 
 	SDL_Init(SDL_INIT_VIDEO);
@@ -463,17 +650,43 @@ int main(int argc, char* argv[])
 		}
 	}
 
+	// The game data is parsed on the worker pool
+	SLOGD("Initializing Worker Pool");
+	InitializeWorkerPool();
+
 	if(!cm->loadGameData())
 	{
 		SLOGI("Failed to load the game data.");
+		ShutdownWorkerPool();
 	}
 	else
 	{
 
 		GCM = cm;
 
+		// Recording and replaying run on the fixed clock from the start
+		if (replayInput.get()[0] != '\0')
+		{
+			StartInputReplay(replayInput.get(), replayPresent);
+		}
+		else if (recordInput.get()[0] != '\0')
+		{
+			StartInputRecording(recordInput.get(), gamepolicy(ms_per_game_cycle));
+		}
+		if (IsRecordingInput() || IsReplayingInput())
+		{
+			// The sound thread would decide when speech ends, which a replay cannot reproduce
+			SLOGI("Sound is off while recording or replaying input");
+			SoundEnableSound(FALSE);
+		}
+
+		SLOGD("Initializing Prefetcher");
+		InitializePrefetcher();
+
+		SetTileSurfaceCacheBudget(size_t(tileCacheSize) * 1024 * 1024);
+
 		SLOGD("Initializing Video Manager");
-		InitializeVideoManager(scalingQuality);
+		InitializeVideoManager(scalingQuality, gpuCompositing, hardwareCursor, framePacing);
 		VideoSetBrightness(brightness);
 
 		SLOGD("Initializing Video Object Manager");
@@ -497,6 +710,10 @@ int main(int argc, char* argv[])
 		SLOGD("Initializing Random");
 		// Initialize random number generator
 		InitializeRandom(); // no Shutdown
+		if (IsRecordingInput() || IsReplayingInput())
+		{
+			SeedRandom(GetInputReplaySeed());
+		}
 
 		SLOGD("Initializing Game Manager");
 		// Initialize the Game
@@ -529,7 +746,18 @@ int main(int argc, char* argv[])
 		/* At this point the SGP is set up, which means all I/O, Memory, tools, etc.
 		 * are available. All we need to do is attend to the gaming mechanics
 		 * themselves */
-		MainLoop(gamepolicy(ms_per_game_cycle));
+		if (IsReplayingInput())
+		{
+			ReplayLoop();
+		}
+		else if (VideoFramePacing())
+		{
+			PacedMainLoop(gamepolicy(ms_per_game_cycle));
+		}
+		else
+		{
+			MainLoop(gamepolicy(ms_per_game_cycle));
+		}
 	}
 
 	delete cm;
@@ -542,14 +770,12 @@ int main(int argc, char* argv[])
 					STRING_ENC_TYPE encType,
 					const char *dialogFile, const char *outputFile)
 {
-	std::vector<ST::string*> quotes;
+	std::vector<ST::string> quotes;
 	std::vector<std::string> quotes_str;
 	cm->loadAllDialogQuotes(encType, dialogFile, quotes);
 	for(int i = 0; i < quotes.size(); i++)
 	{
-		quotes_str.push_back(quotes[i]->to_std_string());
-		delete quotes[i];
-		quotes[i] = nullptr;
+		quotes_str.push_back(quotes[i].to_std_string());
 	}
 	JsonUtility::writeToFile(outputFile, quotes_str);
 }*/
@@ -3,8 +3,11 @@
 
 #include "Types.h"
 
+#include <stdlib.h>
+
 /** Request game exit.
- * Call this function if you want to exit the game. */
-void requestGameExit();
+ * Call this function if you want to exit the game. The process ends with the
+ * given exit status. */
+void requestGameExit(int exit_status = EXIT_SUCCESS);
 
 #endif
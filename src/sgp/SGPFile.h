@@ -13,10 +13,12 @@ struct SGP_FILETIME
 enum SGPFileFlags
 {
 	SGPFILE_NONE = 0U,
-	SGPFILE_REAL = 1U << 0
+	SGPFILE_REAL   = 1U << 0,
+	SGPFILE_MEMORY = 1U << 1
 };
 
 struct LibraryFile;
+struct SGPMemoryFile;
 
 struct SGPFile
 {
@@ -25,6 +27,7 @@ struct SGPFile
 	{
 		FILE*       file;
 		LibraryFile* lib;
+		SGPMemoryFile* mem;
 	} u;
 };
 
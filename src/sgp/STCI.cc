@@ -8,20 +8,21 @@
 #include "Debug.h"
 #include "STCI.h"
 
-#include "ContentManager.h"
-#include "GameInstance.h"
 #include "Logger.h"
 
-static SGPImage* STCILoadIndexed(UINT16 contents, HWFILE, STCIHeader const*);
-static SGPImage* STCILoadRGB(    UINT16 contents, HWFILE, STCIHeader const*);
+static SGPImage* STCILoadIndexed(UINT16 contents, FileViewReader&, STCIHeader const*);
+static SGPImage* STCILoadRGB(    UINT16 contents, FileViewReader&, STCIHeader const*);
 
 
-SGPImage* LoadSTCIFileToImage(char const* const filename, UINT16 const fContents)
+SGPImage* LoadSTCIImage(HWFILE const file, UINT16 const fContents)
 {
-	AutoSGPFile f(GCM->openGameResForReading(filename));
+	/* The file is read through a view, so the data is copied straight from the
+	 * mapped file into the image buffers. */
+	FileView const view(file);
+	FileViewReader f(view);
 
 	STCIHeader header;
-	FileRead(f, &header, sizeof(header));
+	f.Read(&header, sizeof(header));
 	if (memcmp(header.cID, STCI_ID_STRING, STCI_ID_LEN) != 0)
 	{
 		throw std::runtime_error("STCI file has invalid header");
@@ -41,7 +42,7 @@ SGPImage* LoadSTCIFileToImage(char const* const filename, UINT16 const fContents
 }
 
 
-static SGPImage* STCILoadRGB(UINT16 const contents, HWFILE const f, STCIHeader const* const header)
+static SGPImage* STCILoadRGB(UINT16 const contents, FileViewReader& f, STCIHeader const* const header)
 {
 	if (contents & IMAGE_PALETTE && (contents & IMAGE_ALLIMAGEDATA) != IMAGE_ALLIMAGEDATA)
 	{ // RGB doesn't have a palette!
@@ -53,7 +54,7 @@ static SGPImage* STCILoadRGB(UINT16 const contents, HWFILE const f, STCIHeader c
 	{
 		// Allocate memory for the image data and read it in
 		UINT8* const img_data = img->pImageData.Allocate(header->uiStoredSize);
-		FileRead(f, img_data, header->uiStoredSize);
+		f.Read(img_data, header->uiStoredSize);
 
 		img->fFlags |= IMAGE_BITMAPDATA;
 
@@ -93,7 +94,7 @@ static SGPImage* STCILoadRGB(UINT16 const contents, HWFILE const f, STCIHeader c
 }
 
 
-static SGPImage* STCILoadIndexed(UINT16 const contents, HWFILE const f, STCIHeader const* const header)
+static SGPImage* STCILoadIndexed(UINT16 const contents, FileViewReader& f, STCIHeader const* const header)
 {
 	AutoSGPImage img(new SGPImage(header->usWidth, header->usHeight, header->ubDepth));
 	if (contents & IMAGE_PALETTE)
@@ -103,10 +104,8 @@ static SGPImage* STCILoadIndexed(UINT16 const contents, HWFILE const f, STCIHead
 			throw std::runtime_error("Palettized image has bad palette size.");
 		}
 
-		SGP::Buffer<STCIPaletteElement> pSTCIPalette(256);
-
-		// Read in the palette
-		FileRead(f, pSTCIPalette, sizeof(*pSTCIPalette) * 256);
+		// The palette is converted straight from the file data
+		STCIPaletteElement const* const pSTCIPalette = reinterpret_cast<STCIPaletteElement const*>(f.Take(sizeof(*pSTCIPalette) * 256));
 
 		SGPPaletteEntry* const palette = img->pPalette.Allocate(256);
 		for (size_t i = 0; i < 256; i++)
@@ -121,7 +120,7 @@ static SGPImage* STCILoadIndexed(UINT16 const contents, HWFILE const f, STCIHead
 	}
 	else if (contents & (IMAGE_BITMAPDATA | IMAGE_APPDATA))
 	{ // seek past the palette
-		FileSeek(f, sizeof(STCIPaletteElement) * header->Indexed.uiNumberOfColours, FILE_SEEK_FROM_CURRENT);
+		f.Take(sizeof(STCIPaletteElement) * header->Indexed.uiNumberOfColours);
 	}
 
 	if (contents & IMAGE_BITMAPDATA)
@@ -135,27 +134,27 @@ static SGPImage* STCILoadIndexed(UINT16 const contents, HWFILE const f, STCIHead
 			img->usNumberOfObjects = n_subimages;
 
 			ETRLEObject* const etrle_objects = img->pETRLEObject.Allocate(n_subimages);
-			FileRead(f, etrle_objects, sizeof(*etrle_objects) * n_subimages);
+			f.Read(etrle_objects, sizeof(*etrle_objects) * n_subimages);
 
 			img->uiSizePixData  = header->uiStoredSize;
 			img->fFlags        |= IMAGE_TRLECOMPRESSED;
 		}
 
 		UINT8* const image_data = img->pImageData.Allocate(header->uiStoredSize);
-		FileRead(f, image_data, header->uiStoredSize);
+		f.Read(image_data, header->uiStoredSize);
 
 		img->fFlags |= IMAGE_BITMAPDATA;
 	}
 	else if (contents & IMAGE_APPDATA) // then there's a point in seeking ahead
 	{
-		FileSeek(f, header->uiStoredSize, FILE_SEEK_FROM_CURRENT);
+		f.Take(header->uiStoredSize);
 	}
 
 	if (contents & IMAGE_APPDATA && header->uiAppDataSize > 0)
 	{
 		// load application-specific data
 		UINT8* const app_data = img->pAppData.Allocate(header->uiAppDataSize);
-		FileRead(f, app_data, header->uiAppDataSize);
+		f.Read(app_data, header->uiAppDataSize);
 
 		img->uiAppDataSize  = header->uiAppDataSize;
 		img->fFlags        |= IMAGE_APPDATA;
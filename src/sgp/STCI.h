@@ -4,6 +4,8 @@
 #include "Types.h"
 
 
-SGPImage* LoadSTCIFileToImage(char const* filename, UINT16 fContents);
+/* Reads the image from an open file. CreateImage() opens the game resources
+ * with it, other files may be passed as well. */
+SGPImage* LoadSTCIImage(HWFILE, UINT16 fContents);
 
 #endif
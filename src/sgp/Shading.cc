@@ -1,4 +1,7 @@
+#include "Debug.h"
+#include "ETRLEBlitter.h"
 #include "HImage.h"
+#include "MemMan.h"
 #include "Shading.h"
 #include "VObject.h"
 
@@ -65,3 +68,216 @@ void SetShadeTablePercent(float uiShadePercent)
 	guiShadePercent = uiShadePercent;
 	BuildShadeTable();
 }
+
+
+/**********************************************************************************************
+Create16BPPPaletteShaded
+
+	Creates an 8 bit to 16 bit palette table, and modifies the colors as it builds.
+
+	Parameters:
+		rscale, gscale, bscale:
+				Color mode: Percentages (255=100%) of color to translate into destination palette.
+				Mono mode:  Color for monochrome palette.
+		mono:
+				TRUE or FALSE to create a monochrome palette. In mono mode, Luminance values for
+				colors are calculated, and the RGB color is shaded according to each pixel's brightness.
+
+	This can be used in several ways:
+
+	1) To "brighten" a palette, pass down RGB values that are higher than 100% ( > 255) for all
+			three. mono=FALSE.
+	2) To "darken" a palette, do the same with less than 100% ( < 255) values. mono=FALSE.
+
+	3) To create a "glow" palette, select mono=TRUE, and pass the color in the RGB parameters.
+
+	4) For gamma correction, pass in weighted values for each color.
+
+**********************************************************************************************/
+UINT16* Create16BPPPaletteShaded(const SGPPaletteEntry* pPalette, UINT32 rscale, UINT32 gscale, UINT32 bscale, BOOLEAN mono)
+{
+	UINT16* const p16BPPPalette = MALLOCN(UINT16, 256);
+	Build16BPPPaletteShaded(p16BPPPalette, pPalette, rscale, gscale, bscale, mono);
+	return p16BPPPalette;
+}
+
+
+static void Build16BPPPaletteShadedScalar(UINT16* const p16BPPPalette, const SGPPaletteEntry* const pPalette, UINT32 const rscale, UINT32 const gscale, UINT32 const bscale, BOOLEAN const mono)
+{
+	for (UINT32 cnt = 0; cnt < 256; cnt++)
+	{
+		UINT32 rmod;
+		UINT32 gmod;
+		UINT32 bmod;
+		if (mono)
+		{
+			UINT32 lumin = (pPalette[cnt].r * 299 + pPalette[cnt].g * 587 + pPalette[cnt].b * 114) / 1000;
+			rmod = rscale * lumin / 256;
+			gmod = gscale * lumin / 256;
+			bmod = bscale * lumin / 256;
+		}
+		else
+		{
+			rmod = rscale * pPalette[cnt].r / 256;
+			gmod = gscale * pPalette[cnt].g / 256;
+			bmod = bscale * pPalette[cnt].b / 256;
+		}
+
+		UINT8 r = __min(rmod, 255);
+		UINT8 g = __min(gmod, 255);
+		UINT8 b = __min(bmod, 255);
+		p16BPPPalette[cnt] = Get16BPPColor(FROMRGB(r, g, b));
+	}
+}
+
+
+#if defined BLT_SSE2
+// min(c * scale / 256, 255) for eight 8 bit channel values in 16 bit lanes
+static inline __m128i ScaleChannel(__m128i const c, __m128i const scale)
+{
+	__m128i const lo  = _mm_srli_epi16(_mm_mullo_epi16(c, scale), 8);
+	__m128i const fit = _mm_cmpeq_epi16(_mm_mulhi_epu16(c, scale), _mm_setzero_si128());
+	return _mm_or_si128(_mm_and_si128(fit, lo), _mm_andnot_si128(fit, _mm_set1_epi16(255)));
+}
+
+
+static inline __m128i ShiftChannel(__m128i const c, INT16 const shift, UINT16 const mask)
+{
+	__m128i const s = shift < 0 ?
+		_mm_srl_epi16(c, _mm_cvtsi32_si128(-shift)) :
+		_mm_sll_epi16(c, _mm_cvtsi32_si128( shift));
+	return _mm_and_si128(s, _mm_set1_epi16(mask));
+}
+
+
+// Eight entries at a time, see Get16BPPColor()
+static void Build16BPPPaletteShadedSSE2(UINT16* const dst, const SGPPaletteEntry* const pal, UINT32 const rscale, UINT32 const gscale, UINT32 const bscale)
+{
+	__m128i const rs   = _mm_set1_epi16(rscale);
+	__m128i const gs   = _mm_set1_epi16(gscale);
+	__m128i const bs   = _mm_set1_epi16(bscale);
+	__m128i const byte = _mm_set1_epi32(0xFF);
+	for (UINT32 i = 0; i != 256; i += 8)
+	{
+		__m128i const p0 = _mm_loadu_si128(reinterpret_cast<__m128i const*>(pal + i));
+		__m128i const p1 = _mm_loadu_si128(reinterpret_cast<__m128i const*>(pal + i + 4));
+		__m128i const r  = _mm_packs_epi32(_mm_and_si128(p0, byte),                     _mm_and_si128(p1, byte));
+		__m128i const g  = _mm_packs_epi32(_mm_and_si128(_mm_srli_epi32(p0,  8), byte), _mm_and_si128(_mm_srli_epi32(p1,  8), byte));
+		__m128i const b  = _mm_packs_epi32(_mm_and_si128(_mm_srli_epi32(p0, 16), byte), _mm_and_si128(_mm_srli_epi32(p1, 16), byte));
+
+		__m128i const r8 = ScaleChannel(r, rs);
+		__m128i const g8 = ScaleChannel(g, gs);
+		__m128i const b8 = ScaleChannel(b, bs);
+		__m128i colour = _mm_or_si128(_mm_or_si128(
+			ShiftChannel(r8, gusRedShift,   gusRedMask),
+			ShiftChannel(g8, gusGreenShift, gusGreenMask)),
+			ShiftChannel(b8, gusBlueShift,  gusBlueMask));
+
+		// absolute black only stays black if the colour was black
+		__m128i const zero  = _mm_setzero_si128();
+		__m128i const black = _mm_cmpeq_epi16(colour, zero);
+		__m128i const none  = _mm_cmpeq_epi16(_mm_or_si128(_mm_or_si128(r8, g8), b8), zero);
+		colour = _mm_or_si128(colour, _mm_andnot_si128(none, _mm_and_si128(black, _mm_set1_epi16(BLACK_SUBSTITUTE))));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), colour);
+	}
+}
+
+#elif defined BLT_NEON
+// min(c * scale / 256, 255) for eight 8 bit channel values
+static inline uint16x8_t ScaleChannel(uint8x8_t const c, uint16_t const scale)
+{
+	uint16x8_t const c16 = vmovl_u8(c);
+	uint32x4_t const lo  = vmull_n_u16(vget_low_u16(c16),  scale);
+	uint32x4_t const hi  = vmull_n_u16(vget_high_u16(c16), scale);
+	uint16x8_t const s   = vcombine_u16(vqshrn_n_u32(lo, 8), vqshrn_n_u32(hi, 8));
+	return vminq_u16(s, vdupq_n_u16(255));
+}
+
+
+static inline uint16x8_t ShiftChannel(uint16x8_t const c, INT16 const shift, UINT16 const mask)
+{
+	return vandq_u16(vshlq_u16(c, vdupq_n_s16(shift)), vdupq_n_u16(mask));
+}
+
+
+// Eight entries at a time, see Get16BPPColor()
+static void Build16BPPPaletteShadedNEON(UINT16* const dst, const SGPPaletteEntry* const pal, UINT32 const rscale, UINT32 const gscale, UINT32 const bscale)
+{
+	for (UINT32 i = 0; i != 256; i += 8)
+	{
+		uint8x8x4_t const p  = vld4_u8(reinterpret_cast<uint8_t const*>(pal + i));
+		uint16x8_t  const r8 = ScaleChannel(p.val[0], rscale);
+		uint16x8_t  const g8 = ScaleChannel(p.val[1], gscale);
+		uint16x8_t  const b8 = ScaleChannel(p.val[2], bscale);
+		uint16x8_t colour = vorrq_u16(vorrq_u16(
+			ShiftChannel(r8, gusRedShift,   gusRedMask),
+			ShiftChannel(g8, gusGreenShift, gusGreenMask)),
+			ShiftChannel(b8, gusBlueShift,  gusBlueMask));
+
+		// absolute black only stays black if the colour was black
+		uint16x8_t const black = vceqq_u16(colour, vdupq_n_u16(0));
+		uint16x8_t const some  = vtstq_u16(vorrq_u16(vorrq_u16(r8, g8), b8), vdupq_n_u16(0xFFFF));
+		colour = vorrq_u16(colour, vandq_u16(vandq_u16(black, some), vdupq_n_u16(BLACK_SUBSTITUTE)));
+		vst1q_u16(dst + i, colour);
+	}
+}
+#endif
+
+
+void Build16BPPPaletteShaded(UINT16* const p16BPPPalette, const SGPPaletteEntry* const pPalette, UINT32 const rscale, UINT32 const gscale, UINT32 const bscale, BOOLEAN const mono)
+{
+	Assert(pPalette != NULL);
+
+#if defined BLT_SSE2 || defined BLT_NEON
+	// The vector kernels multiply in 16 bit lanes
+	if (g_simd_blitters && !mono && rscale <= UINT16_MAX && gscale <= UINT16_MAX && bscale <= UINT16_MAX)
+	{
+#	if defined BLT_SSE2
+		Build16BPPPaletteShadedSSE2(p16BPPPalette, pPalette, rscale, gscale, bscale);
+#	else
+		Build16BPPPaletteShadedNEON(p16BPPPalette, pPalette, rscale, gscale, bscale);
+#	endif
+		return;
+	}
+#endif
+	Build16BPPPaletteShadedScalar(p16BPPPalette, pPalette, rscale, gscale, bscale, mono);
+}
+
+
+#ifdef WITH_UNITTESTS
+#undef FAIL
+#include "gtest/gtest.h"
+
+TEST(Shading, paletteMatchesScalar)
+{
+	// 565
+	gusRedMask    = 0xF800;
+	gusGreenMask  = 0x07E0;
+	gusBlueMask   = 0x001F;
+	gusRedShift   =  8;
+	gusGreenShift =  3;
+	gusBlueShift  = -3;
+
+	SGPPaletteEntry pal[256];
+	for (UINT i = 0; i != 256; ++i)
+	{
+		pal[i].r = i;
+		pal[i].g = i * 7;
+		pal[i].b = i * 13 + 5;
+		pal[i].a = i * 3;
+	}
+	pal[0].r = pal[0].g = pal[0].b = 0;
+	pal[1].r = 1; pal[1].g = pal[1].b = 0; // shaded down to black
+
+	static UINT32 const scales[][3] = { { 255, 255, 255 }, { 500, 500, 500 }, { 60, 60, 160 }, { 0, 300, 1000 } };
+	for (UINT32 const* const s : scales)
+	{
+		UINT16 expected[256];
+		UINT16 actual[256];
+		Build16BPPPaletteShadedScalar(expected, pal, s[0], s[1], s[2], FALSE);
+		Build16BPPPaletteShaded(actual, pal, s[0], s[1], s[2], FALSE);
+		for (UINT i = 0; i != 256; ++i) EXPECT_EQ(expected[i], actual[i]);
+	}
+}
+
+#endif
@@ -9,6 +9,8 @@
 #include "Buffer.h"
 #include "Debug.h"
 #include "FileMan.h"
+#include "MemMan.h"
+#include "Profiler.h"
 #include "Random.h"
 #include "SoundMan.h"
 #include "Timer.h"
@@ -21,33 +23,50 @@
 
 #include <algorithm>
 #include <assert.h>
+#include <atomic>
+#include <deque>
 #include <iterator>
+#include <new>
 #include <stdexcept>
+#include <string>
+#include <vector>
+
+#if defined __SSE2__ || defined _M_X64 || (defined _M_IX86_FP && _M_IX86_FP >= 2)
+#	define MIX_SSE2
+#	include <emmintrin.h>
+#elif defined __ARM_NEON
+#	define MIX_NEON
+#	include <arm_neon.h>
+#endif
+
+#if SDL_VERSION_ATLEAST(2, 0, 7)
+#	define SOUND_STREAMS // they need SDL_AudioStream
+#endif
 
 
 // Uncomment this to disable the startup of sound hardware
 //#define SOUND_DISABLE
 
-/*
- * from\to FREE PLAY STOP DEAD
+/* The channel list belongs to the main thread and the voices to the sound
+ * callback. The main thread starts, stops and changes voices by queueing
+ * commands, which the callback carries out before it mixes a buffer. When a
+ * voice ends, the callback queues its channel back, and the main thread frees
+ * the channel in SoundServiceStreams(). Neither side waits for the other,
+ * except when all sounds are stopped, which pauses the callback. Streamed files
+ * are refilled by the stream thread, so they keep playing while the main
+ * thread is busy.
+ *
+ * from\to FREE PLAY
  *    FREE       M
- *    PLAY  2         M    C
- *    STOP  2              C
- *    DEAD  M         1
+ *    PLAY  E
  *
- * M = Regular state transition done by main thread
- * C = Regular state transition done by sound callback
- * 1 = Unimportant race, dead channel can be marked stopped by main thread
- *     Gets marked as dead again in the next sound callback run
- * 2 = Only when stopping all sounds, sound callback is deactivated when this
- *     happens
+ * M = Started by the main thread
+ * E = The voice ended, or all sounds were stopped
  */
 enum
 {
 	CHANNEL_FREE,
-	CHANNEL_PLAY,
-	CHANNEL_STOP,
-	CHANNEL_DEAD
+	CHANNEL_PLAY
 };
 
 
@@ -57,16 +76,21 @@ enum
 	SAMPLE_ALLOCATED = 1U << 0,
 	SAMPLE_LOCKED    = 1U << 1,
 	SAMPLE_RANDOM    = 1U << 2,
-	SAMPLE_STEREO    = 1U << 3
+	SAMPLE_STEREO    = 1U << 3,
+	SAMPLE_STREAMED  = 1U << 4  // not cached, freed when it stops playing
 };
 
 
-#define SOUND_MAX_CACHED 128 // number of cache slots
+#define SOUND_MAX_CACHED 512 // number of cache slots
 #define SOUND_MAX_CHANNELS 16 // number of mixer channels
 
 #define SOUND_DEFAULT_MEMORY (32 * 1024 * 1024) // default memory limit
 #define SOUND_DEFAULT_THRESH ( 2 * 1024 * 1024) // size for sample to be double-buffered
 #define SOUND_DEFAULT_STREAM (64 * 1024)        // double-buffered buffer size
+#define SOUND_STREAM_FRAMES  (SOUND_DEFAULT_STREAM / 4) // stereo frames in each half of a stream ring
+#define SOUND_STREAM_POLL    20                 // ms between refills of the streams
+#define SOUND_COMPRESS_RATIO 2                  // decoded size to file size above which the file is kept instead
+#define SOUND_DECODE_CHUNK   4096               // frames converted before they are handed to the mixer
 
 // The audio device will be opened with the following values
 #define SOUND_FREQ      44100
@@ -74,6 +98,56 @@ enum
 #define SOUND_CHANNELS  2
 #define SOUND_SAMPLES   1024
 
+// State of a decoder job or a stream
+enum
+{
+	DECODE_RUNNING,
+	DECODE_DONE,
+	DECODE_FAILED
+};
+
+struct SAMPLETAG;
+struct SoundStreamSource;
+
+/* A sound file which is decoded and converted to the format of the audio
+ * device on the decoder thread. The converted frames are handed over in chunks,
+ * so a voice can start playing the sample before it is complete. */
+struct SoundDecodeJob
+{
+	SAMPLETAG*        sample;     // main thread only, NULL once the job is finished
+	UINT32            n_voices;   // main thread only, voices which play from the job
+	bool              data_taken; // main thread only, the sample owns the data
+	std::string       name;       // for error messages
+	std::vector<BYTE> file;       // the decoder thread is done with it when the job is
+	UINT8*            data;       // set by the decoder thread before the first chunk
+	bool              stereo;     // likewise
+	UINT32            n_samples;  // set by the decoder thread before it is done
+	SDL_atomic_t      n_ready;    // frames of data which are converted
+	SDL_atomic_t      state;
+	SDL_atomic_t      cancel;
+};
+
+
+/* A streamed file, which the stream thread converts into one half of a ring
+ * while the sound callback plays the other. Unlike a decoded sample, a stream
+ * is played only once, so every play of a streamed file has its own. */
+struct SoundStream
+{
+	std::string        name;      // for error messages
+	std::vector<BYTE>  file;      // stream thread only once the stream is started
+	UINT32             loops;     // likewise
+	bool               started;   // main thread only
+	bool               released;  // the sample is gone, protected by the stream lock
+	UINT8*             ring;      // set by the stream thread before the first half is filled
+	bool               stereo;    // likewise
+	UINT32             frames[2]; // frames in each half, set before it is filled
+	SDL_atomic_t       filled;    // halves filled so far
+	SDL_atomic_t       played;    // halves played so far
+	SDL_atomic_t       state;     // set after the last half is filled
+	SoundStreamSource* source;    // stream thread only
+};
+
+
 // Struct definition for sample slots in the cache
 // Holds the regular sample data, as well as the data for the random samples
 struct SAMPLETAG
@@ -81,8 +155,16 @@ struct SAMPLETAG
 	CHAR8   pName[128];  // Path to sample data
 	UINT32  n_samples;
 	UINT32  uiFlags;     // Status flags
-	PTR     pData;       // pointer to sample data memory
+	PTR     pData;       // pointer to sample data memory, NULL while only the compressed form is kept
 	UINT32  uiCacheHits;
+	UINT32  uiLastUse;   // value of guiSoundUseCounter when last played
+
+	// Sound file the sample was decoded from, kept if it is much smaller
+	BYTE*   pCompressed;
+	UINT32  uiCompressedSize;
+
+	SoundDecodeJob* decode; // not NULL while the sample is being decoded
+	SoundStream*    stream; // set if the sample plays from a stream, it has no data then
 
 	// Random sound data
 	UINT32  uiTimeNext;
@@ -97,11 +179,110 @@ struct SAMPLETAG
 };
 
 
+/* Volume of one side of a channel, 0 to 127. The volume used for mixing moves
+ * towards the one set by MIX_RAMP_STEP after every MIX_RAMP_FRAMES frames, so
+ * changes of volume and panning don't click. */
+struct MixVolume
+{
+	INT current;
+	INT target;
+};
+
+#define MIX_RAMP_FRAMES 8
+#define MIX_RAMP_STEP   8
+
+
+// A channel as seen by the sound callback
+struct SoundVoice
+{
+	INT16 const*          data; // NULL if the voice is silent, unless it waits for the job
+	SoundDecodeJob*       job;  // set while the sample is being decoded
+	SoundStream*          stream;
+	UINT32                n_samples;
+	bool                  stereo;
+	UINT32                id;
+	UINT32                pos;
+	UINT32                loops;
+	UINT32                volume;
+	UINT32                pan;
+	MixVolume             vol_l;
+	MixVolume             vol_r;
+};
+
+
+enum SoundCommandType
+{
+	SOUND_CMD_PLAY,
+	SOUND_CMD_STOP,
+	SOUND_CMD_VOLUME,
+	SOUND_CMD_PAN
+};
+
+struct SoundCommand
+{
+	SoundCommandType      type;
+	UINT32                channel;
+	UINT32                id;
+	UINT32                value; // volume or pan
+	// SOUND_CMD_PLAY only
+	INT16 const*          data;
+	SoundDecodeJob*       job;
+	SoundStream*          stream;
+	UINT32                n_samples;
+	bool                  stereo;
+	UINT32                loops;
+	UINT32                pan;
+};
+
+
+/* A queue from one producer thread to one consumer thread, which neither of
+ * them ever waits on. */
+template<typename T, UINT32 N> class SPSCRing
+{
+	static_assert((N & (N - 1)) == 0, "size must be a power of two");
+
+	public:
+		SPSCRing() : head_(0), tail_(0) {}
+
+		// Producer only. Returns false if the ring is full.
+		bool push(T const& item)
+		{
+			UINT32 const head = head_.load(std::memory_order_relaxed);
+			if (head - tail_.load(std::memory_order_acquire) == N) return false;
+			items_[head % N] = item;
+			head_.store(head + 1, std::memory_order_release);
+			return true;
+		}
+
+		// Consumer only. Returns false if the ring is empty.
+		bool pop(T& item)
+		{
+			UINT32 const tail = tail_.load(std::memory_order_relaxed);
+			if (tail == head_.load(std::memory_order_acquire)) return false;
+			item = items_[tail % N];
+			tail_.store(tail + 1, std::memory_order_release);
+			return true;
+		}
+
+		// Only while neither side uses the ring
+		void clear()
+		{
+			head_.store(0);
+			tail_.store(0);
+		}
+
+	private:
+		T                   items_[N];
+		std::atomic<UINT32> head_;
+		std::atomic<UINT32> tail_;
+};
+
+
 // Structure definition for slots in the sound output
 // These are used for both the cached and double-buffered streams
 struct SOUNDTAG
 {
-	volatile UINT State;
+	UINT          State;
 	SAMPLETAG*    pSample;
 	UINT32        uiSoundID;
 	void          (*EOSCallback)(void*);
@@ -111,29 +292,54 @@ struct SOUNDTAG
 	UINT32        uiFadeVolume;
 	UINT32        uiFadeRate;
 	UINT32        uiFadeTime;
-	UINT32        pos;
-	UINT32        Loops;
 	UINT32        Pan;
+	SoundDecodeJob* decode; // the job the voice was started on, if any
 };
 
 static UINT32 GetSampleSize(const SAMPLETAG* const s);
 static const UINT32 guiSoundMemoryLimit    = SOUND_DEFAULT_MEMORY; // Maximum memory used for sounds
 static       UINT32 guiSoundMemoryUsed     = 0;                    // Memory currently in use
-//static const UINT32 guiSoundCacheThreshold = SOUND_DEFAULT_THRESH; // Double-buffered threshold
-static void IncreaseSoundMemoryUsedBySample(SAMPLETAG *sample) { guiSoundMemoryUsed += sample->n_samples * GetSampleSize(sample); }
-static void DecreaseSoundMemoryUsedBySample(SAMPLETAG *sample) { guiSoundMemoryUsed -= sample->n_samples * GetSampleSize(sample); }
+static const UINT32 guiSoundCacheThreshold = SOUND_DEFAULT_THRESH; // Files above this size are streamed
+static       UINT32 guiSoundUseCounter     = 0;                    // Incremented whenever a sample is played
+static       UINT32 guiSoundDecoding       = 0;                    // Samples with a decoder job
+
+// Memory of a sample counted against the limit. Streamed samples are not part of the cache.
+static UINT32 GetSampleMemory(const SAMPLETAG* const s)
+{
+	if (s->uiFlags & SAMPLE_STREAMED) return 0;
+	return (s->pData != NULL ? s->n_samples * GetSampleSize(s) : 0) + s->uiCompressedSize;
+}
+static void IncreaseSoundMemoryUsedBySample(SAMPLETAG *sample) { guiSoundMemoryUsed += GetSampleMemory(sample); }
+static void DecreaseSoundMemoryUsedBySample(SAMPLETAG *sample) { guiSoundMemoryUsed -= GetSampleMemory(sample); }
+
+// Cache statistics, logged when the sound manager is shut down
+static UINT32 guiSoundCacheHits      = 0;
+static UINT32 guiSoundCacheMisses    = 0;
+static UINT32 guiSoundCacheEvictions = 0;
+static UINT32 guiSoundDecodes        = 0; // compressed samples decoded again
+static UINT32 guiSoundStreamed       = 0;
 
 static BOOLEAN fSoundSystemInit = FALSE; // Startup called
 static BOOLEAN gfEnableStartup  = TRUE;  // Allow hardware to start up
 static INT32*  gMixBuffer = NULL;
 static UINT32  guiMixLength = 0;
 
+// Filled in by the sound callback, handed to the profiler by SoundServiceStreams()
+static std::atomic<UINT32> guiMixUnderruns(0); // callbacks which took longer than the audio they made
+static std::atomic<UINT32> guiMixMicroseconds(0);
+
 SDL_AudioSpec gTargetAudioSpec;
 
 // Sample cache list for files loaded
 static SAMPLETAG pSampleList[SOUND_MAX_CACHED];
 // Sound channel list for output channels
 static SOUNDTAG pSoundList[SOUND_MAX_CHANNELS];
+// What the sound callback plays on these channels
+static SoundVoice gSoundVoices[SOUND_MAX_CHANNELS];
+
+// Every channel ends at most once per start, so the ended ring can't fill up
+static SPSCRing<SoundCommand, 256>                gSoundCommands;
+static SPSCRing<UINT32,       SOUND_MAX_CHANNELS> gSoundEnded;
 
 
 void SoundEnableSound(BOOLEAN fEnable)
@@ -144,6 +350,10 @@ void SoundEnableSound(BOOLEAN fEnable)
 
 static void    SoundInitCache(void);
 static BOOLEAN SoundInitHardware(void);
+static void    SoundStartDecoder();
+static void    SoundStopDecoder();
+static void    SoundStartStreamer();
+static void    SoundStopStreamer();
 
 
 void InitializeSoundManager(void)
@@ -157,6 +367,11 @@ void InitializeSoundManager(void)
 #endif
 
 	SoundInitCache();
+	if (fSoundSystemInit)
+	{
+		SoundStartDecoder();
+		SoundStartStreamer();
+	}
 
 	guiSoundMemoryUsed = 0;
 }
@@ -168,8 +383,13 @@ static void SoundShutdownHardware(void);
 
 void ShutdownSoundManager(void)
 {
+	SLOGI("Sound cache: %u hits, %u misses, %u evictions, %u decodes, %u streamed, %u bytes used",
+		guiSoundCacheHits, guiSoundCacheMisses, guiSoundCacheEvictions, guiSoundDecodes, guiSoundStreamed, guiSoundMemoryUsed);
+
 	SoundStopAll();
 	SoundEmptyCache();
+	SoundStopDecoder();
+	SoundStopStreamer();
 	SoundShutdownHardware();
 	fSoundSystemInit = FALSE;
 	if (gMixBuffer != NULL)
@@ -182,38 +402,48 @@ void ShutdownSoundManager(void)
 
 
 static SOUNDTAG*  SoundGetFreeChannel(void);
-static SAMPLETAG* SoundLoadSample(const char* pFilename);
+static SAMPLETAG* SoundGetCached(const char* pFilename);
+static SAMPLETAG* SoundLoadSample(const char* pFilename, bool streamed, bool async);
 static UINT32     SoundStartSample(SAMPLETAG* sample, SOUNDTAG* channel, UINT32 volume, UINT32 pan, UINT32 loop, void (*end_callback)(void*), void* data);
+static void       SoundFreeSample(SAMPLETAG* s);
+static BOOLEAN    SoundSampleIsPlaying(const SAMPLETAG* s);
 
 
-UINT32 SoundPlay(const char* pFilename, UINT32 volume, UINT32 pan, UINT32 loop, void (*end_callback)(void*), void* data)
+/* Plays a sample. Files larger than guiSoundCacheThreshold are streamed as
+ * well, i.e. they do not go through the cache. */
+static UINT32 SoundPlaySample(const char* pFilename, bool streamed, UINT32 volume, UINT32 pan, UINT32 loop, void (*end_callback)(void*), void* data)
 {
 	if (!fSoundSystemInit) return SOUND_ERROR;
 
-#if 0 // TODO0003 implement streaming
-	if (SoundPlayStreamed(pFilename))
-	{
-		//Trying to play a sound which is bigger then the 'guiSoundCacheThreshold'
-		SLOGE("Trying to play %s sound is too large to load into cache, use SoundPlayStreamedFile() instead", pFilename));
-		return SOUND_ERROR;
-	}
-#endif
-
-	SAMPLETAG* const sample = SoundLoadSample(pFilename);
+	SAMPLETAG* const sample = SoundLoadSample(pFilename, streamed, true);
 	if (sample == NULL) return SOUND_ERROR;
 
 	SOUNDTAG* const channel = SoundGetFreeChannel();
-	if (channel == NULL) return SOUND_ERROR;
+	UINT32    const id      = channel != NULL ?
+		SoundStartSample(sample, channel, volume, pan, loop, end_callback, data) :
+		SOUND_ERROR;
+
+	// A streamed sample is not kept if it does not play
+	if (id == SOUND_ERROR && sample->uiFlags & SAMPLE_STREAMED && !SoundSampleIsPlaying(sample))
+	{
+		SoundFreeSample(sample);
+	}
+	return id;
+}
+
 
-	return SoundStartSample(sample, channel, volume, pan, loop, end_callback, data);
+UINT32 SoundPlay(const char* pFilename, UINT32 volume, UINT32 pan, UINT32 loop, void (*end_callback)(void*), void* data)
+{
+	return SoundPlaySample(pFilename, false, volume, pan, loop, end_callback, data);
 }
 
-static SAMPLETAG* SoundLoadBuffer(SDL_AudioFormat format, UINT8 channels, int freq, UINT8* pbuffer, UINT32 size);
-static BOOLEAN    SoundCleanCache(void);
+static SAMPLETAG* SoundLoadBuffer(SDL_AudioFormat format, UINT8 channels, int freq, UINT8* pbuffer, UINT32 size, bool streamed);
+static BOOLEAN    SoundCleanCache(const SAMPLETAG* keep);
 static SAMPLETAG* SoundGetEmptySample(void);
 
 UINT32 SoundPlayFromSmackBuff(UINT8 channels, UINT8 depth, UINT32 rate, UINT8* pbuffer, UINT32 size, UINT32 volume, UINT32 pan, UINT32 loop, void (*end_callback)(void*), void* data)
 {
+	MEM_TAG_SCOPE(MEM_TAG_SOUND);
 	SDL_AudioFormat format;
 
 	if (pbuffer == NULL) return SOUND_ERROR;
@@ -226,7 +456,7 @@ UINT32 SoundPlayFromSmackBuff(UINT8 channels, UINT8 depth, UINT32 rate, UINT8* p
 	else if (depth == 16) format = AUDIO_S16LSB;
 	else return SOUND_ERROR;
 
-	SAMPLETAG* s = SoundLoadBuffer(format, channels, rate, pbuffer, size);
+	SAMPLETAG* s = SoundLoadBuffer(format, channels, rate, pbuffer, size, false);
 	if (s == NULL) return SOUND_ERROR;
 
 	sprintf(s->pName, "SmackBuff %p - SampleSize %u", pbuffer, size);
@@ -239,55 +469,27 @@ UINT32 SoundPlayFromSmackBuff(UINT8 channels, UINT8 depth, UINT32 rate, UINT8* p
 	return SoundStartSample(s, channel, volume, pan, loop, end_callback, data);
 }
 
+/* A streamed file is converted bit by bit into a double-buffered stream on the
+ * stream thread, so neither the conversion nor the sound depend on the main
+ * loop. Without the stream thread, a streamed sample is decoded like a cached
+ * one, but it is not counted against the cache memory, so it does not push the
+ * cached samples out. Either way it is freed as soon as it stops playing. */
 UINT32 SoundPlayStreamedFile(const char* pFilename, UINT32 volume, UINT32 pan, UINT32 loop, void (*end_callback)(void*), void* data)
-try
 {
-#if 1
-	// TODO0003 implement streaming
-	return SoundPlay(pFilename, volume, pan, loop, end_callback, data);
-#else
-	if (!fSoundSystemInit) return SOUND_ERROR;
-
-	SOUNDTAG* const channel = SoundGetFreeChannel();
-	if (channel == NULL) return SOUND_ERROR;
-
-	AutoSGPFile hFile(GCM->openForReadingSmart(pFilename, true));
-
-	// MSS cannot determine which provider to play if you don't give it a real filename
-	// so if the file isn't in a library, play it normally
-	if (DB_EXTRACT_LIBRARY(hFile) == REAL_FILE_LIBRARY_ID)
-	{
-		return SoundStartStream(pFilename, channel, volume, pan, loop, end_callback, data);
-	}
-
-	//Get the real file handle of the file
-	FILE* hRealFileHandle = GetRealFileHandleFromFileManFileHandle(hFile);
-	if (hRealFileHandle == NULL)
-	{
-		SLOGE("SoundPlayStreamedFile(): Couldnt get a real file handle for '%s' in SoundPlayStreamedFile()", pFilename );
-		return SOUND_ERROR;
-	}
+	return SoundPlaySample(pFilename, true, volume, pan, loop, end_callback, data);
+}
 
-	//Convert the file handle into a 'name'
-	char pFileHandlefileName[128];
-	sprintf(pFileHandlefileName, "\\\\\\\\%d", hRealFileHandle);
 
-	//Start the sound stream
-	UINT32 uiRetVal = SoundStartStream(pFileHandlefileName, channel, volume, pan, loop, end_callback, data);
+void SoundPrefetch(const char* pFilename)
+{
+	if (!fSoundSystemInit) return;
+	if (SoundGetCached(pFilename) != NULL) return;
 
-	//if it succeeded, record the file handle
-	if (uiRetVal != SOUND_ERROR)
-	{
-		channel->hFile = hFile.Release();
-	}
+	SAMPLETAG* const s = SoundLoadSample(pFilename, false, true);
+	if (s == NULL) return;
 
-	return uiRetVal;
-#endif
-}
-catch (...)
-{
-	SLOGE("SoundPlayStreamedFile(): Failed to play '%s'", pFilename);
-	return SOUND_ERROR;
+	// Too large, it is streamed anyway
+	if (s->uiFlags & SAMPLE_STREAMED && !SoundSampleIsPlaying(s)) SoundFreeSample(s);
 }
 
 
@@ -297,9 +499,13 @@ UINT32 SoundPlayRandom(const char* pFilename, UINT32 time_min, UINT32 time_max,
 
 	if (!fSoundSystemInit) return SOUND_ERROR;
 
-	SAMPLETAG* const s = SoundLoadSample(pFilename);
+	SAMPLETAG* const s = SoundLoadSample(pFilename, false, false);
 	if (s == NULL) return SOUND_ERROR;
 
+	// A random sample plays again and again, so it is kept in the cache
+	DecreaseSoundMemoryUsedBySample(s);
+	s->uiFlags        &= ~SAMPLE_STREAMED;
+	IncreaseSoundMemoryUsedBySample(s);
 	s->uiFlags        |= SAMPLE_RANDOM | SAMPLE_LOCKED;
 	s->uiTimeMin       = time_min;
 	s->uiTimeMax       = time_max;
@@ -312,7 +518,7 @@ UINT32 SoundPlayRandom(const char* pFilename, UINT32 time_min, UINT32 time_max,
 	s->uiTimeNext =
 		GetClock() +
 		s->uiTimeMin +
-		Random(s->uiTimeMax - s->uiTimeMin);
+		StreamRandom(RANDOM_STREAM_SOUND, s->uiTimeMax - s->uiTimeMin);
 
 	return (UINT32)(s - pSampleList);
 }
@@ -346,26 +552,50 @@ BOOLEAN SoundStop(UINT32 uiSoundID)
 }
 
 
+static void SoundDetachDecode(SOUNDTAG* channel);
+static void SoundReleaseSample(SAMPLETAG* s);
+
+
+/* The samples may be freed right after this, so the sound callback is paused
+ * until no voice plays them any more. */
 void SoundStopAll(void)
 {
 	if (!fSoundSystemInit) return;
 
 	SDL_PauseAudio(1);
+	gSoundCommands.clear();
+	gSoundEnded.clear();
+	std::fill(std::begin(gSoundVoices), std::end(gSoundVoices), SoundVoice{});
 	FOR_EACH(SOUNDTAG, i, pSoundList)
 	{
-		if (SoundStopChannel(i))
-		{
-			assert(i->pSample->uiInstances != 0);
-			i->pSample->uiInstances -= 1;
-			i->pSample               = NULL;
-			i->uiSoundID             = SOUND_ERROR;
-			i->State                 = CHANNEL_FREE;
-		}
+		if (i->State == CHANNEL_FREE) continue;
+		SoundDetachDecode(i);
+		SAMPLETAG* const sample = i->pSample;
+		assert(sample->uiInstances != 0);
+		sample->uiInstances -= 1;
+		i->pSample           = NULL;
+		i->uiSoundID         = SOUND_ERROR;
+		i->State             = CHANNEL_FREE;
+		if (!SoundSampleIsPlaying(sample)) SoundReleaseSample(sample);
 	}
 	SDL_PauseAudio(0);
 }
 
 
+static BOOLEAN SoundSendCommand(SoundCommandType const type, SOUNDTAG const* const channel, UINT32 const value)
+{
+	SoundCommand c = SoundCommand();
+	c.type    = type;
+	c.channel = static_cast<UINT32>(channel - pSoundList);
+	c.id      = channel->uiSoundID;
+	c.value   = value;
+	if (gSoundCommands.push(c)) return TRUE;
+
+	SLOGW("Sound command queue is full, dropping command %d for channel %u", type, c.channel);
+	return FALSE;
+}
+
+
 BOOLEAN SoundSetVolume(UINT32 uiSoundID, UINT32 uiVolume)
 {
 	if (!fSoundSystemInit) return FALSE;
@@ -374,7 +604,7 @@ BOOLEAN SoundSetVolume(UINT32 uiSoundID, UINT32 uiVolume)
 	if (channel == NULL) return FALSE;
 
 	channel->uiFadeVolume = __min(uiVolume, MAXVOLUME);
-	return TRUE;
+	return SoundSendCommand(SOUND_CMD_VOLUME, channel, channel->uiFadeVolume);
 }
 
 
@@ -386,7 +616,7 @@ BOOLEAN SoundSetPan(UINT32 uiSoundID, UINT32 uiPan)
 	if (channel == NULL) return FALSE;
 
 	channel->Pan = __min(uiPan, 127);
-	return TRUE;
+	return SoundSendCommand(SOUND_CMD_PAN, channel, channel->Pan);
 }
 
 
@@ -434,8 +664,8 @@ static UINT32 SoundStartRandom(SAMPLETAG* s)
 	SOUNDTAG* const channel = SoundGetFreeChannel();
 	if (channel == NULL) return NO_SAMPLE;
 
-	const UINT32 volume = s->uiVolMin + Random(s->uiVolMax - s->uiVolMin);
-	const UINT32 pan    = s->uiPanMin + Random(s->uiPanMax - s->uiPanMin);
+	const UINT32 volume = s->uiVolMin + StreamRandom(RANDOM_STREAM_SOUND, s->uiVolMax - s->uiVolMin);
+	const UINT32 pan    = s->uiPanMin + StreamRandom(RANDOM_STREAM_SOUND, s->uiPanMax - s->uiPanMin);
 
 	const UINT32 uiSoundID = SoundStartSample(s, channel, volume, pan, 1, NULL, NULL);
 	if (uiSoundID == SOUND_ERROR) return NO_SAMPLE;
@@ -443,7 +673,7 @@ static UINT32 SoundStartRandom(SAMPLETAG* s)
 	s->uiTimeNext =
 		GetClock() +
 		s->uiTimeMin +
-		Random(s->uiTimeMax - s->uiTimeMin);
+		StreamRandom(RANDOM_STREAM_SOUND, s->uiTimeMax - s->uiTimeMin);
 	return uiSoundID;
 }
 
@@ -471,22 +701,46 @@ void SoundStopAllRandom(void)
 }
 
 
+static void SoundFinishDecode(SAMPLETAG* s);
+
+
 void SoundServiceStreams(void)
 {
 	if (!fSoundSystemInit) return;
 
-	for (UINT32 i = 0; i < lengthof(pSoundList); i++)
+	PROFILE_SCOPE(PROFILE_SOUND_STREAMS);
+
+	ProfilerCount(PROFILE_SOUND_UNDERRUNS, guiMixUnderruns.exchange(0));
+	ProfilerCount(PROFILE_SOUND_MIX_US,    guiMixMicroseconds.exchange(0));
+
+	UINT32 i;
+	while (gSoundEnded.pop(i))
 	{
 		SOUNDTAG* Sound = &pSoundList[i];
-		if (Sound->State == CHANNEL_DEAD)
+		SLOGD("ended channel %u file \"%s\" (refcount %u)", i, Sound->pSample->pName, Sound->pSample->uiInstances);
+		if (Sound->EOSCallback != NULL) Sound->EOSCallback(Sound->pCallbackData);
+		SoundDetachDecode(Sound);
+		SAMPLETAG* const sample = Sound->pSample;
+		assert(sample->uiInstances != 0);
+		sample->uiInstances--;
+		Sound->pSample   = NULL;
+		if (!SoundSampleIsPlaying(sample)) SoundReleaseSample(sample);
+		Sound->uiSoundID = SOUND_ERROR;
+		Sound->State     = CHANNEL_FREE;
+	}
+
+	UINT32 n_playing = 0;
+	FOR_EACH(SOUNDTAG const, c, pSoundList)
+	{
+		if (c->State != CHANNEL_FREE) ++n_playing;
+	}
+	ProfilerCount(PROFILE_SOUND_CHANNELS, n_playing);
+
+	if (guiSoundDecoding != 0)
+	{
+		FOR_EACH(SAMPLETAG, s, pSampleList)
 		{
-			SLOGD("DEAD channel %u file \"%s\" (refcount %u)", i, Sound->pSample->pName, Sound->pSample->uiInstances);
-			if (Sound->EOSCallback != NULL) Sound->EOSCallback(Sound->pCallbackData);
-			assert(Sound->pSample->uiInstances != 0);
-			Sound->pSample->uiInstances--;
-			Sound->pSample   = NULL;
-			Sound->uiSoundID = SOUND_ERROR;
-			Sound->State     = CHANNEL_FREE;
+			if (s->decode != NULL && SDL_AtomicGet(&s->decode->state) != DECODE_RUNNING) SoundFinishDecode(s);
 		}
 	}
 }
@@ -511,9 +765,6 @@ static void SoundInitCache(void)
 }
 
 
-static void SoundFreeSample(SAMPLETAG* s);
-
-
 // Frees up all samples in the cache.
 static void SoundEmptyCache(void)
 {
@@ -526,16 +777,26 @@ static void SoundEmptyCache(void)
 }
 
 
-static SAMPLETAG* SoundGetCached(const char* pFilename);
-static SAMPLETAG* SoundLoadDisk(const char* pFilename);
+static SAMPLETAG* SoundLoadDisk(const char* pFilename, bool streamed, bool async);
 
 
-static SAMPLETAG* SoundLoadSample(const char* pFilename)
+/* Gets a sample from the cache or loads it. If async is set, a sample which is
+ * not cached is decoded on the decoder thread and may still be decoding when it
+ * is returned. */
+static SAMPLETAG* SoundLoadSample(const char* pFilename, bool const streamed, bool const async)
 {
+	MEM_TAG_SCOPE(MEM_TAG_SOUND);
 	SAMPLETAG* const s = SoundGetCached(pFilename);
-	if (s != NULL) return s;
+	if (s != NULL)
+	{
+		++guiSoundCacheHits;
+		ProfilerCount(PROFILE_SOUND_CACHE_HITS, 1);
+		return s;
+	}
 
-	return SoundLoadDisk(pFilename);
+	++guiSoundCacheMisses;
+	ProfilerCount(PROFILE_SOUND_CACHE_MISSES, 1);
+	return SoundLoadDisk(pFilename, streamed, async);
 }
 
 
@@ -549,7 +810,8 @@ static SAMPLETAG* SoundGetCached(const char* pFilename)
 
 	FOR_EACH(SAMPLETAG, i, pSampleList)
 	{
-		if (strcasecmp(i->pName, pFilename) == 0) return i;
+		// A stream can only be played once
+		if (i->stream == NULL && strcasecmp(i->pName, pFilename) == 0) return i;
 	}
 
 	return NULL;
@@ -560,10 +822,10 @@ static UINT32 GetSampleSize(const SAMPLETAG* const s)
 	return 2 * (s->uiFlags & SAMPLE_STEREO ? 2 : 1);
 }
 
-/* Loads a sound from a buffer into the cache, allocating memory and a slot for storage.
+/* Converts a sound in a buffer into the format of the audio device.
  *
- * Returns: The sample if successful, NULL otherwise. */
-static SAMPLETAG* SoundLoadBuffer(SDL_AudioFormat format, UINT8 channels, int freq, UINT8* buffer, UINT32 size)
+ * Returns: The newly allocated sample data if successful, NULL otherwise. */
+static UINT8* SoundConvertBuffer(SDL_AudioFormat format, UINT8 channels, int freq, UINT8* buffer, UINT32 size, UINT32* out_size, UINT8* out_channels)
 {
 	SDL_AudioCVT cvt;
 	int ret;
@@ -624,30 +886,64 @@ static SAMPLETAG* SoundLoadBuffer(SDL_AudioFormat format, UINT8 channels, int fr
 	}
 	// cvt is invalid from this point forward
 
-	// if insufficient memory, start unloading old samples until either
-	// there's nothing left to unload, or we fit
-	while (samplesize + guiSoundMemoryUsed > guiSoundMemoryLimit)
+	*out_size     = samplesize;
+	*out_channels = samplechannels;
+	return sampledata;
+}
+
+
+/* If insufficient memory, start unloading old samples until either there's
+ * nothing left to unload, or we fit. The sample keep is not unloaded.
+ *
+ * Returns: TRUE if there is memory for size bytes, FALSE otherwise. */
+static BOOLEAN SoundReserveMemory(UINT32 const size, const SAMPLETAG* const keep)
+{
+	while (size + guiSoundMemoryUsed > guiSoundMemoryLimit)
 	{
-		if (!SoundCleanCache())
+		if (!SoundCleanCache(keep))
 		{
-			SLOGE("SoundLoadBuffer Error: not enough memory - Size: %u, Used: %u, Max: %u", samplesize, guiSoundMemoryUsed, guiSoundMemoryLimit);
-			MemFree(sampledata);
-			return NULL;
+			SLOGE("SoundLoadBuffer Error: not enough memory - Size: %u, Used: %u, Max: %u", size, guiSoundMemoryUsed, guiSoundMemoryLimit);
+			return FALSE;
 		}
 	}
+	return TRUE;
+}
 
-	// if all the sample slots are full, unloading one
+
+/* Returns an empty slot of the cache, unloading a sample if all of them are
+ * full.
+ *
+ * Returns: The slot if successful, NULL otherwise. */
+static SAMPLETAG* SoundTakeEmptySample()
+{
 	SAMPLETAG* s = SoundGetEmptySample();
 	if (s == NULL)
 	{
-		SoundCleanCache();
+		SoundCleanCache(NULL);
 		s = SoundGetEmptySample();
 	}
 
 	// if we still don't have a sample slot
+	if (s == NULL) SLOGE("SoundLoadBuffer Error: sound channels are full");
+	return s;
+}
+
+
+/* Puts converted sample data into a slot of the cache, which takes ownership
+ * of the data. A streamed sample does not count against the cache memory.
+ *
+ * Returns: The sample if successful, NULL otherwise. */
+static SAMPLETAG* SoundAddSample(UINT8* const sampledata, UINT32 const samplesize, UINT8 const samplechannels, bool const streamed)
+{
+	if (!streamed && !SoundReserveMemory(samplesize, NULL))
+	{
+		MemFree(sampledata);
+		return NULL;
+	}
+
+	SAMPLETAG* const s = SoundTakeEmptySample();
 	if (s == NULL)
 	{
-		SLOGE("SoundLoadBuffer Error: sound channels are full");
 		MemFree(sampledata);
 		return NULL;
 	}
@@ -658,6 +954,7 @@ static SAMPLETAG* SoundLoadBuffer(SDL_AudioFormat format, UINT8 channels, int fr
 		Assert(samplechannels == 2);
 		s->uiFlags |= SAMPLE_STEREO;
 	}
+	if (streamed) s->uiFlags |= SAMPLE_STREAMED;
 	s->n_samples = UINT32(samplesize / GetSampleSize(s));
 
 	IncreaseSoundMemoryUsedBySample(s);
@@ -665,143 +962,1119 @@ static SAMPLETAG* SoundLoadBuffer(SDL_AudioFormat format, UINT8 channels, int fr
 	return s;
 }
 
-/* Loads a sound file from disk into the cache, allocating memory and a slot
- * for storage.
+
+/* Loads a sound from a buffer into the cache, allocating memory and a slot for
+ * storage.
  *
- * Returns: The sample index if successful, NO_SAMPLE if the file wasn't found
- *          in the cache. */
-static SAMPLETAG* SoundLoadDisk(const char* pFilename)
+ * Returns: The sample if successful, NULL otherwise. */
+static SAMPLETAG* SoundLoadBuffer(SDL_AudioFormat format, UINT8 channels, int freq, UINT8* buffer, UINT32 size, bool const streamed)
 {
-	Assert(pFilename != NULL);
-
-	if(pFilename[0] == '\0') {
-		SLOGA("SoundLoadDisk Error: pFilename is an empty string.");
-		return NULL;
-	}
+	UINT32       samplesize;
+	UINT8        samplechannels;
+	UINT8* const sampledata = SoundConvertBuffer(format, channels, freq, buffer, size, &samplesize, &samplechannels);
+	if (sampledata == NULL) return NULL;
 
-	AutoSGPFile hFile;
+	return SoundAddSample(sampledata, samplesize, samplechannels, streamed);
+}
 
-	try
-	{
-		hFile = GCM->openGameResForReading(pFilename);
-	}
-	catch (const std::runtime_error& err)
-	{
-		SLOGA("SoundLoadDisk Error: %s", err.what());
-		return NULL;
-	}
 
-	SDL_RWops* rwOps = FileGetRWOps(hFile);
+/* Decodes a sound file in memory and converts it into the format of the audio
+ * device.
+ *
+ * Returns: The newly allocated sample data if successful, NULL otherwise. */
+static UINT8* SoundDecodeFile(const char* pFilename, BYTE const* data, UINT32 size, UINT32* out_size, UINT8* out_channels)
+{
+	SDL_RWops* const rwOps = SDL_RWFromConstMem(data, size);
 	SDL_AudioSpec wavSpec;
 	Uint32 wavLength;
 	Uint8 *wavBuffer;
 
-	if (SDL_LoadWAV_RW(rwOps, 0,  &wavSpec, &wavBuffer, &wavLength) == NULL) {
+	if (rwOps == NULL || SDL_LoadWAV_RW(rwOps, 1, &wavSpec, &wavBuffer, &wavLength) == NULL) {
 		SLOGE("SoundLoadDisk Error: Error loading file \"%s\"- %s", pFilename, SDL_GetError());
 		return NULL;
 	}
 
-	SAMPLETAG* s = SoundLoadBuffer(wavSpec.format, wavSpec.channels, wavSpec.freq, wavBuffer, wavLength);
-
+	UINT8* const sampledata = SoundConvertBuffer(wavSpec.format, wavSpec.channels, wavSpec.freq, wavBuffer, wavLength, out_size, out_channels);
 	SDL_FreeWAV(wavBuffer);
-	SDL_FreeRW(rwOps);
+	return sampledata;
+}
 
-	if (s == NULL)
+
+static SDL_mutex*                  g_decode_lock;
+static SDL_cond*                   g_decode_work; // signalled when a job is queued
+static SDL_cond*                   g_decode_done; // signalled when a job is finished
+static SDL_Thread*                 g_decode_thread;
+static std::deque<SoundDecodeJob*> g_decode_queue;
+static bool                        g_decode_quit;
+
+
+/* Converts a decoded file into the format of the audio device. The frames are
+ * handed to the voices after every SOUND_DECODE_CHUNK frames of the file.
+ *
+ * Returns: true if successful, false on error or if the job was cancelled. */
+static bool SoundConvertJob(SoundDecodeJob* const job, SDL_AudioSpec const& spec, Uint8 const* const buf, Uint32 const len)
+{
+#if SDL_VERSION_ATLEAST(2, 0, 7)
+	UINT8  const channels  = __min(spec.channels, gTargetAudioSpec.channels);
+	UINT32 const in_frame  = SDL_AUDIO_BITSIZE(spec.format) / 8 * spec.channels;
+	UINT32 const out_frame = SDL_AUDIO_BITSIZE(gTargetAudioSpec.format) / 8 * channels;
+	UINT32 const in_frames = len / in_frame;
+	if (in_frames == 0)
 	{
-		SLOGE("SoundLoadDisk: Error converting sound file \"%s\"", pFilename);
-		return NULL;
+		SLOGE("SoundLoadDisk Error: \"%s\" is empty", job->name.c_str());
+		return false;
 	}
 
-	strcpy(s->pName, pFilename);
+	SDL_AudioStream* const stream = SDL_NewAudioStream(spec.format, spec.channels, spec.freq, gTargetAudioSpec.format, channels, gTargetAudioSpec.freq);
+	if (stream == NULL)
+	{
+		SLOGE("SoundLoadBuffer Error: unsupported audio conversion - %s", SDL_GetError());
+		return false;
+	}
 
-	return s;
-}
+	// Resampling may give a few frames more than the exact ratio
+	UINT32 const capacity = static_cast<UINT32>(uint64_t(in_frames) * gTargetAudioSpec.freq / spec.freq + 64);
+	job->data   = MALLOCN(UINT8, capacity * out_frame);
+	job->stereo = channels == 2;
 
+	bool   ok   = true;
+	UINT32 done = 0;
+	for (UINT32 pos = 0;;)
+	{
+		if (SDL_AtomicGet(&job->cancel))
+		{
+			ok = false;
+			break;
+		}
 
-// Returns TRUE/FALSE that a sample is currently in use for playing a sound.
-static BOOLEAN SoundSampleIsPlaying(const SAMPLETAG* s)
-{
-	return s->uiInstances > 0;
+		UINT32 const n = MIN(in_frames - pos, SOUND_DECODE_CHUNK);
+		int const put = n != 0 ?
+			SDL_AudioStreamPut(stream, buf + pos * in_frame, n * in_frame) :
+			SDL_AudioStreamFlush(stream);
+		int const got = put == 0 ?
+			SDL_AudioStreamGet(stream, job->data + done * out_frame, (capacity - done) * out_frame) :
+			-1;
+		if (got < 0)
+		{
+			SLOGE("SoundLoadBuffer Error: error converting audio - %s", SDL_GetError());
+			ok = false;
+			break;
+		}
+
+		done += got / out_frame;
+		SDL_AtomicSet(&job->n_ready, done);
+		if (n == 0) break;
+		pos += n;
+	}
+	SDL_FreeAudioStream(stream);
+	job->n_samples = done;
+	return ok;
+#else
+	// No audio streams, so the sample is converted in one go
+	UINT32 size;
+	UINT8  out_channels;
+	job->data = SoundConvertBuffer(spec.format, spec.channels, spec.freq, const_cast<Uint8*>(buf), len, &size, &out_channels);
+	if (job->data == NULL) return false;
+	job->stereo    = out_channels == 2;
+	job->n_samples = size / (2 * out_channels);
+	SDL_AtomicSet(&job->n_ready, job->n_samples);
+	return true;
+#endif
 }
 
 
-/* Removes the least-used sound from the cache to make room.
- *
- * Returns: TRUE if a sample was freed, FALSE if none */
-static BOOLEAN SoundCleanCache(void)
+static void SoundRunDecodeJob(SoundDecodeJob* const job)
 {
-	SAMPLETAG* candidate = NULL;
-
-	FOR_EACH(SAMPLETAG, i, pSampleList)
+	bool ok = false;
+	SDL_RWops* const rwOps = SDL_RWFromConstMem(job->file.data(), static_cast<int>(job->file.size()));
+	SDL_AudioSpec    wavSpec;
+	Uint32           wavLength;
+	Uint8*           wavBuffer;
+	if (rwOps == NULL || SDL_LoadWAV_RW(rwOps, 1, &wavSpec, &wavBuffer, &wavLength) == NULL)
 	{
-		if (i->uiFlags & SAMPLE_ALLOCATED &&
-				!(i->uiFlags & SAMPLE_LOCKED) &&
-				(candidate == NULL || candidate->uiCacheHits > i->uiCacheHits))
+		SLOGE("SoundLoadDisk Error: Error loading file \"%s\"- %s", job->name.c_str(), SDL_GetError());
+	}
+	else
+	{
+		try
 		{
-			if (!SoundSampleIsPlaying(i)) candidate = i;
+			ok = SoundConvertJob(job, wavSpec, wavBuffer, wavLength);
 		}
+		catch (const std::bad_alloc&)
+		{
+			SLOGE("SoundLoadDisk Error: out of memory converting \"%s\"", job->name.c_str());
+		}
+		SDL_FreeWAV(wavBuffer);
 	}
+	SDL_AtomicSet(&job->state, ok ? DECODE_DONE : DECODE_FAILED);
+}
 
-	if (candidate != NULL)
+
+static int SoundDecoderMain(void*)
+{
+	MEM_TAG_SCOPE(MEM_TAG_SOUND);
+	SDL_LockMutex(g_decode_lock);
+	for (;;)
 	{
-		SLOGD("freeing sample %u \"%s\" with %u hits", candidate - pSampleList, candidate->pName, candidate->uiCacheHits);
-		SoundFreeSample(candidate);
-		return TRUE;
-	}
+		while (!g_decode_quit && g_decode_queue.empty()) SDL_CondWait(g_decode_work, g_decode_lock);
+		if (g_decode_quit) break;
+		SoundDecodeJob* const job = g_decode_queue.front();
+		g_decode_queue.pop_front();
+		SDL_UnlockMutex(g_decode_lock);
 
-	return FALSE;
+		SoundRunDecodeJob(job);
+
+		SDL_LockMutex(g_decode_lock);
+		SDL_CondBroadcast(g_decode_done);
+	}
+	SDL_UnlockMutex(g_decode_lock);
+	return 0;
 }
 
 
-/* Returns an available sample.
- *
- * Returns: A free sample or NULL if none are left. */
-static SAMPLETAG* SoundGetEmptySample(void)
+/* Without the decoder thread, all samples are decoded when they are loaded. */
+static void SoundStartDecoder()
 {
-	FOR_EACH(SAMPLETAG, i, pSampleList)
+	g_decode_lock = SDL_CreateMutex();
+	g_decode_work = SDL_CreateCond();
+	g_decode_done = SDL_CreateCond();
+	if (g_decode_lock && g_decode_work && g_decode_done)
 	{
-		if (!(i->uiFlags & SAMPLE_ALLOCATED)) return i;
+		g_decode_thread = SDL_CreateThread(SoundDecoderMain, "sound decoder", 0);
+		if (g_decode_thread) return;
 	}
-
-	return NULL;
+	SLOGW("Failed to start the sound decoder thread: %s", SDL_GetError());
+	SoundStopDecoder();
 }
 
 
-// Frees up a sample referred to by its index slot number.
-static void SoundFreeSample(SAMPLETAG* s)
+// All samples must have been freed, so there are no jobs left
+static void SoundStopDecoder()
 {
-	if (!(s->uiFlags & SAMPLE_ALLOCATED)) return;
+	if (g_decode_thread)
+	{
+		SDL_LockMutex(g_decode_lock);
+		g_decode_quit = true;
+		SDL_CondSignal(g_decode_work);
+		SDL_UnlockMutex(g_decode_lock);
 
-	assert(s->uiInstances == 0);
+		SDL_WaitThread(g_decode_thread, 0);
+		g_decode_thread = 0;
+	}
+	assert(g_decode_queue.empty());
 
-	DecreaseSoundMemoryUsedBySample(s);
-	MemFree(s->pData);
-	*s = SAMPLETAG{};
+	if (g_decode_done) { SDL_DestroyCond(g_decode_done);  g_decode_done = 0; }
+	if (g_decode_work) { SDL_DestroyCond(g_decode_work);  g_decode_work = 0; }
+	if (g_decode_lock) { SDL_DestroyMutex(g_decode_lock); g_decode_lock = 0; }
+	g_decode_quit = false;
 }
 
 
-/* Searches out a sound instance referred to by its ID number.
+/* Puts a sound file into an empty slot of the cache and queues it for the
+ * decoder thread. Until the job is finished, the slot has no data and its
+ * memory is not counted.
  *
- * Returns: If the instance was found, the pointer to the channel.  NULL
- *          otherwise. */
-static SOUNDTAG* SoundGetChannelByID(UINT32 uiSoundID)
+ * Returns: The sample if successful, NULL otherwise. */
+static SAMPLETAG* SoundQueueDecode(BYTE const* const data, UINT32 const size, bool const streamed)
 {
-	FOR_EACH(SOUNDTAG, i, pSoundList)
-	{
-		if (i->uiSoundID == uiSoundID) return i;
-	}
+	SAMPLETAG* const s = SoundTakeEmptySample();
+	if (s == NULL) return NULL;
 
-	return NULL;
+	SoundDecodeJob* const job = new SoundDecodeJob();
+	job->sample = s;
+	job->file.assign(data, data + size);
+
+	s->uiFlags |= SAMPLE_ALLOCATED;
+	if (streamed) s->uiFlags |= SAMPLE_STREAMED;
+	s->decode = job;
+	++guiSoundDecoding;
+
+	SDL_LockMutex(g_decode_lock);
+	g_decode_queue.push_back(job);
+	SDL_CondSignal(g_decode_work);
+	SDL_UnlockMutex(g_decode_lock);
+	return s;
 }
 
 
-static void SoundCallback(void* userdata, Uint8* stream, int len)
+static void SoundDeleteDecodeJob(SoundDecodeJob* const job)
 {
-	if (len < 0)
-	{
-		SLOGA("SoundCallback: unexpected negative len %d", len);
-		return;
-	}
+	if (!job->data_taken && job->data != NULL) MemFree(job->data);
+	delete job;
+}
+
+
+// The job stays around until the last voice which plays from it has ended
+static void SoundDetachDecode(SOUNDTAG* const channel)
+{
+	SoundDecodeJob* const job = channel->decode;
+	if (job == NULL) return;
+	channel->decode = NULL;
+	assert(job->n_voices != 0);
+	if (--job->n_voices == 0 && job->sample == NULL) SoundDeleteDecodeJob(job);
+}
+
+
+static void SoundEndDecode(SAMPLETAG* const s)
+{
+	SoundDecodeJob* const job = s->decode;
+	job->sample = NULL;
+	s->decode   = NULL;
+	--guiSoundDecoding;
+	if (job->n_voices == 0) SoundDeleteDecodeJob(job);
+}
+
+
+/* Hands the data of a finished job to its sample. A sample which failed to
+ * decode is freed as soon as it does not play any more. */
+static void SoundFinishDecode(SAMPLETAG* const s)
+{
+	SoundDecodeJob* const job = s->decode;
+	if (SDL_AtomicGet(&job->state) == DECODE_DONE)
+	{
+		bool   const streamed   = (s->uiFlags & SAMPLE_STREAMED) != 0;
+		UINT32 const samplesize = job->n_samples * (job->stereo ? 4 : 2);
+		UINT32 const filesize   = static_cast<UINT32>(job->file.size());
+
+		// It may play already, so it is kept even if there is no memory for it
+		if (!streamed) SoundReserveMemory(samplesize, s);
+		s->pData     = job->data;
+		s->n_samples = job->n_samples;
+		if (job->stereo) s->uiFlags |= SAMPLE_STEREO;
+		job->data_taken = true;
+		IncreaseSoundMemoryUsedBySample(s);
+
+		if (!streamed && samplesize / SOUND_COMPRESS_RATIO >= filesize && SoundReserveMemory(filesize, s))
+		{
+			DecreaseSoundMemoryUsedBySample(s);
+			s->pCompressed      = MALLOCN(BYTE, filesize);
+			s->uiCompressedSize = filesize;
+			memcpy(s->pCompressed, job->file.data(), filesize);
+			IncreaseSoundMemoryUsedBySample(s);
+		}
+		SoundEndDecode(s);
+	}
+	else
+	{
+		s->uiFlags |= SAMPLE_STREAMED;
+		SoundEndDecode(s);
+		if (!SoundSampleIsPlaying(s)) SoundFreeSample(s);
+	}
+}
+
+
+// Stops the job of a sample which does not play, waiting for it if it runs
+static void SoundCancelDecode(SAMPLETAG* const s)
+{
+	SoundDecodeJob* const job = s->decode;
+	SDL_LockMutex(g_decode_lock);
+	std::deque<SoundDecodeJob*>::iterator const i = std::find(g_decode_queue.begin(), g_decode_queue.end(), job);
+	if (i != g_decode_queue.end())
+	{
+		g_decode_queue.erase(i);
+	}
+	else
+	{
+		SDL_AtomicSet(&job->cancel, 1);
+		while (SDL_AtomicGet(&job->state) == DECODE_RUNNING) SDL_CondWait(g_decode_done, g_decode_lock);
+	}
+	SDL_UnlockMutex(g_decode_lock);
+	SoundEndDecode(s);
+}
+
+
+static SDL_mutex*                g_stream_lock;
+static SDL_cond*                 g_stream_work; // signalled when a stream is started
+static SDL_Thread*               g_stream_thread;
+static std::vector<SoundStream*> g_streams;     // started and not yet deleted
+static bool                      g_stream_quit;
+
+
+// Puts a streamed file into an empty slot of the cache, the stream is not started yet
+static SAMPLETAG* SoundNewStream(BYTE const* const data, UINT32 const size)
+{
+	SAMPLETAG* const s = SoundTakeEmptySample();
+	if (s == NULL) return NULL;
+
+	SoundStream* const st = new SoundStream();
+	st->file.assign(data, data + size);
+
+	s->uiFlags |= SAMPLE_ALLOCATED | SAMPLE_STREAMED;
+	s->stream   = st;
+	return s;
+}
+
+
+static void SoundStartStream(SoundStream* const st, UINT32 const loops)
+{
+	assert(!st->started);
+	st->loops   = loops;
+	st->started = true;
+
+	SDL_LockMutex(g_stream_lock);
+	g_streams.push_back(st);
+	SDL_CondSignal(g_stream_work);
+	SDL_UnlockMutex(g_stream_lock);
+}
+
+
+static void SoundDeleteStream(SoundStream* st);
+
+
+// The stream thread deletes a started stream, so it may still be refilling it
+static void SoundReleaseStream(SoundStream* const st)
+{
+	if (!st->started)
+	{
+		SoundDeleteStream(st);
+		return;
+	}
+	SDL_LockMutex(g_stream_lock);
+	st->released = true;
+	SDL_UnlockMutex(g_stream_lock);
+}
+
+
+#ifdef SOUND_STREAMS
+
+// The decoded file a stream is converted from
+struct SoundStreamSource
+{
+	Uint8*           wav;
+	UINT32           n_frames;
+	UINT32           frame_size;
+	UINT32           pos;     // next frame put into the conversion
+	SDL_AudioStream* cvt;
+	bool             flushed; // the end of the file was put into the conversion
+};
+
+
+static void SoundDeleteStream(SoundStream* const st)
+{
+	if (SoundStreamSource* const src = st->source)
+	{
+		if (src->cvt != NULL) SDL_FreeAudioStream(src->cvt);
+		if (src->wav != NULL) SDL_FreeWAV(src->wav);
+		delete src;
+	}
+	if (st->ring != NULL) MemFree(st->ring);
+	delete st;
+}
+
+
+static bool SoundOpenStream(SoundStream* const st)
+{
+	SDL_RWops* const rwOps = SDL_RWFromConstMem(st->file.data(), static_cast<int>(st->file.size()));
+	SDL_AudioSpec    wavSpec;
+	Uint32           wavLength;
+	Uint8*           wavBuffer;
+	if (rwOps == NULL || SDL_LoadWAV_RW(rwOps, 1, &wavSpec, &wavBuffer, &wavLength) == NULL)
+	{
+		SLOGE("SoundLoadDisk Error: Error loading file \"%s\"- %s", st->name.c_str(), SDL_GetError());
+		return false;
+	}
+	std::vector<BYTE>().swap(st->file);
+
+	SoundStreamSource* const src = new SoundStreamSource();
+	st->source      = src;
+	src->wav        = wavBuffer;
+	src->frame_size = SDL_AUDIO_BITSIZE(wavSpec.format) / 8 * wavSpec.channels;
+	src->n_frames   = wavLength / src->frame_size;
+
+	UINT8 const channels = __min(wavSpec.channels, gTargetAudioSpec.channels);
+	src->cvt = SDL_NewAudioStream(wavSpec.format, wavSpec.channels, wavSpec.freq, gTargetAudioSpec.format, channels, gTargetAudioSpec.freq);
+	if (src->cvt == NULL)
+	{
+		SLOGE("SoundLoadBuffer Error: unsupported audio conversion - %s", SDL_GetError());
+		return false;
+	}
+
+	st->ring   = MALLOCN(UINT8, 2 * SOUND_STREAM_FRAMES * 2 * channels);
+	st->stereo = channels == 2;
+	return true;
+}
+
+
+/* Converts the next half of the ring. The file is put into the conversion
+ * again for every loop, so there is no seam between the loops.
+ *
+ * Returns: false on error. */
+static bool SoundFillStream(SoundStream* const st)
+{
+	SoundStreamSource* const src       = st->source;
+	UINT32             const out_frame = st->stereo ? 4 : 2;
+	UINT32             const half      = SDL_AtomicGet(&st->filled) % 2;
+	UINT8*             const dst       = st->ring + half * SOUND_STREAM_FRAMES * out_frame;
+	UINT32                   got       = 0;
+	for (;;)
+	{
+		int const n = SDL_AudioStreamGet(src->cvt, dst + got * out_frame, (SOUND_STREAM_FRAMES - got) * out_frame);
+		if (n < 0) break;
+		got += n / out_frame;
+		if (got == SOUND_STREAM_FRAMES || src->flushed) break;
+
+		if (src->pos == src->n_frames && st->loops != 1)
+		{
+			if (st->loops != 0) --st->loops;
+			src->pos = 0;
+		}
+		UINT32 const chunk = MIN(src->n_frames - src->pos, SOUND_DECODE_CHUNK);
+		int const put = chunk != 0 ?
+			SDL_AudioStreamPut(src->cvt, src->wav + src->pos * src->frame_size, chunk * src->frame_size) :
+			SDL_AudioStreamFlush(src->cvt);
+		if (put != 0) break;
+		src->pos     += chunk;
+		src->flushed  = chunk == 0;
+	}
+
+	if (got != 0)
+	{
+		st->frames[half] = got;
+		SDL_AtomicIncRef(&st->filled);
+	}
+	if (got != SOUND_STREAM_FRAMES && !src->flushed)
+	{
+		SLOGE("SoundLoadBuffer Error: error converting audio - %s", SDL_GetError());
+		return false;
+	}
+	if (got != SOUND_STREAM_FRAMES) SDL_AtomicSet(&st->state, DECODE_DONE);
+	return true;
+}
+
+
+// Fills the halves of the ring which were played
+static void SoundServiceStream(SoundStream* const st)
+{
+	try
+	{
+		if (st->source == NULL && !SoundOpenStream(st)) goto failed;
+		while (SDL_AtomicGet(&st->state) == DECODE_RUNNING &&
+				SDL_AtomicGet(&st->filled) - SDL_AtomicGet(&st->played) < 2)
+		{
+			if (!SoundFillStream(st)) goto failed;
+		}
+		return;
+	}
+	catch (const std::bad_alloc&)
+	{
+		SLOGE("SoundLoadDisk Error: out of memory streaming \"%s\"", st->name.c_str());
+	}
+failed:
+	SDL_AtomicSet(&st->state, DECODE_FAILED);
+}
+
+
+static int SoundStreamerMain(void*)
+{
+	MEM_TAG_SCOPE(MEM_TAG_SOUND);
+	std::vector<SoundStream*> streams;
+	SDL_LockMutex(g_stream_lock);
+	while (!g_stream_quit)
+	{
+		for (std::vector<SoundStream*>::iterator i = g_streams.begin(); i != g_streams.end();)
+		{
+			if ((*i)->released)
+			{
+				SoundDeleteStream(*i);
+				i = g_streams.erase(i);
+			}
+			else
+			{
+				++i;
+			}
+		}
+		streams = g_streams;
+		SDL_UnlockMutex(g_stream_lock);
+
+		for (SoundStream* const st : streams)
+		{
+			if (SDL_AtomicGet(&st->state) == DECODE_RUNNING) SoundServiceStream(st);
+		}
+
+		SDL_LockMutex(g_stream_lock);
+		if (!g_stream_quit) SDL_CondWaitTimeout(g_stream_work, g_stream_lock, SOUND_STREAM_POLL);
+	}
+	SDL_UnlockMutex(g_stream_lock);
+	return 0;
+}
+
+
+/* Without the stream thread, streamed files are decoded like the other
+ * samples. */
+static void SoundStartStreamer()
+{
+	g_stream_lock = SDL_CreateMutex();
+	g_stream_work = SDL_CreateCond();
+	if (g_stream_lock && g_stream_work)
+	{
+		g_stream_thread = SDL_CreateThread(SoundStreamerMain, "sound streamer", 0);
+		if (g_stream_thread) return;
+	}
+	SLOGW("Failed to start the sound stream thread: %s", SDL_GetError());
+	SoundStopStreamer();
+}
+
+
+static void SoundStopStreamer()
+{
+	if (g_stream_thread)
+	{
+		SDL_LockMutex(g_stream_lock);
+		g_stream_quit = true;
+		SDL_CondSignal(g_stream_work);
+		SDL_UnlockMutex(g_stream_lock);
+
+		SDL_WaitThread(g_stream_thread, 0);
+		g_stream_thread = 0;
+	}
+
+	for (SoundStream* const st : g_streams) SoundDeleteStream(st);
+	g_streams.clear();
+
+	if (g_stream_work) { SDL_DestroyCond(g_stream_work);  g_stream_work = 0; }
+	if (g_stream_lock) { SDL_DestroyMutex(g_stream_lock); g_stream_lock = 0; }
+	g_stream_quit = false;
+}
+
+#else
+
+static void SoundDeleteStream(SoundStream* const st) { delete st; }
+static void SoundStartStreamer() {}
+static void SoundStopStreamer()  {}
+
+#endif
+
+
+/* Loads a sound file from disk into the cache, allocating memory and a slot
+ * for storage. Files larger than guiSoundCacheThreshold are always streamed.
+ * If async is set, the file is decoded on the decoder thread instead, see
+ * SoundFinishDecode(), and a streamed one is played from a stream.
+ * If the decoded sample is much larger than the file, e.g. for ADPCM speech,
+ * the file is kept as well, so the decoded sample can be dropped when it stops
+ * playing and decoded again on the next play.
+ *
+ * Returns: The sample index if successful, NO_SAMPLE if the file wasn't found
+ *          in the cache. */
+static SAMPLETAG* SoundLoadDisk(const char* pFilename, bool streamed, bool const async)
+{
+	Assert(pFilename != NULL);
+
+	if(pFilename[0] == '\0') {
+		SLOGA("SoundLoadDisk Error: pFilename is an empty string.");
+		return NULL;
+	}
+
+	SAMPLETAG* s;
+	try
+	{
+		AutoSGPFile    hFile(GCM->openGameResForReading(pFilename));
+		FileView const view(hFile);
+
+		UINT32 const filesize = (UINT32)view.size();
+		if (filesize > guiSoundCacheThreshold) streamed = true;
+
+		if (streamed && async && g_stream_thread != NULL)
+		{
+			s = SoundNewStream(view.data(), filesize);
+			if (s == NULL) return NULL;
+			++guiSoundStreamed;
+			strcpy(s->pName, pFilename);
+			s->stream->name = pFilename;
+			return s;
+		}
+
+		if (async && g_decode_thread != NULL)
+		{
+			s = SoundQueueDecode(view.data(), filesize, streamed);
+			if (s == NULL) return NULL;
+			if (streamed) ++guiSoundStreamed;
+			strcpy(s->pName, pFilename);
+			s->decode->name = pFilename;
+			return s;
+		}
+
+		UINT32       samplesize;
+		UINT8        samplechannels;
+		UINT8* const sampledata = SoundDecodeFile(pFilename, view.data(), filesize, &samplesize, &samplechannels);
+		if (sampledata == NULL) return NULL;
+
+		s = SoundAddSample(sampledata, samplesize, samplechannels, streamed);
+		if (s == NULL)
+		{
+			SLOGE("SoundLoadDisk: Error converting sound file \"%s\"", pFilename);
+			return NULL;
+		}
+
+		if (streamed)
+		{
+			++guiSoundStreamed;
+		}
+		else if (samplesize / SOUND_COMPRESS_RATIO >= filesize && SoundReserveMemory(filesize, s))
+		{
+			DecreaseSoundMemoryUsedBySample(s);
+			s->pCompressed      = MALLOCN(BYTE, filesize);
+			s->uiCompressedSize = filesize;
+			memcpy(s->pCompressed, view.data(), filesize);
+			IncreaseSoundMemoryUsedBySample(s);
+		}
+	}
+	catch (const std::runtime_error& err)
+	{
+		SLOGA("SoundLoadDisk Error: %s", err.what());
+		return NULL;
+	}
+
+	strcpy(s->pName, pFilename);
+
+	return s;
+}
+
+
+/* Makes sure the decoded data of a sample is there, decoding the kept file if
+ * it was dropped. A sample which is still being decoded plays from its job.
+ *
+ * Returns: TRUE if the sample can be played. */
+static BOOLEAN SoundDecodeSample(SAMPLETAG* const s)
+{
+	if (s->pData != NULL || s->decode != NULL || s->stream != NULL) return TRUE;
+	if (s->pCompressed == NULL) return FALSE;
+
+	UINT32       samplesize;
+	UINT8        samplechannels;
+	UINT8* const sampledata = SoundDecodeFile(s->pName, s->pCompressed, s->uiCompressedSize, &samplesize, &samplechannels);
+	if (sampledata == NULL) return FALSE;
+
+	if (!SoundReserveMemory(samplesize, s))
+	{
+		MemFree(sampledata);
+		return FALSE;
+	}
+
+	DecreaseSoundMemoryUsedBySample(s);
+	s->pData = sampledata;
+	IncreaseSoundMemoryUsedBySample(s);
+	++guiSoundDecodes;
+	return TRUE;
+}
+
+
+/* Called when a sample stops playing. A streamed sample is freed and the
+ * decoded data of a compressed one dropped, unless it is a random sample,
+ * which is played again soon. */
+static void SoundReleaseSample(SAMPLETAG* const s)
+{
+	if (s->uiFlags & SAMPLE_STREAMED)
+	{
+		SoundFreeSample(s);
+	}
+	else if (s->pCompressed != NULL && s->pData != NULL && !(s->uiFlags & SAMPLE_RANDOM))
+	{
+		DecreaseSoundMemoryUsedBySample(s);
+		MemFree(s->pData);
+		s->pData = NULL;
+		IncreaseSoundMemoryUsedBySample(s);
+	}
+}
+
+
+// Returns TRUE/FALSE that a sample is currently in use for playing a sound.
+static BOOLEAN SoundSampleIsPlaying(const SAMPLETAG* s)
+{
+	return s->uiInstances > 0;
+}
+
+
+/* Removes the least recently used sound from the cache to make room. The
+ * sample keep is not removed.
+ *
+ * Returns: TRUE if a sample was freed, FALSE if none */
+static BOOLEAN SoundCleanCache(const SAMPLETAG* const keep)
+{
+	SAMPLETAG* candidate = NULL;
+
+	FOR_EACH(SAMPLETAG, i, pSampleList)
+	{
+		if (i->uiFlags & SAMPLE_ALLOCATED &&
+				!(i->uiFlags & SAMPLE_LOCKED) &&
+				i->decode == NULL &&
+				i != keep &&
+				(candidate == NULL || candidate->uiLastUse > i->uiLastUse))
+		{
+			if (!SoundSampleIsPlaying(i)) candidate = i;
+		}
+	}
+
+	if (candidate != NULL)
+	{
+		SLOGD("freeing sample %u \"%s\" with %u hits", candidate - pSampleList, candidate->pName, candidate->uiCacheHits);
+		SoundFreeSample(candidate);
+		++guiSoundCacheEvictions;
+		return TRUE;
+	}
+
+	return FALSE;
+}
+
+
+/* Returns an available sample.
+ *
+ * Returns: A free sample or NULL if none are left. */
+static SAMPLETAG* SoundGetEmptySample(void)
+{
+	FOR_EACH(SAMPLETAG, i, pSampleList)
+	{
+		if (!(i->uiFlags & SAMPLE_ALLOCATED)) return i;
+	}
+
+	return NULL;
+}
+
+
+// Frees up a sample referred to by its index slot number.
+static void SoundFreeSample(SAMPLETAG* s)
+{
+	if (!(s->uiFlags & SAMPLE_ALLOCATED)) return;
+
+	assert(s->uiInstances == 0);
+
+	if (s->decode != NULL) SoundCancelDecode(s);
+	if (s->stream != NULL) SoundReleaseStream(s->stream);
+	DecreaseSoundMemoryUsedBySample(s);
+	if (s->pData       != NULL) MemFree(s->pData);
+	if (s->pCompressed != NULL) MemFree(s->pCompressed);
+	*s = SAMPLETAG{};
+}
+
+
+/* Searches out a sound instance referred to by its ID number.
+ *
+ * Returns: If the instance was found, the pointer to the channel.  NULL
+ *          otherwise. */
+static SOUNDTAG* SoundGetChannelByID(UINT32 uiSoundID)
+{
+	FOR_EACH(SOUNDTAG, i, pSoundList)
+	{
+		if (i->uiSoundID == uiSoundID) return i;
+	}
+
+	return NULL;
+}
+
+
+/* The vector kernels are compiled in if the target supports them, but only
+ * used if the CPU we are running on does as well. */
+static bool DetectSIMDMixer()
+{
+#if defined MIX_SSE2
+	return SDL_HasSSE2() == SDL_TRUE;
+#elif defined MIX_NEON
+	return SDL_HasNEON() == SDL_TRUE;
+#else
+	return false;
+#endif
+}
+
+static bool const g_simd_mixer = DetectSIMDMixer();
+
+
+static inline void RampVolume(MixVolume& v)
+{
+	if (v.current < v.target)
+	{
+		v.current = std::min(v.current + MIX_RAMP_STEP, v.target);
+	}
+	else if (v.current > v.target)
+	{
+		v.current = std::max(v.current - MIX_RAMP_STEP, v.target);
+	}
+}
+
+
+/* Add n frames of 16 bit mono or interleaved stereo samples, scaled by the
+ * volumes, to the interleaved stereo mix buffer. This is the reference for the
+ * vector kernels, which do whole ramp blocks. */
+static void MixScalar(INT32* const mix, INT16 const* const src, UINT32 const n, bool const stereo, MixVolume& vol_l, MixVolume& vol_r)
+{
+	for (UINT32 i = 0; i != n; ++i)
+	{
+		INT const l = stereo ? src[2 * i + 0] : src[i];
+		INT const r = stereo ? src[2 * i + 1] : src[i];
+		mix[2 * i + 0] += l * vol_l.current >> 7;
+		mix[2 * i + 1] += r * vol_r.current >> 7;
+		if ((i + 1) % MIX_RAMP_FRAMES == 0)
+		{
+			RampVolume(vol_l);
+			RampVolume(vol_r);
+		}
+	}
+}
+
+
+static void ClipScalar(INT16* const dst, INT32 const* const mix, UINT32 const n)
+{
+	for (UINT32 i = 0; i != n; ++i)
+	{
+		if (mix[i] >= INT16_MAX)     dst[i] = INT16_MAX;
+		else if(mix[i] <= INT16_MIN) dst[i] = INT16_MIN;
+		else                         dst[i] = (INT16)mix[i];
+	}
+}
+
+
+#if defined MIX_SSE2
+// mix[0..7] += (s * vol) >> 7 for eight 16 bit values
+static inline void MixAdd8(INT32* const mix, __m128i const s, __m128i const vol)
+{
+	__m128i const lo = _mm_mullo_epi16(s, vol);
+	__m128i const hi = _mm_mulhi_epi16(s, vol);
+	__m128i* const m = reinterpret_cast<__m128i*>(mix);
+	_mm_storeu_si128(m + 0, _mm_add_epi32(_mm_loadu_si128(m + 0), _mm_srai_epi32(_mm_unpacklo_epi16(lo, hi), 7)));
+	_mm_storeu_si128(m + 1, _mm_add_epi32(_mm_loadu_si128(m + 1), _mm_srai_epi32(_mm_unpackhi_epi16(lo, hi), 7)));
+}
+
+
+// Whole blocks of MIX_RAMP_FRAMES (8) frames, returns the frames done
+static UINT32 MixSIMD(INT32* mix, INT16 const* src, UINT32 const n, bool const stereo, MixVolume& vol_l, MixVolume& vol_r)
+{
+	UINT32 const blocks = n / 8;
+	for (UINT32 b = 0; b != blocks; ++b, mix += 16)
+	{
+		__m128i const vol = _mm_set_epi16(vol_r.current, vol_l.current, vol_r.current, vol_l.current, vol_r.current, vol_l.current, vol_r.current, vol_l.current);
+		if (stereo)
+		{
+			MixAdd8(mix + 0, _mm_loadu_si128(reinterpret_cast<__m128i const*>(src + 0)), vol);
+			MixAdd8(mix + 8, _mm_loadu_si128(reinterpret_cast<__m128i const*>(src + 8)), vol);
+			src += 16;
+		}
+		else
+		{
+			__m128i const s = _mm_loadu_si128(reinterpret_cast<__m128i const*>(src));
+			MixAdd8(mix + 0, _mm_unpacklo_epi16(s, s), vol);
+			MixAdd8(mix + 8, _mm_unpackhi_epi16(s, s), vol);
+			src += 8;
+		}
+		RampVolume(vol_l);
+		RampVolume(vol_r);
+	}
+	return blocks * 8;
+}
+
+
+// Eight values at a time, the saturating pack clips
+static UINT32 ClipSIMD(INT16* const dst, INT32 const* const mix, UINT32 const n)
+{
+	UINT32 i = 0;
+	for (; i + 8 <= n; i += 8)
+	{
+		__m128i const a = _mm_loadu_si128(reinterpret_cast<__m128i const*>(mix + i));
+		__m128i const b = _mm_loadu_si128(reinterpret_cast<__m128i const*>(mix + i + 4));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_packs_epi32(a, b));
+	}
+	return i;
+}
+
+#elif defined MIX_NEON
+// mix[0..3] += (s * vol) >> 7 for four 16 bit values
+static inline void MixAdd4(INT32* const mix, int16x4_t const s, int16x4_t const vol)
+{
+	vst1q_s32(mix, vaddq_s32(vld1q_s32(mix), vshrq_n_s32(vmull_s16(s, vol), 7)));
+}
+
+
+// Whole blocks of MIX_RAMP_FRAMES (8) frames, returns the frames done
+static UINT32 MixSIMD(INT32* mix, INT16 const* src, UINT32 const n, bool const stereo, MixVolume& vol_l, MixVolume& vol_r)
+{
+	UINT32 const blocks = n / 8;
+	for (UINT32 b = 0; b != blocks; ++b, mix += 16)
+	{
+		int16_t const v[4] = { (int16_t)vol_l.current, (int16_t)vol_r.current, (int16_t)vol_l.current, (int16_t)vol_r.current };
+		int16x4_t const vol = vld1_s16(v);
+		if (stereo)
+		{
+			for (UINT32 i = 0; i != 4; ++i) MixAdd4(mix + 4 * i, vld1_s16(src + 4 * i), vol);
+			src += 16;
+		}
+		else
+		{
+			for (UINT32 i = 0; i != 2; ++i)
+			{
+				int16x4_t   const s = vld1_s16(src + 4 * i);
+				int16x4x2_t const d = vzip_s16(s, s);
+				MixAdd4(mix + 8 * i + 0, d.val[0], vol);
+				MixAdd4(mix + 8 * i + 4, d.val[1], vol);
+			}
+			src += 8;
+		}
+		RampVolume(vol_l);
+		RampVolume(vol_r);
+	}
+	return blocks * 8;
+}
+
+
+// Eight values at a time, the saturating narrow clips
+static UINT32 ClipSIMD(INT16* const dst, INT32 const* const mix, UINT32 const n)
+{
+	UINT32 i = 0;
+	for (; i + 8 <= n; i += 8)
+	{
+		vst1q_s16(dst + i, vcombine_s16(vqmovn_s32(vld1q_s32(mix + i)), vqmovn_s32(vld1q_s32(mix + i + 4))));
+	}
+	return i;
+}
+#endif
+
+
+static void Mix(INT32* const mix, INT16 const* const src, UINT32 const n, bool const stereo, MixVolume& vol_l, MixVolume& vol_r)
+{
+	UINT32 done = 0;
+#if defined MIX_SSE2 || defined MIX_NEON
+	if (g_simd_mixer) done = MixSIMD(mix, src, n, stereo, vol_l, vol_r);
+#endif
+	MixScalar(mix + 2 * done, src + (stereo ? 2 : 1) * done, n - done, stereo, vol_l, vol_r);
+}
+
+
+static void Clip(INT16* const dst, INT32 const* const mix, UINT32 const n)
+{
+	UINT32 done = 0;
+#if defined MIX_SSE2 || defined MIX_NEON
+	if (g_simd_mixer) done = ClipSIMD(dst, mix, n);
+#endif
+	ClipScalar(dst + done, mix + done, n - done);
+}
+
+
+static void SoundEndVoice(UINT32 const channel)
+{
+	gSoundVoices[channel].data   = NULL;
+	gSoundVoices[channel].job    = NULL;
+	gSoundVoices[channel].stream = NULL;
+	gSoundEnded.push(channel);
+}
+
+
+/* Mixes a voice which plays from a stream. The stream loops by itself. If the
+ * stream thread did not keep up, the voice waits. */
+static void SoundMixStream(UINT32 const channel, SoundVoice& v, INT32* mix, UINT32 samples)
+{
+	SoundStream* const st = v.stream;
+	while (samples != 0)
+	{
+		// The state first, so all halves are counted once it is done
+		int    const state  = SDL_AtomicGet(&st->state);
+		UINT32 const played = SDL_AtomicGet(&st->played);
+		if (played == static_cast<UINT32>(SDL_AtomicGet(&st->filled)))
+		{
+			if (state != DECODE_RUNNING) SoundEndVoice(channel);
+			return;
+		}
+
+		UINT32       const half   = played % 2;
+		UINT32       const frames = st->frames[half];
+		UINT32       const amount = MIN(samples, frames - v.pos);
+		INT16 const* const src    = reinterpret_cast<INT16 const*>(st->ring) + (half * SOUND_STREAM_FRAMES + v.pos) * (st->stereo ? 2 : 1);
+		Mix(mix, src, amount, st->stereo, v.vol_l, v.vol_r);
+		mix     += 2 * amount;
+		samples -= amount;
+		v.pos   += amount;
+		if (v.pos == frames)
+		{
+			v.pos = 0;
+			SDL_AtomicSet(&st->played, played + 1);
+		}
+	}
+}
+
+
+/* Takes the frames a voice can play from the job it was started on. Once the
+ * job is done, the voice plays on like any other.
+ *
+ * Returns: false if there is nothing to play yet. */
+static bool SoundPollJob(UINT32 const channel, SoundVoice& v)
+{
+	SoundDecodeJob* const job   = v.job;
+	int             const state = SDL_AtomicGet(&job->state);
+	UINT32          const ready = SDL_AtomicGet(&job->n_ready);
+	switch (state)
+	{
+		case DECODE_FAILED:
+			SoundEndVoice(channel);
+			return false;
+
+		case DECODE_DONE:
+			v.job = NULL;
+			if (job->n_samples == 0)
+			{
+				SoundEndVoice(channel);
+				return false;
+			}
+			v.n_samples = job->n_samples;
+			break;
+
+		default:
+			if (ready == 0) return false;
+			v.n_samples = ready;
+			break;
+	}
+	v.data   = reinterpret_cast<INT16 const*>(job->data);
+	v.stereo = job->stereo;
+	return true;
+}
+
+
+// Carry out the commands the main thread queued since the last buffer
+static void SoundRunCommands()
+{
+	SoundCommand c;
+	while (gSoundCommands.pop(c))
+	{
+		SoundVoice& v = gSoundVoices[c.channel];
+		switch (c.type)
+		{
+			case SOUND_CMD_PLAY:
+				v.data          = c.data;
+				v.job           = c.job;
+				v.stream        = c.stream;
+				v.n_samples     = c.n_samples;
+				v.stereo        = c.stereo;
+				v.id            = c.id;
+				v.pos           = 0;
+				v.loops         = c.loops;
+				v.volume        = c.value;
+				v.pan           = c.pan;
+				v.vol_l.current = v.volume * (127 - v.pan) / MAXVOLUME;
+				v.vol_r.current = v.volume * (  0 + v.pan) / MAXVOLUME;
+				if (v.n_samples == 0 && v.job == NULL && v.stream == NULL) SoundEndVoice(c.channel);
+				break;
+
+			case SOUND_CMD_STOP:
+				// The voice may have ended already and the channel be playing another
+				if ((v.data != NULL || v.job != NULL || v.stream != NULL) && v.id == c.id) SoundEndVoice(c.channel);
+				break;
+
+			case SOUND_CMD_VOLUME:
+				if (v.id == c.id) v.volume = c.value;
+				break;
+
+			case SOUND_CMD_PAN:
+				if (v.id == c.id) v.pan = c.value;
+				break;
+		}
+	}
+}
+
+
+static void SoundCallback(void* userdata, Uint8* stream, int len)
+{
+	PROFILE_ZONE("SoundCallback");
+	if (len < 0)
+	{
+		SLOGA("SoundCallback: unexpected negative len %d", len);
+		return;
+	}
+
+	Uint64 const start = SDL_GetPerformanceCounter();
 
 	// 16-bit stereo = 2 bytes per value, 2 values per sample
 	UINT32 want_bytes = static_cast<UINT32>(len);
@@ -817,84 +2090,65 @@ static void SoundCallback(void* userdata, Uint8* stream, int len)
 
 	std::fill_n(gMixBuffer, want_values, 0);
 
+	SoundRunCommands();
+
 	// Mix sounds
-	for (UINT32 i = 0; i < lengthof(pSoundList); i++)
+	for (UINT32 i = 0; i < lengthof(gSoundVoices); i++)
 	{
-		SOUNDTAG* Sound = &pSoundList[i];
+		SoundVoice& v = gSoundVoices[i];
+		if (v.stream == NULL)
+		{
+			if (v.job != NULL && !SoundPollJob(i, v)) continue;
+			if (v.data == NULL) continue;
+		}
 
-		switch (Sound->State)
+		v.vol_l.target = v.volume * (127 - v.pan) / MAXVOLUME;
+		v.vol_r.target = v.volume * (  0 + v.pan) / MAXVOLUME;
+		if (v.stream != NULL)
 		{
-			default:
-			case CHANNEL_FREE:
-			case CHANNEL_DEAD:
-				continue;
+			SoundMixStream(i, v, gMixBuffer, want_samples);
+			continue;
+		}
 
-			case CHANNEL_STOP:
-				Sound->State = CHANNEL_DEAD;
-				continue;
-
-			case CHANNEL_PLAY:
-			{
-				const SAMPLETAG* const s = Sound->pSample;
-				const INT vol_l   = Sound->uiFadeVolume * (127 - Sound->Pan) / MAXVOLUME;
-				const INT vol_r   = Sound->uiFadeVolume * (  0 + Sound->Pan) / MAXVOLUME;
-				UINT32    samples = want_samples;
-				UINT32    amount;
+		INT32* mix     = gMixBuffer;
+		UINT32 samples = want_samples;
+		UINT32 amount;
 
 mixing:
-				amount = MIN(samples, s->n_samples - Sound->pos);
-				if (s->uiFlags & SAMPLE_STEREO)
-				{
-					const INT16* const src = (const INT16*)s->pData + Sound->pos * 2;
-					for (UINT32 i = 0; i < amount; ++i)
-					{
-						gMixBuffer[2 * i + 0] += src[2 * i + 0] * vol_l >> 7;
-						gMixBuffer[2 * i + 1] += src[2 * i + 1] * vol_r >> 7;
-					}
-				}
-				else
-				{
-					const INT16* const src = (const INT16*)s->pData + Sound->pos;
-					for (UINT32 i = 0; i < amount; i++)
-					{
-						const INT data = src[i];
-						gMixBuffer[2 * i + 0] += data * vol_l >> 7;
-						gMixBuffer[2 * i + 1] += data * vol_r >> 7;
-					}
-				}
-
-				Sound->pos += amount;
-				if (Sound->pos == s->n_samples)
-				{
-					if (Sound->Loops != 1)
-					{
-						if (Sound->Loops != 0) --Sound->Loops;
-						Sound->pos = 0;
-						samples -= amount;
-						if (samples != 0) goto mixing;
-					}
-					else
-					{
-						Sound->State = CHANNEL_DEAD;
-					}
-				}
+		amount = MIN(samples, v.n_samples - v.pos);
+		Mix(mix, v.data + v.pos * (v.stereo ? 2 : 1), amount, v.stereo, v.vol_l, v.vol_r);
+		mix += 2 * amount;
+
+		v.pos += amount;
+		// A voice which caught up with its job waits for the next chunk
+		if (v.pos == v.n_samples && v.job == NULL)
+		{
+			if (v.loops != 1)
+			{
+				if (v.loops != 0) --v.loops;
+				v.pos = 0;
+				samples -= amount;
+				if (samples != 0) goto mixing;
+			}
+			else
+			{
+				SoundEndVoice(i);
 			}
 		}
 	}
 
 	// Clip sounds and fill the stream
-	INT16* Stream = (INT16*)stream;
-	for (UINT32 i = 0; i < want_values; ++i)
-	{
-		if (gMixBuffer[i] >= INT16_MAX)     Stream[i] = INT16_MAX;
-		else if(gMixBuffer[i] <= INT16_MIN) Stream[i] = INT16_MIN;
-		else                                Stream[i] = (INT16)gMixBuffer[i];
-	}
+	Clip((INT16*)stream, gMixBuffer, want_values);
 
 	// "The callback must completely initialize the buffer"
 	// see: https://wiki.libsdl.org/SDL_AudioSpec
 	UINT32 have_bytes = want_values * sizeof(INT16);
 	std::fill_n(stream + have_bytes, want_bytes - have_bytes, 0);
+
+	Uint64 const ticks = SDL_GetPerformanceCounter() - start;
+	Uint64 const freq  = SDL_GetPerformanceFrequency();
+	if (ticks * SOUND_FREQ > want_samples * freq) ++guiMixUnderruns;
+	guiMixMicroseconds += static_cast<UINT32>(ticks * 1000000 / freq);
 }
 
 
@@ -912,6 +2166,9 @@ static BOOLEAN SoundInitHardware(void)
 	if (SDL_OpenAudio(&gTargetAudioSpec, NULL) != 0) return FALSE;
 
 	std::fill(std::begin(pSoundList), std::end(pSoundList), SOUNDTAG{});
+	std::fill(std::begin(gSoundVoices), std::end(gSoundVoices), SoundVoice{});
+	gSoundCommands.clear();
+	gSoundEnded.clear();
 	SDL_PauseAudio(0);
 	return TRUE;
 }
@@ -951,21 +2208,43 @@ static UINT32 SoundStartSample(SAMPLETAG* sample, SOUNDTAG* channel, UINT32 volu
 
 	if (!fSoundSystemInit) return SOUND_ERROR;
 
+	if (!SoundDecodeSample(sample)) return SOUND_ERROR;
+
+	UINT32 uiSoundID = SoundGetUniqueID();
+
+	SoundCommand c = SoundCommand();
+	c.type      = SOUND_CMD_PLAY;
+	c.channel   = static_cast<UINT32>(channel - pSoundList);
+	c.id        = uiSoundID;
+	c.value     = volume;
+	c.data      = static_cast<INT16 const*>(sample->pData);
+	c.job       = sample->decode;
+	c.stream    = sample->stream;
+	c.n_samples = sample->n_samples;
+	c.stereo    = (sample->uiFlags & SAMPLE_STEREO) != 0;
+	c.loops     = loop;
+	c.pan       = pan;
+	if (!gSoundCommands.push(c))
+	{
+		SLOGW("Sound command queue is full, not playing \"%s\"", sample->pName);
+		return SOUND_ERROR;
+	}
+
 	channel->uiFadeVolume  = volume;
-	channel->Loops         = loop;
 	channel->Pan           = pan;
 	channel->EOSCallback   = end_callback;
 	channel->pCallbackData = data;
-
-	UINT32 uiSoundID = SoundGetUniqueID();
-	channel->uiSoundID    = uiSoundID;
-	channel->pSample      = sample;
-	channel->uiTimeStamp  = GetClock();
-	channel->pos          = 0;
-	channel->State        = CHANNEL_PLAY;
+	channel->uiSoundID     = uiSoundID;
+	channel->pSample       = sample;
+	channel->uiTimeStamp   = GetClock();
+	channel->State         = CHANNEL_PLAY;
+	channel->decode        = sample->decode;
+	if (channel->decode != NULL) ++channel->decode->n_voices;
+	if (sample->stream  != NULL) SoundStartStream(sample->stream, loop);
 
 	sample->uiInstances++;
 	sample->uiCacheHits++;
+	sample->uiLastUse = ++guiSoundUseCounter;
 
 	return uiSoundID;
 }
@@ -994,8 +2273,7 @@ static BOOLEAN SoundStopChannel(SOUNDTAG* channel)
 	if (channel->pSample == NULL) return FALSE;
 
 	SLOGD("stopping channel channel %u", channel - pSoundList);
-	channel->State = CHANNEL_STOP;
-	return TRUE;
+	return SoundSendCommand(SOUND_CMD_STOP, channel, 0);
 }
 
 
@@ -1008,3 +2286,67 @@ void SoundStopRandom(UINT32 uiSample)
 		s->uiFlags &= ~SAMPLE_RANDOM;
 	}
 }
+
+
+#ifdef WITH_UNITTESTS
+#include "gtest/gtest.h"
+
+TEST(SoundMan, commandRing)
+{
+	SPSCRing<UINT32, 4> ring;
+	UINT32 v;
+	EXPECT_FALSE(ring.pop(v));
+	for (UINT32 i = 0; i != 4; ++i) EXPECT_TRUE(ring.push(i));
+	EXPECT_FALSE(ring.push(4));
+	EXPECT_TRUE(ring.pop(v));
+	EXPECT_EQ(v, 0u);
+	EXPECT_TRUE(ring.push(4));
+	for (UINT32 i = 1; i != 5; ++i)
+	{
+		EXPECT_TRUE(ring.pop(v));
+		EXPECT_EQ(v, i);
+	}
+	EXPECT_FALSE(ring.pop(v));
+}
+
+TEST(SoundMan, mixMatchesScalar)
+{
+	INT16 src[2 * 77];
+	for (UINT32 i = 0; i != lengthof(src); ++i) src[i] = (INT16)(i * 7919 + 12345);
+	src[0] = INT16_MIN;
+	src[1] = INT16_MAX;
+
+	for (int stereo = 0; stereo != 2; ++stereo)
+	{
+		INT32 expected[2 * 77];
+		INT32 actual[2 * 77];
+		std::fill(std::begin(expected), std::end(expected), 1000);
+		std::fill(std::begin(actual),   std::end(actual),   1000);
+		MixVolume el = { 127,   0 };
+		MixVolume er = {   3, 100 };
+		MixVolume al = el;
+		MixVolume ar = er;
+		MixScalar(expected, src, 77, stereo != 0, el, er);
+		Mix(actual, src, 77, stereo != 0, al, ar);
+		for (UINT32 i = 0; i != lengthof(expected); ++i) EXPECT_EQ(expected[i], actual[i]);
+		EXPECT_EQ(el.current, al.current);
+		EXPECT_EQ(er.current, ar.current);
+		EXPECT_EQ(el.current, 127 - 9 * MIX_RAMP_STEP);
+		EXPECT_EQ(er.current, 3 + 9 * MIX_RAMP_STEP);
+	}
+}
+
+TEST(SoundMan, clipMatchesScalar)
+{
+	INT32 mix[37];
+	for (UINT32 i = 0; i != lengthof(mix); ++i) mix[i] = ((INT32)i - 18) * 5000;
+	INT16 expected[37];
+	INT16 actual[37];
+	ClipScalar(expected, mix, 37);
+	Clip(actual, mix, 37);
+	for (UINT32 i = 0; i != lengthof(mix); ++i) EXPECT_EQ(expected[i], actual[i]);
+	EXPECT_EQ(actual[0],  INT16_MIN);
+	EXPECT_EQ(actual[36], INT16_MAX);
+}
+
+#endif
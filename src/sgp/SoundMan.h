@@ -40,6 +40,11 @@ UINT32 SoundPlay(const char* pFilename, UINT32 volume, UINT32 pan, UINT32 loop,
  *          returned */
 UINT32 SoundPlayStreamedFile(const char* pFilename, UINT32 volume, UINT32 pan, UINT32 loop, void (*end_callback)(void*), void* data);
 
+/* Starts decoding a sample on the decoder thread and leaves it in the cache, so
+ * playing it a moment later does not wait for the disk or the decoder. Files
+ * too large for the cache are streamed when they play and are not prefetched. */
+void SoundPrefetch(const char* pFilename);
+
 /* Registers a sample to be played randomly within the specified parameters.
  *
  * * Samples designated "random" are ALWAYS loaded into the cache, and locked
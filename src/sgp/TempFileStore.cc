@@ -0,0 +1,177 @@
+#include "TempFileStore.h"
+#include "FileMan.h"
+#include "Logger.h"
+
+#include <functional>
+#include <stdexcept>
+
+
+TempFileStore::TempFileStore(std::string const& dir, size_t const budget) :
+	dir_(dir),
+	budget_(budget),
+	clock_(0)
+{
+}
+
+
+SGPFile* TempFileStore::openForWriting(char const* const name, bool const truncate)
+{
+	Entry& e = load(name);
+	if (truncate) e.data->clear();
+	return open(e);
+}
+
+
+SGPFile* TempFileStore::openForAppend(char const* const name)
+{
+	SGPFile* const f = open(load(name));
+	FileSeek(f, 0, FILE_SEEK_FROM_END);
+	return f;
+}
+
+
+SGPFile* TempFileStore::openForReading(char const* const name)
+{
+	if (!exists(name)) throw std::runtime_error(std::string("Temp file not found: ") + name);
+	return open(load(name));
+}
+
+
+void TempFileStore::addReference(char const* const name, std::shared_ptr<std::vector<BYTE> const> const& source, size_t const offset, size_t const size)
+{
+	if (offset > source->size() || size > source->size() - offset)
+	{
+		throw std::out_of_range(std::string("Temp file reference out of range: ") + name);
+	}
+	deleteFile(name);
+	Entry& e = files_[name];
+	e.source   = source;
+	e.offset   = offset;
+	e.size     = size;
+	e.last_use = 0;
+}
+
+
+bool TempFileStore::exists(char const* const name) const
+{
+	return files_.find(name) != files_.end();
+}
+
+
+void TempFileStore::deleteFile(char const* const name)
+{
+	Files::iterator const i = files_.find(name);
+	if (i == files_.end()) return;
+	if (i->second.onDisk()) FileDelete(getPath(i->first));
+	files_.erase(i);
+}
+
+
+void TempFileStore::deleteAll()
+{
+	for (Files::value_type const& i : files_)
+	{
+		if (i.second.onDisk()) FileDelete(getPath(i.first));
+	}
+	files_.clear();
+}
+
+
+size_t TempFileStore::getMemoryUsage() const
+{
+	size_t used = 0;
+	for (Files::value_type const& i : files_)
+	{
+		if (i.second.data) used += i.second.data->size();
+	}
+	return used;
+}
+
+
+std::string TempFileStore::getPath(std::string const& name) const
+{
+	return FileMan::joinPaths(dir_, name);
+}
+
+
+TempFileStore::Entry& TempFileStore::load(char const* const name)
+{
+	Files::iterator const i = files_.find(name);
+	if (i == files_.end())
+	{
+		Entry& e = files_[name];
+		e.data     = std::make_shared<std::vector<BYTE> >();
+		e.last_use = 0;
+		return e;
+	}
+
+	Entry& e = i->second;
+	if (e.source)
+	{ // Copy the referenced data, the file now lives on its own
+		BYTE const* const begin = e.source->data() + e.offset;
+		e.data = std::make_shared<std::vector<BYTE> >(begin, begin + e.size);
+		e.source.reset();
+	}
+	else if (!e.data)
+	{ // Bring it back from disk, it is going to change anyway
+		std::string const path = getPath(i->first);
+		std::shared_ptr<std::vector<BYTE> > data;
+		{
+			AutoSGPFile f(FileMan::openForReading(path.c_str()));
+			data = std::make_shared<std::vector<BYTE> >(FileGetSize(f));
+			if (!data->empty()) FileRead(f, data->data(), data->size());
+		}
+		FileDelete(path);
+		e.data = data;
+	}
+	return e;
+}
+
+
+SGPFile* TempFileStore::open(Entry& e)
+{
+	e.last_use = ++clock_;
+	return FileMan::openInMemory(e.data, std::bind(&TempFileStore::enforceBudget, this));
+}
+
+
+void TempFileStore::spill(Files::value_type& i)
+{
+	std::vector<BYTE> const& data = *i.second.data;
+	{
+		AutoSGPFile f(FileMan::openForWriting(getPath(i.first).c_str()));
+		if (!data.empty()) FileWrite(f, data.data(), data.size());
+	}
+	i.second.data.reset();
+}
+
+
+void TempFileStore::enforceBudget()
+{
+	size_t used = getMemoryUsage();
+	while (used > budget_)
+	{
+		// Move the least recently used file out, which is not open
+		Files::iterator victim = files_.end();
+		for (Files::iterator i = files_.begin(); i != files_.end(); ++i)
+		{
+			Entry const& e = i->second;
+			if (!e.data || e.data.use_count() != 1) continue;
+			if (victim == files_.end() || e.last_use < victim->second.last_use) victim = i;
+		}
+		if (victim == files_.end()) return;
+
+		size_t const size = victim->second.data->size();
+		try
+		{
+			spill(*victim);
+		}
+		catch (std::exception const& e)
+		{
+			// This is called when a file is closed, so keep it in memory instead
+			SLOGW("Moving temp file '%s' to disk failed: %s", victim->first.c_str(), e.what());
+			return;
+		}
+		used -= size;
+	}
+}
@@ -0,0 +1,79 @@
+#ifndef TEMP_FILE_STORE_H
+#define TEMP_FILE_STORE_H
+
+#include "Types.h"
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+struct SGPFile;
+
+
+/* Keeps named temporary files in memory. The files are opened as memory files
+ * on a buffer owned by the store, so they stay around after they are closed.
+ * Once the files in memory take up more than the budget, the least recently
+ * used ones which are not open are moved to the directory on disk, and back
+ * into memory when they are opened again. */
+class TempFileStore
+{
+public:
+	/* Files which are open when the store is destroyed must not be closed
+	 * afterwards. */
+	TempFileStore(std::string const& dir, size_t budget);
+
+	/* Open a file for reading and writing, creating it if it doesn't exist.
+	 * Optionally the file is cut to zero length first. */
+	SGPFile* openForWriting(char const* name, bool truncate);
+
+	/* Like openForWriting() without truncating, positioned at the end. */
+	SGPFile* openForAppend(char const* name);
+
+	/* Open an existing file. Throws if there is no such file. */
+	SGPFile* openForReading(char const* name);
+
+	/* Add a file whose contents are the given slice of a shared buffer. Nothing
+	 * is copied until the file is opened, so the buffer is held until then.
+	 * Replaces any existing file of the same name. */
+	void addReference(char const* name, std::shared_ptr<std::vector<BYTE> const> const& source, size_t offset, size_t size);
+
+	bool exists(char const* name) const;
+
+	void deleteFile(char const* name);
+
+	void deleteAll();
+
+	/* Bytes of file data which are currently held in memory. */
+	size_t getMemoryUsage() const;
+
+private:
+	struct Entry
+	{
+		std::shared_ptr<std::vector<BYTE> >       data;   // null while it is on disk or a reference
+		std::shared_ptr<std::vector<BYTE> const> source; // set while it is a reference
+		size_t                                    offset;
+		size_t                                    size;
+		UINT32                                    last_use;
+
+		bool onDisk() const { return !data && !source; }
+	};
+
+	typedef std::map<std::string, Entry> Files;
+
+	std::string getPath(std::string const& name) const;
+	Entry&      load(char const* name);
+	SGPFile*    open(Entry&);
+	void        spill(Files::value_type&);
+	void        enforceBudget();
+
+	std::string dir_;
+	size_t      budget_;
+	UINT32      clock_;
+	Files       files_;
+
+	TempFileStore(TempFileStore const&);          /* no copy */
+	void operator =(TempFileStore const&);        /* no assignment */
+};
+
+#endif
@@ -0,0 +1,114 @@
+#include "gtest/gtest.h"
+
+#include "FileMan.h"
+#include "TempFileStore.h"
+#include "boost/filesystem.hpp"
+
+#include <stdexcept>
+
+
+TEST(TempFileStoreTest, KeepsFilesInMemory)
+{
+	boost::filesystem::path tmpDir = boost::filesystem::temp_directory_path();
+	tmpDir /= boost::filesystem::unique_path();
+	ASSERT_EQ(boost::filesystem::create_directory(tmpDir), true);
+
+	TempFileStore store(tmpDir.string(), 1000);
+	{
+		AutoSGPFile f(store.openForWriting("foo", true));
+		FileWrite(f, "hello", 5);
+	}
+	{
+		AutoSGPFile f(store.openForAppend("foo"));
+		FileWrite(f, "world", 5);
+	}
+	EXPECT_EQ(store.exists("foo"), true);
+	EXPECT_EQ(store.getMemoryUsage(), 10u);
+	EXPECT_EQ(FindAllFilesInDir(tmpDir.string(), false).size(), 0u);
+
+	{
+		char buf[10];
+		AutoSGPFile f(store.openForReading("foo"));
+		ASSERT_EQ(FileGetSize(f), 10u);
+		FileRead(f, buf, sizeof(buf));
+		EXPECT_EQ(memcmp(buf, "helloworld", sizeof(buf)), 0);
+	}
+
+	store.deleteFile("foo");
+	EXPECT_EQ(store.exists("foo"), false);
+	EXPECT_THROW(store.openForReading("foo"), std::runtime_error);
+
+	boost::filesystem::remove_all(tmpDir);
+}
+
+TEST(TempFileStoreTest, SpillsToDisk)
+{
+	boost::filesystem::path tmpDir = boost::filesystem::temp_directory_path();
+	tmpDir /= boost::filesystem::unique_path();
+	ASSERT_EQ(boost::filesystem::create_directory(tmpDir), true);
+
+	TempFileStore store(tmpDir.string(), 10);
+	std::vector<BYTE> const data(8, 42);
+	{
+		AutoSGPFile f(store.openForWriting("old", true));
+		FileWrite(f, data.data(), data.size());
+	}
+	{
+		// An open file stays in memory, the least recently used one goes
+		AutoSGPFile f(store.openForWriting("new", true));
+		FileWrite(f, data.data(), data.size());
+		EXPECT_EQ(store.getMemoryUsage(), 16u);
+	}
+	EXPECT_EQ(store.getMemoryUsage(), 8u);
+	EXPECT_EQ(boost::filesystem::file_size(tmpDir / "old"), 8u);
+
+	// Opening it brings it back
+	{
+		AutoSGPFile f(store.openForReading("old"));
+		std::vector<BYTE> buf(8);
+		FileRead(f, buf.data(), buf.size());
+		EXPECT_EQ(buf, data);
+	}
+	EXPECT_EQ(boost::filesystem::exists(tmpDir / "old"), false);
+	EXPECT_EQ(boost::filesystem::exists(tmpDir / "new"), true);
+
+	store.deleteAll();
+	EXPECT_EQ(store.exists("old"), false);
+	EXPECT_EQ(store.exists("new"), false);
+	EXPECT_EQ(FindAllFilesInDir(tmpDir.string(), false).size(), 0u);
+
+	boost::filesystem::remove_all(tmpDir);
+}
+
+TEST(TempFileStoreTest, References)
+{
+	TempFileStore store("/nonexistent", 1024);
+	std::shared_ptr<std::vector<BYTE> > const source = std::make_shared<std::vector<BYTE> >();
+	for (BYTE i = 0; i != 16; ++i) source->push_back(i);
+
+	store.addReference("ref", source, 4, 8);
+	EXPECT_EQ(store.exists("ref"), true);
+	EXPECT_EQ(store.getMemoryUsage(), 0u);
+	EXPECT_THROW(store.addReference("bad", source, 12, 8), std::out_of_range);
+
+	// Opening it copies the slice, the source may change afterwards
+	{
+		AutoSGPFile f(store.openForReading("ref"));
+		EXPECT_EQ(FileGetSize(f), 8u);
+		BYTE buf[8];
+		FileRead(f, buf, sizeof(buf));
+		for (BYTE i = 0; i != 8; ++i) EXPECT_EQ(buf[i], i + 4);
+	}
+	(*source)[4] = 99;
+	{
+		AutoSGPFile f(store.openForReading("ref"));
+		BYTE b;
+		FileRead(f, &b, 1);
+		EXPECT_EQ(b, 4);
+	}
+
+	store.addReference("ref", source, 0, 2);
+	store.deleteAll();
+	EXPECT_EQ(store.exists("ref"), false);
+	EXPECT_EQ(source.use_count(), 1);
+}
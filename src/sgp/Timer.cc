@@ -0,0 +1,18 @@
+#include "Timer.h"
+
+
+bool   g_clock_fixed;
+UINT32 g_fixed_clock;
+
+
+void SetClockFixed(bool const fixed)
+{
+	if (fixed && !g_clock_fixed) g_fixed_clock = SDL_GetTicks();
+	g_clock_fixed = fixed;
+}
+
+
+void AdvanceFixedClock(UINT32 const ms)
+{
+	g_fixed_clock += ms;
+}
@@ -4,9 +4,24 @@
 #include "Types.h"
 #include <SDL.h>
 
+/* A fixed clock only advances by AdvanceFixedClock(), so the game takes the
+ * same course however long its cycles take, e.g. while input is recorded or
+ * replayed (see InputReplay.h) or in a benchmark. */
+extern bool   g_clock_fixed;
+extern UINT32 g_fixed_clock;
+
+/* Fixing the clock starts it at the current time. */
+void SetClockFixed(bool fixed);
+void AdvanceFixedClock(UINT32 ms);
+
+static inline bool ClockIsFixed(void)
+{
+	return g_clock_fixed;
+}
+
 static inline UINT32 GetClock(void)
 {
-	return SDL_GetTicks();
+	return g_clock_fixed ? g_fixed_clock : SDL_GetTicks();
 }
 
 #endif
@@ -136,6 +136,7 @@ struct AuxObjectData;
 struct ETRLEObject;
 struct RelTileLoc;
 struct SGPImage;
+struct ZStripInfo;
 
 class SGPVObject;
 typedef SGPVObject* HVOBJECT;
@@ -27,7 +27,7 @@
 static SGPVObject* gpVObjectHead = 0;
 
 
-SGPVObject::SGPVObject(SGPImage const* const img) :
+SGPVObject::SGPVObject(SGPImage* const img) :
 	flags_(),
 	palette16_(),
 	current_shade_(),
@@ -46,7 +46,7 @@ SGPVObject::SGPVObject(SGPImage const* const img) :
 	}
 
 	ETRLEData TempETRLEData;
-	GetETRLEImageData(img, &TempETRLEData);
+	TakeETRLEImageData(img, &TempETRLEData);
 
 	subregion_count_ = TempETRLEData.usNumberOfObjects;
 	etrle_object_    = TempETRLEData.pETRLEObject;
@@ -91,18 +91,7 @@ SGPVObject::~SGPVObject()
 	if (pix_data_)     MemFree(pix_data_);
 	if (etrle_object_) MemFree(etrle_object_);
 
-	if (ppZStripInfo != NULL)
-	{
-		for (UINT32 usLoop = 0; usLoop < SubregionCount(); usLoop++)
-		{
-			if (ppZStripInfo[usLoop] != NULL)
-			{
-				MemFree(ppZStripInfo[usLoop]->pbZChange);
-				MemFree(ppZStripInfo[usLoop]);
-			}
-		}
-		MemFree(ppZStripInfo);
-	}
+	if (ppZStripInfo) MemFree(ppZStripInfo);
 
 #ifdef SGP_VIDEO_DEBUGGING
 	if (name_) MemFree(name_);
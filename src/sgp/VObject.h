@@ -17,6 +17,7 @@ struct ZStripInfo
 	UINT8 ubFirstZStripWidth; // # of pixels in the leftmost strip
 	UINT8 ubNumberOfZChanges; // number of strips (after the first)
 	INT8* pbZChange;          // change to the Z value in each strip (after the first)
+	INT16* psZLevel;          // sum of the changes before each strip, ubNumberOfZChanges + 1 entries
 };
 
 // This definition mimics what is found in WINDOWS.H ( for Direct Draw compatiblity )
@@ -28,7 +29,8 @@ struct ZStripInfo
 class SGPVObject
 {
 	public:
-		SGPVObject(SGPImage const*);
+		// Takes over the pixel data and ETRLE objects of the image
+		SGPVObject(SGPImage*);
 		~SGPVObject();
 
 		UINT8 BPP() const { return bit_depth_; }
@@ -44,6 +46,8 @@ class SGPVObject
 
 		UINT16 SubregionCount() const { return subregion_count_; }
 
+		UINT32 PixDataSize() const { return pix_data_size_; }
+
 		ETRLEObject const& SubregionProperties(size_t idx) const;
 
 		UINT8 const* PixData(ETRLEObject const&) const;
@@ -77,7 +81,7 @@ class SGPVObject
 	private:
 		UINT16 const*                current_shade_;
 	public:
-		ZStripInfo**                 ppZStripInfo;                   // Z-value strip info arrays
+		ZStripInfo**                 ppZStripInfo;                   // Z-value strip info arrays, one block with the records
 
 	private:
 		UINT16                       subregion_count_;               // Total number of objects
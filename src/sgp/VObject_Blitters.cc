@@ -1,5 +1,6 @@
 #include <stdint.h>
 #include "Debug.h"
+#include "ETRLEBlitter.h"
 #include "HImage.h"
 #include "Local.h"
 #include "MemMan.h"
@@ -9,6 +10,8 @@
 #include "VSurface.h"
 #include "WCheck.h"
 
+#include <SDL_cpuinfo.h>
+
 
 SGPRect	ClippingRect;
 							//555      565
@@ -26,6 +29,22 @@ static uint16_t DoZ(int32_t const a, int32_t const b)
 }
 
 
+/* The vector kernels are compiled in if the target supports them, but only
+ * used if the CPU we are running on does as well. */
+static bool DetectSIMDBlitters()
+{
+#if defined BLT_SSE2
+	return SDL_HasSSE2() == SDL_TRUE;
+#elif defined BLT_NEON
+	return SDL_HasNEON() == SDL_TRUE;
+#else
+	return false;
+#endif
+}
+
+bool const g_simd_blitters = DetectSIMDBlitters();
+
+
 /* Blit an image into the destination buffer, using an ETRLE brush as a source,
  * and a 16-bit buffer as a destination. As it is blitting, it checks the Z
  * value of the ZBuffer, and if the pixel's Z level is below that of the current
@@ -35,125 +54,7 @@ static uint16_t DoZ(int32_t const a, int32_t const b)
  * Blits every second pixel ("Translucents"). */
 void Blt8BPPDataTo16BPPBufferTransZNBClipTranslucent(UINT16* const buf, UINT32 const uiDestPitchBYTES, UINT16* const zbuf, UINT16 const zval, HVOBJECT const hSrcVObject, INT32 const iX, INT32 const iY, UINT16 const usIndex, SGPRect const* clipregion)
 {
-	Assert(hSrcVObject);
-	Assert(buf);
-
-	// Get offsets from index into structure.
-	ETRLEObject const& e      = hSrcVObject->SubregionProperties(usIndex);
-	int32_t      const height = e.usHeight; // NB: safe automatic conversion
-	int32_t      const width  = e.usWidth;
-
-	// Add to start position of dest buffer.
-	int32_t const x = iX + e.sOffsetX;
-	int32_t const y = iY + e.sOffsetY;
-
-	if (!clipregion) clipregion = &ClippingRect;
-
-	/* Calculate rows hanging off each side of the screen and check if the whole
-	 * thing is clipped. */
-	UINT16 const left_skip   = DoZ(clipregion->iLeft, x);
-	if (left_skip   >= width)  return;
-	UINT16       top_skip    = DoZ(clipregion->iTop,  y);
-	if (top_skip    >= height) return;
-	UINT16 const right_skip  = DoZ(x + width,  clipregion->iRight);
-	if (right_skip  >= width)  return;
-	UINT16 const bottom_skip = DoZ(y + height, clipregion->iBottom);
-	if (bottom_skip >= height) return;
-
-	// Calculate the remaining rows and columns to blit.
-	INT32 const blit_length = width  - left_skip - right_skip;
-	INT32       blit_height = height - top_skip  - bottom_skip;
-
-	UINT32         const pitch     = uiDestPitchBYTES / 2;
-	UINT8   const*       src       = hSrcVObject->PixData(e);
-	UINT16*              dst       = buf  + pitch * (y + top_skip) + (x + left_skip);
-	UINT16  const*       zdst      = zbuf + pitch * (y + top_skip) + (x + left_skip);
-	UINT16  const* const pal       = hSrcVObject->CurrentShade();
-	UINT32               line_skip = pitch - blit_length;
-
-	for (; top_skip > 0; --top_skip)
-	{
-		for (;;)
-		{
-			UINT32 const px_count = *src++;
-			if (px_count & 0x80) continue;
-			if (px_count == 0)   break;
-			src += px_count;
-		}
-	}
-
-	UINT32 const translucent_mask = guiTranslucentMask;
-	do
-	{
-		INT32  ls_count;
-		UINT32 px_count;
-		for (ls_count = left_skip; ls_count > 0; ls_count -= px_count)
-		{
-			px_count = *src++;
-			if (px_count & 0x80)
-			{
-				px_count &= 0x7F;
-				if (px_count > ls_count)
-				{
-					px_count -= ls_count;
-					ls_count  = blit_length;
-					goto BlitTransparent;
-				}
-			}
-			else
-			{
-				if (px_count > ls_count)
-				{
-					src      += ls_count;
-					px_count -= ls_count;
-					ls_count  = blit_length;
-					goto BlitNonTransLoop;
-				}
-				src += px_count;
-			}
-		}
-
-		ls_count = blit_length;
-		while (ls_count > 0)
-		{
-			px_count = *src++;
-			if (px_count & 0x80)
-			{ // Skip transparent pixels.
-				px_count &= 0x7F;
-BlitTransparent:
-				if (px_count > ls_count) px_count = ls_count;
-				ls_count -= px_count;
-				dst      += px_count;
-				zdst     += px_count;
-			}
-			else
-			{ // Blit non-transparent pixels.
-BlitNonTransLoop:
-				UINT32 unblitted = 0;
-				if (px_count > ls_count)
-				{
-					unblitted = px_count - ls_count;
-					px_count  = ls_count;
-				}
-				ls_count -= px_count;
-
-				do
-				{
-					if (*zdst > zval) continue;
-					*dst =
-						(pal[*src] >> 1 & translucent_mask) +
-						(*dst      >> 1 & translucent_mask);
-				}
-				while (++src, ++dst, ++zdst, --px_count > 0);
-				src += unblitted;
-			}
-		}
-
-		while (*src++ != 0) {} // Skip along until we hit and end-of-line marker.
-		dst  += line_skip;
-		zdst += line_skip;
-	}
-	while (--blit_height > 0);
+	BltETRLE<true>(buf, uiDestPitchBYTES, hSrcVObject, iX, iY, usIndex, clipregion, ETRLETranslucentZPolicy<false>(zbuf, zval, hSrcVObject->CurrentShade()));
 }
 
 
@@ -171,62 +72,7 @@ Blt8BPPDataTo16BPPBufferTransZTranslucent
 **********************************************************************************************/
 void Blt8BPPDataTo16BPPBufferTransZTranslucent( UINT16* const buf, UINT32 const uiDestPitchBYTES, UINT16* const zbuf, UINT16 const zval, HVOBJECT const hSrcVObject, INT32 const iX, INT32 const iY, UINT16 const usIndex )
 {
-
-	// Assertions
-	Assert( hSrcVObject );
-	Assert( buf );
-
-	// Get Offsets from Index into structure
-	ETRLEObject const& e      = hSrcVObject->SubregionProperties(usIndex);
-	UINT32             height = e.usHeight;
-	UINT32      const  width  = e.usWidth;
-
-	// Add to start position of dest buffer
-	INT32 const x = iX + e.sOffsetX;
-	INT32 const y = iY + e.sOffsetY;
-
-	// Validations
-	CHECKV(x >= 0);
-	CHECKV(y >= 0);
-
-	UINT32 const  pitch           = uiDestPitchBYTES / 2;
-	UINT8  const* src             = hSrcVObject->PixData(e);
-	UINT16 * dst                  = buf + pitch * y + x;
-	UINT16 * zdst                 = zbuf + pitch * y + x;
-	UINT16 const* const pal       = hSrcVObject->CurrentShade();
-	UINT32 line_skip              = pitch - width;
-	UINT32 const translucent_mask = guiTranslucentMask;
-
-	do
-	{
-		for (;;)
-		{
-			UINT8 data = *src++;
-
-			if (data == 0) break;
-			if (data & 0x80)
-			{
-				data 		&= 0x7F;
-				dst 	+= data;
-				zdst	+= data;
-			}
-			else
-			{
-				do
-				{
-					if (*zdst > zval) continue;
-					*zdst = zval;
-					*dst =
-						((pal[*src] >> 1) & translucent_mask) +
-						((*dst      >> 1) & translucent_mask);
-				}
-				while (++src, ++dst, ++zdst, --data > 0);
-			}
-		}
-		dst 	+= line_skip;
-		zdst	+= line_skip;
-	}
-	while (--height > 0);
+	BltETRLE<false>(buf, uiDestPitchBYTES, hSrcVObject, iX, iY, usIndex, NULL, ETRLETranslucentZPolicy<true>(zbuf, zval, hSrcVObject->CurrentShade()));
 }
 
 
@@ -239,58 +85,7 @@ void Blt8BPPDataTo16BPPBufferTransZTranslucent( UINT16* const buf, UINT32 const
  * Blits every second pixel ("Translucents"). */
 void Blt8BPPDataTo16BPPBufferTransZNBTranslucent(UINT16* const buf, UINT32 const uiDestPitchBYTES, UINT16* const zbuf, UINT16 const zval, HVOBJECT const hSrcVObject, INT32 const iX, INT32 const iY, UINT16 const usIndex)
 {
-	Assert(hSrcVObject);
-	Assert(buf);
-
-	// Get offsets from index into structure.
-	ETRLEObject const& e      = hSrcVObject->SubregionProperties(usIndex);
-	UINT32             height = e.usHeight;
-	UINT32      const  width  = e.usWidth;
-
-	// Add to start position of dest buffer.
-	INT32 const x = iX + e.sOffsetX;
-	INT32 const y = iY + e.sOffsetY;
-
-	CHECKV(x >= 0);
-	CHECKV(y >= 0);
-
-	UINT32         const pitch     = uiDestPitchBYTES / 2;
-	UINT8   const*       src       = hSrcVObject->PixData(e);
-	UINT16*              dst       = buf  + pitch * y + x;
-	UINT16  const*       zdst      = zbuf + pitch * y + x;
-	UINT16  const* const pal       = hSrcVObject->CurrentShade();
-	UINT32               line_skip = pitch - width;
-
-	UINT32 const translucent_mask = guiTranslucentMask;
-	do
-	{
-		for (;;)
-		{
-			UINT8 data = *src++;
-
-			if (data == 0) break;
-			if (data & 0x80)
-			{
-				data &= 0x7F;
-				dst  += data;
-				zdst += data;
-			}
-			else
-			{
-				do
-				{
-					if (*zdst > zval) continue;
-					*dst =
-						((pal[*src] >> 1) & translucent_mask) +
-						((*dst      >> 1) & translucent_mask);
-				}
-				while (++src, ++dst, ++zdst, --data > 0);
-			}
-		}
-		dst  += line_skip;
-		zdst += line_skip;
-	}
-	while (--height > 0);
+	BltETRLE<false>(buf, uiDestPitchBYTES, hSrcVObject, iX, iY, usIndex, NULL, ETRLETranslucentZPolicy<false>(zbuf, zval, hSrcVObject->CurrentShade()));
 }
 
 
@@ -317,160 +112,7 @@ Blt8BPPDataTo16BPPBufferMonoShadowClip
 **********************************************************************************************/
 void Blt8BPPDataTo16BPPBufferMonoShadowClip( UINT16 *pBuffer, UINT32 uiDestPitchBYTES, HVOBJECT hSrcVObject, INT32 iX, INT32 iY, UINT16 usIndex, SGPRect *clipregion, UINT16 usForeground, UINT16 usBackground, UINT16 usShadow )
 {
-	UINT32 Unblitted;
-	UINT8  *DestPtr;
-	UINT32 LineSkip;
-	INT32  LeftSkip, RightSkip, TopSkip, BottomSkip, BlitLength, BlitHeight, LSCount;
-	INT32  ClipX1, ClipY1, ClipX2, ClipY2;
-
-	// Assertions
-	Assert( hSrcVObject != NULL );
-	Assert( pBuffer != NULL );
-
-	// Get Offsets from Index into structure
-	ETRLEObject const& pTrav = hSrcVObject->SubregionProperties(usIndex);
-	UINT32      const  usHeight = pTrav.usHeight;
-	UINT32      const  usWidth  = pTrav.usWidth;
-
-	// Add to start position of dest buffer
-	INT32 const iTempX = iX + pTrav.sOffsetX;
-	INT32 const iTempY = iY + pTrav.sOffsetY;
-
-	if(clipregion==NULL)
-	{
-		ClipX1=ClippingRect.iLeft;
-		ClipY1=ClippingRect.iTop;
-		ClipX2=ClippingRect.iRight;
-		ClipY2=ClippingRect.iBottom;
-	}
-	else
-	{
-		ClipX1=clipregion->iLeft;
-		ClipY1=clipregion->iTop;
-		ClipX2=clipregion->iRight;
-		ClipY2=clipregion->iBottom;
-	}
-
-	// Calculate rows hanging off each side of the screen
-	LeftSkip=__min(ClipX1 - MIN(ClipX1, iTempX), (INT32)usWidth);
-	RightSkip=__min(MAX(ClipX2, (iTempX+(INT32)usWidth)) - ClipX2, (INT32)usWidth);
-	TopSkip=__min(ClipY1 - __min(ClipY1, iTempY), (INT32)usHeight);
-	BottomSkip=__min(__max(ClipY2, (iTempY+(INT32)usHeight)) - ClipY2, (INT32)usHeight);
-
-	// calculate the remaining rows and columns to blit
-	BlitLength=((INT32)usWidth-LeftSkip-RightSkip);
-	BlitHeight=((INT32)usHeight-TopSkip-BottomSkip);
-
-	// check if whole thing is clipped
-	if((LeftSkip >=(INT32)usWidth) || (RightSkip >=(INT32)usWidth))
-		return;
-
-	// check if whole thing is clipped
-	if((TopSkip >=(INT32)usHeight) || (BottomSkip >=(INT32)usHeight))
-		return;
-
-	UINT8 const* SrcPtr = hSrcVObject->PixData(pTrav);
-	DestPtr = (UINT8 *)pBuffer + (uiDestPitchBYTES*(iTempY+TopSkip)) + ((iTempX+LeftSkip)*2);
-	LineSkip=(uiDestPitchBYTES-(BlitLength*2));
-
-	UINT32 PxCount;
-
-	while (TopSkip > 0)
-	{
-		for (;;)
-		{
-			PxCount = *SrcPtr++;
-			if (PxCount & 0x80) continue;
-			if (PxCount == 0) break;
-			SrcPtr += PxCount;
-		}
-		TopSkip--;
-	}
-
-	do
-	{
-		for (LSCount = LeftSkip; LSCount > 0; LSCount -= PxCount)
-		{
-			PxCount = *SrcPtr++;
-			if (PxCount & 0x80)
-			{
-				PxCount &= 0x7F;
-				if (PxCount > LSCount)
-				{
-					PxCount -= LSCount;
-					LSCount = BlitLength;
-					goto BlitTransparent;
-				}
-			}
-			else
-			{
-				if (PxCount > LSCount)
-				{
-					SrcPtr += LSCount;
-					PxCount -= LSCount;
-					LSCount = BlitLength;
-					goto BlitNonTransLoop;
-				}
-				SrcPtr += PxCount;
-			}
-		}
-
-		LSCount = BlitLength;
-		while (LSCount > 0)
-		{
-			PxCount = *SrcPtr++;
-			if (PxCount & 0x80)
-			{
-BlitTransparent: // skip transparent pixels
-				PxCount &= 0x7F;
-				if (PxCount > LSCount) PxCount = LSCount;
-				LSCount -= PxCount;
-				if (usBackground == 0)
-				{
-					DestPtr += 2 * PxCount;
-				}
-				else
-				{
-					while (PxCount-- != 0)
-					{
-						*(UINT16*)DestPtr = usBackground;
-						DestPtr += 2;
-					}
-				}
-			}
-			else
-			{
-BlitNonTransLoop: // blit non-transparent pixels
-				if (PxCount > LSCount)
-				{
-					Unblitted = PxCount - LSCount;
-					PxCount = LSCount;
-				}
-				else
-				{
-					Unblitted = 0;
-				}
-				LSCount -= PxCount;
-
-				do
-				{
-					switch (*SrcPtr++)
-					{
-						case 0:  if (usBackground != 0) *(UINT16*)DestPtr = usBackground; break;
-						case 1:  if (usShadow != 0)     *(UINT16*)DestPtr = usShadow;     break;
-						default:                        *(UINT16*)DestPtr = usForeground; break;
-					}
-					DestPtr += 2;
-				}
-				while (--PxCount > 0);
-				SrcPtr += Unblitted;
-			}
-		}
-
-		while (*SrcPtr++ != 0) {} // skip along until we hit and end-of-line marker
-		DestPtr += LineSkip;
-	}
-	while (--BlitHeight > 0);
+	BltETRLE<true>(pBuffer, uiDestPitchBYTES, hSrcVObject, iX, iY, usIndex, clipregion, ETRLEMonoShadowPolicy(usForeground, usBackground, usShadow));
 }
 
 
@@ -513,69 +155,7 @@ Blt8BPPDataTo16BPPBufferTransZPixelateObscured
 **********************************************************************************************/
 void Blt8BPPDataTo16BPPBufferTransZPixelateObscured( UINT16 *pBuffer, UINT32 uiDestPitchBYTES, UINT16 *pZBuffer, UINT16 usZValue, HVOBJECT hSrcVObject, INT32 iX, INT32 iY, UINT16 usIndex )
 {
-	UINT32 LineSkip;
-	UINT8  *DestPtr, *ZPtr;
-	UINT32 uiLineFlag;
-
-	// Assertions
-	Assert( hSrcVObject != NULL );
-	Assert( pBuffer != NULL );
-
-	// Get Offsets from Index into structure
-	ETRLEObject const& pTrav = hSrcVObject->SubregionProperties(usIndex);
-	UINT32             usHeight = pTrav.usHeight;
-	UINT32      const  usWidth  = pTrav.usWidth;
-
-	// Add to start position of dest buffer
-	INT32 const iTempX = iX + pTrav.sOffsetX;
-	INT32 const iTempY = iY + pTrav.sOffsetY;
-
-	// Validations
-	CHECKV(iTempX >= 0);
-	CHECKV(iTempY >= 0);
-
-	UINT8 const* SrcPtr = hSrcVObject->PixData(pTrav);
-	DestPtr = (UINT8 *)pBuffer + (uiDestPitchBYTES*iTempY) + (iTempX*2);
-	ZPtr = (UINT8 *)pZBuffer + (uiDestPitchBYTES*iTempY) + (iTempX*2);
-	UINT16 const* const p16BPPPalette = hSrcVObject->CurrentShade();
-	LineSkip=(uiDestPitchBYTES-(usWidth*2));
-	uiLineFlag=(iTempY&1);
-
-	do
-	{
-		for (;;)
-		{
-			UINT8 data = *SrcPtr++;
-
-			if (data == 0) break;
-			if (data & 0x80)
-			{
-				data &= 0x7F;
-				DestPtr += 2 * data;
-				ZPtr += 2 * data;
-			}
-			else
-			{
-				do
-				{
-					if (*(UINT16*)ZPtr < usZValue)
-					{
-						*(UINT16*)ZPtr = usZValue;
-					}
-					else
-					{
-						if (uiLineFlag != (((uintptr_t)DestPtr & 2) != 0)) continue;
-					}
-					*(UINT16*)DestPtr = p16BPPPalette[*SrcPtr];
-				}
-				while (SrcPtr++, DestPtr += 2, ZPtr += 2, --data > 0);
-			}
-		}
-		DestPtr += LineSkip;
-		ZPtr += LineSkip;
-		uiLineFlag ^= 1;
-	}
-	while (--usHeight > 0);
+	BltETRLE<false>(pBuffer, uiDestPitchBYTES, hSrcVObject, iX, iY, usIndex, NULL, ETRLEPixelateZPolicy<false>(pZBuffer, usZValue, hSrcVObject->CurrentShade(), 0, hSrcVObject, iY, usIndex));
 }
 
 
@@ -587,60 +167,7 @@ void Blt8BPPDataTo16BPPBufferTransZPixelateObscured( UINT16 *pBuffer, UINT32 uiD
  * dimensions (including Pitch) as the destination. */
 void Blt8BPPDataTo16BPPBufferTransZ(UINT16* const buf, UINT32 const uiDestPitchBYTES, UINT16* const zbuf, UINT16 const zval, HVOBJECT const hSrcVObject, INT32 const iX, INT32 const iY, UINT16 const usIndex)
 {
-	Assert(hSrcVObject);
-	Assert(buf);
-
-	// Get offsets from index into structure
-	ETRLEObject const& e      = hSrcVObject->SubregionProperties(usIndex);
-	UINT32             height = e.usHeight;
-	UINT32      const  width  = e.usWidth;
-
-	// Add to start position of dest buffer
-	INT32 const x = iX + e.sOffsetX;
-	INT32 const y = iY + e.sOffsetY;
-
-	// Validations
-	CHECKV(x >= 0);
-	CHECKV(y >= 0);
-
-	UINT8 const*        src       = hSrcVObject->PixData(e);
-	UINT32        const pitch     = uiDestPitchBYTES / 2;
-	UINT16*             dst       = buf  + pitch * y + x;
-	UINT16*             zdst      = zbuf + pitch * y + x;
-	UINT16 const* const pal       = hSrcVObject->CurrentShade();
-	UINT32              line_skip = pitch - width;
-
-	for (;;)
-	{
-		UINT8 data = *src++;
-		if (data == 0)
-		{
-			if (--height == 0) break;
-			dst  += line_skip;
-			zdst += line_skip;
-		}
-		else if (data & 0x80)
-		{
-			data &= 0x7F;
-			dst  += data;
-			zdst += data;
-		}
-		else
-		{
-			do
-			{
-				if (*zdst <= zval)
-				{
-					*zdst = zval;
-					*dst  = pal[*src];
-				}
-				++src;
-				++dst;
-				++zdst;
-			}
-			while (--data != 0);
-		}
-	}
+	BltETRLE<false>(buf, uiDestPitchBYTES, hSrcVObject, iX, iY, usIndex, NULL, ETRLEPaletteZPolicy<true>(zbuf, zval, hSrcVObject->CurrentShade()));
 }
 
 
@@ -656,69 +183,29 @@ Blt8BPPDataTo16BPPBufferTransZNB
 **********************************************************************************************/
 void Blt8BPPDataTo16BPPBufferTransZNB( UINT16 *pBuffer, UINT32 uiDestPitchBYTES, UINT16 *pZBuffer, UINT16 usZValue, HVOBJECT hSrcVObject, INT32 iX, INT32 iY, UINT16 usIndex )
 {
-	UINT8  *DestPtr, *ZPtr;
-	UINT32 LineSkip;
-
-	// Assertions
-	Assert( hSrcVObject != NULL );
-	Assert( pBuffer != NULL );
+	BltETRLE<false>(pBuffer, uiDestPitchBYTES, hSrcVObject, iX, iY, usIndex, NULL, ETRLEPaletteZPolicy<false>(pZBuffer, usZValue, hSrcVObject->CurrentShade()));
+}
 
-	// Get Offsets from Index into structure
-	ETRLEObject const& pTrav = hSrcVObject->SubregionProperties(usIndex);
-	UINT32             usHeight = pTrav.usHeight;
-	UINT32      const  usWidth  = pTrav.usWidth;
 
-	// Add to start position of dest buffer
-	INT32 const iTempX = iX + pTrav.sOffsetX;
-	INT32 const iTempY = iY + pTrav.sOffsetY;
+/**********************************************************************************************
+Blt8BPPDataTo16BPPBufferTransShadow
 
-	// Validations
-	CHECKV(iTempX >= 0);
-	CHECKV(iTempY >= 0);
+	Blits an image into the destination buffer, using an ETRLE brush as a source, and a 16-bit
+	buffer as a destination. As it is blitting, it checks the Z value of the ZBuffer, and if the
+	pixel's Z level is below that of the current pixel, it is written on, and the Z value is
+	updated to the current value,	for any non-transparent pixels. If the source pixel is 254,
+	it is considered a shadow, and the destination buffer is darkened rather than blitted on.
+	The Z-buffer is 16 bit, and	must be the same dimensions (including Pitch) as the destination.
 
-	UINT8 const* SrcPtr = hSrcVObject->PixData(pTrav);
-	DestPtr = (UINT8 *)pBuffer + (uiDestPitchBYTES*iTempY) + (iTempX*2);
-	ZPtr = (UINT8 *)pZBuffer + (uiDestPitchBYTES*iTempY) + (iTempX*2);
-	UINT16 const* const p16BPPPalette = hSrcVObject->CurrentShade();
-	LineSkip=(uiDestPitchBYTES-(usWidth*2));
-
-	do
-	{
-		for (;;)
-		{
-			UINT8 data = *SrcPtr++;
-
-			if (data == 0) break;
-			if (data & 0x80)
-			{
-				data &= 0x7F;
-				DestPtr += 2 * data;
-				ZPtr += 2 * data;
-			}
-			else
-			{
-				do
-				{
-					if (*(UINT16*)ZPtr <= usZValue)
-					{
-						*(UINT16*)DestPtr = p16BPPPalette[*SrcPtr];
-					}
-					SrcPtr++;
-					DestPtr += 2;
-					ZPtr += 2;
-				}
-				while (--data > 0);
-			}
-		}
-		DestPtr += LineSkip;
-		ZPtr += LineSkip;
-	}
-	while (--usHeight > 0);
-}
+**********************************************************************************************/
+void Blt8BPPDataTo16BPPBufferTransShadow(UINT16* pBuffer, UINT32 uiDestPitchBYTES, HVOBJECT hSrcVObject, INT32 iX, INT32 iY, UINT16 usIndex, const UINT16* p16BPPPalette)
+{
+	BltETRLE<false>(pBuffer, uiDestPitchBYTES, hSrcVObject, iX, iY, usIndex, NULL, ETRLETransShadowPolicy(p16BPPPalette));
+}
 
 
 /**********************************************************************************************
-Blt8BPPDataTo16BPPBufferTransShadow
+Blt8BPPDataTo16BPPBufferTransShadowZ
 
 	Blits an image into the destination buffer, using an ETRLE brush as a source, and a 16-bit
 	buffer as a destination. As it is blitting, it checks the Z value of the ZBuffer, and if the
@@ -728,152 +215,31 @@ Blt8BPPDataTo16BPPBufferTransShadow
 	The Z-buffer is 16 bit, and	must be the same dimensions (including Pitch) as the destination.
 
 **********************************************************************************************/
-void Blt8BPPDataTo16BPPBufferTransShadow(UINT16* pBuffer, UINT32 uiDestPitchBYTES, HVOBJECT hSrcVObject, INT32 iX, INT32 iY, UINT16 usIndex, const UINT16* p16BPPPalette)
+void Blt8BPPDataTo16BPPBufferTransShadowZ(UINT16* pBuffer, UINT32 uiDestPitchBYTES, UINT16* pZBuffer, UINT16 usZValue, HVOBJECT hSrcVObject, INT32 iX, INT32 iY, UINT16 usIndex, const UINT16* p16BPPPalette)
 {
-	UINT8  *DestPtr;
-	UINT32 LineSkip;
-
-	// Assertions
-	Assert( hSrcVObject != NULL );
-	Assert( pBuffer != NULL );
-
-	// Get Offsets from Index into structure
-	ETRLEObject const& pTrav = hSrcVObject->SubregionProperties(usIndex);
-	UINT32          usHeight = pTrav.usHeight;
-	UINT32   const  usWidth  = pTrav.usWidth;
-
-	// Add to start position of dest buffer
-	INT32 const iTempX = iX + pTrav.sOffsetX;
-	INT32 const iTempY = iY + pTrav.sOffsetY;
-
-	// Validations
-	CHECKV(iTempX >= 0);
-	CHECKV(iTempY >= 0);
-
-	UINT8 const* SrcPtr = hSrcVObject->PixData(pTrav);
-	DestPtr = (UINT8 *)pBuffer + (uiDestPitchBYTES*iTempY) + (iTempX*2);
-	LineSkip=(uiDestPitchBYTES-(usWidth*2));
-
-	do
-	{
-		for (;;)
-		{
-			UINT8 data = *SrcPtr++;
-
-			if (data == 0) break;
-			if (data & 0x80)
-			{
-				data &= 0x7F;
-				DestPtr += 2 * data;
-			}
-			else
-			{
-				do
-				{
-					UINT8 px = *SrcPtr++;
-
-					if (px == 254)
-					{
-						*(UINT16*)DestPtr = ShadeTable[2 * (*(UINT16*)DestPtr)];
-					}
-					else
-					{
-						*(UINT16*)DestPtr = p16BPPPalette[2 * px];
-					}
-					DestPtr += 2;
-				}
-				while (--data > 0);
-			}
-		}
-		DestPtr += LineSkip;
-	}
-	while (--usHeight > 0);
+	BltETRLE<false>(pBuffer, uiDestPitchBYTES, hSrcVObject, iX, iY, usIndex, NULL, ETRLETransShadowZPolicy<false, false>(pZBuffer, usZValue, p16BPPPalette, hSrcVObject, iY, usIndex));
 }
 
 
 /**********************************************************************************************
-Blt8BPPDataTo16BPPBufferTransShadowZ
+Blt8BPPDataTo16BPPBufferTransShadowZNB
 
 	Blits an image into the destination buffer, using an ETRLE brush as a source, and a 16-bit
 	buffer as a destination. As it is blitting, it checks the Z value of the ZBuffer, and if the
-	pixel's Z level is below that of the current pixel, it is written on, and the Z value is
-	updated to the current value,	for any non-transparent pixels. If the source pixel is 254,
-	it is considered a shadow, and the destination buffer is darkened rather than blitted on.
-	The Z-buffer is 16 bit, and	must be the same dimensions (including Pitch) as the destination.
+	pixel's Z level is below that of the current pixel, it is written on. The Z value is NOT
+	updated. If the source pixel is 254, it is considered a shadow, and the destination
+	buffer is darkened rather than blitted on. The Z-buffer is 16 bit, and must be the same
+	dimensions (including Pitch) as the destination.
 
 **********************************************************************************************/
-void Blt8BPPDataTo16BPPBufferTransShadowZ(UINT16* pBuffer, UINT32 uiDestPitchBYTES, UINT16* pZBuffer, UINT16 usZValue, HVOBJECT hSrcVObject, INT32 iX, INT32 iY, UINT16 usIndex, const UINT16* p16BPPPalette)
+void Blt8BPPDataTo16BPPBufferTransShadowZNB(UINT16* pBuffer, UINT32 uiDestPitchBYTES, UINT16* pZBuffer, UINT16 usZValue, HVOBJECT hSrcVObject, INT32 iX, INT32 iY, UINT16 usIndex, const UINT16* p16BPPPalette)
 {
-	UINT8  *DestPtr, *ZPtr;
-	UINT32 LineSkip;
-
-	// Assertions
-	Assert( hSrcVObject != NULL );
-	Assert( pBuffer != NULL );
-
-	// Get Offsets from Index into structure
-	ETRLEObject const& pTrav = hSrcVObject->SubregionProperties(usIndex);
-	UINT32          usHeight = pTrav.usHeight;
-	UINT32    const usWidth  = pTrav.usWidth;
-
-	// Add to start position of dest buffer
-	INT32 const iTempX = iX + pTrav.sOffsetX;
-	INT32 const iTempY = iY + pTrav.sOffsetY;
-
-	// Validations
-	CHECKV(iTempX >= 0);
-	CHECKV(iTempY >= 0);
-
-	UINT8 const* SrcPtr = hSrcVObject->PixData(pTrav);
-	DestPtr = (UINT8 *)pBuffer + (uiDestPitchBYTES*iTempY) + (iTempX*2);
-	ZPtr = (UINT8 *)pZBuffer + (uiDestPitchBYTES*iTempY) + (iTempX*2);
-	LineSkip=(uiDestPitchBYTES-(usWidth*2));
-
-	do
-	{
-		for (;;)
-		{
-			UINT8 data = *SrcPtr++;
-
-			if (data == 0) break;
-			if (data & 0x80)
-			{
-				data &= 0x7F;
-				DestPtr += 2 * data;
-			}
-			else
-			{
-				do
-				{
-					UINT8 px = *SrcPtr++;
-
-					if (px == 254)
-					{
-						if (*(UINT16*)ZPtr < usZValue)
-						{
-							*(UINT16*)DestPtr = ShadeTable[2 * (*(UINT16*)DestPtr)];
-						}
-					}
-					else
-					{
-						if (*(UINT16*)ZPtr <= usZValue)
-						{
-							*(UINT16*)DestPtr = p16BPPPalette[2 * px];
-						}
-					}
-					DestPtr += 2;
-				}
-				while (--data > 0);
-			}
-		}
-		DestPtr += LineSkip;
-	}
-	while (--usHeight > 0);
+	BltETRLE<false>(pBuffer, uiDestPitchBYTES, hSrcVObject, iX, iY, usIndex, NULL, ETRLETransShadowZPolicy<false, false>(pZBuffer, usZValue, p16BPPPalette, hSrcVObject, iY, usIndex));
 }
 
 
 /**********************************************************************************************
-Blt8BPPDataTo16BPPBufferTransShadowZNB
+Blt8BPPDataTo16BPPBufferTransShadowZNBObscured
 
 	Blits an image into the destination buffer, using an ETRLE brush as a source, and a 16-bit
 	buffer as a destination. As it is blitting, it checks the Z value of the ZBuffer, and if the
@@ -883,4117 +249,466 @@ Blt8BPPDataTo16BPPBufferTransShadowZNB
 	dimensions (including Pitch) as the destination.
 
 **********************************************************************************************/
-void Blt8BPPDataTo16BPPBufferTransShadowZNB(UINT16* pBuffer, UINT32 uiDestPitchBYTES, UINT16* pZBuffer, UINT16 usZValue, HVOBJECT hSrcVObject, INT32 iX, INT32 iY, UINT16 usIndex, const UINT16* p16BPPPalette)
+void Blt8BPPDataTo16BPPBufferTransShadowZNBObscured(UINT16* pBuffer, UINT32 uiDestPitchBYTES, UINT16* pZBuffer, UINT16 usZValue, HVOBJECT hSrcVObject, INT32 iX, INT32 iY, UINT16 usIndex, const UINT16* p16BPPPalette)
 {
-	UINT8  *DestPtr, *ZPtr;
-	UINT32 LineSkip;
-
-	// Assertions
-	Assert( hSrcVObject != NULL );
-	Assert( pBuffer != NULL );
+	BltETRLE<false>(pBuffer, uiDestPitchBYTES, hSrcVObject, iX, iY, usIndex, NULL, ETRLETransShadowZPolicy<false, true>(pZBuffer, usZValue, p16BPPPalette, hSrcVObject, iY, usIndex));
+}
 
-	// Get Offsets from Index into structure
-	ETRLEObject const& pTrav = hSrcVObject->SubregionProperties(usIndex);
-	UINT32             usHeight = pTrav.usHeight;
-	UINT32      const  usWidth  = pTrav.usWidth;
 
-	// Add to start position of dest buffer
-	INT32 const iTempX = iX + pTrav.sOffsetX;
-	INT32 const iTempY = iY + pTrav.sOffsetY;
+/**********************************************************************************************
+Blt8BPPDataTo16BPPBufferTransShadowZClip
 
-	// Validations
-	CHECKV(iTempX >= 0);
-	CHECKV(iTempY >= 0);
+	Blits an image into the destination buffer, using an ETRLE brush as a source, and a 16-bit
+	buffer as a destination. As it is blitting, it checks the Z value of the ZBuffer, and if the
+	pixel's Z level is below that of the current pixel, it is written on, and the Z value is
+	updated to the current value,	for any non-transparent pixels. The Z-buffer is 16 bit, and
+	must be the same dimensions (including Pitch) as the destination. Pixels with a value of
+	254 are shaded instead of blitted.
 
-	UINT8 const* SrcPtr = hSrcVObject->PixData(pTrav);
-	DestPtr = (UINT8 *)pBuffer + (uiDestPitchBYTES*iTempY) + (iTempX*2);
-	ZPtr = (UINT8 *)pZBuffer + (uiDestPitchBYTES*iTempY) + (iTempX*2);
-	LineSkip=(uiDestPitchBYTES-(usWidth*2));
+**********************************************************************************************/
+void Blt8BPPDataTo16BPPBufferTransShadowZClip(UINT16* pBuffer, UINT32 uiDestPitchBYTES, UINT16* pZBuffer, UINT16 usZValue, HVOBJECT hSrcVObject, INT32 iX, INT32 iY, UINT16 usIndex, SGPRect* clipregion, const UINT16* p16BPPPalette)
+{
+	BltETRLE<true>(pBuffer, uiDestPitchBYTES, hSrcVObject, iX, iY, usIndex, clipregion, ETRLETransShadowZPolicy<true, false>(pZBuffer, usZValue, p16BPPPalette, hSrcVObject, iY, usIndex));
+}
 
-	do
-	{
-		for (;;)
-		{
-			UINT8 data = *SrcPtr++;
+/**********************************************************************************************
+Blt8BPPDataTo16BPPBufferTransShadowClip
 
-			if (data == 0) break;
-			if (data & 0x80)
-			{
-				data &= 0x7F;
-				DestPtr += 2 * data;
-				ZPtr += 2 * data;
-			}
-			else
-			{
-				do
-				{
-					UINT8 px = *SrcPtr++;
+	Blits an image into the destination buffer, using an ETRLE brush as a source, and a 16-bit
+	buffer as a destination. As it is blitting, it checks the Z value of the ZBuffer, and if the
+	pixel's Z level is below that of the current pixel, it is written on, and the Z value is
+	updated to the current value,	for any non-transparent pixels. The Z-buffer is 16 bit, and
+	must be the same dimensions (including Pitch) as the destination. Pixels with a value of
+	254 are shaded instead of blitted.
 
-					if (px == 254)
-					{
-						if (*(UINT16*)ZPtr < usZValue)
-						{
-							*(UINT16*)DestPtr = ShadeTable[*(UINT16*)DestPtr];
-						}
-					}
-					else
-					{
-						if (*(UINT16*)ZPtr <= usZValue)
-						{
-							*(UINT16*)DestPtr = p16BPPPalette[px];
-						}
-					}
-					DestPtr += 2;
-					ZPtr += 2;
-				}
-				while (--data > 0);
-			}
-		}
-		DestPtr += LineSkip;
-		ZPtr += LineSkip;
-	}
-	while (--usHeight > 0);
+**********************************************************************************************/
+void Blt8BPPDataTo16BPPBufferTransShadowClip(UINT16* pBuffer, UINT32 uiDestPitchBYTES, HVOBJECT hSrcVObject, INT32 iX, INT32 iY, UINT16 usIndex, SGPRect* clipregion, const UINT16* p16BPPPalette)
+{
+	BltETRLE<true>(pBuffer, uiDestPitchBYTES, hSrcVObject, iX, iY, usIndex, clipregion, ETRLETransShadowPolicy(p16BPPPalette));
 }
 
-
 /**********************************************************************************************
-Blt8BPPDataTo16BPPBufferTransShadowZNBObscured
+Blt8BPPDataTo16BPPBufferTransShadowZNBClip
 
 	Blits an image into the destination buffer, using an ETRLE brush as a source, and a 16-bit
 	buffer as a destination. As it is blitting, it checks the Z value of the ZBuffer, and if the
-	pixel's Z level is below that of the current pixel, it is written on. The Z value is NOT
-	updated. If the source pixel is 254, it is considered a shadow, and the destination
-	buffer is darkened rather than blitted on. The Z-buffer is 16 bit, and must be the same
-	dimensions (including Pitch) as the destination.
+	pixel's Z level is below that of the current pixel, it is written on.
+	The Z-buffer is 16 bit, and	must be the same dimensions (including Pitch) as the
+	destination. Pixels with a value of	254 are shaded instead of blitted. The Z buffer is
+	NOT updated.
 
 **********************************************************************************************/
-void Blt8BPPDataTo16BPPBufferTransShadowZNBObscured(UINT16* pBuffer, UINT32 uiDestPitchBYTES, UINT16* pZBuffer, UINT16 usZValue, HVOBJECT hSrcVObject, INT32 iX, INT32 iY, UINT16 usIndex, const UINT16* p16BPPPalette)
+void Blt8BPPDataTo16BPPBufferTransShadowZNBClip(UINT16* pBuffer, UINT32 uiDestPitchBYTES, UINT16* pZBuffer, UINT16 usZValue, HVOBJECT hSrcVObject, INT32 iX, INT32 iY, UINT16 usIndex, SGPRect* clipregion, const UINT16* p16BPPPalette)
 {
-	UINT8  *DestPtr, *ZPtr;
-	UINT32 LineSkip;
-	UINT32 uiLineFlag;
+	BltETRLE<true>(pBuffer, uiDestPitchBYTES, hSrcVObject, iX, iY, usIndex, clipregion, ETRLETransShadowZPolicy<false, false>(pZBuffer, usZValue, p16BPPPalette, hSrcVObject, iY, usIndex));
+}
 
-	// Assertions
-	Assert( hSrcVObject != NULL );
-	Assert( pBuffer != NULL );
 
-	// Get Offsets from Index into structure
-	ETRLEObject const& pTrav = hSrcVObject->SubregionProperties(usIndex);
-	UINT32             usHeight = pTrav.usHeight;
-	UINT32      const  usWidth  = pTrav.usWidth;
+/**********************************************************************************************
+Blt8BPPDataTo16BPPBufferTransShadowZNBClip
 
-	// Add to start position of dest buffer
-	INT32 const iTempX = iX + pTrav.sOffsetX;
-	INT32 const iTempY = iY + pTrav.sOffsetY;
+	Blits an image into the destination buffer, using an ETRLE brush as a source, and a 16-bit
+	buffer as a destination. As it is blitting, it checks the Z value of the ZBuffer, and if the
+	pixel's Z level is below that of the current pixel, it is written on.
+	The Z-buffer is 16 bit, and	must be the same dimensions (including Pitch) as the
+	destination. Pixels with a value of	254 are shaded instead of blitted. The Z buffer is
+	NOT updated.
 
-	// Validations
-	CHECKV(iTempX >= 0);
-	CHECKV(iTempY >= 0);
+**********************************************************************************************/
+void Blt8BPPDataTo16BPPBufferTransShadowZNBObscuredClip(UINT16* pBuffer, UINT32 uiDestPitchBYTES, UINT16* pZBuffer, UINT16 usZValue, HVOBJECT hSrcVObject, INT32 iX, INT32 iY, UINT16 usIndex, SGPRect* clipregion, const UINT16* p16BPPPalette)
+{
+	BltETRLE<true>(pBuffer, uiDestPitchBYTES, hSrcVObject, iX, iY, usIndex, clipregion, ETRLETransShadowZPolicy<false, true>(pZBuffer, usZValue, p16BPPPalette, hSrcVObject, iY, usIndex));
+}
 
-	UINT8 const* SrcPtr = hSrcVObject->PixData(pTrav);
-	DestPtr = (UINT8 *)pBuffer + (uiDestPitchBYTES*iTempY) + (iTempX*2);
-	ZPtr = (UINT8 *)pZBuffer + (uiDestPitchBYTES*iTempY) + (iTempX*2);
-	LineSkip=(uiDestPitchBYTES-(usWidth*2));
-	uiLineFlag=(iTempY&1);
 
-	do
-	{
-		for (;;)
-		{
-			UINT8 data = *SrcPtr++;
+/**********************************************************************************************
+Blt8BPPDataTo16BPPBufferShadowZ
 
-			if (data == 0) break;
-			if (data & 0x80)
-			{
-				data &= 0x7F;
-				DestPtr += 2 * data;
-				ZPtr += 2 * data;
-			}
-			else
-			{
-				do
-				{
-					UINT8 px = *SrcPtr++;
+	Creates a shadow using a brush, but modifies the destination buffer only if the current
+	Z level is equal to higher than what's in the Z buffer at that pixel location. It
+	updates the Z buffer with the new Z level.
 
-					if (px == 254)
-					{
-						if (*(UINT16*)ZPtr < usZValue)
-						{
-							*(UINT16*)DestPtr = ShadeTable[*(UINT16*)DestPtr];
-						}
-					}
-					else
-					{
-						if (*(UINT16*)ZPtr <= usZValue ||
-								uiLineFlag == (((uintptr_t)DestPtr & 2) != 0)) // XXX ugly, can be done better by just examining every other pixel
-						{
-							*(UINT16*)DestPtr = p16BPPPalette[px];
-						}
-					}
-					DestPtr += 2;
-					ZPtr += 2;
-				}
-				while (--data > 0);
-			}
-		}
-		DestPtr += LineSkip;
-		ZPtr += LineSkip;
-		uiLineFlag ^= 1;
-	}
-	while (--usHeight > 0);
+**********************************************************************************************/
+void Blt8BPPDataTo16BPPBufferShadowZ( UINT16 *pBuffer, UINT32 uiDestPitchBYTES, UINT16 *pZBuffer, UINT16 usZValue, HVOBJECT hSrcVObject, INT32 iX, INT32 iY, UINT16 usIndex )
+{
+	BltETRLE<false>(pBuffer, uiDestPitchBYTES, hSrcVObject, iX, iY, usIndex, NULL, ETRLEShadeZPolicy<true>(pZBuffer, usZValue));
 }
 
 
 /**********************************************************************************************
-Blt8BPPDataTo16BPPBufferTransShadowZClip
+Blt8BPPDataTo16BPPBufferShadowZClip
 
 	Blits an image into the destination buffer, using an ETRLE brush as a source, and a 16-bit
 	buffer as a destination. As it is blitting, it checks the Z value of the ZBuffer, and if the
 	pixel's Z level is below that of the current pixel, it is written on, and the Z value is
 	updated to the current value,	for any non-transparent pixels. The Z-buffer is 16 bit, and
-	must be the same dimensions (including Pitch) as the destination. Pixels with a value of
-	254 are shaded instead of blitted.
+	must be the same dimensions (including Pitch) as the destination.
 
 **********************************************************************************************/
-void Blt8BPPDataTo16BPPBufferTransShadowZClip(UINT16* pBuffer, UINT32 uiDestPitchBYTES, UINT16* pZBuffer, UINT16 usZValue, HVOBJECT hSrcVObject, INT32 iX, INT32 iY, UINT16 usIndex, SGPRect* clipregion, const UINT16* p16BPPPalette)
+void Blt8BPPDataTo16BPPBufferShadowZClip( UINT16 *pBuffer, UINT32 uiDestPitchBYTES, UINT16 *pZBuffer, UINT16 usZValue, HVOBJECT hSrcVObject, INT32 iX, INT32 iY, UINT16 usIndex, SGPRect *clipregion)
 {
-	UINT8  *DestPtr, *ZPtr;
-	UINT32 LineSkip;
-	INT32  LeftSkip, RightSkip, TopSkip, BottomSkip, BlitLength, BlitHeight;
-	INT32  ClipX1, ClipY1, ClipX2, ClipY2;
+	BltETRLE<true>(pBuffer, uiDestPitchBYTES, hSrcVObject, iX, iY, usIndex, clipregion, ETRLEShadeZPolicy<true>(pZBuffer, usZValue));
+}
 
-	// Assertions
-	Assert( hSrcVObject != NULL );
-	Assert( pBuffer != NULL );
 
-	// Get Offsets from Index into structure
-	ETRLEObject const& pTrav = hSrcVObject->SubregionProperties(usIndex);
-	UINT32      const  usHeight = pTrav.usHeight;
-	UINT32      const  usWidth  = pTrav.usWidth;
+/**********************************************************************************************
+Blt8BPPDataTo16BPPBufferShadowZNB
 
-	// Add to start position of dest buffer
-	INT32 const iTempX = iX + pTrav.sOffsetX;
-	INT32 const iTempY = iY + pTrav.sOffsetY;
+	Creates a shadow using a brush, but modifies the destination buffer only if the current
+	Z level is equal to higher than what's in the Z buffer at that pixel location. It does
+	NOT update the Z buffer with the new Z value.
 
-	if(clipregion==NULL)
-	{
-		ClipX1=ClippingRect.iLeft;
-		ClipY1=ClippingRect.iTop;
-		ClipX2=ClippingRect.iRight;
-		ClipY2=ClippingRect.iBottom;
-	}
-	else
-	{
-		ClipX1=clipregion->iLeft;
-		ClipY1=clipregion->iTop;
-		ClipX2=clipregion->iRight;
-		ClipY2=clipregion->iBottom;
-	}
-
-	// Calculate rows hanging off each side of the screen
-	LeftSkip=__min(ClipX1 - MIN(ClipX1, iTempX), (INT32)usWidth);
-	RightSkip=__min(MAX(ClipX2, (iTempX+(INT32)usWidth)) - ClipX2, (INT32)usWidth);
-	TopSkip=__min(ClipY1 - __min(ClipY1, iTempY), (INT32)usHeight);
-	BottomSkip=__min(__max(ClipY2, (iTempY+(INT32)usHeight)) - ClipY2, (INT32)usHeight);
-
-	// calculate the remaining rows and columns to blit
-	BlitLength=((INT32)usWidth-LeftSkip-RightSkip);
-	BlitHeight=((INT32)usHeight-TopSkip-BottomSkip);
-
-	// check if whole thing is clipped
-	if((LeftSkip >=(INT32)usWidth) || (RightSkip >=(INT32)usWidth))
-		return;
-
-	// check if whole thing is clipped
-	if((TopSkip >=(INT32)usHeight) || (BottomSkip >=(INT32)usHeight))
-		return;
-
-	UINT8 const* SrcPtr = hSrcVObject->PixData(pTrav);
-	DestPtr = (UINT8 *)pBuffer + (uiDestPitchBYTES*(iTempY+TopSkip)) + ((iTempX+LeftSkip)*2);
-	ZPtr = (UINT8 *)pZBuffer + (uiDestPitchBYTES*(iTempY+TopSkip)) + ((iTempX+LeftSkip)*2);
-	LineSkip=(uiDestPitchBYTES-(BlitLength*2));
-
-	UINT8 PxCount, px;
-	UINT32 Unblitted, LSCount;
-
-
-	while (TopSkip)
-	{
-		px = *SrcPtr++;
-		if (px & 0x80)  continue;
-		if (px)
-		{
-			SrcPtr += px;
-			continue;
-		}
-		TopSkip--;
-	}
-
-	do
-	{
-		Unblitted = 0;
-		for (LSCount = LeftSkip; LSCount > 0; LSCount -= PxCount)
-		{
-			PxCount = *SrcPtr++;
-			if (PxCount & 0x80)
-			{
-				PxCount &= 0x7F;
-				if (PxCount > LSCount)
-				{
-					PxCount -= LSCount;
-					LSCount = BlitLength;
-					Unblitted = 0;
-					goto BlitTransparent;
-				}
-			}
-			else
-			{
-				if (px > LSCount)
-				{
-					SrcPtr += LSCount;
-					PxCount -= LSCount;
-					LSCount = BlitLength;
-					Unblitted = 0;
-					goto BlitNonTransLoop;
-				}
-				SrcPtr += PxCount;
-			}
-		}
-
-		LSCount = BlitLength;
-		Unblitted = 0;
-		while (LSCount > 0)
-		{
-			PxCount = *SrcPtr++;
-			if (PxCount & 0x80)
-			{
-BlitTransparent: // skip transparent pixels
-				PxCount &= 0x7f;
-				if (PxCount > LSCount)
-					PxCount = LSCount;
-
-				LSCount -= PxCount;
-				DestPtr += 2 * PxCount;
-				ZPtr    += 2 * PxCount;
-			}
-			else
-			{
-BlitNonTransLoop: // blit non-transparent pixels
-				if (PxCount > LSCount)
-				{
-					PxCount -= LSCount;
-					Unblitted = PxCount;
-					PxCount = LSCount;
-				}
-				LSCount -= PxCount;
-
-				do
-				{
-					if (*ZPtr < usZValue )
-					{
-						*ZPtr = usZValue;
-						px = *SrcPtr++;
-						if (px != 254)
-							*(UINT16*)DestPtr = p16BPPPalette[px];
-						else
-							*(UINT16*)DestPtr = ShadeTable[*(UINT16*)DestPtr];
-					}
-
-					DestPtr += 2;
-					ZPtr += 2;
-				}
-				while ( --px > 0 );
-				SrcPtr += Unblitted;
-			}
-		}
-		while (*SrcPtr++ != 0);
-		DestPtr += LineSkip;
-		ZPtr += LineSkip;
-	}
-	while ( --BlitHeight > 0 );
-}
-
-/**********************************************************************************************
-Blt8BPPDataTo16BPPBufferTransShadowClip
-
-	Blits an image into the destination buffer, using an ETRLE brush as a source, and a 16-bit
-	buffer as a destination. As it is blitting, it checks the Z value of the ZBuffer, and if the
-	pixel's Z level is below that of the current pixel, it is written on, and the Z value is
-	updated to the current value,	for any non-transparent pixels. The Z-buffer is 16 bit, and
-	must be the same dimensions (including Pitch) as the destination. Pixels with a value of
-	254 are shaded instead of blitted.
-
-**********************************************************************************************/
-void Blt8BPPDataTo16BPPBufferTransShadowClip(UINT16* pBuffer, UINT32 uiDestPitchBYTES, HVOBJECT hSrcVObject, INT32 iX, INT32 iY, UINT16 usIndex, SGPRect* clipregion, const UINT16* p16BPPPalette)
-{
-	UINT8  *DestPtr;
-	UINT32 LineSkip;
-	INT32  LeftSkip, RightSkip, TopSkip, BottomSkip, BlitLength, BlitHeight;
-	INT32  ClipX1, ClipY1, ClipX2, ClipY2;
-
-	// Assertions
-	Assert( hSrcVObject != NULL );
-	Assert( pBuffer != NULL );
-
-	// Get Offsets from Index into structure
-	ETRLEObject const& pTrav = hSrcVObject->SubregionProperties(usIndex);
-	UINT32      const  usHeight = pTrav.usHeight;
-	UINT32      const  usWidth  = pTrav.usWidth;
-
-	// Add to start position of dest buffer
-	INT32 const iTempX = iX + pTrav.sOffsetX;
-	INT32 const iTempY = iY + pTrav.sOffsetY;
-
-	if(clipregion==NULL)
-	{
-		ClipX1=ClippingRect.iLeft;
-		ClipY1=ClippingRect.iTop;
-		ClipX2=ClippingRect.iRight;
-		ClipY2=ClippingRect.iBottom;
-	}
-	else
-	{
-		ClipX1=clipregion->iLeft;
-		ClipY1=clipregion->iTop;
-		ClipX2=clipregion->iRight;
-		ClipY2=clipregion->iBottom;
-	}
-
-	// Calculate rows hanging off each side of the screen
-	LeftSkip=__min(ClipX1 - MIN(ClipX1, iTempX), (INT32)usWidth);
-	RightSkip=__min(MAX(ClipX2, (iTempX+(INT32)usWidth)) - ClipX2, (INT32)usWidth);
-	TopSkip=__min(ClipY1 - __min(ClipY1, iTempY), (INT32)usHeight);
-	BottomSkip=__min(__max(ClipY2, (iTempY+(INT32)usHeight)) - ClipY2, (INT32)usHeight);
-
-	// calculate the remaining rows and columns to blit
-	BlitLength=((INT32)usWidth-LeftSkip-RightSkip);
-	BlitHeight=((INT32)usHeight-TopSkip-BottomSkip);
-
-	// check if whole thing is clipped
-	if((LeftSkip >=(INT32)usWidth) || (RightSkip >=(INT32)usWidth))
-		return;
-
-	// check if whole thing is clipped
-	if((TopSkip >=(INT32)usHeight) || (BottomSkip >=(INT32)usHeight))
-		return;
-
-	UINT8 const* SrcPtr = hSrcVObject->PixData(pTrav);
-	DestPtr = (UINT8 *)pBuffer + (uiDestPitchBYTES*(iTempY+TopSkip)) + ((iTempX+LeftSkip)*2);
-	LineSkip=(uiDestPitchBYTES-(BlitLength*2));
-
-	UINT8 px, PxCount;
-	UINT32 Unblitted;
-	INT32 LSCount;
-
-	while (TopSkip)
-	{
-		px = *SrcPtr++;
-		if (px & 0x80)  continue;
-		if (px)
-		{
-			SrcPtr += px;
-			continue;
-		}
-		TopSkip--;
-	}
-
-	do
-	{
-		Unblitted = 0;
-		for (LSCount = LeftSkip; LSCount > 0; LSCount -= PxCount)
-		{
-			PxCount = *SrcPtr++;
-			if (PxCount & 0x80)
-			{
-				PxCount &= 0x7F;
-				if (PxCount > LSCount)
-				{
-					PxCount -= LSCount;
-					LSCount = BlitLength;
-					Unblitted = 0;
-					goto BlitTransparent;
-				}
-			}
-			else
-			{
-				if (px > LSCount)
-				{
-					SrcPtr += LSCount;
-					PxCount -= LSCount;
-					LSCount = BlitLength;
-					Unblitted = 0;
-					goto BlitNonTransLoop;
-				}
-				SrcPtr += PxCount;
-			}
-		}
-
-		LSCount = BlitLength;
-		Unblitted = 0;
-		while (LSCount > 0)
-		{
-			PxCount = *SrcPtr++;
-			if (PxCount & 0x80)
-			{
-BlitTransparent: // skip transparent pixels
-				PxCount &= 0x7f;
-				if (PxCount > LSCount)
-					PxCount = LSCount;
-
-				LSCount -= PxCount;
-				DestPtr += 2 * PxCount;
-			}
-			else
-			{
-BlitNonTransLoop: // blit non-transparent pixels
-				if (PxCount > LSCount)
-				{
-					PxCount -= LSCount;
-					Unblitted = PxCount;
-					PxCount = LSCount;
-				}
-				LSCount -= PxCount;
-
-				do
-				{
-					px = *SrcPtr++;
-					if (px != 254)
-						*(UINT16*)DestPtr = p16BPPPalette[px];
-					else
-						*(UINT16*)DestPtr = ShadeTable[*(UINT16*)DestPtr];
-					DestPtr += 2;
-				}
-				while ( --px > 0 );
-				SrcPtr += Unblitted;
-			}
-		}
-		while (*SrcPtr++ != 0);
-		DestPtr += LineSkip;
-	}
-	while ( --BlitHeight > 0 );
-}
-
-/**********************************************************************************************
-Blt8BPPDataTo16BPPBufferTransShadowZNBClip
-
-	Blits an image into the destination buffer, using an ETRLE brush as a source, and a 16-bit
-	buffer as a destination. As it is blitting, it checks the Z value of the ZBuffer, and if the
-	pixel's Z level is below that of the current pixel, it is written on.
-	The Z-buffer is 16 bit, and	must be the same dimensions (including Pitch) as the
-	destination. Pixels with a value of	254 are shaded instead of blitted. The Z buffer is
-	NOT updated.
-
-**********************************************************************************************/
-void Blt8BPPDataTo16BPPBufferTransShadowZNBClip(UINT16* pBuffer, UINT32 uiDestPitchBYTES, UINT16* pZBuffer, UINT16 usZValue, HVOBJECT hSrcVObject, INT32 iX, INT32 iY, UINT16 usIndex, SGPRect* clipregion, const UINT16* p16BPPPalette)
-{
-	UINT32 Unblitted;
-	UINT8  *DestPtr, *ZPtr;
-	UINT32 LineSkip;
-	INT32  LeftSkip, RightSkip, TopSkip, BottomSkip, BlitLength, BlitHeight, LSCount;
-	INT32  ClipX1, ClipY1, ClipX2, ClipY2;
-
-	// Assertions
-	Assert( hSrcVObject != NULL );
-	Assert( pBuffer != NULL );
-
-	// Get Offsets from Index into structure
-	ETRLEObject const& pTrav = hSrcVObject->SubregionProperties(usIndex);
-	UINT32      const  usHeight = pTrav.usHeight;
-	UINT32      const  usWidth  = pTrav.usWidth;
-
-	// Add to start position of dest buffer
-	INT32 const iTempX = iX + pTrav.sOffsetX;
-	INT32 const iTempY = iY + pTrav.sOffsetY;
-
-	if(clipregion==NULL)
-	{
-		ClipX1=ClippingRect.iLeft;
-		ClipY1=ClippingRect.iTop;
-		ClipX2=ClippingRect.iRight;
-		ClipY2=ClippingRect.iBottom;
-	}
-	else
-	{
-		ClipX1=clipregion->iLeft;
-		ClipY1=clipregion->iTop;
-		ClipX2=clipregion->iRight;
-		ClipY2=clipregion->iBottom;
-	}
-
-	// Calculate rows hanging off each side of the screen
-	LeftSkip=__min(ClipX1 - MIN(ClipX1, iTempX), (INT32)usWidth);
-	RightSkip=__min(MAX(ClipX2, (iTempX+(INT32)usWidth)) - ClipX2, (INT32)usWidth);
-	TopSkip=__min(ClipY1 - __min(ClipY1, iTempY), (INT32)usHeight);
-	BottomSkip=__min(__max(ClipY2, (iTempY+(INT32)usHeight)) - ClipY2, (INT32)usHeight);
-
-	// calculate the remaining rows and columns to blit
-	BlitLength=((INT32)usWidth-LeftSkip-RightSkip);
-	BlitHeight=((INT32)usHeight-TopSkip-BottomSkip);
-
-	// check if whole thing is clipped
-	if((LeftSkip >=(INT32)usWidth) || (RightSkip >=(INT32)usWidth))
-		return;
-
-	// check if whole thing is clipped
-	if((TopSkip >=(INT32)usHeight) || (BottomSkip >=(INT32)usHeight))
-		return;
-
-	UINT8 const* SrcPtr = hSrcVObject->PixData(pTrav);
-	DestPtr = (UINT8 *)pBuffer + (uiDestPitchBYTES*(iTempY+TopSkip)) + ((iTempX+LeftSkip)*2);
-	ZPtr = (UINT8 *)pZBuffer + (uiDestPitchBYTES*(iTempY+TopSkip)) + ((iTempX+LeftSkip)*2);
-	LineSkip=(uiDestPitchBYTES-(BlitLength*2));
-
-	UINT32 PxCount;
-
-	while (TopSkip > 0)
-	{
-		for (;;)
-		{
-			PxCount = *SrcPtr++;
-			if (PxCount & 0x80) continue;
-			if (PxCount == 0) break;
-			SrcPtr += PxCount;
-		}
-		TopSkip--;
-	}
-
-	do
-	{
-		for (LSCount = LeftSkip; LSCount > 0; LSCount -= PxCount)
-		{
-			PxCount = *SrcPtr++;
-			if (PxCount & 0x80)
-			{
-				PxCount &= 0x7F;
-				if (PxCount > LSCount)
-				{
-					PxCount -= LSCount;
-					LSCount = BlitLength;
-					goto BlitTransparent;
-				}
-			}
-			else
-			{
-				if (PxCount > LSCount)
-				{
-					SrcPtr += LSCount;
-					PxCount -= LSCount;
-					LSCount = BlitLength;
-					goto BlitNonTransLoop;
-				}
-				SrcPtr += PxCount;
-			}
-		}
-
-		LSCount = BlitLength;
-		while (LSCount > 0)
-		{
-			PxCount = *SrcPtr++;
-			if (PxCount & 0x80)
-			{
-BlitTransparent: // skip transparent pixels
-				PxCount &= 0x7F;
-				if (PxCount > LSCount) PxCount = LSCount;
-				LSCount -= PxCount;
-				DestPtr += 2 * PxCount;
-				ZPtr    += 2 * PxCount;
-			}
-			else
-			{
-BlitNonTransLoop: // blit non-transparent pixels
-				if (PxCount > LSCount)
-				{
-					Unblitted = PxCount - LSCount;
-					PxCount = LSCount;
-				}
-				else
-				{
-					Unblitted = 0;
-				}
-				LSCount -= PxCount;
-
-				do
-				{
-					UINT8 px = *SrcPtr++;
-
-					if (px == 254)
-					{
-						if (*(UINT16*)ZPtr < usZValue)
-						{
-							*(UINT16*)DestPtr = ShadeTable[*(UINT16*)DestPtr];
-						}
-					}
-					else
-					{
-						if (*(UINT16*)ZPtr <= usZValue)
-						{
-							*(UINT16*)DestPtr = p16BPPPalette[px];
-						}
-					}
-					DestPtr += 2;
-					ZPtr += 2;
-				}
-				while (--PxCount > 0);
-				SrcPtr += Unblitted;
-			}
-		}
-
-		while (*SrcPtr++ != 0) {} // skip along until we hit and end-of-line marker
-		DestPtr += LineSkip;
-		ZPtr += LineSkip;
-	}
-	while (--BlitHeight > 0);
-}
-
-
-/**********************************************************************************************
-Blt8BPPDataTo16BPPBufferTransShadowZNBClip
-
-	Blits an image into the destination buffer, using an ETRLE brush as a source, and a 16-bit
-	buffer as a destination. As it is blitting, it checks the Z value of the ZBuffer, and if the
-	pixel's Z level is below that of the current pixel, it is written on.
-	The Z-buffer is 16 bit, and	must be the same dimensions (including Pitch) as the
-	destination. Pixels with a value of	254 are shaded instead of blitted. The Z buffer is
-	NOT updated.
-
-**********************************************************************************************/
-void Blt8BPPDataTo16BPPBufferTransShadowZNBObscuredClip(UINT16* pBuffer, UINT32 uiDestPitchBYTES, UINT16* pZBuffer, UINT16 usZValue, HVOBJECT hSrcVObject, INT32 iX, INT32 iY, UINT16 usIndex, SGPRect* clipregion, const UINT16* p16BPPPalette)
-{
-	UINT32 Unblitted, uiLineFlag;
-	UINT8  *DestPtr, *ZPtr;
-	UINT32 LineSkip;
-	INT32  LeftSkip, RightSkip, TopSkip, BottomSkip, BlitLength, BlitHeight, LSCount;
-	INT32  ClipX1, ClipY1, ClipX2, ClipY2;
-
-	// Assertions
-	Assert( hSrcVObject != NULL );
-	Assert( pBuffer != NULL );
-
-	// Get Offsets from Index into structure
-	ETRLEObject const& pTrav = hSrcVObject->SubregionProperties(usIndex);
-	UINT32      const  usHeight = pTrav.usHeight;
-	UINT32      const  usWidth  = pTrav.usWidth;
-
-	// Add to start position of dest buffer
-	INT32 const iTempX = iX + pTrav.sOffsetX;
-	INT32 const iTempY = iY + pTrav.sOffsetY;
-
-	if(clipregion==NULL)
-	{
-		ClipX1=ClippingRect.iLeft;
-		ClipY1=ClippingRect.iTop;
-		ClipX2=ClippingRect.iRight;
-		ClipY2=ClippingRect.iBottom;
-	}
-	else
-	{
-		ClipX1=clipregion->iLeft;
-		ClipY1=clipregion->iTop;
-		ClipX2=clipregion->iRight;
-		ClipY2=clipregion->iBottom;
-	}
-
-	// Calculate rows hanging off each side of the screen
-	LeftSkip=__min(ClipX1 - MIN(ClipX1, iTempX), (INT32)usWidth);
-	RightSkip=__min(MAX(ClipX2, (iTempX+(INT32)usWidth)) - ClipX2, (INT32)usWidth);
-	TopSkip=__min(ClipY1 - __min(ClipY1, iTempY), (INT32)usHeight);
-	BottomSkip=__min(__max(ClipY2, (iTempY+(INT32)usHeight)) - ClipY2, (INT32)usHeight);
-
-	// calculate the remaining rows and columns to blit
-	BlitLength=((INT32)usWidth-LeftSkip-RightSkip);
-	BlitHeight=((INT32)usHeight-TopSkip-BottomSkip);
-
-	// check if whole thing is clipped
-	if((LeftSkip >=(INT32)usWidth) || (RightSkip >=(INT32)usWidth))
-		return;
-
-	// check if whole thing is clipped
-	if((TopSkip >=(INT32)usHeight) || (BottomSkip >=(INT32)usHeight))
-		return;
-
-	UINT8 const* SrcPtr = hSrcVObject->PixData(pTrav);
-	DestPtr = (UINT8 *)pBuffer + (uiDestPitchBYTES*(iTempY+TopSkip)) + ((iTempX+LeftSkip)*2);
-	ZPtr = (UINT8 *)pZBuffer + (uiDestPitchBYTES*(iTempY+TopSkip)) + ((iTempX+LeftSkip)*2);
-	LineSkip=(uiDestPitchBYTES-(BlitLength*2));
-
-	uiLineFlag = (iTempY + TopSkip) & 1;
-
-	UINT32 PxCount;
-
-	while (TopSkip > 0)
-	{
-		for (;;)
-		{
-			PxCount = *SrcPtr++;
-			if (PxCount & 0x80) continue;
-			if (PxCount == 0) break;
-			SrcPtr += PxCount;
-		}
-		TopSkip--;
-	}
-
-	do
-	{
-		for (LSCount = LeftSkip; LSCount > 0; LSCount -= PxCount)
-		{
-			PxCount = *SrcPtr++;
-			if (PxCount & 0x80)
-			{
-				PxCount &= 0x7F;
-				if (PxCount > LSCount)
-				{
-					PxCount -= LSCount;
-					LSCount = BlitLength;
-					goto BlitTransparent;
-				}
-			}
-			else
-			{
-				if (PxCount > LSCount)
-				{
-					SrcPtr += LSCount;
-					PxCount -= LSCount;
-					LSCount = BlitLength;
-					goto BlitNonTransLoop;
-				}
-				SrcPtr += PxCount;
-			}
-		}
-
-		LSCount = BlitLength;
-		while (LSCount > 0)
-		{
-			PxCount = *SrcPtr++;
-			if (PxCount & 0x80)
-			{
-BlitTransparent: // skip transparent pixels
-				PxCount &= 0x7F;
-				if (PxCount > LSCount) PxCount = LSCount;
-				LSCount -= PxCount;
-				DestPtr += 2 * PxCount;
-				ZPtr    += 2 * PxCount;
-			}
-			else
-			{
-BlitNonTransLoop: // blit non-transparent pixels
-				if (PxCount > LSCount)
-				{
-					Unblitted = PxCount - LSCount;
-					PxCount = LSCount;
-				}
-				else
-				{
-					Unblitted = 0;
-				}
-				LSCount -= PxCount;
-
-				do
-				{
-					UINT8 px = *SrcPtr++;
-
-					if (px == 254)
-					{
-						if (*(UINT16*)ZPtr < usZValue)
-						{
-							*(UINT16*)DestPtr = ShadeTable[*(UINT16*)DestPtr];
-						}
-					}
-					else
-					{
-						if (*(UINT16*)ZPtr <= usZValue ||
-								uiLineFlag == (((uintptr_t)DestPtr & 2) != 0)) // XXX ugly, can be done better by just examining every other pixel
-						{
-							*(UINT16*)DestPtr = p16BPPPalette[px];
-						}
-					}
-					DestPtr += 2;
-					ZPtr += 2;
-				}
-				while (--PxCount > 0);
-				SrcPtr += Unblitted;
-			}
-		}
-
-		while (*SrcPtr++ != 0) {} // skip along until we hit and end-of-line marker
-		DestPtr += LineSkip;
-		ZPtr += LineSkip;
-		uiLineFlag ^= 1;
-	}
-	while (--BlitHeight > 0);
-}
-
-
-/**********************************************************************************************
-Blt8BPPDataTo16BPPBufferShadowZ
-
-	Creates a shadow using a brush, but modifies the destination buffer only if the current
-	Z level is equal to higher than what's in the Z buffer at that pixel location. It
-	updates the Z buffer with the new Z level.
-
-**********************************************************************************************/
-void Blt8BPPDataTo16BPPBufferShadowZ( UINT16 *pBuffer, UINT32 uiDestPitchBYTES, UINT16 *pZBuffer, UINT16 usZValue, HVOBJECT hSrcVObject, INT32 iX, INT32 iY, UINT16 usIndex )
-{
-	UINT8  *DestPtr, *ZPtr;
-	UINT32 LineSkip;
-
-	// Assertions
-	Assert( hSrcVObject != NULL );
-	Assert( pBuffer != NULL );
-
-	// Get Offsets from Index into structure
-	ETRLEObject const& pTrav    = hSrcVObject->SubregionProperties(usIndex);
-	UINT32             usHeight = pTrav.usHeight;
-	UINT32      const  usWidth  = pTrav.usWidth;
-
-	// Add to start position of dest buffer
-	INT32 const iTempX = iX + pTrav.sOffsetX;
-	INT32 const iTempY = iY + pTrav.sOffsetY;
-
-	// Validations
-	CHECKV(iTempX >= 0);
-	CHECKV(iTempY >= 0);
-
-	UINT8 const* SrcPtr = hSrcVObject->PixData(pTrav);
-	DestPtr = (UINT8 *)pBuffer + (uiDestPitchBYTES*iTempY) + (iTempX*2);
-	ZPtr = (UINT8 *)pZBuffer + (uiDestPitchBYTES*iTempY) + (iTempX*2);
-	LineSkip=(uiDestPitchBYTES-(usWidth*2));
-
-	do
-	{
-		for (;;)
-		{
-			UINT8 data = *SrcPtr++;
-
-			if (data == 0) break;
-			if (data & 0x80)
-			{
-				data &= 0x7F;
-				DestPtr += 2 * data;
-				ZPtr += 2 * data;
-			}
-			else
-			{
-				SrcPtr += data;
-				do
-				{
-					if (*(UINT16*)ZPtr < usZValue)
-					{
-						*(UINT16*)ZPtr = usZValue;
-						*(UINT16*)DestPtr = ShadeTable[*(UINT16*)DestPtr];
-					}
-					DestPtr += 2;
-					ZPtr += 2;
-				}
-				while (--data  > 0);
-			}
-		}
-		DestPtr += LineSkip;
-		ZPtr += LineSkip;
-	}
-	while (--usHeight > 0);
-}
-
-
-/**********************************************************************************************
-Blt8BPPDataTo16BPPBufferShadowZClip
-
-	Blits an image into the destination buffer, using an ETRLE brush as a source, and a 16-bit
-	buffer as a destination. As it is blitting, it checks the Z value of the ZBuffer, and if the
-	pixel's Z level is below that of the current pixel, it is written on, and the Z value is
-	updated to the current value,	for any non-transparent pixels. The Z-buffer is 16 bit, and
-	must be the same dimensions (including Pitch) as the destination.
-
-**********************************************************************************************/
-void Blt8BPPDataTo16BPPBufferShadowZClip( UINT16 *pBuffer, UINT32 uiDestPitchBYTES, UINT16 *pZBuffer, UINT16 usZValue, HVOBJECT hSrcVObject, INT32 iX, INT32 iY, UINT16 usIndex, SGPRect *clipregion)
-{
-	UINT8  *DestPtr, *ZPtr;
-	UINT32 LineSkip;
-	INT32  LeftSkip, RightSkip, TopSkip, BottomSkip, BlitLength, BlitHeight, LSCount;
-	INT32  ClipX1, ClipY1, ClipX2, ClipY2;
-
-	// Assertions
-	Assert( hSrcVObject != NULL );
-	Assert( pBuffer != NULL );
-
-	// Get Offsets from Index into structure
-	ETRLEObject const& pTrav = hSrcVObject->SubregionProperties(usIndex);
-	UINT32      const  usHeight = pTrav.usHeight;
-	UINT32      const  usWidth  = pTrav.usWidth;
-
-	// Add to start position of dest buffer
-	INT32 const iTempX = iX + pTrav.sOffsetX;
-	INT32 const iTempY = iY + pTrav.sOffsetY;
-
-	if(clipregion==NULL)
-	{
-		ClipX1=ClippingRect.iLeft;
-		ClipY1=ClippingRect.iTop;
-		ClipX2=ClippingRect.iRight;
-		ClipY2=ClippingRect.iBottom;
-	}
-	else
-	{
-		ClipX1=clipregion->iLeft;
-		ClipY1=clipregion->iTop;
-		ClipX2=clipregion->iRight;
-		ClipY2=clipregion->iBottom;
-	}
-
-	// Calculate rows hanging off each side of the screen
-	LeftSkip=__min(ClipX1 - MIN(ClipX1, iTempX), (INT32)usWidth);
-	RightSkip=__min(MAX(ClipX2, (iTempX+(INT32)usWidth)) - ClipX2, (INT32)usWidth);
-	TopSkip=__min(ClipY1 - __min(ClipY1, iTempY), (INT32)usHeight);
-	BottomSkip=__min(__max(ClipY2, (iTempY+(INT32)usHeight)) - ClipY2, (INT32)usHeight);
-
-	// calculate the remaining rows and columns to blit
-	BlitLength=((INT32)usWidth-LeftSkip-RightSkip);
-	BlitHeight=((INT32)usHeight-TopSkip-BottomSkip);
-
-	// check if whole thing is clipped
-	if((LeftSkip >=(INT32)usWidth) || (RightSkip >=(INT32)usWidth))
-		return;
-
-	// check if whole thing is clipped
-	if((TopSkip >=(INT32)usHeight) || (BottomSkip >=(INT32)usHeight))
-		return;
-
-	UINT8 const* SrcPtr = hSrcVObject->PixData(pTrav);
-	DestPtr = (UINT8 *)pBuffer + (uiDestPitchBYTES*(iTempY+TopSkip)) + ((iTempX+LeftSkip)*2);
-	ZPtr = (UINT8 *)pZBuffer + (uiDestPitchBYTES*(iTempY+TopSkip)) + ((iTempX+LeftSkip)*2);
-	LineSkip=(uiDestPitchBYTES-(BlitLength*2));
-
-	UINT32 PxCount;
-
-	while (TopSkip > 0)
-	{
-		for (;;)
-		{
-			PxCount = *SrcPtr++;
-			if (PxCount & 0x80) continue;
-			if (PxCount == 0) break;
-			SrcPtr += PxCount;
-		}
-		TopSkip--;
-	}
-
-	do
-	{
-		for (LSCount = LeftSkip; LSCount > 0; LSCount -= PxCount)
-		{
-			PxCount = *SrcPtr++;
-			if (PxCount & 0x80)
-			{
-				PxCount &= 0x7F;
-				if (PxCount > LSCount)
-				{
-					PxCount -= LSCount;
-					LSCount = BlitLength;
-					goto BlitTransparent;
-				}
-			}
-			else
-			{
-				if (PxCount > LSCount)
-				{
-					SrcPtr += LSCount;
-					PxCount -= LSCount;
-					LSCount = BlitLength;
-					goto BlitNonTransLoop;
-				}
-				SrcPtr += PxCount;
-			}
-		}
-
-		LSCount = BlitLength;
-		while (LSCount > 0)
-		{
-			PxCount = *SrcPtr++;
-			if (PxCount & 0x80)
-			{
-BlitTransparent: // skip transparent pixels
-				PxCount &= 0x7F;
-				if (PxCount > LSCount) PxCount = LSCount;
-				LSCount -= PxCount;
-				DestPtr += 2 * PxCount;
-				ZPtr    += 2 * PxCount;
-			}
-			else
-			{
-BlitNonTransLoop: // blit non-transparent pixels
-				SrcPtr += PxCount;
-				if (PxCount > LSCount) PxCount = LSCount;
-				LSCount -= PxCount;
-
-				do
-				{
-					if (*(UINT16*)ZPtr < usZValue)
-					{
-						*(UINT16*)ZPtr = usZValue;
-						*(UINT16*)DestPtr = ShadeTable[*(UINT16*)DestPtr];
-					}
-					DestPtr += 2;
-					ZPtr += 2;
-				}
-				while (--PxCount > 0);
-			}
-		}
-
-		while (*SrcPtr++ != 0) {} // skip along until we hit and end-of-line marker
-		DestPtr += LineSkip;
-		ZPtr += LineSkip;
-	}
-	while (--BlitHeight > 0);
-}
-
-
-/**********************************************************************************************
-Blt8BPPDataTo16BPPBufferShadowZNB
-
-	Creates a shadow using a brush, but modifies the destination buffer only if the current
-	Z level is equal to higher than what's in the Z buffer at that pixel location. It does
-	NOT update the Z buffer with the new Z value.
-
-**********************************************************************************************/
-void Blt8BPPDataTo16BPPBufferShadowZNB( UINT16 *pBuffer, UINT32 uiDestPitchBYTES, UINT16 *pZBuffer, UINT16 usZValue, HVOBJECT hSrcVObject, INT32 iX, INT32 iY, UINT16 usIndex )
-{
-	UINT8  *DestPtr, *ZPtr;
-	UINT32 LineSkip;
-
-	// Assertions
-	Assert( hSrcVObject != NULL );
-	Assert( pBuffer != NULL );
-
-	// Get Offsets from Index into structure
-	ETRLEObject const& pTrav    = hSrcVObject->SubregionProperties(usIndex);
-	UINT32             usHeight = pTrav.usHeight;
-	UINT32      const  usWidth  = pTrav.usWidth;
-
-	// Add to start position of dest buffer
-	INT32 const iTempX = iX + pTrav.sOffsetX;
-	INT32 const iTempY = iY + pTrav.sOffsetY;
-
-	// Validations
-	CHECKV(iTempX >= 0);
-	CHECKV(iTempY >= 0);
-
-	UINT8 const* SrcPtr = hSrcVObject->PixData(pTrav);
-	DestPtr = (UINT8 *)pBuffer + (uiDestPitchBYTES*iTempY) + (iTempX*2);
-	ZPtr = (UINT8 *)pZBuffer + (uiDestPitchBYTES*iTempY) + (iTempX*2);
-	LineSkip=(uiDestPitchBYTES-(usWidth*2));
-
-	do
-	{
-		for (;;)
-		{
-			UINT8 data = *SrcPtr++;
-
-			if (data == 0) break;
-			if (data & 0x80)
-			{
-				data &= 0x7F;
-				DestPtr += 2 * data;
-				ZPtr += 2 * data;
-			}
-			else
-			{
-				do
-				{
-					if (*(UINT16*)ZPtr < usZValue)
-					{
-						*(UINT16*)DestPtr = ShadeTable[*(UINT16*)DestPtr];
-					}
-				}
-				while (SrcPtr++, DestPtr += 2, ZPtr += 2, --data > 0);
-			}
-		}
-		DestPtr += LineSkip;
-		ZPtr += LineSkip;
-	}
-	while (--usHeight > 0);
-}
-
-
-/**********************************************************************************************
-Blt8BPPDataTo16BPPBufferShadowZNBClip
-
-	Blits an image into the destination buffer, using an ETRLE brush as a source, and a 16-bit
-	buffer as a destination. As it is blitting, it checks the Z value of the ZBuffer, and if the
-	pixel's Z level is below that of the current pixel, it is written on, the Z value is
-	not updated,	for any non-transparent pixels. The Z-buffer is 16 bit, and	must be the
-	same dimensions (including Pitch) as the destination.
-
-**********************************************************************************************/
-void Blt8BPPDataTo16BPPBufferShadowZNBClip( UINT16 *pBuffer, UINT32 uiDestPitchBYTES, UINT16 *pZBuffer, UINT16 usZValue, HVOBJECT hSrcVObject, INT32 iX, INT32 iY, UINT16 usIndex, SGPRect *clipregion)
-{
-	UINT32 Unblitted;
-	UINT8  *DestPtr, *ZPtr;
-	UINT32 LineSkip;
-	INT32  LeftSkip, RightSkip, TopSkip, BottomSkip, BlitLength, BlitHeight, LSCount;
-	INT32  ClipX1, ClipY1, ClipX2, ClipY2;
-
-	// Assertions
-	Assert( hSrcVObject != NULL );
-	Assert( pBuffer != NULL );
-
-	// Get Offsets from Index into structure
-	ETRLEObject const& pTrav = hSrcVObject->SubregionProperties(usIndex);
-	UINT32      const  usHeight = pTrav.usHeight;
-	UINT32      const  usWidth  = pTrav.usWidth;
-
-	// Add to start position of dest buffer
-	INT32 const iTempX = iX + pTrav.sOffsetX;
-	INT32 const iTempY = iY + pTrav.sOffsetY;
-
-	if(clipregion==NULL)
-	{
-		ClipX1=ClippingRect.iLeft;
-		ClipY1=ClippingRect.iTop;
-		ClipX2=ClippingRect.iRight;
-		ClipY2=ClippingRect.iBottom;
-	}
-	else
-	{
-		ClipX1=clipregion->iLeft;
-		ClipY1=clipregion->iTop;
-		ClipX2=clipregion->iRight;
-		ClipY2=clipregion->iBottom;
-	}
-
-	// Calculate rows hanging off each side of the screen
-	LeftSkip=__min(ClipX1 - MIN(ClipX1, iTempX), (INT32)usWidth);
-	RightSkip=__min(MAX(ClipX2, (iTempX+(INT32)usWidth)) - ClipX2, (INT32)usWidth);
-	TopSkip=__min(ClipY1 - __min(ClipY1, iTempY), (INT32)usHeight);
-	BottomSkip=__min(__max(ClipY2, (iTempY+(INT32)usHeight)) - ClipY2, (INT32)usHeight);
-
-	// calculate the remaining rows and columns to blit
-	BlitLength=((INT32)usWidth-LeftSkip-RightSkip);
-	BlitHeight=((INT32)usHeight-TopSkip-BottomSkip);
-
-	// check if whole thing is clipped
-	if((LeftSkip >=(INT32)usWidth) || (RightSkip >=(INT32)usWidth))
-		return;
-
-	// check if whole thing is clipped
-	if((TopSkip >=(INT32)usHeight) || (BottomSkip >=(INT32)usHeight))
-		return;
-
-	UINT8 const* SrcPtr = hSrcVObject->PixData(pTrav);
-	DestPtr = (UINT8 *)pBuffer + (uiDestPitchBYTES*(iTempY+TopSkip)) + ((iTempX+LeftSkip)*2);
-	ZPtr = (UINT8 *)pZBuffer + (uiDestPitchBYTES*(iTempY+TopSkip)) + ((iTempX+LeftSkip)*2);
-	LineSkip=(uiDestPitchBYTES-(BlitLength*2));
-
-	UINT32 PxCount;
-
-	while (TopSkip > 0)
-	{
-		for (;;)
-		{
-			PxCount = *SrcPtr++;
-			if (PxCount & 0x80) continue;
-			if (PxCount == 0) break;
-			SrcPtr += PxCount;
-		}
-		TopSkip--;
-	}
-
-	do
-	{
-		for (LSCount = LeftSkip; LSCount > 0; LSCount -= PxCount)
-		{
-			PxCount = *SrcPtr++;
-			if (PxCount & 0x80)
-			{
-				PxCount &= 0x7F;
-				if (PxCount > LSCount)
-				{
-					PxCount -= LSCount;
-					LSCount = BlitLength;
-					goto BlitTransparent;
-				}
-			}
-			else
-			{
-				if (PxCount > LSCount)
-				{
-					SrcPtr += LSCount;
-					PxCount -= LSCount;
-					LSCount = BlitLength;
-					goto BlitNonTransLoop;
-				}
-				SrcPtr += PxCount;
-			}
-		}
-
-		LSCount = BlitLength;
-		while (LSCount > 0)
-		{
-			PxCount = *SrcPtr++;
-			if (PxCount & 0x80)
-			{
-BlitTransparent: // skip transparent pixels
-				PxCount &= 0x7F;
-				if (PxCount > LSCount) PxCount = LSCount;
-				LSCount -= PxCount;
-				DestPtr += 2 * PxCount;
-				ZPtr    += 2 * PxCount;
-			}
-			else
-			{
-BlitNonTransLoop: // blit non-transparent pixels
-				if (PxCount > LSCount)
-				{
-					Unblitted = PxCount - LSCount;
-					PxCount = LSCount;
-				}
-				else
-				{
-					Unblitted = 0;
-				}
-				LSCount -= PxCount;
-
-				do
-				{
-					if (*(UINT16*)ZPtr < usZValue)
-					{
-						*(UINT16*)DestPtr = ShadeTable[*(UINT16*)DestPtr];
-					}
-				}
-				while (SrcPtr++, DestPtr += 2, ZPtr += 2, --PxCount > 0);
-				SrcPtr += Unblitted;
-			}
-		}
-
-		while (*SrcPtr++ != 0) {} // skip along until we hit and end-of-line marker
-		DestPtr += LineSkip;
-		ZPtr += LineSkip;
-	}
-	while (--BlitHeight > 0);
-}
-
-
-/**********************************************************************************************
-Blt8BPPDataTo16BPPBufferTransZClip
-
-	Blits an image into the destination buffer, using an ETRLE brush as a source, and a 16-bit
-	buffer as a destination. As it is blitting, it checks the Z value of the ZBuffer, and if the
-	pixel's Z level is below that of the current pixel, it is written on, and the Z value is
-	updated to the current value,	for any non-transparent pixels. The Z-buffer is 16 bit, and
-	must be the same dimensions (including Pitch) as the destination.
-
-**********************************************************************************************/
-void Blt8BPPDataTo16BPPBufferTransZClip( UINT16 *pBuffer, UINT32 uiDestPitchBYTES, UINT16 *pZBuffer, UINT16 usZValue, HVOBJECT hSrcVObject, INT32 iX, INT32 iY, UINT16 usIndex, SGPRect *clipregion)
-{
-	UINT32 Unblitted;
-	UINT8  *DestPtr, *ZPtr;
-	UINT32 LineSkip;
-	INT32  LeftSkip, RightSkip, TopSkip, BottomSkip, BlitLength, BlitHeight, LSCount;
-	INT32  ClipX1, ClipY1, ClipX2, ClipY2;
-
-	// Assertions
-	Assert( hSrcVObject != NULL );
-	Assert( pBuffer != NULL );
-
-	// Get Offsets from Index into structure
-	ETRLEObject const& pTrav = hSrcVObject->SubregionProperties(usIndex);
-	UINT32      const  usHeight = pTrav.usHeight;
-	UINT32      const  usWidth  = pTrav.usWidth;
-
-	// Add to start position of dest buffer
-	INT32 const iTempX = iX + pTrav.sOffsetX;
-	INT32 const iTempY = iY + pTrav.sOffsetY;
-
-	if(clipregion==NULL)
-	{
-		ClipX1=ClippingRect.iLeft;
-		ClipY1=ClippingRect.iTop;
-		ClipX2=ClippingRect.iRight;
-		ClipY2=ClippingRect.iBottom;
-	}
-	else
-	{
-		ClipX1=clipregion->iLeft;
-		ClipY1=clipregion->iTop;
-		ClipX2=clipregion->iRight;
-		ClipY2=clipregion->iBottom;
-	}
-
-	// Calculate rows hanging off each side of the screen
-	LeftSkip=__min(ClipX1 - MIN(ClipX1, iTempX), (INT32)usWidth);
-	RightSkip=__min(MAX(ClipX2, (iTempX+(INT32)usWidth)) - ClipX2, (INT32)usWidth);
-	TopSkip=__min(ClipY1 - __min(ClipY1, iTempY), (INT32)usHeight);
-	BottomSkip=__min(__max(ClipY2, (iTempY+(INT32)usHeight)) - ClipY2, (INT32)usHeight);
-
-	// calculate the remaining rows and columns to blit
-	BlitLength=((INT32)usWidth-LeftSkip-RightSkip);
-	BlitHeight=((INT32)usHeight-TopSkip-BottomSkip);
-
-	// check if whole thing is clipped
-	if((LeftSkip >=(INT32)usWidth) || (RightSkip >=(INT32)usWidth))
-		return;
-
-	// check if whole thing is clipped
-	if((TopSkip >=(INT32)usHeight) || (BottomSkip >=(INT32)usHeight))
-		return;
-
-	UINT8 const* SrcPtr = hSrcVObject->PixData(pTrav);
-	DestPtr = (UINT8 *)pBuffer + (uiDestPitchBYTES*(iTempY+TopSkip)) + ((iTempX+LeftSkip)*2);
-	ZPtr = (UINT8 *)pZBuffer + (uiDestPitchBYTES*(iTempY+TopSkip)) + ((iTempX+LeftSkip)*2);
-	UINT16 const* const p16BPPPalette = hSrcVObject->CurrentShade();
-	LineSkip=(uiDestPitchBYTES-(BlitLength*2));
-
-	UINT32 PxCount;
-
-	while (TopSkip > 0)
-	{
-		for (;;)
-		{
-			PxCount = *SrcPtr++;
-			if (PxCount & 0x80) continue;
-			if (PxCount == 0) break;
-			SrcPtr += PxCount;
-		}
-		TopSkip--;
-	}
-
-	do
-	{
-		for (LSCount = LeftSkip; LSCount > 0; LSCount -= PxCount)
-		{
-			PxCount = *SrcPtr++;
-			if (PxCount & 0x80)
-			{
-				PxCount &= 0x7F;
-				if (PxCount > LSCount)
-				{
-					PxCount -= LSCount;
-					LSCount = BlitLength;
-					goto BlitTransparent;
-				}
-			}
-			else
-			{
-				if (PxCount > LSCount)
-				{
-					SrcPtr += LSCount;
-					PxCount -= LSCount;
-					LSCount = BlitLength;
-					goto BlitNonTransLoop;
-				}
-				SrcPtr += PxCount;
-			}
-		}
-
-		LSCount = BlitLength;
-		while (LSCount > 0)
-		{
-			PxCount = *SrcPtr++;
-			if (PxCount & 0x80)
-			{
-BlitTransparent: // skip transparent pixels
-				PxCount &= 0x7F;
-				if (PxCount > LSCount) PxCount = LSCount;
-				LSCount -= PxCount;
-				DestPtr += 2 * PxCount;
-				ZPtr    += 2 * PxCount;
-			}
-			else
-			{
-BlitNonTransLoop: // blit non-transparent pixels
-				if (PxCount > LSCount)
-				{
-					Unblitted = PxCount - LSCount;
-					PxCount = LSCount;
-				}
-				else
-				{
-					Unblitted = 0;
-				}
-				LSCount -= PxCount;
-
-				do
-				{
-					if (*(UINT16*)ZPtr <= usZValue)
-					{
-						*(UINT16*)ZPtr = usZValue;
-						*(UINT16*)DestPtr = p16BPPPalette[*SrcPtr];
-					}
-					SrcPtr++;
-					DestPtr += 2;
-					ZPtr += 2;
-				}
-				while (--PxCount > 0);
-				SrcPtr += Unblitted;
-			}
-		}
-
-		while (*SrcPtr++ != 0) {} // skip along until we hit and end-of-line marker
-		DestPtr += LineSkip;
-		ZPtr += LineSkip;
-	}
-	while (--BlitHeight > 0);
-}
-
-
-/**********************************************************************************************
-Blt8BPPDataTo16BPPBufferTransZNBClip
-
-	Blits an image into the destination buffer, using an ETRLE brush as a source, and a 16-bit
-	buffer as a destination. As it is blitting, it checks the Z value of the ZBuffer, and if the
-	pixel's Z level is below that of the current pixel, it is written on. The Z value is NOT
-	updated in this version. The Z-buffer is 16 bit, and must be the same dimensions (including Pitch) as the destination.
-
-**********************************************************************************************/
-void Blt8BPPDataTo16BPPBufferTransZNBClip( UINT16 *pBuffer, UINT32 uiDestPitchBYTES, UINT16 *pZBuffer, UINT16 usZValue, HVOBJECT hSrcVObject, INT32 iX, INT32 iY, UINT16 usIndex, SGPRect *clipregion)
-{
-	UINT32 Unblitted;
-	UINT8  *DestPtr, *ZPtr;
-	UINT32 LineSkip;
-	INT32  LeftSkip, RightSkip, TopSkip, BottomSkip, BlitLength, BlitHeight, LSCount;
-	INT32  ClipX1, ClipY1, ClipX2, ClipY2;
-
-	// Assertions
-	Assert( hSrcVObject != NULL );
-	Assert( pBuffer != NULL );
-
-	// Get Offsets from Index into structure
-	ETRLEObject const& pTrav = hSrcVObject->SubregionProperties(usIndex);
-	UINT32      const  usHeight = pTrav.usHeight;
-	UINT32      const  usWidth  = pTrav.usWidth;
-
-	// Add to start position of dest buffer
-	INT32 const iTempX = iX + pTrav.sOffsetX;
-	INT32 const iTempY = iY + pTrav.sOffsetY;
-
-	if(clipregion==NULL)
-	{
-		ClipX1=ClippingRect.iLeft;
-		ClipY1=ClippingRect.iTop;
-		ClipX2=ClippingRect.iRight;
-		ClipY2=ClippingRect.iBottom;
-	}
-	else
-	{
-		ClipX1=clipregion->iLeft;
-		ClipY1=clipregion->iTop;
-		ClipX2=clipregion->iRight;
-		ClipY2=clipregion->iBottom;
-	}
-
-	// Calculate rows hanging off each side of the screen
-	LeftSkip=__min(ClipX1 - MIN(ClipX1, iTempX), (INT32)usWidth);
-	RightSkip=__min(MAX(ClipX2, (iTempX+(INT32)usWidth)) - ClipX2, (INT32)usWidth);
-	TopSkip=__min(ClipY1 - __min(ClipY1, iTempY), (INT32)usHeight);
-	BottomSkip=__min(__max(ClipY2, (iTempY+(INT32)usHeight)) - ClipY2, (INT32)usHeight);
-
-	// calculate the remaining rows and columns to blit
-	BlitLength=((INT32)usWidth-LeftSkip-RightSkip);
-	BlitHeight=((INT32)usHeight-TopSkip-BottomSkip);
-
-	// check if whole thing is clipped
-	if((LeftSkip >=(INT32)usWidth) || (RightSkip >=(INT32)usWidth))
-		return;
-
-	// check if whole thing is clipped
-	if((TopSkip >=(INT32)usHeight) || (BottomSkip >=(INT32)usHeight))
-		return;
-
-	UINT8 const* SrcPtr = hSrcVObject->PixData(pTrav);
-	DestPtr = (UINT8 *)pBuffer + (uiDestPitchBYTES*(iTempY+TopSkip)) + ((iTempX+LeftSkip)*2);
-	ZPtr = (UINT8 *)pZBuffer + (uiDestPitchBYTES*(iTempY+TopSkip)) + ((iTempX+LeftSkip)*2);
-	UINT16 const* const p16BPPPalette = hSrcVObject->CurrentShade();
-	LineSkip=(uiDestPitchBYTES-(BlitLength*2));
-
-	UINT32 PxCount;
-
-	while (TopSkip > 0)
-	{
-		for (;;)
-		{
-			PxCount = *SrcPtr++;
-			if (PxCount & 0x80) continue;
-			if (PxCount == 0) break;
-			SrcPtr += PxCount;
-		}
-		TopSkip--;
-	}
-
-	do
-	{
-		for (LSCount = LeftSkip; LSCount > 0; LSCount -= PxCount)
-		{
-			PxCount = *SrcPtr++;
-			if (PxCount & 0x80)
-			{
-				PxCount &= 0x7F;
-				if (PxCount > LSCount)
-				{
-					PxCount -= LSCount;
-					LSCount = BlitLength;
-					goto BlitTransparent;
-				}
-			}
-			else
-			{
-				if (PxCount > LSCount)
-				{
-					SrcPtr += LSCount;
-					PxCount -= LSCount;
-					LSCount = BlitLength;
-					goto BlitNonTransLoop;
-				}
-				SrcPtr += PxCount;
-			}
-		}
-
-		LSCount = BlitLength;
-		while (LSCount > 0)
-		{
-			PxCount = *SrcPtr++;
-			if (PxCount & 0x80)
-			{
-BlitTransparent: // skip transparent pixels
-				PxCount &= 0x7F;
-				if (PxCount > LSCount) PxCount = LSCount;
-				LSCount -= PxCount;
-				DestPtr += 2 * PxCount;
-				ZPtr    += 2 * PxCount;
-			}
-			else
-			{
-BlitNonTransLoop: // blit non-transparent pixels
-				if (PxCount > LSCount)
-				{
-					Unblitted = PxCount - LSCount;
-					PxCount = LSCount;
-				}
-				else
-				{
-					Unblitted = 0;
-				}
-				LSCount -= PxCount;
-
-				do
-				{
-					if (*(UINT16*)ZPtr <= usZValue)
-					{
-						*(UINT16*)DestPtr = p16BPPPalette[*SrcPtr];
-					}
-					SrcPtr++;
-					DestPtr += 2;
-					ZPtr += 2;
-				}
-				while (--PxCount > 0);
-				SrcPtr += Unblitted;
-			}
-		}
-
-		while (*SrcPtr++ != 0) {} // skip along until we hit and end-of-line marker
-		DestPtr += LineSkip;
-		ZPtr += LineSkip;
-	}
-	while (--BlitHeight > 0);
-}
-
-
-/* Blit a subrect from a flat 8 bit surface to a 16-bit buffer. */
-void Blt8BPPDataSubTo16BPPBuffer(UINT16* const buf, UINT32 const uiDestPitchBYTES, SGPVSurface* const hSrcVSurface, UINT8* const pSrcBuffer, UINT32 const src_pitch, INT32 const x, INT32 const y, SGPBox const* const rect)
-{
-	Assert(hSrcVSurface);
-	Assert(pSrcBuffer);
-	Assert(buf);
-
-	CHECKV(x >= 0);
-	CHECKV(y >= 0);
-
-	UINT32 const LeftSkip   = rect->x;
-	UINT32 const TopSkip    = rect->y * src_pitch;
-	UINT32 const BlitLength = rect->w;
-	UINT32       BlitHeight = rect->h;
-	UINT32 const src_skip   = src_pitch - BlitLength;
-
-	UINT32        const pitch     = uiDestPitchBYTES / 2;
-	UINT8  const*       src       = pSrcBuffer + TopSkip + LeftSkip;
-	UINT16*             dst       = buf + pitch * y + x;
-	UINT16 const* const pal       = hSrcVSurface->p16BPPPalette;
-	UINT32              line_skip = pitch - BlitLength;
-
-	do
-	{
-		UINT32 w = BlitLength;
-		do
-		{
-			*dst++ = pal[*src++];
-		}
-		while (--w != 0);
-		src += src_skip;
-		dst += line_skip;
-	}
-	while (--BlitHeight != 0);
-}
-
-
-/**********************************************************************************************
-Blt8BPPDataTo16BPPBuffer
-
-	Blits from a flat surface to a 16-bit buffer.
-
-**********************************************************************************************/
-void Blt8BPPDataTo16BPPBuffer( UINT16 *pBuffer, UINT32 uiDestPitchBYTES, SGPVSurface* hSrcVSurface, UINT8 *pSrcBuffer, INT32 iX, INT32 iY)
-{
-	INT32  iTempX, iTempY;
-
-	// Assertions
-	Assert( hSrcVSurface != NULL );
-	Assert( pSrcBuffer != NULL );
-	Assert( pBuffer != NULL );
-
-	// Get Offsets from Index into structure
-	UINT32 const usWidth  = hSrcVSurface->Width();
-	UINT32 const usHeight = hSrcVSurface->Height();
-
-	// Add to start position of dest buffer
-	iTempX = iX;
-	iTempY = iY;
-
-	// Validations
-	CHECKV(iTempX >= 0);
-	CHECKV(iTempY >= 0);
-
-	UINT8*  SrcPtr        = pSrcBuffer;
-	UINT16* DestPtr       = pBuffer + uiDestPitchBYTES / 2 * iTempY + iTempX;
-	UINT16* p16BPPPalette = hSrcVSurface->p16BPPPalette;
-
-	for (size_t h = usHeight; h != 0; --h)
-	{
-		for (size_t w = 0; w != usWidth; ++w)
-		{
-			DestPtr[w] = p16BPPPalette[SrcPtr[w]];
-		}
-
-		SrcPtr  += usWidth;
-		DestPtr += uiDestPitchBYTES / 2;
-	}
-}
-
-
-/* Blit from a flat surface to a 16-bit buffer, dividing the source image into
- * exactly half the size, optionally from a sub-region.
- * - Source rect is in source units.
- * - In order to make sure the same pixels are skipped, always align the top and
- *   left coordinates to the same factor of two.
- * - A rect specifying an odd number of pixels will divide out to an even number
- *   of pixels blitted to the destination. */
-void Blt8BPPDataTo16BPPBufferHalf(UINT16* const dst_buf, UINT32 const uiDestPitchBYTES, SGPVSurface* const src_surface, UINT8 const* const src_buf, UINT32 const src_pitch, INT32 const x, INT32 const y, SGPBox const* const rect)
-{
-	Assert(src_surface);
-	Assert(src_buf);
-	Assert(dst_buf);
-
-	CHECKV(x >= 0);
-	CHECKV(y >= 0);
-
-	UINT8 const* src = src_buf;
-	UINT32       width;
-	UINT32       height;
-	if (rect)
-	{
-		width  = rect->w;
-		height = rect->h;
-		CHECKV(0 < width  && width  <= src_surface->Width());
-		CHECKV(0 < height && height <= src_surface->Height());
-
-		src += src_pitch * rect->y + rect->x;
-	}
-	else
-	{
-		width  = src_surface->Width();
-		height = src_surface->Height();
-	}
-
-	UINT16*             dst      = dst_buf + uiDestPitchBYTES / 2 * y + x;
-	UINT32        const src_skip = (src_pitch - width / 2) * 2;
-	UINT32        const dst_skip = uiDestPitchBYTES / 2 - width / 2;
-	UINT16 const* const pal      = src_surface->p16BPPPalette;
-
-	height /= 2;
-	do
-	{
-		UINT32 w = width / 2;
-		do
-		{
-			*dst++ = pal[*src];
-			src += 2;
-		}
-		while (--w > 0);
-		src += src_skip;
-		dst += dst_skip;
-	}
-	while (--height > 0);
-}
-
-
-void SetClippingRect(SGPRect *clip)
-{
-	Assert(clip!=NULL);
-	Assert(clip->iLeft < clip->iRight);
-	Assert(clip->iTop < clip->iBottom);
-	ClippingRect = *clip;
-}
-
-
-void GetClippingRect(SGPRect *clip)
-{
-	Assert(clip!=NULL);
-	*clip = ClippingRect;
-}
-
-
-/**********************************************************************************************
-	Blt16BPPBufferPixelateRectWithColor
-
-		Given an 8x8 pattern and a color, pixelates an area by repeatedly "applying the color" to pixels whereever there
-		is a non-zero value in the pattern.
-
-		KM:  Added Nov. 23, 1998
-		This is all the code that I moved from Blt16BPPBufferPixelateRect().
-		This function now takes a color field (which previously was
-		always black.  The 3rd assembler line in this function:
-
-				mov	ax, usColor	// color of pixel
-
-		used to be:
-
-				xor	eax, eax	// color of pixel (black or 0)
-
-	  This was the only internal modification I made other than adding the usColor argument.
-
-*********************************************************************************************/
-static void Blt16BPPBufferPixelateRectWithColor(UINT16* pBuffer, UINT32 uiDestPitchBYTES, SGPRect* area, const UINT8 Pattern[8][8], UINT16 usColor)
-{
-	INT32  width, height;
-	UINT32 LineSkip;
-	UINT16 *DestPtr;
-	INT32	iLeft, iTop, iRight, iBottom;
-
-	// Assertions
-	Assert( pBuffer != NULL );
-	Assert( Pattern != NULL );
-
-	iLeft=__max(ClippingRect.iLeft, area->iLeft);
-	iTop=__max(ClippingRect.iTop, area->iTop);
-	iRight=__min(ClippingRect.iRight-1, area->iRight);
-	iBottom=__min(ClippingRect.iBottom-1, area->iBottom);
-
-	DestPtr=(pBuffer+(iTop*(uiDestPitchBYTES/2))+iLeft);
-	width=iRight-iLeft+1;
-	height=iBottom-iTop+1;
-	LineSkip=(uiDestPitchBYTES-(width*2));
-
-	CHECKV(width  >= 1);
-	CHECKV(height >= 1);
-
-	UINT32 row = 0;
-	do
-	{
-		UINT32 col = 0;
-		UINT32 w = width;
-
-		do
-		{
-			if (Pattern[row][col] != 0) *DestPtr = usColor;
-			DestPtr++;
-			col = (col + 1) % 8;
-		}
-		while (--w > 0);
-		DestPtr += LineSkip / 2;
-		row = (row + 1) % 8;
-	}
-	while (--height > 0);
-}
-
-
-//Uses black hatch color
-void Blt16BPPBufferHatchRect(UINT16 *pBuffer, UINT32 uiDestPitchBYTES, SGPRect *area )
-{
-	const UINT8 Pattern[8][8] =
-	{
-		{ 1,0,1,0,1,0,1,0 },
-		{ 0,1,0,1,0,1,0,1 },
-		{ 1,0,1,0,1,0,1,0 },
-		{ 0,1,0,1,0,1,0,1 },
-		{ 1,0,1,0,1,0,1,0 },
-		{ 0,1,0,1,0,1,0,1 },
-		{ 1,0,1,0,1,0,1,0 },
-		{ 0,1,0,1,0,1,0,1 }
-	};
-	Blt16BPPBufferPixelateRectWithColor( pBuffer, uiDestPitchBYTES, area, Pattern, 0 );
-}
-
-void Blt16BPPBufferLooseHatchRectWithColor(UINT16 *pBuffer, UINT32 uiDestPitchBYTES, SGPRect *area, UINT16 usColor )
-{
-	const UINT8 Pattern[8][8] =
-	{
-		{ 1,0,0,0,1,0,0,0 },
-		{ 0,0,0,0,0,0,0,0 },
-		{ 0,0,1,0,0,0,1,0 },
-		{ 0,0,0,0,0,0,0,0 },
-		{ 1,0,0,0,1,0,0,0 },
-		{ 0,0,0,0,0,0,0,0 },
-		{ 0,0,1,0,0,0,1,0 },
-		{ 0,0,0,0,0,0,0,0 }
-	};
-	Blt16BPPBufferPixelateRectWithColor( pBuffer, uiDestPitchBYTES, area, Pattern, usColor );
-}
-
-
-/**********************************************************************************************
-Blt8BPPDataTo16BPPBufferShadow
-
-	Modifies the destination buffer. Darkens the destination pixels by 25%, using the source
-	image as a mask. Any Non-zero index pixels are used to darken destination pixels.
-
-**********************************************************************************************/
-void Blt8BPPDataTo16BPPBufferShadow( UINT16 *pBuffer, UINT32 uiDestPitchBYTES, HVOBJECT hSrcVObject, INT32 iX, INT32 iY, UINT16 usIndex)
-{
-	UINT8  *DestPtr;
-	UINT32 LineSkip;
-
-	// Assertions
-	Assert( hSrcVObject != NULL );
-	Assert( pBuffer != NULL );
-
-	// Get Offsets from Index into structure
-	ETRLEObject const& pTrav    = hSrcVObject->SubregionProperties(usIndex);
-	UINT32             usHeight = pTrav.usHeight;
-	UINT32      const  usWidth  = pTrav.usWidth;
-
-	// Add to start position of dest buffer
-	INT32 const iTempX = iX + pTrav.sOffsetX;
-	INT32 const iTempY = iY + pTrav.sOffsetY;
-
-	// Validations
-	CHECKV(iTempX >= 0);
-	CHECKV(iTempY >= 0);
-
-	UINT8 const* SrcPtr = hSrcVObject->PixData(pTrav);
-	DestPtr = (UINT8 *)pBuffer + (uiDestPitchBYTES*iTempY) + (iTempX*2);
-	LineSkip=(uiDestPitchBYTES-(usWidth*2));
-
-	do
-	{
-		for (;;)
-		{
-			UINT8 data = *SrcPtr++;
-
-			if (data == 0) break;
-			if (data & 0x80)
-			{
-				data &= 0x7F;
-				DestPtr += 2 * data;
-			}
-			else
-			{
-				SrcPtr += data;
-				do
-				{
-					*(UINT16*)DestPtr = ShadeTable[*(UINT16*)DestPtr];
-					DestPtr += 2;
-				}
-				while (--data  > 0);
-			}
-		}
-		DestPtr += LineSkip;
-	}
-	while (--usHeight > 0);
-}
-
-
-/* Blit an image into the destination buffer, using an ETRLE brush as a source
- * and a 16-bit buffer as a destination. */
-void Blt8BPPDataTo16BPPBufferTransparent(UINT16* const buf, UINT32 const uiDestPitchBYTES, SGPVObject const* const hSrcVObject, INT32 const iX, INT32 const iY, UINT16 const usIndex)
-{
-	Assert(hSrcVObject);
-	Assert(buf);
-
-	// Get offsets from index into structure
-	ETRLEObject const& e      = hSrcVObject->SubregionProperties(usIndex);
-	UINT32             height = e.usHeight;
-	UINT32      const  width  = e.usWidth;
-
-	// Add to start position of dest buffer
-	INT32 const x = iX + e.sOffsetX;
-	INT32 const y = iY + e.sOffsetY;
-
-	CHECKV(x >= 0);
-	CHECKV(y >= 0);
-
-	UINT32        const pitch     = uiDestPitchBYTES / 2;
-	UINT8  const*       src       = hSrcVObject->PixData(e);
-	UINT16*             dst       = buf + pitch * y + x;
-	UINT16 const* const pal       = hSrcVObject->CurrentShade();
-	UINT32              line_skip = pitch - width;
-
-	for (;;)
-	{
-		UINT8 data = *src++;
-		if (data == 0)
-		{
-			if (--height == 0) break;
-			dst += line_skip;
-		}
-		else if (data & 0x80)
-		{ // Transparent
-			dst += data & 0x7F;
-		}
-		else
-		{
-			do
-			{
-				*dst++ = pal[*src++];
-			}
-			while (--data != 0);
-		}
-	}
-}
-
-
-/**********************************************************************************************
-Blt8BPPDataTo16BPPBufferTransparentClip
-
-	Blits an image into the destination buffer, using an ETRLE brush as a source, and a 16-bit
-	buffer as a destination. Clips the brush.
-
-**********************************************************************************************/
-void Blt8BPPDataTo16BPPBufferTransparentClip(UINT16* const pBuffer, const UINT32 uiDestPitchBYTES, const SGPVObject* const hSrcVObject, const INT32 iX, const INT32 iY, const UINT16 usIndex, const SGPRect* const clipregion)
-{
-	UINT32 Unblitted;
-	UINT8  *DestPtr;
-	UINT32 LineSkip;
-	INT32  LeftSkip, RightSkip, TopSkip, BottomSkip, BlitLength, BlitHeight;
-	INT32  ClipX1, ClipY1, ClipX2, ClipY2;
-
-	// Assertions
-	Assert( hSrcVObject != NULL );
-	Assert( pBuffer != NULL );
-
-	// Get Offsets from Index into structure
-	ETRLEObject const& pTrav = hSrcVObject->SubregionProperties(usIndex);
-	UINT32      const  usHeight = pTrav.usHeight;
-	UINT32      const  usWidth  = pTrav.usWidth;
-
-	// Add to start position of dest buffer
-	INT32 const iTempX = iX + pTrav.sOffsetX;
-	INT32 const iTempY = iY + pTrav.sOffsetY;
-
-	if(clipregion==NULL)
-	{
-		ClipX1=ClippingRect.iLeft;
-		ClipY1=ClippingRect.iTop;
-		ClipX2=ClippingRect.iRight;
-		ClipY2=ClippingRect.iBottom;
-	}
-	else
-	{
-		ClipX1=clipregion->iLeft;
-		ClipY1=clipregion->iTop;
-		ClipX2=clipregion->iRight;
-		ClipY2=clipregion->iBottom;
-	}
-
-	// Calculate rows hanging off each side of the screen
-	LeftSkip=__min(ClipX1 - MIN(ClipX1, iTempX), (INT32)usWidth);
-	RightSkip=__min(MAX(ClipX2, (iTempX+(INT32)usWidth)) - ClipX2, (INT32)usWidth);
-	TopSkip=__min(ClipY1 - __min(ClipY1, iTempY), (INT32)usHeight);
-	BottomSkip=__min(__max(ClipY2, (iTempY+(INT32)usHeight)) - ClipY2, (INT32)usHeight);
-
-	// calculate the remaining rows and columns to blit
-	BlitLength=((INT32)usWidth-LeftSkip-RightSkip);
-	BlitHeight=((INT32)usHeight-TopSkip-BottomSkip);
-
-	// check if whole thing is clipped
-	if((LeftSkip >=(INT32)usWidth) || (RightSkip >=(INT32)usWidth))
-		return;
-
-	// check if whole thing is clipped
-	if((TopSkip >=(INT32)usHeight) || (BottomSkip >=(INT32)usHeight))
-		return;
-
-	UINT8 const* SrcPtr = hSrcVObject->PixData(pTrav);
-	DestPtr = (UINT8 *)pBuffer + (uiDestPitchBYTES*(iTempY+TopSkip)) + ((iTempX+LeftSkip)*2);
-	UINT16 const* const p16BPPPalette = hSrcVObject->CurrentShade();
-	LineSkip=(uiDestPitchBYTES-(BlitLength*2));
-
-	UINT32 LSCount;
-	UINT32 PxCount;
-
-	while (TopSkip > 0)
-	{
-		for (;;)
-		{
-			PxCount = *SrcPtr++;
-			if (PxCount & 0x80) continue;
-			if (PxCount == 0) break;
-			SrcPtr += PxCount;
-		}
-		TopSkip--;
-	}
-
-	do
-	{
-		for (LSCount = LeftSkip; LSCount > 0; LSCount -= PxCount)
-		{
-			PxCount = *SrcPtr++;
-			if (PxCount & 0x80)
-			{
-				PxCount &= 0x7F;
-				if (PxCount > LSCount)
-				{
-					PxCount -= LSCount;
-					LSCount = BlitLength;
-					goto BlitTransparent;
-				}
-			}
-			else
-			{
-				if (PxCount > LSCount)
-				{
-					SrcPtr += LSCount;
-					PxCount -= LSCount;
-					LSCount = BlitLength;
-					goto BlitNonTransLoop;
-				}
-				SrcPtr += PxCount;
-			}
-		}
-
-		LSCount = BlitLength;
-		while (LSCount > 0)
-		{
-			PxCount = *SrcPtr++;
-			if (PxCount & 0x80)
-			{
-BlitTransparent: // skip transparent pixels
-				PxCount &= 0x7F;
-				if (PxCount > LSCount) PxCount = LSCount;
-				LSCount -= PxCount;
-				DestPtr += 2 * PxCount;
-			}
-			else
-			{
-BlitNonTransLoop: // blit non-transparent pixels
-				if (PxCount > LSCount)
-				{
-					Unblitted = PxCount - LSCount;
-					PxCount = LSCount;
-				}
-				else
-				{
-					Unblitted = 0;
-				}
-				LSCount -= PxCount;
-
-				do
-				{
-					*(UINT16*)DestPtr = p16BPPPalette[*SrcPtr++];
-					DestPtr += 2;
-				}
-				while (--PxCount > 0);
-				SrcPtr += Unblitted;
-			}
-		}
-
-		while (*SrcPtr++ != 0) {} // skip along until we hit and end-of-line marker
-		DestPtr += LineSkip;
-	}
-	while (--BlitHeight > 0);
-}
-
-
-/**********************************************************************************************
-BltIsClipped
-
-	Determines whether a given blit will need clipping or not. Returns TRUE/FALSE.
-
-**********************************************************************************************/
-BOOLEAN BltIsClipped(const SGPVObject* const hSrcVObject, const INT32 iX, const INT32 iY, const UINT16 usIndex, const SGPRect* const clipregion)
-{
-	INT32  ClipX1, ClipY1, ClipX2, ClipY2;
-
-	// Assertions
-	Assert( hSrcVObject != NULL );
-
-	// Get Offsets from Index into structure
-	ETRLEObject const& pTrav = hSrcVObject->SubregionProperties(usIndex);
-	UINT32      const  usHeight = pTrav.usHeight;
-	UINT32      const  usWidth  = pTrav.usWidth;
-
-	// Add to start position of dest buffer
-	INT32 const iTempX = iX + pTrav.sOffsetX;
-	INT32 const iTempY = iY + pTrav.sOffsetY;
-
-	if(clipregion==NULL)
-	{
-		ClipX1=ClippingRect.iLeft;
-		ClipY1=ClippingRect.iTop;
-		ClipX2=ClippingRect.iRight;
-		ClipY2=ClippingRect.iBottom;
-	}
-	else
-	{
-		ClipX1=clipregion->iLeft;
-		ClipY1=clipregion->iTop;
-		ClipX2=clipregion->iRight;
-		ClipY2=clipregion->iBottom;
-	}
-
-
-	// Calculate rows hanging off each side of the screen
-	if(__min(ClipX1 - MIN(ClipX1, iTempX), (INT32)usWidth))
-		return(TRUE);
-
-	if(__min(MAX(ClipX2, (iTempX+(INT32)usWidth)) - ClipX2, (INT32)usWidth))
-		return(TRUE);
-
-	if(__min(ClipY1 - __min(ClipY1, iTempY), (INT32)usHeight))
-		return(TRUE);
-
-	if(__min(__max(ClipY2, (iTempY+(INT32)usHeight)) - ClipY2, (INT32)usHeight))
-		return(TRUE);
-
-	return(FALSE);
-}
-
-
-
-/**********************************************************************************************
-Blt8BPPDataTo16BPPBufferShadowClip
-
-	Modifies the destination buffer. Darkens the destination pixels by 25%, using the source
-	image as a mask. Any Non-zero index pixels are used to darken destination pixels. Blitter
-	clips brush if it doesn't fit on the viewport.
-
-**********************************************************************************************/
-void Blt8BPPDataTo16BPPBufferShadowClip( UINT16 *pBuffer, UINT32 uiDestPitchBYTES, HVOBJECT hSrcVObject, INT32 iX, INT32 iY, UINT16 usIndex, SGPRect *clipregion)
-{
-	UINT8  *DestPtr;
-	UINT32 LineSkip;
-	INT32  LeftSkip, RightSkip, TopSkip, BottomSkip, BlitLength, BlitHeight;
-	INT32  ClipX1, ClipY1, ClipX2, ClipY2;
-
-	// Assertions
-	Assert( hSrcVObject != NULL );
-	Assert( pBuffer != NULL );
-
-	// Get Offsets from Index into structure
-	ETRLEObject const& pTrav = hSrcVObject->SubregionProperties(usIndex);
-	UINT32      const  usHeight = pTrav.usHeight;
-	UINT32      const  usWidth  = pTrav.usWidth;
-
-	// Add to start position of dest buffer
-	INT32 const iTempX = iX + pTrav.sOffsetX;
-	INT32 const iTempY = iY + pTrav.sOffsetY;
-
-	if(clipregion==NULL)
-	{
-		ClipX1=ClippingRect.iLeft;
-		ClipY1=ClippingRect.iTop;
-		ClipX2=ClippingRect.iRight;
-		ClipY2=ClippingRect.iBottom;
-	}
-	else
-	{
-		ClipX1=clipregion->iLeft;
-		ClipY1=clipregion->iTop;
-		ClipX2=clipregion->iRight;
-		ClipY2=clipregion->iBottom;
-	}
-
-	// Calculate rows hanging off each side of the screen
-	LeftSkip=__min(ClipX1 - MIN(ClipX1, iTempX), (INT32)usWidth);
-	RightSkip=__min(MAX(ClipX2, (iTempX+(INT32)usWidth)) - ClipX2, (INT32)usWidth);
-	TopSkip=__min(ClipY1 - __min(ClipY1, iTempY), (INT32)usHeight);
-	BottomSkip=__min(__max(ClipY2, (iTempY+(INT32)usHeight)) - ClipY2, (INT32)usHeight);
-
-	// calculate the remaining rows and columns to blit
-	BlitLength=((INT32)usWidth-LeftSkip-RightSkip);
-	BlitHeight=((INT32)usHeight-TopSkip-BottomSkip);
-
-	// whole thing is clipped
-	if((LeftSkip >=(INT32)usWidth) || (RightSkip >=(INT32)usWidth))
-		return;
-
-	// whole thing is clipped
-	if((TopSkip >=(INT32)usHeight) || (BottomSkip >=(INT32)usHeight))
-		return;
-
-	UINT8 const* SrcPtr = hSrcVObject->PixData(pTrav);
-	DestPtr = (UINT8 *)pBuffer + (uiDestPitchBYTES*(iTempY+TopSkip)) + ((iTempX+LeftSkip)*2);
-	LineSkip=(uiDestPitchBYTES-(BlitLength*2));
-
-	UINT32 LSCount;
-	UINT32 PxCount;
-
-	while (TopSkip > 0)
-	{
-		for (;;)
-		{
-			PxCount = *SrcPtr++;
-			if (PxCount & 0x80) continue;
-			if (PxCount == 0) break;
-			SrcPtr += PxCount;
-		}
-		TopSkip--;
-	}
-
-	do
-	{
-		for (LSCount = LeftSkip; LSCount > 0; LSCount -= PxCount)
-		{
-			PxCount = *SrcPtr++;
-			if (PxCount & 0x80)
-			{
-				PxCount &= 0x7F;
-				if (PxCount > LSCount)
-				{
-					PxCount -= LSCount;
-					LSCount = BlitLength;
-					goto BlitTransparent;
-				}
-			}
-			else
-			{
-				if (PxCount > LSCount)
-				{
-					SrcPtr += LSCount;
-					PxCount -= LSCount;
-					LSCount = BlitLength;
-					goto BlitNonTransLoop;
-				}
-				SrcPtr += PxCount;
-			}
-		}
-
-		LSCount = BlitLength;
-		while (LSCount > 0)
-		{
-			PxCount = *SrcPtr++;
-			if (PxCount & 0x80)
-			{
-BlitTransparent: // skip transparent pixels
-				PxCount &= 0x7F;
-				if (PxCount > LSCount) PxCount = LSCount;
-				LSCount -= PxCount;
-				DestPtr += 2 * PxCount;
-			}
-			else
-			{
-BlitNonTransLoop: // blit non-transparent pixels
-				SrcPtr += PxCount;
-				if (PxCount > LSCount) PxCount = LSCount;
-				LSCount -= PxCount;
-
-				do
-				{
-					*(UINT16*)DestPtr = ShadeTable[*(UINT16*)DestPtr];
-					DestPtr += 2;
-				}
-				while (--PxCount > 0);
-			}
-		}
-
-		while (*SrcPtr++ != 0) {} // skip along until we hit and end-of-line marker
-		DestPtr += LineSkip;
-	}
-	while (--BlitHeight > 0);
-}
-
-
-void Blt16BPPBufferFilterRect(UINT16* pBuffer, UINT32 uiDestPitchBYTES, const UINT16* filter_table, SGPRect* area)
-{
-INT32  width, height;
-UINT32 LineSkip;
-UINT16 *DestPtr;
-
-	// Assertions
-	Assert( pBuffer != NULL );
-
-	// Clipping
-	if( area->iLeft < ClippingRect.iLeft )
-		area->iLeft = ClippingRect.iLeft;
-	if( area->iTop < ClippingRect.iTop )
-		area->iTop = ClippingRect.iTop;
-	if( area->iRight >= ClippingRect.iRight )
-		area->iRight = ClippingRect.iRight - 1;
-	if( area->iBottom >= ClippingRect.iBottom )
-		area->iBottom = ClippingRect.iBottom - 1;
-	//CHECKF(area->iLeft >= ClippingRect.iLeft );
-	//CHECKF(area->iTop >= ClippingRect.iTop );
-	//CHECKF(area->iRight <= ClippingRect.iRight );
-	//CHECKF(area->iBottom <= ClippingRect.iBottom );
-
-	DestPtr=(pBuffer+(area->iTop*(uiDestPitchBYTES/2))+area->iLeft);
-	width=area->iRight-area->iLeft+1;
-	height=area->iBottom-area->iTop+1;
-	LineSkip=(uiDestPitchBYTES-(width*2));
-
-	CHECKV(width  >= 1);
-	CHECKV(height >= 1);
-
-	do
-	{
-		UINT32 w = width;
-
-		do
-		{
-			*DestPtr = filter_table[*DestPtr];
-			DestPtr++;
-		}
-		while (--w > 0);
-		DestPtr = (UINT16*)((UINT8*)DestPtr + LineSkip);
-	}
-	while (--height > 0);
-}
-
-
-/**********************************************************************************************
-BltIsClippedOrOffScreen
-
-	Determines whether a given blit will need clipping or not. Returns TRUE/FALSE.
-
-**********************************************************************************************/
-CHAR8 BltIsClippedOrOffScreen( HVOBJECT hSrcVObject, INT32 iX, INT32 iY, UINT16 usIndex, SGPRect *clipregion )
-{
-	INT32  ClipX1, ClipY1, ClipX2, ClipY2;
-
-	// Assertions
-	Assert( hSrcVObject != NULL );
-
-	// Get Offsets from Index into structure
-	ETRLEObject const& pTrav = hSrcVObject->SubregionProperties(usIndex);
-	UINT32      const  usHeight = pTrav.usHeight;
-	UINT32      const  usWidth  = pTrav.usWidth;
-
-	// Add to start position of dest buffer
-	INT32 const iTempX = iX + pTrav.sOffsetX;
-	INT32 const iTempY = iY + pTrav.sOffsetY;
-
-	if(clipregion==NULL)
-	{
-		ClipX1=ClippingRect.iLeft;
-		ClipY1=ClippingRect.iTop;
-		ClipX2=ClippingRect.iRight;
-		ClipY2=ClippingRect.iBottom;
-	}
-	else
-	{
-		ClipX1=clipregion->iLeft;
-		ClipY1=clipregion->iTop;
-		ClipX2=clipregion->iRight;
-		ClipY2=clipregion->iBottom;
-	}
-
-
-	// Calculate rows hanging off each side of the screen
-	INT32 gLeftSkip   = __min(ClipX1 -   MIN(ClipX1, iTempX), (INT32)usWidth);
-	INT32 gTopSkip    = __min(ClipY1 - __min(ClipY1, iTempY), (INT32)usHeight);
-	INT32 gRightSkip  = __min(  MAX(ClipX2, iTempX + (INT32)usWidth)  - ClipX2, (INT32)usWidth);
-	INT32 gBottomSkip = __min(__max(ClipY2, iTempY + (INT32)usHeight) - ClipY2, (INT32)usHeight);
-
-	// check if whole thing is clipped
-	if((gLeftSkip >=(INT32)usWidth) || (gRightSkip >=(INT32)usWidth))
-		return(-1 );
-
-	// check if whole thing is clipped
-	if((gTopSkip >=(INT32)usHeight) || (gBottomSkip >=(INT32)usHeight))
-		return(-1 );
-
-
-	if ( gLeftSkip )
-		return( TRUE );
-
-	if ( gRightSkip )
-		return( TRUE );
-
-	if ( gTopSkip )
-		return( TRUE );
-
-	if ( gBottomSkip )
-		return( TRUE );
-
-
-	return(FALSE);
-}
-
-
-// ATE New blitter for rendering a differrent color for value 254. Can be transparent if outline is SGP_TRANSPARENT
-void Blt8BPPDataTo16BPPBufferOutline(UINT16* const buf, UINT32 const uiDestPitchBYTES, SGPVObject const* const hSrcVObject, INT32 const iX, INT32 const iY, UINT16 const usIndex, INT16 const outline)
-{
-	Assert(hSrcVObject);
-	Assert(buf);
-
-	// Get offsets from index into structure
-	ETRLEObject const& e      = hSrcVObject->SubregionProperties(usIndex);
-	UINT32             height = e.usHeight;
-	UINT32      const  width  = e.usWidth;
-
-	// Add to start position of dest buffer
-	INT32 const x = iX + e.sOffsetX;
-	INT32 const y = iY + e.sOffsetY;
-
-	CHECKV(x >= 0);
-	CHECKV(y >= 0);
-
-	UINT8  const*       src       = hSrcVObject->PixData(e);
-	UINT32        const pitch     = uiDestPitchBYTES / 2;
-	UINT16*             dst       = buf + pitch * y + x;
-	UINT32              line_skip = pitch - width;
-	UINT16 const* const pal       = hSrcVObject->CurrentShade();
-
-	for (;;)
-	{
-		UINT8 data = *src++;
-		if (data == 0)
-		{
-			if (--height == 0) break;
-			dst += line_skip;
-		}
-		else if (data & 0x80)
-		{
-			dst += data & 0x7F;
-		}
-		else
-		{
-			do
-			{
-				UINT8 const px = *src++;
-				if (px != 254)
-				{
-					*dst = pal[px];
-				}
-				else if (outline != SGP_TRANSPARENT)
-				{
-					*dst = outline;
-				}
-				++dst;
-			}
-			while (--data != 0);
-		}
-	}
-}
-
-
-// ATE New blitter for rendering a differrent color for value 254. Can be transparent if s16BPPColor is SGP_TRANSPARENT
-void Blt8BPPDataTo16BPPBufferOutlineClip(UINT16* const pBuffer, const UINT32 uiDestPitchBYTES, const SGPVObject* const hSrcVObject, const INT32 iX, const INT32 iY, const UINT16 usIndex, const INT16 s16BPPColor, const SGPRect* const clipregion)
-{
-	UINT32 Unblitted;
-	UINT8  *DestPtr;
-	UINT32 LineSkip;
-	INT32  LeftSkip, RightSkip, TopSkip, BottomSkip, BlitLength, BlitHeight, LSCount;
-	INT32  ClipX1, ClipY1, ClipX2, ClipY2;
-
-	// Assertions
-	Assert( hSrcVObject != NULL );
-	Assert( pBuffer != NULL );
-
-	// Get Offsets from Index into structure
-	ETRLEObject const& pTrav = hSrcVObject->SubregionProperties(usIndex);
-	UINT32      const  usHeight = pTrav.usHeight;
-	UINT32      const  usWidth  = pTrav.usWidth;
-
-	// Add to start position of dest buffer
-	INT32 const iTempX = iX + pTrav.sOffsetX;
-	INT32 const iTempY = iY + pTrav.sOffsetY;
-
-	if(clipregion==NULL)
-	{
-		ClipX1=ClippingRect.iLeft;
-		ClipY1=ClippingRect.iTop;
-		ClipX2=ClippingRect.iRight;
-		ClipY2=ClippingRect.iBottom;
-	}
-	else
-	{
-		ClipX1=clipregion->iLeft;
-		ClipY1=clipregion->iTop;
-		ClipX2=clipregion->iRight;
-		ClipY2=clipregion->iBottom;
-	}
-
-	// Calculate rows hanging off each side of the screen
-	LeftSkip=__min(ClipX1 - MIN(ClipX1, iTempX), (INT32)usWidth);
-	RightSkip=__min(MAX(ClipX2, (iTempX+(INT32)usWidth)) - ClipX2, (INT32)usWidth);
-	TopSkip=__min(ClipY1 - __min(ClipY1, iTempY), (INT32)usHeight);
-	BottomSkip=__min(__max(ClipY2, (iTempY+(INT32)usHeight)) - ClipY2, (INT32)usHeight);
-
-	// calculate the remaining rows and columns to blit
-	BlitLength=((INT32)usWidth-LeftSkip-RightSkip);
-	BlitHeight=((INT32)usHeight-TopSkip-BottomSkip);
-
-	// check if whole thing is clipped
-	if((LeftSkip >=(INT32)usWidth) || (RightSkip >=(INT32)usWidth))
-		return;
-
-	// check if whole thing is clipped
-	if((TopSkip >=(INT32)usHeight) || (BottomSkip >=(INT32)usHeight))
-		return;
-
-	UINT8 const* SrcPtr = hSrcVObject->PixData(pTrav);
-	DestPtr = (UINT8 *)pBuffer + (uiDestPitchBYTES*(iTempY+TopSkip)) + ((iTempX+LeftSkip)*2);
-	LineSkip=(uiDestPitchBYTES-(BlitLength*2));
-	UINT16 const* const p16BPPPalette = hSrcVObject->CurrentShade();
-
-	UINT32 PxCount;
-
-	while (TopSkip > 0)
-	{
-		for (;;)
-		{
-			PxCount = *SrcPtr++;
-			if (PxCount & 0x80) continue;
-			if (PxCount == 0) break;
-			SrcPtr += PxCount;
-		}
-		TopSkip--;
-	}
-
-	do
-	{
-		for (LSCount = LeftSkip; LSCount > 0; LSCount -= PxCount)
-		{
-			PxCount = *SrcPtr++;
-			if (PxCount & 0x80)
-			{
-				PxCount &= 0x7F;
-				if (PxCount > LSCount)
-				{
-					PxCount -= LSCount;
-					LSCount = BlitLength;
-					goto BlitTransparent;
-				}
-			}
-			else
-			{
-				if (PxCount > LSCount)
-				{
-					SrcPtr += LSCount;
-					PxCount -= LSCount;
-					LSCount = BlitLength;
-					goto BlitNonTransLoop;
-				}
-				SrcPtr += PxCount;
-			}
-		}
-
-		LSCount = BlitLength;
-		while (LSCount > 0)
-		{
-			PxCount = *SrcPtr++;
-			if (PxCount & 0x80)
-			{
-BlitTransparent: // skip transparent pixels
-				PxCount &= 0x7F;
-				if (PxCount > LSCount) PxCount = LSCount;
-				LSCount -= PxCount;
-				DestPtr += 2 * PxCount;
-			}
-			else
-			{
-BlitNonTransLoop: // blit non-transparent pixels
-				if (PxCount > LSCount)
-				{
-					Unblitted = PxCount - LSCount;
-					PxCount = LSCount;
-				}
-				else
-				{
-					Unblitted = 0;
-				}
-				LSCount -= PxCount;
-
-				do
-				{
-					UINT32 src = *SrcPtr++;
-
-					if (src != 254)
-					{
-						*(UINT16*)DestPtr = p16BPPPalette[src];
-					}
-					else if (s16BPPColor != SGP_TRANSPARENT)
-					{
-						*(UINT16*)DestPtr = s16BPPColor;
-					}
-					DestPtr += 2;
-				}
-				while (--PxCount > 0);
-				SrcPtr += Unblitted;
-			}
-		}
-
-		while (*SrcPtr++ != 0) {} // skip along until we hit and end-of-line marker
-		DestPtr += LineSkip;
-	}
-	while (--BlitHeight > 0);
-}
-
-
-void Blt8BPPDataTo16BPPBufferOutlineZClip(UINT16* const pBuffer, const UINT32 uiDestPitchBYTES, UINT16* const pZBuffer, const UINT16 usZValue, const HVOBJECT hSrcVObject, const INT32 iX, const INT32 iY, const UINT16 usIndex, const INT16 s16BPPColor, const SGPRect* const clipregion)
-{
-	UINT32 Unblitted;
-	UINT8  *DestPtr, *ZPtr;
-	UINT32 LineSkip;
-	INT32  LeftSkip, RightSkip, TopSkip, BottomSkip, BlitLength, BlitHeight, LSCount;
-	INT32  ClipX1, ClipY1, ClipX2, ClipY2;
-
-	// Assertions
-	Assert( hSrcVObject != NULL );
-	Assert( pBuffer != NULL );
-
-	// Get Offsets from Index into structure
-	ETRLEObject const& pTrav = hSrcVObject->SubregionProperties(usIndex);
-	UINT32      const  usHeight = pTrav.usHeight;
-	UINT32      const  usWidth  = pTrav.usWidth;
-
-	// Add to start position of dest buffer
-	INT32 const iTempX = iX + pTrav.sOffsetX;
-	INT32 const iTempY = iY + pTrav.sOffsetY;
-
-	if(clipregion==NULL)
-	{
-		ClipX1=ClippingRect.iLeft;
-		ClipY1=ClippingRect.iTop;
-		ClipX2=ClippingRect.iRight;
-		ClipY2=ClippingRect.iBottom;
-	}
-	else
-	{
-		ClipX1=clipregion->iLeft;
-		ClipY1=clipregion->iTop;
-		ClipX2=clipregion->iRight;
-		ClipY2=clipregion->iBottom;
-	}
-
-	// Calculate rows hanging off each side of the screen
-	LeftSkip=__min(ClipX1 - MIN(ClipX1, iTempX), (INT32)usWidth);
-	RightSkip=__min(MAX(ClipX2, (iTempX+(INT32)usWidth)) - ClipX2, (INT32)usWidth);
-	TopSkip=__min(ClipY1 - __min(ClipY1, iTempY), (INT32)usHeight);
-	BottomSkip=__min(__max(ClipY2, (iTempY+(INT32)usHeight)) - ClipY2, (INT32)usHeight);
-
-	// calculate the remaining rows and columns to blit
-	BlitLength=((INT32)usWidth-LeftSkip-RightSkip);
-	BlitHeight=((INT32)usHeight-TopSkip-BottomSkip);
-
-	// check if whole thing is clipped
-	if((LeftSkip >=(INT32)usWidth) || (RightSkip >=(INT32)usWidth))
-		return;
-
-	// check if whole thing is clipped
-	if((TopSkip >=(INT32)usHeight) || (BottomSkip >=(INT32)usHeight))
-		return;
-
-	UINT8 const* SrcPtr = hSrcVObject->PixData(pTrav);
-	DestPtr = (UINT8 *)pBuffer + (uiDestPitchBYTES*(iTempY+TopSkip)) + ((iTempX+LeftSkip)*2);
-	ZPtr = (UINT8 *)pZBuffer + (uiDestPitchBYTES*(iTempY+TopSkip)) + ((iTempX+LeftSkip)*2);
-
-	LineSkip=(uiDestPitchBYTES-(BlitLength*2));
-	UINT16 const* const p16BPPPalette = hSrcVObject->CurrentShade();
-
-	UINT32 PxCount;
-
-	while (TopSkip > 0)
-	{
-		for (;;)
-		{
-			PxCount = *SrcPtr++;
-			if (PxCount & 0x80) continue;
-			if (PxCount == 0) break;
-			SrcPtr += PxCount;
-		}
-		TopSkip--;
-	}
-
-	do
-	{
-		for (LSCount = LeftSkip; LSCount > 0; LSCount -= PxCount)
-		{
-			PxCount = *SrcPtr++;
-			if (PxCount & 0x80)
-			{
-				PxCount &= 0x7F;
-				if (PxCount > LSCount)
-				{
-					PxCount -= LSCount;
-					LSCount = BlitLength;
-					goto BlitTransparent;
-				}
-			}
-			else
-			{
-				if (PxCount > LSCount)
-				{
-					SrcPtr += LSCount;
-					PxCount -= LSCount;
-					LSCount = BlitLength;
-					goto BlitNonTransLoop;
-				}
-				SrcPtr += PxCount;
-			}
-		}
-
-		LSCount = BlitLength;
-		while (LSCount > 0)
-		{
-			PxCount = *SrcPtr++;
-			if (PxCount & 0x80)
-			{
-BlitTransparent: // skip transparent pixels
-				PxCount &= 0x7F;
-				if (PxCount > LSCount) PxCount = LSCount;
-				LSCount -= PxCount;
-				DestPtr += 2 * PxCount;
-				ZPtr    += 2 * PxCount;
-			}
-			else
-			{
-BlitNonTransLoop: // blit non-transparent pixels
-				if (PxCount > LSCount)
-				{
-					Unblitted = PxCount - LSCount;
-					PxCount = LSCount;
-				}
-				else
-				{
-					Unblitted = 0;
-				}
-				LSCount -= PxCount;
-
-				do
-				{
-					if (*(UINT16*)ZPtr <= usZValue)
-					{
-						UINT32 src = *SrcPtr;
-
-						if (src != 254)
-						{
-							*(UINT16*)ZPtr = usZValue;
-							*(UINT16*)DestPtr = p16BPPPalette[src];
-						}
-						else
-						{
-							*(UINT16*)DestPtr = s16BPPColor;
-						}
-					}
-					SrcPtr++;
-					DestPtr += 2;
-					ZPtr += 2;
-				}
-				while (--PxCount > 0);
-				SrcPtr += Unblitted;
-			}
-		}
-
-		while (*SrcPtr++ != 0) {} // skip along until we hit an end-of-line marker
-		DestPtr += LineSkip;
-		ZPtr += LineSkip;
-	}
-	while (--BlitHeight > 0);
-}
-
-
-void Blt8BPPDataTo16BPPBufferOutlineZPixelateObscuredClip(UINT16* const pBuffer, const UINT32 uiDestPitchBYTES, UINT16* const pZBuffer, const UINT16 usZValue, const HVOBJECT hSrcVObject, const INT32 iX, const INT32 iY, const UINT16 usIndex, const INT16 s16BPPColor, const SGPRect* const clipregion)
-{
-	UINT32 Unblitted;
-	UINT8  *DestPtr, *ZPtr;
-	UINT32 LineSkip;
-	INT32  LeftSkip, RightSkip, TopSkip, BottomSkip, BlitLength, BlitHeight, LSCount;
-	INT32  ClipX1, ClipY1, ClipX2, ClipY2;
-	UINT32 uiLineFlag;
-
-	// Assertions
-	Assert( hSrcVObject != NULL );
-	Assert( pBuffer != NULL );
-
-	// Get Offsets from Index into structure
-	ETRLEObject const& pTrav = hSrcVObject->SubregionProperties(usIndex);
-	UINT32      const  usHeight = pTrav.usHeight;
-	UINT32      const  usWidth  = pTrav.usWidth;
-
-	// Add to start position of dest buffer
-	INT32 const iTempX = iX + pTrav.sOffsetX;
-	INT32 const iTempY = iY + pTrav.sOffsetY;
-
-	if(clipregion==NULL)
-	{
-		ClipX1=ClippingRect.iLeft;
-		ClipY1=ClippingRect.iTop;
-		ClipX2=ClippingRect.iRight;
-		ClipY2=ClippingRect.iBottom;
-	}
-	else
-	{
-		ClipX1=clipregion->iLeft;
-		ClipY1=clipregion->iTop;
-		ClipX2=clipregion->iRight;
-		ClipY2=clipregion->iBottom;
-	}
-
-	// Calculate rows hanging off each side of the screen
-	LeftSkip=__min(ClipX1 - MIN(ClipX1, iTempX), (INT32)usWidth);
-	RightSkip=__min(MAX(ClipX2, (iTempX+(INT32)usWidth)) - ClipX2, (INT32)usWidth);
-	TopSkip=__min(ClipY1 - __min(ClipY1, iTempY), (INT32)usHeight);
-	BottomSkip=__min(__max(ClipY2, (iTempY+(INT32)usHeight)) - ClipY2, (INT32)usHeight);
-
-	// calculate the remaining rows and columns to blit
-	BlitLength=((INT32)usWidth-LeftSkip-RightSkip);
-	BlitHeight=((INT32)usHeight-TopSkip-BottomSkip);
-
-	// check if whole thing is clipped
-	if((LeftSkip >=(INT32)usWidth) || (RightSkip >=(INT32)usWidth))
-		return;
-
-	// check if whole thing is clipped
-	if((TopSkip >=(INT32)usHeight) || (BottomSkip >=(INT32)usHeight))
-		return;
-
-	UINT8 const* SrcPtr = hSrcVObject->PixData(pTrav);
-	DestPtr = (UINT8 *)pBuffer + (uiDestPitchBYTES*(iTempY+TopSkip)) + ((iTempX+LeftSkip)*2);
-	ZPtr = (UINT8 *)pZBuffer + (uiDestPitchBYTES*(iTempY+TopSkip)) + ((iTempX+LeftSkip)*2);
-
-	LineSkip=(uiDestPitchBYTES-(BlitLength*2));
-	UINT16 const* const p16BPPPalette = hSrcVObject->CurrentShade();
-	uiLineFlag=(iTempY&1);
-
-
-	uiLineFlag = (iTempY + TopSkip) & 1;
-
-	UINT32 PxCount;
-
-	while (TopSkip > 0)
-	{
-		for (;;)
-		{
-			PxCount = *SrcPtr++;
-			if (PxCount & 0x80) continue;
-			if (PxCount == 0) break;
-			SrcPtr += PxCount;
-		}
-		TopSkip--;
-	}
-
-	do
-	{
-		for (LSCount = LeftSkip; LSCount > 0; LSCount -= PxCount)
-		{
-			PxCount = *SrcPtr++;
-			if (PxCount & 0x80)
-			{
-				PxCount &= 0x7F;
-				if (PxCount > LSCount)
-				{
-					PxCount -= LSCount;
-					LSCount = BlitLength;
-					goto BlitTransparent;
-				}
-			}
-			else
-			{
-				if (PxCount > LSCount)
-				{
-					SrcPtr += LSCount;
-					PxCount -= LSCount;
-					LSCount = BlitLength;
-					goto BlitNonTransLoop;
-				}
-				SrcPtr += PxCount;
-			}
-		}
-
-		LSCount = BlitLength;
-		while (LSCount > 0)
-		{
-			PxCount = *SrcPtr++;
-			if (PxCount & 0x80)
-			{
-BlitTransparent: // skip transparent pixels
-				PxCount &= 0x7F;
-				if (PxCount > LSCount) PxCount = LSCount;
-				LSCount -= PxCount;
-				DestPtr += 2 * PxCount;
-				ZPtr    += 2 * PxCount;
-			}
-			else
-			{
-BlitNonTransLoop: // blit non-transparent pixels
-				if (PxCount > LSCount)
-				{
-					Unblitted = PxCount - LSCount;
-					PxCount = LSCount;
-				}
-				else
-				{
-					Unblitted = 0;
-				}
-				LSCount -= PxCount;
-
-				do
-				{
-					if (*(UINT16*)ZPtr <= usZValue)
-					{
-						*(UINT16*)ZPtr = usZValue;
-					}
-					else
-					{
-						// XXX original code updates Z value in one of two cases on this path, seems wrong
-						if (uiLineFlag != (((uintptr_t)DestPtr & 2) != 0)) continue;
-					}
-
-					UINT8 px = *SrcPtr;
-					if (px == 254)
-					{
-						*(UINT16*)DestPtr = s16BPPColor;
-					}
-					else
-					{
-						// XXX original code writes garbage (lower 8 bit are the colour index) into the Z buffer at this point
-						*(UINT16*)DestPtr = p16BPPPalette[px];
-					}
-				}
-				while (SrcPtr++, DestPtr += 2, ZPtr += 2, --PxCount > 0);
-				SrcPtr += Unblitted;
-			}
-		}
-
-		while (*SrcPtr++ != 0) {} // skip along until we hit and end-of-line marker
-		DestPtr += LineSkip;
-		ZPtr += LineSkip;
-		uiLineFlag ^= 1;
-	}
-	while (--BlitHeight > 0);
-}
-
-
-void Blt8BPPDataTo16BPPBufferOutlineShadow(UINT16* const pBuffer, const UINT32 uiDestPitchBYTES, const SGPVObject* const hSrcVObject, const INT32 iX, const INT32 iY, const UINT16 usIndex)
-{
-	UINT8  *DestPtr;
-	UINT32 LineSkip;
-
-	// Assertions
-	Assert( hSrcVObject != NULL );
-	Assert( pBuffer != NULL );
-
-	// Get Offsets from Index into structure
-	ETRLEObject const& pTrav = hSrcVObject->SubregionProperties(usIndex);
-	UINT32             usHeight = pTrav.usHeight;
-	UINT32      const  usWidth  = pTrav.usWidth;
-
-	// Add to start position of dest buffer
-	INT32 const iTempX = iX + pTrav.sOffsetX;
-	INT32 const iTempY = iY + pTrav.sOffsetY;
-
-	// Validations
-	CHECKV(iTempX >= 0);
-	CHECKV(iTempY >= 0);
-
-	UINT8 const* SrcPtr = hSrcVObject->PixData(pTrav);
-	DestPtr = (UINT8 *)pBuffer + (uiDestPitchBYTES*iTempY) + (iTempX*2);
-	LineSkip=(uiDestPitchBYTES-(usWidth*2));
-
-	do
-	{
-		for (;;)
-		{
-			UINT8 data = *SrcPtr++;
-
-			if (data == 0) break;
-			if (data & 0x80)
-			{
-				data &= 0x7F;
-				DestPtr += data * 2;
-			}
-			else
-			{
-				do
-				{
-					if (*SrcPtr++ != 254)
-					{
-						*(UINT16*)DestPtr = ShadeTable[*(UINT16*)DestPtr];
-					}
-					DestPtr += 2;
-				}
-				while (--data > 0);
-			}
-		}
-		DestPtr += LineSkip;
-	}
-	while (--usHeight > 0);
-}
-
-
-void Blt8BPPDataTo16BPPBufferOutlineShadowClip(UINT16* const pBuffer, const UINT32 uiDestPitchBYTES, const SGPVObject* const hSrcVObject, const INT32 iX, const INT32 iY, const UINT16 usIndex, const SGPRect* const clipregion)
-{
-#if 1 // XXX TODO
-	UNIMPLEMENTED
-#else
-	UINT8  *DestPtr;
-	UINT32 LineSkip;
-	INT32  LeftSkip, RightSkip, TopSkip, BottomSkip, BlitLength, BlitHeight;
-	INT32  ClipX1, ClipY1, ClipX2, ClipY2;
-
-	// Assertions
-	Assert( hSrcVObject != NULL );
-	Assert( pBuffer != NULL );
-
-	// Get Offsets from Index into structure
-	ETRLEObject const& pTrav = hSrcVObject->SubregionProperties(usIndex);
-	UINT32      const  usHeight = pTrav.usHeight;
-	UINT32      const  usWidth  = pTrav.usWidth;
-
-	// Add to start position of dest buffer
-	INT32 const iTempX = iX + pTrav.sOffsetX;
-	INT32 const iTempY = iY + pTrav.sOffsetY;
-
-	if(clipregion==NULL)
-	{
-		ClipX1=ClippingRect.iLeft;
-		ClipY1=ClippingRect.iTop;
-		ClipX2=ClippingRect.iRight;
-		ClipY2=ClippingRect.iBottom;
-	}
-	else
-	{
-		ClipX1=clipregion->iLeft;
-		ClipY1=clipregion->iTop;
-		ClipX2=clipregion->iRight;
-		ClipY2=clipregion->iBottom;
-	}
-
-	// Calculate rows hanging off each side of the screen
-	LeftSkip=__min(ClipX1 - MIN(ClipX1, iTempX), (INT32)usWidth);
-	RightSkip=__min(MAX(ClipX2, (iTempX+(INT32)usWidth)) - ClipX2, (INT32)usWidth);
-	TopSkip=__min(ClipY1 - __min(ClipY1, iTempY), (INT32)usHeight);
-	BottomSkip=__min(__max(ClipY2, (iTempY+(INT32)usHeight)) - ClipY2, (INT32)usHeight);
-
-	// calculate the remaining rows and columns to blit
-	BlitLength=((INT32)usWidth-LeftSkip-RightSkip);
-	BlitHeight=((INT32)usHeight-TopSkip-BottomSkip);
-
-	// whole thing is clipped
-	if((LeftSkip >=(INT32)usWidth) || (RightSkip >=(INT32)usWidth))
-		return;
-
-	// whole thing is clipped
-	if((TopSkip >=(INT32)usHeight) || (BottomSkip >=(INT32)usHeight))
-		return;
-
-	UINT8 const* SrcPtr = hSrcVObject->PixData(pTrav);
-	DestPtr = (UINT8 *)pBuffer + (uiDestPitchBYTES*(iTempY+TopSkip)) + ((iTempX+LeftSkip)*2);
-	LineSkip=(uiDestPitchBYTES-(BlitLength*2));
-
-	UINT32 Unblitted;
-	__asm {
-
-		mov		esi, SrcPtr
-		mov		edi, DestPtr
-		mov		edx, OFFSET ShadeTable
-		xor		eax, eax
-		mov		ebx, TopSkip
-		xor		ecx, ecx
-
-		or		ebx, ebx		// check for nothing clipped on top
-		jz		LeftSkipSetup
-
-TopSkipLoop:						// Skips the number of lines clipped at the top
-
-		mov		cl, [esi]
-		inc		esi
-		or		cl, cl
-		js		TopSkipLoop
-		jz		TSEndLine
-
-
-// Check for outline as well
-		mov		cl, [esi]
-		cmp		cl, 254
-		je		TopSkipLoop
-//
-
-		add		esi, ecx
-		jmp		TopSkipLoop
-
-TSEndLine:
-		dec		ebx
-		jnz		TopSkipLoop
-
-
-
-
-LeftSkipSetup:
-
-		mov		Unblitted, 0
-		mov		ebx, LeftSkip		// check for nothing clipped on the left
-		or		ebx, ebx
-		jz		BlitLineSetup
-
-LeftSkipLoop:
-
-		mov		cl, [esi]
-		inc		esi
-
-		or		cl, cl
-		js		LSTrans
-
-		cmp		ecx, ebx
-		je		LSSkip2			// if equal, skip whole, and start blit with new run
-		jb		LSSkip1			// if less, skip whole thing
-
-		add		esi, ebx		// skip partial run, jump into normal loop for rest
-		sub		ecx, ebx
-		mov		ebx, BlitLength
-		mov		Unblitted, 0
-		jmp		BlitNonTransLoop
-
-LSSkip2:
-		add		esi, ecx		// skip whole run, and start blit with new run
-		jmp		BlitLineSetup
-
-
-LSSkip1:
-		add		esi, ecx		// skip whole run, continue skipping
-		sub		ebx, ecx
-		jmp		LeftSkipLoop
-
-
-LSTrans:
-		and		ecx, 07fH
-		cmp		ecx, ebx
-		je		BlitLineSetup		// if equal, skip whole, and start blit with new run
-		jb		LSTrans1		// if less, skip whole thing
-
-		sub		ecx, ebx		// skip partial run, jump into normal loop for rest
-		mov		ebx, BlitLength
-		jmp		BlitTransparent
-
-
-LSTrans1:
-		sub		ebx, ecx		// skip whole run, continue skipping
-		jmp		LeftSkipLoop
-
-
-
-
-BlitLineSetup:						// Does any actual blitting (trans/non) for the line
-		mov		ebx, BlitLength
-		mov		Unblitted, 0
-
-BlitDispatch:
-
-		or		ebx, ebx		// Check to see if we're done blitting
-		jz		RightSkipLoop
-
-		mov		cl, [esi]
-		inc		esi
-		or		cl, cl
-		js		BlitTransparent
-
-BlitNonTransLoop:
-
-		cmp		ecx, ebx
-		jbe		BNTrans1
-
-		sub		ecx, ebx
-		mov		Unblitted, ecx
-		mov		ecx, ebx
-
-BNTrans1:
-		sub		ebx, ecx
-
-		clc
-		rcr		cl, 1
-		jnc		BlitNTL2
-
-		mov		ax, [edi]
-		mov		ax, [edx+eax*2]
-		mov		[edi], ax
-
-		inc		esi
-		add		edi, 2
-
-BlitNTL2:
-		clc
-		rcr		cl, 1
-		jnc		BlitNTL3
-
-		mov		ax, [edi]
-		mov		ax, [edx+eax*2]
-		mov		[edi], ax
-
-		mov		ax, [edi+2]
-		mov		ax, [edx+eax*2]
-		mov		[edi+2], ax
-
-		add		esi, 2
-		add		edi, 4
-
-BlitNTL3:
-
-		or		cl, cl
-		jz		BlitLineEnd
-
-BlitNTL4:
-
-		mov		ax, [edi]
-		mov		ax, [edx+eax*2]
-		mov		[edi], ax
-
-		mov		ax, [edi+2]
-		mov		ax, [edx+eax*2]
-		mov		[edi+2], ax
-
-		mov		ax, [edi+4]
-		mov		ax, [edx+eax*2]
-		mov		[edi+4], ax
-
-		mov		ax, [edi+6]
-		mov		ax, [edx+eax*2]
-		mov		[edi+6], ax
-
-		add		esi, 4
-		add		edi, 8
-		dec		cl
-		jnz		BlitNTL4
-
-BlitLineEnd:
-		add		esi, Unblitted
-		jmp		BlitDispatch
-
-BlitTransparent:
-
-		and		ecx, 07fH
-		cmp		ecx, ebx
-		jbe		BTrans1
-
-		mov		ecx, ebx
-
-BTrans1:
-
-		sub		ebx, ecx
-//		shl		ecx, 1
-		add   ecx, ecx
-		add		edi, ecx
-		jmp		BlitDispatch
-
-
-RightSkipLoop:
-
-
-RSLoop1:
-		mov		al, [esi]
-		inc		esi
-		or		al, al
-		jnz		RSLoop1
-
-		dec		BlitHeight
-		jz		BlitDone
-		add		edi, LineSkip
-
-		jmp		LeftSkipSetup
-
-
-BlitDone:
-	}
-#endif
-}
-
-
-void Blt8BPPDataTo16BPPBufferOutlineZ(UINT16* const pBuffer, const UINT32 uiDestPitchBYTES, UINT16* const pZBuffer, const UINT16 usZValue, const HVOBJECT hSrcVObject, const INT32 iX, const INT32 iY, const UINT16 usIndex, const INT16 s16BPPColor)
-{
-	UINT8  *DestPtr, *ZPtr;
-	UINT32 LineSkip;
-
-	// Assertions
-	Assert( hSrcVObject != NULL );
-	Assert( pBuffer != NULL );
-
-	// Get Offsets from Index into structure
-	ETRLEObject const& pTrav = hSrcVObject->SubregionProperties(usIndex);
-	UINT32             usHeight = pTrav.usHeight;
-	UINT32      const  usWidth  = pTrav.usWidth;
-
-	// Add to start position of dest buffer
-	INT32 const iTempX = iX + pTrav.sOffsetX;
-	INT32 const iTempY = iY + pTrav.sOffsetY;
-
-	// Validations
-	CHECKV(iTempX >= 0);
-	CHECKV(iTempY >= 0);
-
-	UINT8 const* SrcPtr = hSrcVObject->PixData(pTrav);
-	DestPtr = (UINT8 *)pBuffer + (uiDestPitchBYTES*iTempY) + (iTempX*2);
-	ZPtr = (UINT8 *)pZBuffer + (uiDestPitchBYTES*iTempY) + (iTempX*2);
-	UINT16 const* const p16BPPPalette = hSrcVObject->CurrentShade();
-	LineSkip=(uiDestPitchBYTES-(usWidth*2));
-
-#if 1 // XXX TODO
-	do
-	{
-		for (;;)
-		{
-			UINT8 data = *SrcPtr++;
-
-			if (data == 0) break;
-			if (data & 0x80)
-			{
-				data &= 0x7F;
-				DestPtr += 2 * data;
-				ZPtr += 2 * data;
-			}
-			else
-			{
-				do
-				{
-					if (*(UINT16*)ZPtr <= usZValue)
-					{
-						UINT8 px = *SrcPtr;
-
-						if (px == 254)
-						{
-							*(UINT16*)DestPtr = s16BPPColor;
-						}
-						else
-						{
-							*(UINT16*)ZPtr = usZValue; // XXX TODO original code writes garbage into the Z buffer, but comment says don't write at all
-							*(UINT16*)DestPtr = p16BPPPalette[px];
-						}
-					}
-					SrcPtr++;
-					DestPtr += 2;
-					ZPtr += 2;
-				}
-				while (--data > 0);
-			}
-		}
-		DestPtr += LineSkip;
-		ZPtr += LineSkip;
-	}
-	while (--usHeight > 0);
-#else
-	__asm {
-
-		mov		esi, SrcPtr
-		mov		edi, DestPtr
-		mov		edx, p16BPPPalette
-		xor		eax, eax
-		mov		ebx, ZPtr
-		xor		ecx, ecx
-
-BlitDispatch:
-
-		mov		cl, [esi]
-		inc		esi
-		or		cl, cl
-		js		BlitTransparent
-		jz		BlitDoneLine
-
-//BlitNonTransLoop:
-
-		xor		eax, eax
-
-BlitNTL4:
-
-		mov		ax, usZValue
-		cmp		ax, [ebx]
-		jb		BlitNTL5
-
-		// CHECK FOR OUTLINE, BLIT DIFFERENTLY IF WE WANT IT TO!
-		mov		al, [esi]
-		cmp		al, 254
-		jne		BlitNTL6
-
-		//		DO OUTLINE
-		//		ONLY IF WE WANT IT!
-		mov		al, fDoOutline;
-		cmp		al,	1
-		jne		BlitNTL5
-
-		mov		ax, s16BPPColor
-		mov		[edi], ax
-		jmp		BlitNTL5
-
-BlitNTL6:
-
-		//Donot write to z-buffer
-		mov		[ebx], ax
-
-		xor		ah, ah
-		mov		al, [esi]
-		mov		ax, [edx+eax*2]
-		mov		[edi], ax
-
-BlitNTL5:
-		inc		esi
-		inc		edi
-		inc		ebx
-		inc		edi
-		inc		ebx
-
-		dec		cl
-		jnz		BlitNTL4
-
-		jmp		BlitDispatch
-
-
-BlitTransparent:
-
-		and		ecx, 07fH
-//		shl		ecx, 1
-		add   ecx, ecx
-		add		edi, ecx
-		add		ebx, ecx
-		jmp		BlitDispatch
-
-
-BlitDoneLine:
-
-		dec		usHeight
-		jz		BlitDone
-		add		edi, LineSkip
-		add		ebx, LineSkip
-		jmp		BlitDispatch
-
-
-BlitDone:
-	}
-#endif
-}
-
-
-void Blt8BPPDataTo16BPPBufferOutlineZPixelateObscured(UINT16* const pBuffer, const UINT32 uiDestPitchBYTES, UINT16* const pZBuffer, const UINT16 usZValue, const HVOBJECT hSrcVObject, const INT32 iX, const INT32 iY, const UINT16 usIndex, const INT16 s16BPPColor)
-{
-	UINT8  *DestPtr, *ZPtr;
-	UINT32 LineSkip;
-	UINT32 uiLineFlag;
-
-	// Assertions
-	Assert( hSrcVObject != NULL );
-	Assert( pBuffer != NULL );
-
-	// Get Offsets from Index into structure
-	ETRLEObject const& pTrav = hSrcVObject->SubregionProperties(usIndex);
-	UINT32             usHeight = pTrav.usHeight;
-	UINT32      const  usWidth  = pTrav.usWidth;
-
-	// Add to start position of dest buffer
-	INT32 const iTempX = iX + pTrav.sOffsetX;
-	INT32 const iTempY = iY + pTrav.sOffsetY;
-
-	// Validations
-	CHECKV(iTempX >= 0);
-	CHECKV(iTempY >= 0);
-
-	UINT8 const* SrcPtr = hSrcVObject->PixData(pTrav);
-	DestPtr = (UINT8 *)pBuffer + (uiDestPitchBYTES*iTempY) + (iTempX*2);
-	ZPtr = (UINT8 *)pZBuffer + (uiDestPitchBYTES*iTempY) + (iTempX*2);
-	UINT16 const* const p16BPPPalette = hSrcVObject->CurrentShade();
-	LineSkip=(uiDestPitchBYTES-(usWidth*2));
-	uiLineFlag=(iTempY&1);
-
-#if 1 // XXX TODO
-	do
-	{
-		for (;;)
-		{
-			UINT8 data = *SrcPtr++;
-
-			if (data == 0) break;
-			if (data & 0x80)
-			{
-				data &= 0x7F;
-				DestPtr += 2 * data;
-				ZPtr += 2 * data;
-			}
-			else
-			{
-				do
-				{
-					if (*(UINT16*)ZPtr < usZValue)
-					{
-						*(UINT16*)ZPtr = usZValue;
-					}
-					else
-					{
-						// XXX original code updates Z value in one of two cases on this path, seems wrong
-						if (uiLineFlag != (((uintptr_t)DestPtr & 2) != 0)) continue;
-					}
-
-					UINT8 px = *SrcPtr;
-					if (px == 254)
-					{
-						*(UINT16*)DestPtr = s16BPPColor;
-					}
-					else
-					{
-						*(UINT16*)DestPtr = p16BPPPalette[px];
-					}
-				}
-				while (SrcPtr++, DestPtr += 2, ZPtr += 2, --data > 0);
-			}
-		}
-		DestPtr += LineSkip;
-		ZPtr += LineSkip;
-		uiLineFlag ^= 1;
-	}
-	while (--usHeight > 0);
-#else
-	__asm {
-
-		mov		esi, SrcPtr
-		mov		edi, DestPtr
-		mov		edx, p16BPPPalette
-		xor		eax, eax
-		mov		ebx, ZPtr
-		xor		ecx, ecx
-
-BlitDispatch:
-
-		mov		cl, [esi]
-		inc		esi
-		or		cl, cl
-		js		BlitTransparent
-		jz		BlitDoneLine
-
-//BlitNonTransLoop:
-
-		xor		eax, eax
-
-BlitNTL4:
-
-		mov		ax, usZValue
-		cmp		ax, [ebx]
-		jbe		BlitNTL8
-
-		// Write it now!
-		jmp BlitNTL7
-
-BlitNTL8:
-
-		test	uiLineFlag, 1
-		jz		BlitNTL6
-
-		test	edi, 2
-		jz		BlitNTL5
-		jmp		BlitNTL9
-
-
-BlitNTL6:
-
-		test	edi, 2
-		jnz		BlitNTL5
-
-BlitNTL7:
-
-		mov		[ebx], ax
-
-BlitNTL9:
-
-		// CHECK FOR OUTLINE, BLIT DIFFERENTLY IF WE WANT IT TO!
-		mov		al, [esi]
-		cmp		al, 254
-		jne		BlitNTL12
-
-		//		DO OUTLINE
-		//		ONLY IF WE WANT IT!
-		mov		al, fDoOutline;
-		cmp		al,	1
-		jne		BlitNTL5
-
-		mov		ax, s16BPPColor
-		mov		[edi], ax
-		jmp		BlitNTL5
-
-BlitNTL12:
+**********************************************************************************************/
+void Blt8BPPDataTo16BPPBufferShadowZNB( UINT16 *pBuffer, UINT32 uiDestPitchBYTES, UINT16 *pZBuffer, UINT16 usZValue, HVOBJECT hSrcVObject, INT32 iX, INT32 iY, UINT16 usIndex )
+{
+	BltETRLE<false>(pBuffer, uiDestPitchBYTES, hSrcVObject, iX, iY, usIndex, NULL, ETRLEShadeZPolicy<false>(pZBuffer, usZValue));
+}
 
-		xor		ah, ah
-		mov		al, [esi]
-		mov		ax, [edx+eax*2]
-		mov		[edi], ax
 
-BlitNTL5:
-		inc		esi
-		inc		edi
-		inc		ebx
-		inc		edi
-		inc		ebx
+/**********************************************************************************************
+Blt8BPPDataTo16BPPBufferShadowZNBClip
 
-		dec		cl
-		jnz		BlitNTL4
+	Blits an image into the destination buffer, using an ETRLE brush as a source, and a 16-bit
+	buffer as a destination. As it is blitting, it checks the Z value of the ZBuffer, and if the
+	pixel's Z level is below that of the current pixel, it is written on, the Z value is
+	not updated,	for any non-transparent pixels. The Z-buffer is 16 bit, and	must be the
+	same dimensions (including Pitch) as the destination.
 
-		jmp		BlitDispatch
+**********************************************************************************************/
+void Blt8BPPDataTo16BPPBufferShadowZNBClip( UINT16 *pBuffer, UINT32 uiDestPitchBYTES, UINT16 *pZBuffer, UINT16 usZValue, HVOBJECT hSrcVObject, INT32 iX, INT32 iY, UINT16 usIndex, SGPRect *clipregion)
+{
+	BltETRLE<true>(pBuffer, uiDestPitchBYTES, hSrcVObject, iX, iY, usIndex, clipregion, ETRLEShadeZPolicy<false>(pZBuffer, usZValue));
+}
 
 
-BlitTransparent:
+/**********************************************************************************************
+Blt8BPPDataTo16BPPBufferTransZClip
 
-		and		ecx, 07fH
-//		shl		ecx, 1
-		add   ecx, ecx
-		add		edi, ecx
-		add		ebx, ecx
-		jmp		BlitDispatch
+	Blits an image into the destination buffer, using an ETRLE brush as a source, and a 16-bit
+	buffer as a destination. As it is blitting, it checks the Z value of the ZBuffer, and if the
+	pixel's Z level is below that of the current pixel, it is written on, and the Z value is
+	updated to the current value,	for any non-transparent pixels. The Z-buffer is 16 bit, and
+	must be the same dimensions (including Pitch) as the destination.
 
+**********************************************************************************************/
+void Blt8BPPDataTo16BPPBufferTransZClip( UINT16 *pBuffer, UINT32 uiDestPitchBYTES, UINT16 *pZBuffer, UINT16 usZValue, HVOBJECT hSrcVObject, INT32 iX, INT32 iY, UINT16 usIndex, SGPRect *clipregion)
+{
+	BltETRLE<true>(pBuffer, uiDestPitchBYTES, hSrcVObject, iX, iY, usIndex, clipregion, ETRLEPaletteZPolicy<true>(pZBuffer, usZValue, hSrcVObject->CurrentShade()));
+}
 
-BlitDoneLine:
 
-		dec		usHeight
-		jz		BlitDone
-		add		edi, LineSkip
-		add		ebx, LineSkip
-		xor		uiLineFlag, 1
-		jmp		BlitDispatch
+/**********************************************************************************************
+Blt8BPPDataTo16BPPBufferTransZNBClip
 
+	Blits an image into the destination buffer, using an ETRLE brush as a source, and a 16-bit
+	buffer as a destination. As it is blitting, it checks the Z value of the ZBuffer, and if the
+	pixel's Z level is below that of the current pixel, it is written on. The Z value is NOT
+	updated in this version. The Z-buffer is 16 bit, and must be the same dimensions (including Pitch) as the destination.
 
-BlitDone:
-	}
-#endif
+**********************************************************************************************/
+void Blt8BPPDataTo16BPPBufferTransZNBClip( UINT16 *pBuffer, UINT32 uiDestPitchBYTES, UINT16 *pZBuffer, UINT16 usZValue, HVOBJECT hSrcVObject, INT32 iX, INT32 iY, UINT16 usIndex, SGPRect *clipregion)
+{
+	BltETRLE<true>(pBuffer, uiDestPitchBYTES, hSrcVObject, iX, iY, usIndex, clipregion, ETRLEPaletteZPolicy<false>(pZBuffer, usZValue, hSrcVObject->CurrentShade()));
 }
 
 
-// This is the same as above, but DONOT WRITE to Z!
-void Blt8BPPDataTo16BPPBufferOutlineZNB(UINT16* const pBuffer, const UINT32 uiDestPitchBYTES, UINT16* const pZBuffer, const UINT16 usZValue, const HVOBJECT hSrcVObject, const INT32 iX, const INT32 iY, const UINT16 usIndex)
+/* Blit a subrect from a flat 8 bit surface to a 16-bit buffer. */
+void Blt8BPPDataSubTo16BPPBuffer(UINT16* const buf, UINT32 const uiDestPitchBYTES, SGPVSurface* const hSrcVSurface, UINT8* const pSrcBuffer, UINT32 const src_pitch, INT32 const x, INT32 const y, SGPBox const* const rect)
 {
-	UINT8  *DestPtr, *ZPtr;
-	UINT32 LineSkip;
-
-	// Assertions
-	Assert( hSrcVObject != NULL );
-	Assert( pBuffer != NULL );
-
-	// Get Offsets from Index into structure
-	ETRLEObject const& pTrav = hSrcVObject->SubregionProperties(usIndex);
-	UINT32             usHeight = pTrav.usHeight;
-	UINT32      const  usWidth  = pTrav.usWidth;
+	Assert(hSrcVSurface);
+	Assert(pSrcBuffer);
+	Assert(buf);
 
-	// Add to start position of dest buffer
-	INT32 const iTempX = iX + pTrav.sOffsetX;
-	INT32 const iTempY = iY + pTrav.sOffsetY;
+	CHECKV(x >= 0);
+	CHECKV(y >= 0);
 
-	// Validations
-	CHECKV(iTempX >= 0);
-	CHECKV(iTempY >= 0);
+	UINT32 const LeftSkip   = rect->x;
+	UINT32 const TopSkip    = rect->y * src_pitch;
+	UINT32 const BlitLength = rect->w;
+	UINT32       BlitHeight = rect->h;
+	UINT32 const src_skip   = src_pitch - BlitLength;
 
-	UINT8 const* SrcPtr = hSrcVObject->PixData(pTrav);
-	DestPtr = (UINT8 *)pBuffer + (uiDestPitchBYTES*iTempY) + (iTempX*2);
-	ZPtr = (UINT8 *)pZBuffer + (uiDestPitchBYTES*iTempY) + (iTempX*2);
-	UINT16 const* const p16BPPPalette = hSrcVObject->CurrentShade();
-	LineSkip=(uiDestPitchBYTES-(usWidth*2));
+	UINT32        const pitch     = uiDestPitchBYTES / 2;
+	UINT8  const*       src       = pSrcBuffer + TopSkip + LeftSkip;
+	UINT16*             dst       = buf + pitch * y + x;
+	UINT16 const* const pal       = hSrcVSurface->p16BPPPalette;
+	UINT32              line_skip = pitch - BlitLength;
 
 	do
 	{
-		for (;;)
+		UINT32 w = BlitLength;
+		do
 		{
-			UINT8 data = *SrcPtr++;
-
-			if (data == 0) break;
-			if (data & 0x80)
-			{
-				data &= 0x7F;
-				DestPtr += 2 * data;
-				ZPtr += 2 * data;
-			}
-			else
-			{
-				do
-				{
-					if (*(UINT16*)ZPtr < usZValue)
-					{
-						UINT8 px = *SrcPtr;
-						if (px != 254)
-						{
-							*(UINT16*)DestPtr = p16BPPPalette[px];
-						}
-					}
-				}
-				while (SrcPtr++, DestPtr += 2, ZPtr += 2, --data > 0);
-			}
+			*dst++ = pal[*src++];
 		}
-		DestPtr += LineSkip;
-		ZPtr += LineSkip;
+		while (--w != 0);
+		src += src_skip;
+		dst += line_skip;
 	}
-	while (--usHeight > 0);
+	while (--BlitHeight != 0);
 }
 
 
 /**********************************************************************************************
-Blt8BPPDataTo16BPPBufferIntensityZ
+Blt8BPPDataTo16BPPBuffer
 
-	Creates a shadow using a brush, but modifies the destination buffer only if the current
-	Z level is equal to higher than what's in the Z buffer at that pixel location. It
-	updates the Z buffer with the new Z level.
+	Blits from a flat surface to a 16-bit buffer.
 
 **********************************************************************************************/
-void Blt8BPPDataTo16BPPBufferIntensityZ( UINT16 *pBuffer, UINT32 uiDestPitchBYTES, UINT16 *pZBuffer, UINT16 usZValue, HVOBJECT hSrcVObject, INT32 iX, INT32 iY, UINT16 usIndex )
+void Blt8BPPDataTo16BPPBuffer( UINT16 *pBuffer, UINT32 uiDestPitchBYTES, SGPVSurface* hSrcVSurface, UINT8 *pSrcBuffer, INT32 iX, INT32 iY)
 {
-#if 1 // XXX TODO
-	UNIMPLEMENTED
-#else
-	UINT8  *DestPtr, *ZPtr;
-	UINT32 LineSkip;
+	INT32  iTempX, iTempY;
 
 	// Assertions
-	Assert( hSrcVObject != NULL );
+	Assert( hSrcVSurface != NULL );
+	Assert( pSrcBuffer != NULL );
 	Assert( pBuffer != NULL );
 
 	// Get Offsets from Index into structure
-	ETRLEObject const& pTrav = hSrcVObject->SubregionProperties(usIndex);
-	UINT32      const  usHeight = pTrav.usHeight;
-	UINT32      const  usWidth  = pTrav.usWidth;
+	UINT32 const usWidth  = hSrcVSurface->Width();
+	UINT32 const usHeight = hSrcVSurface->Height();
 
 	// Add to start position of dest buffer
-	INT32 const iTempX = iX + pTrav.sOffsetX;
-	INT32 const iTempY = iY + pTrav.sOffsetY;
+	iTempX = iX;
+	iTempY = iY;
 
 	// Validations
 	CHECKV(iTempX >= 0);
 	CHECKV(iTempY >= 0);
 
-	UINT8 const* SrcPtr = hSrcVObject->PixData(pTrav);
-	DestPtr = (UINT8 *)pBuffer + (uiDestPitchBYTES*iTempY) + (iTempX*2);
-	ZPtr = (UINT8 *)pZBuffer + (uiDestPitchBYTES*iTempY) + (iTempX*2);
-	LineSkip=(uiDestPitchBYTES-(usWidth*2));
-
-	__asm {
-
-		mov		esi, SrcPtr
-		mov		edi, DestPtr
-		mov		edx, OFFSET IntensityTable
-		xor		eax, eax
-		mov		ebx, ZPtr
-		xor		ecx, ecx
-
-BlitDispatch:
-
-		mov		cl, [esi]
-		inc		esi
-		or		cl, cl
-		js		BlitTransparent
-		jz		BlitDoneLine
-
-//BlitNonTransLoop:
-
-BlitNTL4:
-
-		mov		ax, [ebx]
-		cmp		ax, usZValue
-		jae		BlitNTL5
-
-		xor		eax, eax
-		mov		ax, [edi]
-		mov		ax, [edx+eax*2]
-		mov		[edi], ax
-		mov		ax, usZValue
-		mov		[ebx], ax
-
-BlitNTL5:
-		inc		esi
-		add		edi, 2
-		add		ebx, 2
-		dec		cl
-		jnz		BlitNTL4
-
-		jmp		BlitDispatch
-
-
-BlitTransparent:
-
-		and		ecx, 07fH
-//		shl		ecx, 1
-		add   ecx, ecx
-		add		edi, ecx
-		add		ebx, ecx
-		jmp		BlitDispatch
-
-
-BlitDoneLine:
-
-		dec		usHeight
-		jz		BlitDone
-		add		edi, LineSkip
-		add		ebx, LineSkip
-		jmp		BlitDispatch
+	UINT8*  SrcPtr        = pSrcBuffer;
+	UINT16* DestPtr       = pBuffer + uiDestPitchBYTES / 2 * iTempY + iTempX;
+	UINT16* p16BPPPalette = hSrcVSurface->p16BPPPalette;
 
+	for (size_t h = usHeight; h != 0; --h)
+	{
+		for (size_t w = 0; w != usWidth; ++w)
+		{
+			DestPtr[w] = p16BPPPalette[SrcPtr[w]];
+		}
 
-BlitDone:
+		SrcPtr  += usWidth;
+		DestPtr += uiDestPitchBYTES / 2;
 	}
-#endif
 }
 
 
-/**********************************************************************************************
-Blt8BPPDataTo16BPPBufferIntensityZClip
-
-	Blits an image into the destination buffer, using an ETRLE brush as a source, and a 16-bit
-	buffer as a destination. As it is blitting, it checks the Z value of the ZBuffer, and if the
-	pixel's Z level is below that of the current pixel, it is written on, and the Z value is
-	updated to the current value,	for any non-transparent pixels. The Z-buffer is 16 bit, and
-	must be the same dimensions (including Pitch) as the destination.
-
-**********************************************************************************************/
-void Blt8BPPDataTo16BPPBufferIntensityZClip( UINT16 *pBuffer, UINT32 uiDestPitchBYTES, UINT16 *pZBuffer, UINT16 usZValue, HVOBJECT hSrcVObject, INT32 iX, INT32 iY, UINT16 usIndex, SGPRect *clipregion)
+/* Blit from a flat surface to a 16-bit buffer, dividing the source image into
+ * exactly half the size, optionally from a sub-region.
+ * - Source rect is in source units.
+ * - In order to make sure the same pixels are skipped, always align the top and
+ *   left coordinates to the same factor of two.
+ * - A rect specifying an odd number of pixels will divide out to an even number
+ *   of pixels blitted to the destination. */
+void Blt8BPPDataTo16BPPBufferHalf(UINT16* const dst_buf, UINT32 const uiDestPitchBYTES, SGPVSurface* const src_surface, UINT8 const* const src_buf, UINT32 const src_pitch, INT32 const x, INT32 const y, SGPBox const* const rect)
 {
-#if 1 // XXX TODO
-	UNIMPLEMENTED
-#else
-	UINT8  *DestPtr, *ZPtr;
-	UINT32 LineSkip;
-	INT32  LeftSkip, RightSkip, TopSkip, BottomSkip, BlitLength, BlitHeight;
-	INT32  ClipX1, ClipY1, ClipX2, ClipY2;
-
-	// Assertions
-	Assert( hSrcVObject != NULL );
-	Assert( pBuffer != NULL );
-
-	// Get Offsets from Index into structure
-	ETRLEObject const& pTrav = hSrcVObject->SubregionProperties(usIndex);
-	UINT32      const  usHeight = pTrav.usHeight;
-	UINT32      const  usWidth  = pTrav.usWidth;
+	Assert(src_surface);
+	Assert(src_buf);
+	Assert(dst_buf);
 
-	// Add to start position of dest buffer
-	INT32 const iTempX = iX + pTrav.sOffsetX;
-	INT32 const iTempY = iY + pTrav.sOffsetY;
+	CHECKV(x >= 0);
+	CHECKV(y >= 0);
 
-	if(clipregion==NULL)
+	UINT8 const* src = src_buf;
+	UINT32       width;
+	UINT32       height;
+	if (rect)
 	{
-		ClipX1=ClippingRect.iLeft;
-		ClipY1=ClippingRect.iTop;
-		ClipX2=ClippingRect.iRight;
-		ClipY2=ClippingRect.iBottom;
+		width  = rect->w;
+		height = rect->h;
+		CHECKV(0 < width  && width  <= src_surface->Width());
+		CHECKV(0 < height && height <= src_surface->Height());
+
+		src += src_pitch * rect->y + rect->x;
 	}
 	else
 	{
-		ClipX1=clipregion->iLeft;
-		ClipY1=clipregion->iTop;
-		ClipX2=clipregion->iRight;
-		ClipY2=clipregion->iBottom;
+		width  = src_surface->Width();
+		height = src_surface->Height();
 	}
 
-	// Calculate rows hanging off each side of the screen
-	LeftSkip=__min(ClipX1 - MIN(ClipX1, iTempX), (INT32)usWidth);
-	RightSkip=__min(MAX(ClipX2, (iTempX+(INT32)usWidth)) - ClipX2, (INT32)usWidth);
-	TopSkip=__min(ClipY1 - __min(ClipY1, iTempY), (INT32)usHeight);
-	BottomSkip=__min(__max(ClipY2, (iTempY+(INT32)usHeight)) - ClipY2, (INT32)usHeight);
-
-	// calculate the remaining rows and columns to blit
-	BlitLength=((INT32)usWidth-LeftSkip-RightSkip);
-	BlitHeight=((INT32)usHeight-TopSkip-BottomSkip);
-
-	// check if whole thing is clipped
-	if((LeftSkip >=(INT32)usWidth) || (RightSkip >=(INT32)usWidth))
-		return;
-
-	// check if whole thing is clipped
-	if((TopSkip >=(INT32)usHeight) || (BottomSkip >=(INT32)usHeight))
-		return;
-
-	UINT8 const* SrcPtr = hSrcVObject->PixData(pTrav);
-	DestPtr = (UINT8 *)pBuffer + (uiDestPitchBYTES*(iTempY+TopSkip)) + ((iTempX+LeftSkip)*2);
-	ZPtr = (UINT8 *)pZBuffer + (uiDestPitchBYTES*(iTempY+TopSkip)) + ((iTempX+LeftSkip)*2);
-	LineSkip=(uiDestPitchBYTES-(BlitLength*2));
-
-	UINT32 Unblitted;
-	INT32  LSCount;
-	__asm {
-
-		mov		esi, SrcPtr
-		mov		edi, DestPtr
-		mov		edx, OFFSET IntensityTable
-		xor		eax, eax
-		mov		ebx, ZPtr
-		xor		ecx, ecx
-
-		cmp		TopSkip, 0		// check for nothing clipped on top
-		je		LeftSkipSetup
-
-TopSkipLoop:						// Skips the number of lines clipped at the top
-
-		mov		cl, [esi]
-		inc		esi
-		or		cl, cl
-		js		TopSkipLoop
-		jz		TSEndLine
-
-		add		esi, ecx
-		jmp		TopSkipLoop
-
-TSEndLine:
-		dec		TopSkip
-		jnz		TopSkipLoop
-
-LeftSkipSetup:
-
-		mov		Unblitted, 0
-		mov		eax, LeftSkip
-		mov		LSCount, eax
-		or		eax, eax
-		jz		BlitLineSetup
-
-LeftSkipLoop:
-
-		mov		cl, [esi]
-		inc		esi
-
-		or		cl, cl
-		js		LSTrans
-
-		cmp		ecx, LSCount
-		je		LSSkip2			// if equal, skip whole, and start blit with new run
-		jb		LSSkip1			// if less, skip whole thing
-
-		add		esi, LSCount		// skip partial run, jump into normal loop for rest
-		sub		ecx, LSCount
-		mov		eax, BlitLength
-		mov		LSCount, eax
-		mov		Unblitted, 0
-		jmp		BlitNonTransLoop
-
-LSSkip2:
-		add		esi, ecx		// skip whole run, and start blit with new run
-		jmp		BlitLineSetup
-
-
-LSSkip1:
-		add		esi, ecx		// skip whole run, continue skipping
-		sub		LSCount, ecx
-		jmp		LeftSkipLoop
-
+	UINT16*             dst      = dst_buf + uiDestPitchBYTES / 2 * y + x;
+	UINT32        const src_skip = (src_pitch - width / 2) * 2;
+	UINT32        const dst_skip = uiDestPitchBYTES / 2 - width / 2;
+	UINT16 const* const pal      = src_surface->p16BPPPalette;
 
-LSTrans:
-		and		ecx, 07fH
-		cmp		ecx, LSCount
-		je		BlitLineSetup		// if equal, skip whole, and start blit with new run
-		jb		LSTrans1		// if less, skip whole thing
+	height /= 2;
+	do
+	{
+		UINT32 w = width / 2;
+		do
+		{
+			*dst++ = pal[*src];
+			src += 2;
+		}
+		while (--w > 0);
+		src += src_skip;
+		dst += dst_skip;
+	}
+	while (--height > 0);
+}
 
-		sub		ecx, LSCount		// skip partial run, jump into normal loop for rest
-		mov		eax, BlitLength
-		mov		LSCount, eax
-		mov		Unblitted, 0
-		jmp		BlitTransparent
 
+void SetClippingRect(SGPRect *clip)
+{
+	Assert(clip!=NULL);
+	Assert(clip->iLeft < clip->iRight);
+	Assert(clip->iTop < clip->iBottom);
+	ClippingRect = *clip;
+}
 
-LSTrans1:
-		sub		LSCount, ecx		// skip whole run, continue skipping
-		jmp		LeftSkipLoop
 
+void GetClippingRect(SGPRect *clip)
+{
+	Assert(clip!=NULL);
+	*clip = ClippingRect;
+}
 
-BlitLineSetup:						// Does any actual blitting (trans/non) for the line
-		mov		eax, BlitLength
-		mov		LSCount, eax
-		mov		Unblitted, 0
 
-BlitDispatch:
+/**********************************************************************************************
+	Blt16BPPBufferPixelateRectWithColor
 
-		cmp		LSCount, 0		// Check to see if we're done blitting
-		je		RightSkipLoop
+		Given an 8x8 pattern and a color, pixelates an area by repeatedly "applying the color" to pixels whereever there
+		is a non-zero value in the pattern.
 
-		mov		cl, [esi]
-		inc		esi
-		or		cl, cl
-		js		BlitTransparent
+		KM:  Added Nov. 23, 1998
+		This is all the code that I moved from Blt16BPPBufferPixelateRect().
+		This function now takes a color field (which previously was
+		always black.  The 3rd assembler line in this function:
 
-BlitNonTransLoop:					// blit non-transparent pixels
+				mov	ax, usColor	// color of pixel
 
-		cmp		ecx, LSCount
-		jbe		BNTrans1
+		used to be:
 
-		sub		ecx, LSCount
-		mov		Unblitted, ecx
-		mov		ecx, LSCount
+				xor	eax, eax	// color of pixel (black or 0)
 
-BNTrans1:
-		sub		LSCount, ecx
+	  This was the only internal modification I made other than adding the usColor argument.
 
-BlitNTL1:
+*********************************************************************************************/
+static void Blt16BPPBufferPixelateRectWithColor(UINT16* pBuffer, UINT32 uiDestPitchBYTES, SGPRect* area, const UINT8 Pattern[8][8], UINT16 usColor)
+{
+	INT32  width, height;
+	UINT32 LineSkip;
+	UINT16 *DestPtr;
+	INT32	iLeft, iTop, iRight, iBottom;
 
-		mov		ax, [ebx]
-		cmp		ax, usZValue
-		jae		BlitNTL2
+	// Assertions
+	Assert( pBuffer != NULL );
+	Assert( Pattern != NULL );
 
-		mov		ax, usZValue
-		mov		[ebx], ax
+	iLeft=__max(ClippingRect.iLeft, area->iLeft);
+	iTop=__max(ClippingRect.iTop, area->iTop);
+	iRight=__min(ClippingRect.iRight-1, area->iRight);
+	iBottom=__min(ClippingRect.iBottom-1, area->iBottom);
 
-		xor		eax, eax
+	DestPtr=(pBuffer+(iTop*(uiDestPitchBYTES/2))+iLeft);
+	width=iRight-iLeft+1;
+	height=iBottom-iTop+1;
+	LineSkip=(uiDestPitchBYTES-(width*2));
 
-		mov		ax, [edi]
-		mov		ax, [edx+eax*2]
-		mov		[edi], ax
+	CHECKV(width  >= 1);
+	CHECKV(height >= 1);
 
-BlitNTL2:
-		inc		esi
-		add		edi, 2
-		add		ebx, 2
-		dec		cl
-		jnz		BlitNTL1
+	UINT32 row = 0;
+	do
+	{
+		UINT32 col = 0;
+		UINT32 w = width;
 
-//BlitLineEnd:
-		add		esi, Unblitted
-		jmp		BlitDispatch
+		do
+		{
+			if (Pattern[row][col] != 0) *DestPtr = usColor;
+			DestPtr++;
+			col = (col + 1) % 8;
+		}
+		while (--w > 0);
+		DestPtr += LineSkip / 2;
+		row = (row + 1) % 8;
+	}
+	while (--height > 0);
+}
 
-BlitTransparent:					// skip transparent pixels
 
-		and		ecx, 07fH
-		cmp		ecx, LSCount
-		jbe		BTrans1
+//Uses black hatch color
+void Blt16BPPBufferHatchRect(UINT16 *pBuffer, UINT32 uiDestPitchBYTES, SGPRect *area )
+{
+	const UINT8 Pattern[8][8] =
+	{
+		{ 1,0,1,0,1,0,1,0 },
+		{ 0,1,0,1,0,1,0,1 },
+		{ 1,0,1,0,1,0,1,0 },
+		{ 0,1,0,1,0,1,0,1 },
+		{ 1,0,1,0,1,0,1,0 },
+		{ 0,1,0,1,0,1,0,1 },
+		{ 1,0,1,0,1,0,1,0 },
+		{ 0,1,0,1,0,1,0,1 }
+	};
+	Blt16BPPBufferPixelateRectWithColor( pBuffer, uiDestPitchBYTES, area, Pattern, 0 );
+}
 
-		mov		ecx, LSCount
+void Blt16BPPBufferLooseHatchRectWithColor(UINT16 *pBuffer, UINT32 uiDestPitchBYTES, SGPRect *area, UINT16 usColor )
+{
+	const UINT8 Pattern[8][8] =
+	{
+		{ 1,0,0,0,1,0,0,0 },
+		{ 0,0,0,0,0,0,0,0 },
+		{ 0,0,1,0,0,0,1,0 },
+		{ 0,0,0,0,0,0,0,0 },
+		{ 1,0,0,0,1,0,0,0 },
+		{ 0,0,0,0,0,0,0,0 },
+		{ 0,0,1,0,0,0,1,0 },
+		{ 0,0,0,0,0,0,0,0 }
+	};
+	Blt16BPPBufferPixelateRectWithColor( pBuffer, uiDestPitchBYTES, area, Pattern, usColor );
+}
 
-BTrans1:
 
-		sub		LSCount, ecx
-//		shl		ecx, 1
-		add   ecx, ecx
-		add		edi, ecx
-		add		ebx, ecx
-		jmp		BlitDispatch
+/**********************************************************************************************
+Blt8BPPDataTo16BPPBufferShadow
 
+	Modifies the destination buffer. Darkens the destination pixels by 25%, using the source
+	image as a mask. Any Non-zero index pixels are used to darken destination pixels.
 
-RightSkipLoop:						// skip along until we hit and end-of-line marker
+**********************************************************************************************/
+void Blt8BPPDataTo16BPPBufferShadow( UINT16 *pBuffer, UINT32 uiDestPitchBYTES, HVOBJECT hSrcVObject, INT32 iX, INT32 iY, UINT16 usIndex)
+{
+	BltETRLE<false>(pBuffer, uiDestPitchBYTES, hSrcVObject, iX, iY, usIndex, NULL, ETRLEShadePolicy());
+}
 
 
-RSLoop1:
-		mov		al, [esi]
-		inc		esi
-		or		al, al
-		jnz		RSLoop1
+/* Blit an image into the destination buffer, using an ETRLE brush as a source
+ * and a 16-bit buffer as a destination. */
+void Blt8BPPDataTo16BPPBufferTransparent(UINT16* const buf, UINT32 const uiDestPitchBYTES, SGPVObject const* const hSrcVObject, INT32 const iX, INT32 const iY, UINT16 const usIndex)
+{
+	BltETRLE<false>(buf, uiDestPitchBYTES, hSrcVObject, iX, iY, usIndex, NULL, ETRLEPalettePolicy(hSrcVObject->CurrentShade()));
+}
 
-		dec		BlitHeight
-		jz		BlitDone
-		add		edi, LineSkip
-		add		ebx, LineSkip
 
-		jmp		LeftSkipSetup
+/**********************************************************************************************
+Blt8BPPDataTo16BPPBufferTransparentClip
 
+	Blits an image into the destination buffer, using an ETRLE brush as a source, and a 16-bit
+	buffer as a destination. Clips the brush.
 
-BlitDone:
-	}
-#endif
+**********************************************************************************************/
+void Blt8BPPDataTo16BPPBufferTransparentClip(UINT16* const pBuffer, const UINT32 uiDestPitchBYTES, const SGPVObject* const hSrcVObject, const INT32 iX, const INT32 iY, const UINT16 usIndex, const SGPRect* const clipregion)
+{
+	BltETRLE<true>(pBuffer, uiDestPitchBYTES, hSrcVObject, iX, iY, usIndex, clipregion, ETRLEPalettePolicy(hSrcVObject->CurrentShade()));
 }
 
 
 /**********************************************************************************************
-Blt8BPPDataTo16BPPBufferIntensityZNB
+BltIsClipped
 
-	Creates a shadow using a brush, but modifies the destination buffer only if the current
-	Z level is equal to higher than what's in the Z buffer at that pixel location. It does
-	NOT update the Z buffer with the new Z value.
+	Determines whether a given blit will need clipping or not. Returns TRUE/FALSE.
 
 **********************************************************************************************/
-void Blt8BPPDataTo16BPPBufferIntensityZNB( UINT16 *pBuffer, UINT32 uiDestPitchBYTES, UINT16 *pZBuffer, UINT16 usZValue, HVOBJECT hSrcVObject, INT32 iX, INT32 iY, UINT16 usIndex )
+BOOLEAN BltIsClipped(const SGPVObject* const hSrcVObject, const INT32 iX, const INT32 iY, const UINT16 usIndex, const SGPRect* const clipregion)
 {
-#if 1 // XXX TODO
-	UNIMPLEMENTED
-#else
-	UINT8  *DestPtr, *ZPtr;
-	UINT32 LineSkip;
+	INT32  ClipX1, ClipY1, ClipX2, ClipY2;
 
 	// Assertions
 	Assert( hSrcVObject != NULL );
-	Assert( pBuffer != NULL );
 
 	// Get Offsets from Index into structure
 	ETRLEObject const& pTrav = hSrcVObject->SubregionProperties(usIndex);
@@ -5004,101 +719,113 @@ void Blt8BPPDataTo16BPPBufferIntensityZNB( UINT16 *pBuffer, UINT32 uiDestPitchBY
 	INT32 const iTempX = iX + pTrav.sOffsetX;
 	INT32 const iTempY = iY + pTrav.sOffsetY;
 
-	// Validations
-	CHECKV(iTempX >= 0);
-	CHECKV(iTempY >= 0);
+	if(clipregion==NULL)
+	{
+		ClipX1=ClippingRect.iLeft;
+		ClipY1=ClippingRect.iTop;
+		ClipX2=ClippingRect.iRight;
+		ClipY2=ClippingRect.iBottom;
+	}
+	else
+	{
+		ClipX1=clipregion->iLeft;
+		ClipY1=clipregion->iTop;
+		ClipX2=clipregion->iRight;
+		ClipY2=clipregion->iBottom;
+	}
 
-	UINT8 const* SrcPtr = hSrcVObject->PixData(pTrav);
-	DestPtr = (UINT8 *)pBuffer + (uiDestPitchBYTES*iTempY) + (iTempX*2);
-	ZPtr = (UINT8 *)pZBuffer + (uiDestPitchBYTES*iTempY) + (iTempX*2);
-	LineSkip=(uiDestPitchBYTES-(usWidth*2));
 
-	__asm {
+	// Calculate rows hanging off each side of the screen
+	if(__min(ClipX1 - MIN(ClipX1, iTempX), (INT32)usWidth))
+		return(TRUE);
 
-		mov		esi, SrcPtr
-		mov		edi, DestPtr
-		mov		edx, OFFSET IntensityTable
-		xor		eax, eax
-		mov		ebx, ZPtr
-		xor		ecx, ecx
+	if(__min(MAX(ClipX2, (iTempX+(INT32)usWidth)) - ClipX2, (INT32)usWidth))
+		return(TRUE);
 
-BlitDispatch:
+	if(__min(ClipY1 - __min(ClipY1, iTempY), (INT32)usHeight))
+		return(TRUE);
 
-		mov		cl, [esi]
-		inc		esi
-		or		cl, cl
-		js		BlitTransparent
-		jz		BlitDoneLine
+	if(__min(__max(ClipY2, (iTempY+(INT32)usHeight)) - ClipY2, (INT32)usHeight))
+		return(TRUE);
 
-//BlitNonTransLoop:
+	return(FALSE);
+}
 
-BlitNTL4:
 
-		mov		ax, [ebx]
-		cmp		ax, usZValue
-		jae		BlitNTL5
 
-		xor		eax, eax
-		mov		ax, [edi]
-		mov		ax, [edx+eax*2]
-		mov		[edi], ax
+/**********************************************************************************************
+Blt8BPPDataTo16BPPBufferShadowClip
 
-BlitNTL5:
-		inc		esi
-		add		edi, 2
-		add		ebx, 2
-		dec		cl
-		jnz		BlitNTL4
+	Modifies the destination buffer. Darkens the destination pixels by 25%, using the source
+	image as a mask. Any Non-zero index pixels are used to darken destination pixels. Blitter
+	clips brush if it doesn't fit on the viewport.
 
-		jmp		BlitDispatch
+**********************************************************************************************/
+void Blt8BPPDataTo16BPPBufferShadowClip( UINT16 *pBuffer, UINT32 uiDestPitchBYTES, HVOBJECT hSrcVObject, INT32 iX, INT32 iY, UINT16 usIndex, SGPRect *clipregion)
+{
+	BltETRLE<true>(pBuffer, uiDestPitchBYTES, hSrcVObject, iX, iY, usIndex, clipregion, ETRLEShadePolicy());
+}
 
 
-BlitTransparent:
+void Blt16BPPBufferFilterRect(UINT16* pBuffer, UINT32 uiDestPitchBYTES, const UINT16* filter_table, SGPRect* area)
+{
+INT32  width, height;
+UINT32 LineSkip;
+UINT16 *DestPtr;
 
-		and		ecx, 07fH
-//		shl		ecx, 1
-		add   ecx, ecx
-		add		edi, ecx
-		add		ebx, ecx
-		jmp		BlitDispatch
+	// Assertions
+	Assert( pBuffer != NULL );
 
+	// Clipping
+	if( area->iLeft < ClippingRect.iLeft )
+		area->iLeft = ClippingRect.iLeft;
+	if( area->iTop < ClippingRect.iTop )
+		area->iTop = ClippingRect.iTop;
+	if( area->iRight >= ClippingRect.iRight )
+		area->iRight = ClippingRect.iRight - 1;
+	if( area->iBottom >= ClippingRect.iBottom )
+		area->iBottom = ClippingRect.iBottom - 1;
+	//CHECKF(area->iLeft >= ClippingRect.iLeft );
+	//CHECKF(area->iTop >= ClippingRect.iTop );
+	//CHECKF(area->iRight <= ClippingRect.iRight );
+	//CHECKF(area->iBottom <= ClippingRect.iBottom );
 
-BlitDoneLine:
+	DestPtr=(pBuffer+(area->iTop*(uiDestPitchBYTES/2))+area->iLeft);
+	width=area->iRight-area->iLeft+1;
+	height=area->iBottom-area->iTop+1;
+	LineSkip=(uiDestPitchBYTES-(width*2));
 
-		dec		usHeight
-		jz		BlitDone
-		add		edi, LineSkip
-		add		ebx, LineSkip
-		jmp		BlitDispatch
+	CHECKV(width  >= 1);
+	CHECKV(height >= 1);
 
+	do
+	{
+		UINT32 w = width;
 
-BlitDone:
+		do
+		{
+			*DestPtr = filter_table[*DestPtr];
+			DestPtr++;
+		}
+		while (--w > 0);
+		DestPtr = (UINT16*)((UINT8*)DestPtr + LineSkip);
 	}
-#endif
+	while (--height > 0);
 }
 
 
 /**********************************************************************************************
-Blt8BPPDataTo16BPPBufferIntensityClip
+BltIsClippedOrOffScreen
 
-	Modifies the destination buffer. Darkens the destination pixels by 25%, using the source
-	image as a mask. Any Non-zero index pixels are used to darken destination pixels. Blitter
-	clips brush if it doesn't fit on the viewport.
+	Determines whether a given blit will need clipping or not. Returns TRUE/FALSE.
 
 **********************************************************************************************/
-void Blt8BPPDataTo16BPPBufferIntensityClip( UINT16 *pBuffer, UINT32 uiDestPitchBYTES, HVOBJECT hSrcVObject, INT32 iX, INT32 iY, UINT16 usIndex, SGPRect *clipregion)
+CHAR8 BltIsClippedOrOffScreen( HVOBJECT hSrcVObject, INT32 iX, INT32 iY, UINT16 usIndex, SGPRect *clipregion )
 {
-#if 1 // XXX TODO
-	UNIMPLEMENTED
-#else
-	UINT8  *DestPtr;
-	UINT32 LineSkip;
-	INT32  LeftSkip, RightSkip, TopSkip, BottomSkip, BlitLength, BlitHeight;
 	INT32  ClipX1, ClipY1, ClipX2, ClipY2;
 
 	// Assertions
 	Assert( hSrcVObject != NULL );
-	Assert( pBuffer != NULL );
 
 	// Get Offsets from Index into structure
 	ETRLEObject const& pTrav = hSrcVObject->SubregionProperties(usIndex);
@@ -5124,234 +851,151 @@ void Blt8BPPDataTo16BPPBufferIntensityClip( UINT16 *pBuffer, UINT32 uiDestPitchB
 		ClipY2=clipregion->iBottom;
 	}
 
-	// Calculate rows hanging off each side of the screen
-	LeftSkip=__min(ClipX1 - MIN(ClipX1, iTempX), (INT32)usWidth);
-	RightSkip=__min(MAX(ClipX2, (iTempX+(INT32)usWidth)) - ClipX2, (INT32)usWidth);
-	TopSkip=__min(ClipY1 - __min(ClipY1, iTempY), (INT32)usHeight);
-	BottomSkip=__min(__max(ClipY2, (iTempY+(INT32)usHeight)) - ClipY2, (INT32)usHeight);
-
-	// calculate the remaining rows and columns to blit
-	BlitLength=((INT32)usWidth-LeftSkip-RightSkip);
-	BlitHeight=((INT32)usHeight-TopSkip-BottomSkip);
-
-	// whole thing is clipped
-	if((LeftSkip >=(INT32)usWidth) || (RightSkip >=(INT32)usWidth))
-		return;
-
-	// whole thing is clipped
-	if((TopSkip >=(INT32)usHeight) || (BottomSkip >=(INT32)usHeight))
-		return;
-
-	UINT8 const* SrcPtr = hSrcVObject->PixData(pTrav);
-	DestPtr = (UINT8 *)pBuffer + (uiDestPitchBYTES*(iTempY+TopSkip)) + ((iTempX+LeftSkip)*2);
-	LineSkip=(uiDestPitchBYTES-(BlitLength*2));
-
-	UINT32 Unblitted;
-	__asm {
-
-		mov		esi, SrcPtr
-		mov		edi, DestPtr
-		mov		edx, OFFSET IntensityTable
-		xor		eax, eax
-		mov		ebx, TopSkip
-		xor		ecx, ecx
-
-		or		ebx, ebx		// check for nothing clipped on top
-		jz		LeftSkipSetup
-
-TopSkipLoop:						// Skips the number of lines clipped at the top
-
-		mov		cl, [esi]
-		inc		esi
-		or		cl, cl
-		js		TopSkipLoop
-		jz		TSEndLine
-
-		add		esi, ecx
-		jmp		TopSkipLoop
-
-TSEndLine:
-		dec		ebx
-		jnz		TopSkipLoop
-
 
+	// Calculate rows hanging off each side of the screen
+	INT32 gLeftSkip   = __min(ClipX1 -   MIN(ClipX1, iTempX), (INT32)usWidth);
+	INT32 gTopSkip    = __min(ClipY1 - __min(ClipY1, iTempY), (INT32)usHeight);
+	INT32 gRightSkip  = __min(  MAX(ClipX2, iTempX + (INT32)usWidth)  - ClipX2, (INT32)usWidth);
+	INT32 gBottomSkip = __min(__max(ClipY2, iTempY + (INT32)usHeight) - ClipY2, (INT32)usHeight);
 
+	// check if whole thing is clipped
+	if((gLeftSkip >=(INT32)usWidth) || (gRightSkip >=(INT32)usWidth))
+		return(-1 );
 
-LeftSkipSetup:
-
-		mov		Unblitted, 0
-		mov		ebx, LeftSkip		// check for nothing clipped on the left
-		or		ebx, ebx
-		jz		BlitLineSetup
-
-LeftSkipLoop:
-
-		mov		cl, [esi]
-		inc		esi
-
-		or		cl, cl
-		js		LSTrans
-
-		cmp		ecx, ebx
-		je		LSSkip2			// if equal, skip whole, and start blit with new run
-		jb		LSSkip1			// if less, skip whole thing
-
-		add		esi, ebx		// skip partial run, jump into normal loop for rest
-		sub		ecx, ebx
-		mov		ebx, BlitLength
-		mov		Unblitted, 0
-		jmp		BlitNonTransLoop
-
-LSSkip2:
-		add		esi, ecx		// skip whole run, and start blit with new run
-		jmp		BlitLineSetup
-
-
-LSSkip1:
-		add		esi, ecx		// skip whole run, continue skipping
-		sub		ebx, ecx
-		jmp		LeftSkipLoop
-
-
-LSTrans:
-		and		ecx, 07fH
-		cmp		ecx, ebx
-		je		BlitLineSetup		// if equal, skip whole, and start blit with new run
-		jb		LSTrans1		// if less, skip whole thing
-
-		sub		ecx, ebx		// skip partial run, jump into normal loop for rest
-		mov		ebx, BlitLength
-		jmp		BlitTransparent
-
+	// check if whole thing is clipped
+	if((gTopSkip >=(INT32)usHeight) || (gBottomSkip >=(INT32)usHeight))
+		return(-1 );
 
-LSTrans1:
-		sub		ebx, ecx		// skip whole run, continue skipping
-		jmp		LeftSkipLoop
 
+	if ( gLeftSkip )
+		return( TRUE );
 
+	if ( gRightSkip )
+		return( TRUE );
 
+	if ( gTopSkip )
+		return( TRUE );
 
-BlitLineSetup:						// Does any actual blitting (trans/non) for the line
-		mov		ebx, BlitLength
-		mov		Unblitted, 0
+	if ( gBottomSkip )
+		return( TRUE );
 
-BlitDispatch:
 
-		or		ebx, ebx		// Check to see if we're done blitting
-		jz		RightSkipLoop
+	return(FALSE);
+}
 
-		mov		cl, [esi]
-		inc		esi
-		or		cl, cl
-		js		BlitTransparent
 
-BlitNonTransLoop:
+// ATE New blitter for rendering a differrent color for value 254. Can be transparent if outline is SGP_TRANSPARENT
+void Blt8BPPDataTo16BPPBufferOutline(UINT16* const buf, UINT32 const uiDestPitchBYTES, SGPVObject const* const hSrcVObject, INT32 const iX, INT32 const iY, UINT16 const usIndex, INT16 const outline)
+{
+	BltETRLE<false>(buf, uiDestPitchBYTES, hSrcVObject, iX, iY, usIndex, NULL, ETRLEOutlinePolicy(hSrcVObject->CurrentShade(), outline));
+}
 
-		cmp		ecx, ebx
-		jbe		BNTrans1
 
-		sub		ecx, ebx
-		mov		Unblitted, ecx
-		mov		ecx, ebx
+// ATE New blitter for rendering a differrent color for value 254. Can be transparent if s16BPPColor is SGP_TRANSPARENT
+void Blt8BPPDataTo16BPPBufferOutlineClip(UINT16* const pBuffer, const UINT32 uiDestPitchBYTES, const SGPVObject* const hSrcVObject, const INT32 iX, const INT32 iY, const UINT16 usIndex, const INT16 s16BPPColor, const SGPRect* const clipregion)
+{
+	BltETRLE<true>(pBuffer, uiDestPitchBYTES, hSrcVObject, iX, iY, usIndex, clipregion, ETRLEOutlinePolicy(hSrcVObject->CurrentShade(), s16BPPColor));
+}
 
-BNTrans1:
-		sub		ebx, ecx
 
-		clc
-		rcr		cl, 1
-		jnc		BlitNTL2
+void Blt8BPPDataTo16BPPBufferOutlineZClip(UINT16* const pBuffer, const UINT32 uiDestPitchBYTES, UINT16* const pZBuffer, const UINT16 usZValue, const HVOBJECT hSrcVObject, const INT32 iX, const INT32 iY, const UINT16 usIndex, const INT16 s16BPPColor, const SGPRect* const clipregion)
+{
+	BltETRLE<true>(pBuffer, uiDestPitchBYTES, hSrcVObject, iX, iY, usIndex, clipregion, ETRLEOutlineZPolicy(pZBuffer, usZValue, hSrcVObject->CurrentShade(), s16BPPColor));
+}
 
-		mov		ax, [edi]
-		mov		ax, [edx+eax*2]
-		mov		[edi], ax
 
-		inc		esi
-		add		edi, 2
+void Blt8BPPDataTo16BPPBufferOutlineZPixelateObscuredClip(UINT16* const pBuffer, const UINT32 uiDestPitchBYTES, UINT16* const pZBuffer, const UINT16 usZValue, const HVOBJECT hSrcVObject, const INT32 iX, const INT32 iY, const UINT16 usIndex, const INT16 s16BPPColor, const SGPRect* const clipregion)
+{
+	BltETRLE<true>(pBuffer, uiDestPitchBYTES, hSrcVObject, iX, iY, usIndex, clipregion, ETRLEPixelateZPolicy<true>(pZBuffer, usZValue, hSrcVObject->CurrentShade(), s16BPPColor, hSrcVObject, iY, usIndex));
+}
 
-BlitNTL2:
-		clc
-		rcr		cl, 1
-		jnc		BlitNTL3
 
-		mov		ax, [edi]
-		mov		ax, [edx+eax*2]
-		mov		[edi], ax
+void Blt8BPPDataTo16BPPBufferOutlineShadow(UINT16* const pBuffer, const UINT32 uiDestPitchBYTES, const SGPVObject* const hSrcVObject, const INT32 iX, const INT32 iY, const UINT16 usIndex)
+{
+	BltETRLE<false>(pBuffer, uiDestPitchBYTES, hSrcVObject, iX, iY, usIndex, NULL, ETRLEOutlineShadowPolicy());
+}
 
-		mov		ax, [edi+2]
-		mov		ax, [edx+eax*2]
-		mov		[edi+2], ax
 
-		add		esi, 2
-		add		edi, 4
+void Blt8BPPDataTo16BPPBufferOutlineShadowClip(UINT16* const pBuffer, const UINT32 uiDestPitchBYTES, const SGPVObject* const hSrcVObject, const INT32 iX, const INT32 iY, const UINT16 usIndex, const SGPRect* const clipregion)
+{
+	BltETRLE<true>(pBuffer, uiDestPitchBYTES, hSrcVObject, iX, iY, usIndex, clipregion, ETRLEOutlineShadowPolicy());
+}
 
-BlitNTL3:
 
-		or		cl, cl
-		jz		BlitLineEnd
+void Blt8BPPDataTo16BPPBufferOutlineZ(UINT16* const pBuffer, const UINT32 uiDestPitchBYTES, UINT16* const pZBuffer, const UINT16 usZValue, const HVOBJECT hSrcVObject, const INT32 iX, const INT32 iY, const UINT16 usIndex, const INT16 s16BPPColor)
+{
+	BltETRLE<false>(pBuffer, uiDestPitchBYTES, hSrcVObject, iX, iY, usIndex, NULL, ETRLEOutlineZPolicy(pZBuffer, usZValue, hSrcVObject->CurrentShade(), s16BPPColor));
+}
 
-BlitNTL4:
 
-		mov		ax, [edi]
-		mov		ax, [edx+eax*2]
-		mov		[edi], ax
+void Blt8BPPDataTo16BPPBufferOutlineZPixelateObscured(UINT16* const pBuffer, const UINT32 uiDestPitchBYTES, UINT16* const pZBuffer, const UINT16 usZValue, const HVOBJECT hSrcVObject, const INT32 iX, const INT32 iY, const UINT16 usIndex, const INT16 s16BPPColor)
+{
+	BltETRLE<false>(pBuffer, uiDestPitchBYTES, hSrcVObject, iX, iY, usIndex, NULL, ETRLEPixelateZPolicy<true>(pZBuffer, usZValue, hSrcVObject->CurrentShade(), s16BPPColor, hSrcVObject, iY, usIndex));
+}
 
-		mov		ax, [edi+2]
-		mov		ax, [edx+eax*2]
-		mov		[edi+2], ax
 
-		mov		ax, [edi+4]
-		mov		ax, [edx+eax*2]
-		mov		[edi+4], ax
+// This is the same as above, but DONOT WRITE to Z!
+void Blt8BPPDataTo16BPPBufferOutlineZNB(UINT16* const pBuffer, const UINT32 uiDestPitchBYTES, UINT16* const pZBuffer, const UINT16 usZValue, const HVOBJECT hSrcVObject, const INT32 iX, const INT32 iY, const UINT16 usIndex)
+{
+	BltETRLE<false>(pBuffer, uiDestPitchBYTES, hSrcVObject, iX, iY, usIndex, NULL, ETRLEOutlineZNBPolicy(pZBuffer, usZValue, hSrcVObject->CurrentShade()));
+}
 
-		mov		ax, [edi+6]
-		mov		ax, [edx+eax*2]
-		mov		[edi+6], ax
 
-		add		esi, 4
-		add		edi, 8
-		dec		cl
-		jnz		BlitNTL4
+/**********************************************************************************************
+Blt8BPPDataTo16BPPBufferIntensityZ
 
-BlitLineEnd:
-		add		esi, Unblitted
-		jmp		BlitDispatch
+	Creates a shadow using a brush, but modifies the destination buffer only if the current
+	Z level is equal to higher than what's in the Z buffer at that pixel location. It
+	updates the Z buffer with the new Z level.
 
-BlitTransparent:
+**********************************************************************************************/
+void Blt8BPPDataTo16BPPBufferIntensityZ( UINT16 *pBuffer, UINT32 uiDestPitchBYTES, UINT16 *pZBuffer, UINT16 usZValue, HVOBJECT hSrcVObject, INT32 iX, INT32 iY, UINT16 usIndex )
+{
+	BltETRLE<false>(pBuffer, uiDestPitchBYTES, hSrcVObject, iX, iY, usIndex, NULL, ETRLEShadeZPolicy<true>(pZBuffer, usZValue, IntensityTable));
+}
 
-		and		ecx, 07fH
-		cmp		ecx, ebx
-		jbe		BTrans1
 
-		mov		ecx, ebx
+/**********************************************************************************************
+Blt8BPPDataTo16BPPBufferIntensityZClip
 
-BTrans1:
+	Blits an image into the destination buffer, using an ETRLE brush as a source, and a 16-bit
+	buffer as a destination. As it is blitting, it checks the Z value of the ZBuffer, and if the
+	pixel's Z level is below that of the current pixel, it is written on, and the Z value is
+	updated to the current value,	for any non-transparent pixels. The Z-buffer is 16 bit, and
+	must be the same dimensions (including Pitch) as the destination.
 
-		sub		ebx, ecx
-//		shl		ecx, 1
-		add   ecx, ecx
-		add		edi, ecx
-		jmp		BlitDispatch
+**********************************************************************************************/
+void Blt8BPPDataTo16BPPBufferIntensityZClip( UINT16 *pBuffer, UINT32 uiDestPitchBYTES, UINT16 *pZBuffer, UINT16 usZValue, HVOBJECT hSrcVObject, INT32 iX, INT32 iY, UINT16 usIndex, SGPRect *clipregion)
+{
+	BltETRLE<true>(pBuffer, uiDestPitchBYTES, hSrcVObject, iX, iY, usIndex, clipregion, ETRLEShadeZPolicy<true>(pZBuffer, usZValue, IntensityTable));
+}
 
 
-RightSkipLoop:
+/**********************************************************************************************
+Blt8BPPDataTo16BPPBufferIntensityZNB
 
+	Creates a shadow using a brush, but modifies the destination buffer only if the current
+	Z level is equal to higher than what's in the Z buffer at that pixel location. It does
+	NOT update the Z buffer with the new Z value.
 
-RSLoop1:
-		mov		al, [esi]
-		inc		esi
-		or		al, al
-		jnz		RSLoop1
+**********************************************************************************************/
+void Blt8BPPDataTo16BPPBufferIntensityZNB( UINT16 *pBuffer, UINT32 uiDestPitchBYTES, UINT16 *pZBuffer, UINT16 usZValue, HVOBJECT hSrcVObject, INT32 iX, INT32 iY, UINT16 usIndex )
+{
+	BltETRLE<false>(pBuffer, uiDestPitchBYTES, hSrcVObject, iX, iY, usIndex, NULL, ETRLEShadeZPolicy<false>(pZBuffer, usZValue, IntensityTable));
+}
 
-		dec		BlitHeight
-		jz		BlitDone
-		add		edi, LineSkip
 
-		jmp		LeftSkipSetup
+/**********************************************************************************************
+Blt8BPPDataTo16BPPBufferIntensityClip
 
+	Modifies the destination buffer. Darkens the destination pixels by 25%, using the source
+	image as a mask. Any Non-zero index pixels are used to darken destination pixels. Blitter
+	clips brush if it doesn't fit on the viewport.
 
-BlitDone:
-	}
-#endif
+**********************************************************************************************/
+void Blt8BPPDataTo16BPPBufferIntensityClip( UINT16 *pBuffer, UINT32 uiDestPitchBYTES, HVOBJECT hSrcVObject, INT32 iX, INT32 iY, UINT16 usIndex, SGPRect *clipregion)
+{
+	BltETRLE<true>(pBuffer, uiDestPitchBYTES, hSrcVObject, iX, iY, usIndex, clipregion, ETRLEShadePolicy(IntensityTable));
 }
 
 
@@ -5364,300 +1008,502 @@ Blt8BPPDataTo16BPPBufferIntensity
 **********************************************************************************************/
 void Blt8BPPDataTo16BPPBufferIntensity( UINT16 *pBuffer, UINT32 uiDestPitchBYTES, HVOBJECT hSrcVObject, INT32 iX, INT32 iY, UINT16 usIndex)
 {
-#if 1 // XXX TODO
-	UNIMPLEMENTED
-#else
-	UINT8  *DestPtr;
-	UINT32 LineSkip;
-
-	// Assertions
-	Assert( hSrcVObject != NULL );
-	Assert( pBuffer != NULL );
-
-	// Get Offsets from Index into structure
-	ETRLEObject const& pTrav = hSrcVObject->SubregionProperties(usIndex);
-	UINT32      const  usHeight = pTrav.usHeight;
-	UINT32      const  usWidth  = pTrav.usWidth;
-
-	// Add to start position of dest buffer
-	INT32 const iTempX = iX + pTrav.sOffsetX;
-	INT32 const iTempY = iY + pTrav.sOffsetY;
+	BltETRLE<false>(pBuffer, uiDestPitchBYTES, hSrcVObject, iX, iY, usIndex, NULL, ETRLEShadePolicy(IntensityTable));
+}
 
-	// Validations
-	CHECKV(iTempX >= 0);
-	CHECKV(iTempY >= 0);
 
-	UINT8 const* SrcPtr = hSrcVObject->PixData(pTrav);
-	DestPtr = (UINT8 *)pBuffer + (uiDestPitchBYTES*iTempY) + (iTempX*2);
-	LineSkip=(uiDestPitchBYTES-(usWidth*2));
+/**********************************************************************************************
+Blt8BPPDataTo16BPPBufferTransZClipPixelateObscured
 
-	__asm {
+	Blits an image into the destination buffer, using an ETRLE brush as a source, and a 16-bit
+	buffer as a destination. As it is blitting, it checks the Z value of the ZBuffer, and if the
+	pixel's Z level is below that of the current pixel, it is written on, and the Z value is
+	NOT updated to the current value,	for any non-transparent pixels. The Z-buffer is 16 bit, and
+	must be the same dimensions (including Pitch) as the destination.
 
-		mov		esi, SrcPtr
-		mov		edi, DestPtr
-		xor		eax, eax
-		mov		ebx, usHeight
-		xor		ecx, ecx
-		mov		edx, OFFSET IntensityTable
+	Blits every second pixel ("pixelates").
 
-BlitDispatch:
+**********************************************************************************************/
+void Blt8BPPDataTo16BPPBufferTransZClipPixelateObscured( UINT16 *pBuffer, UINT32 uiDestPitchBYTES, UINT16 *pZBuffer, UINT16 usZValue, HVOBJECT hSrcVObject, INT32 iX, INT32 iY, UINT16 usIndex, SGPRect *clipregion)
+{
+	BltETRLE<true>(pBuffer, uiDestPitchBYTES, hSrcVObject, iX, iY, usIndex, clipregion, ETRLEPixelateZPolicy<false>(pZBuffer, usZValue, hSrcVObject->CurrentShade(), 0, hSrcVObject, iY, usIndex));
+}
 
 
-		mov		cl, [esi]
-		inc		esi
-		or		cl, cl
-		js		BlitTransparent
-		jz		BlitDoneLine
+#ifdef WITH_UNITTESTS
+#undef FAIL
+#include "gtest/gtest.h"
 
-//BlitNonTransLoop:
+#include <vector>
 
-		xor		eax, eax
 
-		add		esi, ecx
+namespace
+{
+	// Deterministic, so a failure can be reproduced
+	struct TestRandom
+	{
+		UINT32 state;
+		explicit TestRandom(UINT32 const seed) : state(seed) {}
+		UINT32 operator ()(UINT32 const n) { state = state * 1664525 + 1013904223; return (state >> 8) % n; }
+	};
 
-		clc
-		rcr		cl, 1
-		jnc		BlitNTL2
+	/* A random ETRLE image together with its pixels, -1 for transparent ones,
+	 * so the blitters can be checked against a plain loop over the pixels. */
+	struct TestETRLEImage
+	{
+		INT32              w;
+		INT32              h;
+		INT16              offset_x;
+		INT16              offset_y;
+		std::vector<UINT8> data;
+		std::vector<INT32> pixels;
+	};
 
-		mov		ax, [edi]
-		mov		ax, [edx+eax*2]
-		mov		[edi], ax
+	TestETRLEImage MakeTestETRLEImage(TestRandom& rnd)
+	{
+		TestETRLEImage img;
+		img.w        = 1 + rnd(40);
+		img.h        = 1 + rnd(24);
+		img.offset_x = INT16(rnd(11)) - 5;
+		img.offset_y = INT16(rnd(11)) - 5;
+		for (INT32 y = 0; y != img.h; ++y)
+		{
+			for (INT32 x = 0; x != img.w;)
+			{
+				UINT32 const n = 1 + rnd(__min(img.w - x, 0x7F));
+				if (rnd(3) == 0)
+				{
+					img.data.push_back(UINT8(0x80 | n));
+					img.pixels.insert(img.pixels.end(), n, -1);
+				}
+				else
+				{
+					img.data.push_back(UINT8(n));
+					for (UINT32 i = 0; i != n; ++i)
+					{
+						// Index 254 is the outline or shadow, 1 the mono shadow
+						UINT32 const r   = rnd(10);
+						UINT8  const idx = r == 0 ? 254 : r == 1 ? 1 : UINT8(1 + rnd(255));
+						img.data.push_back(idx);
+						img.pixels.push_back(idx);
+					}
+				}
+				x += n;
+			}
+			img.data.push_back(0);
+		}
+		return img;
+	}
 
-		add		edi, 2
+	SGPVObject* MakeTestVObject(TestETRLEImage const& t)
+	{
+		SGPImage img(t.w, t.h, 8);
+		img.fFlags = IMAGE_TRLECOMPRESSED;
 
-BlitNTL2:
-		clc
-		rcr		cl, 1
-		jnc		BlitNTL3
+		SGPPaletteEntry* const pal = img.pPalette.Allocate(256);
+		for (UINT i = 0; i != 256; ++i)
+		{
+			pal[i].r = i;
+			pal[i].g = i * 7;
+			pal[i].b = i * 13 + 5;
+			pal[i].a = 0;
+		}
 
-		mov		ax, [edi]
-		mov		ax, [edx+eax*2]
-		mov		[edi], ax
+		UINT8* const data = img.pImageData.Allocate(t.data.size());
+		std::copy(t.data.begin(), t.data.end(), data);
+		img.uiSizePixData = t.data.size();
 
-		mov		ax, [edi+2]
-		mov		ax, [edx+eax*2]
-		mov		[edi+2], ax
+		ETRLEObject* const e = img.pETRLEObject.Allocate(1);
+		e->uiDataOffset = 0;
+		e->uiDataLength = t.data.size();
+		e->sOffsetX     = t.offset_x;
+		e->sOffsetY     = t.offset_y;
+		e->usHeight     = t.h;
+		e->usWidth      = t.w;
+		img.usNumberOfObjects = 1;
 
-		add		edi, 4
+		return new SGPVObject(&img);
+	}
 
-BlitNTL3:
+	enum TestBlit
+	{
+		TB_PALETTE, TB_PALETTE_Z, TB_SHADE, TB_SHADE_Z, TB_INTENSITY, TB_INTENSITY_Z,
+		TB_TRANSLUCENT_Z, TB_MONO_SHADOW, TB_PIXELATE_Z, TB_OUTLINE_PIXELATE_Z,
+		TB_OUTLINE, TB_OUTLINE_Z, TB_OUTLINE_ZNB, TB_OUTLINE_SHADOW,
+		TB_TRANS_SHADOW, TB_TRANS_SHADOW_Z, TB_TRANS_SHADOW_Z_OBSCURED
+	};
 
-		or		cl, cl
-		jz		BlitDispatch
+	UINT16 const TEST_OUTLINE    = 0x1234;
+	UINT16 const TEST_FOREGROUND = 0x4321;
+	UINT16 const TEST_BACKGROUND = 0x5678;
 
-BlitNTL4:
+	/* What the blitters are meant to do, one pixel at a time. The clipping
+	 * rectangle is exclusive at the right and the bottom. The buffer is
+	 * aligned and of even width, so the checkerboard of the obscured blitters
+	 * covers the pixels whose column and row are both even or both odd. */
+	void ReferenceBlit(UINT16* const buf, UINT16* const zbuf, INT32 const pitch, TestETRLEImage const& img, UINT16 const* const pal, INT32 const x, INT32 const y, SGPRect const& clip, TestBlit const mode, bool const update_z, UINT16 const zval)
+	{
+		for (INT32 row = 0; row != img.h; ++row)
+		{
+			for (INT32 col = 0; col != img.w; ++col)
+			{
+				INT32 const px  = x + img.offset_x + col;
+				INT32 const py  = y + img.offset_y + row;
+				INT32 const idx = img.pixels[row * img.w + col];
+				if (px < clip.iLeft || px >= clip.iRight || py < clip.iTop || py >= clip.iBottom) continue;
 
-		mov		ax, [edi]
-		mov		ax, [edx+eax*2]
-		mov		[edi], ax
+				UINT16&    d          = buf[py * pitch + px];
+				UINT16&    z          = zbuf[py * pitch + px];
+				bool const on_pattern = (px & 1) == (py & 1);
+				if (idx < 0)
+				{
+					if (mode == TB_MONO_SHADOW) d = TEST_BACKGROUND;
+					continue;
+				}
+				switch (mode)
+				{
+					case TB_PALETTE:   d = pal[idx];           break;
+					case TB_SHADE:     d = ShadeTable[d];      break;
+					case TB_INTENSITY: d = IntensityTable[d];  break;
 
-		mov		ax, [edi+2]
-		mov		ax, [edx+eax*2]
-		mov		[edi+2], ax
+					case TB_MONO_SHADOW: // no shadow colour
+						if (idx != 1) d = TEST_FOREGROUND;
+						break;
 
-		mov		ax, [edi+4]
-		mov		ax, [edx+eax*2]
-		mov		[edi+4], ax
+					case TB_TRANSLUCENT_Z:
+						if (z > zval) break;
+						if (update_z) z = zval;
+						d = (pal[idx] >> 1 & 0x7BEF) + (d >> 1 & 0x7BEF);
+						break;
 
-		mov		ax, [edi+6]
-		mov		ax, [edx+eax*2]
-		mov		[edi+6], ax
+					case TB_PIXELATE_Z:
+					case TB_OUTLINE_PIXELATE_Z:
+						if (z < zval)
+						{
+							z = zval;
+						}
+						else if (!on_pattern)
+						{
+							break;
+						}
+						d = mode == TB_OUTLINE_PIXELATE_Z && idx == 254 ? TEST_OUTLINE : pal[idx];
+						break;
 
-		add		edi, 8
-		dec		cl
-		jnz		BlitNTL4
+					case TB_OUTLINE:
+						d = idx == 254 ? TEST_OUTLINE : pal[idx];
+						break;
 
-		jmp		BlitDispatch
+					case TB_OUTLINE_Z:
+						if (z > zval) break;
+						if (idx == 254)
+						{
+							d = TEST_OUTLINE;
+						}
+						else
+						{
+							z = zval;
+							d = pal[idx];
+						}
+						break;
 
-BlitTransparent:
+					case TB_OUTLINE_ZNB:
+						if (z < zval && idx != 254) d = pal[idx];
+						break;
 
-		and		ecx, 07fH
-//		shl		ecx, 1
-		add   ecx, ecx
-		add		edi, ecx
-		jmp		BlitDispatch
+					case TB_OUTLINE_SHADOW:
+						if (idx != 254) d = ShadeTable[d];
+						break;
 
+					case TB_TRANS_SHADOW:
+						d = idx == 254 ? ShadeTable[d] : pal[idx];
+						break;
 
-BlitDoneLine:
+					case TB_TRANS_SHADOW_Z:
+					case TB_TRANS_SHADOW_Z_OBSCURED:
+						if (update_z)
+						{
+							if (z >= zval) break;
+							z = zval;
+						}
+						else if (idx == 254 ? z >= zval : z > zval && !(mode == TB_TRANS_SHADOW_Z_OBSCURED && on_pattern))
+						{
+							break;
+						}
+						d = idx == 254 ? ShadeTable[d] : pal[idx];
+						break;
 
-		dec		ebx
-		jz		BlitDone
-		add		edi, LineSkip
-		jmp		BlitDispatch
+					case TB_PALETTE_Z:
+						if (z > zval) break;
+						if (update_z) z = zval;
+						d = pal[idx];
+						break;
 
+					case TB_SHADE_Z:
+						if (z >= zval) break;
+						if (update_z) z = zval;
+						d = ShadeTable[d];
+						break;
 
-BlitDone:
+					case TB_INTENSITY_Z:
+						if (z >= zval) break;
+						if (update_z) z = zval;
+						d = IntensityTable[d];
+						break;
+				}
+			}
+		}
 	}
-#endif
 }
 
 
-/**********************************************************************************************
-Blt8BPPDataTo16BPPBufferTransZClipPixelateObscured
-
-	Blits an image into the destination buffer, using an ETRLE brush as a source, and a 16-bit
-	buffer as a destination. As it is blitting, it checks the Z value of the ZBuffer, and if the
-	pixel's Z level is below that of the current pixel, it is written on, and the Z value is
-	NOT updated to the current value,	for any non-transparent pixels. The Z-buffer is 16 bit, and
-	must be the same dimensions (including Pitch) as the destination.
-
-	Blits every second pixel ("pixelates").
-
-**********************************************************************************************/
-void Blt8BPPDataTo16BPPBufferTransZClipPixelateObscured( UINT16 *pBuffer, UINT32 uiDestPitchBYTES, UINT16 *pZBuffer, UINT16 usZValue, HVOBJECT hSrcVObject, INT32 iX, INT32 iY, UINT16 usIndex, SGPRect *clipregion)
+TEST(VObjectBlitters, etrleMatchesReference)
 {
-	UINT32 uiLineFlag;
-	UINT32 Unblitted;
-	UINT8  *DestPtr, *ZPtr;
-	UINT32 LineSkip;
-	INT32  LeftSkip, RightSkip, TopSkip, BottomSkip, BlitLength, BlitHeight, LSCount;
-	INT32  ClipX1, ClipY1, ClipX2, ClipY2;
-
-	// Assertions
-	Assert( hSrcVObject != NULL );
-	Assert( pBuffer != NULL );
-
-	// Get Offsets from Index into structure
-	ETRLEObject const& pTrav = hSrcVObject->SubregionProperties(usIndex);
-	UINT32      const  usHeight = pTrav.usHeight;
-	UINT32      const  usWidth  = pTrav.usWidth;
-
-	// Add to start position of dest buffer
-	INT32 const iTempX = iX + pTrav.sOffsetX;
-	INT32 const iTempY = iY + pTrav.sOffsetY;
+	// 565
+	gusRedMask    = 0xF800;
+	gusGreenMask  = 0x07E0;
+	gusBlueMask   = 0x001F;
+	gusRedShift   =  8;
+	gusGreenShift =  3;
+	gusBlueShift  = -3;
+	for (UINT i = 0; i != 65536; ++i) ShadeTable[i]     = (i >> 1) & 0x7BEF;
+	for (UINT i = 0; i != 65536; ++i) IntensityTable[i] = UINT16(i * 7 + 1);
+	guiTranslucentMask = 0x7BEF;
+
+	static struct { bool clipped; TestBlit mode; bool update_z; } const kinds[] =
+	{
+		{ false, TB_PALETTE_Z,               true  },
+		{ false, TB_PALETTE_Z,               false },
+		{ false, TB_SHADE_Z,                 true  },
+		{ false, TB_SHADE_Z,                 false },
+		{ false, TB_PALETTE,                 false },
+		{ false, TB_SHADE,                   false },
+		{ true,  TB_PALETTE_Z,               true  },
+		{ true,  TB_PALETTE_Z,               false },
+		{ true,  TB_SHADE_Z,                 true  },
+		{ true,  TB_SHADE_Z,                 false },
+		{ true,  TB_PALETTE,                 false },
+		{ true,  TB_SHADE,                   false },
+		{ false, TB_INTENSITY_Z,             true  },
+		{ false, TB_INTENSITY_Z,             false },
+		{ true,  TB_INTENSITY_Z,             true  },
+		{ false, TB_TRANSLUCENT_Z,           true  },
+		{ false, TB_TRANSLUCENT_Z,           false },
+		{ true,  TB_TRANSLUCENT_Z,           false },
+		{ true,  TB_MONO_SHADOW,             false },
+		{ false, TB_PIXELATE_Z,              true  },
+		{ true,  TB_PIXELATE_Z,              true  },
+		{ false, TB_OUTLINE_PIXELATE_Z,      true  },
+		{ true,  TB_OUTLINE_PIXELATE_Z,      true  },
+		{ false, TB_OUTLINE,                 false },
+		{ true,  TB_OUTLINE,                 false },
+		{ false, TB_OUTLINE_Z,               true  },
+		{ true,  TB_OUTLINE_Z,               true  },
+		{ false, TB_OUTLINE_ZNB,             false },
+		{ false, TB_OUTLINE_SHADOW,          false },
+		{ true,  TB_OUTLINE_SHADOW,          false },
+		{ false, TB_TRANS_SHADOW,            false },
+		{ true,  TB_TRANS_SHADOW,            false },
+		{ false, TB_TRANS_SHADOW_Z,          false },
+		{ false, TB_TRANS_SHADOW_Z,          false },
+		{ true,  TB_TRANS_SHADOW_Z,          false },
+		{ true,  TB_TRANS_SHADOW_Z,          true  },
+		{ false, TB_TRANS_SHADOW_Z_OBSCURED, false },
+		{ true,  TB_TRANS_SHADOW_Z_OBSCURED, false },
+		{ false, TB_INTENSITY,               false },
+		{ true,  TB_INTENSITY,               false }
+	};
 
-	if(clipregion==NULL)
-	{
-		ClipX1=ClippingRect.iLeft;
-		ClipY1=ClippingRect.iTop;
-		ClipX2=ClippingRect.iRight;
-		ClipY2=ClippingRect.iBottom;
+	INT32  const W     = 64;
+	INT32  const H     = 48;
+	UINT32 const pitch = W * sizeof(UINT16);
+
+	TestRandom rnd(12345);
+	for (UINT iteration = 0; iteration != 300; ++iteration)
+	{
+		TestETRLEImage const img = MakeTestETRLEImage(rnd);
+		SGPVObject*    const vo  = MakeTestVObject(img);
+		UINT16 const*  const pal = vo->CurrentShade();
+
+		std::vector<UINT16> buf0(W * H);
+		std::vector<UINT16> zbuf0(W * H);
+		for (UINT16& p : buf0)  p = UINT16(rnd(65536));
+		for (UINT16& z : zbuf0) z = UINT16(rnd(8));
+		UINT16 const zval = UINT16(rnd(8));
+
+		// Positions partly off the buffer, which only the clipped blitters take
+		INT32 const x = INT32(rnd(W + 40)) - 20;
+		INT32 const y = INT32(rnd(H + 30)) - 15;
+		SGPRect clip;
+		clip.iLeft   = rnd(W / 2);
+		clip.iTop    = rnd(H / 2);
+		clip.iRight  = clip.iLeft + 1 + rnd(W - clip.iLeft);
+		clip.iBottom = clip.iTop  + 1 + rnd(H - clip.iTop);
+		SGPRect const whole = { 0, 0, W, H };
+
+		INT32 const left = x + img.offset_x;
+		INT32 const top  = y + img.offset_y;
+		bool  const fits = left >= 0 && top >= 0 && left + img.w <= W && top + img.h <= H;
+
+		for (UINT kind = 0; kind != lengthof(kinds); ++kind)
+		{
+			bool     const clipped  = kinds[kind].clipped;
+			TestBlit const mode     = kinds[kind].mode;
+			bool     const update_z = kinds[kind].update_z;
+			if (!clipped && !fits) continue;
+
+			std::vector<UINT16> buf(buf0),  expected(buf0);
+			std::vector<UINT16> zbuf(zbuf0), expected_z(zbuf0);
+			SGPRect* const region = clipped ? &clip : 0;
+			switch (kind)
+			{
+				case  0: Blt8BPPDataTo16BPPBufferTransZ(                     &buf[0], pitch, &zbuf[0], zval, vo, x, y, 0); break;
+				case  1: Blt8BPPDataTo16BPPBufferTransZNB(                   &buf[0], pitch, &zbuf[0], zval, vo, x, y, 0); break;
+				case  2: Blt8BPPDataTo16BPPBufferShadowZ(                    &buf[0], pitch, &zbuf[0], zval, vo, x, y, 0); break;
+				case  3: Blt8BPPDataTo16BPPBufferShadowZNB(                  &buf[0], pitch, &zbuf[0], zval, vo, x, y, 0); break;
+				case  4: Blt8BPPDataTo16BPPBufferTransparent(                &buf[0], pitch,                 vo, x, y, 0); break;
+				case  5: Blt8BPPDataTo16BPPBufferShadow(                     &buf[0], pitch,                 vo, x, y, 0); break;
+				case  6: Blt8BPPDataTo16BPPBufferTransZClip(                 &buf[0], pitch, &zbuf[0], zval, vo, x, y, 0, region); break;
+				case  7: Blt8BPPDataTo16BPPBufferTransZNBClip(               &buf[0], pitch, &zbuf[0], zval, vo, x, y, 0, region); break;
+				case  8: Blt8BPPDataTo16BPPBufferShadowZClip(                &buf[0], pitch, &zbuf[0], zval, vo, x, y, 0, region); break;
+				case  9: Blt8BPPDataTo16BPPBufferShadowZNBClip(              &buf[0], pitch, &zbuf[0], zval, vo, x, y, 0, region); break;
+				case 10: Blt8BPPDataTo16BPPBufferTransparentClip(            &buf[0], pitch,                 vo, x, y, 0, region); break;
+				case 11: Blt8BPPDataTo16BPPBufferShadowClip(                 &buf[0], pitch,                 vo, x, y, 0, region); break;
+				case 12: Blt8BPPDataTo16BPPBufferIntensityZ(                 &buf[0], pitch, &zbuf[0], zval, vo, x, y, 0); break;
+				case 13: Blt8BPPDataTo16BPPBufferIntensityZNB(               &buf[0], pitch, &zbuf[0], zval, vo, x, y, 0); break;
+				case 14: Blt8BPPDataTo16BPPBufferIntensityZClip(             &buf[0], pitch, &zbuf[0], zval, vo, x, y, 0, region); break;
+				case 15: Blt8BPPDataTo16BPPBufferTransZTranslucent(          &buf[0], pitch, &zbuf[0], zval, vo, x, y, 0); break;
+				case 16: Blt8BPPDataTo16BPPBufferTransZNBTranslucent(        &buf[0], pitch, &zbuf[0], zval, vo, x, y, 0); break;
+				case 17: Blt8BPPDataTo16BPPBufferTransZNBClipTranslucent(    &buf[0], pitch, &zbuf[0], zval, vo, x, y, 0, region); break;
+				case 18: Blt8BPPDataTo16BPPBufferMonoShadowClip(             &buf[0], pitch,                 vo, x, y, 0, region, TEST_FOREGROUND, TEST_BACKGROUND, 0); break;
+				case 19: Blt8BPPDataTo16BPPBufferTransZPixelateObscured(     &buf[0], pitch, &zbuf[0], zval, vo, x, y, 0); break;
+				case 20: Blt8BPPDataTo16BPPBufferTransZClipPixelateObscured( &buf[0], pitch, &zbuf[0], zval, vo, x, y, 0, region); break;
+				case 21: Blt8BPPDataTo16BPPBufferOutlineZPixelateObscured(   &buf[0], pitch, &zbuf[0], zval, vo, x, y, 0, TEST_OUTLINE); break;
+				case 22: Blt8BPPDataTo16BPPBufferOutlineZPixelateObscuredClip(&buf[0], pitch, &zbuf[0], zval, vo, x, y, 0, TEST_OUTLINE, region); break;
+				case 23: Blt8BPPDataTo16BPPBufferOutline(                    &buf[0], pitch,                 vo, x, y, 0, TEST_OUTLINE); break;
+				case 24: Blt8BPPDataTo16BPPBufferOutlineClip(                &buf[0], pitch,                 vo, x, y, 0, TEST_OUTLINE, region); break;
+				case 25: Blt8BPPDataTo16BPPBufferOutlineZ(                   &buf[0], pitch, &zbuf[0], zval, vo, x, y, 0, TEST_OUTLINE); break;
+				case 26: Blt8BPPDataTo16BPPBufferOutlineZClip(               &buf[0], pitch, &zbuf[0], zval, vo, x, y, 0, TEST_OUTLINE, region); break;
+				case 27: Blt8BPPDataTo16BPPBufferOutlineZNB(                 &buf[0], pitch, &zbuf[0], zval, vo, x, y, 0); break;
+				case 28: Blt8BPPDataTo16BPPBufferOutlineShadow(              &buf[0], pitch,                 vo, x, y, 0); break;
+				case 29: Blt8BPPDataTo16BPPBufferOutlineShadowClip(          &buf[0], pitch,                 vo, x, y, 0, region); break;
+				case 30: Blt8BPPDataTo16BPPBufferTransShadow(                &buf[0], pitch,                 vo, x, y, 0, pal); break;
+				case 31: Blt8BPPDataTo16BPPBufferTransShadowClip(            &buf[0], pitch,                 vo, x, y, 0, region, pal); break;
+				case 32: Blt8BPPDataTo16BPPBufferTransShadowZ(               &buf[0], pitch, &zbuf[0], zval, vo, x, y, 0, pal); break;
+				case 33: Blt8BPPDataTo16BPPBufferTransShadowZNB(             &buf[0], pitch, &zbuf[0], zval, vo, x, y, 0, pal); break;
+				case 34: Blt8BPPDataTo16BPPBufferTransShadowZNBClip(         &buf[0], pitch, &zbuf[0], zval, vo, x, y, 0, region, pal); break;
+				case 35: Blt8BPPDataTo16BPPBufferTransShadowZClip(           &buf[0], pitch, &zbuf[0], zval, vo, x, y, 0, region, pal); break;
+				case 36: Blt8BPPDataTo16BPPBufferTransShadowZNBObscured(     &buf[0], pitch, &zbuf[0], zval, vo, x, y, 0, pal); break;
+				case 37: Blt8BPPDataTo16BPPBufferTransShadowZNBObscuredClip( &buf[0], pitch, &zbuf[0], zval, vo, x, y, 0, region, pal); break;
+				case 38: Blt8BPPDataTo16BPPBufferIntensity(                  &buf[0], pitch,                 vo, x, y, 0); break;
+				case 39: Blt8BPPDataTo16BPPBufferIntensityClip(              &buf[0], pitch,                 vo, x, y, 0, region); break;
+			}
+			ReferenceBlit(&expected[0], &expected_z[0], W, img, pal, x, y, clipped ? clip : whole, mode, update_z, zval);
+
+			EXPECT_EQ(expected,   buf)  << "iteration " << iteration << ", blitter " << kind;
+			EXPECT_EQ(expected_z, zbuf) << "iteration " << iteration << ", blitter " << kind;
+		}
+
+		delete vo;
 	}
-	else
-	{
-		ClipX1=clipregion->iLeft;
-		ClipY1=clipregion->iTop;
-		ClipX2=clipregion->iRight;
-		ClipY2=clipregion->iBottom;
-	}
-
-	// Calculate rows hanging off each side of the screen
-	LeftSkip=__min(ClipX1 - MIN(ClipX1, iTempX), (INT32)usWidth);
-	RightSkip=__min(MAX(ClipX2, (iTempX+(INT32)usWidth)) - ClipX2, (INT32)usWidth);
-	TopSkip=__min(ClipY1 - __min(ClipY1, iTempY), (INT32)usHeight);
-	BottomSkip=__min(__max(ClipY2, (iTempY+(INT32)usHeight)) - ClipY2, (INT32)usHeight);
-
-	// calculate the remaining rows and columns to blit
-	BlitLength=((INT32)usWidth-LeftSkip-RightSkip);
-	BlitHeight=((INT32)usHeight-TopSkip-BottomSkip);
-
-	// check if whole thing is clipped
-	if((LeftSkip >=(INT32)usWidth) || (RightSkip >=(INT32)usWidth))
-		return;
-
-	// check if whole thing is clipped
-	if((TopSkip >=(INT32)usHeight) || (BottomSkip >=(INT32)usHeight))
-		return;
-
-	UINT8 const* SrcPtr = hSrcVObject->PixData(pTrav);
-	DestPtr = (UINT8 *)pBuffer + (uiDestPitchBYTES*(iTempY+TopSkip)) + ((iTempX+LeftSkip)*2);
-	ZPtr = (UINT8 *)pZBuffer + (uiDestPitchBYTES*(iTempY+TopSkip)) + ((iTempX+LeftSkip)*2);
-	UINT16 const* const p16BPPPalette = hSrcVObject->CurrentShade();
-	LineSkip=(uiDestPitchBYTES-(BlitLength*2));
-	uiLineFlag=(iTempY&1);
+}
 
-	uiLineFlag = (iTempY + TopSkip) & 1;
 
-	UINT32 PxCount;
+// The vector kernel of BlitZRun() against its scalar loop
+template<bool UpdateZ>
+static void TestBlitZRun()
+{
+	UINT16 pal[256];
+	for (UINT i = 0; i != 256; ++i) pal[i] = UINT16(i * 251 + 3);
 
-	while (TopSkip > 0)
+	TestRandom rnd(UpdateZ ? 2 : 1);
+	for (UINT32 n = 0; n != 26; ++n)
 	{
-		for (;;)
+		for (UINT offset = 0; offset != 3; ++offset)
 		{
-			PxCount = *SrcPtr++;
-			if (PxCount & 0x80) continue;
-			if (PxCount == 0) break;
-			SrcPtr += PxCount;
-		}
-		TopSkip--;
-	}
+			// Room before and after the run, to catch writes outside of it
+			UINT8  src[40];
+			UINT16 dst[40];
+			UINT16 zbuf[40];
+			for (UINT i = 0; i != 40; ++i)
+			{
+				src[i]  = UINT8(rnd(256));
+				dst[i]  = UINT16(rnd(65536));
+				zbuf[i] = UINT16(rnd(6) == 0 ? 0xFFFF - rnd(2) : rnd(6));
+			}
+			UINT16 const zval = UINT16(rnd(4) == 0 ? 0xFFFF : rnd(6));
 
-	do
-	{
-		for (LSCount = LeftSkip; LSCount > 0; LSCount -= PxCount)
-		{
-			PxCount = *SrcPtr++;
-			if (PxCount & 0x80)
+			UINT16 expected[40];
+			UINT16 expected_z[40];
+			std::copy(std::begin(dst),  std::end(dst),  expected);
+			std::copy(std::begin(zbuf), std::end(zbuf), expected_z);
+			for (UINT i = 4 + offset; i != 4 + offset + n; ++i)
 			{
-				PxCount &= 0x7F;
-				if (PxCount > LSCount)
-				{
-					PxCount -= LSCount;
-					LSCount = BlitLength;
-					goto BlitTransparent;
-				}
+				if (expected_z[i] > zval) continue;
+				if (UpdateZ) expected_z[i] = zval;
+				expected[i] = pal[src[i]];
 			}
-			else
+
+			BlitZRun<UpdateZ>(dst + 4 + offset, zbuf + 4 + offset, src + 4 + offset, n, pal, zval);
+			for (UINT i = 0; i != 40; ++i)
 			{
-				if (PxCount > LSCount)
-				{
-					SrcPtr += LSCount;
-					PxCount -= LSCount;
-					LSCount = BlitLength;
-					goto BlitNonTransLoop;
-				}
-				SrcPtr += PxCount;
+				EXPECT_EQ(expected[i],   dst[i])  << "run of " << n << " at " << offset << ", pixel " << i;
+				EXPECT_EQ(expected_z[i], zbuf[i]) << "run of " << n << " at " << offset << ", pixel " << i;
 			}
 		}
+	}
+}
+
 
-		LSCount = BlitLength;
-		while (LSCount > 0)
+// The vector kernel of ShadeZRun() against its scalar loop
+template<bool UpdateZ>
+static void TestShadeZRun()
+{
+	static UINT16 table[65536];
+	for (UINT i = 0; i != 65536; ++i) table[i] = UINT16(i * 40503 + 7);
+
+	TestRandom rnd(UpdateZ ? 4 : 3);
+	for (UINT32 n = 0; n != 26; ++n)
+	{
+		for (UINT offset = 0; offset != 3; ++offset)
 		{
-			PxCount = *SrcPtr++;
-			if (PxCount & 0x80)
+			// Room before and after the run, to catch writes outside of it
+			UINT16 dst[40];
+			UINT16 zbuf[40];
+			for (UINT i = 0; i != 40; ++i)
 			{
-BlitTransparent: // skip transparent pixels
-				PxCount &= 0x7F;
-				if (PxCount > LSCount) PxCount = LSCount;
-				LSCount -= PxCount;
-				DestPtr += 2 * PxCount;
-				ZPtr    += 2 * PxCount;
+				dst[i]  = UINT16(rnd(65536));
+				zbuf[i] = UINT16(rnd(6) == 0 ? 0xFFFF - rnd(2) : rnd(6));
 			}
-			else
+			UINT16 const zval = UINT16(rnd(4) == 0 ? 0xFFFF : rnd(6));
+
+			UINT16 expected[40];
+			UINT16 expected_z[40];
+			std::copy(std::begin(dst),  std::end(dst),  expected);
+			std::copy(std::begin(zbuf), std::end(zbuf), expected_z);
+			for (UINT i = 4 + offset; i != 4 + offset + n; ++i)
 			{
-BlitNonTransLoop: // blit non-transparent pixels
-				if (PxCount > LSCount)
-				{
-					Unblitted = PxCount - LSCount;
-					PxCount = LSCount;
-				}
-				else
-				{
-					Unblitted = 0;
-				}
-				LSCount -= PxCount;
+				if (expected_z[i] >= zval) continue;
+				if (UpdateZ) expected_z[i] = zval;
+				expected[i] = table[expected[i]];
+			}
 
-				do
-				{
-					if (*(UINT16*)ZPtr < usZValue)
-					{
-						*(UINT16*)ZPtr = usZValue;
-					}
-					else
-					{
-						if (uiLineFlag != (((uintptr_t)DestPtr & 2) != 0)) continue;
-					}
-					*(UINT16*)DestPtr = p16BPPPalette[*SrcPtr];
-				}
-				while (SrcPtr++, DestPtr += 2, ZPtr += 2, --PxCount > 0);
-				SrcPtr += Unblitted;
+			ShadeZRun<UpdateZ>(dst + 4 + offset, zbuf + 4 + offset, n, table, zval);
+			for (UINT i = 0; i != 40; ++i)
+			{
+				EXPECT_EQ(expected[i],   dst[i])  << "run of " << n << " at " << offset << ", pixel " << i;
+				EXPECT_EQ(expected_z[i], zbuf[i]) << "run of " << n << " at " << offset << ", pixel " << i;
 			}
 		}
-
-		while (*SrcPtr++ != 0) {} // skip along until we hit and end-of-line marker
-		DestPtr += LineSkip;
-		ZPtr += LineSkip;
-		uiLineFlag ^= 1;
 	}
-	while (--BlitHeight > 0);
 }
+
+
+TEST(VObjectBlitters, zRunMatchesScalar)
+{
+	TestBlitZRun<true>();
+	TestBlitZRun<false>();
+	TestShadeZRun<true>();
+	TestShadeZRun<false>();
+}
+
+#endif
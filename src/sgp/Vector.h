@@ -52,7 +52,7 @@ namespace SGP
 		catch (...)
 		{
 			for (size_t k = i; k != 0;) new_v[--i].~T();
-			free(new_v);
+			MemFree(new_v);
 			throw;
 		}
 
@@ -61,7 +61,7 @@ namespace SGP
 		size_     = new_size;
 
 		for (size_t k = old_size; k != 0;) old_v[--k].~T();
-		free(old_v);
+		MemFree(old_v);
 	}
 }
 
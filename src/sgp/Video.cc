@@ -1,3 +1,4 @@
+#include "Benchmark_Suite.h"
 #include "Debug.h"
 #include "Fade_Screen.h"
 #include "FileMan.h"
@@ -5,6 +6,7 @@
 #include "Input.h"
 #include "Local.h"
 #include "MemMan.h"
+#include "Profiler.h"
 #include "RenderWorld.h"
 #include "Render_Dirty.h"
 #include "Timer.h"
@@ -24,25 +26,47 @@
 #include "Logger.h"
 
 #include <algorithm>
+#include <atomic>
 #include <ctime>
 #include <errno.h>
 #include <fcntl.h>
 #include <stdarg.h>
 #include <stdexcept>
+#include <string>
+#include <vector>
 
 #define BUFFER_READY      0x00
 #define BUFFER_DIRTY      0x02
 
+/* NEAR_PERFECT scales the screen up by a whole multiple with nearest neighbour
+ * sampling into ScaledScreenTexture, and that down or up to the window with
+ * linear sampling. The multiple is the smallest which covers the window, but
+ * not above this. */
+#define NEAR_PERFECT_MAX_SCALE 4
+
 #define MAX_CURSOR_WIDTH  64
 #define MAX_CURSOR_HEIGHT 64
 
 #define MAX_DIRTY_REGIONS 128
 
+/* If the dirty regions of a frame cover more than this percentage of the
+ * screen, copy the whole frame buffer instead of one rectangle at a time */
+#define DIRTY_REGIONS_MAX_PERCENT 75
+
+// Dirty regions, scroll strip and both mouse cursor rectangles
+#define MAX_TEXTURE_UPDATE_RECTS (MAX_DIRTY_REGIONS * 2 + 3)
+
+/* If the dirty area of a frame exceeds this percentage of the screen, upload
+ * the whole screen texture at once instead of one rectangle at a time */
+#define PARTIAL_TEXTURE_UPDATE_MAX_PERCENT 50
+
 #define VIDEO_OFF         0x00
 #define VIDEO_ON          0x01
 #define VIDEO_SUSPENDED   0x04
 
-#define MAX_NUM_FRAMES    25
+/* Captured frames waiting for the capture thread. When it falls behind by this
+ * many frames, new ones are dropped instead of stalling the game. */
+#define CAPTURE_RING_FRAMES 16
 
 #define RED_MASK 0xF800
 #define GREEN_MASK 0x07E0
@@ -53,8 +77,19 @@
 static BOOLEAN gfVideoCapture = FALSE;
 static UINT32  guiFramePeriod = 1000 / 15;
 static UINT32  guiLastFrame;
-static UINT16* gpFrameData[MAX_NUM_FRAMES];
-static INT32   giNumFrames = 0;
+
+/* The game thread copies frames into the ring at g_capture_head, the capture
+ * thread writes them out from g_capture_tail. g_capture_ready counts the
+ * frames in between. */
+static UINT16*             g_capture_frames[CAPTURE_RING_FRAMES];
+static std::atomic<UINT32> g_capture_head;
+static std::atomic<UINT32> g_capture_tail;
+static std::atomic<bool>   g_capture_quit;
+static SDL_sem*            g_capture_ready;
+static SDL_Thread*         g_capture_thread;
+static std::string         g_capture_folder;
+static UINT32              g_capture_file_no;
+static UINT32              g_capture_dropped;
 
 
 // Globals for mouse cursor
@@ -64,6 +99,41 @@ static INT16  gsMouseCursorXOffset;
 static INT16  gsMouseCursorYOffset;
 
 static SDL_Rect MouseBackground = { 0, 0, 0, 0 };
+static BOOLEAN  gfMouseCursorDrawn; // into the ScreenBuffer, at MouseBackground
+
+/* How the MouseCursor surface reaches the screen. Unless it is
+ * CURSOR_SOFTWARE the cursor is drawn after the ScreenBuffer is uploaded, so
+ * the ScreenBuffer never contains it and nothing has to be restored or
+ * re-uploaded when the mouse moves:
+ * - CURSOR_GPU_LAYER draws it by the renderer on top of the screen texture.
+ * - CURSOR_HARDWARE turns it into an SDL cursor, which the operating system
+ *   moves independently of the game frame. */
+enum MouseCursorMode
+{
+	CURSOR_SOFTWARE,
+	CURSOR_GPU_LAYER,
+	CURSOR_HARDWARE
+};
+
+static MouseCursorMode gCursorMode = CURSOR_SOFTWARE;
+static SDL_Texture*    MouseCursorTexture;
+
+#define MAX_HARDWARE_CURSORS 32
+
+/* SDL cursors created from the MouseCursor surface, keyed by a hash of its
+ * contents, so animated and flashing cursors cycle through cached cursors
+ * instead of creating a new one every frame. */
+struct HardwareCursor
+{
+	UINT32      hash;
+	UINT32      last_used;
+	SDL_Cursor* cursor;
+};
+
+static HardwareCursor HardwareCursors[MAX_HARDWARE_CURSORS];
+static UINT32         guiHardwareCursorClock;
+static UINT32         guiCurrentHardwareCursorHash;
+static BOOLEAN        gfHardwareCursorShown;
 
 // Refresh thread based variables
 static UINT32 guiFrameBufferState;  // BUFFER_READY, BUFFER_DIRTY
@@ -78,9 +148,24 @@ static BOOLEAN  gfForceFullScreenRefresh;
 static SDL_Rect DirtyRegionsEx[MAX_DIRTY_REGIONS];
 static UINT32   guiDirtyRegionExCount;
 
+static DirtyRegionStats gDirtyRegionStats;
+
+// Parts of the ScreenBuffer which changed since the last texture upload
+static SDL_Rect TextureUpdateRects[MAX_TEXTURE_UPDATE_RECTS];
+static UINT32   guiTextureUpdateRectCount;
+static BOOLEAN  gfFullTextureUpdate;
+
 // Screen output stuff
 static BOOLEAN gfPrintFrameBuffer;
-static UINT32  guiPrintFrameBufferIndex;
+static BOOLEAN gfPresent = TRUE;
+static BOOLEAN gfFramePacing;
+static BOOLEAN gfVSync;
+static UINT32  guiPrintFrameBufferIndex; // only touched by the screenshot thread while it runs
+
+// The copy of the screen the screenshot thread is writing
+static UINT16*     g_screenshot;
+static SDL_Thread* g_screenshot_thread;
+static std::string g_screenshot_folder;
 
 
 static SDL_Surface* MouseCursor;
@@ -91,11 +176,14 @@ SDL_Window* g_game_window;
 static SDL_Surface* ScreenBuffer;
 static SDL_Texture* ScreenTexture;
 static SDL_Texture* ScaledScreenTexture;
+static int          g_scaled_screen_scale;  // of ScaledScreenTexture
+static BOOLEAN      g_scaled_screen_stale;  // ScaledScreenTexture is behind ScreenTexture
 static Uint32       g_window_flags = 0;
 static VideoScaleQuality ScaleQuality = VideoScaleQuality::LINEAR;
 
 static void RecreateBackBuffer();
 static void DeletePrimaryVideoSurfaces(void);
+static void FreeHardwareCursors();
 
 void VideoSetFullScreen(const BOOLEAN enable)
 {
@@ -130,7 +218,78 @@ void VideoSetBrightness(float brightness)
 static void GetRGBDistribution();
 
 
-void InitializeVideoManager(const VideoScaleQuality quality)
+// The nearest neighbour multiple for NEAR_PERFECT at the current window size
+static int NearPerfectScale()
+{
+	int w;
+	int h;
+	if (SDL_GetRendererOutputSize(GameRenderer, &w, &h) != 0) return NEAR_PERFECT_MAX_SCALE;
+	int const scale = std::max((w + SCREEN_WIDTH - 1) / SCREEN_WIDTH, (h + SCREEN_HEIGHT - 1) / SCREEN_HEIGHT);
+	return std::max(1, std::min(scale, NEAR_PERFECT_MAX_SCALE));
+}
+
+
+static void CreateScaledScreenTexture()
+{
+	if (ScaledScreenTexture) SDL_DestroyTexture(ScaledScreenTexture);
+
+	int const scale = NearPerfectScale();
+	SDL_SetHint(SDL_HINT_RENDER_SCALE_QUALITY, "linear");
+	ScaledScreenTexture = SDL_CreateTexture(GameRenderer,
+		SDL_PIXELFORMAT_RGB565,
+		SDL_TEXTUREACCESS_TARGET,
+		SCREEN_WIDTH * scale, SCREEN_HEIGHT * scale);
+
+	if (ScaledScreenTexture == NULL) {
+		SLOGE("SDL_CreateTexture for ScaledScreenTexture failed: %s\n", SDL_GetError());
+	}
+	g_scaled_screen_scale = scale;
+	g_scaled_screen_stale = TRUE;
+}
+
+
+/* (Re)creates the textures the screen is drawn with for ScaleQuality. The
+ * sampling of a texture is fixed when it is created. */
+static void CreateScreenTextures()
+{
+	if (ScreenTexture)       SDL_DestroyTexture(ScreenTexture);
+	if (ScaledScreenTexture) SDL_DestroyTexture(ScaledScreenTexture);
+	ScaledScreenTexture = NULL;
+
+#if SDL_VERSION_ATLEAST(2,0,5)
+	SDL_RenderSetIntegerScale(GameRenderer, SDL_FALSE);
+#endif
+	if (ScaleQuality == VideoScaleQuality::PERFECT) {
+		SDL_SetHint(SDL_HINT_RENDER_SCALE_QUALITY, "nearest");
+#if SDL_VERSION_ATLEAST(2,0,5)
+		SDL_RenderSetIntegerScale(GameRenderer, SDL_TRUE);
+#else
+		ScaleQuality = VideoScaleQuality::NEAR_PERFECT;
+#endif
+	}
+	else if (ScaleQuality == VideoScaleQuality::NEAR_PERFECT) {
+		SDL_SetHint(SDL_HINT_RENDER_SCALE_QUALITY, "nearest");
+	}
+	else {
+		SDL_SetHint(SDL_HINT_RENDER_SCALE_QUALITY, "linear");
+	}
+
+	ScreenTexture = SDL_CreateTexture(GameRenderer,
+					SDL_PIXELFORMAT_RGB565,
+					SDL_TEXTUREACCESS_STREAMING,
+					SCREEN_WIDTH, SCREEN_HEIGHT);
+
+	if (ScreenTexture == NULL) {
+		SLOGE("SDL_CreateTexture for ScreenTexture failed: %s\n", SDL_GetError());
+	}
+
+	if (ScaleQuality == VideoScaleQuality::NEAR_PERFECT) CreateScaledScreenTexture();
+
+	gfFullTextureUpdate = TRUE;
+}
+
+
+void InitializeVideoManager(const VideoScaleQuality quality, const BOOLEAN gpu_compositing, const BOOLEAN hardware_cursor, const BOOLEAN frame_pacing)
 {
 	SLOGD("Initializing the video manager");
 	SDL_SetHint(SDL_HINT_RENDER_DRIVER, "opengl");
@@ -144,9 +303,17 @@ void InitializeVideoManager(const VideoScaleQuality quality)
 					SCREEN_WIDTH, SCREEN_HEIGHT,
 					g_window_flags);
 
-	GameRenderer = SDL_CreateRenderer(g_game_window, -1, 0);
+	GameRenderer = SDL_CreateRenderer(g_game_window, -1, frame_pacing ? SDL_RENDERER_PRESENTVSYNC : 0);
 	SDL_RenderSetLogicalSize(GameRenderer, SCREEN_WIDTH, SCREEN_HEIGHT);
 
+	gfFramePacing = frame_pacing;
+	if (frame_pacing)
+	{
+		SDL_RendererInfo info;
+		gfVSync = SDL_GetRendererInfo(GameRenderer, &info) == 0 && info.flags & SDL_RENDERER_PRESENTVSYNC;
+		if (!gfVSync) SLOGW("Frame pacing without vsync, the renderer does not support it");
+	}
+
 	SDL_Surface* windowIcon = SDL_CreateRGBSurfaceFrom(
 			(void*)gWindowIconData.pixel_data,
 			gWindowIconData.width,
@@ -176,43 +343,7 @@ void InitializeVideoManager(const VideoScaleQuality quality)
 	}
 
 
-	if (ScaleQuality == VideoScaleQuality::PERFECT) {
-		SDL_SetHint(SDL_HINT_RENDER_SCALE_QUALITY, "nearest");
-#if SDL_VERSION_ATLEAST(2,0,5)
-		SDL_RenderSetIntegerScale(GameRenderer, SDL_TRUE);
-#else
-		ScaleQuality = VideoScaleQuality::NEAR_PERFECT;
-#endif
-	}
-	else if (ScaleQuality == VideoScaleQuality::NEAR_PERFECT) {
-		SDL_SetHint(SDL_HINT_RENDER_SCALE_QUALITY, "nearest");
-	}
-	else {
-		SDL_SetHint(SDL_HINT_RENDER_SCALE_QUALITY, "linear");
-	}
-
-	ScreenTexture = SDL_CreateTexture(GameRenderer,
-					SDL_PIXELFORMAT_RGB565,
-					SDL_TEXTUREACCESS_STREAMING,
-					SCREEN_WIDTH, SCREEN_HEIGHT);
-
-	if (ScreenTexture == NULL) {
-		SLOGE("SDL_CreateTexture for ScreenTexture failed: %s\n", SDL_GetError());
-	}
-
-	if (ScaleQuality == VideoScaleQuality::NEAR_PERFECT) {
-		int scale = 4;
-
-		SDL_SetHint(SDL_HINT_RENDER_SCALE_QUALITY, "linear");
-		ScaledScreenTexture = SDL_CreateTexture(GameRenderer,
-			SDL_PIXELFORMAT_RGB565,
-			SDL_TEXTUREACCESS_TARGET,
-			SCREEN_WIDTH * scale, SCREEN_HEIGHT * scale);
-
-		if (ScaledScreenTexture == NULL) {
-			SLOGE("SDL_CreateTexture for ScaledScreenTexture failed: %s\n", SDL_GetError());
-		}
-	}
+	CreateScreenTextures();
 
 	FrameBuffer = SDL_CreateRGBSurface(
 		SDL_SWSURFACE, SCREEN_WIDTH, SCREEN_HEIGHT, PIXEL_DEPTH,
@@ -235,13 +366,38 @@ void InitializeVideoManager(const VideoScaleQuality quality)
 		SLOGE("SDL_CreateRGBSurface for MouseCursor failed: %s\n", SDL_GetError());
 	}
 
+	gCursorMode = CURSOR_SOFTWARE;
+	if (hardware_cursor)
+	{
+		gCursorMode = CURSOR_HARDWARE;
+	}
+	else if (gpu_compositing)
+	{
+		MouseCursorTexture = SDL_CreateTexture(GameRenderer,
+			SDL_PIXELFORMAT_ARGB8888,
+			SDL_TEXTUREACCESS_STREAMING,
+			MAX_CURSOR_WIDTH, MAX_CURSOR_HEIGHT);
+		if (MouseCursorTexture == NULL)
+		{
+			SLOGW("SDL_CreateTexture for MouseCursorTexture failed, drawing the cursor in software: %s\n", SDL_GetError());
+		}
+		else
+		{
+			SDL_SetTextureBlendMode(MouseCursorTexture, SDL_BLENDMODE_BLEND);
+			gCursorMode = CURSOR_GPU_LAYER;
+		}
+	}
+
 	SDL_ShowCursor(SDL_DISABLE);
+	gfHardwareCursorShown        = FALSE;
+	guiCurrentHardwareCursorHash = 0;
 
 	// Initialize state variables
 	guiFrameBufferState      = BUFFER_DIRTY;
 	guiVideoManagerState     = VIDEO_ON;
 	guiDirtyRegionCount      = 0;
 	gfForceFullScreenRefresh = TRUE;
+	gfFullTextureUpdate      = TRUE;
 	gfPrintFrameBuffer       = FALSE;
 	guiPrintFrameBufferIndex = 0;
 
@@ -250,18 +406,36 @@ void InitializeVideoManager(const VideoScaleQuality quality)
 }
 
 
+static void StopVideoCapture();
+static void FinishScreenshot();
+
+
 void ShutdownVideoManager(void)
 {
 	SLOGD("Shutting down the video manager");
 	/* Toggle the state of the video manager to indicate to the refresh thread
 	 * that it needs to shut itself down */
 
+	StopVideoCapture();
+	FinishScreenshot();
+
+	FreeHardwareCursors();
+
 	SDL_QuitSubSystem(SDL_INIT_VIDEO);
 
 	guiVideoManagerState = VIDEO_OFF;
 
 	// ATE: Release mouse cursor!
 	FreeMouseCursor();
+
+	DirtyRegionStats const& d = gDirtyRegionStats;
+	SLOGD("Dirty regions: %u frames, %u full refreshes (%u on overflow), %u merges, %.1f rectangles and %.0f pixels per frame",
+		d.frames, d.full_refreshes, d.overflows, d.merges,
+		d.frames ? (double)d.regions / d.frames : 0.,
+		d.frames ? (double)d.area    / d.frames : 0.);
+
+	MouseCursorTexture = NULL;
+	gCursorMode        = CURSOR_SOFTWARE;
 }
 
 
@@ -270,41 +444,154 @@ void SuspendVideoManager(void)
 	guiVideoManagerState = VIDEO_SUSPENDED;
 }
 
-void InvalidateRegion(INT32 iLeft, INT32 iTop, INT32 iRight, INT32 iBottom)
+/* Rectangles on different sides of the bottom edge of the viewport are never
+ * merged, because RefreshScreen() treats the viewport differently from the
+ * rest of the screen while scrolling. */
+static int RegionSide(SDL_Rect const& r)
 {
-	if (gfForceFullScreenRefresh)
+	INT32 const edge = gsVIEWPORT_WINDOW_END_Y;
+	if (r.y + r.h <= edge) return 0;
+	if (r.y >= edge)       return 1;
+	return 2;
+}
+
+
+static bool RectContains(SDL_Rect const& outer, SDL_Rect const& inner)
+{
+	return
+		outer.x <= inner.x && inner.x + inner.w <= outer.x + outer.w &&
+		outer.y <= inner.y && inner.y + inner.h <= outer.y + outer.h;
+}
+
+
+/* Merge every pair of rectangles whose bounding box is not larger than the two
+ * rectangles together. This removes overlaps and contained rectangles and
+ * joins adjacent ones, so no pixel is copied twice. */
+static void CoalesceRects(SDL_Rect* const rects, UINT32& n, bool const keep_sides)
+{
+	BOOLEAN merged;
+	do
 	{
-		// There's no point in going on since we are forcing a full screen refresh
-		return;
+		merged = FALSE;
+		for (UINT32 i = 0; i < n; ++i)
+		{
+			for (UINT32 j = i + 1; j < n;)
+			{
+				SDL_Rect&       a = rects[i];
+				SDL_Rect const& b = rects[j];
+				SDL_Rect        u;
+				SDL_UnionRect(&a, &b, &u);
+				if (u.w * u.h <= a.w * a.h + b.w * b.h &&
+						(!keep_sides || RegionSide(a) == RegionSide(b)))
+				{
+					a = u;
+					rects[j] = rects[--n];
+					merged = TRUE;
+				}
+				else
+				{
+					++j;
+				}
+			}
+		}
 	}
+	while (merged);
+}
+
 
-	if (guiDirtyRegionCount < MAX_DIRTY_REGIONS)
+/* Merge the pair of rectangles on the same side of the viewport edge whose
+ * bounding box adds the fewest pixels. Returns false if there is no such
+ * pair. */
+static bool MergeCheapestRects(SDL_Rect* const rects, UINT32& n)
+{
+	UINT32 best_i    = 0;
+	UINT32 best_j    = 0;
+	INT32  best_cost = -1;
+	for (UINT32 i = 0; i < n; ++i)
 	{
-		// Well we haven't broken the MAX_DIRTY_REGIONS limit yet, so we register the new region
+		for (UINT32 j = i + 1; j < n; ++j)
+		{
+			SDL_Rect const& a = rects[i];
+			SDL_Rect const& b = rects[j];
+			if (RegionSide(a) != RegionSide(b)) continue;
+			SDL_Rect u;
+			SDL_UnionRect(&a, &b, &u);
+			INT32 const cost = u.w * u.h - a.w * a.h - b.w * b.h;
+			if (best_cost < 0 || cost < best_cost)
+			{
+				best_i    = i;
+				best_j    = j;
+				best_cost = cost;
+			}
+		}
+	}
+	if (best_cost < 0) return false;
 
-		// DO SOME PREMIMARY CHECKS FOR VALID RECTS
-		if (iLeft < 0) iLeft = 0;
-		if (iTop  < 0) iTop  = 0;
+	SDL_UnionRect(&rects[best_i], &rects[best_j], &rects[best_i]);
+	rects[best_j] = rects[--n];
+	return true;
+}
+
+
+/* Adds a rectangle to a dirty region list. Rectangles covered by another one
+ * are dropped, and a full list is shrunk by merging rectangles, so a busy
+ * screen stays on the incremental path. Returns false if the list cannot take
+ * the rectangle and the whole screen has to be refreshed. */
+static bool AddDirtyRegion(SDL_Rect* const regions, UINT32& n, INT32 iLeft, INT32 iTop, INT32 iRight, INT32 iBottom)
+{
+	// DO SOME PRELIMINARY CHECKS FOR VALID RECTS
+	if (iLeft < 0) iLeft = 0;
+	if (iTop  < 0) iTop  = 0;
 
-		if (iRight  > SCREEN_WIDTH)  iRight  = SCREEN_WIDTH;
-		if (iBottom > SCREEN_HEIGHT) iBottom = SCREEN_HEIGHT;
+	if (iRight  > SCREEN_WIDTH)  iRight  = SCREEN_WIDTH;
+	if (iBottom > SCREEN_HEIGHT) iBottom = SCREEN_HEIGHT;
 
-		if (iRight - iLeft <= 0) return;
-		if (iBottom - iTop <= 0) return;
+	if (iRight - iLeft <= 0) return true;
+	if (iBottom - iTop <= 0) return true;
 
-		DirtyRegions[guiDirtyRegionCount].x = iLeft;
-		DirtyRegions[guiDirtyRegionCount].y = iTop;
-		DirtyRegions[guiDirtyRegionCount].w = iRight  - iLeft;
-		DirtyRegions[guiDirtyRegionCount].h = iBottom - iTop;
-		guiDirtyRegionCount++;
+	SDL_Rect const r = { iLeft, iTop, iRight - iLeft, iBottom - iTop };
+	for (UINT32 i = 0; i < n;)
+	{
+		if (RectContains(regions[i], r)) return true;
+		if (RectContains(r, regions[i]))
+		{
+			regions[i] = regions[--n];
+			continue;
+		}
+		++i;
 	}
-	else
+
+	if (n == MAX_DIRTY_REGIONS)
 	{
-		// The MAX_DIRTY_REGIONS limit has been exceeded. Therefore we arbitrarely invalidate the entire
-		// screen and force a full screen refresh
-		guiDirtyRegionExCount = 0;
-		guiDirtyRegionCount = 0;
-		gfForceFullScreenRefresh = TRUE;
+		CoalesceRects(regions, n, true);
+		if (n == MAX_DIRTY_REGIONS && !MergeCheapestRects(regions, n)) return false;
+		++gDirtyRegionStats.merges;
+	}
+	regions[n++] = r;
+	return true;
+}
+
+
+static void ForceFullScreenRefresh()
+{
+	guiDirtyRegionExCount = 0;
+	guiDirtyRegionCount = 0;
+	gfForceFullScreenRefresh = TRUE;
+	++gDirtyRegionStats.overflows;
+}
+
+
+void InvalidateRegion(INT32 iLeft, INT32 iTop, INT32 iRight, INT32 iBottom)
+{
+	if (gfForceFullScreenRefresh)
+	{
+		// There's no point in going on since we are forcing a full screen refresh
+		return;
+	}
+
+	if (!AddDirtyRegion(DirtyRegions, guiDirtyRegionCount, iLeft, iTop, iRight, iBottom))
+	{
+		ForceFullScreenRefresh();
 	}
 }
 
@@ -332,29 +619,11 @@ void InvalidateRegionEx(INT32 iLeft, INT32 iTop, INT32 iRight, INT32 iBottom)
 
 static void AddRegionEx(INT32 iLeft, INT32 iTop, INT32 iRight, INT32 iBottom)
 {
-	if (guiDirtyRegionExCount < MAX_DIRTY_REGIONS)
-	{
-		// DO SOME PRELIMINARY CHECKS FOR VALID RECTS
-		if (iLeft < 0) iLeft = 0;
-		if (iTop  < 0) iTop  = 0;
+	if (gfForceFullScreenRefresh) return;
 
-		if (iRight  > SCREEN_WIDTH)  iRight  = SCREEN_WIDTH;
-		if (iBottom > SCREEN_HEIGHT) iBottom = SCREEN_HEIGHT;
-
-		if (iRight - iLeft <= 0) return;
-		if (iBottom - iTop <= 0) return;
-
-		DirtyRegionsEx[guiDirtyRegionExCount].x = iLeft;
-		DirtyRegionsEx[guiDirtyRegionExCount].y = iTop;
-		DirtyRegionsEx[guiDirtyRegionExCount].w = iRight  - iLeft;
-		DirtyRegionsEx[guiDirtyRegionExCount].h = iBottom - iTop;
-		guiDirtyRegionExCount++;
-	}
-	else
+	if (!AddDirtyRegion(DirtyRegionsEx, guiDirtyRegionExCount, iLeft, iTop, iRight, iBottom))
 	{
-		guiDirtyRegionExCount = 0;
-		guiDirtyRegionCount = 0;
-		gfForceFullScreenRefresh = TRUE;
+		ForceFullScreenRefresh();
 	}
 }
 
@@ -479,21 +748,14 @@ static void ScrollJA2Background(INT16 sScrollXIncrement, INT16 sScrollYIncrement
 	// BLIT NEW
 	ExecuteVideoOverlaysToAlternateBuffer(BACKBUFFER);
 
-	SDL_Texture* screenTexture = SDL_CreateTextureFromSurface(GameRenderer, ScreenBuffer);
-
-	SDL_Rect r;
-	r.x = gsVIEWPORT_START_X;
-	r.y = gsVIEWPORT_WINDOW_START_Y;
-	r.w = gsVIEWPORT_END_X - gsVIEWPORT_START_X;
-	r.h = gsVIEWPORT_WINDOW_END_Y - gsVIEWPORT_WINDOW_START_Y;
-	SDL_RenderCopy(GameRenderer, screenTexture, &r, &r);
-
+	/* The caller queues the viewport for the next texture upload, so it reaches
+	 * the screen together with the rest of the frame. */
 	SDL_FreeSurface(Source);
-	SDL_DestroyTexture(screenTexture);
 }
 
 
-static void WriteTGAHeader(FILE* const f)
+// 2 is an uncompressed, 10 a run-length encoded true colour image
+static void WriteTGAHeader(FILE* const f, UINT8 const type)
 {
 	/*
 	 *  0 byte ID length
@@ -509,11 +771,11 @@ static void WriteTGAHeader(FILE* const f)
 	 * 16 byte bits per pixel
 	 * 17 byte image descriptor
 	 */
-	static const BYTE data[] =
+	const BYTE data[] =
 	{
 		0,
 		0,
-		2,
+		type,
 		0, 0,
 		0, 0,
 		0,
@@ -528,14 +790,83 @@ static void WriteTGAHeader(FILE* const f)
 }
 
 
+/* Run-length encodes one row of 16 bit pixels as in a Targa file of type 10.
+ * Packets do not cross rows. Gives the end of the output, which needs room for
+ * n * 2 + (n + 127) / 128 bytes. */
+static BYTE* EncodeTGARLERow(UINT16 const* const src, UINT32 const n, BYTE* dst)
+{
+	UINT32 i = 0;
+	while (i < n)
+	{
+		UINT32 run = 1;
+		while (i + run < n && run < 128 && src[i + run] == src[i]) ++run;
+		if (run >= 2)
+		{
+			*dst++ = 0x80 | (run - 1);
+			memcpy(dst, &src[i], 2);
+			dst += 2;
+			i   += run;
+			continue;
+		}
+
+		// A raw packet ends where a run of at least two pixels starts
+		UINT32 raw = 1;
+		while (i + raw < n && raw < 128 && (i + raw + 1 == n || src[i + raw] != src[i + raw + 1])) ++raw;
+		*dst++ = raw - 1;
+		memcpy(dst, &src[i], raw * 2);
+		dst += raw * 2;
+		i   += raw;
+	}
+	return dst;
+}
+
+
+/* Writes a copy of the screen as a run-length encoded 16-bit (RGB 5,5,5) Targa
+ * file and closes it. The copy is converted in place, buf is scratch space. */
+static void WriteTGAFrame(FILE* const f, UINT16* const frame, std::vector<BYTE>& buf)
+{
+	if (gusRedMask != 0x7C00 || gusGreenMask != 0x03E0 || gusBlueMask != 0x001F)
+	{
+		ConvertRGBDistribution565To555(frame, SCREEN_WIDTH * SCREEN_HEIGHT);
+	}
+
+	buf.resize(SCREEN_HEIGHT * (SCREEN_WIDTH * 2 + (SCREEN_WIDTH + 127) / 128));
+	BYTE* end = buf.data();
+	for (INT32 y = SCREEN_HEIGHT - 1; y >= 0; --y)
+	{
+		end = EncodeTGARLERow(frame + y * SCREEN_WIDTH, SCREEN_WIDTH, end);
+	}
+
+	WriteTGAHeader(f, 10);
+	fwrite(buf.data(), end - buf.data(), 1, f);
+	fclose(f);
+}
+
+
+// Copies the screen buffer, which may have padded rows, to dst
+static void CopyScreen(UINT16* const dst)
+{
+	BYTE const*  src = static_cast<BYTE const*>(ScreenBuffer->pixels);
+	size_t const row = SCREEN_WIDTH * sizeof(*dst);
+	if (ScreenBuffer->pitch == (int)row)
+	{
+		memcpy(dst, src, row * SCREEN_HEIGHT);
+		return;
+	}
+	for (UINT32 y = 0; y != SCREEN_HEIGHT; ++y)
+	{
+		memcpy(dst + y * SCREEN_WIDTH, src + y * ScreenBuffer->pitch, row);
+	}
+}
+
+
 /* Create a file for a screenshot, which is guaranteed not to exist yet. */
 static FILE* CreateScreenshotFile(void)
 {
-	const std::string exec_dir = GCM->getScreenshotFolder();
 	do
 	{
 		char filename[2048];
-		sprintf(filename, "%s/SCREEN%03d.TGA", exec_dir.c_str(), guiPrintFrameBufferIndex++);
+		sprintf(filename, "%s/SCREEN%03d.TGA", g_screenshot_folder.c_str(), guiPrintFrameBufferIndex++);
 #ifndef _WIN32
 #	define O_BINARY 0
 #endif
@@ -552,43 +883,292 @@ static FILE* CreateScreenshotFile(void)
 }
 
 
-static void TakeScreenshot()
+static int ScreenshotThreadMain(void*)
 {
 	FILE* const f = CreateScreenshotFile();
-	if (!f) return;
+	if (f)
+	{
+		std::vector<BYTE> buf;
+		WriteTGAFrame(f, g_screenshot, buf);
+	}
+	else
+	{
+		SLOGW("Failed to create a screenshot file in %s", g_screenshot_folder.c_str());
+	}
+	return 0;
+}
 
-	WriteTGAHeader(f);
 
-	// If not 5/5/5, create buffer
-	UINT16* buf = 0;
-	if (gusRedMask != 0x7C00 || gusGreenMask != 0x03E0 || gusBlueMask != 0x001F)
+// Waits for the last screenshot to be written
+static void FinishScreenshot()
+{
+	if (!g_screenshot) return;
+	if (g_screenshot_thread)
 	{
-		buf = MALLOCN(UINT16, SCREEN_WIDTH);
+		SDL_WaitThread(g_screenshot_thread, 0);
+		g_screenshot_thread = 0;
 	}
+	MemFree(g_screenshot);
+	g_screenshot = 0;
+}
 
-	UINT16 const* src = static_cast<UINT16 const*>(ScreenBuffer->pixels);
-	for (INT32 y = SCREEN_HEIGHT - 1; y >= 0; --y)
+
+/* Copies the screen and leaves encoding and writing it to a thread of its own,
+ * so the frame does not wait for the disk. */
+static void TakeScreenshot()
+{
+	PROFILE_SCOPE(PROFILE_SCREEN_CAPTURE);
+	FinishScreenshot();
+
+	g_screenshot_folder = GCM->getScreenshotFolder();
+	g_screenshot        = MALLOCN(UINT16, SCREEN_WIDTH * SCREEN_HEIGHT);
+	CopyScreen(g_screenshot);
+
+	g_screenshot_thread = SDL_CreateThread(ScreenshotThreadMain, "screenshot", 0);
+	if (!g_screenshot_thread)
 	{
-		if (buf)
-		{ // ATE: Fix this such that it converts pixel format to 5/5/5
-			memcpy(buf, src + y * SCREEN_WIDTH, SCREEN_WIDTH * sizeof(*buf));
-			ConvertRGBDistribution565To555(buf, SCREEN_WIDTH);
-			fwrite(buf, sizeof(*buf), SCREEN_WIDTH, f);
+		SLOGW("Failed to create the screenshot thread, writing directly: %s", SDL_GetError());
+		ScreenshotThreadMain(0);
+	}
+}
+
+static void CaptureFrame();
+
+
+static void AddTextureUpdateRect(SDL_Rect const& r)
+{
+	if (gfFullTextureUpdate) return;
+	if (r.w <= 0 || r.h <= 0) return;
+
+	if (guiTextureUpdateRectCount == MAX_TEXTURE_UPDATE_RECTS)
+	{
+		gfFullTextureUpdate = TRUE;
+		return;
+	}
+	TextureUpdateRects[guiTextureUpdateRectCount++] = r;
+}
+
+
+// Whether anything was uploaded
+static bool UpdateScreenTexture()
+{
+	if (!gfFullTextureUpdate)
+	{
+		CoalesceRects(TextureUpdateRects, guiTextureUpdateRectCount, false);
+
+		UINT32 area = 0;
+		for (UINT32 i = 0; i < guiTextureUpdateRectCount; ++i)
+		{
+			area += TextureUpdateRects[i].w * TextureUpdateRects[i].h;
 		}
-		else
+		if (area * 100 > SCREEN_WIDTH * SCREEN_HEIGHT * PARTIAL_TEXTURE_UPDATE_MAX_PERCENT)
 		{
-			fwrite(src + y * SCREEN_WIDTH, SCREEN_WIDTH * 2, 1, f);
+			gfFullTextureUpdate = TRUE;
 		}
 	}
 
-	if (buf) MemFree(buf);
+	if (gfFullTextureUpdate)
+	{
+		SDL_UpdateTexture(ScreenTexture, NULL, ScreenBuffer->pixels, ScreenBuffer->pitch);
+	}
+	else
+	{
+		UINT8 const* const pixels = static_cast<UINT8 const*>(ScreenBuffer->pixels);
+		INT32        const pitch  = ScreenBuffer->pitch;
+		INT32        const bpp    = ScreenBuffer->format->BytesPerPixel;
+		for (UINT32 i = 0; i < guiTextureUpdateRectCount; ++i)
+		{
+			SDL_Rect const& r = TextureUpdateRects[i];
+			SDL_UpdateTexture(ScreenTexture, &r, pixels + r.y * pitch + r.x * bpp, pitch);
+		}
+	}
 
-	fclose(f);
+	bool const updated = gfFullTextureUpdate || guiTextureUpdateRectCount != 0;
+	gfFullTextureUpdate       = FALSE;
+	guiTextureUpdateRectCount = 0;
+	return updated;
 }
 
-static void SnapshotSmall(void);
 
-void RefreshScreen(void)
+/* Converts the top left w x h pixels of the MouseCursor surface to ARGB8888.
+ * Colour 0 is the transparent colour key. */
+static void ConvertMouseCursor(void* const pixels, int const pitch, UINT32 const w, UINT32 const h)
+{
+	UINT16 const* src = static_cast<UINT16 const*>(MouseCursor->pixels);
+	UINT8*        dst = static_cast<UINT8*>(pixels);
+	for (UINT32 y = 0; y != h; ++y)
+	{
+		UINT32* const d = reinterpret_cast<UINT32*>(dst);
+		for (UINT32 x = 0; x != w; ++x)
+		{
+			UINT32 const p = src[x];
+			if (p == 0)
+			{
+				d[x] = 0;
+				continue;
+			}
+			UINT32 const r8 = (p >> 11 & 0x1F) * 255 / 31;
+			UINT32 const g8 = (p >>  5 & 0x3F) * 255 / 63;
+			UINT32 const b8 = (p       & 0x1F) * 255 / 31;
+			d[x] = 0xFF000000 | r8 << 16 | g8 << 8 | b8;
+		}
+		src  = reinterpret_cast<UINT16 const*>(reinterpret_cast<UINT8 const*>(src) + MouseCursor->pitch);
+		dst += pitch;
+	}
+}
+
+
+/* Copies the used part of the software cursor into the cursor texture. The
+ * cursor surface is redrawn in place, e.g. for the AP text on the cursor, so
+ * this is done every frame. It is at most MAX_CURSOR_WIDTH x MAX_CURSOR_HEIGHT
+ * pixels. */
+static void UpdateMouseCursorTexture()
+{
+	UINT32 const w = gusMouseCursorWidth;
+	UINT32 const h = gusMouseCursorHeight;
+	if (w == 0 || h == 0) return;
+
+	SDL_Rect const r = { 0, 0, (int)w, (int)h };
+	void* pixels;
+	int   pitch;
+	if (SDL_LockTexture(MouseCursorTexture, &r, &pixels, &pitch) != 0) return;
+	ConvertMouseCursor(pixels, pitch, w, h);
+	SDL_UnlockTexture(MouseCursorTexture);
+}
+
+
+/* Creates an SDL cursor from the used part of the MouseCursor surface, scaled
+ * like the game screen, because the operating system draws it at window
+ * resolution. */
+static SDL_Cursor* CreateHardwareCursor(UINT32 const w, UINT32 const h, float const scale)
+{
+	SDL_Surface* const argb = SDL_CreateRGBSurface(0, w, h, 32, 0x00FF0000, 0x0000FF00, 0x000000FF, 0xFF000000);
+	if (!argb) return NULL;
+	ConvertMouseCursor(argb->pixels, argb->pitch, w, h);
+
+	SDL_Surface* image = argb;
+	int const sw = (int)(w * scale + .5f);
+	int const sh = (int)(h * scale + .5f);
+	if ((sw != (int)w || sh != (int)h) && sw > 0 && sh > 0)
+	{
+		SDL_Surface* const scaled = SDL_CreateRGBSurface(0, sw, sh, 32, 0x00FF0000, 0x0000FF00, 0x000000FF, 0xFF000000);
+		if (scaled)
+		{
+			SDL_SetSurfaceBlendMode(argb, SDL_BLENDMODE_NONE);
+			SDL_BlitScaled(argb, NULL, scaled, NULL);
+			image = scaled;
+		}
+	}
+
+	int const hot_x = __max(0, __min((int)(gsMouseCursorXOffset * scale), image->w - 1));
+	int const hot_y = __max(0, __min((int)(gsMouseCursorYOffset * scale), image->h - 1));
+	SDL_Cursor* const cursor = SDL_CreateColorCursor(image, hot_x, hot_y);
+	if (!cursor) SLOGW("SDL_CreateColorCursor failed: %s\n", SDL_GetError());
+
+	if (image != argb) SDL_FreeSurface(image);
+	SDL_FreeSurface(argb);
+	return cursor;
+}
+
+
+/* Hands the current cursor to the operating system. The MouseCursor surface
+ * is hashed every frame, because it is redrawn in place, and a cached SDL
+ * cursor is only created for contents not seen before. */
+static void UpdateHardwareCursor()
+{
+	UINT32 const w = gusMouseCursorWidth;
+	UINT32 const h = gusMouseCursorHeight;
+	if (w == 0 || h == 0)
+	{
+		if (gfHardwareCursorShown)
+		{
+			SDL_ShowCursor(SDL_DISABLE);
+			gfHardwareCursorShown = FALSE;
+		}
+		return;
+	}
+
+	float scale_x;
+	float scale_y;
+	SDL_RenderGetScale(GameRenderer, &scale_x, &scale_y);
+	float const scale = __min(scale_x, scale_y);
+
+	// FNV-1a over the pixels, the dimensions, the hot spot and the scale
+	UINT32 hash = 2166136261U;
+#define HASH(v) (hash = (hash ^ (UINT32)(v)) * 16777619U)
+	HASH(w);
+	HASH(h);
+	HASH((UINT16)gsMouseCursorXOffset);
+	HASH((UINT16)gsMouseCursorYOffset);
+	HASH(scale * 256);
+	UINT8 const* row = static_cast<UINT8 const*>(MouseCursor->pixels);
+	for (UINT32 y = 0; y != h; ++y, row += MouseCursor->pitch)
+	{
+		UINT16 const* const px = reinterpret_cast<UINT16 const*>(row);
+		for (UINT32 x = 0; x != w; ++x) HASH(px[x]);
+	}
+#undef HASH
+	if (hash == 0) hash = 1; // 0 marks a free cache slot
+
+	if (hash != guiCurrentHardwareCursorHash)
+	{
+		HardwareCursor* slot = NULL;
+		for (HardwareCursor* i = HardwareCursors; i != endof(HardwareCursors); ++i)
+		{
+			if (i->hash == hash)
+			{
+				slot = i;
+				break;
+			}
+			if (!slot || i->last_used < slot->last_used) slot = i;
+		}
+
+		if (slot->hash != hash)
+		{
+			SDL_Cursor* const cursor = CreateHardwareCursor(w, h, scale);
+			if (!cursor) return;
+			// The least recently used slot is never the current cursor
+			if (slot->cursor) SDL_FreeCursor(slot->cursor);
+			slot->hash   = hash;
+			slot->cursor = cursor;
+		}
+
+		SDL_SetCursor(slot->cursor);
+		slot->last_used = ++guiHardwareCursorClock;
+		guiCurrentHardwareCursorHash = hash;
+	}
+
+	if (!gfHardwareCursorShown)
+	{
+		SDL_ShowCursor(SDL_ENABLE);
+		gfHardwareCursorShown = TRUE;
+	}
+}
+
+
+static void FreeHardwareCursors()
+{
+	for (HardwareCursor* i = HardwareCursors; i != endof(HardwareCursors); ++i)
+	{
+		if (i->cursor) SDL_FreeCursor(i->cursor);
+		i->hash      = 0;
+		i->last_used = 0;
+		i->cursor    = NULL;
+	}
+	guiCurrentHardwareCursorHash = 0;
+}
+
+
+static void RestoreMouseBackground()
+{
+	if (!gfMouseCursorDrawn) return;
+	SDL_BlitSurface(FrameBuffer, &MouseBackground, ScreenBuffer, &MouseBackground);
+	AddTextureUpdateRect(MouseBackground);
+	gfMouseCursorDrawn = FALSE;
+}
+
+
+void UpdateScreen(void)
 {
 	if (guiVideoManagerState != VIDEO_ON) return;
 
@@ -611,7 +1191,7 @@ void RefreshScreen(void)
 	}
 #endif
 
-	SDL_BlitSurface(FrameBuffer, &MouseBackground, ScreenBuffer, &MouseBackground);
+	RestoreMouseBackground();
 
 	const BOOLEAN scrolling = (gsScrollXIncrement != 0 || gsScrollYIncrement != 0);
 
@@ -620,18 +1200,42 @@ void RefreshScreen(void)
 		if (gfFadeInitialized && gfFadeInVideo)
 		{
 			gFadeFunction();
+			gfFullTextureUpdate = TRUE;
 		}
 		else
 		{
-			if (gfForceFullScreenRefresh)
+			UINT32 area = 0;
+			for (UINT32 i = 0; i < guiDirtyRegionCount;   i++) area += DirtyRegions[i].w   * DirtyRegions[i].h;
+			for (UINT32 i = 0; i < guiDirtyRegionExCount; i++) area += DirtyRegionsEx[i].w * DirtyRegionsEx[i].h;
+			/* Copying most of the screen by rectangles is no cheaper than copying all
+			 * of it. While scrolling the regions in the viewport are skipped below, so
+			 * the rectangles are kept then. */
+			BOOLEAN const full =
+				gfForceFullScreenRefresh ||
+				(!scrolling && area * 100 > (UINT32)(SCREEN_WIDTH * SCREEN_HEIGHT) * DIRTY_REGIONS_MAX_PERCENT);
+
+			++gDirtyRegionStats.frames;
+			if (full)
 			{
+				++gDirtyRegionStats.full_refreshes;
+				gDirtyRegionStats.area += SCREEN_WIDTH * SCREEN_HEIGHT;
+				ProfilerCount(PROFILE_DIRTY_AREA, SCREEN_WIDTH * SCREEN_HEIGHT);
+				ProfilerCount(PROFILE_FULL_REFRESHES, 1);
+
 				SDL_BlitSurface(FrameBuffer, NULL, ScreenBuffer, NULL);
+				gfFullTextureUpdate = TRUE;
 			}
 			else
 			{
+				gDirtyRegionStats.regions += guiDirtyRegionCount + guiDirtyRegionExCount;
+				gDirtyRegionStats.area    += area;
+				ProfilerCount(PROFILE_DIRTY_REGIONS, guiDirtyRegionCount + guiDirtyRegionExCount);
+				ProfilerCount(PROFILE_DIRTY_AREA, area);
+
 				for (UINT32 i = 0; i < guiDirtyRegionCount; i++)
 				{
 					SDL_BlitSurface(FrameBuffer, &DirtyRegions[i], ScreenBuffer, &DirtyRegions[i]);
+					AddTextureUpdateRect(DirtyRegions[i]);
 				}
 
 				for (UINT32 i = 0; i < guiDirtyRegionExCount; i++)
@@ -646,12 +1250,20 @@ void RefreshScreen(void)
 						}
 					}
 					SDL_BlitSurface(FrameBuffer, r, ScreenBuffer, r);
+					AddTextureUpdateRect(*r);
 				}
 			}
 		}
 		if (scrolling)
 		{
 			ScrollJA2Background(gsScrollXIncrement, gsScrollYIncrement);
+
+			SDL_Rect viewport;
+			viewport.x = gsVIEWPORT_START_X;
+			viewport.y = gsVIEWPORT_WINDOW_START_Y;
+			viewport.w = gsVIEWPORT_END_X - gsVIEWPORT_START_X;
+			viewport.h = gsVIEWPORT_WINDOW_END_Y - gsVIEWPORT_WINDOW_START_Y;
+			AddTextureUpdateRect(viewport);
 			gsScrollXIncrement = 0;
 			gsScrollYIncrement = 0;
 		}
@@ -664,7 +1276,7 @@ void RefreshScreen(void)
 		UINT32 uiTime = GetClock();
 		if (uiTime < guiLastFrame || uiTime > guiLastFrame + guiFramePeriod)
 		{
-			SnapshotSmall();
+			CaptureFrame();
 			guiLastFrame = uiTime;
 		}
 	}
@@ -675,6 +1287,26 @@ void RefreshScreen(void)
 		gfPrintFrameBuffer = FALSE;
 	}
 
+	gfForceFullScreenRefresh = FALSE;
+	guiDirtyRegionCount      = 0;
+	guiDirtyRegionExCount    = 0;
+}
+
+
+void PresentScreen(void)
+{
+	if (guiVideoManagerState != VIDEO_ON) return;
+
+	if (!gfPresent)
+	{
+		gfFullTextureUpdate       = FALSE;
+		guiTextureUpdateRectCount = 0;
+		return;
+	}
+
+	// The cursor may have moved since the last present of the same frame
+	RestoreMouseBackground();
+
 	SGPPoint MousePos;
 	GetMousePos(&MousePos);
 	SDL_Rect src;
@@ -685,29 +1317,144 @@ void RefreshScreen(void)
 	SDL_Rect dst;
 	dst.x = MousePos.iX - gsMouseCursorXOffset;
 	dst.y = MousePos.iY - gsMouseCursorYOffset;
-	SDL_BlitSurface(MouseCursor, &src, ScreenBuffer, &dst);
-	MouseBackground = dst;
+	switch (gCursorMode)
+	{
+		case CURSOR_SOFTWARE:
+			SDL_BlitSurface(MouseCursor, &src, ScreenBuffer, &dst);
+			MouseBackground    = dst;
+			gfMouseCursorDrawn = TRUE;
+			AddTextureUpdateRect(MouseBackground);
+			break;
+
+		case CURSOR_GPU_LAYER:
+			UpdateMouseCursorTexture();
+			dst.w = src.w;
+			dst.h = src.h;
+			break;
+
+		case CURSOR_HARDWARE:
+			UpdateHardwareCursor();
+			break;
+	}
 
-	SDL_UpdateTexture(ScreenTexture, NULL, ScreenBuffer->pixels, ScreenBuffer->pitch);
+	if (UpdateScreenTexture()) g_scaled_screen_stale = TRUE;
 
 	SDL_RenderClear(GameRenderer);
 
 	if (ScaleQuality == VideoScaleQuality::NEAR_PERFECT) {
-		SDL_SetRenderTarget(GameRenderer, ScaledScreenTexture);
-		SDL_RenderCopy(GameRenderer, ScreenTexture, nullptr, nullptr);
+		if (NearPerfectScale() != g_scaled_screen_scale) CreateScaledScreenTexture();
+
+		/* The nearest neighbour pass only has to be redone when the screen
+		 * changed, which most frames it does not, at least not in the menus. */
+		if (g_scaled_screen_stale)
+		{
+			SDL_SetRenderTarget(GameRenderer, ScaledScreenTexture);
+			SDL_RenderCopy(GameRenderer, ScreenTexture, nullptr, nullptr);
+			SDL_SetRenderTarget(GameRenderer, nullptr);
+			g_scaled_screen_stale = FALSE;
+		}
 
-		SDL_SetRenderTarget(GameRenderer, nullptr);
 		SDL_RenderCopy(GameRenderer, ScaledScreenTexture, nullptr, nullptr);
 	}
 	else {
 		SDL_RenderCopy(GameRenderer, ScreenTexture, NULL, NULL);
 	}
 
+	if (gCursorMode == CURSOR_GPU_LAYER && src.w != 0 && src.h != 0)
+	{
+		SDL_RenderCopy(GameRenderer, MouseCursorTexture, &src, &dst);
+	}
+
+	DrawProfilerOverlay(GameRenderer);
+
 	SDL_RenderPresent(GameRenderer);
+	ProfilerPresent();
+}
 
-	gfForceFullScreenRefresh = FALSE;
-	guiDirtyRegionCount = 0;
-	guiDirtyRegionExCount = 0;
+
+void RefreshScreen(void)
+{
+	UpdateScreen();
+	PresentScreen();
+}
+
+
+BOOLEAN VideoFramePacing(void)
+{
+	return gfFramePacing;
+}
+
+
+BOOLEAN VideoHasVSync(void)
+{
+	return gfVSync;
+}
+
+
+void VideoSetPresent(BOOLEAN const present)
+{
+	gfPresent = present;
+}
+
+
+struct ScalingBenchResult
+{
+	UINT32 frames;
+	double ms;
+};
+
+
+static void WriteScalingResult(FILE* const f, char const* const quality, char const* const kind, ScalingBenchResult const& r)
+{
+	if (r.frames == 0) return;
+	SLOGI("Scaling benchmark, %s, %s frames: %u frames, %.3f ms per present", quality, kind, r.frames, r.ms / r.frames);
+	if (f) fprintf(f, "%s,%s,%u,%.3f\n", quality, kind, r.frames, r.ms / r.frames);
+	RecordBenchmarkResult(std::string("scaling.") + quality + "." + kind + "_present_ms", r.ms / r.frames);
+}
+
+
+// Presents the screen frames times, uploading all of it every frame if full
+static ScalingBenchResult BenchmarkPresents(UINT32 const frames, bool const full)
+{
+	ScalingBenchResult r = ScalingBenchResult();
+	for (UINT32 i = 0; i != frames; ++i)
+	{
+		if (full) gfFullTextureUpdate = TRUE;
+		uint64_t const start = SDL_GetPerformanceCounter();
+		PresentScreen();
+		r.ms += MSSince(start);
+		++r.frames;
+	}
+	return r;
+}
+
+
+void BenchmarkScreenScaling(UINT32 const frames)
+{
+	static struct { VideoScaleQuality quality; char const* name; } const qualities[] =
+	{
+		{ VideoScaleQuality::LINEAR,       "LINEAR"       },
+		{ VideoScaleQuality::NEAR_PERFECT, "NEAR_PERFECT" },
+		{ VideoScaleQuality::PERFECT,      "PERFECT"      }
+	};
+
+	std::string const path = GCM->getScreenshotFolder() + "/scalingbench.csv";
+	FILE* const f = fopen(path.c_str(), "w");
+	if (!f) SLOGW("Failed to write the scaling benchmark %s", path.c_str());
+	if (f) fputs("quality,kind,frames,present_ms\n", f);
+
+	VideoScaleQuality const configured = ScaleQuality;
+	for (size_t i = 0; i != lengthof(qualities); ++i)
+	{
+		ScaleQuality = qualities[i].quality;
+		CreateScreenTextures();
+		WriteScalingResult(f, qualities[i].name, "full",      BenchmarkPresents(frames, true));
+		WriteScalingResult(f, qualities[i].name, "unchanged", BenchmarkPresents(frames, false));
+	}
+	if (f) fclose(f);
+
+	ScaleQuality = configured;
+	CreateScreenTextures();
 }
 
 
@@ -749,6 +1496,12 @@ void SetMouseCursorProperties(INT16 sOffsetX, INT16 sOffsetY, UINT16 usCursorHei
 }
 
 
+DirtyRegionStats const& GetDirtyRegionStats()
+{
+	return gDirtyRegionStats;
+}
+
+
 void EndFrameBufferRender(void)
 {
 	guiFrameBufferState = BUFFER_DIRTY;
@@ -761,74 +1514,110 @@ void PrintScreen(void)
 }
 
 
-/*******************************************************************************
- * SnapshotSmall
- *
- * Grabs a screen from the primary surface, and stuffs it into a 16-bit
- * (RGB 5,5,5), uncompressed Targa file. Each time the routine is called, it
- * increments the file number by one. The files are create in the current
- * directory, usually the EXE directory. This routine produces 1/4 sized images.
- *
- ******************************************************************************/
-
-
-static void RefreshMovieCache(void);
-
-
-static void SnapshotSmall(void)
+static int CaptureThreadMain(void*)
 {
-	// Get the write pointer
-	const UINT16* pVideo = (UINT16*)ScreenBuffer->pixels;
-
-	UINT16* pDest = gpFrameData[giNumFrames];
-
-	for (INT32 iCountY = SCREEN_HEIGHT - 1; iCountY >= 0; iCountY--)
+	std::vector<BYTE> buf;
+	for (;;)
 	{
-		for (INT32 iCountX = 0; iCountX < SCREEN_WIDTH; iCountX++)
+		SDL_SemWait(g_capture_ready);
+		UINT32 const tail = g_capture_tail.load(std::memory_order_relaxed);
+		if (tail == g_capture_head.load(std::memory_order_acquire))
+		{
+			if (g_capture_quit.load()) break;
+			continue;
+		}
+		char filename[2048];
+		snprintf(filename, sizeof(filename), "%s/JA%5.5u.TGA", g_capture_folder.c_str(), g_capture_file_no++);
+		FILE* const f = fopen(filename, "wb");
+		if (f)
 		{
-			pDest[iCountY * SCREEN_WIDTH + iCountX] = pVideo[iCountY * SCREEN_WIDTH + iCountX];
+			WriteTGAFrame(f, g_capture_frames[tail % CAPTURE_RING_FRAMES], buf);
 		}
+		else
+		{
+			SLOGW("Failed to write the captured frame %s", filename);
+		}
+		g_capture_tail.store(tail + 1, std::memory_order_release);
 	}
-
-	giNumFrames++;
-
-	if (giNumFrames == MAX_NUM_FRAMES) RefreshMovieCache();
+	return 0;
 }
 
-static void RefreshMovieCache(void)
-{
-	static UINT32 uiPicNum = 0;
-
-	PauseTime(TRUE);
-
-	const std::string exec_dir = GCM->getVideoCaptureFolder();
 
-	for (INT32 cnt = 0; cnt < giNumFrames; cnt++)
+static void StartVideoCapture()
+{
+	g_capture_folder = GCM->getVideoCaptureFolder();
+	for (UINT32 i = 0; i != CAPTURE_RING_FRAMES; ++i)
 	{
-		CHAR8 cFilename[2048];
-		sprintf(cFilename, "%s/JA%5.5d.TGA", exec_dir.c_str(), uiPicNum++);
+		g_capture_frames[i] = MALLOCN(UINT16, SCREEN_WIDTH * SCREEN_HEIGHT);
+	}
+	g_capture_head.store(0);
+	g_capture_tail.store(0);
+	g_capture_quit.store(false);
+	g_capture_dropped = 0;
+
+	g_capture_ready  = SDL_CreateSemaphore(0);
+	g_capture_thread = g_capture_ready ? SDL_CreateThread(CaptureThreadMain, "capture", 0) : 0;
+	if (!g_capture_thread)
+	{
+		SLOGW("Failed to start the video capture: %s", SDL_GetError());
+		if (g_capture_ready) SDL_DestroySemaphore(g_capture_ready);
+		g_capture_ready = 0;
+		for (UINT32 i = 0; i != CAPTURE_RING_FRAMES; ++i) MemFree(g_capture_frames[i]);
+		return;
+	}
 
-		FILE* disk = fopen(cFilename, "wb");
-		if (disk == NULL) return;
+	gfVideoCapture = TRUE;
+	guiLastFrame   = GetClock();
+	SLOGI("Capturing video to %s", g_capture_folder.c_str());
+}
 
-		WriteTGAHeader(disk);
 
-		UINT16* pDest = gpFrameData[cnt];
+// Waits for the frames still queued to be written
+static void StopVideoCapture()
+{
+	if (!gfVideoCapture) return;
+	gfVideoCapture = FALSE;
+
+	g_capture_quit.store(true);
+	SDL_SemPost(g_capture_ready);
+	SDL_WaitThread(g_capture_thread, 0);
+	g_capture_thread = 0;
+	SDL_DestroySemaphore(g_capture_ready);
+	g_capture_ready = 0;
+	for (UINT32 i = 0; i != CAPTURE_RING_FRAMES; ++i) MemFree(g_capture_frames[i]);
+
+	SLOGI("Stopped capturing video, %u frames were dropped because writing fell behind", g_capture_dropped);
+}
 
-		for (INT32 iCountY = SCREEN_HEIGHT - 1; iCountY >= 0; iCountY -= 1)
-		{
-			for (INT32 iCountX = 0; iCountX < SCREEN_WIDTH; iCountX ++)
-			{
-				fwrite(pDest + iCountY * SCREEN_WIDTH + iCountX, sizeof(UINT16), 1, disk);
-			}
-		}
 
-		fclose(disk);
+void VideoToggleCapture(void)
+{
+	if (gfVideoCapture)
+	{
+		StopVideoCapture();
+	}
+	else
+	{
+		StartVideoCapture();
 	}
+}
+
 
-	PauseTime(FALSE);
+/* Copies the screen into the capture ring for the capture thread to write out.
+ * If the ring is full the frame is dropped. */
+static void CaptureFrame()
+{
+	PROFILE_SCOPE(PROFILE_SCREEN_CAPTURE);
+	UINT32 const head = g_capture_head.load(std::memory_order_relaxed);
+	if (head - g_capture_tail.load(std::memory_order_acquire) == CAPTURE_RING_FRAMES)
+	{
+		++g_capture_dropped;
+		return;
+	}
 
-	giNumFrames = 0;
+	CopyScreen(g_capture_frames[head % CAPTURE_RING_FRAMES]);
+	g_capture_head.store(head + 1, std::memory_order_release);
+	SDL_SemPost(g_capture_ready);
 }
 
 
@@ -14,7 +14,14 @@ extern SDL_Window* g_game_window;
 using VideoScaleQuality = ScalingQuality;
 
 void         VideoSetFullScreen(BOOLEAN enable);
-void         InitializeVideoManager(VideoScaleQuality quality);
+/* With gpu_compositing the mouse cursor is drawn as its own layer by the
+ * renderer instead of being blitted into the screen buffer. Everything else,
+ * tiles, soldiers and interface, is still blitted on the CPU and reaches the
+ * renderer as the one streamed screen texture. With
+ * hardware_cursor it is handed to the operating system as a native cursor,
+ * which takes precedence. With frame_pacing the renderer presents in step
+ * with the display's refresh, if it can, see VideoFramePacing(). */
+void         InitializeVideoManager(VideoScaleQuality quality, BOOLEAN gpu_compositing, BOOLEAN hardware_cursor, BOOLEAN frame_pacing);
 void         ShutdownVideoManager(void);
 void         SuspendVideoManager(void);
 void         InvalidateRegion(INT32 iLeft, INT32 iTop, INT32 iRight, INT32 iBottom);
@@ -23,6 +30,12 @@ void         GetPrimaryRGBDistributionMasks(UINT32* RedBitMask, UINT32* GreenBit
 void         EndFrameBufferRender(void);
 void         PrintScreen(void);
 
+/* Starts or stops writing the screen to the video capture folder 15 times a
+ * second, as numbered run-length encoded Targa files. The frames are copied
+ * into a ring and written by a thread of their own, so the game does not
+ * pause; when writing falls behind, frames are dropped and counted. */
+void         VideoToggleCapture(void);
+
 void VideoSetBrightness(float brightness);
 
 /* Toggle between fullscreen and window mode after initialising the video
@@ -33,8 +46,44 @@ void SetMouseCursorProperties(INT16 sOffsetX, INT16 sOffsetY, UINT16 usCursorHei
 
 void InvalidateRegionEx(INT32 iLeft, INT32 iTop, INT32 iRight, INT32 iBottom);
 
+/* Totals of the dirty region handling since the video manager started. */
+struct DirtyRegionStats
+{
+	UINT32   frames;         // frames with a dirty frame buffer
+	UINT32   full_refreshes; // frames which copied the whole frame buffer
+	UINT32   overflows;      // full refreshes forced by a region list that could not be shrunk
+	UINT32   merges;         // times a full region list was shrunk by merging rectangles
+	uint64_t regions;        // rectangles copied in frames without a full refresh
+	uint64_t area;           // pixels copied
+};
+
+DirtyRegionStats const& GetDirtyRegionStats();
+
+/* Brings the screen buffer up to date with the frame buffer and presents it. */
 void RefreshScreen(void);
 
+/* The two halves of RefreshScreen(). With frame pacing the game loop only
+ * updates the screen and the main loop presents it, once per refresh of the
+ * display, with the mouse cursor where it is at the time. */
+void UpdateScreen(void);
+void PresentScreen(void);
+
+BOOLEAN VideoFramePacing(void);
+/* Whether PresentScreen() waits for the display's refresh. */
+BOOLEAN VideoHasVSync(void);
+
+/* With present off RefreshScreen() still brings the screen buffer up to date,
+ * but nothing is shown in the window. */
+void VideoSetPresent(BOOLEAN present);
+
+/* Presents the current screen frames times with each scaling quality, once
+ * uploading the whole screen every frame and once with nothing changed, and
+ * logs the time per present and writes it to scalingbench.csv in the
+ * screenshot folder. With vsync the times include waiting for the display.
+ * The configured scaling quality is restored afterwards. Part of
+ * RunBenchmarkSuite(). */
+void BenchmarkScreenScaling(UINT32 frames);
+
 // Creates a list to contain video Surfaces
 void InitializeVideoSurfaceManager(void);
 
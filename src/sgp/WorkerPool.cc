@@ -0,0 +1,148 @@
+#include "Debug.h"
+#include "WorkerPool.h"
+
+#include <SDL.h>
+
+
+#define MAX_WORKERS 15
+
+
+static SDL_mutex*   g_lock;
+static SDL_cond*    g_work;       // signalled when a new batch of jobs is ready
+static SDL_cond*    g_done;       // signalled when the last worker is finished with a batch
+static SDL_Thread*  g_threads[MAX_WORKERS];
+static UINT         g_n_threads;
+static UINT         g_generation; // counts the batches, so every worker runs each one once
+static UINT         g_busy;       // workers not finished with the current batch
+static bool         g_quit;
+
+static void       (*g_job)(UINT, void*);
+static void*        g_ctx;
+static UINT         g_n_jobs;
+static SDL_atomic_t g_next_job;
+
+// Set on the worker threads, and on the calling thread while it runs jobs
+static thread_local bool g_in_job;
+
+
+static void RunJobs()
+{
+	for (;;)
+	{
+		UINT const i = SDL_AtomicAdd(&g_next_job, 1);
+		if (i >= g_n_jobs) break;
+		g_job(i, g_ctx);
+	}
+}
+
+
+static int WorkerMain(void*)
+{
+	g_in_job = true;
+
+	UINT seen = 0;
+	SDL_LockMutex(g_lock);
+	for (;;)
+	{
+		while (!g_quit && seen == g_generation) SDL_CondWait(g_work, g_lock);
+		if (g_quit) break;
+		seen = g_generation;
+		SDL_UnlockMutex(g_lock);
+
+		RunJobs();
+
+		SDL_LockMutex(g_lock);
+		if (--g_busy == 0) SDL_CondSignal(g_done);
+	}
+	SDL_UnlockMutex(g_lock);
+	return 0;
+}
+
+
+void InitializeWorkerPool()
+{
+	int const n_cpus = SDL_GetCPUCount();
+	if (n_cpus <= 1) return;
+
+	g_lock = SDL_CreateMutex();
+	g_work = SDL_CreateCond();
+	g_done = SDL_CreateCond();
+	if (!g_lock || !g_work || !g_done)
+	{
+		SLOGW("Failed to create worker pool synchronisation: %s", SDL_GetError());
+		ShutdownWorkerPool();
+		return;
+	}
+
+	UINT const n_workers = __min(n_cpus - 1, MAX_WORKERS);
+	while (g_n_threads != n_workers)
+	{
+		SDL_Thread* const t = SDL_CreateThread(WorkerMain, "worker", 0);
+		if (!t)
+		{
+			SLOGW("Failed to create worker thread: %s", SDL_GetError());
+			break;
+		}
+		g_threads[g_n_threads++] = t;
+	}
+	SLOGD("Started %u worker threads", g_n_threads);
+}
+
+
+void ShutdownWorkerPool()
+{
+	if (g_n_threads != 0)
+	{
+		SDL_LockMutex(g_lock);
+		g_quit = true;
+		SDL_CondBroadcast(g_work);
+		SDL_UnlockMutex(g_lock);
+
+		for (UINT i = 0; i != g_n_threads; ++i) SDL_WaitThread(g_threads[i], 0);
+		g_n_threads = 0;
+	}
+
+	if (g_done) { SDL_DestroyCond(g_done);   g_done = 0; }
+	if (g_work) { SDL_DestroyCond(g_work);   g_work = 0; }
+	if (g_lock) { SDL_DestroyMutex(g_lock);  g_lock = 0; }
+	g_quit = false;
+}
+
+
+UINT WorkerPoolSize()
+{
+	return g_n_threads + 1;
+}
+
+
+void RunParallel(UINT const n, void (* const job)(UINT i, void* ctx), void* const ctx)
+{
+	// There is one batch at a time, a job must not start another
+	Assert(!g_in_job);
+
+	if (g_n_threads == 0 || n <= 1)
+	{
+		g_in_job = true;
+		for (UINT i = 0; i != n; ++i) job(i, ctx);
+		g_in_job = false;
+		return;
+	}
+
+	SDL_LockMutex(g_lock);
+	g_job    = job;
+	g_ctx    = ctx;
+	g_n_jobs = n;
+	SDL_AtomicSet(&g_next_job, 0);
+	g_busy   = g_n_threads;
+	++g_generation;
+	SDL_CondBroadcast(g_work);
+	SDL_UnlockMutex(g_lock);
+
+	g_in_job = true;
+	RunJobs();
+	g_in_job = false;
+
+	SDL_LockMutex(g_lock);
+	while (g_busy != 0) SDL_CondWait(g_done, g_lock);
+	SDL_UnlockMutex(g_lock);
+}
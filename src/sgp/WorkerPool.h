@@ -0,0 +1,33 @@
+#ifndef WORKER_POOL_H
+#define WORKER_POOL_H
+
+#include "Types.h"
+
+
+/* Starts a worker thread for every CPU but the one the game loop runs on. */
+void InitializeWorkerPool();
+void ShutdownWorkerPool();
+
+/* Number of threads taking part in RunParallel(), including the caller. It is 1
+ * if there are no worker threads. */
+UINT WorkerPoolSize();
+
+/* Calls job(i, ctx) for every i in [0, n) and returns after all calls are done.
+ * The calls are spread over the worker threads and the calling thread.
+ *
+ * There is only one batch of jobs at a time: RunParallel() is called by the
+ * main thread, and a job must not call it again. The calls of job run at the
+ * same time, so job may
+ *   - write its own part of what it is handed in ctx, e.g. its element of an
+ *     array or its band of a buffer, and nothing else,
+ *   - read game state which nothing writes while the batch runs, e.g. the
+ *     world while the main thread waits for a line of sight batch,
+ *   - open and read game resources, though not while their names are
+ *     recorded at startup,
+ *   - allocate memory and log.
+ * It must not call Random(), which would change the sequence of random numbers
+ * depending on the timing of the threads, nor create, free or lock video
+ * objects and surfaces or use anything else only the main thread may use. */
+void RunParallel(UINT n, void (*job)(UINT i, void* ctx), void* ctx);
+
+#endif